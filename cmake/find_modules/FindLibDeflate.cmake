@@ -0,0 +1,26 @@
+# - Find libdeflate
+# Find the native libdeflate includes and library
+#
+#  LIBDEFLATE_INCLUDE_DIR - where to find libdeflate.h
+#  LIBDEFLATE_LIBRARIES   - List of libraries when using libdeflate.
+#  LIBDEFLATE_FOUND       - True if libdeflate found.
+
+IF(LIBDEFLATE_INCLUDE_DIR AND LIBDEFLATE_LIBRARIES)
+  # Already in cache, be silent
+  SET(LIBDEFLATE_FIND_QUIETLY TRUE)
+ENDIF(LIBDEFLATE_INCLUDE_DIR AND LIBDEFLATE_LIBRARIES)
+
+FIND_PATH(LIBDEFLATE_INCLUDE_DIR libdeflate.h
+          PATHS "${LIBDEFLATE_DIR}"
+          PATH_SUFFIXES include
+          )
+
+FIND_LIBRARY(LIBDEFLATE_LIBRARIES NAMES deflate libdeflate
+             PATHS "${LIBDEFLATE_DIR}"
+             PATH_SUFFIXES lib
+             )
+
+# handle the QUIETLY and REQUIRED arguments and set LIBDEFLATE_FOUND to TRUE if
+# all listed variables are TRUE
+INCLUDE(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(LibDeflate DEFAULT_MSG LIBDEFLATE_LIBRARIES LIBDEFLATE_INCLUDE_DIR)
@@ -116,6 +116,11 @@ if (NOT NO_LUA)
 	find_package(Lua REQUIRED)
 endif()
 find_package(MPG123 REQUIRED)
+if (USE_LIBDEFLATE)
+	find_package(LibDeflate REQUIRED)
+	include_directories(${LIBDEFLATE_INCLUDE_DIR})
+	add_definitions(-DUSE_LIBDEFLATE)
+endif()
 include_directories(
 	${FREEIMAGE_INCLUDE_DIR}
 	${SFML_INCLUDE_DIR}
@@ -200,6 +205,10 @@ if (NOT NO_FLUIDSYNTH)
 	target_link_libraries(slade ${FLUIDSYNTH_LIBRARIES})
 endif()
 
+if (USE_LIBDEFLATE)
+	target_link_libraries(slade ${LIBDEFLATE_LIBRARIES})
+endif()
+
 set_target_properties(slade PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${SLADE_OUTPUT_DIR})
 
 # TODO: Installation targets for APPLE
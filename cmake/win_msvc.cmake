@@ -37,6 +37,12 @@ if (NOT NO_FLUIDSYNTH)
 	find_package(FluidSynth CONFIG REQUIRED)
 endif ()
 
+# libdeflate
+if (USE_LIBDEFLATE)
+	find_package(libdeflate CONFIG REQUIRED)
+	ADD_DEFINITIONS(-DUSE_LIBDEFLATE)
+endif ()
+
 # Other
 find_package(freeimage CONFIG REQUIRED)
 find_package(MPG123 CONFIG REQUIRED)
@@ -114,3 +120,7 @@ endif ()
 if (NOT NO_FLUIDSYNTH)
 	target_link_libraries(slade FluidSynth::libfluidsynth)
 endif ()
+
+if (USE_LIBDEFLATE)
+	target_link_libraries(slade libdeflate::libdeflate_static)
+endif ()
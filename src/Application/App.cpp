@@ -33,6 +33,8 @@
 #include "Main.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
+#include "Audio/MIDIPlayer.h"
+#include "Benchmarks.h"
 #include "Game/Configuration.h"
 #include "General/Clipboard.h"
 #include "General/ColourConfiguration.h"
@@ -42,18 +44,22 @@
 #include "General/Misc.h"
 #include "General/ResourceManager.h"
 #include "General/SAction.h"
+#include "General/Tasks.h"
 #include "General/UI.h"
 #include "Graphics/Icons.h"
 #include "Graphics/Palette/PaletteManager.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "MainEditor/MainEditor.h"
+#include "MapEditor/BatchMapChecks.h"
+#include "MapEditor/MapBackupManager.h"
+#include "MapEditor/MapEditor.h"
 #include "MapEditor/NodeBuilders.h"
 #include "OpenGL/Drawing.h"
 #include "OpenGL/GLTexture.h"
+#include "OpenGL/TextureArray.h"
 #include "SLADEWxApp.h"
 #include "Scripting/Lua.h"
 #include "Scripting/ScriptManager.h"
-#include "TextEditor/TextLanguage.h"
 #include "TextEditor/TextStyle.h"
 #include "UI/Dialogs/SetupWizard/SetupWizardDialog.h"
 #include "UI/SBrush.h"
@@ -103,6 +109,16 @@ PaletteManager  palette_manager;
 ArchiveManager  archive_manager;
 Clipboard       clip_board;
 ResourceManager resource_manager;
+
+// Command line map checks (-checkmaps)
+bool           batch_map_checks = false;
+vector<string> batch_check_ids;
+string         batch_game;
+string         batch_port;
+
+// Command line benchmarks (-benchmark)
+bool     run_benchmarks       = false;
+unsigned benchmark_iterations = 5;
 } // namespace slade::app
 
 CVAR(Int, temp_location, 0, CVar::Flag::Save)
@@ -351,6 +367,34 @@ vector<string> processCommandLine(const vector<string>& args)
 			log::info("Debugging stuff enabled");
 		}
 
+		// -checkmaps: Run map checks on the given archives and exit
+		else if (strutil::equalCI(arg, "-checkmaps"))
+		{
+			batch_map_checks = true;
+			ui::enableSplash(false);
+		}
+
+		// -checks=<ids>: Comma-separated map check ids to run for -checkmaps
+		else if (strutil::startsWithCI(arg, "-checks="))
+			batch_check_ids = strutil::split(strutil::afterFirstV(arg, '='), ',');
+
+		// -benchmark: Run benchmarks on the given archives and exit
+		else if (strutil::equalCI(arg, "-benchmark"))
+		{
+			run_benchmarks = true;
+			ui::enableSplash(false);
+		}
+
+		// -iterations=<n>: Number of times to run each benchmark for -benchmark
+		else if (strutil::startsWithCI(arg, "-iterations="))
+			benchmark_iterations = strutil::asInt(strutil::afterFirst(arg, '='));
+
+		// -game=<id>/-port=<id>: Game configuration to use for -checkmaps/-benchmark
+		else if (strutil::startsWithCI(arg, "-game="))
+			batch_game = strutil::afterFirst(arg, '=');
+		else if (strutil::startsWithCI(arg, "-port="))
+			batch_port = strutil::afterFirst(arg, '=');
+
 		// Other (no dash), open as archive
 		else if (!strutil::startsWith(arg, '-'))
 			to_open.push_back(arg);
@@ -362,6 +406,19 @@ vector<string> processCommandLine(const vector<string>& args)
 
 	return to_open;
 }
+
+// -----------------------------------------------------------------------------
+// Logs the time taken by the startup [stage], ie. since the previous stage was
+// logged (or since the application was started)
+// -----------------------------------------------------------------------------
+void logStartupStage(string_view stage)
+{
+	static long stage_start = 0;
+
+	auto time = timer.Time();
+	log::info(2, "Startup: {} took {}ms", stage, time - stage_start);
+	stage_start = time;
+}
 } // namespace slade::app
 
 // -----------------------------------------------------------------------------
@@ -446,6 +503,7 @@ bool app::init(const vector<string>& args, double ui_scale)
 
 	// Init log
 	log::init();
+	logStartupStage("Directories and log");
 
 	// Init FreeImage
 	FreeImage_Initialise();
@@ -459,10 +517,12 @@ bool app::init(const vector<string>& args, double ui_scale)
 	// Load configuration file
 	log::info("Loading configuration");
 	readConfigFile();
+	logStartupStage("Configuration");
 
 	// Init entry types
 	EntryDataFormat::initBuiltinFormats();
 	EntryType::initTypes();
+	logStartupStage("Builtin entry types");
 
 	// Check that SLADE.pk3 can be found
 	log::info("Loading resources");
@@ -476,6 +536,7 @@ bool app::init(const vector<string>& args, double ui_scale)
 			wxICON_ERROR);
 		return false;
 	}
+	logStartupStage("Program resource");
 
 	// Init SActions
 	SAction::setBaseWxId(26000);
@@ -491,6 +552,7 @@ bool app::init(const vector<string>& args, double ui_scale)
 
 	// Show splash screen
 	ui::showSplash("Starting up...");
+	logStartupStage("Actions, scripting and UI");
 
 	// Init palettes
 	if (!palette_manager.init())
@@ -498,6 +560,7 @@ bool app::init(const vector<string>& args, double ui_scale)
 		log::error("Failed to initialise palettes");
 		return false;
 	}
+	logStartupStage("Palettes");
 
 	// Init SImage formats
 	SIFormat::initFormats();
@@ -511,14 +574,14 @@ bool app::init(const vector<string>& args, double ui_scale)
 
 	// Load program fonts
 	drawing::initFonts();
+	logStartupStage("Image formats, brushes, icons and fonts");
 
 	// Load entry types
 	log::info("Loading entry types");
 	EntryType::loadEntryTypes();
+	logStartupStage("Entry types");
 
-	// Load text languages
-	log::info("Loading text languages");
-	TextLanguage::loadLanguages();
+	// Text languages are loaded on first use (see TextLanguage::fromId etc.)
 
 	// Init text stylesets
 	log::info("Loading text style sets");
@@ -528,29 +591,46 @@ bool app::init(const vector<string>& args, double ui_scale)
 	// Init colour configuration
 	log::info("Loading colour configuration");
 	colourconfig::init();
+	logStartupStage("Text styles and colours");
 
-	// Init nodebuilders
-	nodebuilders::init();
+	// Nodebuilders are loaded on first use (see nodebuilders::builder etc.)
 
 	// Init game executables
 	executables::init();
 
 	// Init main editor
 	maineditor::init();
+	logStartupStage("Executables and main editor");
 
 	// Init base resource
 	log::info("Loading base resource");
 	archive_manager.initBaseResource();
 	log::info("Base resource loaded");
+	logStartupStage("Base resource");
 
 	// Init game configuration
 	log::info("Loading game configurations");
 	game::init();
+	logStartupStage("Game configurations");
 
-#ifndef NO_LUA
-	// Init script manager
-	scriptmanager::init();
-#endif
+	// The script manager loads its scripts on first use (see scriptmanager::init)
+
+	// Just run map checks on the command line archives if requested, and exit
+	// with the result rather than showing the main window
+	if (batch_map_checks)
+	{
+		auto result = mapeditor::runBatchMapChecks(paths_to_open, batch_check_ids, batch_game, batch_port);
+		archive_manager.closeAll();
+		std::exit(result);
+	}
+
+	// Same for benchmarks
+	if (run_benchmarks)
+	{
+		auto result = runBenchmarks(paths_to_open, benchmark_iterations, batch_game, batch_port);
+		archive_manager.closeAll();
+		std::exit(result);
+	}
 
 	// Show the main window
 	maineditor::windowWx()->Show(true);
@@ -563,9 +643,10 @@ bool app::init(const vector<string>& args, double ui_scale)
 
 	// Hide splash screen
 	ui::hideSplash();
+	logStartupStage("Main window and command line archives");
 
 	init_ok = true;
-	log::info("SLADE Initialisation OK");
+	log::info("SLADE Initialisation OK ({}ms)", timer.Time());
 
 	// Show Setup Wizard if needed
 	if (!setup_wizard_run)
@@ -694,12 +775,22 @@ void app::exit(bool save_config)
 #endif
 	}
 
+	// Finish writing any map backup in progress
+	mapeditor::backupManager().waitForBackup();
+
+	// Stop MIDI playback (joins the synthesis thread, if any)
+	audio::resetMIDIPlayer();
+
+	// Stop background tasks
+	tasks::shutdown();
+
 	// Close all open archives
 	archive_manager.closeAll();
 
 	// Clean up
 	drawing::cleanupFonts();
 	gl::Texture::clearAll();
+	gl::TextureArray::clearAll();
 
 	// Clear temp folder
 	std::error_code error;
@@ -0,0 +1,418 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Benchmarks.cpp
+// Description: Times common operations (archive open/save, entry type
+//              detection, image and texture conversions, text parsing, map
+//              read/write and checks) on a list of archives without opening
+//              the main window (for the -benchmark command line option),
+//              writing the results to stdout as JSON
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Benchmarks.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "Archive/EntryType/EntryType.h"
+#include "Archive/Formats/DirArchive.h"
+#include "Archive/Formats/WadArchive.h"
+#include "Archive/Formats/ZipArchive.h"
+#include "Game/Configuration.h"
+#include "General/Misc.h"
+#include "Graphics/CTexture/PatchTable.h"
+#include "Graphics/CTexture/TextureXList.h"
+#include "Graphics/Palette/PaletteManager.h"
+#include "Graphics/SImage/SImage.h"
+#include "MapEditor/MapChecks.h"
+#include "SLADEMap/SLADEMap.h"
+#include "Utility/Tokenizer.h"
+#include <chrono>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// The results of a benchmark, with the time taken for each iteration
+struct Benchmark
+{
+	string         name;
+	string         map;       // Map the benchmark was run on (map benchmarks only)
+	unsigned       items = 0; // Number of items processed per iteration
+	vector<double> times;     // In milliseconds
+};
+
+// -----------------------------------------------------------------------------
+// Runs [func] [iterations] times and returns the benchmark results as [name].
+// [func] should return the number of items it processed
+// -----------------------------------------------------------------------------
+template<typename F> Benchmark runBenchmark(string_view name, unsigned iterations, F&& func)
+{
+	Benchmark bench{ string{ name } };
+	for (unsigned a = 0; a < iterations; ++a)
+	{
+		auto start  = std::chrono::steady_clock::now();
+		bench.items = func();
+		bench.times.push_back(
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	return bench;
+}
+
+// -----------------------------------------------------------------------------
+// Returns [text] escaped and quoted as a JSON string
+// -----------------------------------------------------------------------------
+string jsonString(string_view text)
+{
+	string escaped = "\"";
+	for (auto c : text)
+	{
+		if (c == '"' || c == '\\')
+		{
+			escaped += '\\';
+			escaped += c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+			escaped += fmt::format("\\u{:04x}", static_cast<int>(c));
+		else
+			escaped += c;
+	}
+
+	return escaped + '"';
+}
+
+// -----------------------------------------------------------------------------
+// Returns [bench] as a JSON object
+// -----------------------------------------------------------------------------
+string benchmarkJson(const Benchmark& bench)
+{
+	auto times = bench.times;
+	std::sort(times.begin(), times.end());
+	double total = 0.;
+	for (auto time : times)
+		total += time;
+
+	return fmt::format(
+		"{{ \"name\": {}, \"map\": {}, \"items\": {}, \"min_ms\": {:.3f}, \"median_ms\": {:.3f}, "
+		"\"mean_ms\": {:.3f}, \"max_ms\": {:.3f} }}",
+		jsonString(bench.name),
+		jsonString(bench.map),
+		bench.items,
+		times.empty() ? 0. : times.front(),
+		times.empty() ? 0. : times[times.size() / 2],
+		times.empty() ? 0. : total / times.size(),
+		times.empty() ? 0. : times.back());
+}
+
+// -----------------------------------------------------------------------------
+// Creates and returns a new (unopened) archive of [format], or nullptr if
+// opening it isn't benchmarked
+// -----------------------------------------------------------------------------
+shared_ptr<Archive> newArchive(string_view format)
+{
+	if (format == "wad")
+		return std::make_shared<WadArchive>();
+	if (format == "zip")
+		return std::make_shared<ZipArchive>();
+	if (format == "folder")
+		return std::make_shared<DirArchive>();
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Runs the archive and entry benchmarks on [archive] (opened from [path]),
+// adding the results to [results]
+// -----------------------------------------------------------------------------
+void benchmarkArchive(Archive& archive, const string& path, unsigned iterations, vector<Benchmark>& results)
+{
+	vector<ArchiveEntry*> entries;
+	archive.putEntryTreeAsList(entries);
+
+	// Open
+	if (newArchive(archive.formatId()))
+		results.push_back(runBenchmark(
+			"archive_open",
+			iterations,
+			[&]()
+			{
+				auto copy = newArchive(archive.formatId());
+				copy->open(path);
+				return copy->numEntries();
+			}));
+
+	// Save (to memory)
+	if (archive.formatId() != "folder")
+		results.push_back(runBenchmark(
+			"archive_write",
+			iterations,
+			[&]()
+			{
+				MemChunk mc;
+				archive.write(mc, false);
+				return mc.size();
+			}));
+
+	// Entry type detection
+	results.push_back(runBenchmark(
+		"entry_type_detection",
+		iterations,
+		[&]()
+		{
+			EntryType::detectEntryTypes(entries);
+			return entries.size();
+		}));
+
+	// Text parsing
+	vector<ArchiveEntry*> text_entries;
+	for (auto* entry : entries)
+		if (entry->type()->editor() == "text")
+			text_entries.push_back(entry);
+	results.push_back(runBenchmark(
+		"tokenizer",
+		iterations,
+		[&]()
+		{
+			unsigned  n_tokens = 0;
+			Tokenizer tz;
+			for (auto* entry : text_entries)
+			{
+				tz.openMem(entry->data(), entry->name());
+				while (!tz.atEnd())
+				{
+					tz.next();
+					++n_tokens;
+				}
+			}
+			return n_tokens;
+		}));
+
+	// Image loading
+	vector<ArchiveEntry*> image_entries;
+	for (auto* entry : entries)
+		if (entry->type()->extraProps().contains("image"))
+			image_entries.push_back(entry);
+	vector<SImage> images(image_entries.size());
+	results.push_back(runBenchmark(
+		"image_load",
+		iterations,
+		[&]()
+		{
+			unsigned n_loaded = 0;
+			for (unsigned a = 0; a < image_entries.size(); ++a)
+				if (misc::loadImageFromEntry(&images[a], image_entries[a]))
+					++n_loaded;
+			return n_loaded;
+		}));
+
+	// Image conversion (to RGBA and back, which uses nearest colour lookups)
+	auto palette = app::paletteManager()->globalPalette();
+	results.push_back(runBenchmark(
+		"image_convert",
+		iterations,
+		[&]()
+		{
+			for (auto& image : images)
+			{
+				SImage copy{ image };
+				copy.convertRGBA(palette);
+				copy.convertPaletted(palette);
+			}
+			return images.size();
+		}));
+
+	// Composite texture building
+	auto pnames = archive.entry("PNAMES", true);
+	if (pnames)
+	{
+		PatchTable   patch_table;
+		TextureXList textures;
+		patch_table.loadPNAMES(pnames, &archive);
+		for (const auto& name : { "TEXTURE1", "TEXTURE2" })
+			if (auto texturex = archive.entry(name, true))
+				textures.readTEXTUREXData(texturex, patch_table, true);
+
+		results.push_back(runBenchmark(
+			"texture_to_image",
+			iterations,
+			[&]()
+			{
+				SImage image;
+				for (const auto& texture : textures.textures())
+					texture->toImage(image, &archive, palette);
+				return textures.size();
+			}));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Runs the map benchmarks on [map_desc], adding the results to [results].
+// The game configuration for the map's format must already be open
+// -----------------------------------------------------------------------------
+void benchmarkMap(const Archive::MapDesc& map_desc, unsigned iterations, vector<Benchmark>& results)
+{
+	auto first = results.size();
+
+	// Read
+	auto map = std::make_unique<SLADEMap>();
+	results.push_back(runBenchmark(
+		"map_read",
+		iterations,
+		[&]()
+		{
+			map = std::make_unique<SLADEMap>();
+			map->readMap(map_desc);
+			return map->nLines();
+		}));
+
+	// Write
+	results.push_back(runBenchmark(
+		"map_write",
+		iterations,
+		[&]()
+		{
+			vector<ArchiveEntry*> map_entries;
+			map->writeMap(map_entries);
+			for (auto* entry : map_entries)
+				delete entry;
+			return map->nLines();
+		}));
+
+	// Sector polygon triangulation
+	results.push_back(runBenchmark(
+		"sector_polygons",
+		iterations,
+		[&]()
+		{
+			for (auto* sector : map->sectors())
+			{
+				sector->resetPolygon();
+				sector->polygon();
+			}
+			return map->nSectors();
+		}));
+
+	// Map checks (texture checks need the map editor texture manager)
+	results.push_back(runBenchmark(
+		"map_checks",
+		iterations,
+		[&]()
+		{
+			unsigned n_problems = 0;
+			for (int a = 0; a < MapCheck::NumStandardChecks; ++a)
+			{
+				auto type = static_cast<MapCheck::StandardCheck>(a);
+				if (type == MapCheck::UnknownTexture || type == MapCheck::UnknownFlat)
+					continue;
+
+				auto check = MapCheck::standardCheck(type, map.get());
+				check->doCheck();
+				n_problems += check->nProblems();
+			}
+			return n_problems;
+		}));
+
+	for (auto a = first; a < results.size(); ++a)
+		results[a].map = map_desc.name;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// App Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Runs the benchmarks [iterations] times on each of [archives], using the
+// given [game] and [port] configuration (or the current one if not given) for
+// any maps. The results are written to stdout as JSON.
+// Returns the exit code: 0 if successful, 2 if an archive couldn't be opened
+// -----------------------------------------------------------------------------
+int app::runBenchmarks(const vector<string>& archives, unsigned iterations, const string& game, const string& port)
+{
+	auto     config_game = game.empty() ? game::configuration().currentGame() : game;
+	auto     config_port = port.empty() ? game::configuration().currentPort() : port;
+	unsigned n_done      = 0;
+	bool     errors      = false;
+	iterations           = std::max(iterations, 1u);
+
+	fmt::print("{{\n");
+	fmt::print("\t\"version\": {},\n", jsonString(app::version().toString()));
+	fmt::print("\t\"iterations\": {},\n", iterations);
+	fmt::print("\t\"archives\": [");
+
+	for (auto& path : archives)
+	{
+		auto archive = app::archiveManager().openArchive(path, true, true);
+		if (!archive)
+		{
+			log::error("Unable to open archive \"{}\": {}", path, global::error);
+			errors = true;
+			continue;
+		}
+
+		vector<Benchmark> results;
+		benchmarkArchive(*archive, path, iterations, results);
+
+		for (const auto& map_desc : archive->detectMaps())
+		{
+			if (!game::configuration().openConfig(config_game, config_port, map_desc.format))
+			{
+				log::error("Unable to open game configuration for map {}", map_desc.name);
+				errors = true;
+				continue;
+			}
+
+			benchmarkMap(map_desc, iterations, results);
+		}
+
+		fmt::print("{}\n\t\t{{\n", n_done++ > 0 ? "," : "");
+		fmt::print("\t\t\t\"path\": {},\n", jsonString(path));
+		fmt::print("\t\t\t\"format\": {},\n", jsonString(archive->formatId()));
+		fmt::print("\t\t\t\"entries\": {},\n", archive->numEntries());
+		fmt::print("\t\t\t\"benchmarks\": [");
+		for (unsigned b = 0; b < results.size(); ++b)
+			fmt::print("{}\n\t\t\t\t{}", b > 0 ? "," : "", benchmarkJson(results[b]));
+		fmt::print("\n\t\t\t]\n\t\t}}");
+
+		app::archiveManager().closeArchive(archive.get());
+	}
+
+	fmt::print("\n\t]\n}}\n");
+	std::fflush(stdout);
+
+	return errors ? 2 : 0;
+}
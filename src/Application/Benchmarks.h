@@ -0,0 +1,6 @@
+#pragma once
+
+namespace slade::app
+{
+int runBenchmarks(const vector<string>& archives, unsigned iterations, const string& game, const string& port);
+} // namespace slade::app
@@ -50,7 +50,7 @@ using std::weak_ptr;
 // Namespace to hold 'global' variables
 namespace slade::global
 {
-extern string error;
+extern thread_local string error; // Last error message (per thread, so functions can be used on worker threads)
 extern string sc_rev;
 extern bool   debug;
 extern int    win_version_major;
@@ -61,7 +61,7 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 namespace slade::global
 {
-string error;
+thread_local string error;
 
 #ifdef GIT_DESCRIPTION
 string sc_rev = GIT_DESCRIPTION;
@@ -396,6 +396,11 @@ bool SLADEWxApp::singleInstanceCheck()
 	if (argc == 1)
 		return true;
 
+	// Don't hand off command line map checks to another instance
+	for (int a = 1; a < argc; a++)
+		if (argv[a].CmpNoCase("-checkmaps") == 0)
+			return true;
+
 	if (single_instance_checker_->IsAnotherRunning())
 	{
 		delete single_instance_checker_;
@@ -31,6 +31,9 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "Archive.h"
+#include "ArchiveSnapshot.h"
+#include "General/Tasks.h"
+#include "General/Trace.h"
 #include "General/UndoRedo.h"
 #include "Utility/FileUtils.h"
 #include "Utility/Parser.h"
@@ -49,6 +52,11 @@ CVAR(Bool, archive_load_data, false, CVar::Flag::Save)
 CVAR(Bool, backup_archives, true, CVar::Flag::Save)
 bool                  Archive::save_backup = true;
 vector<ArchiveFormat> Archive::formats_;
+namespace
+{
+// Minimum number of entries to search before matching names in parallel
+constexpr size_t PARALLEL_SEARCH_MIN_ENTRIES = 8192;
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -210,6 +218,10 @@ public:
 
 	bool doRedo() override { return !created_ ? deleteEntry() : createEntry(); }
 
+	// The copy shares its data with the entry (see ArchiveEntry copy
+	// constructor), so it only uses extra memory if the entry was deleted
+	size_t memUsage() const override { return created_ ? 0 : entry_copy_->size(); }
+
 private:
 	bool                     created_;
 	Archive*                 archive_;
@@ -272,6 +284,14 @@ public:
 			return archive_->createDir(path_) != nullptr;
 	}
 
+	size_t memUsage() const override
+	{
+		size_t usage = 0;
+		if (tree_)
+			tree_->visitEntries([&usage](const ArchiveEntry& entry) { usage += entry.size(); });
+		return usage;
+	}
+
 private:
 	bool                   created_;
 	Archive*               archive_;
@@ -455,9 +475,12 @@ string Archive::filename(bool full) const
 // -----------------------------------------------------------------------------
 bool Archive::open(string_view filename)
 {
-	// Read the file into a MemChunk
+	TRACE_ZONE("Archive::open", filename);
+
+	// Map the file into a MemChunk (entry data is then only read from disk as
+	// it is accessed while opening, rather than reading the whole file in)
 	MemChunk mc;
-	if (!mc.importFile(filename))
+	if (!mc.mapFile(filename))
 	{
 		global::error = "Unable to open file. Make sure it isn't in use by another program.";
 		return false;
@@ -643,6 +666,8 @@ bool Archive::write(string_view filename, bool update)
 // -----------------------------------------------------------------------------
 bool Archive::save(string_view filename)
 {
+	TRACE_ZONE("Archive::save", filename.empty() ? string_view{ filename_ } : filename);
+
 	bool success = false;
 
 	// Check if the archive is read-only
@@ -735,7 +760,7 @@ void Archive::entryStateChanged(ArchiveEntry* entry)
 		return;
 
 	// Signal entry state change
-	signals_.entry_state_changed(*this, *entry);
+	signalEntryStateChanged(*entry);
 
 	// If entry was set to unmodified, don't set the archive to modified
 	if (entry->state() == ArchiveEntry::State::Unmodified)
@@ -754,14 +779,9 @@ void Archive::putEntryTreeAsList(vector<ArchiveEntry*>& list, ArchiveDir* start)
 	if (!start)
 		start = dir_root_.get();
 
-	// Get tree a flat list of shared pointers
-	vector<shared_ptr<ArchiveEntry>> shared_list;
-	ArchiveDir::entryTreeAsList(start, shared_list);
-
-	// Build resulting list of raw pointers
-	list.reserve(shared_list.size());
-	for (const auto& entry : shared_list)
-		list.emplace_back(entry.get());
+	// Build list of raw pointers directly from the tree
+	list.reserve(list.size() + start->numEntries(true));
+	start->visitEntries([&list](ArchiveEntry& entry) { list.push_back(&entry); }, true, true);
 }
 
 // -----------------------------------------------------------------------------
@@ -774,9 +794,19 @@ void Archive::putEntryTreeAsList(vector<shared_ptr<ArchiveEntry>>& list, Archive
 		start = dir_root_.get();
 
 	// Build list from [start]
+	list.reserve(list.size() + start->numEntries(true));
 	ArchiveDir::entryTreeAsList(start, list);
 }
 
+// -----------------------------------------------------------------------------
+// Returns an immutable snapshot of all entries in the archive, which can be
+// read from other threads (see ArchiveSnapshot::create)
+// -----------------------------------------------------------------------------
+shared_ptr<const ArchiveSnapshot> Archive::snapshot(bool load_data) const
+{
+	return ArchiveSnapshot::create(*this, load_data);
+}
+
 // -----------------------------------------------------------------------------
 // 'Pastes' the [tree] into the archive, with its root entries starting at
 // [position] in [base] directory.
@@ -802,10 +832,12 @@ bool Archive::paste(ArchiveDir* tree, unsigned position, shared_ptr<ArchiveDir>
 		return false;
 
 	// Signal changes
+	if (!created_dirs.empty())
+		flushBatchChanges();
 	for (const auto& cdir : created_dirs)
 		signals_.dir_added(*this, *cdir);
 	for (const auto& entry : created_entries)
-		signals_.entry_added(*this, *entry);
+		signalEntryAdded(entry);
 
 	return true;
 }
@@ -858,6 +890,8 @@ shared_ptr<ArchiveDir> Archive::createDir(string_view path, shared_ptr<ArchiveDi
 	setModified(true);
 
 	// Signal directory addition
+	if (!created_dirs.empty())
+		flushBatchChanges();
 	for (const auto& cdir : created_dirs)
 		signals_.dir_added(*this, *cdir);
 
@@ -894,6 +928,7 @@ shared_ptr<ArchiveDir> Archive::removeDir(string_view path, ArchiveDir* base)
 	setModified(true);
 
 	// Signal directory removal
+	flushBatchChanges();
 	signals_.dir_removed(*this, parent, *dir);
 
 	return removed;
@@ -962,7 +997,7 @@ shared_ptr<ArchiveEntry> Archive::addEntry(shared_ptr<ArchiveEntry> entry, unsig
 	entry->state_ = ArchiveEntry::State::New;
 
 	// Signal entry addition
-	signals_.entry_added(*this, *entry);
+	signalEntryAdded(entry);
 
 	// Create undo step
 	if (undoredo::currentlyRecording())
@@ -1054,8 +1089,8 @@ bool Archive::removeEntry(ArchiveEntry* entry, bool set_deleted)
 		if (set_deleted)
 			entry_shared->setState(ArchiveEntry::State::Deleted);
 
-		signals_.entry_removed(*this, *dir, *entry); // Signal entry removed
-		setModified(true);                           // Update variables etc
+		signalEntryRemoved(*dir, entry_shared); // Signal entry removed
+		setModified(true);                      // Update variables etc
 	}
 
 	return ok;
@@ -1087,6 +1122,7 @@ bool Archive::swapEntries(unsigned index1, unsigned index2, ArchiveDir* dir)
 		setModified(true);
 
 		// Signal
+		flushBatchChanges();
 		signals_.entries_swapped(*this, *dir, index1, index2);
 
 		return true;
@@ -1147,6 +1183,7 @@ bool Archive::swapEntries(ArchiveEntry* entry1, ArchiveEntry* entry2)
 	setModified(true);
 
 	// Signal
+	flushBatchChanges();
 	signals_.entries_swapped(*this, *dir, i1, i2);
 
 	// Return success
@@ -1235,6 +1272,7 @@ bool Archive::renameEntry(ArchiveEntry* entry, string_view name, bool force)
 	entry->setState(ArchiveEntry::State::Modified, true);
 
 	// Announce modification
+	flushBatchChanges();
 	signals_.entry_renamed(*this, *entry, prev_name);
 	entryStateChanged(entry);
 
@@ -1256,6 +1294,7 @@ bool Archive::importDir(string_view directory, bool ignore_hidden, shared_ptr<Ar
 			files.push_back(item.path().string());
 
 	// Go through files
+	const ArchiveBatch batch{ *this };
 	for (const auto& file : files)
 	{
 		strutil::Path fn{ strutil::replace(file, directory, "") }; // Remove directory from entry name
@@ -1379,68 +1418,16 @@ string Archive::detectNamespace(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 ArchiveEntry* Archive::findFirst(SearchOptions& options)
 {
-	// Init search variables
-	auto dir = options.dir;
-	if (!dir)
-		dir = dir_root_.get();
-	strutil::upperIP(options.match_name); // Force case-insensitive
-
-	// Begin search
-
-	// Search entries
-	for (unsigned a = 0; a < dir->numEntries(); a++)
-	{
-		const auto entry = dir->entryAt(a);
-
-		// Check type
-		if (options.match_type)
+	ArchiveEntry* match = nullptr;
+	visitMatchingEntries(
+		options,
+		[&match](ArchiveEntry& entry)
 		{
-			if (entry->type() == EntryType::unknownType())
-			{
-				if (!options.match_type->isThisType(*entry))
-					continue;
-			}
-			else if (options.match_type != entry->type())
-				continue;
-		}
+			match = &entry;
+			return false;
+		});
 
-		// Check name
-		if (!options.match_name.empty())
-		{
-			// Cut extension if ignoring
-			const auto check_name = options.ignore_ext ? entry->upperNameNoExt() : entry->upperName();
-			if (!strutil::matches(check_name, options.match_name))
-				continue;
-		}
-
-		// Check namespace
-		if (!options.match_namespace.empty())
-		{
-			if (!strutil::equalCI(detectNamespace(entry), options.match_namespace))
-				continue;
-		}
-
-		// Entry passed all checks so far, so we found a match
-		return entry;
-	}
-
-	// Search subdirectories (if needed)
-	if (options.search_subdirs)
-	{
-		for (unsigned a = 0; a < dir->numSubdirs(); a++)
-		{
-			auto opt         = options;
-			opt.dir          = dir->subdirAt(a).get();
-			const auto match = findFirst(opt);
-
-			// If a match was found in this subdir, return it
-			if (match)
-				return match;
-		}
-	}
-
-	// No matches found
-	return nullptr;
+	return match;
 }
 
 // -----------------------------------------------------------------------------
@@ -1518,68 +1505,94 @@ ArchiveEntry* Archive::findLast(SearchOptions& options)
 // -----------------------------------------------------------------------------
 vector<ArchiveEntry*> Archive::findAll(SearchOptions& options)
 {
-	// Init search variables
+	vector<ArchiveEntry*> ret;
+	visitMatchingEntries(
+		options,
+		[&ret](ArchiveEntry& entry)
+		{
+			ret.push_back(&entry);
+			return true;
+		});
+
+	return ret;
+}
+
+// -----------------------------------------------------------------------------
+// Calls [visitor] for each entry matching the search criteria in [options], in
+// the same order as findAll (without building a list). The visitor can return
+// false to stop searching.
+// Returns false if the search was stopped early
+// -----------------------------------------------------------------------------
+bool Archive::visitMatchingEntries(const SearchOptions& options, const std::function<bool(ArchiveEntry&)>& visitor)
+{
 	auto dir = options.dir;
 	if (!dir)
 		dir = dir_root_.get();
-	vector<ArchiveEntry*> ret;
-	strutil::upperIP(options.match_name); // Force case-insensitive
-
-	// Begin search
+	const auto upper_name = strutil::upper(options.match_name); // Force case-insensitive
 
-	// Search entries
-	for (unsigned a = 0; a < dir->numEntries(); a++)
+	// Searching for a literal name, use the directory name indices to skip
+	// directories without it and start from the first match in each
+	if (!upper_name.empty() && upper_name.find_first_of("*?") == string::npos)
 	{
-		auto entry = dir->entryAt(a);
-
-		// Check type
-		if (options.match_type)
+		auto visit_dir = [&](const ArchiveDir& search_dir)
 		{
-			if (entry->type() == EntryType::unknownType())
+			auto first = search_dir.entry(upper_name, options.ignore_ext);
+			if (!first)
+				return true;
+
+			const auto& entries = search_dir.entries();
+			for (auto a = static_cast<size_t>(search_dir.entryIndex(first)); a < entries.size(); ++a)
 			{
-				if (!options.match_type->isThisType(*entry))
+				auto& entry = *entries[a];
+				if ((options.ignore_ext ? entry.upperNameNoExt() : entry.upperName()) != upper_name)
 					continue;
+				if (entryMatches(entry, options, {}) && !visitor(entry))
+					return false;
 			}
-			else if (options.match_type != entry->type())
-				continue;
-		}
 
-		// Check name
-		if (!options.match_name.empty())
-		{
-			// Cut extension if ignoring
-			const auto check_name = options.ignore_ext ? entry->upperNameNoExt() : entry->upperName();
-			if (!strutil::matches(check_name, options.match_name))
-				continue;
-		}
+			return true;
+		};
 
-		// Check namespace
-		if (!options.match_namespace.empty())
-		{
-			if (!strutil::equalCI(detectNamespace(entry), options.match_namespace))
-				continue;
-		}
+		if (!visit_dir(*dir))
+			return false;
 
-		// Entry passed all checks so far, so we found a match
-		ret.push_back(entry);
+		return !options.search_subdirs || dir->visitDirs(visit_dir);
 	}
 
-	// Search subdirectories (if needed)
-	if (options.search_subdirs)
+	// Searching for a wildcard name in a large archive, match entry names in
+	// parallel first (the rest of the checks aren't thread-safe, since they can
+	// load entry data or update the entry index guess)
+	if (!upper_name.empty())
 	{
-		for (unsigned a = 0; a < dir->numSubdirs(); a++)
+		vector<ArchiveEntry*> candidates;
+		dir->visitEntries([&](ArchiveEntry& entry) { candidates.push_back(&entry); }, options.search_subdirs);
+
+		if (candidates.size() >= PARALLEL_SEARCH_MIN_ENTRIES)
 		{
-			auto opt = options;
-			opt.dir  = dir->subdirAt(a).get();
+			vector<uint8_t> name_match(candidates.size(), 0);
+			tasks::parallelFor(
+				0,
+				candidates.size(),
+				[&](unsigned index)
+				{
+					const auto check_name = options.ignore_ext ? candidates[index]->upperNameNoExt() :
+																 candidates[index]->upperName();
+					name_match[index]     = strutil::matches(check_name, upper_name) ? 1 : 0;
+				},
+				256);
 
-			// Add any matches to the list
-			auto vec = findAll(opt);
-			ret.insert(ret.end(), vec.begin(), vec.end());
+			// Check remaining criteria for name matches, in order
+			for (size_t a = 0; a < candidates.size(); ++a)
+				if (name_match[a] && entryMatches(*candidates[a], options, {}) && !visitor(*candidates[a]))
+					return false;
+
+			return true;
 		}
 	}
 
-	// Return matches
-	return ret;
+	return dir->visitEntries(
+		[&](ArchiveEntry& entry) { return !entryMatches(entry, options, upper_name) || visitor(entry); },
+		options.search_subdirs);
 }
 
 // -----------------------------------------------------------------------------
@@ -1618,6 +1631,43 @@ vector<ArchiveEntry*> Archive::findModifiedEntries(ArchiveDir* dir)
 	return ret;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if [entry] matches the search criteria in [options].
+// [upper_name] is the uppercase version of options.match_name
+// -----------------------------------------------------------------------------
+bool Archive::entryMatches(ArchiveEntry& entry, const SearchOptions& options, string_view upper_name)
+{
+	// Check type
+	if (options.match_type)
+	{
+		if (entry.type() == EntryType::unknownType())
+		{
+			if (!options.match_type->isThisType(entry))
+				return false;
+		}
+		else if (options.match_type != entry.type())
+			return false;
+	}
+
+	// Check name
+	if (!upper_name.empty())
+	{
+		// Cut extension if ignoring
+		const auto check_name = options.ignore_ext ? entry.upperNameNoExt() : entry.upperName();
+		if (!strutil::matches(check_name, upper_name))
+			return false;
+	}
+
+	// Check namespace
+	if (!options.match_namespace.empty())
+	{
+		if (!strutil::equalCI(detectNamespace(&entry), options.match_namespace))
+			return false;
+	}
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Blocks or unblocks signals for archive/entry modifications
 // -----------------------------------------------------------------------------
@@ -1630,6 +1680,7 @@ void Archive::blockModificationSignals(bool block)
 		signals_.entry_removed.block();
 		signals_.entry_state_changed.block();
 		signals_.entry_renamed.block();
+		signals_.entries_changed.block();
 	}
 	else
 	{
@@ -1638,9 +1689,115 @@ void Archive::blockModificationSignals(bool block)
 		signals_.entry_removed.unblock();
 		signals_.entry_state_changed.unblock();
 		signals_.entry_renamed.unblock();
+		signals_.entries_changed.unblock();
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Ends a batch of changes started with beginBatch. When the outermost batch is
+// committed, all entry changes made within it are announced together via the
+// entries_changed signal
+// -----------------------------------------------------------------------------
+void Archive::commitBatch()
+{
+	if (batch_depth_ > 0 && --batch_depth_ == 0)
+		flushBatchChanges();
+}
+
+// -----------------------------------------------------------------------------
+// Announces that [entry] was added to the archive, or adds it to the current
+// batch of changes if in a batch
+// -----------------------------------------------------------------------------
+void Archive::signalEntryAdded(const shared_ptr<ArchiveEntry>& entry)
+{
+	if (!inBatch())
+	{
+		signals_.entry_added(*this, *entry);
+		return;
+	}
+
+	if (!signals_.entries_changed.blocked() && batch_added_.insert(entry.get()).second)
+		batch_changes_.added.push_back(entry);
+}
+
+// -----------------------------------------------------------------------------
+// Announces that [entry] was removed from [dir], or adds it to the current
+// batch of changes if in a batch
+// -----------------------------------------------------------------------------
+void Archive::signalEntryRemoved(ArchiveDir& dir, const shared_ptr<ArchiveEntry>& entry)
+{
+	if (!inBatch())
+	{
+		signals_.entry_removed(*this, dir, *entry);
+		return;
+	}
+
+	if (signals_.entries_changed.blocked())
+		return;
+
+	// If the entry was added within the batch, nothing has been told about it
+	// yet so there's no need to announce its removal either
+	batch_state_changed_.erase(entry.get());
+	if (batch_added_.erase(entry.get()) > 0)
+		return;
+
+	batch_changes_.removed.push_back({ ArchiveDir::getShared(&dir), entry });
+}
+
+// -----------------------------------------------------------------------------
+// Announces that [entry]'s state has changed, or adds it to the current batch
+// of changes if in a batch
+// -----------------------------------------------------------------------------
+void Archive::signalEntryStateChanged(ArchiveEntry& entry)
+{
+	if (!inBatch())
+	{
+		signals_.entry_state_changed(*this, entry);
+		return;
+	}
+
+	// Entries added within the batch will be announced as added anyway
+	if (signals_.entries_changed.blocked() || batch_added_.count(&entry) > 0)
+		return;
+
+	if (batch_state_changed_.insert(&entry).second)
+		batch_changes_.state_changed.push_back(entry.getShared());
+}
+
+// -----------------------------------------------------------------------------
+// Announces all entry changes collected so far in the current batch via the
+// entries_changed signal. This is also done before announcing any change that
+// isn't batched (eg. directory added/removed), so that the order of changes is
+// kept for anything listening
+// -----------------------------------------------------------------------------
+void Archive::flushBatchChanges()
+{
+	if (batch_changes_.empty())
+		return;
+
+	auto changes   = std::move(batch_changes_);
+	batch_changes_ = {};
+
+	// Remove any entries that were added or modified and then removed again
+	// within the batch (or duplicates, if re-added after being removed)
+	auto filter = [](vector<shared_ptr<ArchiveEntry>>& list, std::set<const ArchiveEntry*>& pending)
+	{
+		vector<shared_ptr<ArchiveEntry>> filtered;
+		filtered.reserve(list.size());
+		for (auto& entry : list)
+			if (entry && pending.erase(entry.get()) > 0)
+				filtered.push_back(std::move(entry));
+		list = std::move(filtered);
+	};
+	filter(changes.added, batch_added_);
+	filter(changes.state_changed, batch_state_changed_);
+	batch_added_.clear();
+	batch_state_changed_.clear();
+
+	if (!changes.empty())
+		signals_.entries_changed(*this, changes);
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -1659,10 +1816,10 @@ bool Archive::loadFormats(MemChunk& mc)
 		return false;
 
 	auto root         = parser.parseTreeRoot();
-	auto formats_node = root->child("archive_formats");
+	auto formats_node = root->childPTN("archive_formats");
 	for (unsigned a = 0; a < formats_node->nChildren(); a++)
 	{
-		auto          fmt_desc = dynamic_cast<ParseTreeNode*>(formats_node->child(a));
+		auto          fmt_desc = formats_node->childPTN(a);
 		ArchiveFormat fmt{ fmt_desc->name() };
 
 		for (unsigned p = 0; p < fmt_desc->nChildren(); p++)
@@ -3,9 +3,12 @@
 #include "ArchiveDir.h"
 #include "ArchiveEntry.h"
 #include "General/Defs.h"
+#include <atomic>
 
 namespace slade
 {
+class ArchiveSnapshot;
+
 struct ArchiveFormat
 {
 	string             id;
@@ -63,6 +66,11 @@ public:
 
 	void setModified(bool modified);
 	void setFilename(string_view filename) { filename_ = filename; }
+	void setUseIndexCache(bool use) { use_index_cache_ = use; }
+
+	// Opening cancellation (for opening on a background thread)
+	void cancelOpen() { open_cancelled_ = true; }
+	bool openCancelled() const { return open_cancelled_; }
 
 	// Entry retrieval/info
 	bool                             checkEntry(const ArchiveEntry* entry) const;
@@ -99,6 +107,9 @@ public:
 	virtual bool importDir(string_view directory, bool ignore_hidden = false, shared_ptr<ArchiveDir> base = nullptr);
 	virtual bool hasFlatHack() { return false; }
 
+	// Snapshots (for reading on background threads, see ArchiveSnapshot)
+	shared_ptr<const ArchiveSnapshot> snapshot(bool load_data = true) const;
+
 	// Directory stuff
 	ArchiveDir*                    dirAtPath(string_view path, ArchiveDir* base = nullptr) const;
 	virtual shared_ptr<ArchiveDir> createDir(string_view path, shared_ptr<ArchiveDir> base = nullptr);
@@ -160,6 +171,25 @@ public:
 	virtual ArchiveEntry*         findLast(SearchOptions& options);
 	virtual vector<ArchiveEntry*> findAll(SearchOptions& options);
 	virtual vector<ArchiveEntry*> findModifiedEntries(ArchiveDir* dir = nullptr);
+	bool visitMatchingEntries(const SearchOptions& options, const std::function<bool(ArchiveEntry&)>& visitor);
+
+	// Batched changes
+	struct RemovedEntry
+	{
+		shared_ptr<ArchiveDir>   dir;   // Dir the entry was removed from
+		shared_ptr<ArchiveEntry> entry; // The removed entry
+	};
+	struct EntryChanges
+	{
+		vector<RemovedEntry>             removed;
+		vector<shared_ptr<ArchiveEntry>> added;
+		vector<shared_ptr<ArchiveEntry>> state_changed;
+
+		bool empty() const { return removed.empty() && added.empty() && state_changed.empty(); }
+	};
+	void beginBatch() { ++batch_depth_; }
+	void commitBatch();
+	bool inBatch() const { return batch_depth_ > 0; }
 
 	// Signals
 	struct Signals
@@ -174,6 +204,8 @@ public:
 		sigslot::signal<Archive&, ArchiveDir&, unsigned, unsigned> entries_swapped; // Archive, Dir, Index 1, Index 2
 		sigslot::signal<Archive&, ArchiveDir&>                     dir_added;
 		sigslot::signal<Archive&, ArchiveDir&, ArchiveDir&>        dir_removed; // Archive, Parent dir, Removed Dir
+		sigslot::signal<Archive&, string_view, float>              open_progress; // Archive, Message, Progress (<0 if unknown)
+		sigslot::signal<Archive&, const EntryChanges&>             entries_changed; // Entry changes in a batch
 	};
 	Signals& signals() { return signals_; }
 	void     blockModificationSignals(bool block = true);
@@ -186,16 +218,31 @@ protected:
 	string                 format_;
 	string                 filename_;
 	weak_ptr<ArchiveEntry> parent_;
-	bool   on_disk_       = false; // Specifies whether the archive exists on disk (as opposed to being newly created)
-	bool   read_only_     = false; // If true, the archive cannot be modified
-	time_t file_modified_ = 0;
+	bool   on_disk_         = false; // Specifies whether the archive exists on disk (as opposed to being newly created)
+	bool   read_only_       = false; // If true, the archive cannot be modified
+	time_t file_modified_   = 0;
+	bool   use_index_cache_ = false; // If true, the entry index is cached on disk (see ArchiveIndexCache)
+
+	std::atomic<bool> open_cancelled_{ false }; // Set to cancel opening the archive (from another thread)
 
 private:
 	bool                   modified_ = true;
 	shared_ptr<ArchiveDir> dir_root_;
 	Signals                signals_;
 
+	// Batched changes (see beginBatch/commitBatch)
+	int                           batch_depth_ = 0;
+	EntryChanges                  batch_changes_;
+	std::set<const ArchiveEntry*> batch_added_;
+	std::set<const ArchiveEntry*> batch_state_changed_;
+
 	static vector<ArchiveFormat> formats_;
+
+	bool entryMatches(ArchiveEntry& entry, const SearchOptions& options, string_view upper_name);
+	void signalEntryAdded(const shared_ptr<ArchiveEntry>& entry);
+	void signalEntryRemoved(ArchiveDir& dir, const shared_ptr<ArchiveEntry>& entry);
+	void signalEntryStateChanged(ArchiveEntry& entry);
+	void flushBatchChanges();
 };
 
 // Base class for list-based archive formats
@@ -263,6 +310,19 @@ public:
 	string detectNamespace(unsigned index, ArchiveDir* dir = nullptr) override { return "global"; }
 };
 
+// Simple class that will begin and commit a batch of changes to an archive via RAII.
+// While a batch is active, entry additions, removals and state changes are
+// collected and announced together via the entries_changed signal on commit
+class ArchiveBatch
+{
+public:
+	ArchiveBatch(Archive& archive) : archive_{ &archive } { archive_->beginBatch(); }
+	~ArchiveBatch() { archive_->commitBatch(); }
+
+private:
+	Archive* archive_;
+};
+
 // Simple class that will block and unblock modification signals for an archive via RAII
 class ArchiveModSignalBlocker
 {
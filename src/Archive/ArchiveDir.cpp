@@ -33,6 +33,7 @@
 #include "Main.h"
 #include "ArchiveDir.h"
 #include "Archive.h"
+#include "EntryExport.h"
 #include "Utility/StringUtils.h"
 #include <filesystem>
 
@@ -223,13 +224,11 @@ ArchiveEntry* ArchiveDir::entry(string_view name, bool cut_ext) const
 	if (name.empty())
 		return nullptr;
 
-	// Go through entries
-	for (auto& entry : entries_)
-	{
-		// Check for (non-case-sensitive) name match
-		if (strutil::equalCI(cut_ext ? entry->nameNoExt() : entry->name(), name))
-			return entry.get();
-	}
+	// Check for (non-case-sensitive) name match
+	const auto& index = cut_ext ? name_noext_index_ : name_index_;
+	const auto  found = index.find(strutil::upper(name));
+	if (found != index.end())
+		return found->second;
 
 	// Not found
 	return nullptr;
@@ -241,20 +240,11 @@ ArchiveEntry* ArchiveDir::entry(string_view name, bool cut_ext) const
 // -----------------------------------------------------------------------------
 shared_ptr<ArchiveEntry> ArchiveDir::sharedEntry(string_view name, bool cut_ext) const
 {
-	// Check name was given
-	if (name.empty())
+	const auto found = entry(name, cut_ext);
+	if (!found)
 		return nullptr;
 
-	// Go through entries
-	for (auto& entry : entries_)
-	{
-		// Check for (non-case-sensitive) name match
-		if (strutil::equalCI(cut_ext ? entry->nameNoExt() : entry->name(), name))
-			return entry;
-	}
-
-	// Not found
-	return nullptr;
+	return sharedEntryAt(entryIndex(found));
 }
 
 // -----------------------------------------------------------------------------
@@ -310,6 +300,7 @@ bool ArchiveDir::addEntry(shared_ptr<ArchiveEntry> entry, bool ignore_requiremen
 		entries_.push_back(entry); // 'Invalid' index, add to end of list
 	else
 		entries_.insert(entries_.begin() + index, entry); // Add it at index
+	indexEntry(entry.get());
 
 	// Check entry name if duplicate names aren't allowed
 	if (!ignore_requirements && !allow_duplicate_names_)
@@ -329,6 +320,7 @@ bool ArchiveDir::removeEntry(unsigned index)
 		return false;
 
 	// De-parent entry
+	unindexEntry(entries_[index].get());
 	entries_[index]->parent_ = nullptr;
 
 	// Remove it from the entry list
@@ -348,7 +340,13 @@ bool ArchiveDir::swapEntries(unsigned index1, unsigned index2)
 		return false;
 
 	// Swap entries
+	const auto entry1 = entries_[index1].get();
+	const auto entry2 = entries_[index2].get();
+	unindexEntry(entry1);
+	unindexEntry(entry2);
 	entries_[index1].swap(entries_[index2]);
+	indexEntry(entry1);
+	indexEntry(entry2);
 
 	return true;
 }
@@ -452,6 +450,8 @@ shared_ptr<ArchiveDir> ArchiveDir::removeSubdirAt(unsigned index)
 void ArchiveDir::clear()
 {
 	entries_.clear();
+	name_index_.clear();
+	name_noext_index_.clear();
 	subdirs_.clear();
 }
 
@@ -481,9 +481,23 @@ shared_ptr<ArchiveDir> ArchiveDir::clone(shared_ptr<ArchiveDir> parent)
 }
 
 // -----------------------------------------------------------------------------
-// Exports all entries and subdirs to the filesystem at [path]
+// Exports all entries and subdirs to the filesystem at [path].
+// Returns false if any entry couldn't be exported
 // -----------------------------------------------------------------------------
 bool ArchiveDir::exportTo(string_view path) const
+{
+	vector<entryexport::File> files;
+	addExportFiles(path, files);
+
+	return entryexport::exportFiles(files);
+}
+
+// -----------------------------------------------------------------------------
+// Adds files to export all entries and subdirectories in the directory to
+// [path] on disk to [files] (see entryexport::exportFiles). The directory and
+// subdirectories are created on disk if needed
+// -----------------------------------------------------------------------------
+void ArchiveDir::addExportFiles(string_view path, vector<entryexport::File>& files) const
 {
 	// Create directory if needed
 	if (!std::filesystem::exists(path))
@@ -500,15 +514,12 @@ bool ArchiveDir::exportTo(string_view path) const
 		if (!fn.hasExtension())
 			fn.setExtension(entry->type()->extension());
 
-		// Do export
-		entry->exportFile(fn.fullPath());
+		files.push_back({ entry.get(), fn.fullPath() });
 	}
 
 	// Export subdirectories
 	for (auto&& subdir : subdirs_)
-		subdir->exportTo(fmt::format("{}/{}", path, subdir->name()));
-
-	return true;
+		subdir->addExportFiles(fmt::format("{}/{}", path, subdir->name()), files);
 }
 
 // -----------------------------------------------------------------------------
@@ -544,6 +555,55 @@ void ArchiveDir::ensureUniqueName(ArchiveEntry* entry) const
 		entry->setName(name);
 }
 
+// -----------------------------------------------------------------------------
+// Adds [entry] to the name lookup indices, unless an entry with the same name
+// comes before it in the directory.
+// [entry] must already be in this directory
+// -----------------------------------------------------------------------------
+void ArchiveDir::indexEntry(ArchiveEntry* entry)
+{
+	// An entry added at the end can't come before an existing one
+	const bool at_end = !entries_.empty() && entries_.back().get() == entry;
+
+	auto add = [&](std::unordered_map<string, ArchiveEntry*>& index, string_view name)
+	{
+		auto [it, added] = index.try_emplace(string{ name }, entry);
+		if (!added && !at_end && it->second != entry && entryIndex(entry) < entryIndex(it->second))
+			it->second = entry;
+	};
+
+	add(name_index_, entry->upperName());
+	add(name_noext_index_, entry->upperNameNoExt());
+}
+
+// -----------------------------------------------------------------------------
+// Removes [entry] from the name lookup indices. If another entry in the
+// directory has the same name, the first such entry is indexed in its place
+// -----------------------------------------------------------------------------
+void ArchiveDir::unindexEntry(ArchiveEntry* entry)
+{
+	auto remove = [&](std::unordered_map<string, ArchiveEntry*>& index, string_view name, bool cut_ext)
+	{
+		const auto it = index.find(string{ name });
+		if (it == index.end() || it->second != entry)
+			return;
+
+		for (const auto& other : entries_)
+		{
+			if (other.get() != entry && (cut_ext ? other->upperNameNoExt() : other->upperName()) == name)
+			{
+				it->second = other.get();
+				return;
+			}
+		}
+
+		index.erase(it);
+	};
+
+	remove(name_index_, entry->upperName(), false);
+	remove(name_noext_index_, entry->upperNameNoExt(), true);
+}
+
 // -----------------------------------------------------------------------------
 // Returns the first entry in the directory that has the same name as another,
 // or nullptr if all names are unique
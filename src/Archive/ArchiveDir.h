@@ -4,9 +4,15 @@
 
 namespace slade
 {
+namespace entryexport
+{
+	struct File;
+}
+
 class ArchiveDir
 {
 	friend class Archive;
+	friend class ArchiveEntry;
 
 public:
 	ArchiveDir(string_view name, const shared_ptr<ArchiveDir>& parent = nullptr, Archive* archive = nullptr);
@@ -37,6 +43,14 @@ public:
 	vector<shared_ptr<ArchiveEntry>> allEntries() const;
 	vector<shared_ptr<ArchiveDir>>   allDirectories() const;
 
+	// Entry Traversal
+	// These walk the tree in place (no lists are built). [visitor] is called
+	// with either an ArchiveEntry& or a const shared_ptr<ArchiveEntry>&
+	// (whichever it accepts), and can return false to stop the traversal early
+	template<typename Visitor>
+	bool visitEntries(Visitor&& visitor, bool include_subdirs = true, bool include_dir_entries = false) const;
+	template<typename Visitor> bool visitDirs(Visitor&& visitor) const;
+
 	// Entry Operations
 	bool addEntry(shared_ptr<ArchiveEntry> entry, bool ignore_requirements, unsigned index = 0xFFFFFFFF);
 	bool addEntry(shared_ptr<ArchiveEntry> entry, unsigned index = 0xFFFFFFFF) { return addEntry(entry, false, index); }
@@ -55,6 +69,7 @@ public:
 	void                   clear();
 	shared_ptr<ArchiveDir> clone(shared_ptr<ArchiveDir> parent = nullptr);
 	bool                   exportTo(string_view path) const;
+	void                   addExportFiles(string_view path, vector<entryexport::File>& files) const;
 	void                   allowDuplicateNames(bool allow) { allow_duplicate_names_ = allow; }
 	ArchiveEntry*          findDuplicateEntryName() const;
 
@@ -88,6 +103,86 @@ private:
 	vector<shared_ptr<ArchiveDir>>   subdirs_;
 	bool                             allow_duplicate_names_ = true;
 
+	// Case-insensitive (uppercase) name -> first entry with that name, for fast lookups
+	std::unordered_map<string, ArchiveEntry*> name_index_;
+	std::unordered_map<string, ArchiveEntry*> name_noext_index_;
+
 	void ensureUniqueName(ArchiveEntry* entry) const;
+	void indexEntry(ArchiveEntry* entry);
+	void unindexEntry(ArchiveEntry* entry);
 };
+
+namespace detail
+{
+	// Calls [visitor] with [arg], returning false if the visitor returned false
+	// (visitors that don't return anything always continue)
+	template<typename Visitor, typename T> bool callVisitor(Visitor& visitor, T& arg)
+	{
+		if constexpr (std::is_void_v<std::invoke_result_t<Visitor&, T&>>)
+		{
+			visitor(arg);
+			return true;
+		}
+		else
+			return visitor(arg);
+	}
+
+	// Calls [visitor] with [entry] or the ArchiveEntry it points to, depending
+	// on which the visitor accepts
+	template<typename Visitor> bool visitEntry(Visitor& visitor, const shared_ptr<ArchiveEntry>& entry)
+	{
+		if constexpr (std::is_invocable_v<Visitor&, const shared_ptr<ArchiveEntry>&>)
+			return callVisitor(visitor, entry);
+		else
+			return callVisitor(visitor, *entry);
+	}
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// Calls [visitor] for each entry in this directory, and all subdirectories if
+// [include_subdirs] is true. Entries are visited in the same order as
+// entryTreeAsList, and if [include_dir_entries] is true each subdirectory's
+// dir entry is visited before its contents.
+// Returns false if the visitor stopped the traversal early
+// -----------------------------------------------------------------------------
+template<typename Visitor>
+bool ArchiveDir::visitEntries(Visitor&& visitor, bool include_subdirs, bool include_dir_entries) const
+{
+	for (const auto& entry : entries_)
+		if (!detail::visitEntry(visitor, entry))
+			return false;
+
+	if (include_subdirs)
+	{
+		for (const auto& subdir : subdirs_)
+		{
+			if (include_dir_entries && !detail::visitEntry(visitor, subdir->dir_entry_))
+				return false;
+
+			if (!subdir->visitEntries(visitor, true, include_dir_entries))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Calls [visitor] with each subdirectory (as an ArchiveDir&) of this directory,
+// recursively, in the same order as allDirectories.
+// Returns false if the visitor stopped the traversal early
+// -----------------------------------------------------------------------------
+template<typename Visitor> bool ArchiveDir::visitDirs(Visitor&& visitor) const
+{
+	for (const auto& subdir : subdirs_)
+	{
+		if (!detail::callVisitor(visitor, *subdir))
+			return false;
+
+		if (!subdir->visitDirs(visitor))
+			return false;
+	}
+
+	return true;
+}
 } // namespace slade
@@ -37,6 +37,7 @@
 #include "Archive.h"
 #include "General/Misc.h"
 #include "Utility/StringUtils.h"
+#include <atomic>
 
 using namespace slade;
 
@@ -57,6 +58,8 @@ CVAR(Int, max_entry_size_mb, 512, CVar::Flag::Save)
 // -----------------------------------------------------------------------------
 namespace
 {
+std::atomic<uint64_t> data_access_counter{ 0 }; // Incremented on each entry data access, for LRU tracking
+
 unsigned maxEntrySizeBytes()
 {
 	constexpr unsigned MB_TO_BYTES = 1024 * 1024;
@@ -89,17 +92,20 @@ ArchiveEntry::ArchiveEntry(ArchiveEntry& copy) :
 	upper_name_{ copy.upper_name_ },
 	size_{ copy.size_ },
 	type_{ copy.type_ },
-	ex_props_{ copy.ex_props_ },
+	full_size_{ copy.full_size_ },
 	encrypted_{ copy.encrypted_ },
 	reliability_{ copy.reliability_ }
 {
-	// Copy data
-	data_.importMem(copy.rawData(true), copy.size());
+	// Share data with the copied entry, it is only actually copied when either
+	// entry's data is modified
+	dataChunk().share(copy.data(true));
 
-	// Clear properties that shouldn't be copied
-	ex_props_.remove("ZipIndex");
-	ex_props_.remove("Offset");
-	ex_props_.remove("filePath");
+	// Copy properties, except those that shouldn't be
+	if (copy.ex_props_)
+	{
+		ex_props_ = std::make_unique<PropertyList>(*copy.ex_props_);
+		ex_props_->remove("filePath");
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -165,8 +171,8 @@ string ArchiveEntry::path(bool include_name) const
 // -----------------------------------------------------------------------------
 const uint8_t* ArchiveEntry::rawData(bool allow_load)
 {
-	// Return entry data
-	return data(allow_load).data();
+	// Return entry data (via const MemChunk so shared data isn't copied)
+	return constData(allow_load).data();
 }
 
 // -----------------------------------------------------------------------------
@@ -185,7 +191,44 @@ MemChunk& ArchiveEntry::data(bool allow_load)
 		setState(State::Unmodified);
 	}
 
-	return data_;
+	// Record access (see ArchiveManager::enforceMemoryBudget)
+	last_access_ = ++data_access_counter;
+
+	return dataChunk();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the entry data MemChunk, creating it if the entry hasn't had any data
+// yet. It isn't created up front since most entries in large archives are
+// never loaded
+// -----------------------------------------------------------------------------
+MemChunk& ArchiveEntry::dataChunk()
+{
+	if (!data_)
+		data_ = std::make_unique<MemChunk>();
+
+	return *data_;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the entry's extra properties, creating them if they don't exist yet.
+// Use exProp<T> or hasExProp to check a property without creating them
+// -----------------------------------------------------------------------------
+PropertyList& ArchiveEntry::exProps()
+{
+	if (!ex_props_)
+		ex_props_ = std::make_unique<PropertyList>();
+
+	return *ex_props_;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the entry's extra properties (an empty list if none were set)
+// -----------------------------------------------------------------------------
+const PropertyList& ArchiveEntry::exProps() const
+{
+	static const PropertyList no_props;
+	return ex_props_ ? *ex_props_ : no_props;
 }
 
 // -----------------------------------------------------------------------------
@@ -224,13 +267,35 @@ int ArchiveEntry::index()
 	return parent_ ? parent_->entryIndex(this) : -1;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a 64-bit hash of the entry's data, for quickly comparing the content
+// of entries. The hash is cached and only recalculated if the data changes
+// -----------------------------------------------------------------------------
+uint64_t ArchiveEntry::contentHash()
+{
+	if (!content_hash_valid_)
+	{
+		const auto& mc      = data();
+		content_hash_       = misc::hash64(mc.data(), mc.size());
+		content_hash_valid_ = true;
+	}
+
+	return content_hash_;
+}
+
 // -----------------------------------------------------------------------------
 // Sets the entry's name (but doesn't change state to modified)
 // -----------------------------------------------------------------------------
 void ArchiveEntry::setName(string_view name)
 {
+	if (parent_)
+		parent_->unindexEntry(this);
+
 	name_       = name;
 	upper_name_ = strutil::upper(name);
+
+	if (parent_)
+		parent_->indexEntry(this);
 }
 
 // -----------------------------------------------------------------------------
@@ -239,6 +304,13 @@ void ArchiveEntry::setName(string_view name)
 // -----------------------------------------------------------------------------
 void ArchiveEntry::setState(State state, bool silent)
 {
+	// Any modification could have changed the data
+	if (state != State::Unmodified)
+	{
+		content_hash_valid_ = false;
+		image_format_       = nullptr;
+	}
+
 	if (state_locked_ || (state == State::Unmodified && state_ == State::Unmodified))
 		return;
 
@@ -259,7 +331,7 @@ void ArchiveEntry::setState(State state, bool silent)
 void ArchiveEntry::unloadData(bool force)
 {
 	// Check there is any data to be 'unloaded'
-	if (!data_.hasData() || !data_loaded_)
+	if (!data_ || !data_->hasData() || !data_loaded_)
 		return;
 
 	// Only unload if the data wasn't modified
@@ -267,7 +339,7 @@ void ArchiveEntry::unloadData(bool force)
 		return;
 
 	// Delete any data
-	data_.clear();
+	data_->clear();
 
 	// Update variables etc
 	setLoaded(false);
@@ -302,6 +374,9 @@ void ArchiveEntry::unlock()
 // -----------------------------------------------------------------------------
 void ArchiveEntry::formatName(const ArchiveFormat& format)
 {
+	if (parent_)
+		parent_->unindexEntry(this);
+
 	// Perform character substitution if needed
 	name_ = misc::fileNameToLumpName(name_);
 
@@ -324,6 +399,9 @@ void ArchiveEntry::formatName(const ArchiveFormat& format)
 
 	// Update uppercase name
 	upper_name_ = strutil::upper(name_);
+
+	if (parent_)
+		parent_->indexEntry(this);
 }
 
 // -----------------------------------------------------------------------------
@@ -368,7 +446,7 @@ bool ArchiveEntry::resize(uint32_t new_size, bool preserve_data)
 	// Update attributes
 	setState(State::Modified);
 
-	return data_.reSize(new_size, preserve_data);
+	return dataChunk().reSize(new_size, preserve_data);
 }
 
 // -----------------------------------------------------------------------------
@@ -384,7 +462,8 @@ void ArchiveEntry::clearData()
 	}
 
 	// Delete the data
-	data_.clear();
+	if (data_)
+		data_->clear();
 
 	// Reset attributes
 	size_        = 0;
@@ -420,7 +499,7 @@ bool ArchiveEntry::importMem(const void* data, uint32_t size)
 	clearData();
 
 	// Copy data into the entry
-	data_.importMem((const uint8_t*)data, size);
+	dataChunk().importMem((const uint8_t*)data, size);
 
 	// Update attributes
 	size_ = size;
@@ -439,13 +518,36 @@ bool ArchiveEntry::importMem(const void* data, uint32_t size)
 bool ArchiveEntry::importMemChunk(MemChunk& mc)
 {
 	// Check that the given MemChunk has data
-	if (mc.hasData())
+	if (!mc.hasData())
+		return false;
+
+	// Check if locked
+	if (locked_)
 	{
-		// Copy the data from the MemChunk into the entry
-		return importMem(mc.data(), mc.size());
+		global::error = "Entry is locked";
+		return false;
 	}
 
-	return false;
+	// Check size
+	if (mc.size() > maxEntrySizeBytes())
+	{
+		global::error = "Over maximum entry size";
+		return false;
+	}
+
+	// Clear any current data
+	clearData();
+
+	// Share the data from the MemChunk (copied only when either is modified)
+	dataChunk().share(mc);
+
+	// Update attributes
+	size_ = mc.size();
+	setLoaded();
+	setType(EntryType::unknownType());
+	setState(State::Modified);
+
+	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -520,10 +622,10 @@ bool ArchiveEntry::importFileStream(wxFile& file, uint32_t len)
 	}
 
 	// Import data from the file stream
-	if (data_.importFileStreamWx(file, len))
+	if (dataChunk().importFileStreamWx(file, len))
 	{
 		// Update attributes
-		size_ = data_.size();
+		size_ = data_->size();
 		setLoaded();
 		setType(EntryType::unknownType());
 		setState(State::Modified);
@@ -552,8 +654,8 @@ bool ArchiveEntry::importEntry(ArchiveEntry* entry)
 	if (!entry)
 		return false;
 
-	// Copy entry data
-	importMem(entry->rawData(), entry->size());
+	// Copy entry data (shared until either entry is modified)
+	importMemChunk(entry->data());
 
 	return true;
 }
@@ -599,10 +701,10 @@ bool ArchiveEntry::write(const void* data, uint32_t size)
 		rawData(true);
 
 	// Perform the write
-	if (data_.write(data, size))
+	if (dataChunk().write(data, size))
 	{
 		// Update attributes
-		size_ = data_.size();
+		size_ = data_->size();
 		setState(State::Modified);
 
 		return true;
@@ -620,7 +722,7 @@ bool ArchiveEntry::read(void* buf, uint32_t size)
 	if (isLoaded())
 		rawData(true);
 
-	return data_.read(buf, size);
+	return dataChunk().read(buf, size);
 }
 
 // -----------------------------------------------------------------------------
@@ -8,6 +8,7 @@ namespace slade
 struct ArchiveFormat;
 class ArchiveDir;
 class Archive;
+class SIFormat;
 
 class ArchiveEntry
 {
@@ -41,18 +42,20 @@ public:
 	string_view              nameNoExt() const;
 	const string&            upperName() const { return upper_name_; }
 	string_view              upperNameNoExt() const;
-	uint32_t                 size() const { return data_loaded_ ? data_.size() : size_; }
+	uint32_t                 size() const { return data_loaded_ ? (data_ ? data_->size() : 0) : size_; }
 	MemChunk&                data(bool allow_load = true);
+	const MemChunk&          constData(bool allow_load = true) { return data(allow_load); }
 	const uint8_t*           rawData(bool allow_load = true);
 	ArchiveDir*              parentDir() const { return parent_; }
 	Archive*                 parent() const;
 	Archive*                 topParent() const;
 	string                   path(bool name = false) const;
 	EntryType*               type() const { return type_; }
-	PropertyList&            exProps() { return ex_props_; }
-	const PropertyList&      exProps() const { return ex_props_; }
-	Property&                exProp(const string& key) { return ex_props_[key]; }
-	template<typename T> T   exProp(const string& key);
+	PropertyList&            exProps();
+	const PropertyList&      exProps() const;
+	Property&                exProp(const string& key) { return exProps()[key]; }
+	template<typename T> T   exProp(const string& key) const;
+	bool                     hasExProp(string_view key) const { return ex_props_ && ex_props_->contains(key); }
 	State                    state() const { return state_; }
 	bool                     isLocked() const { return locked_; }
 	bool                     isLoaded() const { return data_loaded_; }
@@ -61,15 +64,27 @@ public:
 	ArchiveEntry*            prevEntry();
 	shared_ptr<ArchiveEntry> getShared();
 	int                      index();
+	uint64_t                 contentHash();
+	uint64_t                 lastAccess() const { return last_access_; }
+	SIFormat*                imageFormat() const { return image_format_; }
+
+	// Format-specific info (see setOffset etc.)
+	uint32_t offset() const { return offset_; }
+	bool     hasOffset() const { return has_offset_; }
+	int      zipIndex() const { return zip_index_; }
+	bool     hasZipIndex() const { return zip_index_ >= 0; }
+	uint32_t fullSize() const { return full_size_; }
 
 	// Modifiers (won't change entry state, except setState of course :P)
 	void setName(string_view name);
 	void setLoaded(bool loaded = true) { data_loaded_ = loaded; }
 	void setType(EntryType* type, int r = 0)
 	{
-		type_        = type;
-		reliability_ = r;
+		type_         = type;
+		reliability_  = r;
+		image_format_ = nullptr;
 	}
+	void setImageFormat(SIFormat* format) { image_format_ = format; }
 	void setState(State state, bool silent = false);
 	void setEncryption(Encryption enc) { encrypted_ = enc; }
 	void unloadData(bool force = false);
@@ -78,7 +93,14 @@ public:
 	void lockState() { state_locked_ = true; }
 	void unlockState() { state_locked_ = false; }
 	void formatName(const ArchiveFormat& format);
-	void updateSize() { size_ = data_.size(); }
+	void updateSize() { size_ = data_ ? data_->size() : 0; }
+	void setOffset(uint32_t offset)
+	{
+		offset_     = offset;
+		has_offset_ = true;
+	}
+	void setZipIndex(int index) { zip_index_ = index; }
+	void setFullSize(uint32_t size) { full_size_ = size; }
 
 	// Entry modification (will change entry state)
 	bool rename(string_view new_name);
@@ -100,8 +122,8 @@ public:
 	// Data access
 	bool     write(const void* data, uint32_t size);
 	bool     read(void* buf, uint32_t size);
-	bool     seek(uint32_t offset, uint32_t start) { return data_.seek(offset, start); }
-	uint32_t currentPos() const { return data_.currentPos(); }
+	bool     seek(uint32_t offset, uint32_t start) { return dataChunk().seek(offset, start); }
+	uint32_t currentPos() const { return data_ ? data_->currentPos() : 0; }
 
 	// Misc
 	string        sizeString() const;
@@ -109,18 +131,26 @@ public:
 	void          stateChanged();
 	void          setExtensionByType();
 	int           typeReliability() const { return (type_ ? (type()->reliability() * reliability_ / 255) : 0); }
+	int           reliability() const { return reliability_; }
 	bool          isInNamespace(string_view ns);
 	ArchiveEntry* relativeEntry(string_view path, bool allow_absolute_path = true) const;
 
 private:
 	// Entry Info
-	string       name_;
-	string       upper_name_;
-	uint32_t     size_ = 0;
-	MemChunk     data_;
-	EntryType*   type_   = nullptr;
-	ArchiveDir*  parent_ = nullptr;
-	PropertyList ex_props_;
+	string                   name_;
+	string                   upper_name_;
+	uint32_t                 size_ = 0;
+	unique_ptr<MemChunk>     data_; // Created when the entry first has data (see dataChunk)
+	EntryType*               type_   = nullptr;
+	ArchiveDir*              parent_ = nullptr;
+	unique_ptr<PropertyList> ex_props_; // Created when the first property is set
+
+	// Format-specific info, kept out of ex_props_ since almost every entry in
+	// an archive has them
+	uint32_t offset_     = 0;  // Offset of the entry data in the archive file
+	uint32_t full_size_  = 0;  // Uncompressed size, if the entry is compressed in the archive file
+	int      zip_index_  = -1; // Index of the entry in the zip file, -1 if none
+	bool     has_offset_ = false;
 
 	// Entry status
 	State      state_        = State::New;
@@ -130,16 +160,19 @@ private:
 	Encryption encrypted_    = Encryption::None; // Is there some encrypting on the archive?
 
 	// Misc stuff
-	int    reliability_ = 0; // The reliability of the entry's identification
-	size_t index_guess_ = 0; // for speed
+	int       reliability_        = 0;       // The reliability of the entry's identification
+	size_t    index_guess_        = 0;       // for speed
+	uint64_t  content_hash_       = 0;       // Cached hash of the entry data (see contentHash)
+	bool      content_hash_valid_ = false;   // False if the data has changed since content_hash_ was calculated
+	uint64_t  last_access_        = 0;       // Increases each time the data is accessed (for unloading old data)
+	SIFormat* image_format_       = nullptr; // Image format the data was last loaded with (null if data changed)
+
+	MemChunk& dataChunk();
 };
 
-template<typename T> T ArchiveEntry::exProp(const string& key)
+template<typename T> T ArchiveEntry::exProp(const string& key) const
 {
-	if (auto val = std::get_if<T>(&ex_props_[key]))
-		return *val;
-
-	return T{};
+	return ex_props_ ? ex_props_->getOr<T>(key, T{}) : T{};
 }
 
 } // namespace slade
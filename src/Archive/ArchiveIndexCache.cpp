@@ -0,0 +1,261 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ArchiveIndexCache.cpp
+// Description: Persistent on-disk cache of archive entry indexes (entry
+//              locations, sizes and detected types), used to skip reading
+//              and type detection of entries when opening large resource
+//              archives that haven't changed since they were last opened
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ArchiveIndexCache.h"
+#include "App.h"
+#include "EntryType/EntryType.h"
+#include "General/Console.h"
+#include "General/Misc.h"
+#include "Utility/FileUtils.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, archive_index_cache, true, CVar::Flag::Save)
+namespace
+{
+constexpr uint32_t CACHE_MAGIC   = 0x58444953; // 'SIDX'
+constexpr uint32_t CACHE_VERSION = 2;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the path to the directory containing cached archive indexes
+// -----------------------------------------------------------------------------
+string cacheDir()
+{
+	return app::path("index_cache", app::Dir::User);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the path to the cached index file for the archive at [archive_path]
+// -----------------------------------------------------------------------------
+string cacheFilePath(string_view archive_path)
+{
+	auto hash = misc::hash64(reinterpret_cast<const uint8_t*>(archive_path.data()), archive_path.size());
+	return fmt::format("{}/{:016x}.idx", cacheDir(), hash);
+}
+
+// -----------------------------------------------------------------------------
+// Returns a hash of the program version and currently defined entry types.
+// Cached indexes are only valid if this matches, since type detection can
+// change between versions (or if the user adds their own types)
+// -----------------------------------------------------------------------------
+uint64_t entryTypesHash()
+{
+	auto ids = app::version().toString() + '\n';
+	for (auto* type : EntryType::allTypes())
+	{
+		ids += type->id();
+		ids += '\n';
+	}
+
+	return misc::hash64(reinterpret_cast<const uint8_t*>(ids.data()), ids.size());
+}
+
+// -----------------------------------------------------------------------------
+// Writes [str] to [mc] (16-bit length followed by the characters)
+// -----------------------------------------------------------------------------
+void writeString(MemChunk& mc, string_view str)
+{
+	const auto len = static_cast<uint16_t>(std::min<size_t>(str.size(), 0xFFFF));
+	mc.write(&len, 2);
+	mc.write(str.data(), len);
+}
+
+// -----------------------------------------------------------------------------
+// Reads a string written by writeString from [mc] into [str]
+// -----------------------------------------------------------------------------
+bool readString(MemChunk& mc, string& str)
+{
+	uint16_t len;
+	if (!mc.read(&len, 2))
+		return false;
+
+	str.resize(len);
+	return len == 0 || mc.read(str.data(), len);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ArchiveIndexCache Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// Returns true if the archive index cache is enabled
+// -----------------------------------------------------------------------------
+bool archiveindexcache::enabled()
+{
+	return archive_index_cache;
+}
+
+// -----------------------------------------------------------------------------
+// Reads the cached index for the archive at [archive_path] into [entries].
+// Returns false if there is no cached index, or it is out of date (ie. the
+// archive's [file_size] or [file_modified] time differ from when the index
+// was cached)
+// -----------------------------------------------------------------------------
+bool archiveindexcache::read(
+	string_view        archive_path,
+	uint64_t           file_size,
+	time_t             file_modified,
+	vector<EntryInfo>& entries)
+{
+	if (!archive_index_cache)
+		return false;
+
+	auto cache_file = cacheFilePath(archive_path);
+	if (!fileutil::fileExists(cache_file))
+		return false;
+
+	MemChunk mc;
+	if (!mc.importFile(cache_file))
+		return false;
+
+	// Check header
+	uint32_t magic, version, num_entries;
+	uint64_t size;
+	int64_t  modified;
+	uint64_t types_hash;
+	string   path;
+	if (!mc.read(&magic, 4) || !mc.read(&version, 4) || !mc.read(&size, 8) || !mc.read(&modified, 8)
+		|| !mc.read(&types_hash, 8) || !readString(mc, path) || !mc.read(&num_entries, 4))
+		return false;
+	if (magic != CACHE_MAGIC || version != CACHE_VERSION || size != file_size
+		|| modified != static_cast<int64_t>(file_modified) || path != archive_path || types_hash != entryTypesHash()
+		|| num_entries > mc.size())
+		return false;
+
+	// Read entries
+	entries.clear();
+	entries.resize(num_entries);
+	for (auto& info : entries)
+	{
+		if (!readString(mc, info.path) || !readString(mc, info.name) || !mc.read(&info.size, 4)
+			|| !mc.read(&info.location, 4) || !readString(mc, info.type_id) || !mc.read(&info.reliability, 1))
+		{
+			log::warning("Cached index for {} is invalid", archive_path);
+			entries.clear();
+			return false;
+		}
+	}
+
+	log::info(2, "Read cached index for {} ({} entries)", archive_path, num_entries);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes [entries] as the cached index for the archive at [archive_path], with
+// the given [file_size] and [file_modified] time to check against when reading
+// -----------------------------------------------------------------------------
+bool archiveindexcache::write(
+	string_view              archive_path,
+	uint64_t                 file_size,
+	time_t                   file_modified,
+	const vector<EntryInfo>& entries)
+{
+	if (!archive_index_cache)
+		return false;
+
+	if (!fileutil::dirExists(cacheDir()))
+		fileutil::createDir(cacheDir());
+
+	// Write header
+	MemChunk   mc;
+	const auto modified    = static_cast<int64_t>(file_modified);
+	const auto types_hash  = entryTypesHash();
+	const auto num_entries = static_cast<uint32_t>(entries.size());
+	mc.reserve(64 + num_entries * 48);
+	mc.write(&CACHE_MAGIC, 4);
+	mc.write(&CACHE_VERSION, 4);
+	mc.write(&file_size, 8);
+	mc.write(&modified, 8);
+	mc.write(&types_hash, 8);
+	writeString(mc, archive_path);
+	mc.write(&num_entries, 4);
+
+	// Write entries
+	for (const auto& info : entries)
+	{
+		writeString(mc, info.path);
+		writeString(mc, info.name);
+		mc.write(&info.size, 4);
+		mc.write(&info.location, 4);
+		writeString(mc, info.type_id);
+		mc.write(&info.reliability, 1);
+	}
+
+	return mc.exportFile(cacheFilePath(archive_path));
+}
+
+// -----------------------------------------------------------------------------
+// Removes all cached archive indexes
+// -----------------------------------------------------------------------------
+void archiveindexcache::clear()
+{
+	if (fileutil::dirExists(cacheDir()))
+		fileutil::removeDir(cacheDir());
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// Removes all cached archive indexes
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(clear_index_cache, 0, true)
+{
+	archiveindexcache::clear();
+	log::info("Cleared archive index cache");
+}
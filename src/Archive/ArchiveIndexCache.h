@@ -0,0 +1,20 @@
+#pragma once
+
+namespace slade::archiveindexcache
+{
+// Cached info for an entry (or directory, if name is empty) in an archive
+struct EntryInfo
+{
+	string   path;            // Path of the directory containing the entry
+	string   name;            // Entry name (empty for a directory)
+	uint32_t size        = 0; // Entry data size
+	uint32_t location    = 0; // Format-specific location of the entry's data (eg. offset)
+	string   type_id;         // Detected EntryType id
+	uint8_t  reliability = 0; // Detected type reliability
+};
+
+bool enabled();
+bool read(string_view archive_path, uint64_t file_size, time_t file_modified, vector<EntryInfo>& entries);
+bool write(string_view archive_path, uint64_t file_size, time_t file_modified, const vector<EntryInfo>& entries);
+void clear();
+} // namespace slade::archiveindexcache
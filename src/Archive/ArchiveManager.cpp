@@ -52,6 +52,75 @@ using namespace slade;
 CVAR(Int, base_resource, -1, CVar::Flag::Save)
 CVAR(Int, max_recent_files, 25, CVar::Flag::Save)
 CVAR(Bool, auto_open_wads_root, false, CVar::Flag::Save)
+CVAR(Int, archive_memory_budget_mb, 1024, CVar::Flag::Save)
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Creates and returns a new (unopened) archive of the format of the file at
+// [filename], or nullptr if the format is unsupported
+// -----------------------------------------------------------------------------
+shared_ptr<Archive> createArchiveForFile(string_view filename)
+{
+	string std_fn{ filename };
+	if (WadArchive::isWadArchive(std_fn))
+		return std::make_shared<WadArchive>();
+	if (ZipArchive::isZipArchive(std_fn))
+		return std::make_shared<ZipArchive>();
+	if (ResArchive::isResArchive(std_fn))
+		return std::make_shared<ResArchive>();
+	if (DatArchive::isDatArchive(std_fn))
+		return std::make_shared<DatArchive>();
+	if (LibArchive::isLibArchive(std_fn))
+		return std::make_shared<LibArchive>();
+	if (PakArchive::isPakArchive(std_fn))
+		return std::make_shared<PakArchive>();
+	if (BSPArchive::isBSPArchive(std_fn))
+		return std::make_shared<BSPArchive>();
+	if (GrpArchive::isGrpArchive(std_fn))
+		return std::make_shared<GrpArchive>();
+	if (RffArchive::isRffArchive(std_fn))
+		return std::make_shared<RffArchive>();
+	if (GobArchive::isGobArchive(std_fn))
+		return std::make_shared<GobArchive>();
+	if (LfdArchive::isLfdArchive(std_fn))
+		return std::make_shared<LfdArchive>();
+	if (HogArchive::isHogArchive(std_fn))
+		return std::make_shared<HogArchive>();
+	if (ADatArchive::isADatArchive(std_fn))
+		return std::make_shared<ADatArchive>();
+	if (Wad2Archive::isWad2Archive(std_fn))
+		return std::make_shared<Wad2Archive>();
+	if (WadJArchive::isWadJArchive(std_fn))
+		return std::make_shared<WadJArchive>();
+	if (WolfArchive::isWolfArchive(std_fn))
+		return std::make_shared<WolfArchive>();
+	if (GZipArchive::isGZipArchive(std_fn))
+		return std::make_shared<GZipArchive>();
+	if (BZip2Archive::isBZip2Archive(std_fn))
+		return std::make_shared<BZip2Archive>();
+	if (TarArchive::isTarArchive(std_fn))
+		return std::make_shared<TarArchive>();
+	if (DiskArchive::isDiskArchive(std_fn))
+		return std::make_shared<DiskArchive>();
+	if (PodArchive::isPodArchive(std_fn))
+		return std::make_shared<PodArchive>();
+	if (ChasmBinArchive::isChasmBinArchive(std_fn))
+		return std::make_shared<ChasmBinArchive>();
+	if (SiNArchive::isSiNArchive(std_fn))
+		return std::make_shared<SiNArchive>();
+
+	// Unsupported format
+	global::error = "Unsupported or invalid Archive format";
+	return nullptr;
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -143,6 +212,7 @@ bool ArchiveManager::init()
 		dir_slade_pk3 = "slade.pk3";
 
 	// Open slade.pk3
+	program_resource_archive_->setUseIndexCache(true);
 	if (!program_resource_archive_->open(dir_slade_pk3))
 	{
 		log::error("Unable to find slade.pk3!");
@@ -289,59 +359,9 @@ shared_ptr<Archive> ArchiveManager::openArchive(string_view filename, bool manag
 	}
 
 	// Determine file format
-	string std_fn{ filename };
-	if (WadArchive::isWadArchive(std_fn))
-		new_archive = std::make_shared<WadArchive>();
-	else if (ZipArchive::isZipArchive(std_fn))
-		new_archive = std::make_shared<ZipArchive>();
-	else if (ResArchive::isResArchive(std_fn))
-		new_archive = std::make_shared<ResArchive>();
-	else if (DatArchive::isDatArchive(std_fn))
-		new_archive = std::make_shared<DatArchive>();
-	else if (LibArchive::isLibArchive(std_fn))
-		new_archive = std::make_shared<LibArchive>();
-	else if (PakArchive::isPakArchive(std_fn))
-		new_archive = std::make_shared<PakArchive>();
-	else if (BSPArchive::isBSPArchive(std_fn))
-		new_archive = std::make_shared<BSPArchive>();
-	else if (GrpArchive::isGrpArchive(std_fn))
-		new_archive = std::make_shared<GrpArchive>();
-	else if (RffArchive::isRffArchive(std_fn))
-		new_archive = std::make_shared<RffArchive>();
-	else if (GobArchive::isGobArchive(std_fn))
-		new_archive = std::make_shared<GobArchive>();
-	else if (LfdArchive::isLfdArchive(std_fn))
-		new_archive = std::make_shared<LfdArchive>();
-	else if (HogArchive::isHogArchive(std_fn))
-		new_archive = std::make_shared<HogArchive>();
-	else if (ADatArchive::isADatArchive(std_fn))
-		new_archive = std::make_shared<ADatArchive>();
-	else if (Wad2Archive::isWad2Archive(std_fn))
-		new_archive = std::make_shared<Wad2Archive>();
-	else if (WadJArchive::isWadJArchive(std_fn))
-		new_archive = std::make_shared<WadJArchive>();
-	else if (WolfArchive::isWolfArchive(std_fn))
-		new_archive = std::make_shared<WolfArchive>();
-	else if (GZipArchive::isGZipArchive(std_fn))
-		new_archive = std::make_shared<GZipArchive>();
-	else if (BZip2Archive::isBZip2Archive(std_fn))
-		new_archive = std::make_shared<BZip2Archive>();
-	else if (TarArchive::isTarArchive(std_fn))
-		new_archive = std::make_shared<TarArchive>();
-	else if (DiskArchive::isDiskArchive(std_fn))
-		new_archive = std::make_shared<DiskArchive>();
-	else if (PodArchive::isPodArchive(std_fn))
-		new_archive = std::make_shared<PodArchive>();
-	else if (ChasmBinArchive::isChasmBinArchive(std_fn))
-		new_archive = std::make_shared<ChasmBinArchive>();
-	else if (SiNArchive::isSiNArchive(std_fn))
-		new_archive = std::make_shared<SiNArchive>();
-	else
-	{
-		// Unsupported format
-		global::error = "Unsupported or invalid Archive format";
+	new_archive = createArchiveForFile(filename);
+	if (!new_archive)
 		return nullptr;
-	}
 
 	// If it opened successfully, add it to the list if needed & return it,
 	// Otherwise, delete it and return nullptr
@@ -531,6 +551,114 @@ shared_ptr<Archive> ArchiveManager::openDirArchive(string_view dir, bool manage,
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Opens the archive (file or directory) at [filename] on a background thread.
+// Progress is reported via the archive's open_progress signal, and opening can
+// be cancelled via Archive::cancelOpen. When finished, the archive is added to
+// the list (if [manage] is true) and [on_opened] is called (on the main thread)
+// with the opened archive, or nullptr if opening failed or was cancelled.
+//
+// Returns the archive being opened, or nullptr if it couldn't be opened (in
+// which case [on_opened] is not called)
+// -----------------------------------------------------------------------------
+shared_ptr<Archive> ArchiveManager::openArchiveAsync(
+	string_view  filename,
+	OpenCallback on_opened,
+	bool         manage,
+	bool         silent)
+{
+	// If the archive is already open, just return it
+	if (auto archive = getArchive(filename))
+	{
+		if (!silent)
+			signals_.archive_opened(archiveIndex(archive.get()));
+
+		on_opened(archive);
+		return archive;
+	}
+
+	// Check it isn't already being opened
+	for (const auto& pending : pending_opens_)
+		if (pending->filename == filename)
+		{
+			global::error = "Archive is already being opened";
+			return nullptr;
+		}
+
+	// Determine format
+	shared_ptr<Archive> new_archive;
+	if (fileutil::dirExists(filename))
+		new_archive = std::make_shared<DirArchive>();
+	else
+		new_archive = createArchiveForFile(filename);
+	if (!new_archive)
+		return nullptr;
+
+	log::info("Opening archive {} in background", filename);
+
+	auto pending       = std::make_unique<PendingOpen>();
+	pending->archive   = new_archive;
+	pending->filename  = filename;
+	pending->on_opened = std::move(on_opened);
+	pending->manage    = manage;
+	pending->silent    = silent;
+
+	// Open on a worker thread
+	weak_ptr<Archive> wp_archive = new_archive;
+	pending->thread = std::thread(
+		[this, wp_archive, archive = new_archive.get(), path = pending->filename]()
+		{
+			// Send splash progress updates from the archive's open function
+			// to the main thread as open_progress signals
+			string last_message;
+			int    last_progress = -2;
+			ui::setThreadProgressHandler(
+				[&](string_view message, float progress)
+				{
+					// Only send updates if something visibly changed
+					const auto progress_pct = progress < 0.0f ? -1 : static_cast<int>(progress * 100);
+					if (progress_pct == last_progress && message == last_message)
+						return;
+					last_progress = progress_pct;
+					last_message  = message;
+
+					wxTheApp->CallAfter(
+						[wp_archive, message = last_message, progress]()
+						{
+							if (auto archive = wp_archive.lock())
+								archive->signals().open_progress(*archive, message, progress);
+						});
+				});
+
+			const bool success = archive->open(path);
+			ui::setThreadProgressHandler({});
+
+			// global::error is per-thread, so pass this thread's error on
+			wxTheApp->CallAfter(
+				[this, archive, success, error = success ? string{} : global::error]()
+				{ finishOpen(archive, success, error); });
+		});
+
+	pending_opens_.push_back(std::move(pending));
+
+	return new_archive;
+}
+
+// -----------------------------------------------------------------------------
+// Cancels any archives currently being opened in the background, waiting for
+// their threads to finish
+// -----------------------------------------------------------------------------
+void ArchiveManager::cancelPendingOpens()
+{
+	for (auto& pending : pending_opens_)
+		pending->archive->cancelOpen();
+
+	for (auto& pending : pending_opens_)
+		pending->thread.join();
+
+	pending_opens_.clear();
+}
+
 // -----------------------------------------------------------------------------
 // Creates a new archive of the specified format and adds it to the list of open
 // archives. Returns the created archive, or nullptr if an invalid archive type
@@ -675,6 +803,9 @@ bool ArchiveManager::closeArchive(Archive* archive)
 // -----------------------------------------------------------------------------
 void ArchiveManager::closeAll()
 {
+	// Cancel any archives being opened
+	cancelPendingOpens();
+
 	// Close the first archive in the list until no archives are open
 	while (!open_archives_.empty())
 		closeArchive(0);
@@ -912,6 +1043,7 @@ bool ArchiveManager::openBaseResource(int index)
 
 	// Attempt to open the file
 	ui::showSplash(fmt::format("Opening {}...", filename), true);
+	base_resource_archive_->setUseIndexCache(true);
 	if (base_resource_archive_->open(filename))
 	{
 		base_resource = index;
@@ -1298,6 +1430,134 @@ bool slade::ArchiveManager::isBookmarked(ArchiveEntry* entry)
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Called on the main thread when the background open of [archive] has
+// finished. Adds it to the list if it was opened [success]fully and wasn't
+// cancelled, then calls the callback given to openArchiveAsync. If it failed,
+// global::error is set to the [error] from the worker thread first
+// -----------------------------------------------------------------------------
+void ArchiveManager::finishOpen(Archive* archive, bool success, const string& error)
+{
+	// Find the pending open (it won't exist if it was cancelled via cancelPendingOpens)
+	auto it = std::find_if(
+		pending_opens_.begin(),
+		pending_opens_.end(),
+		[archive](const unique_ptr<PendingOpen>& pending) { return pending->archive.get() == archive; });
+	if (it == pending_opens_.end())
+		return;
+
+	auto pending = std::move(*it);
+	pending_opens_.erase(it);
+	pending->thread.join();
+
+	if (!success || archive->openCancelled())
+	{
+		global::error = archive->openCancelled() ? "Opening cancelled" : error;
+		log::error(global::error);
+		pending->on_opened(nullptr);
+		return;
+	}
+
+	if (pending->manage)
+	{
+		// Add the archive
+		auto index = open_archives_.size();
+		addArchive(pending->archive);
+
+		// Announce open
+		if (!pending->silent)
+			signals_.archive_opened(index);
+
+		// Add to recent files
+		addRecentFile(pending->filename);
+	}
+
+	pending->on_opened(pending->archive);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the total size of all currently loaded entry data in [archive]
+// -----------------------------------------------------------------------------
+uint64_t ArchiveManager::residentDataSize(const Archive* archive)
+{
+	uint64_t total = 0;
+	archive->rootDir()->visitEntries(
+		[&total](const ArchiveEntry& entry)
+		{
+			if (entry.isLoaded())
+				total += entry.size();
+		},
+		true,
+		true);
+
+	return total;
+}
+
+// -----------------------------------------------------------------------------
+// Unloads the least recently accessed entry data in all open archives until the
+// total loaded entry data is within the memory budget (archive_memory_budget_mb).
+// Only data that can be reloaded from disk (ie. loaded, unmodified and unlocked
+// entries in archives on disk) is unloaded.
+//
+// This should only be called when entry data isn't currently being used
+// (eg. from an idle event or timer), since references to the unloaded data
+// will become invalid
+// -----------------------------------------------------------------------------
+void ArchiveManager::enforceMemoryBudget()
+{
+	if (archive_memory_budget_mb <= 0)
+		return;
+
+	const auto budget = static_cast<uint64_t>(archive_memory_budget_mb) * 1024 * 1024;
+
+	auto archives = allArchives();
+	if (base_resource_archive_)
+		archives.push_back(base_resource_archive_);
+
+	// Get total loaded data size and all entries that can be unloaded
+	uint64_t              resident = 0;
+	vector<ArchiveEntry*> candidates;
+	for (const auto& archive : archives)
+	{
+		const bool can_reload = archive->isOnDisk() && !archive->parentEntry();
+
+		archive->rootDir()->visitEntries(
+			[&](ArchiveEntry& entry)
+			{
+				if (!entry.isLoaded() || entry.size() == 0)
+					return;
+
+				resident += entry.size();
+				if (can_reload && entry.state() == ArchiveEntry::State::Unmodified && !entry.isLocked())
+					candidates.push_back(&entry);
+			},
+			true,
+			true);
+	}
+
+	if (resident <= budget)
+		return;
+
+	// Unload least recently accessed data first
+	std::sort(
+		candidates.begin(),
+		candidates.end(),
+		[](const ArchiveEntry* left, const ArchiveEntry* right) { return left->lastAccess() < right->lastAccess(); });
+
+	unsigned unloaded = 0;
+	for (auto* entry : candidates)
+	{
+		if (resident <= budget)
+			break;
+
+		resident -= entry->size();
+		entry->unloadData();
+		unloaded++;
+	}
+
+	log::info(2, "Unloaded data for {} entries to stay within the memory budget", unloaded);
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -1320,6 +1580,33 @@ CONSOLE_COMMAND(list_archives, 0, true)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Lists the size of loaded entry data in each open archive
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(list_archive_memory, 0, true)
+{
+	auto& manager = app::archiveManager();
+	auto  mb      = [](uint64_t bytes) { return fmt::format("{:.2f}mb", static_cast<double>(bytes) / (1024 * 1024)); };
+
+	uint64_t total = 0;
+	for (int a = 0; a < manager.numArchives(); a++)
+	{
+		auto       archive  = manager.getArchive(a);
+		const auto resident = ArchiveManager::residentDataSize(archive.get());
+		total += resident;
+		log::info("{}: \"{}\" - {}", a + 1, archive->filename(), mb(resident));
+	}
+
+	if (auto* bra = manager.baseResourceArchive())
+	{
+		const auto resident = ArchiveManager::residentDataSize(bra);
+		total += resident;
+		log::info("Base Resource: \"{}\" - {}", bra->filename(), mb(resident));
+	}
+
+	log::info("Total: {} (budget {}mb)", mb(total), archive_memory_budget_mb.value);
+}
+
 // -----------------------------------------------------------------------------
 // Attempts to open each given argument (filenames)
 // -----------------------------------------------------------------------------
@@ -1,12 +1,15 @@
 #pragma once
 
 #include "Archive.h"
+#include <thread>
 
 namespace slade
 {
 class ArchiveManager
 {
 public:
+	typedef std::function<void(shared_ptr<Archive>)> OpenCallback;
+
 	ArchiveManager()  = default;
 	~ArchiveManager() = default;
 
@@ -21,6 +24,12 @@ public:
 	shared_ptr<Archive>         openArchive(string_view filename, bool manage = true, bool silent = false);
 	shared_ptr<Archive>         openArchive(ArchiveEntry* entry, bool manage = true, bool silent = false);
 	shared_ptr<Archive>         openDirArchive(string_view dir, bool manage = true, bool silent = false);
+	shared_ptr<Archive>         openArchiveAsync(
+						string_view  filename,
+						OpenCallback on_opened,
+						bool         manage = true,
+						bool         silent = false);
+	void                        cancelPendingOpens();
 	shared_ptr<Archive>         newArchive(string_view format);
 	bool                        closeArchive(int index);
 	bool                        closeArchive(string_view filename);
@@ -72,6 +81,10 @@ public:
 	unsigned      numBookmarks() const { return bookmarks_.size(); }
 	bool          isBookmarked(ArchiveEntry* entry);
 
+	// Entry data memory budget
+	void            enforceMemoryBudget();
+	static uint64_t residentDataSize(const Archive* archive);
+
 	// Signals
 	struct Signals
 	{
@@ -99,7 +112,19 @@ private:
 		bool                      resource;
 	};
 
-	vector<OpenArchive>            open_archives_;
+	// An archive being opened on a background thread
+	struct PendingOpen
+	{
+		shared_ptr<Archive> archive;
+		string              filename;
+		OpenCallback        on_opened;
+		bool                manage = true;
+		bool                silent = false;
+		std::thread         thread;
+	};
+
+	vector<OpenArchive>             open_archives_;
+	vector<unique_ptr<PendingOpen>> pending_opens_;
 	unique_ptr<Archive>            program_resource_archive_;
 	shared_ptr<Archive>            base_resource_archive_;
 	bool                           res_archive_open_ = false;
@@ -112,5 +137,6 @@ private:
 
 	bool initArchiveFormats() const;
 	void getDependentArchivesInternal(Archive* archive, vector<shared_ptr<Archive>>& vec);
+	void finishOpen(Archive* archive, bool success, const string& error);
 };
 } // namespace slade
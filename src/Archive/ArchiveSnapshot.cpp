@@ -0,0 +1,144 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ArchiveSnapshot.cpp
+// Description: ArchiveSnapshot class - an immutable view of an archive's
+//              entries that background threads can read while the archive is
+//              being edited
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ArchiveSnapshot.h"
+#include "Archive.h"
+#include "Utility/StringUtils.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns [path] as a key for the snapshot path index
+// -----------------------------------------------------------------------------
+string pathKey(string_view path)
+{
+	return strutil::lower(strutil::startsWith(path, '/') ? path.substr(1) : path);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ArchiveSnapshot Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the snapshot entry at [path], or null if there is none
+// -----------------------------------------------------------------------------
+const ArchiveSnapshot::Entry* ArchiveSnapshot::entryAtPath(string_view path) const
+{
+	auto i = path_index_.find(pathKey(path));
+	return i != path_index_.end() ? &entries_[i->second] : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the live archive entry that snapshot [entry] was created from, if it
+// is unchanged since the snapshot was created (still in the archive with the
+// same path and data). Returns null otherwise.
+// Must only be called from the UI thread
+// -----------------------------------------------------------------------------
+ArchiveEntry* ArchiveSnapshot::liveEntry(const Entry& entry) const
+{
+	auto live = entry.live.lock();
+	if (!live || live->state() == ArchiveEntry::State::Deleted || !live->parent())
+		return nullptr;
+
+	// Check path
+	if (live->path(true) != entry.path)
+		return nullptr;
+
+	// Check data, if the snapshot has it. Live data is copied before it is
+	// modified while the snapshot shares it, so if it's the same data it
+	// can't have changed. Otherwise compare the content (eg. if the live
+	// entry data has been unloaded and reloaded since)
+	if (entry.has_data)
+	{
+		if (live->size() != entry.size)
+			return nullptr;
+
+		const auto& live_data = live->data();
+		if (live_data.data() != entry.data.data()
+			&& (entry.size > 0 && memcmp(live_data.data(), entry.data.data(), entry.size) != 0))
+			return nullptr;
+	}
+
+	return live.get();
+}
+
+// -----------------------------------------------------------------------------
+// Creates a snapshot of all entries in [archive]. If [load_data] is true, any
+// entries that don't currently have their data loaded are loaded first,
+// otherwise their snapshot data will be empty.
+// Must only be called from the UI thread
+// -----------------------------------------------------------------------------
+shared_ptr<const ArchiveSnapshot> ArchiveSnapshot::create(const Archive& archive, bool load_data)
+{
+	auto snapshot        = std::make_shared<ArchiveSnapshot>();
+	snapshot->filename_  = archive.filename();
+	snapshot->format_id_ = archive.formatId();
+
+	vector<shared_ptr<ArchiveEntry>> entries;
+	archive.putEntryTreeAsList(entries);
+	snapshot->entries_.reserve(entries.size());
+	for (const auto& live : entries)
+	{
+		auto& entry = snapshot->entries_.emplace_back();
+		entry.path  = live->path(true);
+		entry.name  = live->name();
+		entry.type  = live->type();
+		entry.size  = live->size();
+		entry.live  = live;
+
+		if (load_data || live->isLoaded())
+		{
+			entry.data.share(live->data(load_data));
+			entry.has_data = true;
+			entry.size     = entry.data.size();
+		}
+
+		snapshot->path_index_.try_emplace(pathKey(entry.path), snapshot->entries_.size() - 1);
+	}
+
+	return snapshot;
+}
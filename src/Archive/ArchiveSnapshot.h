@@ -0,0 +1,53 @@
+#pragma once
+
+namespace slade
+{
+class Archive;
+class ArchiveEntry;
+class EntryType;
+
+// An immutable view of an archive's entries at the time it was created, which
+// can be read from any thread while the archive itself continues to be edited
+// on the UI thread. Entry data is shared with the live entries (see
+// MemChunk::share), so nothing is copied unless a live entry is modified.
+// Results of work done on a snapshot can be reconciled with the live archive
+// afterwards via liveEntry (on the UI thread only)
+class ArchiveSnapshot
+{
+public:
+	struct Entry
+	{
+		string                 path; // Full path (including name) in the archive
+		string                 name;
+		EntryType*             type = nullptr;
+		unsigned               size = 0;
+		MemChunk               data;             // Empty if the data wasn't loaded (see create)
+		bool                   has_data = false; // False if the data wasn't loaded when the snapshot was created
+		weak_ptr<ArchiveEntry> live;
+	};
+
+	ArchiveSnapshot()  = default;
+	~ArchiveSnapshot() = default;
+
+	// Non-copyable
+	ArchiveSnapshot(const ArchiveSnapshot&)            = delete;
+	ArchiveSnapshot& operator=(const ArchiveSnapshot&) = delete;
+
+	const string&        filename() const { return filename_; }
+	const string&        formatId() const { return format_id_; }
+	const vector<Entry>& entries() const { return entries_; }
+	const Entry*         entryAtPath(string_view path) const;
+
+	// Reconciliation (UI thread only)
+	ArchiveEntry* liveEntry(const Entry& entry) const;
+	bool          isCurrent(const Entry& entry) const { return liveEntry(entry) != nullptr; }
+
+	static shared_ptr<const ArchiveSnapshot> create(const Archive& archive, bool load_data = true);
+
+private:
+	string                               filename_;
+	string                               format_id_;
+	vector<Entry>                        entries_;
+	std::unordered_map<string, unsigned> path_index_; // Lowercase path (without leading /) -> entry index
+};
+} // namespace slade
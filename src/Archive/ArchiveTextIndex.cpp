@@ -0,0 +1,645 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ArchiveTextIndex.cpp
+// Description: ArchiveTextIndex class - an inverted trigram index of the text
+//              entries in an archive, for fast archive-wide text searches
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ArchiveTextIndex.h"
+#include "Archive.h"
+#include "EntryType/EntryType.h"
+#include "General/Console.h"
+#include "MainEditor/MainEditor.h"
+#include <regex>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+std::map<Archive*, unique_ptr<ArchiveTextIndex>> archive_indexes;
+constexpr size_t                                 MAX_CONTEXT_LENGTH = 200;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns [c] in lower case (ASCII only)
+// -----------------------------------------------------------------------------
+inline uint8_t foldCase(uint8_t c)
+{
+	return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the (case-folded) trigrams in [text] to [trigrams]
+// -----------------------------------------------------------------------------
+void addTrigrams(string_view text, vector<uint32_t>& trigrams)
+{
+	if (text.size() < 3)
+		return;
+
+	uint32_t trigram = (foldCase(text[0]) << 8) | foldCase(text[1]);
+	for (size_t a = 2; a < text.size(); ++a)
+	{
+		trigram = ((trigram << 8) | foldCase(text[a])) & 0xffffff;
+		trigrams.push_back(trigram);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Sorts [trigrams] and removes duplicates
+// -----------------------------------------------------------------------------
+void sortUnique(vector<uint32_t>& trigrams)
+{
+	std::sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+// -----------------------------------------------------------------------------
+// Returns the sorted, unique trigrams in [data]
+// -----------------------------------------------------------------------------
+vector<uint32_t> dataTrigrams(const MemChunk& data)
+{
+	vector<uint32_t> trigrams;
+	trigrams.reserve(data.size());
+	addTrigrams({ reinterpret_cast<const char*>(data.data()), data.size() }, trigrams);
+	sortUnique(trigrams);
+	return trigrams;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the trigrams of text that any match of regex [pattern] must contain,
+// from the literal runs in the pattern. Returns nothing if no text is
+// required (eg. the pattern has alternatives)
+// -----------------------------------------------------------------------------
+vector<uint32_t> regexTrigrams(string_view pattern)
+{
+	vector<uint32_t> trigrams;
+	string           run;
+	auto             end_run = [&]()
+	{
+		addTrigrams(run, trigrams);
+		run.clear();
+	};
+
+	for (size_t a = 0; a < pattern.size(); ++a)
+	{
+		auto c = pattern[a];
+		switch (c)
+		{
+		// Alternatives, nothing in particular is required
+		case '|': return {};
+
+		// Escape, either a literal character or a character class etc.
+		case '\\':
+			if (a + 1 < pattern.size() && !isalnum(static_cast<unsigned char>(pattern[a + 1])))
+				run += pattern[++a];
+			else
+			{
+				end_run();
+				++a;
+			}
+			break;
+
+		// Character set, skip it
+		case '[':
+			end_run();
+			a = pattern.find(']', a + 2);
+			if (a == string_view::npos)
+				return {};
+			break;
+
+		// Group, skip it (its contents may be optional or alternatives)
+		case '(':
+		{
+			end_run();
+			int depth = 1;
+			while (depth > 0 && ++a < pattern.size())
+			{
+				if (pattern[a] == '\\')
+					++a;
+				else if (pattern[a] == '(')
+					++depth;
+				else if (pattern[a] == ')')
+					--depth;
+			}
+			break;
+		}
+
+		// Optional quantifiers, the previous character isn't required
+		case '*':
+		case '?':
+		case '{':
+			if (!run.empty())
+				run.pop_back();
+			end_run();
+			if (c == '{')
+			{
+				a = pattern.find('}', a);
+				if (a == string_view::npos)
+					return {};
+			}
+			break;
+
+		case '+':
+		case '.':
+		case '^':
+		case '$': end_run(); break;
+
+		default: run += c; break;
+		}
+	}
+	end_run();
+
+	sortUnique(trigrams);
+	return trigrams;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [line] contains [text], ignoring case if [match_case] is
+// false (ASCII only)
+// -----------------------------------------------------------------------------
+bool lineContains(string_view line, string_view text, bool match_case)
+{
+	if (match_case)
+		return line.find(text) != string_view::npos;
+
+	return std::search(
+			   line.begin(),
+			   line.end(),
+			   text.begin(),
+			   text.end(),
+			   [](char a, char b) { return foldCase(a) == foldCase(b); })
+		   != line.end();
+}
+
+// -----------------------------------------------------------------------------
+// Trims whitespace from [line] and limits it to MAX_CONTEXT_LENGTH characters,
+// for the context of a match
+// -----------------------------------------------------------------------------
+string matchContext(string_view line)
+{
+	auto first = line.find_first_not_of(" \t\r");
+	if (first == string_view::npos)
+		return {};
+	auto last = line.find_last_not_of(" \t\r");
+	return string{ line.substr(first, std::min(last - first + 1, MAX_CONTEXT_LENGTH)) };
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ArchiveTextIndex::Build Struct
+//
+// -----------------------------------------------------------------------------
+struct ArchiveTextIndex::Build
+{
+	vector<Doc>                                    docs;
+	vector<MemChunk>                               data; // Shared with each doc's entry (see MemChunk::share)
+	std::map<ArchiveEntry*, unsigned>              doc_index;
+	std::unordered_map<uint32_t, vector<unsigned>> postings;
+	bool                                           complete = false;
+
+	// Builds the index from the entry data. Stops early (leaving the build
+	// incomplete) if [task] is cancelled
+	void run(const tasks::Task* task)
+	{
+		tasks::parallelFor(
+			0, docs.size(), [this](unsigned index) { docs[index].trigrams = dataTrigrams(data[index]); }, 16, task);
+		if (task && task->isCancelled())
+			return;
+
+		data.clear();
+		for (unsigned a = 0; a < docs.size(); ++a)
+		{
+			doc_index[docs[a].entry_ptr] = a;
+			for (auto trigram : docs[a].trigrams)
+				postings[trigram].push_back(a);
+		}
+
+		complete = true;
+	}
+};
+
+
+// -----------------------------------------------------------------------------
+//
+// ArchiveTextIndex Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// ArchiveTextIndex class constructor, begins building the index of [archive]
+// in a background task
+// -----------------------------------------------------------------------------
+ArchiveTextIndex::ArchiveTextIndex(Archive& archive) : archive_{ &archive }
+{
+	// Track entry changes
+	auto& signals = archive.signals();
+	signal_connections_ += signals.entry_added.connect(
+		[this](Archive&, ArchiveEntry& entry) { changed_.push_back(entry.getShared()); });
+	signal_connections_ += signals.entry_state_changed.connect(
+		[this](Archive&, ArchiveEntry& entry) { changed_.push_back(entry.getShared()); });
+	signal_connections_ += signals.entry_removed.connect(
+		[this](Archive&, ArchiveDir&, ArchiveEntry& entry) { removed_.push_back(&entry); });
+	signal_connections_ += signals.entries_changed.connect(
+		[this](Archive&, const Archive::EntryChanges& changes)
+		{
+			for (const auto& removed : changes.removed)
+				removed_.push_back(removed.entry.get());
+			for (const auto& entry : changes.added)
+				changed_.push_back(entry);
+			for (const auto& entry : changes.state_changed)
+				changed_.push_back(entry);
+		});
+
+	// Get text entries to index (sharing their data so it can be read in the
+	// build task)
+	auto build = std::make_shared<Build>();
+	archive.rootDir()->visitEntries(
+		[&build](const shared_ptr<ArchiveEntry>& entry)
+		{
+			if (entry->type()->editor() == "text")
+			{
+				auto& doc     = build->docs.emplace_back();
+				doc.entry     = entry;
+				doc.entry_ptr = entry.get();
+				build->data.emplace_back().share(entry->data());
+			}
+		});
+
+	// Build the index in the background
+	build_      = build;
+	build_task_ = tasks::run([build](const tasks::Task& task) { build->run(&task); });
+}
+
+// -----------------------------------------------------------------------------
+// ArchiveTextIndex class destructor
+// -----------------------------------------------------------------------------
+ArchiveTextIndex::~ArchiveTextIndex()
+{
+	// The build task only holds on to its own state, no need to wait for it
+	build_task_.cancel();
+}
+
+// -----------------------------------------------------------------------------
+// Searches the text entries in the archive for [text] (a regular expression
+// if [regex] is true), ignoring case unless [match_case] is true.
+// Returns each line containing a match (up to [max_matches] if it is non-zero),
+// in entry order
+// -----------------------------------------------------------------------------
+vector<ArchiveTextIndex::Match> ArchiveTextIndex::search(
+	string_view text,
+	bool        match_case,
+	bool        regex,
+	unsigned    max_matches)
+{
+	if (text.empty())
+		return {};
+
+	waitForBuild();
+	applyChanges();
+
+	// Compile regex
+	std::regex re;
+	if (regex)
+	{
+		try
+		{
+			auto flags = std::regex::ECMAScript | std::regex::optimize;
+			if (!match_case)
+				flags |= std::regex::icase;
+			re.assign(text.begin(), text.end(), flags);
+		}
+		catch (const std::regex_error& ex)
+		{
+			log::error("Invalid regular expression \"{}\": {}", text, ex.what());
+			return {};
+		}
+	}
+
+	// Get the entries that contain all the trigrams any match must have
+	vector<uint32_t> trigrams;
+	if (regex)
+		trigrams = regexTrigrams(text);
+	else
+	{
+		addTrigrams(text, trigrams);
+		sortUnique(trigrams);
+	}
+	struct Job
+	{
+		shared_ptr<ArchiveEntry> entry;
+		MemChunk                 data; // Shared with the entry (see MemChunk::share)
+		vector<Match>            matches;
+	};
+	vector<Job> jobs;
+	for (auto doc : candidateDocs(trigrams))
+		if (auto entry = docs_[doc].entry.lock())
+		{
+			auto& job = jobs.emplace_back();
+			job.entry = entry;
+			job.data.share(entry->data());
+		}
+	if (jobs.empty())
+		return {};
+
+	// Find matching lines in each entry, in parallel
+	tasks::parallelFor(
+		0,
+		jobs.size(),
+		[&](unsigned index)
+		{
+			auto&       job = jobs[index];
+			string_view data{ reinterpret_cast<const char*>(job.data.data()), job.data.size() };
+			unsigned    line_no = 1;
+			for (size_t start = 0; start < data.size(); ++line_no)
+			{
+				auto end = data.find('\n', start);
+				if (end == string_view::npos)
+					end = data.size();
+				auto line = data.substr(start, end - start);
+				if (!line.empty() && line.back() == '\r')
+					line.remove_suffix(1);
+
+				if (regex ? std::regex_search(line.begin(), line.end(), re) : lineContains(line, text, match_case))
+					job.matches.push_back({ job.entry, line_no, matchContext(line) });
+
+				start = end + 1;
+			}
+		});
+
+	// Collect matches
+	vector<Match> matches;
+	for (auto& job : jobs)
+		for (auto& match : job.matches)
+		{
+			if (max_matches > 0 && matches.size() >= max_matches)
+				return matches;
+			matches.push_back(std::move(match));
+		}
+
+	return matches;
+}
+
+// -----------------------------------------------------------------------------
+// Waits for the background build of the index to finish and takes the result.
+// The build is finished here if the task didn't complete it (eg. it was
+// dropped when the task scheduler was stopped)
+// -----------------------------------------------------------------------------
+void ArchiveTextIndex::waitForBuild()
+{
+	if (!build_)
+		return;
+
+	build_task_.wait();
+	if (!build_->complete)
+		build_->run(nullptr);
+
+	docs_.swap(build_->docs);
+	doc_index_.swap(build_->doc_index);
+	postings_.swap(build_->postings);
+	build_.reset();
+}
+
+// -----------------------------------------------------------------------------
+// Reindexes any entries that were added, modified or removed since the last
+// search
+// -----------------------------------------------------------------------------
+void ArchiveTextIndex::applyChanges()
+{
+	// Removals first, in case a removed entry was then re-added
+	for (auto* entry : removed_)
+		removeDoc(entry);
+	removed_.clear();
+
+	std::set<ArchiveEntry*> done;
+	for (const auto& weak : changed_)
+	{
+		auto entry = weak.lock();
+		if (!entry || !done.insert(entry.get()).second)
+			continue;
+
+		removeDoc(entry.get());
+		if (entry->parent() == archive_ && entry->type()->editor() == "text")
+			addDoc(entry, dataTrigrams(entry->data()));
+	}
+	changed_.clear();
+
+	// Compact the index once half of it is removed entries
+	if (n_removed_ > 0 && n_removed_ >= docs_.size() / 2)
+	{
+		vector<Doc> docs;
+		for (auto& doc : docs_)
+			if (!doc.removed)
+				docs.push_back(std::move(doc));
+		docs_.swap(docs);
+
+		doc_index_.clear();
+		for (unsigned a = 0; a < docs_.size(); ++a)
+			doc_index_[docs_[a].entry_ptr] = a;
+
+		n_removed_ = 0;
+		rebuildPostings();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds a doc for [entry] to the index, containing [trigrams]
+// -----------------------------------------------------------------------------
+void ArchiveTextIndex::addDoc(const shared_ptr<ArchiveEntry>& entry, vector<uint32_t> trigrams)
+{
+	// New docs always have the highest index, so posting lists stay sorted
+	unsigned index = docs_.size();
+	for (auto trigram : trigrams)
+		postings_[trigram].push_back(index);
+
+	auto& doc     = docs_.emplace_back();
+	doc.entry     = entry;
+	doc.entry_ptr = entry.get();
+	doc.trigrams  = std::move(trigrams);
+
+	doc_index_[entry.get()] = index;
+}
+
+// -----------------------------------------------------------------------------
+// Marks the doc for [entry] as removed (if any)
+// -----------------------------------------------------------------------------
+void ArchiveTextIndex::removeDoc(ArchiveEntry* entry)
+{
+	auto i = doc_index_.find(entry);
+	if (i == doc_index_.end())
+		return;
+
+	auto& doc   = docs_[i->second];
+	doc.removed = true;
+	doc.trigrams.clear();
+	doc.trigrams.shrink_to_fit();
+	doc_index_.erase(i);
+	++n_removed_;
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the trigram posting lists from all docs
+// -----------------------------------------------------------------------------
+void ArchiveTextIndex::rebuildPostings()
+{
+	postings_.clear();
+	for (unsigned a = 0; a < docs_.size(); ++a)
+		for (auto trigram : docs_[a].trigrams)
+			postings_[trigram].push_back(a);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the (non-removed) docs containing all of [trigrams], in order
+// -----------------------------------------------------------------------------
+vector<unsigned> ArchiveTextIndex::candidateDocs(vector<uint32_t> trigrams) const
+{
+	vector<unsigned> docs;
+
+	// No trigrams required, all docs are candidates
+	if (trigrams.empty())
+	{
+		for (unsigned a = 0; a < docs_.size(); ++a)
+			if (!docs_[a].removed)
+				docs.push_back(a);
+		return docs;
+	}
+
+	// Get posting lists, smallest first
+	vector<const vector<unsigned>*> lists;
+	for (auto trigram : trigrams)
+	{
+		auto i = postings_.find(trigram);
+		if (i == postings_.end())
+			return {};
+		lists.push_back(&i->second);
+	}
+	std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+
+	// Intersect them
+	docs = *lists[0];
+	vector<unsigned> intersection;
+	for (unsigned a = 1; a < lists.size() && !docs.empty(); ++a)
+	{
+		intersection.clear();
+		std::set_intersection(
+			docs.begin(), docs.end(), lists[a]->begin(), lists[a]->end(), std::back_inserter(intersection));
+		docs.swap(intersection);
+	}
+
+	docs.erase(
+		std::remove_if(docs.begin(), docs.end(), [this](unsigned doc) { return docs_[doc].removed; }), docs.end());
+
+	return docs;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// ArchiveTextIndex Static Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the text index for [archive], creating it (and beginning to build
+// it in the background) if needed
+// -----------------------------------------------------------------------------
+ArchiveTextIndex& ArchiveTextIndex::forArchive(Archive& archive)
+{
+	auto& index = archive_indexes[&archive];
+	if (!index)
+	{
+		index = std::make_unique<ArchiveTextIndex>(archive);
+
+		// Remove the index when the archive is closed
+		index->signal_connections_ += archive.signals().closed.connect(
+			[](Archive& closed) { archive_indexes.erase(&closed); });
+	}
+
+	return *index;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Lists the lines in text entries of the current archive that contain the
+// given text
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(findtext, 1, true)
+{
+	auto archive = maineditor::currentArchive();
+	if (!archive)
+	{
+		log::console("No archive open");
+		return;
+	}
+
+	// Check for options
+	bool   match_case = false;
+	bool   regex      = false;
+	string text;
+	for (const auto& arg : args)
+	{
+		if (arg == "-case" && text.empty())
+			match_case = true;
+		else if (arg == "-regex" && text.empty())
+			regex = true;
+		else
+			text += text.empty() ? arg : " " + arg;
+	}
+
+	auto matches = ArchiveTextIndex::forArchive(*archive).search(text, match_case, regex, 1000);
+	for (const auto& match : matches)
+		if (auto entry = match.entry.lock())
+			log::console(fmt::format("{}:{}: {}", entry->path(true), match.line, match.context));
+
+	log::console(fmt::format("{} matching line(s) found", matches.size()));
+}
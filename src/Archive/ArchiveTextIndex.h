@@ -0,0 +1,74 @@
+#pragma once
+
+#include "General/Sigslot.h"
+#include "General/Tasks.h"
+
+namespace slade
+{
+class Archive;
+class ArchiveEntry;
+
+// An inverted trigram index of the text entries in an archive, for fast
+// archive-wide text searches. Searches only need to check the entries
+// containing every (case-folded) trigram of the search text.
+//
+// The index is built in a background task when created, and entries
+// modified since then (tracked via the archive's signals) are reindexed
+// before each search
+class ArchiveTextIndex
+{
+public:
+	struct Match
+	{
+		weak_ptr<ArchiveEntry> entry;
+		unsigned               line = 0; // Line number (from 1)
+		string                 context;  // Text of the matching line
+	};
+
+	explicit ArchiveTextIndex(Archive& archive);
+	~ArchiveTextIndex();
+
+	// Non-copyable (owns the build task)
+	ArchiveTextIndex(const ArchiveTextIndex&)            = delete;
+	ArchiveTextIndex& operator=(const ArchiveTextIndex&) = delete;
+
+	bool isReady() const { return !build_ || build_task_.isFinished(); }
+
+	vector<Match> search(string_view text, bool match_case = false, bool regex = false, unsigned max_matches = 0);
+
+	static ArchiveTextIndex& forArchive(Archive& archive);
+
+private:
+	struct Doc
+	{
+		weak_ptr<ArchiveEntry> entry;
+		ArchiveEntry*          entry_ptr = nullptr;
+		vector<uint32_t>       trigrams; // Sorted
+		bool                   removed = false;
+	};
+
+	Archive*                                       archive_;
+	vector<Doc>                                    docs_;
+	std::map<ArchiveEntry*, unsigned>              doc_index_; // Current doc for each entry
+	std::unordered_map<uint32_t, vector<unsigned>> postings_;  // Docs containing each trigram (sorted)
+	unsigned                                       n_removed_ = 0;
+
+	// Building (shared with the build task, which doesn't access the index
+	// itself so it can be cancelled without waiting for it)
+	struct Build;
+	shared_ptr<Build> build_;
+	tasks::Task       build_task_;
+
+	// Changes since the index was built (applied before searching)
+	vector<weak_ptr<ArchiveEntry>> changed_;
+	vector<ArchiveEntry*>          removed_;
+	ScopedConnectionList           signal_connections_;
+
+	void             waitForBuild();
+	void             applyChanges();
+	void             addDoc(const shared_ptr<ArchiveEntry>& entry, vector<uint32_t> trigrams);
+	void             removeDoc(ArchiveEntry* entry);
+	void             rebuildPostings();
+	vector<unsigned> candidateDocs(vector<uint32_t> trigrams) const;
+};
+} // namespace slade
@@ -0,0 +1,297 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    EntryExport.cpp
+// Description: Functions for exporting many entries to files at once, with
+//              data loading, conversion and file writing done in parallel
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "EntryExport.h"
+#include "ArchiveEntry.h"
+#include "General/Tasks.h"
+#include "General/UI.h"
+#include <condition_variable>
+#include <mutex>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Maximum amount of loaded entry data waiting to be converted or written.
+// Loading stops until some of it has been written once this is reached
+constexpr uint64_t MAX_PENDING_BYTES = 256 * 1024 * 1024;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// State of a file in an export, shared between the UI thread and the
+// conversion and writer tasks
+enum class FileState
+{
+	Waiting,    // Data not loaded yet
+	Loaded,     // Data loaded, needs converting
+	Converting, // Being converted
+	Ready,      // Ready to write
+	Failed,     // Conversion failed, skip
+};
+
+// An export in progress
+struct Export
+{
+	vector<entryexport::File>& files;
+	vector<MemChunk>           data;
+	vector<uint64_t>           sizes; // Size of each file's data counted in pending_bytes
+	vector<FileState>          state;
+	uint64_t                   pending_bytes = 0; // Loaded data not yet written
+	unsigned                   n_written     = 0; // Files written (or skipped) so far
+	bool                       ok            = true;
+	bool                       writing       = false; // True once something has started writing the files
+	std::mutex                 mutex;
+	std::condition_variable    cv;
+
+	Export(vector<entryexport::File>& files) :
+		files{ files }, data(files.size()), sizes(files.size(), 0), state(files.size(), FileState::Waiting)
+	{
+	}
+
+	// Sets the state of file [index] to [new_state] and wakes the other threads
+	void setState(unsigned index, FileState new_state)
+	{
+		std::lock_guard lock(mutex);
+		state[index] = new_state;
+		cv.notify_all();
+	}
+
+	// Converts file [index] if it is loaded and nothing else has started
+	// converting it yet
+	void convert(unsigned index)
+	{
+		{
+			std::lock_guard lock(mutex);
+			if (state[index] != FileState::Loaded)
+				return;
+			state[index] = FileState::Converting;
+		}
+
+		setState(index, files[index].convert(data[index]) ? FileState::Ready : FileState::Failed);
+	}
+};
+
+// -----------------------------------------------------------------------------
+// Returns true if [left] should be written before [right]: files are grouped
+// by directory, and in name order within each directory
+// -----------------------------------------------------------------------------
+bool writeOrder(const entryexport::File& left, const entryexport::File& right)
+{
+	auto left_slash  = left.path.find_last_of("/\\");
+	auto right_slash = right.path.find_last_of("/\\");
+	auto left_dir    = string_view{ left.path }.substr(0, left_slash == string::npos ? 0 : left_slash);
+	auto right_dir   = string_view{ right.path }.substr(0, right_slash == string::npos ? 0 : right_slash);
+
+	if (left_dir != right_dir)
+		return left_dir < right_dir;
+
+	return left.path < right.path;
+}
+
+// -----------------------------------------------------------------------------
+// Writes [data] to a file at [path]. An empty file is written if there is no
+// data (as ArchiveEntry::exportFile does)
+// -----------------------------------------------------------------------------
+bool writeFile(const string& path, const MemChunk& data)
+{
+	wxFile file(wxString::FromUTF8(path), wxFile::write);
+	if (!file.IsOpened())
+	{
+		log::error("Unable to open file {} for writing", path);
+		return false;
+	}
+
+	if (data.hasData())
+		file.Write(data.data(), data.size());
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the files in [exp] in order as they become ready. Does nothing if
+// something else has already started writing them.
+// Any loaded file that no conversion task has picked up yet is converted here
+// rather than waiting for it, so this never waits on queued tasks
+// -----------------------------------------------------------------------------
+void writeFiles(Export& exp)
+{
+	{
+		std::lock_guard lock(exp.mutex);
+		if (exp.writing)
+			return;
+		exp.writing = true;
+	}
+
+	for (unsigned index = 0; index < exp.files.size(); ++index)
+	{
+		// Wait for the file to be loaded (and converted)
+		FileState state;
+		while (true)
+		{
+			{
+				std::unique_lock lock(exp.mutex);
+				exp.cv.wait(lock, [&] { return exp.state[index] != FileState::Waiting; });
+				state = exp.state[index];
+			}
+
+			if (state == FileState::Loaded)
+				exp.convert(index);
+			else if (state == FileState::Converting)
+			{
+				std::unique_lock lock(exp.mutex);
+				exp.cv.wait(lock, [&] { return exp.state[index] != FileState::Converting; });
+			}
+			else
+				break;
+		}
+
+		bool ok = state == FileState::Ready && writeFile(exp.files[index].path, exp.data[index]);
+
+		// Release the data
+		exp.data[index].clear();
+
+		std::lock_guard lock(exp.mutex);
+		exp.pending_bytes -= exp.sizes[index];
+		exp.n_written++;
+		exp.ok = exp.ok && ok;
+		exp.cv.notify_all();
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// EntryExport Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Exports all [files], showing progress in the splash window with [message].
+// The files are sorted into the order they will be written in (grouped by
+// directory), and any directories they are in must already exist.
+// Must be called from the UI thread, and doesn't return until all files have
+// been written. Returns false if any file couldn't be converted or written
+// -----------------------------------------------------------------------------
+bool entryexport::exportFiles(vector<File>& files, string_view message)
+{
+	if (files.empty())
+		return true;
+
+	std::stable_sort(files.begin(), files.end(), writeOrder);
+
+	ui::showSplash(message, true);
+
+	// Start writing files as they become ready. The export state is shared
+	// with the conversion and writer tasks, which may still be finishing up
+	// (or not have started at all) after the last file has been written
+	auto  exp_shared = std::make_shared<Export>(files);
+	auto& exp        = *exp_shared;
+	auto  writer     = tasks::run([exp_shared](const tasks::Task&) { writeFiles(*exp_shared); }, tasks::Priority::High);
+
+	// Updates the splash window progress (while waiting, if [wait] is true)
+	auto n_files         = static_cast<float>(files.size());
+	auto update_progress = [&](std::unique_lock<std::mutex>& lock, bool wait)
+	{
+		if (wait)
+			exp.cv.wait_for(lock, std::chrono::milliseconds(50));
+
+		auto n_written = exp.n_written;
+		lock.unlock();
+		ui::setSplashProgressMessage(fmt::format("{} of {}", n_written, files.size()));
+		ui::setSplashProgress(static_cast<float>(n_written) / n_files);
+		lock.lock();
+	};
+
+	// Load entry data in order, passing it to the conversion tasks if needed
+	// (or straight to the writer if not)
+	auto convert_here = tasks::numWorkers() == 0;
+	for (unsigned index = 0; index < files.size(); ++index)
+	{
+		auto& file = files[index];
+		auto  size = file.entry->size();
+
+		// Wait for some data to be written if there is too much pending (and
+		// the writer has started, otherwise it could be a while)
+		{
+			std::unique_lock lock(exp.mutex);
+			while (exp.writing && exp.pending_bytes > 0 && exp.pending_bytes + size > MAX_PENDING_BYTES)
+				update_progress(lock, true);
+			exp.pending_bytes += size;
+			exp.sizes[index] = size;
+			if (index % 64 == 0)
+				update_progress(lock, false);
+		}
+
+		exp.data[index].share(file.entry->data());
+
+		if (!file.convert)
+			exp.setState(index, FileState::Ready);
+		else
+		{
+			exp.setState(index, FileState::Loaded);
+			if (convert_here)
+				exp.convert(index);
+			else
+				tasks::run([exp_shared, index](const tasks::Task&) { exp_shared->convert(index); });
+		}
+	}
+
+	// Write the files here if the writer task hasn't started yet (it will do
+	// nothing if it does start later), then wait for everything to be written
+	writer.cancel();
+	writeFiles(exp);
+	{
+		std::unique_lock lock(exp.mutex);
+		while (exp.n_written < files.size())
+			update_progress(lock, true);
+	}
+
+	ui::hideSplash();
+
+	return exp.ok;
+}
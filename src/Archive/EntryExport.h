@@ -0,0 +1,27 @@
+#pragma once
+
+namespace slade
+{
+class ArchiveEntry;
+
+// Bulk export of entries to files on disk. Entry data is loaded on the UI
+// thread (archives can't be accessed from other threads), converted (if
+// needed) by tasks and written in order by a separate writer task, so all
+// three stages overlap
+namespace entryexport
+{
+	// A file to write [entry]'s data to. If [convert] is given it is called
+	// on the data (a shared copy of the entry's data) from a worker thread
+	// before it is written, and can replace it. It must not access any
+	// entry, archive or other UI thread state, and should return false (and
+	// log an error) if the conversion failed
+	struct File
+	{
+		ArchiveEntry*                  entry = nullptr;
+		string                         path;
+		std::function<bool(MemChunk&)> convert;
+	};
+
+	bool exportFiles(vector<File>& files, string_view message = "Exporting Entries...");
+} // namespace entryexport
+} // namespace slade
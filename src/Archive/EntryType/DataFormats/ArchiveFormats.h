@@ -3,19 +3,19 @@
 class WadDataFormat : public EntryDataFormat
 {
 public:
-	WadDataFormat() : EntryDataFormat("archive_wad") {}
+	WadDataFormat() : EntryDataFormat("archive_wad", { "IWAD", "PWAD" }) {}
 	~WadDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return WadArchive::isWadArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return WadArchive::isWadArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class ZipDataFormat : public EntryDataFormat
 {
 public:
-	ZipDataFormat() : EntryDataFormat("archive_zip") {}
+	ZipDataFormat() : EntryDataFormat("archive_zip", { "PK\x03\x04", "PK\x05\x06" }) {}
 	~ZipDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return ZipArchive::isZipArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return ZipArchive::isZipArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class LibDataFormat : public EntryDataFormat
@@ -24,7 +24,7 @@ public:
 	LibDataFormat() : EntryDataFormat("archive_lib") {}
 	~LibDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return LibArchive::isLibArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return LibArchive::isLibArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class DatDataFormat : public EntryDataFormat
@@ -33,7 +33,7 @@ public:
 	DatDataFormat() : EntryDataFormat("archive_dat") {}
 	~DatDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return DatArchive::isDatArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return DatArchive::isDatArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class ResDataFormat : public EntryDataFormat
@@ -42,16 +42,16 @@ public:
 	ResDataFormat() : EntryDataFormat("archive_res") {}
 	~ResDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return ResArchive::isResArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return ResArchive::isResArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class PakDataFormat : public EntryDataFormat
 {
 public:
-	PakDataFormat() : EntryDataFormat("archive_pak") {}
+	PakDataFormat() : EntryDataFormat("archive_pak", { "PACK" }) {}
 	~PakDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return PakArchive::isPakArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return PakArchive::isPakArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class BSPDataFormat : public EntryDataFormat
@@ -60,16 +60,16 @@ public:
 	BSPDataFormat() : EntryDataFormat("archive_bsp") {}
 	~BSPDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return BSPArchive::isBSPArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return BSPArchive::isBSPArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class Wad2DataFormat : public EntryDataFormat
 {
 public:
-	Wad2DataFormat() : EntryDataFormat("archive_wad2") {}
+	Wad2DataFormat() : EntryDataFormat("archive_wad2", { "WAD2", "WAD3" }) {}
 	~Wad2DataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return Wad2Archive::isWad2Archive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return Wad2Archive::isWad2Archive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class WadJDataFormat : public EntryDataFormat
@@ -78,43 +78,43 @@ public:
 	WadJDataFormat() : EntryDataFormat("archive_wadj") {}
 	~WadJDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return WadJArchive::isWadJArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return WadJArchive::isWadJArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class GrpDataFormat : public EntryDataFormat
 {
 public:
-	GrpDataFormat() : EntryDataFormat("archive_grp") {}
+	GrpDataFormat() : EntryDataFormat("archive_grp", { "KenSilverman" }) {}
 	~GrpDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return GrpArchive::isGrpArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return GrpArchive::isGrpArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class RffDataFormat : public EntryDataFormat
 {
 public:
-	RffDataFormat() : EntryDataFormat("archive_rff") {}
+	RffDataFormat() : EntryDataFormat("archive_rff", { "RFF\x1A" }) {}
 	~RffDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return RffArchive::isRffArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return RffArchive::isRffArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class GobDataFormat : public EntryDataFormat
 {
 public:
-	GobDataFormat() : EntryDataFormat("archive_gob") {}
+	GobDataFormat() : EntryDataFormat("archive_gob", { "GOB\x0A" }) {}
 	~GobDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return GobArchive::isGobArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return GobArchive::isGobArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class LfdDataFormat : public EntryDataFormat
 {
 public:
-	LfdDataFormat() : EntryDataFormat("archive_lfd") {}
+	LfdDataFormat() : EntryDataFormat("archive_lfd", { "RMAP" }) {}
 	~LfdDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return LfdArchive::isLfdArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return LfdArchive::isLfdArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class ADatDataFormat : public EntryDataFormat
@@ -123,7 +123,7 @@ public:
 	ADatDataFormat() : EntryDataFormat("archive_adat") {}
 	~ADatDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return ADatArchive::isADatArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return ADatArchive::isADatArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class HogDataFormat : public EntryDataFormat
@@ -132,7 +132,7 @@ public:
 	HogDataFormat() : EntryDataFormat("archive_hog") {}
 	~HogDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return HogArchive::isHogArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return HogArchive::isHogArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class WolfDataFormat : public EntryDataFormat
@@ -141,7 +141,7 @@ public:
 	WolfDataFormat() : EntryDataFormat("archive_wolf") {}
 	~WolfDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return WolfArchive::isWolfArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return WolfArchive::isWolfArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class GZipDataFormat : public EntryDataFormat
@@ -150,7 +150,7 @@ public:
 	GZipDataFormat() : EntryDataFormat("archive_gzip") {}
 	~GZipDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return GZipArchive::isGZipArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return GZipArchive::isGZipArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class BZip2DataFormat : public EntryDataFormat
@@ -159,7 +159,10 @@ public:
 	BZip2DataFormat() : EntryDataFormat("archive_bz2") {}
 	~BZip2DataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return BZip2Archive::isBZip2Archive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override
+	{
+		return BZip2Archive::isBZip2Archive(mc) ? MATCH_TRUE : MATCH_FALSE;
+	}
 };
 
 class TarDataFormat : public EntryDataFormat
@@ -168,7 +171,7 @@ public:
 	TarDataFormat() : EntryDataFormat("archive_tar") {}
 	~TarDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return TarArchive::isTarArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return TarArchive::isTarArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class DiskDataFormat : public EntryDataFormat
@@ -177,7 +180,7 @@ public:
 	DiskDataFormat() : EntryDataFormat("archive_disk") {}
 	~DiskDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return PakArchive::isPakArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return PakArchive::isPakArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class PodArchiveDataFormat : public EntryDataFormat
@@ -186,7 +189,10 @@ public:
 	PodArchiveDataFormat() : EntryDataFormat("archive_pod") {}
 	~PodArchiveDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return PodArchive::isPodArchive(mc) ? MATCH_PROBABLY : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override
+	{
+		return PodArchive::isPodArchive(mc) ? MATCH_PROBABLY : MATCH_FALSE;
+	}
 };
 
 class ChasmBinArchiveDataFormat : public EntryDataFormat
@@ -194,7 +200,7 @@ class ChasmBinArchiveDataFormat : public EntryDataFormat
 public:
 	ChasmBinArchiveDataFormat() : EntryDataFormat("archive_chasm_bin") {}
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		return ChasmBinArchive::isChasmBinArchive(mc) ? MATCH_TRUE : MATCH_FALSE;
 	}
@@ -205,5 +211,5 @@ class SinArchiveDataFormat : public EntryDataFormat
 public:
 	SinArchiveDataFormat() : EntryDataFormat("archive_sin") {}
 
-	int isThisFormat(MemChunk& mc) override { return SiNArchive::isSiNArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return SiNArchive::isSiNArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
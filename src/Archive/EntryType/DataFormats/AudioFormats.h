@@ -6,10 +6,10 @@
 class MUSDataFormat : public EntryDataFormat
 {
 public:
-	MUSDataFormat() : EntryDataFormat("midi_mus") {}
+	MUSDataFormat() : EntryDataFormat("midi_mus", { "MUS\x1A" }) {}
 	~MUSDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 16)
@@ -26,10 +26,10 @@ public:
 class MIDIDataFormat : public EntryDataFormat
 {
 public:
-	MIDIDataFormat() : EntryDataFormat("midi_smf") {}
+	MIDIDataFormat() : EntryDataFormat("midi_smf", { "MThd" }) {}
 	~MIDIDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 16)
@@ -46,10 +46,10 @@ public:
 class XMIDataFormat : public EntryDataFormat
 {
 public:
-	XMIDataFormat() : EntryDataFormat("midi_xmi") {}
+	XMIDataFormat() : EntryDataFormat("midi_xmi", { "FORM" }) {}
 	~XMIDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 50)
@@ -71,10 +71,10 @@ public:
 class HMIDataFormat : public EntryDataFormat
 {
 public:
-	HMIDataFormat() : EntryDataFormat("midi_hmi") {}
+	HMIDataFormat() : EntryDataFormat("midi_hmi", { "HMI-MIDI" }) {}
 	~HMIDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 50)
@@ -92,10 +92,10 @@ public:
 class HMPDataFormat : public EntryDataFormat
 {
 public:
-	HMPDataFormat() : EntryDataFormat("midi_hmp") {}
+	HMPDataFormat() : EntryDataFormat("midi_hmp", { "HMIMIDIP" }) {}
 	~HMPDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 50)
@@ -113,10 +113,10 @@ public:
 class GMIDDataFormat : public EntryDataFormat
 {
 public:
-	GMIDDataFormat() : EntryDataFormat("midi_gmid") {}
+	GMIDDataFormat() : EntryDataFormat("midi_gmid", { "MIDI", "GMD ", "ADL ", "ROL " }) {}
 	~GMIDDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 8)
@@ -137,10 +137,10 @@ public:
 class RMIDDataFormat : public EntryDataFormat
 {
 public:
-	RMIDDataFormat() : EntryDataFormat("midi_rmid") {}
+	RMIDDataFormat() : EntryDataFormat("midi_rmid", { "RIFF" }) {}
 	~RMIDDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 36)
@@ -160,10 +160,10 @@ public:
 class ITModuleDataFormat : public EntryDataFormat
 {
 public:
-	ITModuleDataFormat() : EntryDataFormat("mod_it") {}
+	ITModuleDataFormat() : EntryDataFormat("mod_it", { "IMPM" }) {}
 	~ITModuleDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 32)
@@ -183,7 +183,7 @@ public:
 	XMModuleDataFormat() : EntryDataFormat("mod_xm") {}
 	~XMModuleDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 80)
@@ -213,7 +213,7 @@ public:
 	S3MModuleDataFormat() : EntryDataFormat("mod_s3m") {}
 	~S3MModuleDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 60)
@@ -233,7 +233,7 @@ public:
 	MODModuleDataFormat() : EntryDataFormat("mod_mod") {}
 	~MODModuleDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 1084)
@@ -259,10 +259,10 @@ public:
 class OKTModuleDataFormat : public EntryDataFormat
 {
 public:
-	OKTModuleDataFormat() : EntryDataFormat("mod_okt") {}
+	OKTModuleDataFormat() : EntryDataFormat("mod_okt", { "OKTASONGCMOD" }) {}
 	~OKTModuleDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 1360)
@@ -283,10 +283,10 @@ public:
 class IMFDataFormat : public EntryDataFormat
 {
 public:
-	IMFDataFormat() : EntryDataFormat("opl_imf") {}
+	IMFDataFormat() : EntryDataFormat("opl_imf", { "ADLIB\x01" }) {}
 	~IMFDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 13)
@@ -308,7 +308,7 @@ public:
 	IMFRawDataFormat() : EntryDataFormat("opl_imf_raw") {}
 	~IMFRawDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		// Check size
@@ -368,10 +368,10 @@ public:
 class DRODataFormat : public EntryDataFormat
 {
 public:
-	DRODataFormat() : EntryDataFormat("opl_dro") {}
+	DRODataFormat() : EntryDataFormat("opl_dro", { "DBRAWOPL" }) {}
 	~DRODataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 20)
@@ -393,10 +393,10 @@ public:
 class RAWDataFormat : public EntryDataFormat
 {
 public:
-	RAWDataFormat() : EntryDataFormat("opl_raw") {}
+	RAWDataFormat() : EntryDataFormat("opl_raw", { "RAWADATA" }) {}
 	~RAWDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 10)
@@ -418,7 +418,7 @@ public:
 	DoomSoundDataFormat() : EntryDataFormat("snd_doom") {}
 	~DoomSoundDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 8)
@@ -426,10 +426,9 @@ public:
 			// Check header
 			uint16_t head, samplerate;
 			uint32_t samples;
-			mc.seek(0, SEEK_SET);
-			mc.read(&head, 2);
-			mc.read(&samplerate, 2);
-			mc.read(&samples, 4);
+			mc.read(0, &head, 2);
+			mc.read(2, &samplerate, 2);
+			mc.read(4, &samples, 4);
 
 			if (head == 3 && samples <= (mc.size() - 8) && samples > 4 && samplerate >= 8000)
 				return MATCH_TRUE;
@@ -445,7 +444,7 @@ public:
 	DoomMacSoundDataFormat() : EntryDataFormat("snd_doom_mac") {}
 	~DoomMacSoundDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 8)
@@ -453,10 +452,9 @@ public:
 			// Check header
 			uint16_t head, samplerate;
 			uint32_t samples;
-			mc.seek(0, SEEK_SET);
-			mc.read(&head, 2);
-			mc.read(&samplerate, 2);
-			mc.read(&samples, 4);
+			mc.read(0, &head, 2);
+			mc.read(2, &samplerate, 2);
+			mc.read(4, &samples, 4);
 
 			head    = wxUINT16_SWAP_ON_BE(head);
 			samples = wxUINT32_SWAP_ON_BE(samples);
@@ -475,7 +473,7 @@ public:
 	JaguarDoomSoundDataFormat() : EntryDataFormat("snd_jaguar") {}
 	~JaguarDoomSoundDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 28)
@@ -505,7 +503,7 @@ public:
 	DoomPCSpeakerDataFormat() : EntryDataFormat("snd_speaker") {}
 	~DoomPCSpeakerDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -537,7 +535,7 @@ public:
 #define WAVE_FMT_MP3 0x0055
 #define WAVE_FMT_XTNSBL 0xFFFE
 
-int RiffWavFormat(MemChunk& mc)
+int RiffWavFormat(const MemChunk& mc)
 {
 	// Check size
 	size_t size   = mc.size();
@@ -586,7 +584,7 @@ public:
 	WAVDataFormat() : EntryDataFormat("snd_wav") {}
 	~WAVDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		int fmt = RiffWavFormat(mc);
 		if (fmt == WAVE_FMT_UNK || fmt == WAVE_FMT_MP3)
@@ -600,10 +598,10 @@ public:
 class OggDataFormat : public EntryDataFormat
 {
 public:
-	OggDataFormat() : EntryDataFormat("snd_ogg") {}
+	OggDataFormat() : EntryDataFormat("snd_ogg", { "OggS" }) {}
 	~OggDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 40)
@@ -625,10 +623,10 @@ public:
 class FLACDataFormat : public EntryDataFormat
 {
 public:
-	FLACDataFormat() : EntryDataFormat("snd_flac") {}
+	FLACDataFormat() : EntryDataFormat("snd_flac", { "fLaC" }) {}
 	~FLACDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -649,7 +647,7 @@ public:
 
 	// This function was written using the following page as reference:
 	// http://mpgedit.org/mpgedit/mpeg_format/mpeghdr.htm
-	static int validMPEG(MemChunk& mc, uint8_t layer, size_t start)
+	static int validMPEG(const MemChunk& mc, uint8_t layer, size_t start)
 	{
 		// Check size
 		if (mc.size() > 4 + start)
@@ -682,7 +680,7 @@ public:
 		return MATCH_FALSE;
 	}
 
-	int isThisFormat(MemChunk& mc) override { return validMPEG(mc, 2, audio::checkForTags(mc)); }
+	int isThisFormat(const MemChunk& mc) override { return validMPEG(mc, 2, audio::checkForTags(mc)); }
 };
 
 class MP3DataFormat : public EntryDataFormat
@@ -691,7 +689,7 @@ public:
 	MP3DataFormat() : EntryDataFormat("snd_mp3") {}
 	~MP3DataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// MP3 data might be contained in RIFF-WAV files.
 		// Officially, they are legit .WAV files, just using MP3 instead of PCM.
@@ -711,7 +709,7 @@ public:
 	VocDataFormat() : EntryDataFormat("snd_voc") {}
 	~VocDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 26)
@@ -740,7 +738,7 @@ public:
 	WolfSoundDataFormat() : EntryDataFormat("snd_wolf") {}
 	~WolfSoundDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return (mc.size() > 0 ? MATCH_MAYBE : MATCH_FALSE); }
+	int isThisFormat(const MemChunk& mc) override { return (mc.size() > 0 ? MATCH_MAYBE : MATCH_FALSE); }
 };
 
 class AudioTPCSoundDataFormat : public EntryDataFormat
@@ -749,7 +747,7 @@ public:
 	AudioTPCSoundDataFormat() : EntryDataFormat("snd_audiot") {}
 	~AudioTPCSoundDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size > 8)
@@ -776,7 +774,7 @@ public:
 	AudioTAdlibSoundDataFormat() : EntryDataFormat("opl_audiot") {}
 	~AudioTAdlibSoundDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size > 24 && size < 1024)
@@ -807,7 +805,7 @@ public:
 	BloodSFXDataFormat() : EntryDataFormat("snd_bloodsfx") {}
 	~BloodSFXDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size, must be between 22 and 29 included
 		if (mc.size() > 21 && mc.size() < 30)
@@ -837,7 +835,7 @@ public:
 	SunSoundDataFormat() : EntryDataFormat("snd_sun") {}
 	~SunSoundDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 32)
@@ -871,7 +869,7 @@ public:
 	AIFFSoundDataFormat() : EntryDataFormat("snd_aiff") {}
 	~AIFFSoundDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 50)
@@ -925,7 +923,7 @@ public:
 	AYDataFormat() : EntryDataFormat("gme_ay") {}
 	~AYDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 20)
@@ -944,7 +942,7 @@ public:
 	GBSDataFormat() : EntryDataFormat("gme_gbs") {}
 	~GBSDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 112)
@@ -963,7 +961,7 @@ public:
 	GYMDataFormat() : EntryDataFormat("gme_gym") {}
 	~GYMDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 428)
@@ -982,7 +980,7 @@ public:
 	HESDataFormat() : EntryDataFormat("gme_hes") {}
 	~HESDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 32)
@@ -1001,7 +999,7 @@ public:
 	KSSDataFormat() : EntryDataFormat("gme_kss") {}
 	~KSSDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 16)
@@ -1021,7 +1019,7 @@ public:
 	NSFDataFormat() : EntryDataFormat("gme_nsf") {}
 	~NSFDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 128)
@@ -1040,7 +1038,7 @@ public:
 	NSFEDataFormat() : EntryDataFormat("gme_nsfe") {}
 	~NSFEDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 5)
@@ -1059,7 +1057,7 @@ public:
 	SAPDataFormat() : EntryDataFormat("gme_sap") {}
 	~SAPDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 16)
@@ -1079,7 +1077,7 @@ public:
 	SPCDataFormat() : EntryDataFormat("gme_spc") {}
 	~SPCDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 256)
@@ -1098,7 +1096,7 @@ public:
 	VGMDataFormat() : EntryDataFormat("gme_vgm") {}
 	~VGMDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 64)
@@ -1117,7 +1115,7 @@ public:
 	VGZDataFormat() : EntryDataFormat("gme_vgz") {}
 	~VGZDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 64)
@@ -1125,9 +1123,11 @@ public:
 			// Check for GZip header first
 			if (mc.readB32(0) == 0x1F8B0800)
 			{
-				// Extract, then check for vgm signature
-				MemChunk tmp;
-				if (compression::gzipInflate(mc, tmp) && tmp.size() > 64 && memcmp(tmp.data(), "Vgm ", 4) == 0)
+				// Extract (from a shared view, since inflating moves the
+				// read cursor), then check for vgm signature
+				MemChunk in, tmp;
+				in.share(mc);
+				if (compression::gzipInflate(in, tmp) && tmp.size() > 64 && memcmp(tmp.data(), "Vgm ", 4) == 0)
 					return MATCH_TRUE;
 			}
 		}
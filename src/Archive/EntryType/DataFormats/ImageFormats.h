@@ -1,14 +1,15 @@
 #pragma once
 
 #include "Graphics/GameFormats.h"
+#include "Graphics/SImage/DoomPatch.h"
 
 class PNGDataFormat : public EntryDataFormat
 {
 public:
-	PNGDataFormat() : EntryDataFormat("img_png") {}
+	PNGDataFormat() : EntryDataFormat("img_png", { "\x89PNG\r\n\x1A\n" }) {}
 	~PNGDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 8)
@@ -26,10 +27,10 @@ public:
 class BMPDataFormat : public EntryDataFormat
 {
 public:
-	BMPDataFormat() : EntryDataFormat("img_bmp"){};
+	BMPDataFormat() : EntryDataFormat("img_bmp", { "BM" }){};
 	~BMPDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 30)
@@ -58,10 +59,10 @@ public:
 class GIFDataFormat : public EntryDataFormat
 {
 public:
-	GIFDataFormat() : EntryDataFormat("img_gif"){};
+	GIFDataFormat() : EntryDataFormat("img_gif", { "GIF8" }){};
 	~GIFDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 6)
@@ -79,10 +80,10 @@ public:
 class PCXDataFormat : public EntryDataFormat
 {
 public:
-	PCXDataFormat() : EntryDataFormat("img_pcx"){};
+	PCXDataFormat() : EntryDataFormat("img_pcx", { "\x0A" }){};
 	~PCXDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() < 129)
@@ -156,7 +157,7 @@ public:
 	TGADataFormat() : EntryDataFormat("img_tga"){};
 	~TGADataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Size check for the header
 		if (mc.size() < 18)
@@ -201,10 +202,10 @@ public:
 class TIFFDataFormat : public EntryDataFormat
 {
 public:
-	TIFFDataFormat() : EntryDataFormat("img_tiff"){};
+	TIFFDataFormat() : EntryDataFormat("img_tiff", { "II", "MM" }){};
 	~TIFFDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size, minimum size is 26 if I'm not mistaken:
 		// 8 for the image header, +2 for at least one image
@@ -244,10 +245,10 @@ public:
 class JPEGDataFormat : public EntryDataFormat
 {
 public:
-	JPEGDataFormat() : EntryDataFormat("img_jpeg"){};
+	JPEGDataFormat() : EntryDataFormat("img_jpeg", { "\xFF\xD8\xFF" }){};
 	~JPEGDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 128)
@@ -270,10 +271,10 @@ public:
 class ILBMDataFormat : public EntryDataFormat
 {
 public:
-	ILBMDataFormat() : EntryDataFormat("img_ilbm"){};
+	ILBMDataFormat() : EntryDataFormat("img_ilbm", { "FORM" }){};
 	~ILBMDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 48)
@@ -300,10 +301,10 @@ public:
 class WebPDataFormat : public EntryDataFormat
 {
 public:
-	WebPDataFormat() : EntryDataFormat("img_webp") {}
+	WebPDataFormat() : EntryDataFormat("img_webp", { "RIFF" }) {}
 	~WebPDataFormat() override = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() < 12)
 			return MATCH_FALSE;
@@ -330,47 +331,27 @@ public:
 	DoomGfxDataFormat() : EntryDataFormat("img_doom"){};
 	~DoomGfxDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
-		const uint8_t* data = mc.data();
-
-		// Check size
-		if (mc.size() > sizeof(gfx::PatchHeader))
-		{
-			const gfx::PatchHeader* header = (const gfx::PatchHeader*)data;
-
-			// Check header values are 'sane'
-			if (header->height > 0 && header->height < 4096 && header->width > 0 && header->width < 4096
-				&& header->top > -2000 && header->top < 2000 && header->left > -2000 && header->left < 2000)
-			{
-				uint32_t* col_offsets = (uint32_t*)((const uint8_t*)data + sizeof(gfx::PatchHeader));
-
-				// Check there is room for needed column pointers
-				if (mc.size() < sizeof(gfx::PatchHeader) + (header->width * sizeof(uint32_t)))
-					return MATCH_FALSE;
-
-				// Check column pointers are within range
-				for (int a = 0; a < header->width; a++)
-				{
-					if (col_offsets[a] > mc.size() || col_offsets[a] < sizeof(gfx::PatchHeader))
-						return MATCH_FALSE;
-				}
+		// Read and check header and column offsets
+		doompatch::Layout layout;
+		if (!doompatch::readLayout(mc, doompatch::Version::Doom, layout))
+			return MATCH_FALSE;
 
-				// Check if total size is reasonable; this computation corresponds to the most inefficient
-				// possible use of space by the format (horizontal stripes of 1 pixel, 1 pixel apart).
-				int numpixels  = (header->height + 2 + header->height % 2) / 2;
-				int maxcolsize = sizeof(uint32_t) + (numpixels * 5) + 1;
-				if (mc.size() > (sizeof(gfx::PatchHeader) + (header->width * maxcolsize)))
-				{
-					return MATCH_UNLIKELY; // This may still be good anyway
-				}
+		// Check header values are 'sane'
+		if (layout.height >= 4096 || layout.width >= 4096 || layout.offset_y <= -2000 || layout.offset_y >= 2000
+			|| layout.offset_x <= -2000 || layout.offset_x >= 2000)
+			return MATCH_FALSE;
 
-				// Passed all checks, so probably is doom gfx
-				return MATCH_TRUE;
-			}
-		}
+		// Check if total size is reasonable; this computation corresponds to the most inefficient
+		// possible use of space by the format (horizontal stripes of 1 pixel, 1 pixel apart).
+		int numpixels  = (layout.height + 2 + layout.height % 2) / 2;
+		int maxcolsize = sizeof(uint32_t) + (numpixels * 5) + 1;
+		if (mc.size() > (sizeof(gfx::PatchHeader) + (layout.width * maxcolsize)))
+			return MATCH_UNLIKELY; // This may still be good anyway
 
-		return MATCH_FALSE;
+		// Passed all checks, so probably is doom gfx
+		return MATCH_TRUE;
 	}
 };
 
@@ -380,53 +361,26 @@ public:
 	DoomGfxAlphaDataFormat() : EntryDataFormat("img_doom_alpha"){};
 	~DoomGfxAlphaDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
-		// Check size
-		if (mc.size() > sizeof(gfx::OldPatchHeader))
-		{
-			// Check that it ends on a FF byte
-			if (mc[mc.size() - 1] != 0xFF)
-				return MATCH_FALSE;
-
-			const gfx::OldPatchHeader* header = (const gfx::OldPatchHeader*)mc.data();
-
-			// Check header values are 'sane'
-			if (header->width > 0 && header->height > 0)
-			{
-				// Check there is room for needed column pointers
-				if (mc.size() < sizeof(gfx::OldPatchHeader) + (header->width * sizeof(uint16_t)))
-					return MATCH_FALSE;
-
-				uint16_t col_offsets[255]; // Old format headers do not allow dimensions greater than 255.
-				for (uint16_t a = 0; a < header->width; a++)
-				{
-					col_offsets[a] = mc.readL16((sizeof(gfx::OldPatchHeader) + a * sizeof(uint16_t)));
-				}
-
-
-				// Check column pointers are within range
-				for (int a = 0; a < header->width; a++)
-				{
-					if (col_offsets[a] > mc.size() || col_offsets[a] < sizeof(gfx::OldPatchHeader))
-						return MATCH_FALSE;
-				}
+		// Check that it ends on a FF byte
+		if (mc.size() <= sizeof(gfx::OldPatchHeader) || mc[mc.size() - 1] != 0xFF)
+			return MATCH_FALSE;
 
-				// Check if total size is reasonable; this computation corresponds to the most inefficient
-				// possible use of space by the format (horizontal stripes of 1 pixel, 1 pixel apart).
-				int numpixels  = (header->height + 2 + header->height % 2) / 2;
-				int maxcolsize = sizeof(uint16_t) + (numpixels * 3) + 1;
-				if (mc.size() > (sizeof(gfx::OldPatchHeader) + (header->width * maxcolsize)))
-				{
-					return MATCH_FALSE;
-				}
+		// Read and check header and column offsets
+		doompatch::Layout layout;
+		if (!doompatch::readLayout(mc, doompatch::Version::Alpha, layout))
+			return MATCH_FALSE;
 
-				// Passed all checks, so probably is doom gfx
-				return MATCH_TRUE;
-			}
-		}
+		// Check if total size is reasonable; this computation corresponds to the most inefficient
+		// possible use of space by the format (horizontal stripes of 1 pixel, 1 pixel apart).
+		int numpixels  = (layout.height + 2 + layout.height % 2) / 2;
+		int maxcolsize = sizeof(uint16_t) + (numpixels * 3) + 1;
+		if (mc.size() > (sizeof(gfx::OldPatchHeader) + (layout.width * maxcolsize)))
+			return MATCH_FALSE;
 
-		return MATCH_FALSE;
+		// Passed all checks, so probably is doom gfx
+		return MATCH_TRUE;
 	}
 };
 
@@ -436,14 +390,12 @@ public:
 	DoomGfxBetaDataFormat() : EntryDataFormat("img_doom_beta"){};
 	~DoomGfxBetaDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() <= sizeof(gfx::PatchHeader))
 			return MATCH_FALSE;
 
-		const uint8_t* data = mc.data();
-
 		// Check that it ends on a FF byte.
 		if (mc[mc.size() - 1] != 0xFF)
 		{
@@ -459,39 +411,25 @@ public:
 			}
 		}
 
-		const gfx::PatchHeader* header = (const gfx::PatchHeader*)data;
+		// Read and check header and column offsets
+		doompatch::Layout layout;
+		if (!doompatch::readLayout(mc, doompatch::Version::Beta, layout))
+			return MATCH_FALSE;
 
 		// Check header values are 'sane'
-		if (header->height > 0 && header->height < 256 && header->width > 0 && header->width < 384 && header->top > -200
-			&& header->top < 200 && header->left > -200 && header->left < 200)
-		{
-			uint16_t* col_offsets = (uint16_t*)((const uint8_t*)data + sizeof(gfx::PatchHeader));
-
-			// Check there is room for needed column pointers
-			if (mc.size() < sizeof(gfx::PatchHeader) + (header->width * sizeof(uint16_t)))
-				return MATCH_FALSE;
-
-			// Check column pointers are within range
-			for (int a = 0; a < header->width; a++)
-			{
-				if (col_offsets[a] > mc.size() || col_offsets[a] < sizeof(gfx::PatchHeader))
-					return MATCH_FALSE;
-			}
-
-			// Check if total size is reasonable; this computation corresponds to the most inefficient
-			// possible use of space by the format (horizontal stripes of 1 pixel, 1 pixel apart).
-			int numpixels  = (header->height + 2 + header->height % 2) / 2;
-			int maxcolsize = sizeof(uint16_t) + (numpixels * 3) + 1;
-			if (mc.size() > (sizeof(gfx::PatchHeader) + (header->width * maxcolsize)))
-			{
-				return MATCH_FALSE;
-			}
+		if (layout.height >= 256 || layout.width >= 384 || layout.offset_y <= -200 || layout.offset_y >= 200
+			|| layout.offset_x <= -200 || layout.offset_x >= 200)
+			return MATCH_FALSE;
 
-			// Passed all checks, so probably is doom gfx
-			return MATCH_TRUE;
-		}
+		// Check if total size is reasonable; this computation corresponds to the most inefficient
+		// possible use of space by the format (horizontal stripes of 1 pixel, 1 pixel apart).
+		int numpixels  = (layout.height + 2 + layout.height % 2) / 2;
+		int maxcolsize = sizeof(uint16_t) + (numpixels * 3) + 1;
+		if (mc.size() > (sizeof(gfx::PatchHeader) + (layout.width * maxcolsize)))
+			return MATCH_FALSE;
 
-		return MATCH_FALSE;
+		// Passed all checks, so probably is doom gfx
+		return MATCH_TRUE;
 	}
 };
 
@@ -512,7 +450,7 @@ public:
 	 *	next WxH bytes contain the bitmap for columns 1, 5, 9,
 	 *	etc., and so on. No transparency.
 	 */
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() < 6)
@@ -545,7 +483,7 @@ public:
 	 * To be honest, I'm not actually sure there are offset fields
 	 * since those values always seem to be set to 0, but hey.
 	 */
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() < sizeof(gfx::PatchHeader))
 			return MATCH_FALSE;
@@ -574,7 +512,7 @@ public:
 		colmajor(colmajor){};
 	~DoomJaguarDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() < sizeof(gfx::JagPicHeader))
 			return MATCH_FALSE;
@@ -623,7 +561,7 @@ public:
 	/* This format is used in the Jaguar Doom IWAD. It can be recognized by the fact the last 320 bytes are a copy of
 	 * the first.
 	 */
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		// Smallest pic size 832 (32x16), largest pic size 33088 (256x128)
@@ -650,7 +588,7 @@ public:
 
 	/* This format is used in the Jaguar Doom IWAD. It is an annoying format.
 	 */
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 16)
@@ -689,7 +627,7 @@ public:
 	DoomPSXDataFormat() : EntryDataFormat("img_doom_psx"){};
 	~DoomPSXDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() < sizeof(gfx::PSXPicHeader))
 			return MATCH_FALSE;
@@ -714,10 +652,10 @@ public:
 class IMGZDataFormat : public EntryDataFormat
 {
 public:
-	IMGZDataFormat() : EntryDataFormat("img_imgz"){};
+	IMGZDataFormat() : EntryDataFormat("img_imgz", { "IMGZ" }){};
 	~IMGZDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// A format created by Randy Heit and used by some crosshairs in ZDoom.
 		uint32_t size = mc.size();
@@ -754,7 +692,7 @@ public:
 
 	// A data format found while rifling through some Legacy mods,
 	// specifically High Tech Hell 2. It seems to be how it works.
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		uint32_t size = mc.size();
 		if (size < 9)
@@ -776,11 +714,11 @@ public:
 class QuakeSpriteDataFormat : public EntryDataFormat
 {
 public:
-	QuakeSpriteDataFormat() : EntryDataFormat("img_qspr"){};
+	QuakeSpriteDataFormat() : EntryDataFormat("img_qspr", { "IDSP" }){};
 	~QuakeSpriteDataFormat() = default;
 
 	// A Quake sprite can contain several frames and each frame may contain several pictures.
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		uint32_t size = mc.size();
 		// Minimum size for a sprite with a single frame containing a single 2x2 picture
@@ -854,7 +792,7 @@ public:
 	QuakeTexDataFormat() : EntryDataFormat("img_quaketex"){};
 	~QuakeTexDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 125)
@@ -880,7 +818,7 @@ public:
 	QuakeIIWalDataFormat() : EntryDataFormat("img_quake2wal"){};
 	~QuakeIIWalDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 101)
@@ -924,7 +862,7 @@ public:
 	ShadowCasterGfxFormat() : EntryDataFormat("img_scgfx"){};
 	~ShadowCasterGfxFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// If those were static functions, then I could
 		// just do this instead of such copypasta:
@@ -954,7 +892,7 @@ public:
 	ShadowCasterSpriteFormat() : EntryDataFormat("img_scsprite"){};
 	~ShadowCasterSpriteFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		int size = mc.size();
 		if (size < 4)
@@ -1009,7 +947,7 @@ public:
 	ShadowCasterWallFormat() : EntryDataFormat("img_scwall"){};
 	~ShadowCasterWallFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		int size = mc.size();
 		// Minimum valid size for such a picture to be
@@ -1026,7 +964,7 @@ public:
 	AnaMipImageFormat() : EntryDataFormat("img_mipimage"){};
 	~AnaMipImageFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 4)
@@ -1046,7 +984,7 @@ public:
 	BuildTileFormat() : EntryDataFormat("img_arttile"){};
 	~BuildTileFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 16)
@@ -1085,10 +1023,10 @@ public:
 class Heretic2M8Format : public EntryDataFormat
 {
 public:
-	Heretic2M8Format() : EntryDataFormat("img_m8"){};
+	Heretic2M8Format() : EntryDataFormat("img_m8", { string_view{ "\x02\0\0\0", 4 } }){};
 	~Heretic2M8Format() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 1040)
@@ -1117,10 +1055,10 @@ public:
 class Heretic2M32Format : public EntryDataFormat
 {
 public:
-	Heretic2M32Format() : EntryDataFormat("img_m32"){};
+	Heretic2M32Format() : EntryDataFormat("img_m32", { string_view{ "\x04\0\0\0", 4 } }){};
 	~Heretic2M32Format() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 1040)
@@ -1152,7 +1090,7 @@ public:
 	HalfLifeTextureFormat() : EntryDataFormat("img_hlt"){};
 	~HalfLifeTextureFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 812)
@@ -1187,7 +1125,7 @@ public:
 	RottGfxDataFormat() : EntryDataFormat("img_rott"){};
 	~RottGfxDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		const uint8_t* data = mc.data();
 
@@ -1237,7 +1175,7 @@ public:
 	RottTransGfxDataFormat() : EntryDataFormat("img_rottmask"){};
 	~RottTransGfxDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		const uint8_t* data = mc.data();
 
@@ -1288,7 +1226,7 @@ public:
 	RottLBMDataFormat() : EntryDataFormat("img_rottlbm"){};
 	~RottLBMDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		const uint8_t* data = mc.data();
 
@@ -1314,7 +1252,7 @@ public:
 	/* How many format does ROTT need? This is just like the raw data plus header
 	 * format from the Doom alpha, except that it's column-major instead of row-major.
 	 */
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() < sizeof(gfx::PatchHeader))
 			return MATCH_FALSE;
@@ -1342,7 +1280,7 @@ public:
 	~RottPicDataFormat() = default;
 
 	// Yet another ROTT image format. Cheesus.
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 8)
@@ -1362,7 +1300,7 @@ public:
 	~WolfPicDataFormat() = default;
 
 	// Wolf picture format
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 4)
@@ -1381,7 +1319,7 @@ public:
 	~WolfSpriteDataFormat() = default;
 
 	// Wolf picture format
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 8 || size > 4228)
@@ -1401,7 +1339,7 @@ public:
 	~JediBMFormat() = default;
 
 	// Jedi engine bitmap format
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size > 32)
@@ -1428,7 +1366,7 @@ public:
 	~JediFMEFormat() = default;
 
 	// Jedi engine frame format
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size > 64)
@@ -1481,7 +1419,7 @@ public:
 	~JediWAXFormat() = default;
 
 	// Jedi engine wax format
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size > 460)
@@ -1515,7 +1453,7 @@ public:
 	Font0DataFormat() : EntryDataFormat("font_doom_alpha"){};
 	~Font0DataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() <= 0x302)
 			return MATCH_FALSE;
@@ -1547,7 +1485,7 @@ public:
 	Font1DataFormat() : EntryDataFormat("font_zd_console"){};
 	~Font1DataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -1566,7 +1504,7 @@ public:
 	Font2DataFormat() : EntryDataFormat("font_zd_big"){};
 	~Font2DataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -1585,7 +1523,7 @@ public:
 	BMFontDataFormat() : EntryDataFormat("font_bmf"){};
 	~BMFontDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -1604,7 +1542,7 @@ public:
 	FontWolfDataFormat() : EntryDataFormat("font_wolf"){};
 	~FontWolfDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() <= 0x302)
 			return MATCH_FALSE;
@@ -1637,7 +1575,7 @@ public:
 	~JediFNTFormat() = default;
 
 	// Jedi engine fnt format
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size > 35)
@@ -1665,7 +1603,7 @@ public:
 	~JediFONTFormat() = default;
 
 	// Jedi engine font format
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size > 16)
@@ -6,7 +6,7 @@ public:
 	TextureXDataFormat() : EntryDataFormat("texturex") {}
 	~TextureXDataFormat() override = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() < 4)
@@ -29,7 +29,7 @@ public:
 	PNamesDataFormat() : EntryDataFormat("pnames") {}
 	~PNamesDataFormat() override = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// It's a pretty simple format alright
 		uint32_t number = mc.readL32(0);
@@ -47,7 +47,7 @@ public:
 	BoomAnimatedDataFormat() : EntryDataFormat("animated") {}
 	~BoomAnimatedDataFormat() override = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() > sizeof(AnimatedEntry))
 		{
@@ -71,7 +71,7 @@ public:
 	BoomSwitchesDataFormat() : EntryDataFormat("switches") {}
 	~BoomSwitchesDataFormat() override = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() > sizeof(SwitchesEntry))
 		{
@@ -91,7 +91,7 @@ public:
 	ZNodesDataFormat() : EntryDataFormat("znod") {}
 	~ZNodesDataFormat() override = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -107,10 +107,10 @@ public:
 class ZGLNodesDataFormat : public EntryDataFormat
 {
 public:
-	ZGLNodesDataFormat() : EntryDataFormat("zgln") {}
+	ZGLNodesDataFormat() : EntryDataFormat("zgln", { "ZGLN" }) {}
 	~ZGLNodesDataFormat() override = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -126,10 +126,10 @@ public:
 class ZGLNodes2DataFormat : public EntryDataFormat
 {
 public:
-	ZGLNodes2DataFormat() : EntryDataFormat("zgl2") {}
+	ZGLNodes2DataFormat() : EntryDataFormat("zgl2", { "ZGL2" }) {}
 	~ZGLNodes2DataFormat() override = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -145,10 +145,10 @@ public:
 class XNodesDataFormat : public EntryDataFormat
 {
 public:
-	XNodesDataFormat() : EntryDataFormat("xnod") {}
+	XNodesDataFormat() : EntryDataFormat("xnod", { "XGLN" }) {}
 	~XNodesDataFormat() override = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -164,10 +164,10 @@ public:
 class XGLNodesDataFormat : public EntryDataFormat
 {
 public:
-	XGLNodesDataFormat() : EntryDataFormat("xgln") {}
+	XGLNodesDataFormat() : EntryDataFormat("xgln", { "XGLN" }) {}
 	~XGLNodesDataFormat() override = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -183,10 +183,10 @@ public:
 class XGLNodes2DataFormat : public EntryDataFormat
 {
 public:
-	XGLNodes2DataFormat() : EntryDataFormat("xgl2") {}
+	XGLNodes2DataFormat() : EntryDataFormat("xgl2", { "XGL2" }) {}
 	~XGLNodes2DataFormat() override = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -202,10 +202,10 @@ public:
 class XGLNodes3DataFormat : public EntryDataFormat
 {
 public:
-	XGLNodes3DataFormat() : EntryDataFormat("xgl3") {}
+	XGLNodes3DataFormat() : EntryDataFormat("xgl3", { "XGL3" }) {}
 	~XGLNodes3DataFormat() override = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -221,10 +221,10 @@ public:
 class ACS0DataFormat : public EntryDataFormat
 {
 public:
-	ACS0DataFormat() : EntryDataFormat("acs0") {}
+	ACS0DataFormat() : EntryDataFormat("acs0", { "ACS" }) {}
 	~ACS0DataFormat() override = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 15)
@@ -250,10 +250,10 @@ public:
 class ACSeDataFormat : public EntryDataFormat
 {
 public:
-	ACSeDataFormat() : EntryDataFormat("acsl") {}
+	ACSeDataFormat() : EntryDataFormat("acsl", { "ACS" }) {}
 	~ACSeDataFormat() override = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 32)
@@ -287,10 +287,10 @@ public:
 class ACSEDataFormat : public EntryDataFormat
 {
 public:
-	ACSEDataFormat() : EntryDataFormat("acse") {}
+	ACSEDataFormat() : EntryDataFormat("acse", { "ACS" }) {}
 	~ACSEDataFormat() override = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 32)
@@ -3,10 +3,10 @@
 class RLE0DataFormat : public EntryDataFormat
 {
 public:
-	RLE0DataFormat() : EntryDataFormat("misc_rle0") {}
+	RLE0DataFormat() : EntryDataFormat("misc_rle0", { "RLE0" }) {}
 	~RLE0DataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 6)
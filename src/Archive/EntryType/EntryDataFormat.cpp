@@ -93,11 +93,28 @@ EntryDataFormat* registerDataFormat(string_view id)
 // To be overridden by specific data types, returns true if the data in [mc]
 // matches the data format
 // -----------------------------------------------------------------------------
-int EntryDataFormat::isThisFormat(MemChunk& mc)
+int EntryDataFormat::isThisFormat(const MemChunk& mc)
 {
 	return MATCH_TRUE;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the data in [mc] begins with one of the format's magic
+// signatures (or the format doesn't define any). This is a quick check that
+// can be done before the (potentially much slower) isThisFormat
+// -----------------------------------------------------------------------------
+bool EntryDataFormat::matchesMagic(const MemChunk& mc) const
+{
+	if (magic_.empty())
+		return true;
+
+	for (const auto& magic : magic_)
+		if (mc.size() >= magic.size() && memcmp(mc.data(), magic.data(), magic.size()) == 0)
+			return true;
+
+	return false;
+}
+
 // -----------------------------------------------------------------------------
 // Copies data format properties to [target]
 // -----------------------------------------------------------------------------
@@ -181,7 +198,7 @@ public:
 	AnyDataFormat() : EntryDataFormat("any") {}
 	~AnyDataFormat() override = default;
 
-	int isThisFormat(MemChunk& mc) override { return MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return MATCH_FALSE; }
 };
 
 // Format enumeration moved to separate files
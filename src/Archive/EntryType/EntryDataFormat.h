@@ -12,12 +12,19 @@ public:
 	static const int MATCH_PROBABLY = 192;
 	static const int MATCH_TRUE     = 255;
 
-	EntryDataFormat(string_view id) : id_{ id } {}
+	EntryDataFormat(string_view id, const vector<string_view>& magic = {}) : id_{ id }
+	{
+		for (auto m : magic)
+			magic_.emplace_back(m);
+	}
 	virtual ~EntryDataFormat() = default;
 
-	const string& id() const { return id_; }
+	const string&         id() const { return id_; }
+	const vector<string>& magic() const { return magic_; }
+
+	bool matchesMagic(const MemChunk& mc) const;
 
-	virtual int isThisFormat(MemChunk& mc);
+	virtual int isThisFormat(const MemChunk& mc);
 	void        copyToFormat(EntryDataFormat& target) const;
 
 	static void             initBuiltinFormats();
@@ -27,7 +34,8 @@ public:
 	static EntryDataFormat* textFormat();
 
 private:
-	string id_;
+	string         id_;
+	vector<string> magic_; // Data of this format must begin with one of these (any data if empty)
 
 	// Struct to specify an inclusive range for a byte (min <= valid <= max)
 	// If max == min, only 1 valid value
@@ -35,6 +35,8 @@
 #include "Archive/ArchiveManager.h"
 #include "Archive/Formats/ZipArchive.h"
 #include "General/Console.h"
+#include "General/Tasks.h"
+#include "General/Trace.h"
 #include "MainEditor/MainEditor.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
@@ -58,6 +60,13 @@ EntryType* etype_unknown = nullptr; // The default, 'unknown' entry type
 EntryType* etype_folder  = nullptr; // Folder entry type
 EntryType* etype_marker  = nullptr; // Marker entry type
 EntryType* etype_map     = nullptr; // Map marker type
+
+// Detection candidates, indexed by the first byte of entry data. Each list
+// contains (in priority order) the detectable types that could possibly match
+// data beginning with that byte, considering the magic signatures of their data
+// formats
+vector<EntryType*> detection_candidates[256];
+vector<EntryType*> detection_candidates_all; // All detectable types
 } // namespace
 
 
@@ -182,27 +191,6 @@ int EntryType::isThisType(ArchiveEntry& entry) const
 			return EntryDataFormat::MATCH_FALSE;
 	}
 
-	// Check for data format match if needed
-	int r = EntryDataFormat::MATCH_TRUE;
-	if (format_ == EntryDataFormat::textFormat())
-	{
-		// Hack for identifying ACS script sources despite DB2 apparently appending
-		// two null bytes to them, which make the memchr test fail.
-		size_t end = entry.size() - 1;
-		if (end > 3)
-			end -= 2;
-		// Text is a special case, as other data formats can sometimes be detected as 'text',
-		// we'll only check for it if text data is specified in the entry type
-		if (entry.size() > 0 && memchr(entry.rawData(), 0, end) != nullptr)
-			return EntryDataFormat::MATCH_FALSE;
-	}
-	else if (format_ != EntryDataFormat::anyFormat() && entry.size() > 0)
-	{
-		r = format_->isThisFormat(entry.data());
-		if (r == EntryDataFormat::MATCH_FALSE)
-			return EntryDataFormat::MATCH_FALSE;
-	}
-
 	// Check for size multiple match if needed
 	if (!size_multiple_.empty())
 	{
@@ -284,6 +272,31 @@ int EntryType::isThisType(ArchiveEntry& entry) const
 		}
 	}
 
+	// Check for data format match if needed (done after the checks above as it
+	// can be comparatively slow)
+	int r = EntryDataFormat::MATCH_TRUE;
+	if (format_ == EntryDataFormat::textFormat())
+	{
+		// Hack for identifying ACS script sources despite DB2 apparently appending
+		// two null bytes to them, which make the memchr test fail.
+		size_t end = entry.size() - 1;
+		if (end > 3)
+			end -= 2;
+		// Text is a special case, as other data formats can sometimes be detected as 'text',
+		// we'll only check for it if text data is specified in the entry type
+		if (entry.size() > 0 && memchr(entry.rawData(), 0, end) != nullptr)
+			return EntryDataFormat::MATCH_FALSE;
+	}
+	else if (format_ != EntryDataFormat::anyFormat() && entry.size() > 0)
+	{
+		if (!format_->matchesMagic(entry.data()))
+			return EntryDataFormat::MATCH_FALSE;
+
+		r = format_->isThisFormat(entry.data());
+		if (r == EntryDataFormat::MATCH_FALSE)
+			return EntryDataFormat::MATCH_FALSE;
+	}
+
 	// Check for entry section match if needed
 	if (!section_.empty())
 	{
@@ -352,6 +365,8 @@ void slade::EntryType::initTypes()
 	etype_map           = et_map.get();
 	etype_map->index_   = static_cast<int>(entry_types.size());
 	entry_types.push_back(std::move(et_map));
+
+	updateDetectionIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -522,6 +537,8 @@ bool EntryType::readEntryTypeDefinitions(string_view definitions, string_view so
 		entry_types.push_back(std::move(ntype));
 	}
 
+	updateDetectionIndex();
+
 	return true;
 }
 
@@ -591,6 +608,8 @@ bool EntryType::loadEntryTypes()
 // -----------------------------------------------------------------------------
 bool EntryType::detectEntryType(ArchiveEntry& entry)
 {
+	TRACE_ZONE("EntryType::detectEntryType");
+
 	// Do nothing if the entry is a folder or a map marker
 	if (entry.type() == etype_folder || entry.type() == etype_map)
 		return false;
@@ -602,32 +621,128 @@ bool EntryType::detectEntryType(ArchiveEntry& entry)
 		return true;
 	}
 
-	// Reset entry type
-	entry.setType(etype_unknown);
+	// Detect and set type
+	int  reliability = 0;
+	auto type        = findType(entry, reliability);
+	entry.setType(type, reliability);
+
+	// Return t/f depending on if a matching type was found
+	return type != etype_unknown;
+}
+
+// -----------------------------------------------------------------------------
+// Detects the types of all given [entries], splitting the work between
+// multiple threads. Entry data must already be loaded for this to be done in
+// parallel, any entries that aren't loaded will be detected on this thread
+// -----------------------------------------------------------------------------
+void EntryType::detectEntryTypes(const vector<ArchiveEntry*>& entries)
+{
+	// Get entries that need to be detected in parallel,
+	// anything else is quick (or unsafe to do in parallel) so just do it here
+	vector<ArchiveEntry*> to_detect;
+	to_detect.reserve(entries.size());
+	for (auto entry : entries)
+	{
+		if (entry->type() == etype_folder || entry->type() == etype_map)
+			continue;
+
+		if (entry->size() == 0 || !entry->isLoaded())
+			detectEntryType(*entry);
+		else
+			to_detect.push_back(entry);
+	}
+
+	// Not worth the threading overhead for only a few entries
+	const auto n_entries = to_detect.size();
+	if (n_entries < 32)
+	{
+		for (auto entry : to_detect)
+			detectEntryType(*entry);
+		return;
+	}
+
+	// Detect types on the task workers.
+	// Results are stored and applied to the entries afterwards on this thread
+	vector<EntryType*> types(n_entries, etype_unknown);
+	vector<int>        reliabilities(n_entries, 0);
+	tasks::parallelFor(
+		0, n_entries, [&](unsigned index) { types[index] = findType(*to_detect[index], reliabilities[index]); });
+
+	// Apply detected types
+	for (size_t a = 0; a < n_entries; ++a)
+		to_detect[a]->setType(types[a], reliabilities[a]);
+}
 
-	// Go through all registered types
-	const size_t entry_types_size = entry_types.size();
-	for (size_t a = 0; a < entry_types_size; a++)
+// -----------------------------------------------------------------------------
+// Returns the most reliable matching type for [entry] and writes its match
+// reliability to [reliability]. Doesn't modify the entry so it is safe to be
+// called on different entries from multiple threads
+// -----------------------------------------------------------------------------
+EntryType* EntryType::findType(ArchiveEntry& entry, int& reliability)
+{
+	EntryType* type             = etype_unknown;
+	int        type_reliability = 0;
+	reliability                 = 0;
+
+	// Go through all types that could possibly match the entry data
+	const auto& candidates = entry.size() > 0 ? detection_candidates[entry.rawData()[0]] : detection_candidates_all;
+	for (auto candidate : candidates)
 	{
 		// If the current type is more 'reliable' than this one, skip it
-		if (entry.typeReliability() >= entry_types[a]->reliability())
+		if (type_reliability >= candidate->reliability())
 			continue;
 
 		// Check for possible type match
-		const int r = entry_types[a]->isThisType(entry);
+		const int r = candidate->isThisType(entry);
 		if (r > 0)
 		{
 			// Type matches, set it
-			entry.setType(entry_types[a].get(), r);
+			type             = candidate;
+			reliability      = r;
+			type_reliability = type->reliability() * r / 255;
 
 			// No need to continue if the identification is 100% reliable
-			if (entry.typeReliability() >= 255)
-				return true;
+			if (type_reliability >= 255)
+				break;
 		}
 	}
 
-	// Return t/f depending on if a matching type was found
-	return entry.type() != etype_unknown;
+	return type;
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the lists of detection candidates for each possible first byte of
+// entry data, so that types whose data format can't match the entry data
+// don't need to be checked at all
+// -----------------------------------------------------------------------------
+void EntryType::updateDetectionIndex()
+{
+	detection_candidates_all.clear();
+	for (auto& candidates : detection_candidates)
+		candidates.clear();
+
+	for (const auto& type : entry_types)
+	{
+		if (!type->detectable_)
+			continue;
+
+		detection_candidates_all.push_back(type.get());
+
+		// Go through possible first bytes
+		const auto& magic = type->format_->magic();
+		for (unsigned byte = 0; byte < 256; ++byte)
+		{
+			// Type is a candidate if its format has no magic
+			// or any of its magic signatures begins with the byte
+			bool candidate = magic.empty();
+			for (const auto& m : magic)
+				if (m.empty() || static_cast<uint8_t>(m[0]) == byte)
+					candidate = true;
+
+			if (candidate)
+				detection_candidates[byte].push_back(type.get());
+		}
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -702,6 +817,48 @@ vector<string> EntryType::allCategories()
 }
 
 
+// -----------------------------------------------------------------------------
+//
+// EntryTypeDetectionQueue Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Adds [entry] to the detection queue. If enough entries (or entry data) have
+// been queued, the queue will be flushed
+// -----------------------------------------------------------------------------
+void EntryTypeDetectionQueue::add(ArchiveEntry* entry)
+{
+	static constexpr size_t   max_entries   = 4096;
+	static constexpr uint64_t max_data_size = 64 * 1024 * 1024;
+
+	entries_.push_back(entry);
+	data_size_ += entry->size();
+
+	if (entries_.size() >= max_entries || data_size_ >= max_data_size)
+		flush();
+}
+
+// -----------------------------------------------------------------------------
+// Detects the types of all queued entries and clears the queue
+// -----------------------------------------------------------------------------
+void EntryTypeDetectionQueue::flush()
+{
+	if (entries_.empty())
+		return;
+
+	EntryType::detectEntryTypes(entries_);
+
+	if (on_detected_)
+		for (auto entry : entries_)
+			on_detected_(*entry);
+
+	entries_.clear();
+	data_size_ = 0;
+}
+
+
 // -----------------------------------------------------------------------------
 //
 // Console Commands
@@ -39,6 +39,7 @@ public:
 	static bool               readEntryTypeDefinitions(string_view definitions, string_view source);
 	static bool               loadEntryTypes();
 	static bool               detectEntryType(ArchiveEntry& entry);
+	static void               detectEntryTypes(const vector<ArchiveEntry*>& entries);
 	static EntryType*         fromId(string_view id);
 	static EntryType*         unknownType();
 	static EntryType*         folderType();
@@ -80,5 +81,30 @@ private:
 	vector<string> section_;       // The 'section' of the archive the entry must be in, eg "sprites" for entries
 								   // between SS_START/SS_END in a wad, or the 'sprites' folder in a zip
 	vector<string> match_archive_; // The types of archive the entry can be found in (e.g., wad or zip)
+
+	static EntryType* findType(ArchiveEntry& entry, int& reliability);
+	static void       updateDetectionIndex();
+};
+
+// Queues entries for type detection, detecting them in parallel in batches
+// (so that not too much entry data has to be loaded at once).
+// [on_detected] is called (on the queueing thread) for each entry after its
+// type has been detected, eg. to unload the entry data again
+class EntryTypeDetectionQueue
+{
+public:
+	EntryTypeDetectionQueue(std::function<void(ArchiveEntry&)> on_detected = {}) :
+		on_detected_{ std::move(on_detected) }
+	{
+	}
+	~EntryTypeDetectionQueue() { flush(); }
+
+	void add(ArchiveEntry* entry);
+	void flush();
+
+private:
+	vector<ArchiveEntry*>              entries_;
+	uint64_t                           data_size_ = 0;
+	std::function<void(ArchiveEntry&)> on_detected_;
 };
 } // namespace slade
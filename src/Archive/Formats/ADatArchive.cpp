@@ -122,8 +122,8 @@ bool ADatArchive::open(MemChunk& mc)
 
 		// Create entry
 		auto entry                = std::make_shared<ArchiveEntry>(strutil::Path::fileNameOf(name), compsize);
-		entry->exProp("Offset")   = (int)offset;
-		entry->exProp("FullSize") = (int)decsize;
+		entry->setOffset(offset);
+		entry->setFullSize(decsize);
 		entry->setLoaded(false);
 		entry->setState(ArchiveEntry::State::Unmodified);
 
@@ -131,7 +131,17 @@ bool ADatArchive::open(MemChunk& mc)
 		dir->addEntry(entry);
 	}
 
-	// Detect all entry types
+	// Detect all entry types (in parallel, in batches)
+	EntryTypeDetectionQueue detection_queue(
+		[](ArchiveEntry& entry)
+		{
+			// Unload entry data if needed
+			if (!archive_load_data)
+				entry.unloadData();
+
+			// Set entry to unchanged
+			entry.setState(ArchiveEntry::State::Unmodified);
+		});
 	MemChunk              edata;
 	vector<ArchiveEntry*> all_entries;
 	putEntryTreeAsList(all_entries);
@@ -148,9 +158,9 @@ bool ADatArchive::open(MemChunk& mc)
 		if (entry->size() > 0)
 		{
 			// Read the entry data
-			mc.exportMemChunk(edata, entry->exProp<int>("Offset"), entry->size());
+			mc.exportMemChunk(edata, entry->offset(), entry->size());
 			MemChunk xdata;
-			if (compression::zlibInflate(edata, xdata, entry->exProp<int>("FullSize")))
+			if (compression::zlibInflate(edata, xdata, entry->fullSize()))
 				entry->importMemChunk(xdata);
 			else
 			{
@@ -159,16 +169,10 @@ bool ADatArchive::open(MemChunk& mc)
 			}
 		}
 
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
+		// Queue entry for type detection
+		detection_queue.add(entry);
 	}
+	detection_queue.flush();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -229,7 +233,7 @@ bool ADatArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->setOffset(offset);
 		}
 
 		///////////////////////////////////
@@ -334,7 +338,7 @@ bool ADatArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to entry offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->offset(), wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -353,7 +357,7 @@ bool ADatArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Anachronox dat archive
 // -----------------------------------------------------------------------------
-bool ADatArchive::isADatArchive(MemChunk& mc)
+bool ADatArchive::isADatArchive(const MemChunk& mc)
 {
 	// Check it opened ok
 	if (mc.size() < 16)
@@ -364,11 +368,10 @@ bool ADatArchive::isADatArchive(MemChunk& mc)
 	long dir_offset;
 	long dir_size;
 	long version;
-	mc.seek(0, SEEK_SET);
-	mc.read(magic, 4);
-	mc.read(&dir_offset, 4);
-	mc.read(&dir_size, 4);
-	mc.read(&version, 4);
+	mc.read(0, magic, 4);
+	mc.read(4, &dir_offset, 4);
+	mc.read(8, &dir_size, 4);
+	mc.read(12, &version, 4);
 
 	// Byteswap values for big endian if needed
 	dir_size   = wxINT32_SWAP_ON_BE(dir_size);
@@ -21,7 +21,7 @@ public:
 	bool loadEntryData(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isADatArchive(MemChunk& mc);
+	static bool isADatArchive(const MemChunk& mc);
 	static bool isADatArchive(const string& filename);
 
 private:
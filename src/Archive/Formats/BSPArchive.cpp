@@ -68,7 +68,7 @@ uint32_t BSPArchive::entryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return entry->offset();
 }
 
 // -----------------------------------------------------------------------------
@@ -156,7 +156,7 @@ bool BSPArchive::open(MemChunk& mc)
 		// Update splash window progress
 		ui::setSplashProgress(((float)a / (float)numtex));
 
-		size_t offset;
+		uint32_t offset;
 		mc.read(&offset, 4);
 		offset = wxINT32_SWAP_ON_BE(offset);
 
@@ -165,7 +165,7 @@ bool BSPArchive::open(MemChunk& mc)
 		{
 			// A texture header takes 40 bytes (16 bytes for name, 6 int32 for records),
 			// and offsets are measured from the start of the miptex lump.
-			if (offset + texoffset + 40 > size)
+			if (static_cast<size_t>(offset) + texoffset + 40 > size)
 				return false;
 
 			// Keep track of where we are now to return to it later.
@@ -223,7 +223,7 @@ bool BSPArchive::open(MemChunk& mc)
 			// Create & setup lump
 			auto nlump = std::make_shared<ArchiveEntry>(name, lumpsize);
 			nlump->setLoaded(false);
-			nlump->exProp("Offset") = (int)(offset + texoffset);
+			nlump->setOffset(offset + texoffset);
 			nlump->setState(ArchiveEntry::State::Unmodified);
 
 			// Add to entry list
@@ -234,7 +234,20 @@ bool BSPArchive::open(MemChunk& mc)
 		}
 	}
 
-	// Detect all entry types
+	// Detect all entry types (in parallel, in batches). Entry data is only
+	// needed for detection, and is unloaded again afterwards if it can be
+	// reloaded from the archive file on disk later (see loadEntryData)
+	bool unload = !archive_load_data && mc.isMapped();
+	EntryTypeDetectionQueue detection_queue(
+		[unload](ArchiveEntry& entry)
+		{
+			// Set entry to unchanged (modified entry data isn't unloaded)
+			entry.setState(ArchiveEntry::State::Unmodified);
+
+			// Unload entry data if needed
+			if (unload)
+				entry.unloadData();
+		});
 	MemChunk edata;
 	ui::setSplashProgressMessage("Detecting entry types");
 	for (size_t a = 0; a < numEntries(); a++)
@@ -245,24 +258,22 @@ bool BSPArchive::open(MemChunk& mc)
 		// Get entry
 		auto entry = entryAt(a);
 
-		// Read entry data if it isn't zero-sized
+		// Read entry data if it isn't zero-sized. The data is shared with the
+		// archive data rather than copied, unless it is to be kept loaded from
+		// the mapped archive file (entries shouldn't keep the file mapped)
 		if (entry->size() > 0)
 		{
-			// Read the entry data
-			mc.exportMemChunk(edata, entryOffset(entry), entry->size());
+			if (archive_load_data && mc.isMapped())
+				mc.exportMemChunk(edata, entryOffset(entry), entry->size());
+			else
+				edata.share(mc, entryOffset(entry), entry->size());
 			entry->importMemChunk(edata);
 		}
 
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
+		// Queue entry for type detection
+		detection_queue.add(entry);
 	}
+	detection_queue.flush();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -312,7 +323,7 @@ bool BSPArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to entry offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->offset(), wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -332,7 +343,7 @@ bool BSPArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Quake BSP archive
 // -----------------------------------------------------------------------------
-bool BSPArchive::isBSPArchive(MemChunk& mc)
+bool BSPArchive::isBSPArchive(const MemChunk& mc)
 {
 	// If size is less than 64, there's not even enough room for a full header
 	size_t size = mc.size();
@@ -343,8 +354,7 @@ bool BSPArchive::isBSPArchive(MemChunk& mc)
 	uint32_t version;
 	uint32_t texoffset = 0;
 	uint32_t texsize;
-	mc.seek(0, SEEK_SET);
-	mc.read(&version, 4);
+	mc.read(0, &version, 4);
 	version = wxINT32_SWAP_ON_BE(version);
 	if (version != 0x17 && version != 0x1D)
 		return false;
@@ -355,8 +365,8 @@ bool BSPArchive::isBSPArchive(MemChunk& mc)
 	for (int a = 0; a < 15; ++a)
 	{
 		uint32_t ofs, sz;
-		mc.read(&ofs, 4);
-		mc.read(&sz, 4);
+		mc.read(4 + a * 8, &ofs, 4);
+		mc.read(8 + a * 8, &sz, 4);
 
 		// Check that content stays within bounds
 		if (wxINT32_SWAP_ON_BE(sz) + wxINT32_SWAP_ON_BE(ofs) > size)
@@ -375,8 +385,7 @@ bool BSPArchive::isBSPArchive(MemChunk& mc)
 
 	// Now validate miptex entry
 	uint32_t numtex;
-	mc.seek(texoffset, wxFromStart);
-	mc.read(&numtex, 4);
+	mc.read(texoffset, &numtex, 4);
 	numtex = wxINT32_SWAP_ON_BE(numtex);
 
 	// Check that the offset table is within bounds
@@ -386,31 +395,26 @@ bool BSPArchive::isBSPArchive(MemChunk& mc)
 	// Check that each texture is within bounds
 	for (size_t a = 0; a < numtex; ++a)
 	{
-		size_t offset;
-		mc.read(&offset, 4);
+		uint32_t offset;
+		mc.read(texoffset + 4 + a * 4, &offset, 4);
 		offset = wxINT32_SWAP_ON_BE(offset);
 
 		// A texture header takes 40 bytes (16 bytes for name, 6 int32 for records),
 		// and offsets are measured from the start of the miptex lump.
-		if (offset + texoffset + 40 > size)
+		if (static_cast<size_t>(offset) + texoffset + 40 > size)
 			return false;
 
 		if (offset != 0xFFFFFFFF)
 		{
-			// Keep track of where we are now to return to it later.
-			size_t currentpos = mc.currentPos();
-
-			// Move to texture header
-			mc.seek(texoffset + offset, SEEK_SET);
-			char     name[16];
+			// Read texture header (after the 16 byte name)
+			auto     header = texoffset + offset;
 			uint32_t width, height, offset1, offset2, offset4, offset8;
-			mc.read(name, 16);
-			mc.read(&width, 4);
-			mc.read(&height, 4);
-			mc.read(&offset1, 4);
-			mc.read(&offset2, 4);
-			mc.read(&offset4, 4);
-			mc.read(&offset8, 4);
+			mc.read(header + 16, &width, 4);
+			mc.read(header + 20, &height, 4);
+			mc.read(header + 24, &offset1, 4);
+			mc.read(header + 28, &offset2, 4);
+			mc.read(header + 32, &offset4, 4);
+			mc.read(header + 36, &offset8, 4);
 
 			// Byteswap values for big endian if needed
 			width   = wxINT32_SWAP_ON_BE(width);
@@ -434,9 +438,6 @@ bool BSPArchive::isBSPArchive(MemChunk& mc)
 				return false;
 			if (texoffset + offset + offset8 + (tsize >> 6) > size)
 				return false;
-
-			// Okay, that texture works, go back to where we were and check the next
-			mc.seek(currentpos, SEEK_SET);
 		}
 	}
 
@@ -500,12 +501,12 @@ bool BSPArchive::isBSPArchive(const string& filename)
 	// Check that each texture is within bounds
 	for (size_t a = 0; a < numtex; ++a)
 	{
-		size_t offset;
+		uint32_t offset;
 		file.Read(&offset, 4);
 		offset = wxINT32_SWAP_ON_BE(offset);
 		// A texture header takes 40 bytes (16 bytes for name, 6 int32 for records),
 		// and offsets are measured from the start of the miptex lump.
-		if (offset + texoffset + 40 > size)
+		if (static_cast<size_t>(offset) + texoffset + 40 > size)
 			return false;
 
 		// Keep track of where we are now to return to it later.
@@ -19,7 +19,7 @@ public:
 	uint32_t entryOffset(ArchiveEntry* entry);
 
 	// Static functions
-	static bool isBSPArchive(MemChunk& mc);
+	static bool isBSPArchive(const MemChunk& mc);
 	static bool isBSPArchive(const string& filename);
 };
 } // namespace slade
@@ -212,7 +212,7 @@ vector<ArchiveEntry*> BZip2Archive::findAll(SearchOptions& options)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid BZip2 archive
 // -----------------------------------------------------------------------------
-bool BZip2Archive::isBZip2Archive(MemChunk& mc)
+bool BZip2Archive::isBZip2Archive(const MemChunk& mc)
 {
 	size_t size = mc.size();
 	if (size < 14)
@@ -220,7 +220,7 @@ bool BZip2Archive::isBZip2Archive(MemChunk& mc)
 
 	// Read header
 	uint8_t header[4];
-	mc.read(header, 4);
+	mc.read(0, header, 4);
 
 	// Check for BZip2 header (reject BZip1 headers)
 	if (header[0] == 'B' && header[1] == 'Z' && header[2] == 'h' && (header[3] >= '1' && header[3] <= '9'))
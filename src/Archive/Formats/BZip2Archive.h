@@ -49,7 +49,7 @@ public:
 	vector<ArchiveEntry*> findAll(SearchOptions& options) override;
 
 	// Static functions
-	static bool isBZip2Archive(MemChunk& mc);
+	static bool isBZip2Archive(const MemChunk& mc);
 	static bool isBZip2Archive(const string& filename);
 };
 } // namespace slade
@@ -144,7 +144,7 @@ bool DatArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(myname, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->setOffset(offset);
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		if (flags & 1)
@@ -511,7 +511,7 @@ bool DatArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)wxINT32_SWAP_ON_BE(offset);
+			entry->setOffset(wxINT32_SWAP_ON_BE(offset));
 		}
 	}
 
@@ -583,15 +583,14 @@ bool DatArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Shadowcaster dat archive
 // -----------------------------------------------------------------------------
-bool DatArchive::isDatArchive(MemChunk& mc)
+bool DatArchive::isDatArchive(const MemChunk& mc)
 {
 	// Read dat header
-	mc.seek(0, SEEK_SET);
 	uint16_t num_lumps;
 	uint32_t dir_offset, junk;
-	mc.read(&num_lumps, 2);  // Size
-	mc.read(&dir_offset, 4); // Directory offset
-	mc.read(&junk, 4);       // Unknown value
+	mc.read(0, &num_lumps, 2);  // Size
+	mc.read(2, &dir_offset, 4); // Directory offset
+	mc.read(6, &junk, 4);       // Unknown value
 	num_lumps  = wxINT16_SWAP_ON_BE(num_lumps);
 	dir_offset = wxINT32_SWAP_ON_BE(dir_offset);
 	junk       = wxINT32_SWAP_ON_BE(junk);
@@ -600,17 +599,16 @@ bool DatArchive::isDatArchive(MemChunk& mc)
 		return false;
 
 	// Read the directory
-	mc.seek(dir_offset, SEEK_SET);
 	// Read lump info
 	uint32_t offset  = 0;
 	uint32_t size    = 0;
 	uint16_t nameofs = 0;
 	uint16_t flags   = 0;
 
-	mc.read(&offset, 4);  // Offset
-	mc.read(&size, 4);    // Size
-	mc.read(&nameofs, 2); // Name offset
-	mc.read(&flags, 2);   // Flags
+	mc.read(dir_offset, &offset, 4);       // Offset
+	mc.read(dir_offset + 4, &size, 4);     // Size
+	mc.read(dir_offset + 8, &nameofs, 2);  // Name offset
+	mc.read(dir_offset + 10, &flags, 2);   // Flags
 
 	// Byteswap values for big endian if needed
 	offset  = wxINT32_SWAP_ON_BE(offset);
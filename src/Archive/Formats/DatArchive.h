@@ -11,8 +11,8 @@ public:
 	~DatArchive() = default;
 
 	// Dat specific
-	uint32_t getEntryOffset(ArchiveEntry* entry) const { return entry->exProp<int>("Offset"); }
-	void     setEntryOffset(ArchiveEntry* entry, uint32_t offset) const { entry->exProp("Offset") = (int)offset; }
+	uint32_t getEntryOffset(ArchiveEntry* entry) const { return entry->offset(); }
+	void     setEntryOffset(ArchiveEntry* entry, uint32_t offset) const { entry->setOffset(offset); }
 	void     updateNamespaces();
 
 	// Opening/writing
@@ -42,7 +42,7 @@ public:
 	string detectNamespace(unsigned index, ArchiveDir* dir = nullptr) override;
 	string detectNamespace(ArchiveEntry* entry) override;
 
-	static bool isDatArchive(MemChunk& mc);
+	static bool isDatArchive(const MemChunk& mc);
 	static bool isDatArchive(const string& filename);
 
 private:
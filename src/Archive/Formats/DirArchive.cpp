@@ -34,6 +34,7 @@
 #include "Main.h"
 #include "DirArchive.h"
 #include "App.h"
+#include "General/Tasks.h"
 #include "General/UI.h"
 #include "Utility/FileUtils.h"
 #include "Utility/StringUtils.h"
@@ -59,6 +60,52 @@ EXTERN_CVAR(Bool, archive_load_data)
 EXTERN_CVAR(Int, max_entry_size_mb)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Reads the files at [paths] into [data] and their modification times into
+// [modified_times], splitting the work between the task workers. [read_ok]
+// will be set to 0 for any file that couldn't be opened
+// -----------------------------------------------------------------------------
+void readFiles(
+	const vector<string>& paths,
+	vector<MemChunk>&     data,
+	vector<time_t>&       modified_times,
+	vector<uint8_t>&      read_ok)
+{
+	data.clear();
+	data.resize(paths.size());
+	modified_times.assign(paths.size(), 0);
+	read_ok.assign(paths.size(), 1);
+
+	// Files are read in chunks of 8, not worth the threading overhead for fewer
+	tasks::parallelFor(
+		0,
+		paths.size(),
+		[&](unsigned index)
+		{
+			SFile file;
+			if (!file.open(paths[index]))
+			{
+				read_ok[index] = 0;
+				return;
+			}
+
+			if (file.size() > 0)
+				file.read(data[index], 0);
+
+			modified_times[index] = fileutil::fileModifiedTime(paths[index]);
+		},
+		8);
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // DirArchive Class Functions
@@ -97,46 +144,78 @@ bool DirArchive::open(string_view filename)
 	// Stop announcements (don't want to be announcing modification due to entries being added etc)
 	const ArchiveModSignalBlocker sig_blocker{ *this };
 
+	// Entry types are detected in parallel, in batches as files are read
+	EntryTypeDetectionQueue detection_queue(
+		[](ArchiveEntry& entry)
+		{
+			// Unload data if needed
+			if (!archive_load_data)
+				entry.unloadData();
+		});
+
+	// Read files in batches, with each batch read in parallel
+	static constexpr size_t batch_size = 256;
+	vector<string>          batch_files;
+	vector<MemChunk>        batch_data;
+	vector<time_t>          batch_modified_times;
+	vector<uint8_t>         batch_read_ok;
 	ui::setSplashProgressMessage("Reading files");
-	for (unsigned a = 0; a < files.size(); a++)
+	for (size_t batch_start = 0; batch_start < files.size(); batch_start += batch_size)
 	{
-		ui::setSplashProgress(static_cast<float>(a) / static_cast<float>(files.size()));
+		ui::setSplashProgress(static_cast<float>(batch_start) / static_cast<float>(files.size()));
 
-		// Cut off directory to get entry name + relative path
-		auto name = files[a];
-		name.erase(0, filename.size());
-		if (strutil::startsWith(name, separator_))
-			name.erase(0, 1);
+		if (openCancelled())
+		{
+			global::error = "Opening cancelled";
+			return false;
+		}
 
-		// log::info(3, fn.GetPath(true, wxPATH_UNIX));
+		// Read batch
+		const auto batch_end = std::min(batch_start + batch_size, files.size());
+		batch_files.assign(files.begin() + batch_start, files.begin() + batch_end);
+		readFiles(batch_files, batch_data, batch_modified_times, batch_read_ok);
 
-		// Create entry
-		auto fn        = strutil::Path{ name };
-		auto new_entry = std::make_shared<ArchiveEntry>(fn.fileName());
+		for (unsigned a = 0; a < batch_files.size(); a++)
+		{
+			const auto& file_path = batch_files[a];
 
-		// Setup entry info
-		new_entry->setLoaded(false);
-		new_entry->exProp("filePath") = files[a];
+			// Cut off directory to get entry name + relative path
+			auto name = file_path;
+			name.erase(0, filename.size());
+			if (strutil::startsWith(name, separator_))
+				name.erase(0, 1);
 
-		// Add entry and directory to directory tree
-		auto ndir = createDir(fn.path());
-		ndir->addEntry(new_entry);
-		ndir->dirEntry()->exProp("filePath") = fmt::format("{}{}", filename, fn.path());
+			// Create entry
+			auto fn        = strutil::Path{ name };
+			auto new_entry = std::make_shared<ArchiveEntry>(fn.fileName());
 
-		// Read entry data
-		if (!new_entry->importFile(files[a]))
-			return false;
-		new_entry->setLoaded(true);
+			// Setup entry info
+			new_entry->setLoaded(false);
+			new_entry->exProp("filePath") = file_path;
 
-		file_modification_times_[new_entry.get()] = fileutil::fileModifiedTime(files[a]);
+			// Add entry and directory to directory tree
+			auto ndir = createDir(fn.path());
+			ndir->addEntry(new_entry);
+			ndir->dirEntry()->exProp("filePath") = fmt::format("{}{}", filename, fn.path());
 
-		// Detect entry type
-		EntryType::detectEntryType(*new_entry);
+			// Import entry data
+			if (!batch_read_ok[a])
+			{
+				global::error = fmt::format("Unable to open file \"{}\" for reading", file_path);
+				return false;
+			}
+			if (batch_data[a].hasData() && !new_entry->importMemChunk(batch_data[a]))
+				return false;
+			batch_data[a].clear();
+			new_entry->setLoaded(true);
 
-		// Unload data if needed
-		if (!archive_load_data)
-			new_entry->unloadData();
+			file_modification_times_[new_entry.get()] = batch_modified_times[a];
+
+			// Queue entry for type detection
+			detection_queue.add(new_entry.get());
+		}
 	}
+	detection_queue.flush();
 
 	// Add empty directories
 	for (const auto& subdir : dirs)
@@ -290,7 +369,7 @@ bool DirArchive::save(string_view filename)
 		}
 
 		// Check if entry needs to be (re)written
-		if (entries[a]->state() == ArchiveEntry::State::Unmodified && entries[a]->exProps().contains("filePath")
+		if (entries[a]->state() == ArchiveEntry::State::Unmodified && entries[a]->hasExProp("filePath")
 			&& path == entries[a]->exProp<string>("filePath"))
 			continue;
 
@@ -361,7 +440,7 @@ shared_ptr<ArchiveDir> DirArchive::removeDir(string_view path, ArchiveDir* base)
 	// Add to removed files list
 	for (auto& entry : entries)
 	{
-		if (!entry->exProps().contains("filePath"))
+		if (!entry->hasExProp("filePath"))
 			continue;
 
 		log::info(2, entry->exProp<string>("filePath"));
@@ -418,7 +497,7 @@ bool DirArchive::removeEntry(ArchiveEntry* entry, bool set_deleted)
 	if (!checkEntry(entry))
 		return false;
 
-	if (entry->exProps().contains("filePath"))
+	if (entry->hasExProp("filePath"))
 	{
 		// If it exists on disk we need to update removed_files_
 		const auto old_name = entry->exProp<string>("filePath");
@@ -442,7 +521,7 @@ bool DirArchive::renameEntry(ArchiveEntry* entry, string_view name, bool force)
 		return false;
 
 	// Check if entry exists on disk
-	if (entry->exProps().contains("filePath"))
+	if (entry->hasExProp("filePath"))
 	{
 		const auto old_name = entry->exProp<string>("filePath");
 		const bool success  = Archive::renameEntry(entry, name, force);
@@ -118,7 +118,7 @@ bool DiskArchive::open(MemChunk& mc)
 
 		// Create entry
 		auto entry              = std::make_shared<ArchiveEntry>(fn.fileName(), dent.length);
-		entry->exProp("Offset") = (int)dent.offset;
+		entry->setOffset(dent.offset);
 		entry->setLoaded(false);
 		entry->setState(ArchiveEntry::State::Unmodified);
 
@@ -126,7 +126,17 @@ bool DiskArchive::open(MemChunk& mc)
 		dir->addEntry(entry);
 	}
 
-	// Detect all entry types
+	// Detect all entry types (in parallel, in batches)
+	EntryTypeDetectionQueue detection_queue(
+		[](ArchiveEntry& entry)
+		{
+			// Unload entry data if needed
+			if (!archive_load_data)
+				entry.unloadData();
+
+			// Set entry to unchanged
+			entry.setState(ArchiveEntry::State::Unmodified);
+		});
 	MemChunk              edata;
 	vector<ArchiveEntry*> all_entries;
 	putEntryTreeAsList(all_entries);
@@ -143,20 +153,14 @@ bool DiskArchive::open(MemChunk& mc)
 		if (entry->size() > 0)
 		{
 			// Read the entry data
-			mc.exportMemChunk(edata, entry->exProp<int>("Offset"), entry->size());
+			mc.exportMemChunk(edata, entry->offset(), entry->size());
 			entry->importMemChunk(edata);
 		}
 
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
+		// Queue entry for type detection
+		detection_queue.add(entry);
 	}
+	detection_queue.flush();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -215,7 +219,7 @@ bool DiskArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->setOffset(offset);
 		}
 
 		// Check entry name
@@ -302,7 +306,7 @@ bool DiskArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to entry offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->offset(), wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -322,7 +326,7 @@ bool DiskArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Nerve disk archive
 // -----------------------------------------------------------------------------
-bool DiskArchive::isDiskArchive(MemChunk& mc)
+bool DiskArchive::isDiskArchive(const MemChunk& mc)
 {
 	// Check given data is valid
 	size_t mcsize = mc.size();
@@ -332,8 +336,7 @@ bool DiskArchive::isDiskArchive(MemChunk& mc)
 	// Read disk header
 	uint32_t num_entries;
 	uint32_t size_entries;
-	mc.seek(0, SEEK_SET);
-	mc.read(&num_entries, 4);
+	mc.read(0, &num_entries, 4);
 	num_entries = wxUINT32_SWAP_ON_LE(num_entries);
 
 	size_t start_offset = (72 * num_entries) + 8;
@@ -346,7 +349,7 @@ bool DiskArchive::isDiskArchive(MemChunk& mc)
 	{
 		// Read entry info
 		DiskEntry entry;
-		mc.read(&entry, 72);
+		mc.read(4 + d * 72, &entry, 72);
 
 		// Byteswap if needed
 		entry.length = wxUINT32_SWAP_ON_LE(entry.length);
@@ -359,7 +362,7 @@ bool DiskArchive::isDiskArchive(MemChunk& mc)
 		if (entry.offset + entry.length > mcsize)
 			return false;
 	}
-	mc.read(&size_entries, 4);
+	mc.read(4 + num_entries * 72, &size_entries, 4);
 	size_entries = wxUINT32_SWAP_ON_LE(size_entries);
 	if (size_entries + start_offset != mcsize)
 		return false;
@@ -383,7 +383,7 @@ vector<ArchiveEntry*> GZipArchive::findAll(SearchOptions& options)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid GZip archive
 // -----------------------------------------------------------------------------
-bool GZipArchive::isGZipArchive(MemChunk& mc)
+bool GZipArchive::isGZipArchive(const MemChunk& mc)
 {
 	// Minimal metadata size is 18: 10 for header, 8 for footer
 	size_t mds  = 18;
@@ -393,7 +393,7 @@ bool GZipArchive::isGZipArchive(MemChunk& mc)
 
 	// Read header
 	uint8_t header[4];
-	mc.read(header, 4);
+	mc.read(0, header, 4);
 
 	// Check for GZip header; we'll only accept deflated gzip files
 	// and reject any field using unknown flags
@@ -406,36 +406,28 @@ bool GZipArchive::isGZipArchive(MemChunk& mc)
 	bool fname = (header[3] & FLG_FNAME) != 0;
 	bool fcmnt = (header[3] & FLG_FCMNT) != 0;
 
-	uint32_t mtime;
-	mc.read(&mtime, 4);
-
-	uint8_t xfl;
-	mc.read(&xfl, 1);
-	uint8_t os;
-	mc.read(&os, 1);
+	// Skip modification time, extra flags and OS
+	size_t pos = 10;
 
 	// Skip extra fields which may be there
 	if (fxtra)
 	{
 		uint16_t xlen;
-		mc.read(&xlen, 2);
+		mc.read(pos, &xlen, 2);
 		xlen = wxUINT16_SWAP_ON_BE(xlen);
 		mds += xlen + 2;
 		if (mds > size)
 			return false;
-		mc.seek(xlen, SEEK_CUR);
+		pos += xlen + 2;
 	}
 
 	// Skip past name, if any
 	if (fname)
 	{
-		string name;
-		char   c;
+		uint8_t c;
 		do
 		{
-			mc.read(&c, 1);
-			if (c)
-				name += c;
+			c = mc[pos++];
 			++mds;
 		} while (c != 0 && size > mds);
 	}
@@ -443,13 +435,10 @@ bool GZipArchive::isGZipArchive(MemChunk& mc)
 	// Skip past comment
 	if (fcmnt)
 	{
-		string comment;
-		char   c;
+		uint8_t c;
 		do
 		{
-			mc.read(&c, 1);
-			if (c)
-				comment += c;
+			c = mc[pos++];
 			++mds;
 		} while (c != 0 && size > mds);
 	}
@@ -457,13 +446,12 @@ bool GZipArchive::isGZipArchive(MemChunk& mc)
 	// Skip past CRC 16 check
 	if (fhcrc)
 	{
-		uint16_t hcrc;
-		mc.read(&hcrc, 2);
+		pos += 2;
 		mds += 2;
 	}
 
 	// Header is over
-	if (mds > size || mc.currentPos() + 8 > size)
+	if (mds > size || pos + 8 > size)
 		return false;
 
 	// If it's passed to here it's probably a gzip file
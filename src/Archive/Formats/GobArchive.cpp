@@ -61,7 +61,7 @@ uint32_t GobArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return entry->offset();
 }
 
 // -----------------------------------------------------------------------------
@@ -73,7 +73,7 @@ void GobArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->setOffset(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -150,14 +150,24 @@ bool GobArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->setOffset(offset);
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Add to entry list
 		rootDir()->addEntry(nlump);
 	}
 
-	// Detect all entry types
+	// Detect all entry types (in parallel, in batches)
+	EntryTypeDetectionQueue detection_queue(
+		[](ArchiveEntry& entry)
+		{
+			// Unload entry data if needed
+			if (!archive_load_data)
+				entry.unloadData();
+
+			// Set entry to unchanged
+			entry.setState(ArchiveEntry::State::Unmodified);
+		});
 	MemChunk edata;
 	ui::setSplashProgressMessage("Detecting entry types");
 	for (size_t a = 0; a < numEntries(); a++)
@@ -176,16 +186,10 @@ bool GobArchive::open(MemChunk& mc)
 			entry->importMemChunk(edata);
 		}
 
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
+		// Queue entry for type detection
+		detection_queue.add(entry);
 	}
+	detection_queue.flush();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -250,7 +254,7 @@ bool GobArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->setOffset(offset);
 		}
 	}
 
@@ -298,7 +302,7 @@ bool GobArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Dark Forces gob archive
 // -----------------------------------------------------------------------------
-bool GobArchive::isGobArchive(MemChunk& mc)
+bool GobArchive::isGobArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -310,8 +314,7 @@ bool GobArchive::isGobArchive(MemChunk& mc)
 
 	// Get directory offset
 	uint32_t dir_offset = 0;
-	mc.seek(4, SEEK_SET);
-	mc.read(&dir_offset, 4);
+	mc.read(4, &dir_offset, 4);
 	dir_offset = wxINT32_SWAP_ON_BE(dir_offset);
 
 	// Check size
@@ -320,8 +323,7 @@ bool GobArchive::isGobArchive(MemChunk& mc)
 
 	// Get number of lumps
 	uint32_t num_lumps = 0;
-	mc.seek(dir_offset, SEEK_SET);
-	mc.read(&num_lumps, 4);
+	mc.read(dir_offset, &num_lumps, 4);
 	num_lumps = wxINT32_SWAP_ON_BE(num_lumps);
 
 	// Compute directory size
@@ -61,7 +61,7 @@ uint32_t GrpArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return entry->offset();
 }
 
 // -----------------------------------------------------------------------------
@@ -73,7 +73,7 @@ void GrpArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->setOffset(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -147,14 +147,24 @@ bool GrpArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->setOffset(offset);
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Add to entry list
 		rootDir()->addEntry(nlump);
 	}
 
-	// Detect all entry types
+	// Detect all entry types (in parallel, in batches)
+	EntryTypeDetectionQueue detection_queue(
+		[](ArchiveEntry& entry)
+		{
+			// Unload entry data if needed
+			if (!archive_load_data)
+				entry.unloadData();
+
+			// Set entry to unchanged
+			entry.setState(ArchiveEntry::State::Unmodified);
+		});
 	MemChunk edata;
 	ui::setSplashProgressMessage("Detecting entry types");
 	for (size_t a = 0; a < numEntries(); a++)
@@ -173,16 +183,10 @@ bool GrpArchive::open(MemChunk& mc)
 			entry->importMemChunk(edata);
 		}
 
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
+		// Queue entry for type detection
+		detection_queue.add(entry);
 	}
+	detection_queue.flush();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -227,7 +231,7 @@ bool GrpArchive::write(MemChunk& mc, bool update)
 		{
 			long offset = getEntryOffset(entry);
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->setOffset(offset);
 		}
 	}
 
@@ -282,7 +286,7 @@ bool GrpArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Duke Nukem 3D grp archive
 // -----------------------------------------------------------------------------
-bool GrpArchive::isGrpArchive(MemChunk& mc)
+bool GrpArchive::isGrpArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 16)
@@ -291,9 +295,8 @@ bool GrpArchive::isGrpArchive(MemChunk& mc)
 	// Get number of lumps
 	uint32_t num_lumps     = 0;
 	char     ken_magic[13] = "";
-	mc.seek(0, SEEK_SET);
-	mc.read(ken_magic, 12); // "KenSilverman"
-	mc.read(&num_lumps, 4); // No. of lumps in grp
+	mc.read(0, ken_magic, 12);  // "KenSilverman"
+	mc.read(12, &num_lumps, 4); // No. of lumps in grp
 
 	// Byteswap values for big endian if needed
 	num_lumps = wxINT32_SWAP_ON_BE(num_lumps);
@@ -310,8 +313,7 @@ bool GrpArchive::isGrpArchive(MemChunk& mc)
 	uint32_t size      = 0;
 	for (uint32_t a = 0; a < num_lumps; ++a)
 	{
-		mc.read(ken_magic, 12);
-		mc.read(&size, 4);
+		mc.read(16 + a * 16 + 12, &size, 4); // After the 12 character name
 		totalsize += size;
 	}
 
@@ -22,7 +22,7 @@ public:
 	bool loadEntryData(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isGrpArchive(MemChunk& mc);
+	static bool isGrpArchive(const MemChunk& mc);
 	static bool isGrpArchive(const string& filename);
 };
 } // namespace slade
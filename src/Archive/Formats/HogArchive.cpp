@@ -128,7 +128,7 @@ uint32_t HogArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return entry->offset();
 }
 
 // -----------------------------------------------------------------------------
@@ -140,7 +140,7 @@ void HogArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->setOffset(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -195,7 +195,7 @@ bool HogArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->setOffset(offset);
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Handle txb/ctb as archive level encryption. This is not strictly
@@ -211,7 +211,17 @@ bool HogArchive::open(MemChunk& mc)
 		iter_offset = offset + size;
 	}
 
-	// Detect all entry types
+	// Detect all entry types (in parallel, in batches)
+	EntryTypeDetectionQueue detection_queue(
+		[](ArchiveEntry& entry)
+		{
+			// Unload entry data if needed
+			if (!archive_load_data)
+				entry.unloadData();
+
+			// Set entry to unchanged
+			entry.setState(ArchiveEntry::State::Unmodified);
+		});
 	MemChunk edata;
 	ui::setSplashProgressMessage("Detecting entry types");
 	for (size_t a = 0; a < numEntries(); a++)
@@ -232,16 +242,10 @@ bool HogArchive::open(MemChunk& mc)
 			entry->importMemChunk(edata);
 		}
 
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
+		// Queue entry for type detection
+		detection_queue.add(entry);
 	}
+	detection_queue.flush();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -269,7 +273,7 @@ bool HogArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->setOffset(offset);
 		}
 		offset += entry->size();
 	}
@@ -400,7 +404,7 @@ bool HogArchive::renameEntry(ArchiveEntry* entry, string_view name, bool force)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Descent hog archive
 // -----------------------------------------------------------------------------
-bool HogArchive::isHogArchive(MemChunk& mc)
+bool HogArchive::isHogArchive(const MemChunk& mc)
 {
 	// Check size
 	size_t size = mc.size();
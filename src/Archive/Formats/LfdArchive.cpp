@@ -62,7 +62,7 @@ uint32_t LfdArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return entry->offset();
 }
 
 // -----------------------------------------------------------------------------
@@ -74,7 +74,7 @@ void LfdArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->setOffset(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -151,7 +151,7 @@ bool LfdArchive::open(MemChunk& mc)
 		fn.setExtension(type);
 		auto nlump = std::make_shared<ArchiveEntry>(fn.fileName(), length);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->setOffset(offset);
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Add to entry list
@@ -165,7 +165,17 @@ bool LfdArchive::open(MemChunk& mc)
 	if (num_lumps != numEntries())
 		log::warning("Computed {} lumps, but actually {} entries", num_lumps, numEntries());
 
-	// Detect all entry types
+	// Detect all entry types (in parallel, in batches)
+	EntryTypeDetectionQueue detection_queue(
+		[](ArchiveEntry& entry)
+		{
+			// Unload entry data if needed
+			if (!archive_load_data)
+				entry.unloadData();
+
+			// Set entry to unchanged
+			entry.setState(ArchiveEntry::State::Unmodified);
+		});
 	MemChunk edata;
 	ui::setSplashProgressMessage("Detecting entry types");
 	for (size_t a = 0; a < numEntries(); a++)
@@ -184,16 +194,10 @@ bool LfdArchive::open(MemChunk& mc)
 			entry->importMemChunk(edata);
 		}
 
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
+		// Queue entry for type detection
+		detection_queue.add(entry);
 	}
+	detection_queue.flush();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -222,7 +226,7 @@ bool LfdArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)total_size;
+			entry->setOffset(total_size);
 		}
 		total_size += entry->size();
 	}
@@ -328,7 +332,7 @@ bool LfdArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Dark Forces lfd archive
 // -----------------------------------------------------------------------------
-bool LfdArchive::isLfdArchive(MemChunk& mc)
+bool LfdArchive::isLfdArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -340,8 +344,7 @@ bool LfdArchive::isLfdArchive(MemChunk& mc)
 
 	// Get offset of first entry
 	uint32_t dir_offset = 0;
-	mc.seek(12, SEEK_SET);
-	mc.read(&dir_offset, 4);
+	mc.read(12, &dir_offset, 4);
 	dir_offset = wxINT32_SWAP_ON_BE(dir_offset) + 16;
 	if (dir_offset % 16)
 		return false;
@@ -351,11 +354,11 @@ bool LfdArchive::isLfdArchive(MemChunk& mc)
 	char     name2[9];
 	uint32_t len1;
 	uint32_t len2;
-	mc.read(type1, 4);
+	mc.read(16, type1, 4);
 	type1[4] = 0;
-	mc.read(name1, 8);
+	mc.read(20, name1, 8);
 	name1[8] = 0;
-	mc.read(&len1, 4);
+	mc.read(28, &len1, 4);
 	len1 = wxINT32_SWAP_ON_BE(len1);
 
 	// Check size
@@ -363,12 +366,11 @@ bool LfdArchive::isLfdArchive(MemChunk& mc)
 		return false;
 
 	// Compare
-	mc.seek(dir_offset, SEEK_SET);
-	mc.read(type2, 4);
+	mc.read(dir_offset, type2, 4);
 	type2[4] = 0;
-	mc.read(name2, 8);
+	mc.read(dir_offset + 4, name2, 8);
 	name2[8] = 0;
-	mc.read(&len2, 4);
+	mc.read(dir_offset + 12, &len2, 4);
 	len2 = wxINT32_SWAP_ON_BE(len2);
 
 	if (strcmp(type1, type2) != 0 || strcmp(name1, name2) != 0 || len1 != len2)
@@ -22,7 +22,7 @@ public:
 	bool loadEntryData(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isLfdArchive(MemChunk& mc);
+	static bool isLfdArchive(const MemChunk& mc);
 	static bool isLfdArchive(const string& filename);
 };
 } // namespace slade
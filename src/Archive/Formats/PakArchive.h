@@ -18,7 +18,7 @@ public:
 	bool loadEntryData(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isPakArchive(MemChunk& mc);
+	static bool isPakArchive(const MemChunk& mc);
 	static bool isPakArchive(const string& filename);
 };
 } // namespace slade
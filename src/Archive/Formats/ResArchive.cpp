@@ -60,7 +60,7 @@ uint32_t ResArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return entry->offset();
 }
 
 // -----------------------------------------------------------------------------
@@ -72,7 +72,7 @@ void ResArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->setOffset(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -148,7 +148,7 @@ bool ResArchive::readDirectory(MemChunk& mc, size_t dir_offset, size_t num_lumps
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->setOffset(offset);
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Read entry data if it isn't zero-sized
@@ -303,7 +303,7 @@ bool ResArchive::write(MemChunk& mc, bool update)
 
 			if (update) {
 				entry->setState(ArchiveEntry::State::Unmodified);
-				entry->exProp("Offset") = (int)offset;
+				entry->setOffset(offset);
 			}
 		}
 	*/
@@ -351,12 +351,12 @@ bool ResArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid A&A res archive
 // -----------------------------------------------------------------------------
-bool ResArchive::isResArchive(MemChunk& mc)
+bool ResArchive::isResArchive(const MemChunk& mc)
 {
 	size_t dummy1, dummy2;
 	return isResArchive(mc, dummy1, dummy2);
 }
-bool ResArchive::isResArchive(MemChunk& mc, size_t& dir_offset, size_t& num_lumps)
+bool ResArchive::isResArchive(const MemChunk& mc, size_t& dir_offset, size_t& num_lumps)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -367,9 +367,8 @@ bool ResArchive::isResArchive(MemChunk& mc, size_t& dir_offset, size_t& num_lump
 		return false;
 
 	uint32_t dir_size = 0;
-	mc.seek(4, SEEK_SET);
-	mc.read(&dir_offset, 4);
-	mc.read(&dir_size, 4);
+	mc.read(4, &dir_offset, 4);
+	mc.read(8, &dir_size, 4);
 
 	// Byteswap values for big endian if needed
 	dir_size   = wxINT32_SWAP_ON_BE(dir_size);
@@ -387,9 +386,6 @@ bool ResArchive::isResArchive(MemChunk& mc, size_t& dir_offset, size_t& num_lump
 
 	num_lumps = dir_size / RESDIRENTRYSIZE;
 
-	// Reset MemChunk (just in case)
-	mc.seek(0, SEEK_SET);
-
 	// If it's passed to here it's probably a res file
 	return true;
 }
@@ -113,6 +113,16 @@ void bloodCrypt(void* data, int key, int len)
 	for (i = 0; i < len; ++i)
 		((uint8_t*)data)[i] ^= (unsigned char)(p + (i >> 1));
 }
+
+// -----------------------------------------------------------------------------
+// Decrypts [mc] in-place if [entry] is encrypted. Only the first 256 bytes of
+// an encrypted lump are actually encrypted
+// -----------------------------------------------------------------------------
+void decryptEntryData(const ArchiveEntry* entry, MemChunk& mc)
+{
+	if (entry->encryption() != ArchiveEntry::Encryption::None)
+		bloodCrypt(mc.data(), 0, std::min<int>(mc.size(), 256));
+}
 } // namespace
 
 
@@ -132,7 +142,7 @@ uint32_t RffArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return entry->offset();
 }
 
 // -----------------------------------------------------------------------------
@@ -144,7 +154,7 @@ void RffArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->setOffset(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -222,7 +232,7 @@ bool RffArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->setOffset(offset);
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Is the entry encrypted?
@@ -234,7 +244,17 @@ bool RffArchive::open(MemChunk& mc)
 	}
 	delete[] lumps;
 
-	// Detect all entry types
+	// Detect all entry types (in parallel, in batches)
+	EntryTypeDetectionQueue detection_queue(
+		[](ArchiveEntry& entry)
+		{
+			// Unload entry data if needed
+			if (!archive_load_data)
+				entry.unloadData();
+
+			// Set entry to unchanged
+			entry.setState(ArchiveEntry::State::Unmodified);
+		});
 	MemChunk edata;
 	ui::setSplashProgressMessage("Detecting entry types");
 	for (size_t a = 0; a < numEntries(); a++)
@@ -248,34 +268,18 @@ bool RffArchive::open(MemChunk& mc)
 		// Read entry data if it isn't zero-sized
 		if (entry->size() > 0)
 		{
-			// Read the entry data
+			// Read the entry data (decrypting it if needed)
 			mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
-
-			// If the entry is encrypted, decrypt it
-			if (entry->encryption() != ArchiveEntry::Encryption::None)
-			{
-				uint8_t* cdata = new uint8_t[entry->size()];
-				memcpy(cdata, edata.data(), entry->size());
-				int cryptlen = entry->size() < 256 ? entry->size() : 256;
-				bloodCrypt(cdata, 0, cryptlen);
-				edata.importMem(cdata, entry->size());
-				delete[] cdata;
-			}
+			decryptEntryData(entry, edata);
 
 			// Import data
 			entry->importMemChunk(edata);
 		}
 
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
+		// Queue entry for type detection
+		detection_queue.add(entry);
 	}
+	detection_queue.flush();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -325,8 +329,13 @@ bool RffArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to lump offset in file and read it in
+	MemChunk edata(entry->size());
 	file.Seek(getEntryOffset(entry), wxFromStart);
-	entry->importFileStream(file, entry->size());
+	file.Read(edata.data(), entry->size());
+
+	// Decrypt and import it
+	decryptEntryData(entry, edata);
+	entry->importMemChunk(edata);
 
 	// Set the lump to loaded
 	entry->setLoaded();
@@ -337,7 +346,7 @@ bool RffArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Duke Nukem 3D grp archive
 // -----------------------------------------------------------------------------
-bool RffArchive::isRffArchive(MemChunk& mc)
+bool RffArchive::isRffArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -347,11 +356,10 @@ bool RffArchive::isRffArchive(MemChunk& mc)
 	uint8_t  magic[4];
 	uint32_t version, dir_offset, num_lumps;
 
-	mc.seek(0, SEEK_SET);
-	mc.read(magic, 4);       // Should be "RFF\x18"
-	mc.read(&version, 4);    // 0x01 0x03 \x00 \x00
-	mc.read(&dir_offset, 4); // Offset to directory
-	mc.read(&num_lumps, 4);  // No. of lumps in rff
+	mc.read(0, magic, 4);        // Should be "RFF\x18"
+	mc.read(4, &version, 4);     // 0x01 0x03 \x00 \x00
+	mc.read(8, &dir_offset, 4);  // Offset to directory
+	mc.read(12, &num_lumps, 4);  // No. of lumps in rff
 
 	// Byteswap values for big endian if needed
 	dir_offset = wxINT32_SWAP_ON_BE(dir_offset);
@@ -365,9 +373,8 @@ bool RffArchive::isRffArchive(MemChunk& mc)
 
 	// Compute total size
 	auto lumps = new RFFLump[num_lumps];
-	mc.seek(dir_offset, SEEK_SET);
 	ui::setSplashProgressMessage("Reading rff archive data");
-	mc.read(lumps, num_lumps * sizeof(RFFLump));
+	mc.read(dir_offset, lumps, num_lumps * sizeof(RFFLump));
 	bloodCrypt(lumps, dir_offset, num_lumps * sizeof(RFFLump));
 	uint32_t totalsize = 12 + num_lumps * sizeof(RFFLump);
 	uint32_t size      = 0;
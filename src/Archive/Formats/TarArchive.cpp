@@ -330,7 +330,7 @@ bool TarArchive::open(MemChunk& mc)
 
 			// Create entry
 			auto entry              = std::make_shared<ArchiveEntry>(strutil::Path::fileNameOf(name), size);
-			entry->exProp("Offset") = (int)mc.currentPos();
+			entry->setOffset(mc.currentPos());
 			entry->setLoaded(false);
 			entry->setState(ArchiveEntry::State::Unmodified);
 
@@ -355,7 +355,20 @@ bool TarArchive::open(MemChunk& mc)
 		mc.seek(sum, SEEK_CUR); // and move on
 	}
 
-	// Detect all entry types
+	// Detect all entry types (in parallel, in batches). Entry data is only
+	// needed for detection, and is unloaded again afterwards if it can be
+	// reloaded from the archive file on disk later (see loadEntryData)
+	bool unload = !archive_load_data && mc.isMapped();
+	EntryTypeDetectionQueue detection_queue(
+		[unload](ArchiveEntry& entry)
+		{
+			// Set entry to unchanged (modified entry data isn't unloaded)
+			entry.setState(ArchiveEntry::State::Unmodified);
+
+			// Unload entry data if needed
+			if (unload)
+				entry.unloadData();
+		});
 	MemChunk              edata;
 	vector<ArchiveEntry*> all_entries;
 	putEntryTreeAsList(all_entries);
@@ -368,24 +381,22 @@ bool TarArchive::open(MemChunk& mc)
 		// Get entry
 		auto entry = all_entries[a];
 
-		// Read entry data if it isn't zero-sized
+		// Read entry data if it isn't zero-sized. The data is shared with the
+		// archive data rather than copied, unless it is to be kept loaded from
+		// the mapped archive file (entries shouldn't keep the file mapped)
 		if (entry->size() > 0)
 		{
-			// Read the entry data
-			mc.exportMemChunk(edata, entry->exProp<int>("Offset"), entry->size());
+			if (archive_load_data && mc.isMapped())
+				mc.exportMemChunk(edata, entry->offset(), entry->size());
+			else
+				edata.share(mc, entry->offset(), entry->size());
 			entry->importMemChunk(edata);
 		}
 
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
+		// Queue entry for type detection
+		detection_queue.add(entry);
 	}
+	detection_queue.flush();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -414,6 +425,13 @@ bool TarArchive::write(MemChunk& mc, bool update)
 	putEntryTreeAsList(entries);
 	size_t listsize = entries.size();
 
+	// Reserve the total size (each entry has a 512 byte header and is padded
+	// to a multiple of 512 bytes, plus two empty records at the end)
+	unsigned total_size = 1024;
+	for (auto* entry : entries)
+		total_size += 512 + (entry->size() + 511) / 512 * 512;
+	mc.reserve(total_size);
+
 	for (size_t a = 0; a < listsize; ++a)
 	{
 		// MAYBE TODO: store the header variables as ExProps for the entries, then only change
@@ -491,7 +509,7 @@ bool TarArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to entry offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->offset(), wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -511,15 +529,16 @@ bool TarArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Unix tar archive
 // -----------------------------------------------------------------------------
-bool TarArchive::isTarArchive(MemChunk& mc)
+bool TarArchive::isTarArchive(const MemChunk& mc)
 {
-	mc.seek(0, SEEK_SET);
-	int blankcount = 0;
-	while ((mc.currentPos() + 512) <= mc.size() && blankcount < 3)
+	size_t pos        = 0;
+	int    blankcount = 0;
+	while ((pos + 512) <= mc.size() && blankcount < 3)
 	{
 		// Read tar header
 		TarHeader header;
-		mc.read(&header, 512);
+		mc.read(pos, &header, 512);
+		pos += 512;
 		if (!strutil::equalCI({header.magic, sizeof(header.magic)}, TMAGIC))
 		{
 			if (tarMakeChecksum(&header) == 0)
@@ -550,7 +569,7 @@ bool TarArchive::isTarArchive(MemChunk& mc)
 		if (sum)
 			sum = 512 - sum;    // Compute it
 		sum += size;            // then add it
-		mc.seek(sum, SEEK_CUR); // and move on
+		pos += sum;             // and move on
 	}
 	// We should end with a blankcount of precisely 2
 	return (blankcount == 2);
@@ -18,7 +18,7 @@ public:
 	bool loadEntryData(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isTarArchive(MemChunk& mc);
+	static bool isTarArchive(const MemChunk& mc);
 	static bool isTarArchive(const string& filename);
 };
 } // namespace slade
@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "WadArchive.h"
+#include "Archive/ArchiveIndexCache.h"
 #include "General/Misc.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
@@ -46,6 +47,7 @@ using namespace slade;
 //
 // -----------------------------------------------------------------------------
 CVAR(Bool, iwad_lock, true, CVar::Flag::Save)
+CVAR(Bool, wad_save_incremental, false, CVar::Flag::Save)
 
 namespace
 {
@@ -147,7 +149,7 @@ uint32_t WadArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return entry->offset();
 }
 
 // -----------------------------------------------------------------------------
@@ -159,7 +161,7 @@ void WadArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->setOffset(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -362,6 +364,12 @@ bool WadArchive::open(MemChunk& mc)
 		// Update splash window progress
 		ui::setSplashProgress(((float)d / (float)num_lumps));
 
+		if (openCancelled())
+		{
+			global::error = "Opening cancelled";
+			return false;
+		}
+
 		// Read lump info
 		char     name[9] = "";
 		uint32_t offset  = 0;
@@ -447,13 +455,13 @@ bool WadArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->setOffset(offset);
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		if (jaguarencrypt)
 		{
 			nlump->setEncryption(ArchiveEntry::Encryption::Jaguar);
-			nlump->exProp("FullSize") = (int)size;
+			nlump->setFullSize(size);
 		}
 
 		// Add to entry list
@@ -464,46 +472,60 @@ bool WadArchive::open(MemChunk& mc)
 	// rely on being within certain namespaces)
 	updateNamespaces();
 
-	// Detect all entry types
-	MemChunk edata;
-	ui::setSplashProgressMessage("Detecting entry types");
-	for (size_t a = 0; a < numEntries(); a++)
+	// Use entry types from the cached index if possible, otherwise read and
+	// detect all entry types (in parallel, in batches)
+	const bool cached = use_index_cache_ && archiveindexcache::enabled() && readIndexCache(mc.size());
+	if (!cached)
 	{
-		// Update splash window progress
-		ui::setSplashProgress((((float)a / (float)numEntries())));
-
-		// Get entry
-		auto entry = entryAt(a);
-
-		// Read entry data if it isn't zero-sized
-		if (entry->size() > 0)
+		EntryTypeDetectionQueue detection_queue(
+			[](ArchiveEntry& entry)
+			{
+				// Unload entry data if needed
+				if (!archive_load_data)
+					entry.unloadData();
+
+				// Set entry to unchanged
+				entry.setState(ArchiveEntry::State::Unmodified);
+			});
+		MemChunk edata;
+		ui::setSplashProgressMessage("Detecting entry types");
+		for (size_t a = 0; a < numEntries(); a++)
 		{
-			// Read the entry data
-			mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
-			if (entry->encryption() != ArchiveEntry::Encryption::None)
+			// Update splash window progress
+			ui::setSplashProgress((((float)a / (float)numEntries())));
+
+			if (openCancelled())
 			{
-				if (entry->exProps().contains("FullSize")
-					&& static_cast<unsigned>(entry->exProp<int>("FullSize")) > entry->size())
-					edata.reSize((entry->exProp<int>("FullSize")), true);
-				if (!WadJArchive::jaguarDecode(edata))
-					log::warning(
-						"{}: {} (following {}), did not decode properly",
-						a,
-						entry->name(),
-						a > 0 ? entryAt(a - 1)->name() : "nothing");
+				global::error = "Opening cancelled";
+				return false;
 			}
-			entry->importMemChunk(edata);
-		}
 
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
+			// Get entry
+			auto entry = entryAt(a);
 
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
+			// Read entry data if it isn't zero-sized
+			if (entry->size() > 0)
+			{
+				// Read the entry data
+				mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
+				if (entry->encryption() != ArchiveEntry::Encryption::None)
+				{
+					if (entry->fullSize() > entry->size())
+						edata.reSize(entry->fullSize(), true);
+					if (!WadJArchive::jaguarDecode(edata))
+						log::warning(
+							"{}: {} (following {}), did not decode properly",
+							a,
+							entry->name(),
+							a > 0 ? entryAt(a - 1)->name() : "nothing");
+				}
+				entry->importMemChunk(edata);
+			}
 
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
+			// Queue entry for type detection
+			detection_queue.add(entry);
+		}
+		detection_queue.flush();
 	}
 
 	// Identify #included lumps (DECORATE, GLDEFS, etc.)
@@ -513,6 +535,10 @@ bool WadArchive::open(MemChunk& mc)
 	ui::setSplashProgressMessage("Detecting maps");
 	detectMaps();
 
+	// Update the cached index if needed
+	if (use_index_cache_ && !cached && archiveindexcache::enabled())
+		writeIndexCache(mc.size());
+
 	// Setup variables
 	sig_blocker.unblock();
 	setModified(false);
@@ -590,7 +616,7 @@ bool WadArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->setOffset(offset);
 		}
 	}
 
@@ -610,6 +636,16 @@ bool WadArchive::write(string_view filename, bool update)
 		return false;
 	}
 
+	// Only write changed lumps if saving incrementally
+	const bool in_place = on_disk_ && filename == filename_;
+	if (wad_save_incremental && update && in_place && !write_full_ && canWriteIncremental())
+		return writeIncremental();
+
+	// Make sure all entry data is loaded before overwriting the file it would be loaded from
+	if (in_place)
+		for (uint32_t l = 0; l < numEntries(); l++)
+			entryAt(l)->rawData();
+
 	// Open file for writing
 	wxFile file;
 	file.Open(wxString{ filename.data(), filename.size() }, wxFile::write);
@@ -668,7 +704,7 @@ bool WadArchive::write(string_view filename, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->setOffset(offset);
 		}
 	}
 
@@ -677,6 +713,221 @@ bool WadArchive::write(string_view filename, bool update)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Rewrites the whole wad file, reclaiming any unused space left over from
+// incremental saves.
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool WadArchive::compact()
+{
+	if (!on_disk_ || filename_.empty() || parentEntry())
+	{
+		global::error = "Only wad files on disk can be compacted";
+		return false;
+	}
+
+	write_full_   = true;
+	const auto ok = save();
+	write_full_   = false;
+
+	return ok;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the wad can be saved incrementally to its file on disk.
+// This is only possible if all unmodified lumps are still in the file where
+// the directory currently there says they are
+// -----------------------------------------------------------------------------
+bool WadArchive::canWriteIncremental()
+{
+	// Open the wad file and read the header
+	wxFile file(filename_);
+	if (!file.IsOpened() || file.Length() < 12)
+		return false;
+
+	char     wad_type[4];
+	uint32_t num_lumps  = 0;
+	uint32_t dir_offset = 0;
+	file.Read(wad_type, 4);
+	file.Read(&num_lumps, 4);
+	file.Read(&dir_offset, 4);
+	num_lumps  = wxINT32_SWAP_ON_BE(num_lumps);
+	dir_offset = wxINT32_SWAP_ON_BE(dir_offset);
+	if (wad_type[1] != 'W' || wad_type[2] != 'A' || wad_type[3] != 'D'
+		|| static_cast<uint64_t>(dir_offset) + static_cast<uint64_t>(num_lumps) * 16 > static_cast<uint64_t>(file.Length()))
+		return false;
+
+	// Read the directory currently in the file
+	MemChunk directory;
+	file.Seek(dir_offset, wxFromStart);
+	if (num_lumps > 0 && !directory.importFileStreamWx(file, num_lumps * 16))
+		return false;
+
+	std::set<std::pair<uint32_t, uint32_t>> lumps;
+	for (uint32_t l = 0; l < num_lumps; l++)
+		lumps.emplace(directory.readL32(l * 16), directory.readL32(l * 16 + 4));
+
+	// Check all unmodified lumps are in there, and the size of everything
+	// that needs to be written
+	uint64_t new_size = file.Length() + numEntries() * 16;
+	for (uint32_t l = 0; l < numEntries(); l++)
+	{
+		auto entry = entryAt(l);
+		if (entry->size() == 0)
+			continue;
+
+		if (entry->state() == ArchiveEntry::State::Unmodified && entry->hasOffset())
+		{
+			if (lumps.count({ getEntryOffset(entry), entry->size() }) == 0)
+				return false;
+		}
+		else
+			new_size += entry->size();
+	}
+
+	// Wads can't be larger than 4GB
+	return new_size <= 0xFFFFFFFF;
+}
+
+// -----------------------------------------------------------------------------
+// Saves the wad to its file on disk, appending new and modified lumps to the
+// end of the file, followed by the new directory. Unmodified lumps are left
+// where they are, and anything no longer used is left as unused space in the
+// file until it is compacted.
+// The header is only updated (to point to the new directory) once everything
+// else has been written, so if saving fails the file still contains the
+// previously saved wad
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool WadArchive::writeIncremental()
+{
+	wxFile file(filename_, wxFile::read_write);
+	if (!file.IsOpened())
+	{
+		global::error = "Unable to open file for writing";
+		return false;
+	}
+
+	auto write_error = [&]()
+	{
+		global::error = "Error writing to file, check there is enough free disk space";
+		return false;
+	};
+
+	// Write new and modified lumps at the end of the file
+	const auto    num_lumps = numEntries();
+	auto          offset    = static_cast<uint32_t>(file.Length());
+	ArchiveEntry* entry;
+	file.Seek(offset, wxFromStart);
+	for (uint32_t l = 0; l < num_lumps; l++)
+	{
+		entry = entryAt(l);
+		if (entry->state() == ArchiveEntry::State::Unmodified && entry->hasOffset())
+			continue;
+
+		if (entry->size() > 0 && file.Write(entry->rawData(), entry->size()) != entry->size())
+			return write_error();
+
+		setEntryOffset(entry, offset);
+		offset += entry->size();
+	}
+
+	// Write the directory
+	MemChunk directory(num_lumps * 16);
+	for (uint32_t l = 0; l < num_lumps; l++)
+	{
+		entry                = entryAt(l);
+		char     name[8]     = { 0, 0, 0, 0, 0, 0, 0, 0 };
+		uint32_t lump_offset = wxINT32_SWAP_ON_BE(getEntryOffset(entry));
+		uint32_t lump_size   = wxINT32_SWAP_ON_BE(entry->size());
+
+		for (size_t c = 0; c < entry->name().length() && c < 8; c++)
+			name[c] = entry->name()[c];
+
+		directory.write(&lump_offset, 4);
+		directory.write(&lump_size, 4);
+		directory.write(name, 8);
+	}
+	if (num_lumps > 0 && file.Write(directory.data(), directory.size()) != directory.size())
+		return write_error();
+	if (!file.Flush())
+		return write_error();
+
+	// Update the header to point to the new directory
+	char wad_type[4] = { 'P', 'W', 'A', 'D' };
+	if (iwad_)
+		wad_type[0] = 'I';
+	uint32_t header_lumps  = wxINT32_SWAP_ON_BE(num_lumps);
+	uint32_t header_offset = wxINT32_SWAP_ON_BE(offset);
+	file.Seek(0, wxFromStart);
+	if (file.Write(wad_type, 4) != 4 || file.Write(&header_lumps, 4) != 4 || file.Write(&header_offset, 4) != 4
+		|| !file.Flush())
+		return write_error();
+
+	file.Close();
+
+	// Update entry states
+	for (uint32_t l = 0; l < num_lumps; l++)
+		entryAt(l)->setState(ArchiveEntry::State::Unmodified);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Applies entry types from the cached index for this wad (if one exists and
+// matches the lumps read from the directory), so they don't need to be read
+// and detected. [file_size] is the size of the wad file on disk.
+// Returns true if the cached index was used
+// -----------------------------------------------------------------------------
+bool WadArchive::readIndexCache(uint64_t file_size)
+{
+	vector<archiveindexcache::EntryInfo> cached;
+	if (!archiveindexcache::read(filename_, file_size, file_modified_, cached) || cached.size() != numEntries())
+		return false;
+
+	// Check the cached index matches the directory
+	vector<EntryType*> types(cached.size());
+	for (unsigned a = 0; a < cached.size(); a++)
+	{
+		auto entry = entryAt(a);
+		if (entry->name() != cached[a].name || entry->size() != cached[a].size
+			|| getEntryOffset(entry) != cached[a].location)
+			return false;
+
+		types[a] = EntryType::fromId(cached[a].type_id);
+	}
+
+	// Apply cached types
+	for (unsigned a = 0; a < cached.size(); a++)
+		entryAt(a)->setType(types[a], cached[a].reliability);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the cached index for this wad, with the given [file_size] of the wad
+// file on disk.
+// Encrypted wads aren't cached since their entries need decoding anyway
+// -----------------------------------------------------------------------------
+void WadArchive::writeIndexCache(uint64_t file_size)
+{
+	vector<archiveindexcache::EntryInfo> index(numEntries());
+	for (unsigned a = 0; a < index.size(); a++)
+	{
+		auto entry = entryAt(a);
+		if (entry->encryption() != ArchiveEntry::Encryption::None)
+			return;
+
+		index[a].name        = entry->name();
+		index[a].size        = entry->size();
+		index[a].location    = getEntryOffset(entry);
+		index[a].type_id     = entry->type()->id();
+		index[a].reliability = static_cast<uint8_t>(entry->reliability());
+	}
+
+	archiveindexcache::write(filename_, file_size, file_modified_, index);
+}
+
 // -----------------------------------------------------------------------------
 // Loads an entry's data from the wadfile
 // Returns true if successful, false otherwise
@@ -1492,7 +1743,7 @@ vector<ArchiveEntry*> WadArchive::findAll(SearchOptions& options)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Doom wad archive
 // -----------------------------------------------------------------------------
-bool WadArchive::isWadArchive(MemChunk& mc)
+bool WadArchive::isWadArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -1505,12 +1756,8 @@ bool WadArchive::isWadArchive(MemChunk& mc)
 	// Get number of lumps and directory offset
 	uint32_t num_lumps  = 0;
 	uint32_t dir_offset = 0;
-	mc.seek(4, SEEK_SET);
-	mc.read(&num_lumps, 4);
-	mc.read(&dir_offset, 4);
-
-	// Reset MemChunk (just in case)
-	mc.seek(0, SEEK_SET);
+	mc.read(4, &num_lumps, 4);
+	mc.read(8, &dir_offset, 4);
 
 	// Byteswap values for big endian if needed
 	num_lumps  = wxINT32_SWAP_ON_BE(num_lumps);
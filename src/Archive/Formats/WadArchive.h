@@ -23,6 +23,7 @@ public:
 	// Writing/Saving
 	bool write(MemChunk& mc, bool update = true) override;         // Write to MemChunk
 	bool write(string_view filename, bool update = true) override; // Write to File
+	bool compact();
 
 	// Misc
 	bool loadEntryData(ArchiveEntry* entry) override;
@@ -56,7 +57,7 @@ public:
 	vector<ArchiveEntry*> findAll(SearchOptions& options) override;
 
 	// Static functions
-	static bool isWadArchive(MemChunk& mc);
+	static bool isWadArchive(const MemChunk& mc);
 	static bool isWadArchive(const string& filename);
 
 	static bool exportEntriesAsWad(string_view filename, vector<ArchiveEntry*> entries)
@@ -90,5 +91,11 @@ private:
 
 	bool           iwad_ = false;
 	vector<NSPair> namespaces_;
+	bool           write_full_ = false; // If true, always rewrite the whole file when saving (even if incremental)
+
+	bool canWriteIncremental();
+	bool writeIncremental();
+	bool readIndexCache(uint64_t file_size);
+	void writeIndexCache(uint64_t file_size);
 };
 } // namespace slade
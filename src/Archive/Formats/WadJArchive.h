@@ -18,7 +18,7 @@ public:
 	string detectNamespace(ArchiveEntry* entry) override;
 	string detectNamespace(unsigned index, ArchiveDir* dir = nullptr) override;
 
-	static bool isWadJArchive(MemChunk& mc);
+	static bool isWadJArchive(const MemChunk& mc);
 	static bool isWadJArchive(const string& filename);
 
 	static bool jaguarDecode(MemChunk& mc);
@@ -197,7 +197,7 @@ void addWolfPicHeader(ArchiveEntry* entry, uint16_t width, uint16_t height)
 	if (!entry)
 		return;
 
-	auto& mc = entry->data();
+	const auto& mc = entry->constData();
 	if (mc.size() == 0)
 		return;
 
@@ -226,7 +226,7 @@ void addIMFHeader(ArchiveEntry* entry)
 	if (!entry)
 		return;
 
-	auto& mc = entry->data();
+	const auto& mc = entry->constData();
 	if (mc.size() == 0)
 		return;
 
@@ -282,19 +282,70 @@ struct HuffNode
 {
 	uint16_t bit0, bit1; // 0-255 is a character, > is a pointer to a node
 };
-void expandWolfGraphLump(ArchiveEntry* entry, size_t lumpnum, size_t numlumps, HuffNode* hufftable)
+
+// Result of decoding (up to) 8 bits of VGAGRAPH data from the head node, so
+// that most characters can be decoded with a single table lookup
+struct HuffLookup
+{
+	uint16_t value  = 0;     // Decoded character, or the node to continue from if not a leaf
+	uint8_t  length = 0;     // Number of bits used, 0 if the bits are invalid
+	bool     leaf   = false; // True if [value] is a decoded character
+};
+
+// -----------------------------------------------------------------------------
+// Builds the [lookup] table (256 entries) for [hufftable]
+// -----------------------------------------------------------------------------
+void buildHuffLookup(const HuffNode* hufftable, HuffLookup* lookup)
+{
+	for (unsigned bits = 0; bits < 256; ++bits)
+	{
+		auto& result = lookup[bits];
+		auto  node   = hufftable + 254; // head node is always node 254
+		for (uint8_t a = 0; a < 8; ++a)
+		{
+			uint16_t nodeval = (bits >> a) & 1 ? node->bit1 : node->bit0;
+			if (nodeval < 256)
+			{
+				result = { nodeval, static_cast<uint8_t>(a + 1), true };
+				break;
+			}
+			if (nodeval >= 512)
+				break;
+
+			node   = hufftable + (nodeval - 256);
+			result = { static_cast<uint16_t>(nodeval - 256), static_cast<uint8_t>(a + 1), false };
+		}
+
+		// Invalid if a bad node was hit before reaching a character or 8 bits
+		if (!result.leaf && result.length < 8)
+			result.length = 0;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Expands the huffman-compressed VGAGRAPH data of [entry] (lump [lumpnum] of
+// [numlumps]), using [hufftable] and its [lookup] table
+// -----------------------------------------------------------------------------
+void expandWolfGraphLump(
+	ArchiveEntry*     entry,
+	size_t            lumpnum,
+	size_t            numlumps,
+	const HuffNode*   hufftable,
+	const HuffLookup* lookup)
 {
 	if (!entry || entry->size() == 0)
 		return;
 
 	size_t         expanded; // expanded size
-	const uint8_t* source = entry->rawData();
-
+	const uint8_t* source     = entry->rawData();
+	const uint8_t* source_end = source + entry->size();
 
 	if (lumpnum == WolfConstant(STARTTILE8, numlumps))
 		expanded = 64 * WolfConstant(NUMTILE8, numlumps);
 	else
 	{
+		if (entry->size() < 4)
+			return;
 		expanded = *(uint32_t*)source;
 		source += 4; // skip over length
 	}
@@ -305,50 +356,74 @@ void expandWolfGraphLump(ArchiveEntry* entry, size_t lumpnum, size_t numlumps, H
 		return;
 	}
 
-	uint8_t*  dest = new uint8_t[expanded];
-	uint8_t * end, *start;
-	HuffNode *headptr, *huffptr;
+	vector<uint8_t> dest(expanded);
 
-	headptr = hufftable + 254; // head node is always node 254
+	// Source bits are read least significant first, buffered so that up to 8
+	// bits at a time can be decoded via the lookup table
+	uint64_t bits   = 0;
+	unsigned n_bits = 0;
+	auto     refill = [&]()
+	{
+		while (n_bits <= 56 && source < source_end)
+		{
+			bits |= static_cast<uint64_t>(*source++) << n_bits;
+			n_bits += 8;
+		}
+	};
 
 	size_t written = 0;
-
-	end   = dest + expanded;
-	start = dest;
-
-	uint8_t  val  = *source++;
-	uint8_t  mask = 1;
-	uint16_t nodeval;
-	huffptr = headptr;
-	while (true)
+	bool   error   = false;
+	while (written < expanded && !error)
 	{
-		if (!(val & mask))
-			nodeval = huffptr->bit0;
-		else
-			nodeval = huffptr->bit1;
-		if (mask == 0x80)
-			val = *source++, mask = 1;
-		else
-			mask <<= 1;
+		refill();
+		const auto& result = lookup[bits & 0xFF];
+		if (result.length == 0 || result.length > n_bits)
+		{
+			error = true;
+			break;
+		}
+		bits >>= result.length;
+		n_bits -= result.length;
 
-		if (nodeval < 256)
+		if (result.leaf)
 		{
-			*dest++ = (uint8_t)nodeval;
-			written++;
-			huffptr = headptr;
-			if (dest >= end)
-				break;
+			dest[written++] = static_cast<uint8_t>(result.value);
+			continue;
 		}
-		else if (nodeval < 512)
+
+		// Codes longer than 8 bits continue one bit at a time
+		auto node = hufftable + result.value;
+		while (true)
 		{
-			huffptr = hufftable + (nodeval - 256);
+			refill();
+			if (n_bits == 0)
+			{
+				error = true;
+				break;
+			}
+
+			uint16_t nodeval = bits & 1 ? node->bit1 : node->bit0;
+			bits >>= 1;
+			--n_bits;
+
+			if (nodeval < 256)
+			{
+				dest[written++] = static_cast<uint8_t>(nodeval);
+				break;
+			}
+			if (nodeval >= 512)
+			{
+				error = true;
+				break;
+			}
+			node = hufftable + (nodeval - 256);
 		}
-		else
-			log::warning("ExpandWolfGraphLump: nodeval is out of control ({}) in entry {}", nodeval, lumpnum);
 	}
 
-	entry->importMem(start, expanded);
-	delete[] start;
+	if (error)
+		log::warning("ExpandWolfGraphLump: invalid or truncated data in entry {}", lumpnum);
+
+	entry->importMem(dest.data(), expanded);
 }
 } // namespace
 
@@ -366,7 +441,7 @@ void expandWolfGraphLump(ArchiveEntry* entry, size_t lumpnum, size_t numlumps, H
 // -----------------------------------------------------------------------------
 uint32_t WolfArchive::getEntryOffset(ArchiveEntry* entry) const
 {
-	return uint32_t(entry->exProp<int>("Offset"));
+	return entry->offset();
 }
 
 // -----------------------------------------------------------------------------
@@ -374,7 +449,7 @@ uint32_t WolfArchive::getEntryOffset(ArchiveEntry* entry) const
 // -----------------------------------------------------------------------------
 void WolfArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset) const
 {
-	entry->exProp("Offset") = (int)offset;
+	entry->setOffset(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -546,7 +621,7 @@ bool WolfArchive::open(MemChunk& mc)
 			// Create & setup lump
 			auto nlump = std::make_shared<ArchiveEntry>(name, size);
 			nlump->setLoaded(false);
-			nlump->exProp("Offset") = (int)pages[d].offset;
+			nlump->setOffset(pages[d].offset);
 			nlump->setState(ArchiveEntry::State::Unmodified);
 
 			d = e;
@@ -725,7 +800,7 @@ bool WolfArchive::openAudio(MemChunk& head, MemChunk& data)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->setOffset(offset);
 
 		// Detect entry type
 		if (size > 0)
@@ -797,7 +872,7 @@ bool WolfArchive::openMaps(MemChunk& head, MemChunk& data)
 
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->setOffset(offset);
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Add to entry list
@@ -817,7 +892,7 @@ bool WolfArchive::openMaps(MemChunk& head, MemChunk& data)
 			name        = fmt::format("PLANE{}", i);
 			auto nlump2 = std::make_shared<ArchiveEntry>(name, planelen[i]);
 			nlump2->setLoaded(false);
-			nlump2->exProp("Offset") = (int)planeofs[i];
+			nlump2->setOffset(planeofs[i]);
 			nlump2->setState(ArchiveEntry::State::Unmodified);
 			rootDir()->addEntry(nlump2);
 		}
@@ -877,6 +952,8 @@ bool WolfArchive::openGraph(MemChunk& head, MemChunk& data, MemChunk& dict)
 	}
 	HuffNode nodes[256];
 	memcpy(nodes, dict.data(), 1024);
+	HuffLookup lookup[256];
+	buildHuffLookup(nodes, lookup);
 
 	// Read Wolf header file
 	uint32_t num_lumps = (head.size() / 3) - 1;
@@ -938,7 +1015,7 @@ bool WolfArchive::openGraph(MemChunk& head, MemChunk& data, MemChunk& dict)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->setOffset(offset);
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Add to entry list
@@ -964,7 +1041,7 @@ bool WolfArchive::openGraph(MemChunk& head, MemChunk& data, MemChunk& dict)
 			data.exportMemChunk(edata, getEntryOffset(entry), entry->size());
 			entry->importMemChunk(edata);
 		}
-		expandWolfGraphLump(entry, a, num_lumps, nodes);
+		expandWolfGraphLump(entry, a, num_lumps, nodes, lookup);
 
 		// Store pictable information
 		if (a == 0)
@@ -1070,18 +1147,17 @@ bool WolfArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Wolfenstein VSWAP archive
 // -----------------------------------------------------------------------------
-bool WolfArchive::isWolfArchive(MemChunk& mc)
+bool WolfArchive::isWolfArchive(const MemChunk& mc)
 {
 	// Read Wolf header
-	mc.seek(0, SEEK_SET);
 	uint16_t num_lumps, sprites, sounds;
-	mc.read(&num_lumps, 2); // Size
+	mc.read(0, &num_lumps, 2); // Size
 	num_lumps = wxINT16_SWAP_ON_BE(num_lumps);
 	if (num_lumps == 0)
 		return false;
 
-	mc.read(&sprites, 2); // Sprites start
-	mc.read(&sounds, 2);  // Sounds start
+	mc.read(2, &sprites, 2); // Sprites start
+	mc.read(4, &sounds, 2);  // Sounds start
 	sprites = wxINT16_SWAP_ON_BE(sprites);
 	sounds  = wxINT16_SWAP_ON_BE(sounds);
 	if (sprites > sounds)
@@ -1100,7 +1176,7 @@ bool WolfArchive::isWolfArchive(MemChunk& mc)
 	uint32_t           lastoffset = 0;
 	for (size_t a = 0; a < num_lumps; ++a)
 	{
-		mc.read(&offset, 4);
+		mc.read(6 + a * 4, &offset, 4);
 		offset = wxINT32_SWAP_ON_BE(offset);
 		if (offset < lastoffset || offset % 512)
 			return false;
@@ -1110,7 +1186,7 @@ bool WolfArchive::isWolfArchive(MemChunk& mc)
 	uint16_t lastsize = 0;
 	for (size_t b = 0; b < num_lumps; ++b)
 	{
-		mc.read(&size, 2);
+		mc.read(6 + num_lumps * 4 + b * 2, &size, 2);
 		size = wxINT16_SWAP_ON_BE(size);
 		pagesize += (size / 512) + ((size % 512) ? 1 : 0);
 		pages[b].size = size;
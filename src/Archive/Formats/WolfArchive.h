@@ -39,7 +39,7 @@ public:
 	// Entry modification
 	bool renameEntry(ArchiveEntry* entry, string_view name, bool force = false) override { return false; }
 
-	static bool isWolfArchive(MemChunk& mc);
+	static bool isWolfArchive(const MemChunk& mc);
 	static bool isWolfArchive(const string& filename);
 
 private:
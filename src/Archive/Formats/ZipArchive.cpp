@@ -32,13 +32,21 @@
 #include "Main.h"
 #include "ZipArchive.h"
 #include "App.h"
+#include "Archive/ArchiveIndexCache.h"
 #include "General/Misc.h"
+#include "General/Tasks.h"
 #include "General/UI.h"
 #include "UI/WxUtils.h"
+#include "Utility/Compression.h"
 #include "Utility/FileUtils.h"
 #include "Utility/StringUtils.h"
 #include "WadArchive.h"
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
 #include <fstream>
+#include <mutex>
+#include <wx/mstream.h>
 
 using namespace slade;
 
@@ -49,6 +57,9 @@ using namespace slade;
 //
 // -----------------------------------------------------------------------------
 CVAR(Bool, zip_allow_duplicate_names, false, CVar::Save)
+CVAR(Int, zip_level_default, 9, CVar::Save)      // Deflate level for most entries (0 = store)
+CVAR(Int, zip_level_compressed, 0, CVar::Save)   // Deflate level for already compressed formats (png, ogg, etc.)
+CVAR(Int, zip_level_high_entropy, 1, CVar::Save) // Deflate level for unknown entries that look compressed
 
 
 // -----------------------------------------------------------------------------
@@ -60,6 +71,402 @@ EXTERN_CVAR(Bool, archive_load_data)
 EXTERN_CVAR(Int, max_entry_size_mb)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Info for an entry in the old zip file (that is being replaced when writing)
+struct ZipOldEntry
+{
+	uint64_t header_offset   = 0; // Offset of the local file header in the old zip
+	uint16_t flags           = 0;
+	uint16_t method          = 0;
+	uint32_t dos_time        = 0;
+	uint32_t crc             = 0;
+	uint32_t size            = 0;
+	uint32_t compressed_size = 0;
+};
+
+// Info for an entry to be written to a zip file
+struct ZipWriteEntry
+{
+	string          name;
+	bool            is_dir          = false;
+	uint16_t        flags           = 0;
+	uint16_t        method          = wxZIP_METHOD_STORE;
+	uint32_t        dos_time        = 0;
+	uint32_t        crc             = 0;
+	uint32_t        size            = 0;
+	uint32_t        compressed_size = 0;
+	uint64_t        header_offset   = 0;       // Offset of the local file header in the written zip
+	int             level           = 9;       // Deflate level to compress with (0 = store)
+	int             entropy_level   = -1;      // Level to use if the data looks compressed (-1 = don't check)
+	const MemChunk* source          = nullptr; // Uncompressed data to compress and write
+	MemChunk        data;                      // Data to write, once compressed
+	bool            ready   = false;           // True once compression has finished
+	bool            has_old = false;           // True if the entry exists in the old zip
+	ZipOldEntry     old;
+	bool            copy = false; // If true, copy the (compressed) data from the old zip
+
+	// Sets the entry to be copied as-is from the old zip
+	void copyOld()
+	{
+		copy            = true;
+		flags           = old.flags & ~0x0008; // Sizes are always given in the local header (no data descriptor)
+		method          = old.method;
+		dos_time        = old.dos_time;
+		crc             = old.crc;
+		size            = old.size;
+		compressed_size = old.compressed_size;
+	}
+};
+
+// -----------------------------------------------------------------------------
+// Writes a 16-bit little-endian [value] to [mc]
+// -----------------------------------------------------------------------------
+void writeL16(MemChunk& mc, uint16_t value)
+{
+	value = wxUINT16_SWAP_ON_BE(value);
+	mc.write(&value, 2);
+}
+
+// -----------------------------------------------------------------------------
+// Writes a 32-bit little-endian [value] to [mc]
+// -----------------------------------------------------------------------------
+void writeL32(MemChunk& mc, uint32_t value)
+{
+	value = wxUINT32_SWAP_ON_BE(value);
+	mc.write(&value, 4);
+}
+
+// -----------------------------------------------------------------------------
+// Writes a 64-bit little-endian [value] to [mc]
+// -----------------------------------------------------------------------------
+void writeL64(MemChunk& mc, uint64_t value)
+{
+	writeL32(mc, static_cast<uint32_t>(value));
+	writeL32(mc, static_cast<uint32_t>(value >> 32));
+}
+
+// -----------------------------------------------------------------------------
+// Reads a 64-bit little-endian value from [mc] at [offset]
+// -----------------------------------------------------------------------------
+uint64_t readL64(const MemChunk& mc, unsigned offset)
+{
+	return mc.readL32(offset) + (static_cast<uint64_t>(mc.readL32(offset + 4)) << 32);
+}
+
+// -----------------------------------------------------------------------------
+// Returns [path] as a zip entry name (no leading /, trailing / for
+// directories)
+// -----------------------------------------------------------------------------
+string zipEntryName(string_view path, bool is_dir)
+{
+	while (!path.empty() && path[0] == '/')
+		path.remove_prefix(1);
+
+	string name{ path };
+	if (is_dir && (name.empty() || name.back() != '/'))
+		name += '/';
+
+	return name;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [format_id] is a data format that is already compressed, and
+// therefore not worth deflating again
+// -----------------------------------------------------------------------------
+bool isCompressedFormat(string_view format_id)
+{
+	static const vector<string_view> compressed_formats = {
+		"img_png", "img_jpeg", "img_webp", "img_gif", "snd_ogg", "snd_flac", "snd_mp3", "snd_mp2",
+		"archive_zip", "archive_gzip", "archive_bz2", "gme_vgz"
+	};
+
+	return std::find(compressed_formats.begin(), compressed_formats.end(), format_id) != compressed_formats.end();
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [data] looks like it is already compressed (or otherwise
+// random), by sampling the byte entropy of a few blocks spread through it
+// -----------------------------------------------------------------------------
+bool looksCompressed(const MemChunk& data)
+{
+	static constexpr unsigned block_size = 4096;
+	static constexpr unsigned n_blocks   = 4;
+
+	// Small data is quick to deflate anyway
+	const auto size = data.size();
+	if (size < block_size)
+		return false;
+
+	unsigned counts[256] = {};
+	unsigned total       = 0;
+	for (unsigned b = 0; b < n_blocks; ++b)
+	{
+		auto start = static_cast<unsigned>(static_cast<uint64_t>(size - block_size) * b / (n_blocks - 1));
+		for (unsigned a = start; a < start + block_size; ++a)
+			++counts[data[a]];
+		total += block_size;
+	}
+
+	double entropy = 0.0;
+	for (auto count : counts)
+	{
+		if (count == 0)
+			continue;
+		auto p = static_cast<double>(count) / total;
+		entropy -= p * std::log2(p);
+	}
+
+	// Deflate can't do much with data much over 7.5 bits per byte
+	return entropy > 7.5;
+}
+
+// -----------------------------------------------------------------------------
+// Compresses the source data of [zip_entry] at its deflate level. The data is
+// stored uncompressed if the level is 0 or deflating it wouldn't make it any
+// smaller, or not compressed at all if it is the same as in the old zip.
+// Doesn't touch anything other than [zip_entry] and its source data so it is
+// safe to be called on different entries from multiple threads
+// -----------------------------------------------------------------------------
+void compressZipEntry(ZipWriteEntry& zip_entry)
+{
+	// Deflate works on a non-const MemChunk (to seek), but the data itself isn't modified
+	auto& source = const_cast<MemChunk&>(*zip_entry.source);
+
+	zip_entry.size = source.size();
+	zip_entry.crc  = source.crc();
+
+	// If the data is unchanged from the old zip (eg. the entry was only renamed
+	// or moved), it can be copied from there without recompressing
+	if (zip_entry.has_old && zip_entry.size == zip_entry.old.size && zip_entry.crc == zip_entry.old.crc)
+	{
+		zip_entry.copyOld();
+		return;
+	}
+
+	// Unknown data is sampled to see if it's worth compressing properly
+	if (zip_entry.entropy_level >= 0 && looksCompressed(source))
+		zip_entry.level = zip_entry.entropy_level;
+
+	if (zip_entry.size > 0 && zip_entry.level > 0 && compression::zipDeflate(source, zip_entry.data, zip_entry.level)
+		&& zip_entry.data.size() < zip_entry.size)
+	{
+		zip_entry.method = wxZIP_METHOD_DEFLATE;
+	}
+	else
+	{
+		zip_entry.method = wxZIP_METHOD_STORE;
+		zip_entry.data.importMem(source);
+	}
+	zip_entry.compressed_size = zip_entry.data.size();
+}
+
+// -----------------------------------------------------------------------------
+// Writes the local file header for [zip_entry] to [mc]
+// -----------------------------------------------------------------------------
+void writeLocalHeader(MemChunk& mc, const ZipWriteEntry& zip_entry)
+{
+	writeL32(mc, 0x04034b50);
+	writeL16(mc, 20); // Version needed to extract (2.0)
+	writeL16(mc, zip_entry.flags);
+	writeL16(mc, zip_entry.method);
+	writeL32(mc, zip_entry.dos_time);
+	writeL32(mc, zip_entry.crc);
+	writeL32(mc, zip_entry.compressed_size);
+	writeL32(mc, zip_entry.size);
+	writeL16(mc, static_cast<uint16_t>(zip_entry.name.size()));
+	writeL16(mc, 0); // Extra field length
+	mc.write(zip_entry.name.data(), zip_entry.name.size());
+}
+
+// -----------------------------------------------------------------------------
+// Writes the central directory record for [zip_entry] to [mc]
+// -----------------------------------------------------------------------------
+void writeCentralDirRecord(MemChunk& mc, const ZipWriteEntry& zip_entry)
+{
+	// Local headers past 4GB need their offset in a zip64 extra field
+	const bool     zip64   = zip_entry.header_offset >= 0xFFFFFFFF;
+	const uint16_t version = zip64 ? 45 : 20;
+
+	writeL32(mc, 0x02014b50);
+	writeL16(mc, version); // Version made by (MS-DOS)
+	writeL16(mc, version); // Version needed to extract
+	writeL16(mc, zip_entry.flags);
+	writeL16(mc, zip_entry.method);
+	writeL32(mc, zip_entry.dos_time);
+	writeL32(mc, zip_entry.crc);
+	writeL32(mc, zip_entry.compressed_size);
+	writeL32(mc, zip_entry.size);
+	writeL16(mc, static_cast<uint16_t>(zip_entry.name.size()));
+	writeL16(mc, zip64 ? 12 : 0);              // Extra field length
+	writeL16(mc, 0);                           // Comment length
+	writeL16(mc, 0);                           // Disk number
+	writeL16(mc, 0);                           // Internal attributes
+	writeL32(mc, zip_entry.is_dir ? 0x10 : 0); // External attributes (MS-DOS directory flag)
+	writeL32(mc, zip64 ? 0xFFFFFFFF : static_cast<uint32_t>(zip_entry.header_offset));
+	mc.write(zip_entry.name.data(), zip_entry.name.size());
+
+	// Zip64 extended information extra field
+	if (zip64)
+	{
+		writeL16(mc, 0x0001);
+		writeL16(mc, 8); // Size of the rest of the field
+		writeL64(mc, zip_entry.header_offset);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Copies the (compressed) data for [zip_entry] from the [old_zip] data to
+// [out], without loading it all into memory
+// -----------------------------------------------------------------------------
+bool copyOldZipEntryData(SeekableData& old_zip, SeekableData& out, const ZipWriteEntry& zip_entry)
+{
+	// Read the local file header
+	uint8_t header[30];
+	if (!old_zip.seekFromStart(zip_entry.old.header_offset) || !old_zip.read(header, 30))
+		return false;
+	const MemChunk lh(header, 30);
+	if (lh.readL32(0) != 0x04034b50)
+		return false;
+
+	// Skip the name and extra field to get to the entry data
+	old_zip.seek(lh.readL16(26) + lh.readL16(28));
+
+	// Copy data in chunks
+	static constexpr unsigned chunk_size = 1024 * 1024;
+	vector<uint8_t>           buffer(std::min(zip_entry.compressed_size, chunk_size));
+	auto                      remaining = zip_entry.compressed_size;
+	while (remaining > 0)
+	{
+		const auto count = std::min(remaining, chunk_size);
+		if (!old_zip.read(buffer.data(), count) || !out.write(buffer.data(), count))
+			return false;
+		remaining -= count;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes all [zip_entries] and the central directory to [out]. Entries that
+// are being compressed in other threads are waited for (via [wait_compressed],
+// called with the entry index) before they are written.
+// Returns false if writing failed
+// -----------------------------------------------------------------------------
+bool writeZipEntries(
+	SeekableData&                            out,
+	vector<ZipWriteEntry>&                   zip_entries,
+	SeekableData*                            old_zip,
+	const std::function<void(size_t index)>& wait_compressed)
+{
+	// Write entries
+	const auto n_entries = zip_entries.size();
+	uint64_t   offset    = 0;
+	MemChunk   header;
+	for (size_t a = 0; a < n_entries; a++)
+	{
+		ui::setSplashProgress(static_cast<float>(a) / static_cast<float>(n_entries));
+
+		auto& zip_entry = zip_entries[a];
+		if (zip_entry.source)
+			wait_compressed(a);
+
+		// Flag UTF-8 names
+		zip_entry.flags &= ~0x0800;
+		for (auto c : zip_entry.name)
+		{
+			if (static_cast<uint8_t>(c) >= 128)
+			{
+				zip_entry.flags |= 0x0800;
+				break;
+			}
+		}
+
+		// Write local header
+		zip_entry.header_offset = offset;
+		header.clear();
+		writeLocalHeader(header, zip_entry);
+		if (!out.write(header.data(), header.size()))
+		{
+			global::error = "Error writing to file, check there is enough free disk space";
+			return false;
+		}
+
+		// Write data
+		if (zip_entry.copy)
+		{
+			// Copy compressed data as-is from the old zip
+			if (!old_zip || !copyOldZipEntryData(*old_zip, out, zip_entry))
+			{
+				global::error = fmt::format("Unable to copy entry {} from the original zip", zip_entry.name);
+				return false;
+			}
+		}
+		else if (zip_entry.data.size() > 0 && !out.write(zip_entry.data.data(), zip_entry.data.size()))
+		{
+			global::error = "Error writing to file, check there is enough free disk space";
+			return false;
+		}
+		offset += header.size() + zip_entry.compressed_size;
+		zip_entry.data.clear();
+	}
+
+	// Build central directory
+	MemChunk cd;
+	for (const auto& zip_entry : zip_entries)
+		writeCentralDirRecord(cd, zip_entry);
+	const auto cd_offset = offset;
+	const auto cd_size   = cd.size();
+
+	// Zip64 end of central directory record + locator, needed if there are
+	// too many entries or the central directory is past 4GB, for the standard
+	// end of central directory record
+	if (n_entries >= 0xFFFF || cd_offset >= 0xFFFFFFFF)
+	{
+		writeL32(cd, 0x06064b50);
+		writeL64(cd, 44); // Size of the rest of this record
+		writeL16(cd, 45); // Version made by (4.5)
+		writeL16(cd, 45); // Version needed to extract (4.5)
+		writeL32(cd, 0);  // Disk number
+		writeL32(cd, 0);  // Disk with central directory
+		writeL64(cd, n_entries);
+		writeL64(cd, n_entries);
+		writeL64(cd, cd_size);
+		writeL64(cd, cd_offset);
+
+		writeL32(cd, 0x07064b50);
+		writeL32(cd, 0); // Disk with zip64 end of central directory
+		writeL64(cd, cd_offset + cd_size);
+		writeL32(cd, 1); // Total number of disks
+	}
+
+	// End of central directory record
+	const auto n_records = static_cast<uint16_t>(std::min<size_t>(n_entries, 0xFFFF));
+	writeL32(cd, 0x06054b50);
+	writeL16(cd, 0); // Disk number
+	writeL16(cd, 0); // Disk with central directory
+	writeL16(cd, n_records);
+	writeL16(cd, n_records);
+	writeL32(cd, cd_size);
+	writeL32(cd, static_cast<uint32_t>(std::min<uint64_t>(cd_offset, 0xFFFFFFFF)));
+	writeL16(cd, 0); // Comment length
+
+	if (!out.write(cd.data(), cd.size()))
+	{
+		global::error = "Error writing to file, check there is enough free disk space";
+		return false;
+	}
+
+	return true;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // ZipArchive Class Functions
@@ -100,110 +507,44 @@ bool ZipArchive::open(string_view filename)
 	// Copy the zip to a temp file (for use when saving)
 	generateTempFileName(filename);
 	fileutil::copyFile(filename, temp_file_);
+	source_data_.clear();
 
-	// Open the file
-	wxFFileInputStream in(wxutil::strFromView(filename));
-	if (!in.IsOk())
-	{
-		global::error = "Unable to open file";
-		return false;
-	}
-
-	// Create zip stream
-	wxZipInputStream zip(in);
-	if (!zip.IsOk())
-	{
-		global::error = "Invalid zip file";
-		return false;
-	}
+	// Read the central directory (for random access to entry data later)
+	SFile file(filename);
+	if (!readCentralDirectory(file, file.length()))
+		log::warning("ZipArchive::open: Unable to read zip central directory, entry loading will be slower");
+	const auto file_size = file.length();
+	file.close();
 
-	// Stop announcements (don't want to be announcing modification due to entries being added etc)
-	const ArchiveModSignalBlocker sig_blocker{ *this };
+	filename_      = filename;
+	file_modified_ = fileutil::fileModifiedTime(filename);
 
-	// Go through all zip entries
-	int  entry_index = 0;
-	auto zip_entry   = zip.GetNextEntry();
-	ui::setSplashProgressMessage("Reading zip data");
-	while (zip_entry)
+	// Read entries from the cached index if possible (entry data is then
+	// loaded directly via the central directory when needed)
+	const bool use_cache = use_index_cache_ && archiveindexcache::enabled() && !central_dir_.empty();
+	if (!use_cache || !readIndexCache(file_size))
 	{
-		ui::setSplashProgress(-1.0f);
-		if (zip_entry->GetMethod() != wxZIP_METHOD_DEFLATE && zip_entry->GetMethod() != wxZIP_METHOD_STORE)
+		// Open the file
+		wxFFileInputStream in(wxutil::strFromView(filename));
+		if (!in.IsOk())
 		{
-			global::error = "Unsupported zip compression method";
+			global::error = "Unable to open file";
 			return false;
 		}
 
-		if (!zip_entry->IsDir())
-		{
-			// Get the entry name as a Path (so we can break it up)
-			strutil::Path fn(wxutil::strToView(zip_entry->GetName(wxPATH_UNIX)));
-
-			// Create entry
-			auto new_entry = std::make_shared<ArchiveEntry>(
-				misc::fileNameToLumpName(fn.fileName()), zip_entry->GetSize());
-
-			// Setup entry info
-			new_entry->setLoaded(false);
-			new_entry->exProp("ZipIndex") = entry_index;
-
-			// Add entry and directory to directory tree
-			auto ndir = createDir(fn.path(true));
-			ndir->addEntry(new_entry, true);
-
-			if (const auto ze_size = zip_entry->GetSize(); ze_size < max_entry_size_mb * 1024 * 1024)
-			{
-				if (ze_size > 0)
-				{
-					vector<uint8_t> data(ze_size);
-					zip.Read(data.data(), ze_size); // Note: this is where exceedingly large files cause an exception.
-					new_entry->importMem(data.data(), static_cast<uint32_t>(ze_size));
-				}
-				new_entry->setLoaded(true);
-
-				// Determine its type
-				EntryType::detectEntryType(*new_entry);
-
-				// Unload data if needed
-				if (!archive_load_data)
-					new_entry->unloadData();
-			}
-			else
-			{
-				global::error = fmt::format("Entry too large: {} is {} mb", fn.fullPath(), ze_size / (1 << 20));
-				return false;
-			}
-		}
-		else
-		{
-			// Zip entry is a directory, add it to the directory tree
-			strutil::Path fn(wxutil::strToView(zip_entry->GetName(wxPATH_UNIX)));
-			createDir(fn.path(true));
-		}
+		// Read entries
+		if (!readEntries(in))
+			return false;
 
-		// Go to next entry in the zip file
-		delete zip_entry;
-		zip_entry = zip.GetNextEntry();
-		entry_index++;
+		// Update the cached index if needed
+		if (use_cache && !central_dir_.empty())
+			writeIndexCache(file_size);
 	}
-	ui::updateSplash();
-
-	// Set all entries/directories to unmodified
-	vector<ArchiveEntry*> entry_list;
-	putEntryTreeAsList(entry_list);
-	for (auto& entry : entry_list)
-		entry->setState(ArchiveEntry::State::Unmodified);
-
-	// Enable announcements
-	sig_blocker.unblock();
 
 	// Setup variables
-	filename_      = filename;
-	file_modified_ = fileutil::fileModifiedTime(filename);
 	setModified(false);
 	on_disk_ = true;
 
-	ui::setSplashProgressMessage("");
-
 	return true;
 }
 
@@ -213,17 +554,26 @@ bool ZipArchive::open(string_view filename)
 // -----------------------------------------------------------------------------
 bool ZipArchive::open(MemChunk& mc)
 {
-	// Write the MemChunk to a temp file
-	const auto tempfile = app::path("slade-temp-open.zip", app::Dir::Temp);
-	mc.exportFile(tempfile);
+	// Keep a copy of the zip data (for loading entry data and saving), rather
+	// than writing it out to a temp file
+	if (!source_data_.importMem(mc))
+	{
+		global::error = "Invalid zip file";
+		return false;
+	}
 
-	// Load the file
-	const bool success = open(tempfile);
+	// Read the central directory (for random access to entry data later)
+	if (!readCentralDirectory(source_data_, source_data_.size()))
+		log::warning("ZipArchive::open: Unable to read zip central directory, entry loading will be slower");
 
-	// Clean up
-	fileutil::removeFile(tempfile);
+	// Read entries directly from the data
+	wxMemoryInputStream in(source_data_.data(), source_data_.size());
+	if (!readEntries(in))
+		return false;
+
+	setModified(false);
 
-	return success;
+	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -232,20 +582,18 @@ bool ZipArchive::open(MemChunk& mc)
 // -----------------------------------------------------------------------------
 bool ZipArchive::write(MemChunk& mc, bool update)
 {
-	bool success = false;
+	mc.clear();
+	if (!writeZip(mc, update))
+		return false;
 
-	// Write to a temporary file
-	const auto tempfile = app::path("slade-temp-write.zip", app::Dir::Temp);
-	if (write(tempfile, true))
+	// Update the saved copy of the zip data
+	if (update)
 	{
-		// Load file into MemChunk
-		success = mc.importFile(tempfile);
+		source_data_.importMem(mc);
+		readCentralDirectory(source_data_, source_data_.size());
 	}
 
-	// Clean up
-	wxRemoveFile(tempfile);
-
-	return success;
+	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -254,133 +602,33 @@ bool ZipArchive::write(MemChunk& mc, bool update)
 // -----------------------------------------------------------------------------
 bool ZipArchive::write(string_view filename, bool update)
 {
-	// Check for entries with duplicate names (not allowed for zips)
-	auto all_dirs = rootDir()->allDirectories();
-	all_dirs.insert(all_dirs.begin(), rootDir());
-	for (const auto& dir : all_dirs)
-	{
-		if (auto* dup_entry = dir->findDuplicateEntryName())
-		{
-			global::error = fmt::format("Multiple entries named {} found in {}", dup_entry->name(), dup_entry->path());
-			return false;
-		}
-	}
-
 	// Open the file
-	wxFFileOutputStream out(wxutil::strFromView(filename));
-	if (!out.IsOk())
+	SFile out(filename, SFile::Mode::Write);
+	if (!out.isOpen())
 	{
 		global::error = "Unable to open file for saving. Make sure it isn't in use by another program.";
 		return false;
 	}
 
-	// Open as zip for writing
-	wxZipOutputStream zip(out, 9);
-	if (!zip.IsOk())
-	{
-		global::error = "Unable to create zip for saving";
+	if (!writeZip(out, update))
 		return false;
-	}
+	out.close();
 
-	// Open old zip for copying, from the temp file that was copied on opening.
-	// This is used to copy any entries that have been previously saved/compressed
-	// and are unmodified, to greatly speed up zip file saving by not having to
-	// recompress unchanged entries
-	unique_ptr<wxZipInputStream>   inzip;
-	unique_ptr<wxFFileInputStream> in;
-	vector<wxZipEntry*>            c_entries;
-	if (fileutil::fileExists(temp_file_))
+	if (update)
 	{
-		in    = std::make_unique<wxFFileInputStream>(temp_file_);
-		inzip = std::make_unique<wxZipInputStream>(*in);
+		// Update the temp file
+		if (temp_file_.empty())
+			generateTempFileName(filename);
+		fileutil::copyFile(filename, temp_file_);
+		source_data_.clear();
+
+		// Update the central directory info (ZipIndex has been updated to the new layout)
+		SFile file(filename);
+		readCentralDirectory(file, file.length());
+	}
 
-		if (inzip->IsOk())
-		{
-			// Get a list of all entries in the old zip
-			c_entries.resize(inzip->GetTotalEntries(), nullptr);
-			for (unsigned a = 0; a < c_entries.size(); a++)
-			{
-				c_entries[a] = inzip->GetNextEntry();
-
-				// Stop if reading the zip failed
-				if (!c_entries[a])
-					break;
-			}
-			inzip->Reset();
-		}
-		else
-		{
-			in    = nullptr;
-			inzip = nullptr;
-		}
-	}
-
-	// Get a linear list of all entries in the archive
-	vector<ArchiveEntry*> entries;
-	putEntryTreeAsList(entries);
-
-	// Go through all entries
-	auto n_entries = entries.size();
-	ui::setSplashProgressMessage("Writing zip entries");
-	ui::setSplashProgress(0.0f);
-	ui::updateSplash();
-	for (size_t a = 0; a < n_entries; a++)
-	{
-		ui::setSplashProgress(static_cast<float>(a) / static_cast<float>(n_entries));
-
-		if (entries[a]->type() == EntryType::folderType())
-		{
-			// If the current entry is a folder, just write a directory entry and continue
-			zip.PutNextDirEntry(entries[a]->path(true));
-			if (update)
-				entries[a]->setState(ArchiveEntry::State::Unmodified);
-			continue;
-		}
-
-		// Get entry zip index
-		int index = -1;
-		if (entries[a]->exProps().contains("ZipIndex"))
-			index = entries[a]->exProp<int>("ZipIndex");
-
-		auto saname = misc::lumpNameToFileName(entries[a]->name());
-		if (!inzip || entries[a]->state() != ArchiveEntry::State::Unmodified || index < 0
-			|| index >= inzip->GetTotalEntries() || !c_entries[index])
-		{
-			// If the current entry has been changed, or doesn't exist in the old zip,
-			// (re)compress its data and write it to the zip
-			const auto zipentry = new wxZipEntry(entries[a]->path() + saname);
-			zip.PutNextEntry(zipentry);
-			zip.Write(entries[a]->rawData(), entries[a]->size());
-		}
-		else
-		{
-			// If the entry is unmodified and exists in the old zip, just copy it over
-			c_entries[index]->SetName(entries[a]->path() + saname);
-			zip.CopyEntry(c_entries[index], *inzip);
-			inzip->Reset();
-		}
-
-		// Update entry info
-		if (update)
-		{
-			entries[a]->setState(ArchiveEntry::State::Unmodified);
-			entries[a]->exProp("ZipIndex") = static_cast<int>(a);
-		}
-	}
-
-	// Clean up
-	zip.Close();
-	out.Close();
-
-	// Update the temp file
-	if (temp_file_.empty())
-		generateTempFileName(filename);
-	fileutil::copyFile(filename, temp_file_);
-
-	ui::setSplashProgressMessage("");
-
-	return true;
-}
+	return true;
+}
 
 // -----------------------------------------------------------------------------
 // Loads an entry's data from the saved copy of the archive if any.
@@ -406,24 +654,37 @@ bool ZipArchive::loadEntryData(ArchiveEntry* entry)
 
 	// Check that the entry has a zip index
 	int zip_index;
-	if (entry->exProps().contains("ZipIndex"))
-		zip_index = entry->exProp<int>("ZipIndex");
+	if (entry->hasZipIndex())
+		zip_index = entry->zipIndex();
 	else
 	{
 		log::error("ZipArchive::loadEntryData: Entry {} has no zip entry index!", entry->name());
 		return false;
 	}
 
-	// Open the file
-	wxFFileInputStream in(filename_);
-	if (!in.IsOk())
+	// Load directly from the local header offset if we have central directory info for the entry
+	if (zip_index >= 0 && static_cast<size_t>(zip_index) < central_dir_.size())
+	{
+		if (loadEntryDataDirect(entry, central_dir_[zip_index]))
+			return true;
+
+		log::warning("ZipArchive::loadEntryData: Direct load failed for {}, searching zip", entry->name());
+	}
+
+	// Otherwise skip through the zip to the entry
+	std::unique_ptr<wxInputStream> in;
+	if (source_data_.hasData())
+		in = std::make_unique<wxMemoryInputStream>(source_data_.data(), source_data_.size());
+	else
+		in = std::make_unique<wxFFileInputStream>(filename_);
+	if (!in->IsOk())
 	{
 		log::error("ZipArchive::loadEntryData: Unable to open zip file \"{}\"!", filename_);
 		return false;
 	}
 
 	// Create zip stream
-	wxZipInputStream zip(in);
+	wxZipInputStream zip(*in);
 	if (!zip.IsOk())
 	{
 		log::error("ZipArchive::loadEntryData: Invalid zip file \"{}\"!", filename_);
@@ -463,6 +724,24 @@ bool ZipArchive::loadEntryData(ArchiveEntry* entry)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the CRC-32 of [entry]'s data as recorded in the zip central
+// directory, without loading the data. Returns 0 if [entry] has been modified
+// since the zip was opened (or isn't in the central directory)
+// -----------------------------------------------------------------------------
+uint32_t ZipArchive::storedCRC(const ArchiveEntry* entry) const
+{
+	if (!entry || entry->parent() != this || entry->state() != ArchiveEntry::State::Unmodified
+		|| !entry->hasZipIndex())
+		return 0;
+
+	auto index = entry->zipIndex();
+	if (index < 0 || static_cast<size_t>(index) >= central_dir_.size())
+		return 0;
+
+	return central_dir_[index].crc;
+}
+
 // -----------------------------------------------------------------------------
 // Adds [entry] to the end of the namespace matching [add_namespace].
 // If [copy] is true a copy of the entry is added.
@@ -655,6 +934,557 @@ vector<ArchiveEntry*> ZipArchive::findAll(SearchOptions& options)
 	return Archive::findAll(opt);
 }
 
+// -----------------------------------------------------------------------------
+// Reads all entries from the zip data in [in].
+// Returns false if the zip is invalid or an entry couldn't be read
+// -----------------------------------------------------------------------------
+bool ZipArchive::readEntries(wxInputStream& in)
+{
+	// Create zip stream
+	wxZipInputStream zip(in);
+	if (!zip.IsOk())
+	{
+		global::error = "Invalid zip file";
+		return false;
+	}
+
+	// Stop announcements (don't want to be announcing modification due to entries being added etc)
+	const ArchiveModSignalBlocker sig_blocker{ *this };
+
+	// Entry types are detected in parallel, in batches as entries are read
+	EntryTypeDetectionQueue detection_queue(
+		[](ArchiveEntry& entry)
+		{
+			// Unload data if needed
+			if (!archive_load_data)
+				entry.unloadData();
+		});
+
+	// Go through all zip entries
+	int  entry_index = 0;
+	auto zip_entry   = zip.GetNextEntry();
+	ui::setSplashProgressMessage("Reading zip data");
+	while (zip_entry)
+	{
+		ui::setSplashProgress(
+			central_dir_.empty() ? -1.0f : static_cast<float>(entry_index) / static_cast<float>(central_dir_.size()));
+
+		if (openCancelled())
+		{
+			delete zip_entry;
+			global::error = "Opening cancelled";
+			return false;
+		}
+
+		if (zip_entry->GetMethod() != wxZIP_METHOD_DEFLATE && zip_entry->GetMethod() != wxZIP_METHOD_STORE)
+		{
+			global::error = "Unsupported zip compression method";
+			return false;
+		}
+
+		if (!zip_entry->IsDir())
+		{
+			// Get the entry name as a Path (so we can break it up)
+			strutil::Path fn(wxutil::strToView(zip_entry->GetName(wxPATH_UNIX)));
+
+			// Create entry
+			auto new_entry = std::make_shared<ArchiveEntry>(
+				misc::fileNameToLumpName(fn.fileName()), zip_entry->GetSize());
+
+			// Setup entry info
+			new_entry->setLoaded(false);
+			new_entry->setZipIndex(entry_index);
+
+			// Add entry and directory to directory tree
+			auto ndir = createDir(fn.path(true));
+			ndir->addEntry(new_entry, true);
+
+			if (const auto ze_size = zip_entry->GetSize(); ze_size < max_entry_size_mb * 1024 * 1024)
+			{
+				if (ze_size > 0)
+				{
+					vector<uint8_t> data(ze_size);
+					zip.Read(data.data(), ze_size); // Note: this is where exceedingly large files cause an exception.
+					new_entry->importMem(data.data(), static_cast<uint32_t>(ze_size));
+				}
+				new_entry->setLoaded(true);
+
+				// Queue entry for type detection
+				detection_queue.add(new_entry.get());
+			}
+			else
+			{
+				global::error = fmt::format("Entry too large: {} is {} mb", fn.fullPath(), ze_size / (1 << 20));
+				return false;
+			}
+		}
+		else
+		{
+			// Zip entry is a directory, add it to the directory tree
+			strutil::Path fn(wxutil::strToView(zip_entry->GetName(wxPATH_UNIX)));
+			createDir(fn.path(true));
+		}
+
+		// Go to next entry in the zip file
+		delete zip_entry;
+		zip_entry = zip.GetNextEntry();
+		entry_index++;
+	}
+	detection_queue.flush();
+	ui::updateSplash();
+
+	// Don't use the central directory if it doesn't match what was read
+	if (central_dir_.size() != static_cast<size_t>(entry_index))
+		central_dir_.clear();
+
+	// Set all entries/directories to unmodified
+	vector<ArchiveEntry*> entry_list;
+	putEntryTreeAsList(entry_list);
+	for (auto& entry : entry_list)
+		entry->setState(ArchiveEntry::State::Unmodified);
+
+	// Enable announcements
+	sig_blocker.unblock();
+
+	ui::setSplashProgressMessage("");
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the zip archive to [out]. If [update] is true, entries are set to
+// unmodified and their ZipIndex updated to match the written zip.
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool ZipArchive::writeZip(SeekableData& out, bool update)
+{
+	// Check for entries with duplicate names (not allowed for zips)
+	auto all_dirs = rootDir()->allDirectories();
+	all_dirs.insert(all_dirs.begin(), rootDir());
+	for (const auto& dir : all_dirs)
+	{
+		if (auto* dup_entry = dir->findDuplicateEntryName())
+		{
+			global::error = fmt::format("Multiple entries named {} found in {}", dup_entry->name(), dup_entry->path());
+			return false;
+		}
+	}
+
+	// Get a linear list of all entries in the archive
+	vector<ArchiveEntry*> entries;
+	putEntryTreeAsList(entries);
+
+	// Get the old zip data for copying, either from memory (if opened from
+	// another entry) or the temp file that was copied on opening. This is used
+	// to copy any entries that have been previously saved/compressed and are
+	// unmodified, to greatly speed up zip file saving by not having to
+	// recompress unchanged entries
+	SFile         old_file;
+	SeekableData* old_zip = nullptr;
+	if (!central_dir_.empty())
+	{
+		if (source_data_.hasData())
+			old_zip = &source_data_;
+		else if (fileutil::fileExists(temp_file_) && old_file.open(temp_file_))
+			old_zip = &old_file;
+	}
+
+	// Setup the info to write for each entry
+	const auto            n_entries = entries.size();
+	const auto            dos_time  = static_cast<uint32_t>(wxDateTime::Now().GetAsDOS());
+	vector<ZipWriteEntry> zip_entries(n_entries);
+	vector<size_t>        to_compress;
+	for (size_t a = 0; a < n_entries; a++)
+	{
+		auto  entry     = entries[a];
+		auto& zip_entry = zip_entries[a];
+
+		zip_entry.dos_time = dos_time;
+		if (entry->type() == EntryType::folderType())
+		{
+			// Folder, just needs a directory entry
+			zip_entry.name   = zipEntryName(entry->path(true), true);
+			zip_entry.is_dir = true;
+			continue;
+		}
+
+		zip_entry.name = zipEntryName(entry->path() + misc::lumpNameToFileName(entry->name()), false);
+
+		// Check if the entry exists in the old zip
+		int index = -1;
+		if (entry->hasZipIndex())
+			index = entry->zipIndex();
+		if (old_zip && index >= 0 && index < static_cast<int>(central_dir_.size()))
+		{
+			const auto& cd_entry          = central_dir_[index];
+			zip_entry.has_old             = true;
+			zip_entry.old.header_offset   = cd_entry.header_offset;
+			zip_entry.old.flags           = cd_entry.flags;
+			zip_entry.old.method          = cd_entry.method;
+			zip_entry.old.dos_time        = cd_entry.dos_time;
+			zip_entry.old.crc             = cd_entry.crc;
+			zip_entry.old.size            = cd_entry.size;
+			zip_entry.old.compressed_size = cd_entry.compressed_size;
+
+			// Unmodified entries can be copied straight over
+			if (entry->state() == ArchiveEntry::State::Unmodified)
+			{
+				zip_entry.copyOld();
+				continue;
+			}
+		}
+
+		// Otherwise the entry data needs to be (re)compressed (unless it turns out
+		// to be unchanged), make sure it's loaded here since it can't be done from
+		// the compression threads
+		zip_entry.source = &entry->data();
+		to_compress.push_back(a);
+
+		// Pick the compression level from the entry type
+		if (isCompressedFormat(entry->type()->formatId()))
+			zip_entry.level = std::clamp<int>(zip_level_compressed, 0, 9);
+		else
+		{
+			zip_entry.level = std::clamp<int>(zip_level_default, 0, 9);
+			if (entry->type() == EntryType::unknownType())
+				zip_entry.entropy_level = std::clamp<int>(zip_level_high_entropy, 0, 9);
+		}
+	}
+
+	// Compress entry data on the task workers, each grabbing the next entry to
+	// compress until there are none left. Entries are written (in order) on
+	// this thread as soon as they are ready
+	std::mutex              ready_mutex;
+	std::condition_variable ready_cv;
+	std::atomic<size_t>     next_index{ 0 };
+	auto                    compress_next = [&]()
+	{
+		const auto index = next_index++;
+		if (index >= to_compress.size())
+			return false;
+
+		auto& zip_entry = zip_entries[to_compress[index]];
+		compressZipEntry(zip_entry);
+
+		std::lock_guard lock(ready_mutex);
+		zip_entry.ready = true;
+		ready_cv.notify_all();
+		return true;
+	};
+	auto compress_task = tasks::run(
+		[&](const tasks::Task& task)
+		{ tasks::parallelFor(0, to_compress.size(), [&](unsigned) { compress_next(); }, 1, &task); });
+
+	// Waits for the entry at [index] to be compressed. Entries are compressed
+	// on this thread until it has been started, in case the workers are busy
+	auto wait_compressed = [&](size_t index)
+	{
+		const auto pos = static_cast<size_t>(
+			std::lower_bound(to_compress.begin(), to_compress.end(), index) - to_compress.begin());
+		while (next_index <= pos)
+			if (!compress_next())
+				break;
+
+		std::unique_lock lock(ready_mutex);
+		ready_cv.wait(lock, [&] { return zip_entries[index].ready; });
+	};
+
+	// Write entries
+	ui::setSplashProgressMessage("Writing zip entries");
+	ui::setSplashProgress(0.0f);
+	ui::updateSplash();
+	auto success = writeZipEntries(out, zip_entries, old_zip, wait_compressed);
+	compress_task.cancel();
+	compress_task.wait();
+
+	if (!success)
+	{
+		ui::setSplashProgressMessage("");
+		return false;
+	}
+
+	// Update entry info
+	if (update)
+	{
+		for (size_t a = 0; a < n_entries; a++)
+		{
+			entries[a]->setState(ArchiveEntry::State::Unmodified);
+			if (!zip_entries[a].is_dir)
+				entries[a]->setZipIndex(a);
+		}
+	}
+
+	ui::setSplashProgressMessage("");
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads the central directory of the zip [data], so that entry data can be
+// loaded directly from its offset without iterating through the zip.
+// Returns false if the central directory couldn't be read
+// -----------------------------------------------------------------------------
+bool ZipArchive::readCentralDirectory(SeekableData& data, uint64_t data_size)
+{
+	central_dir_.clear();
+
+	if (data_size < 22)
+		return false;
+
+	// Find the end of central directory record (searching back from the end,
+	// since it can be followed by a comment of up to 64kb)
+	const auto tail_size = static_cast<unsigned>(std::min<uint64_t>(data_size, 22 + 65535));
+	MemChunk   tail(tail_size);
+	data.seekFromStart(data_size - tail_size);
+	if (!data.read(tail.data(), tail_size))
+		return false;
+
+	int eocd = -1;
+	for (int a = static_cast<int>(tail_size) - 22; a >= 0; --a)
+	{
+		if (tail.readL32(a) == 0x06054b50)
+		{
+			eocd = a;
+			break;
+		}
+	}
+	if (eocd < 0)
+		return false;
+
+	uint64_t num_entries = tail.readL16(eocd + 10);
+	uint64_t cd_size     = tail.readL32(eocd + 12);
+	uint64_t cd_offset   = tail.readL32(eocd + 16);
+
+	// Saturated values mean the real ones are in the zip64 end of central
+	// directory record, found via the locator directly before the standard one
+	if (num_entries == 0xFFFF || cd_size == 0xFFFFFFFF || cd_offset == 0xFFFFFFFF)
+	{
+		if (eocd < 20 || tail.readL32(eocd - 20) != 0x07064b50)
+			return false;
+
+		uint8_t record[56];
+		if (!data.seekFromStart(readL64(tail, eocd - 12)) || !data.read(record, 56))
+			return false;
+		const MemChunk zip64_eocd(record, 56);
+		if (zip64_eocd.readL32(0) != 0x06064b50)
+			return false;
+
+		num_entries = readL64(zip64_eocd, 32);
+		cd_size     = readL64(zip64_eocd, 40);
+		cd_offset   = readL64(zip64_eocd, 48);
+	}
+
+	// The central directory itself is always read into memory
+	if (cd_offset + cd_size > data_size || cd_size > 0xFFFFFFFF)
+		return false;
+
+	// Read the central directory
+	MemChunk cd(static_cast<uint32_t>(cd_size));
+	data.seekFromStart(cd_offset);
+	if (cd_size > 0 && !data.read(cd.data(), cd_size))
+		return false;
+
+	// Read entry info from each central directory record
+	if (num_entries > cd_size / 46)
+		return false;
+	central_dir_.resize(num_entries);
+	unsigned pos = 0;
+	for (auto& cd_entry : central_dir_)
+	{
+		if (pos + 46 > cd_size || cd.readL32(pos) != 0x02014b50)
+		{
+			central_dir_.clear();
+			return false;
+		}
+
+		const unsigned name_len  = cd.readL16(pos + 28);
+		const unsigned extra_len = cd.readL16(pos + 30);
+
+		cd_entry.flags           = cd.readL16(pos + 8);
+		cd_entry.method          = cd.readL16(pos + 10);
+		cd_entry.dos_time        = cd.readL32(pos + 12);
+		cd_entry.crc             = cd.readL32(pos + 16);
+		cd_entry.compressed_size = cd.readL32(pos + 20);
+		cd_entry.size            = cd.readL32(pos + 24);
+		cd_entry.header_offset   = cd.readL32(pos + 42);
+
+		// The local header offset is in the zip64 extra field if saturated.
+		// Entries whose sizes are saturated are too large to load anyway, and
+		// are left with their 32-bit placeholder sizes
+		if (cd_entry.header_offset == 0xFFFFFFFF && pos + 46 + name_len + extra_len <= cd_size)
+		{
+			unsigned extra     = pos + 46 + name_len;
+			unsigned extra_end = extra + extra_len;
+			while (extra + 4 <= extra_end)
+			{
+				const unsigned tag  = cd.readL16(extra);
+				const unsigned size = cd.readL16(extra + 2);
+				if (tag == 0x0001)
+				{
+					// Fields are only present if saturated, in this order
+					unsigned field = extra + 4;
+					if (cd_entry.size == 0xFFFFFFFF)
+						field += 8;
+					if (cd_entry.compressed_size == 0xFFFFFFFF)
+						field += 8;
+					if (field + 8 <= extra + 4 + size && field + 8 <= extra_end)
+						cd_entry.header_offset = readL64(cd, field);
+					break;
+				}
+				extra += 4 + size;
+			}
+		}
+
+		// Next record (skip name, extra field and comment)
+		pos += 46 + name_len + extra_len + cd.readL16(pos + 32);
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Loads [entry]'s data by seeking directly to its local header in the zip data
+// (or file), using the info in [cd_entry] from the central directory.
+// Returns false if the data couldn't be read
+// -----------------------------------------------------------------------------
+bool ZipArchive::loadEntryDataDirect(ArchiveEntry* entry, const CentralDirEntry& cd_entry)
+{
+	if (cd_entry.method != wxZIP_METHOD_DEFLATE && cd_entry.method != wxZIP_METHOD_STORE)
+		return false;
+
+	SFile         file;
+	SeekableData* zip = &source_data_;
+	if (!source_data_.hasData())
+	{
+		if (!file.open(filename_))
+			return false;
+		zip = &file;
+	}
+
+	// Read the local file header
+	uint8_t header[30];
+	if (!zip->seekFromStart(cd_entry.header_offset) || !zip->read(header, 30))
+		return false;
+	const MemChunk lh(header, 30);
+	if (lh.readL32(0) != 0x04034b50)
+		return false;
+
+	// Skip the name and extra field to get to the entry data
+	zip->seek(lh.readL16(26) + lh.readL16(28));
+
+	// Read the (possibly compressed) data
+	MemChunk data(cd_entry.compressed_size);
+	if (cd_entry.compressed_size > 0 && !zip->read(data.data(), cd_entry.compressed_size))
+		return false;
+
+	// Decompress if needed
+	entry->lockState();
+	if (cd_entry.method == wxZIP_METHOD_DEFLATE)
+	{
+		MemChunk inflated;
+		if (!compression::zipInflate(data, inflated, cd_entry.size))
+		{
+			entry->unlockState();
+			return false;
+		}
+		entry->importMemChunk(inflated);
+	}
+	else
+		entry->importMemChunk(data);
+
+	entry->setLoaded();
+	entry->unlockState();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads entries from the cached index for this zip (if one exists and matches
+// the central directory), instead of reading and detecting each entry's data.
+// [file_size] is the size of the zip file on disk.
+// Returns true if the cached index was used
+// -----------------------------------------------------------------------------
+bool ZipArchive::readIndexCache(uint64_t file_size)
+{
+	vector<archiveindexcache::EntryInfo> cached;
+	if (!archiveindexcache::read(filename_, file_size, file_modified_, cached))
+		return false;
+
+	// Check the cached index matches the central directory
+	for (const auto& info : cached)
+		if (!info.name.empty()
+			&& (info.location >= central_dir_.size() || central_dir_[info.location].size != info.size))
+			return false;
+
+	// Stop announcements (don't want to be announcing modification due to entries being added etc)
+	const ArchiveModSignalBlocker sig_blocker{ *this };
+
+	// Create directories and entries (directories are first in the index)
+	for (const auto& info : cached)
+	{
+		auto dir = createDir(info.path);
+		if (info.name.empty())
+			continue;
+
+		auto entry = std::make_shared<ArchiveEntry>(info.name, info.size);
+		entry->setLoaded(false);
+		entry->setZipIndex(info.location);
+		entry->setType(EntryType::fromId(info.type_id), info.reliability);
+		dir->addEntry(entry, true);
+	}
+
+	// Set all entries/directories to unmodified
+	vector<ArchiveEntry*> entry_list;
+	putEntryTreeAsList(entry_list);
+	for (auto& entry : entry_list)
+		entry->setState(ArchiveEntry::State::Unmodified);
+
+	// Enable announcements
+	sig_blocker.unblock();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the cached index for this zip, with the given [file_size] of the zip
+// file on disk
+// -----------------------------------------------------------------------------
+void ZipArchive::writeIndexCache(uint64_t file_size)
+{
+	vector<archiveindexcache::EntryInfo> index;
+
+	// Directories (in tree order, so they are re-created in the same order)
+	for (const auto& dir : rootDir()->allDirectories())
+		index.push_back({ dir->path(true) });
+
+	// Entries (in zip order, so they are added to each directory in the same order)
+	vector<ArchiveEntry*> entries;
+	putEntryTreeAsList(entries);
+	vector<archiveindexcache::EntryInfo> entry_index;
+	for (auto* entry : entries)
+	{
+		if (entry->type() == EntryType::folderType())
+			continue;
+
+		archiveindexcache::EntryInfo info;
+		info.path        = entry->path();
+		info.name        = entry->name();
+		info.size        = entry->size();
+		info.location    = entry->zipIndex();
+		info.type_id     = entry->type()->id();
+		info.reliability = static_cast<uint8_t>(entry->reliability());
+		entry_index.push_back(info);
+	}
+	std::sort(
+		entry_index.begin(),
+		entry_index.end(),
+		[](const archiveindexcache::EntryInfo& left, const archiveindexcache::EntryInfo& right)
+		{ return left.location < right.location; });
+	index.insert(index.end(), entry_index.begin(), entry_index.end());
+
+	archiveindexcache::write(filename_, file_size, file_modified_, index);
+}
+
 // -----------------------------------------------------------------------------
 // Generates the temp file path to use, from [filename].
 // The temp file will be in the configured temp folder
@@ -690,7 +1520,7 @@ void ZipArchive::generateTempFileName(string_view filename)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid zip archive
 // -----------------------------------------------------------------------------
-bool ZipArchive::isZipArchive(MemChunk& mc)
+bool ZipArchive::isZipArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 22)
@@ -698,8 +1528,7 @@ bool ZipArchive::isZipArchive(MemChunk& mc)
 
 	// Read first 4 bytes
 	uint32_t sig;
-	mc.seek(0, SEEK_SET);
-	mc.read(&sig, sizeof(uint32_t));
+	mc.read(0, &sig, sizeof(uint32_t));
 
 	// Check for signature
 	if (sig != 0x04034b50 && // File header
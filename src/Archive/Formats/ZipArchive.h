@@ -19,7 +19,8 @@ public:
 	bool write(string_view filename, bool update = true) override; // Write to File
 
 	// Misc
-	bool loadEntryData(ArchiveEntry* entry) override;
+	bool     loadEntryData(ArchiveEntry* entry) override;
+	uint32_t storedCRC(const ArchiveEntry* entry) const;
 
 	// Entry addition/removal
 	shared_ptr<ArchiveEntry> addEntry(shared_ptr<ArchiveEntry> entry, string_view add_namespace) override;
@@ -34,12 +35,32 @@ public:
 	vector<ArchiveEntry*> findAll(SearchOptions& options) override;
 
 	// Static functions
-	static bool isZipArchive(MemChunk& mc);
+	static bool isZipArchive(const MemChunk& mc);
 	static bool isZipArchive(const string& filename);
 
 private:
-	string temp_file_;
+	// Info for an entry read from the zip central directory
+	struct CentralDirEntry
+	{
+		uint64_t header_offset   = 0; // Offset of the entry's local file header
+		uint32_t compressed_size = 0;
+		uint32_t size            = 0;
+		uint32_t crc             = 0;
+		uint32_t dos_time        = 0; // Modification time+date (MS-DOS format)
+		uint16_t flags           = 0;
+		uint16_t method          = 0;
+	};
+
+	string                  temp_file_;
+	MemChunk                source_data_; // Zip data, if opened from memory (eg. an entry in another archive)
+	vector<CentralDirEntry> central_dir_; // Indexed by ZipIndex
 
 	void generateTempFileName(string_view filename);
+	bool readEntries(wxInputStream& in);
+	bool writeZip(SeekableData& out, bool update);
+	bool readCentralDirectory(SeekableData& data, uint64_t data_size);
+	bool loadEntryDataDirect(ArchiveEntry* entry, const CentralDirEntry& cd_entry);
+	bool readIndexCache(uint64_t file_size);
+	void writeIndexCache(uint64_t file_size);
 };
 } // namespace slade
@@ -31,8 +31,12 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "AudioTags.h"
+#include "Archive/ArchiveEntry.h"
+#include "Archive/EntryType/EntryType.h"
 #include "Utility/Memory.h"
 #include <SFML/System.hpp>
+#include <deque>
+#include <mutex>
 
 using namespace slade;
 
@@ -250,6 +254,14 @@ enum ID3v2Frames
 	ID3_TRCK = 0x5452434B,
 	ID3_TYER = 0x54594552,
 };
+
+// A frame in an ID3v2 tag (see indexID3v2Frames)
+struct ID3v2Frame
+{
+	size_t id;     // Frame identifier, as a big-endian integer
+	size_t offset; // Offset of the frame data
+	size_t size;   // Size of the frame data
+};
 } // namespace
 
 
@@ -260,6 +272,18 @@ enum ID3v2Frames
 // -----------------------------------------------------------------------------
 namespace
 {
+// Cache of recently parsed tag info, keyed by entry content hash and type
+// (most recent last)
+struct CachedTagInfo
+{
+	uint64_t         hash;
+	const EntryType* type;
+	wxString         info;
+};
+constexpr unsigned        MAX_CACHED_TAG_INFO = 256;
+std::mutex                tag_cache_mutex;
+std::deque<CachedTagInfo> tag_cache;
+
 // clang-format off
 const char * const id3v1_genres[] =
 {
@@ -368,13 +392,13 @@ wxString buildID3v2GenreString(wxString content)
 	return genre;
 }
 
-wxString parseID3v1Tag(MemChunk& mc, size_t start)
+wxString parseID3v1Tag(const MemChunk& mc, size_t start)
 {
 	ID3v1    tag;
 	wxString version, title, artist, album, comment, genre, year;
 	int      track = 0;
 
-	mc.read(&tag, 128, start);
+	mc.read(start, &tag, 128);
 	title   = wxString::FromAscii(tag.title, 30);
 	artist  = wxString::FromAscii(tag.artist, 30);
 	album   = wxString::FromAscii(tag.album, 30);
@@ -396,7 +420,7 @@ wxString parseID3v1Tag(MemChunk& mc, size_t start)
 		ID3v1e etag;
 		version += '+';
 
-		mc.read(&etag, 227, start - 227);
+		mc.read(start - 227, &etag, 227);
 		title += wxString::FromAscii(etag.title, 60);
 		artist += wxString::FromAscii(etag.artist, 60);
 		album += wxString::FromAscii(etag.album, 60);
@@ -419,176 +443,194 @@ wxString parseID3v1Tag(MemChunk& mc, size_t start)
 	return ret;
 }
 
-wxString parseID3v2Tag(MemChunk& mc, size_t start)
+// -----------------------------------------------------------------------------
+// Returns an index of the frames in the ID3v2 tag at [start] in [mc]. Only the
+// frame headers are read, frames with flags set (compression, encryption etc.)
+// are skipped, as are any frames extending past the end of the tag
+// -----------------------------------------------------------------------------
+vector<ID3v2Frame> indexID3v2Frames(const MemChunk& mc, size_t start)
 {
-	wxString version, title, artist, composer, copyright, album, genre, year, group, subtitle, track, comments;
-	bool     artists = false;
-
-	version  = wxString::Format("ID3v2.%d.%d", mc[start + 3], mc[start + 4]);
-	bool v22 = mc[start + 3] < 3;
+	vector<ID3v2Frame> frames;
 
 	// ID3v2.2 frame headers have a size of 6 (3 byte identifier, 3 byte size).
 	// ID3v2.3 and v2.4 frame headers have a size of 10 (4 byte identifier, 4 byte size, 2 byte flags)
+	bool   v22  = mc[start + 3] < 3;
 	size_t step = v22 ? 6 : 10;
 
 	// Compute synchsafe size
 	size_t size = (mc[start + 6] << 21) + (mc[start + 7] << 14) + (mc[start + 8] << 7) + mc[start + 9] + 10;
-	size_t end  = start + size;
+	size_t end  = std::min<size_t>(start + size, mc.size());
 
-	// ID3v2.2 tag frames have three-char identifiers.
-	// We only care about a little subset of them, though.
+	// Iterate through frame headers. The minimal size of a frame is 1 byte of data.
 	size_t s = start + 10;
-
-	// Iterate through frames. The minimal size of a frame is 1 byte of data.
 	while (s + step + 1 < end)
 	{
 		size_t fsize = v22 ? mc.readB24(s + 3) : mc.readB32(s + 4);
 
-		// One byte for encoding
-		size_t tsize = fsize - 1;
+		// Parsing stops when padding starts
+		if (mc[s] == 0 && fsize == 0)
+			break;
 
-		// Process only text frames that aren't empty
-		// Also skip flags, not gonna bother with encryption or compression
-		if ((mc[s] == 'T' || (mc[s] == 'C' && mc[s + 1] == 'O' && mc[s + 2] == 'M')) && tsize > 0
-			&& (v22 || (mc[s + 8] == 0 && mc[s + 9] == 0)))
-		{
-			wxString content;
+		if (s + step + fsize <= end && (v22 || (mc[s + 8] == 0 && mc[s + 9] == 0)))
+			frames.push_back({ v22 ? mc.readB24(s) : mc.readB32(s), s + step, fsize });
+
+		s += (fsize + step);
+	}
 
-			// First step: retrieve the text (UTF-16 massively sucks)
-			auto buffer = new char[fsize];
-			mc.read(buffer, tsize, s + step + 1);
-			size_t frame = v22 ? mc.readB24(s) : mc.readB32(s);
+	return frames;
+}
 
-			bool   bomle = true;
-			size_t bom   = 0;
-			switch (mc[s + step])
+// -----------------------------------------------------------------------------
+// Decodes the text content of ID3v2 text [frame] in [mc]
+// -----------------------------------------------------------------------------
+wxString decodeID3v2Text(const MemChunk& mc, const ID3v2Frame& frame)
+{
+	// One byte for encoding
+	auto   data   = mc.data() + frame.offset;
+	auto   buffer = data + 1;
+	size_t tsize  = frame.size - 1;
+
+	// Retrieve the text (UTF-16 massively sucks)
+	bool   bomle = true;
+	size_t bom   = 0;
+	switch (data[0])
+	{
+	case 0: // Plain old ASCII
+		return wxString::From8BitData((const char*)buffer, tsize);
+	case 1: // UTF-16 with byte order mark
+	{
+		size_t i = 1;
+		while (i + 3 < tsize)
+		{
+			bom = i + 1;
+			// Looks like stuffing garbage before the actual content is popular
+			if (data[i] == 0xFF && data[i + 1] == 0xFE && data[i + 2] != 0)
 			{
-			case 0: // Plain old ASCII
-				content = wxString::From8BitData(buffer, tsize);
+				bomle = true;
 				break;
-			case 1: // UTF-16 with byte order mark
-			{
-				size_t i = 1;
-				while (i < tsize - 3)
-				{
-					bom = i + 1;
-					// Looks like stuffing garbage before the actual content is popular
-					if (mc[s + step + i] == 0xFF && mc[s + step + i + 1] == 0xFE && mc[s + step + i + 2] != 0)
-					{
-						bomle = true;
-						break;
-					}
-					if (mc[s + step + i] == 0xFE && mc[s + step + i + 1] == 0xFF && mc[s + step + i + 3] != 0)
-					{
-						bomle = false;
-						break;
-					}
-					++i;
-				}
 			}
-				// Fall through
-			case 2: // UTF-16 without byte order mark
+			if (data[i] == 0xFE && data[i + 1] == 0xFF && data[i + 3] != 0)
 			{
-				// You're right, wxWidgets. Code like this is so much
-				// better than having something like wxString::FromUTF16()
-				size_t u16c   = (tsize - bom) / 2;
-				auto   wchars = new wchar_t[u16c];
-				for (size_t i = 0; i < u16c; ++i)
-				{
-					if (bomle)
-						wchars[i] = (wchar_t)memory::readL16((const uint8_t*)buffer, bom + 2 * i);
-					else
-						wchars[i] = (wchar_t)memory::readB16((const uint8_t*)buffer, bom + 2 * i);
-				}
-				content = wxString(wchars, u16c);
-				delete[] wchars;
-			}
-			break;
-			case 3: // UTF-8
-				content = wxString::FromUTF8(buffer, tsize);
+				bomle = false;
 				break;
 			}
-			delete[] buffer;
+			++i;
+		}
+	}
+		// Fall through
+	case 2: // UTF-16 without byte order mark
+	{
+		// You're right, wxWidgets. Code like this is so much
+		// better than having something like wxString::FromUTF16()
+		size_t          u16c = bom < tsize ? (tsize - bom) / 2 : 0;
+		vector<wchar_t> wchars(u16c);
+		for (size_t i = 0; i < u16c; ++i)
+		{
+			if (bomle)
+				wchars[i] = (wchar_t)memory::readL16(buffer, bom + 2 * i);
+			else
+				wchars[i] = (wchar_t)memory::readB16(buffer, bom + 2 * i);
+		}
+		return wxString(wchars.data(), u16c);
+	}
+	case 3: // UTF-8
+		return wxString::FromUTF8((const char*)buffer, tsize);
+	default: return {};
+	}
+}
 
-			// Second step: treat frame accordingly to type
-			switch (frame)
+wxString parseID3v2Tag(const MemChunk& mc, size_t start)
+{
+	wxString version, title, artist, composer, copyright, album, genre, year, group, subtitle, track, comments;
+	bool     artists = false;
+
+	version = wxString::Format("ID3v2.%d.%d", mc[start + 3], mc[start + 4]);
+
+	// Go through the tag's text frames that aren't empty. Frame contents are
+	// only decoded for the frames we show (eg. large comments or binary frames
+	// like attached pictures are skipped over)
+	for (const auto& frame : indexID3v2Frames(mc, start))
+	{
+		if (frame.size <= 1)
+			continue;
+
+		auto content = [&]() { return decodeID3v2Text(mc, frame); };
+
+		// Treat frame accordingly to type
+		switch (frame.id)
+		{
+		case ID3_COM:  // Comments
+		case ID3_COMM: // Comments
+			if (comments.length())
+				comments += "\n\n";
+			comments += content();
+			break;
+		case ID3_TAL:  // Album/Movie/Show title
+		case ID3_TOT:  // Original album/movie/show title
+		case ID3_TALB: // Album/Movie/Show title
+		case ID3_TOAL: // Original album/movie/show title
+			if (album.length())
+				album += " / ";
+			album += content();
+			break;
+		case ID3_TCM:  // Composer
+		case ID3_TCOM: // Composer
+			composer = content();
+			break;
+		case ID3_TCO:  // Content type
+		case ID3_TCON: // Content type
+			genre = buildID3v2GenreString(content());
+			break;
+		case ID3_TCR:  // Copyright message
+		case ID3_TCOP: // Copyright message
+			copyright = content();
+			break;
+		case ID3_TOA:  // Original artist(s)/performer(s)
+		case ID3_TOL:  // Original Lyricist(s)/text writer(s)
+		case ID3_TP1:  // Lead artist(s)/Lead performer(s)/Soloist(s)/Performing group
+		case ID3_TP2:  // Band/Orchestra/Accompaniment
+		case ID3_TP3:  // Conductor/Performer refinement
+		case ID3_TP4:  // Interpreted, remixed, or otherwise modified by
+		case ID3_TXT:  // Lyricist/text writer
+		case ID3_TEXT: // Lyricist/Text writer
+		case ID3_TOLY: // Original lyricist(s)/text writer(s)
+		case ID3_TOPE: // Original artist(s)/performer(s)
+		case ID3_TPE1: // Lead performer(s)/Soloist(s)
+		case ID3_TPE2: // Band/orchestra/accompaniment
+		case ID3_TPE3: // Conductor/performer refinement
+		case ID3_TPE4: // Interpreted, remixed, or otherwise modified by
+			if (artist.length())
 			{
-			case ID3_COM:  // Comments
-			case ID3_COMM: // Comments
-				if (comments.length())
-					comments += "\n\n";
-				comments += content;
-				break;
-			case ID3_TAL:  // Album/Movie/Show title
-			case ID3_TOT:  // Original album/movie/show title
-			case ID3_TALB: // Album/Movie/Show title
-			case ID3_TOAL: // Original album/movie/show title
-				if (album.length())
-					album += " / ";
-				album += content;
-				break;
-			case ID3_TCM:  // Composer
-			case ID3_TCOM: // Composer
-				composer = content;
-				break;
-			case ID3_TCO:  // Content type
-			case ID3_TCON: // Content type
-				genre = buildID3v2GenreString(content);
-				break;
-			case ID3_TCR:  // Copyright message
-			case ID3_TCOP: // Copyright message
-				copyright = content;
-				break;
-			case ID3_TOA:  // Original artist(s)/performer(s)
-			case ID3_TOL:  // Original Lyricist(s)/text writer(s)
-			case ID3_TP1:  // Lead artist(s)/Lead performer(s)/Soloist(s)/Performing group
-			case ID3_TP2:  // Band/Orchestra/Accompaniment
-			case ID3_TP3:  // Conductor/Performer refinement
-			case ID3_TP4:  // Interpreted, remixed, or otherwise modified by
-			case ID3_TXT:  // Lyricist/text writer
-			case ID3_TEXT: // Lyricist/Text writer
-			case ID3_TOLY: // Original lyricist(s)/text writer(s)
-			case ID3_TOPE: // Original artist(s)/performer(s)
-			case ID3_TPE1: // Lead performer(s)/Soloist(s)
-			case ID3_TPE2: // Band/orchestra/accompaniment
-			case ID3_TPE3: // Conductor/performer refinement
-			case ID3_TPE4: // Interpreted, remixed, or otherwise modified by
-				if (artist.length())
-				{
-					artist += " / ";
-					artists = true;
-				}
-				artist += content;
-				break;
-			case ID3_TRK:  // Track number/Position in set
-			case ID3_TRCK: // Track number/Position in set
-				track = content;
-				break;
-			case ID3_TT1:  // Content group description
-			case ID3_TIT1: // Content group description
-				group = content;
-				break;
-			case ID3_TT2:  // Title/Songname/Content description
-			case ID3_TIT2: // Title/songname/content description
-				title = content;
-				break;
-			case ID3_TT3:  // Subtitle/Description refinement
-			case ID3_TIT3: // Subtitle/Description refinement
-				group = content;
-				break;
-			case ID3_TYE:  // Year
-			case ID3_TYER: // Year
-				year = content;
-				break;
-			case ID3_TDRC: // Recording time (precision varies between yyyy and yyyy-MM-ddTHH:mm:ss)
-				year = content.Left(4);
-				break;
+				artist += " / ";
+				artists = true;
 			}
-		}
-		// Parsing stops when padding starts
-		else if (mc[s] == 0 && fsize == 0)
+			artist += content();
 			break;
-		s += (fsize + step);
+		case ID3_TRK:  // Track number/Position in set
+		case ID3_TRCK: // Track number/Position in set
+			track = content();
+			break;
+		case ID3_TT1:  // Content group description
+		case ID3_TIT1: // Content group description
+			group = content();
+			break;
+		case ID3_TT2:  // Title/Songname/Content description
+		case ID3_TIT2: // Title/songname/content description
+			title = content();
+			break;
+		case ID3_TT3:  // Subtitle/Description refinement
+		case ID3_TIT3: // Subtitle/Description refinement
+			group = content();
+			break;
+		case ID3_TYE:  // Year
+		case ID3_TYER: // Year
+			year = content();
+			break;
+		case ID3_TDRC: // Recording time (precision varies between yyyy and yyyy-MM-ddTHH:mm:ss)
+			year = content().Left(4);
+			break;
+		default: break;
+		}
 	}
 
 	wxString ret = version + '\n';
@@ -614,7 +656,7 @@ wxString parseID3v2Tag(MemChunk& mc, size_t start)
 	return ret;
 }
 
-wxString parseVorbisComment(MemChunk& mc, size_t start)
+wxString parseVorbisComment(const MemChunk& mc, size_t start)
 {
 	sf::Clock timer;
 	wxString  ret;
@@ -647,7 +689,7 @@ wxString parseVorbisComment(MemChunk& mc, size_t start)
 	return ret;
 }
 
-wxString parseIFFChunks(MemChunk& mc, size_t s, size_t samplerate, const WavChunk* cue, bool bigendian = false)
+wxString parseIFFChunks(const MemChunk& mc, size_t s, size_t samplerate, const WavChunk* cue, bool bigendian = false)
 {
 	const WavChunk* temp  = nullptr;
 	auto            data  = (const char*)mc.data();
@@ -922,7 +964,7 @@ wxString parseIFFChunks(MemChunk& mc, size_t s, size_t samplerate, const WavChun
 //
 // -----------------------------------------------------------------------------
 
-wxString audio::getID3Tag(MemChunk& mc)
+wxString audio::getID3Tag(const MemChunk& mc)
 {
 	// We actually identify RIFF-WAVE files as MP3 if they are encoded with
 	// the MP3 codec, but that means the metadata format is different, so
@@ -988,7 +1030,7 @@ wxString audio::getID3Tag(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getOggComments(MemChunk& mc)
+wxString audio::getOggComments(const MemChunk& mc)
 {
 	OggPageHeader ogg;
 	VorbisHeader  vorb;
@@ -998,7 +1040,7 @@ wxString audio::getOggComments(MemChunk& mc)
 
 	while (pagestart + 28 < end)
 	{
-		mc.read(&ogg, 27, pagestart);
+		mc.read(pagestart, &ogg, 27);
 		size_t pagesize = 27;
 
 		for (int i = 0; i < ogg.segments && pagestart + 27 + i < end; ++i)
@@ -1014,7 +1056,7 @@ wxString audio::getOggComments(MemChunk& mc)
 					return ret;
 
 				// Look if we have a vorbis comment header in that segment
-				mc.read(&vorb, 7, datastart);
+				mc.read(datastart, &vorb, 7);
 				if (vorb.packettype == 3 && vorb.tag[0] == 'v' && vorb.tag[1] == 'o' && vorb.tag[2] == 'r'
 					&& vorb.tag[3] == 'b' && vorb.tag[4] == 'i' && vorb.tag[5] == 's')
 				{
@@ -1034,7 +1076,7 @@ wxString audio::getOggComments(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getFlacComments(MemChunk& mc)
+wxString audio::getFlacComments(const MemChunk& mc)
 {
 	wxString ret = "";
 	// FLAC files begin with identifier "fLaC"; skip them
@@ -1059,7 +1101,7 @@ wxString audio::getFlacComments(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getITComments(MemChunk& mc)
+wxString audio::getITComments(const MemChunk& mc)
 {
 	auto   data = (const char*)mc.data();
 	auto   head = (const ITHeader*)data;
@@ -1136,7 +1178,7 @@ wxString audio::getITComments(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getModComments(MemChunk& mc)
+wxString audio::getModComments(const MemChunk& mc)
 {
 	auto   data = (const char*)mc.data();
 	size_t s    = 20;
@@ -1162,7 +1204,7 @@ wxString audio::getModComments(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getS3MComments(MemChunk& mc)
+wxString audio::getS3MComments(const MemChunk& mc)
 {
 	auto   data = (const char*)mc.data();
 	auto   head = (const S3MHeader*)data;
@@ -1197,7 +1239,7 @@ wxString audio::getS3MComments(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getXMComments(MemChunk& mc)
+wxString audio::getXMComments(const MemChunk& mc)
 {
 	auto   data = (const char*)mc.data();
 	auto   head = (const XMHeader*)data;
@@ -1273,7 +1315,7 @@ wxString audio::getXMComments(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getSunInfo(MemChunk& mc)
+wxString audio::getSunInfo(const MemChunk& mc)
 {
 	size_t datasize   = mc.readB32(8);
 	size_t codec      = mc.readB32(12);
@@ -1310,7 +1352,7 @@ wxString audio::getSunInfo(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getVocInfo(MemChunk& mc)
+wxString audio::getVocInfo(const MemChunk& mc)
 {
 	int         codec      = -1;
 	int         blockcount = 0;
@@ -1411,7 +1453,7 @@ wxString audio::getVocInfo(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getWavInfo(MemChunk& mc)
+wxString audio::getWavInfo(const MemChunk& mc)
 {
 	auto               data  = (const char*)mc.data();
 	auto               udata = (const uint8_t*)data;
@@ -1528,7 +1570,7 @@ wxString audio::getWavInfo(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getRmidInfo(MemChunk& mc)
+wxString audio::getRmidInfo(const MemChunk& mc)
 {
 	auto            data  = (const char*)mc.data();
 	auto            udata = (const uint8_t*)data;
@@ -1569,7 +1611,7 @@ wxString audio::getRmidInfo(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getAiffInfo(MemChunk& mc)
+wxString audio::getAiffInfo(const MemChunk& mc)
 {
 	auto            data  = (const char*)mc.data();
 	auto            udata = (const uint8_t*)data;
@@ -1659,7 +1701,7 @@ wxString audio::getAiffInfo(MemChunk& mc)
 // returns the index at which the true audio data begins.
 // Returns 0 if there is no tag before audio data.
 // -----------------------------------------------------------------------------
-size_t audio::checkForTags(MemChunk& mc)
+size_t audio::checkForTags(const MemChunk& mc)
 {
 	// Check for empty wasted space at the beginning, since it's apparently
 	// quite popular in MP3s to start with a useless blank frame.
@@ -1710,3 +1752,64 @@ size_t audio::checkForTags(MemChunk& mc)
 	}
 	return s;
 }
+
+// -----------------------------------------------------------------------------
+// Returns the tag info/comments for audio [entry], depending on its type.
+// Results are cached by the entry's content hash, so repeated lookups for
+// unmodified entries don't need to parse the data again
+// -----------------------------------------------------------------------------
+wxString audio::getTagInfo(ArchiveEntry& entry)
+{
+	auto type = entry.type();
+	auto hash = entry.contentHash();
+
+	// Check cache
+	{
+		std::lock_guard lock(tag_cache_mutex);
+		for (auto i = tag_cache.begin(); i != tag_cache.end(); ++i)
+			if (i->hash == hash && i->type == type)
+			{
+				auto cached = *i;
+				tag_cache.erase(i);
+				tag_cache.push_back(cached);
+				return cached.info;
+			}
+	}
+
+	wxString    info;
+	const auto& mc = entry.constData();
+	if (type == EntryType::fromId("snd_sun"))
+		info = getSunInfo(mc);
+	else if (type == EntryType::fromId("snd_voc"))
+		info = getVocInfo(mc);
+	else if (type == EntryType::fromId("snd_wav"))
+		info = getWavInfo(mc);
+	else if (type == EntryType::fromId("snd_mp3"))
+		info = getID3Tag(mc);
+	else if (type == EntryType::fromId("snd_ogg"))
+		info = getOggComments(mc);
+	else if (type == EntryType::fromId("snd_flac"))
+		info = getFlacComments(mc);
+	else if (type == EntryType::fromId("snd_aiff"))
+		info = getAiffInfo(mc);
+	else if (type == EntryType::fromId("mod_it"))
+		info = getITComments(mc);
+	else if (type == EntryType::fromId("mod_mod"))
+		info = getModComments(mc);
+	else if (type == EntryType::fromId("mod_s3m"))
+		info = getS3MComments(mc);
+	else if (type == EntryType::fromId("mod_xm"))
+		info = getXMComments(mc);
+	else if (type == EntryType::fromId("midi_rmid"))
+		info = getRmidInfo(mc);
+	else
+		return {};
+
+	// Add to cache
+	std::lock_guard lock(tag_cache_mutex);
+	tag_cache.push_back({ hash, type, info });
+	while (tag_cache.size() > MAX_CACHED_TAG_INFO)
+		tag_cache.pop_front();
+
+	return info;
+}
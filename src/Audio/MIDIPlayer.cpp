@@ -33,7 +33,13 @@
 #include "Main.h"
 #include "MIDIPlayer.h"
 #include "App.h"
+#include "General/Misc.h"
 #include "Utility/StringUtils.h"
+#include <SFML/Audio.hpp>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 using namespace slade;
 using namespace audio;
@@ -46,7 +52,7 @@ using namespace audio;
 // -----------------------------------------------------------------------------
 CVAR(String, snd_midi_player, "none", CVar::Flag::Save)
 CVAR(String, fs_soundfont_path, "", CVar::Flag::Save)
-CVAR(String, fs_driver, "", CVar::Flag::Save)
+CVAR(Int, fs_prerender_time, 3, CVar::Flag::Save)
 CVAR(String, snd_timidity_path, "", CVar::Flag::Save)
 CVAR(String, snd_timidity_options, "", CVar::Flag::Save)
 namespace slade::audio
@@ -76,8 +82,174 @@ EXTERN_CVAR(Int, snd_volume)
 //
 // A MIDIPlayer that uses fluidsynth to play MIDI
 // Requires a soundfont file to be configured (fs_soundfont_path cvar)
+//
+// Audio is rendered ahead of playback by a synthesis thread into a ring buffer
+// that is streamed through SFML. The first few seconds of each render are
+// cached, so playback of recently played MIDI starts straight away from the
+// cache while the synthesis thread catches up.
+//
+// The synthesis thread is a dedicated thread rather than a task since it runs
+// (mostly waiting for space in the ring buffer) for as long as the MIDI plays,
+// and can't be held up behind queued tasks without playback stuttering. It is
+// joined by stop(), which the destructor calls
 // -----------------------------------------------------------------------------
 #ifndef NO_FLUIDSYNTH
+namespace
+{
+constexpr unsigned SAMPLE_RATE        = 44100;
+constexpr unsigned CHANNELS           = 2;
+constexpr unsigned MAX_CACHED_RENDERS = 16;
+
+// Single-producer, single-consumer lock-free ring buffer of audio samples
+class SampleRing
+{
+public:
+	explicit SampleRing(size_t capacity) : buffer_(capacity) {}
+
+	size_t readable() const { return write_.load(std::memory_order_acquire) - read_.load(std::memory_order_relaxed); }
+	size_t writable() const
+	{
+		return buffer_.size() - (write_.load(std::memory_order_relaxed) - read_.load(std::memory_order_acquire));
+	}
+
+	// Only to be called when neither the producer or consumer is active
+	void clear()
+	{
+		read_  = 0;
+		write_ = 0;
+	}
+
+	// Writes up to [count] samples from [samples], returns the number written
+	size_t write(const int16_t* samples, size_t count)
+	{
+		count    = std::min(count, writable());
+		auto pos = write_.load(std::memory_order_relaxed);
+		for (size_t a = 0; a < count; ++a)
+			buffer_[(pos + a) % buffer_.size()] = samples[a];
+		write_.store(pos + count, std::memory_order_release);
+		return count;
+	}
+
+	// Reads up to [count] samples into [samples], returns the number read
+	size_t read(int16_t* samples, size_t count)
+	{
+		count    = std::min(count, readable());
+		auto pos = read_.load(std::memory_order_relaxed);
+		for (size_t a = 0; a < count; ++a)
+			samples[a] = buffer_[(pos + a) % buffer_.size()];
+		read_.store(pos + count, std::memory_order_release);
+		return count;
+	}
+
+private:
+	vector<int16_t>     buffer_;
+	std::atomic<size_t> read_{ 0 };  // Total samples read
+	std::atomic<size_t> write_{ 0 }; // Total samples written
+};
+
+// Cache of the first few seconds of recent renders, keyed by MIDI data hash
+// (most recent last)
+using RenderedSamples = shared_ptr<const vector<int16_t>>;
+std::mutex                                       render_cache_mutex;
+std::deque<std::pair<uint64_t, RenderedSamples>> render_cache;
+
+RenderedSamples cachedRender(uint64_t key)
+{
+	std::lock_guard lock(render_cache_mutex);
+	for (auto i = render_cache.begin(); i != render_cache.end(); ++i)
+		if (i->first == key)
+		{
+			auto samples = i->second;
+			render_cache.erase(i);
+			render_cache.emplace_back(key, samples);
+			return samples;
+		}
+
+	return nullptr;
+}
+
+void addCachedRender(uint64_t key, vector<int16_t> samples)
+{
+	std::lock_guard lock(render_cache_mutex);
+	render_cache.emplace_back(key, std::make_shared<const vector<int16_t>>(std::move(samples)));
+	while (render_cache.size() > MAX_CACHED_RENDERS)
+		render_cache.pop_front();
+}
+
+void clearRenderCache()
+{
+	std::lock_guard lock(render_cache_mutex);
+	render_cache.clear();
+}
+
+// Sound stream playing any cached samples first, then samples from the ring
+// buffer as they are rendered
+class SynthStream : public sf::SoundStream
+{
+public:
+	SynthStream() : ring_{ SAMPLE_RATE * CHANNELS * 2 } { initialize(CHANNELS, SAMPLE_RATE); }
+	~SynthStream() { stop(); }
+
+	SampleRing& ring() { return ring_; }
+	void        setRenderDone() { render_done_ = true; }
+
+	// Resets the stream to play [cached] samples first (if any). The stream
+	// must be stopped and nothing rendering to it
+	void reset(RenderedSamples cached)
+	{
+		cached_      = std::move(cached);
+		cached_pos_  = 0;
+		render_done_ = false;
+		ring_.clear();
+	}
+
+protected:
+	bool onGetData(Chunk& data) override
+	{
+		static constexpr size_t chunk_size = SAMPLE_RATE * CHANNELS / 10;
+
+		// Cached samples first
+		if (cached_ && cached_pos_ < cached_->size())
+		{
+			data.samples     = cached_->data() + cached_pos_;
+			data.sampleCount = std::min(chunk_size, cached_->size() - cached_pos_);
+			cached_pos_ += data.sampleCount;
+			return true;
+		}
+
+		// Wait for rendered samples
+		chunk_.resize(chunk_size);
+		size_t count;
+		while ((count = ring_.read(chunk_.data(), chunk_size)) == 0)
+		{
+			if (render_done_)
+			{
+				// Rendering finished, check for any last samples
+				count = ring_.read(chunk_.data(), chunk_size);
+				if (count == 0)
+					return false;
+				break;
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		data.samples     = chunk_.data();
+		data.sampleCount = count;
+		return true;
+	}
+
+	void onSeek(sf::Time time_offset) override {}
+
+private:
+	SampleRing        ring_;
+	RenderedSamples   cached_;
+	size_t            cached_pos_ = 0;
+	vector<int16_t>   chunk_;
+	std::atomic<bool> render_done_{ false };
+};
+} // namespace
+
 class FluidSynthMIDIPlayer : public MIDIPlayer
 {
 public:
@@ -90,10 +262,6 @@ public:
 		fs_initialised_ = false;
 		file_           = "";
 
-		// Set fluidsynth driver to alsa in linux (no idea why it defaults to jack)
-		if (app::platform() == app::Platform::Linux && fs_driver.value.empty())
-			fs_driver = "alsa";
-
 		// Init soundfont path
 		if (fs_soundfont_path.value.empty())
 		{
@@ -107,7 +275,7 @@ public:
 		initFluidsynth();
 		FluidSynthMIDIPlayer::reloadSoundfont();
 
-		if (!fs_player_ || !fs_adriver_)
+		if (!fs_initialised_)
 			log::warning(1, "Failed to initialise FluidSynth, MIDI playback disabled");
 	}
 
@@ -117,7 +285,6 @@ public:
 	virtual ~FluidSynthMIDIPlayer()
 	{
 		FluidSynthMIDIPlayer::stop();
-		delete_fluid_audio_driver(fs_adriver_);
 		delete_fluid_player(fs_player_);
 		delete_fluid_synth(fs_synth_);
 		delete_fluid_settings(fs_settings_);
@@ -139,6 +306,10 @@ public:
 
 		char separator = app::platform() == app::Platform::Windows ? ';' : ':';
 
+		// Cached renders are for the previous soundfont
+		stop();
+		clearRenderCache();
+
 		// Unload any current soundfont
 		for (int a = fs_soundfont_ids_.size() - 1; a >= 0; --a)
 		{
@@ -172,22 +343,11 @@ public:
 	bool openFile(const string& filename) override
 	{
 		file_ = filename;
-		if (!fs_initialised_)
+		data_.clear();
+		if (!data_.importFile(filename))
 			return false;
 
-		// Delete+Recreate player
-		delete_fluid_player(fs_player_);
-		fs_player_ = nullptr;
-		fs_player_ = new_fluid_player(fs_synth_);
-
-		// Open midi
-		if (fs_player_)
-		{
-			fluid_player_add(fs_player_, filename.c_str());
-			return true;
-		}
-
-		return false;
+		return prepare();
 	}
 
 	// -------------------------------------------------------------------------
@@ -200,22 +360,7 @@ public:
 		mc.seek(0, SEEK_SET);
 		data_.importMem(mc.data(), mc.size());
 
-		if (!fs_initialised_)
-			return false;
-
-		// Delete+Recreate player
-		delete_fluid_player(fs_player_);
-		fs_player_ = nullptr;
-		fs_player_ = new_fluid_player(fs_synth_);
-
-		if (fs_player_)
-		{
-			// fluid_player_set_loop(fs_player, -1);
-			fluid_player_add_mem(fs_player_, mc.data(), mc.size());
-			return true;
-		}
-
-		return false;
+		return prepare();
 	}
 
 	// -------------------------------------------------------------------------
@@ -229,13 +374,18 @@ public:
 	// -------------------------------------------------------------------------
 	bool play() override
 	{
-		stop();
-		timer_.restart();
-
 		if (!fs_initialised_)
 			return false;
 
-		return (fluid_player_play(fs_player_) == FLUID_OK);
+		// Playback always starts from the beginning, re-render unless the
+		// MIDI was only just prepared (when opened)
+		if (!prepared_ && !prepare())
+			return false;
+
+		prepared_ = false;
+		stream_.play();
+
+		return true;
 	}
 
 	// -------------------------------------------------------------------------
@@ -254,16 +404,20 @@ public:
 	// -------------------------------------------------------------------------
 	bool stop() override
 	{
-		bool stopped = false;
+		if (!fs_initialised_)
+			return false;
 
-		if (fs_initialised_)
-		{
-			fluid_player_stop(fs_player_);
-			fluid_synth_system_reset(fs_synth_);
-			stopped = true;
-		}
+		// Stop synthesis thread first, so the stream isn't left waiting for it
+		stop_render_ = true;
+		stream_.stop();
+		if (render_thread_.joinable())
+			render_thread_.join();
 
-		return stopped;
+		fluid_player_stop(fs_player_);
+		fluid_synth_system_reset(fs_synth_);
+		prepared_ = false;
+
+		return true;
 	}
 
 	// -------------------------------------------------------------------------
@@ -274,17 +428,13 @@ public:
 		if (!fs_initialised_)
 			return false;
 
-		return (fluid_player_get_status(fs_player_) == FLUID_PLAYER_PLAYING);
+		return stream_.getStatus() == sf::SoundSource::Playing;
 	}
 
 	// -------------------------------------------------------------------------
 	// Returns the current position of the playing MIDI stream
 	// -------------------------------------------------------------------------
-	int position() override
-	{
-		// We cannot query this information from fluidsynth, so we cheat by querying our own timer
-		return timer_.getElapsedTime().asMilliseconds();
-	}
+	int position() override { return stream_.getPlayingOffset().asMilliseconds(); }
 
 	// -------------------------------------------------------------------------
 	// Seeks to [pos] in the currently loaded MIDI stream
@@ -300,7 +450,7 @@ public:
 	// -------------------------------------------------------------------------
 	bool setVolume(int volume) override
 	{
-		if (!isReady())
+		if (!fs_initialised_)
 			return false;
 
 		// Clamp volume
@@ -309,20 +459,27 @@ public:
 		if (volume < 0)
 			volume = 0;
 
-		fluid_synth_set_gain(fs_synth_, volume * 0.01f);
+		// Applied to the stream rather than the synth, so cached renders are
+		// unaffected
+		stream_.setVolume(volume);
 
 		return true;
 	}
 
 private:
-	fluid_settings_t*     fs_settings_ = nullptr;
-	fluid_synth_t*        fs_synth_    = nullptr;
-	fluid_player_t*       fs_player_   = nullptr;
-	fluid_audio_driver_t* fs_adriver_  = nullptr;
+	fluid_settings_t* fs_settings_ = nullptr;
+	fluid_synth_t*    fs_synth_    = nullptr;
+	fluid_player_t*   fs_player_   = nullptr;
 
 	bool        fs_initialised_ = false;
 	vector<int> fs_soundfont_ids_;
 
+	// Rendering
+	SynthStream       stream_;
+	std::thread       render_thread_;
+	std::atomic<bool> stop_render_{ false };
+	bool              prepared_ = false; // Rendering from the start, not played yet
+
 	// -------------------------------------------------------------------------
 	// Initialises fluidsynth
 	// -------------------------------------------------------------------------
@@ -332,34 +489,121 @@ private:
 		if (fs_initialised_)
 			return true;
 
-		// Init fluidsynth settings
-		fs_settings_         = new_fluid_settings();
-		string fs_driver_str = fs_driver;
-		if (!fs_driver_str.empty())
-			fluid_settings_setstr(fs_settings_, "audio.driver", fs_driver_str.c_str());
+		// Init fluidsynth settings.
+		// The player is timed by the samples rendered rather than the system
+		// clock, so it can be rendered ahead of playback
+		fs_settings_ = new_fluid_settings();
+		fluid_settings_setnum(fs_settings_, "synth.sample-rate", SAMPLE_RATE);
+		fluid_settings_setstr(fs_settings_, "player.timing-source", "sample");
 
 		// Create fluidsynth objects
-		fs_synth_   = new_fluid_synth(fs_settings_);
-		fs_player_  = new_fluid_player(fs_synth_);
-		fs_adriver_ = new_fluid_audio_driver(fs_settings_, fs_synth_);
+		fs_synth_  = new_fluid_synth(fs_settings_);
+		fs_player_ = new_fluid_player(fs_synth_);
 
 		// Check init succeeded
-		if (fs_synth_)
+		if (fs_synth_ && fs_player_)
+		{
+			fluid_synth_set_gain(fs_synth_, 1.0f);
+			fs_initialised_ = true;
+			setVolume(snd_volume);
+			return true;
+		}
+
+		// Init unsuccessful
+		return false;
+	}
+
+	// -------------------------------------------------------------------------
+	// Stops any current playback and starts rendering the loaded MIDI from the
+	// beginning, ready to play.
+	// Returns true if successful, false otherwise
+	// -------------------------------------------------------------------------
+	bool prepare()
+	{
+		if (!fs_initialised_)
+			return false;
+
+		stop();
+
+		// Delete+Recreate player
+		delete_fluid_player(fs_player_);
+		fs_player_ = new_fluid_player(fs_synth_);
+		if (!fs_player_ || fluid_player_add_mem(fs_player_, data_.data(), data_.size()) != FLUID_OK)
+			return false;
+
+		// Start rendering (after any cached samples)
+		auto key    = misc::hash64(data_.data(), data_.size());
+		auto cached = cachedRender(key);
+		stream_.reset(cached);
+		stop_render_ = false;
+		if (fluid_player_play(fs_player_) != FLUID_OK)
+			return false;
+		render_thread_ = std::thread([this, key, cached] { render(key, cached ? cached->size() : 0); });
+
+		prepared_ = true;
+		return true;
+	}
+
+	// -------------------------------------------------------------------------
+	// Renders the current MIDI to the stream's ring buffer until finished or
+	// stopped, skipping the first [skip] (already cached) samples.
+	// The first fs_prerender_time seconds are added to the render cache with
+	// [key] if not already cached.
+	// Runs on the synthesis thread
+	// -------------------------------------------------------------------------
+	void render(uint64_t key, size_t skip)
+	{
+		static constexpr int block_frames = 512;
+		int16_t              block[block_frames * CHANNELS];
+
+		auto&  ring        = stream_.ring();
+		size_t capture_max = skip > 0 ? 0 : std::max(fs_prerender_time.value, 0) * SAMPLE_RATE * CHANNELS;
+		int    tail        = SAMPLE_RATE / block_frames; // Keep rendering for a second after the end (releases)
+		bool   finished    = false;
+
+		vector<int16_t> capture;
+		capture.reserve(capture_max);
+
+		while (!stop_render_)
 		{
-			if (fs_adriver_)
+			// Check if the song is finished
+			if (fluid_player_get_status(fs_player_) != FLUID_PLAYER_PLAYING && tail-- <= 0)
 			{
-				setVolume(snd_volume);
-				fs_initialised_ = true;
-				return true;
+				finished = true;
+				break;
 			}
 
-			// Driver creation unsuccessful
-			delete_fluid_synth(fs_synth_);
-			return false;
+			// Wait for space in the ring buffer (unless skipping)
+			if (skip == 0 && ring.writable() < block_frames * CHANNELS)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+				continue;
+			}
+
+			fluid_synth_write_s16(fs_synth_, block_frames, block, 0, CHANNELS, block, 1, CHANNELS);
+
+			// Skip cached samples
+			const int16_t* samples = block;
+			size_t         count   = block_frames * CHANNELS;
+			if (skip > 0)
+			{
+				auto skipped = std::min(skip, count);
+				samples += skipped;
+				count -= skipped;
+				skip -= skipped;
+			}
+
+			if (capture.size() < capture_max)
+				capture.insert(capture.end(), samples, samples + std::min(count, capture_max - capture.size()));
+
+			ring.write(samples, count);
 		}
 
-		// Init unsuccessful
-		return false;
+		// Cache the start of the render if it is complete
+		if (!capture.empty() && (finished || capture.size() >= capture_max))
+			addCachedRender(key, std::move(capture));
+
+		stream_.setRenderDone();
 	}
 };
 #endif // !NO_FLUIDSYNTH
@@ -73,11 +73,13 @@ bool ModMusic::openFromFile(const string& filename)
 	// Close current module if any
 	close();
 
-	// Load module file
-	dumb_module_ = dumb_load_any(filename.c_str(), 0, 0);
+	// Load module file (without seek checkpoints, see loadIndexed)
+	dumb_module_ = dumb_load_any_quick(filename.c_str(), 0, 0);
 	if (dumb_module_ != nullptr)
 	{
 		initialize(2, 44100);
+		startDecoding(0);
+		loadIndexed([filename] { return dumb_load_any(filename.c_str(), 0, 0); });
 		return true;
 	}
 	else
@@ -99,12 +101,25 @@ bool ModMusic::loadFromMemory(const uint8_t* data, const uint32_t size)
 	// Close current module if any
 	close();
 
-	// Load module file
-	dumb_module_ = dumb_read_any(dumbfile_open_memory((const char*)data, size), 0, 0);
+	// Load module data (without seek checkpoints, see loadIndexed)
+	auto file    = dumbfile_open_memory((const char*)data, size);
+	dumb_module_ = dumb_read_any_quick(file, 0, 0);
+	dumbfile_close(file);
 	if (dumb_module_ != nullptr)
 	{
 		initialize(2, 44100);
-		dumb_player_ = duh_start_sigrenderer(dumb_module_, 0, 2, 0);
+		startDecoding(0);
+
+		auto copy = std::make_shared<const vector<uint8_t>>(data, data + size);
+		loadIndexed(
+			[copy]
+			{
+				auto file = dumbfile_open_memory((const char*)copy->data(), copy->size());
+				auto duh  = dumb_read_any(file, 0, 0);
+				dumbfile_close(file);
+				return duh;
+			});
+
 		return true;
 	}
 	else
@@ -115,11 +130,16 @@ bool ModMusic::loadFromMemory(const uint8_t* data, const uint32_t size)
 }
 
 // -----------------------------------------------------------------------------
-// Returns the duration of the currently loaded mod
+// Returns the duration of the currently loaded mod.
+// This is 0 until the module has been fully loaded in the background
 // -----------------------------------------------------------------------------
 sf::Time ModMusic::duration() const
 {
-	return sf::seconds(static_cast<float>(duh_get_length(dumb_module_) / 65536.f));
+	if (!indexed_)
+		return {};
+
+	std::lock_guard lock(indexed_->mutex);
+	return sf::seconds(static_cast<float>(indexed_->length / 65536.f));
 }
 
 // -----------------------------------------------------------------------------
@@ -127,6 +147,9 @@ sf::Time ModMusic::duration() const
 // -----------------------------------------------------------------------------
 void ModMusic::close()
 {
+	stop();
+	decoder_.stop();
+
 	if (dumb_player_ != nullptr)
 	{
 		duh_end_sigrenderer(dumb_player_);
@@ -137,16 +160,97 @@ void ModMusic::close()
 		unload_duh(dumb_module_);
 		dumb_module_ = nullptr;
 	}
+
+	// Unload the background-loaded module, or have the loading task unload
+	// it if it hasn't finished yet (or not load it at all if it hasn't started)
+	if (indexed_)
+	{
+		indexed_task_.cancel();
+		std::lock_guard lock(indexed_->mutex);
+		if (indexed_->duh != nullptr)
+		{
+			unload_duh(indexed_->duh);
+			indexed_->duh = nullptr;
+		}
+		indexed_->orphaned = true;
+	}
+	indexed_.reset();
 }
 
 // -----------------------------------------------------------------------------
-// Called when seeking is requested on the sound stream
+// Starts rendering the module from [pos] (in 1/65536ths of a second) on the
+// decoder thread
 // -----------------------------------------------------------------------------
-void ModMusic::onSeek(sf::Time timeOffset)
+void ModMusic::startDecoding(long pos)
 {
-	long pos     = static_cast<long>(timeOffset.asSeconds() * 65536);
 	dumb_player_ = duh_start_sigrenderer(dumb_module_, 0, 2, pos);
 	// dumb_it_set_loop_callback(duh_get_it_sigrenderer(dumb_player), dumb_it_callback_terminate, NULL);
+
+	decoder_.start(
+		[this](int16_t* samples, size_t max)
+		{
+			auto rendered = duh_render(dumb_player_, 16, 0, 1.0f, (65536.0f / 44100.0f), max / 2, samples);
+			return static_cast<size_t>(std::max(rendered, 0L)) * 2;
+		});
+}
+
+// -----------------------------------------------------------------------------
+// Fully loads the module with [load] in a background task.
+//
+// The module is initially loaded without the 'initial runthrough' of the
+// song, which gets its length and builds the checkpoints needed for seeking
+// (otherwise seeking has to render everything up to the seek point). This can
+// take a while for long modules so it is done here instead, and the module
+// playing is replaced with the fully loaded one at the next seek
+// -----------------------------------------------------------------------------
+void ModMusic::loadIndexed(std::function<DUH*()> load)
+{
+	indexed_ = std::make_shared<Indexed>();
+
+	indexed_task_ = tasks::run(
+		[indexed = indexed_, load = std::move(load)](const tasks::Task&)
+		{
+			auto duh = load();
+
+			std::lock_guard lock(indexed->mutex);
+			if (indexed->orphaned)
+			{
+				if (duh)
+					unload_duh(duh);
+				return;
+			}
+			indexed->duh    = duh;
+			indexed->length = duh ? duh_get_length(duh) : 0;
+		},
+		tasks::Priority::Low);
+}
+
+// -----------------------------------------------------------------------------
+// Called when seeking is requested on the sound stream
+// -----------------------------------------------------------------------------
+void ModMusic::onSeek(sf::Time timeOffset)
+{
+	decoder_.stop();
+	if (dumb_player_ != nullptr)
+	{
+		duh_end_sigrenderer(dumb_player_);
+		dumb_player_ = nullptr;
+	}
+
+	// Switch to the fully loaded module if it's ready
+	if (indexed_)
+	{
+		std::lock_guard lock(indexed_->mutex);
+		if (indexed_->duh != nullptr)
+		{
+			unload_duh(dumb_module_);
+			dumb_module_  = indexed_->duh;
+			indexed_->duh = nullptr;
+		}
+	}
+
+	if (dumb_module_ != nullptr)
+		startDecoding(static_cast<long>(timeOffset.asSeconds() * 65536));
 }
 
 // -----------------------------------------------------------------------------
@@ -154,9 +258,13 @@ void ModMusic::onSeek(sf::Time timeOffset)
 // -----------------------------------------------------------------------------
 bool ModMusic::onGetData(Chunk& data)
 {
-	duh_render(dumb_player_, 16, 0, 1.0f, (65536.0f / 44100.0f), 44100 / 2, samples_);
-	data.samples     = samples_;
-	data.sampleCount = 44100;
+	const int16_t* samples = nullptr;
+	size_t         count   = 0;
+	if (!decoder_.next(samples, count))
+		return false;
+
+	data.samples     = samples;
+	data.sampleCount = count;
 	return true;
 }
 
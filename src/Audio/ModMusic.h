@@ -1,5 +1,7 @@
 #pragma once
 
+#include "General/Tasks.h"
+#include "StreamDecoder.h"
 #include <SFML/Audio.hpp>
 
 struct DUH;
@@ -20,13 +22,26 @@ public:
 	static void initDumb();
 
 private:
+	// Module with seek checkpoints, loaded in a background task (shared with it)
+	struct Indexed
+	{
+		std::mutex mutex;
+		DUH*       duh      = nullptr;
+		long       length   = 0;
+		bool       orphaned = false; // Closed before loading finished, the task unloads the module
+	};
+
 	void close();
+	void startDecoding(long pos);
+	void loadIndexed(std::function<DUH*()> load);
 	bool onGetData(Chunk& data) override;
 	void onSeek(sf::Time timeOffset) override;
 
-	sf::Int16        samples_[44100]{};
-	DUH*             dumb_module_ = nullptr;
-	DUH_SIGRENDERER* dumb_player_ = nullptr;
+	DUH*                dumb_module_ = nullptr;
+	DUH_SIGRENDERER*    dumb_player_ = nullptr;
+	shared_ptr<Indexed> indexed_;
+	tasks::Task         indexed_task_;
+	StreamDecoder       decoder_;
 
 	static bool init_done_;
 };
@@ -10,34 +10,21 @@ namespace slade::audio
 {
 struct Mp3MemoryData
 {
-	void*  data;
-	size_t size;
-	off_t  offset;
+	shared_ptr<const vector<uint8_t>> data;
+	off_t                             offset;
 };
 
 ssize_t memoryDataRead(void* raw_mp3_data, void* buffer, size_t nbyte)
 {
 	auto mp3_data = static_cast<Mp3MemoryData*>(raw_mp3_data);
-	if (mp3_data->offset >= (ssize_t)mp3_data->size)
-	{
-		memset(buffer, 0, nbyte);
+	auto size     = static_cast<off_t>(mp3_data->data->size());
+	if (mp3_data->offset >= size)
 		return (ssize_t)0;
-	}
-	else if (mp3_data->offset + (ssize_t)nbyte > (ssize_t)mp3_data->size)
-	{
-		size_t read_size    = mp3_data->size - mp3_data->offset;
-		size_t mem_set_size = mp3_data->offset + nbyte - (ssize_t)mp3_data->size;
-		memcpy(buffer, (unsigned char*)mp3_data->data + mp3_data->offset, read_size);
-		memset(buffer, 0, mem_set_size);
-		mp3_data->offset += read_size;
-		return (ssize_t)read_size;
-	}
-	else
-	{
-		memcpy(buffer, (unsigned char*)mp3_data->data + mp3_data->offset, nbyte);
-		mp3_data->offset += nbyte;
-		return (ssize_t)nbyte;
-	}
+
+	auto read_size = std::min<off_t>(nbyte, size - mp3_data->offset);
+	memcpy(buffer, mp3_data->data->data() + mp3_data->offset, read_size);
+	mp3_data->offset += read_size;
+	return (ssize_t)read_size;
 }
 
 off_t memoryDataLSeek(void* raw_mp3_data, off_t offset, int whence)
@@ -47,7 +34,7 @@ off_t memoryDataLSeek(void* raw_mp3_data, off_t offset, int whence)
 	{
 	case SEEK_SET: mp3_data->offset = offset; break;
 	case SEEK_CUR: mp3_data->offset += offset; break;
-	case SEEK_END: mp3_data->offset = mp3_data->size + offset; break;
+	case SEEK_END: mp3_data->offset = mp3_data->data->size() + offset; break;
 	}
 	return mp3_data->offset;
 }
@@ -57,6 +44,22 @@ void memoryDataCleanup(void* raw_mp3_data)
 	delete static_cast<Mp3MemoryData*>(raw_mp3_data);
 }
 
+// Opens [handle] on [filename], or on [data] if [filename] is empty
+bool openMp3Handle(mpg123_handle* handle, const string& filename, const shared_ptr<const vector<uint8_t>>& data)
+{
+	if (!filename.empty())
+		return mpg123_open(handle, filename.c_str()) == MPG123_OK;
+
+	auto mp3_data = new Mp3MemoryData{ data, 0 };
+	if (mpg123_open_handle(handle, mp3_data) != MPG123_OK)
+	{
+		delete mp3_data;
+		return false;
+	}
+
+	return true;
+}
+
 } // namespace slade::audio
 
 
@@ -82,12 +85,8 @@ Mp3Music::Mp3Music()
 Mp3Music::~Mp3Music()
 {
 	SoundStream::stop();
-
-	if (buffer_)
-	{
-		delete[] buffer_;
-		buffer_ = nullptr;
-	}
+	decoder_.stop();
+	index_task_.cancel();
 
 	mpg123_close(handle_);
 	mpg123_delete(handle_);
@@ -96,132 +95,173 @@ Mp3Music::~Mp3Music()
 
 bool Mp3Music::openFromFile(const std::string& filename)
 {
-	stop();
-
-	if (buffer_)
-	{
-		delete[] buffer_;
-		buffer_ = nullptr;
-	}
-
-	if (handle_)
-		mpg123_close(handle_);
-
-	if (mpg123_open(handle_, filename.c_str()) != MPG123_OK)
+	data_.reset();
+	if (!openHandle(filename))
 	{
-		std::cerr << mpg123_strerror(handle_) << std::endl;
+		std::cerr << "Failed to open \"" << filename << "\": " << mpg123_strerror(handle_) << std::endl;
 		return false;
 	}
 
-	long rate     = 0;
-	int  channels = 0, encoding = 0;
-	if (mpg123_getformat(handle_, &rate, &channels, &encoding) != MPG123_OK)
-	{
-		std::cerr << "Failed to get format information for \"" << filename << "\"" << std::endl;
-		return false;
-	}
-	sampling_rate_ = rate;
+	return true;
+}
 
-	buffer_size_ = mpg123_outblock(handle_);
-	buffer_      = new unsigned char[buffer_size_];
-	if (!buffer_)
+bool Mp3Music::loadFromMemory(void* data, size_t size_in_bytes)
+{
+	// Keep a copy of the data, shared with the seek index task
+	auto bytes = static_cast<const uint8_t*>(data);
+	data_      = std::make_shared<const vector<uint8_t>>(bytes, bytes + size_in_bytes);
+
+	if (!openHandle({}))
 	{
-		std::cerr << "Failed to reserve memory for decoding one frame for \"" << filename << "\"" << std::endl;
+		log::error("Failed to open mp3 Memory Object: {}", mpg123_strerror(handle_));
 		return false;
 	}
 
-	initialize(channels, rate);
-
 	return true;
 }
 
-bool Mp3Music::loadFromMemory(void* data, size_t size_in_bytes)
+// Opens the mp3 for decoding from [filename] (or data_ if empty). Only the
+// stream headers are read here, decoding starts on the decoder thread and the
+// seek index is built in a background task
+bool Mp3Music::openHandle(const string& filename)
 {
 	stop();
+	decoder_.stop();
 
-	if (buffer_)
-	{
-		delete[] buffer_;
-		buffer_ = nullptr;
-	}
-
-	if (handle_)
-		mpg123_close(handle_);
+	if (!handle_)
+		return false;
 
-	auto mp3_data = new Mp3MemoryData{ data, size_in_bytes, 0 };
-	if (!mp3_data)
-	{
-		log::error("Failed to reserve memory for keeping track of Memory Object");
-	}
+	mpg123_close(handle_);
+	index_task_.cancel();
+	index_.reset();
+	index_applied_ = false;
 
-	if (mpg123_open_handle(handle_, mp3_data) != MPG123_OK)
-	{
-		log::error(mpg123_strerror(handle_));
-		delete mp3_data;
-		mp3_data = nullptr;
+	if (!openMp3Handle(handle_, filename, data_))
 		return false;
-	}
 
 	long rate     = 0;
 	int  channels = 0, encoding = 0;
 	if (mpg123_getformat(handle_, &rate, &channels, &encoding) != MPG123_OK)
-	{
-		log::error("Failed to get format information for Memory Object");
 		return false;
-	}
 	sampling_rate_ = rate;
 
-	buffer_size_ = mpg123_outblock(handle_);
-	buffer_      = new unsigned char[buffer_size_];
-	if (!buffer_)
-	{
-		log::error("Failed to reserve memory for decoding one frame for Memory Object");
-		return false;
-	}
-
-	log::info("rate {}, channels {}", rate, channels);
+	// Get the length from the headers (estimated from the bitrate if there is
+	// no Xing/Info header), the exact length comes with the seek index
+	length_ = std::max<off_t>(mpg123_length(handle_), 0);
 
 	initialize(channels, rate);
+	startDecoding();
+	buildIndex(filename);
 
 	return true;
 }
 
+// Starts decoding from the current position on the decoder thread
+void Mp3Music::startDecoding()
+{
+	decoder_.start(
+		[this](int16_t* samples, size_t max)
+		{
+			size_t done = 0;
+			int    err  = MPG123_OK;
+			do
+			{
+				err = mpg123_read(handle_, reinterpret_cast<unsigned char*>(samples), max * sizeof(int16_t), &done);
+			} while (done == 0 && err == MPG123_NEW_FORMAT);
+
+			return done / sizeof(int16_t);
+		});
+}
+
+// Scans the whole mp3 in a background task (with its own handle) to build a
+// full seek index and get its exact length. Seeking without the index has to
+// read through every frame before the seek point
+void Mp3Music::buildIndex(const string& filename)
+{
+	index_ = std::make_shared<SeekIndex>();
+
+	index_task_ = tasks::run(
+		[index = index_, data = data_, filename](const tasks::Task&)
+		{
+			if (mpg123_init() != MPG123_OK)
+				return;
+
+			auto handle = mpg123_new(nullptr, nullptr);
+			if (handle)
+			{
+				mpg123_replace_reader_handle(handle, &memoryDataRead, &memoryDataLSeek, &memoryDataCleanup);
+				if (openMp3Handle(handle, filename, data) && mpg123_scan(handle) == MPG123_OK)
+				{
+					off_t* offsets = nullptr;
+					off_t  step    = 0;
+					size_t fill    = 0;
+					mpg123_index(handle, &offsets, &step, &fill);
+
+					std::lock_guard lock(index->mutex);
+					index->offsets.assign(offsets, offsets + fill);
+					index->step   = step;
+					index->length = mpg123_length(handle);
+					index->ready  = true;
+				}
+
+				mpg123_close(handle);
+				mpg123_delete(handle);
+			}
+
+			mpg123_exit();
+		},
+		tasks::Priority::Low);
+}
+
 sf::Time Mp3Music::duration() const
 {
 	if (!handle_ || sampling_rate_ == 0)
 		return {};
 
-	auto len  = mpg123_length(handle_);
-	auto secs = (float)len / (float)sampling_rate_;
-
-	log::info("len {} rate {} secs {}", len, sampling_rate_, secs);
+	auto len = length_;
+	if (index_)
+	{
+		std::lock_guard lock(index_->mutex);
+		if (index_->ready && index_->length > 0)
+			len = index_->length;
+	}
 
-	return sf::seconds(secs);
+	return sf::seconds((float)len / (float)sampling_rate_);
 }
 
 bool Mp3Music::onGetData(Chunk& data)
 {
-	sf::Lock lock(mutex_);
-
-	if (handle_)
-	{
-		size_t done;
-		mpg123_read(handle_, buffer_, buffer_size_, &done);
+	const int16_t* samples = nullptr;
+	size_t         count   = 0;
+	if (!decoder_.next(samples, count))
+		return false;
 
-		data.samples     = (short*)buffer_;
-		data.sampleCount = done / sizeof(short);
+	data.samples     = samples;
+	data.sampleCount = count;
 
-		return (data.sampleCount > 0);
-	}
-	else
-		return false;
+	return true;
 }
 
 void Mp3Music::onSeek(sf::Time time_offset)
 {
-	sf::Lock lock(mutex_);
+	if (!handle_)
+		return;
+
+	decoder_.stop();
+
+	// Use the full seek index once it's ready
+	if (index_ && !index_applied_)
+	{
+		std::lock_guard lock(index_->mutex);
+		if (index_->ready && !index_->offsets.empty())
+		{
+			mpg123_set_index(handle_, index_->offsets.data(), index_->step, index_->offsets.size());
+			index_applied_ = true;
+		}
+	}
 
 	// tschumacher: sampleoff must be (seconds * samplingRate) to make this working correctly
-	if (handle_)
-		mpg123_seek(handle_, static_cast<off_t>(time_offset.asSeconds() * sampling_rate_), SEEK_SET);
+	mpg123_seek(handle_, static_cast<off_t>(time_offset.asSeconds() * sampling_rate_), SEEK_SET);
+
+	startDecoding();
 }
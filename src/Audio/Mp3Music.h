@@ -1,5 +1,7 @@
 #pragma once
 
+#include "General/Tasks.h"
+#include "StreamDecoder.h"
 #include <SFML/Audio.hpp>
 #include <mpg123.h>
 
@@ -20,10 +22,27 @@ protected:
 	void onSeek(sf::Time time_offset) override;
 
 private:
-	mpg123_handle* handle_      = nullptr;
-	size_t         buffer_size_ = 0;
-	unsigned char* buffer_      = nullptr;
-	sf::Mutex      mutex_;
-	long           sampling_rate_ = 0;
+	// Seek index built in a background task (shared with it)
+	struct SeekIndex
+	{
+		std::mutex    mutex;
+		bool          ready = false;
+		vector<off_t> offsets;
+		off_t         step   = 0;
+		off_t         length = 0; // Exact length in samples
+	};
+
+	mpg123_handle*                    handle_ = nullptr;
+	long                              sampling_rate_ = 0;
+	off_t                             length_        = 0; // Estimated length in samples
+	shared_ptr<const vector<uint8_t>> data_;
+	shared_ptr<SeekIndex>             index_;
+	tasks::Task                       index_task_;
+	bool                              index_applied_ = false;
+	StreamDecoder                     decoder_;
+
+	bool openHandle(const string& filename);
+	void startDecoding();
+	void buildIndex(const string& filename);
 };
 } // namespace slade::audio
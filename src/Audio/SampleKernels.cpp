@@ -0,0 +1,430 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    SampleKernels.cpp
+// Description: Bulk audio sample conversion functions, with SIMD
+//              implementations where available
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "SampleKernels.h"
+#include <array>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SAMPLEKERNELS_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SAMPLEKERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+const int16_t SIGN_BIT   = 0x80; // Sign bit = values are otherwise treated as unsigned).
+const int16_t QUANT_MASK = 0xf;  // Quantization field mask.
+const int16_t SEG_SHIFT  = 4;    // Left shift for segment number.
+const int16_t SEG_MASK   = 0x70; // Segment field mask.
+const int16_t BIAS       = 0x84; // Bias for linear code.
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Scalar Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+namespace scalar
+{
+	// -------------------------------------------------------------------------
+	// Converts a 16-bit signed sample to an 8-bit unsigned one.
+	// -------------------------------------------------------------------------
+	uint8_t pcm16to8bits(int16_t val)
+	{
+		// Value is in the [-32768, 32767] range.
+		// Shift it eight bits to [-128, 127] range,
+		// and add 128 to put it in [0, 255] range.
+		uint8_t ret = 128 + (val >> 8);
+		// Round value up or down depending on value
+		// of shifted-off bits.
+		if ((val & 0x80FF) > 127 && ret < 255)
+			ret++;
+		else if ((val & 0x80FF) < -128 && ret > 0)
+			ret--;
+		// Send it.
+		return ret;
+	}
+
+	// -------------------------------------------------------------------------
+	// Converts a 24-bit signed sample to an 8-bit unsigned one.
+	// -------------------------------------------------------------------------
+	uint8_t pcm24to8bits(int32_t val)
+	{
+		int16_t ret = (val >> 8);
+		if ((val & 0x8000FF) > 127 && ret < 255)
+			ret++;
+		else if ((val & 0x8000FF) < -128 && ret > 0)
+			ret--;
+		return pcm16to8bits(ret);
+	}
+
+	// -------------------------------------------------------------------------
+	// Converts a 32-bit signed sample to an 8-bit unsigned one.
+	// -------------------------------------------------------------------------
+	uint8_t pcm32to8bits(int32_t val)
+	{
+		static const int32_t mod = 0x800000FF;
+		int32_t              ret = (val >> 8);
+		if ((val & mod) > 127 && ret < 255)
+			ret++;
+		else if ((val & mod) < -128 && ret > 0)
+			ret--;
+		return pcm24to8bits(ret);
+	}
+
+	// The following two functions are adapted from Sun Microsystem's g711.cpp code.
+	// Unrestricted use and modifications are allowed.
+
+	// -------------------------------------------------------------------------
+	// Converts a 8-bit A-law sample to 16-bit signed linear PCM
+	// -------------------------------------------------------------------------
+	int16_t alawToLinear(uint8_t alaw)
+	{
+		int16_t t;
+		int16_t seg;
+
+		alaw ^= 0x55;
+
+		t   = (alaw & QUANT_MASK) << 4;
+		seg = (alaw & SEG_MASK) >> SEG_SHIFT;
+		switch (seg)
+		{
+		case 0: t += 8; break;
+		case 1: t += 0x108; break;
+		default: t += 0x108; t <<= seg - 1;
+		}
+		return ((alaw & SIGN_BIT) ? t : -t);
+	}
+
+	// -------------------------------------------------------------------------
+	// Converts a 8-bit µ-law sample to 16-bit signed linear PCM
+	// -------------------------------------------------------------------------
+	int16_t mulawToLinear(uint8_t ulaw)
+	{
+		int t;
+
+		/* Complement to obtain normal u-law value. */
+		ulaw = ~ulaw;
+
+		/*
+		 * Extract and bias the quantization bits. Then
+		 * shift up by the segment number and subtract out the bias.
+		 */
+		t = ((ulaw & QUANT_MASK) << 3) + BIAS;
+		t <<= (ulaw & SEG_MASK) >> SEG_SHIFT;
+
+		return ((ulaw & SIGN_BIT) ? (BIAS - t) : (t - BIAS));
+	}
+
+	void pcm16to8(const uint8_t* in, uint8_t* out, unsigned count)
+	{
+		for (unsigned a = 0; a < count; ++a)
+		{
+			int16_t val;
+			memcpy(&val, in + a * 2, 2);
+			out[a] = pcm16to8bits(val);
+		}
+	}
+
+	void stereoToMono(const uint8_t* in, uint8_t* out, unsigned count)
+	{
+		for (unsigned a = 0; a < count; ++a)
+			out[a] = (in[a * 2] + in[a * 2 + 1]) / 2;
+	}
+
+	void swapBytes(uint8_t* samples, unsigned sample_size, unsigned count)
+	{
+		for (unsigned a = 0; a < count; ++a)
+			std::reverse(samples + a * sample_size, samples + (a + 1) * sample_size);
+	}
+} // namespace scalar
+
+// -----------------------------------------------------------------------------
+// Returns a lookup table of 8-bit unsigned samples for each 8-bit A-law (if
+// [alaw] is true) or µ-law sample value
+// -----------------------------------------------------------------------------
+const uint8_t* lawTable(bool alaw)
+{
+	static const auto tables = []
+	{
+		std::array<std::array<uint8_t, 256>, 2> tables{};
+		for (unsigned a = 0; a < 256; ++a)
+		{
+			tables[0][a] = scalar::pcm16to8bits(scalar::mulawToLinear(a));
+			tables[1][a] = scalar::pcm16to8bits(scalar::alawToLinear(a));
+		}
+		return tables;
+	}();
+
+	return tables[alaw ? 1 : 0].data();
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// SIMD Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+namespace simd
+{
+#if defined(SAMPLEKERNELS_SSE2)
+	// Converts 8 16-bit samples to 8-bit (as 16-bit values), rounding the same
+	// way as scalar::pcm16to8bits
+	__m128i pcm16to8x8(__m128i samples)
+	{
+		const auto low_mask = _mm_set1_epi16(0xFF);
+		const auto max      = _mm_set1_epi16(127);
+
+		// Round up if negative, or if the low byte is > 127 and the result won't overflow
+		auto high  = _mm_srai_epi16(samples, 8);
+		auto round = _mm_or_si128(
+			_mm_srai_epi16(samples, 15),
+			_mm_and_si128(_mm_cmpgt_epi16(_mm_and_si128(samples, low_mask), max), _mm_cmplt_epi16(high, max)));
+
+		// (round is -1 where rounding up)
+		return _mm_sub_epi16(_mm_add_epi16(high, _mm_set1_epi16(128)), round);
+	}
+
+	void pcm16to8(const uint8_t* in, uint8_t* out, unsigned count)
+	{
+		unsigned a = 0;
+		for (; a + 16 <= count; a += 16)
+		{
+			auto src = reinterpret_cast<const __m128i*>(in + a * 2);
+			auto lo  = pcm16to8x8(_mm_loadu_si128(src));
+			auto hi  = pcm16to8x8(_mm_loadu_si128(src + 1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + a), _mm_packus_epi16(lo, hi));
+		}
+
+		scalar::pcm16to8(in + a * 2, out + a, count - a);
+	}
+
+	void stereoToMono(const uint8_t* in, uint8_t* out, unsigned count)
+	{
+		const auto low_mask = _mm_set1_epi16(0xFF);
+		unsigned   a        = 0;
+		for (; a + 16 <= count; a += 16)
+		{
+			auto src = reinterpret_cast<const __m128i*>(in + a * 2);
+			auto v0  = _mm_loadu_si128(src);
+			auto v1  = _mm_loadu_si128(src + 1);
+
+			// (left + right) / 2 for each 16-bit left/right pair
+			v0 = _mm_srli_epi16(_mm_add_epi16(_mm_and_si128(v0, low_mask), _mm_srli_epi16(v0, 8)), 1);
+			v1 = _mm_srli_epi16(_mm_add_epi16(_mm_and_si128(v1, low_mask), _mm_srli_epi16(v1, 8)), 1);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + a), _mm_packus_epi16(v0, v1));
+		}
+
+		scalar::stereoToMono(in + a * 2, out + a, count - a);
+	}
+
+	void swapBytes(uint8_t* samples, unsigned sample_size, unsigned count)
+	{
+		if (sample_size != 2 && sample_size != 4)
+		{
+			scalar::swapBytes(samples, sample_size, count);
+			return;
+		}
+
+		unsigned a = 0;
+		for (; (count - a) * sample_size >= 16; a += 16 / sample_size)
+		{
+			auto ptr = reinterpret_cast<__m128i*>(samples + a * sample_size);
+			auto v   = _mm_loadu_si128(ptr);
+			v        = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+			if (sample_size == 4)
+				v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+			_mm_storeu_si128(ptr, v);
+		}
+
+		scalar::swapBytes(samples + a * sample_size, sample_size, count - a);
+	}
+#elif defined(SAMPLEKERNELS_NEON)
+	// Converts 8 16-bit samples to 8-bit, rounding the same way as
+	// scalar::pcm16to8bits
+	uint8x8_t pcm16to8x8(int16x8_t samples)
+	{
+		const auto max = vdupq_n_s16(127);
+
+		// Round up if negative, or if the low byte is > 127 and the result won't overflow
+		auto high  = vshrq_n_s16(samples, 8);
+		auto round = vorrq_u16(
+			vcltq_s16(samples, vdupq_n_s16(0)),
+			vandq_u16(vcgtq_s16(vandq_s16(samples, vdupq_n_s16(0xFF)), max), vcltq_s16(high, max)));
+
+		// (round is all bits set where rounding up)
+		auto result = vsubq_s16(vaddq_s16(high, vdupq_n_s16(128)), vreinterpretq_s16_u16(round));
+		return vqmovun_s16(result);
+	}
+
+	void pcm16to8(const uint8_t* in, uint8_t* out, unsigned count)
+	{
+		unsigned a = 0;
+		for (; a + 16 <= count; a += 16)
+		{
+			auto lo = pcm16to8x8(vreinterpretq_s16_u8(vld1q_u8(in + a * 2)));
+			auto hi = pcm16to8x8(vreinterpretq_s16_u8(vld1q_u8(in + a * 2 + 16)));
+			vst1q_u8(out + a, vcombine_u8(lo, hi));
+		}
+
+		scalar::pcm16to8(in + a * 2, out + a, count - a);
+	}
+
+	void stereoToMono(const uint8_t* in, uint8_t* out, unsigned count)
+	{
+		unsigned a = 0;
+		for (; a + 16 <= count; a += 16)
+		{
+			auto lr = vld2q_u8(in + a * 2);
+			vst1q_u8(out + a, vhaddq_u8(lr.val[0], lr.val[1]));
+		}
+
+		scalar::stereoToMono(in + a * 2, out + a, count - a);
+	}
+
+	void swapBytes(uint8_t* samples, unsigned sample_size, unsigned count)
+	{
+		if (sample_size != 2 && sample_size != 4)
+		{
+			scalar::swapBytes(samples, sample_size, count);
+			return;
+		}
+
+		unsigned a = 0;
+		for (; (count - a) * sample_size >= 16; a += 16 / sample_size)
+		{
+			auto v = vld1q_u8(samples + a * sample_size);
+			vst1q_u8(samples + a * sample_size, sample_size == 2 ? vrev16q_u8(v) : vrev32q_u8(v));
+		}
+
+		scalar::swapBytes(samples + a * sample_size, sample_size, count - a);
+	}
+#else
+	using scalar::pcm16to8;
+	using scalar::stereoToMono;
+	using scalar::swapBytes;
+#endif
+} // namespace simd
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// SampleKernels Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Converts [count] 16-bit samples from [in] to 8-bit samples in [out]
+// -----------------------------------------------------------------------------
+void samplekernels::pcm16to8(const uint8_t* in, uint8_t* out, unsigned count)
+{
+	simd::pcm16to8(in, out, count);
+}
+
+// -----------------------------------------------------------------------------
+// Converts [count] 24-bit samples from [in] to 8-bit samples in [out]
+// -----------------------------------------------------------------------------
+void samplekernels::pcm24to8(const uint8_t* in, uint8_t* out, unsigned count)
+{
+	for (unsigned a = 0; a < count; ++a)
+		out[a] = scalar::pcm24to8bits(in[a * 3] | (in[a * 3 + 1] << 8) | (in[a * 3 + 2] << 16));
+}
+
+// -----------------------------------------------------------------------------
+// Converts [count] 32-bit samples from [in] to 8-bit samples in [out]
+// -----------------------------------------------------------------------------
+void samplekernels::pcm32to8(const uint8_t* in, uint8_t* out, unsigned count)
+{
+	for (unsigned a = 0; a < count; ++a)
+	{
+		int32_t val;
+		memcpy(&val, in + a * 4, 4);
+		out[a] = scalar::pcm32to8bits(val);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Converts [count] 8-bit A-law [samples] to 8-bit linear PCM (in place)
+// -----------------------------------------------------------------------------
+void samplekernels::alawTo8(uint8_t* samples, unsigned count)
+{
+	auto table = lawTable(true);
+	for (unsigned a = 0; a < count; ++a)
+		samples[a] = table[samples[a]];
+}
+
+// -----------------------------------------------------------------------------
+// Converts [count] 8-bit µ-law [samples] to 8-bit linear PCM (in place)
+// -----------------------------------------------------------------------------
+void samplekernels::mulawTo8(uint8_t* samples, unsigned count)
+{
+	auto table = lawTable(false);
+	for (unsigned a = 0; a < count; ++a)
+		samples[a] = table[samples[a]];
+}
+
+// -----------------------------------------------------------------------------
+// Averages [count] pairs of 8-bit stereo samples from [in] into mono samples
+// in [out]. [in] and [out] can be the same
+// -----------------------------------------------------------------------------
+void samplekernels::stereoToMono(const uint8_t* in, uint8_t* out, unsigned count)
+{
+	simd::stereoToMono(in, out, count);
+}
+
+// -----------------------------------------------------------------------------
+// Reverses the byte order of [count] [samples] of [sample_size] bytes each
+// (in place)
+// -----------------------------------------------------------------------------
+void samplekernels::swapBytes(uint8_t* samples, unsigned sample_size, unsigned count)
+{
+	simd::swapBytes(samples, sample_size, count);
+}
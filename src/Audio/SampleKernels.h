@@ -0,0 +1,16 @@
+#pragma once
+
+// Bulk audio sample conversion functions used by the sound format
+// conversions, with SIMD implementations where available (SSE2 on x86, NEON
+// on ARM) and a scalar fallback.
+// All multi-byte samples are signed little-endian, 8-bit samples are unsigned
+namespace slade::samplekernels
+{
+void pcm16to8(const uint8_t* in, uint8_t* out, unsigned count);
+void pcm24to8(const uint8_t* in, uint8_t* out, unsigned count);
+void pcm32to8(const uint8_t* in, uint8_t* out, unsigned count);
+void alawTo8(uint8_t* samples, unsigned count);
+void mulawTo8(uint8_t* samples, unsigned count);
+void stereoToMono(const uint8_t* in, uint8_t* out, unsigned count);
+void swapBytes(uint8_t* samples, unsigned sample_size, unsigned count);
+} // namespace slade::samplekernels
@@ -0,0 +1,157 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    StreamDecoder.cpp
+// Description: StreamDecoder class, decodes audio for a sound stream on a
+//              background thread into a bounded pool of sample blocks
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "StreamDecoder.h"
+
+using namespace slade;
+using namespace audio;
+
+
+// -----------------------------------------------------------------------------
+//
+// StreamDecoder Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// StreamDecoder class constructor
+// -----------------------------------------------------------------------------
+StreamDecoder::StreamDecoder(size_t block_samples, unsigned n_blocks) : blocks_(n_blocks)
+{
+	for (auto& block : blocks_)
+		block.samples.resize(block_samples);
+}
+
+// -----------------------------------------------------------------------------
+// Starts decoding with [decode] on the decoding thread (stopping any current
+// decoding first)
+// -----------------------------------------------------------------------------
+void StreamDecoder::start(DecodeFunc decode)
+{
+	stop();
+
+	thread_ = std::thread(
+		[this, decode = std::move(decode)]
+		{
+			while (true)
+			{
+				// Wait for a free block
+				unsigned index;
+				{
+					std::unique_lock lock(mutex_);
+					cv_.wait(lock, [this] { return stop_ || !free_.empty(); });
+					if (stop_)
+						return;
+					index = free_.back();
+					free_.pop_back();
+				}
+
+				// Decode into it
+				auto& block = blocks_[index];
+				block.count = decode(block.samples.data(), block.samples.size());
+
+				// Add to decoded queue (or end if nothing was decoded)
+				{
+					std::lock_guard lock(mutex_);
+					if (block.count == 0)
+					{
+						free_.push_back(index);
+						ended_ = true;
+					}
+					else
+						decoded_.push_back(index);
+				}
+				cv_.notify_all();
+
+				if (block.count == 0)
+					return;
+			}
+		});
+}
+
+// -----------------------------------------------------------------------------
+// Stops decoding and discards any decoded blocks
+// -----------------------------------------------------------------------------
+void StreamDecoder::stop()
+{
+	{
+		std::lock_guard lock(mutex_);
+		stop_ = true;
+	}
+	cv_.notify_all();
+	if (thread_.joinable())
+		thread_.join();
+
+	// Reset block pool
+	free_.clear();
+	decoded_.clear();
+	for (unsigned a = 0; a < blocks_.size(); ++a)
+		free_.push_back(a);
+	playing_ = -1;
+	ended_   = false;
+	stop_    = false;
+}
+
+// -----------------------------------------------------------------------------
+// Gets the next decoded block of [samples] ([count] samples), waiting for it
+// to be decoded if needed. The block is valid until the next call.
+// Returns false if the end of the stream was reached (or decoding isn't
+// running)
+// -----------------------------------------------------------------------------
+bool StreamDecoder::next(const int16_t*& samples, size_t& count)
+{
+	std::unique_lock lock(mutex_);
+
+	// The previous block is finished with
+	if (playing_ >= 0)
+	{
+		free_.push_back(playing_);
+		playing_ = -1;
+		cv_.notify_all();
+	}
+
+	if (!thread_.joinable())
+		return false;
+
+	cv_.wait(lock, [this] { return stop_ || ended_ || !decoded_.empty(); });
+	if (decoded_.empty())
+		return false;
+
+	playing_ = decoded_.front();
+	decoded_.pop_front();
+	samples = blocks_[playing_].samples.data();
+	count   = blocks_[playing_].count;
+
+	return true;
+}
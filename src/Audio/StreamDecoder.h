@@ -0,0 +1,57 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace slade::audio
+{
+// Decodes audio on a background thread into a bounded pool of sample blocks,
+// for sound streams to play from. Decoding runs ahead of playback until all
+// blocks in the pool are filled.
+//
+// This uses a dedicated thread rather than a task: it lives for as long as
+// the stream plays, mostly blocked waiting for free blocks, which would tie
+// up a task worker indefinitely, and decoding can't wait behind queued tasks
+// without the stream running dry. The thread is joined by stop() (and so by
+// the destructor)
+class StreamDecoder
+{
+public:
+	// Decodes up to [max] samples into [samples], returning the number decoded
+	// (0 at the end of the stream)
+	typedef std::function<size_t(int16_t* samples, size_t max)> DecodeFunc;
+
+	StreamDecoder(size_t block_samples = 16384, unsigned n_blocks = 8);
+	~StreamDecoder() { stop(); }
+
+	// Non-copyable (owns the decoding thread)
+	StreamDecoder(const StreamDecoder&)            = delete;
+	StreamDecoder& operator=(const StreamDecoder&) = delete;
+
+	bool isRunning() const { return thread_.joinable(); }
+
+	void start(DecodeFunc decode);
+	void stop();
+	bool next(const int16_t*& samples, size_t& count);
+
+private:
+	struct Block
+	{
+		vector<int16_t> samples;
+		size_t          count = 0;
+	};
+
+	vector<Block>           blocks_;
+	vector<unsigned>        free_;    // Blocks available to decode into
+	std::deque<unsigned>    decoded_; // Decoded blocks, in playback order
+	int                     playing_ = -1; // Block last returned by next, still in use by the stream
+	bool                    ended_   = false;
+	bool                    stop_    = false;
+	std::mutex              mutex_;
+	std::condition_variable cv_;
+	std::thread             thread_;
+};
+} // namespace slade::audio
@@ -39,10 +39,12 @@
 #include "Decorate.h"
 #include "GenLineSpecial.h"
 #include "General/Console.h"
+#include "General/Misc.h"
 #include "SLADEMap/SLADEMap.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
 #include "ZScript.h"
+#include <filesystem>
 
 using namespace slade;
 using namespace game;
@@ -56,6 +58,158 @@ using namespace game;
 EXTERN_CVAR(String, game_configuration)
 EXTERN_CVAR(String, port_configuration)
 CVAR(Bool, debug_configuration, false, CVar::Flag::Save)
+CVAR(Bool, game_config_cache, true, CVar::Flag::Save)
+
+namespace
+{
+constexpr unsigned CONFIG_CACHE_MAX_FILES = 16;
+constexpr int      MAX_LOOKUP_TABLE_SIZE  = 65536; // Larger ids are looked up in the map
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the parsed configuration cache directory, creating it if needed
+// -----------------------------------------------------------------------------
+const string& configCacheDir()
+{
+	static const string dir = []
+	{
+		auto path = app::path("config_cache", app::Dir::User);
+		std::error_code error;
+		std::filesystem::create_directories(path, error);
+		return path;
+	}();
+
+	return dir;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the path to the cached parse tree file for [key]
+// -----------------------------------------------------------------------------
+string configCachePath(uint64_t key)
+{
+	return fmt::format("{}/{:016x}.ptb", configCacheDir(), key);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the cache key for full configuration text [cfg] read for map
+// [format]. The text includes all included files, so any change to a
+// contributing file changes the key
+// -----------------------------------------------------------------------------
+uint64_t configCacheKey(string_view cfg, MapFormat format)
+{
+	auto hash = misc::hash64(reinterpret_cast<const uint8_t*>(cfg.data()), static_cast<uint32_t>(cfg.size()));
+	return hash ^ ((static_cast<uint64_t>(format) + 1) * 0x9e3779b97f4a7c15ull);
+}
+
+// -----------------------------------------------------------------------------
+// Loads the cached parse tree for [key] into [parser].
+// Returns false if there is no (valid) cached tree
+// -----------------------------------------------------------------------------
+bool loadCachedConfig(uint64_t key, Parser& parser)
+{
+	auto path = configCachePath(key);
+	if (!wxFileExists(path))
+		return false;
+
+	MemChunk mc;
+	if (!mc.importFile(path) || !parser.readBinary(mc))
+	{
+		log::warning("Invalid cached game configuration {}, re-parsing", path);
+		return false;
+	}
+
+	// Mark as recently used (see saveCachedConfig)
+	std::error_code error;
+	std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the parse tree in [parser] to the cache for [key], removing the least
+// recently used cached trees if there are more than CONFIG_CACHE_MAX_FILES
+// -----------------------------------------------------------------------------
+void saveCachedConfig(uint64_t key, const Parser& parser)
+{
+	MemChunk mc;
+	parser.writeBinary(mc);
+	if (!mc.exportFile(configCachePath(key)))
+		return;
+
+	// Prune
+	vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+	std::error_code                                                           error;
+	for (const auto& item : std::filesystem::directory_iterator(configCacheDir(), error))
+		if (item.is_regular_file(error) && item.path().extension() == ".ptb")
+			files.emplace_back(item.last_write_time(error), item.path());
+	if (files.size() <= CONFIG_CACHE_MAX_FILES)
+		return;
+
+	std::sort(files.begin(), files.end());
+	for (unsigned a = 0; a < files.size() - CONFIG_CACHE_MAX_FILES; ++a)
+		std::filesystem::remove(files[a].second, error);
+}
+
+// -----------------------------------------------------------------------------
+// Builds [table] of pointers to the values in [map], indexed by key (up to
+// MAX_LOOKUP_TABLE_SIZE), with null for keys not in the map
+// -----------------------------------------------------------------------------
+template<typename T> void buildLookupTable(const std::map<int, T>& map, vector<const T*>& table)
+{
+	table.clear();
+	if (map.empty())
+		return;
+
+	table.resize(std::clamp(map.rbegin()->first + 1, 0, MAX_LOOKUP_TABLE_SIZE), nullptr);
+	for (const auto& [id, value] : map)
+		if (id >= 0 && id < static_cast<int>(table.size()))
+			table[id] = &value;
+}
+
+// -----------------------------------------------------------------------------
+// Builds the UDMF [fields] set by binary format [flags], from the
+// space-separated UDMF field names of each flag. A field name beginning with
+// '!' is set when the flag is *not* set (eg. "!single" for multiplayer only)
+// -----------------------------------------------------------------------------
+void buildFlagFields(const vector<Configuration::Flag>& flags, vector<Configuration::UDMFFlagField>& fields)
+{
+	fields.clear();
+	for (const auto& flag : flags)
+		for (auto name : strutil::splitV(flag.udmf, ' '))
+		{
+			bool inverted = strutil::startsWith(name, '!');
+			if (inverted)
+				name.remove_prefix(1);
+			if (name.empty())
+				continue;
+
+			// Get (or add) the field
+			auto id    = MobjPropertyList::id(name);
+			auto field = std::find_if(fields.begin(), fields.end(), [id](const auto& f) { return f.id == id; });
+			if (field == fields.end())
+			{
+				fields.push_back({ id });
+				field = fields.end() - 1;
+			}
+
+			if (inverted)
+			{
+				field->inverted_mask |= flag.flag;
+				field->inverted = true;
+			}
+			else
+				field->mask |= flag.flag;
+		}
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -167,7 +321,7 @@ void Configuration::readActionSpecials(
 		{
 			// Add current node name to group path
 			groupname = fmt::format("{}/{}", group->name(), groupname);
-			group     = dynamic_cast<ParseTreeNode*>(group->parent());
+			group     = group->parentPTN();
 		}
 	}
 	strutil::removeSuffixIP(groupname, '/');
@@ -232,7 +386,7 @@ void Configuration::readThingTypes(ParseTreeNode* node, const ThingType& group_d
 		{
 			// Add current node name to group path
 			groupname = fmt::format("{}/{}", group->name(), groupname);
-			group     = dynamic_cast<ParseTreeNode*>(group->parent());
+			group     = group->parentPTN();
 		}
 	}
 	strutil::removeSuffixIP(groupname, '/');
@@ -546,6 +700,10 @@ bool Configuration::readConfiguration(
 		setDefaults();
 		action_specials_.clear();
 		thing_types_.clear();
+		action_special_table_.clear();
+		action_special_tree_.clear();
+		thing_type_table_.clear();
+		++thing_types_version_;
 		flags_thing_.clear();
 		flags_line_.clear();
 		sector_types_.clear();
@@ -557,18 +715,24 @@ bool Configuration::readConfiguration(
 		tt_group_defaults_.clear();
 	}
 
-	// Parse the full configuration
+	// Parse the full configuration, or load the parse tree from the cache if
+	// it was parsed before (embedded configurations aren't cached)
 	Parser parser;
-	switch (format)
+	auto   cache_key = game_config_cache && !ignore_game ? configCacheKey(cfg, format) : 0;
+	if (!cache_key || !loadCachedConfig(cache_key, parser))
 	{
-	case MapFormat::Doom: parser.define("MAP_DOOM"); break;
-	case MapFormat::Hexen: parser.define("MAP_HEXEN"); break;
-	case MapFormat::Doom64: parser.define("MAP_DOOM64"); break;
-	case MapFormat::Doom32X: parser.define("MAP_DOOM32X"); break;
-	case MapFormat::UDMF: parser.define("MAP_UDMF"); break;
-	default: parser.define("MAP_UNKNOWN"); break;
+		switch (format)
+		{
+		case MapFormat::Doom: parser.define("MAP_DOOM"); break;
+		case MapFormat::Hexen: parser.define("MAP_HEXEN"); break;
+		case MapFormat::Doom64: parser.define("MAP_DOOM64"); break;
+		case MapFormat::Doom32X: parser.define("MAP_DOOM32X"); break;
+		case MapFormat::UDMF: parser.define("MAP_UDMF"); break;
+		default: parser.define("MAP_UNKNOWN"); break;
+		}
+		if (parser.parseText(cfg, source) && cache_key)
+			saveCachedConfig(cache_key, parser);
 	}
-	parser.parseText(cfg, source);
 
 	// Process parsed data
 	auto base = parser.parseTreeRoot();
@@ -878,6 +1042,8 @@ bool Configuration::readConfiguration(
 			log::warning("Unexpected game configuration section \"{}\", skipping", node->name());
 	}
 
+	updateLookupTables();
+
 	return true;
 }
 
@@ -995,13 +1161,11 @@ bool Configuration::openConfig(const string& game, const string& port, MapFormat
 // -----------------------------------------------------------------------------
 // Returns the action special definition for [id]
 // -----------------------------------------------------------------------------
-const ActionSpecial& Configuration::actionSpecial(unsigned id)
+const ActionSpecial& Configuration::actionSpecial(unsigned id) const
 {
-	auto& as = action_specials_[id];
-
 	// Defined Action Special
-	if (as.defined())
-		return as;
+	if (auto* as = findActionSpecial(id); as && as->defined())
+		return *as;
 
 	// Boom Generalised Special
 	if (featureSupported(Feature::Boom) && id >= 0x2f80)
@@ -1019,7 +1183,7 @@ const ActionSpecial& Configuration::actionSpecial(unsigned id)
 // -----------------------------------------------------------------------------
 // Returns the action special name for [special], if any
 // -----------------------------------------------------------------------------
-string Configuration::actionSpecialName(int special)
+string Configuration::actionSpecialName(int special) const
 {
 	// Check special id is valid
 	if (special < 0)
@@ -1027,8 +1191,8 @@ string Configuration::actionSpecialName(int special)
 	else if (special == 0)
 		return "None";
 
-	if (action_specials_[special].defined())
-		return action_specials_[special].name();
+	if (auto* as = findActionSpecial(special); as && as->defined())
+		return as->name();
 	else if (special >= 0x2F80 && featureSupported(Feature::Boom))
 		return genlinespecial::parseLineType(special);
 	else
@@ -1038,13 +1202,113 @@ string Configuration::actionSpecialName(int special)
 // -----------------------------------------------------------------------------
 // Returns the thing type definition for [type]
 // -----------------------------------------------------------------------------
-const ThingType& Configuration::thingType(unsigned type)
+const ThingType& Configuration::thingType(unsigned type) const
 {
-	auto& ttype = thing_types_[type];
-	if (ttype.defined())
-		return ttype;
-	else
-		return ThingType::unknown();
+	// Don't add an entry for undefined types here, so thing types can be looked
+	// up from multiple threads (eg. by map checks)
+	const ThingType* tt = nullptr;
+	if (type < thing_type_table_.size())
+		tt = thing_type_table_[type];
+	if (!tt)
+	{
+		// Not in the lookup table (large DoomEdNum or added since the table
+		// was last updated)
+		auto i = thing_types_.find(type);
+		if (i != thing_types_.end())
+			tt = &i->second;
+	}
+
+	return tt && tt->defined() ? *tt : ThingType::unknown();
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the dense action special and thing type lookup tables and the
+// binary flag -> UDMF field tables, and marks any ThingType cached by map
+// things as out of date (see MapThing::typeDef).
+// Must be called after action specials, thing types or flags are added or
+// removed
+// -----------------------------------------------------------------------------
+void Configuration::updateLookupTables()
+{
+	buildLookupTable(action_specials_, action_special_table_);
+	buildLookupTable(thing_types_, thing_type_table_);
+	action_special_tree_.clear();
+	++thing_types_version_;
+
+	// UDMF fields for binary format flags
+	buildFlagFields(flags_line_, udmf_line_fields_);
+	buildFlagFields(flags_thing_, udmf_thing_fields_);
+
+	// Binary format things are in all game modes unless a flag says otherwise
+	for (auto mode : { "single", "coop", "dm" })
+	{
+		auto id      = MobjPropertyList::id(mode);
+		auto is_mode = [id](const UDMFFlagField& field) { return field.id == id; };
+		if (std::none_of(udmf_thing_fields_.begin(), udmf_thing_fields_.end(), is_mode))
+			udmf_thing_fields_.push_back({ id, 0, 0, true });
+	}
+
+	// UDMF fields for Hexen SPAC trigger values
+	for (auto& fields : udmf_trigger_fields_)
+		fields.clear();
+	for (const auto& trigger : triggers_line_)
+		if (trigger.flag >= 0 && trigger.flag < static_cast<int>(udmf_trigger_fields_.size()))
+			for (auto name : strutil::splitV(trigger.udmf, ' '))
+				if (!name.empty())
+					udmf_trigger_fields_[trigger.flag].push_back(MobjPropertyList::id(name));
+}
+
+// -----------------------------------------------------------------------------
+// Returns the groups and defined action specials of the configuration as a
+// flat list of tree nodes, in the order they should be added to a tree (parent
+// groups always come before their children). The list is only built once per
+// configuration, so special tree controls don't need to rebuild the group
+// structure each time they are created
+// -----------------------------------------------------------------------------
+const vector<Configuration::SpecialTreeNode>& Configuration::actionSpecialTree() const
+{
+	if (!action_special_tree_.empty())
+		return action_special_tree_;
+
+	std::map<string, int> group_nodes; // Full group path -> node index
+	for (auto& [number, special] : action_specials_)
+	{
+		if (!special.defined())
+			continue;
+
+		// Get (or create) the group node for the special
+		int    parent = -1;
+		string path;
+		if (!special.group().empty())
+			for (auto& group : strutil::splitV(special.group(), '/'))
+			{
+				if (!path.empty())
+					path += '/';
+				path += group;
+
+				auto [i, inserted] = group_nodes.try_emplace(path, action_special_tree_.size());
+				if (inserted)
+					action_special_tree_.push_back({ string{ group }, parent, -1 });
+				parent = i->second;
+			}
+
+		action_special_tree_.push_back({ fmt::format("{}: {}", special.number(), special.name()), parent, number });
+	}
+
+	return action_special_tree_;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the action special for [id] (defined or not), or null if there is
+// none
+// -----------------------------------------------------------------------------
+const ActionSpecial* Configuration::findActionSpecial(unsigned id) const
+{
+	if (id < action_special_table_.size() && action_special_table_[id])
+		return action_special_table_[id];
+
+	auto i = action_specials_.find(id);
+	return i != action_specials_.end() ? &i->second : nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -1366,7 +1630,9 @@ void Configuration::setThingBasicFlag(string_view flag, MapThing* thing, MapForm
 // -----------------------------------------------------------------------------
 bool Configuration::parseDecorateDefs(Archive* archive)
 {
-	return readDecorateDefs(archive, thing_types_, parsed_types_);
+	auto ok = readDecorateDefs(archive, thing_types_, parsed_types_);
+	updateLookupTables();
+	return ok;
 }
 
 // -----------------------------------------------------------------------------
@@ -1387,6 +1653,7 @@ void Configuration::clearDecorateDefs() const
 void Configuration::importZScriptDefs(zscript::Definitions& defs)
 {
 	defs.exportThingTypes(thing_types_, parsed_types_);
+	updateLookupTables();
 }
 
 // -----------------------------------------------------------------------------
@@ -1416,6 +1683,8 @@ void Configuration::linkDoomEdNums()
 			log::info(2, "Linked parsed class {} to DoomEdNum {}", parsed.className(), ednum);
 		}
 	}
+
+	updateLookupTables();
 }
 
 // -----------------------------------------------------------------------------
@@ -1753,24 +2022,47 @@ const string& Configuration::spacTriggerUDMFName(unsigned trigger_index)
 }
 
 // -----------------------------------------------------------------------------
-// Returns the UDMF property definition matching [name] for MapObject [type]
+// Returns the ids of the UDMF fields for the Hexen SPAC [trigger] value (as
+// stored in bits 10-12 of the line flags)
+// -----------------------------------------------------------------------------
+const vector<MobjPropertyList::Id>& Configuration::udmfSpacTriggerFields(int trigger) const
+{
+	static const vector<MobjPropertyList::Id> none;
+
+	if (trigger < 0 || trigger >= static_cast<int>(udmf_trigger_fields_.size()))
+		return none;
+
+	return udmf_trigger_fields_[trigger];
+}
+
+// -----------------------------------------------------------------------------
+// Returns the UDMF property definition matching [name] for MapObject [type].
+// Existing properties are only looked up (not inserted), so this is safe to
+// call from multiple threads for those (see UniversalDoomMapFormat::writeMap)
 // -----------------------------------------------------------------------------
 UDMFProperty* Configuration::getUDMFProperty(const string& name, MapObject::Type type)
 {
 	using Type = MapObject::Type;
 
+	UDMFPropMap* map;
 	if (type == Type::Vertex)
-		return &udmf_vertex_props_[name];
+		map = &udmf_vertex_props_;
 	else if (type == Type::Line)
-		return &udmf_linedef_props_[name];
+		map = &udmf_linedef_props_;
 	else if (type == Type::Side)
-		return &udmf_sidedef_props_[name];
+		map = &udmf_sidedef_props_;
 	else if (type == Type::Sector)
-		return &udmf_sector_props_[name];
+		map = &udmf_sector_props_;
 	else if (type == Type::Thing)
-		return &udmf_thing_props_[name];
+		map = &udmf_thing_props_;
 	else
 		return nullptr;
+
+	auto i = map->find(name);
+	if (i != map->end())
+		return &i->second;
+
+	return &(*map)[name];
 }
 
 // -----------------------------------------------------------------------------
@@ -66,6 +66,18 @@ namespace game
 			bool   activation;
 		};
 
+		// A UDMF field set from the flags of a binary format line or thing
+		// when converting a map to UDMF (see updateLookupTables)
+		struct UDMFFlagField
+		{
+			MobjPropertyList::Id id            = 0;
+			int                  mask          = 0;     // True if any of these flags are set
+			int                  inverted_mask = 0;     // ...or if none of these are set ("!field")
+			bool                 inverted      = false; // Whether inverted_mask applies
+
+			bool value(int flags) const { return (flags & mask) != 0 || (inverted && (flags & inverted_mask) == 0); }
+		};
+
 		struct MapConf
 		{
 			string mapname;
@@ -73,6 +85,14 @@ namespace game
 			string sky2;
 		};
 
+		// A node in the action special tree (see actionSpecialTree)
+		struct SpecialTreeNode
+		{
+			string label;   // Group name, or "<number>: <name>" for a special
+			int    parent;  // Index of the parent group node, -1 if none
+			int    special; // Special number, -1 for a group
+		};
+
 		Configuration();
 		~Configuration() = default;
 
@@ -116,12 +136,15 @@ namespace game
 		bool openConfig(const string& game, const string& port = "", MapFormat format = MapFormat::Unknown);
 
 		// Action specials
-		const ActionSpecial& actionSpecial(unsigned id);
-		string               actionSpecialName(int special);
+		const ActionSpecial& actionSpecial(unsigned id) const;
+		string               actionSpecialName(int special) const;
+
+		const vector<SpecialTreeNode>& actionSpecialTree() const;
 
 		// Thing types
-		const ThingType& thingType(unsigned type);
+		const ThingType& thingType(unsigned type) const;
 		const ThingType& thingTypeGroupDefaults(const string& group);
+		unsigned         thingTypesVersion() const { return thing_types_version_; }
 
 		// Thing flags
 		int    nThingFlags() const { return flags_thing_.size(); }
@@ -157,6 +180,11 @@ namespace game
 		void        setLineFlag(string_view udmf_name, MapLine* line, MapFormat map_format, bool set = true) const;
 		void        setLineBasicFlag(string_view flag, MapLine* line, MapFormat map_format, bool set = true) const;
 
+		// Binary format flag -> UDMF field conversion
+		const vector<UDMFFlagField>&        udmfLineFlagFields() const { return udmf_line_fields_; }
+		const vector<UDMFFlagField>&        udmfThingFlagFields() const { return udmf_thing_fields_; }
+		const vector<MobjPropertyList::Id>& udmfSpacTriggerFields(int trigger) const;
+
 		// Line action (SPAC) triggers
 		string         spacTriggerString(MapLine* line, MapFormat map_format);
 		int            spacTriggerIndexHexen(const MapLine* line) const;
@@ -222,11 +250,18 @@ namespace game
 
 		// Action specials
 		std::map<int, ActionSpecial> action_specials_;
+		vector<const ActionSpecial*> action_special_table_; // Indexed by special (see updateLookupTables)
+
+		// Groups and specials in the order they are added to the special tree,
+		// built on first use and cleared when the lookup tables are updated
+		mutable vector<SpecialTreeNode> action_special_tree_;
 
 		// Thing types
 		std::map<int, ThingType>    thing_types_;
 		std::map<string, ThingType> tt_group_defaults_;
 		vector<ThingType>           parsed_types_;
+		vector<const ThingType*>    thing_type_table_;        // Indexed by type (see updateLookupTables)
+		unsigned                    thing_types_version_ = 0; // Incremented when thing types change
 		// std::map<string, ThingType> parsed_types_;		// ThingTypes parsed from definitions
 		// (DECORATE, ZScript etc.)
 
@@ -235,6 +270,12 @@ namespace game
 		vector<Flag> flags_line_;
 		vector<Flag> triggers_line_;
 
+		// UDMF fields for binary format flags and (Hexen) SPAC trigger values,
+		// built by updateLookupTables
+		vector<UDMFFlagField>                       udmf_line_fields_;
+		vector<UDMFFlagField>                       udmf_thing_fields_;
+		std::array<vector<MobjPropertyList::Id>, 8> udmf_trigger_fields_;
+
 		// Sector types
 		std::map<int, string> sector_types_;
 
@@ -265,6 +306,9 @@ namespace game
 
 		// Special Presets
 		vector<SpecialPreset> special_presets_;
+
+		void                 updateLookupTables();
+		const ActionSpecial* findActionSpecial(unsigned id) const;
 	};
 } // namespace game
 } // namespace slade
@@ -34,6 +34,7 @@
 #include "Archive/Archive.h"
 #include "Configuration.h"
 #include "Game.h"
+#include "ParsedEntryCache.h"
 #include "ThingType.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
@@ -50,7 +51,36 @@ using namespace game;
 namespace
 {
 EntryType* etype_decorate = nullptr;
-}
+
+// A DECORATE actor definition parsed from an entry, to be added to the thing
+// types (see addActor)
+struct ParsedActor
+{
+	bool           old_format = false; // Old (non-actor) DECORATE definition
+	string         name;
+	string         actor_name;
+	string         parent;
+	string         group;
+	int            ednum = -1;
+	vector<string> game_filters;
+	PropertyList   props;
+};
+
+// The actor definitions parsed from a single DECORATE entry, and the entries
+// it #includes
+struct ParsedDecorate
+{
+	struct Include
+	{
+		string   path;
+		unsigned line;
+		unsigned index; // Index of the actor the #include is before
+	};
+
+	vector<ParsedActor> actors;
+	vector<Include>     includes;
+};
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -236,19 +266,19 @@ void parseStates(Tokenizer& tz, PropertyList& props)
 }
 
 // -----------------------------------------------------------------------------
-// Parses a DECORATE 'actor' definition
+// Parses a DECORATE 'actor' definition into [actor]
 // -----------------------------------------------------------------------------
-void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+void parseDecorateActor(Tokenizer& tz, ParsedActor& actor)
 {
 	// Get actor name
-	auto   name       = tz.next().text;
-	auto   actor_name = name;
-	string parent;
+	auto& name       = actor.name;
+	name             = tz.next().text;
+	actor.actor_name = name;
 
 	// Check for inheritance
 	// string next = tz.peekToken();
 	if (tz.advIfNext(":"))
-		parent = tz.next().text;
+		actor.parent = tz.next().text;
 
 	// Check for replaces
 	if (tz.checkNextNC("replaces"))
@@ -259,18 +289,16 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 		tz.adv();
 
 	// Check for no editor number (ie can't be placed in the map)
-	int ednum;
+	auto& ednum = actor.ednum;
 	if (!tz.peek().isInteger())
 		ednum = -1;
 	else
 		tz.next().toInt(ednum);
 
-	PropertyList found_props;
-	bool         available       = false;
-	bool         filters_present = false;
-	bool         sprite_given    = false;
-	bool         title_given     = false;
-	string       group;
+	auto& found_props  = actor.props;
+	auto& group        = actor.group;
+	bool  sprite_given = false;
+	bool  title_given  = false;
 
 	// Skip "native" keyword if present
 	tz.advIfNextNC("native");
@@ -295,13 +323,9 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 				continue;
 			}
 
-			// Game filter
+			// Game filter (checked when the actor is added)
 			else if (tz.checkNC("game"))
-			{
-				filters_present = true;
-				if (gameDef(configuration().currentGame()).supportsFilter(tz.next().text))
-					available = true;
-			}
+				actor.game_filters.push_back(tz.next().text);
 
 			// Tag
 			else if (!title_given && tz.checkNC("tag"))
@@ -425,62 +449,13 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 	}
 	else
 		log::warning("Warning: Invalid actor definition for {}", name);
-
-	// Ignore actors filtered for other games,
-	// and actors with a negative or null type
-	if (available || !filters_present)
-	{
-		auto group_path = group.empty() ? "Decorate" : "Decorate/" + group;
-
-		// Find existing definition or create it
-		ThingType* def = nullptr;
-		if (ednum <= 0)
-		{
-			for (auto& ptype : parsed)
-				if (strutil::equalCI(ptype.className(), actor_name))
-				{
-					def = &ptype;
-					break;
-				}
-
-			if (!def)
-			{
-				parsed.emplace_back(name, group_path, actor_name);
-				def = &parsed.back();
-			}
-		}
-		else
-			def = &types[ednum];
-
-		// Add/update definition
-		def->define(ednum, name, group_path);
-
-		// Set group defaults (if any)
-		if (!group.empty())
-		{
-			auto& group_defaults = configuration().thingTypeGroupDefaults(group);
-			if (!group_defaults.group().empty())
-				def->copy(group_defaults);
-		}
-
-		// Inherit from parent
-		if (!parent.empty())
-			for (auto& ptype : parsed)
-				if (strutil::equalCI(ptype.className(), parent))
-				{
-					def->copy(ptype);
-					break;
-				}
-
-		// Set parsed properties
-		def->loadProps(found_props);
-	}
 }
 
 // -----------------------------------------------------------------------------
-// Parses an old-style (non-actor) DECORATE definition
+// Parses an old-style (non-actor) DECORATE definition, adding it to [actors]
+// if it has a DoomEdNum
 // -----------------------------------------------------------------------------
-void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
+void parseDecorateOld(Tokenizer& tz, vector<ParsedActor>& actors)
 {
 	string       name, sprite, group;
 	bool         spritefound = false;
@@ -557,10 +532,12 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 			found_props["sprite"] = sprite + frame + '?';
 
 		// Add type
-		types[type].define(type, name, group.empty() ? "Decorate" : "Decorate/" + group);
-
-		// Set parsed properties
-		types[type].loadProps(found_props);
+		auto& actor      = actors.emplace_back();
+		actor.old_format = true;
+		actor.name       = name;
+		actor.group      = group;
+		actor.ednum      = type;
+		actor.props      = found_props;
 
 		log::info(3, "Parsed {} {}: {}", group.length() ? group : "decoration", name, type);
 	}
@@ -569,15 +546,17 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 }
 
 // -----------------------------------------------------------------------------
-// Parses all DECORATE thing definitions in [entry] and adds them to [types]
+// Parses all DECORATE thing definitions in [data] into [result].
+// Entries and game configuration aren't accessed here (see addActor), so this
+// can be called on a worker thread
 // -----------------------------------------------------------------------------
-void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+void parseDecorateData(const MemChunk& data, string_view name, ParsedDecorate& result)
 {
 	// Init tokenizer
 	Tokenizer tz;
 	tz.setSpecialCharacters(":,{}");
 	tz.enableDecorate(true);
-	tz.openMem(entry->data(), entry->name());
+	tz.openMem(data, name);
 
 	// --- Parse ---
 	while (!tz.atEnd())
@@ -585,7 +564,119 @@ void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, ve
 		// Check for #include
 		if (tz.checkNC("#include"))
 		{
-			auto inc_entry = entry->relativeEntry(tz.next().text);
+			const auto& path = tz.next();
+			result.includes.push_back({ path.text, path.line_no, static_cast<unsigned>(result.actors.size()) });
+			tz.adv();
+		}
+
+		// Check for actor definition
+		else if (tz.checkNC("actor"))
+			parseDecorateActor(tz, result.actors.emplace_back());
+		else
+			parseDecorateOld(tz, result.actors); // Old DECORATE definitions might be found
+
+		tz.advIf("}");
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds (or updates) parsed [actor] to [types] (or [parsed] if it has no
+// DoomEdNum)
+// -----------------------------------------------------------------------------
+void addActor(const ParsedActor& actor, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+{
+	auto group_path = actor.group.empty() ? "Decorate" : "Decorate/" + actor.group;
+
+	// Old DECORATE definition
+	if (actor.old_format)
+	{
+		types[actor.ednum].define(actor.ednum, actor.name, group_path);
+		types[actor.ednum].loadProps(actor.props);
+		return;
+	}
+
+	// Ignore actors filtered for other games,
+	// and actors with a negative or null type
+	if (!actor.game_filters.empty())
+	{
+		auto& game_def  = gameDef(configuration().currentGame());
+		bool  available = false;
+		for (const auto& filter : actor.game_filters)
+			if (game_def.supportsFilter(filter))
+				available = true;
+
+		if (!available)
+			return;
+	}
+
+	// Find existing definition or create it
+	ThingType* def = nullptr;
+	if (actor.ednum <= 0)
+	{
+		for (auto& ptype : parsed)
+			if (strutil::equalCI(ptype.className(), actor.actor_name))
+			{
+				def = &ptype;
+				break;
+			}
+
+		if (!def)
+		{
+			parsed.emplace_back(actor.name, group_path, actor.actor_name);
+			def = &parsed.back();
+		}
+	}
+	else
+		def = &types[actor.ednum];
+
+	// Add/update definition
+	def->define(actor.ednum, actor.name, group_path);
+
+	// Set group defaults (if any)
+	if (!actor.group.empty())
+	{
+		auto& group_defaults = configuration().thingTypeGroupDefaults(actor.group);
+		if (!group_defaults.group().empty())
+			def->copy(group_defaults);
+	}
+
+	// Inherit from parent
+	if (!actor.parent.empty())
+		for (auto& ptype : parsed)
+			if (strutil::equalCI(ptype.className(), actor.parent))
+			{
+				def->copy(ptype);
+				break;
+			}
+
+	// Set parsed properties
+	def->loadProps(actor.props);
+}
+
+// -----------------------------------------------------------------------------
+// Adds all DECORATE thing definitions parsed from [entry] in [cache] to
+// [types], including those from any #included entries
+// -----------------------------------------------------------------------------
+void addEntryDefs(
+	ArchiveEntry*                                 entry,
+	const game::ParsedEntryCache<ParsedDecorate>& cache,
+	std::map<int, ThingType>&                     types,
+	vector<ThingType>&                            parsed,
+	vector<ArchiveEntry*>&                        entry_stack)
+{
+	auto* result = cache.get(entry);
+	if (!result)
+		return;
+
+	entry_stack.push_back(entry);
+
+	auto include = result->includes.begin();
+	for (unsigned a = 0; a <= result->actors.size(); ++a)
+	{
+		// #includes before this actor
+		for (; include != result->includes.end() && include->index == a; ++include)
+		{
+			auto inc_entry = entry->relativeEntry(include->path);
 
 			// Check #include path could be resolved
 			if (!inc_entry)
@@ -594,27 +685,40 @@ void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, ve
 					"Warning parsing DECORATE entry {}: "
 					"Unable to find #included entry \"{}\" at line {}, skipping",
 					entry->name(),
-					tz.current().text,
-					tz.current().line_no);
+					include->path,
+					include->line);
+			}
+			else if (VECTOR_EXISTS(entry_stack, inc_entry))
+			{
+				log::warning(
+					"Warning parsing DECORATE entry {}: "
+					"Detected circular #include \"{}\" on line {}, skipping",
+					entry->name(),
+					include->path,
+					include->line);
 			}
 			else
-				parseDecorateEntry(inc_entry, types, parsed);
-
-			tz.adv();
+				addEntryDefs(inc_entry, cache, types, parsed, entry_stack);
 		}
 
-		// Check for actor definition
-		else if (tz.checkNC("actor"))
-			parseDecorateActor(tz, types, parsed);
-		else
-			parseDecorateOld(tz, types); // Old DECORATE definitions might be found
-
-		tz.advIf("}");
+		if (a < result->actors.size())
+			addActor(result->actors[a], types, parsed);
 	}
 
 	// Set entry type
 	if (etype_decorate && entry->type() != etype_decorate)
 		entry->setType(etype_decorate);
+
+	entry_stack.pop_back();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the cache of parsed DECORATE entries in resource archives
+// -----------------------------------------------------------------------------
+game::ParsedEntryCache<ParsedDecorate>& parseCache()
+{
+	static game::ParsedEntryCache<ParsedDecorate> cache{ parseDecorateData };
+	return cache;
 }
 
 } // namespace
@@ -650,13 +754,27 @@ bool game::readDecorateDefs(Archive* archive, std::map<int, ThingType>& types, v
 	if (etype_decorate == EntryType::unknownType())
 		etype_decorate = nullptr;
 
-	// Parse DECORATE entries
+	// Parse DECORATE entries (and their #includes), reusing the results for any
+	// unchanged entries parsed previously
+	parseCache().parse(decorate_entries);
 	for (auto entry : decorate_entries)
-		parseDecorateEntry(entry, types, parsed);
+	{
+		vector<ArchiveEntry*> entry_stack;
+		addEntryDefs(entry, parseCache(), types, parsed, entry_stack);
+	}
 
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Removes cached parsed DECORATE entries that weren't used since the last
+// call (ie. entries in archives that were closed or modified)
+// -----------------------------------------------------------------------------
+void game::pruneDecorateCache()
+{
+	parseCache().pruneUnused();
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -682,7 +800,12 @@ CONSOLE_COMMAND(test_decorate, 0, false)
 	{
 		auto entry = archive->entryAtPath(args[0]);
 		if (entry)
-			parseDecorateEntry(entry, types, parsed);
+		{
+			game::ParsedEntryCache<ParsedDecorate> cache{ parseDecorateData };
+			vector<ArchiveEntry*>                  entry_stack;
+			cache.parse({ entry });
+			addEntryDefs(entry, cache, types, parsed, entry_stack);
+		}
 		else
 			log::console("Entry not found");
 	}
@@ -20,5 +20,6 @@ namespace game
 	};
 
 	bool readDecorateDefs(Archive* archive, std::map<int, ThingType>& types, vector<ThingType>& parsed);
+	void pruneDecorateCache();
 } // namespace game
 } // namespace slade
@@ -36,11 +36,12 @@
 #include "Archive/ArchiveManager.h"
 #include "Archive/Formats/ZipArchive.h"
 #include "Configuration.h"
+#include "Decorate.h"
+#include "General/Tasks.h"
 #include "TextEditor/TextLanguage.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
 #include "ZScript.h"
-#include <thread>
 
 using namespace slade;
 using namespace game;
@@ -60,7 +61,6 @@ std::map<string, PortDef> port_defs;
 PortDef                   port_def_unknown;
 zscript::Definitions      zscript_base;
 zscript::Definitions      zscript_custom;
-unique_ptr<std::thread>   zscript_parse_thread;
 } // namespace slade::game
 CVAR(String, game_configuration, "", CVar::Flag::Save)
 CVAR(String, port_configuration, "", CVar::Flag::Save)
@@ -269,6 +269,11 @@ void game::updateCustomDefinitions()
 	config_current.importZScriptDefs(zscript_custom);
 	config_current.linkDoomEdNums();
 
+	// Clear cached parse results for entries that are no longer open
+	zscript::pruneParseCache();
+	pruneDecorateCache();
+	pruneMapInfoCache();
+
 	auto lang = TextLanguage::fromId("zscript");
 	if (lang)
 	{
@@ -416,32 +421,34 @@ void game::init()
 	// Load zdoom.pk3 stuff
 	if (wxFileExists(zdoom_pk3_path))
 	{
-		zscript_parse_thread = std::make_unique<std::thread>([=]() {
-			ZipArchive zdoom_pk3;
-			if (!zdoom_pk3.open(zdoom_pk3_path))
-				return;
+		tasks::run(
+			[=](tasks::Task&)
+			{
+				ZipArchive zdoom_pk3;
+				if (!zdoom_pk3.open(zdoom_pk3_path))
+					return;
 
-			// ZScript
-			auto zscript_entry = zdoom_pk3.entryAtPath("zscript.txt");
+				// ZScript
+				auto zscript_entry = zdoom_pk3.entryAtPath("zscript.txt");
 
-			if (!zscript_entry)
-			{
-				// Bail out if no entry is found.
-				log::warning(1, "Could not find \'zscript.txt\' in " + zdoom_pk3_path);
-			}
-			else
-			{
-				zscript_base.parseZScript(zscript_entry);
+				if (!zscript_entry)
+				{
+					// Bail out if no entry is found.
+					log::warning(1, "Could not find \'zscript.txt\' in " + zdoom_pk3_path);
+				}
+				else
+				{
+					zscript_base.parseZScript(zscript_entry);
 
-				auto lang = TextLanguage::fromId("zscript");
-				if (lang)
-					lang->loadZScript(zscript_base);
+					auto lang = TextLanguage::fromId("zscript");
+					if (lang)
+						lang->loadZScript(zscript_base);
 
-				// MapInfo
-				config_current.parseMapInfo(zdoom_pk3);
-			}
-		});
-		zscript_parse_thread->detach();
+					// MapInfo
+					config_current.parseMapInfo(zdoom_pk3);
+				}
+			},
+			tasks::Priority::Low);
 	}
 
 	// Update custom definitions when an archive is opened or closed
@@ -237,82 +237,195 @@ static const char* Steps[] = {
 	"24",
 };
 
-// ------------------------------------------------------------------------
-// Returns a string representation of the generalised line value [type]
-// ------------------------------------------------------------------------
-string parseLineType(int type)
+namespace
 {
-	string type_string;
+// Bit field of a generalised special property
+struct Field
+{
+	int mask;
+	int shift;
+};
 
-	// Floor type
-	if (type >= 0x6000)
+// Base value and property bit fields of a generalised special type, in the
+// order they are given in the props array (trigger is always first)
+struct TypeLayout
+{
+	SpecialType type;
+	int         base;
+	unsigned    n_props;
+	Field       fields[7];
+};
+
+// Layouts of each generalised special type, in descending order of base value
+constexpr TypeLayout Layouts[] = {
+	{ SpecialType::Floor,
+	  GenFloorBase,
+	  7,
+	  { { TriggerType, TriggerTypeShift },
+		{ FloorSpeed, FloorSpeedShift },
+		{ FloorModel, FloorModelShift },
+		{ FloorDirection, FloorDirectionShift },
+		{ FloorTarget, FloorTargetShift },
+		{ FloorChange, FloorChangeShift },
+		{ FloorCrush, FloorCrushShift } } },
+	{ SpecialType::Ceiling,
+	  GenCeilingBase,
+	  7,
+	  { { TriggerType, TriggerTypeShift },
+		{ CeilingSpeed, CeilingSpeedShift },
+		{ CeilingModel, CeilingModelShift },
+		{ CeilingDirection, CeilingDirectionShift },
+		{ CeilingTarget, CeilingTargetShift },
+		{ CeilingChange, CeilingChangeShift },
+		{ CeilingCrush, CeilingCrushShift } } },
+	{ SpecialType::Door,
+	  GenDoorBase,
+	  5,
+	  { { TriggerType, TriggerTypeShift },
+		{ DoorSpeed, DoorSpeedShift },
+		{ DoorKind, DoorKindShift },
+		{ DoorMonster, DoorMonsterShift },
+		{ DoorDelay, DoorDelayShift } } },
+	{ SpecialType::LockedDoor,
+	  GenLockedBase,
+	  5,
+	  { { TriggerType, TriggerTypeShift },
+		{ LockedSpeed, LockedSpeedShift },
+		{ LockedKind, LockedKindShift },
+		{ LockedKey, LockedKeyShift },
+		{ LockedNKeys, LockedNKeysShift } } },
+	{ SpecialType::Lift,
+	  GenLiftBase,
+	  5,
+	  { { TriggerType, TriggerTypeShift },
+		{ LiftSpeed, LiftSpeedShift },
+		{ LiftMonster, LiftMonsterShift },
+		{ LiftDelay, LiftDelayShift },
+		{ LiftTarget, LiftTargetShift } } },
+	{ SpecialType::Stairs,
+	  GenStairsBase,
+	  6,
+	  { { TriggerType, TriggerTypeShift },
+		{ StairSpeed, StairSpeedShift },
+		{ StairMonster, StairMonsterShift },
+		{ StairStep, StairStepShift },
+		{ StairDirection, StairDirectionShift },
+		{ StairIgnore, StairIgnoreShift } } },
+	{ SpecialType::Crusher,
+	  GenCrusherBase,
+	  4,
+	  { { TriggerType, TriggerTypeShift },
+		{ CrusherSpeed, CrusherSpeedShift },
+		{ CrusherMonster, CrusherMonsterShift },
+		{ CrusherSilent, CrusherSilentShift } } },
+};
+
+// All generalised special bases are multiples of 0x80, so the type of any
+// special can be found from its value >> 7. Values of 0x8000 and above are
+// treated as floor specials, as before
+constexpr int BlockShift = 7;
+constexpr int NumBlocks  = 0x8000 >> BlockShift;
+
+// -----------------------------------------------------------------------------
+// Builds the table of Layouts indices (or -1 for none) by special >> 7
+// -----------------------------------------------------------------------------
+constexpr std::array<int8_t, NumBlocks> buildLayoutTable()
+{
+	std::array<int8_t, NumBlocks> table{};
+	for (int block = 0; block < NumBlocks; ++block)
 	{
-		int trigger   = type & TriggerType;
-		int speed     = (type & FloorSpeed) >> FloorSpeedShift;
-		int direction = (type & FloorDirection) >> FloorDirectionShift;
-		int target    = (type & FloorTarget) >> FloorTargetShift;
-		int change    = (type & FloorChange) >> FloorChangeShift;
-		int model     = (type & FloorModel) >> FloorModelShift;
-
-		// Trigger
-		type_string += Triggers[trigger];
-		if (change == 0 && model == 1)
-			type_string += "M";
+		table[block] = -1;
+		for (int l = 0; l < static_cast<int>(std::size(Layouts)); ++l)
+			if ((block << BlockShift) >= Layouts[l].base)
+			{
+				table[block] = static_cast<int8_t>(l);
+				break;
+			}
+	}
+	return table;
+}
 
-		type_string += " Floor ";
+constexpr auto LayoutTable = buildLayoutTable();
 
-		// Direction, target, speed
-		type_string += fmt::format("{} {} {}", Directions[direction], FloorTargets[target], Speeds[speed]);
+// -----------------------------------------------------------------------------
+// Returns the layout of generalised special [type], or null if it isn't one
+// -----------------------------------------------------------------------------
+const TypeLayout* layoutForType(int type)
+{
+	if (type < GenCrusherBase)
+		return nullptr;
 
-		// Change
-		if (type & FloorChange)
-			type_string += fmt::format(" {} ({})", Changers[change], Models[model]);
+	auto index = LayoutTable[std::min(type >> BlockShift, NumBlocks - 1)];
+	return index < 0 ? nullptr : &Layouts[index];
+}
 
-		// Crush
-		if (type & FloorCrush)
-			type_string += " Crushing";
-	}
+// -----------------------------------------------------------------------------
+// Returns the layout of generalised special type [type], or null if invalid
+// -----------------------------------------------------------------------------
+const TypeLayout* layoutForSpecialType(SpecialType type)
+{
+	for (const auto& layout : Layouts)
+		if (layout.type == type)
+			return &layout;
+
+	return nullptr;
+}
+} // namespace
+
+// ------------------------------------------------------------------------
+// Returns a string representation of the generalised line value [type]
+// ------------------------------------------------------------------------
+string parseLineType(int type)
+{
+	int  props[7];
+	auto special_type = getLineTypeProperties(type, props);
+	if (special_type == SpecialType::None)
+		return {};
+
+	// Trigger
+	string type_string = Triggers[props[0]];
 
-	// Ceiling type
-	else if (type >= 0x4000)
+	switch (special_type)
 	{
-		int trigger   = type & TriggerType;
-		int speed     = (type & CeilingSpeed) >> CeilingSpeedShift;
-		int direction = (type & CeilingDirection) >> CeilingDirectionShift;
-		int target    = (type & CeilingTarget) >> CeilingTargetShift;
-		int change    = (type & CeilingChange) >> CeilingChangeShift;
-		int model     = (type & CeilingModel) >> CeilingModelShift;
-
-		// Trigger
-		type_string += Triggers[trigger];
+	// Floor/Ceiling type
+	case SpecialType::Floor:
+	case SpecialType::Ceiling:
+	{
+		bool floor     = special_type == SpecialType::Floor;
+		int  speed     = props[1];
+		int  model     = props[2];
+		int  direction = props[3];
+		int  target    = props[4];
+		int  change    = props[5];
+
 		if (change == 0 && model == 1)
 			type_string += "M";
 
-		type_string += " Ceiling ";
+		type_string += floor ? " Floor " : " Ceiling ";
 
 		// Direction, target, speed
-		type_string += fmt::format("{} {} {}", Directions[direction], CeilingTargets[target], Speeds[speed]);
+		type_string += fmt::format(
+			"{} {} {}", Directions[direction], floor ? FloorTargets[target] : CeilingTargets[target], Speeds[speed]);
 
 		// Change
-		if (type & CeilingChange)
+		if (change)
 			type_string += fmt::format(" {} ({})", Changers[change], Models[model]);
 
 		// Crush
-		if (type & CeilingCrush)
+		if (props[6])
 			type_string += " Crushing";
+
+		break;
 	}
 
 	// Door type
-	else if (type >= 0x3c00)
+	case SpecialType::Door:
 	{
-		int trigger = type & TriggerType;
-		int kind    = (type & DoorKind) >> DoorKindShift;
-		int delay   = (type & DoorDelay) >> DoorDelayShift;
-		int speed   = (type & DoorSpeed) >> DoorSpeedShift;
-
-		// Trigger
-		type_string += Triggers[trigger];
-		if (type & DoorMonster)
+		int speed = props[1];
+		int kind  = props[2];
+		int delay = props[4];
+
+		if (props[3])
 			type_string += "M";
 
 		type_string += " Door ";
@@ -329,19 +442,16 @@ string parseLineType(int type)
 
 		// Door speed
 		type_string += fmt::format(" {}", Speeds[speed]);
+		break;
 	}
 
 	// Locked Door type
-	else if (type >= 0x3800)
+	case SpecialType::LockedDoor:
 	{
-		int trigger = type & TriggerType;
-		int key     = (type & LockedKey) >> LockedKeyShift;
-		int num     = (type & LockedNKeys) >> LockedNKeysShift;
-		int kind    = (type & LockedKind) >> LockedKindShift;
-		int speed   = (type & DoorSpeed) >> DoorSpeedShift;
-
-		// Trigger
-		type_string += Triggers[trigger];
+		int speed = props[1];
+		int kind  = props[2];
+		int key   = props[3];
+		int num   = props[4];
 
 		type_string += " Door ";
 
@@ -353,78 +463,66 @@ string parseLineType(int type)
 		{
 		case 0: type_string += "Open Wait 4 Close"; break;
 		case 1: type_string += "Open Stay"; break;
-		case 2: type_string += "Close Wait 4 Open"; break;
-		case 3: type_string += "Close Stay"; break;
 		default: break;
 		}
 
 		// Door speed
 		type_string += fmt::format(" {}", Speeds[speed]);
+		break;
 	}
 
 	// Lift type
-	else if (type >= 0x3400)
+	case SpecialType::Lift:
 	{
-		int trigger = type & TriggerType;
-		int target  = (type & LiftTarget) >> LiftTargetShift;
-		int delay   = (type & LiftDelay) >> LiftDelayShift;
-		int speed   = (type & LiftSpeed) >> LiftSpeedShift;
-
-		// Trigger
-		type_string += Triggers[trigger];
-		if (type & LiftMonster)
-			type_string += "M";
-
-		type_string += " Lift ";
+		int speed  = props[1];
+		int delay  = props[3];
+		int target = props[4];
 
-		// Target
-		type_string += LiftTargets[target];
-
-		// Delay
-		type_string += fmt::format(" Delay {} ", LiftDelays[delay]);
+		if (props[2])
+			type_string += "M";
 
-		// Speed
-		type_string += Speeds[speed];
+		// Target, delay, speed
+		type_string += fmt::format(" Lift {} Delay {} {}", LiftTargets[target], LiftDelays[delay], Speeds[speed]);
+		break;
 	}
 
 	// Stairs type
-	else if (type >= 0x3000)
+	case SpecialType::Stairs:
 	{
-		int trigger   = type & TriggerType;
-		int direction = (type & StairDirection) >> StairDirectionShift;
-		int step      = (type & StairStep) >> StairStepShift;
-		int speed     = (type & StairSpeed) >> StairSpeedShift;
-
-		// Trigger
-		type_string += Triggers[trigger];
-		if (type & StairMonster)
+		int speed     = props[1];
+		int step      = props[3];
+		int direction = props[4];
+
+		if (props[2])
 			type_string += "M";
 
 		// Direction, step height, speed
 		type_string += fmt::format(" Stairs {} {} {}", Directions[direction], Steps[step], Speeds[speed]);
 
 		// Ignore
-		if (type & StairIgnore)
+		if (props[5])
 			type_string += " Ignore Tex";
+
+		break;
 	}
 
 	// Crusher type
-	else if (type >= 0x2F80)
+	case SpecialType::Crusher:
 	{
-		int trigger = type & TriggerType;
-		int speed   = (type & CrusherSpeed) >> CrusherSpeedShift;
-
-		// Trigger
-		type_string += Triggers[trigger];
-		if (type & CrusherMonster)
+		if (props[2])
 			type_string += "M";
 
 		// Speed
-		type_string += fmt::format(" Crusher {}", Speeds[speed]);
+		type_string += fmt::format(" Crusher {}", Speeds[props[1]]);
 
 		// Silent
-		if (type & CrusherSilent)
+		if (props[3])
 			type_string += " Silent";
+
+		break;
+	}
+
+	default: break;
 	}
 
 	return type_string;
@@ -441,88 +539,14 @@ SpecialType getLineTypeProperties(int type, int* props)
 	// Trigger always first
 	props[0] = type & TriggerType;
 
-	// Floor
-	if (type >= 0x6000)
-	{
-		props[1] = (type & FloorSpeed) >> FloorSpeedShift;
-		props[2] = (type & FloorModel) >> FloorModelShift;
-		props[3] = (type & FloorDirection) >> FloorDirectionShift;
-		props[4] = (type & FloorTarget) >> FloorTargetShift;
-		props[5] = (type & FloorChange) >> FloorChangeShift;
-		props[6] = (type & FloorCrush) >> FloorCrushShift;
-
-		return SpecialType::Floor;
-	}
-
-	// Ceiling
-	else if (type >= 0x4000)
-	{
-		props[1] = (type & CeilingSpeed) >> CeilingSpeedShift;
-		props[2] = (type & CeilingModel) >> CeilingModelShift;
-		props[3] = (type & CeilingDirection) >> CeilingDirectionShift;
-		props[4] = (type & CeilingTarget) >> CeilingTargetShift;
-		props[5] = (type & CeilingChange) >> CeilingChangeShift;
-		props[6] = (type & CeilingCrush) >> CeilingCrushShift;
-
-		return SpecialType::Ceiling;
-	}
-
-	// Door
-	else if (type >= 0x3c00)
-	{
-		props[1] = (type & DoorSpeed) >> DoorSpeedShift;
-		props[2] = (type & DoorKind) >> DoorKindShift;
-		props[3] = (type & DoorMonster) >> DoorMonsterShift;
-		props[4] = (type & DoorDelay) >> DoorDelayShift;
-
-		return SpecialType::Door;
-	}
-
-	// Locked Door
-	else if (type >= 0x3800)
-	{
-		props[1] = (type & LockedSpeed) >> LockedSpeedShift;
-		props[2] = (type & LockedKind) >> LockedKindShift;
-		props[3] = (type & LockedKey) >> LockedKeyShift;
-		props[4] = (type & LockedNKeys) >> LockedNKeysShift;
-
-		return SpecialType::LockedDoor;
-	}
-
-	// Lift
-	else if (type >= 0x3400)
-	{
-		props[1] = (type & LiftSpeed) >> LiftSpeedShift;
-		props[2] = (type & LiftMonster) >> LiftMonsterShift;
-		props[3] = (type & LiftDelay) >> LiftDelayShift;
-		props[4] = (type & LiftTarget) >> LiftTargetShift;
-
-		return SpecialType::Lift;
-	}
-
-	// Stairs
-	else if (type >= 0x3000)
-	{
-		props[1] = (type & StairSpeed) >> StairSpeedShift;
-		props[2] = (type & StairMonster) >> StairMonsterShift;
-		props[3] = (type & StairStep) >> StairStepShift;
-		props[4] = (type & StairDirection) >> StairDirectionShift;
-		props[5] = (type & StairIgnore) >> StairIgnoreShift;
-
-		return SpecialType::Stairs;
-	}
+	auto* layout = layoutForType(type);
+	if (!layout)
+		return SpecialType::None;
 
-	// Crusher
-	else if (type >= 0x2F80)
-	{
-		props[1] = (type & CrusherSpeed) >> CrusherSpeedShift;
-		props[2] = (type & CrusherMonster) >> CrusherMonsterShift;
-		props[3] = (type & CrusherSilent) >> CrusherSilentShift;
+	for (unsigned a = 1; a < layout->n_props; ++a)
+		props[a] = (type & layout->fields[a].mask) >> layout->fields[a].shift;
 
-		return SpecialType::Crusher;
-	}
-
-	return SpecialType::None;
+	return layout->type;
 }
 
 // ------------------------------------------------------------------------
@@ -531,88 +555,13 @@ SpecialType getLineTypeProperties(int type, int* props)
 // ------------------------------------------------------------------------
 int generateSpecial(SpecialType type, const int* props)
 {
-	int special = 0;
+	auto* layout = layoutForSpecialType(type);
+	if (!layout)
+		return 0;
 
-	// Floor
-	if (type == SpecialType::Floor)
-	{
-		special = GenFloorBase;
-		special += (props[0] << TriggerTypeShift);
-		special += (props[1] << FloorSpeedShift);
-		special += (props[2] << FloorModelShift);
-		special += (props[3] << FloorDirectionShift);
-		special += (props[4] << FloorTargetShift);
-		special += (props[5] << FloorChangeShift);
-		special += (props[6] << FloorCrushShift);
-	}
-
-	// Ceiling
-	else if (type == SpecialType::Ceiling)
-	{
-		special = GenCeilingBase;
-		special += (props[0] << TriggerTypeShift);
-		special += (props[1] << CeilingSpeedShift);
-		special += (props[2] << CeilingModelShift);
-		special += (props[3] << CeilingDirectionShift);
-		special += (props[4] << CeilingTargetShift);
-		special += (props[5] << CeilingChangeShift);
-		special += (props[6] << CeilingCrushShift);
-	}
-
-	// Door
-	else if (type == SpecialType::Door)
-	{
-		special = GenDoorBase;
-		special += (props[0] << TriggerTypeShift);
-		special += (props[1] << DoorSpeedShift);
-		special += (props[2] << DoorKindShift);
-		special += (props[3] << DoorMonsterShift);
-		special += (props[4] << DoorDelayShift);
-	}
-
-	// Locked Door
-	else if (type == SpecialType::LockedDoor)
-	{
-		special = GenLockedBase;
-		special += (props[0] << TriggerTypeShift);
-		special += (props[1] << LockedSpeedShift);
-		special += (props[2] << LockedKindShift);
-		special += (props[3] << LockedKeyShift);
-		special += (props[4] << LockedNKeysShift);
-	}
-
-	// Lift
-	else if (type == SpecialType::Lift)
-	{
-		special = GenLiftBase;
-		special += (props[0] << TriggerTypeShift);
-		special += (props[1] << LiftSpeedShift);
-		special += (props[2] << LiftMonsterShift);
-		special += (props[3] << LiftDelayShift);
-		special += (props[4] << LiftTargetShift);
-	}
-
-	// Stairs
-	else if (type == SpecialType::Stairs)
-	{
-		special = GenStairsBase;
-		special += (props[0] << TriggerTypeShift);
-		special += (props[1] << StairSpeedShift);
-		special += (props[2] << StairMonsterShift);
-		special += (props[3] << StairStepShift);
-		special += (props[4] << StairDirectionShift);
-		special += (props[5] << StairIgnoreShift);
-	}
-
-	// Crusher
-	else if (type == SpecialType::Crusher)
-	{
-		special = GenCrusherBase;
-		special += (props[0] << TriggerTypeShift);
-		special += (props[1] << CrusherSpeedShift);
-		special += (props[2] << CrusherMonsterShift);
-		special += (props[3] << CrusherSilentShift);
-	}
+	int special = layout->base;
+	for (unsigned a = 0; a < layout->n_props; ++a)
+		special += props[a] << layout->fields[a].shift;
 
 	return special;
 }
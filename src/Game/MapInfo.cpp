@@ -32,13 +32,59 @@
 #include "Main.h"
 #include "MapInfo.h"
 #include "Archive/Archive.h"
+#include "General/Misc.h"
 #include "UI/WxUtils.h"
 #include "Utility/StringUtils.h"
+#include <mutex>
 
 using namespace slade;
 using namespace game;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// The result of a MapInfo::readMapInfo call, and the entries it parsed
+struct CachedRead
+{
+	vector<std::pair<string, uint64_t>> entries; // Path + content hash of each entry parsed, root entry first
+	bool                                result    = false;
+	uint64_t                            state_key = 0; // MapInfo state key after reading
+	vector<MapInfo::Map>                maps;
+	MapInfo::Map                        default_map;
+	MapInfo::DoomEdNumMap               editor_nums;
+	bool                                used = true;
+};
+
+// Cached reads, by hash of the MapInfo state key before reading and the content
+// hash of the root MAPINFO entry
+std::map<uint64_t, CachedRead> read_cache;
+std::mutex                     read_cache_mutex; // The base zdoom.pk3 MAPINFO is read on a separate thread
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns a hash combining [key] and [hash]
+// -----------------------------------------------------------------------------
+uint64_t combineHash(uint64_t key, uint64_t hash)
+{
+	uint64_t values[2] = { key, hash };
+	return misc::hash64(reinterpret_cast<const uint8_t*>(values), sizeof(values));
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MapInfo Class Functions
@@ -58,7 +104,13 @@ void MapInfo::clear(bool maps, bool editor_nums)
 	}
 
 	if (editor_nums)
+	{
 		editor_nums_.clear();
+		class_editor_nums_.clear();
+	}
+
+	// Update state key so cached reads from before a partial clear aren't used
+	state_key_ = maps && editor_nums ? 0 : combineHash(state_key_, maps ? 1 : 2);
 }
 
 // -----------------------------------------------------------------------------
@@ -89,52 +141,98 @@ bool MapInfo::addOrUpdateMap(Map& map)
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the DoomEdNum definition for [number], adding it if needed
+// -----------------------------------------------------------------------------
+MapInfo::DoomEdNum& MapInfo::doomEdNum(int number)
+{
+	class_editor_nums_.clear();
+	return editor_nums_[number];
+}
+
 // -----------------------------------------------------------------------------
 // Returns the DoomEdNum for the ZScript/DECORATE class [actor_class]
 // -----------------------------------------------------------------------------
-int MapInfo::doomEdNumForClass(string_view actor_class)
+int MapInfo::doomEdNumForClass(string_view actor_class) const
 {
-	// Find DoomEdNum def with matching class
-	for (auto& i : editor_nums_)
-		if (strutil::equalCI(i.second.actor_class, actor_class))
-			return i.first;
+	// Build class lookup if needed (lowest number first, as before)
+	if (class_editor_nums_.empty())
+		for (auto& [number, def] : editor_nums_)
+			class_editor_nums_.try_emplace(strutil::lower(def.actor_class), number);
 
-	// Invalid
-	return -1;
+	auto i = class_editor_nums_.find(strutil::lower(actor_class));
+	return i != class_editor_nums_.end() ? i->second : -1;
 }
 
 // -----------------------------------------------------------------------------
-// Reads and parses all MAPINFO entries in [archive]
+// Reads and parses all MAPINFO entries in [archive].
+// Parsing results are cached by the content of the entries parsed (including
+// any includes) and the state of this MapInfo beforehand, so reading the same
+// unchanged archives again (eg. whenever custom definitions are updated) only
+// needs to restore the cached result
 // -----------------------------------------------------------------------------
 bool MapInfo::readMapInfo(const Archive& archive)
 {
-	for (const auto& entry : archive.rootDir()->entries())
-	{
-		// ZMapInfo
-		if (entry->type()->id() == "zmapinfo")
-			return parseZMapInfo(entry.get());
+	auto* entry = findMapInfoEntry(archive);
+	if (!entry)
+		return false;
 
-		// TODO: EMapInfo
-		if (entry->type()->id() == "emapinfo")
-			log::info("EMAPINFO parsing not yet implemented");
+	auto key = combineHash(state_key_, entry->contentHash());
 
-		// MapInfo
-		else if (entry->type()->id() == "mapinfo")
+	// Check for a cached result
+	{
+		std::lock_guard lock(read_cache_mutex);
+		auto            i = read_cache.find(key);
+		if (i != read_cache.end())
 		{
-			// Detect format
-			switch (detectMapInfoType(entry.get()))
+			// Check all included entries are unchanged
+			auto& cached = i->second;
+			bool  valid  = true;
+			for (unsigned a = 1; a < cached.entries.size() && valid; ++a)
 			{
-			case Format::Hexen:
-			case Format::ZDoomOld: log::info("MAPINFO (Hexen/Old ZDoom) parsing not yet implemented"); break;
-			case Format::ZDoomNew: return parseZMapInfo(entry.get());
-			case Format::Eternity: log::info("EMAPINFO parsing not yet implemented"); break;
-			case Format::Universal: log::info("UMAPINFO parsing not yet implemented"); break;
-			default: break;
+				auto* inc_entry = archive.entryAtPath(cached.entries[a].first);
+				valid           = inc_entry && inc_entry->contentHash() == cached.entries[a].second;
+			}
+
+			if (valid)
+			{
+				maps_        = cached.maps;
+				default_map_ = cached.default_map;
+				editor_nums_ = cached.editor_nums;
+				state_key_   = cached.state_key;
+				cached.used  = true;
+				class_editor_nums_.clear();
+				log::info(2, "Using cached MAPINFO parse results for {}", entry->name());
+				return cached.result;
 			}
 		}
 	}
 
-	return false;
+	// Parse
+	parsed_entries_.clear();
+	auto result = parseZMapInfo(entry);
+	class_editor_nums_.clear();
+
+	// Add to cache
+	CachedRead cached;
+	state_key_ = key;
+	for (auto* parsed : parsed_entries_)
+	{
+		cached.entries.emplace_back(parsed->path(true), parsed->contentHash());
+		if (parsed != entry)
+			state_key_ = combineHash(state_key_, cached.entries.back().second);
+	}
+	cached.result      = result;
+	cached.state_key   = state_key_;
+	cached.maps        = maps_;
+	cached.default_map = default_map_;
+	cached.editor_nums = editor_nums_;
+	parsed_entries_.clear();
+
+	std::lock_guard lock(read_cache_mutex);
+	read_cache[key] = std::move(cached);
+
+	return result;
 }
 
 // -----------------------------------------------------------------------------
@@ -186,6 +284,8 @@ bool MapInfo::strToCol(const string& str, ColRGBA& col) const
 // -----------------------------------------------------------------------------
 bool MapInfo::parseZMapInfo(ArchiveEntry* entry)
 {
+	parsed_entries_.push_back(entry);
+
 	Tokenizer tz;
 	tz.setReadLowerCase(true);
 	tz.openMem(entry->data(), entry->name());
@@ -453,6 +553,8 @@ bool MapInfo::parseZMap(Tokenizer& tz, string_view type)
 // -----------------------------------------------------------------------------
 bool MapInfo::parseDoomEdNums(Tokenizer& tz)
 {
+	class_editor_nums_.clear();
+
 	// Opening brace
 	if (!tz.advIfNext("{", 2))
 	{
@@ -527,6 +629,41 @@ bool MapInfo::parseDoomEdNums(Tokenizer& tz)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the first supported (ZMAPINFO-format) MAPINFO entry in the root
+// directory of [archive], or null if there is none
+// -----------------------------------------------------------------------------
+ArchiveEntry* MapInfo::findMapInfoEntry(const Archive& archive) const
+{
+	for (const auto& entry : archive.rootDir()->entries())
+	{
+		// ZMapInfo
+		if (entry->type()->id() == "zmapinfo")
+			return entry.get();
+
+		// TODO: EMapInfo
+		if (entry->type()->id() == "emapinfo")
+			log::info("EMAPINFO parsing not yet implemented");
+
+		// MapInfo
+		else if (entry->type()->id() == "mapinfo")
+		{
+			// Detect format
+			switch (detectMapInfoType(entry.get()))
+			{
+			case Format::Hexen:
+			case Format::ZDoomOld: log::info("MAPINFO (Hexen/Old ZDoom) parsing not yet implemented"); break;
+			case Format::ZDoomNew: return entry.get();
+			case Format::Eternity: log::info("EMAPINFO parsing not yet implemented"); break;
+			case Format::Universal: log::info("UMAPINFO parsing not yet implemented"); break;
+			default: break;
+			}
+		}
+	}
+
+	return nullptr;
+}
+
 // -----------------------------------------------------------------------------
 // Attempts to detect the port-specific MAPINFO format of [entry]
 // -----------------------------------------------------------------------------
@@ -592,6 +729,34 @@ void MapInfo::dumpDoomEdNums()
 
 
 
+// -----------------------------------------------------------------------------
+//
+// Game Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Removes cached MAPINFO parse results that weren't used since the last call
+// (ie. from archives that were closed or modified)
+// -----------------------------------------------------------------------------
+void game::pruneMapInfoCache()
+{
+	std::lock_guard lock(read_cache_mutex);
+	for (auto i = read_cache.begin(); i != read_cache.end();)
+	{
+		if (!i->second.used)
+			i = read_cache.erase(i);
+		else
+		{
+			i->second.used = false;
+			++i;
+		}
+	}
+}
+
+
+
 // TEMP TESTING STUFF
 #include "General/Console.h"
 #include "MainEditor/MainEditor.h"
@@ -69,8 +69,8 @@ namespace game
 
 		// DoomEdNum access
 		const DoomEdNumMap& doomEdNums() const { return editor_nums_; }
-		DoomEdNum&          doomEdNum(int number) { return editor_nums_[number]; }
-		int                 doomEdNumForClass(string_view actor_class);
+		DoomEdNum&          doomEdNum(int number);
+		int                 doomEdNumForClass(string_view actor_class) const;
 
 		// MAPINFO loading
 		bool readMapInfo(const Archive& archive);
@@ -94,6 +94,18 @@ namespace game
 		vector<Map>  maps_;
 		Map          default_map_;
 		DoomEdNumMap editor_nums_;
+
+		// Identifies the sequence of MAPINFO entries (by content) read since
+		// the last clear, so cached results can be reused (see readMapInfo)
+		uint64_t              state_key_ = 0;
+		vector<ArchiveEntry*> parsed_entries_; // Entries parsed by the current readMapInfo call
+
+		// Lowercase actor class -> DoomEdNum, built on first use
+		mutable std::map<string, int> class_editor_nums_;
+
+		ArchiveEntry* findMapInfoEntry(const Archive& archive) const;
 	};
+
+	void pruneMapInfoCache();
 } // namespace game
 } // namespace slade
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Archive/ArchiveEntry.h"
+#include "General/Tasks.h"
+
+namespace slade
+{
+namespace game
+{
+	// Caches the results of parsing definition entries (DECORATE, ZScript etc.)
+	// by entry content, so unchanged entries don't need to be parsed again, and
+	// parses entries that aren't cached in parallel.
+	//
+	// T is the result of parsing a single entry. It must have an 'includes'
+	// vector of items with a 'path' string, listing the entries it #includes
+	// (relative to the entry) so they can be parsed along with it.
+	// The parse function is called on worker threads, so it must only use the
+	// data and name it is given
+	template<typename T> class ParsedEntryCache
+	{
+	public:
+		using ParseFunc = std::function<void(const MemChunk& data, string_view name, T& result)>;
+
+		explicit ParsedEntryCache(ParseFunc parse) : parse_{ std::move(parse) } {}
+
+		// Returns the parsed result for [entry], or null if it hasn't been parsed
+		const T* get(ArchiveEntry* entry) const
+		{
+			auto i = items_.find(entry->contentHash());
+			return i != items_.end() ? i->second.result.get() : nullptr;
+		}
+
+		// Parses all [entries] and the entries they #include (recursively),
+		// except those already in the cache
+		void parse(const vector<ArchiveEntry*>& entries)
+		{
+			std::set<ArchiveEntry*> queued;
+			vector<ArchiveEntry*>   pending;
+			for (auto* entry : entries)
+				if (queued.insert(entry).second)
+					pending.push_back(entry);
+
+			// Parse in 'waves', since #includes aren't known until their
+			// parent entries are parsed
+			while (!pending.empty())
+			{
+				parseUncached(pending);
+
+				vector<ArchiveEntry*> included;
+				for (auto* entry : pending)
+					if (auto* result = get(entry))
+						for (const auto& include : result->includes)
+						{
+							auto* inc_entry = entry->relativeEntry(include.path);
+							if (inc_entry && queued.insert(inc_entry).second)
+								included.push_back(inc_entry);
+						}
+				pending.swap(included);
+			}
+		}
+
+		// Removes results that weren't used (parsed or found in the cache)
+		// since the last call
+		void pruneUnused()
+		{
+			for (auto i = items_.begin(); i != items_.end();)
+			{
+				if (!i->second.used)
+					i = items_.erase(i);
+				else
+				{
+					i->second.used = false;
+					++i;
+				}
+			}
+		}
+
+		void clear() { items_.clear(); }
+
+	private:
+		struct Item
+		{
+			unique_ptr<T> result;
+			bool          used = true;
+		};
+
+		ParseFunc                parse_;
+		std::map<uint64_t, Item> items_;
+
+		// Parses all [entries] that aren't already cached, spread over the task
+		// worker threads
+		void parseUncached(const vector<ArchiveEntry*>& entries)
+		{
+			struct Job
+			{
+				uint64_t      key;
+				MemChunk      data; // Shared with the entry (see MemChunk::share)
+				string        name;
+				unique_ptr<T> result;
+			};
+
+			// Get entries to parse (each unique content only once)
+			vector<Job> jobs;
+			for (auto* entry : entries)
+			{
+				auto key  = entry->contentHash();
+				auto item = items_.find(key);
+				if (item != items_.end())
+				{
+					item->second.used = true;
+					continue;
+				}
+
+				items_[key] = {};
+				auto& job   = jobs.emplace_back();
+				job.key     = key;
+				job.name    = entry->name();
+				job.result  = std::make_unique<T>();
+				job.data.share(entry->data());
+			}
+			if (jobs.empty())
+				return;
+
+			// Parse
+			tasks::parallelFor(
+				0, jobs.size(), [&](unsigned a) { parse_(jobs[a].data, jobs[a].name, *jobs[a].result); });
+
+			for (auto& job : jobs)
+				items_[job.key].result = std::move(job.result);
+		}
+	};
+} // namespace game
+} // namespace slade
@@ -34,6 +34,7 @@
 #include "App.h"
 #include "Archive/Archive.h"
 #include "Archive/ArchiveManager.h"
+#include "ParsedEntryCache.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
 
@@ -184,49 +185,45 @@ bool checkKeywordValueStatement(const vector<string>& tokens, unsigned index, st
 	return false;
 }
 
+// The statements/blocks parsed from a single ZScript entry, and the entries it
+// #includes (see addParsedBlocks)
+struct ParsedEntry
+{
+	struct Include
+	{
+		string   path;
+		unsigned line;
+		unsigned index; // Index of the statement the #include is before
+	};
+
+	vector<ParsedStatement> statements;
+	vector<Include>         includes;
+};
+
 // -----------------------------------------------------------------------------
-// Parses all statements/blocks in [entry], adding them to [parsed]
+// Parses all statements/blocks in ZScript [data] into [result].
+// Entries aren't accessed here (statement entries are set by addParsedBlocks),
+// so this can be called on a worker thread
 // -----------------------------------------------------------------------------
-void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed, vector<ArchiveEntry*>& entry_stack)
+void parseEntryStatements(const MemChunk& data, string_view name, ParsedEntry& result)
 {
 	Tokenizer tz;
 	tz.setSpecialCharacters(Tokenizer::DEFAULT_SPECIAL_CHARACTERS + "()+-[]&!?.<>");
 	tz.enableDecorate(true);
 	tz.setCommentTypes(Tokenizer::CommentTypes::CPPStyle | Tokenizer::CommentTypes::CStyle);
-	tz.openMem(entry->data(), "ZScript");
-
-	entry_stack.push_back(entry);
+	tz.enableZeroCopy(true);
+	tz.openMem(data, name);
 
 	while (!tz.atEnd())
 	{
 		// Preprocessor
-		if (strutil::startsWith(tz.current().text, '#'))
+		if (strutil::startsWith(tz.current().view(), '#'))
 		{
 			if (tz.checkNC("#include"))
 			{
-				auto inc_entry = entry->relativeEntry(tz.next().text);
-
-				// Check #include path could be resolved
-				if (!inc_entry)
-				{
-					log::warning(
-						"Warning parsing ZScript entry {}: "
-						"Unable to find #included entry \"{}\" at line {}, skipping",
-						entry->name(),
-						tz.current().text,
-						tz.current().line_no);
-				}
-				else if (VECTOR_EXISTS(entry_stack, inc_entry))
-				{
-					log::warning(
-						"Warning parsing ZScript entry {}: "
-						"Detected circular #include \"{}\" on line {}, skipping",
-						entry->name(),
-						tz.current().text,
-						tz.current().line_no);
-				}
-				else
-					parseBlocks(inc_entry, parsed, entry_stack);
+				const auto& path = tz.next();
+				result.includes.push_back(
+					{ string{ path.view() }, path.line_no, static_cast<unsigned>(result.statements.size()) });
 			}
 
 			tz.advToNextLine();
@@ -241,10 +238,74 @@ void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed, vector<Ar
 		}
 
 		// ZScript
-		parsed.push_back({});
-		parsed.back().entry = entry;
-		if (!parsed.back().parse(tz))
-			parsed.pop_back();
+		result.statements.push_back({});
+		if (!result.statements.back().parse(tz))
+			result.statements.pop_back();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Sets the entry of [statement] and all statements in its block to [entry]
+// -----------------------------------------------------------------------------
+void setStatementEntry(ParsedStatement& statement, ArchiveEntry* entry)
+{
+	statement.entry = entry;
+	for (auto& child : statement.block)
+		setStatementEntry(child, entry);
+}
+
+// -----------------------------------------------------------------------------
+// Adds all statements/blocks parsed from [entry] in [cache] to [parsed],
+// including those from any #included entries
+// -----------------------------------------------------------------------------
+void addParsedBlocks(
+	ArchiveEntry*                              entry,
+	const game::ParsedEntryCache<ParsedEntry>& cache,
+	vector<ParsedStatement>&                   parsed,
+	vector<ArchiveEntry*>&                     entry_stack)
+{
+	auto* result = cache.get(entry);
+	if (!result)
+		return;
+
+	entry_stack.push_back(entry);
+
+	auto include = result->includes.begin();
+	for (unsigned a = 0; a <= result->statements.size(); ++a)
+	{
+		// #includes before this statement
+		for (; include != result->includes.end() && include->index == a; ++include)
+		{
+			auto inc_entry = entry->relativeEntry(include->path);
+
+			// Check #include path could be resolved
+			if (!inc_entry)
+			{
+				log::warning(
+					"Warning parsing ZScript entry {}: "
+					"Unable to find #included entry \"{}\" at line {}, skipping",
+					entry->name(),
+					include->path,
+					include->line);
+			}
+			else if (VECTOR_EXISTS(entry_stack, inc_entry))
+			{
+				log::warning(
+					"Warning parsing ZScript entry {}: "
+					"Detected circular #include \"{}\" on line {}, skipping",
+					entry->name(),
+					include->path,
+					include->line);
+			}
+			else
+				addParsedBlocks(inc_entry, cache, parsed, entry_stack);
+		}
+
+		if (a < result->statements.size())
+		{
+			parsed.push_back(result->statements[a]);
+			setStatementEntry(parsed.back(), entry);
+		}
 	}
 
 	// Set entry type
@@ -254,6 +315,15 @@ void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed, vector<Ar
 	entry_stack.pop_back();
 }
 
+// -----------------------------------------------------------------------------
+// Returns the cache of parsed ZScript entries in resource archives
+// -----------------------------------------------------------------------------
+game::ParsedEntryCache<ParsedEntry>& parseCache()
+{
+	static game::ParsedEntryCache<ParsedEntry> cache{ parseEntryStatements };
+	return cache;
+}
+
 // -----------------------------------------------------------------------------
 // Returns true if [word] is a ZScript keyword
 // -----------------------------------------------------------------------------
@@ -967,12 +1037,23 @@ void Definitions::clear()
 bool Definitions::parseZScript(ArchiveEntry* entry)
 {
 	// Parse into tree of expressions and blocks
-	auto                    start = app::runTimer();
-	vector<ParsedStatement> parsed;
-	vector<ArchiveEntry*>   entry_stack;
-	parseBlocks(entry, parsed, entry_stack);
+	auto                                start = app::runTimer();
+	game::ParsedEntryCache<ParsedEntry> cache{ parseEntryStatements };
+	vector<ParsedStatement>             parsed;
+	vector<ArchiveEntry*>               entry_stack;
+	cache.parse({ entry });
+	addParsedBlocks(entry, cache, parsed, entry_stack);
 	log::debug(2, "parseBlocks: {}ms", app::runTimer() - start);
-	start = app::runTimer();
+
+	return parseStatements(parsed);
+}
+
+// -----------------------------------------------------------------------------
+// Reads classes, structs and enums from [parsed] statements
+// -----------------------------------------------------------------------------
+bool Definitions::parseStatements(vector<ParsedStatement>& parsed)
+{
+	auto start = app::runTimer();
 
 	for (auto& block : parsed)
 	{
@@ -1055,11 +1136,18 @@ bool Definitions::parseZScript(Archive* archive)
 	if (etype_zscript == EntryType::unknownType())
 		etype_zscript = nullptr;
 
-	// Parse ZScript entries
+	// Parse ZScript entries (and their #includes), reusing the results for any
+	// unchanged entries parsed previously
+	parseCache().parse(zscript_enries);
 	bool ok = true;
 	for (auto entry : zscript_enries)
-		if (!parseZScript(entry))
+	{
+		vector<ParsedStatement> parsed;
+		vector<ArchiveEntry*>   entry_stack;
+		addParsedBlocks(entry, parseCache(), parsed, entry_stack);
+		if (!parseStatements(parsed))
 			ok = false;
+	}
 
 	return ok;
 }
@@ -1075,6 +1163,23 @@ void Definitions::exportThingTypes(std::map<int, game::ThingType>& types, vector
 }
 
 
+// -----------------------------------------------------------------------------
+//
+// ZScript Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Removes cached parsed entries that weren't used since the last call (ie.
+// entries in archives that were closed or modified)
+// -----------------------------------------------------------------------------
+void zscript::pruneParseCache()
+{
+	parseCache().pruneUnused();
+}
+
+
 // -----------------------------------------------------------------------------
 //
 // ParsedStatement Struct Functions
@@ -1118,9 +1223,9 @@ bool ParsedStatement::parse(Tokenizer& tz)
 			return true;
 
 		// DB comment
-		if (strutil::startsWith(tz.current().text, db_comment))
+		if (strutil::startsWith(tz.current().view(), db_comment))
 		{
-			tokens.emplace_back(tz.current().text);
+			tokens.emplace_back(tz.current().view());
 			tokens.emplace_back(tz.getLine());
 			return true;
 		}
@@ -1160,7 +1265,7 @@ bool ParsedStatement::parse(Tokenizer& tz)
 			continue;
 		}
 
-		tokens.emplace_back(tz.current().text);
+		tokens.emplace_back(tz.current().view());
 		tz.adv();
 	}
 
@@ -1263,7 +1368,9 @@ CONSOLE_COMMAND(test_parseblocks, 1, false)
 	vector<ArchiveEntry*>   entry_stack;
 	for (auto a = 0; a < num; ++a)
 	{
-		parseBlocks(entry, parsed, entry_stack);
+		game::ParsedEntryCache<ParsedEntry> cache{ parseEntryStatements };
+		cache.parse({ entry });
+		addParsedBlocks(entry, cache, parsed, entry_stack);
 		parsed.clear();
 	}
 	log::console(fmt::format("Took {}ms", app::runTimer() - start));
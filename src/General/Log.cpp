@@ -32,8 +32,11 @@
 #include "Main.h"
 #include "App.h"
 #include <fmt/chrono.h>
+#include <condition_variable>
 #include <fmt/format.h>
 #include <fstream>
+#include <mutex>
+#include <thread>
 
 using namespace slade;
 
@@ -48,6 +51,60 @@ namespace slade::log
 vector<Message> log;
 std::ofstream   log_file;
 } // namespace slade::log
+namespace
+{
+// Logged messages are queued (from any thread), and added to the log next time
+// it is accessed from the main thread
+std::mutex           queued_mutex;
+vector<log::Message> queued_messages;
+
+// Consecutive repeats of the same message are counted rather than logged
+string           last_message;
+log::MessageType last_type    = log::MessageType::Any;
+unsigned         repeat_count = 0;
+
+// Writes messages to the log file on a background thread, so that logging
+// doesn't have to wait for file I/O
+class LogFileWriter
+{
+public:
+	~LogFileWriter() { stop(); }
+
+	void start();
+	void stop();
+	void queue(const log::Message& message);
+
+private:
+	std::thread             thread_;
+	std::mutex              mutex_;
+	std::condition_variable cv_;
+	vector<log::Message>    queue_;
+	bool                    stop_ = false;
+};
+LogFileWriter file_writer;
+
+// Stream buffer for sf::err that logs each line written to it as an error
+class SFMLErrorBuffer : public std::streambuf
+{
+protected:
+	int overflow(int c) override
+	{
+		if (c == '\n')
+		{
+			log::error(line_);
+			line_.clear();
+		}
+		else if (c != traits_type::eof())
+			line_ += static_cast<char>(c);
+
+		return c;
+	}
+
+private:
+	string line_;
+};
+SFMLErrorBuffer sfml_error_buffer;
+} // namespace
 CVAR(Int, log_verbosity, 1, CVar::Flag::Save)
 
 
@@ -113,6 +170,143 @@ string log::Message::formattedMessageLine() const
 }
 
 
+// -----------------------------------------------------------------------------
+//
+// LogFileWriter Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Starts the writer thread, which writes queued messages to the log file in
+// batches until stopped
+// -----------------------------------------------------------------------------
+void LogFileWriter::start()
+{
+	if (thread_.joinable() || !log::log_file.is_open())
+		return;
+
+	thread_ = std::thread(
+		[this]()
+		{
+			while (true)
+			{
+				vector<log::Message> messages;
+				{
+					std::unique_lock lock(mutex_);
+					cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+					if (queue_.empty())
+						return;
+					messages.swap(queue_);
+				}
+
+				for (const auto& message : messages)
+					log::log_file << message.formattedMessageLine() << "\n";
+				log::log_file.flush();
+			}
+		});
+}
+
+// -----------------------------------------------------------------------------
+// Stops the writer thread once all queued messages have been written
+// -----------------------------------------------------------------------------
+void LogFileWriter::stop()
+{
+	if (!thread_.joinable())
+		return;
+
+	{
+		std::lock_guard lock(mutex_);
+		stop_ = true;
+	}
+	cv_.notify_one();
+	thread_.join();
+}
+
+// -----------------------------------------------------------------------------
+// Queues [message] to be written to the log file (if open)
+// -----------------------------------------------------------------------------
+void LogFileWriter::queue(const log::Message& message)
+{
+	if (!thread_.joinable() || message.type == log::MessageType::Console)
+		return;
+
+	{
+		std::lock_guard lock(mutex_);
+		queue_.push_back(message);
+	}
+	cv_.notify_one();
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Queues [message], to be added to the log and written to the log file.
+// [queued_mutex] must be locked
+// -----------------------------------------------------------------------------
+void queueMessage(log::Message message)
+{
+	file_writer.queue(message);
+	queued_messages.push_back(std::move(message));
+}
+
+// -----------------------------------------------------------------------------
+// Queues a message with the number of times the last message was repeated, if
+// it was. [queued_mutex] must be locked
+// -----------------------------------------------------------------------------
+void queueRepeatCount()
+{
+	if (repeat_count == 0)
+		return;
+
+	auto text = fmt::format("(Previous message repeated {} more time{})", repeat_count, repeat_count > 1 ? "s" : "");
+	queueMessage({ text, last_type, fmt::localtime(std::time(nullptr)) });
+	repeat_count = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Adds any queued messages to the log.
+// Must only be called from the main thread
+// -----------------------------------------------------------------------------
+void addQueuedMessages()
+{
+	std::lock_guard lock(queued_mutex);
+	queueRepeatCount();
+	for (auto& message : queued_messages)
+		log::log.push_back(std::move(message));
+	queued_messages.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Queues a message [text] of [type] to be added to the log. If it is the same
+// as the previous message it is only counted (except for console and script
+// output), and the count is logged after the repeats end
+// -----------------------------------------------------------------------------
+void addMessage(log::MessageType type, string_view text)
+{
+	std::lock_guard lock(queued_mutex);
+
+	if (type == last_type && text == last_message && type != log::MessageType::Console
+		&& type != log::MessageType::Script)
+	{
+		++repeat_count;
+		return;
+	}
+
+	queueRepeatCount();
+	last_type    = type;
+	last_message = text;
+	queueMessage({ text, type, fmt::localtime(std::time(nullptr)) });
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // Log Namespace Functions
@@ -125,9 +319,12 @@ string log::Message::formattedMessageLine() const
 // -----------------------------------------------------------------------------
 void log::init()
 {
-	// Redirect sf::err output to the log file
+	// Open the log file and start writing to it
 	log_file.open(app::path("slade3.log", app::Dir::User));
-	sf::err().rdbuf(log_file.rdbuf());
+	file_writer.start();
+
+	// Redirect sf::err output to the log
+	sf::err().rdbuf(&sfml_error_buffer);
 
 	// Write logfile header
 	auto t  = std::time(nullptr);
@@ -162,6 +359,7 @@ void log::init()
 // -----------------------------------------------------------------------------
 const vector<log::Message>& log::history()
 {
+	addQueuedMessages();
 	return log;
 }
 
@@ -187,20 +385,16 @@ void log::setVerbosity(int verbosity)
 // -----------------------------------------------------------------------------
 void log::message(MessageType type, string_view text)
 {
-	// Add log message
-	auto t = std::time(nullptr);
-	log.emplace_back(text, type, *std::localtime(&t));
-
-	// Write to log file
-	if (log_file.is_open() && type != MessageType::Console) {
-		sf::err() << log.back().formattedMessageLine() << "\n";
-		sf::err().flush();
-	}
+	addMessage(type, text);
 }
 
 void log::message(MessageType type, int level, string_view text, fmt::format_args args)
 {
-	message(type, level, fmt::vformat(text, args));
+	// Don't bother formatting the message if it won't be logged
+	if (level > log_verbosity)
+		return;
+
+	message(type, fmt::vformat(text, args));
 }
 
 void log::message(MessageType type, string_view text, fmt::format_args args)
@@ -213,6 +407,8 @@ void log::message(MessageType type, string_view text, fmt::format_args args)
 // -----------------------------------------------------------------------------
 vector<log::Message*> log::since(time_t time, MessageType type)
 {
+	addQueuedMessages();
+
 	vector<Message*> list;
 	for (auto& msg : log)
 		if (mktime(&msg.timestamp) >= time && (type == MessageType::Any || msg.type == type))
@@ -258,11 +454,5 @@ void log::message(MessageType type, int level, string_view text)
 	if (level > log_verbosity)
 		return;
 
-	// Add log message
-	auto t = std::time(nullptr);
-	log.emplace_back(text, type, *std::localtime(&t));
-
-	// Write to log file
-	if (log_file.is_open() && type != MessageType::Console)
-		sf::err() << log.back().formattedMessageLine() << "\n";
+	addMessage(type, text);
 }
@@ -0,0 +1,144 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MemoryStats.cpp
+// Description: Memory accounting. Keeps track of the current and peak amount
+//              of memory used by various categories (entry data, images, GL
+//              textures, undo history, etc.), reported via the 'memstats'
+//              console command
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MemoryStats.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "General/Console.h"
+#include "General/ResourceManager.h"
+#include "Utility/StringUtils.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns [bytes] as a string in megabytes
+// -----------------------------------------------------------------------------
+string mb(int64_t bytes)
+{
+	return fmt::format("{:.2f}mb", static_cast<double>(bytes) / (1024 * 1024));
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MemStats Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the display name of [category]
+// -----------------------------------------------------------------------------
+string_view memstats::categoryName(Category category)
+{
+	switch (category)
+	{
+	case Category::Data: return "Data";
+	case Category::Image: return "Images";
+	case Category::GLTexture: return "GL Textures";
+	case Category::UndoHistory: return "Undo History";
+	case Category::MapObjects: return "Map Objects";
+	case Category::Resources: return "Resources";
+	default: return "Unknown";
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Resets the peak usage of all categories to their current usage
+// -----------------------------------------------------------------------------
+void memstats::resetPeaks()
+{
+	for (auto& counter : counters)
+		counter.peak = counter.current.load();
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Lists the current and peak memory usage of each category, and the resident
+// entry data of each open archive. 'memstats reset' resets the peak values
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(memstats, 0, true)
+{
+	if (!args.empty() && strutil::equalCI(args[0], "reset"))
+	{
+		memstats::resetPeaks();
+		log::console("Memory usage peaks reset");
+		return;
+	}
+
+	// Resource indices are measured rather than counted as they change
+	memstats::set(memstats::Category::Resources, app::resources().memUsage());
+
+	log::console("Memory usage by category (current / peak):");
+	int64_t total = 0;
+	for (unsigned a = 0; a < static_cast<unsigned>(memstats::Category::Count); ++a)
+	{
+		auto category = static_cast<memstats::Category>(a);
+		auto current  = memstats::current(category);
+		total += current;
+		log::console(
+			fmt::format("{}: {} / {}", memstats::categoryName(category), mb(current), mb(memstats::peak(category))));
+	}
+	log::console(fmt::format("Total: {}", mb(total)));
+
+	// Entry data per archive (included in the Data category above)
+	auto& manager = app::archiveManager();
+	log::console("Resident entry data by archive:");
+	for (int a = 0; a < manager.numArchives(); a++)
+	{
+		auto archive = manager.getArchive(a);
+		log::console(fmt::format(
+			"{}: \"{}\" - {}", a + 1, archive->filename(), mb(ArchiveManager::residentDataSize(archive.get()))));
+	}
+	if (auto* bra = manager.baseResourceArchive())
+		log::console(
+			fmt::format("Base Resource: \"{}\" - {}", bra->filename(), mb(ArchiveManager::residentDataSize(bra))));
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+
+namespace slade::memstats
+{
+// Categories of memory use that are tracked. Each byte is only counted in one
+// category (eg. image pixel data is counted as Image rather than Data)
+enum class Category : uint8_t
+{
+	Data,        // MemChunk data (entry data, temporary buffers etc.)
+	Image,       // Decoded image pixel/mask data (SImage)
+	GLTexture,   // OpenGL textures (estimated from their dimensions)
+	UndoHistory, // Undo levels currently held in memory (estimated)
+	MapObjects,  // Map object allocations (vertices, lines, sides, etc.)
+	Resources,   // ResourceManager indices (estimated, updated on request)
+
+	Count
+};
+
+struct Counter
+{
+	std::atomic<int64_t> current{ 0 };
+	std::atomic<int64_t> peak{ 0 };
+};
+
+inline Counter counters[static_cast<unsigned>(Category::Count)];
+
+// Records [bytes] allocated for [category], updating its peak if needed
+inline void allocated(Category category, size_t bytes)
+{
+	auto& counter = counters[static_cast<unsigned>(category)];
+	auto  current = counter.current.fetch_add(bytes, std::memory_order_relaxed) + static_cast<int64_t>(bytes);
+	auto  peak    = counter.peak.load(std::memory_order_relaxed);
+	while (current > peak && !counter.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {}
+}
+
+// Records [bytes] freed for [category]
+inline void freed(Category category, size_t bytes)
+{
+	counters[static_cast<unsigned>(category)].current.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+// Sets the current usage of [category] to [bytes], for categories that are
+// measured rather than counted as they change
+inline void set(Category category, size_t bytes)
+{
+	auto& counter = counters[static_cast<unsigned>(category)];
+	freed(category, counter.current.load(std::memory_order_relaxed));
+	allocated(category, bytes);
+}
+
+inline int64_t current(Category category)
+{
+	return counters[static_cast<unsigned>(category)].current.load(std::memory_order_relaxed);
+}
+inline int64_t peak(Category category)
+{
+	return counters[static_cast<unsigned>(category)].peak.load(std::memory_order_relaxed);
+}
+
+string_view categoryName(Category category);
+void        resetPeaks();
+} // namespace slade::memstats
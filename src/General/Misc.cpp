@@ -34,6 +34,7 @@
 #include "General/Misc.h"
 #include "Archive/Archive.h"
 #include "Archive/ArchiveEntry.h"
+#include "Archive/EntryType/EntryType.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "Graphics/SImage/SImage.h"
 #include "Utility/StringUtils.h"
@@ -89,27 +90,10 @@ bool misc::loadImageFromEntry(SImage* image, ArchiveEntry* entry, int index)
 	if (entry->type()->extraProps().contains("image_format"))
 		format_hint = entry->type()->extraProps().getOr<string>("image_format", {});
 
-	// Font formats are still manually loaded for now
-	auto format = entry->type()->formatId();
-	if (format == "font_doom_alpha")
-		return image->loadFont0(entry->rawData(), entry->size());
-	else if (format == "font_zd_console")
-		return image->loadFont1(entry->rawData(), entry->size());
-	else if (format == "font_zd_big")
-		return image->loadFont2(entry->rawData(), entry->size());
-	else if (format == "font_bmf")
-		return image->loadBMF(entry->rawData(), entry->size());
-	else if (format == "font_mono")
-		return image->loadFontM(entry->rawData(), entry->size());
-	else if (format == "font_wolf")
-		return image->loadWolfFont(entry->rawData(), entry->size());
-	else if (format == "font_jedi_fnt")
-		return image->loadJediFNT(entry->rawData(), entry->size());
-	else if (format == "font_jedi_font")
-		return image->loadJediFONT(entry->rawData(), entry->size());
 	// Jaguar Doom sprite and texture formats are a bit complicated, so
 	// they need manual loading as well rather than the SIFormat system
-	else if (format == "img_jaguar_sprite")
+	auto format = entry->type()->formatId();
+	if (format == "img_jaguar_sprite")
 	{
 		Archive* parent = entry->parent();
 		if (parent == nullptr)
@@ -132,23 +116,87 @@ bool misc::loadImageFromEntry(SImage* image, ArchiveEntry* entry, int index)
 		return image->loadJaguarTexture(entry->rawData(), entry->size(), dimensions.x, dimensions.y);
 	}
 
+	// Load the image, using the format it was loaded with last time (if any)
+	// to skip detection
+	if (!loadImageFromData(image, entry->data(), format, format_hint, index, entry->imageFormat()))
+		return false;
+
+	entry->setImageFormat(image->format());
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Loads an image from [data] into [image], where [format_id] and [format_hint]
+// are the format id and "image_format" property of the data's entry type.
+// Doesn't access any entry or archive, so can be called from a worker thread
+// (but can't load formats that need other entries, eg. Jaguar Doom sprites and
+// textures). On failure global::error is set, which is per-thread.
+// If [format] is given, it is tried first (skipping format detection).
+// Returns false if the given data wasn't a valid image, true otherwise
+// -----------------------------------------------------------------------------
+bool misc::loadImageFromData(
+	SImage*     image,
+	MemChunk&   data,
+	string_view format_id,
+	string_view format_hint,
+	int         index,
+	SIFormat*   format)
+{
+	// Font formats are still manually loaded for now
+	if (format_id == "font_doom_alpha")
+		return image->loadFont0(data.data(), data.size());
+	else if (format_id == "font_zd_console")
+		return image->loadFont1(data.data(), data.size());
+	else if (format_id == "font_zd_big")
+		return image->loadFont2(data.data(), data.size());
+	else if (format_id == "font_bmf")
+		return image->loadBMF(data.data(), data.size());
+	else if (format_id == "font_mono")
+		return image->loadFontM(data.data(), data.size());
+	else if (format_id == "font_wolf")
+		return image->loadWolfFont(data.data(), data.size());
+	else if (format_id == "font_jedi_fnt")
+		return image->loadJediFNT(data.data(), data.size());
+	else if (format_id == "font_jedi_font")
+		return image->loadJediFONT(data.data(), data.size());
+
+	// Try the known format if given
+	if (format && format->loadImage(*image, data, index))
+		return true;
+
 	// Firstly try SIFormat system
-	if (image->open(entry->data(), index, format_hint))
+	if (image->open(data, index, format_hint))
 		return true;
 
 	// Raw images are a special case (not reliably possible to detect just from data)
-	if (format == "img_raw" && SIFormat::rawFormat()->isThisFormat(entry->data()))
-		return SIFormat::rawFormat()->loadImage(*image, entry->data());
+	if (format_id == "img_raw" && SIFormat::rawFormat()->isThisFormat(data))
+		return SIFormat::rawFormat()->loadImage(*image, data);
 
 	// Lastly, try detecting/loading via FreeImage
-	else if (SIFormat::generalFormat()->isThisFormat(entry->data()))
-		return SIFormat::generalFormat()->loadImage(*image, entry->data());
+	else if (SIFormat::generalFormat()->isThisFormat(data))
+		return SIFormat::generalFormat()->loadImage(*image, data);
 
 	// Unknown image type
 	global::error = "Entry is not a known image format";
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if [entry] is an image that can be loaded from its data alone
+// (see loadImageFromData), detecting its type first if needed
+// -----------------------------------------------------------------------------
+bool misc::canLoadImageFromData(ArchiveEntry& entry)
+{
+	if (entry.type() == EntryType::unknownType())
+		EntryType::detectEntryType(entry);
+
+	if (!entry.type()->extraProps().contains("image"))
+		return false;
+
+	// Jaguar formats need other entries to load
+	return !strutil::startsWith(entry.type()->formatId(), "img_jaguar");
+}
+
 // -----------------------------------------------------------------------------
 // Detects the few known cases where a picture does not use PLAYPAL as its
 // default palette.
@@ -453,9 +501,6 @@ void misc::doMassRename(vector<string>& names, string_view name_filter)
 /* Table of CRCs of all 8-bit messages. */
 uint32_t crc_table[256];
 
-/* Flag: has the table been computed? Initially false. */
-int crc_table_computed = 0;
-
 /* Make the table for a fast CRC. */
 void make_crc_table(void)
 {
@@ -476,8 +521,6 @@ void make_crc_table(void)
 
 		crc_table[n] = c;
 	}
-
-	crc_table_computed = 1;
 }
 
 /* Update a running CRC with the bytes buf[0..len-1]--the CRC
@@ -488,8 +531,10 @@ uint32_t update_crc(uint32_t crc, const uint8_t* buf, uint32_t len)
 {
 	uint32_t c = crc;
 
-	if (!crc_table_computed)
-		make_crc_table();
+	/* Static initialization so the table is only computed once, even
+	 * when called from multiple threads (eg. PNG optimization) */
+	static const bool crc_table_computed = (make_crc_table(), true);
+	(void)crc_table_computed;
 
 	for (uint32_t n = 0; n < len; n++)
 		c = crc_table[(c ^ buf[n]) & 0xff] ^ (c >> 8);
@@ -504,6 +549,113 @@ uint32_t misc::crc(const uint8_t* buf, uint32_t len)
 }
 
 
+// 64-bit hash stuff (XXH64 algorithm)
+namespace
+{
+constexpr uint64_t xxh_prime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t xxh_prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t xxh_prime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t xxh_prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t xxh_prime5 = 0x27D4EB2F165667C5ULL;
+
+uint64_t xxhRotl(uint64_t val, int bits)
+{
+	return (val << bits) | (val >> (64 - bits));
+}
+
+uint64_t xxhRead64(const uint8_t* buf)
+{
+	uint64_t val;
+	memcpy(&val, buf, 8);
+	return wxUINT64_SWAP_ON_BE(val);
+}
+
+uint64_t xxhRead32(const uint8_t* buf)
+{
+	uint32_t val;
+	memcpy(&val, buf, 4);
+	return wxUINT32_SWAP_ON_BE(val);
+}
+
+uint64_t xxhRound(uint64_t acc, uint64_t input)
+{
+	acc += input * xxh_prime2;
+	return xxhRotl(acc, 31) * xxh_prime1;
+}
+
+uint64_t xxhMergeRound(uint64_t acc, uint64_t val)
+{
+	acc ^= xxhRound(0, val);
+	return acc * xxh_prime1 + xxh_prime4;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Returns a fast 64-bit (non-cryptographic) hash of the bytes in [buf] of
+// length [len], for quickly comparing data
+// -----------------------------------------------------------------------------
+uint64_t misc::hash64(const uint8_t* buf, uint32_t len)
+{
+	const auto* end = buf + len;
+	uint64_t    hash;
+
+	// Process 32 byte stripes
+	if (len >= 32)
+	{
+		const auto* limit = end - 32;
+		uint64_t    v1    = xxh_prime1 + xxh_prime2;
+		uint64_t    v2    = xxh_prime2;
+		uint64_t    v3    = 0;
+		uint64_t    v4    = 0 - xxh_prime1;
+		do
+		{
+			v1 = xxhRound(v1, xxhRead64(buf));
+			v2 = xxhRound(v2, xxhRead64(buf + 8));
+			v3 = xxhRound(v3, xxhRead64(buf + 16));
+			v4 = xxhRound(v4, xxhRead64(buf + 24));
+			buf += 32;
+		} while (buf <= limit);
+
+		hash = xxhRotl(v1, 1) + xxhRotl(v2, 7) + xxhRotl(v3, 12) + xxhRotl(v4, 18);
+		hash = xxhMergeRound(hash, v1);
+		hash = xxhMergeRound(hash, v2);
+		hash = xxhMergeRound(hash, v3);
+		hash = xxhMergeRound(hash, v4);
+	}
+	else
+		hash = xxh_prime5;
+
+	hash += len;
+
+	// Remaining bytes
+	for (; buf + 8 <= end; buf += 8)
+	{
+		hash ^= xxhRound(0, xxhRead64(buf));
+		hash = xxhRotl(hash, 27) * xxh_prime1 + xxh_prime4;
+	}
+	if (buf + 4 <= end)
+	{
+		hash ^= xxhRead32(buf) * xxh_prime1;
+		hash = xxhRotl(hash, 23) * xxh_prime2 + xxh_prime3;
+		buf += 4;
+	}
+	for (; buf < end; ++buf)
+	{
+		hash ^= *buf * xxh_prime5;
+		hash = xxhRotl(hash, 11) * xxh_prime1;
+	}
+
+	// Final mix
+	hash ^= hash >> 33;
+	hash *= xxh_prime2;
+	hash ^= hash >> 29;
+	hash *= xxh_prime3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
+
+
 // -----------------------------------------------------------------------------
 // Find the given name in a texture lump and returns a point2_t which contains
 // the dimensions.
@@ -519,8 +671,8 @@ Vec2i misc::findJaguarTextureDimensions(ArchiveEntry* entry, string_view name)
 	if (entry->size() < 40)
 		return dimensions;
 
-	auto&  data   = entry->data();
-	size_t numtex = data.readL32(0);
+	const auto& data   = entry->constData();
+	size_t      numtex = data.readL32(0);
 
 	// 4 bytes for the offset, plus 32 byte for the texture definition itself
 	// so a total of 36 bytes per texture; plus four for the texture count
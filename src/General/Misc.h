@@ -3,14 +3,24 @@
 namespace slade
 {
 class SImage;
+class MemChunk;
 class Archive;
 class ArchiveEntry;
 class Palette;
+class SIFormat;
 class Tokenizer;
 
 namespace misc
 {
 	bool loadImageFromEntry(SImage* image, ArchiveEntry* entry, int index = 0);
+	bool loadImageFromData(
+		SImage*     image,
+		MemChunk&   data,
+		string_view format_id,
+		string_view format_hint,
+		int         index  = 0,
+		SIFormat*   format = nullptr);
+	bool canLoadImageFromData(ArchiveEntry& entry);
 
 	// Palette detection
 	namespace palhack
@@ -34,6 +44,7 @@ namespace misc
 	string   lumpNameToFileName(string_view lump);
 	string   fileNameToLumpName(string_view file);
 	uint32_t crc(const uint8_t* buf, uint32_t len);
+	uint64_t hash64(const uint8_t* buf, uint32_t len);
 	Vec2i    findJaguarTextureDimensions(ArchiveEntry* entry, string_view name);
 
 	// Mass Rename
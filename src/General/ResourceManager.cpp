@@ -59,30 +59,130 @@ string ResourceManager::doom64_hash_table_[65536];
 namespace
 {
 // ----------------------------------------------------------------------------
-// Removes all entries in resource [map] that are within [archive]
+// Returns the resource [name] in [map], or nullptr if there isn't one
 // ----------------------------------------------------------------------------
-void removeArchiveFromMap(EntryResourceMap& map, const Archive* archive)
+template<typename Map> auto findResource(Map& map, string_view name) -> decltype(&map.begin()->second)
+{
+	auto i = map.find(name);
+	return i != map.end() ? &i->second : nullptr;
+}
+
+// ----------------------------------------------------------------------------
+// Returns the resource [name] in [map], adding it if it doesn't exist yet.
+// The name is interned in [names] so the map key remains valid
+// ----------------------------------------------------------------------------
+template<typename T> T& addResource(ResourceMap<T>& map, string_view name, std::unordered_set<string>& names)
+{
+	auto i = map.find(name);
+	if (i == map.end())
+		i = map.try_emplace(*names.emplace(name).first).first;
+
+	return i->second;
+}
+
+// ----------------------------------------------------------------------------
+// Returns pointers to all resources in [map], sorted by name
+// ----------------------------------------------------------------------------
+template<typename Map> auto sortedResources(Map& map)
+{
+	vector<decltype(&*map.begin())> sorted;
+	sorted.reserve(map.size());
+	for (auto& i : map)
+		sorted.push_back(&i);
+
+	std::sort(sorted.begin(), sorted.end(), [](const auto* left, const auto* right) { return left->first < right->first; });
+
+	return sorted;
+}
+
+// ----------------------------------------------------------------------------
+// Removes all entries in resource [map] that are within [archive], recording
+// any affected resources in [changes]
+// ----------------------------------------------------------------------------
+void removeArchiveFromMap(EntryResourceMap& map, const Archive* archive, ResourceChanges::Names& changes)
 {
 	for (auto& i : map)
-		i.second.removeArchive(archive);
+		if (i.second.removeArchive(archive))
+			changes.remove(i.first, i.second.length() == 0);
 }
 
 // ----------------------------------------------------------------------------
-// Removes [entry] from resource [map].
+// Removes [entry] from resource [map], recording any affected resources in
+// [changes].
 // If [full_check] is true, all resources in the map are checked for the entry,
 // otherwise only the resource [name] is checked
 // ----------------------------------------------------------------------------
-void removeEntryFromMap(EntryResourceMap& map, const string& name, const ArchiveEntry* entry, bool full_check)
+void removeEntryFromMap(
+	EntryResourceMap&       map,
+	string_view             name,
+	const ArchiveEntry*     entry,
+	bool                    full_check,
+	ResourceChanges::Names& changes)
 {
 	if (full_check)
+	{
 		for (auto& i : map)
-			i.second.remove(entry);
-	else
-		map[name].remove(entry);
+			if (i.second.remove(entry))
+				changes.remove(i.first, i.second.length() == 0);
+	}
+	else if (auto* res = findResource(map, name))
+	{
+		if (res->remove(entry))
+			changes.remove(name, res->length() == 0);
+	}
+}
+
+// ----------------------------------------------------------------------------
+// Adds [entry] to the resource [name] in [map], recording the change in
+// [changes]. Returns the resource
+// ----------------------------------------------------------------------------
+EntryResource& addEntryToMap(
+	EntryResourceMap&               map,
+	string_view                     name,
+	const shared_ptr<ArchiveEntry>& entry,
+	std::unordered_set<string>&     names,
+	ResourceChanges::Names&         changes)
+{
+	auto& res = addResource(map, name, names);
+	changes.add(name, res.length() == 0);
+	res.add(entry);
+
+	return res;
 }
 } // namespace
 
 
+// ----------------------------------------------------------------------------
+//
+// ResourceNameHash/ResourceNameEqual Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns a case-insensitive (FNV-1a) hash of [name]
+// -----------------------------------------------------------------------------
+size_t ResourceNameHash::operator()(string_view name) const
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (auto c : name)
+	{
+		hash ^= static_cast<uint8_t>(toupper(static_cast<uint8_t>(c)));
+		hash *= 1099511628211ull;
+	}
+
+	return static_cast<size_t>(hash);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [left] and [right] are equal, ignoring case
+// -----------------------------------------------------------------------------
+bool ResourceNameEqual::operator()(string_view left, string_view right) const
+{
+	return strutil::equalCI(left, right);
+}
+
+
 // ----------------------------------------------------------------------------
 //
 // EntryResource Class Functions
@@ -100,35 +200,47 @@ void EntryResource::add(const shared_ptr<ArchiveEntry>& entry)
 }
 
 // -----------------------------------------------------------------------------
-// Removes matching [entry] from the resource
+// Removes matching [entry] from the resource.
+// Returns true if it was found
 // -----------------------------------------------------------------------------
-void EntryResource::remove(const ArchiveEntry* entry)
+bool EntryResource::remove(const ArchiveEntry* entry)
 {
-	unsigned a = 0;
+	auto     removed = false;
+	unsigned a       = 0;
 	while (a < entries_.size())
 	{
 		if (entries_[a].lock().get() == entry)
+		{
 			entries_.erase(entries_.begin() + a);
+			removed = true;
+		}
 		else
 			++a;
 	}
+
+	return removed;
 }
 
 // ----------------------------------------------------------------------------
-// Removes any entries in the resource that are in [archive]
+// Removes any entries in the resource that are in [archive].
+// Returns true if any were removed
 // ----------------------------------------------------------------------------
-void EntryResource::removeArchive(const Archive* archive)
+bool EntryResource::removeArchive(const Archive* archive)
 {
-	unsigned a = 0;
+	auto     removed = false;
+	unsigned a       = 0;
 	while (a < entries_.size())
 	{
-		if (entries_[a].expired())
-			entries_.erase(entries_.begin() + a);
-		else if (entries_[a].lock()->parent() == archive)
+		if (entries_[a].expired() || entries_[a].lock()->parent() == archive)
+		{
 			entries_.erase(entries_.begin() + a);
+			removed = true;
+		}
 		else
 			++a;
 	}
+
+	return removed;
 }
 
 // ----------------------------------------------------------------------------
@@ -189,7 +301,7 @@ ArchiveEntry* EntryResource::getEntry(const Archive* priority, string_view nspac
 		}
 
 		// Otherwise, if it's in a 'later' archive than the current resource entry, set it
-		if (app::archiveManager().archiveIndex(best->parent()) <= app::archiveManager().archiveIndex(entry->parent()))
+		if (app::resources().archivePriority(best->parent()) <= app::resources().archivePriority(entry->parent()))
 			best = entry;
 	}
 
@@ -218,20 +330,81 @@ void TextureResource::add(CTexture* tex, Archive* parent)
 }
 
 // -----------------------------------------------------------------------------
-// Removes any textures in this resource that are part of [parent] archive
+// Removes any textures in this resource that are part of [parent] archive.
+// Returns true if any were removed
 // -----------------------------------------------------------------------------
-void TextureResource::remove(const Archive* parent)
+bool TextureResource::remove(const Archive* parent)
 {
 	// Remove any textures with matching parent
-	auto i = textures_.begin();
+	auto removed = false;
+	auto i       = textures_.begin();
 	while (i != textures_.end())
 	{
 		auto* t_parent = i->get()->parent.lock().get();
 		if (!t_parent || t_parent == parent)
-			i = textures_.erase(i);
+		{
+			i       = textures_.erase(i);
+			removed = true;
+		}
 		else
 			++i;
 	}
+
+	return removed;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// ResourceChanges::Names Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Records an entry or texture being added to resource [name]. If [was_empty]
+// is true the resource didn't have anything in it before
+// -----------------------------------------------------------------------------
+void ResourceChanges::Names::add(string_view name, bool was_empty)
+{
+	string key{ name };
+	if (!was_empty)
+	{
+		if (added.count(key) == 0)
+			changed.insert(key);
+	}
+	else if (removed.erase(key) > 0)
+		changed.insert(key); // Removed then re-added
+	else
+		added.insert(key);
+}
+
+// -----------------------------------------------------------------------------
+// Records an entry or texture being removed from resource [name]. If
+// [now_empty] is true the resource has nothing left in it
+// -----------------------------------------------------------------------------
+void ResourceChanges::Names::remove(string_view name, bool now_empty)
+{
+	string key{ name };
+	if (!now_empty)
+	{
+		if (added.count(key) == 0)
+			changed.insert(key);
+	}
+	else if (added.erase(key) == 0) // Nothing to report if it was only just added
+	{
+		changed.erase(key);
+		removed.insert(key);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if resource [name] was added, removed or changed
+// -----------------------------------------------------------------------------
+bool ResourceChanges::Names::contains(string_view name) const
+{
+	string key{ name };
+	return added.count(key) > 0 || removed.count(key) > 0 || changed.count(key) > 0;
 }
 
 
@@ -251,17 +424,19 @@ void ResourceManager::addArchive(Archive* archive)
 	if (!archive)
 		return;
 
+	// Archive order may have changed
+	archive_priority_dirty_ = true;
+
 	// Go through entries
-	vector<shared_ptr<ArchiveEntry>> entries;
-	archive->putEntryTreeAsList(entries);
-	for (auto& entry : entries)
-		addEntry(entry);
+	archive->rootDir()->visitEntries([this](const shared_ptr<ArchiveEntry>& entry) { addEntry(entry); }, true, true);
 
 	// Update entries from the archive when changed (added/removed/modified)
 	archive->signals().entry_added.connect([this](Archive&, ArchiveEntry& e) { updateEntry(e, false, true); });
 	archive->signals().entry_removed.connect([this](Archive&, ArchiveDir&, ArchiveEntry& e)
 											 { updateEntry(e, true, false); });
 	archive->signals().entry_state_changed.connect([this](Archive&, ArchiveEntry& e) { updateEntry(e, true, true); });
+	archive->signals().entries_changed.connect([this](Archive&, const Archive::EntryChanges& changes)
+											   { updateEntries(changes); });
 
 	// Update entries from the archive when renamed
 	archive->signals().entry_renamed.connect(
@@ -272,11 +447,11 @@ void ResourceManager::addArchive(Archive* archive)
 			removeEntry(&entry, prev_upper);
 			addEntry(entry_shared);
 
-			signals_.resources_updated();
+			announceChanges();
 		});
 
 	// Announce resource update
-	signals_.resources_updated();
+	announceChanges();
 }
 
 // -----------------------------------------------------------------------------
@@ -288,29 +463,33 @@ void ResourceManager::removeArchive(const Archive* archive)
 	if (!archive)
 		return;
 
+	archive_priority_dirty_ = true;
+
 	// Remove from palettes
-	removeArchiveFromMap(palettes_, archive);
+	removeArchiveFromMap(palettes_, archive, changes_.palettes);
 
 	// Remove from patches
-	removeArchiveFromMap(patches_, archive);
-	removeArchiveFromMap(patches_fp_, archive);
-	removeArchiveFromMap(patches_fp_only_, archive);
+	removeArchiveFromMap(patches_, archive, changes_.patches);
+	removeArchiveFromMap(patches_fp_, archive, changes_.patches);
+	removeArchiveFromMap(patches_fp_only_, archive, changes_.patches);
 
 	// Remove from flats
-	removeArchiveFromMap(flats_, archive);
-	removeArchiveFromMap(flats_fp_, archive);
-	removeArchiveFromMap(flats_fp_only_, archive);
+	removeArchiveFromMap(flats_, archive, changes_.flats);
+	removeArchiveFromMap(flats_fp_, archive, changes_.flats);
+	removeArchiveFromMap(flats_fp_only_, archive, changes_.flats);
 
-	// Remove from stand-alone textures
-	removeArchiveFromMap(satextures_, archive);
-	removeArchiveFromMap(satextures_fp_, archive);
+	// Remove from stand-alone and hi-res textures
+	removeArchiveFromMap(satextures_, archive, changes_.satextures);
+	removeArchiveFromMap(satextures_fp_, archive, changes_.satextures);
+	removeArchiveFromMap(hires_, archive, changes_.satextures);
 
 	// Remove any textures in the archive
 	for (auto& i : composites_)
-		i.second.remove(archive);
+		if (i.second.remove(archive))
+			changes_.textures.remove(i.first, i.second.length() == 0);
 
 	// Announce resource update
-	signals_.resources_updated();
+	announceChanges();
 }
 
 // -----------------------------------------------------------------------------
@@ -330,10 +509,73 @@ uint16_t ResourceManager::getTextureHash(string_view name) const
 	return static_cast<uint16_t>(hash);
 }
 
+// -----------------------------------------------------------------------------
+// Returns the load order priority of [archive] (higher is loaded later and
+// takes precedence), or -1 if it isn't open in the archive manager
+// -----------------------------------------------------------------------------
+int ResourceManager::archivePriority(const Archive* archive) const
+{
+	// Rebuild the lookup if archives were added or removed since it was built
+	if (archive_priority_dirty_)
+	{
+		auto archives = app::archiveManager().allArchives(false);
+		archive_priority_.clear();
+		for (unsigned a = 0; a < archives.size(); ++a)
+			archive_priority_[archives[a].get()] = static_cast<int>(a);
+
+		archive_priority_dirty_ = false;
+	}
+
+	auto i = archive_priority_.find(archive);
+	return i != archive_priority_.end() ? i->second : -1;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the (approximate) amount of memory used by the resource indices, in
+// bytes. This doesn't include the resource entries' data, which is owned by
+// their archives
+// -----------------------------------------------------------------------------
+size_t ResourceManager::memUsage() const
+{
+	// Map nodes and buckets
+	auto map_usage = [](const auto& map)
+	{ return map.bucket_count() * sizeof(void*) + map.size() * (sizeof(*map.begin()) + sizeof(void*)); };
+
+	size_t usage = 0;
+	for (const auto* map : { &palettes_,
+							 &patches_,
+							 &patches_fp_,
+							 &patches_fp_only_,
+							 &graphics_,
+							 &flats_,
+							 &flats_fp_,
+							 &flats_fp_only_,
+							 &satextures_,
+							 &satextures_fp_,
+							 &hires_ })
+	{
+		usage += map_usage(*map);
+		for (const auto& res : *map)
+			usage += res.second.entries_.capacity() * sizeof(weak_ptr<ArchiveEntry>);
+	}
+
+	usage += map_usage(composites_);
+	for (const auto& res : composites_)
+		usage += res.second.textures_.capacity() * sizeof(unique_ptr<TextureResource::Texture>)
+				 + res.second.textures_.size() * sizeof(TextureResource::Texture);
+
+	// Interned names
+	usage += map_usage(names_);
+	for (const auto& name : names_)
+		usage += name.capacity();
+
+	return usage;
+}
+
 // -----------------------------------------------------------------------------
 // Adds an entry to be managed
 // -----------------------------------------------------------------------------
-void ResourceManager::addEntry(shared_ptr<ArchiveEntry>& entry)
+void ResourceManager::addEntry(const shared_ptr<ArchiveEntry>& entry)
 {
 	if (!entry)
 		return;
@@ -357,7 +599,7 @@ void ResourceManager::addEntry(shared_ptr<ArchiveEntry>& entry)
 
 	// Check for palette entry
 	if (type->id() == "palette")
-		palettes_[name].add(entry);
+		addEntryToMap(palettes_, name, entry, names_, changes_.palettes);
 
 	// Check for various image entries, so only accept images
 	if (type->editor() == "gfx")
@@ -378,17 +620,18 @@ void ResourceManager::addEntry(shared_ptr<ArchiveEntry>& entry)
 		// Check for patch entry
 		if (type->extraProps().contains("patch") || entry->isInNamespace("patches") || entry->isInNamespace("sprites"))
 		{
-			if (patches_[name].length() == 0)
+			auto& patch = addResource(patches_, name, names_);
+			if (patch.length() == 0)
 			{
 				addToFpOnly = false;
 			}
-			patches_[name].add(entry);
+			addEntryToMap(patches_, name, entry, names_, changes_.patches);
 			if (!entry->parent()->isTreeless())
 			{
-				patches_fp_[path].add(entry);
-				if ((lname.size() > 8 || patches_[name].length() > 0) && addToFpOnly)
+				addEntryToMap(patches_fp_, path, entry, names_, changes_.patches);
+				if ((lname.size() > 8 || patch.length() > 0) && addToFpOnly)
 				{
-					patches_fp_only_[path].add(entry);
+					addEntryToMap(patches_fp_only_, path, entry, names_, changes_.patches);
 				}
 			}
 		}
@@ -398,17 +641,18 @@ void ResourceManager::addEntry(shared_ptr<ArchiveEntry>& entry)
 		// Check for flat entry
 		if (type->id() == "gfx_flat" || entry->isInNamespace("flats"))
 		{
-			if (flats_[name].length() == 0)
+			auto& flat = addResource(flats_, name, names_);
+			if (flat.length() == 0)
 			{
 				addToFpOnly = false;
 			}
-			flats_[name].add(entry);
+			addEntryToMap(flats_, name, entry, names_, changes_.flats);
 			if (!entry->parent()->isTreeless())
 			{
-				flats_fp_[path].add(entry);
-				if ((lname.size() > 8 || flats_[name].length() > 0) && addToFpOnly)
+				addEntryToMap(flats_fp_, path, entry, names_, changes_.flats);
+				if ((lname.size() > 8 || flat.length() > 0) && addToFpOnly)
 				{
-					flats_fp_only_[path].add(entry);
+					addEntryToMap(flats_fp_only_, path, entry, names_, changes_.flats);
 				}
 			}
 		}
@@ -416,10 +660,10 @@ void ResourceManager::addEntry(shared_ptr<ArchiveEntry>& entry)
 		// Check for stand-alone texture entry
 		if (entry->isInNamespace("textures"))
 		{
-			satextures_[name].add(entry);
+			addEntryToMap(satextures_, name, entry, names_, changes_.satextures);
 			if (!entry->parent()->isTreeless())
 			{
-				satextures_fp_[path].add(entry);
+				addEntryToMap(satextures_fp_, path, entry, names_, changes_.satextures);
 			}
 
 			// Add name to hash table
@@ -427,7 +671,7 @@ void ResourceManager::addEntry(shared_ptr<ArchiveEntry>& entry)
 		}
 		else if (entry->isInNamespace("hires"))
 		{ // Handle hi-res textures
-			hires_[name].add(entry);
+			addEntryToMap(hires_, name, entry, names_, changes_.satextures);
 		}
 	}
 
@@ -461,7 +705,9 @@ void ResourceManager::addEntry(shared_ptr<ArchiveEntry>& entry)
 		for (unsigned a = 0; a < tx.size(); a++)
 		{
 			tex = tx.texture(a);
-			composites_[tex->name()].add(tex, entry->parent());
+			auto& res = addResource(composites_, tex->name(), names_);
+			changes_.textures.add(tex->name(), res.length() == 0);
+			res.add(tex, entry->parent());
 		}
 	}
 }
@@ -483,21 +729,22 @@ void ResourceManager::removeEntry(ArchiveEntry* entry, string_view entry_name, b
 	log::debug("Removing entry {} from resource manager", path);
 
 	// Remove from palettes
-	removeEntryFromMap(palettes_, name, entry, full_check);
+	removeEntryFromMap(palettes_, name, entry, full_check, changes_.palettes);
 
 	// Remove from patches
-	removeEntryFromMap(patches_, name, entry, full_check);
-	removeEntryFromMap(patches_fp_, path, entry, full_check);
-	removeEntryFromMap(patches_fp_only_, path, entry, full_check);
+	removeEntryFromMap(patches_, name, entry, full_check, changes_.patches);
+	removeEntryFromMap(patches_fp_, path, entry, full_check, changes_.patches);
+	removeEntryFromMap(patches_fp_only_, path, entry, full_check, changes_.patches);
 
 	// Remove from flats
-	removeEntryFromMap(flats_, name, entry, full_check);
-	removeEntryFromMap(flats_fp_, path, entry, full_check);
-	removeEntryFromMap(flats_fp_only_, path, entry, full_check);
+	removeEntryFromMap(flats_, name, entry, full_check, changes_.flats);
+	removeEntryFromMap(flats_fp_, path, entry, full_check, changes_.flats);
+	removeEntryFromMap(flats_fp_only_, path, entry, full_check, changes_.flats);
 
-	// Remove from stand-alone textures
-	removeEntryFromMap(satextures_, name, entry, full_check);
-	removeEntryFromMap(satextures_fp_, path, entry, full_check);
+	// Remove from stand-alone and hi-res textures
+	removeEntryFromMap(satextures_, name, entry, full_check, changes_.satextures);
+	removeEntryFromMap(satextures_fp_, path, entry, full_check, changes_.satextures);
+	removeEntryFromMap(hires_, name, entry, full_check, changes_.satextures);
 
 	// Check for TEXTUREx entry
 	int txentry = 0;
@@ -517,7 +764,11 @@ void ResourceManager::removeEntry(ArchiveEntry* entry, string_view entry_name, b
 
 		// Remove all texture resources
 		for (unsigned a = 0; a < tx.size(); a++)
-			composites_[tx.texture(a)->name()].remove(entry->parent());
+		{
+			auto* res = findResource(composites_, tx.texture(a)->name());
+			if (res && res->remove(entry->parent()))
+				changes_.textures.remove(tx.texture(a)->name(), res->length() == 0);
+		}
 	}
 }
 
@@ -526,12 +777,17 @@ void ResourceManager::removeEntry(ArchiveEntry* entry, string_view entry_name, b
 // -----------------------------------------------------------------------------
 void ResourceManager::listAllPatches() const
 {
+	vector<std::pair<string_view, int>> patches;
 	for (auto& i : patches_)
+		patches.emplace_back(i.first, i.second.length());
+	std::sort(patches.begin(), patches.end());
+
+	for (auto& i : patches)
 	{
-		if (i.second.length() == 0)
+		if (i.second == 0)
 			continue;
 
-		log::info("{} ({})", i.first, i.second.length());
+		log::info("{} ({})", i.first, i.second);
 	}
 }
 
@@ -540,9 +796,9 @@ void ResourceManager::listAllPatches() const
 // -----------------------------------------------------------------------------
 void ResourceManager::putAllPatchEntries(vector<ArchiveEntry*>& list, const Archive* priority, bool fullPath)
 {
-	for (auto& i : patches_)
+	for (auto* i : sortedResources(patches_))
 	{
-		auto* entry = i.second.getEntry(priority);
+		auto* entry = i->second.getEntry(priority);
 		if (entry)
 			list.push_back(entry);
 	}
@@ -550,14 +806,35 @@ void ResourceManager::putAllPatchEntries(vector<ArchiveEntry*>& list, const Arch
 	if (!fullPath)
 		return;
 
-	for (auto& i : patches_fp_only_)
+	for (auto* i : sortedResources(patches_fp_only_))
 	{
-		auto* entry = i.second.getEntry(priority);
+		auto* entry = i->second.getEntry(priority);
 		if (entry)
 			list.push_back(entry);
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Adds the current patch entries for each of [names] to [list].
+// Used to update a list from putAllPatchEntries for a set of ResourceChanges::Names
+// -----------------------------------------------------------------------------
+void ResourceManager::putPatchEntries(
+	vector<ArchiveEntry*>&  list,
+	const std::set<string>& names,
+	const Archive*          priority,
+	bool                    fullPath)
+{
+	for (const auto& name : names)
+	{
+		auto* res = findResource(patches_, name);
+		if (!res && fullPath)
+			res = findResource(patches_fp_only_, name);
+
+		if (auto* entry = res ? res->getEntry(priority) : nullptr)
+			list.push_back(entry);
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Adds all current textures to [list]
 // -----------------------------------------------------------------------------
@@ -567,42 +844,25 @@ void ResourceManager::putAllTextures(
 	const Archive*                     ignore) const
 {
 	// Add all primary textures to the list
-	for (auto& i : composites_)
-	{
-		// Skip if no entries
-		if (i.second.length() == 0)
-			continue;
-
-		const auto& tex_res = i.second;
-
-		// Go through resource textures
-		auto* best_res = tex_res.textures_[0].get();
-		for (int a = 1; a < tex_res.length(); a++)
-		{
-			auto* res        = tex_res.textures_[a].get();
-			auto* res_parent = res->parent.lock().get();
-
-			// Skip if it's in the 'ignore' archive
-			if (!res_parent || res_parent == ignore)
-				continue;
-
-			// If it's in the 'priority' archive, exit loop
-			if (priority && res_parent == priority)
-			{
-				best_res = tex_res.textures_[a].get();
-				break;
-			}
-
-			// Otherwise, if it's in a 'later' archive than the current resource, set it
-			if (app::archiveManager().archiveIndex(res_parent)
-				<= app::archiveManager().archiveIndex(best_res->parent.lock().get()))
-				best_res = tex_res.textures_[a].get();
-		}
-
-		// Add texture resource to the list
-		if (best_res->parent.lock().get() != ignore)
+	for (auto* i : sortedResources(composites_))
+		if (auto* best_res = bestTexture(i->second, priority, ignore))
 			list.push_back(best_res);
-	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds the current textures for each of [names] to [list].
+// Used to update a list from putAllTextures for a set of ResourceChanges::Names
+// -----------------------------------------------------------------------------
+void ResourceManager::putTextures(
+	vector<TextureResource::Texture*>& list,
+	const std::set<string>&            names,
+	const Archive*                     priority,
+	const Archive*                     ignore) const
+{
+	for (const auto& name : names)
+		if (auto* res = findResource(composites_, name))
+			if (auto* best_res = bestTexture(*res, priority, ignore))
+				list.push_back(best_res);
 }
 
 // -----------------------------------------------------------------------------
@@ -611,9 +871,11 @@ void ResourceManager::putAllTextures(
 void ResourceManager::putAllTextureNames(vector<string>& list) const
 {
 	// Add all primary textures to the list
+	auto first = list.size();
 	for (auto& i : composites_)
 		if (i.second.length() > 0) // Ignore if no entries
-			list.push_back(i.first);
+			list.emplace_back(i.first);
+	std::sort(list.begin() + first, list.end());
 }
 
 // -----------------------------------------------------------------------------
@@ -621,9 +883,9 @@ void ResourceManager::putAllTextureNames(vector<string>& list) const
 // -----------------------------------------------------------------------------
 void ResourceManager::putAllFlatEntries(vector<ArchiveEntry*>& list, const Archive* priority, bool fullPath)
 {
-	for (auto& i : flats_)
+	for (auto* i : sortedResources(flats_))
 	{
-		auto* entry = i.second.getEntry(priority);
+		auto* entry = i->second.getEntry(priority);
 		if (entry)
 			list.push_back(entry);
 	}
@@ -631,23 +893,46 @@ void ResourceManager::putAllFlatEntries(vector<ArchiveEntry*>& list, const Archi
 	if (!fullPath)
 		return;
 
-	for (auto& i : flats_fp_only_)
+	for (auto* i : sortedResources(flats_fp_only_))
 	{
-		auto* entry = i.second.getEntry(priority);
+		auto* entry = i->second.getEntry(priority);
 		if (entry)
 			list.push_back(entry);
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Adds the current flat entries for each of [names] to [list].
+// Used to update a list from putAllFlatEntries for a set of ResourceChanges::Names
+// -----------------------------------------------------------------------------
+void ResourceManager::putFlatEntries(
+	vector<ArchiveEntry*>&  list,
+	const std::set<string>& names,
+	const Archive*          priority,
+	bool                    fullPath)
+{
+	for (const auto& name : names)
+	{
+		auto* res = findResource(flats_, name);
+		if (!res && fullPath)
+			res = findResource(flats_fp_only_, name);
+
+		if (auto* entry = res ? res->getEntry(priority) : nullptr)
+			list.push_back(entry);
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Adds all current flat names to [list]
 // -----------------------------------------------------------------------------
 void ResourceManager::putAllFlatNames(vector<string>& list) const
 {
 	// Add all primary flats to the list
+	auto first = list.size();
 	for (auto& i : flats_)
 		if (i.second.length() > 0) // Ignore if no entries
-			list.push_back(i.first);
+			list.emplace_back(i.first);
+	std::sort(list.begin() + first, list.end());
 }
 
 // -----------------------------------------------------------------------------
@@ -656,7 +941,8 @@ void ResourceManager::putAllFlatNames(vector<string>& list) const
 // -----------------------------------------------------------------------------
 ArchiveEntry* ResourceManager::getPaletteEntry(string_view palette, const Archive* priority)
 {
-	return palettes_[strutil::upper(palette)].getEntry(priority);
+	auto* res = findResource(palettes_, palette);
+	return res ? res->getEntry(priority) : nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -673,14 +959,12 @@ ArchiveEntry* ResourceManager::getPatchEntry(string_view patch, string_view nspa
 	if (strutil::equalCI(nspace, "textures"))
 		return getTextureEntry(patch, "textures", priority);
 
-	auto  patch_upper = strutil::upper(patch);
-	auto* entry       = patches_[patch_upper].getEntry(priority, nspace, true);
-	if (entry)
-		return entry;
+	if (auto* res = findResource(patches_, patch))
+		if (auto* entry = res->getEntry(priority, nspace, true))
+			return entry;
 
-	entry = patches_fp_[patch_upper].getEntry(priority, nspace, true);
-	if (entry)
-		return entry;
+	if (auto* res = findResource(patches_fp_, patch))
+		return res->getEntry(priority, nspace, true);
 
 	return nullptr;
 }
@@ -691,18 +975,13 @@ ArchiveEntry* ResourceManager::getPatchEntry(string_view patch, string_view nspa
 // -----------------------------------------------------------------------------
 ArchiveEntry* ResourceManager::getFlatEntry(string_view flat, const Archive* priority)
 {
-	// Check resource with matching name exists
-	auto  flat_upper = strutil::upper(flat);
-	auto& res        = flats_[flat_upper];
-
-	// Return most relevant entry
-	auto* entry = res.getEntry(priority);
-	if (entry)
-		return entry;
+	// Return most relevant entry from resource with matching name (if any)
+	if (auto* res = findResource(flats_, flat))
+		if (auto* entry = res->getEntry(priority))
+			return entry;
 
-	entry = flats_fp_[flat_upper].getEntry(priority, "flats", true);
-	if (entry)
-		return entry;
+	if (auto* res = findResource(flats_fp_, flat))
+		return res->getEntry(priority, "flats", true);
 
 	return nullptr;
 }
@@ -713,14 +992,12 @@ ArchiveEntry* ResourceManager::getFlatEntry(string_view flat, const Archive* pri
 // -----------------------------------------------------------------------------
 ArchiveEntry* ResourceManager::getTextureEntry(string_view texture, string_view nspace, const Archive* priority)
 {
-	auto  tex_upper = strutil::upper(texture);
-	auto* entry     = satextures_[tex_upper].getEntry(priority, nspace, true);
-	if (entry)
-		return entry;
+	if (auto* res = findResource(satextures_, texture))
+		if (auto* entry = res->getEntry(priority, nspace, true))
+			return entry;
 
-	entry = satextures_fp_[tex_upper].getEntry(priority, nspace, true);
-	if (entry)
-		return entry;
+	if (auto* res = findResource(satextures_fp_, texture))
+		return res->getEntry(priority, nspace, true);
 
 	return nullptr;
 }
@@ -736,14 +1013,14 @@ CTexture* ResourceManager::getTexture(
 	const Archive* ignore)
 {
 	// Check texture resource with matching name exists
-	auto& res = composites_[strutil::upper(texture)];
-	if (res.textures_.empty())
+	auto* res = findResource(composites_, texture);
+	if (!res || res->textures_.empty())
 		return nullptr;
 
 	// Go through resource textures
-	auto* tex    = &res.textures_[0]->tex;
-	auto* parent = res.textures_[0]->parent.lock().get();
-	for (auto& res_tex : res.textures_)
+	auto* tex    = &res->textures_[0]->tex;
+	auto* parent = res->textures_[0]->parent.lock().get();
+	for (auto& res_tex : res->textures_)
 	{
 		// Skip if it's not the desired type
 		if (!type.empty() && res_tex->tex.type() != type)
@@ -759,7 +1036,7 @@ CTexture* ResourceManager::getTexture(
 			return &res_tex->tex;
 
 		// Otherwise, if it's in a 'later' archive than the current resource entry, set it
-		if (app::archiveManager().archiveIndex(parent) <= app::archiveManager().archiveIndex(rt_parent))
+		if (archivePriority(parent) <= archivePriority(rt_parent))
 		{
 			tex    = &res_tex->tex;
 			parent = rt_parent;
@@ -776,9 +1053,72 @@ CTexture* ResourceManager::getTexture(
 ArchiveEntry* ResourceManager::getHiresEntry(string_view texture, const Archive* priority)
 {
 	// Hi-res textures can only be used with a short name
-	return hires_[strutil::upper(texture)].getEntry(priority, "hires", true);
+	auto* res = findResource(hires_, texture);
+	return res ? res->getEntry(priority, "hires", true) : nullptr;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the most relevant texture in [res], prioritising textures in the
+// [priority] archive and ignoring any in the [ignore] archive
+// -----------------------------------------------------------------------------
+TextureResource::Texture* ResourceManager::bestTexture(
+	const TextureResource& res,
+	const Archive*         priority,
+	const Archive*         ignore) const
+{
+	// Skip if no entries
+	if (res.textures_.empty())
+		return nullptr;
+
+	// Go through resource textures
+	auto* best_res = res.textures_[0].get();
+	for (int a = 1; a < res.length(); a++)
+	{
+		auto* tex        = res.textures_[a].get();
+		auto* tex_parent = tex->parent.lock().get();
+
+		// Skip if it's in the 'ignore' archive
+		if (!tex_parent || tex_parent == ignore)
+			continue;
+
+		// If it's in the 'priority' archive, exit loop
+		if (priority && tex_parent == priority)
+		{
+			best_res = tex;
+			break;
+		}
+
+		// Otherwise, if it's in a 'later' archive than the current resource, set it
+		if (archivePriority(tex_parent) <= archivePriority(best_res->parent.lock().get()))
+			best_res = tex;
+	}
+
+	if (best_res->parent.lock().get() == ignore)
+		return nullptr;
+
+	return best_res;
+}
+
+// -----------------------------------------------------------------------------
+// Emits resources_changed with any changes recorded since the last update,
+// followed by resources_updated
+// -----------------------------------------------------------------------------
+void ResourceManager::announceChanges()
+{
+	if (!changes_.empty())
+	{
+		auto changes = std::move(changes_);
+		changes_     = {};
+		signals_.resources_changed(changes);
+	}
+
+	signals_.resources_updated();
+}
+
+// -----------------------------------------------------------------------------
+// Updates resources for [entry] after a change. If [remove] is true, it is
+// removed as it was, then if [add] is true it is (re-)added as it is now
+// -----------------------------------------------------------------------------
 void ResourceManager::updateEntry(ArchiveEntry& entry, bool remove, bool add)
 {
 	auto sptr = entry.getShared();
@@ -787,7 +1127,26 @@ void ResourceManager::updateEntry(ArchiveEntry& entry, bool remove, bool add)
 	if (add)
 		addEntry(sptr);
 
-	signals_.resources_updated();
+	announceChanges();
+}
+
+// -----------------------------------------------------------------------------
+// Updates resources for a batch of entry [changes] from an archive
+// -----------------------------------------------------------------------------
+void ResourceManager::updateEntries(const Archive::EntryChanges& changes)
+{
+	for (const auto& removed : changes.removed)
+		removeEntry(removed.entry.get());
+	for (const auto& entry : changes.added)
+		addEntry(entry);
+	for (const auto& entry : changes.state_changed)
+	{
+		removeEntry(entry.get());
+		addEntry(entry);
+	}
+
+	// Only announce once for the whole batch
+	announceChanges();
 }
 
 
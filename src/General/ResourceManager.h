@@ -2,6 +2,7 @@
 
 #include "Archive/Archive.h"
 #include "Graphics/CTexture/CTexture.h"
+#include <unordered_set>
 
 namespace slade
 {
@@ -31,8 +32,8 @@ public:
 	~EntryResource() override = default;
 
 	void add(const shared_ptr<ArchiveEntry>& entry);
-	void remove(const ArchiveEntry* entry);
-	void removeArchive(const Archive* archive);
+	bool remove(const ArchiveEntry* entry);
+	bool removeArchive(const Archive* archive);
 
 	int length() const override { return entries_.size(); }
 
@@ -62,7 +63,7 @@ public:
 	~TextureResource() override = default;
 
 	void add(CTexture* tex, Archive* parent);
-	void remove(const Archive* parent);
+	bool remove(const Archive* parent);
 
 	int length() const override { return textures_.size(); }
 
@@ -70,8 +71,51 @@ private:
 	vector<unique_ptr<Texture>> textures_;
 };
 
-typedef std::map<string, EntryResource>   EntryResourceMap;
-typedef std::map<string, TextureResource> TextureResourceMap;
+// Case-insensitive hash/comparison for resource names, so resources can be
+// looked up by name without building an uppercase copy of it first
+struct ResourceNameHash
+{
+	size_t operator()(string_view name) const;
+};
+struct ResourceNameEqual
+{
+	bool operator()(string_view left, string_view right) const;
+};
+
+// Resource maps are keyed by views of names interned in the ResourceManager,
+// so lookups by string_view don't need to allocate
+template<typename T> using ResourceMap = std::unordered_map<string_view, T, ResourceNameHash, ResourceNameEqual>;
+typedef ResourceMap<EntryResource>   EntryResourceMap;
+typedef ResourceMap<TextureResource> TextureResourceMap;
+
+// Resources that were added, removed or changed in a ResourceManager update
+struct ResourceChanges
+{
+	// Names of resources of one kind that were added (first matching entry or
+	// texture), removed (last one removed) or changed
+	struct Names
+	{
+		std::set<string> added;
+		std::set<string> removed;
+		std::set<string> changed;
+
+		void add(string_view name, bool was_empty);
+		void remove(string_view name, bool now_empty);
+		bool empty() const { return added.empty() && removed.empty() && changed.empty(); }
+		bool contains(string_view name) const;
+	};
+
+	Names palettes;
+	Names patches;
+	Names flats;
+	Names textures;   // Composite textures
+	Names satextures; // Stand-alone and hi-res textures
+
+	bool empty() const
+	{
+		return palettes.empty() && patches.empty() && flats.empty() && textures.empty() && satextures.empty();
+	}
+};
 
 class ResourceManager
 {
@@ -82,19 +126,34 @@ public:
 	void addArchive(Archive* archive);
 	void removeArchive(const Archive* archive);
 
-	void addEntry(shared_ptr<ArchiveEntry>& entry);
+	void addEntry(const shared_ptr<ArchiveEntry>& entry);
 	void removeEntry(ArchiveEntry* entry, string_view entry_name = {}, bool full_check = false);
 
 	void listAllPatches() const;
 	void putAllPatchEntries(vector<ArchiveEntry*>& list, const Archive* priority, bool fullPath = false);
+	void putPatchEntries(
+		vector<ArchiveEntry*>&  list,
+		const std::set<string>& names,
+		const Archive*          priority,
+		bool                    fullPath = false);
 
 	void putAllTextures(
 		vector<TextureResource::Texture*>& list,
 		const Archive*                     priority,
 		const Archive*                     ignore = nullptr) const;
+	void putTextures(
+		vector<TextureResource::Texture*>& list,
+		const std::set<string>&            names,
+		const Archive*                     priority,
+		const Archive*                     ignore = nullptr) const;
 	void putAllTextureNames(vector<string>& list) const;
 
 	void putAllFlatEntries(vector<ArchiveEntry*>& list, const Archive* priority, bool fullPath = false);
+	void putFlatEntries(
+		vector<ArchiveEntry*>&  list,
+		const std::set<string>& names,
+		const Archive*          priority,
+		bool                    fullPath = false);
 	void putAllFlatNames(vector<string>& list) const;
 
 	ArchiveEntry* getPaletteEntry(string_view palette, const Archive* priority = nullptr);
@@ -111,11 +170,14 @@ public:
 			const Archive* priority = nullptr,
 			const Archive* ignore   = nullptr);
 	uint16_t getTextureHash(string_view name) const;
+	int      archivePriority(const Archive* archive) const;
+	size_t   memUsage() const;
 
 	// Signals
 	struct Signals
 	{
-		sigslot::signal<> resources_updated;
+		sigslot::signal<>                       resources_updated;
+		sigslot::signal<const ResourceChanges&> resources_changed; // Emitted before resources_updated
 	};
 	Signals& signals() { return signals_; }
 
@@ -135,9 +197,23 @@ private:
 	EntryResourceMap   hires_;
 	TextureResourceMap composites_; // Composite textures (defined in a TEXTUREx/TEXTURES lump)
 	Signals            signals_;
+	ResourceChanges    changes_; // Changes since the last update was announced
+
+	// Interned resource names (resource map keys are views of these)
+	std::unordered_set<string> names_;
+
+	// Cached archive load order, used to prioritise resources from later archives
+	mutable std::unordered_map<const Archive*, int> archive_priority_;
+	mutable bool                                    archive_priority_dirty_ = true;
 
 	static string doom64_hash_table_[65536];
 
+	TextureResource::Texture* bestTexture(
+		const TextureResource& res,
+		const Archive*         priority,
+		const Archive*         ignore) const;
+	void announceChanges();
 	void updateEntry(ArchiveEntry& entry, bool remove, bool add);
+	void updateEntries(const Archive::EntryChanges& changes);
 };
 } // namespace slade
@@ -0,0 +1,594 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Tasks.cpp
+// Description: Shared work-stealing task scheduler for background work.
+//              Tasks are queued by priority and run on a fixed pool of worker
+//              threads, each of which has its own queue for tasks queued from
+//              within a task (eg. parallelFor helpers) that idle workers can
+//              steal from. Task handles provide cancellation and progress
+//              reporting, and continuations are run on the UI thread
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Tasks.h"
+#include "General/Console.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+using namespace slade;
+using namespace tasks;
+
+
+// -----------------------------------------------------------------------------
+//
+// Task::State Struct
+//
+// -----------------------------------------------------------------------------
+struct Task::State
+{
+	std::atomic<bool>       cancelled{ false };
+	std::atomic<bool>       finished{ false };
+	std::atomic<bool>       progress_queued{ false }; // A progress signal is waiting to be emitted on the UI thread
+	std::mutex              mutex;
+	std::condition_variable finished_cv;
+	float                   progress = 0.f;
+	string                  message;
+	Signals                 signals;
+};
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// A queued job, called with true to run it or false if it is being dropped
+// without running (on shutdown)
+using Job = std::function<void(bool run)>;
+
+// A worker thread's own job queue. The worker takes jobs from the back, other
+// workers steal from the front
+struct WorkerQueue
+{
+	std::mutex      mutex;
+	std::deque<Job> jobs;
+};
+
+// The scheduler state. Worker threads keep a shared_ptr to it, so it outlives
+// any workers still finishing a job after shutdown
+struct Scheduler
+{
+	std::mutex                      mutex;
+	std::condition_variable         cv;
+	std::deque<Job>                 queues[3]; // By priority
+	vector<unique_ptr<WorkerQueue>> worker_queues;
+	std::atomic<unsigned>           pending{ 0 }; // Number of queued jobs (global and worker queues)
+	std::atomic<unsigned>           running{ 0 }; // Number of workers taking or running a job
+	std::condition_variable         idle_cv;      // Notified when no workers are running a job
+	std::atomic<bool>               stopping{ false };
+};
+
+shared_ptr<Scheduler> scheduler_instance;
+std::once_flag        scheduler_init;
+thread_local int      worker_index = -1; // Index of the current worker thread, -1 if not a worker
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Takes the next job to run for worker [index] (or any thread if -1) from
+// [sched], in order of preference: the worker's own queue (newest first), the
+// global queues by priority, then the oldest job in another worker's queue.
+// Returns false if there are no jobs
+// -----------------------------------------------------------------------------
+bool takeJob(Scheduler& sched, int index, Job& job)
+{
+	// Own queue
+	if (index >= 0)
+	{
+		auto&           queue = *sched.worker_queues[index];
+		std::lock_guard lock(queue.mutex);
+		if (!queue.jobs.empty())
+		{
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+			--sched.pending;
+			return true;
+		}
+	}
+
+	// Global queues
+	{
+		std::lock_guard lock(sched.mutex);
+		for (auto& queue : sched.queues)
+			if (!queue.empty())
+			{
+				job = std::move(queue.front());
+				queue.pop_front();
+				--sched.pending;
+				return true;
+			}
+	}
+
+	// Steal from other workers
+	auto n_workers = static_cast<int>(sched.worker_queues.size());
+	for (int a = 1; a <= n_workers; ++a)
+	{
+		auto other = (index + a) % n_workers;
+		if (other == index || other < 0)
+			continue;
+
+		auto&           queue = *sched.worker_queues[other];
+		std::lock_guard lock(queue.mutex);
+		if (!queue.jobs.empty())
+		{
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+			--sched.pending;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Worker thread [index] main loop
+// -----------------------------------------------------------------------------
+void workerLoop(shared_ptr<Scheduler> sched, int index)
+{
+	worker_index = index;
+
+	// Counts this worker as running from before it takes a job until after it
+	// has finished it, so shutdown can't miss a job that was just taken
+	auto job_done = [&sched]
+	{
+		if (--sched->running == 0)
+		{
+			std::lock_guard lock(sched->mutex);
+			sched->idle_cv.notify_all();
+		}
+	};
+
+	while (true)
+	{
+		Job job;
+		++sched->running;
+		if (takeJob(*sched, index, job))
+		{
+			job(true);
+			job = {};
+			job_done();
+			continue;
+		}
+		job_done();
+
+		std::unique_lock lock(sched->mutex);
+		sched->cv.wait(lock, [&] { return sched->stopping || sched->pending > 0; });
+		if (sched->stopping)
+			return;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the scheduler, starting the worker threads if needed
+// -----------------------------------------------------------------------------
+Scheduler& scheduler()
+{
+	std::call_once(
+		scheduler_init,
+		[]
+		{
+			// One worker per hardware thread, less one for the UI thread (but
+			// at least two so a long-running task can't block all others)
+			auto n_workers     = std::max(std::thread::hardware_concurrency(), 3u) - 1;
+			scheduler_instance = std::make_shared<Scheduler>();
+			for (unsigned a = 0; a < n_workers; ++a)
+				scheduler_instance->worker_queues.push_back(std::make_unique<WorkerQueue>());
+			for (unsigned a = 0; a < n_workers; ++a)
+				std::thread(workerLoop, scheduler_instance, static_cast<int>(a)).detach();
+		});
+
+	return *scheduler_instance;
+}
+
+// -----------------------------------------------------------------------------
+// Queues [job] to be run with [priority]. Jobs queued from a worker thread go
+// on that worker's own queue (regardless of priority), as they are usually
+// parts of the job it is running. If the scheduler has been shut down, [job]
+// is dropped immediately
+// -----------------------------------------------------------------------------
+void queueJob(Job job, Priority priority)
+{
+	auto& sched = scheduler();
+
+	{
+		std::unique_lock lock(sched.mutex);
+		if (sched.stopping)
+		{
+			lock.unlock();
+			job(false);
+			return;
+		}
+
+		if (worker_index < 0)
+		{
+			sched.queues[static_cast<int>(priority)].push_back(std::move(job));
+			++sched.pending;
+		}
+	}
+
+	if (worker_index >= 0)
+	{
+		{
+			auto&           queue = *sched.worker_queues[worker_index];
+			std::lock_guard lock(queue.mutex);
+			queue.jobs.push_back(std::move(job));
+			++sched.pending;
+		}
+
+		// Sync with any worker about to wait, so it can't miss the notification
+		std::lock_guard lock(sched.mutex);
+	}
+
+	sched.cv.notify_one();
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Task Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Task class constructor
+// -----------------------------------------------------------------------------
+Task::Task() : state_{ std::make_shared<State>() } {}
+
+// -----------------------------------------------------------------------------
+// Returns true if the task has been cancelled, or the scheduler is shutting
+// down (see tasks::shutdown)
+// -----------------------------------------------------------------------------
+bool Task::isCancelled() const
+{
+	return state_->cancelled.load(std::memory_order_relaxed)
+		   || (scheduler_instance && scheduler_instance->stopping.load(std::memory_order_relaxed));
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the task has finished running (or was cancelled or dropped
+// before it started)
+// -----------------------------------------------------------------------------
+bool Task::isFinished() const
+{
+	return state_->finished;
+}
+
+// -----------------------------------------------------------------------------
+// Requests cancellation of the task. If it hasn't started yet it won't be run,
+// otherwise it's up to the task function to check isCancelled()
+// -----------------------------------------------------------------------------
+void Task::cancel() const
+{
+	state_->cancelled = true;
+}
+
+// -----------------------------------------------------------------------------
+// Blocks until the task has finished. If called from a worker thread, other
+// queued jobs are run while waiting so the workers can't all end up blocked
+// -----------------------------------------------------------------------------
+void Task::wait() const
+{
+	while (!state_->finished)
+	{
+		Job job;
+		if (worker_index >= 0 && takeJob(scheduler(), worker_index, job))
+		{
+			job(true);
+			continue;
+		}
+
+		std::unique_lock lock(state_->mutex);
+		state_->finished_cv.wait_for(lock, std::chrono::milliseconds(10), [this] { return state_->finished.load(); });
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the last progress (0-1) reported by the task
+// -----------------------------------------------------------------------------
+float Task::progress() const
+{
+	std::lock_guard lock(state_->mutex);
+	return state_->progress;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the last progress message reported by the task
+// -----------------------------------------------------------------------------
+string Task::message() const
+{
+	std::lock_guard lock(state_->mutex);
+	return state_->message;
+}
+
+// -----------------------------------------------------------------------------
+// Reports the task's [progress] (0-1) and [message] (if not empty). The
+// progress signal is emitted on the UI thread, at most once per UI event loop
+// iteration however often this is called
+// -----------------------------------------------------------------------------
+void Task::setProgress(float progress, string_view message) const
+{
+	{
+		std::lock_guard lock(state_->mutex);
+		state_->progress = progress;
+		if (!message.empty())
+			state_->message = message;
+	}
+
+	if (state_->progress_queued.exchange(true))
+		return;
+
+	callOnUIThread(
+		[state = state_]
+		{
+			state->progress_queued = false;
+
+			float  progress;
+			string message;
+			{
+				std::lock_guard lock(state->mutex);
+				progress = state->progress;
+				message  = state->message;
+			}
+			state->signals.progress(progress, message);
+		});
+}
+
+// -----------------------------------------------------------------------------
+// Returns the task's signals
+// -----------------------------------------------------------------------------
+Task::Signals& Task::signals() const
+{
+	return state_->signals;
+}
+
+// -----------------------------------------------------------------------------
+// Marks the task as finished and queues [then] (if given) and the finished
+// signal to run on the UI thread
+// -----------------------------------------------------------------------------
+void Task::finish(const ContinuationFunc& then) const
+{
+	{
+		std::lock_guard lock(state_->mutex);
+		state_->finished = true;
+	}
+	state_->finished_cv.notify_all();
+
+	callOnUIThread(
+		[task = *this, then]() mutable
+		{
+			if (then)
+				then(task);
+			task.signals().finished(task.isCancelled());
+		});
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Tasks Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Queues [func] to be run on a worker thread with [priority]. When it has
+// finished, [then] (if given) is called with the task on the UI thread.
+// If the task is dropped without running (on shutdown) it is cancelled, but
+// still finished as normal.
+// Returns a handle to the task
+// -----------------------------------------------------------------------------
+Task tasks::run(TaskFunc func, Priority priority, ContinuationFunc then)
+{
+	Task task;
+	queueJob(
+		[task, func = std::move(func), then = std::move(then)](bool run) mutable
+		{
+			if (!run)
+				task.cancel();
+			else if (!task.isCancelled())
+				func(task);
+			task.finish(then);
+		},
+		priority);
+
+	return task;
+}
+
+// -----------------------------------------------------------------------------
+// Calls [func] for each index in [begin, end) in parallel
+// -----------------------------------------------------------------------------
+void tasks::parallelFor(
+	unsigned                             begin,
+	unsigned                             end,
+	const std::function<void(unsigned)>& func,
+	unsigned                             grain,
+	const Task*                          task)
+{
+	if (end <= begin)
+		return;
+
+	grain         = std::max(grain, 1u);
+	auto n_chunks = (end - begin + grain - 1) / grain;
+
+	// Just run here if there is only one chunk
+	if (n_chunks == 1)
+	{
+		for (auto a = begin; a < end; ++a)
+			func(a);
+		return;
+	}
+
+	// Shared by the helper jobs, which may start after this function has
+	// returned (in which case there will be no chunks left for them)
+	struct Chunks
+	{
+		std::atomic<unsigned>   next{ 0 };
+		std::atomic<unsigned>   done{ 0 };
+		std::mutex              mutex;
+		std::condition_variable cv;
+	};
+	auto chunks = std::make_shared<Chunks>();
+
+	auto process = [chunks, n_chunks, begin, end, grain, &func, task](bool run = true)
+	{
+		// Dropped helpers can leave their chunks to the other threads
+		if (!run)
+			return;
+
+		for (auto c = chunks->next++; c < n_chunks; c = chunks->next++)
+		{
+			if (!task || !task->isCancelled())
+			{
+				auto start = begin + c * grain;
+				auto stop  = std::min(start + grain, end);
+				for (auto a = start; a < stop; ++a)
+					func(a);
+			}
+
+			if (++chunks->done == n_chunks)
+			{
+				std::lock_guard lock(chunks->mutex);
+				chunks->cv.notify_all();
+			}
+		}
+	};
+
+	// Queue helpers and process chunks on this thread too
+	auto n_helpers = std::min(numWorkers(), n_chunks - 1);
+	for (unsigned a = 0; a < n_helpers; ++a)
+		queueJob(process, Priority::High);
+	process();
+
+	// Wait for chunks being processed by helpers
+	std::unique_lock lock(chunks->mutex);
+	chunks->cv.wait(lock, [&] { return chunks->done == n_chunks; });
+}
+
+// -----------------------------------------------------------------------------
+// Queues [func] to be called on the UI thread (via the wx event loop)
+// -----------------------------------------------------------------------------
+void tasks::callOnUIThread(std::function<void()> func)
+{
+	if (wxTheApp)
+		wxTheApp->CallAfter(std::move(func));
+	else
+		func();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of worker threads
+// -----------------------------------------------------------------------------
+unsigned tasks::numWorkers()
+{
+	return scheduler().worker_queues.size();
+}
+
+// -----------------------------------------------------------------------------
+// Stops the scheduler: all tasks are cancelled (see Task::isCancelled), queued
+// jobs are dropped (tasks are finished without running) and this waits until
+// the worker threads have finished their current jobs. Any jobs queued
+// afterwards are dropped too (parallelFor will run everything on the calling
+// thread).
+// Must be called from the UI thread
+// -----------------------------------------------------------------------------
+void tasks::shutdown()
+{
+	auto& sched = scheduler();
+
+	// Take all queued jobs
+	std::deque<Job> dropped;
+	{
+		std::lock_guard lock(sched.mutex);
+		sched.stopping = true;
+		for (auto& queue : sched.queues)
+		{
+			for (auto& job : queue)
+				dropped.push_back(std::move(job));
+			queue.clear();
+		}
+	}
+	for (auto& queue : sched.worker_queues)
+	{
+		std::lock_guard lock(queue->mutex);
+		for (auto& job : queue->jobs)
+			dropped.push_back(std::move(job));
+		queue->jobs.clear();
+	}
+	sched.pending = 0;
+	sched.cv.notify_all();
+
+	// Drop them
+	for (auto& job : dropped)
+		job(false);
+
+	// Wait for running jobs to finish
+	std::unique_lock lock(sched.mutex);
+	sched.idle_cv.wait(lock, [&sched] { return sched.running == 0; });
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Shows the number of task worker threads and queued jobs
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(tasks, 0, false)
+{
+	auto& sched = scheduler();
+	log::console(fmt::format("{} task worker threads, {} queued jobs", tasks::numWorkers(), sched.pending.load()));
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <type_traits>
+
+namespace slade::tasks
+{
+enum class Priority
+{
+	High,   // Work something is waiting on (eg. parallelFor helpers)
+	Normal, // General background work
+	Low,    // Work that can wait (eg. loading base resource definitions)
+};
+
+class Task;
+using TaskFunc         = std::function<void(Task& task)>;
+using ContinuationFunc = std::function<void(Task& task)>;
+
+Task run(TaskFunc func, Priority priority = Priority::Normal, ContinuationFunc then = {});
+
+// A handle to a task queued via run(), shared between the task function and
+// whatever queued it. Acts as the task's cancellation token and progress
+// report: the task function should check isCancelled() periodically and can
+// report progress via setProgress(). The task's signals are always emitted on
+// the UI thread, so UI can connect to them directly
+class Task
+{
+public:
+	struct Signals
+	{
+		sigslot::signal<float, const string&> progress; // Progress (0-1) and message
+		sigslot::signal<bool>                 finished; // Emitted with true if the task was cancelled
+	};
+
+	Task();
+	~Task() = default;
+
+	bool isCancelled() const;
+	bool isFinished() const;
+	void cancel() const;
+	void wait() const;
+
+	float    progress() const;
+	string   message() const;
+	void     setProgress(float progress, string_view message = {}) const;
+	Signals& signals() const;
+
+private:
+	struct State;
+	shared_ptr<State> state_;
+
+	void finish(const ContinuationFunc& then) const;
+
+	friend Task run(TaskFunc func, Priority priority, ContinuationFunc then);
+};
+
+// Calls [func] for each index in [begin, end), spread over the worker threads
+// and the calling thread, in chunks of [grain] indices. Returns when all
+// indices have been processed. If [task] is given, remaining chunks are
+// skipped once it is cancelled. Safe to call from within another task
+void parallelFor(
+	unsigned                             begin,
+	unsigned                             end,
+	const std::function<void(unsigned)>& func,
+	unsigned                             grain = 1,
+	const Task*                          task  = nullptr);
+
+// Returns a vector of the results of calling [func] on each of [items], which
+// are processed in parallel (see parallelFor)
+template<typename T, typename F> auto parallelMap(const vector<T>& items, F&& func, const Task* task = nullptr)
+{
+	vector<std::decay_t<std::invoke_result_t<F&, const T&>>> results(items.size());
+	parallelFor(0, items.size(), [&](unsigned index) { results[index] = func(items[index]); }, 1, task);
+	return results;
+}
+
+void     callOnUIThread(std::function<void()> func);
+unsigned numWorkers();
+void     shutdown();
+
+// A queue of jobs run on the task workers, for background work that decides
+// its own order (eg. most recently requested first) or drops jobs that haven't
+// started yet. Each job pushed queues a task (see run) that takes whichever
+// job is next in this queue when it starts.
+// [work] is called with each job on a worker thread, and [finish] (if given)
+// with the same job on the UI thread afterwards, unless the queue has been
+// destroyed by then. Neither should access the queue's owner or anything else
+// that may be gone by the time they're called (other than [finish] checking
+// the owner via the job)
+template<typename Job> class JobQueue
+{
+public:
+	using JobFunc = std::function<void(Job& job)>;
+
+	explicit JobQueue(JobFunc work, JobFunc finish = {}, Priority priority = Priority::Normal) :
+		state_{ std::make_shared<State>() }
+	{
+		state_->work     = std::move(work);
+		state_->finish   = std::move(finish);
+		state_->priority = priority;
+	}
+
+	~JobQueue()
+	{
+		state_->destroyed = true;
+		takeQueued();
+	}
+
+	// Non-copyable
+	JobQueue(const JobQueue&)            = delete;
+	JobQueue& operator=(const JobQueue&) = delete;
+
+	// Adds [job] to the end of the queue, or the front if [next] is true
+	void push(shared_ptr<Job> job, bool next = false)
+	{
+		{
+			std::lock_guard lock(state_->mutex);
+			if (next)
+				state_->jobs.push_front(std::move(job));
+			else
+				state_->jobs.push_back(std::move(job));
+		}
+
+		run(
+			[state = state_](Task&)
+			{
+				shared_ptr<Job> job;
+				{
+					std::lock_guard lock(state->mutex);
+					if (state->jobs.empty())
+						return; // Taken by an earlier task or dropped
+					job = std::move(state->jobs.front());
+					state->jobs.pop_front();
+				}
+
+				state->work(*job);
+
+				if (state->finish)
+					callOnUIThread(
+						[state, job]
+						{
+							if (!state->destroyed)
+								state->finish(*job);
+						});
+			},
+			state_->priority);
+	}
+
+	// Removes all jobs that haven't been started yet from the queue, and
+	// returns them
+	std::deque<shared_ptr<Job>> takeQueued()
+	{
+		std::deque<shared_ptr<Job>> jobs;
+		std::lock_guard             lock(state_->mutex);
+		jobs.swap(state_->jobs);
+		return jobs;
+	}
+
+private:
+	struct State
+	{
+		std::mutex                  mutex;
+		std::deque<shared_ptr<Job>> jobs;
+		JobFunc                     work;
+		JobFunc                     finish;
+		Priority                    priority  = Priority::Normal;
+		bool                        destroyed = false; // Only accessed on the UI thread
+	};
+
+	shared_ptr<State> state_;
+};
+} // namespace slade::tasks
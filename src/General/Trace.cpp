@@ -0,0 +1,220 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Trace.cpp
+// Description: Lightweight timing instrumentation. Zones (see TRACE_ZONE) are
+//              recorded while a capture is active, and written out in Chrome
+//              trace event format (viewable in chrome://tracing or Perfetto)
+//              when it is stopped
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Trace.h"
+#include "App.h"
+#include "General/Console.h"
+#include "Utility/StringUtils.h"
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace slade::trace
+{
+// A completed zone
+struct Event
+{
+	const char* name;
+	string      detail;
+	unsigned    thread;
+	int64_t     start;
+	int64_t     duration;
+};
+
+std::mutex                            events_mutex;
+vector<Event>                         events;
+std::map<std::thread::id, unsigned>   thread_ids; // Small ids for threads, in order of first use
+std::chrono::steady_clock::time_point capture_start;
+} // namespace slade::trace
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the number of microseconds since the current capture was started
+// -----------------------------------------------------------------------------
+int64_t captureTime()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+			   std::chrono::steady_clock::now() - trace::capture_start)
+		.count();
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Zone Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Begins timing the zone, with optional [detail] text (eg. a filename)
+// -----------------------------------------------------------------------------
+void trace::Zone::begin(string_view detail)
+{
+	detail_ = detail;
+	start_  = captureTime();
+}
+
+// -----------------------------------------------------------------------------
+// Finishes timing the zone and adds it to the current capture (if it is still
+// active)
+// -----------------------------------------------------------------------------
+void trace::Zone::end() const
+{
+	auto end = captureTime();
+
+	std::lock_guard lock(events_mutex);
+	if (!isCapturing())
+		return;
+
+	auto thread = thread_ids.try_emplace(std::this_thread::get_id(), thread_ids.size()).first->second;
+	events.push_back({ name_, detail_, thread, start_, end - start_ });
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Trace Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Starts a new trace capture, discarding any current one
+// -----------------------------------------------------------------------------
+void trace::startCapture()
+{
+	std::lock_guard lock(events_mutex);
+	events.clear();
+	thread_ids.clear();
+	capture_start = std::chrono::steady_clock::now();
+	capturing     = true;
+}
+
+// -----------------------------------------------------------------------------
+// Stops the current trace capture and writes it to [filename] in Chrome trace
+// event (JSON) format. Returns the number of zones written
+// -----------------------------------------------------------------------------
+unsigned trace::stopCapture(string_view filename)
+{
+	vector<Event> captured;
+	{
+		std::lock_guard lock(events_mutex);
+		capturing = false;
+		captured.swap(events);
+	}
+
+	std::ofstream file{ string{ filename } };
+	if (!file.is_open())
+	{
+		log::error("Unable to open trace file \"{}\" for writing", filename);
+		return 0;
+	}
+
+	file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+	for (unsigned a = 0; a < captured.size(); ++a)
+	{
+		const auto& event = captured[a];
+		file << fmt::format(
+			"{{\"name\": \"{}\", \"cat\": \"slade\", \"ph\": \"X\", \"pid\": 1, \"tid\": {}, \"ts\": {}, \"dur\": {}",
+			event.name,
+			event.thread,
+			event.start,
+			event.duration);
+		if (!event.detail.empty())
+			file << fmt::format(", \"args\": {{\"detail\": \"{}\"}}", strutil::escapedString(event.detail));
+		file << (a + 1 < captured.size() ? "},\n" : "}\n");
+	}
+	file << "]}\n";
+
+	return captured.size();
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Starts or stops a trace capture:
+// trace start
+// trace stop [filename]
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(trace, 1, true)
+{
+#ifdef NO_TRACE
+	log::console("Tracing is disabled in this build");
+#else
+	if (strutil::equalCI(args[0], "start"))
+	{
+		trace::startCapture();
+		log::console("Trace capture started");
+	}
+	else if (strutil::equalCI(args[0], "stop"))
+	{
+		if (!trace::isCapturing())
+		{
+			log::console("No trace capture is active");
+			return;
+		}
+
+		auto filename = args.size() > 1 ? args[1] : app::path("slade3_trace.json", app::Dir::User);
+		auto n_zones  = trace::stopCapture(filename);
+		log::console(fmt::format("Trace capture stopped, {} zones written to \"{}\"", n_zones, filename));
+	}
+	else
+		log::console("Usage: trace start|stop [filename]");
+#endif
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+
+namespace slade::trace
+{
+inline std::atomic<bool> capturing{ false };
+
+inline bool isCapturing()
+{
+#ifdef NO_TRACE
+	return false;
+#else
+	return capturing.load(std::memory_order_relaxed);
+#endif
+}
+
+void     startCapture();
+unsigned stopCapture(string_view filename);
+
+// Records the time between its construction and destruction as a zone named
+// [name] (which must be a string literal) in the current trace capture, if
+// there is one. Use via the TRACE_ZONE macro so that it is compiled out when
+// NO_TRACE is defined
+class Zone
+{
+public:
+	Zone(const char* name, string_view detail = {}) : name_{ name }
+	{
+		if (isCapturing())
+			begin(detail);
+	}
+	~Zone()
+	{
+		if (start_ >= 0)
+			end();
+	}
+
+	// Non-copyable
+	Zone(const Zone&)            = delete;
+	Zone& operator=(const Zone&) = delete;
+
+private:
+	const char* name_;
+	string      detail_;
+	int64_t     start_ = -1; // Microseconds since the capture started, -1 if not capturing
+
+	void begin(string_view detail);
+	void end() const;
+};
+} // namespace slade::trace
+
+#ifdef NO_TRACE
+#define TRACE_ZONE(...)
+#else
+#define TRACE_ZONE_NAME2(line) trace_zone_##line
+#define TRACE_ZONE_NAME(line)  TRACE_ZONE_NAME2(line)
+#define TRACE_ZONE(...)        slade::trace::Zone TRACE_ZONE_NAME(__LINE__)(__VA_ARGS__)
+#endif
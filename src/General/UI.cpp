@@ -49,6 +49,11 @@ namespace slade::ui
 unique_ptr<SplashWindow> splash_window;
 bool                     splash_enabled = true;
 
+// Background progress for the current thread
+thread_local ProgressHandler thread_progress_handler;
+thread_local string          thread_progress_message;
+thread_local float           thread_progress = -1.0f;
+
 // Pixel sizes/scale
 double scale = 1.;
 int    px_pad_small;
@@ -169,7 +174,17 @@ void ui::setSplashMessage(string_view message)
 // -----------------------------------------------------------------------------
 void ui::setSplashProgressMessage(string_view message)
 {
-	if (splash_window && isMainThread())
+	if (!isMainThread())
+	{
+		if (thread_progress_handler)
+		{
+			thread_progress_message = message;
+			thread_progress_handler(thread_progress_message, thread_progress);
+		}
+		return;
+	}
+
+	if (splash_window)
 		splash_window->setProgressMessage(wxString{ message.data(), message.size() });
 }
 
@@ -178,10 +193,31 @@ void ui::setSplashProgressMessage(string_view message)
 // -----------------------------------------------------------------------------
 void ui::setSplashProgress(float progress)
 {
-	if (splash_window && isMainThread())
+	if (!isMainThread())
+	{
+		if (thread_progress_handler)
+		{
+			thread_progress = progress;
+			thread_progress_handler(thread_progress_message, thread_progress);
+		}
+		return;
+	}
+
+	if (splash_window)
 		splash_window->setProgress(progress);
 }
 
+// -----------------------------------------------------------------------------
+// Sets the [handler] to receive splash progress updates made from the current
+// (non-main) thread. Set to an empty handler to stop receiving updates
+// -----------------------------------------------------------------------------
+void ui::setThreadProgressHandler(ProgressHandler handler)
+{
+	thread_progress_handler = std::move(handler);
+	thread_progress_message.clear();
+	thread_progress = -1.0f;
+}
+
 // -----------------------------------------------------------------------------
 // Sets the mouse cursor for [window]
 // -----------------------------------------------------------------------------
@@ -15,6 +15,11 @@ void  setSplashMessage(string_view message);
 void  setSplashProgressMessage(string_view message);
 void  setSplashProgress(float progress);
 
+// Background progress (splash progress updates from a worker thread are sent
+// to the handler set for that thread, if any)
+typedef std::function<void(string_view message, float progress)> ProgressHandler;
+void setThreadProgressHandler(ProgressHandler handler);
+
 // Mouse Cursor
 enum class MouseCursor
 {
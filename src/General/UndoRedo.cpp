@@ -31,6 +31,10 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "General/UndoRedo.h"
+#include "App.h"
+#include "General/MemoryStats.h"
+#include <filesystem>
+#include <fstream>
 
 using namespace slade;
 
@@ -43,8 +47,12 @@ using namespace slade;
 namespace
 {
 UndoManager* current_undo_manager = nullptr;
+unsigned     n_undo_files         = 0;
 } // namespace
 
+CVAR(Int, undo_memory_limit, 512, CVar::Flag::Save)
+CVAR(Int, undo_levels_in_memory, 0, CVar::Flag::Save)
+
 
 // -----------------------------------------------------------------------------
 //
@@ -58,6 +66,23 @@ UndoManager* current_undo_manager = nullptr;
 // -----------------------------------------------------------------------------
 UndoLevel::UndoLevel(string_view name) : name_{ name }, timestamp_{ wxDateTime::Now() } {}
 
+// -----------------------------------------------------------------------------
+// UndoLevel class destructor
+// -----------------------------------------------------------------------------
+UndoLevel::~UndoLevel()
+{
+	// Wait for any unloading in progress and remove the file
+	if (unloading_.valid())
+		unloading_.wait();
+	if (!file_.empty())
+	{
+		std::error_code error;
+		std::filesystem::remove(file_, error);
+	}
+
+	memstats::freed(memstats::Category::UndoHistory, mem_counted_);
+}
+
 // -----------------------------------------------------------------------------
 // Returns a string representation of the time at which the undo level was
 // recorded
@@ -72,6 +97,22 @@ string UndoLevel::timeStamp(bool date, bool time) const
 		return timestamp_.FormatISOCombined().ToStdString();
 }
 
+// -----------------------------------------------------------------------------
+// Lets all undo steps know recording has ended, and updates the level's memory
+// usage
+// -----------------------------------------------------------------------------
+void UndoLevel::recordEnded()
+{
+	mem_usage_ = 0;
+	for (auto& undo_step : undo_steps_)
+	{
+		undo_step->recordEnded();
+		mem_usage_ += undo_step->memUsage();
+	}
+
+	updateMemStats();
+}
+
 // -----------------------------------------------------------------------------
 // Performs all undo steps for this level
 // -----------------------------------------------------------------------------
@@ -109,6 +150,24 @@ bool UndoLevel::doRedo()
 // -----------------------------------------------------------------------------
 bool UndoLevel::readFile(string_view filename) const
 {
+	MemChunk mc;
+	if (!mc.importFile(filename))
+		return false;
+
+	MemChunk step_data;
+	for (auto& undo_step : undo_steps_)
+	{
+		uint32_t size = 0;
+		if (!mc.read(&size, sizeof(size)) || mc.currentPos() + size > mc.size())
+			return false;
+
+		step_data.importMem(mc.data() + mc.currentPos(), size);
+		step_data.seekFromStart(0);
+		mc.seek(size);
+		if (!undo_step->readFile(step_data))
+			return false;
+	}
+
 	return true;
 }
 
@@ -117,7 +176,25 @@ bool UndoLevel::readFile(string_view filename) const
 // -----------------------------------------------------------------------------
 bool UndoLevel::writeFile(string_view filename) const
 {
-	return true;
+	// (This can be called from a background thread by unloadToFile, so no
+	// logging here)
+	std::ofstream file(string{ filename }, std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	for (auto& undo_step : undo_steps_)
+	{
+		MemChunk step_data;
+		if (!undo_step->writeFile(step_data))
+			return false;
+
+		uint32_t size = step_data.size();
+		file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		if (size > 0)
+			file.write(reinterpret_cast<const char*>(step_data.data()), size);
+	}
+
+	return file.good();
 }
 
 // -----------------------------------------------------------------------------
@@ -127,13 +204,90 @@ void UndoLevel::createMerged(vector<unique_ptr<UndoLevel>>& levels)
 {
 	for (auto& level : levels)
 	{
+		level->load();
 		for (auto& undo_step : level->undo_steps_)
 		{
 			auto ptr = undo_step.release();
 			undo_steps_.emplace_back(ptr);
 		}
 		level->undo_steps_.clear();
+
+		mem_usage_ += level->mem_usage_;
+		level->mem_usage_ = 0;
+		level->updateMemStats();
 	}
+
+	updateMemStats();
+}
+
+
+// -----------------------------------------------------------------------------
+// Writes the level's data to [filename] and frees it from memory, on a
+// background thread. The level must not be used until load() is called
+// -----------------------------------------------------------------------------
+void UndoLevel::unloadToFile(string_view filename)
+{
+	if (!isLoaded())
+		return;
+
+	file_      = filename;
+	unloading_ = std::async(
+		std::launch::async,
+		[this]()
+		{
+			if (!writeFile(file_))
+				return false;
+
+			for (auto& undo_step : undo_steps_)
+				undo_step->unload();
+
+			return true;
+		});
+
+	// The level's data no longer counts as being in memory once unloading has
+	// started (see memUsage)
+	updateMemStats();
+}
+
+// -----------------------------------------------------------------------------
+// Restores the level's data if it was unloaded with unloadToFile.
+// Returns false if the data couldn't be read back
+// -----------------------------------------------------------------------------
+bool UndoLevel::load()
+{
+	if (unloading_.valid())
+		unloaded_ = unloading_.get();
+
+	if (!unloaded_)
+	{
+		updateMemStats();
+		return true;
+	}
+
+	if (!readFile(file_))
+	{
+		log::error("Unable to read undo level \"{}\" from \"{}\"", name_, file_);
+		return false;
+	}
+
+	unloaded_ = false;
+	std::error_code error;
+	std::filesystem::remove(file_, error);
+	file_.clear();
+	updateMemStats();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Updates the amount of memory counted for the level in memstats to its
+// current memory usage
+// -----------------------------------------------------------------------------
+void UndoLevel::updateMemStats()
+{
+	memstats::freed(memstats::Category::UndoHistory, mem_counted_);
+	mem_counted_ = memUsage();
+	memstats::allocated(memstats::Category::UndoHistory, mem_counted_);
 }
 
 
@@ -191,9 +345,12 @@ void UndoManager::endRecord(bool success)
 
 	// Add current level to levels
 	// log::info(1, "Recording undo level \"%s\" succeeded", current_level->getName());
+	current_level_->recordEnded();
 	undo_levels_.push_back(std::move(current_level_));
 	current_level_.reset(nullptr);
 	current_level_index_ = undo_levels_.size() - 1;
+	applyMemoryLimit();
+	unloadOldLevels();
 
 	// Clear current undo manager
 	current_undo_manager = nullptr;
@@ -241,10 +398,14 @@ string UndoManager::undo()
 	if (current_level_index_ < 0)
 		return "";
 
+	// Reload level if it was unloaded
+	auto& level = undo_levels_[current_level_index_];
+	if (!level->load())
+		return "";
+
 	// Perform undo level
 	undo_running_        = true;
 	current_undo_manager = this;
-	auto& level          = undo_levels_[current_level_index_];
 	if (!level->doUndo())
 		log::warning("Undo operation \"{}\" failed", level->name());
 	undo_running_        = false;
@@ -269,11 +430,15 @@ string UndoManager::redo()
 	if (current_level_index_ == (int)undo_levels_.size() - 1 || undo_levels_.empty())
 		return "";
 
+	// Reload level if it was unloaded
+	auto& level = undo_levels_[current_level_index_ + 1];
+	if (!level->load())
+		return "";
+
 	// Perform redo level
 	current_level_index_++;
 	undo_running_        = true;
 	current_undo_manager = this;
-	auto& level          = undo_levels_[current_level_index_];
 	level->doRedo();
 	undo_running_        = false;
 	current_undo_manager = nullptr;
@@ -293,11 +458,12 @@ void UndoManager::putAllLevels(vector<string>& list)
 }
 
 // -----------------------------------------------------------------------------
-// Clears all undo levels up to the last reset point
+// Clears all undo levels up to the last reset point (or all levels if the
+// reset point level has been removed, see applyMemoryLimit)
 // -----------------------------------------------------------------------------
 void UndoManager::clearToResetPoint()
 {
-	while (current_level_index_ > reset_point_)
+	while (current_level_index_ > reset_point_ && !undo_levels_.empty())
 	{
 		undo_levels_.pop_back();
 		current_level_index_--;
@@ -337,10 +503,62 @@ bool UndoManager::createMergedLevel(UndoManager* manager, string_view name)
 	undo_levels_.push_back(std::move(merged));
 	current_level_.reset(nullptr);
 	current_level_index_ = undo_levels_.size() - 1;
+	applyMemoryLimit();
 
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Removes the oldest undo levels until the total memory used by all levels is
+// within the undo_memory_limit cvar (in MB, 0 for no limit). The current level
+// is always kept. If the reset point level is removed, the reset point is
+// invalidated rather than moved to the oldest remaining level
+// -----------------------------------------------------------------------------
+void UndoManager::applyMemoryLimit()
+{
+	if (undo_memory_limit <= 0)
+		return;
+
+	const auto limit = static_cast<size_t>(undo_memory_limit) * 1024 * 1024;
+	size_t     total = 0;
+	for (auto& level : undo_levels_)
+		total += level->memUsage();
+
+	unsigned n_remove = 0;
+	while (total > limit && static_cast<int>(n_remove) < current_level_index_)
+		total -= undo_levels_[n_remove++]->memUsage();
+
+	if (n_remove == 0)
+		return;
+
+	log::warning(
+		"Undo memory limit ({}MB) reached, removed the {} oldest undo level{}",
+		undo_memory_limit,
+		n_remove,
+		n_remove == 1 ? "" : "s");
+	undo_levels_.erase(undo_levels_.begin(), undo_levels_.begin() + n_remove);
+	current_level_index_ -= n_remove;
+	if (reset_point_ >= static_cast<int>(n_remove))
+		reset_point_ -= n_remove;
+	else if (reset_point_ >= 0)
+		reset_point_ = RESET_POINT_REMOVED;
+}
+
+// -----------------------------------------------------------------------------
+// Unloads all but the most recent undo levels to temp files, if the
+// undo_levels_in_memory cvar is set (0 keeps all levels in memory). Unloaded
+// levels are reloaded when they are undone
+// -----------------------------------------------------------------------------
+void UndoManager::unloadOldLevels()
+{
+	if (undo_levels_in_memory <= 0)
+		return;
+
+	for (int a = 0; a <= current_level_index_ - undo_levels_in_memory; ++a)
+		if (undo_levels_[a]->isLoaded())
+			undo_levels_[a]->unloadToFile(app::path(fmt::format("undo{}.tmp", ++n_undo_files), app::Dir::Temp));
+}
+
 
 // -----------------------------------------------------------------------------
 //
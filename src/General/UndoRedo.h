@@ -1,5 +1,7 @@
 #pragma once
 
+#include <future>
+
 namespace slade
 {
 class UndoStep
@@ -13,28 +15,52 @@ public:
 	virtual bool writeFile(MemChunk& mc) { return true; }
 	virtual bool readFile(MemChunk& mc) { return true; }
 	virtual bool isOk() { return true; }
+
+	// Frees the step's data after it has been written with writeFile, it will
+	// be restored with readFile before the step is used again
+	virtual void unload() {}
+
+	// Called when recording of the undo level containing this step has ended
+	virtual void recordEnded() {}
+
+	// Returns the (approximate) amount of memory used by this step, in bytes
+	virtual size_t memUsage() const { return 0; }
 };
 
 class UndoLevel
 {
 public:
 	UndoLevel(string_view name);
-	~UndoLevel() = default;
+	~UndoLevel();
 
 	string name() const { return name_; }
+	size_t memUsage() const { return isLoaded() ? mem_usage_ : 0; }
+	bool   isLoaded() const { return !unloaded_ && !unloading_.valid(); }
 	bool   doUndo();
 	bool   doRedo();
 	void   addStep(unique_ptr<UndoStep> step) { undo_steps_.push_back(std::move(step)); }
 	string timeStamp(bool date, bool time) const;
+	void   recordEnded();
 
 	bool writeFile(string_view filename) const;
 	bool readFile(string_view filename) const;
 	void createMerged(vector<unique_ptr<UndoLevel>>& levels);
+	void unloadToFile(string_view filename);
+	bool load();
 
 private:
 	string                       name_;
 	vector<unique_ptr<UndoStep>> undo_steps_;
 	wxDateTime                   timestamp_;
+	size_t                       mem_usage_   = 0;
+	size_t                       mem_counted_ = 0; // Amount currently counted in memstats
+
+	// Unloading (see unloadToFile)
+	string            file_;
+	std::future<bool> unloading_;
+	bool              unloaded_ = false;
+
+	void updateMemStats();
 };
 
 class SLADEMap;
@@ -72,6 +98,9 @@ public:
 	Signals& signals() { return signals_; }
 
 private:
+	// Reset point value once the level it was set at has been removed
+	static constexpr int RESET_POINT_REMOVED = -2;
+
 	vector<unique_ptr<UndoLevel>> undo_levels_;
 	unique_ptr<UndoLevel>         current_level_;
 	int                           current_level_index_ = -1;
@@ -79,6 +108,9 @@ private:
 	bool                          undo_running_        = false;
 	SLADEMap*                     map_                 = nullptr;
 	Signals                       signals_;
+
+	void applyMemoryLimit();
+	void unloadOldLevels();
 };
 
 namespace undoredo
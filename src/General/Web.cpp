@@ -31,8 +31,8 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "Web.h"
+#include "General/Tasks.h"
 #include <SFML/Network.hpp>
-#include <thread>
 
 using namespace slade;
 
@@ -73,12 +73,12 @@ string web::getHttp(const string& host, const string& uri)
 // -----------------------------------------------------------------------------
 void web::getHttpAsync(const string& host, const string& uri, wxEvtHandler* event_handler)
 {
-	std::thread thread([=]() {
-		// Queue wx event with http request response
-		auto event = new wxThreadEvent(wxEVT_THREAD_WEBGET_COMPLETED);
-		event->SetString(getHttp(host, uri));
-		wxQueueEvent(event_handler, event);
-	});
-
-	thread.detach();
+	tasks::run(
+		[=](tasks::Task&)
+		{
+			// Queue wx event with http request response
+			auto event = new wxThreadEvent(wxEVT_THREAD_WEBGET_COMPLETED);
+			event->SetString(getHttp(host, uri));
+			wxQueueEvent(event_handler, event);
+		});
 }
@@ -33,8 +33,10 @@
 #include "Main.h"
 #include "CTexture.h"
 #include "App.h"
+#include "CompositeCache.h"
 #include "General/Misc.h"
 #include "General/ResourceManager.h"
+#include "Graphics/Palette/Palette.h"
 #include "Graphics/SImage/SImage.h"
 #include "TextureXList.h"
 #include "Utility/StringUtils.h"
@@ -149,7 +151,7 @@ bool CTPatchEx::parse(Tokenizer& tz, Type type)
 {
 	// Read basic info
 	type_ = type;
-	name_ = strutil::upper(tz.next().text);
+	name_ = strutil::upper(tz.next().view());
 	tz.adv(); // Skip ,
 	offset_.x = tz.next().asInt();
 	tz.adv(); // Skip ,
@@ -182,14 +184,14 @@ bool CTPatchEx::parse(Tokenizer& tz, Type type)
 			{
 				// Build translation string
 				string translate;
-				string temp = tz.next().text;
+				string temp{ tz.next().view() };
 				if (strutil::contains(temp, '='))
 					temp = fmt::format("\"{}\"", temp);
 				translate += temp;
 				while (tz.checkNext(","))
 				{
-					translate += tz.next().text; // add ','
-					temp = tz.next().text;
+					translate += tz.next().view(); // add ','
+					temp = tz.next().view();
 					if (strutil::contains(temp, '='))
 						temp = fmt::format("\"{}\"", temp);
 					translate += temp;
@@ -207,7 +209,7 @@ bool CTPatchEx::parse(Tokenizer& tz, Type type)
 				blendtype_ = BlendType::Blend;
 
 				// Read first value
-				auto first = tz.next().text;
+				auto first = string{ tz.next().view() };
 
 				// If no second value, it's just a colour string
 				if (!tz.checkNext(","))
@@ -240,7 +242,7 @@ bool CTPatchEx::parse(Tokenizer& tz, Type type)
 						colour_.b = tz.next().asInt();
 						if (!tz.checkNext(","))
 						{
-							log::error("Invalid TEXTURES definition, expected ',', got '{}'", tz.peek().text);
+							log::error("Invalid TEXTURES definition, expected ',', got '{}'", tz.peek().view());
 							return false;
 						}
 						tz.adv(); // Skip ,
@@ -256,7 +258,7 @@ bool CTPatchEx::parse(Tokenizer& tz, Type type)
 
 			// Style
 			if (tz.checkNC("Style"))
-				style_ = tz.next().text;
+				style_ = tz.next().view();
 
 			// Read next property name
 			tz.adv();
@@ -597,7 +599,7 @@ bool CTexture::parse(Tokenizer& tz, string_view type)
 	type_     = type;
 	extended_ = true;
 	defined_  = false;
-	name_     = strutil::upper(tz.next().text);
+	name_     = strutil::upper(tz.next().view());
 	tz.adv(); // Skip ,
 	size_.x = tz.next().asInt();
 	tz.adv(); // Skip ,
@@ -676,7 +678,7 @@ bool CTexture::parseDefine(Tokenizer& tz)
 	type_       = "Define";
 	extended_   = true;
 	defined_    = true;
-	name_       = strutil::upper(tz.next().text);
+	name_       = strutil::upper(tz.next().view());
 	def_size_.x = tz.next().asInt();
 	def_size_.y = tz.next().asInt();
 	size_       = def_size_;
@@ -808,9 +810,66 @@ bool CTexture::convertRegular()
 
 // -----------------------------------------------------------------------------
 // Generates a SImage representation of this texture, using patches from
-// [parent] primarily, and the palette [pal]
+// [parent] primarily, and the palette [pal].
+// The generated image is cached (see CompositeCache) so the texture doesn't
+// need to be recomposed each time unless its definition or patches change
 // -----------------------------------------------------------------------------
 bool CTexture::toImage(SImage& image, Archive* parent, Palette* pal, bool force_rgba)
+{
+	// Extended textures can use other textures in the list they are in as
+	// patches, and changes to those aren't tracked, so don't cache them
+	auto     use_cache = cacheable();
+	uint64_t key       = 0;
+	if (use_cache)
+	{
+		key = cacheKey(parent, pal, force_rgba);
+		if (compositecache::getComposite(key, image))
+		{
+			// Defined textures take their size from the image
+			if (defined_)
+			{
+				size_.x  = image.width();
+				size_.y  = image.height();
+				scale_.x = static_cast<double>(size_.x) / static_cast<double>(def_size_.x);
+				scale_.y = static_cast<double>(size_.y) / static_cast<double>(def_size_.y);
+			}
+
+			return true;
+		}
+	}
+
+	// Load patches from their source texture or entry
+	auto load_patch = [&](unsigned index, SImage& p_img)
+	{
+		auto source = patchSource(index, parent);
+		if (source.texture)
+			return source.texture->toImage(p_img, parent, pal, force_rgba);
+
+		return compositecache::loadPatch(p_img, source.entry);
+	};
+
+	if (!composeImage(image, pal, force_rgba, load_patch))
+		return false;
+
+	if (use_cache)
+	{
+		vector<string> dependencies;
+		for (auto& patch : patches_)
+			dependencies.push_back(patch->name());
+
+		compositecache::addComposite(key, name_, dependencies, image);
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Composes the image for this texture from its patches (see toImage), using
+// [load_patch] to load each patch image by index.
+// This doesn't access any archive or resource, so can be used on a worker
+// thread (on a copy of the texture) if [load_patch] doesn't either
+// -----------------------------------------------------------------------------
+bool CTexture::composeImage(SImage& image, Palette* pal, bool force_rgba, const PatchLoader& load_patch)
 {
 	// Init image
 	image.clear();
@@ -822,7 +881,7 @@ bool CTexture::toImage(SImage& image, Archive* parent, Palette* pal, bool force_
 	dp.src_alpha = false;
 	if (defined_)
 	{
-		if (!loadPatchImage(0, p_img, parent, pal, force_rgba))
+		if (!load_patch(0, p_img))
 			return false;
 		size_.x = p_img.width();
 		size_.y = p_img.height();
@@ -845,7 +904,7 @@ bool CTexture::toImage(SImage& image, Archive* parent, Palette* pal, bool force_
 				p_img.clear(SImage::Type::PalMask);
 
 			// Load patch entry
-			if (!loadPatchImage(a, p_img, parent, pal, force_rgba))
+			if (!load_patch(a, p_img))
 				continue;
 
 			// Handle offsets
@@ -918,10 +977,10 @@ bool CTexture::toImage(SImage& image, Archive* parent, Palette* pal, bool force_
 		// Normal texture
 
 		// Add each patch to image
-		for (auto& patch : patches_)
+		for (unsigned a = 0; a < patches_.size(); a++)
 		{
-			if (misc::loadImageFromEntry(&p_img, patch->patchEntry(parent)))
-				image.drawImage(p_img, patch->xOffset(), patch->yOffset(), dp, pal, pal);
+			if (load_patch(a, p_img))
+				image.drawImage(p_img, patches_[a]->xOffset(), patches_[a]->yOffset(), dp, pal, pal);
 		}
 	}
 
@@ -929,14 +988,16 @@ bool CTexture::toImage(SImage& image, Archive* parent, Palette* pal, bool force_
 }
 
 // -----------------------------------------------------------------------------
-// Loads the image for the patch at [pindex] into [image].
-// Can deal with textures-as-patches
+// Returns the source of the patch at [pindex], either another texture (for
+// textures-as-patches in extended textures) or the patch entry, searching
+// [parent] primarily.
+// Both are null if the patch couldn't be found
 // -----------------------------------------------------------------------------
-bool CTexture::loadPatchImage(unsigned pindex, SImage& image, Archive* parent, Palette* pal, bool force_rgba) const
+CTexture::PatchSource CTexture::patchSource(unsigned pindex, Archive* parent) const
 {
 	// Check patch index
 	if (pindex >= patches_.size())
-		return false;
+		return {};
 
 	auto* patch = patches_[pindex].get();
 
@@ -957,32 +1018,78 @@ bool CTexture::loadPatchImage(unsigned pindex, SImage& image, Archive* parent, P
 
 				// Check for name match
 				if (strutil::equalCI(tex->name(), patch->name()))
-				{
-					// Load texture to image
-					return tex->toImage(image, parent, pal, force_rgba);
-				}
+					return { tex, nullptr };
 			}
 		}
 
 		// Otherwise, try the resource manager
 		// TODO: Something has to be ignored here. The entire archive or just the current list?
-		auto* tex = app::resources().getTexture(patch->name(), "", parent);
-		if (tex)
-			return tex->toImage(image, parent, pal, force_rgba);
+		if (auto* tex = app::resources().getTexture(patch->name(), "", parent))
+			return { tex, nullptr };
 	}
 
 	// Get patch entry
-	auto* entry = patch->patchEntry(parent);
+	if (auto* entry = patch->patchEntry(parent))
+		return { nullptr, entry };
 
-	// Load entry to image if valid
-	if (entry)
-		return misc::loadImageFromEntry(&image, entry);
+	// Maybe it's a texture? (regular textures can only use patches)
+	if (extended_ || defined_)
+		return { nullptr, app::resources().getTextureEntry(patch->name(), "", parent) };
+
+	return {};
+}
+
+// -----------------------------------------------------------------------------
+// Loads the image for the patch at [pindex] into [image].
+// Can deal with textures-as-patches
+// -----------------------------------------------------------------------------
+bool CTexture::loadPatchImage(unsigned pindex, SImage& image, Archive* parent, Palette* pal, bool force_rgba) const
+{
+	auto source = patchSource(pindex, parent);
+	if (source.texture)
+		return source.texture->toImage(image, parent, pal, force_rgba);
 
 	// Maybe it's a texture?
-	entry = app::resources().getTextureEntry(patch->name(), "", parent);
+	if (!source.entry && pindex < patches_.size())
+		source.entry = app::resources().getTextureEntry(patches_[pindex]->name(), "", parent);
 
-	if (entry)
-		return misc::loadImageFromEntry(&image, entry);
+	return compositecache::loadPatch(image, source.entry);
+}
+
+// -----------------------------------------------------------------------------
+// Returns a key identifying the image generated by toImage for this texture's
+// current definition, using patches from [parent] and the palette [pal]
+// -----------------------------------------------------------------------------
+uint64_t CTexture::cacheKey(const Archive* parent, const Palette* pal, bool force_rgba)
+{
+	// Texture definition
+	string key;
+	if (extended_)
+		key = asText();
+	else
+	{
+		key = fmt::format("{} {} {}\n", name_, size_.x, size_.y);
+		for (auto& patch : patches_)
+			key += fmt::format("{} {} {}\n", patch->name(), patch->xOffset(), patch->yOffset());
+	}
+
+	// Palette
+	uint64_t pal_hash = 0;
+	if (pal)
+	{
+		uint8_t colours[1024];
+		for (unsigned a = 0; a < 256; ++a)
+		{
+			auto col           = pal->colour(a);
+			colours[a * 4]     = col.r;
+			colours[a * 4 + 1] = col.g;
+			colours[a * 4 + 2] = col.b;
+			colours[a * 4 + 3] = col.a;
+		}
+		pal_hash = misc::hash64(colours, 1024);
+	}
+
+	key += fmt::format("{} {} {}", fmt::ptr(parent), pal_hash, force_rgba);
 
-	return false;
+	return misc::hash64(reinterpret_cast<const uint8_t*>(key.data()), key.size());
 }
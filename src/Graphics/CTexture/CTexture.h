@@ -133,6 +133,7 @@ public:
 	bool           worldPanning() const { return world_panning_; }
 	const string&  type() const { return type_; }
 	bool           isExtended() const { return extended_; }
+	bool           isDefined() const { return defined_; }
 	bool           isOptional() const { return optional_; }
 	bool           noDecals() const { return no_decals_; }
 	bool           nullTexture() const { return null_texture_; }
@@ -175,13 +176,28 @@ public:
 
 	bool convertExtended();
 	bool convertRegular();
-	bool loadPatchImage(
+
+	// Image generation
+	struct PatchSource
+	{
+		CTexture*     texture = nullptr; // Texture used as a patch (textures-as-patches)
+		ArchiveEntry* entry   = nullptr; // Patch entry
+	};
+	typedef std::function<bool(unsigned, SImage&)> PatchLoader;
+
+	PatchSource patchSource(unsigned pindex, Archive* parent = nullptr) const;
+	bool        loadPatchImage(
 		unsigned pindex,
 		SImage&  image,
 		Archive* parent     = nullptr,
 		Palette* pal        = nullptr,
 		bool     force_rgba = false) const;
 	bool toImage(SImage& image, Archive* parent = nullptr, Palette* pal = nullptr, bool force_rgba = false);
+	bool composeImage(SImage& image, Palette* pal, bool force_rgba, const PatchLoader& load_patch);
+
+	// Composite cache
+	bool     cacheable() const { return !(extended_ && in_list_); }
+	uint64_t cacheKey(const Archive* parent, const Palette* pal, bool force_rgba);
 
 	// Signals
 	struct Signals
@@ -0,0 +1,330 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    CompositeCache.cpp
+// Description: Process-wide cache of composite texture images and the decoded
+//              patch images they are built from. Composites are invalidated
+//              when any resource they depend on changes, and patches when
+//              their entry's data changes, so each patch is only decoded once
+//              no matter how many textures use it
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "CompositeCache.h"
+#include "App.h"
+#include "Archive/ArchiveEntry.h"
+#include "General/Console.h"
+#include "General/Misc.h"
+#include "General/ResourceManager.h"
+#include "Graphics/SImage/SImage.h"
+#include "Utility/StringUtils.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr size_t MAX_CACHE_SIZE = 128 * 1024 * 1024; // Max. total size of cached image data (bytes)
+
+struct Composite
+{
+	unique_ptr<SImage> image;
+	string             name;         // Texture name (uppercase)
+	vector<string>     dependencies; // Names of patches/textures used by the texture (uppercase)
+};
+
+struct Patch
+{
+	weak_ptr<ArchiveEntry> entry;
+	uint64_t               content_hash = 0;
+	unique_ptr<SImage>     image; // Null if the entry couldn't be loaded as an image
+};
+
+std::unordered_map<uint64_t, Composite>        composites;
+std::unordered_map<const ArchiveEntry*, Patch> patches;
+size_t                                         cache_size        = 0;
+bool                                           signals_connected = false;
+unsigned                                       cache_generation  = 0;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the (approximate) size of [image]'s data in bytes
+// -----------------------------------------------------------------------------
+size_t imageSize(const SImage* image)
+{
+	if (!image)
+		return 0;
+
+	return static_cast<size_t>(image->width()) * image->height() * (image->type() == SImage::Type::RGBA ? 4 : 2);
+}
+
+// -----------------------------------------------------------------------------
+// Connects to resource manager signals to invalidate cached composites when
+// resources change, if not done already
+// -----------------------------------------------------------------------------
+void connectSignals()
+{
+	if (signals_connected)
+		return;
+
+	app::resources().signals().resources_changed.connect(
+		[](const ResourceChanges& changes)
+		{
+			std::set<string> names;
+			for (const auto* res : { &changes.patches, &changes.flats, &changes.textures, &changes.satextures })
+			{
+				names.insert(res->added.begin(), res->added.end());
+				names.insert(res->removed.begin(), res->removed.end());
+				names.insert(res->changed.begin(), res->changed.end());
+			}
+
+			if (!names.empty())
+				compositecache::invalidate(names);
+		});
+
+	signals_connected = true;
+}
+
+// -----------------------------------------------------------------------------
+// Clears the cache if it has grown beyond the max. size
+// -----------------------------------------------------------------------------
+void checkCacheSize()
+{
+	if (cache_size > MAX_CACHE_SIZE)
+	{
+		log::info(2, "Composite texture cache full, clearing");
+		compositecache::clear();
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// CompositeCache Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Copies the cached composite texture image for [key] to [image].
+// Returns false if there is no cached image for [key]
+// -----------------------------------------------------------------------------
+bool compositecache::getComposite(uint64_t key, SImage& image)
+{
+	auto i = composites.find(key);
+	if (i == composites.end())
+		return false;
+
+	return image.copyImage(i->second.image.get());
+}
+
+// -----------------------------------------------------------------------------
+// Adds a copy of composite texture [image] to the cache for [key].
+// The cached image will be invalidated if the texture [name] or any resource
+// in [dependencies] changes
+// -----------------------------------------------------------------------------
+void compositecache::addComposite(
+	uint64_t              key,
+	string_view           name,
+	const vector<string>& dependencies,
+	const SImage&         image)
+{
+	connectSignals();
+
+	auto& composite = composites[key];
+	cache_size -= imageSize(composite.image.get());
+
+	composite.image = std::make_unique<SImage>(image);
+	composite.name  = strutil::upper(name);
+	composite.dependencies.clear();
+	for (const auto& dependency : dependencies)
+		composite.dependencies.push_back(strutil::upper(dependency));
+
+	cache_size += imageSize(composite.image.get());
+	checkCacheSize();
+}
+
+// -----------------------------------------------------------------------------
+// Loads the patch image from [entry] into [image], decoding it only if it
+// isn't already cached (or [entry]'s data has changed since it was cached)
+// -----------------------------------------------------------------------------
+bool compositecache::loadPatch(SImage& image, ArchiveEntry* entry)
+{
+	if (!entry)
+		return false;
+
+	// Check for a valid cached image
+	auto  content_hash = entry->contentHash();
+	auto& patch        = patches[entry];
+	if (patch.entry.lock().get() == entry && patch.content_hash == content_hash)
+		return patch.image ? image.copyImage(patch.image.get()) : false;
+
+	// Not cached (or out of date), decode the entry
+	cache_size -= imageSize(patch.image.get());
+	patch.entry        = entry->getShared();
+	patch.content_hash = content_hash;
+	patch.image        = std::make_unique<SImage>();
+	if (!misc::loadImageFromEntry(patch.image.get(), entry))
+	{
+		patch.image.reset();
+		return false;
+	}
+	cache_size += imageSize(patch.image.get());
+
+	auto ok = image.copyImage(patch.image.get());
+	checkCacheSize();
+
+	return ok;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if an up-to-date decoded image for [entry] is cached (even if
+// the entry isn't a valid image)
+// -----------------------------------------------------------------------------
+bool compositecache::hasPatch(ArchiveEntry* entry)
+{
+	if (!entry)
+		return false;
+
+	auto i = patches.find(entry);
+	return i != patches.end() && i->second.entry.lock().get() == entry
+		   && i->second.content_hash == entry->contentHash();
+}
+
+// -----------------------------------------------------------------------------
+// Adds a copy of [image], decoded from [entry]'s data with the given
+// [content_hash], to the cache. If [image] is null the entry is cached as not
+// being a valid image.
+// Used for patches decoded outside of loadPatch (eg. on a worker thread)
+// -----------------------------------------------------------------------------
+void compositecache::addPatch(ArchiveEntry* entry, uint64_t content_hash, const SImage* image)
+{
+	if (!entry)
+		return;
+
+	auto& patch = patches[entry];
+	cache_size -= imageSize(patch.image.get());
+	patch.entry        = entry->getShared();
+	patch.content_hash = content_hash;
+	patch.image        = image ? std::make_unique<SImage>(*image) : nullptr;
+	cache_size += imageSize(patch.image.get());
+
+	checkCacheSize();
+}
+
+// -----------------------------------------------------------------------------
+// Removes all cached composites that use any of the resources in [names],
+// and any that use those composites (as textures-as-patches)
+// -----------------------------------------------------------------------------
+void compositecache::invalidate(const std::set<string>& names)
+{
+	++cache_generation;
+
+	std::set<string> invalid;
+	for (const auto& name : names)
+		invalid.insert(strutil::upper(name));
+
+	auto removed = true;
+	while (removed)
+	{
+		removed = false;
+
+		auto i = composites.begin();
+		while (i != composites.end())
+		{
+			auto& composite = i->second;
+			auto  depends   = false;
+			for (const auto& dependency : composite.dependencies)
+				if (invalid.count(dependency) > 0)
+				{
+					depends = true;
+					break;
+				}
+
+			if (depends)
+			{
+				// Anything using this composite is also invalid
+				removed |= invalid.insert(composite.name).second;
+
+				cache_size -= imageSize(composite.image.get());
+				i = composites.erase(i);
+			}
+			else
+				++i;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Clears all cached composites and patches
+// -----------------------------------------------------------------------------
+void compositecache::clear()
+{
+	composites.clear();
+	patches.clear();
+	cache_size = 0;
+	++cache_generation;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the current cache generation, which changes whenever cached images
+// are invalidated or cleared. Composites built from resources read before a
+// generation change may be out of date, and shouldn't be added to the cache
+// -----------------------------------------------------------------------------
+unsigned compositecache::generation()
+{
+	return cache_generation;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// Clears the composite texture cache
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(clear_texture_cache, 0, true)
+{
+	compositecache::clear();
+	log::info("Cleared composite texture cache");
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+namespace slade
+{
+class ArchiveEntry;
+class SImage;
+
+namespace compositecache
+{
+	bool     getComposite(uint64_t key, SImage& image);
+	void     addComposite(uint64_t key, string_view name, const vector<string>& dependencies, const SImage& image);
+	bool     loadPatch(SImage& image, ArchiveEntry* entry);
+	bool     hasPatch(ArchiveEntry* entry);
+	void     addPatch(ArchiveEntry* entry, uint64_t content_hash, const SImage* image);
+	void     invalidate(const std::set<string>& names);
+	void     clear();
+	unsigned generation();
+} // namespace compositecache
+} // namespace slade
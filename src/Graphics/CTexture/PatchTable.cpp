@@ -65,11 +65,18 @@ PatchTable::Patch& PatchTable::patch(size_t index)
 // -----------------------------------------------------------------------------
 PatchTable::Patch& PatchTable::patch(string_view name)
 {
-	// Go through list
-	for (auto& patch : patches_)
+	// Check the first patch with a (case-insensitively) matching name
+	auto index = patchIndex(name);
+	if (index < 0)
+		return patch_invalid_;
+	if (patches_[index].name == name)
+		return patches_[index];
+
+	// Otherwise check any others
+	for (auto a = static_cast<size_t>(index) + 1; a < patches_.size(); ++a)
 	{
-		if (patch.name == name)
-			return patch;
+		if (patches_[a].name == name)
+			return patches_[a];
 	}
 
 	return patch_invalid_;
@@ -113,15 +120,8 @@ ArchiveEntry* PatchTable::patchEntry(size_t index)
 // -----------------------------------------------------------------------------
 ArchiveEntry* PatchTable::patchEntry(string_view name)
 {
-	// Search for patch by name
-	for (size_t a = 0; a < patches_.size(); a++)
-	{
-		if (strutil::equalCI(patches_[a].name, name))
-			return patchEntry(a);
-	}
-
-	// Not found
-	return nullptr;
+	auto index = patchIndex(name);
+	return index < 0 ? nullptr : patchEntry(index);
 }
 
 // -----------------------------------------------------------------------------
@@ -129,10 +129,19 @@ ArchiveEntry* PatchTable::patchEntry(string_view name)
 // -----------------------------------------------------------------------------
 int32_t PatchTable::patchIndex(string_view name) const
 {
+	// Lump-length names are looked up in the index
+	if (name.size() <= 8)
+	{
+		auto i = name_index_.find(strutil::lumpNameKey(name));
+		return i != name_index_.end() && patches_[i->second].name.size() == name.size()
+				   ? static_cast<int32_t>(i->second)
+				   : -1;
+	}
+
 	// Search for patch by name
 	for (size_t a = 0; a < patches_.size(); a++)
 	{
-		if (strutil::equalCI(patches_[a].name, name))
+		if (strutil::equalLumpNameCI(patches_[a].name, name))
 			return a;
 	}
 
@@ -169,6 +178,7 @@ bool PatchTable::removePatch(unsigned index)
 
 	// Remove the patch
 	patches_.erase(patches_.begin() + index);
+	rebuildNameIndex();
 
 	// Announce
 	signals_.modified();
@@ -190,6 +200,7 @@ bool PatchTable::replacePatch(unsigned index, string_view newname)
 
 	// Change the patch name
 	patches_[index].name = newname;
+	rebuildNameIndex();
 
 	// Announce
 	signals_.modified();
@@ -203,17 +214,13 @@ bool PatchTable::replacePatch(unsigned index, string_view newname)
 bool PatchTable::addPatch(string_view name, bool allow_dup)
 {
 	// Check patch doesn't already exist
-	if (!allow_dup)
-	{
-		for (auto& patch : patches_)
-		{
-			if (name == patch.name)
-				return false;
-		}
-	}
+	if (!allow_dup && &patch(name) != &patch_invalid_)
+		return false;
 
 	// Add the patch
 	patches_.emplace_back(name);
+	if (name.size() <= 8)
+		name_index_.try_emplace(strutil::lumpNameKey(name), patches_.size() - 1);
 
 	// Announce
 	signals_.modified();
@@ -235,6 +242,7 @@ bool PatchTable::loadPNAMES(ArchiveEntry* pnames, Archive* parent)
 
 	// Clear current table
 	patches_.clear();
+	name_index_.clear();
 
 	// Setup parent archive
 	if (!parent)
@@ -342,3 +350,14 @@ void PatchTable::updatePatchUsage(CTexture* tex)
 	// Announce
 	signals_.modified();
 }
+
+// -----------------------------------------------------------------------------
+// Rebuilds the patch name -> index lookup
+// -----------------------------------------------------------------------------
+void PatchTable::rebuildNameIndex()
+{
+	name_index_.clear();
+	for (unsigned a = 0; a < patches_.size(); ++a)
+		if (patches_[a].name.size() <= 8)
+			name_index_.try_emplace(strutil::lumpNameKey(patches_[a].name), a);
+}
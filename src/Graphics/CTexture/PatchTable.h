@@ -62,9 +62,12 @@ public:
 	Signals& signals() { return signals_; }
 
 private:
-	Archive*      parent_ = nullptr;
-	vector<Patch> patches_;
-	Patch         patch_invalid_{ "INVALID_PATCH" };
-	Signals       signals_;
+	Archive*                               parent_ = nullptr;
+	vector<Patch>                          patches_;
+	std::unordered_map<uint64_t, uint32_t> name_index_; // First patch for each name (see strutil::lumpNameKey)
+	Patch                                  patch_invalid_{ "INVALID_PATCH" };
+	Signals                                signals_;
+
+	void rebuildNameIndex();
 };
 } // namespace slade
@@ -0,0 +1,273 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TextureComposer.cpp
+// Description: TextureComposer class. Composes queued textures (see
+//              CTexture::toImage) on the task workers, decoding their patches
+//              there too. Anything needing archive or resource access is done
+//              on the main thread when a texture is queued, and the composed
+//              images are handed back to the main thread via callbacks.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "TextureComposer.h"
+#include "Archive/ArchiveEntry.h"
+#include "Archive/EntryType/EntryType.h"
+#include "CTexture.h"
+#include "CompositeCache.h"
+#include "General/Misc.h"
+#include "Graphics/Palette/Palette.h"
+#include "Graphics/SImage/SImage.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// TextureComposer Structs
+//
+// -----------------------------------------------------------------------------
+
+// A texture to be composed, with everything needed to compose it without
+// accessing any archive or resource
+struct TextureComposer::Job
+{
+	struct Patch
+	{
+		unique_ptr<SImage> image = std::make_unique<SImage>();
+		bool               ok    = false;
+
+		// Entry data to decode on the worker thread (if decode is true)
+		bool                   decode = false;
+		MemChunk               data; // Shared with the entry (see MemChunk::share)
+		string                 format_id;
+		string                 format_hint;
+		SIFormat*              image_format = nullptr; // Format the entry was last loaded with, if known
+		weak_ptr<ArchiveEntry> entry;
+		uint64_t               content_hash = 0;
+	};
+
+	unique_ptr<CTexture>      texture;
+	unique_ptr<Palette>       palette;
+	bool                      force_rgba = false;
+	vector<unique_ptr<Patch>> patches;
+	vector<int>               patch_index; // Index in patches for each texture patch (-1 if not found)
+	unsigned                  cancel_id = 0;
+
+	// Composite cache info
+	bool           cacheable  = false;
+	uint64_t       key        = 0;
+	unsigned       generation = 0;
+	vector<string> dependencies;
+
+	// Result
+	SImage   image;
+	bool     ok = false;
+	Callback on_composed;
+};
+
+
+// -----------------------------------------------------------------------------
+//
+// TextureComposer Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// TextureComposer class constructor
+// -----------------------------------------------------------------------------
+TextureComposer::TextureComposer() : jobs_{ &TextureComposer::compose, [this](Job& job) { finish(job); } } {}
+
+// -----------------------------------------------------------------------------
+// TextureComposer class destructor
+// -----------------------------------------------------------------------------
+TextureComposer::~TextureComposer() = default;
+
+// -----------------------------------------------------------------------------
+// Queues [texture] to be composed on a worker thread, using patches from
+// [parent] primarily and the palette [pal], with [on_composed] called on the
+// main thread once done. The result is the same as CTexture::toImage, and is
+// added to the composite cache.
+// If the texture is already cached, [on_composed] is called immediately
+// -----------------------------------------------------------------------------
+void TextureComposer::queue(CTexture& texture, Archive* parent, Palette* pal, bool force_rgba, Callback on_composed)
+{
+	auto job         = std::make_shared<Job>();
+	job->cacheable   = texture.cacheable();
+	job->on_composed = std::move(on_composed);
+
+	// Check for a cached composite first
+	if (job->cacheable)
+	{
+		job->key        = texture.cacheKey(parent, pal, force_rgba);
+		job->generation = compositecache::generation();
+		if (compositecache::getComposite(job->key, job->image))
+		{
+			// Let toImage deal with anything it updates from the cached image
+			job->ok = texture.toImage(job->image, parent, pal, force_rgba);
+			if (job->on_composed)
+				job->on_composed(job->ok, job->image, texture);
+			return;
+		}
+	}
+
+	// Copy everything the texture needs to be composed
+	job->texture = std::make_unique<CTexture>();
+	job->texture->copyTexture(texture);
+	job->force_rgba = force_rgba;
+	if (pal)
+	{
+		job->palette = std::make_unique<Palette>();
+		job->palette->copyPalette(pal);
+	}
+
+	// Find patches
+	std::map<ArchiveEntry*, int> entry_patches;
+	for (unsigned a = 0; a < texture.nPatches(); ++a)
+	{
+		job->dependencies.emplace_back(texture.patch(a)->name());
+
+		auto source = texture.patchSource(a, parent);
+		if (!source.texture && !source.entry)
+		{
+			job->patch_index.push_back(-1);
+			continue;
+		}
+
+		// Same entry used for multiple patches
+		if (source.entry && entry_patches.count(source.entry) > 0)
+		{
+			job->patch_index.push_back(entry_patches[source.entry]);
+			continue;
+		}
+
+		job->patch_index.push_back(static_cast<int>(job->patches.size()));
+		auto& patch = job->patches.emplace_back(std::make_unique<Job::Patch>());
+
+		// Textures-as-patches are composed here since they may use more
+		// resources (they're usually cached anyway)
+		if (source.texture)
+		{
+			patch->ok = source.texture->toImage(*patch->image, parent, pal, force_rgba);
+			continue;
+		}
+
+		entry_patches[source.entry] = job->patch_index.back();
+
+		// Decode the patch on the worker thread if it isn't cached already
+		// (and doesn't need other entries to load)
+		if (!compositecache::hasPatch(source.entry) && misc::canLoadImageFromData(*source.entry))
+		{
+			patch->decode       = true;
+			patch->entry        = source.entry->getShared();
+			patch->content_hash = source.entry->contentHash();
+			patch->format_id    = source.entry->type()->formatId();
+			patch->format_hint  = source.entry->type()->extraProps().getOr<string>("image_format", {});
+			patch->image_format = source.entry->imageFormat();
+			patch->data.share(source.entry->data());
+		}
+		else
+			patch->ok = compositecache::loadPatch(*patch->image, source.entry);
+	}
+
+	// Add to queue
+	job->cancel_id = cancel_id_;
+	++pending_;
+	jobs_.push(job);
+}
+
+// -----------------------------------------------------------------------------
+// Cancels all queued textures. Their callbacks won't be called, even if they
+// are currently being composed
+// -----------------------------------------------------------------------------
+void TextureComposer::cancel()
+{
+	jobs_.takeQueued();
+	++cancel_id_;
+	pending_ = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Decodes [job]'s patches and composes its texture (on a worker thread)
+// -----------------------------------------------------------------------------
+void TextureComposer::compose(Job& job)
+{
+	// Decode patches
+	for (auto& patch : job.patches)
+	{
+		if (!patch->decode)
+			continue;
+
+		patch->ok = misc::loadImageFromData(
+			patch->image.get(), patch->data, patch->format_id, patch->format_hint, 0, patch->image_format);
+		patch->data.clear();
+	}
+
+	// Compose texture
+	auto load_patch = [&job](unsigned index, SImage& image)
+	{
+		if (index >= job.patch_index.size() || job.patch_index[index] < 0)
+			return false;
+
+		auto& patch = *job.patches[job.patch_index[index]];
+		return patch.ok && image.copyImage(patch.image.get());
+	};
+	job.ok = job.texture->composeImage(job.image, job.palette.get(), job.force_rgba, load_patch);
+}
+
+// -----------------------------------------------------------------------------
+// Adds [job]'s decoded patches and composed image to the composite cache and
+// calls its callback (on the main thread)
+// -----------------------------------------------------------------------------
+void TextureComposer::finish(Job& job)
+{
+	// Ignore if cancelled
+	if (job.cancel_id != cancel_id_)
+		return;
+
+	if (pending_ > 0)
+		--pending_;
+
+	// Cache decoded patches
+	for (auto& patch : job.patches)
+		if (patch->decode)
+			if (auto entry = patch->entry.lock())
+			{
+				compositecache::addPatch(entry.get(), patch->content_hash, patch->ok ? patch->image.get() : nullptr);
+
+				// Remember the detected image format if the entry is unchanged
+				if (patch->ok && entry->contentHash() == patch->content_hash)
+					entry->setImageFormat(patch->image->format());
+			}
+
+	// Cache composed image, unless any resources changed since it was queued
+	if (job.ok && job.cacheable && job.generation == compositecache::generation())
+		compositecache::addComposite(job.key, job.texture->name(), job.dependencies, job.image);
+
+	if (job.on_composed)
+		job.on_composed(job.ok, job.image, *job.texture);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "General/Tasks.h"
+
+namespace slade
+{
+class Archive;
+class CTexture;
+class Palette;
+class SImage;
+
+class TextureComposer
+{
+public:
+	// Called on the main thread when a queued texture has been composed, with
+	// the composed [image] and the copy of the [texture] it was composed from
+	// (defined textures take their size and scale from their patch)
+	typedef std::function<void(bool ok, const SImage& image, const CTexture& texture)> Callback;
+
+	TextureComposer();
+	~TextureComposer();
+
+	unsigned pending() const { return pending_; }
+
+	void queue(CTexture& texture, Archive* parent, Palette* pal, bool force_rgba, Callback on_composed);
+	void cancel();
+
+private:
+	struct Job;
+
+	tasks::JobQueue<Job> jobs_;
+	unsigned             pending_   = 0;
+	unsigned             cancel_id_ = 0;
+
+	static void compose(Job& job);
+	void        finish(Job& job);
+};
+} // namespace slade
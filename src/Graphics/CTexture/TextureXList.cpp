@@ -139,7 +139,7 @@ CTexture* TextureXList::texture(string_view name)
 	// Search for texture by name
 	for (auto& texture : textures_)
 	{
-		if (strutil::equalCI(texture->name(), name))
+		if (strutil::equalLumpNameCI(texture->name(), name))
 			return texture.get();
 	}
 
@@ -155,7 +155,7 @@ int TextureXList::textureIndex(string_view name) const
 	// Search for texture by name
 	for (unsigned a = 0; a < textures_.size(); a++)
 	{
-		if (strutil::equalCI(textures_[a]->name(), name))
+		if (strutil::equalLumpNameCI(textures_[a]->name(), name))
 		{
 			textures_[a]->index_ = a;
 			return a;
@@ -693,6 +693,7 @@ bool TextureXList::readTEXTURESData(ArchiveEntry* textures)
 
 	// Get text to parse
 	Tokenizer tz;
+	tz.enableZeroCopy(true);
 	tz.openMem(textures->data(), textures->name());
 
 	// Parsing gogo
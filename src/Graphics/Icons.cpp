@@ -33,8 +33,11 @@
 #include "Icons.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
+#include "General/Misc.h"
 #include "UI/WxUtils.h"
 #include "Utility/Parser.h"
+#include <filesystem>
+#include <fstream>
 #include <wx/mstream.h>
 
 using namespace slade;
@@ -47,12 +50,14 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 CVAR(String, iconset_general, "Default", CVar::Flag::Save)
 CVAR(String, iconset_entry_list, "Default", CVar::Flag::Save)
+CVAR(Bool, icon_cache, true, CVar::Flag::Save)
 
 namespace slade::icons
 {
 struct IconDef
 {
 	string        svg_data;
+	uint64_t      svg_hash    = 0; // Identifies the svg data in the rasterised icon caches
 	ArchiveEntry* entry_png16 = nullptr;
 	ArchiveEntry* entry_png32 = nullptr;
 };
@@ -71,6 +76,24 @@ vector<IconSet> iconsets_general;
 IconSet         iconset_text_editor{ "Default" };
 IconSet         iconset_ui_dark{ "Dark" };
 IconSet         iconset_ui_light{ "Light" };
+
+// Rasterised svg icons by rasterKey, so each icon is only rasterised once
+// per size
+std::map<uint64_t, wxImage> rasterised_icons;
+
+constexpr uint32_t ICON_CACHE_MAGIC   = 0x43494c53; // "SLIC"
+constexpr uint16_t ICON_CACHE_VERSION = 1;
+
+// Cached icon file header, followed by width * height RGB pixels, then
+// width * height alpha values
+struct IconCacheHeader
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t width;
+	uint16_t height;
+	uint16_t reserved;
+};
 } // namespace slade::icons
 
 
@@ -151,6 +174,15 @@ const IconDef* iconDef(Type type, string_view name)
 	return nullptr;
 }
 
+// -----------------------------------------------------------------------------
+// Sets the svg data of [icon] to [svg_data]
+// -----------------------------------------------------------------------------
+void setSVGData(IconDef& icon, string svg_data)
+{
+	icon.svg_data = std::move(svg_data);
+	icon.svg_hash = misc::hash64(reinterpret_cast<const uint8_t*>(icon.svg_data.data()), icon.svg_data.size());
+}
+
 // -----------------------------------------------------------------------------
 // Parses an icon definition from icons.cfg
 // -----------------------------------------------------------------------------
@@ -163,7 +195,7 @@ IconDef parseIconDefinition(const ParseTreeNode& node, const Archive& res_archiv
 	{
 		auto* entry = res_archive.entryAtPath(node.stringValue());
 		if (entry)
-			idef.svg_data = entry->data().asString();
+			setSVGData(idef, entry->data().asString());
 		else
 			log::error("Icon entry \"{}\" does not exist in slade.pk3", node.stringValue());
 	}
@@ -276,11 +308,117 @@ void parseGeneralBlock(const ParseTreeNode& node, const Archive& res_archive)
 }
 
 // -----------------------------------------------------------------------------
-// Loads an SVG [svg_data] of [size] into a wxBitmap, with optional [padding]
+// Returns the key for svg data with [svg_hash] rasterised at [width]x[height]
+// -----------------------------------------------------------------------------
+uint64_t rasterKey(uint64_t svg_hash, int width, int height)
+{
+	const uint64_t key_data[] = { svg_hash, static_cast<uint64_t>(width), static_cast<uint64_t>(height) };
+	return misc::hash64(reinterpret_cast<const uint8_t*>(key_data), sizeof(key_data));
+}
+
+// -----------------------------------------------------------------------------
+// Returns the path to the on-disk cached icon for [key], creating the cache
+// directory if needed
+// -----------------------------------------------------------------------------
+string iconCachePath(uint64_t key)
+{
+	static const string dir = []
+	{
+		auto path = app::path("icon_cache", app::Dir::User);
+		std::error_code error;
+		std::filesystem::create_directories(path, error);
+		return path;
+	}();
+
+	return fmt::format("{}/{:016x}.icon", dir, key);
+}
+
+// -----------------------------------------------------------------------------
+// Loads the on-disk cached icon for [key] into [image].
+// Returns false if there is no (valid) cached icon of [width]x[height]
+// -----------------------------------------------------------------------------
+bool loadCachedIcon(uint64_t key, int width, int height, wxImage& image)
+{
+	std::ifstream file(iconCachePath(key), std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	IconCacheHeader header{};
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file.good() || header.magic != ICON_CACHE_MAGIC || header.version != ICON_CACHE_VERSION
+		|| header.width != width || header.height != height)
+		return false;
+
+	// wxImage takes ownership of (and frees) the data, so it must be malloc'd
+	const auto n_pixels = static_cast<size_t>(width) * height;
+	auto       rgb      = static_cast<unsigned char*>(malloc(n_pixels * 3));
+	auto       alpha    = static_cast<unsigned char*>(malloc(n_pixels));
+	file.read(reinterpret_cast<char*>(rgb), n_pixels * 3);
+	file.read(reinterpret_cast<char*>(alpha), n_pixels);
+	if (!file.good())
+	{
+		free(rgb);
+		free(alpha);
+		return false;
+	}
+
+	image = wxImage(width, height, rgb, alpha, false);
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes [image] to the on-disk icon cache for [key]
+// -----------------------------------------------------------------------------
+void saveCachedIcon(uint64_t key, const wxImage& image)
+{
+	if (!image.IsOk() || !image.HasAlpha())
+		return;
+
+	IconCacheHeader header{ ICON_CACHE_MAGIC,
+							ICON_CACHE_VERSION,
+							static_cast<uint16_t>(image.GetWidth()),
+							static_cast<uint16_t>(image.GetHeight()),
+							0 };
+	const auto n_pixels = static_cast<size_t>(image.GetWidth()) * image.GetHeight();
+
+	std::ofstream file(iconCachePath(key), std::ios::binary);
+	if (!file.is_open())
+		return;
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(image.GetData()), n_pixels * 3);
+	file.write(reinterpret_cast<const char*>(image.GetAlpha()), n_pixels);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the svg [svg_data] (with [svg_hash]) rasterised at [width]x[height].
+// Each size of each icon is only rasterised once - after that it comes from
+// memory, or from the on-disk cache in later sessions (if icon_cache is on)
+// -----------------------------------------------------------------------------
+wxImage rasteriseSVGIcon(const string& svg_data, uint64_t svg_hash, int width, int height)
+{
+	const auto key = rasterKey(svg_hash, width, height);
+	if (auto i = rasterised_icons.find(key); i != rasterised_icons.end())
+		return i->second;
+
+	wxImage image;
+	if (!icon_cache || !loadCachedIcon(key, width, height, image))
+	{
+		image = wxutil::createImageFromSVG(svg_data, width, height);
+		if (icon_cache)
+			saveCachedIcon(key, image);
+	}
+
+	rasterised_icons[key] = image;
+	return image;
+}
+
+// -----------------------------------------------------------------------------
+// Loads the SVG [icon] of [size] into a wxBitmap, with optional [padding]
 // -----------------------------------------------------------------------------
-wxBitmap loadSVGIcon(const string& svg_data, int size, Point2i padding)
+wxBitmap loadSVGIcon(const IconDef& icon, int size, Point2i padding)
 {
-	const auto img = wxutil::createImageFromSVG(svg_data, size, size);
+	const auto img = rasteriseSVGIcon(icon.svg_data, icon.svg_hash, size, size);
 
 	// Add padding if needed
 	if (padding.x > 0 || padding.y > 0)
@@ -295,6 +433,37 @@ wxBitmap loadSVGIcon(const string& svg_data, int size, Point2i padding)
 	return { img };
 }
 
+#if wxCHECK_VERSION(3, 1, 6)
+// A bitmap bundle for an svg icon that rasterises each size on request (via
+// rasteriseSVGIcon, so it is cached) rather than using wx's own svg bundle
+class SVGIconBundleImpl : public wxBitmapBundleImpl
+{
+public:
+	SVGIconBundleImpl(const IconDef& icon, int size) :
+		svg_data_{ icon.svg_data }, svg_hash_{ icon.svg_hash }, size_{ size }
+	{
+	}
+
+	wxSize GetDefaultSize() const override { return { size_, size_ }; }
+
+	wxSize GetPreferredBitmapSizeAtScale(double scale) const override
+	{
+		const int size = static_cast<int>(std::lround(size_ * scale));
+		return { size, size };
+	}
+
+	wxBitmap GetBitmap(const wxSize& size) override
+	{
+		return { rasteriseSVGIcon(svg_data_, svg_hash_, size.x, size.y) };
+	}
+
+private:
+	string   svg_data_;
+	uint64_t svg_hash_ = 0;
+	int      size_     = 16;
+};
+#endif
+
 // -----------------------------------------------------------------------------
 // Loads a PNG icon of [size] using the given [icon] definition into a wxBitmap,
 // with optional [padding]
@@ -430,12 +599,12 @@ bool icons::loadIcons()
 	// Load UI icons (light)
 	auto* dir_ui_icons_light = res_archive->dirAtPath("icons/ui/light");
 	for (auto& icon_entry : dir_ui_icons_light->entries())
-		iconset_ui_light.icons[string{ icon_entry->nameNoExt() }].svg_data = icon_entry->data().asString();
+		setSVGData(iconset_ui_light.icons[string{ icon_entry->nameNoExt() }], icon_entry->data().asString());
 
 	// Load UI icons (dark)
 	auto* dir_ui_icons_dark = res_archive->dirAtPath("icons/ui/dark");
 	for (auto& icon_entry : dir_ui_icons_dark->entries())
-		iconset_ui_dark.icons[string{ icon_entry->nameNoExt() }].svg_data = icon_entry->data().asString();
+		setSVGData(iconset_ui_dark.icons[string{ icon_entry->nameNoExt() }], icon_entry->data().asString());
 
 	return true;
 }
@@ -445,8 +614,8 @@ bool icons::loadIcons()
 // Loads the icon [name] of [type] into a wxBitmapBundle of minimum [size], with
 // optional [padding] (png icons only).
 //
-// NOTE: this does not use any kind of caching and will generate/load the icon
-// from svg/png data each time
+// NOTE: svg icons are rasterised (and cached) per size when the bundle is
+// first drawn at that size, png icons are loaded from png data each time
 // -----------------------------------------------------------------------------
 wxBitmapBundle icons::getIcon(Type type, string_view name, int size, Point2i padding)
 {
@@ -464,7 +633,7 @@ wxBitmapBundle icons::getIcon(Type type, string_view name, int size, Point2i pad
 
 	// If there is SVG data use that
 	if (!icon_def->svg_data.empty())
-		return wxBitmapBundle::FromSVG(icon_def->svg_data.c_str(), { size, size });
+		return wxBitmapBundle::FromImpl(new SVGIconBundleImpl(*icon_def, size));
 
 	// Otherwise load from png
 	if (icon_def->entry_png16 || icon_def->entry_png32)
@@ -485,8 +654,8 @@ wxBitmapBundle icons::getIcon(Type type, string_view name, int size, Point2i pad
 // Loads the icon [name] of [type] into a wxBitmap of [size], with optional
 // [padding].
 //
-// NOTE: this does not use any kind of caching and will generate/load the icon
-// from svg/png data each time
+// NOTE: svg icons are cached per size (see rasteriseSVGIcon), png icons are
+// loaded from png data each time
 // -----------------------------------------------------------------------------
 wxBitmap icons::getIcon(Type type, string_view name, int size, Point2i padding)
 {
@@ -504,7 +673,7 @@ wxBitmap icons::getIcon(Type type, string_view name, int size, Point2i padding)
 
 	// If there is SVG data use that
 	if (!icon_def->svg_data.empty())
-		return loadSVGIcon(icon_def->svg_data, size, padding);
+		return loadSVGIcon(*icon_def, size, padding);
 
 	// Otherwise load from png
 	if (icon_def->entry_png16 || icon_def->entry_png32)
@@ -519,8 +688,8 @@ wxBitmap icons::getIcon(Type type, string_view name, int size, Point2i padding)
 // Loads the interface icon [name] from [theme] into a wxBitmapBundle of minimum
 // [size].
 //
-// NOTE: this does not use any kind of caching and will generate/load the icon
-// from svg/png data each time
+// NOTE: the icon is rasterised (and cached) per size when the bundle is first
+// drawn at that size
 // -----------------------------------------------------------------------------
 wxBitmapBundle icons::getInterfaceIcon(string_view name, int size, InterfaceTheme theme)
 {
@@ -550,16 +719,14 @@ wxBitmapBundle icons::getInterfaceIcon(string_view name, int size, InterfaceThem
 
 	// If there is SVG data use that
 	if (!icon_def->svg_data.empty())
-		return wxBitmapBundle::FromSVG(icon_def->svg_data.c_str(), { size, size });
+		return wxBitmapBundle::FromImpl(new SVGIconBundleImpl(*icon_def, size));
 
 	return wxNullBitmap;
 }
 #else
 // -----------------------------------------------------------------------------
 // Loads the interface icon [name] from [theme] into a wxBitmap of [size].
-//
-// NOTE: this does not use any kind of caching and will generate/load the icon
-// from svg/png data each time
+// The icon is cached per size (see rasteriseSVGIcon)
 // -----------------------------------------------------------------------------
 wxBitmap icons::getInterfaceIcon(string_view name, int size, InterfaceTheme theme)
 {
@@ -589,7 +756,7 @@ wxBitmap icons::getInterfaceIcon(string_view name, int size, InterfaceTheme them
 
 	// If there is SVG data use that
 	if (!icon_def->svg_data.empty())
-		return loadSVGIcon(icon_def->svg_data, size, {});
+		return loadSVGIcon(*icon_def, size, {});
 
 	return wxNullBitmap;
 }
@@ -0,0 +1,409 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    PNGOptimizer.cpp
+// Description: Built-in lossless PNG optimization. The image data is unfiltered
+//              and refiltered with each PNG filter strategy, and the smallest
+//              result after maximum-level deflate compression is kept.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "PNGOptimizer.h"
+#include "General/Misc.h"
+#include "Utility/Compression.h"
+#include "Utility/Memory.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr uint8_t PNG_SIGNATURE[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+constexpr size_t  MAX_RAW_SIZE     = 1 << 30; // Don't attempt anything bigger than this uncompressed
+
+// PNG scanline filter types
+enum Filter : uint8_t
+{
+	None = 0,
+	Sub,
+	Up,
+	Average,
+	Paeth
+};
+constexpr unsigned N_FILTERS = 5;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// A chunk within PNG data
+struct Chunk
+{
+	char           type[4];
+	const uint8_t* data;
+	uint32_t       size;
+};
+
+// Info from the IHDR chunk needed to (un)filter the image data
+struct ImageInfo
+{
+	uint32_t width     = 0;
+	uint32_t height    = 0;
+	unsigned row_bytes = 0; // Not including the filter type byte
+	unsigned bpp       = 0; // Bytes per complete pixel, at least 1 (as used by filters)
+};
+
+// -----------------------------------------------------------------------------
+// Reads all chunks in [png_data] to [chunks].
+// Returns false if the data isn't a valid PNG
+// -----------------------------------------------------------------------------
+bool readChunks(const MemChunk& png_data, vector<Chunk>& chunks)
+{
+	if (png_data.size() < 8 || memcmp(png_data.data(), PNG_SIGNATURE, 8) != 0)
+		return false;
+
+	const auto* data = png_data.data();
+	const auto  size = png_data.size();
+	unsigned    pos  = 8;
+	while (pos + 12 <= size)
+	{
+		Chunk chunk;
+		chunk.size = memory::readB32(data, pos);
+		memcpy(chunk.type, data + pos + 4, 4);
+		chunk.data = data + pos + 8;
+		if (chunk.size > size - pos - 12)
+			return false;
+
+		chunks.push_back(chunk);
+		pos += chunk.size + 12;
+
+		if (memcmp(chunk.type, "IEND", 4) == 0)
+			return true;
+	}
+
+	// No IEND chunk
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Reads image info from the IHDR chunk [ihdr] to [info].
+// Returns false if the image is invalid or unsupported (interlaced)
+// -----------------------------------------------------------------------------
+bool readHeader(const Chunk& ihdr, ImageInfo& info)
+{
+	if (memcmp(ihdr.type, "IHDR", 4) != 0 || ihdr.size != 13)
+		return false;
+
+	info.width  = memory::readB32(ihdr.data, 0);
+	info.height = memory::readB32(ihdr.data, 4);
+	if (info.width == 0 || info.height == 0)
+		return false;
+
+	// Only the standard compression and filter methods exist, and interlacing
+	// isn't supported here
+	const auto bit_depth   = ihdr.data[8];
+	const auto colour_type = ihdr.data[9];
+	if (ihdr.data[10] != 0 || ihdr.data[11] != 0 || ihdr.data[12] != 0)
+		return false;
+
+	// Check colour type and bit depth
+	unsigned channels;
+	switch (colour_type)
+	{
+	case 0: // Greyscale
+		channels = 1;
+		if (bit_depth != 1 && bit_depth != 2 && bit_depth != 4 && bit_depth != 8 && bit_depth != 16)
+			return false;
+		break;
+	case 3: // Paletted
+		channels = 1;
+		if (bit_depth != 1 && bit_depth != 2 && bit_depth != 4 && bit_depth != 8)
+			return false;
+		break;
+	case 2: // RGB
+	case 4: // Greyscale + alpha
+	case 6: // RGBA
+		channels = colour_type == 2 ? 3 : colour_type == 4 ? 2 : 4;
+		if (bit_depth != 8 && bit_depth != 16)
+			return false;
+		break;
+	default: return false;
+	}
+
+	const auto bits_per_pixel = channels * bit_depth;
+	const auto row_bytes      = (static_cast<uint64_t>(info.width) * bits_per_pixel + 7) / 8;
+	if ((row_bytes + 1) * info.height > MAX_RAW_SIZE)
+		return false;
+
+	info.row_bytes = static_cast<unsigned>(row_bytes);
+	info.bpp       = std::max<unsigned>(bits_per_pixel / 8, 1);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Paeth predictor function as defined in the PNG specification
+// -----------------------------------------------------------------------------
+inline uint8_t paeth(int a, int b, int c)
+{
+	const int p  = a + b - c;
+	const int pa = std::abs(p - a);
+	const int pb = std::abs(p - b);
+	const int pc = std::abs(p - c);
+	if (pa <= pb && pa <= pc)
+		return a;
+	return pb <= pc ? b : c;
+}
+
+// -----------------------------------------------------------------------------
+// Unfilters the image data in [raw] (filtered scanlines, each prefixed with
+// its filter type) to [pixels], with no filter type bytes.
+// Returns false if any scanline has an invalid filter type
+// -----------------------------------------------------------------------------
+bool unfilter(const ImageInfo& info, const uint8_t* raw, vector<uint8_t>& pixels)
+{
+	const auto row_bytes = info.row_bytes;
+	const auto bpp       = info.bpp;
+	pixels.resize(static_cast<size_t>(row_bytes) * info.height);
+
+	const vector<uint8_t> zero_row(row_bytes, 0);
+	for (unsigned y = 0; y < info.height; ++y)
+	{
+		const auto  filter = raw[0];
+		const auto* src    = raw + 1;
+		auto*       row    = pixels.data() + static_cast<size_t>(row_bytes) * y;
+		const auto* prev   = y > 0 ? row - row_bytes : zero_row.data();
+
+		switch (filter)
+		{
+		case None: memcpy(row, src, row_bytes); break;
+		case Sub:
+			for (unsigned x = 0; x < row_bytes; ++x)
+				row[x] = src[x] + (x >= bpp ? row[x - bpp] : 0);
+			break;
+		case Up:
+			for (unsigned x = 0; x < row_bytes; ++x)
+				row[x] = src[x] + prev[x];
+			break;
+		case Average:
+			for (unsigned x = 0; x < row_bytes; ++x)
+				row[x] = src[x] + (((x >= bpp ? row[x - bpp] : 0) + prev[x]) >> 1);
+			break;
+		case Paeth:
+			for (unsigned x = 0; x < row_bytes; ++x)
+				row[x] = src[x] + paeth(x >= bpp ? row[x - bpp] : 0, prev[x], x >= bpp ? prev[x - bpp] : 0);
+			break;
+		default: return false;
+		}
+
+		raw += row_bytes + 1;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes [row] filtered with [filter] to [out] (not including the filter type
+// byte), given the previous unfiltered row [prev]
+// -----------------------------------------------------------------------------
+void filterRow(uint8_t filter, const uint8_t* row, const uint8_t* prev, unsigned row_bytes, unsigned bpp, uint8_t* out)
+{
+	switch (filter)
+	{
+	case Sub:
+		for (unsigned x = 0; x < row_bytes; ++x)
+			out[x] = row[x] - (x >= bpp ? row[x - bpp] : 0);
+		break;
+	case Up:
+		for (unsigned x = 0; x < row_bytes; ++x)
+			out[x] = row[x] - prev[x];
+		break;
+	case Average:
+		for (unsigned x = 0; x < row_bytes; ++x)
+			out[x] = row[x] - (((x >= bpp ? row[x - bpp] : 0) + prev[x]) >> 1);
+		break;
+	case Paeth:
+		for (unsigned x = 0; x < row_bytes; ++x)
+			out[x] = row[x] - paeth(x >= bpp ? row[x - bpp] : 0, prev[x], x >= bpp ? prev[x - bpp] : 0);
+		break;
+	default: memcpy(out, row, row_bytes); break;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Filters the unfiltered image [pixels] to [raw], using [strategy] as the
+// filter for all scanlines, or if [strategy] is N_FILTERS, choosing the filter per scanline
+// with the lowest sum of absolute differences (the heuristic recommended by the
+// PNG specification)
+// -----------------------------------------------------------------------------
+void refilter(const ImageInfo& info, const vector<uint8_t>& pixels, unsigned strategy, MemChunk& raw)
+{
+	const auto row_bytes = info.row_bytes;
+	raw.reSize((row_bytes + 1) * info.height, false);
+
+	const vector<uint8_t> zero_row(row_bytes, 0);
+	vector<uint8_t>       test_row(row_bytes);
+	auto*                 out = raw.data();
+	for (unsigned y = 0; y < info.height; ++y)
+	{
+		const auto* row  = pixels.data() + static_cast<size_t>(row_bytes) * y;
+		const auto* prev = y > 0 ? row - row_bytes : zero_row.data();
+
+		auto row_filter = static_cast<uint8_t>(strategy);
+		if (strategy >= N_FILTERS)
+		{
+			// Find filter with the lowest sum of absolute differences
+			uint64_t best_sum = std::numeric_limits<uint64_t>::max();
+			for (uint8_t f = 0; f < N_FILTERS; ++f)
+			{
+				filterRow(f, row, prev, row_bytes, info.bpp, test_row.data());
+				uint64_t sum = 0;
+				for (auto val : test_row)
+					sum += val < 128 ? val : 256 - val;
+
+				if (sum < best_sum)
+				{
+					best_sum   = sum;
+					row_filter = f;
+				}
+			}
+		}
+
+		out[0] = row_filter;
+		filterRow(row_filter, row, prev, row_bytes, info.bpp, out + 1);
+		out += row_bytes + 1;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Writes a PNG chunk of [type] with [size] bytes of [data] to [out]
+// -----------------------------------------------------------------------------
+void writeChunk(MemChunk& out, const char* type, const uint8_t* data, uint32_t size)
+{
+	const uint8_t size_be[4] = { static_cast<uint8_t>(size >> 24),
+								 static_cast<uint8_t>(size >> 16),
+								 static_cast<uint8_t>(size >> 8),
+								 static_cast<uint8_t>(size) };
+	out.write(size_be, 4);
+	const auto type_pos = out.currentPos();
+	out.write(type, 4);
+	out.write(data, size);
+
+	// CRC covers the type and data
+	const auto    crc       = misc::crc(out.data() + type_pos, size + 4);
+	const uint8_t crc_be[4] = { static_cast<uint8_t>(crc >> 24),
+								static_cast<uint8_t>(crc >> 16),
+								static_cast<uint8_t>(crc >> 8),
+								static_cast<uint8_t>(crc) };
+	out.write(crc_be, 4);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Graphics Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Losslessly recompresses the PNG [png_data] to [out]. Returns false if the
+// data isn't a valid PNG or is unsupported (interlaced), in which case [out]
+// is untouched. Note that [out] may end up larger than the original if it was
+// already well optimized, this is left to the caller to check
+// -----------------------------------------------------------------------------
+bool gfx::pngOptimize(const MemChunk& png_data, MemChunk& out)
+{
+	// Read chunks
+	vector<Chunk> chunks;
+	if (!readChunks(png_data, chunks) || chunks.empty())
+		return false;
+
+	// Read header
+	ImageInfo info;
+	if (!readHeader(chunks[0], info))
+		return false;
+
+	// Concatenate IDAT chunks
+	MemChunk compressed;
+	unsigned first_idat = 0;
+	for (unsigned a = 0; a < chunks.size(); ++a)
+		if (memcmp(chunks[a].type, "IDAT", 4) == 0)
+		{
+			if (!compressed.hasData())
+				first_idat = a;
+			compressed.write(chunks[a].data, chunks[a].size);
+		}
+	if (!compressed.hasData())
+		return false;
+
+	// Inflate and unfilter image data
+	const auto raw_size = (info.row_bytes + 1) * info.height;
+	MemChunk   raw;
+	if (!compression::zlibInflate(compressed, raw, raw_size) || raw.size() != raw_size)
+		return false;
+	vector<uint8_t> pixels;
+	if (!unfilter(info, raw.data(), pixels))
+		return false;
+
+	// Try each filter strategy and keep the smallest result
+	MemChunk best;
+	MemChunk deflated;
+	for (unsigned f = 0; f <= N_FILTERS; ++f)
+	{
+		refilter(info, pixels, f, raw);
+		if (compression::zlibDeflateBest(raw, deflated) && (!best.hasData() || deflated.size() < best.size()))
+			best.importMem(deflated);
+	}
+	if (!best.hasData())
+		return false;
+
+	// Rebuild PNG with a single IDAT chunk in place of the original(s)
+	MemChunk png;
+	png.write(PNG_SIGNATURE, 8);
+	for (unsigned a = 0; a < chunks.size(); ++a)
+	{
+		if (a == first_idat)
+			writeChunk(png, "IDAT", best.data(), best.size());
+		else if (memcmp(chunks[a].type, "IDAT", 4) != 0)
+			png.write(chunks[a].data - 8, chunks[a].size + 12); // Keep other chunks exactly as they were
+	}
+
+	out.importMem(png);
+
+	return true;
+}
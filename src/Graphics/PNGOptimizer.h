@@ -0,0 +1,10 @@
+#pragma once
+
+namespace slade::gfx
+{
+// Losslessly recompresses PNG data without any external tools, by trying each
+// scanline filter strategy and deflating at the highest level available.
+// All chunks other than IDAT are kept as-is. Thread-safe, so many PNGs can be
+// optimized at once (see ArchivePanel::optimizePNG)
+bool pngOptimize(const MemChunk& png_data, MemChunk& out);
+} // namespace slade::gfx
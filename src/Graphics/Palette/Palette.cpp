@@ -32,6 +32,8 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "Palette.h"
+#include "General/Tasks.h"
+#include "Graphics/SImage/PixelKernels.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "Graphics/Translation.h"
 #include "Utility/CIEDeltaEquations.h"
@@ -55,6 +57,56 @@ CVAR(Float, col_match_l, 1.0, CVar::Flag::Save)
 EXTERN_CVAR(Float, col_greyscale_r)
 EXTERN_CVAR(Float, col_greyscale_g)
 EXTERN_CVAR(Float, col_greyscale_b)
+EXTERN_CVAR(Float, col_cie_kl)
+EXTERN_CVAR(Float, col_cie_k1)
+EXTERN_CVAR(Float, col_cie_k2)
+namespace
+{
+constexpr unsigned LUT_SIZE = 1 << 18; // Number of cells in nearest colour lookup tables
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the nearest colour lookup table cell for [colour]
+// -----------------------------------------------------------------------------
+unsigned lutCell(const ColRGBA& colour)
+{
+	return ((colour.r >> 2) << 12) | ((colour.g >> 2) << 6) | (colour.b >> 2);
+}
+
+// -----------------------------------------------------------------------------
+// Returns [colour] as a 24-bit RGB value
+// -----------------------------------------------------------------------------
+uint32_t rgbKey(const ColRGBA& colour)
+{
+	return (colour.r << 16) | (colour.g << 8) | colour.b;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the colour matching method to use for [match] (the col_match cvar
+// if [match] is Default)
+// -----------------------------------------------------------------------------
+Palette::ColourMatch colourMatch(Palette::ColourMatch match)
+{
+	using ColourMatch = Palette::ColourMatch;
+
+	// Be nice if there was an easier way to convert from int -> enum class,
+	// but then that's kind of the point of them I guess
+	static vector<ColourMatch> cm_convert = {
+		ColourMatch::Default, ColourMatch::Old, ColourMatch::RGB, ColourMatch::HSL,
+		ColourMatch::C76,     ColourMatch::C94, ColourMatch::C2K, ColourMatch::Stop,
+	};
+
+	return match == ColourMatch::Default ? cm_convert[col_match] : match;
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -109,6 +161,7 @@ bool Palette::loadMem(MemChunk& mc)
 			break;
 	}
 	mc.seek(0, SEEK_SET);
+	clearNearestLUTs();
 
 	return true;
 }
@@ -135,6 +188,7 @@ bool Palette::loadMem(const uint8_t* data, uint32_t size)
 		if (++c == 256)
 			break;
 	}
+	clearNearestLUTs();
 
 	return true;
 }
@@ -462,6 +516,7 @@ void Palette::setColour(uint8_t index, const ColRGBA& col)
 	colours_[index].index = index;
 	colours_lab_[index]   = colours_[index].asLAB();
 	colours_hsl_[index]   = colours_[index].asHSL();
+	clearNearestLUTs();
 }
 
 // -----------------------------------------------------------------------------
@@ -472,6 +527,7 @@ void Palette::setColourR(uint8_t index, uint8_t val)
 	colours_[index].r   = val;
 	colours_lab_[index] = colours_[index].asLAB();
 	colours_hsl_[index] = colours_[index].asHSL();
+	clearNearestLUTs();
 }
 
 // -----------------------------------------------------------------------------
@@ -482,6 +538,7 @@ void Palette::setColourG(uint8_t index, uint8_t val)
 	colours_[index].g   = val;
 	colours_lab_[index] = colours_[index].asLAB();
 	colours_hsl_[index] = colours_[index].asHSL();
+	clearNearestLUTs();
 }
 
 // -----------------------------------------------------------------------------
@@ -492,6 +549,7 @@ void Palette::setColourB(uint8_t index, uint8_t val)
 	colours_[index].b   = val;
 	colours_lab_[index] = colours_[index].asLAB();
 	colours_hsl_[index] = colours_[index].asHSL();
+	clearNearestLUTs();
 }
 
 // -----------------------------------------------------------------------------
@@ -527,6 +585,8 @@ void Palette::setGradient(uint8_t startIndex, uint8_t endIndex, const ColRGBA& s
 			a + startIndex);
 		colours_[a + startIndex].set(gradCol);
 	}
+
+	clearNearestLUTs();
 }
 
 // -----------------------------------------------------------------------------
@@ -604,24 +664,37 @@ double Palette::colourDiff(const ColRGBA& rgb, const ColHSL& hsl, const ColLAB&
 }
 
 // -----------------------------------------------------------------------------
-// Returns the index of the closest colour in the palette to [colour]
+// Returns the index of the closest colour in the palette to [colour].
+// Results are cached per colour matching method in a lookup table of 18-bit
+// (6 bits per channel) RGB cells, filled as needed with the nearest colour to
+// each cell's centre. Colours exactly matching a palette colour always return
+// that colour's index
 // -----------------------------------------------------------------------------
 short Palette::nearestColour(const ColRGBA& colour, ColourMatch match)
 {
+	match = colourMatch(match);
+	return nearestColourLUT(nearestLUT(match), colour, match);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the closest colour in the palette to [colour], by
+// comparing against every palette colour.
+// Slower than nearestColour but not affected by its lookup table precision,
+// so use this where exact results matter more than speed
+// -----------------------------------------------------------------------------
+short Palette::nearestColourExact(const ColRGBA& colour, ColourMatch match)
+{
+	match = colourMatch(match);
+
+	// CIE76/94 distances to all palette colours are calculated at once
+	if (match == ColourMatch::C76 || match == ColourMatch::C94)
+		return nearestColourLab(colour.asLAB(), match);
+
 	double min_d = 999999;
 	short  index = 0;
 	ColHSL chsl  = colour.asHSL();
 	ColLAB clab  = colour.asLAB();
 
-	// Be nice if there was an easier way to convert from int -> enum class,
-	// but then that's kind of the point of them I guess
-	static vector<ColourMatch> cm_convert = {
-		ColourMatch::Default, ColourMatch::Old, ColourMatch::RGB, ColourMatch::HSL,
-		ColourMatch::C76,     ColourMatch::C94, ColourMatch::C2K, ColourMatch::Stop,
-	};
-	if (match == ColourMatch::Default)
-		match = cm_convert[col_match];
-
 	double delta;
 	for (short a = 0; a < 256; a++)
 	{
@@ -640,6 +713,248 @@ short Palette::nearestColour(const ColRGBA& colour, ColourMatch match)
 	return index;
 }
 
+// -----------------------------------------------------------------------------
+// Writes the indices of the closest palette colours to [count] [rgba] pixels
+// (4 bytes per pixel) to [dest]. Gives the same results as calling
+// nearestColour for each pixel, but with the lookup table setup done once
+// -----------------------------------------------------------------------------
+void Palette::nearestColours(const uint8_t* rgba, uint8_t* dest, unsigned count, ColourMatch match)
+{
+	match     = colourMatch(match);
+	auto& lut = nearestLUT(match);
+
+	// Neighbouring pixels are often the same colour, so remember the last one
+	uint32_t last_key   = 0xFFFFFFFF;
+	uint8_t  last_index = 0;
+	for (unsigned a = 0; a < count; ++a)
+	{
+		const auto* pixel = rgba + a * 4;
+		uint32_t    key   = (pixel[0] << 16) | (pixel[1] << 8) | pixel[2];
+		if (key != last_key)
+		{
+			last_key   = key;
+			last_index = nearestColourLUT(lut, ColRGBA(pixel[0], pixel[1], pixel[2], 255), match);
+		}
+		dest[a] = last_index;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Writes the indices of the closest palette colours to [count] [rgba] pixels
+// (4 bytes per pixel) to [dest], using nearestColourExact. The pixels are
+// split into blocks that are processed in parallel on the task workers
+// -----------------------------------------------------------------------------
+void Palette::nearestColoursExact(const uint8_t* rgba, uint8_t* dest, unsigned count, ColourMatch match)
+{
+	match = colourMatch(match);
+
+	// Build Lab colours here first since it can't be done from multiple threads
+	if (match == ColourMatch::C76 || match == ColourMatch::C94)
+		labPalette();
+
+	// Match pixels in blocks on the task workers
+	tasks::parallelFor(
+		0,
+		count,
+		[&](unsigned index)
+		{
+			const auto* pixel = rgba + index * 4;
+			dest[index]       = nearestColourExact(ColRGBA(pixel[0], pixel[1], pixel[2], 255), match);
+		},
+		256);
+}
+
+// -----------------------------------------------------------------------------
+// Generates a Doom COLORMAP (34 maps of 256 palette indices) from the palette
+// into [mc], using the [match] colour matching method: 32 maps for diminishing
+// light levels, an inverted greyscale map (used for invulnerability) and an
+// empty (black) map
+// -----------------------------------------------------------------------------
+void Palette::generateColormap(MemChunk& mc, ColourMatch match)
+{
+	constexpr unsigned n_maps   = 34;
+	constexpr unsigned grey_map = 32;
+
+	// Build the target colour for each map entry
+	vector<uint8_t> targets(n_maps * 256 * 4);
+	for (unsigned l = 0; l < n_maps; ++l)
+	{
+		for (unsigned c = 0; c < 256; ++c)
+		{
+			auto rgb = colour(c);
+			if (l < grey_map)
+			{
+				// Diminish light level
+				auto diminish = [l](uint8_t col) { return static_cast<uint8_t>((col * (32.0 - l) + 16.0) / 32.0); };
+				rgb.r         = diminish(rgb.r);
+				rgb.g         = diminish(rgb.g);
+				rgb.b         = diminish(rgb.b);
+
+				// Point of mostly useless trivia: the green "light amp" colormap in the Press Release beta
+				// have colors that, on average, correspond to a bit less than (R*75/256, G*225/256, B*115/256)
+			}
+			else if (l == grey_map)
+			{
+				// Generate inverse map
+				float grey = (rgb.r / 256.0 * col_greyscale_r) + (rgb.g / 256.0 * col_greyscale_g)
+							 + (rgb.b / 256.0 * col_greyscale_b);
+				grey = 1.0 - grey;
+				// Clamp value: with Id Software's values, the sum is greater than 1.0 (0.299+0.587+0.144=1.030)
+				// This means the negation above can give a negative value (for example, with RGB values of 247 or
+				// more), which will not be converted correctly to unsigned 8-bit int in the ColRGBA struct.
+				if (grey < 0.0)
+					grey = 0;
+				rgb.r = rgb.g = rgb.b = grey * 255;
+			}
+			else
+			{
+				// Fill with 0
+				rgb = colour(0);
+			}
+
+			auto target = targets.data() + (l * 256 + c) * 4;
+			target[0]   = rgb.r;
+			target[1]   = rgb.g;
+			target[2]   = rgb.b;
+			target[3]   = 255;
+		}
+	}
+
+	// Find the nearest palette colour for each
+	mc.reSize(n_maps * 256, false);
+	nearestColoursExact(targets.data(), mc.data(), n_maps * 256, match);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the nearest colour lookup table for [match] (which must not be
+// Default), clearing it if the colour match weights have changed since it was
+// filled. Also builds the exact colour lookup if needed
+// -----------------------------------------------------------------------------
+Palette::NearestLUT& Palette::nearestLUT(ColourMatch match)
+{
+	// Build exact colour lookup if needed
+	if (exact_cells_.empty())
+	{
+		exact_cells_.resize(LUT_SIZE, false);
+		for (int a = static_cast<int>(std::min<size_t>(colours_.size(), 256)) - 1; a >= 0; a--)
+		{
+			exact_cells_[lutCell(colours_[a])]  = true;
+			exact_colours_[rgbKey(colours_[a])] = a; // Lowest index wins
+		}
+	}
+
+	auto& lut        = nearest_luts_[match];
+	float weights[3] = { 0.0f, 0.0f, 0.0f };
+	if (match == ColourMatch::RGB)
+	{
+		weights[0] = col_match_r;
+		weights[1] = col_match_g;
+		weights[2] = col_match_b;
+	}
+	else if (match == ColourMatch::HSL)
+	{
+		weights[0] = col_match_h;
+		weights[1] = col_match_s;
+		weights[2] = col_match_l;
+	}
+	if (lut.indices.empty() || lut.weights[0] != weights[0] || lut.weights[1] != weights[1]
+		|| lut.weights[2] != weights[2])
+	{
+		lut.indices.assign(LUT_SIZE, -1);
+		lut.weights[0] = weights[0];
+		lut.weights[1] = weights[1];
+		lut.weights[2] = weights[2];
+	}
+
+	return lut;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the closest colour in the palette to [colour], using
+// (and filling as needed) [lut], the lookup table for [match]
+// -----------------------------------------------------------------------------
+short Palette::nearestColourLUT(NearestLUT& lut, const ColRGBA& colour, ColourMatch match)
+{
+	// Check for an exact match
+	const auto cell = lutCell(colour);
+	if (exact_cells_[cell])
+	{
+		auto i = exact_colours_.find(rgbKey(colour));
+		if (i != exact_colours_.end())
+			return i->second;
+	}
+
+	// Find nearest colour to the cell centre if it isn't known yet
+	auto& index = lut.indices[cell];
+	if (index < 0)
+		index = nearestColourExact(
+			ColRGBA((colour.r & 0xFC) | 2, (colour.g & 0xFC) | 2, (colour.b & 0xFC) | 2, 255), match);
+
+	return index;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the closest colour in the palette to [lab], using the
+// CIE76 or CIE94 [match] method. The distances to all palette colours are
+// calculated together via pixelkernels
+// -----------------------------------------------------------------------------
+short Palette::nearestColourLab(const ColLAB& lab, ColourMatch match)
+{
+	float      dist[256];
+	const auto l = static_cast<float>(lab.l);
+	const auto a = static_cast<float>(lab.a);
+	const auto b = static_cast<float>(lab.b);
+	if (match == ColourMatch::C76)
+		pixelkernels::cie76Distances(labPalette(), l, a, b, dist);
+	else
+		pixelkernels::cie94Distances(labPalette(), l, a, b, col_cie_kl, col_cie_k1, col_cie_k2, dist);
+
+	// Lowest index wins if several colours are equally close
+	const auto n_colours = static_cast<short>(std::min<size_t>(colours_lab_.size(), 256));
+	short      index     = 0;
+	for (short c = 1; c < n_colours; c++)
+	{
+		if (dist[c] < dist[index])
+			index = c;
+	}
+
+	return index;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the palette's Lab colours for CIE76/94 distance calculations,
+// building them first if needed
+// -----------------------------------------------------------------------------
+const pixelkernels::LabPalette& Palette::labPalette()
+{
+	if (!lab_palette_)
+	{
+		auto pal = std::make_shared<pixelkernels::LabPalette>();
+		for (unsigned a = 0; a < std::min<size_t>(colours_lab_.size(), 256); a++)
+		{
+			const auto& col = colours_lab_[a];
+			pal->l[a]       = static_cast<float>(col.l);
+			pal->a[a]       = static_cast<float>(col.a);
+			pal->b[a]       = static_cast<float>(col.b);
+			pal->c[a]       = static_cast<float>(std::sqrt(col.a * col.a + col.b * col.b));
+		}
+		lab_palette_ = pal;
+	}
+
+	return *lab_palette_;
+}
+
+// -----------------------------------------------------------------------------
+// Clears all nearest colour lookup tables (the palette colours have changed)
+// -----------------------------------------------------------------------------
+void Palette::clearNearestLUTs()
+{
+	nearest_luts_.clear();
+	exact_cells_.clear();
+	exact_colours_.clear();
+	lab_palette_.reset();
+}
+
 // -----------------------------------------------------------------------------
 // Returns the number of unique colors in a palette
 // -----------------------------------------------------------------------------
@@ -680,8 +995,9 @@ void Palette::applyTranslation(Translation* trans)
 	temp.copyPalette(this);
 
 	// Translate colors
+	const auto& table = trans->compile(this);
 	for (size_t i = 0; i < 256; ++i)
-		temp.setColour(i, trans->translate(colours_[i], this));
+		temp.setColour(i, table.colour[i]);
 
 	// Load translated palette
 	copyPalette(&temp);
@@ -808,6 +1124,8 @@ void Palette::saturate(float amount, int start, int end)
 		colours_[i]     = colours_hsl_[i].asRGB();
 		colours_lab_[i] = colours_[i].asLAB();
 	}
+
+	clearNearestLUTs();
 }
 
 // -----------------------------------------------------------------------------
@@ -836,6 +1154,8 @@ void Palette::illuminate(float amount, int start, int end)
 		colours_[i]     = colours_hsl_[i].asRGB();
 		colours_lab_[i] = colours_[i].asLAB();
 	}
+
+	clearNearestLUTs();
 }
 
 // -----------------------------------------------------------------------------
@@ -864,6 +1184,8 @@ void Palette::shift(float amount, int start, int end)
 		colours_[i]     = colours_hsl_[i].asRGB();
 		colours_lab_[i] = colours_[i].asLAB();
 	}
+
+	clearNearestLUTs();
 }
 
 // -----------------------------------------------------------------------------
@@ -4,6 +4,10 @@
 namespace slade
 {
 class Translation;
+namespace pixelkernels
+{
+	struct LabPalette;
+}
 
 class Palette
 {
@@ -53,9 +57,18 @@ public:
 	void   copyPalette(const Palette* copy);
 	short  findColour(const ColRGBA& colour);
 	short  nearestColour(const ColRGBA& colour, ColourMatch match = ColourMatch::Default);
+	short  nearestColourExact(const ColRGBA& colour, ColourMatch match = ColourMatch::Default);
 	size_t countColours();
 	void   applyTranslation(Translation* trans);
 
+	// Nearest colours for [count] RGBA pixels at once
+	void nearestColours(const uint8_t* rgba, uint8_t* dest, unsigned count, ColourMatch match = ColourMatch::Default);
+	void nearestColoursExact(
+		const uint8_t* rgba,
+		uint8_t*       dest,
+		unsigned       count,
+		ColourMatch    match = ColourMatch::Default);
+
 	// Advanced palette modification
 	void colourise(const ColRGBA& col, int start, int end);
 	void tint(const ColRGBA& col, float amount, int start, int end);
@@ -67,6 +80,7 @@ public:
 
 	// For automated palette generation
 	void idtint(int r, int g, int b, int shift, int steps);
+	void generateColormap(MemChunk& mc, ColourMatch match = ColourMatch::Default);
 
 private:
 	vector<ColRGBA> colours_;
@@ -74,6 +88,23 @@ private:
 	vector<ColLAB>  colours_lab_;
 	short           index_trans_;
 
-	double colourDiff(const ColRGBA& rgb, const ColHSL& hsl, const ColLAB& lab, int index, ColourMatch match);
+	// Nearest colour lookup (see nearestColour)
+	struct NearestLUT
+	{
+		vector<short> indices;                  // Nearest colour index for each 18-bit RGB cell (-1 if not found yet)
+		float         weights[3] = { 0, 0, 0 }; // Colour match weights used (RGB/HSL matching only)
+	};
+	std::map<ColourMatch, NearestLUT>          nearest_luts_;
+	vector<bool>                               exact_cells_;   // Cells containing palette colours
+	std::unordered_map<uint32_t, short>        exact_colours_; // Palette index of each (24-bit RGB) palette colour
+	shared_ptr<const pixelkernels::LabPalette> lab_palette_;   // Lab colours for CIE76/94 batches (built as needed)
+
+	double      colourDiff(const ColRGBA& rgb, const ColHSL& hsl, const ColLAB& lab, int index, ColourMatch match);
+	NearestLUT& nearestLUT(ColourMatch match);
+	short       nearestColourLUT(NearestLUT& lut, const ColRGBA& colour, ColourMatch match);
+	short       nearestColourLab(const ColLAB& lab, ColourMatch match);
+	void        clearNearestLUTs();
+
+	const pixelkernels::LabPalette& labPalette();
 };
 } // namespace slade
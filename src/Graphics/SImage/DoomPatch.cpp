@@ -0,0 +1,233 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    DoomPatch.cpp
+// Description: Functions for reading Doom-format (column/post) patch graphics.
+//              The header and column offsets are validated once by
+//              readLayout, which is used both when detecting the format and
+//              when decoding, so that decode only needs to bounds check each
+//              post rather than each pixel
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "DoomPatch.h"
+#include "Graphics/GameFormats.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Reads the [count] column offsets of [size] bytes each starting at [table]
+// into [offsets]. The table isn't necessarily aligned so each offset is copied
+// out before byteswapping
+// -----------------------------------------------------------------------------
+void readColumnOffsets(const uint8_t* table, unsigned size, int count, vector<uint32_t>& offsets)
+{
+	offsets.resize(count);
+	if (size == 4)
+	{
+		uint32_t offset;
+		for (int a = 0; a < count; a++)
+		{
+			memcpy(&offset, table + a * 4, 4);
+			offsets[a] = wxUINT32_SWAP_ON_BE(offset);
+		}
+	}
+	else
+	{
+		uint16_t offset;
+		for (int a = 0; a < count; a++)
+		{
+			memcpy(&offset, table + a * 2, 2);
+			offsets[a] = wxUINT16_SWAP_ON_BE(offset);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Copies the column-major [src] image of [width]x[height] pixels to row-major
+// [dest]. Done in square blocks so both sides stay in cache for large images
+// -----------------------------------------------------------------------------
+void transpose(const uint8_t* src, uint8_t* dest, int width, int height)
+{
+	static constexpr int block = 32;
+
+	for (int c0 = 0; c0 < width; c0 += block)
+	{
+		int c1 = std::min(c0 + block, width);
+		for (int r0 = 0; r0 < height; r0 += block)
+		{
+			int r1 = std::min(r0 + block, height);
+			for (int r = r0; r < r1; r++)
+				for (int c = c0; c < c1; c++)
+					dest[r * width + c] = src[c * height + r];
+		}
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// DoomPatch Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Reads the header and column offsets of the [version] format patch in [data]
+// into [layout], in a single pass. Returns false if the header is truncated,
+// the dimensions are invalid or any column offset is outside of the data
+// -----------------------------------------------------------------------------
+bool doompatch::readLayout(const MemChunk& data, Version version, Layout& layout)
+{
+	auto gfx_data = data.data();
+
+	// Read header
+	if (version == Version::Alpha)
+	{
+		if (data.size() <= sizeof(gfx::OldPatchHeader))
+			return false;
+
+		layout.width    = gfx_data[0];
+		layout.height   = gfx_data[1];
+		layout.offset_x = static_cast<int8_t>(gfx_data[2]);
+		layout.offset_y = static_cast<int8_t>(gfx_data[3]);
+		layout.hdr_size = sizeof(gfx::OldPatchHeader);
+	}
+	else
+	{
+		if (data.size() <= sizeof(gfx::PatchHeader))
+			return false;
+
+		gfx::PatchHeader header;
+		memcpy(&header, gfx_data, sizeof(gfx::PatchHeader));
+		layout.width    = wxINT16_SWAP_ON_BE(header.width);
+		layout.height   = wxINT16_SWAP_ON_BE(header.height);
+		layout.offset_x = wxINT16_SWAP_ON_BE(header.left);
+		layout.offset_y = wxINT16_SWAP_ON_BE(header.top);
+		layout.hdr_size = sizeof(gfx::PatchHeader);
+	}
+
+	if (layout.width <= 0 || layout.height <= 0)
+		return false;
+
+	// Check there is room for the column offsets
+	unsigned offset_size = version == Version::Doom ? 4 : 2;
+	if (data.size() < layout.hdr_size + layout.width * offset_size)
+		return false;
+
+	// Read column offsets and check they are within the data
+	readColumnOffsets(gfx_data + layout.hdr_size, offset_size, layout.width, layout.col_offsets);
+	for (auto offset : layout.col_offsets)
+		if (offset < layout.hdr_size || offset >= data.size())
+			return false;
+
+	// Check for the Pleiades hack:
+	// Roger Ritenour's pleiades.wad for ZDoom uses 256-tall sky textures,
+	// and since the patch format uses 8-bit values for the length of a column,
+	// the 256 height overflows to 0. To detect this situation, we check if
+	// every column represents precisely 261 bytes, in other words just enough
+	// for a single post of 256 pixels.
+	layout.pleiades_hack = false;
+	if (layout.height == 256)
+	{
+		layout.pleiades_hack = data.size() - layout.col_offsets.back() == 261;
+		for (int c = 1; c < layout.width && layout.pleiades_hack; ++c)
+			if (layout.col_offsets[c] - layout.col_offsets[c - 1] != 261)
+				layout.pleiades_hack = false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Decodes the [version] format patch in [data] (with [layout] as read by
+// readLayout) to row-major [pixels] and [mask], which must both be
+// width*height bytes. Posts are copied whole into a column-major buffer and
+// clipped to the image height and the end of the data, then the buffer is
+// transposed to the output
+// -----------------------------------------------------------------------------
+void doompatch::decode(const MemChunk& data, const Layout& layout, Version version, uint8_t* pixels, uint8_t* mask)
+{
+	auto width    = layout.width;
+	auto height   = layout.height;
+	auto gfx_data = data.data();
+	auto gfx_end  = gfx_data + data.size();
+	auto post_pad = version == Version::Doom ? 1 : 0; // Unused byte before and after each post's pixels
+
+	vector<uint8_t> col_pixels(width * height, 0); // Palette index 0
+	vector<uint8_t> col_mask(width * height, 0);   // Fully transparent
+
+	for (int c = 0; c < width; c++)
+	{
+		auto bits          = gfx_data + layout.col_offsets[c];
+		auto col_data      = col_pixels.data() + c * height;
+		auto col_mask_data = col_mask.data() + c * height;
+
+		// Read posts
+		int top = -1;
+		while (bits + 1 < gfx_end && *bits != 0xFF)
+		{
+			// Get row offset (relative to the previous post for tall patches)
+			int row = *bits;
+			if (row <= top && version == Version::Doom)
+				top += row;
+			else
+				top = row;
+
+			// Get no. of pixels (if this is a Pleiades sky, the height is 256)
+			int n_pix = layout.pleiades_hack ? 256 : bits[1];
+
+			// Copy as much of the post as is within the image and the data
+			auto post_start = bits + 2 + post_pad;
+			if (post_start >= gfx_end)
+				break;
+			auto count = std::min<ptrdiff_t>({ n_pix, height - top, gfx_end - post_start });
+			if (count > 0)
+			{
+				memcpy(col_data + top, post_start, count);
+				memset(col_mask_data + top, 255, count);
+			}
+
+			// Go to next post
+			if (gfx_end - post_start <= n_pix + post_pad)
+				break;
+			bits = post_start + n_pix + post_pad;
+		}
+	}
+
+	transpose(col_pixels.data(), pixels, width, height);
+	transpose(col_mask.data(), mask, width, height);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+// Reading of Doom-format (column/post) patch graphics, shared between format
+// detection (EntryDataFormat) and decoding (SIFDoomGfx and its variants)
+namespace slade::doompatch
+{
+enum class Version
+{
+	Doom,  // 8-byte header, 32-bit column offsets, tall patch support
+	Beta,  // 8-byte header, 16-bit column offsets
+	Alpha, // 4-byte header, 16-bit column offsets
+};
+
+// The header and (byteswapped) column offsets of a patch
+struct Layout
+{
+	int              width    = 0;
+	int              height   = 0;
+	int              offset_x = 0;
+	int              offset_y = 0;
+	unsigned         hdr_size = 0;
+	vector<uint32_t> col_offsets;
+	bool             pleiades_hack = false; // Single 256-pixel post per column (see readLayout)
+};
+
+bool readLayout(const MemChunk& data, Version version, Layout& layout);
+void decode(const MemChunk& data, const Layout& layout, Version version, uint8_t* pixels, uint8_t* mask);
+} // namespace slade::doompatch
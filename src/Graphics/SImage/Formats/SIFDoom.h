@@ -1,5 +1,6 @@
 
 #include "Graphics/GameFormats.h"
+#include "Graphics/SImage/DoomPatch.h"
 
 class SIFDoomGfx : public SIFormat
 {
@@ -10,7 +11,7 @@ public:
 	}
 	~SIFDoomGfx() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		if (EntryDataFormat::format("img_doom")->isThisFormat(mc))
 			return true;
@@ -18,13 +19,13 @@ public:
 			return false;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
 		// Read header
 		gfx::PatchHeader hdr;
-		mc.read(&hdr, 8, 0);
+		mc.read(0, &hdr, 8);
 
 		// Setup info
 		info.width       = hdr.width;
@@ -81,157 +82,26 @@ public:
 	}
 
 protected:
-	bool readDoomFormat(SImage& image, MemChunk& data, int version) const
+	bool readDoomFormat(SImage& image, const MemChunk& data, int version) const
 	{
-		// Init variables
-		auto gfx_data = data.data();
-		int  width    = 0;
-		int  height   = 0;
-		int  offset_x = 0;
-		int  offset_y = 0;
-
-		// Read header
-		uint8_t hdr_size = 0;
-		if (version > 1)
-		{
-			width    = gfx_data[0];
-			height   = gfx_data[1];
-			offset_x = (int8_t)gfx_data[2];
-			offset_y = (int8_t)gfx_data[3];
-			hdr_size = 4;
-		}
-		else
-		{
-			auto header = (gfx::PatchHeader*)gfx_data;
-			width       = wxINT16_SWAP_ON_BE(header->width);
-			height      = wxINT16_SWAP_ON_BE(header->height);
-			offset_x    = wxINT16_SWAP_ON_BE(header->left);
-			offset_y    = wxINT16_SWAP_ON_BE(header->top);
-			hdr_size    = 8;
-		}
-
-		// Create image
-		image.create(width, height, SImage::Type::PalMask);
-
-		// Read column offsets
-		vector<uint32_t> col_offsets(width);
-		if (version > 0)
-		{
-			auto c_ofs = (uint16_t*)((uint8_t*)gfx_data + hdr_size);
-			for (int a = 0; a < width; a++)
-				col_offsets[a] = wxUINT16_SWAP_ON_BE(c_ofs[a]);
-		}
-		else
-		{
-			auto c_ofs = (uint32_t*)((uint8_t*)gfx_data + hdr_size);
-			for (int a = 0; a < width; a++)
-				col_offsets[a] = wxUINT32_SWAP_ON_BE(c_ofs[a]);
-		}
-
-		// Load data
-		uint8_t* img_data = imageData(image);
-		memset(img_data, 0, width * height); // Set colour to palette index 0
-		uint8_t* img_mask = imageMask(image);
-		memset(img_mask, 0, width * height); // Set mask to fully transparent
-
-		// Check for the Pleiades hack:
-		// Roger Ritenour's pleiades.wad for ZDoom uses 256-tall sky textures,
-		// and since the patch format uses 8-bit values for the length of a column,
-		// the 256 height overflows to 0. To detect this situation, we check if
-		// every column represents precisely 261 bytes, in other words just enough
-		// for a single post of 256 pixels.
-		bool pleiadeshack = false;
-		if (height == 256)
-		{
-			pleiadeshack = true;
-			for (int c = 1; c < width; ++c)
-			{
-				if (col_offsets[c] - col_offsets[c - 1] != 261)
-				{
-					pleiadeshack = false;
-					break;
-				}
-			}
-			if (data.size() - col_offsets[width - 1] != 261)
-				pleiadeshack = false;
-		}
-
-		// Load data
-		for (int c = 0; c < width; c++)
-		{
-			// Get current column offset (byteswap if needed)
-			auto col_offset = col_offsets[c]; // wxUINT32_SWAP_ON_BE(col_offsets[c]);
-
-			// Check column offset is valid
-			if (col_offset >= data.size())
-				return false;
-
-			// Go to start of column
-			const uint8_t* bits = gfx_data;
-			bits += col_offset;
-
-			// Read posts
-			int top = -1;
-			while (true)
-			{
-				// Get row offset
-				auto row = *bits;
-
-				if (row == 0xFF) // End of column?
-					break;
-
-				// Tall patches support
-				if (row <= top && version == 0)
-					top += row;
-				else
-					top = row;
-
-				// Get no. of pixels
-				bits++;
-				uint16_t n_pix = *bits;
-
-				// If this is a Pleiades sky, the height is 256.
-				if (pleiadeshack)
-					n_pix = 256;
-
-				if (version == 0)
-					bits++; // Skip buffer
-				for (uint16_t p = 0; p < n_pix; p++)
-				{
-					// Get pixel position
-					bits++;
-					int pos = ((top + p) * width + c);
-
-					// Stop if we're outside the image
-					if (pos >= width * height)
-						break;
-
-					// Stop if for some reason we're outside the gfx data
-					if (bits >= gfx_data + data.size())
-						break;
-
-					// Fail if bogus data gives a negative pos (this corrupts the heap!)
-					if (pos < 0)
-						return false;
+		// Read and validate header and column offsets
+		auto              patch_version = static_cast<doompatch::Version>(version);
+		doompatch::Layout layout;
+		if (!doompatch::readLayout(data, patch_version, layout))
+			return false;
 
-					// Write pixel data
-					img_data[pos] = *bits;
-					img_mask[pos] = 255;
-				}
-				if (version == 0)
-					bits++; // Skip buffer
-				bits++;     // Go to next row offset
-			}
-		}
+		// Create image and decode column posts
+		image.create(layout.width, layout.height, SImage::Type::PalMask);
+		doompatch::decode(data, layout, patch_version, imageData(image), imageMask(image));
 
 		// Setup variables
-		image.setXOffset(offset_x);
-		image.setYOffset(offset_y);
+		image.setXOffset(layout.offset_x);
+		image.setYOffset(layout.offset_y);
 
 		return true;
 	}
 
-	bool readImage(SImage& image, MemChunk& data, int index) override { return readDoomFormat(image, data, 0); }
+	bool readImage(SImage& image, const MemChunk& data, int index) override { return readDoomFormat(image, data, 0); }
 
 	bool writeImage(SImage& image, MemChunk& out, Palette* pal, int index) override
 	{
@@ -434,9 +304,12 @@ public:
 	SIFDoomBetaGfx() : SIFDoomGfx("doom_beta", "Doom Gfx (Beta)", 160) {}
 	~SIFDoomBetaGfx() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_beta")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override
+	{
+		return EntryDataFormat::format("img_doom_beta")->isThisFormat(mc);
+	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		auto info   = SIFDoomGfx::info(mc, index);
 		info.format = id_;
@@ -449,7 +322,7 @@ public:
 	bool     convertWritable(SImage& image, ConvertOptions opt) override { return false; }
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override { return readDoomFormat(image, data, 1); }
+	bool readImage(SImage& image, const MemChunk& data, int index) override { return readDoomFormat(image, data, 1); }
 };
 
 class SIFDoomAlphaGfx : public SIFDoomGfx
@@ -458,9 +331,12 @@ public:
 	SIFDoomAlphaGfx() : SIFDoomGfx("doom_alpha", "Doom Gfx (Alpha)", 100) {}
 	~SIFDoomAlphaGfx() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_alpha")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override
+	{
+		return EntryDataFormat::format("img_doom_alpha")->isThisFormat(mc);
+	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -481,7 +357,7 @@ public:
 	bool     convertWritable(SImage& image, ConvertOptions opt) override { return false; }
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override { return readDoomFormat(image, data, 2); }
+	bool readImage(SImage& image, const MemChunk& data, int index) override { return readDoomFormat(image, data, 2); }
 };
 
 class SIFDoomArah : public SIFormat
@@ -490,15 +366,18 @@ public:
 	SIFDoomArah() : SIFormat("doom_arah", "Doom Arah", "lmp", 100) {}
 	~SIFDoomArah() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_arah")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override
+	{
+		return EntryDataFormat::format("img_doom_arah")->isThisFormat(mc);
+	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
 		// Read header
 		gfx::PatchHeader header;
-		mc.read(&header, 8, 0);
+		mc.read(0, &header, 8);
 
 		// Set info
 		info.width     = wxINT16_SWAP_ON_BE(header.width);
@@ -512,11 +391,11 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Setup variables
 		gfx::PatchHeader header;
-		data.read(&header, 8, 0);
+		data.read(0, &header, 8);
 		int width    = wxINT16_SWAP_ON_BE(header.width);
 		int height   = wxINT16_SWAP_ON_BE(header.height);
 		int offset_x = wxINT16_SWAP_ON_BE(header.left);
@@ -528,7 +407,7 @@ protected:
 		uint8_t* img_mask = imageMask(image);
 
 		// Read raw pixel data
-		data.read(img_data, width * height, 8);
+		data.read(8, img_data, width * height);
 
 		// Create mask (all opaque)
 		memset(img_mask, 255, width * height);
@@ -552,9 +431,12 @@ public:
 	SIFDoomSnea() : SIFormat("doom_snea", "Doom Snea", "lmp") {}
 	~SIFDoomSnea() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_snea")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override
+	{
+		return EntryDataFormat::format("img_doom_snea")->isThisFormat(mc);
+	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -569,7 +451,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Check/setup size
 		uint8_t qwidth = data[0];
@@ -684,15 +566,15 @@ public:
 	SIFDoomPSX() : SIFormat("doom_psx", "Doom PSX", "lmp", 100) {}
 	~SIFDoomPSX() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_psx")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_doom_psx")->isThisFormat(mc); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
 		// Read header
 		gfx::PatchHeader header;
-		mc.read(&header, 8, 0);
+		mc.read(0, &header, 8);
 
 		// Set info
 		info.width     = wxINT16_SWAP_ON_BE(header.width);
@@ -742,11 +624,11 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Setup variables
 		gfx::PSXPicHeader header;
-		data.read(&header, 8, 0);
+		data.read(0, &header, 8);
 		int width    = wxINT16_SWAP_ON_BE(header.width);
 		int height   = wxINT16_SWAP_ON_BE(header.height);
 		int offset_x = wxINT16_SWAP_ON_BE(header.left);
@@ -758,7 +640,7 @@ protected:
 		auto img_mask = imageMask(image);
 
 		// Read raw pixel data
-		data.read(img_data, width * height, 8);
+		data.read(8, img_data, width * height);
 
 		// Create mask (all opaque)
 		memset(img_mask, 255, width * height);
@@ -845,15 +727,18 @@ public:
 	}
 	~SIFDoomJaguar() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_jaguar")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override
+	{
+		return EntryDataFormat::format("img_doom_jaguar")->isThisFormat(mc);
+	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
 		// Read header
 		gfx::JagPicHeader header;
-		mc.read(&header, 16, 0);
+		mc.read(0, &header, 16);
 
 		// Set info
 		info.width     = wxINT16_SWAP_ON_LE(header.width);
@@ -901,11 +786,11 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Setup variables
 		gfx::JagPicHeader header;
-		data.read(&header, 16, 0);
+		data.read(0, &header, 16);
 		int width  = wxINT16_SWAP_ON_LE(header.width);
 		int height = wxINT16_SWAP_ON_LE(header.height);
 		int depth  = wxINT16_SWAP_ON_LE(header.depth);
@@ -933,7 +818,7 @@ protected:
 		// Read raw pixel data
 		if (depth == 3)
 		{
-			data.read(img_data, width * height);
+			data.read(16, img_data, width * height);
 		}
 		else if (depth == 2)
 		{
@@ -1010,7 +895,7 @@ public:
 	SIFDoomJaguarColMajor() : SIFDoomJaguar(1, "doom_jaguar_colmajor", "Doom Jaguar CM") {}
 	~SIFDoomJaguarColMajor() final = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_doom_jaguar_colmajor")->isThisFormat(mc);
 	}
@@ -5,7 +5,7 @@ public:
 	SIFPlanar() : SIFormat("planar", "Planar", "lmp", 240) {}
 	~SIFPlanar() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		// Can only go by image size
 		if (mc.size() == 153648)
@@ -14,7 +14,7 @@ public:
 			return false;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -65,7 +65,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Variables
 		Palette palette;
@@ -244,13 +244,13 @@ public:
 	SIF4BitChunk() : SIFormat("4bit", "4-bit", "lmp", 80) {}
 	~SIF4BitChunk() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		// Can only detect by size
 		return (mc.size() == 32 || mc.size() == 184);
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -295,7 +295,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		int width, height;
 
@@ -10,21 +10,26 @@ public:
 	uint32_t  crc() const { return crc_; }
 	MemChunk& data() { return data_; }
 
-	void read(MemChunk& mc)
+	// Reads the chunk at [offset] in [mc], advancing [offset] past what was read
+	void read(const MemChunk& mc, unsigned& offset)
 	{
 		// Read size and chunk name
-		mc.read(&size_, 4);
-		mc.read(name_, 4);
+		if (mc.read(offset, &size_, 4))
+			offset += 4;
+		if (mc.read(offset, name_, 4))
+			offset += 4;
 
 		// Endianness correction
 		size_ = wxUINT32_SWAP_ON_LE(size_);
 
 		// Read chunk data
 		data_.clear();
-		mc.readMC(data_, size_);
+		if (offset + size_ < mc.size() && data_.write(mc.data() + offset, size_))
+			offset += size_;
 
 		// Read crc
-		mc.read(&crc_, 4);
+		if (mc.read(offset, &crc_, 4))
+			offset += 4;
 
 		// Endianness correction
 		crc_ = wxUINT32_SWAP_ON_LE(crc_);
@@ -77,13 +82,10 @@ private:
 class SIFPng : public SIFormat
 {
 public:
-	SIFPng() : SIFormat("png", "PNG", "png") {}
+	SIFPng() : SIFormat("png", "PNG", "png") { data_format_ = "img_png"; }
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
-		// Reset MemChunk
-		mc.seek(0, SEEK_SET);
-
 		// Check size
 		if (mc.size() > 8)
 		{
@@ -96,7 +98,7 @@ public:
 		return false;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info inf;
 		inf.format = "png";
@@ -104,9 +106,9 @@ public:
 		inf.height = 0;
 
 		// Read first chunk
-		mc.seek(8, SEEK_SET);
+		unsigned offset = 8;
 		PNGChunk chunk;
-		chunk.read(mc);
+		chunk.read(mc, offset);
 		// Should be IHDR
 		int bpp = 32;
 		if (chunk.name() == "IHDR")
@@ -132,7 +134,7 @@ public:
 		// Look for other info chunks (grAb or alPh)
 		while (true)
 		{
-			chunk.read(mc);
+			chunk.read(mc, offset);
 
 			// Set format to alpha map if alPh present (and 8bpp)
 			if (bpp == 8 && chunk.name() == "alPh")
@@ -230,7 +232,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Create FreeImage bitmap from entry data
 		auto mem = FreeImage_OpenMemory((BYTE*)data.data(), data.size());
@@ -256,12 +258,12 @@ protected:
 		int32_t yoff       = 0;
 		bool    alPh_chunk = false;
 		bool    grAb_chunk = false;
-		data.seek(8, SEEK_SET); // Start after PNG header
+		unsigned offset = 8; // Start after PNG header
 		PNGChunk chunk;
 		while (true)
 		{
 			// Read next PNG chunk
-			chunk.read(data);
+			chunk.read(data, offset);
 
 			// Check for 'grAb' chunk
 			if (!grAb_chunk && chunk.name() == "grAb")
@@ -5,12 +5,12 @@ public:
 	SIFHalfLifeTex() : SIFormat("hlt", "Half-Life Texture", "hlt", 20) {}
 	~SIFHalfLifeTex() {}
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_hlt")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -25,7 +25,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		auto info = this->info(data, index);
@@ -84,12 +84,12 @@ public:
 	SIFSCSprite() : SIFormat("scsprite", "Shadowcaster Sprite", "dat", 110) {}
 	~SIFSCSprite() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_scsprite")->isThisFormat(mc) >= EntryDataFormat::MATCH_UNLIKELY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		int          size = mc.size();
 		SImage::Info info;
@@ -133,7 +133,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get width & height
 		auto info = this->info(data, index);
@@ -187,18 +187,18 @@ public:
 	SIFSCGfx() : SIFormat("scgfx", "Shadowcaster Gfx", "dat", 100) {}
 	~SIFSCGfx() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_scgfx")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
 		// Read header
 		gfx::PatchHeader header;
-		mc.read(&header, 8, 0);
+		mc.read(0, &header, 8);
 
 		// Set info
 		info.width     = wxINT16_SWAP_ON_BE(header.width);
@@ -212,11 +212,11 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Setup variables
 		gfx::PatchHeader header;
-		data.read(&header, 8, 0);
+		data.read(0, &header, 8);
 		int width    = wxINT16_SWAP_ON_BE(header.width);
 		int height   = wxINT16_SWAP_ON_BE(header.height);
 		int offset_x = wxINT16_SWAP_ON_BE(header.left);
@@ -228,7 +228,7 @@ protected:
 		auto img_mask = imageMask(image);
 
 		// Read raw pixel data
-		data.read(img_data, width * height, 8);
+		data.read(8, img_data, width * height);
 
 		// Create mask (all opaque)
 		memset(img_mask, 255, width * height);
@@ -257,7 +257,7 @@ public:
 	}
 	~SIFSCWall() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		if (EntryDataFormat::format("img_scwall")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY)
 			return true;
@@ -265,7 +265,7 @@ public:
 			return false;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -279,7 +279,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		static const int HEADEROFFSET = 130;
 
@@ -325,12 +325,12 @@ public:
 	SIFAnaMip() : SIFormat("mipimage", "Amulets & Armor", "dat", 100) {}
 	~SIFAnaMip() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_mipimage")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -348,7 +348,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		auto info = this->info(data, index);
@@ -362,7 +362,7 @@ protected:
 		image.fillAlpha(255);
 
 		// Read data
-		data.read(imageData(image), info.width * info.height, 4);
+		data.read(4, imageData(image), info.width * info.height);
 
 		return true;
 	}
@@ -374,12 +374,12 @@ public:
 	SIFBuildTile() : SIFormat("arttile", "Build ART", "art", 100) {}
 	~SIFBuildTile() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_arttile")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -390,7 +390,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get info and data start
 		SImage::Info info;
@@ -409,7 +409,7 @@ protected:
 		// Read data
 		auto img_data = imageData(image);
 		auto img_mask = imageMask(image);
-		data.read(img_data, info.width * info.height, datastart);
+		data.read(datastart, img_data, info.width * info.height);
 
 		// Create mask
 		for (int a = 0; a < info.width * info.height; a++)
@@ -432,7 +432,7 @@ protected:
 	}
 
 private:
-	unsigned getTileInfo(SImage::Info& info, MemChunk& mc, int index) const
+	unsigned getTileInfo(SImage::Info& info, const MemChunk& mc, int index) const
 	{
 		size_t headeroffset = 0;
 
@@ -500,15 +500,15 @@ private:
 class SIFHeretic2M8 : public SIFormat
 {
 public:
-	SIFHeretic2M8() : SIFormat("m8", "Heretic 2 8bpp", "dat", 80) {}
+	SIFHeretic2M8() : SIFormat("m8", "Heretic 2 8bpp", "dat", 80) { data_format_ = "img_m8"; }
 	~SIFHeretic2M8() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_m8")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -518,7 +518,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get miplevel info and offset
 		SImage::Info info;
@@ -544,13 +544,13 @@ protected:
 		image.fillAlpha(255);
 
 		// Read image data
-		data.read(imageData(image), info.width * info.height, datastart);
+		data.read(datastart, imageData(image), info.width * info.height);
 
 		return true;
 	}
 
 private:
-	unsigned getLevelInfo(SImage::Info& info, MemChunk& mc, int index) const
+	unsigned getLevelInfo(SImage::Info& info, const MemChunk& mc, int index) const
 	{
 		// Check size
 		if (mc.size() < 1040)
@@ -577,15 +577,15 @@ private:
 class SIFHeretic2M32 : public SIFormat
 {
 public:
-	SIFHeretic2M32() : SIFormat("m32", "Heretic 2 32bpp", "dat", 80) {}
+	SIFHeretic2M32() : SIFormat("m32", "Heretic 2 32bpp", "dat", 80) { data_format_ = "img_m32"; }
 	~SIFHeretic2M32() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_m32")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -595,7 +595,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get miplevel info and offset
 		SImage::Info info;
@@ -610,13 +610,13 @@ protected:
 		image.fillAlpha(255);
 
 		// Read image data
-		data.read(imageData(image), info.width * info.height * 4, datastart);
+		data.read(datastart, imageData(image), info.width * info.height * 4);
 
 		return true;
 	}
 
 private:
-	unsigned getLevelInfo(SImage::Info& info, MemChunk& mc, int index) const
+	unsigned getLevelInfo(SImage::Info& info, const MemChunk& mc, int index) const
 	{
 		// Check size
 		if (mc.size() < 968)
@@ -645,12 +645,12 @@ public:
 	SIFWolfPic() : SIFormat("wolfpic", "Wolf3d Pic", "dat", 200) {}
 	~SIFWolfPic() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_wolfpic")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -666,7 +666,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		auto info = this->info(data, index);
@@ -704,12 +704,12 @@ public:
 	SIFWolfSprite() : SIFormat("wolfsprite", "Wolf3d Sprite", "dat", 200) {}
 	~SIFWolfSprite() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_wolfsprite")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -730,7 +730,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		auto info = this->info(data, index);
@@ -5,9 +5,9 @@ public:
 	SIFQuakeGfx() : SIFormat("quake", "Quake Gfx", "dat") {}
 	~SIFQuakeGfx() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_quake")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_quake")->isThisFormat(mc); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -29,7 +29,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image properties
 		int     width  = wxINT16_SWAP_ON_BE(*(const uint16_t*)(data.data()));
@@ -121,12 +121,12 @@ private:
 class SIFQuakeSprite : public SIFormat
 {
 public:
-	SIFQuakeSprite() : SIFormat("qspr", "Quake Sprite", "dat") {}
+	SIFQuakeSprite() : SIFormat("qspr", "Quake Sprite", "dat") { data_format_ = "img_qspr"; }
 	~SIFQuakeSprite() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_qspr")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_qspr")->isThisFormat(mc); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		// Get image info
 		SImage::Info info;
@@ -136,7 +136,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		SImage::Info info;
@@ -166,7 +166,7 @@ protected:
 	}
 
 private:
-	unsigned sprInfo(MemChunk& mc, int index, SImage::Info& info) const
+	unsigned sprInfo(const MemChunk& mc, int index, SImage::Info& info) const
 	{
 		// Setup variables
 		uint32_t maxheight = mc.readL32(16);
@@ -256,9 +256,9 @@ public:
 	SIFQuakeTex() : SIFormat("quaketex", "Quake Texture", "dat", 11) {}
 	~SIFQuakeTex() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_quaketex")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_quaketex")->isThisFormat(mc); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -285,7 +285,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		auto info = this->info(data, index);
@@ -312,9 +312,12 @@ public:
 	SIFQuake2Wal() : SIFormat("quake2wal", "Quake II Wall", "dat", 21) {}
 	~SIFQuake2Wal() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_quake2wal")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override
+	{
+		return EntryDataFormat::format("img_quake2wal")->isThisFormat(mc);
+	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -329,7 +332,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		auto info = this->info(data, index);
@@ -8,12 +8,12 @@ public:
 	}
 	~SIFRottGfx() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_rott")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -32,7 +32,7 @@ public:
 	}
 
 protected:
-	bool readRottGfx(SImage& image, MemChunk& data, bool mask)
+	bool readRottGfx(SImage& image, const MemChunk& data, bool mask)
 	{
 		// Get image info
 		auto info = this->info(data, 0);
@@ -119,7 +119,7 @@ protected:
 		return true;
 	}
 
-	bool readImage(SImage& image, MemChunk& data, int index) override { return readRottGfx(image, data, false); }
+	bool readImage(SImage& image, const MemChunk& data, int index) override { return readRottGfx(image, data, false); }
 };
 
 class SIFRottGfxMasked : public SIFRottGfx
@@ -128,10 +128,10 @@ public:
 	SIFRottGfxMasked() : SIFRottGfx("rottmask", "ROTT Masked Gfx", 120) {}
 	~SIFRottGfxMasked() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_rottmask")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_rottmask")->isThisFormat(mc); }
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override { return readRottGfx(image, data, true); }
+	bool readImage(SImage& image, const MemChunk& data, int index) override { return readRottGfx(image, data, true); }
 };
 
 class SIFRottLbm : public SIFormat
@@ -140,12 +140,12 @@ public:
 	SIFRottLbm() : SIFormat("rottlbm", "ROTT Lbm", "dat", 80) {}
 	~SIFRottLbm() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_rottlbm")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -160,7 +160,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		auto info = this->info(data, index);
@@ -229,12 +229,12 @@ public:
 	SIFRottRaw() : SIFormat("rottraw", "ROTT Raw", "dat", 101) {}
 	~SIFRottRaw() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_rottraw")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -253,7 +253,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		auto info = this->info(data, index);
@@ -263,7 +263,7 @@ protected:
 		image.fillAlpha(255);
 
 		// Read raw pixel data
-		data.read(imageData(image), info.width * info.height, 8);
+		data.read(8, imageData(image), info.width * info.height);
 
 		// Convert from column-major to row-major
 		image.rotate(90);
@@ -279,12 +279,12 @@ public:
 	SIFRottPic() : SIFormat("rottpic", "ROTT Picture", "dat", 60) {}
 	~SIFRottPic() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_rottpic")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -300,7 +300,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		auto info = this->info(data, index);
@@ -346,9 +346,9 @@ public:
 	SIFRottWall() : SIFormat("rottwall", "ROTT Flat", "dat", 10) {}
 	~SIFRottWall() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return (mc.size() == 4096 || mc.size() == 51200); }
+	bool isThisFormat(const MemChunk& mc) override { return (mc.size() == 4096 || mc.size() == 51200); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -364,7 +364,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		auto info = this->info(data, index);
@@ -374,8 +374,7 @@ protected:
 		image.fillAlpha(255);
 
 		// Read raw pixel data
-		data.seek(0, SEEK_SET);
-		data.read(imageData(image), info.height * info.width);
+		data.read(0, imageData(image), info.height * info.width);
 
 		// Convert from column-major to row-major
 		image.rotate(90);
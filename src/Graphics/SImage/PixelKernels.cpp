@@ -0,0 +1,1137 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    PixelKernels.cpp
+// Description: Bulk pixel conversion functions (palette expansion, alpha
+//              masking, brightness, scaling) used by SImage. Uses SSE2 (and
+//              AVX2 if enabled at compile time) on x86 or NEON on ARM, with a
+//              scalar fallback for other platforms and the leftover pixels at
+//              the end of each run
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "PixelKernels.h"
+#include "App.h"
+#include "General/Console.h"
+#include "Utility/MathStuff.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIXELKERNELS_SSE2
+#include <emmintrin.h>
+#if defined(__AVX2__)
+#define PIXELKERNELS_AVX2
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PIXELKERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Brightness weights (0.3, 0.59, 0.11) as 15-bit fixed point, summing to 1.0
+constexpr int LUMA_R = 9830;
+constexpr int LUMA_G = 19333;
+constexpr int LUMA_B = 3605;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Scalar Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+namespace scalar
+{
+	uint8_t luma(const uint8_t* rgba)
+	{
+		return (rgba[0] * LUMA_R + rgba[1] * LUMA_G + rgba[2] * LUMA_B) >> 15;
+	}
+
+	void expandPalette(const uint8_t* indices, const uint8_t* mask, const uint8_t* palette, uint8_t* rgba, unsigned count)
+	{
+		for (unsigned a = 0; a < count; ++a)
+		{
+			memcpy(rgba + a * 4, palette + indices[a] * 4, 4);
+			rgba[a * 4 + 3] = mask ? mask[a] : 255;
+		}
+	}
+
+	void expandGreyscale(const uint8_t* grey, uint8_t* rgba, unsigned count)
+	{
+		for (unsigned a = 0; a < count; ++a)
+			memset(rgba + a * 4, grey[a], 4);
+	}
+
+	void extractAlpha(const uint8_t* rgba, uint8_t* alpha, unsigned count)
+	{
+		for (unsigned a = 0; a < count; ++a)
+			alpha[a] = rgba[a * 4 + 3];
+	}
+
+	void brightness(const uint8_t* rgba, uint8_t* dest, unsigned count)
+	{
+		for (unsigned a = 0; a < count; ++a)
+			dest[a] = luma(rgba + a * 4);
+	}
+
+	void brightnessToAlpha(uint8_t* rgba, unsigned count)
+	{
+		for (unsigned a = 0; a < count; ++a)
+			rgba[a * 4 + 3] = luma(rgba + a * 4);
+	}
+
+	void maskColour(uint8_t* rgba, uint8_t r, uint8_t g, uint8_t b, unsigned count)
+	{
+		for (unsigned a = 0; a < count; ++a)
+		{
+			auto* pixel = rgba + a * 4;
+			pixel[3]    = (pixel[0] == r && pixel[1] == g && pixel[2] == b) ? 0 : 255;
+		}
+	}
+
+	void cie76Distances(const pixelkernels::LabPalette& pal, float l, float a, float b, float* dist)
+	{
+		for (unsigned i = 0; i < 256; ++i)
+		{
+			float dl = l - pal.l[i];
+			float da = a - pal.a[i];
+			float db = b - pal.b[i];
+			dist[i]  = dl * dl + da * da + db * db;
+		}
+	}
+
+	// [c] is the chroma of the colour, [w] the weights for the squared
+	// lightness, chroma and hue differences
+	void cie94Distances(
+		const pixelkernels::LabPalette& pal,
+		float                           l,
+		float                           a,
+		float                           b,
+		float                           c,
+		const float*                    w,
+		float*                          dist)
+	{
+		for (unsigned i = 0; i < 256; ++i)
+		{
+			float dl  = l - pal.l[i];
+			float da  = a - pal.a[i];
+			float db  = b - pal.b[i];
+			float dc  = c - pal.c[i];
+			float dh2 = std::max(da * da + db * db - dc * dc, 0.0f);
+			dist[i]   = dl * dl * w[0] + dc * dc * w[1] + dh2 * w[2];
+		}
+	}
+
+	// Resampling kernels, working on RGBA pixels as 4 floats with colours
+	// premultiplied by alpha (so transparent pixels don't bleed into the
+	// edges of opaque areas)
+	void premultiply(const uint8_t* rgba, float* dest, unsigned count)
+	{
+		for (unsigned a = 0; a < count; ++a)
+		{
+			float alpha     = rgba[a * 4 + 3] / 255.0f;
+			dest[a * 4]     = rgba[a * 4] * alpha;
+			dest[a * 4 + 1] = rgba[a * 4 + 1] * alpha;
+			dest[a * 4 + 2] = rgba[a * 4 + 2] * alpha;
+			dest[a * 4 + 3] = rgba[a * 4 + 3];
+		}
+	}
+
+	void unpremultiply(const float* src, uint8_t* rgba, unsigned count)
+	{
+		for (unsigned a = 0; a < count; ++a)
+		{
+			float alpha  = src[a * 4 + 3];
+			float factor = alpha > 0.0f ? 255.0f / alpha : 0.0f;
+			for (unsigned c = 0; c < 3; ++c)
+				rgba[a * 4 + c] = static_cast<uint8_t>(std::clamp(src[a * 4 + c] * factor, 0.0f, 255.0f) + 0.5f);
+			rgba[a * 4 + 3] = static_cast<uint8_t>(std::clamp(alpha, 0.0f, 255.0f) + 0.5f);
+		}
+	}
+
+	// Writes the sum of [count] [src] pixels multiplied by [weights] to [dest]
+	void weightedSum(const float* src, const float* weights, unsigned count, float* dest)
+	{
+		float sum[4] = {};
+		for (unsigned a = 0; a < count; ++a)
+			for (unsigned c = 0; c < 4; ++c)
+				sum[c] += src[a * 4 + c] * weights[a];
+		memcpy(dest, sum, sizeof(sum));
+	}
+
+	// Adds [count] [src] values multiplied by [weight] to [dest]
+	void addScaled(const float* src, float weight, float* dest, unsigned count)
+	{
+		for (unsigned a = 0; a < count; ++a)
+			dest[a] += src[a] * weight;
+	}
+} // namespace scalar
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// SIMD Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+namespace simd
+{
+#if defined(PIXELKERNELS_SSE2)
+	// Returns the brightness of 4 RGBA pixels as 32-bit values
+	__m128i luma4(__m128i pixels)
+	{
+		const auto zero    = _mm_setzero_si128();
+		const auto weights = _mm_set_epi16(0, LUMA_B, LUMA_G, LUMA_R, 0, LUMA_B, LUMA_G, LUMA_R);
+
+		// (r*wr + g*wg, b*wb) for each pixel
+		auto lo = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), weights);
+		auto hi = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), weights);
+
+		// Sum pairs and gather into one vector
+		lo = _mm_add_epi32(lo, _mm_srli_epi64(lo, 32));
+		hi = _mm_add_epi32(hi, _mm_srli_epi64(hi, 32));
+		lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0));
+		hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0));
+
+		return _mm_srli_epi32(_mm_unpacklo_epi64(lo, hi), 15);
+	}
+
+	void expandPalette(const uint8_t* indices, const uint8_t* mask, const uint8_t* palette, uint8_t* rgba, unsigned count)
+	{
+		const auto rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+		const auto pal      = reinterpret_cast<const int32_t*>(palette);
+		unsigned   a        = 0;
+
+#if defined(PIXELKERNELS_AVX2)
+		const auto rgb_mask_8 = _mm256_set1_epi32(0x00FFFFFF);
+		for (; a + 8 <= count; a += 8)
+		{
+			auto index  = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + a)));
+			auto pixels = _mm256_i32gather_epi32(pal, index, 4);
+			auto alpha  = mask ? _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(mask + a)))
+							   : _mm256_set1_epi32(255);
+			pixels = _mm256_or_si256(_mm256_and_si256(pixels, rgb_mask_8), _mm256_slli_epi32(alpha, 24));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + a * 4), pixels);
+		}
+#endif
+
+		// No gather in SSE2, so look up 4 pixels at a time and insert the
+		// alpha values together
+		for (; a + 4 <= count; a += 4)
+		{
+			auto pixels = _mm_set_epi32(
+				pal[indices[a + 3]], pal[indices[a + 2]], pal[indices[a + 1]], pal[indices[a]]);
+			auto alpha = mask ? _mm_set_epi32(mask[a + 3], mask[a + 2], mask[a + 1], mask[a]) : _mm_set1_epi32(255);
+			pixels     = _mm_or_si128(_mm_and_si128(pixels, rgb_mask), _mm_slli_epi32(alpha, 24));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + a * 4), pixels);
+		}
+
+		scalar::expandPalette(indices + a, mask ? mask + a : nullptr, palette, rgba + a * 4, count - a);
+	}
+
+	void expandGreyscale(const uint8_t* grey, uint8_t* rgba, unsigned count)
+	{
+		unsigned a = 0;
+		for (; a + 16 <= count; a += 16)
+		{
+			auto v   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(grey + a));
+			auto lo  = _mm_unpacklo_epi8(v, v);
+			auto hi  = _mm_unpackhi_epi8(v, v);
+			auto out = reinterpret_cast<__m128i*>(rgba + a * 4);
+			_mm_storeu_si128(out, _mm_unpacklo_epi16(lo, lo));
+			_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, lo));
+			_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, hi));
+			_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, hi));
+		}
+
+		scalar::expandGreyscale(grey + a, rgba + a * 4, count - a);
+	}
+
+	// Packs 16 32-bit values (all 0-255) into 16 bytes at [dest]
+	void pack16(__m128i v0, __m128i v1, __m128i v2, __m128i v3, uint8_t* dest)
+	{
+		auto lo = _mm_packs_epi32(v0, v1);
+		auto hi = _mm_packs_epi32(v2, v3);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_packus_epi16(lo, hi));
+	}
+
+	void extractAlpha(const uint8_t* rgba, uint8_t* alpha, unsigned count)
+	{
+		unsigned a = 0;
+		for (; a + 16 <= count; a += 16)
+		{
+			auto in = reinterpret_cast<const __m128i*>(rgba + a * 4);
+			pack16(
+				_mm_srli_epi32(_mm_loadu_si128(in), 24),
+				_mm_srli_epi32(_mm_loadu_si128(in + 1), 24),
+				_mm_srli_epi32(_mm_loadu_si128(in + 2), 24),
+				_mm_srli_epi32(_mm_loadu_si128(in + 3), 24),
+				alpha + a);
+		}
+
+		scalar::extractAlpha(rgba + a * 4, alpha + a, count - a);
+	}
+
+	void brightness(const uint8_t* rgba, uint8_t* dest, unsigned count)
+	{
+		unsigned a = 0;
+		for (; a + 16 <= count; a += 16)
+		{
+			auto in = reinterpret_cast<const __m128i*>(rgba + a * 4);
+			pack16(
+				luma4(_mm_loadu_si128(in)),
+				luma4(_mm_loadu_si128(in + 1)),
+				luma4(_mm_loadu_si128(in + 2)),
+				luma4(_mm_loadu_si128(in + 3)),
+				dest + a);
+		}
+
+		scalar::brightness(rgba + a * 4, dest + a, count - a);
+	}
+
+	void brightnessToAlpha(uint8_t* rgba, unsigned count)
+	{
+		const auto rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+		unsigned   a        = 0;
+		for (; a + 4 <= count; a += 4)
+		{
+			auto ptr    = reinterpret_cast<__m128i*>(rgba + a * 4);
+			auto pixels = _mm_loadu_si128(ptr);
+			pixels      = _mm_or_si128(_mm_and_si128(pixels, rgb_mask), _mm_slli_epi32(luma4(pixels), 24));
+			_mm_storeu_si128(ptr, pixels);
+		}
+
+		scalar::brightnessToAlpha(rgba + a * 4, count - a);
+	}
+
+	void maskColour(uint8_t* rgba, uint8_t r, uint8_t g, uint8_t b, unsigned count)
+	{
+		const auto rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+		const auto opaque   = _mm_set1_epi32(static_cast<int>(0xFF000000));
+		const auto colour   = _mm_set1_epi32(r | (g << 8) | (b << 16));
+		unsigned   a        = 0;
+		for (; a + 4 <= count; a += 4)
+		{
+			auto ptr    = reinterpret_cast<__m128i*>(rgba + a * 4);
+			auto pixels = _mm_and_si128(_mm_loadu_si128(ptr), rgb_mask);
+			auto equal  = _mm_cmpeq_epi32(pixels, colour);
+			_mm_storeu_si128(ptr, _mm_or_si128(pixels, _mm_andnot_si128(equal, opaque)));
+		}
+
+		scalar::maskColour(rgba + a * 4, r, g, b, count - a);
+	}
+
+	void cie76Distances(const pixelkernels::LabPalette& pal, float l, float a, float b, float* dist)
+	{
+		unsigned i = 0;
+
+#if defined(PIXELKERNELS_AVX2)
+		const auto l8 = _mm256_set1_ps(l);
+		const auto a8 = _mm256_set1_ps(a);
+		const auto b8 = _mm256_set1_ps(b);
+		for (; i < 256; i += 8)
+		{
+			auto dl = _mm256_sub_ps(l8, _mm256_loadu_ps(pal.l + i));
+			auto da = _mm256_sub_ps(a8, _mm256_loadu_ps(pal.a + i));
+			auto db = _mm256_sub_ps(b8, _mm256_loadu_ps(pal.b + i));
+			auto d  = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dl, dl), _mm256_mul_ps(da, da)), _mm256_mul_ps(db, db));
+			_mm256_storeu_ps(dist + i, d);
+		}
+#endif
+
+		const auto l4 = _mm_set1_ps(l);
+		const auto a4 = _mm_set1_ps(a);
+		const auto b4 = _mm_set1_ps(b);
+		for (; i < 256; i += 4)
+		{
+			auto dl = _mm_sub_ps(l4, _mm_loadu_ps(pal.l + i));
+			auto da = _mm_sub_ps(a4, _mm_loadu_ps(pal.a + i));
+			auto db = _mm_sub_ps(b4, _mm_loadu_ps(pal.b + i));
+			_mm_storeu_ps(dist + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dl, dl), _mm_mul_ps(da, da)), _mm_mul_ps(db, db)));
+		}
+	}
+
+	void cie94Distances(
+		const pixelkernels::LabPalette& pal,
+		float                           l,
+		float                           a,
+		float                           b,
+		float                           c,
+		const float*                    w,
+		float*                          dist)
+	{
+		unsigned i = 0;
+
+#if defined(PIXELKERNELS_AVX2)
+		const auto l8    = _mm256_set1_ps(l);
+		const auto a8    = _mm256_set1_ps(a);
+		const auto b8    = _mm256_set1_ps(b);
+		const auto c8    = _mm256_set1_ps(c);
+		const auto wl8   = _mm256_set1_ps(w[0]);
+		const auto wc8   = _mm256_set1_ps(w[1]);
+		const auto wh8   = _mm256_set1_ps(w[2]);
+		const auto zero8 = _mm256_setzero_ps();
+		for (; i < 256; i += 8)
+		{
+			auto dl  = _mm256_sub_ps(l8, _mm256_loadu_ps(pal.l + i));
+			auto da  = _mm256_sub_ps(a8, _mm256_loadu_ps(pal.a + i));
+			auto db  = _mm256_sub_ps(b8, _mm256_loadu_ps(pal.b + i));
+			auto dc  = _mm256_sub_ps(c8, _mm256_loadu_ps(pal.c + i));
+			auto dc2 = _mm256_mul_ps(dc, dc);
+			auto dh2 = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(da, da), _mm256_mul_ps(db, db)), dc2);
+			dh2      = _mm256_max_ps(dh2, zero8);
+			auto d   = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(dl, dl), wl8), _mm256_mul_ps(dc2, wc8));
+			_mm256_storeu_ps(dist + i, _mm256_add_ps(d, _mm256_mul_ps(dh2, wh8)));
+		}
+#endif
+
+		const auto l4   = _mm_set1_ps(l);
+		const auto a4   = _mm_set1_ps(a);
+		const auto b4   = _mm_set1_ps(b);
+		const auto c4   = _mm_set1_ps(c);
+		const auto wl4  = _mm_set1_ps(w[0]);
+		const auto wc4  = _mm_set1_ps(w[1]);
+		const auto wh4  = _mm_set1_ps(w[2]);
+		const auto zero = _mm_setzero_ps();
+		for (; i < 256; i += 4)
+		{
+			auto dl  = _mm_sub_ps(l4, _mm_loadu_ps(pal.l + i));
+			auto da  = _mm_sub_ps(a4, _mm_loadu_ps(pal.a + i));
+			auto db  = _mm_sub_ps(b4, _mm_loadu_ps(pal.b + i));
+			auto dc  = _mm_sub_ps(c4, _mm_loadu_ps(pal.c + i));
+			auto dc2 = _mm_mul_ps(dc, dc);
+			auto dh2 = _mm_max_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(da, da), _mm_mul_ps(db, db)), dc2), zero);
+			auto d   = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(dl, dl), wl4), _mm_mul_ps(dc2, wc4));
+			_mm_storeu_ps(dist + i, _mm_add_ps(d, _mm_mul_ps(dh2, wh4)));
+		}
+	}
+
+	// Returns RGBA [pixel] with its colour premultiplied by alpha
+	__m128 premultiply1(__m128 pixel)
+	{
+		const auto rgb_mask  = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+		const auto alpha_one = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+
+		auto alpha = _mm_mul_ps(_mm_shuffle_ps(pixel, pixel, _MM_SHUFFLE(3, 3, 3, 3)), _mm_set1_ps(1.0f / 255.0f));
+		return _mm_mul_ps(pixel, _mm_or_ps(_mm_and_ps(alpha, rgb_mask), alpha_one));
+	}
+
+	// Returns premultiplied RGBA [pixel] converted back to 32-bit values
+	__m128i unpremultiply1(__m128 pixel)
+	{
+		const auto rgb_mask  = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+		const auto alpha_one = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+		const auto zero      = _mm_setzero_ps();
+
+		auto alpha  = _mm_shuffle_ps(pixel, pixel, _MM_SHUFFLE(3, 3, 3, 3));
+		auto factor = _mm_and_ps(_mm_div_ps(_mm_set1_ps(255.0f), alpha), _mm_cmpgt_ps(alpha, zero));
+		factor      = _mm_or_ps(_mm_and_ps(factor, rgb_mask), alpha_one);
+		pixel       = _mm_min_ps(_mm_max_ps(_mm_mul_ps(pixel, factor), zero), _mm_set1_ps(255.0f));
+		return _mm_cvtps_epi32(pixel);
+	}
+
+	void premultiply(const uint8_t* rgba, float* dest, unsigned count)
+	{
+		const auto zero = _mm_setzero_si128();
+		unsigned   a    = 0;
+		for (; a + 4 <= count; a += 4)
+		{
+			auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + a * 4));
+			auto lo     = _mm_unpacklo_epi8(pixels, zero);
+			auto hi     = _mm_unpackhi_epi8(pixels, zero);
+			_mm_storeu_ps(dest + a * 4, premultiply1(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero))));
+			_mm_storeu_ps(dest + a * 4 + 4, premultiply1(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero))));
+			_mm_storeu_ps(dest + a * 4 + 8, premultiply1(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero))));
+			_mm_storeu_ps(dest + a * 4 + 12, premultiply1(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero))));
+		}
+
+		scalar::premultiply(rgba + a * 4, dest + a * 4, count - a);
+	}
+
+	void unpremultiply(const float* src, uint8_t* rgba, unsigned count)
+	{
+		unsigned a = 0;
+		for (; a + 4 <= count; a += 4)
+		{
+			auto lo = _mm_packs_epi32(
+				unpremultiply1(_mm_loadu_ps(src + a * 4)), unpremultiply1(_mm_loadu_ps(src + a * 4 + 4)));
+			auto hi = _mm_packs_epi32(
+				unpremultiply1(_mm_loadu_ps(src + a * 4 + 8)), unpremultiply1(_mm_loadu_ps(src + a * 4 + 12)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + a * 4), _mm_packus_epi16(lo, hi));
+		}
+
+		scalar::unpremultiply(src + a * 4, rgba + a * 4, count - a);
+	}
+
+	void weightedSum(const float* src, const float* weights, unsigned count, float* dest)
+	{
+		auto sum = _mm_setzero_ps();
+		for (unsigned a = 0; a < count; ++a)
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(src + a * 4), _mm_set1_ps(weights[a])));
+		_mm_storeu_ps(dest, sum);
+	}
+
+	void addScaled(const float* src, float weight, float* dest, unsigned count)
+	{
+		unsigned a = 0;
+
+#if defined(PIXELKERNELS_AVX2)
+		const auto weight8 = _mm256_set1_ps(weight);
+		for (; a + 8 <= count; a += 8)
+		{
+			auto sum = _mm256_add_ps(_mm256_loadu_ps(dest + a), _mm256_mul_ps(_mm256_loadu_ps(src + a), weight8));
+			_mm256_storeu_ps(dest + a, sum);
+		}
+#endif
+
+		const auto weight4 = _mm_set1_ps(weight);
+		for (; a + 4 <= count; a += 4)
+			_mm_storeu_ps(dest + a, _mm_add_ps(_mm_loadu_ps(dest + a), _mm_mul_ps(_mm_loadu_ps(src + a), weight4)));
+
+		scalar::addScaled(src + a, weight, dest + a, count - a);
+	}
+#elif defined(PIXELKERNELS_NEON)
+	// Returns the brightness of 8 pixels with the given channel values
+	uint8x8_t luma8(uint8x8_t r, uint8x8_t g, uint8x8_t b)
+	{
+		auto r16 = vmovl_u8(r);
+		auto g16 = vmovl_u8(g);
+		auto b16 = vmovl_u8(b);
+
+		auto lo = vmull_n_u16(vget_low_u16(r16), LUMA_R);
+		lo      = vmlal_n_u16(lo, vget_low_u16(g16), LUMA_G);
+		lo      = vmlal_n_u16(lo, vget_low_u16(b16), LUMA_B);
+		auto hi = vmull_n_u16(vget_high_u16(r16), LUMA_R);
+		hi      = vmlal_n_u16(hi, vget_high_u16(g16), LUMA_G);
+		hi      = vmlal_n_u16(hi, vget_high_u16(b16), LUMA_B);
+
+		return vmovn_u16(vcombine_u16(vshrn_n_u32(lo, 15), vshrn_n_u32(hi, 15)));
+	}
+
+	// Returns the brightness of 16 deinterleaved RGBA pixels
+	uint8x16_t luma16(const uint8x16x4_t& pixels)
+	{
+		return vcombine_u8(
+			luma8(vget_low_u8(pixels.val[0]), vget_low_u8(pixels.val[1]), vget_low_u8(pixels.val[2])),
+			luma8(vget_high_u8(pixels.val[0]), vget_high_u8(pixels.val[1]), vget_high_u8(pixels.val[2])));
+	}
+
+	void expandPalette(const uint8_t* indices, const uint8_t* mask, const uint8_t* palette, uint8_t* rgba, unsigned count)
+	{
+		// No gather in NEON, so look up colours individually and insert the
+		// alpha values 16 pixels at a time
+		unsigned a = 0;
+		for (; a + 16 <= count; a += 16)
+		{
+			for (unsigned p = 0; p < 16; ++p)
+				memcpy(rgba + (a + p) * 4, palette + indices[a + p] * 4, 4);
+
+			auto pixels   = vld4q_u8(rgba + a * 4);
+			pixels.val[3] = mask ? vld1q_u8(mask + a) : vdupq_n_u8(255);
+			vst4q_u8(rgba + a * 4, pixels);
+		}
+
+		scalar::expandPalette(indices + a, mask ? mask + a : nullptr, palette, rgba + a * 4, count - a);
+	}
+
+	void expandGreyscale(const uint8_t* grey, uint8_t* rgba, unsigned count)
+	{
+		unsigned a = 0;
+		for (; a + 16 <= count; a += 16)
+		{
+			auto         v      = vld1q_u8(grey + a);
+			uint8x16x4_t pixels = { { v, v, v, v } };
+			vst4q_u8(rgba + a * 4, pixels);
+		}
+
+		scalar::expandGreyscale(grey + a, rgba + a * 4, count - a);
+	}
+
+	void extractAlpha(const uint8_t* rgba, uint8_t* alpha, unsigned count)
+	{
+		unsigned a = 0;
+		for (; a + 16 <= count; a += 16)
+			vst1q_u8(alpha + a, vld4q_u8(rgba + a * 4).val[3]);
+
+		scalar::extractAlpha(rgba + a * 4, alpha + a, count - a);
+	}
+
+	void brightness(const uint8_t* rgba, uint8_t* dest, unsigned count)
+	{
+		unsigned a = 0;
+		for (; a + 16 <= count; a += 16)
+			vst1q_u8(dest + a, luma16(vld4q_u8(rgba + a * 4)));
+
+		scalar::brightness(rgba + a * 4, dest + a, count - a);
+	}
+
+	void brightnessToAlpha(uint8_t* rgba, unsigned count)
+	{
+		unsigned a = 0;
+		for (; a + 16 <= count; a += 16)
+		{
+			auto pixels   = vld4q_u8(rgba + a * 4);
+			pixels.val[3] = luma16(pixels);
+			vst4q_u8(rgba + a * 4, pixels);
+		}
+
+		scalar::brightnessToAlpha(rgba + a * 4, count - a);
+	}
+
+	void maskColour(uint8_t* rgba, uint8_t r, uint8_t g, uint8_t b, unsigned count)
+	{
+		unsigned a = 0;
+		for (; a + 16 <= count; a += 16)
+		{
+			auto pixels = vld4q_u8(rgba + a * 4);
+			auto equal  = vandq_u8(
+				 vandq_u8(vceqq_u8(pixels.val[0], vdupq_n_u8(r)), vceqq_u8(pixels.val[1], vdupq_n_u8(g))),
+				 vceqq_u8(pixels.val[2], vdupq_n_u8(b)));
+			pixels.val[3] = vmvnq_u8(equal);
+			vst4q_u8(rgba + a * 4, pixels);
+		}
+
+		scalar::maskColour(rgba + a * 4, r, g, b, count - a);
+	}
+
+	void cie76Distances(const pixelkernels::LabPalette& pal, float l, float a, float b, float* dist)
+	{
+		const auto l4 = vdupq_n_f32(l);
+		const auto a4 = vdupq_n_f32(a);
+		const auto b4 = vdupq_n_f32(b);
+		for (unsigned i = 0; i < 256; i += 4)
+		{
+			auto dl = vsubq_f32(l4, vld1q_f32(pal.l + i));
+			auto da = vsubq_f32(a4, vld1q_f32(pal.a + i));
+			auto db = vsubq_f32(b4, vld1q_f32(pal.b + i));
+			vst1q_f32(dist + i, vmlaq_f32(vmlaq_f32(vmulq_f32(dl, dl), da, da), db, db));
+		}
+	}
+
+	void cie94Distances(
+		const pixelkernels::LabPalette& pal,
+		float                           l,
+		float                           a,
+		float                           b,
+		float                           c,
+		const float*                    w,
+		float*                          dist)
+	{
+		const auto l4   = vdupq_n_f32(l);
+		const auto a4   = vdupq_n_f32(a);
+		const auto b4   = vdupq_n_f32(b);
+		const auto c4   = vdupq_n_f32(c);
+		const auto zero = vdupq_n_f32(0.0f);
+		for (unsigned i = 0; i < 256; i += 4)
+		{
+			auto dl  = vsubq_f32(l4, vld1q_f32(pal.l + i));
+			auto da  = vsubq_f32(a4, vld1q_f32(pal.a + i));
+			auto db  = vsubq_f32(b4, vld1q_f32(pal.b + i));
+			auto dc  = vsubq_f32(c4, vld1q_f32(pal.c + i));
+			auto dc2 = vmulq_f32(dc, dc);
+			auto dh2 = vmaxq_f32(vsubq_f32(vmlaq_f32(vmulq_f32(da, da), db, db), dc2), zero);
+			auto d   = vmulq_n_f32(vmulq_f32(dl, dl), w[0]);
+			d        = vmlaq_n_f32(d, dc2, w[1]);
+			vst1q_f32(dist + i, vmlaq_n_f32(d, dh2, w[2]));
+		}
+	}
+
+	void premultiply(const uint8_t* rgba, float* dest, unsigned count)
+	{
+		uint32_t value;
+		for (unsigned a = 0; a < count; ++a)
+		{
+			memcpy(&value, rgba + a * 4, 4);
+			auto bytes = vreinterpret_u8_u32(vdup_n_u32(value));
+			auto pixel = vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(bytes))));
+			auto alpha = vsetq_lane_f32(1.0f, vdupq_n_f32(vgetq_lane_f32(pixel, 3) / 255.0f), 3);
+			vst1q_f32(dest + a * 4, vmulq_f32(pixel, alpha));
+		}
+	}
+
+	void unpremultiply(const float* src, uint8_t* rgba, unsigned count)
+	{
+		const auto zero = vdupq_n_f32(0.0f);
+		const auto max  = vdupq_n_f32(255.0f);
+		for (unsigned a = 0; a < count; ++a)
+		{
+			auto  pixel  = vld1q_f32(src + a * 4);
+			float alpha  = vgetq_lane_f32(pixel, 3);
+			auto  factor = vsetq_lane_f32(1.0f, vdupq_n_f32(alpha > 0.0f ? 255.0f / alpha : 0.0f), 3);
+			pixel        = vaddq_f32(vminq_f32(vmaxq_f32(vmulq_f32(pixel, factor), zero), max), vdupq_n_f32(0.5f));
+			auto bytes   = vmovn_u16(vcombine_u16(vmovn_u32(vcvtq_u32_f32(pixel)), vdup_n_u16(0)));
+			vst1_lane_u32(reinterpret_cast<uint32_t*>(rgba + a * 4), vreinterpret_u32_u8(bytes), 0);
+		}
+	}
+
+	void weightedSum(const float* src, const float* weights, unsigned count, float* dest)
+	{
+		auto sum = vdupq_n_f32(0.0f);
+		for (unsigned a = 0; a < count; ++a)
+			sum = vmlaq_n_f32(sum, vld1q_f32(src + a * 4), weights[a]);
+		vst1q_f32(dest, sum);
+	}
+
+	void addScaled(const float* src, float weight, float* dest, unsigned count)
+	{
+		unsigned a = 0;
+		for (; a + 4 <= count; a += 4)
+			vst1q_f32(dest + a, vmlaq_n_f32(vld1q_f32(dest + a), vld1q_f32(src + a), weight));
+
+		scalar::addScaled(src + a, weight, dest + a, count - a);
+	}
+#else
+	using scalar::addScaled;
+	using scalar::brightness;
+	using scalar::brightnessToAlpha;
+	using scalar::cie76Distances;
+	using scalar::cie94Distances;
+	using scalar::expandGreyscale;
+	using scalar::expandPalette;
+	using scalar::extractAlpha;
+	using scalar::maskColour;
+	using scalar::premultiply;
+	using scalar::unpremultiply;
+	using scalar::weightedSum;
+#endif
+} // namespace simd
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Resampling Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// The source pixels and weights that make up each destination pixel along one
+// axis of a resample
+struct Contributions
+{
+	unsigned         max_taps = 0;
+	vector<unsigned> first;   // First source pixel for each destination pixel
+	vector<unsigned> count;   // No. of source pixels for each destination pixel
+	vector<float>    weights; // max_taps weights for each destination pixel
+};
+
+// -----------------------------------------------------------------------------
+// Returns the radius of [filter] (in source pixels, when not downscaling)
+// -----------------------------------------------------------------------------
+double filterSupport(pixelkernels::ScaleFilter filter)
+{
+	switch (filter)
+	{
+	case pixelkernels::ScaleFilter::Box: return 0.5;
+	case pixelkernels::ScaleFilter::Bilinear: return 1.0;
+	case pixelkernels::ScaleFilter::Lanczos: return 3.0;
+	default: return 0.5;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the weight of [filter] at distance [x] from its centre
+// -----------------------------------------------------------------------------
+double filterWeight(pixelkernels::ScaleFilter filter, double x)
+{
+	x = std::abs(x);
+	switch (filter)
+	{
+	case pixelkernels::ScaleFilter::Bilinear: return std::max(0.0, 1.0 - x);
+	case pixelkernels::ScaleFilter::Lanczos:
+	{
+		if (x < 1e-8)
+			return 1.0;
+		if (x >= 3.0)
+			return 0.0;
+		auto px = math::PI * x;
+		return 3.0 * std::sin(px) * std::sin(px / 3.0) / (px * px);
+	}
+	default: return x <= 0.5 ? 1.0 : 0.0;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Calculates the contributions of [size] source pixels to each of [n_size]
+// destination pixels for [filter]. When downscaling the filter is widened to
+// cover every source pixel (so Box averages the area each destination pixel
+// covers)
+// -----------------------------------------------------------------------------
+Contributions calculateContributions(unsigned size, unsigned n_size, pixelkernels::ScaleFilter filter)
+{
+	double scale   = static_cast<double>(size) / n_size;
+	double fscale  = std::max(1.0, scale);
+	double support = filterSupport(filter) * fscale;
+
+	Contributions contrib;
+	contrib.max_taps = static_cast<unsigned>(std::ceil(support * 2.0)) + 2;
+	contrib.first.resize(n_size);
+	contrib.count.resize(n_size);
+	contrib.weights.resize(static_cast<size_t>(n_size) * contrib.max_taps, 0.0f);
+
+	for (unsigned d = 0; d < n_size; ++d)
+	{
+		double centre  = (d + 0.5) * scale;
+		auto   first   = static_cast<int>(std::max(0.0, std::floor(centre - support)));
+		auto   last    = static_cast<int>(std::min<double>(size - 1, std::ceil(centre + support)));
+		auto   count   = std::min<unsigned>(last - first + 1, contrib.max_taps);
+		auto   weights = contrib.weights.data() + static_cast<size_t>(d) * contrib.max_taps;
+
+		double total = 0.0;
+		for (unsigned t = 0; t < count; ++t)
+		{
+			weights[t] = static_cast<float>(filterWeight(filter, (first + t + 0.5 - centre) / fscale));
+			total += weights[t];
+		}
+
+		// Normalise weights, falling back to the nearest pixel if none apply
+		if (total > 0.0)
+		{
+			for (unsigned t = 0; t < count; ++t)
+				weights[t] = static_cast<float>(weights[t] / total);
+		}
+		else
+		{
+			first      = std::min<int>(centre, size - 1);
+			count      = 1;
+			weights[0] = 1.0f;
+		}
+
+		contrib.first[d] = first;
+		contrib.count[d] = count;
+	}
+
+	return contrib;
+}
+
+// -----------------------------------------------------------------------------
+// Resamples [width]x[height] RGBA pixels in [src] to [n_width]x[n_height] RGBA
+// pixels in [dest] using [filter]. Scales horizontally into a premultiplied
+// float buffer first, then vertically a whole row at a time. Uses the scalar
+// kernels if [use_simd] is false (for benchmarking)
+// -----------------------------------------------------------------------------
+void resample(
+	const uint8_t*            src,
+	unsigned                  width,
+	unsigned                  height,
+	uint8_t*                  dest,
+	unsigned                  n_width,
+	unsigned                  n_height,
+	pixelkernels::ScaleFilter filter,
+	bool                      use_simd)
+{
+	auto contrib_x = calculateContributions(width, n_width, filter);
+	auto contrib_y = calculateContributions(height, n_height, filter);
+
+	// Only rows that contribute to the output need to be scaled horizontally
+	unsigned row_first = contrib_y.first.front();
+	unsigned row_last  = contrib_y.first.back() + contrib_y.count.back();
+
+	vector<float> row(static_cast<size_t>(width) * 4);
+	vector<float> scaled_x(static_cast<size_t>(n_width) * (row_last - row_first) * 4);
+	for (unsigned y = row_first; y < row_last; ++y)
+	{
+		auto src_row = src + static_cast<size_t>(y) * width * 4;
+		if (use_simd)
+			simd::premultiply(src_row, row.data(), width);
+		else
+			scalar::premultiply(src_row, row.data(), width);
+
+		auto out = scaled_x.data() + static_cast<size_t>(y - row_first) * n_width * 4;
+		for (unsigned x = 0; x < n_width; ++x)
+		{
+			auto weights = contrib_x.weights.data() + static_cast<size_t>(x) * contrib_x.max_taps;
+			auto first   = row.data() + contrib_x.first[x] * 4;
+			if (use_simd)
+				simd::weightedSum(first, weights, contrib_x.count[x], out + x * 4);
+			else
+				scalar::weightedSum(first, weights, contrib_x.count[x], out + x * 4);
+		}
+	}
+
+	vector<float> out(static_cast<size_t>(n_width) * 4);
+	for (unsigned y = 0; y < n_height; ++y)
+	{
+		std::fill(out.begin(), out.end(), 0.0f);
+		auto weights = contrib_y.weights.data() + static_cast<size_t>(y) * contrib_y.max_taps;
+		for (unsigned t = 0; t < contrib_y.count[y]; ++t)
+		{
+			auto in = scaled_x.data() + static_cast<size_t>(contrib_y.first[y] + t - row_first) * n_width * 4;
+			if (use_simd)
+				simd::addScaled(in, weights[t], out.data(), n_width * 4);
+			else
+				scalar::addScaled(in, weights[t], out.data(), n_width * 4);
+		}
+
+		auto dest_row = dest + static_cast<size_t>(y) * n_width * 4;
+		if (use_simd)
+			simd::unpremultiply(out.data(), dest_row, n_width);
+		else
+			scalar::unpremultiply(out.data(), dest_row, n_width);
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// PixelKernels Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the name of the SIMD instruction set used, or "Scalar" if none
+// -----------------------------------------------------------------------------
+string_view pixelkernels::instructionSet()
+{
+#if defined(PIXELKERNELS_AVX2)
+	return "AVX2";
+#elif defined(PIXELKERNELS_SSE2)
+	return "SSE2";
+#elif defined(PIXELKERNELS_NEON)
+	return "NEON";
+#else
+	return "Scalar";
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Writes [count] RGBA pixels to [rgba] from palette [indices], using the 256
+// RGBA colours in [palette]. Alpha values come from [mask] if given, or are
+// fully opaque otherwise
+// -----------------------------------------------------------------------------
+void pixelkernels::expandPalette(
+	const uint8_t* indices,
+	const uint8_t* mask,
+	const uint8_t* palette,
+	uint8_t*       rgba,
+	unsigned       count)
+{
+	simd::expandPalette(indices, mask, palette, rgba, count);
+}
+
+// -----------------------------------------------------------------------------
+// Writes [count] RGBA pixels to [rgba] from [grey] values, with every channel
+// (including alpha) set to the grey value
+// -----------------------------------------------------------------------------
+void pixelkernels::expandGreyscale(const uint8_t* grey, uint8_t* rgba, unsigned count)
+{
+	simd::expandGreyscale(grey, rgba, count);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the alpha values of [count] [rgba] pixels to [alpha]
+// -----------------------------------------------------------------------------
+void pixelkernels::extractAlpha(const uint8_t* rgba, uint8_t* alpha, unsigned count)
+{
+	simd::extractAlpha(rgba, alpha, count);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the brightness (0.3r + 0.59g + 0.11b) of [count] [rgba] pixels to
+// [dest]
+// -----------------------------------------------------------------------------
+void pixelkernels::brightness(const uint8_t* rgba, uint8_t* dest, unsigned count)
+{
+	simd::brightness(rgba, dest, count);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the alpha of [count] [rgba] pixels to their brightness
+// -----------------------------------------------------------------------------
+void pixelkernels::brightnessToAlpha(uint8_t* rgba, unsigned count)
+{
+	simd::brightnessToAlpha(rgba, count);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the alpha of [count] [rgba] pixels to 0 if they match the colour
+// [r],[g],[b], or 255 otherwise
+// -----------------------------------------------------------------------------
+void pixelkernels::maskColour(uint8_t* rgba, uint8_t r, uint8_t g, uint8_t b, unsigned count)
+{
+	simd::maskColour(rgba, r, g, b, count);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the (squared) CIE76 distances from the L*a*b* colour [l],[a],[b] to
+// all 256 colours in [pal] to [dist]
+// -----------------------------------------------------------------------------
+void pixelkernels::cie76Distances(const LabPalette& pal, float l, float a, float b, float* dist)
+{
+	simd::cie76Distances(pal, l, a, b, dist);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the (squared) CIE94 distances from the L*a*b* colour [l],[a],[b] to
+// all 256 colours in [pal] to [dist], with weighting factors [kl], [k1] and
+// [k2] (see CIEDeltaEquations)
+// -----------------------------------------------------------------------------
+void pixelkernels::cie94Distances(
+	const LabPalette& pal,
+	float             l,
+	float             a,
+	float             b,
+	float             kl,
+	float             k1,
+	float             k2,
+	float*            dist)
+{
+	// The chroma-dependent factors only depend on the given colour, so are
+	// calculated once here as weights for the squared differences
+	const float c    = std::sqrt(a * a + b * b);
+	const float sc   = 1.0f + k1 * c;
+	const float sh   = 1.0f + k2 * c;
+	const float w[3] = { 1.0f / (kl * kl), 1.0f / (sc * sc), 1.0f / (sh * sh) };
+	simd::cie94Distances(pal, l, a, b, c, w, dist);
+}
+
+// -----------------------------------------------------------------------------
+// Scales [width]x[height] RGBA pixels in [src] to [n_width]x[n_height] RGBA
+// pixels in [dest] using [filter]. Colours are weighted by alpha, so
+// transparent pixels don't bleed into the edges of opaque areas
+// -----------------------------------------------------------------------------
+void pixelkernels::scaleRGBA(
+	const uint8_t* src,
+	unsigned       width,
+	unsigned       height,
+	uint8_t*       dest,
+	unsigned       n_width,
+	unsigned       n_height,
+	ScaleFilter    filter)
+{
+	if (width == 0 || height == 0 || n_width == 0 || n_height == 0)
+		return;
+
+	resample(src, width, height, dest, n_width, n_height, filter, true);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// Compares the speed of the SIMD and scalar pixel kernels on a 4K image
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(benchmark_pixel_kernels, 0, false)
+{
+	constexpr unsigned width  = 3840;
+	constexpr unsigned height = 2160;
+	constexpr unsigned count  = width * height;
+	constexpr int      runs   = 10;
+
+	// Generate test data
+	vector<uint8_t> indices(count), mask(count), palette(1024), rgba(count * 4), dest(count);
+	uint32_t        seed = 12345;
+	auto            random = [&seed]()
+	{
+		seed = seed * 1664525 + 1013904223;
+		return static_cast<uint8_t>(seed >> 24);
+	};
+	for (auto& v : indices)
+		v = random();
+	for (auto& v : mask)
+		v = random();
+	for (auto& v : palette)
+		v = random();
+
+	log::console(fmt::format(
+		"Pixel kernels ({}), {}x{} image, {} runs:", pixelkernels::instructionSet(), width, height, runs));
+
+	auto run = [&](string_view name, const std::function<void()>& simd_func, const std::function<void()>& scalar_func)
+	{
+		auto start = app::runTimer();
+		for (int a = 0; a < runs; ++a)
+			simd_func();
+		auto simd_time = app::runTimer() - start;
+
+		start = app::runTimer();
+		for (int a = 0; a < runs; ++a)
+			scalar_func();
+		auto scalar_time = app::runTimer() - start;
+
+		log::console(fmt::format("{}: {}ms (scalar {}ms)", name, simd_time, scalar_time));
+	};
+
+	run(
+		"expandPalette",
+		[&]() { simd::expandPalette(indices.data(), mask.data(), palette.data(), rgba.data(), count); },
+		[&]() { scalar::expandPalette(indices.data(), mask.data(), palette.data(), rgba.data(), count); });
+	run(
+		"expandGreyscale",
+		[&]() { simd::expandGreyscale(mask.data(), rgba.data(), count); },
+		[&]() { scalar::expandGreyscale(mask.data(), rgba.data(), count); });
+	run(
+		"extractAlpha",
+		[&]() { simd::extractAlpha(rgba.data(), dest.data(), count); },
+		[&]() { scalar::extractAlpha(rgba.data(), dest.data(), count); });
+	run(
+		"brightness",
+		[&]() { simd::brightness(rgba.data(), dest.data(), count); },
+		[&]() { scalar::brightness(rgba.data(), dest.data(), count); });
+	run(
+		"brightnessToAlpha",
+		[&]() { simd::brightnessToAlpha(rgba.data(), count); },
+		[&]() { scalar::brightnessToAlpha(rgba.data(), count); });
+	run(
+		"maskColour",
+		[&]() { simd::maskColour(rgba.data(), 0, 255, 255, count); },
+		[&]() { scalar::maskColour(rgba.data(), 0, 255, 255, count); });
+
+	vector<uint8_t> scaled((width / 4) * (height / 4) * 4);
+	for (auto filter : { pixelkernels::ScaleFilter::Box, pixelkernels::ScaleFilter::Lanczos })
+		run(
+			filter == pixelkernels::ScaleFilter::Box ? "scaleRGBA (Box, 1/4)" : "scaleRGBA (Lanczos, 1/4)",
+			[&]() { resample(rgba.data(), width, height, scaled.data(), width / 4, height / 4, filter, true); },
+			[&]() { resample(rgba.data(), width, height, scaled.data(), width / 4, height / 4, filter, false); });
+
+	// Check results match
+	vector<uint8_t> check(count * 4);
+	simd::expandPalette(indices.data(), mask.data(), palette.data(), rgba.data(), count);
+	scalar::expandPalette(indices.data(), mask.data(), palette.data(), check.data(), count);
+	auto match = rgba == check;
+	simd::brightnessToAlpha(rgba.data(), count);
+	scalar::brightnessToAlpha(check.data(), count);
+	match &= rgba == check;
+	log::console(match ? "Results match" : "Results DON'T match!");
+}
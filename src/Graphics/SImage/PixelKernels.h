@@ -0,0 +1,46 @@
+#pragma once
+
+// Bulk pixel conversion and scaling functions used by SImage (and colour
+// distance functions used by Palette), with SIMD implementations
+// where available (SSE2/AVX2 on x86, NEON on ARM) and a scalar fallback.
+// All RGBA data is 4 bytes per pixel in R, G, B, A order
+namespace slade::pixelkernels
+{
+string_view instructionSet();
+
+void expandPalette(const uint8_t* indices, const uint8_t* mask, const uint8_t* palette, uint8_t* rgba, unsigned count);
+void expandGreyscale(const uint8_t* grey, uint8_t* rgba, unsigned count);
+void extractAlpha(const uint8_t* rgba, uint8_t* alpha, unsigned count);
+void brightness(const uint8_t* rgba, uint8_t* dest, unsigned count);
+void brightnessToAlpha(uint8_t* rgba, unsigned count);
+void maskColour(uint8_t* rgba, uint8_t r, uint8_t g, uint8_t b, unsigned count);
+
+enum class ScaleFilter
+{
+	Box,      // Average of the covered area (nearest when upscaling)
+	Bilinear, // Triangle filter
+	Lanczos,  // Lanczos-3, sharpest but can ring at hard edges
+};
+
+void scaleRGBA(
+	const uint8_t* src,
+	unsigned       width,
+	unsigned       height,
+	uint8_t*       dest,
+	unsigned       n_width,
+	unsigned       n_height,
+	ScaleFilter    filter);
+
+// Palette colours in CIE L*a*b* space, as separate arrays for calculating the
+// distances from a colour to every palette colour at once
+struct LabPalette
+{
+	float l[256] = {};
+	float a[256] = {};
+	float b[256] = {};
+	float c[256] = {}; // Chroma (sqrt(a*a + b*b))
+};
+
+void cie76Distances(const LabPalette& pal, float l, float a, float b, float* dist);
+void cie94Distances(const LabPalette& pal, float l, float a, float b, float kl, float k1, float k2, float* dist);
+} // namespace slade::pixelkernels
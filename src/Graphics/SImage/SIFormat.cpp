@@ -52,6 +52,13 @@ SIFormat*         sif_raw     = nullptr;
 SIFormat*         sif_flat    = nullptr;
 SIFormat*         sif_general = nullptr;
 SIFormat*         sif_unknown = nullptr;
+
+// Detection candidates, indexed by the first byte of image data. Each list
+// contains (in detection order) the formats that could possibly match data
+// beginning with that byte, along with the data format to check the full
+// signature with (if any)
+vector<std::pair<SIFormat*, EntryDataFormat*>> detection_candidates[256];
+vector<std::pair<SIFormat*, EntryDataFormat*>> detection_candidates_all;
 } // namespace
 
 
@@ -86,14 +93,14 @@ EXTERN_CVAR(Bool, gfx_extraconv)
 class SIFUnknown : public SIFormat
 {
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override { return false; }
+	bool readImage(SImage& image, const MemChunk& data, int index) override { return false; }
 
 public:
 	SIFUnknown() : SIFormat("unknown") { reliability_ = 0; }
 	~SIFUnknown() = default;
 
-	bool         isThisFormat(MemChunk& mc) override { return false; }
-	SImage::Info info(MemChunk& mc, int index) override { return {}; }
+	bool         isThisFormat(const MemChunk& mc) override { return false; }
+	SImage::Info info(const MemChunk& mc, int index) override { return {}; }
 };
 
 
@@ -109,7 +116,7 @@ public:
 	SIFGeneralImage() : SIFormat("image", "Image", "dat") {}
 	~SIFGeneralImage() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		auto mem = FreeImage_OpenMemory((BYTE*)mc.data(), mc.size());
 		auto fif = FreeImage_GetFileTypeFromMemory(mem, 0);
@@ -117,7 +124,7 @@ public:
 		return fif != FIF_UNKNOWN;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 		getFIInfo(mc, info);
@@ -125,7 +132,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		SImage::Info info;
@@ -189,7 +196,7 @@ protected:
 	bool writeImage(SImage& image, MemChunk& out, Palette* pal, int index) override { return false; }
 
 private:
-	FIBITMAP* getFIInfo(MemChunk& data, SImage::Info& info) const
+	FIBITMAP* getFIInfo(const MemChunk& data, SImage::Info& info) const
 	{
 		// Get FreeImage bitmap info from entry data
 		auto mem = FreeImage_OpenMemory((BYTE*)data.data(), data.size());
@@ -254,13 +261,13 @@ public:
 	SIFRaw(string_view id = "raw") : SIFormat(id, "Raw", "dat") {}
 	~SIFRaw() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		// Just check the size
 		return validSize(mc.size());
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 		unsigned     size = mc.size();
@@ -353,14 +360,14 @@ protected:
 		return false;
 	}
 
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get info
 		auto inf = info(data, index);
 
 		// Create image from data
 		image.create(inf.width, inf.height, SImage::Type::PalMask);
-		data.read(imageData(image), inf.width * inf.height, 0);
+		data.read(0, imageData(image), inf.width * inf.height);
 		image.fillAlpha(255);
 
 		return true;
@@ -567,6 +574,10 @@ void SIFormat::initFormats()
 	new SIFHeretic2M32();
 	new SIFWolfPic();
 	new SIFWolfSprite();
+
+	// Build the detection index now, since formats are detected from multiple
+	// threads (needs the builtin EntryDataFormats to be initialised already)
+	updateDetectionIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -596,18 +607,19 @@ SIFormat* SIFormat::getFormat(string_view id)
 // -----------------------------------------------------------------------------
 // Determines the format of the image data in [mc]
 // -----------------------------------------------------------------------------
-SIFormat* SIFormat::determineFormat(MemChunk& mc)
+SIFormat* SIFormat::determineFormat(const MemChunk& mc)
 {
-	// Go through all registered formats
-	SIFormat* format = sif_unknown;
-	for (auto& simage_format : simage_formats)
+	// Go through all formats that could possibly match the data
+	SIFormat*   format     = sif_unknown;
+	const auto& candidates = mc.size() > 0 ? detection_candidates[mc.data()[0]] : detection_candidates_all;
+	for (const auto& [simage_format, data_format] : candidates)
 	{
 		// Don't bother checking if the format is less reliable
 		if (simage_format->reliability_ < format->reliability_)
 			continue;
 
 		// Check if data matches format
-		if (simage_format->isThisFormat(mc))
+		if ((!data_format || data_format->matchesMagic(mc)) && simage_format->isThisFormat(mc))
 			format = simage_format;
 
 		// Stop if format detected is 100% reliable
@@ -619,6 +631,43 @@ SIFormat* SIFormat::determineFormat(MemChunk& mc)
 	return format;
 }
 
+// -----------------------------------------------------------------------------
+// Rebuilds the lists of detection candidates for each possible first byte of
+// image data (see determineFormat). Only done in initFormats, so the lists
+// are never modified while other threads are detecting formats
+// -----------------------------------------------------------------------------
+void SIFormat::updateDetectionIndex()
+{
+	for (auto& list : detection_candidates)
+		list.clear();
+	detection_candidates_all.clear();
+
+	for (auto* format : simage_formats)
+	{
+		auto* data_format = format->data_format_.empty() ? nullptr : EntryDataFormat::format(format->data_format_);
+		if (data_format == EntryDataFormat::anyFormat())
+			data_format = nullptr;
+
+		detection_candidates_all.emplace_back(format, data_format);
+
+		// Get the possible first bytes of the format's data (any if it has no signature)
+		bool first_bytes[256] = {};
+		auto any_byte         = !data_format || data_format->magic().empty();
+		if (data_format)
+			for (const auto& magic : data_format->magic())
+			{
+				if (magic.empty())
+					any_byte = true;
+				else
+					first_bytes[static_cast<uint8_t>(magic[0])] = true;
+			}
+
+		for (unsigned a = 0; a < 256; ++a)
+			if (any_byte || first_bytes[a])
+				detection_candidates[a].emplace_back(format, data_format);
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Returns the 'unknown' image format
 // -----------------------------------------------------------------------------
@@ -34,17 +34,24 @@ public:
 	const string& name() const { return name_; }
 	const string& extension() const { return extension_; }
 
-	virtual bool isThisFormat(MemChunk& mc) = 0;
+	virtual bool isThisFormat(const MemChunk& mc) = 0;
 
 	// Reading
-	virtual SImage::Info info(MemChunk& mc, int index = 0) = 0;
+	virtual SImage::Info info(const MemChunk& mc, int index = 0) = 0;
 
-	bool loadImage(SImage& image, MemChunk& data, int index = 0)
+	bool loadImage(SImage& image, const MemChunk& data, int index = 0)
 	{
 		// Check format
 		if (!isThisFormat(data))
 			return false;
 
+		return loadImageUnchecked(image, data, index);
+	}
+
+	// Same as loadImage but without checking the data is in this format first,
+	// for when that has already been done (eg. by determineFormat)
+	bool loadImageUnchecked(SImage& image, const MemChunk& data, int index = 0)
+	{
 		// Attempt to read image data
 		bool ok = readImage(image, data, index);
 
@@ -90,7 +97,7 @@ public:
 
 	static void      initFormats();
 	static SIFormat* getFormat(string_view name);
-	static SIFormat* determineFormat(MemChunk& mc);
+	static SIFormat* determineFormat(const MemChunk& mc);
 	static SIFormat* unknownFormat();
 	static SIFormat* rawFormat();
 	static SIFormat* flatFormat();
@@ -102,13 +109,17 @@ protected:
 	string  name_        = "Unknown";
 	string  extension_   = "dat";
 	uint8_t reliability_ = 255;
+	string  data_format_; // Id of the EntryDataFormat detecting this format, if its signature can rule it out
 
 	// Stuff to access protected image data
 	uint8_t* imageData(SImage& image) const { return image.data_.data(); }
 	uint8_t* imageMask(SImage& image) const { return image.mask_.data(); }
 	Palette& imagePalette(SImage& image) const { return image.palette_; }
 
-	virtual bool readImage(SImage& image, MemChunk& data, int index) = 0;
+	virtual bool readImage(SImage& image, const MemChunk& data, int index) = 0;
 	virtual bool writeImage(SImage& image, MemChunk& data, Palette* pal, int index) { return false; }
+
+private:
+	static void updateDetectionIndex();
 };
 } // namespace slade
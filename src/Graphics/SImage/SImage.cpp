@@ -34,6 +34,7 @@
 #include "Main.h"
 #include "SImage.h"
 #include "Graphics/Translation.h"
+#include "PixelKernels.h"
 #include "SIFormat.h"
 #include "Utility/MathStuff.h"
 #undef BOOL
@@ -51,6 +52,145 @@ EXTERN_CVAR(Float, col_greyscale_g)
 EXTERN_CVAR(Float, col_greyscale_b)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Writes the 256 colours of [palette] to [table] as RGBA (1024 bytes)
+// -----------------------------------------------------------------------------
+void paletteTable(const Palette& palette, uint8_t* table)
+{
+	for (int a = 0; a < 256; ++a)
+		palette.colour(a).write(table + a * 4);
+}
+
+// -----------------------------------------------------------------------------
+// Reverses the order of [count] pixels of [Bpp] bytes each in [data]
+// -----------------------------------------------------------------------------
+template<int Bpp> void reversePixels(uint8_t* data, unsigned count)
+{
+	uint8_t temp[Bpp];
+	for (unsigned a = 0, b = count - 1; a < b; ++a, --b)
+	{
+		memcpy(temp, data + a * Bpp, Bpp);
+		memcpy(data + a * Bpp, data + b * Bpp, Bpp);
+		memcpy(data + b * Bpp, temp, Bpp);
+	}
+}
+void reversePixels(uint8_t* data, unsigned count, unsigned bpp)
+{
+	if (bpp == 4)
+		reversePixels<4>(data, count);
+	else
+		std::reverse(data, data + count);
+}
+
+// -----------------------------------------------------------------------------
+// Writes [width]x[height] pixels of [Bpp] bytes each from [src] to [dest],
+// rotated 90° clockwise ([clockwise] = true) or anticlockwise. The pixels are
+// copied in square blocks so both the source rows and destination rows being
+// written stay in cache
+// -----------------------------------------------------------------------------
+template<int Bpp> void rotatePixels(const uint8_t* src, uint8_t* dest, int width, int height, bool clockwise)
+{
+	static constexpr int block = 32;
+
+	for (int y0 = 0; y0 < height; y0 += block)
+	{
+		int y1 = std::min(y0 + block, height);
+		for (int x0 = 0; x0 < width; x0 += block)
+		{
+			int x1 = std::min(x0 + block, width);
+			for (int y = y0; y < y1; ++y)
+				for (int x = x0; x < x1; ++x)
+				{
+					// The rotated image is [height] pixels wide
+					int dx = clockwise ? height - 1 - y : y;
+					int dy = clockwise ? x : width - 1 - x;
+					memcpy(dest + (dy * height + dx) * Bpp, src + (y * width + x) * Bpp, Bpp);
+				}
+		}
+	}
+}
+void rotatePixels(const uint8_t* src, uint8_t* dest, int width, int height, unsigned bpp, bool clockwise)
+{
+	if (bpp == 4)
+		rotatePixels<4>(src, dest, width, height, clockwise);
+	else
+		rotatePixels<1>(src, dest, width, height, clockwise);
+}
+
+// -----------------------------------------------------------------------------
+// Mirrors the [width]x[height] pixels of [bpp] bytes each in [data] in-place
+// -----------------------------------------------------------------------------
+void mirrorPixels(uint8_t* data, unsigned width, unsigned height, unsigned bpp, bool vertical)
+{
+	const auto row_len = width * bpp;
+	if (vertical)
+	{
+		for (unsigned a = 0, b = height - 1; a < b; ++a, --b)
+			std::swap_ranges(data + a * row_len, data + (a + 1) * row_len, data + b * row_len);
+	}
+	else
+	{
+		for (unsigned y = 0; y < height; ++y)
+			reversePixels(data + y * row_len, width, bpp);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Changes the [width]x[height] pixels of [bpp] bytes each in [mc] to
+// [n_width]x[n_height] in-place, keeping the existing pixels at the top-left.
+// Any new area is filled with zeros
+// -----------------------------------------------------------------------------
+void resizePixels(MemChunk& mc, unsigned width, unsigned height, unsigned n_width, unsigned n_height, unsigned bpp)
+{
+	const auto row_len   = width * bpp;
+	const auto n_row_len = n_width * bpp;
+	const auto copy_len  = std::min(row_len, n_row_len);
+	const auto rows      = std::min(height, n_height);
+
+	// Nothing to keep if there is no existing data
+	if (mc.size() < row_len * height || rows == 0 || copy_len == 0)
+	{
+		mc.reSize(n_row_len * n_height, false);
+		mc.fillData(0);
+		return;
+	}
+
+	if (n_row_len <= row_len)
+	{
+		// Rows only move towards the start of the data, so move them first
+		auto data = mc.data();
+		for (unsigned y = 1; y < rows; ++y)
+			memmove(data + y * n_row_len, data + y * row_len, copy_len);
+		mc.reSize(n_row_len * n_height, true);
+	}
+	else
+	{
+		// Rows move towards the end of the data, so grow it first and move
+		// the rows starting from the last one
+		mc.reSize(std::max(mc.size(), n_row_len * n_height), true);
+		auto data = mc.data();
+		for (unsigned y = rows; y-- > 0;)
+		{
+			memmove(data + y * n_row_len, data + y * row_len, copy_len);
+			memset(data + y * n_row_len + copy_len, 0, n_row_len - copy_len);
+		}
+		mc.reSize(n_row_len * n_height, true);
+	}
+
+	// Clear any new rows
+	if (n_height > rows)
+		memset(mc.data() + rows * n_row_len, 0, (n_height - rows) * n_row_len);
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // SImage Class Functions
@@ -103,39 +243,16 @@ bool SImage::putRGBAData(MemChunk& mc, Palette* pal) const
 		// Get palette to use
 		const auto& palette = (has_palette_ || !pal) ? palette_ : *pal;
 
-		uint8_t rgba[4];
-		for (int a = 0; a < width_ * height_; a++)
-		{
-			// Get colour
-			ColRGBA col = palette.colour(data_[a]);
-
-			// Set alpha
-			if (mask_.data())
-				col.a = mask_[a];
-			else
-				col.a = 255;
-
-			col.write(rgba);   // Write colour to array
-			mc.write(rgba, 4); // Write array to MemChunk
-		}
+		uint8_t pal_rgba[1024];
+		paletteTable(palette, pal_rgba);
+		pixelkernels::expandPalette(data_.data(), mask_.data(), pal_rgba, mc.data(), width_ * height_);
 
 		return true;
 	}
 
 	// Convert if alpha map
 	else if (type_ == Type::AlphaMap)
-	{
-		uint8_t rgba[4];
-		ColRGBA col;
-		for (int a = 0; a < width_ * height_; a++)
-		{
-			// Get pixel as colour (greyscale)
-			col.set(data_[a], data_[a], data_[a], data_[a]);
-
-			col.write(rgba);   // Write colour to array
-			mc.write(rgba, 4); // Write array to MemChunk
-		}
-	}
+		pixelkernels::expandGreyscale(data_.data(), mc.data(), width_ * height_);
 
 	return false; // Invalid image type
 }
@@ -169,12 +286,11 @@ bool SImage::putRGBData(MemChunk& mc, Palette* pal) const
 		const auto& palette = (has_palette_ || !pal) ? palette_ : *pal;
 
 		// Build RGB data
-		uint8_t rgba[4];
+		uint8_t pal_rgba[1024];
+		paletteTable(palette, pal_rgba);
+		auto rgb = mc.data();
 		for (int a = 0; a < width_ * height_; a++)
-		{
-			palette.colour(data_[a]).write(rgba);
-			mc.write(rgba, 3);
-		}
+			memcpy(rgb + a * 3, pal_rgba + data_[a] * 4, 3);
 
 		return true;
 	}
@@ -216,6 +332,56 @@ bool SImage::putIndexedData(MemChunk& mc) const
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Loads the image as interleaved palette index and alpha pairs (2 bytes per
+// pixel) into [mc].
+// Returns false if the image is invalid or not paletted, true otherwise
+// -----------------------------------------------------------------------------
+bool SImage::putIndexedMaskData(MemChunk& mc) const
+{
+	if (!isValid() || type_ != Type::PalMask)
+		return false;
+
+	auto count = static_cast<unsigned>(width_ * height_);
+	mc.reSize(count * 2, false);
+	auto dest = mc.data();
+	for (unsigned a = 0; a < count; ++a)
+	{
+		dest[a * 2]     = data_[a];
+		dest[a * 2 + 1] = mask_.hasData() ? mask_[a] : 255;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if every pixel in the image is fully opaque
+// -----------------------------------------------------------------------------
+bool SImage::isOpaque() const
+{
+	if (!isValid())
+		return false;
+
+	auto count = static_cast<unsigned>(width_ * height_);
+	if (type_ == Type::PalMask)
+	{
+		if (!mask_.hasData())
+			return true;
+
+		for (unsigned a = 0; a < count; ++a)
+			if (mask_[a] < 255)
+				return false;
+	}
+	else if (type_ == Type::RGBA)
+	{
+		for (unsigned a = 0; a < count; ++a)
+			if (data_[a * 4 + 3] < 255)
+				return false;
+	}
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the number of bytes per image row
 // -----------------------------------------------------------------------------
@@ -584,6 +750,7 @@ bool SImage::copyImage(SImage* image)
 	has_palette_ = image->has_palette_;
 	offset_x_    = image->offset_x_;
 	offset_y_    = image->offset_y_;
+	format_      = image->format_;
 	imgindex_    = image->imgindex_;
 	numimages_   = image->numimages_;
 
@@ -603,18 +770,22 @@ bool SImage::copyImage(SImage* image)
 // Detects the format of [data] and, if it's a valid image format, loads it into
 // this image
 // -----------------------------------------------------------------------------
-bool SImage::open(MemChunk& data, int index, string_view type_hint)
+bool SImage::open(const MemChunk& data, int index, string_view type_hint)
 {
 	// Check with type hint format first
 	if (!type_hint.empty())
 	{
 		auto format = SIFormat::getFormat(type_hint);
 		if (format != SIFormat::unknownFormat() && format->isThisFormat(data))
-			return format->loadImage(*this, data, index);
+			return format->loadImageUnchecked(*this, data, index);
 	}
 
 	// No type hint given or didn't match, autodetect format with SIFormat system instead
-	return SIFormat::determineFormat(data)->loadImage(*this, data, index);
+	auto format = SIFormat::determineFormat(data);
+	if (format == SIFormat::unknownFormat())
+		return false;
+
+	return format->loadImageUnchecked(*this, data, index);
 }
 
 // -----------------------------------------------------------------------------
@@ -675,9 +846,7 @@ bool SImage::convertPaletted(Palette* pal_target, Palette* pal_current)
 		mask_.reSize(width_ * height_);
 
 		// Get values from alpha channel
-		int c = 0;
-		for (int a = 3; a < width_ * height_ * 4; a += 4)
-			mask_[c++] = rgba_data[a];
+		pixelkernels::extractAlpha(rgba_data.data(), mask_.data(), width_ * height_);
 	}
 
 	// Load given palette
@@ -688,16 +857,7 @@ bool SImage::convertPaletted(Palette* pal_target, Palette* pal_current)
 
 	// Do conversion
 	data_.reSize(width_ * height_);
-	unsigned i = 0;
-	ColRGBA  col;
-	for (int a = 0; a < width_ * height_; a++)
-	{
-		col.r    = rgba_data[i++];
-		col.g    = rgba_data[i++];
-		col.b    = rgba_data[i++];
-		data_[a] = palette_.nearestColour(col);
-		i++; // Skip alpha
-	}
+	palette_.nearestColours(rgba_data.data(), data_.data(), width_ * height_);
 
 	// Update variables
 	type_        = Type::PalMask;
@@ -724,23 +884,10 @@ bool SImage::convertAlphaMap(AlphaSource alpha_source, Palette* pal)
 	create(width_, height_, Type::AlphaMap);
 
 	// Generate alpha mask
-	unsigned c = 0;
-	for (int a = 0; a < width_ * height_; a++)
-	{
-		// Determine alpha for this pixel
-		uint8_t alpha;
-		if (alpha_source == AlphaSource::Brightness) // Pixel brightness
-			alpha = static_cast<double>(rgba[c]) * 0.3 + static_cast<double>(rgba[c + 1]) * 0.59
-					+ static_cast<double>(rgba[c + 2]) * 0.11;
-		else // Existing alpha
-			alpha = rgba[c + 3];
-
-		// Set pixel
-		data_[a] = alpha;
-
-		// Next RGBA pixel
-		c += 4;
-	}
+	if (alpha_source == AlphaSource::Brightness) // Pixel brightness
+		pixelkernels::brightness(rgba.data(), data_.data(), width_ * height_);
+	else // Existing alpha
+		pixelkernels::extractAlpha(rgba.data(), data_.data(), width_ * height_);
 
 	// Announce change
 	signals_.image_changed();
@@ -760,31 +907,19 @@ bool SImage::maskFromColour(ColRGBA colour, Palette* pal)
 		if (has_palette_ || !pal)
 			pal = &palette_;
 
+		// Determine mask value for each palette index
+		uint8_t index_mask[256];
+		for (int a = 0; a < 256; a++)
+			index_mask[a] = pal->colour(a).equals(colour) ? 0 : 255;
+
 		// Palette+Mask type, go through the mask
 		for (int a = 0; a < width_ * height_; a++)
-		{
-			if (pal->colour(data_[a]).equals(colour))
-				mask_[a] = 0;
-			else
-				mask_[a] = 255;
-		}
+			mask_[a] = index_mask[data_[a]];
 	}
 	else if (type_ == Type::RGBA)
 	{
 		// RGBA type, go through alpha channel
-		uint32_t c = 0;
-		for (int a = 0; a < width_ * height_; a++)
-		{
-			ColRGBA pix_col(data_[c], data_[c + 1], data_[c + 2], 255);
-
-			if (pix_col.equals(colour))
-				data_[c + 3] = 0;
-			else
-				data_[c + 3] = 255;
-
-			// Skip to next pixel
-			c += 4;
-		}
+		pixelkernels::maskColour(data_.data(), colour.r, colour.g, colour.b, width_ * height_);
 	}
 	else
 		return false;
@@ -807,27 +942,19 @@ bool SImage::maskFromBrightness(Palette* pal)
 		if (has_palette_ || !pal)
 			pal = &palette_;
 
-		// Go through pixel data
+		// Determine brightness of each palette index
+		uint8_t pal_rgba[1024], index_brightness[256];
+		paletteTable(*pal, pal_rgba);
+		pixelkernels::brightness(pal_rgba, index_brightness, 256);
+
+		// Go through pixel data, set mask from pixel colour brightness value
 		for (int a = 0; a < width_ * height_; a++)
-		{
-			// Set mask from pixel colour brightness value
-			const ColRGBA col = pal->colour(data_[a]);
-			mask_[a]          = (static_cast<double>(col.r) * 0.3) + (static_cast<double>(col.g) * 0.59)
-					   + (static_cast<double>(col.b) * 0.11);
-		}
+			mask_[a] = index_brightness[data_[a]];
 	}
 	else if (type_ == Type::RGBA)
 	{
-		// Go through pixel data
-		unsigned c = 0;
-		for (int a = 0; a < width_ * height_; a++)
-		{
-			// Set alpha from pixel colour brightness value
-			data_[c + 3] = static_cast<double>(data_[c]) * 0.3 + static_cast<double>(data_[c + 1]) * 0.59
-						   + static_cast<double>(data_[c + 2]) * 0.11;
-			// Skip alpha
-			c += 4;
-		}
+		// Go through pixel data, set alpha from pixel colour brightness value
+		pixelkernels::brightnessToAlpha(data_.data(), width_ * height_);
 	}
 	// ALPHAMASK type is already a brightness mask
 
@@ -1018,118 +1145,52 @@ bool SImage::rotate(int angle)
 	angle %= 360;
 	angle = 360 - angle;
 
-	// Compute new dimensions and numbers of pixels and bytes
-	int new_width, new_height;
-	if (angle % 180)
-	{
-		new_width  = height_;
-		new_height = width_;
-	}
-	else
-	{
-		new_width  = width_;
-		new_height = height_;
-	}
-	const int numpixels = width_ * height_;
-	int       numbpp;
-	if (type_ == Type::PalMask)
-		numbpp = 1;
-	else if (type_ == Type::RGBA)
-		numbpp = 4;
-	else
+	if (type_ != Type::PalMask && type_ != Type::RGBA)
 		return false;
 
-	// Create new data and mask
-	vector<uint8_t> new_data(numpixels * numbpp);
-	vector<uint8_t> new_mask;
-	if (mask_.hasData())
-		new_mask.resize(numpixels * numbpp, 0);
+	const unsigned numpixels = width_ * height_;
+	const unsigned numbpp    = bpp();
 
-	// Remapping loop
-	int i, j, k;
-	for (i = 0; i < numpixels; ++i)
+	if (angle == 180)
 	{
-		switch (angle)
-		{
-			// Urgh maths...
-		case 90: j = (((new_height - 1) - (i % width_)) * new_width) + (i / width_); break;
-		case 180: j = (numpixels - 1) - i; break;
-		case 270: j = ((i % width_) * new_width) + ((new_width - 1) - (i / width_)); break;
-		default: return false;
-		}
-		if (j >= numpixels)
-		{
-			log::error("Pixel {} remapped to {}, how did this even happen?", i, j);
-			return false;
-		}
-		for (k = 0; k < numbpp; ++k)
+		// 180° is just the pixels in reverse order, so can be done in-place
+		reversePixels(data_.data(), numpixels, numbpp);
+		if (mask_.hasData())
+			std::reverse(mask_.data(), mask_.data() + numpixels);
+	}
+	else if (angle == 90 || angle == 270)
+	{
+		// The image is rotated anticlockwise by [angle] here
+		MemChunk new_data(numpixels * numbpp);
+		rotatePixels(data_.data(), new_data.data(), width_, height_, numbpp, angle == 270);
+		data_.importMem(new_data);
+		if (mask_.hasData())
 		{
-			new_data[(j * numbpp) + k] = data_[(i * numbpp) + k];
-			if (mask_.hasData())
-				new_mask[(j * numbpp) + k] = mask_[(i * numbpp) + k];
+			rotatePixels(mask_.data(), new_data.data(), width_, height_, 1, angle == 270);
+			mask_.importMem(new_data.data(), numpixels);
 		}
+		std::swap(width_, height_);
 	}
 
-	// It worked, yay
-	clearData();
-	data_.importMem(new_data.data(), new_data.size());
-	if (!new_mask.empty())
-		mask_.importMem(new_mask.data(), new_mask.size());
-	width_  = new_width;
-	height_ = new_height;
-
 	// Announce change
 	signals_.image_changed();
 	return true;
 }
 
 // -----------------------------------------------------------------------------
-// Mirrors the image horizontally or vertically.
+// Mirrors the image horizontally or vertically (in-place).
 // -----------------------------------------------------------------------------
 bool SImage::mirror(bool vertical)
 {
-	// Compute numbers of pixels and bytes
-	const int numpixels = width_ * height_;
-	int       numbpp;
-	if (type_ == Type::PalMask)
-		numbpp = 1;
-	else if (type_ == Type::RGBA)
-		numbpp = 4;
-	else
+	if (type_ != Type::PalMask && type_ != Type::RGBA)
 		return false;
 
-	// Create new data and mask
-	vector<uint8_t> new_data(numpixels * numbpp);
-	vector<uint8_t> new_mask;
-	if (mask_.hasData())
-		new_mask.resize(numpixels * numbpp);
-
-	// Remapping loop
-	int i, j, k;
-	for (i = 0; i < numpixels; ++i)
-	{
-		if (vertical)
-			j = (((height_ - 1) - (i / width_)) * width_) + (i % width_);
-		else // horizontal
-			j = ((i / width_) * width_) + ((width_ - 1) - (i % width_));
-		if (j >= numpixels)
-		{
-			log::error("Pixel {} remapped to {}, how did this even happen?", i, j);
-			return false;
-		}
-		for (k = 0; k < numbpp; ++k)
-		{
-			new_data[(j * numbpp) + k] = data_[(i * numbpp) + k];
-			if (mask_.hasData())
-				new_mask[(j * numbpp) + k] = mask_[(i * numbpp) + k];
-		}
-	}
+	if (!data_.hasData())
+		return true; // Nothing to do
 
-	// It worked, yay
-	clearData();
-	data_.importMem(new_data.data(), new_data.size());
-	if (!new_mask.empty())
-		mask_.importMem(new_mask.data(), new_mask.size());
+	mirrorPixels(data_.data(), width_, height_, bpp(), vertical);
+	if (mask_.hasData())
+		mirrorPixels(mask_.data(), width_, height_, 1, vertical);
 
 	// Announce change
 	signals_.image_changed();
@@ -1163,41 +1224,24 @@ bool SImage::crop(long x1, long y1, long x2, long y2)
 	if (x2 <= x1 || y2 <= y1 || x1 > width_ || y1 > height_)
 		return false;
 
-	const size_t new_width  = x2 - x1;
-	const size_t new_height = y2 - y1;
-
-	// Compute numbers of pixels and bytes
-	const int numpixels = new_width * new_height;
-	int       numbpp;
-	if (type_ == Type::PalMask || type_ == Type::AlphaMap)
-		numbpp = 1;
-	else if (type_ == Type::RGBA)
-		numbpp = 4;
-	else
+	if (type_ != Type::PalMask && type_ != Type::AlphaMap && type_ != Type::RGBA)
 		return false;
 
-	// Create new data and mask
-	vector<uint8_t> new_data(numpixels * numbpp);
-	vector<uint8_t> new_mask;
-	if (mask_.hasData())
-		new_mask.resize(numpixels * numbpp);
+	const unsigned new_width  = x2 - x1;
+	const unsigned new_height = y2 - y1;
 
-	// Remapping loop
-	size_t i, a, b;
-	for (i = 0; i < new_height; ++i)
+	// Move the cropped rows to the start of the data (in-place, as each row
+	// only moves towards the start)
+	auto crop_rows = [&](MemChunk& mc, unsigned numbpp)
 	{
-		a = i * new_width * numbpp;
-		b = (((i + y1) * width_) + x1) * numbpp;
-		memcpy(new_data.data() + a, data_.data() + b, new_width * numbpp);
-		if (mask_.hasData())
-			memcpy(new_mask.data() + a, mask_.data() + b, new_width * numbpp);
-	}
-
-	// It worked, yay
-	clearData();
-	data_.importMem(new_data.data(), new_data.size());
-	if (!new_mask.empty())
-		mask_.importMem(new_mask.data(), new_mask.size());
+		auto data = mc.data();
+		for (unsigned y = 0; y < new_height; ++y)
+			memmove(data + y * new_width * numbpp, data + ((y + y1) * width_ + x1) * numbpp, new_width * numbpp);
+		mc.reSize(new_width * new_height * numbpp, true);
+	};
+	crop_rows(data_, bpp());
+	if (mask_.hasData())
+		crop_rows(mask_, 1);
 	width_  = new_width;
 	height_ = new_height;
 
@@ -1223,47 +1267,75 @@ bool SImage::resize(int nwidth, int nheight)
 		return true;
 	}
 
-	// Init new image data
-	uint8_t bpp = 1;
-	if (type_ == Type::RGBA)
-		bpp = 4;
+	// Resize image data (and mask) in-place
+	resizePixels(data_, width_, height_, nwidth, nheight, bpp());
+	if (type_ == Type::PalMask)
+		resizePixels(mask_, width_, height_, nwidth, nheight, 1);
+	else
+		mask_.clear();
+	width_  = nwidth;
+	height_ = nheight;
 
-	// Create new image data
-	vector<uint8_t> new_data(nwidth * nheight * bpp, 0);
+	// Announce change
+	signals_.image_changed();
 
-	// Create new mask if needed
-	vector<uint8_t> new_mask;
-	if (type_ == Type::PalMask)
-		new_mask.resize(nwidth * nheight, 0);
+	return true;
+}
 
-	// Write new image data
-	unsigned       offset = 0;
-	const unsigned rowlen = std::min<unsigned>(width_, nwidth) * bpp;
-	const unsigned nrows  = std::min<unsigned>(height_, nheight);
-	for (unsigned y = 0; y < nrows; y++)
-	{
-		// Copy data row
-		memcpy(new_data.data() + offset, data_.data() + (y * width_ * bpp), rowlen);
+// -----------------------------------------------------------------------------
+// Scales the image to [nwidth]x[nheight]. RGBA images are resampled with
+// [filter], while paletted images and alpha maps always use the nearest pixel
+// (since palette indices can't be blended)
+// -----------------------------------------------------------------------------
+bool SImage::scale(int nwidth, int nheight, ScaleFilter filter)
+{
+	if (nwidth <= 0 || nheight <= 0 || !isValid())
+		return false;
 
-		// Copy mask row
-		if (!new_mask.empty())
-			memcpy(new_mask.data() + offset, mask_.data() + (y * width_), rowlen);
+	if (nwidth == width_ && nheight == height_)
+		return true; // Nothing to do
 
-		// Go to next row
-		offset += nwidth * bpp;
+	if (type_ == Type::RGBA && filter != ScaleFilter::Nearest)
+	{
+		auto kernel_filter = pixelkernels::ScaleFilter::Box;
+		if (filter == ScaleFilter::Bilinear)
+			kernel_filter = pixelkernels::ScaleFilter::Bilinear;
+		else if (filter == ScaleFilter::Lanczos)
+			kernel_filter = pixelkernels::ScaleFilter::Lanczos;
+
+		MemChunk new_data(nwidth * nheight * 4);
+		pixelkernels::scaleRGBA(data_.data(), width_, height_, new_data.data(), nwidth, nheight, kernel_filter);
+		data_.importMem(new_data);
+	}
+	else
+	{
+		// Nearest - map each destination column to its source column once
+		vector<unsigned> src_x(nwidth);
+		for (int x = 0; x < nwidth; ++x)
+			src_x[x] = static_cast<unsigned>((x + 0.5) * width_ / nwidth);
+
+		auto scale_nearest = [&](MemChunk& mc, unsigned numbpp)
+		{
+			MemChunk new_data(nwidth * nheight * numbpp);
+			auto     dest = new_data.data();
+			for (int y = 0; y < nheight; ++y)
+			{
+				auto src_row = mc.data() + static_cast<unsigned>((y + 0.5) * height_ / nheight) * width_ * numbpp;
+				for (int x = 0; x < nwidth; ++x, dest += numbpp)
+					memcpy(dest, src_row + src_x[x] * numbpp, numbpp);
+			}
+			mc.importMem(new_data);
+		};
+		scale_nearest(data_, bpp());
+		if (mask_.hasData())
+			scale_nearest(mask_, 1);
 	}
 
-	// Update variables
 	width_  = nwidth;
 	height_ = nheight;
-	clearData();
-	data_.importMem(new_data.data(), new_data.size());
-	if (!new_mask.empty())
-		mask_.importMem(new_mask.data(), new_mask.size());
 
 	// Announce change
 	signals_.image_changed();
-
 	return true;
 }
 
@@ -1334,6 +1406,9 @@ bool SImage::applyTranslation(Translation* tr, Palette* pal, bool truecolor)
 	else
 		newdata = data_.data();
 
+	// Get translation lookup tables for the palette
+	const auto& table = tr->compile(pal);
+
 	// Go through pixels
 	for (int p = 0; p < width_ * height_; p++)
 	{
@@ -1341,32 +1416,37 @@ bool SImage::applyTranslation(Translation* tr, Palette* pal, bool truecolor)
 		if (mask_.hasData() && mask_[p] == 0)
 			continue;
 
-		ColRGBA col;
+		uint8_t index;
+		uint8_t alpha;
 		int     q = p * bpp;
 		if (type_ == Type::PalMask)
-			col.set(pal->colour(data_[p]));
-		else if (type_ == Type::RGBA)
 		{
-			col.set(data_[q], data_[q + 1], data_[q + 2], data_[q + 3]);
+			index = data_[p];
+			alpha = table.colour[index].a;
+		}
+		else
+		{
+			ColRGBA col(data_[q], data_[q + 1], data_[q + 2], data_[q + 3]);
 
 			// skip colours that don't match exactly to the palette
-			col.index = pal->nearestColour(col);
-			if (!col.equals(pal->colour(col.index)))
+			index = pal->nearestColour(col);
+			if (!col.equals(pal->colour(index)))
 				continue;
-		}
 
-		col = tr->translate(col, pal);
+			alpha = col.a;
+		}
 
 		if (truecolor)
 		{
-			q              = p * 4;
-			newdata[q + 0] = col.r;
-			newdata[q + 1] = col.g;
-			newdata[q + 2] = col.b;
-			newdata[q + 3] = mask_.hasData() ? mask_[p] : col.a;
+			const auto& col = table.colour[index];
+			q               = p * 4;
+			newdata[q + 0]  = col.r;
+			newdata[q + 1]  = col.g;
+			newdata[q + 2]  = col.b;
+			newdata[q + 3]  = mask_.hasData() ? mask_[p] : alpha;
 		}
 		else
-			data_[p] = col.index;
+			data_[p] = table.index[index];
 	}
 
 	if (truecolor && type_ == Type::PalMask)
@@ -29,6 +29,14 @@ public:
 		Modulate,        // 'Modulate' blend
 	};
 
+	enum class ScaleFilter
+	{
+		Nearest,
+		Box,      // Area average when downscaling
+		Bilinear,
+		Lanczos,
+	};
+
 	enum class AlphaSource
 	{
 		// Alpha map generation sources
@@ -83,6 +91,8 @@ public:
 	bool      putRGBAData(MemChunk& mc, Palette* pal = nullptr) const;
 	bool      putRGBData(MemChunk& mc, Palette* pal = nullptr) const;
 	bool      putIndexedData(MemChunk& mc) const;
+	bool      putIndexedMaskData(MemChunk& mc) const;
+	bool      isOpaque() const;
 	int       width() const { return width_; }
 	int       height() const { return height_; }
 	int       index() const { return imgindex_; }
@@ -120,7 +130,7 @@ public:
 	bool   copyImage(SImage* image);
 
 	// Image format reading
-	bool open(MemChunk& data, int index = 0, string_view type_hint = "");
+	bool open(const MemChunk& data, int index = 0, string_view type_hint = "");
 	bool loadFont0(const uint8_t* gfx_data, int size);
 	bool loadFont1(const uint8_t* gfx_data, int size);
 	bool loadFont2(const uint8_t* gfx_data, int size);
@@ -149,6 +159,7 @@ public:
 	bool mirror(bool vert);
 	bool crop(long x1, long y1, long x2, long y2);
 	bool resize(int nwidth, int nheight);
+	bool scale(int nwidth, int nheight, ScaleFilter filter = ScaleFilter::Box);
 	bool setImageData(const vector<uint8_t>& ndata, int nwidth, int nheight, Type ntype);
 	bool setImageData(const uint8_t* ndata, unsigned ndata_size, int nwidth, int nheight, Type ntype);
 	bool applyTranslation(Translation* tr, Palette* pal = nullptr, bool truecolor = false);
@@ -177,8 +188,8 @@ public:
 private:
 	int       width_  = 0;
 	int       height_ = 0;
-	MemChunk  data_;
-	MemChunk  mask_;
+	MemChunk  data_{ memstats::Category::Image };
+	MemChunk  mask_{ memstats::Category::Image };
 	Type      type_ = Type::RGBA;
 	Palette   palette_;
 	bool      has_palette_ = false;
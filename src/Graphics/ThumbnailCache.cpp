@@ -0,0 +1,370 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ThumbnailCache.cpp
+// Description: Persistent on-disk cache of small, pre-scaled RGBA thumbnails
+//              for browser items, keyed by content hash and palette
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ThumbnailCache.h"
+#include "App.h"
+#include "Archive/ArchiveEntry.h"
+#include "General/Console.h"
+#include "General/Misc.h"
+#include "Graphics/CTexture/CTexture.h"
+#include "Graphics/Palette/Palette.h"
+#include "Graphics/SImage/PixelKernels.h"
+#include "Graphics/SImage/SImage.h"
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, thumbnail_cache, true, CVar::Flag::Save)
+CVAR(Int, thumbnail_cache_max_mb, 256, CVar::Flag::Save)
+
+namespace
+{
+constexpr uint32_t THUMB_MAGIC   = 0x48544c53; // "SLTH"
+constexpr uint16_t THUMB_VERSION = 1;
+
+// Thumbnail file header, followed by width * height RGBA pixels
+struct ThumbHeader
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t width;
+	uint16_t height;
+	uint16_t full_width;
+	uint16_t full_height;
+	uint16_t reserved;
+};
+
+bool pruned = false;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the thumbnail cache directory, creating it if needed
+// -----------------------------------------------------------------------------
+const string& cacheDir()
+{
+	static const string dir = []
+	{
+		auto path = app::path("thumbnails", app::Dir::User);
+		std::error_code error;
+		std::filesystem::create_directories(path, error);
+		return path;
+	}();
+
+	return dir;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the path to the cached thumbnail file for [key]
+// -----------------------------------------------------------------------------
+string thumbPath(uint64_t key)
+{
+	return fmt::format("{}/{:016x}.thumb", cacheDir(), key);
+}
+
+// -----------------------------------------------------------------------------
+// Returns a hash of palette [pal]'s colours (or 0 if [pal] is null)
+// -----------------------------------------------------------------------------
+uint64_t paletteHash(const Palette* pal)
+{
+	if (!pal)
+		return 0;
+
+	uint8_t colours[1024];
+	for (unsigned a = 0; a < 256; ++a)
+	{
+		auto col           = pal->colour(a);
+		colours[a * 4]     = col.r;
+		colours[a * 4 + 1] = col.g;
+		colours[a * 4 + 2] = col.b;
+		colours[a * 4 + 3] = col.a;
+	}
+
+	return misc::hash64(colours, 1024);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the oldest cached thumbnails if the cache has grown beyond
+// thumbnail_cache_max_mb, until it is back down to 3/4 of that size
+// -----------------------------------------------------------------------------
+void pruneCache()
+{
+	namespace fs = std::filesystem;
+
+	struct ThumbFile
+	{
+		fs::path           path;
+		uintmax_t          size;
+		fs::file_time_type time;
+	};
+
+	std::error_code   error;
+	vector<ThumbFile> files;
+	uintmax_t         total = 0;
+	for (const auto& item : fs::directory_iterator(cacheDir(), error))
+	{
+		if (!item.is_regular_file(error))
+			continue;
+
+		auto& file = files.emplace_back(ThumbFile{ item.path(), item.file_size(error), item.last_write_time(error) });
+		total += file.size;
+	}
+
+	const uintmax_t max_size = static_cast<uintmax_t>(std::max<int>(thumbnail_cache_max_mb, 1)) * 1024 * 1024;
+	if (total <= max_size)
+		return;
+
+	std::sort(files.begin(), files.end(), [](const ThumbFile& a, const ThumbFile& b) { return a.time < b.time; });
+	for (const auto& file : files)
+	{
+		if (total <= max_size / 4 * 3)
+			break;
+
+		if (fs::remove(file.path, error))
+			total -= file.size;
+	}
+
+	log::info(2, "Pruned thumbnail cache to {}kb", total / 1024);
+}
+
+// -----------------------------------------------------------------------------
+// Prunes the cache if it hasn't been done yet this session
+// -----------------------------------------------------------------------------
+void checkPruned()
+{
+	if (pruned)
+		return;
+
+	pruneCache();
+	pruned = true;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ThumbnailCache Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the thumbnail key for the image in [entry] using palette [pal], or 0
+// if the thumbnail cache is disabled
+// -----------------------------------------------------------------------------
+uint64_t thumbnailcache::entryKey(ArchiveEntry& entry, const Palette* pal)
+{
+	if (!thumbnail_cache)
+		return 0;
+	checkPruned();
+
+	auto key = fmt::format("entry {} {}", entry.contentHash(), paletteHash(pal));
+	return misc::hash64(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+}
+
+// -----------------------------------------------------------------------------
+// Returns the thumbnail key for the composed image of [texture], using patches
+// from [parent] primarily and palette [pal].
+// Returns 0 if the texture can't be cached (eg. it is being edited or uses
+// other textures as patches) or the thumbnail cache is disabled
+// -----------------------------------------------------------------------------
+uint64_t thumbnailcache::textureKey(CTexture& texture, Archive* parent, const Palette* pal)
+{
+	if (!thumbnail_cache || !texture.cacheable())
+		return 0;
+	checkPruned();
+
+	// Texture definition
+	string key;
+	if (texture.isExtended())
+		key = texture.asText();
+	else
+	{
+		key = fmt::format("{} {} {}\n", texture.name(), texture.width(), texture.height());
+		for (unsigned a = 0; a < texture.nPatches(); ++a)
+		{
+			auto patch = texture.patch(a);
+			key += fmt::format("{} {} {}\n", patch->name(), patch->xOffset(), patch->yOffset());
+		}
+	}
+
+	// Patch contents
+	for (unsigned a = 0; a < texture.nPatches(); ++a)
+	{
+		auto source = texture.patchSource(a, parent);
+		if (source.texture)
+			return 0;
+
+		key += fmt::format("{}\n", source.entry ? source.entry->contentHash() : 0);
+	}
+
+	key += fmt::format("texture {}", paletteHash(pal));
+	return misc::hash64(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+}
+
+// -----------------------------------------------------------------------------
+// Loads the cached thumbnail for [key] into [image] (as RGBA), and the size of
+// the image it was scaled from into [full_size].
+// Returns false if there is no (valid) cached thumbnail for [key]
+// -----------------------------------------------------------------------------
+bool thumbnailcache::load(uint64_t key, SImage& image, Vec2i& full_size)
+{
+	if (key == 0)
+		return false;
+
+	// (This can be called from a worker thread, so no logging here)
+	std::ifstream file(thumbPath(key), std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	ThumbHeader header{};
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file.good() || header.magic != THUMB_MAGIC || header.version != THUMB_VERSION || header.width == 0
+		|| header.height == 0)
+		return false;
+
+	vector<uint8_t> data(static_cast<size_t>(header.width) * header.height * 4);
+	file.read(reinterpret_cast<char*>(data.data()), data.size());
+	if (!file.good())
+		return false;
+
+	full_size = { header.full_width, header.full_height };
+	return image.setImageData(data, header.width, header.height, SImage::Type::RGBA);
+}
+
+// -----------------------------------------------------------------------------
+// Scales [image] down to fit within MAX_SIZE (if needed) and writes it to the
+// cache as RGBA for [key], using palette [pal] if it is paletted
+// -----------------------------------------------------------------------------
+void thumbnailcache::save(uint64_t key, const SImage& image, Palette* pal)
+{
+	if (key == 0 || !image.isValid())
+		return;
+
+	MemChunk rgba;
+	if (!image.putRGBAData(rgba, pal))
+		return;
+
+	// Scale down to fit, keeping the aspect ratio
+	int             width  = image.width();
+	int             height = image.height();
+	vector<uint8_t> scaled;
+	const uint8_t*  data = rgba.data();
+	if (width > MAX_SIZE || height > MAX_SIZE)
+	{
+		auto scale    = std::min(static_cast<double>(MAX_SIZE) / width, static_cast<double>(MAX_SIZE) / height);
+		auto n_width  = std::max(1, static_cast<int>(width * scale));
+		auto n_height = std::max(1, static_cast<int>(height * scale));
+		scaled.resize(static_cast<size_t>(n_width) * n_height * 4);
+		pixelkernels::scaleRGBA(
+			rgba.data(), width, height, scaled.data(), n_width, n_height, pixelkernels::ScaleFilter::Box);
+		data   = scaled.data();
+		width  = n_width;
+		height = n_height;
+	}
+
+	// Write to a temp file first, so a partially written thumbnail is never
+	// read by another thread
+	// (This can be called from a worker thread, so no logging here)
+	ThumbHeader header{ THUMB_MAGIC,
+						THUMB_VERSION,
+						static_cast<uint16_t>(width),
+						static_cast<uint16_t>(height),
+						static_cast<uint16_t>(image.width()),
+						static_cast<uint16_t>(image.height()),
+						0 };
+	auto path     = thumbPath(key);
+	auto tmp_path = fmt::format("{}.{}", path, std::hash<std::thread::id>{}(std::this_thread::get_id()));
+	{
+		std::ofstream file(tmp_path, std::ios::binary);
+		if (!file.is_open())
+			return;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(data), static_cast<size_t>(width) * height * 4);
+		if (!file.good())
+		{
+			file.close();
+			std::error_code error;
+			std::filesystem::remove(tmp_path, error);
+			return;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tmp_path, path, error);
+	if (error)
+		std::filesystem::remove(tmp_path, error);
+}
+
+// -----------------------------------------------------------------------------
+// Removes all cached thumbnails
+// -----------------------------------------------------------------------------
+void thumbnailcache::clear()
+{
+	std::error_code error;
+	for (const auto& item : std::filesystem::directory_iterator(cacheDir(), error))
+		if (item.is_regular_file(error))
+			std::filesystem::remove(item.path(), error);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// Clears the thumbnail cache
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(clear_thumbnail_cache, 0, true)
+{
+	thumbnailcache::clear();
+	log::info("Cleared thumbnail cache");
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+namespace slade
+{
+class Archive;
+class ArchiveEntry;
+class CTexture;
+class Palette;
+class SImage;
+
+// On-disk cache of small RGBA thumbnail images, so browser item images don't
+// need to be decoded (or composed) again in later sessions.
+// Keys are built from content (entry data, texture definitions and palettes)
+// so they stay valid between sessions. load and save don't access any entry
+// or other global state, so can be called from worker threads
+namespace thumbnailcache
+{
+	static constexpr int MAX_SIZE = 256; // Max. thumbnail width/height
+
+	uint64_t entryKey(ArchiveEntry& entry, const Palette* pal);
+	uint64_t textureKey(CTexture& texture, Archive* parent, const Palette* pal);
+	bool     load(uint64_t key, SImage& image, Vec2i& full_size);
+	void     save(uint64_t key, const SImage& image, Palette* pal);
+	void     clear();
+} // namespace thumbnailcache
+} // namespace slade
@@ -103,6 +103,8 @@ enum SpecialBlend
 // -----------------------------------------------------------------------------
 void Translation::parse(string_view def)
 {
+	compiled_.reset();
+
 	// Test for ZDoom built-in translation
 	string     def_str{ def };
 	const auto test = strutil::lower(def);
@@ -173,6 +175,8 @@ void Translation::parse(string_view def)
 // -----------------------------------------------------------------------------
 TransRange* Translation::parseRange(string_view range)
 {
+	compiled_.reset();
+
 	// Open definition string for processing w/tokenizer
 	Tokenizer tz;
 	tz.setSpecialCharacters("[]:%,=#@$");
@@ -359,6 +363,8 @@ TransRange* Translation::parseRange(string_view range)
 // -----------------------------------------------------------------------------
 void Translation::read(const uint8_t* data)
 {
+	compiled_.reset();
+
 	int     i = 0;
 	uint8_t val, o_start, o_end, d_start, d_end;
 	o_start = 0;
@@ -417,6 +423,7 @@ void Translation::clear()
 	translations_.clear();
 	built_in_name_ = "";
 	desat_amount_  = 0;
+	compiled_.reset();
 }
 
 // -----------------------------------------------------------------------------
@@ -455,8 +462,11 @@ TransRange* Translation::range(unsigned index)
 {
 	if (index >= translations_.size())
 		return nullptr;
-	else
-		return translations_[index].get();
+
+	// The range can be modified via the returned pointer
+	compiled_.reset();
+
+	return translations_[index].get();
 }
 
 // -----------------------------------------------------------------------------
@@ -636,6 +646,53 @@ ColRGBA Translation::translate(const ColRGBA& col, Palette* pal)
 	return colour;
 }
 
+// -----------------------------------------------------------------------------
+// Compiles the translation to lookup tables of the translated index and colour
+// for each index in [pal] (or the current palette if none given), so it can be
+// applied to many pixels without going through every range for each.
+// The tables are kept until the translation changes or it is compiled for a
+// different palette
+// -----------------------------------------------------------------------------
+const Translation::Table& Translation::compile(Palette* pal)
+{
+	if (pal == nullptr)
+		pal = maineditor::currentPalette();
+
+	// Check if already compiled for the palette
+	if (compiled_ && compiled_->greyscale[0] == *col_greyscale_r && compiled_->greyscale[1] == *col_greyscale_g
+		&& compiled_->greyscale[2] == *col_greyscale_b)
+	{
+		auto same = true;
+		for (unsigned a = 0; a < 256; ++a)
+			if (!compiled_->palette[a].equals(pal->colour(a), true))
+			{
+				same = false;
+				break;
+			}
+
+		if (same)
+			return compiled_->table;
+	}
+
+	if (!compiled_)
+		compiled_ = std::make_unique<Compiled>();
+
+	compiled_->greyscale[0] = col_greyscale_r;
+	compiled_->greyscale[1] = col_greyscale_g;
+	compiled_->greyscale[2] = col_greyscale_b;
+
+	// Translate each palette colour
+	for (unsigned a = 0; a < 256; ++a)
+	{
+		compiled_->palette[a]      = pal->colour(a);
+		const auto col             = translate(compiled_->palette[a], pal);
+		compiled_->table.colour[a] = col;
+		compiled_->table.index[a]  = col.index;
+	}
+
+	return compiled_->table;
+}
+
 // -----------------------------------------------------------------------------
 // Adds a new translation range of [type] at [pos] in the list, with the range
 // spanning from [range_start] to [range_end]
@@ -656,6 +713,7 @@ TransRange* Translation::addRange(TransRange::Type type, int pos, int range_star
 	}
 
 	// Add to list
+	compiled_.reset();
 	const auto ptr = tr.get();
 	if (pos < 0 || pos >= static_cast<int>(translations_.size()))
 		translations_.push_back(std::move(tr));
@@ -676,6 +734,7 @@ void Translation::removeRange(int pos)
 
 	// Remove it
 	translations_.erase(translations_.begin() + pos);
+	compiled_.reset();
 }
 
 // -----------------------------------------------------------------------------
@@ -690,6 +749,7 @@ void Translation::swapRanges(int pos1, int pos2)
 
 	// Swap them
 	translations_[pos1].swap(translations_[pos2]);
+	compiled_.reset();
 }
 
 // -----------------------------------------------------------------------------
@@ -259,6 +259,13 @@ class Palette;
 class Translation
 {
 public:
+	// The translation compiled to lookup tables for a palette (see compile)
+	struct Table
+	{
+		uint8_t index[256];  // Translated palette index for each palette index
+		ColRGBA colour[256]; // Translated colour for each palette index
+	};
+
 	Translation()  = default;
 	~Translation() = default;
 
@@ -277,10 +284,19 @@ public:
 	const string& builtInName() const { return built_in_name_; }
 	uint8_t       desaturationAmount() const { return desat_amount_; }
 
-	void setBuiltInName(string_view name) { built_in_name_ = name; }
-	void setDesaturationAmount(uint8_t amount) { desat_amount_ = amount; }
+	void setBuiltInName(string_view name)
+	{
+		built_in_name_ = name;
+		compiled_.reset();
+	}
+	void setDesaturationAmount(uint8_t amount)
+	{
+		desat_amount_ = amount;
+		compiled_.reset();
+	}
 
-	ColRGBA translate(const ColRGBA& col, Palette* pal = nullptr);
+	ColRGBA      translate(const ColRGBA& col, Palette* pal = nullptr);
+	const Table& compile(Palette* pal = nullptr);
 
 	TransRange* addRange(TransRange::Type type, int pos = -1, int range_start = 0, int range_end = 0);
 	void        removeRange(int pos);
@@ -290,8 +306,16 @@ public:
 	static string  getPredefined(string_view def);
 
 private:
+	struct Compiled
+	{
+		Table   table;
+		ColRGBA palette[256]; // Palette the table was compiled for
+		double  greyscale[3]; // Greyscale weights (col_greyscale_*) the table was compiled with
+	};
+
 	vector<unique_ptr<TransRange>> translations_;
 	string                         built_in_name_;
 	uint8_t                        desat_amount_ = 0;
+	unique_ptr<Compiled>           compiled_;
 };
 } // namespace slade
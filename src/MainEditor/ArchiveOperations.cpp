@@ -37,6 +37,8 @@
 #include "Archive/Formats/WadArchive.h"
 #include "General/Console.h"
 #include "General/ResourceManager.h"
+#include "General/Sigslot.h"
+#include "General/Tasks.h"
 #include "Graphics/CTexture/TextureXList.h"
 #include "MainEditor/MainEditor.h"
 #include "MainEditor/UI/MainWindow.h"
@@ -45,12 +47,15 @@
 #include "SLADEMap/MapFormat/HexenMapFormat.h"
 #include "SLADEMap/MapFormat/Doom32XMapFormat.h"
 #include "SLADEMap/MapObject/MapSector.h"
+#include "SLADEMap/MapUsageIndex.h"
 #include "UI/Dialogs/ExtMessageDialog.h"
 #include "UI/WxUtils.h"
 #include "Utility/FileUtils.h"
+#include "Utility/NameKey.h"
 #include "Utility/SFileDialog.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
+#include <unordered_set>
 
 using namespace slade;
 
@@ -62,7 +67,7 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 typedef std::map<wxString, int>                   StrIntMap;
 typedef std::map<wxString, vector<ArchiveEntry*>> PathMap;
-typedef std::map<int, vector<ArchiveEntry*>>      CRCMap;
+typedef std::map<uint64_t, vector<ArchiveEntry*>> HashMap;
 
 
 // -----------------------------------------------------------------------------
@@ -219,6 +224,7 @@ bool archiveoperations::removeUnusedPatches(Archive* archive)
 	}
 
 	// Remove unused patch entries
+	archive->beginBatch();
 	for (auto& a : to_remove)
 	{
 		log::info(wxString::Format("Removed entry %s", a->name()));
@@ -231,6 +237,7 @@ bool archiveoperations::removeUnusedPatches(Archive* archive)
 	// Write TEXTUREx changes
 	for (unsigned a = 0; a < tx_lists.size(); a++)
 		tx_lists[a]->writeTEXTUREXData(tx_entries[a], ptable);
+	archive->commitBatch();
 
 	// Cleanup
 	for (auto& tx_list : tx_lists)
@@ -254,23 +261,16 @@ bool archiveoperations::checkDuplicateEntryNames(Archive* archive)
 	StrIntMap map_namecounts;
 	PathMap   map_entries;
 
-	// Get list of all entries in archive
-	vector<ArchiveEntry*> entries;
-	archive->putEntryTreeAsList(entries);
-
-	// Go through list
-	for (auto& entry : entries)
-	{
-		// Skip directory entries
-		if (entry->type() == EntryType::folderType())
-			continue;
-
-		// Increment count for entry name
-		map_namecounts[entry->path(true)] += 1;
+	// Go through all entries in archive (not including directories)
+	archive->rootDir()->visitEntries(
+		[&](ArchiveEntry& entry)
+		{
+			// Increment count for entry name
+			map_namecounts[entry.path(true)] += 1;
 
-		// Enqueue entries
-		map_entries[string{ entry->nameNoExt() }].push_back(entry);
-	}
+			// Enqueue entries
+			map_entries[string{ entry.nameNoExt() }].push_back(&entry);
+		});
 
 	// Generate string of duplicate entry names
 	wxString dups;
@@ -330,6 +330,180 @@ bool archiveoperations::checkDuplicateEntryNames(Archive* archive)
 	return true;
 }
 
+namespace
+{
+// An index of the entries and texture definitions in the base resource
+// archive, built when first needed and reused by the IWAD override operations
+// until the base resource archive is changed or modified.
+// Entries are looked up by (upper case, extensionless) name and namespace, and
+// content comparisons use the entries' cached content hashes
+class BaseResourceIndex
+{
+public:
+	// A texture/flat/patch name defined by an entry in the base resource
+	struct AssetName
+	{
+		string        name;
+		ArchiveEntry* entry;
+	};
+
+	explicit BaseResourceIndex(const shared_ptr<Archive>& archive) :
+		archive_{ archive }, is_wad_{ archive->formatId() == "wad" }
+	{
+		// Index entries by name and namespace
+		archive->rootDir()->visitEntries(
+			[&](ArchiveEntry& entry)
+			{
+				auto name = entry.upperNameNoExt();
+				auto ns   = strutil::lower(archive->detectNamespace(&entry));
+				entries_[string{ name }]                    = &entry;
+				ns_entries_[fmt::format("{}/{}", ns, name)] = &entry;
+			});
+
+		signal_connections_ += archive->signals().modified.connect([this](Archive&, bool) { modified_ = true; });
+	}
+
+	// Returns the last entry named [name] (upper case, without extension) in
+	// namespace [ns], or null if none
+	ArchiveEntry* findLast(string_view ns, string_view name) const
+	{
+		// "global" and "graphics" namespaces cover the whole wad
+		if (is_wad_ && (ns.empty() || strutil::equalCI(ns, "global") || strutil::equalCI(ns, "graphics")))
+		{
+			auto i = entries_.find(string{ name });
+			return i != entries_.end() ? i->second : nullptr;
+		}
+
+		auto i = ns_entries_.find(fmt::format("{}/{}", strutil::lower(ns), name));
+		return i != ns_entries_.end() ? i->second : nullptr;
+	}
+
+	// Returns true if any TEXTUREx/TEXTURES entries were found
+	bool hasTextureDefinitions()
+	{
+		indexTextures();
+		return has_texture_defs_;
+	}
+
+	// Returns the TEXTUREx/TEXTURES entries defining texture [name] (upper case)
+	const vector<ArchiveEntry*>& textureEntries(const string& name)
+	{
+		static const vector<ArchiveEntry*> none;
+
+		indexTextures();
+		auto i = textures_.find(name);
+		return i != textures_.end() ? i->second : none;
+	}
+
+	// Returns all texture, flat and patch names in the base resource
+	const vector<AssetName>& assetNames()
+	{
+		indexTextures();
+		return asset_names_;
+	}
+
+	ArchiveEntry* pnames()
+	{
+		indexTextures();
+		return pnames_;
+	}
+
+	// Returns the index for the current base resource archive (building it if
+	// needed), or null if there is no base resource archive
+	static BaseResourceIndex* get()
+	{
+		static unique_ptr<BaseResourceIndex> index;
+
+		auto bra = app::archiveManager().baseResourceArchive();
+		if (!bra)
+		{
+			index.reset();
+			return nullptr;
+		}
+
+		if (!index || index->modified_ || index->archive_.lock().get() != bra)
+			index = std::make_unique<BaseResourceIndex>(app::archiveManager().shareArchive(bra));
+
+		return index.get();
+	}
+
+private:
+	weak_ptr<Archive>                                 archive_;
+	bool                                              is_wad_;
+	bool                                              modified_ = false;
+	std::unordered_map<string, ArchiveEntry*>         entries_;    // Last entry with each name
+	std::unordered_map<string, ArchiveEntry*>         ns_entries_; // Last entry with each namespace/name
+	bool                                              textures_indexed_ = false;
+	bool                                              has_texture_defs_ = false;
+	std::unordered_map<string, vector<ArchiveEntry*>> textures_; // TEXTUREx/TEXTURES entries defining each texture
+	vector<AssetName>                                 asset_names_;
+	ArchiveEntry*                                     pnames_ = nullptr;
+	ScopedConnectionList                              signal_connections_;
+
+	// Reads the texture definitions and patch table in the base resource (once)
+	void indexTextures()
+	{
+		auto archive = archive_.lock();
+		if (textures_indexed_ || !archive)
+			return;
+		textures_indexed_ = true;
+
+		// Textures and flats
+		for (auto ns : { "textures", "flats" })
+		{
+			Archive::SearchOptions opt;
+			opt.match_namespace = ns;
+			for (auto* entry : archive->findAll(opt))
+				if (entry->size() > 0)
+					asset_names_.push_back({ string{ entry->upperNameNoExt() }, entry });
+		}
+
+		// Patch table
+		Archive::SearchOptions opt;
+		opt.match_type = EntryType::fromId("pnames");
+		pnames_        = archive->findLast(opt);
+		PatchTable ptable;
+		if (pnames_)
+		{
+			ptable.loadPNAMES(pnames_);
+			for (unsigned a = 0; a < ptable.nPatches(); ++a)
+				asset_names_.push_back({ strutil::upper(ptable.patchName(a)), pnames_ });
+		}
+
+		// Texture definitions
+		auto add_textures = [this](ArchiveEntry* entry, TextureXList& list)
+		{
+			has_texture_defs_ = true;
+			for (unsigned a = 0; a < list.size(); ++a)
+			{
+				auto  name    = strutil::upper(list.texture(a)->name());
+				auto& entries = textures_[name];
+				if (entries.empty() || entries.back() != entry)
+					entries.push_back(entry);
+				asset_names_.push_back({ name, entry });
+			}
+		};
+		if (pnames_)
+		{
+			opt.match_type = EntryType::fromId("texturex");
+			for (auto* entry : archive->findAll(opt))
+			{
+				TextureXList list;
+				list.readTEXTUREXData(entry, ptable);
+				add_textures(entry, list);
+			}
+		}
+		opt.match_type = EntryType::fromId("zdtextures");
+		for (auto* entry : archive->findAll(opt))
+		{
+			TextureXList list;
+			list.readTEXTURESData(entry);
+			add_textures(entry, list);
+		}
+	}
+};
+} // namespace
+
 // -----------------------------------------------------------------------------
 // Compare the archive's entries with those sharing the same name and namespace
 // in the base resource archive, deleting duplicates
@@ -341,18 +515,17 @@ void archiveoperations::removeEntriesUnchangedFromIWAD(Archive* archive)
 	auto bra = app::archiveManager().baseResourceArchive();
 	if (bra == nullptr || bra == archive || archive == nullptr)
 		return;
+	auto bra_index = BaseResourceIndex::get();
 
 	// Get list of all entries in archive
 	vector<ArchiveEntry*> entries;
 	archive->putEntryTreeAsList(entries);
 
-	// Init search options
-	Archive::SearchOptions search;
-	ArchiveEntry*          other = nullptr;
-	wxString               dups  = "";
-	size_t                 count = 0;
+	wxString dups  = "";
+	size_t   count = 0;
 
 	// Go through list
+	archive->beginBatch();
 	for (auto& entry : entries)
 	{
 		// Skip directory entries
@@ -364,19 +537,18 @@ void archiveoperations::removeEntriesUnchangedFromIWAD(Archive* archive)
 			continue;
 
 		// Now, let's look for a counterpart in the IWAD
-		search.match_namespace = archive->detectNamespace(entry);
-		search.match_name      = entry->name();
-		other                  = bra->findLast(search);
+		auto other = bra_index->findLast(archive->detectNamespace(entry), entry->upperNameNoExt());
 
 		// If there is one, and it is identical, remove it
-		if (other != nullptr && (other->data().crc() == entry->data().crc()))
+		if (other != nullptr && other->size() == entry->size() && other->contentHash() == entry->contentHash())
 		{
 			++count;
-			dups += wxString::Format("%s\n", search.match_name);
+			dups += wxString::Format("%s\n", entry->upperName());
 			archive->removeEntry(entry);
 			entry = nullptr;
 		}
 	}
+	archive->commitBatch();
 
 
 	// If no duplicates exist, do nothing
@@ -409,40 +581,29 @@ bool archiveoperations::checkOverriddenEntriesInIWAD(Archive* archive)
 	auto bra = app::archiveManager().baseResourceArchive();
 	if (bra == nullptr || bra == archive || archive == nullptr)
 		return false;
+	auto bra_index = BaseResourceIndex::get();
 
-	// Get list of all entries in archive
-	vector<ArchiveEntry*> entries;
-	archive->putEntryTreeAsList(entries);
-
-	// Init search options
-	Archive::SearchOptions search;
-	ArchiveEntry*          other = nullptr;
-	wxString               overrides  = "";
-	size_t                 count = 0;
-
-	// Go through list
-	for (auto& entry : entries)
-	{
-		// Skip directory entries
-		if (entry->type() == EntryType::folderType())
-			continue;
+	wxString overrides = "";
+	size_t   count     = 0;
 
-		// Skip markers
-		if (entry->type() == EntryType::mapMarkerType() || entry->size() == 0)
-			continue;
+	// Go through all entries in archive (not including directories)
+	archive->rootDir()->visitEntries(
+		[&](ArchiveEntry& entry)
+		{
+			// Skip markers
+			if (entry.type() == EntryType::mapMarkerType() || entry.size() == 0)
+				return;
 
-		// Now, let's look for a counterpart in the IWAD
-		search.match_namespace = archive->detectNamespace(entry);
-		search.match_name      = entry->name();
-		other                  = bra->findLast(search);
+			// Now, let's look for a counterpart in the IWAD
+			auto ns = archive->detectNamespace(&entry);
 
-		// If there is one list it
-		if (other != nullptr)
-		{
-			++count;
-			overrides += wxString::Format("%s: %s\n", search.match_namespace, search.match_name);
-		}
-	}
+			// If there is one list it
+			if (bra_index->findLast(ns, entry.upperNameNoExt()) != nullptr)
+			{
+				++count;
+				overrides += wxString::Format("%s: %s\n", ns, entry.upperName());
+			}
+		});
 
 	// If no overrides exist, do nothing
 	if (count == 0)
@@ -465,7 +626,6 @@ bool archiveoperations::checkOverriddenEntriesInIWAD(Archive* archive)
 
 
 	// Find all texture entries
-	std::unordered_map<ArchiveEntry*, TextureXList> braTextureEntries;
 	std::unordered_multimap<string, std::pair<ArchiveEntry*, ArchiveEntry*>>  duplicate_texture_entries;
 	std::set<string>                                found_duplicate_textures;
 
@@ -478,30 +638,8 @@ bool archiveoperations::checkOverriddenEntriesInIWAD(Archive* archive)
 	Archive::SearchOptions zdtexturesopt;
 	zdtexturesopt.match_type = EntryType::fromId("zdtextures");
 
-
-	auto bra_pnames = bra->findLast(pnamesopt);
-
-	// Load BRA patch table and BRA textures
-	PatchTable bra_ptable;
-	if (bra_pnames)
-	{
-		bra_ptable.loadPNAMES(bra_pnames);
-
-		// Load all BRA Texturex entries
-		for (ArchiveEntry* texturexentry : bra->findAll(texturexopt))
-		{
-			braTextureEntries[texturexentry].readTEXTUREXData(texturexentry, bra_ptable);
-		}
-	}
-
-	// Load BRA Zdoom Textures
-	for (ArchiveEntry* texturesentry : bra->findAll(zdtexturesopt))
-	{
-		braTextureEntries[texturesentry].readTEXTURESData(texturesentry);
-	}
-
-	// If we ended up not loading textures from base resource archive
-	if (!braTextureEntries.size())
+	// If there are no texture definitions in the base resource archive
+	if (!bra_index->hasTextureDefinitions())
 	{
 		log::error("Base resource archive has no texture entries to compare against");
 		return true;
@@ -517,23 +655,18 @@ bool archiveoperations::checkOverriddenEntriesInIWAD(Archive* archive)
 
 	auto processTextureList = [&found_duplicate_textures, 
 		&duplicate_texture_entries, 
-		&braTextureEntries](ArchiveEntry* textureEntry, TextureXList& textureList)
+		bra_index](ArchiveEntry* textureEntry, TextureXList& textureList)
 	{
 		for (unsigned a = 0; a < textureList.textures().size(); a++)
 		{
 			CTexture* this_texture = textureList.texture(a);
 
-			for (auto const& iter : braTextureEntries)
+			for (auto* bra_entry : bra_index->textureEntries(strutil::upper(this_texture->name())))
 			{
-				int other_texture_index = iter.second.textureIndex(this_texture->name());
-
-				if (other_texture_index >= 0)
-				{
-					// Other texture with this name found
-					log::info(wxString::Format("Found Overridden Texture: %s.", this_texture->name()));
-					found_duplicate_textures.insert(this_texture->name());
-					duplicate_texture_entries.emplace(this_texture->name(), std::make_pair(textureEntry, iter.first));
-				}
+				// Other texture with this name found
+				log::info(wxString::Format("Found Overridden Texture: %s.", this_texture->name()));
+				found_duplicate_textures.insert(this_texture->name());
+				duplicate_texture_entries.emplace(this_texture->name(), std::make_pair(textureEntry, bra_entry));
 			}
 		}
 	};
@@ -605,6 +738,7 @@ bool archiveoperations::checkZDoomOverriddenEntriesInIWAD(Archive* archive)
 	auto bra = app::archiveManager().baseResourceArchive();
 	if (bra == nullptr || bra == archive || archive == nullptr)
 		return false;
+	auto bra_index = BaseResourceIndex::get();
 
 	std::unordered_multimap<string, ArchiveEntry*> archiveTexEntries;
 	std::unordered_multimap<string, ArchiveEntry*> overiddenBraTexEntries;
@@ -614,7 +748,7 @@ bool archiveoperations::checkZDoomOverriddenEntriesInIWAD(Archive* archive)
 	Archive::SearchOptions pnames_opt;
 	pnames_opt.match_type = EntryType::fromId("pnames");
 
-	auto braPnames = bra->findLast(pnames_opt);
+	auto braPnames = bra_index->pnames();
 
 	auto process_entries = [&archiveTexEntries](const vector<ArchiveEntry*> archive_entries)
 	{
@@ -714,121 +848,13 @@ bool archiveoperations::checkZDoomOverriddenEntriesInIWAD(Archive* archive)
 		}
 	}
 
-	auto process_bra_entries = [&archiveTexEntries, &overiddenBraTexEntries, &overiddenBraTexNames, &braPnames](
-								   const vector<ArchiveEntry*> archive_entries)
-	{
-		for (auto& archive_entry : archive_entries)
-		{
-			// Skip markers
-			if (archive_entry->size() == 0)
-				continue;
-
-			string entry_name{ archive_entry->upperNameNoExt() };
-
-			auto iter = archiveTexEntries.find(entry_name);
-
-			// If the pnames ptr is the same, we loaded pnames from the bra, so don't mark it as overridden
-			if (iter != archiveTexEntries.end() && iter->second != braPnames)
-			{
-				overiddenBraTexEntries.emplace(entry_name, archive_entry);
-				overiddenBraTexNames.insert(entry_name);
-			}
-		}
-	};
-
-	auto process_bra_patch_table = [&archiveTexEntries, &overiddenBraTexEntries, &overiddenBraTexNames](
-									   ArchiveEntry* pnames_entry, const PatchTable& patch_table)
-	{
-		for (int patchIndex = 0; patchIndex < patch_table.nPatches(); ++patchIndex)
-		{
-			string patch_name = string(patch_table.patchName(patchIndex));
-			patch_name        = strutil::upperIP(patch_name);
-
-			archiveTexEntries.emplace(patch_name, pnames_entry);
-
-			auto iter = archiveTexEntries.find(patch_name);
-
-			// If the pnames ptr is the same, we loaded pnames from the bra, so don't mark it as overridden
-			if (iter != archiveTexEntries.end() && iter->second != pnames_entry)
-			{
-				overiddenBraTexEntries.emplace(patch_name, pnames_entry);
-				overiddenBraTexNames.insert(patch_name);
-			}
-		}
-	};
-
-	auto process_bra_texture_list = [&archiveTexEntries, &overiddenBraTexEntries, &overiddenBraTexNames, &braPnames](
-										ArchiveEntry* texture_archive_entry, TextureXList& texture_list)
-	{
-		for (unsigned texture_index = 0; texture_index < texture_list.size(); texture_index++)
-		{
-			// Skip markers
-			if (texture_archive_entry->size() == 0)
-				continue;
-
-			auto texture = texture_list.texture(texture_index);
-
-			string texture_name = string(texture->name());
-			texture_name        = strutil::upperIP(texture_name);
-
-			auto iter = archiveTexEntries.find(texture_name);
-
-			// If the duplicate is the bra pnames, don't mark it as overridden
-			if (iter != archiveTexEntries.end()
-				&& iter->second != braPnames)
-			{
-				overiddenBraTexEntries.emplace(texture_name, texture_archive_entry);
-				overiddenBraTexNames.insert(texture_name);
-			}
-		}
-	};
-
-	// Find all textures
-	{
-		Archive::SearchOptions search_opt;
-		search_opt.match_namespace = "textures";
-		process_bra_entries(bra->findAll(search_opt));
-	}
-
-	// Find all flats
-	{
-		Archive::SearchOptions search_opt;
-		search_opt.match_namespace = "flats";
-		process_bra_entries(bra->findAll(search_opt));
-	}
-
-	// Load patch table
-	if (braPnames)
-	{
-		PatchTable ptable;
-		ptable.loadPNAMES(braPnames);
-
-		process_bra_patch_table(braPnames, ptable);
-
-		// Load all Texturex entries
-		Archive::SearchOptions texturexopt;
-		texturexopt.match_type = EntryType::fromId("texturex");
-
-		for (ArchiveEntry* texturexentry : bra->findAll(texturexopt))
-		{
-			TextureXList texture_list;
-			texture_list.readTEXTUREXData(texturexentry, ptable, true);
-
-			process_bra_texture_list(texturexentry, texture_list);
-		}
-	}
-
-	// Load all zdtextures entries
+	// Check all texture, flat and patch names in the base resource archive
+	for (const auto& asset : bra_index->assetNames())
 	{
-		Archive::SearchOptions zdtexturesopt;
-		zdtexturesopt.match_type = EntryType::fromId("zdtextures");
-
-		for (ArchiveEntry* texturesentry : bra->findAll(zdtexturesopt))
+		if (archiveTexEntries.count(asset.name) > 0)
 		{
-			TextureXList texture_list;
-			texture_list.readTEXTURESData(texturesentry);
-
-			process_bra_texture_list(texturesentry, texture_list);
+			overiddenBraTexEntries.emplace(asset.name, asset.entry);
+			overiddenBraTexNames.insert(asset.name);
 		}
 	}
 
@@ -887,26 +913,31 @@ bool archiveoperations::checkZDoomOverriddenEntriesInIWAD(Archive* archive)
 // -----------------------------------------------------------------------------
 bool archiveoperations::checkDuplicateEntryContent(const Archive* archive)
 {
-	CRCMap map_entries;
+	HashMap map_entries;
 
-	// Get list of all entries in archive
-	vector<ArchiveEntry*> entries;
-	archive->putEntryTreeAsList(entries);
 	wxString dups = "";
 
-	// Go through list
-	for (auto& entry : entries)
-	{
-		// Skip directory entries
-		if (entry->type() == EntryType::folderType())
-			continue;
+	// Group entries by size first, only entries with the same size need
+	// their content compared (saves loading data for unique sizes)
+	std::unordered_map<uint32_t, vector<ArchiveEntry*>> size_groups;
+	archive->rootDir()->visitEntries(
+		[&size_groups](ArchiveEntry& entry)
+		{
+			// Skip markers
+			if (entry.type() == EntryType::mapMarkerType() || entry.size() == 0)
+				return;
 
-		// Skip markers
-		if (entry->type() == EntryType::mapMarkerType() || entry->size() == 0)
+			size_groups[entry.size()].push_back(&entry);
+		});
+
+	// Enqueue entries by content hash
+	for (const auto& group : size_groups)
+	{
+		if (group.second.size() < 2)
 			continue;
 
-		// Enqueue entries
-		map_entries[entry->data().crc()].push_back(entry);
+		for (auto* entry : group.second)
+			map_entries[entry->contentHash()].push_back(entry);
 	}
 
 	// Now iterate through the dupes to list the name of the duplicated entries
@@ -917,7 +948,7 @@ bool archiveoperations::checkDuplicateEntryContent(const Archive* archive)
 		{
 			wxString name = i->second[0]->path(true);
 			name.Remove(0, 1);
-			dups += wxString::Format("\n%s\t(%8x) duplicated by", name, i->first);
+			dups += wxString::Format("\n%s\t(%016llx) duplicated by", name, static_cast<unsigned long long>(i->first));
 			auto j = i->second.begin() + 1;
 			while (j != i->second.end())
 			{
@@ -973,94 +1004,46 @@ struct TexUsed
 	TexUsed() : used(false) {}
 };
 WX_DECLARE_STRING_HASH_MAP(TexUsed, TexUsedMap);
-void archiveoperations::removeUnusedTextures(Archive* archive)
-{
-	// Check archive was given
-	if (!archive)
-		return;
-
-	// --- Build list of used textures ---
-	TexUsedMap used_textures;
-	int        total_maps = 0;
-
-	// Get all SIDEDEFS entries
-	Archive::SearchOptions opt;
-	opt.match_type = EntryType::fromId("map_sidedefs");
-	auto sidedefs  = archive->findAll(opt);
-	total_maps += sidedefs.size();
 
-	// Go through and add used textures to list
-	DoomMapFormat::SideDef sdef;
-	wxString               tex_lower, tex_middle, tex_upper;
-	for (auto& sidedef : sidedefs)
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the map usage index for [archive], brought up to date. If the archive
+// isn't open in the archive manager a temporary index is created in [temp]
+// instead
+// -----------------------------------------------------------------------------
+MapUsageIndex& usageIndex(Archive& archive, unique_ptr<MapUsageIndex>& temp)
+{
+	auto index = MapUsageIndex::forArchive(archive);
+	if (!index)
 	{
-		int nsides = sidedef->size() / 30;
-		sidedef->seek(0, SEEK_SET);
-		for (int s = 0; s < nsides; s++)
-		{
-			// Read side data
-			sidedef->read(&sdef, 30);
-
-			// Get textures
-			tex_lower  = wxString::FromAscii(sdef.tex_lower, 8);
-			tex_middle = wxString::FromAscii(sdef.tex_middle, 8);
-			tex_upper  = wxString::FromAscii(sdef.tex_upper, 8);
-
-			// Add to used textures list
-			used_textures[tex_lower].used  = true;
-			used_textures[tex_middle].used = true;
-			used_textures[tex_upper].used  = true;
-		}
+		temp  = std::make_unique<MapUsageIndex>(archive);
+		index = temp.get();
 	}
 
-	// Get all TEXTMAP entries
-	opt.match_name = "TEXTMAP";
-	opt.match_type = EntryType::fromId("udmf_textmap");
-	auto udmfmaps  = archive->findAll(opt);
-	total_maps += udmfmaps.size();
-
-	// Go through and add used textures to list
-	Tokenizer tz;
-	tz.setSpecialCharacters("{};=");
-	for (auto& udmfmap : udmfmaps)
-	{
-		// Open in tokenizer
-		tz.openMem(udmfmap->data(), "UDMF TEXTMAP");
-
-		// Go through text tokens
-		wxString token = tz.getToken();
-		while (!token.IsEmpty())
-		{
-			// Check for sidedef definition
-			if (token == "sidedef")
-			{
-				tz.getToken(); // Skip {
-
-				token = tz.getToken();
-				while (token != "}")
-				{
-					// Check for texture property
-					if (token == "texturetop" || token == "texturemiddle" || token == "texturebottom")
-					{
-						tz.getToken(); // Skip =
-						used_textures[tz.getToken()].used = true;
-					}
+	index->updateNow();
+	return *index;
+}
+} // namespace
 
-					token = tz.getToken();
-				}
-			}
+void archiveoperations::removeUnusedTextures(Archive* archive)
+{
+	// Check archive was given
+	if (!archive)
+		return;
 
-			// Next token
-			token = tz.getToken();
-		}
-	}
+	// --- Get list of used textures ---
+	unique_ptr<MapUsageIndex> temp_index;
+	auto&                     usage_index = usageIndex(*archive, temp_index);
 
 	// Check if any maps were found
-	if (total_maps == 0)
+	if (usage_index.maps().empty())
 		return;
 
+	auto used_textures = usage_index.usedTextures();
+
 	// Find all TEXTUREx entries
-	opt.match_name  = "";
+	Archive::SearchOptions opt;
 	opt.match_type  = EntryType::fromId("texturex");
 	auto tx_entries = archive->findAll(opt);
 
@@ -1101,7 +1084,7 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 			}
 
 			// Mark if unused and not part of an animation
-			if (!used_textures[texname].used && !anim && !thisend)
+			if (!used_textures.count(NameKey{ txlist.texture(t)->name() }) && !anim && !thisend)
 				unused_tex.Add(txlist.texture(t)->name());
 		}
 	}
@@ -1140,7 +1123,7 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 			swname.Replace("SW1", "SW2", false);
 
 			// Check if its counterpart is used
-			if (used_textures[swname].used)
+			if (used_textures.count(NameKey{ swname.ToStdString() }))
 				swtex = true;
 		}
 		else if (unused_tex[a].StartsWith("SW2"))
@@ -1150,7 +1133,7 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 			swname.Replace("SW2", "SW1", false);
 
 			// Check if its counterpart is used
-			if (used_textures[swname].used)
+			if (used_textures.count(NameKey{ swname.ToStdString() }))
 				swtex = true;
 		}
 
@@ -1174,6 +1157,8 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 	int n_removed = 0;
 	if (dialog.ShowModal() == wxID_OK)
 	{
+		ArchiveBatch batch{ *archive };
+
 		// Get selected textures
 		selection = dialog.GetSelections();
 
@@ -1211,86 +1196,18 @@ void archiveoperations::removeUnusedFlats(Archive* archive)
 	if (!archive)
 		return;
 
-	// --- Build list of used flats ---
-	TexUsedMap used_textures;
-	int        total_maps = 0;
-
-	// Get all SECTORS entries
-	Archive::SearchOptions opt;
-	opt.match_type = EntryType::fromId("map_sectors");
-	auto sectors   = archive->findAll(opt);
-	total_maps += sectors.size();
-
-	// Go through and add used flats to list
-	DoomMapFormat::Sector sec;
-	wxString              tex_floor, tex_ceil;
-	for (auto& sector : sectors)
-	{
-		int nsec = sector->size() / 26;
-		sector->seek(0, SEEK_SET);
-		for (int s = 0; s < nsec; s++)
-		{
-			// Read sector data
-			sector->read(&sec, 26);
-
-			// Get textures
-			tex_floor = wxString::FromAscii(sec.f_tex, 8);
-			tex_ceil  = wxString::FromAscii(sec.c_tex, 8);
-
-			// Add to used textures list
-			used_textures[tex_floor].used = true;
-			used_textures[tex_ceil].used  = true;
-		}
-	}
-
-	// Get all TEXTMAP entries
-	opt.match_name = "TEXTMAP";
-	opt.match_type = EntryType::fromId("udmf_textmap");
-	auto udmfmaps  = archive->findAll(opt);
-	total_maps += udmfmaps.size();
-
-	// Go through and add used flats to list
-	Tokenizer tz;
-	tz.setSpecialCharacters("{};=");
-	for (auto& udmfmap : udmfmaps)
-	{
-		// Open in tokenizer
-		tz.openMem(udmfmap->data(), "UDMF TEXTMAP");
-
-		// Go through text tokens
-		wxString token = tz.getToken();
-		while (!token.IsEmpty())
-		{
-			// Check for sector definition
-			if (token == "sector")
-			{
-				tz.getToken(); // Skip {
-
-				token = tz.getToken();
-				while (token != "}")
-				{
-					// Check for texture property
-					if (token == "texturefloor" || token == "textureceiling")
-					{
-						tz.getToken(); // Skip =
-						used_textures[tz.getToken()].used = true;
-					}
-
-					token = tz.getToken();
-				}
-			}
-
-			// Next token
-			token = tz.getToken();
-		}
-	}
+	// --- Get list of used flats ---
+	unique_ptr<MapUsageIndex> temp_index;
+	auto&                     usage_index = usageIndex(*archive, temp_index);
 
 	// Check if any maps were found
-	if (total_maps == 0)
+	if (usage_index.maps().empty())
 		return;
 
+	auto used_textures = usage_index.usedFlats();
+
 	// Find all flats
-	opt.match_name      = "";
+	Archive::SearchOptions opt;
 	opt.match_namespace = "flats";
 	opt.match_type      = nullptr;
 	auto flats          = archive->findAll(opt);
@@ -1330,7 +1247,7 @@ void archiveoperations::removeUnusedFlats(Archive* archive)
 		}
 
 		// Add if not animated
-		if (!used_textures[flatname].used && !anim && !thisend)
+		if (!used_textures.count(NameKey{ flatname }) && !anim && !thisend)
 			unused_tex.Add(flatname);
 	}
 
@@ -1350,6 +1267,8 @@ void archiveoperations::removeUnusedFlats(Archive* archive)
 	int n_removed = 0;
 	if (dialog.ShowModal() == wxID_OK)
 	{
+		ArchiveBatch batch{ *archive };
+
 		// Go through selected flats
 		selection           = dialog.GetSelections();
 		opt.match_namespace = "flats";
@@ -1400,143 +1319,45 @@ void archiveoperations::removeUnusedZDoomTextures(Archive* archive)
 	archive          = ptr_archive.get();
 
 	// --- Build list of used textures ---
-	TexUsedMap used_textures;
-	int        total_maps = 0;
-
-	auto process_maps_in_archive_func = [&total_maps, &used_textures](Archive* archive)
-	{
-		// Get all SIDEDEFS entries
-		Archive::SearchOptions side_def_opt;
-		side_def_opt.match_type = EntryType::fromId("map_sidedefs");
-		auto sidedefs           = archive->findAll(side_def_opt);
-		total_maps += sidedefs.size();
-
-		// Go through and add used textures to list
-		DoomMapFormat::SideDef sdef;
-		wxString               tex_lower, tex_middle, tex_upper;
-		for (auto& sidedef : sidedefs)
-		{
-			int nsides = sidedef->size() / 30;
-			sidedef->seek(0, SEEK_SET);
-			for (int s = 0; s < nsides; s++)
-			{
-				// Read side data
-				sidedef->read(&sdef, 30);
-
-				// Get textures
-				tex_lower  = wxString::FromAscii(sdef.tex_lower, 8);
-				tex_middle = wxString::FromAscii(sdef.tex_middle, 8);
-				tex_upper  = wxString::FromAscii(sdef.tex_upper, 8);
-
-				// Add to used textures list
-				used_textures[tex_lower].used  = true;
-				used_textures[tex_middle].used = true;
-				used_textures[tex_upper].used  = true;
-			}
-		}
-
-		// Get all SECTORS entries
-		Archive::SearchOptions sectors_opt;
-		sectors_opt.match_type = EntryType::fromId("map_sectors");
-		auto sectors           = archive->findAll(sectors_opt);
-		total_maps += sectors.size();
-
-		// Go through and add used flats to list
-		DoomMapFormat::Sector sec;
-		wxString              tex_floor, tex_ceil;
-		for (auto& sector : sectors)
-		{
-			int nsec = sector->size() / 26;
-			sector->seek(0, SEEK_SET);
-			for (int s = 0; s < nsec; s++)
-			{
-				// Read sector data
-				sector->read(&sec, 26);
-
-				// Get textures
-				tex_floor = wxString::FromAscii(sec.f_tex, 8);
-				tex_ceil  = wxString::FromAscii(sec.c_tex, 8);
-
-				// Add to used textures list
-				used_textures[tex_floor].used = true;
-				used_textures[tex_ceil].used  = true;
-			}
-		}
-
-		// Get all TEXTMAP entries
-		Archive::SearchOptions text_map_opt;
-		text_map_opt.match_name = "TEXTMAP";
-		text_map_opt.match_type = EntryType::fromId("udmf_textmap");
-		auto udmfmaps           = archive->findAll(text_map_opt);
-		total_maps += udmfmaps.size();
-
-		// Go through and add used textures and flats to list
-		Tokenizer tz;
-		tz.setSpecialCharacters("{};=");
-		for (auto& udmfmap : udmfmaps)
-		{
-			// Open in tokenizer
-			tz.openMem(udmfmap->data(), "UDMF TEXTMAP");
-
-			// Go through text tokens
-			wxString token = tz.getToken();
-			while (!token.IsEmpty())
-			{
-				// Check for sidedef definition
-				if (token == "sidedef")
-				{
-					tz.getToken(); // Skip {
-
-					token = tz.getToken();
-					while (token != "}")
-					{
-						// Check for texture property
-						if (token == "texturetop" || token == "texturemiddle" || token == "texturebottom")
-						{
-							tz.getToken(); // Skip =
-							used_textures[tz.getToken()].used = true;
-						}
-
-						token = tz.getToken();
-					}
-				}
-				// Check for sector definition
-				else if (token == "sector")
-				{
-					tz.getToken(); // Skip {
-
-					token = tz.getToken();
-					while (token != "}")
-					{
-						// Check for texture property
-						if (token == "texturefloor" || token == "textureceiling")
-						{
-							tz.getToken(); // Skip =
-							used_textures[tz.getToken()].used = true;
-						}
-
-						token = tz.getToken();
-					}
-				}
-
-				// Next token
-				token = tz.getToken();
-			}
-		}
-	};
 
-	process_maps_in_archive_func(archive);
-
-	// Get all wad entries and their maps
+	// Get all wad entries and open them to scan their maps too (the opened
+	// archives are kept until the maps have been scanned)
 	Archive::SearchOptions wad_opt;
 	wad_opt.match_type     = EntryType::fromId("wad");
 	wad_opt.search_subdirs = true;
 	auto wads              = archive->findAll(wad_opt);
 
+	vector<shared_ptr<Archive>> wad_archives;
+	vector<Archive*>            map_archives{ archive };
 	for (auto wad_entry : wads)
+		if (auto wad_archive = app::archiveManager().openArchive(wad_entry, false, false))
+		{
+			map_archives.push_back(wad_archive.get());
+			wad_archives.push_back(wad_archive);
+		}
+
+	// Index the maps in all of the archives (scanned together, in parallel)
+	vector<unique_ptr<MapUsageIndex>> temp_indexes;
+	vector<MapUsageIndex*>            usage_indexes;
+	for (auto* map_archive : map_archives)
+	{
+		auto index = MapUsageIndex::forArchive(*map_archive);
+		if (!index)
+			index = temp_indexes.emplace_back(std::make_unique<MapUsageIndex>(*map_archive)).get();
+		usage_indexes.push_back(index);
+	}
+	MapUsageIndex::updateNow(usage_indexes);
+
+	std::unordered_set<NameKey> used_textures;
+	size_t                      total_maps = 0;
+	for (auto* usage_index : usage_indexes)
 	{
-		auto wad_archive = app::archiveManager().openArchive(wad_entry, false, false);
-		process_maps_in_archive_func(wad_archive.get());
+		total_maps += usage_index->maps().size();
+
+		auto textures = usage_index->usedTextures();
+		auto flats    = usage_index->usedFlats();
+		used_textures.insert(textures.begin(), textures.end());
+		used_textures.insert(flats.begin(), flats.end());
 	}
 
 	// Check if any maps were found
@@ -1728,7 +1549,7 @@ void archiveoperations::removeUnusedZDoomTextures(Archive* archive)
 		string texture_name{ texture->nameNoExt() };
 
 		// TODO: When animdefs parser is more reliable, exclude animated textures here
-		if (!used_textures[texture_name].used)
+		if (!used_textures.count(NameKey{ texture_name }))
 		{
 			unused_tex.Add(texture_name);
 			unused_entries.push_back(texture);
@@ -1755,6 +1576,8 @@ void archiveoperations::removeUnusedZDoomTextures(Archive* archive)
 	int n_removed = 0;
 	if (textures_dialog.ShowModal() == wxID_OK)
 	{
+		ArchiveBatch batch{ *archive };
+
 		// Go through selected flats
 		selection = textures_dialog.GetSelections();
 		for (int i : selection)
@@ -1783,7 +1606,7 @@ void archiveoperations::removeUnusedZDoomTextures(Archive* archive)
 		string flatname{ flat->nameNoExt() };
 
 		// TODO: When animdefs parser is more reliable, exclude animated textures here
-		if (!used_textures[flatname].used)
+		if (!used_textures.count(NameKey{ flatname }))
 		{
 			unused_tex.Add(flatname);
 			unused_entries.push_back(flat);
@@ -1810,6 +1633,8 @@ void archiveoperations::removeUnusedZDoomTextures(Archive* archive)
 	n_removed = 0;
 	if (flats_dialog.ShowModal() == wxID_OK)
 	{
+		ArchiveBatch batch{ *archive };
+
 		// Go through selected flats
 		selection = flats_dialog.GetSelections();
 		for (int i : selection)
@@ -1837,7 +1662,7 @@ void archiveoperations::removeUnusedZDoomTextures(Archive* archive)
 			}
 
 			// TODO: When animdefs parser is more reliable, exclude animated textures here
-			if (!used_textures[texture->name()].used)
+			if (!used_textures.count(NameKey{ texture->name() }))
 				unused_tex.Add(texture->name());
 		}
 
@@ -2185,197 +2010,490 @@ CONSOLE_COMMAND(test_cleanzdoomtex, 0, false)
 		archiveoperations::removeUnusedZDoomTextures(current);
 }
 
-void importEntryDataKeepType(ArchiveEntry* entry, const void* data, unsigned size)
+// -----------------------------------------------------------------------------
+// Map search and replace
+//
+// Replacements are applied to the map lumps of all maps in parallel (see
+// runLumpPatches). Binary lumps are patched record by record in copy-on-write
+// buffers, and UDMF TEXTMAP lumps are rewritten by streaming through the text
+// and replacing only the values of changed fields (see rewriteUDMF), so
+// neither loads the map or builds a parse tree
+// -----------------------------------------------------------------------------
+namespace
 {
-	auto type = entry->type();
-	entry->importMem(data, size);
-	entry->setType(type, type->reliability());
-}
-size_t replaceThingsDoom(ArchiveEntry* entry, int oldtype, int newtype)
+// Copy-on-write buffer for patching lump data - the data is only copied when
+// the first change is made
+class PatchBuffer
 {
-	if (entry == nullptr)
-		return 0;
+public:
+	PatchBuffer(const uint8_t* data, size_t size) : data_{ data }, size_{ size } {}
+
+	bool                   modified() const { return modified_; }
+	const vector<uint8_t>& patched() const { return copy_; }
+	string_view            text() const { return { reinterpret_cast<const char*>(data_), size_ }; }
 
-	size_t size      = entry->size();
-	size_t numthings = size / sizeof(DoomMapFormat::Thing);
-	size_t changed   = 0;
+	template<typename T> size_t count() const { return size_ / sizeof(T); }
 
-	auto things = new DoomMapFormat::Thing[numthings];
-	memcpy(things, entry->rawData(), size);
+	template<typename T> T read(size_t index) const
+	{
+		T record;
+		memcpy(&record, (modified_ ? copy_.data() : data_) + index * sizeof(T), sizeof(T));
+		return record;
+	}
 
-	// Perform replacement
-	for (size_t t = 0; t < numthings; ++t)
+	template<typename T> void write(size_t index, const T& record)
 	{
-		if (things[t].type == oldtype)
+		if (!modified_)
 		{
-			things[t].type = newtype;
-			++changed;
+			copy_.assign(data_, data_ + size_);
+			modified_ = true;
 		}
+		memcpy(copy_.data() + index * sizeof(T), &record, sizeof(T));
 	}
-	// Import the changes if needed
-	if (changed > 0)
-		importEntryDataKeepType(entry, things, size);
-	delete[] things;
 
-	return changed;
-}
-size_t replaceThingsDoom64(ArchiveEntry* entry, int oldtype, int newtype)
+	void replace(string_view data)
+	{
+		copy_.assign(data.begin(), data.end());
+		modified_ = true;
+	}
+
+private:
+	const uint8_t*  data_;
+	size_t          size_;
+	vector<uint8_t> copy_;
+	bool            modified_ = false;
+};
+
+// A patch to apply to a map lump, returning the number of map elements changed
+struct LumpPatch
 {
-	if (entry == nullptr)
-		return 0;
+	ArchiveEntry*                       entry;
+	unsigned                            map; // Index of the map the lump is part of
+	std::function<size_t(PatchBuffer&)> patch;
+};
+
+// A block (eg. thing, linedef) in a UDMF TEXTMAP being rewritten
+struct UDMFBlock
+{
+	struct Field
+	{
+		string_view key;
+		string_view value;  // As written (strings include quotes)
+		size_t      offset; // Offset of the value in the TEXTMAP
+	};
+
+	string_view                       type;
+	vector<Field>                     fields;
+	size_t                            end = 0; // Offset of the closing brace
+	vector<std::pair<string, string>> set;     // Field values to set
+
+	const Field* field(string_view key) const
+	{
+		for (const auto& field : fields)
+			if (strutil::equalCI(field.key, key))
+				return &field;
+
+		return nullptr;
+	}
+
+	int intValue(string_view key) const
+	{
+		int value = 0;
+		if (auto* f = field(key))
+			strutil::toInt(f->value, value);
+		return value;
+	}
+
+	string stringValue(string_view key, string_view default_value) const
+	{
+		auto* f = field(key);
+		if (!f)
+			return string{ default_value };
+
+		auto value = f->value;
+		if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+			value = value.substr(1, value.size() - 2);
+		return string{ value };
+	}
+
+	void setValue(string_view key, string value)
+	{
+		for (auto& [set_key, set_value] : set)
+			if (set_key == key)
+			{
+				set_value = std::move(value);
+				return;
+			}
+
+		set.emplace_back(key, std::move(value));
+	}
+};
+
+// -----------------------------------------------------------------------------
+// Streams through UDMF [text] one block at a time (without building a parse
+// tree), calling [edit] for each block. Field values set in a block by [edit]
+// replace the original values, or are added to the end of the block if the
+// field isn't there.
+// Returns true and writes the rewritten text to [out] if anything was changed
+// -----------------------------------------------------------------------------
+bool rewriteUDMF(string_view text, string& out, const std::function<void(UDMFBlock&)>& edit)
+{
+	struct Edit
+	{
+		size_t offset;
+		size_t length;
+		string text;
+	};
+	vector<Edit> edits;
+
+	// Skips whitespace and comments
+	size_t pos  = 0;
+	auto   skip = [&]()
+	{
+		while (pos < text.size())
+		{
+			if (isspace(static_cast<unsigned char>(text[pos])))
+				++pos;
+			else if (text.compare(pos, 2, "//") == 0)
+				pos = std::min(text.find('\n', pos), text.size());
+			else if (text.compare(pos, 2, "/*") == 0)
+				pos = std::min(text.find("*/", pos + 2), text.size() - 2) + 2;
+			else
+				break;
+		}
+	};
 
-	size_t size      = entry->size();
-	size_t numthings = size / sizeof(Doom64MapFormat::Thing);
-	size_t changed   = 0;
+	// Reads an identifier (eg. block type or field key)
+	auto identifier = [&]()
+	{
+		skip();
+		auto start = pos;
+		while (pos < text.size() && (isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '_'))
+			++pos;
+		return text.substr(start, pos - start);
+	};
 
-	auto things = new Doom64MapFormat::Thing[numthings];
-	memcpy(things, entry->rawData(), size);
+	// Reads a value up to the next ;, setting [offset] to its start
+	auto value = [&](size_t& offset)
+	{
+		skip();
+		offset = pos;
+		while (pos < text.size() && text[pos] != ';')
+		{
+			// Skip strings (may contain ;)
+			if (text[pos] == '"')
+				for (++pos; pos < text.size() && text[pos] != '"'; ++pos)
+					if (text[pos] == '\\')
+						++pos;
+			++pos;
+		}
+		pos      = std::min(pos, text.size());
+		auto end = pos;
+		while (end > offset && isspace(static_cast<unsigned char>(text[end - 1])))
+			--end;
+		++pos; // Skip ;
+		return text.substr(offset, end - offset);
+	};
 
-	// Perform replacement
-	for (size_t t = 0; t < numthings; ++t)
+	while (true)
 	{
-		if (things[t].type == oldtype)
+		auto name = identifier();
+		skip();
+		if (pos >= text.size())
+			break;
+
+		// Unexpected character
+		if (name.empty())
 		{
-			things[t].type = newtype;
-			++changed;
+			++pos;
+			continue;
+		}
+
+		// Global assignment (eg. namespace)
+		if (text[pos] == '=')
+		{
+			size_t offset;
+			++pos;
+			value(offset);
+			continue;
+		}
+
+		if (text[pos] != '{')
+			continue;
+		++pos;
+
+		// Read block fields
+		UDMFBlock block;
+		block.type = name;
+		while (true)
+		{
+			auto key = identifier();
+			skip();
+			if (pos >= text.size())
+				break;
+			if (key.empty())
+			{
+				if (text[pos] == '}')
+					break;
+				++pos;
+				continue;
+			}
+			if (text[pos] != '=')
+				continue;
+
+			++pos;
+			size_t offset;
+			auto   val = value(offset);
+			block.fields.push_back({ key, val, offset });
+		}
+		block.end = std::min(pos, text.size());
+		++pos; // Skip }
+
+		// Edit block
+		edit(block);
+		for (auto& [key, val] : block.set)
+		{
+			if (auto* field = block.field(key))
+				edits.push_back({ field->offset, field->value.size(), std::move(val) });
+			else
+				edits.push_back({ block.end, 0, fmt::format("{} = {};\n", key, val) });
 		}
 	}
-	// Import the changes if needed
-	if (changed > 0)
-		importEntryDataKeepType(entry, things, size);
-	delete[] things;
 
-	return changed;
+	if (edits.empty())
+		return false;
+
+	// Write rewritten text
+	std::stable_sort(edits.begin(), edits.end(), [](const Edit& l, const Edit& r) { return l.offset < r.offset; });
+	out.clear();
+	out.reserve(text.size() + edits.size() * 8);
+	size_t copied = 0;
+	for (const auto& e : edits)
+	{
+		out.append(text.substr(copied, e.offset - copied));
+		out.append(e.text);
+		copied = e.offset + e.length;
+	}
+	out.append(text.substr(copied));
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Imports [data] to [entry], keeping its current type
+// -----------------------------------------------------------------------------
+void importEntryDataKeepType(ArchiveEntry* entry, const void* data, unsigned size)
+{
+	auto type = entry->type();
+	entry->importMem(data, size);
+	entry->setType(type, type->reliability());
+}
+
+// -----------------------------------------------------------------------------
+// Returns the first entry in [entries] of type [type_id], or null if none
+// -----------------------------------------------------------------------------
+ArchiveEntry* findMapEntry(const vector<ArchiveEntry*>& entries, string_view type_id)
+{
+	auto type = EntryType::fromId(type_id);
+	for (auto* entry : entries)
+		if (entry->type() == type)
+			return entry;
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the usage info in [index] for the map with header (or wad) entry
+// [head], or null if there is no index, it isn't up to date (it is still being
+// updated in the background) or the map isn't indexed
+// -----------------------------------------------------------------------------
+const MapUsageIndex::MapUsage* indexedMapUsage(MapUsageIndex* index, const ArchiveEntry* head)
+{
+	if (!index)
+		return nullptr;
+
+	index->update();
+	return index->isReady() ? index->mapUsage(head) : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Applies [patches] to their lumps on the task workers, then imports the
+// changed lumps and adds the number of elements changed in each map to
+// [map_changes]
+// -----------------------------------------------------------------------------
+void runLumpPatches(const vector<LumpPatch>& patches, vector<size_t>& map_changes)
+{
+	// Any entry data not loaded yet must be loaded here, not on the task
+	// workers
+	vector<PatchBuffer> buffers;
+	buffers.reserve(patches.size());
+	for (const auto& lump_patch : patches)
+		buffers.emplace_back(lump_patch.entry->rawData(), lump_patch.entry->size());
+
+	// Patch lumps
+	vector<size_t> changed(patches.size());
+	tasks::parallelFor(
+		0, patches.size(), [&](unsigned index) { changed[index] = patches[index].patch(buffers[index]); });
+
+	// Import changes
+	for (unsigned i = 0; i < patches.size(); ++i)
+	{
+		if (buffers[i].modified() && changed[i] > 0)
+			importEntryDataKeepType(patches[i].entry, buffers[i].patched().data(), buffers[i].patched().size());
+		map_changes[patches[i].map] += changed[i];
+	}
 }
-size_t replaceThingsHexen(ArchiveEntry* entry, int oldtype, int newtype)
+
+// -----------------------------------------------------------------------------
+// Opens the wad in [entry] (a map in a zip/pk3) and calls [replace] on it,
+// writing the wad back to [entry] if anything was changed.
+// Returns the number of map elements changed
+// -----------------------------------------------------------------------------
+size_t replaceInEmbeddedWad(ArchiveEntry* entry, const std::function<size_t(Archive*)>& replace)
 {
-	if (entry == nullptr)
+	auto wad = std::make_shared<WadArchive>();
+	if (!wad->open(entry->data()))
+		return 0;
+
+	auto changed = replace(wad.get());
+	if (changed == 0)
 		return 0;
 
-	size_t size      = entry->size();
-	size_t numthings = size / sizeof(HexenMapFormat::Thing);
-	size_t changed   = 0;
+	MemChunk mc;
+	if (!wad->write(mc, true))
+		return 0;
+	wad->close();
 
-	auto things = new HexenMapFormat::Thing[numthings];
-	memcpy(things, entry->rawData(), size);
+	return entry->importMemChunk(mc) ? changed : 0;
+}
 
-	// Perform replacement
-	for (size_t t = 0; t < numthings; ++t)
+// -----------------------------------------------------------------------------
+// Logs the number of [elements] changed in each of [maps], and returns the
+// total number changed
+// -----------------------------------------------------------------------------
+size_t reportChanges(const vector<Archive::MapDesc>& maps, const vector<size_t>& map_changes, const char* elements)
+{
+	size_t   changed = 0;
+	wxString report;
+	for (unsigned m = 0; m < maps.size(); ++m)
 	{
-		if (things[t].type == oldtype)
-		{
-			things[t].type = newtype;
-			++changed;
-		}
+		if (auto head = maps[m].head.lock())
+			report += wxString::Format("%s:\t%i %s changed\n", head->name(), (int)map_changes[m], elements);
+		changed += map_changes[m];
 	}
-	// Import the changes if needed
-	if (changed > 0)
-		importEntryDataKeepType(entry, things, size);
-	delete[] things;
 
+	log::info(1, report);
 	return changed;
 }
-size_t replaceThingsUDMF(ArchiveEntry* entry, int oldtype, int newtype)
-{
-	if (entry == nullptr)
-		return 0;
 
+// -----------------------------------------------------------------------------
+// Changes the type of all things (of struct type T) in [buffer] of type
+// [oldtype] to [newtype]
+// -----------------------------------------------------------------------------
+template<typename T> size_t replaceThingTypes(PatchBuffer& buffer, int oldtype, int newtype)
+{
 	size_t changed = 0;
-	// TODO: parse and replace code
-	// Import the changes if needed
-	if (changed > 0)
+	for (size_t t = 0; t < buffer.count<T>(); ++t)
 	{
-		// entry->importMemChunk(mc);
+		auto thing = buffer.read<T>(t);
+		if (thing.type != oldtype)
+			continue;
+
+		thing.type = newtype;
+		buffer.write(t, thing);
+		++changed;
 	}
+
 	return changed;
 }
-size_t archiveoperations::replaceThings(Archive* archive, int oldtype, int newtype)
+
+// -----------------------------------------------------------------------------
+// Changes the type of all things in UDMF TEXTMAP [buffer] of type [oldtype] to
+// [newtype]
+// -----------------------------------------------------------------------------
+size_t replaceThingsUDMF(PatchBuffer& buffer, int oldtype, int newtype)
 {
 	size_t changed = 0;
+	auto   edit    = [&](UDMFBlock& block)
+	{
+		if (strutil::equalCI(block.type, "thing") && block.intValue("type") == oldtype)
+		{
+			block.setValue("type", std::to_string(newtype));
+			++changed;
+		}
+	};
+
+	string text;
+	if (rewriteUDMF(buffer.text(), text, edit))
+		buffer.replace(text);
+
+	return changed;
+}
+} // namespace
+
+size_t archiveoperations::replaceThings(Archive* archive, int oldtype, int newtype)
+{
 	// Check archive was given
 	if (!archive)
-		return changed;
+		return 0;
 
-	// Get all maps
-	auto     maps   = archive->detectMaps();
-	wxString report = "";
+	// Maps without any things of the type can be skipped
+	auto usage_index = MapUsageIndex::forArchive(*archive);
 
-	for (auto& map : maps)
+	// Get all maps and the lumps to patch in each
+	auto              maps = archive->detectMaps();
+	vector<size_t>    map_changes(maps.size());
+	vector<LumpPatch> patches;
+	for (unsigned m = 0; m < maps.size(); ++m)
 	{
-		auto m_head = map.head.lock();
+		auto& map    = maps[m];
+		auto  m_head = map.head.lock();
 		if (!m_head)
 			continue;
 
-		size_t achanged = 0;
+		// Check if the type is used at all
+		if (auto usage = indexedMapUsage(usage_index, m_head.get());
+			usage && usage->format != MapFormat::Unknown && !usage->things.count(oldtype))
+			continue;
+
 		// Is it an embedded wad?
 		if (map.archive)
 		{
-			// Attempt to open entry as wad archive
-			auto temp_archive = std::make_shared<WadArchive>();
-			if (temp_archive->open(m_head->data()))
-			{
-				achanged = archiveoperations::replaceThings(temp_archive.get(), oldtype, newtype);
-				MemChunk mc;
-				if (!(temp_archive->write(mc, true)))
-				{
-					achanged = 0;
-				}
-				else
-				{
-					temp_archive->close();
-					if (!(m_head->importMemChunk(mc)))
-					{
-						achanged = 0;
-					}
-				}
-			}
+			map_changes[m] = replaceInEmbeddedWad(
+				m_head.get(),
+				[oldtype, newtype](Archive* wad) { return archiveoperations::replaceThings(wad, oldtype, newtype); });
+			continue;
 		}
-		else
-		{
-			// Find the map entry to modify
-			auto          entries = map.entries(*archive);
-			ArchiveEntry* things  = nullptr;
-			if (map.format == MapFormat::Doom || map.format == MapFormat::Doom64 || map.format == MapFormat::Hexen)
-			{
-				for (auto mapentry : entries)
-				{
-					if (mapentry->type() == EntryType::fromId("map_things"))
-					{
-						things = mapentry;
-						break;
-					}
-				}
-			}
-			else if (map.format == MapFormat::UDMF)
-			{
-				for (auto mapentry : entries)
-				{
-					if (mapentry->type() == EntryType::fromId("udmf_textmap"))
-					{
-						things = mapentry;
-						break;
-					}
-				}
-			}
 
-			// Did we get a map entry?
-			if (things)
-			{
-				switch (map.format)
-				{
-				case MapFormat::Doom: achanged = replaceThingsDoom(things, oldtype, newtype); break;
-				case MapFormat::Hexen: achanged = replaceThingsHexen(things, oldtype, newtype); break;
-				case MapFormat::Doom64: achanged = replaceThingsDoom64(things, oldtype, newtype); break;
-				case MapFormat::UDMF: achanged = replaceThingsUDMF(things, oldtype, newtype); break;
-				default: log::warning("Unknown map format for " + m_head->name()); break;
-				}
-			}
+		// Find the map entry to modify
+		auto entries = map.entries(*archive);
+		auto things  = findMapEntry(entries, map.format == MapFormat::UDMF ? "udmf_textmap" : "map_things");
+		if (!things)
+			continue;
+
+		std::function<size_t(PatchBuffer&)> patch;
+		switch (map.format)
+		{
+		case MapFormat::Doom:
+			patch = [=](PatchBuffer& b) { return replaceThingTypes<DoomMapFormat::Thing>(b, oldtype, newtype); };
+			break;
+		case MapFormat::Hexen:
+			patch = [=](PatchBuffer& b) { return replaceThingTypes<HexenMapFormat::Thing>(b, oldtype, newtype); };
+			break;
+		case MapFormat::Doom64:
+			patch = [=](PatchBuffer& b) { return replaceThingTypes<Doom64MapFormat::Thing>(b, oldtype, newtype); };
+			break;
+		case MapFormat::UDMF: patch = [=](PatchBuffer& b) { return replaceThingsUDMF(b, oldtype, newtype); }; break;
+		default: log::warning("Unknown map format for " + m_head->name()); continue;
 		}
-		report += wxString::Format("%s:\t%i things changed\n", m_head->name(), achanged);
-		changed += achanged;
+
+		patches.push_back({ things, m, patch });
 	}
-	log::info(1, report);
-	return changed;
+
+	// Apply replacements to all maps
+	runLumpPatches(patches, map_changes);
+
+	return reportChanges(maps, map_changes, "things");
 }
 
 CONSOLE_COMMAND(replacethings, 2, true)
@@ -2458,188 +2576,117 @@ CONSOLE_COMMAND(convertmapchex2to3, 0, false)
 	}
 }
 
-size_t replaceSpecialsDoom(ArchiveEntry* entry, int oldtype, int newtype, bool tag, int oldtag, int newtag)
+namespace
 {
-	if (entry == nullptr)
-		return 0;
-
-	size_t size     = entry->size();
-	size_t numlines = size / sizeof(DoomMapFormat::LineDef);
-	size_t changed  = 0;
+// Special (and args) replacement to perform
+struct SpecialReplace
+{
+	int  oldtype = 0;
+	int  newtype = 0;
+	bool lines   = true;
+	bool things  = true;
+	bool arg[5]{};    // Args to check/replace
+	int  oldarg[5]{}; // Arg values to replace
+	int  newarg[5]{}; // Arg values to replace with
+
+	bool argsMatch(const uint8_t* args) const
+	{
+		for (unsigned a = 0; a < 5; ++a)
+			if (arg[a] && args[a] != oldarg[a])
+				return false;
 
-	auto lines = new DoomMapFormat::LineDef[numlines];
-	memcpy(lines, entry->rawData(), size);
+		return true;
+	}
 
-	// Perform replacement
-	for (size_t l = 0; l < numlines; ++l)
+	void setArgs(uint8_t* args) const
 	{
-		if (lines[l].type == oldtype)
-		{
-			if (!tag || lines[l].sector_tag == oldtag)
-			{
-				lines[l].type = newtype;
-				if (tag)
-					lines[l].sector_tag = newtag;
-				++changed;
-			}
-		}
+		for (unsigned a = 0; a < 5; ++a)
+			if (arg[a])
+				args[a] = newarg[a];
 	}
-	// Import the changes if needed
-	if (changed > 0)
-		importEntryDataKeepType(entry, lines, size);
-	delete[] lines;
+};
 
-	return changed;
-}
-size_t replaceSpecialsDoom64(ArchiveEntry* entry, int oldtype, int newtype, bool tag, int oldtag, int newtag)
-{
-	return 0;
-}
-size_t replaceSpecialsHexen(
-	ArchiveEntry* l_entry,
-	ArchiveEntry* t_entry,
-	int           oldtype,
-	int           newtype,
-	bool          arg0,
-	bool          arg1,
-	bool          arg2,
-	bool          arg3,
-	bool          arg4,
-	int           oldarg0,
-	int           oldarg1,
-	int           oldarg2,
-	int           oldarg3,
-	int           oldarg4,
-	int           newarg0,
-	int           newarg1,
-	int           newarg2,
-	int           newarg3,
-	int           newarg4)
+// -----------------------------------------------------------------------------
+// Replaces specials of all Doom-format lines (of struct type T) in [buffer]
+// as specified in [rep]. Arg0 is used as the line's sector tag
+// -----------------------------------------------------------------------------
+template<typename T> size_t replaceLineSpecials(PatchBuffer& buffer, const SpecialReplace& rep)
 {
-	if (l_entry == nullptr && t_entry == nullptr)
-		return 0;
-
-	size_t size    = 0;
 	size_t changed = 0;
-
-	if (l_entry)
+	for (size_t l = 0; l < buffer.count<T>(); ++l)
 	{
-		size            = l_entry->size();
-		size_t numlines = size / sizeof(HexenMapFormat::LineDef);
-
-		auto lines = new HexenMapFormat::LineDef[numlines];
-		memcpy(lines, l_entry->rawData(), size);
-		size_t lchanged = 0;
+		auto line = buffer.read<T>(l);
+		if (line.type != rep.oldtype || (rep.arg[0] && line.sector_tag != rep.oldarg[0]))
+			continue;
 
-		// Perform replacement
-		for (size_t l = 0; l < numlines; ++l)
-		{
-			if (lines[l].type == oldtype)
-			{
-				if ((!arg0 || lines[l].args[0] == oldarg0) && (!arg1 || lines[l].args[1] == oldarg1)
-					&& (!arg2 || lines[l].args[2] == oldarg2) && (!arg3 || lines[l].args[3] == oldarg3)
-					&& (!arg4 || lines[l].args[4] == oldarg4))
-				{
-					lines[l].type = newtype;
-					if (arg0)
-						lines[l].args[0] = newarg0;
-					if (arg1)
-						lines[l].args[1] = newarg1;
-					if (arg2)
-						lines[l].args[2] = newarg2;
-					if (arg3)
-						lines[l].args[3] = newarg3;
-					if (arg4)
-						lines[l].args[4] = newarg4;
-					++lchanged;
-				}
-			}
-		}
-		// Import the changes if needed
-		if (lchanged > 0)
-		{
-			importEntryDataKeepType(l_entry, lines, size);
-			changed += lchanged;
-		}
-		delete[] lines;
+		line.type = rep.newtype;
+		if (rep.arg[0])
+			line.sector_tag = rep.newarg[0];
+		buffer.write(l, line);
+		++changed;
 	}
 
-	if (t_entry)
-	{
-		size             = t_entry->size();
-		size_t numthings = size / sizeof(HexenMapFormat::Thing);
+	return changed;
+}
 
-		auto things = new HexenMapFormat::Thing[numthings];
-		memcpy(things, t_entry->rawData(), size);
-		size_t tchanged = 0;
+// -----------------------------------------------------------------------------
+// Replaces specials of all Hexen-format lines or things (of struct type T) in
+// [buffer] as specified in [rep]. [special] is the special member of T
+// -----------------------------------------------------------------------------
+template<typename T> size_t replaceArgSpecials(PatchBuffer& buffer, const SpecialReplace& rep, uint8_t T::*special)
+{
+	size_t changed = 0;
+	for (size_t i = 0; i < buffer.count<T>(); ++i)
+	{
+		auto object = buffer.read<T>(i);
+		if (object.*special != rep.oldtype || !rep.argsMatch(object.args))
+			continue;
 
-		// Perform replacement
-		for (size_t t = 0; t < numthings; ++t)
-		{
-			if (things[t].type == oldtype)
-			{
-				if ((!arg0 || things[t].args[0] == oldarg0) && (!arg1 || things[t].args[1] == oldarg1)
-					&& (!arg2 || things[t].args[2] == oldarg2) && (!arg3 || things[t].args[3] == oldarg3)
-					&& (!arg4 || things[t].args[4] == oldarg4))
-				{
-					things[t].type = newtype;
-					if (arg0)
-						things[t].args[0] = newarg0;
-					if (arg1)
-						things[t].args[1] = newarg1;
-					if (arg2)
-						things[t].args[2] = newarg2;
-					if (arg3)
-						things[t].args[3] = newarg3;
-					if (arg4)
-						things[t].args[4] = newarg4;
-					++tchanged;
-				}
-			}
-		}
-		// Import the changes if needed
-		if (tchanged > 0)
-		{
-			importEntryDataKeepType(t_entry, things, size);
-			changed += tchanged;
-		}
-		delete[] things;
+		object.*special = rep.newtype;
+		rep.setArgs(object.args);
+		buffer.write(i, object);
+		++changed;
 	}
 
 	return changed;
 }
-size_t replaceSpecialsUDMF(
-	ArchiveEntry* entry,
-	int           oldtype,
-	int           newtype,
-	bool          arg0,
-	bool          arg1,
-	bool          arg2,
-	bool          arg3,
-	bool          arg4,
-	int           oldarg0,
-	int           oldarg1,
-	int           oldarg2,
-	int           oldarg3,
-	int           oldarg4,
-	int           newarg0,
-	int           newarg1,
-	int           newarg2,
-	int           newarg3,
-	int           newarg4)
+
+// -----------------------------------------------------------------------------
+// Replaces specials of all lines and/or things in UDMF TEXTMAP [buffer] as
+// specified in [rep]
+// -----------------------------------------------------------------------------
+size_t replaceSpecialsUDMF(PatchBuffer& buffer, const SpecialReplace& rep)
 {
-	if (entry == nullptr)
-		return 0;
+	static const char* arg_keys[] = { "arg0", "arg1", "arg2", "arg3", "arg4" };
 
 	size_t changed = 0;
-	// TODO: parse and replace code
-	// Import the changes if needed
-	if (changed > 0)
-	{
-		// entry->importMemChunk(mc);
-	}
+	auto   edit    = [&](UDMFBlock& block)
+	{
+		if (!(rep.lines && strutil::equalCI(block.type, "linedef"))
+			&& !(rep.things && strutil::equalCI(block.type, "thing")))
+			return;
+
+		if (block.intValue("special") != rep.oldtype)
+			return;
+		for (unsigned a = 0; a < 5; ++a)
+			if (rep.arg[a] && block.intValue(arg_keys[a]) != rep.oldarg[a])
+				return;
+
+		block.setValue("special", std::to_string(rep.newtype));
+		for (unsigned a = 0; a < 5; ++a)
+			if (rep.arg[a])
+				block.setValue(arg_keys[a], std::to_string(rep.newarg[a]));
+		++changed;
+	};
+
+	string text;
+	if (rewriteUDMF(buffer.text(), text, edit))
+		buffer.replace(text);
+
 	return changed;
 }
+} // namespace
+
 size_t archiveoperations::replaceSpecials(
 	Archive* archive,
 	int      oldtype,
@@ -2662,173 +2709,113 @@ size_t archiveoperations::replaceSpecials(
 	int      oldarg4,
 	int      newarg4)
 {
-	size_t changed = 0;
 	// Check archive was given
 	if (!archive)
-		return changed;
-
-	// Get all maps
-	auto     maps   = archive->detectMaps();
-	wxString report = "";
+		return 0;
 
-	for (auto& map : maps)
-	{
-		auto m_head = map.head.lock();
+	SpecialReplace rep{ oldtype,
+						newtype,
+						lines,
+						things,
+						{ arg0, arg1, arg2, arg3, arg4 },
+						{ oldarg0, oldarg1, oldarg2, oldarg3, oldarg4 },
+						{ newarg0, newarg1, newarg2, newarg3, newarg4 } };
+	bool           hexen_args = arg1 || arg2 || arg3 || arg4;
+
+	// Get all maps and the lumps to patch in each
+	auto              maps = archive->detectMaps();
+	vector<size_t>    map_changes(maps.size());
+	vector<LumpPatch> patches;
+	for (unsigned m = 0; m < maps.size(); ++m)
+	{
+		auto& map    = maps[m];
+		auto  m_head = map.head.lock();
 		if (!m_head)
 			continue;
 
-		size_t achanged = 0;
+		// Check if the texture is used at all
+		if (auto usage = indexedMapUsage(usage_index, m_head.get());
+			usage && usage->format != MapFormat::Doom64 && usage->format != MapFormat::Unknown
+			&& !(walls && usage->textures.count(old_key)) && !(flats && usage->flats.count(old_key)))
+			continue;
+
 		// Is it an embedded wad?
 		if (map.archive)
 		{
-			// Attempt to open entry as wad archive
-			Archive* temp_archive = new WadArchive();
-			if (temp_archive->open(m_head.get()))
-			{
-				achanged = archiveoperations::replaceSpecials(
-					temp_archive,
-					oldtype,
-					newtype,
-					lines,
-					things,
-					arg0,
-					oldarg0,
-					newarg0,
-					arg1,
-					oldarg1,
-					newarg1,
-					arg2,
-					oldarg2,
-					newarg2,
-					arg3,
-					oldarg3,
-					newarg3,
-					arg4,
-					oldarg4,
-					newarg4);
-				MemChunk mc;
-				if (!(temp_archive->write(mc, true)))
-				{
-					achanged = 0;
-				}
-				else
-				{
-					temp_archive->close();
-					if (!(m_head->importMemChunk(mc)))
-					{
-						achanged = 0;
-					}
-				}
-			}
-
-			// Cleanup
-			delete temp_archive;
-		}
-		else
-		{
-			// Find the map entry to modify
-			ArchiveEntry* t_entry = nullptr;
-			ArchiveEntry* l_entry = nullptr;
-			auto          entries = map.entries(*archive);
-			if (map.format == MapFormat::Doom || map.format == MapFormat::Doom64 || map.format == MapFormat::Hexen)
-			{
-				for (auto mapentry : entries)
+			map_changes[m] = replaceInEmbeddedWad(
+				m_head.get(),
+				[&](Archive* wad)
 				{
-					if (things && mapentry->type() == EntryType::fromId("map_things"))
-					{
-						t_entry = mapentry;
-						if (l_entry || !lines)
-							break;
-					}
-					if (lines && mapentry->type() == EntryType::fromId("map_linedefs"))
-					{
-						l_entry = mapentry;
-						if (t_entry || !things)
-							break;
-					}
-				}
-			}
-			else if (map.format == MapFormat::UDMF)
-			{
-				for (auto mapentry : entries)
-				{
-					if (mapentry->type() == EntryType::fromId("udmf_textmap"))
-					{
-						l_entry = t_entry = mapentry;
-						break;
-					}
-				}
-			}
-
-			// Did we get a map entry?
-			if (l_entry || t_entry)
-			{
-				switch (map.format)
-				{
-				case MapFormat::Doom:
-					if (arg1 || arg2 || arg3 || arg4) // Do nothing if Hexen specials are being modified
-						break;
-					achanged = replaceSpecialsDoom(l_entry, oldtype, newtype, arg0, oldarg0, newarg0);
-					break;
-				case MapFormat::Hexen:
-					if (oldtype > 255 || newtype > 255) // Do nothing if Doom specials are being modified
-						break;
-					achanged = replaceSpecialsHexen(
-						l_entry,
-						t_entry,
+					return archiveoperations::replaceSpecials(
+						wad,
 						oldtype,
 						newtype,
+						lines,
+						things,
 						arg0,
-						arg1,
-						arg2,
-						arg3,
-						arg4,
 						oldarg0,
-						oldarg1,
-						oldarg2,
-						oldarg3,
-						oldarg4,
 						newarg0,
-						newarg1,
-						newarg2,
-						newarg3,
-						newarg4);
-					break;
-				case MapFormat::Doom64:
-					if (arg1 || arg2 || arg3 || arg4) // Do nothing if Hexen specials are being modified
-						break;
-					achanged = replaceSpecialsDoom64(l_entry, oldtype, newtype, arg0, oldarg0, newarg0);
-					break;
-				case MapFormat::UDMF:
-					achanged = replaceSpecialsUDMF(
-						l_entry,
-						oldtype,
-						newtype,
-						arg0,
 						arg1,
-						arg2,
-						arg3,
-						arg4,
-						oldarg0,
 						oldarg1,
-						oldarg2,
-						oldarg3,
-						oldarg4,
-						newarg0,
 						newarg1,
+						arg2,
+						oldarg2,
 						newarg2,
+						arg3,
+						oldarg3,
 						newarg3,
+						arg4,
+						oldarg4,
 						newarg4);
-					break;
-				default: log::warning("Unknown map format for " + m_head->name()); break;
-				}
-			}
+				});
+			continue;
+		}
+
+		// Find the map entries to modify
+		auto entries   = map.entries(*archive);
+		auto l_entry   = lines ? findMapEntry(entries, "map_linedefs") : nullptr;
+		auto t_entry   = things ? findMapEntry(entries, "map_things") : nullptr;
+		auto add_patch = [&](ArchiveEntry* entry, std::function<size_t(PatchBuffer&)> patch)
+		{
+			if (entry)
+				patches.push_back({ entry, m, std::move(patch) });
+		};
+
+		switch (map.format)
+		{
+		case MapFormat::Doom:
+			if (hexen_args) // Do nothing if Hexen specials are being modified
+				break;
+			add_patch(l_entry, [rep](PatchBuffer& b) { return replaceLineSpecials<DoomMapFormat::LineDef>(b, rep); });
+			break;
+		case MapFormat::Hexen:
+			if (oldtype > 255 || newtype > 255) // Do nothing if Doom specials are being modified
+				break;
+			add_patch(
+				l_entry,
+				[rep](PatchBuffer& b) { return replaceArgSpecials(b, rep, &HexenMapFormat::LineDef::type); });
+			add_patch(
+				t_entry,
+				[rep](PatchBuffer& b) { return replaceArgSpecials(b, rep, &HexenMapFormat::Thing::special); });
+			break;
+		case MapFormat::Doom64:
+			if (hexen_args) // Do nothing if Hexen specials are being modified
+				break;
+			add_patch(l_entry, [rep](PatchBuffer& b) { return replaceLineSpecials<Doom64MapFormat::LineDef>(b, rep); });
+			break;
+		case MapFormat::UDMF:
+			add_patch(
+				findMapEntry(entries, "udmf_textmap"),
+				[rep](PatchBuffer& b) { return replaceSpecialsUDMF(b, rep); });
+			break;
+		default: log::warning("Unknown map format for " + m_head->name()); break;
 		}
-		report += wxString::Format("%s:\t%i specials changed\n", m_head->name(), achanged);
-		changed += achanged;
 	}
-	log::info(1, report);
-	return changed;
+
+	// Apply replacements to all maps
+	runLumpPatches(patches, map_changes);
+
+	return reportChanges(maps, map_changes, "specials");
 }
 
 CONSOLE_COMMAND(replacespecials, 2, true)
@@ -2883,227 +2870,241 @@ CONSOLE_COMMAND(replacespecials, 2, true)
 	}
 }
 
-bool replaceTextureString(char* str, wxString oldtex, wxString newtex)
+namespace
 {
-	bool go = true;
-	for (unsigned c = 0; c < oldtex.Length(); ++c)
+// Texture replacement to perform
+struct TextureReplace
+{
+	string   oldtex;
+	string   newtex;
+	uint16_t oldhash = 0; // Doom64 texture hashes
+	uint16_t newhash = 0;
+	bool     floor   = true;
+	bool     ceiling = true;
+	bool     lower   = true;
+	bool     middle  = true;
+	bool     upper   = true;
+};
+
+// -----------------------------------------------------------------------------
+// Replaces the 8-character texture name [str] with [newtex] if it matches
+// [oldtex]. [oldtex] can contain ? (any character) and * (anything after)
+// wildcards, and ? or * in [newtex] keep that character or the rest of the
+// name as-is.
+// Returns true if the name matched
+// -----------------------------------------------------------------------------
+bool replaceTextureString(char* str, string_view oldtex, string_view newtex)
+{
+	if (oldtex.size() > 8)
+		return false;
+
+	for (unsigned c = 0; c < oldtex.size(); ++c)
 	{
-		if (str[c] != oldtex[c] && oldtex[c] != '?' && oldtex[c] != '*')
-			go = false;
 		if (oldtex[c] == '*')
 			break;
+		if (str[c] != oldtex[c] && oldtex[c] != '?')
+			return false;
 	}
-	if (go)
+
+	for (unsigned i = 0; i < 8; ++i)
 	{
-		for (unsigned i = 0; i < 8; ++i)
+		if (i < newtex.size())
 		{
-			if (i < newtex.Len())
-			{
-				// Keep the rest of the name as-is?
-				if (newtex[i] == '*')
-					break;
-				// Keep just this character as-is?
-				if (newtex[i] == '?')
-					continue;
-				// Else, copy the character
-				str[i] = newtex[i];
-			}
-			else
-				str[i] = 0;
+			// Keep the rest of the name as-is?
+			if (newtex[i] == '*')
+				break;
+			// Keep just this character as-is?
+			if (newtex[i] == '?')
+				continue;
+			// Else, copy the character
+			str[i] = newtex[i];
 		}
+		else
+			str[i] = 0;
 	}
-	return go;
+
+	return true;
 }
-size_t replaceFlatsDoomHexen(
-	ArchiveEntry*   entry,
-	const wxString& oldtex,
-	const wxString& newtex,
-	bool            floor,
-	bool            ceiling)
+
+// -----------------------------------------------------------------------------
+// Replaces texture [name] (from a UDMF map) as specified in [rep].
+// Returns true if the name matched
+// -----------------------------------------------------------------------------
+bool replaceTextureName(string& name, const TextureReplace& rep)
 {
-	if (entry == nullptr)
-		return 0;
+	// Long names can only match exactly
+	if (name.size() > 8)
+	{
+		if (!strutil::equalCI(name, rep.oldtex))
+			return false;
 
-	size_t size       = entry->size();
-	size_t numsectors = size / sizeof(DoomMapFormat::Sector);
-	bool   fchanged, cchanged;
-	size_t changed = 0;
+		name = rep.newtex;
+		return true;
+	}
 
-	auto sectors = new DoomMapFormat::Sector[numsectors];
-	memcpy(sectors, entry->rawData(), size);
+	char str[9]{};
+	memcpy(str, name.data(), name.size());
+	if (!replaceTextureString(str, rep.oldtex, rep.newtex))
+		return false;
 
-	// Perform replacement
-	for (size_t s = 0; s < numsectors; ++s)
+	name = str;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Replaces the floor/ceiling textures of all Doom/Hexen-format sectors in
+// [buffer] as specified in [rep]
+// -----------------------------------------------------------------------------
+size_t replaceFlatsDoomHexen(PatchBuffer& buffer, const TextureReplace& rep)
+{
+	size_t changed = 0;
+	for (size_t s = 0; s < buffer.count<DoomMapFormat::Sector>(); ++s)
 	{
-		fchanged = cchanged = false;
-		if (floor)
-			fchanged = replaceTextureString(sectors[s].f_tex, oldtex, newtex);
-		if (ceiling)
-			cchanged = replaceTextureString(sectors[s].c_tex, oldtex, newtex);
+		auto sector   = buffer.read<DoomMapFormat::Sector>(s);
+		bool fchanged = rep.floor && replaceTextureString(sector.f_tex, rep.oldtex, rep.newtex);
+		bool cchanged = rep.ceiling && replaceTextureString(sector.c_tex, rep.oldtex, rep.newtex);
 		if (fchanged || cchanged)
+		{
+			buffer.write(s, sector);
 			++changed;
+		}
 	}
-	// Import the changes if needed
-	if (changed > 0)
-		importEntryDataKeepType(entry, sectors, size);
-	delete[] sectors;
 
 	return changed;
 }
-size_t replaceWallsDoomHexen(
-	ArchiveEntry*   entry,
-	const wxString& oldtex,
-	const wxString& newtex,
-	bool            lower,
-	bool            middle,
-	bool            upper)
-{
-	if (entry == nullptr)
-		return 0;
 
-	size_t size     = entry->size();
-	size_t numsides = size / sizeof(DoomMapFormat::SideDef);
-	bool   lchanged, mchanged, uchanged;
+// -----------------------------------------------------------------------------
+// Replaces the textures of all Doom/Hexen-format sides in [buffer] as
+// specified in [rep]
+// -----------------------------------------------------------------------------
+size_t replaceWallsDoomHexen(PatchBuffer& buffer, const TextureReplace& rep)
+{
 	size_t changed = 0;
-
-	DoomMapFormat::SideDef* sides = new DoomMapFormat::SideDef[numsides];
-	memcpy(sides, entry->rawData(), size);
-	char compare[9];
-	compare[8] = 0;
-
-	// Perform replacement
-	for (size_t s = 0; s < numsides; ++s)
-	{
-		lchanged = mchanged = uchanged = false;
-		if (lower)
-			lchanged = replaceTextureString(sides[s].tex_lower, oldtex, newtex);
-		if (middle)
-			mchanged = replaceTextureString(sides[s].tex_middle, oldtex, newtex);
-		if (upper)
-			uchanged = replaceTextureString(sides[s].tex_upper, oldtex, newtex);
+	for (size_t s = 0; s < buffer.count<DoomMapFormat::SideDef>(); ++s)
+	{
+		auto side     = buffer.read<DoomMapFormat::SideDef>(s);
+		bool lchanged = rep.lower && replaceTextureString(side.tex_lower, rep.oldtex, rep.newtex);
+		bool mchanged = rep.middle && replaceTextureString(side.tex_middle, rep.oldtex, rep.newtex);
+		bool uchanged = rep.upper && replaceTextureString(side.tex_upper, rep.oldtex, rep.newtex);
 		if (lchanged || mchanged || uchanged)
+		{
+			buffer.write(s, side);
 			++changed;
+		}
 	}
-	// Import the changes if needed
-	if (changed > 0)
-		importEntryDataKeepType(entry, sides, size);
-	delete[] sides;
 
 	return changed;
 }
-size_t replaceFlatsDoom64(ArchiveEntry* entry, const wxString& oldtex, const wxString& newtex, bool floor, bool ceiling)
+
+// -----------------------------------------------------------------------------
+// Replaces the floor/ceiling textures of all Doom64-format sectors in [buffer]
+// as specified in [rep]
+// -----------------------------------------------------------------------------
+size_t replaceFlatsDoom64(PatchBuffer& buffer, const TextureReplace& rep)
 {
-	if (entry == nullptr)
-		return 0;
+	auto replace = [&rep](uint16_t& tex, bool enabled)
+	{
+		if (!enabled || tex != rep.oldhash)
+			return false;
+		tex = rep.newhash;
+		return true;
+	};
 
-	size_t size       = entry->size();
-	size_t numsectors = size / sizeof(Doom64MapFormat::Sector);
-	bool   fchanged, cchanged;
 	size_t changed = 0;
+	for (size_t s = 0; s < buffer.count<Doom64MapFormat::Sector>(); ++s)
+	{
+		auto sector   = buffer.read<Doom64MapFormat::Sector>(s);
+		bool fchanged = replace(sector.f_tex, rep.floor);
+		bool cchanged = replace(sector.c_tex, rep.ceiling);
+		if (fchanged || cchanged)
+		{
+			buffer.write(s, sector);
+			++changed;
+		}
+	}
 
-	uint16_t oldhash = app::resources().getTextureHash(oldtex.ToStdString());
-	uint16_t newhash = app::resources().getTextureHash(newtex.ToStdString());
+	return changed;
+}
 
-	auto sectors = new Doom64MapFormat::Sector[numsectors];
-	memcpy(sectors, entry->rawData(), size);
+// -----------------------------------------------------------------------------
+// Replaces the textures of all Doom64-format sides in [buffer] as specified in
+// [rep]
+// -----------------------------------------------------------------------------
+size_t replaceWallsDoom64(PatchBuffer& buffer, const TextureReplace& rep)
+{
+	auto replace = [&rep](uint16_t& tex, bool enabled)
+	{
+		if (!enabled || tex != rep.oldhash)
+			return false;
+		tex = rep.newhash;
+		return true;
+	};
 
-	// Perform replacement
-	for (size_t s = 0; s < numsectors; ++s)
+	size_t changed = 0;
+	for (size_t s = 0; s < buffer.count<Doom64MapFormat::SideDef>(); ++s)
 	{
-		fchanged = cchanged = false;
-		if (floor && oldhash == sectors[s].f_tex)
-		{
-			sectors[s].f_tex = newhash;
-			fchanged         = true;
-		}
-		if (ceiling && oldhash == sectors[s].c_tex)
+		auto side     = buffer.read<Doom64MapFormat::SideDef>(s);
+		bool lchanged = replace(side.tex_lower, rep.lower);
+		bool mchanged = replace(side.tex_middle, rep.middle);
+		bool uchanged = replace(side.tex_upper, rep.upper);
+		if (lchanged || mchanged || uchanged)
 		{
-			sectors[s].c_tex = newhash;
-			cchanged         = true;
-		}
-		if (fchanged || cchanged)
+			buffer.write(s, side);
 			++changed;
+		}
 	}
-	// Import the changes if needed
-	if (changed > 0)
-		importEntryDataKeepType(entry, sectors, size);
-	delete[] sectors;
 
 	return changed;
 }
-size_t replaceWallsDoom64(
-	ArchiveEntry*   entry,
-	const wxString& oldtex,
-	const wxString& newtex,
-	bool            lower,
-	bool            middle,
-	bool            upper)
-{
-	if (entry == nullptr)
-		return 0;
 
-	size_t size     = entry->size();
-	size_t numsides = size / sizeof(Doom64MapFormat::SideDef);
-	bool   lchanged, mchanged, uchanged;
+// -----------------------------------------------------------------------------
+// Replaces the textures of all sectors and sides in UDMF TEXTMAP [buffer] as
+// specified in [rep]
+// -----------------------------------------------------------------------------
+size_t replaceTexturesUDMF(PatchBuffer& buffer, const TextureReplace& rep)
+{
 	size_t changed = 0;
+	auto   edit    = [&](UDMFBlock& block)
+	{
+		// Replaces the texture in [key] if [enabled], returns true if changed
+		auto replace = [&block, &rep](string_view key, bool enabled)
+		{
+			if (!enabled)
+				return false;
 
-	uint16_t oldhash = app::resources().getTextureHash(oldtex.ToStdString());
-	uint16_t newhash = app::resources().getTextureHash(newtex.ToStdString());
+			auto name = block.stringValue(key, "-");
+			if (!replaceTextureName(name, rep))
+				return false;
 
-	auto sides = new Doom64MapFormat::SideDef[numsides];
-	memcpy(sides, entry->rawData(), size);
+			block.setValue(key, fmt::format("\"{}\"", name));
+			return true;
+		};
 
-	// Perform replacement
-	for (size_t s = 0; s < numsides; ++s)
-	{
-		lchanged = mchanged = uchanged = false;
-		if (lower && oldhash == sides[s].tex_lower)
+		bool block_changed = false;
+		if (strutil::equalCI(block.type, "sector"))
 		{
-			sides[s].tex_lower = newhash;
-			lchanged           = true;
+			block_changed |= replace("texturefloor", rep.floor);
+			block_changed |= replace("textureceiling", rep.ceiling);
 		}
-		if (middle && oldhash == sides[s].tex_middle)
+		else if (strutil::equalCI(block.type, "sidedef"))
 		{
-			sides[s].tex_middle = newhash;
-			mchanged            = true;
+			block_changed |= replace("texturebottom", rep.lower);
+			block_changed |= replace("texturemiddle", rep.middle);
+			block_changed |= replace("texturetop", rep.upper);
 		}
-		if (upper && oldhash == sides[s].tex_upper)
-		{
-			sides[s].tex_upper = newhash;
-			uchanged           = true;
-		}
-		if (lchanged || mchanged || uchanged)
+
+		if (block_changed)
 			++changed;
-	}
-	// Import the changes if needed
-	if (changed > 0)
-		importEntryDataKeepType(entry, sides, size);
-	delete[] sides;
+	};
 
-	return changed;
-}
-size_t replaceTexturesUDMF(
-	ArchiveEntry*   entry,
-	const wxString& oldtex,
-	const wxString& newtex,
-	bool            floor,
-	bool            ceiling,
-	bool            lower,
-	bool            middle,
-	bool            upper)
-{
-	if (entry == nullptr)
-		return 0;
+	string text;
+	if (rewriteUDMF(buffer.text(), text, edit))
+		buffer.replace(text);
 
-	size_t changed = 0;
-	// TODO: parse and replace code
-	// Import the changes if needed
-	if (changed > 0)
-	{
-		// entry->importMemChunk(mc);
-	}
 	return changed;
 }
+} // namespace
+
 size_t archiveoperations::replaceTextures(
 	Archive*        archive,
 	const wxString& oldtex,
@@ -3114,117 +3115,93 @@ size_t archiveoperations::replaceTextures(
 	bool            middle,
 	bool            upper)
 {
-	size_t changed = 0;
 	// Check archive was given
 	if (!archive)
-		return changed;
-
-	// Get all maps
-	auto     maps   = archive->detectMaps();
-	wxString report = "";
+		return 0;
 
-	for (auto& map : maps)
-	{
-		auto m_head = map.head.lock();
+	// Texture hashes are looked up here rather than on the worker threads
+	TextureReplace rep{ oldtex.ToStdString(),
+						newtex.ToStdString(),
+						app::resources().getTextureHash(oldtex.ToStdString()),
+						app::resources().getTextureHash(newtex.ToStdString()),
+						floor,
+						ceiling,
+						lower,
+						middle,
+						upper };
+	bool           flats = floor || ceiling;
+	bool           walls = lower || middle || upper;
+
+	// Maps that don't use the texture can be skipped, if it is an exact name
+	// (Doom64 maps only reference textures by hash, so can't be checked)
+	auto    exact       = rep.oldtex.find_first_of("*?") == string::npos;
+	auto    usage_index = exact ? MapUsageIndex::forArchive(*archive) : nullptr;
+	NameKey old_key{ rep.oldtex };
+
+	// Get all maps and the lumps to patch in each
+	auto              maps = archive->detectMaps();
+	vector<size_t>    map_changes(maps.size());
+	vector<LumpPatch> patches;
+	for (unsigned m = 0; m < maps.size(); ++m)
+	{
+		auto& map    = maps[m];
+		auto  m_head = map.head.lock();
 		if (!m_head)
 			continue;
 
-		size_t achanged = 0;
+		// Check if the texture is used at all
+		if (auto usage = indexedMapUsage(usage_index, m_head.get());
+			usage && usage->format != MapFormat::Doom64 && usage->format != MapFormat::Unknown
+			&& !(walls && usage->textures.count(old_key)) && !(flats && usage->flats.count(old_key)))
+			continue;
+
 		// Is it an embedded wad?
 		if (map.archive)
 		{
-			// Attempt to open entry as wad archive
-			Archive* temp_archive = new WadArchive();
-			if (temp_archive->open(m_head.get()))
-			{
-				achanged = archiveoperations::replaceTextures(
-					temp_archive, oldtex, newtex, floor, ceiling, lower, middle, upper);
-				MemChunk mc;
-				if (!(temp_archive->write(mc, true)))
-				{
-					achanged = 0;
-				}
-				else
+			map_changes[m] = replaceInEmbeddedWad(
+				m_head.get(),
+				[&](Archive* wad)
 				{
-					temp_archive->close();
-					if (!(m_head->importMemChunk(mc)))
-					{
-						achanged = 0;
-					}
-				}
-			}
-
-			// Cleanup
-			delete temp_archive;
+					return archiveoperations::replaceTextures(
+						wad, oldtex, newtex, floor, ceiling, lower, middle, upper);
+				});
+			continue;
 		}
-		else
+
+		// Find the map entries to modify
+		auto entries   = map.entries(*archive);
+		auto sectors   = flats ? findMapEntry(entries, "map_sectors") : nullptr;
+		auto sides     = walls ? findMapEntry(entries, "map_sidedefs") : nullptr;
+		auto add_patch = [&](ArchiveEntry* entry, std::function<size_t(PatchBuffer&)> patch)
 		{
-			// Find the map entry to modify
-			ArchiveEntry* sectors = nullptr;
-			ArchiveEntry* sides   = nullptr;
-			auto          entries = map.entries(*archive);
-			if (map.format == MapFormat::Doom || map.format == MapFormat::Doom64 || map.format == MapFormat::Hexen)
-			{
-				for (auto mapentry : entries)
-				{
-					if ((floor || ceiling) && (mapentry->type() == EntryType::fromId("map_sectors")))
-					{
-						sectors = mapentry;
-						if (sides || !(lower || middle || upper))
-							break;
-					}
-					if ((lower || middle || upper) && (mapentry->type() == EntryType::fromId("map_sidedefs")))
-					{
-						sides = mapentry;
-						if (sectors || !(floor || ceiling))
-							break;
-					}
-				}
-			}
-			else if (map.format == MapFormat::UDMF)
-			{
-				for (auto mapentry : entries)
-				{
-					if (mapentry->type() == EntryType::fromId("udmf_textmap"))
-					{
-						sectors = sides = mapentry;
-						break;
-					}
-				}
-			}
+			if (entry)
+				patches.push_back({ entry, m, std::move(patch) });
+		};
 
-			// Did we get a map entry?
-			if (sectors || sides)
-			{
-				switch (map.format)
-				{
-				case MapFormat::Doom:
-				case MapFormat::Hexen:
-					achanged = 0;
-					if (sectors)
-						achanged += replaceFlatsDoomHexen(sectors, oldtex, newtex, floor, ceiling);
-					if (sides)
-						achanged += replaceWallsDoomHexen(sides, oldtex, newtex, lower, middle, upper);
-					break;
-				case MapFormat::Doom64:
-					achanged = 0;
-					if (sectors)
-						achanged += replaceFlatsDoom64(sectors, oldtex, newtex, floor, ceiling);
-					if (sides)
-						achanged += replaceWallsDoom64(sides, oldtex, newtex, lower, middle, upper);
-					break;
-				case MapFormat::UDMF:
-					achanged = replaceTexturesUDMF(sectors, oldtex, newtex, floor, ceiling, lower, middle, upper);
-					break;
-				default: log::warning("Unknown map format for " + m_head->name()); break;
-				}
-			}
+		switch (map.format)
+		{
+		case MapFormat::Doom:
+		case MapFormat::Hexen:
+			add_patch(sectors, [rep](PatchBuffer& b) { return replaceFlatsDoomHexen(b, rep); });
+			add_patch(sides, [rep](PatchBuffer& b) { return replaceWallsDoomHexen(b, rep); });
+			break;
+		case MapFormat::Doom64:
+			add_patch(sectors, [rep](PatchBuffer& b) { return replaceFlatsDoom64(b, rep); });
+			add_patch(sides, [rep](PatchBuffer& b) { return replaceWallsDoom64(b, rep); });
+			break;
+		case MapFormat::UDMF:
+			add_patch(
+				findMapEntry(entries, "udmf_textmap"),
+				[rep](PatchBuffer& b) { return replaceTexturesUDMF(b, rep); });
+			break;
+		default: log::warning("Unknown map format for " + m_head->name()); break;
 		}
-		report += wxString::Format("%s:\t%i elements changed\n", m_head->name(), achanged);
-		changed += achanged;
 	}
-	log::info(1, report);
-	return changed;
+
+	// Apply replacements to all maps
+	runLumpPatches(patches, map_changes);
+
+	return reportChanges(maps, map_changes, "elements");
 }
 
 CONSOLE_COMMAND(replacetextures, 2, true)
@@ -33,6 +33,7 @@
 #include "Conversions.h"
 #include "Archive/Archive.h"
 #include "Archive/ArchiveEntry.h"
+#include "Audio/SampleKernels.h"
 #include "thirdparty/mus2mid/mus2mid.h"
 #include "thirdparty/zreaders/i_music.h"
 
@@ -46,14 +47,13 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 namespace slade::conversion
 {
-const int16_t SIGN_BIT   = 0x80; // Sign bit = values are otherwise treated as unsigned).
-const int16_t QUANT_MASK = 0xf;  // Quantization field mask.
-const int16_t SEG_SHIFT  = 4;    // Left shift for segment number.
-const int16_t SEG_MASK   = 0x70; // Segment field mask.
-const int16_t BIAS       = 0x84; // Bias for linear code.
-const uint8_t WAV_PCM    = 1;
-const uint8_t WAV_ALAW   = 6;
-const uint8_t WAV_ULAW   = 7;
+const uint8_t WAV_PCM  = 1;
+const uint8_t WAV_ALAW = 6;
+const uint8_t WAV_ULAW = 7;
+
+// If set, conversion errors on this thread are written here instead of
+// global::error (see convertWithError)
+thread_local string* thread_error = nullptr;
 } // namespace slade::conversion
 CVAR(Bool, dmx_padding, true, CVar::Flag::Save)
 CVAR(Int, wolfsnd_rate, 7042, CVar::Flag::Save)
@@ -161,105 +161,74 @@ struct KvxColumnPostHeader
 namespace slade::conversion
 {
 // -----------------------------------------------------------------------------
-// Converts a 16-bit signed sample to an 8-bit unsigned one.
+// Returns the string to write conversion errors to for the current thread
 // -----------------------------------------------------------------------------
-uint8_t pcm16to8bits(int16_t val)
+string& error()
 {
-	// Value is in the [-32768, 32767] range.
-	// Shift it eight bits to [-128, 127] range,
-	// and add 128 to put it in [0, 255] range.
-	uint8_t ret = 128 + (val >> 8);
-	// Round value up or down depending on value
-	// of shifted-off bits.
-	if ((val & 0x80FF) > 127 && ret < 255)
-		ret++;
-	else if ((val & 0x80FF) < -128 && ret > 0)
-		ret--;
-	// Send it.
-	return ret;
+	return thread_error ? *thread_error : global::error;
 }
 
 // -----------------------------------------------------------------------------
-// Converts a 24-bit signed sample to an 8-bit unsigned one.
+// Reads the format of wav data [in] into [fmtchunk] and [wavfmt] (the format
+// tag, from the extension if present), checking it can be converted to doom
+// sound format. [ofs] is set to the offset of the fmt chunk
 // -----------------------------------------------------------------------------
-uint8_t pcm24to8bits(int32_t val)
+bool readWavFormat(MemChunk& in, WavFmtChunk& fmtchunk, uint8_t& wavfmt, size_t& ofs)
 {
-	int16_t ret = (val >> 8);
-	if ((val & 0x8000FF) > 127 && ret < 255)
-		ret++;
-	else if ((val & 0x8000FF) < -128 && ret > 0)
-		ret--;
-	return pcm16to8bits(ret);
-}
-
-// -----------------------------------------------------------------------------
-// Converts a 32-bit signed sample to an 8-bit unsigned one.
-// -----------------------------------------------------------------------------
-uint8_t pcm32to8bits(int32_t val)
-{
-	static const int32_t mod = 0x800000FF;
-	int32_t              ret = (val >> 8);
-	if ((val & mod) > 127 && ret < 255)
-		ret++;
-	else if ((val & mod) < -128 && ret > 0)
-		ret--;
-	return pcm24to8bits(ret);
-}
+	WavChunk chunk;
 
-// -----------------------------------------------------------------------------
-// Averages the values of two eight-bit unsigned samples into one.
-// -----------------------------------------------------------------------------
-uint8_t stereoToMono(uint8_t left, uint8_t right)
-{
-	uint16_t val = left + right;
-	val /= 2;
-	if (val > 255)
-		val = 255;
-	return (uint8_t)val;
-}
+	// Read header
+	in.seek(0, SEEK_SET);
+	in.read(&chunk, 8);
 
-// The following two functions are adapted from Sun Microsystem's g711.cpp code.
-// Unrestricted use and modifications are allowed.
+	// Check header
+	if (chunk.id[0] != 'R' || chunk.id[1] != 'I' || chunk.id[2] != 'F' || chunk.id[3] != 'F')
+	{
+		error() = "Invalid WAV";
+		return false;
+	}
 
-// -----------------------------------------------------------------------------
-// Converts a 8-bit A-law sample to 16-bit signed linear PCM
-// -----------------------------------------------------------------------------
-int16_t alawToLinear(uint8_t alaw)
-{
-	int16_t t;
-	int16_t seg;
+	// Read format
+	char format[4];
+	in.read(format, 4);
 
-	alaw ^= 0x55;
+	// Check format
+	if (format[0] != 'W' || format[1] != 'A' || format[2] != 'V' || format[3] != 'E')
+	{
+		error() = "Invalid WAV format";
+		return false;
+	}
 
-	t   = (alaw & QUANT_MASK) << 4;
-	seg = (alaw & SEG_MASK) >> SEG_SHIFT;
-	switch (seg)
+	// Find fmt chunk
+	ofs = 12;
+	while (ofs < in.size())
 	{
-	case 0: t += 8; break;
-	case 1: t += 0x108; break;
-	default: t += 0x108; t <<= seg - 1;
+		if (in[ofs] == 'f' && in[ofs + 1] == 'm' && in[ofs + 2] == 't' && in[ofs + 3] == ' ')
+			break;
+		ofs += 8 + in.readL32((ofs + 4));
 	}
-	return ((alaw & SIGN_BIT) ? t : -t);
-}
 
-// -----------------------------------------------------------------------------
-// Converts a 8-bit µ-law sample to 16-bit signed linear PCM
-// -----------------------------------------------------------------------------
-int16_t mulawToLinear(uint8_t ulaw)
-{
-	int t;
+	// Read fmt chunk
+	if (ofs + sizeof(WavFmtChunk) > in.size())
+	{
+		error() = "Invalid WAV: no 'fmt ' chunk";
+		return false;
+	}
+	in.seek(ofs, SEEK_SET);
+	in.read(&fmtchunk, sizeof(WavFmtChunk));
 
-	/* Complement to obtain normal u-law value. */
-	ulaw = ~ulaw;
+	// Get format
+	wavfmt = fmtchunk.tag == 0xFFFE ? in.readL32(ofs + 32) : fmtchunk.tag;
 
-	/*
-	 * Extract and bias the quantization bits. Then
-	 * shift up by the segment number and subtract out the bias.
-	 */
-	t = ((ulaw & QUANT_MASK) << 3) + BIAS;
-	t <<= (ulaw & SEG_MASK) >> SEG_SHIFT;
+	// Check fmt chunk values
+	if (fmtchunk.channels > 2 || fmtchunk.bps % 8 || fmtchunk.bps / 8 > 4
+		|| (wavfmt != WAV_PCM && wavfmt != WAV_ALAW && wavfmt != WAV_ULAW))
+	{
+		error() = "Cannot convert WAV file, only stereo or monophonic sounds in PCM format can be converted";
+		return false;
+	}
 
-	return ((ulaw & SIGN_BIT) ? (BIAS - t) : (t - BIAS));
+	return true;
 }
 } // namespace slade::conversion
 
@@ -286,12 +255,12 @@ bool conversion::doomSndToWav(MemChunk& in, MemChunk& out)
 	// Format checks
 	if (header.three != 3 && header.three != 0x300) // Check for magic number
 	{
-		global::error = "Invalid Doom Sound";
+		error() = "Invalid Doom Sound";
 		return false;
 	}
 	if (header.samples > (in.size() - 8) || header.samples <= 4) // Check for sane values
 	{
-		global::error = "Invalid Doom Sound";
+		error() = "Invalid Doom Sound";
 		return false;
 	}
 
@@ -366,69 +335,40 @@ bool conversion::doomSndToWav(MemChunk& in, MemChunk& out)
 }
 
 // -----------------------------------------------------------------------------
-// Converts wav data [in] to doom sound format, written to [out]
+// Returns true if converting wav data [in] to doom sound format would lose
+// audio quality (ie. it isn't 8-bit mono PCM)
 // -----------------------------------------------------------------------------
-bool conversion::wavToDoomSnd(MemChunk& in, MemChunk& out)
+bool conversion::wavToDoomSndIsLossy(MemChunk& in)
 {
-	// --- Read WAV ---
-	WavChunk chunk;
-
-	// Read header
-	in.seek(0, SEEK_SET);
-	in.read(&chunk, 8);
-
-	// Check header
-	if (chunk.id[0] != 'R' || chunk.id[1] != 'I' || chunk.id[2] != 'F' || chunk.id[3] != 'F')
-	{
-		global::error = "Invalid WAV";
-		return false;
-	}
-
-	// Read format
-	char format[4];
-	in.read(format, 4);
-
-	// Check format
-	if (format[0] != 'W' || format[1] != 'A' || format[2] != 'V' || format[3] != 'E')
-	{
-		global::error = "Invalid WAV format";
+	WavFmtChunk fmtchunk;
+	uint8_t     wavfmt;
+	size_t      ofs;
+	if (!readWavFormat(in, fmtchunk, wavfmt, ofs))
 		return false;
-	}
 
-	// Find fmt chunk
-	size_t ofs = 12;
-	while (ofs < in.size())
-	{
-		if (in[ofs] == 'f' && in[ofs + 1] == 'm' && in[ofs + 2] == 't' && in[ofs + 3] == ' ')
-			break;
-		ofs += 8 + in.readL32((ofs + 4));
-	}
+	return fmtchunk.bps > 8 || wavfmt != WAV_PCM || fmtchunk.channels == 2;
+}
 
-	// Read fmt chunk
-	if (ofs + sizeof(WavFmtChunk) > in.size())
-	{
-		global::error = "Invalid WAV: no 'fmt ' chunk";
-		return false;
-	}
-	in.seek(ofs, SEEK_SET);
+// -----------------------------------------------------------------------------
+// Converts wav data [in] to doom sound format, written to [out].
+// If [confirm_lossy] is true, the user is asked to confirm the conversion if
+// it will lose audio quality
+// -----------------------------------------------------------------------------
+bool conversion::wavToDoomSnd(MemChunk& in, MemChunk& out, bool confirm_lossy)
+{
+	// --- Read WAV ---
+	WavChunk    chunk;
 	WavFmtChunk fmtchunk;
-	in.read(&fmtchunk, sizeof(WavFmtChunk));
+	uint8_t     wavfmt;
+	size_t      ofs;
+	if (!readWavFormat(in, fmtchunk, wavfmt, ofs))
+		return false;
 
-	// Get format
-	uint8_t wavfmt = fmtchunk.tag == 0xFFFE ? in.readL32(ofs + 32) : fmtchunk.tag;
 	// Get byte per samples (from bits per sample)
 	uint8_t wavbps = fmtchunk.bps / 8;
 
-	// Check fmt chunk values
-	if (fmtchunk.channels > 2 || fmtchunk.bps % 8 || wavbps > 4
-		|| (wavfmt != WAV_PCM && wavfmt != WAV_ALAW && wavfmt != WAV_ULAW))
-	{
-		global::error = "Cannot convert WAV file, only stereo or monophonic sounds in PCM format can be converted";
-		return false;
-	}
-
 	// Warn
-	if (wavbps > 1 || wavfmt != WAV_PCM || fmtchunk.channels == 2)
+	if (confirm_lossy && (wavbps > 1 || wavfmt != WAV_PCM || fmtchunk.channels == 2))
 	{
 		if (!(wxMessageBox(
 				  "Warning: conversion will result in loss of metadata and audio quality. Do you wish to proceed?",
@@ -436,7 +376,7 @@ bool conversion::wavToDoomSnd(MemChunk& in, MemChunk& out)
 				  wxOK | wxCANCEL)
 			  == wxOK))
 		{
-			global::error = "Conversion aborted by user";
+			error() = "Conversion aborted by user";
 			return false;
 		}
 	}
@@ -453,7 +393,7 @@ bool conversion::wavToDoomSnd(MemChunk& in, MemChunk& out)
 	// Read data
 	if (ofs + sizeof(WavFmtChunk) > in.size())
 	{
-		global::error = "Invalid WAV: no 'data' chunk";
+		error() = "Invalid WAV: no 'data' chunk";
 		return false;
 	}
 	in.seek(ofs, SEEK_SET);
@@ -462,47 +402,41 @@ bool conversion::wavToDoomSnd(MemChunk& in, MemChunk& out)
 	if (wavbps > 1)
 		chunk.size /= wavbps;
 
+	// Clamp to the sample data actually present
+	const auto* samples   = in.data() + in.currentPos();
+	size_t      available = in.size() - in.currentPos();
+	if (chunk.size * std::max<size_t>(wavbps, 1) > available)
+		chunk.size = available / std::max<size_t>(wavbps, 1);
+	if (chunk.size < fmtchunk.channels || chunk.size == 0)
+	{
+		error() = "Invalid WAV: no sample data";
+		return false;
+	}
+
 	vector<uint8_t> data(chunk.size);
 	uint8_t         padding[16];
 
-	// Store sample data. A simple read for 8 bits per sample.
-	if (fmtchunk.bps == 8)
-		in.read(data.data(), chunk.size);
-	// For 16, 24, or 32 bits per sample, downsample to 8.
-	else
+	// Store sample data. A simple copy for 8 bits per sample, for 16, 24, or
+	// 32 bits per sample, downsample to 8.
+	switch (wavbps)
 	{
-		int32_t val = 0;
-		for (size_t i = 0; i < chunk.size; ++i)
-		{
-			in.read(&val, wavbps);
-			if (wavbps == 4)
-				data[i] = pcm32to8bits(val);
-			else if (wavbps == 3)
-				data[i] = pcm24to8bits(val);
-			else if (wavbps == 2)
-				data[i] = pcm16to8bits((int16_t)val);
-		}
+	case 4: samplekernels::pcm32to8(samples, data.data(), chunk.size); break;
+	case 3: samplekernels::pcm24to8(samples, data.data(), chunk.size); break;
+	case 2: samplekernels::pcm16to8(samples, data.data(), chunk.size); break;
+	default: memcpy(data.data(), samples, chunk.size); break;
 	}
 
 	// Convert A-law or µ-law to 8-bit linear
-	if (wavfmt == WAV_ALAW || wavfmt == WAV_ULAW)
-	{
-		for (size_t i = 0; i < chunk.size; ++i)
-		{
-			int16_t val = (wavfmt == WAV_ALAW) ? alawToLinear(data[i]) : mulawToLinear(data[i]);
-			data[i]     = pcm16to8bits(val);
-		}
-	}
+	if (wavfmt == WAV_ALAW)
+		samplekernels::alawTo8(data.data(), chunk.size);
+	else if (wavfmt == WAV_ULAW)
+		samplekernels::mulawTo8(data.data(), chunk.size);
 
 	// Merge stereo channels into a single mono one
 	if (fmtchunk.channels == 2)
 	{
 		chunk.size /= 2;
-		for (size_t i = 0; i < chunk.size; ++i)
-		{
-			size_t j = 2 * i;
-			data[i]  = stereoToMono(data[j], data[j + 1]);
-		}
+		samplekernels::stereoToMono(data.data(), data.data(), chunk.size);
 	}
 
 	// --- Write Doom Sound ---
@@ -557,7 +491,7 @@ bool conversion::vocToWav(MemChunk& in, MemChunk& out)
 	if (in.size() < 26 || in[19] != 26 || in[20] != 26 || in[21] != 0
 		|| (0x1234 + ~(in.readL16(22)) != (in.readL16(24))))
 	{
-		global::error = "Invalid VOC";
+		error() = "Invalid VOC";
 		return false;
 	}
 
@@ -579,7 +513,7 @@ bool conversion::vocToWav(MemChunk& in, MemChunk& out)
 		i += 4;
 		if (i + blocksize > e && i < e && blocktype != 0)
 		{
-			global::error = fmt::format("VOC file cut abruptly in block {}", blockcount);
+			error() = fmt::format("VOC file cut abruptly in block {}", blockcount);
 			return false;
 		}
 		blockcount++;
@@ -591,7 +525,7 @@ bool conversion::vocToWav(MemChunk& in, MemChunk& out)
 		case 1: // Sound data
 			if (!gotextra && codec >= 0 && codec != in[i + 1])
 			{
-				global::error = "VOC files with different codecs are not supported";
+				error() = "VOC files with different codecs are not supported";
 				return false;
 			}
 			else if (codec == -1)
@@ -606,7 +540,7 @@ bool conversion::vocToWav(MemChunk& in, MemChunk& out)
 		case 2: // Sound data continuation
 			if (codec == -1)
 			{
-				global::error = "Sound data without codec in VOC file";
+				error() = "Sound data without codec in VOC file";
 				return false;
 			}
 			datasize += blocksize;
@@ -620,7 +554,7 @@ bool conversion::vocToWav(MemChunk& in, MemChunk& out)
 		case 8: // Extra info, overrides any following sound data codec info
 			if (codec != -1)
 			{
-				global::error = "Extra info block must precede sound data info block in VOC file";
+				error() = "Extra info block must precede sound data info block in VOC file";
 				return false;
 			}
 			else
@@ -634,7 +568,7 @@ bool conversion::vocToWav(MemChunk& in, MemChunk& out)
 		case 9: // Sound data in new format
 			if (codec >= 0 && codec != in.readL16(i + 6))
 			{
-				global::error = "VOC files with different codecs are not supported";
+				error() = "VOC files with different codecs are not supported";
 				return false;
 			}
 			else if (codec == -1)
@@ -669,9 +603,9 @@ bool conversion::vocToWav(MemChunk& in, MemChunk& out)
 	case 6:     // alaw
 	case 7:     // ulaw
 	case 0x200: // 4 bits to 16 bits Creative ADPCM (only valid in block type 0x09)
-		global::error = fmt::format("Unsupported codec {} in VOC file", codec);
+		error() = fmt::format("Unsupported codec {} in VOC file", codec);
 		return false;
-	default: global::error = fmt::format("Unknown codec {} in VOC file", codec); return false;
+	default: error() = fmt::format("Unknown codec {} in VOC file", codec); return false;
 	}
 
 	// --- Write WAV ---
@@ -690,6 +624,9 @@ bool conversion::vocToWav(MemChunk& in, MemChunk& out)
 	memcpy(&whdr.id, &wid, 4);
 	whdr.size = wdhdr.size + fmtchunk.header.size + 20;
 
+	// Sound data is copied block by block, so reserve the full size up-front
+	out.reserve(whdr.size + 8);
+
 	// Write chunks
 	out.write(&whdr, 8);
 	out.write("WAVE", 4);
@@ -731,10 +668,10 @@ bool conversion::vocToWav(MemChunk& in, MemChunk& out)
 // -----------------------------------------------------------------------------
 bool conversion::bloodToWav(ArchiveEntry* in, MemChunk& out)
 {
-	auto& mc = in->data();
+	const auto& mc = in->constData();
 	if (mc.size() < 22 || mc.size() > 29 || ((mc[12] != 1 && mc[12] != 5) || mc[mc.size() - 1] != 0))
 	{
-		global::error = "Invalid SFX";
+		error() = "Invalid SFX";
 		return false;
 	}
 	string name;
@@ -744,7 +681,7 @@ bool conversion::bloodToWav(ArchiveEntry* in, MemChunk& out)
 		if ((mc[i] < '0' || (mc[i] > '9' && mc[i] < 'A') || (mc[i] > 'Z' && mc[i] < 'a') || mc[i] > 'z')
 			&& mc[i] != '_')
 		{
-			global::error = "Invalid SFX";
+			error() = "Invalid SFX";
 			return false;
 		}
 		else
@@ -756,7 +693,7 @@ bool conversion::bloodToWav(ArchiveEntry* in, MemChunk& out)
 	auto raw = in->parent()->entry(name);
 	if (!raw || raw->size() == 0)
 	{
-		global::error = "No RAW data for SFX";
+		error() = "No RAW data for SFX";
 		return false;
 	}
 
@@ -868,7 +805,7 @@ bool conversion::jagSndToWav(MemChunk& in, MemChunk& out)
 	// Format checks
 	if (header.samples > (in.size() - 28) || header.samples <= 4) // Check for sane values
 	{
-		global::error = "Invalid Jaguar Doom Sound";
+		error() = "Invalid Jaguar Doom Sound";
 		return false;
 	}
 
@@ -1075,7 +1012,7 @@ bool conversion::spkSndToWav(MemChunk& in, MemChunk& out, bool audioT)
 	size_t minsize = 4 + (audioT ? 3 : 0);
 	if (in.size() < minsize)
 	{
-		global::error = "Invalid PC Speaker Sound";
+		error() = "Invalid PC Speaker Sound";
 		return false;
 	}
 
@@ -1093,7 +1030,7 @@ bool conversion::spkSndToWav(MemChunk& in, MemChunk& out, bool audioT)
 		in.read(&priority, 2);
 		if (in.size() < 6 + numsamples)
 		{
-			global::error = "Invalid AudioT PC Speaker Sound";
+			error() = "Invalid AudioT PC Speaker Sound";
 			return false;
 		}
 	}
@@ -1101,12 +1038,12 @@ bool conversion::spkSndToWav(MemChunk& in, MemChunk& out, bool audioT)
 	{
 		if (header.zero != 0) // Check for magic number
 		{
-			global::error = "Invalid Doom PC Speaker Sound";
+			error() = "Invalid Doom PC Speaker Sound";
 			return false;
 		}
 		if (header.samples > (in.size() - 4) || header.samples < 4) // Check for sane values
 		{
-			global::error = "Invalid Doom PC Speaker Sound";
+			error() = "Invalid Doom PC Speaker Sound";
 			return false;
 		}
 		numsamples = header.samples;
@@ -1125,7 +1062,7 @@ bool conversion::spkSndToWav(MemChunk& in, MemChunk& out, bool audioT)
 	{
 		if (osamples[s] > 127 && !audioT)
 		{
-			global::error = fmt::format("Invalid PC Speaker counter value: {} > 127", osamples[s]);
+			error() = fmt::format("Invalid PC Speaker counter value: {} > 127", osamples[s]);
 			return false;
 		}
 		if (osamples[s] > 0)
@@ -1217,13 +1154,13 @@ bool conversion::auSndToWav(MemChunk& in, MemChunk& out)
 	// Format checks
 	if (header.magic != 0x2E736E64) // ASCII code for ".snd"
 	{
-		global::error = "Invalid Sun Sound";
+		error() = "Invalid Sun Sound";
 		return false;
 	}
 	// Only cover integer linear PCM for now
 	if (header.format < 2 || header.format > 5)
 	{
-		global::error = fmt::format("Unsupported Sun Sound format ({})", header.format);
+		error() = fmt::format("Unsupported Sun Sound format ({})", header.format);
 		return false;
 	}
 	uint8_t samplesize = header.format - 1;
@@ -1238,33 +1175,7 @@ bool conversion::auSndToWav(MemChunk& in, MemChunk& out)
 
 	// Swap endianness around if needed
 	if (samplesize > 1)
-	{
-		uint8_t swapval = 0;
-		for (size_t i = 0; i < header.size / samplesize; ++i)
-		{
-			switch (samplesize)
-			{
-			case 2:
-				swapval            = samples[i * 2];
-				samples[i * 2]     = samples[i * 2 + 1];
-				samples[i * 2 + 1] = swapval;
-				break;
-			case 3:
-				swapval            = samples[i * 3];
-				samples[i * 3]     = samples[i * 3 + 2];
-				samples[i * 3 + 2] = swapval;
-				break;
-			case 4:
-				swapval            = samples[i * 4];
-				samples[i * 4]     = samples[i * 4 + 3];
-				samples[i * 4 + 3] = swapval;
-				swapval            = samples[i * 4 + 2];
-				samples[i * 4 + 2] = samples[i * 4 + 1];
-				samples[i * 4 + 1] = swapval;
-				break;
-			}
-		}
-	}
+		samplekernels::swapBytes(samples.data(), samplesize, header.size / samplesize);
 
 	// --- Write WAV ---
 
@@ -1468,3 +1379,18 @@ bool conversion::voxToKvx(MemChunk& in, MemChunk& out)
 
 #undef AT
 }
+
+// -----------------------------------------------------------------------------
+// Runs [convert], with any error from the conversion functions written to
+// [error] instead of global::error. Conversions can be run on multiple
+// threads at once this way (as long as they don't need to ask the user
+// anything, see wavToDoomSnd)
+// -----------------------------------------------------------------------------
+bool conversion::convertWithError(const std::function<bool()>& convert, string& error)
+{
+	thread_error = &error;
+	auto ok      = convert();
+	thread_error = nullptr;
+
+	return ok;
+}
@@ -6,7 +6,8 @@ class ArchiveEntry;
 
 namespace conversion
 {
-	bool wavToDoomSnd(MemChunk& in, MemChunk& out);
+	bool wavToDoomSnd(MemChunk& in, MemChunk& out, bool confirm_lossy = true);
+	bool wavToDoomSndIsLossy(MemChunk& in);
 	bool spkSndToWav(MemChunk& in, MemChunk& out, bool audioT = false);
 	bool doomSndToWav(MemChunk& in, MemChunk& out);
 	bool wolfSndToWav(MemChunk& in, MemChunk& out);
@@ -20,5 +21,7 @@ namespace conversion
 	bool rmidToMidi(MemChunk& in, MemChunk& out);
 	bool voxToKvx(MemChunk& in, MemChunk& out);
 	bool addImfHeader(MemChunk& in, MemChunk& out);
+
+	bool convertWithError(const std::function<bool()>& convert, string& error);
 } // namespace conversion
 } // namespace slade
@@ -33,12 +33,15 @@
 #include "EntryOperations.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
+#include "Archive/EntryExport.h"
 #include "Archive/EntryType/EntryDataFormat.h"
 #include "Archive/Formats/WadArchive.h"
 #include "BinaryControlLump.h"
 #include "General/Console.h"
 #include "General/Misc.h"
 #include "Graphics/Graphics.h"
+#include "Graphics/Palette/Palette.h"
+#include "Graphics/PNGOptimizer.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "MainEditor/MainEditor.h"
 #include "SLADEWxApp.h"
@@ -48,7 +51,11 @@
 #include "Utility/FileMonitor.h"
 #include "Utility/Memory.h"
 #include "Utility/SFileDialog.h"
+#include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
+#include <filesystem>
+#include <thread>
+#include <wx/progdlg.h>
 
 using namespace slade;
 
@@ -63,8 +70,310 @@ CVAR(String, path_acc_libs, "", CVar::Flag::Save);
 CVAR(String, path_pngout, "", CVar::Flag::Save);
 CVAR(String, path_pngcrush, "", CVar::Flag::Save);
 CVAR(String, path_deflopt, "", CVar::Flag::Save);
+CVAR(Bool, png_opt_external, false, CVar::Flag::Save);
 CVAR(String, path_db2, "", CVar::Flag::Save)
 CVAR(Bool, acc_always_show_output, false, CVar::Flag::Save);
+CVAR(Int, acc_max_jobs, 0, CVar::Flag::Save);
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// An ACS source entry in an archive, with its #include/#import dependencies
+struct ACSSource
+{
+	ArchiveEntry*  entry = nullptr;
+	vector<string> includes;         // Lower-case names (no extension) of #included/#imported sources
+	vector<int>    dependents;       // Sources that directly #include/#import this one
+	bool           library  = false; // Has a #library directive
+	bool           selected = false; // Selected for compiling
+	uint64_t       key      = 0;     // Hash of this and all included sources (see dependencyKey)
+};
+
+class ACCProcess;
+
+// A single ACS compile job (one ACC process) in a compile queue
+struct ACSCompileJob
+{
+	ACSSource*  source = nullptr;
+	string      dir;                // Temp directory the job compiles in
+	ACCProcess* process  = nullptr; // Running ACC process
+	bool        finished = false;   // ACC has exited (or couldn't be run)
+	bool        done     = false;   // Finished and the result has been imported
+	bool        success  = false;
+	string      output;             // ACC output, or the contents of acs.err if it was written
+};
+
+// Dependency keys of successfully compiled ACS sources, so unchanged sources
+// aren't compiled again
+std::map<ArchiveEntry*, std::pair<weak_ptr<ArchiveEntry>, uint64_t>> acs_compiled;
+
+// An ACC process for an ACS compile job. Its output is logged as it runs
+class ACCProcess : public wxProcess
+{
+public:
+	explicit ACCProcess(ACSCompileJob& job) : wxProcess{ wxPROCESS_REDIRECT }, job_{ &job } {}
+
+	// Logs any new output from the process
+	void poll()
+	{
+		readOutput(GetInputStream());
+		readOutput(GetErrorStream());
+		logOutput(false);
+	}
+
+	void OnTerminate(int pid, int status) override
+	{
+		poll();
+		logOutput(true);
+		job_->process  = nullptr;
+		job_->finished = true;
+		delete this;
+	}
+
+private:
+	ACSCompileJob* job_;
+	string         buffer_;
+
+	void readOutput(wxInputStream* stream)
+	{
+		if (!stream)
+			return;
+
+		while (stream->CanRead())
+		{
+			auto c = stream->GetC();
+			if (stream->LastRead() == 0)
+				break;
+			buffer_ += static_cast<char>(c);
+		}
+	}
+
+	void logOutput(bool flush)
+	{
+		size_t start = 0;
+		for (auto end = buffer_.find('\n'); end != string::npos; end = buffer_.find('\n', start))
+		{
+			auto line = string_view{ buffer_ }.substr(start, end - start);
+			if (!line.empty() && line.back() == '\r')
+				line.remove_suffix(1);
+			log::info("{}: {}", job_->source->entry->name(), line);
+			job_->output.append(line).append("\n");
+			start = end + 1;
+		}
+		buffer_.erase(0, start);
+
+		if (flush && !buffer_.empty())
+		{
+			log::info("{}: {}", job_->source->entry->name(), buffer_);
+			job_->output += buffer_;
+			buffer_.clear();
+		}
+	}
+};
+
+// -----------------------------------------------------------------------------
+// Returns the ACC command line options for the current ACS settings
+// -----------------------------------------------------------------------------
+wxString accOptions(bool hexen)
+{
+	wxString opt;
+	if (hexen)
+		opt += " -h";
+	for (const auto& include_path : wxSplit(path_acc_libs, ';'))
+		opt += wxString::Format(" -i \"%s\"", include_path);
+
+	return opt;
+}
+
+// -----------------------------------------------------------------------------
+// Checks the ACC path is set up, opening the ACS preferences if it isn't
+// -----------------------------------------------------------------------------
+bool checkACCPath(wxFrame* parent)
+{
+	wxString accpath = path_acc;
+	if (accpath.IsEmpty() || !wxFileExists(accpath))
+	{
+		wxMessageBox(
+			"Error: ACC path not defined, please configure in SLADE preferences",
+			"Error",
+			wxOK | wxCENTRE | wxICON_ERROR);
+		PreferencesDialog::openPreferences(parent, "ACS");
+		return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Imports the compiled ACS [ofile] for [entry] in [archive].
+// If the entry is named SCRIPTS, it is imported to the BEHAVIOR entry previous
+// to it, otherwise to a same-name compiled library entry in the acs namespace
+// -----------------------------------------------------------------------------
+void importCompiledACS(Archive* archive, ArchiveEntry* entry, const string& ofile)
+{
+	// Check if the script is a map script (BEHAVIOR)
+	if (entry->upperName() == "SCRIPTS")
+	{
+		// Get entry before SCRIPTS
+		auto prev = archive->entryAt(archive->entryIndex(entry) - 1);
+
+		// Create a new entry there if it isn't BEHAVIOR
+		if (!prev || prev->upperName() != "BEHAVIOR")
+			prev = archive->addNewEntry("BEHAVIOR", archive->entryIndex(entry)).get();
+
+		// Import compiled script
+		prev->importFile(ofile);
+	}
+	else
+	{
+		// Otherwise, treat it as a library
+
+		// See if the compiled library already exists as an entry
+		Archive::SearchOptions opt;
+		opt.match_namespace = "acs";
+		opt.match_name      = entry->nameNoExt();
+		if (archive->formatDesc().names_extensions)
+		{
+			opt.match_name += ".o";
+			opt.ignore_ext = false;
+		}
+		auto lib = archive->findLast(opt);
+
+		// If it doesn't exist, create it
+		if (!lib)
+		{
+			auto new_lib = std::make_shared<ArchiveEntry>(fmt::format("{}.o", entry->nameNoExt()));
+			lib          = archive->addEntry(new_lib, "acs").get();
+		}
+
+		// Import compiled script
+		lib->importFile(ofile);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads the #include, #import and #library directives in [source]'s entry
+// -----------------------------------------------------------------------------
+void parseACSDirectives(ACSSource& source)
+{
+	Tokenizer tz;
+	tz.openMem(source.entry->data(), source.entry->name());
+	for (auto* token = &tz.current(); token->valid; token = &tz.next())
+	{
+		if (tz.checkNC("#include") || tz.checkNC("#import"))
+		{
+			token = &tz.next();
+			source.includes.push_back(strutil::lower(strutil::Path::fileNameOf(token->view(), false)));
+		}
+		else if (tz.checkNC("#library"))
+			source.library = true;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns a hash of the ACC [command] and the content of the source at [index] in
+// [sources] and every source it (recursively) includes
+// -----------------------------------------------------------------------------
+uint64_t dependencyKey(
+	const vector<ACSSource>&     sources,
+	const std::map<string, int>& names,
+	int                          index,
+	const wxString&              command)
+{
+	std::set<int> visited{ index };
+	vector<int>   pending{ index };
+	while (!pending.empty())
+	{
+		auto source = pending.back();
+		pending.pop_back();
+		for (const auto& include : sources[source].includes)
+		{
+			auto i = names.find(include);
+			if (i != names.end() && visited.insert(i->second).second)
+				pending.push_back(i->second);
+		}
+	}
+
+	uint64_t key = std::hash<string>{}(command.ToStdString());
+	for (auto source : visited)
+		key = (key ^ sources[source].entry->contentHash()) * 1099511628211ull;
+
+	return key;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a function that converts [entry]'s image data to PNG when it is
+// exported (see entryexport::File), or an empty function if [entry] isn't a
+// valid image. [palettes] holds the copies of palettes used by the functions,
+// which can be shared between them
+// -----------------------------------------------------------------------------
+std::function<bool(MemChunk&)> pngConverter(ArchiveEntry* entry, std::map<Palette*, shared_ptr<Palette>>& palettes)
+{
+	// Detect entry type if it isn't already
+	if (entry->type() == EntryType::unknownType())
+		EntryType::detectEntryType(*entry);
+
+	// Get a copy of the palette to convert with
+	shared_ptr<Palette> palette;
+	if (auto pal = maineditor::currentPalette(entry))
+	{
+		auto& copy = palettes[pal];
+		if (!copy)
+			copy = std::make_shared<Palette>(*pal);
+		palette = copy;
+	}
+
+	// Jaguar formats (and anything that isn't an image) need to be loaded
+	// here since they need other entries
+	auto               format_id = entry->type()->formatId();
+	shared_ptr<SImage> image;
+	string             format_hint;
+	if (!entry->type()->extraProps().contains("image") || strutil::startsWith(format_id, "img_jaguar"))
+	{
+		image = std::make_shared<SImage>();
+		if (!misc::loadImageFromEntry(image.get(), entry))
+		{
+			log::error(wxString::Format("Error converting %s: %s", entry->name(), global::error));
+			return {};
+		}
+	}
+	else
+		format_hint = entry->type()->extraProps().getOr<string>("image_format", {});
+
+	return [name = entry->name(), format_id, format_hint, format = entry->imageFormat(), image, palette](
+			   MemChunk& data)
+	{
+		// Load image from data if it wasn't already
+		SImage  decoded;
+		SImage* source = image.get();
+		if (!source)
+		{
+			if (!misc::loadImageFromData(&decoded, data, format_id, format_hint, 0, format))
+			{
+				log::error("Error converting {}: not a valid image", name);
+				return false;
+			}
+			source = &decoded;
+		}
+
+		// Write png data
+		MemChunk png;
+		if (!SIFormat::getFormat("png")->saveImage(*source, png, palette.get()))
+		{
+			log::error("Error converting {}", name);
+			return false;
+		}
+
+		data.share(png);
+		return true;
+	};
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -233,6 +542,8 @@ bool entryoperations::exportEntries(const vector<ArchiveEntry*>& entries, const
 	if (filedialog::saveFiles(
 			info, "Export Multiple Entries (Filename is ignored)", "Any File (*.*)|*.*", maineditor::windowWx()))
 	{
+		vector<entryexport::File> files;
+
 		// Go through the selected entries
 		for (auto& entry : entries)
 		{
@@ -250,13 +561,15 @@ bool entryoperations::exportEntries(const vector<ArchiveEntry*>& entries, const
 					fn.SetEmptyExt();
 			}
 
-			// Do export
-			entry->exportFile(fn.GetFullPath().ToStdString());
+			files.push_back({ entry, fn.GetFullPath().ToStdString() });
 		}
 
 		// Go through selected dirs
 		for (auto& dir : dirs)
-			dir->exportTo(string{ info.path + "/" + dir->name() });
+			dir->addExportFiles(string{ info.path + "/" + dir->name() }, files);
+
+		// Do export
+		entryexport::exportFiles(files);
 	}
 
 	return true;
@@ -971,31 +1284,13 @@ bool entryoperations::compileACS(ArchiveEntry* entry, bool hexen, ArchiveEntry*
 	}
 
 	// Check if the ACC path is set up
-	wxString accpath = path_acc;
-	if (accpath.IsEmpty() || !wxFileExists(accpath))
-	{
-		wxMessageBox(
-			"Error: ACC path not defined, please configure in SLADE preferences",
-			"Error",
-			wxOK | wxCENTRE | wxICON_ERROR);
-		PreferencesDialog::openPreferences(parent, "ACS");
+	if (!checkACCPath(parent))
 		return false;
-	}
 
 	// Setup some path strings
-	auto srcfile       = app::path(fmt::format("{}.acs", entry->nameNoExt()), app::Dir::Temp);
-	auto ofile         = app::path(fmt::format("{}.o", entry->nameNoExt()), app::Dir::Temp);
-	auto include_paths = wxSplit(path_acc_libs, ';');
-
-	// Setup command options
-	wxString opt;
-	if (hexen)
-		opt += " -h";
-	if (!include_paths.IsEmpty())
-	{
-		for (const auto& include_path : include_paths)
-			opt += wxString::Format(" -i \"%s\"", include_path);
-	}
+	auto srcfile = app::path(fmt::format("{}.acs", entry->nameNoExt()), app::Dir::Temp);
+	auto ofile   = app::path(fmt::format("{}.o", entry->nameNoExt()), app::Dir::Temp);
+	auto opt     = accOptions(hexen);
 
 	// Find/export any resource libraries
 	Archive::SearchOptions sopt;
@@ -1070,46 +1365,7 @@ bool entryoperations::compileACS(ArchiveEntry* entry, bool hexen, ArchiveEntry*
 	{
 		// If no target entry was given, find one
 		if (!target)
-		{
-			// Check if the script is a map script (BEHAVIOR)
-			if (entry->upperName() == "SCRIPTS")
-			{
-				// Get entry before SCRIPTS
-				auto prev = archive->entryAt(archive->entryIndex(entry) - 1);
-
-				// Create a new entry there if it isn't BEHAVIOR
-				if (!prev || prev->upperName() != "BEHAVIOR")
-					prev = archive->addNewEntry("BEHAVIOR", archive->entryIndex(entry)).get();
-
-				// Import compiled script
-				prev->importFile(ofile);
-			}
-			else
-			{
-				// Otherwise, treat it as a library
-
-				// See if the compiled library already exists as an entry
-				Archive::SearchOptions opt;
-				opt.match_namespace = "acs";
-				opt.match_name      = entry->nameNoExt();
-				if (archive->formatDesc().names_extensions)
-				{
-					opt.match_name += ".o";
-					opt.ignore_ext = false;
-				}
-				auto lib = archive->findLast(opt);
-
-				// If it doesn't exist, create it
-				if (!lib)
-				{
-					auto new_lib = std::make_shared<ArchiveEntry>(fmt::format("{}.o", entry->nameNoExt()));
-					lib          = archive->addEntry(new_lib, "acs").get();
-				}
-
-				// Import compiled script
-				lib->importFile(ofile);
-			}
-		}
+			importCompiledACS(archive, entry, ofile);
 		else
 			target->importFile(ofile);
 
@@ -1147,6 +1403,262 @@ bool entryoperations::compileACS(ArchiveEntry* entry, bool hexen, ArchiveEntry*
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Compiles multiple ACS [entries] (all in the same archive), running up to
+// acc_max_jobs ACC processes at once (one per hardware thread if 0).
+//
+// #include/#import dependencies between the archive's ACS sources are
+// tracked, so any scripts and libraries that include one of the [entries] are
+// compiled along with it, and any that are unchanged (along with everything
+// they include) since they were last compiled are skipped. Compiled data is
+// imported as each compile finishes (see compileACS above)
+// -----------------------------------------------------------------------------
+bool entryoperations::compileACS(const vector<ArchiveEntry*>& entries, bool hexen, wxFrame* parent)
+{
+	if (entries.empty() || !entries[0]->parent())
+		return false;
+
+	// Check if the ACC path is set up
+	if (!checkACCPath(parent))
+		return false;
+
+	// Get all ACS sources in the archive, and the selected entries
+	auto*                  archive = entries[0]->parent();
+	Archive::SearchOptions sopt;
+	sopt.match_type     = EntryType::fromId("acs");
+	sopt.search_subdirs = true;
+	auto                  acs_entries = archive->findAll(sopt);
+	vector<ACSSource>     sources;
+	std::map<string, int> names;
+	auto                  add_source = [&](ArchiveEntry* entry)
+	{
+		for (auto& source : sources)
+			if (source.entry == entry)
+				return &source;
+
+		auto& source = sources.emplace_back();
+		source.entry = entry;
+		parseACSDirectives(source);
+		if (entry->upperNameNoExt() != "SCRIPTS")
+			names.emplace(strutil::lower(entry->nameNoExt()), sources.size() - 1);
+		return &source;
+	};
+	for (auto* entry : acs_entries)
+		add_source(entry);
+	for (auto* entry : entries)
+	{
+		if (entry->parent() != archive)
+			continue;
+
+		if (!EntryDataFormat::format("text")->isThisFormat(entry->data()))
+		{
+			log::warning("Not compiling {}: Entry does not appear to be text", entry->name());
+			continue;
+		}
+
+		add_source(entry)->selected = true;
+	}
+
+	// Link dependencies
+	for (unsigned a = 0; a < sources.size(); ++a)
+		for (const auto& include : sources[a].includes)
+			if (auto i = names.find(include); i != names.end() && i->second != static_cast<int>(a))
+				sources[i->second].dependents.push_back(a);
+
+	// Get selected sources and (recursively) their dependents
+	vector<bool> affected(sources.size());
+	vector<int>  pending;
+	for (unsigned a = 0; a < sources.size(); ++a)
+		if (sources[a].selected)
+		{
+			affected[a] = true;
+			pending.push_back(a);
+		}
+	while (!pending.empty())
+	{
+		auto source = pending.back();
+		pending.pop_back();
+		for (auto dependent : sources[source].dependents)
+			if (!affected[dependent])
+			{
+				affected[dependent] = true;
+				pending.push_back(dependent);
+			}
+	}
+
+	// Determine what to compile - selected sources (unless they are only
+	// included by others) and affected map scripts and libraries
+	wxString           acc = "\"" + path_acc + "\"" + accOptions(hexen);
+	vector<ACSSource*> to_compile;
+	for (unsigned a = 0; a < sources.size(); ++a)
+	{
+		auto& source   = sources[a];
+		auto  compiles = source.library || source.entry->upperNameNoExt() == "SCRIPTS";
+		if (affected[a] && (compiles || (source.selected && source.dependents.empty())))
+		{
+			source.key = dependencyKey(sources, names, a, acc);
+			to_compile.push_back(&source);
+		}
+	}
+
+	// Skip sources that haven't changed since they were last compiled,
+	// unless everything is up to date
+	for (auto i = acs_compiled.begin(); i != acs_compiled.end();)
+		i = i->second.first.expired() ? acs_compiled.erase(i) : std::next(i);
+	auto up_to_date = [](const ACSSource* source)
+	{
+		auto i = acs_compiled.find(source->entry);
+		return i != acs_compiled.end() && i->second.second == source->key;
+	};
+	if (!std::all_of(to_compile.begin(), to_compile.end(), up_to_date))
+	{
+		for (auto* source : to_compile)
+			if (up_to_date(source))
+				log::info(2, "ACS source {} is up to date", source->entry->name());
+		to_compile.erase(std::remove_if(to_compile.begin(), to_compile.end(), up_to_date), to_compile.end());
+	}
+	if (to_compile.empty())
+		return false;
+
+	// Export all sources (except SCRIPTS) to a shared include directory
+	std::error_code ec;
+	auto            temp_dir    = app::path("acs_compile", app::Dir::Temp);
+	auto            include_dir = temp_dir + "/include";
+	std::filesystem::remove_all(temp_dir, ec);
+	std::filesystem::create_directories(include_dir, ec);
+	for (const auto& [name, index] : names)
+		sources[index].entry->exportFile(fmt::format("{}/{}.acs", include_dir, sources[index].entry->nameNoExt()));
+	acc += wxString::Format(" -i \"%s\"", include_dir);
+
+	// Setup jobs, each compiling in its own directory (ACC writes acs.err
+	// next to the source file)
+	vector<ACSCompileJob> jobs(to_compile.size());
+	for (unsigned a = 0; a < jobs.size(); ++a)
+	{
+		jobs[a].source = to_compile[a];
+		jobs[a].dir    = fmt::format("{}/{}", temp_dir, a);
+		std::filesystem::create_directories(jobs[a].dir, ec);
+	}
+
+	// Run jobs
+	unsigned n_jobs   = jobs.size();
+	unsigned max_jobs = acc_max_jobs > 0 ? acc_max_jobs : std::max(std::thread::hardware_concurrency(), 1u);
+	unsigned next_job = 0;
+	unsigned n_done   = 0;
+	bool     cancel   = false;
+	log::console(fmt::format("Compiling {} ACS script(s)...", n_jobs));
+	{
+		wxProgressDialog progress(
+			"Compile ACS",
+			"Compiling ACS scripts...",
+			n_jobs,
+			parent,
+			wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME | wxPD_SMOOTH);
+
+		while (true)
+		{
+			// Start jobs while there are free slots
+			unsigned n_running = std::count_if(
+				jobs.begin(), jobs.end(), [](const ACSCompileJob& job) { return job.process != nullptr; });
+			for (; !cancel && next_job < n_jobs && n_running < max_jobs; ++next_job)
+			{
+				auto& job     = jobs[next_job];
+				auto  name    = job.source->entry->nameNoExt();
+				auto  srcfile = fmt::format("{}/{}.acs", job.dir, name);
+				auto  ofile   = fmt::format("{}/{}.o", job.dir, name);
+				job.source->entry->exportFile(srcfile);
+
+				auto command = acc + " \"" + srcfile + "\" \"" + ofile + "\"";
+				auto process = new ACCProcess(job);
+				if (wxExecute(command, wxEXEC_ASYNC | wxEXEC_HIDE_CONSOLE, process) == 0)
+				{
+					log::error(wxString::Format("Unable to run ACC: %s", command));
+					delete process;
+					job.finished = true;
+					continue;
+				}
+				job.process = process;
+				++n_running;
+			}
+
+			// Import compiled data from finished jobs
+			for (auto& job : jobs)
+			{
+				if (!job.finished || job.done)
+					continue;
+
+				auto* entry = job.source->entry;
+				auto  ofile = fmt::format("{}/{}.o", job.dir, entry->nameNoExt());
+				job.success = !cancel && wxFileExists(ofile);
+				if (job.success)
+				{
+					importCompiledACS(archive, entry, ofile);
+					acs_compiled[entry] = { entry->getShared(), job.source->key };
+				}
+				else
+					acs_compiled.erase(entry);
+
+				// Prefer acs.err (if written) over the raw output for results
+				auto errfile = job.dir + "/acs.err";
+				if (wxFileExists(errfile))
+				{
+					wxFile       file(errfile);
+					vector<char> buf(file.Length());
+					file.Read(buf.data(), file.Length());
+					job.output.assign(buf.data(), buf.size());
+				}
+
+				job.done = true;
+				++n_done;
+			}
+
+			if (n_running == 0 && (cancel || next_job == n_jobs))
+				break;
+
+			// Update progress, killing running processes if cancelled
+			if (!cancel && !progress.Update(n_done, wxString::Format("Compiled %u of %u scripts", n_done, n_jobs)))
+			{
+				cancel = true;
+				for (auto& job : jobs)
+					if (job.process)
+						wxProcess::Kill(job.process->GetPid(), wxSIGKILL, wxKILL_CHILDREN);
+			}
+
+			// Log output from running processes. Yielding is needed for the
+			// processes' termination to be handled
+			for (auto& job : jobs)
+				if (job.process)
+					job.process->poll();
+			wxYield();
+			wxMilliSleep(20);
+		}
+	}
+	std::filesystem::remove_all(temp_dir, ec);
+
+	// Show results
+	auto n_success = std::count_if(jobs.begin(), jobs.end(), [](const ACSCompileJob& job) { return job.success; });
+	log::console(fmt::format("Compiled {} of {} ACS script(s)", n_success, n_jobs));
+	if (cancel)
+		return false;
+
+	bool     success = n_success == n_jobs;
+	wxString errors;
+	for (const auto& job : jobs)
+		if ((!job.success || acc_always_show_output) && !job.output.empty())
+			errors += wxString::FromUTF8(fmt::format("=== {} ===\n{}\n", job.source->entry->name(), job.output));
+	if (!success || (acc_always_show_output && !errors.empty()))
+	{
+		ExtMessageDialog dlg(nullptr, success ? "ACC Output" : "Error Compiling");
+		dlg.setMessage(
+			success ? "Compiler output shown below: " :
+					  "The following errors were encountered while compiling, please fix them and recompile:");
+		dlg.setExt(errors);
+		dlg.ShowModal();
+	}
+
+	return success;
+}
+
 // -----------------------------------------------------------------------------
 // Converts [entry] to a PNG image (if possible) and saves the PNG data to a
 // file [filename]. Does not alter the entry data itself
@@ -1179,7 +1691,38 @@ bool entryoperations::exportAsPNG(ArchiveEntry* entry, const wxString& filename)
 }
 
 // -----------------------------------------------------------------------------
-// Attempts to optimize [entry] using external PNG optimizers.
+// Converts [entries] to PNG images (where possible) and saves them to files in
+// directory [path], named after each entry with a .png extension. Returns
+// false if any entry couldn't be converted or written
+// -----------------------------------------------------------------------------
+bool entryoperations::exportAsPNG(const vector<ArchiveEntry*>& entries, const wxString& path)
+{
+	std::map<Palette*, shared_ptr<Palette>> palettes;
+	vector<entryexport::File>               files;
+	bool                                    ok = true;
+	for (auto* entry : entries)
+	{
+		// Setup entry filename
+		wxFileName fn(entry->name());
+		fn.SetPath(path);
+		fn.SetExt("png");
+
+		auto convert = pngConverter(entry, palettes);
+		if (!convert)
+		{
+			ok = false;
+			continue;
+		}
+
+		files.push_back({ entry, fn.GetFullPath().ToStdString(), std::move(convert) });
+	}
+
+	return entryexport::exportFiles(files, "Exporting Entries as PNG...") && ok;
+}
+
+// -----------------------------------------------------------------------------
+// Attempts to optimize [entry], first with the built-in PNG optimizer and then
+// with any external PNG optimizers if it failed (or png_opt_external is set)
 // -----------------------------------------------------------------------------
 bool entryoperations::optimizePNG(ArchiveEntry* entry)
 {
@@ -1198,12 +1741,46 @@ bool entryoperations::optimizePNG(ArchiveEntry* entry)
 		return false;
 	}
 
+	// Built-in optimizer
+	MemChunk   optimized;
+	const auto oldsize  = entry->size();
+	const bool internal = gfx::pngOptimize(entry->data(), optimized);
+	if (internal)
+	{
+		if (optimized.size() < oldsize)
+			entry->importMemChunk(optimized);
+		log::info("PNG {} size {} =Built-in=> {}", entry->name(), oldsize, entry->size());
+	}
+
+	// External optimizers
+	if ((!internal || png_opt_external) && pngToolsAvailable())
+		return optimizePNGExternal(entry) || internal;
+
+	if (!internal)
+		log::error(1, "Unable to optimize PNG {}, no optimization done.", entry->name());
+
+	return internal;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if any of the external PNG optimizer paths are set up
+// -----------------------------------------------------------------------------
+bool entryoperations::pngToolsAvailable()
+{
+	auto valid_path = [](const string& path) { return !path.empty() && wxFileExists(path); };
+	return valid_path(*path_pngcrush) || valid_path(*path_pngout) || valid_path(*path_deflopt);
+}
+
+// -----------------------------------------------------------------------------
+// Attempts to optimize PNG [entry] using external PNG optimizers.
+// -----------------------------------------------------------------------------
+bool entryoperations::optimizePNGExternal(ArchiveEntry* entry)
+{
 	// Check if the PNG tools path are set up, at least one of them should be
 	wxString pngpathc = path_pngcrush;
 	wxString pngpatho = path_pngout;
 	wxString pngpathd = path_deflopt;
-	if ((pngpathc.IsEmpty() || !wxFileExists(pngpathc)) && (pngpatho.IsEmpty() || !wxFileExists(pngpatho))
-		&& (pngpathd.IsEmpty() || !wxFileExists(pngpathd)))
+	if (!pngToolsAvailable())
 	{
 		log::error(1, "PNG tool paths not defined or invalid, no optimization done.");
 		return false;
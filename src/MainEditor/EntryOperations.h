@@ -23,8 +23,12 @@ namespace entryoperations
 	bool cleanTextureIwadDupes(const vector<ArchiveEntry*>& entries);
 	bool cleanZdTextureSinglePatch(const vector<ArchiveEntry*>& entries);
 	bool compileACS(ArchiveEntry* entry, bool hexen = false, ArchiveEntry* target = nullptr, wxFrame* parent = nullptr);
+	bool compileACS(const vector<ArchiveEntry*>& entries, bool hexen = false, wxFrame* parent = nullptr);
 	bool exportAsPNG(ArchiveEntry* entry, const wxString& filename);
+	bool exportAsPNG(const vector<ArchiveEntry*>& entries, const wxString& path);
 	bool optimizePNG(ArchiveEntry* entry);
+	bool optimizePNGExternal(ArchiveEntry* entry);
+	bool pngToolsAvailable();
 
 	// ANIMATED/SWITCHES
 	bool convertAnimated(ArchiveEntry* entry, MemChunk* animdata, bool animdefs);
@@ -68,6 +68,16 @@ public:
 				if (&entry == entry_)
 					delete this;
 			});
+		sc_entries_changed_ = archive_->signals().entries_changed.connect(
+			[this](Archive&, const Archive::EntryChanges& changes)
+			{
+				for (const auto& removed : changes.removed)
+					if (removed.entry.get() == entry_)
+					{
+						delete this;
+						return;
+					}
+			});
 	}
 
 	virtual ~ExternalEditFileMonitor() { manager_->monitorStopped(this); }
@@ -88,8 +98,7 @@ public:
 		if (ok)
 		{
 			filename_      = fn.fullPath();
-			file_modified_ = fileutil::fileModifiedTime(filename_);
-			Start(1000);
+			startMonitoring();
 		}
 		else
 			global::error = "Failed to export entry";
@@ -103,6 +112,7 @@ protected:
 	ExternalEditManager*       manager_ = nullptr;
 	string                     gfx_format_;
 	sigslot::scoped_connection sc_entry_removed_;
+	sigslot::scoped_connection sc_entries_changed_;
 };
 
 
@@ -180,8 +190,7 @@ public:
 		filename_ = fn.fullPath();
 		if (png.exportFile(filename_))
 		{
-			file_modified_ = fileutil::fileModifiedTime(filename_);
-			Start(1000);
+			startMonitoring();
 			return true;
 		}
 
@@ -246,8 +255,7 @@ public:
 		filename_ = fn.fullPath();
 		if (convdata.exportFile(filename_))
 		{
-			file_modified_ = fileutil::fileModifiedTime(filename_);
-			Start(1000);
+			startMonitoring();
 			return true;
 		}
 
@@ -343,8 +351,7 @@ public:
 		filename_ = fn.fullPath();
 		if (convdata.exportFile(filename_))
 		{
-			file_modified_ = fileutil::fileModifiedTime(filename_);
-			Start(1000);
+			startMonitoring();
 			return true;
 		}
 
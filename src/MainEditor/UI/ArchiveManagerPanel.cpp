@@ -52,6 +52,8 @@
 #include "UI/WxUtils.h"
 #include "Utility/FileUtils.h"
 #include "Utility/StringUtils.h"
+#include <unordered_set>
+#include <wx/progdlg.h>
 
 using namespace slade;
 
@@ -76,6 +78,80 @@ EXTERN_CVAR(String, dir_last)
 EXTERN_CVAR(Int, autosave_entry_changes)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Opens the archive at [path] in the background, showing a (non-modal)
+// progress dialog that allows opening to be cancelled. Shows an error message
+// beginning with [error_prefix] if the archive failed to open
+// -----------------------------------------------------------------------------
+void openArchiveInBackground(const string& path, const wxString& error_prefix)
+{
+	// Progress dialog (created once opening has started)
+	auto progress   = std::make_shared<wxProgressDialog*>(nullptr);
+	auto connection = std::make_shared<sigslot::scoped_connection>();
+	auto sw         = std::make_shared<wxStopWatch>();
+	auto finished   = std::make_shared<bool>(false);
+	auto cancelled  = std::make_shared<bool>(false);
+
+	auto on_opened = [=](shared_ptr<Archive> archive)
+	{
+		*finished = true;
+		connection->disconnect();
+		if (*progress)
+			(*progress)->Destroy();
+
+		log::info(wxString::Format("Opening took %d ms", (int)sw->Time()));
+
+		// If archive didn't open ok, show error message (unless it was cancelled)
+		if (!archive && !*cancelled)
+			wxMessageBox(wxString::Format("%s %s:\n%s", error_prefix, path, global::error), "Error", wxICON_ERROR);
+	};
+
+	auto archive = app::archiveManager().openArchiveAsync(path, on_opened);
+	if (!archive)
+	{
+		wxMessageBox(wxString::Format("%s %s:\n%s", error_prefix, path, global::error), "Error", wxICON_ERROR);
+		return;
+	}
+
+	// Nothing to show progress for if the archive was already open
+	if (*finished)
+		return;
+
+	*progress = new wxProgressDialog(
+		"Opening Archive",
+		wxString::Format("Opening %s...", strutil::Path::fileNameOf(path)),
+		100,
+		nullptr,
+		wxPD_CAN_ABORT | wxPD_ELAPSED_TIME | wxPD_SMOOTH);
+
+	// Update progress dialog as the archive opens, cancelling if aborted
+	*connection = archive->signals().open_progress.connect(
+		[progress, cancelled](Archive& archive, string_view message, float value)
+		{
+			bool keep_going;
+			if (value < 0.0f)
+				keep_going = (*progress)->Pulse(wxString{ message.data(), message.size() });
+			else
+				keep_going = (*progress)->Update(
+					std::min(static_cast<int>(value * 100), 99), wxString{ message.data(), message.size() });
+
+			if (!keep_going)
+			{
+				*cancelled = true;
+				archive.cancelOpen();
+			}
+		});
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // DirArchiveCheck Class Functions
@@ -102,7 +178,7 @@ DirArchiveCheck::DirArchiveCheck(wxEvtHandler* handler, DirArchive* archive) :
 	{
 		entry_info_.emplace_back(
 			entry->path(true),
-			entry->exProps().getOr<string>("filePath", ""),
+			entry->exProp<string>("filePath"),
 			entry->type() == EntryType::folderType(),
 			archive->fileModificationTime(entry));
 	}
@@ -128,6 +204,13 @@ wxThread::ExitCode DirArchiveCheck::Entry()
 	wxDir               dir(dir_path_);
 	dir.Traverse(traverser, "", wxDIR_FILES | wxDIR_DIRS);
 
+	// Build lookups for entries (by file path) and removed files
+	std::unordered_map<string, const EntryInfo*> entry_info_by_path;
+	for (const auto& info : entry_info_)
+		if (!info.file_path.empty())
+			entry_info_by_path[info.file_path.ToStdString()] = &info;
+	const std::unordered_set<string> removed_files(removed_files_.begin(), removed_files_.end());
+
 	// Check for deleted files
 	for (auto& info : entry_info_)
 	{
@@ -153,53 +236,34 @@ wxThread::ExitCode DirArchiveCheck::Entry()
 	for (const auto& file : files)
 	{
 		// Ignore files removed from archive since last save
-		if (VECTOR_EXISTS(removed_files_, file))
+		if (removed_files.count(file) > 0)
 			continue;
 
 		// Find file in archive
-		EntryInfo inf;
-		bool      found = false;
-		for (auto& info : entry_info_)
-		{
-			if (info.file_path == file)
-			{
-				inf   = info;
-				found = true;
-				break;
-			}
-		}
+		auto found = entry_info_by_path.find(file);
 
 		time_t mod = wxFileModificationTime(file);
 
 		// No match, added to archive
-		if (!found)
+		if (found == entry_info_by_path.end())
 			addChange(DirEntryChange(DirEntryChange::Action::AddedFile, file, "", mod));
 		// Matched, check modification time
-		else if (mod > inf.file_modified)
-			addChange(DirEntryChange(DirEntryChange::Action::Updated, file, inf.entry_path.ToStdString(), mod));
+		else if (mod > found->second->file_modified)
+			addChange(
+				DirEntryChange(DirEntryChange::Action::Updated, file, found->second->entry_path.ToStdString(), mod));
 	}
 
 	// Check for new dirs
 	for (const auto& subdir : dirs)
 	{
 		// Ignore dirs removed from archive since last save
-		if (VECTOR_EXISTS(removed_files_, subdir))
+		if (removed_files.count(subdir) > 0)
 			continue;
 
-		bool found = false;
-		for (auto& info : entry_info_)
-		{
-			if (info.file_path == subdir)
-			{
-				found = true;
-				break;
-			}
-		}
-
 		time_t mod = wxDateTime::Now().GetTicks();
 
 		// No match, added to archive
-		if (!found)
+		if (entry_info_by_path.count(subdir) == 0)
 			addChange(DirEntryChange(DirEntryChange::Action::AddedDir, subdir, "", mod));
 	}
 
@@ -1188,28 +1252,7 @@ void ArchiveManagerPanel::closeEntryTabs(Archive* parent) const
 // -----------------------------------------------------------------------------
 void ArchiveManagerPanel::openFile(const wxString& filename) const
 {
-	// Show splash screen
-	ui::showSplash("Opening Archive...", true);
-
-	// test
-	wxStopWatch sw;
-	sw.Start();
-
-	// Open the file in the archive manager
-	auto new_archive = app::archiveManager().openArchive(filename.ToStdString());
-
-	sw.Pause();
-	log::info(wxString::Format("Opening took %d ms", (int)sw.Time()));
-
-	// Hide splash screen
-	ui::hideSplash();
-
-	// Check that the archive opened ok
-	if (!new_archive)
-	{
-		// If archive didn't open ok, show error message
-		wxMessageBox(wxString::Format("Error opening %s:\n%s", filename, global::error), "Error", wxICON_ERROR);
-	}
+	openArchiveInBackground(filename.ToStdString(), "Error opening");
 }
 
 // -----------------------------------------------------------------------------
@@ -1230,28 +1273,7 @@ void ArchiveManagerPanel::openFiles(const wxArrayString& files) const
 // -----------------------------------------------------------------------------
 void ArchiveManagerPanel::openDirAsArchive(const wxString& dir) const
 {
-	// Show splash screen
-	ui::showSplash("Opening Directory...", true);
-
-	// test
-	wxStopWatch sw;
-	sw.Start();
-
-	// Open the file in the archive manager
-	auto new_archive = app::archiveManager().openDirArchive(dir.ToStdString());
-
-	sw.Pause();
-	log::info(wxString::Format("Opening took %d ms", (int)sw.Time()));
-
-	// Hide splash screen
-	ui::hideSplash();
-
-	// Check that the archive opened ok
-	if (!new_archive)
-	{
-		// If archive didn't open ok, show error message
-		wxMessageBox(wxString::Format("Error opening directory %s:\n%s", dir, global::error), "Error", wxICON_ERROR);
-	}
+	openArchiveInBackground(dir.ToStdString(), "Error opening directory");
 }
 
 // -----------------------------------------------------------------------------
@@ -1406,6 +1428,15 @@ void ArchiveManagerPanel::checkDirArchives()
 		if (VECTOR_EXISTS(checking_archives_, archive.get()))
 			continue;
 
+		// No need to check if the directory is being watched and no changes were reported
+		if (watched_dir_archives_.count(archive.get()) > 0)
+		{
+			if (changed_dir_archives_.erase(archive.get()) == 0)
+				continue;
+		}
+		else
+			watchDirArchive(archive.get());
+
 		log::info(2, "Checking {} for external changes...", archive->filename());
 		checking_archives_.push_back(archive.get());
 		auto check = new DirArchiveCheck(this, dynamic_cast<DirArchive*>(archive.get()));
@@ -1414,6 +1445,54 @@ void ArchiveManagerPanel::checkDirArchives()
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Starts watching the directory of [archive] (if it is a directory archive)
+// for changes on the file system, so that it only needs to be checked for
+// changes when something has actually changed
+// -----------------------------------------------------------------------------
+void ArchiveManagerPanel::watchDirArchive(Archive* archive)
+{
+	if (!archive || archive->formatId() != "folder" || watched_dir_archives_.count(archive) > 0)
+		return;
+
+	// The watcher needs a running event loop, if there isn't one yet the
+	// archive will just be fully checked (and then watched) when activated
+	if (!wxEventLoopBase::GetActive())
+		return;
+
+	if (!dir_watcher_)
+	{
+		dir_watcher_ = std::make_unique<wxFileSystemWatcher>();
+		dir_watcher_->SetOwner(this);
+		Bind(wxEVT_FSWATCHER, &ArchiveManagerPanel::onDirArchiveFileChanged, this);
+	}
+
+	const auto dir_path = wxFileName::DirName(archive->filename());
+	if (!dir_watcher_->AddTree(dir_path))
+	{
+		log::warning("Unable to watch directory {} for changes", archive->filename());
+		return;
+	}
+
+	watched_dir_archives_[archive] = dir_path.GetFullPath();
+}
+
+// -----------------------------------------------------------------------------
+// Stops watching the directory of [archive] for changes
+// -----------------------------------------------------------------------------
+void ArchiveManagerPanel::unwatchDirArchive(Archive* archive)
+{
+	auto watched = watched_dir_archives_.find(archive);
+	if (watched == watched_dir_archives_.end())
+		return;
+
+	if (dir_watcher_)
+		dir_watcher_->RemoveTree(wxFileName::DirName(watched->second));
+
+	watched_dir_archives_.erase(watched);
+	changed_dir_archives_.erase(archive);
+}
+
 // -----------------------------------------------------------------------------
 // Creates a new archive of the given type and opens it in a tab
 // -----------------------------------------------------------------------------
@@ -2274,6 +2353,27 @@ void ArchiveManagerPanel::onDirArchiveCheckCompleted(wxThreadEvent& e)
 	VECTOR_REMOVE(checking_archives_, change_list.archive);
 }
 
+// -----------------------------------------------------------------------------
+// Called when a file/directory changes within a watched directory archive.
+// Flags the archive as changed so it will be checked next time
+// checkDirArchives is called
+// -----------------------------------------------------------------------------
+void ArchiveManagerPanel::onDirArchiveFileChanged(wxFileSystemWatcherEvent& e)
+{
+	// Rescan everything if the watcher itself had problems (eg. overflowed)
+	if (e.GetChangeType() == wxFSW_EVENT_ERROR || e.GetChangeType() == wxFSW_EVENT_WARNING)
+	{
+		for (const auto& watched : watched_dir_archives_)
+			changed_dir_archives_.insert(watched.first);
+		return;
+	}
+
+	const auto path = e.GetPath().GetFullPath();
+	for (const auto& watched : watched_dir_archives_)
+		if (path.StartsWith(watched.second))
+			changed_dir_archives_.insert(watched.first);
+}
+
 void ArchiveManagerPanel::connectSignals()
 {
 	auto& signals = app::archiveManager().signals();
@@ -2284,6 +2384,7 @@ void ArchiveManagerPanel::connectSignals()
 		{
 			list_archives_->addItem(index, wxEmptyString);
 			updateOpenListItem(index);
+			watchDirArchive(app::archiveManager().getArchive(index).get());
 		});
 	signal_connections += signals.archive_closed.connect([this](unsigned index) { list_archives_->DeleteItem(index); });
 	signal_connections += signals.archive_saved.connect(
@@ -2306,6 +2407,7 @@ void ArchiveManagerPanel::connectSignals()
 			closeTextureTab(index);
 			closeEntryTabs(app::archiveManager().getArchive(index).get());
 			closeTab(index);
+			unwatchDirArchive(app::archiveManager().getArchive(index).get());
 		});
 
 	// When an archive is opened, open its tab
@@ -5,6 +5,7 @@
 #include "General/Sigslot.h"
 #include "UI/Controls/DockPanel.h"
 #include "UI/Lists/ListView.h"
+#include <wx/fswatcher.h>
 
 wxDECLARE_EVENT(wxEVT_COMMAND_DIRARCHIVECHECK_COMPLETED, wxThreadEvent);
 
@@ -171,6 +172,7 @@ public:
 	void onArchiveTabClose(wxAuiNotebookEvent& e);
 	void onArchiveTabClosed(wxAuiNotebookEvent& e);
 	void onDirArchiveCheckCompleted(wxThreadEvent& e);
+	void onDirArchiveFileChanged(wxFileSystemWatcherEvent& e);
 
 private:
 	STabCtrl*        stc_tabs_                    = nullptr;
@@ -190,10 +192,17 @@ private:
 	bool             checked_dir_archive_changes_ = false;
 	vector<Archive*> checking_archives_;
 
+	// Directory archive change notifications
+	unique_ptr<wxFileSystemWatcher> dir_watcher_;
+	std::map<Archive*, wxString>    watched_dir_archives_;
+	std::set<Archive*>              changed_dir_archives_;
+
 	// Signal connections
 	ScopedConnectionList signal_connections;
 
 	void connectSignals();
 	bool prepareCloseTab(int index);
+	void watchDirArchive(Archive* archive);
+	void unwatchDirArchive(Archive* archive);
 };
 } // namespace slade
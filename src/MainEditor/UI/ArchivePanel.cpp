@@ -35,12 +35,14 @@
 #include "ArchivePanel.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
+#include "Archive/Formats/WadArchive.h"
 #include "Archive/Formats/ZipArchive.h"
 #include "ArchiveManagerPanel.h"
 #include "EntryPanel/ANSIEntryPanel.h"
 #include "EntryPanel/AudioEntryPanel.h"
 #include "EntryPanel/DataEntryPanel.h"
 #include "EntryPanel/DefaultEntryPanel.h"
+#include "EntryPanel/EntryPreviewLoader.h"
 #include "EntryPanel/GfxEntryPanel.h"
 #include "EntryPanel/HexEntryPanel.h"
 #include "EntryPanel/MapEntryPanel.h"
@@ -51,7 +53,9 @@
 #include "General/Executables.h"
 #include "General/KeyBind.h"
 #include "General/Misc.h"
+#include "General/Tasks.h"
 #include "General/UI.h"
+#include "Graphics/PNGOptimizer.h"
 #include "Graphics/Palette/PaletteManager.h"
 #include "MainEditor/ArchiveOperations.h"
 #include "MainEditor/Conversions.h"
@@ -76,8 +80,12 @@
 #include "UI/Dialogs/TranslationEditorDialog.h"
 #include "UI/Lists/ArchiveEntryTree.h"
 #include "UI/WxUtils.h"
+#include "Utility/FileUtils.h"
 #include "Utility/SFileDialog.h"
 #include "Utility/StringUtils.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 using namespace slade;
 
@@ -112,9 +120,7 @@ CVAR(Bool, elist_no_tree, false, CVar::Flag::Save)
 // External Variables
 //
 // -----------------------------------------------------------------------------
-EXTERN_CVAR(String, path_pngout)
-EXTERN_CVAR(String, path_pngcrush)
-EXTERN_CVAR(String, path_deflopt)
+EXTERN_CVAR(Bool, png_opt_external)
 EXTERN_CVAR(Bool, confirm_entry_revert)
 EXTERN_CVAR(Bool, archive_dir_ignore_hidden)
 
@@ -159,17 +165,20 @@ public:
 		bool     yes_to_all = false;
 		wxString caption    = (filenames.size() > 1) ? "Overwrite entries" : "Overwrite entry";
 
-		// Import all dragged files, inserting after the item they were dragged onto
+		// Go through dragged files, importing directories and getting the
+		// files to import (and any existing entries to replace)
+		vector<string>        files;
+		vector<ArchiveEntry*> replace;
 		list_->Freeze();
-		for (int a = filenames.size() - 1; a >= 0; a--)
+		for (const auto& filename : filenames)
 		{
 			// Is this a directory?
-			if (wxDirExists(filenames[a]))
+			if (wxDirExists(filename))
 			{
 				// If the archive supports directories, create the directory and import its contents
 				if (archive->formatDesc().supports_dirs)
 				{
-					strutil::Path fn(filenames[a].ToStdString());
+					strutil::Path fn(filename.ToStdString());
 					auto          ndir = archive->createDir(fn.fileName(false), ArchiveDir::getShared(dir));
 					archive->importDir(fn.fullPath(), true, ndir);
 				}
@@ -179,7 +188,7 @@ public:
 			}
 			else
 			{
-				strutil::Path fn(filenames[a].ToStdString());
+				strutil::Path fn(filename.ToStdString());
 				ArchiveEntry* entry = nullptr;
 
 				// Find entry to replace if needed
@@ -206,17 +215,16 @@ public:
 					}
 				}
 
-				// Create new entry if needed
-				if (entry == nullptr)
-					entry = archive->addNewEntry(fn.fileName(), index, dir).get();
-
-				// Import the file to it
-				entry->importFile(filenames[a].ToStdString());
-				EntryType::detectEntryType(*entry);
+				files.push_back(filename.ToStdString());
+				replace.push_back(entry);
 			}
 		}
 		list_->Thaw();
 
+		// Import files, inserting before the item they were dragged onto
+		if (!files.empty())
+			parent_->importFiles(files, dir, index, replace);
+
 		return true;
 	}
 
@@ -411,6 +419,233 @@ size_t getNamespaceNumber(
 	return ns.size();
 }
 
+// A sound entry conversion for convertSounds. [convert] is run on a worker
+// thread unless [main_thread] is set (for conversions that need to access
+// anything other than the entry data)
+struct SoundConversion
+{
+	ArchiveEntry*                             entry = nullptr;
+	std::function<bool(MemChunk&, MemChunk&)> convert;
+	bool                                      main_thread = false;
+};
+
+// -----------------------------------------------------------------------------
+// Runs the sound [conversions] on all available cores, then updates the
+// converted entries (recording undo steps in [undo_manager]). Entries without
+// a conversion function are treated as failed conversions.
+// Any errors are logged, returns false if there were any
+// -----------------------------------------------------------------------------
+bool convertSounds(const vector<SoundConversion>& conversions, UndoManager* undo_manager)
+{
+	struct Result
+	{
+		MemChunk in;
+		MemChunk out;
+		bool     ok = false;
+		string   error;
+	};
+	const auto     n_jobs = static_cast<unsigned>(conversions.size());
+	vector<Result> results(n_jobs);
+
+	// Share entry data so it can be read from worker threads
+	for (unsigned a = 0; a < n_jobs; ++a)
+		if (conversions[a].convert)
+			results[a].in.share(conversions[a].entry->data());
+
+	// Convert on the task workers (and this thread)
+	tasks::parallelFor(
+		0,
+		n_jobs,
+		[&](unsigned index)
+		{
+			auto& conv   = conversions[index];
+			auto& result = results[index];
+			if (!conv.convert || conv.main_thread)
+				return;
+
+			result.ok = conversion::convertWithError(
+				[&] { return conv.convert(result.in, result.out); }, result.error);
+			result.in.clear();
+		});
+
+	// Update converted entries
+	bool errors = false;
+	for (unsigned a = 0; a < n_jobs; ++a)
+	{
+		auto& conv   = conversions[a];
+		auto& result = results[a];
+		if (!conv.convert)
+			result.error = "Unsupported sound format";
+		else if (conv.main_thread)
+			result.ok = conversion::convertWithError(
+				[&] { return conv.convert(result.in, result.out); }, result.error);
+
+		if (result.ok)
+		{
+			undo_manager->recordUndoStep(std::make_unique<EntryDataUS>(conv.entry)); // Create undo step
+			conv.entry->importMemChunk(result.out);                                  // Load converted data
+			EntryType::detectEntryType(*conv.entry);                                 // Update entry type
+			conv.entry->setExtensionByType();                                        // Update extension if necessary
+		}
+		else
+		{
+			log::error(wxString::Format("Unable to convert entry %s: %s", conv.entry->name(), result.error));
+			errors = true;
+		}
+	}
+
+	return !errors;
+}
+
+// A file to import for importFileEntries
+struct FileImport
+{
+	string        path;
+	ArchiveEntry* entry = nullptr; // Existing entry to import to, a new entry is created if null
+};
+
+// -----------------------------------------------------------------------------
+// Imports [files] into [archive], adding new entries (named by filename) to
+// [dir] from [index] (or at the end if negative).
+// Files are read ahead on a few task workers, while this thread adds the read
+// files to the archive in batches and detects their types (in parallel).
+// Progress is shown in a dialog (with [parent]) which can cancel the import.
+// Returns false if any files couldn't be imported or it was cancelled
+// -----------------------------------------------------------------------------
+bool importFileEntries(
+	Archive&                  archive,
+	const vector<FileImport>& files,
+	ArchiveDir*               dir,
+	int                       index,
+	wxWindow*                 parent)
+{
+	constexpr size_t   BATCH_SIZE     = 256;
+	constexpr unsigned MAX_READERS    = 4; // More rarely helps reading from disk
+	const auto         n_files        = files.size();
+
+	// Read files on the task workers, roughly in order so batches can be added
+	// to the archive while the rest are still being read
+	struct ReadFile
+	{
+		MemChunk          data;
+		bool              ok = false;
+		std::atomic<bool> done{ false };
+	};
+	vector<ReadFile>        read(n_files);
+	std::atomic<size_t>     next_read{ 0 };
+	std::atomic<bool>       cancel{ false };
+	std::mutex              read_mutex;
+	std::condition_variable read_cv;
+
+	auto read_file = [&](size_t file_index)
+	{
+		SFile file;
+		auto& file_read = read[file_index];
+		if (file.open(files[file_index].path))
+			file_read.ok = file.size() == 0 || file.read(file_read.data, file.size());
+
+		std::lock_guard lock(read_mutex);
+		file_read.done = true;
+		read_cv.notify_one();
+	};
+	auto reader = [&](const tasks::Task&)
+	{
+		for (auto file_index = next_read++; file_index < n_files && !cancel; file_index = next_read++)
+			read_file(file_index);
+	};
+	vector<tasks::Task> readers;
+	for (size_t a = 0; a < std::min<size_t>(MAX_READERS, n_files); ++a)
+		readers.push_back(tasks::run(reader));
+
+	// Add read files to the archive in batches
+	wxProgressDialog progress(
+		"Import Files",
+		"Importing files...",
+		static_cast<int>(n_files),
+		parent,
+		wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME | wxPD_REMAINING_TIME | wxPD_SMOOTH);
+	const uint8_t no_data = 0;
+	size_t        next    = 0;
+	bool          ok      = true;
+	while (next < n_files)
+	{
+		// Read the next file here if no reader has started it yet (eg. if the
+		// task workers are busy), otherwise wait for it to be read (or until
+		// progress needs updating)
+		if (next_read <= next)
+		{
+			const auto file_index = next_read++;
+			if (file_index < n_files)
+				read_file(file_index);
+		}
+		{
+			std::unique_lock lock(read_mutex);
+			read_cv.wait_for(lock, std::chrono::milliseconds(50), [&]() { return read[next].done.load(); });
+		}
+
+		// Get (up to) the next batch of read files
+		auto end = next;
+		while (end < n_files && end < next + BATCH_SIZE && read[end].done)
+			++end;
+
+		// Import them
+		vector<ArchiveEntry*> imported;
+		for (; next < end; ++next)
+		{
+			auto& file      = files[next];
+			auto& file_read = read[next];
+			if (!file_read.ok)
+			{
+				log::error("Unable to read file \"{}\"", file.path);
+				ok = false;
+				continue;
+			}
+
+			// Import to the existing entry, or a new one
+			shared_ptr<ArchiveEntry> new_entry;
+			auto*                    entry = file.entry;
+			if (!entry)
+			{
+				new_entry = std::make_shared<ArchiveEntry>(strutil::Path::fileNameOf(file.path));
+				entry     = new_entry.get();
+			}
+			auto data        = file_read.data.hasData() ? file_read.data.data() : &no_data;
+			auto imported_ok = entry->importMem(data, file_read.data.size());
+			file_read.data.clear();
+			if (!imported_ok)
+			{
+				log::error("Unable to import file \"{}\": {}", file.path, global::error);
+				ok = false;
+				continue;
+			}
+
+			// Add new entry to the archive
+			if (new_entry)
+			{
+				archive.addEntry(new_entry, index, dir);
+				if (index >= 0)
+					index++;
+			}
+			imported.push_back(entry);
+		}
+		EntryType::detectEntryTypes(imported);
+
+		// Update progress
+		if (!progress.Update(static_cast<int>(next), fmt::format("Imported {} of {} files", next, n_files)))
+		{
+			cancel = true;
+			ok     = false;
+			break;
+		}
+	}
+
+	cancel = true;
+	for (auto& reader : readers)
+		reader.wait();
+
+	return ok;
+}
+
 } // namespace
 
 
@@ -428,12 +663,18 @@ ArchivePanel::ArchivePanel(wxWindow* parent, shared_ptr<Archive>& archive) :
 	wxPanel(parent, -1),
 	archive_{ archive },
 	undo_manager_{ new UndoManager() },
-	ee_manager_{ new ExternalEditManager }
+	ee_manager_{ new ExternalEditManager },
+	preview_loader_{ new EntryPreviewLoader }
 {
 	setup(archive.get());
 	bindEvents(archive.get());
 }
 
+// -----------------------------------------------------------------------------
+// ArchivePanel class destructor
+// -----------------------------------------------------------------------------
+ArchivePanel::~ArchivePanel() = default;
+
 // -----------------------------------------------------------------------------
 // Setup the panel controls and layout
 // -----------------------------------------------------------------------------
@@ -496,6 +737,15 @@ void ArchivePanel::bindEvents(Archive* archive)
 			}
 		});
 
+	// Open the gfx entry waiting for its image once it's decoded (see openEntry)
+	preview_loader_->setReadyCallback(
+		[this](const EntryPreviewLoader::Preview& preview)
+		{
+			auto entry = preview.entry.lock();
+			if (entry && entry == pending_preview_entry_.lock() && cur_area_ == default_area_)
+				openEntry(entry.get(), true);
+		});
+
 	// Update entry moving toolbar if sorting changed
 	entry_tree_->Bind(
 		wxEVT_DATAVIEW_COLUMN_SORTED,
@@ -510,15 +760,22 @@ void ArchivePanel::bindEvents(Archive* archive)
 		});
 
 	// Close current entry panel if it's entry was removed
+	auto entry_removed = [this](const ArchiveEntry& entry)
+	{
+		if (currentArea()->entry() == &entry)
+		{
+			currentArea()->closeEntry();
+			currentArea()->openEntry(nullptr);
+			currentArea()->Show(false);
+		}
+	};
 	sc_entry_removed_ = archive->signals().entry_removed.connect(
-		[this](Archive&, ArchiveDir&, ArchiveEntry& entry)
+		[entry_removed](Archive&, ArchiveDir&, ArchiveEntry& entry) { entry_removed(entry); });
+	sc_entries_changed_ = archive->signals().entries_changed.connect(
+		[entry_removed](Archive&, const Archive::EntryChanges& changes)
 		{
-			if (currentArea()->entry() == &entry)
-			{
-				currentArea()->closeEntry();
-				currentArea()->openEntry(nullptr);
-				currentArea()->Show(false);
-			}
+			for (const auto& removed : changes.removed)
+				entry_removed(*removed.entry);
 		});
 }
 
@@ -960,44 +1217,9 @@ bool ArchivePanel::importFiles()
 		else
 			index = -1; // If not add to the end of the list
 
-		// Begin recording undo level
+		// Import files
 		undo_manager_->beginRecord("Import Files");
-
-		// Go through the list of files
-		bool ok = true;
-		entry_tree_->Freeze();
-		ui::showSplash("Importing Files...", true);
-		for (size_t a = 0; a < info.filenames.size(); a++)
-		{
-			// Get filename
-			wxString name = wxFileName(info.filenames[a]).GetFullName();
-
-			// Update splash window
-			ui::setSplashProgress(static_cast<float>(a) / static_cast<float>(info.filenames.size()));
-			ui::setSplashProgressMessage(name.ToStdString());
-
-			// Create new entry
-			auto new_entry = std::make_shared<ArchiveEntry>(name.ToStdString());
-
-			// Import file to entry
-			if (new_entry->importFile(info.filenames[a]))
-			{
-				archive->addEntry(new_entry, index, dir); // Add the entry to the archive
-				EntryType::detectEntryType(*new_entry);   // Detect entry type
-			}
-			else
-			{
-				log::error(global::error);
-				ok = false;
-			}
-
-			if (index > 0)
-				index++;
-		}
-		ui::hideSplash();
-		entry_tree_->Thaw();
-
-		// End recording undo level
+		auto ok = importFiles(info.filenames, dir, index);
 		undo_manager_->endRecord(true);
 
 		return ok;
@@ -1006,6 +1228,41 @@ bool ArchivePanel::importFiles()
 		return false;
 }
 
+// -----------------------------------------------------------------------------
+// Imports the files at [paths] into [dir], as new entries (named by filename)
+// from [index], or at the end if [index] is negative. If [replace] is given,
+// any file with a (non-null) entry at the same index in [replace] is imported
+// into that entry instead.
+// Returns false if any files couldn't be imported or it was cancelled
+// -----------------------------------------------------------------------------
+bool ArchivePanel::importFiles(
+	const vector<string>&        paths,
+	ArchiveDir*                  dir,
+	int                          index,
+	const vector<ArchiveEntry*>& replace)
+{
+	// Check the archive is still open
+	auto archive = archive_.lock();
+	if (!archive || paths.empty())
+		return false;
+
+	vector<FileImport> files(paths.size());
+	for (unsigned a = 0; a < paths.size(); ++a)
+	{
+		files[a].path  = paths[a];
+		files[a].entry = a < replace.size() ? replace[a] : nullptr;
+	}
+
+	// Import files (as a single batch of archive changes)
+	entry_tree_->Freeze();
+	archive->beginBatch();
+	auto ok = importFileEntries(*archive, files, dir, index, this);
+	archive->commitBatch();
+	entry_tree_->Thaw();
+
+	return ok;
+}
+
 // -----------------------------------------------------------------------------
 // Opens a dir selection dialog and imports any files within the selected
 // directory into the current directory, using the filenames as entry names
@@ -1196,6 +1453,7 @@ bool ArchivePanel::deleteEntry(bool confirm)
 
 	// Go through the selected entries
 	entry_tree_->Freeze();
+	archive->beginBatch();
 	for (int a = selected_entries.size() - 1; a >= 0; a--)
 	{
 		// Remove from bookmarks
@@ -1222,6 +1480,7 @@ bool ArchivePanel::deleteEntry(bool confirm)
 		// Remove the selected directory from the archive
 		archive->removeDir(selected_dirs[a]->path());
 	}
+	archive->commitBatch();
 	entry_tree_->Thaw();
 
 	// Finish recording undo level
@@ -1950,6 +2209,7 @@ bool ArchivePanel::pasteEntry() const
 	bool pasted = false;
 	undo_manager_->beginRecord("Paste Entry");
 	entry_tree_->Freeze();
+	archive->beginBatch();
 	for (unsigned a = 0; a < app::clipboard().size(); a++)
 	{
 		// Check item type
@@ -1963,6 +2223,7 @@ bool ArchivePanel::pasteEntry() const
 		if (archive->paste(clip->tree(), index, dir))
 			pasted = true;
 	}
+	archive->commitBatch();
 	undo_manager_->endRecord(true);
 	entry_tree_->Thaw();
 	panel->refreshArchiveList();
@@ -2032,13 +2293,9 @@ bool ArchivePanel::gfxConvert() const
 		if (!gcd.itemModified(a))
 			continue;
 
-		// Get image and conversion info
-		auto image  = gcd.itemImage(a);
-		auto format = gcd.itemFormat(a);
-
 		// Write converted image back to entry
 		MemChunk mc;
-		format->saveImage(*image, mc, gcd.itemPalette(a));
+		gcd.itemData(a, mc);
 		selection[a]->importMemChunk(mc);
 		EntryType::detectEntryType(*selection[a]);
 		selection[a]->setExtensionByType();
@@ -2282,17 +2539,8 @@ bool ArchivePanel::gfxExportPNG()
 		if (filedialog::saveFiles(
 				info, "Export Entries as PNG (Filename will be ignored)", "PNG Files (*.png)|*.png", this))
 		{
-			// Go through the selection
-			for (auto& entry : selection)
-			{
-				// Setup entry filename
-				wxFileName fn(entry->name());
-				fn.SetPath(info.path);
-				fn.SetExt("png");
-
-				// Do export
-				entryoperations::exportAsPNG(entry, fn.GetFullPath());
-			}
+			// Export the selection
+			entryoperations::exportAsPNG(selection, info.path);
 		}
 	}
 
@@ -2558,35 +2806,29 @@ bool ArchivePanel::palConvert() const
 // -----------------------------------------------------------------------------
 bool ArchivePanel::wavDSndConvert() const
 {
-	// Get selected entries
-	auto selection = entry_tree_->selectedEntries();
-
-	// Begin recording undo level
-	undo_manager_->beginRecord("Convert Wav -> Doom Sound");
-
-	// Go through selection
-	bool errors = false;
-	for (auto& entry : selection)
-	{
-		// Convert WAV -> Doom Sound if the entry is WAV format
+	// Get selected WAV entries
+	vector<SoundConversion> conversions;
+	bool                    lossy = false;
+	for (auto* entry : entry_tree_->selectedEntries())
 		if (entry->type()->formatId() == "snd_wav")
 		{
-			MemChunk dsnd;
-			// Attempt conversion
-			if (!conversion::wavToDoomSnd(entry->data(), dsnd))
-			{
-				log::error(wxString::Format("Unable to convert entry %s: %s", entry->name(), global::error));
-				errors = true;
-				continue;
-			}
-			undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(entry)); // Create undo step
-			entry->importMemChunk(dsnd);                                         // Load doom sound data
-			EntryType::detectEntryType(*entry);                                  // Update entry type
-			entry->setExtensionByType();                                         // Update extension if necessary
+			lossy |= conversion::wavToDoomSndIsLossy(entry->data());
+			conversions.push_back(
+				{ entry, [](MemChunk& in, MemChunk& out) { return conversion::wavToDoomSnd(in, out, false); } });
 		}
-	}
 
-	// Finish recording undo level
+	// Warn (once for all entries, conversions run on worker threads so can't ask)
+	if (lossy
+		&& wxMessageBox(
+			   "Warning: conversion will result in loss of metadata and audio quality. Do you wish to proceed?",
+			   "Conversion warning",
+			   wxOK | wxCANCEL)
+			   != wxOK)
+		return false;
+
+	// Convert WAV -> Doom Sound
+	undo_manager_->beginRecord("Convert Wav -> Doom Sound");
+	bool errors = !convertSounds(conversions, undo_manager_.get());
 	undo_manager_->endRecord(true);
 
 	// Show message if errors occurred
@@ -2601,52 +2843,41 @@ bool ArchivePanel::wavDSndConvert() const
 // -----------------------------------------------------------------------------
 bool ArchivePanel::dSndWavConvert() const
 {
-	// Get selected entries
-	auto selection = entry_tree_->selectedEntries();
-
-	// Begin recording undo level
-	undo_manager_->beginRecord("Convert Doom Sound -> Wav");
-
-	// Go through selection
-	bool errors = false;
-	for (auto& entry : selection)
+	// Get conversion for each selected entry
+	vector<SoundConversion> conversions;
+	for (auto* entry : entry_tree_->selectedEntries())
 	{
-		bool     worked = false;
-		MemChunk wav;
-		// Convert Doom Sound -> WAV if the entry is Doom Sound format
-		if (entry->type()->formatId() == "snd_doom" || entry->type()->formatId() == "snd_doom_mac")
-			worked = conversion::doomSndToWav(entry->data(), wav);
+		auto& conv     = conversions.emplace_back();
+		conv.entry     = entry;
+		const auto& id = entry->type()->formatId();
+
+		// Doom Sound format
+		if (id == "snd_doom" || id == "snd_doom_mac")
+			conv.convert = conversion::doomSndToWav;
 		// Or Doom Speaker sound format
-		else if (entry->type()->formatId() == "snd_speaker")
-			worked = conversion::spkSndToWav(entry->data(), wav);
+		else if (id == "snd_speaker")
+			conv.convert = [](MemChunk& in, MemChunk& out) { return conversion::spkSndToWav(in, out); };
 		// Or Jaguar Doom sound format
-		else if (entry->type()->formatId() == "snd_jaguar")
-			worked = conversion::jagSndToWav(entry->data(), wav);
+		else if (id == "snd_jaguar")
+			conv.convert = conversion::jagSndToWav;
 		// Or Wolfenstein 3D sound format
-		else if (entry->type()->formatId() == "snd_wolf")
-			worked = conversion::wolfSndToWav(entry->data(), wav);
+		else if (id == "snd_wolf")
+			conv.convert = conversion::wolfSndToWav;
 		// Or Creative Voice File format
-		else if (entry->type()->formatId() == "snd_voc")
-			worked = conversion::vocToWav(entry->data(), wav);
-		// Or Blood SFX format (this one needs to be given the entry, not just the mem chunk)
-		else if (entry->type()->formatId() == "snd_bloodsfx")
-			worked = conversion::bloodToWav(entry, wav);
-		// If successfully converted, update the entry
-		if (worked)
-		{
-			undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(entry)); // Create undo step
-			entry->importMemChunk(wav);                                          // Load wav data
-			EntryType::detectEntryType(*entry);                                  // Update entry type
-			entry->setExtensionByType();                                         // Update extension if necessary
-		}
-		else
+		else if (id == "snd_voc")
+			conv.convert = conversion::vocToWav;
+		// Or Blood SFX format (this one needs to be given the entry, not just the mem chunk, and reads other
+		// entries in the archive, so is done on the main thread)
+		else if (id == "snd_bloodsfx")
 		{
-			log::error(wxString::Format("Unable to convert entry %s: %s", entry->name(), global::error));
-			errors = true;
+			conv.convert     = [entry](MemChunk&, MemChunk& out) { return conversion::bloodToWav(entry, out); };
+			conv.main_thread = true;
 		}
 	}
 
-	// Finish recording undo level
+	// Convert -> WAV
+	undo_manager_->beginRecord("Convert Doom Sound -> Wav");
+	bool errors = !convertSounds(conversions, undo_manager_.get());
 	undo_manager_->endRecord(true);
 
 	// Show message if errors occurred
@@ -2699,58 +2930,125 @@ bool ArchivePanel::musMidiConvert() const
 // -----------------------------------------------------------------------------
 bool ArchivePanel::compileACS(bool hexen) const
 {
-	// Get selected entries
-	auto selection = entry_tree_->selectedEntries();
-
-	// Go through selection
-	for (auto& entry : selection)
-	{
-		// Compile ACS script
-		entryoperations::compileACS(entry, hexen, nullptr, theMainWindow);
-	}
+	// Compile selected entries (along with any scripts/libraries that include them)
+	entryoperations::compileACS(entry_tree_->selectedEntries(), hexen, theMainWindow);
 
 	return true;
 }
 
 // -----------------------------------------------------------------------------
-// Compiles any selected text entries as ACS scripts
+// Optimizes any selected PNG entries with the built-in PNG optimizer, on all
+// available cores. External PNG optimizers are then run (if set up) on any it
+// couldn't optimize, or on all of them if png_opt_external is set
 // -----------------------------------------------------------------------------
 bool ArchivePanel::optimizePNG() const
 {
-	// Check if the PNG tools path are set up, at least one of them should be
-	wxString pngpathc = path_pngcrush;
-	wxString pngpatho = path_pngout;
-	wxString pngpathd = path_deflopt;
-	if ((pngpathc.IsEmpty() || !wxFileExists(pngpathc)) && (pngpatho.IsEmpty() || !wxFileExists(pngpatho))
-		&& (pngpathd.IsEmpty() || !wxFileExists(pngpathd)))
-	{
-		wxMessageBox(
-			"Error: PNG tool paths not defined or invalid, please configure in SLADE preferences",
-			"Error",
-			wxOK | wxCENTRE | wxICON_ERROR);
+	// Get selected PNG entries
+	vector<ArchiveEntry*> entries;
+	for (auto* entry : entry_tree_->selectedEntries())
+		if (entry->type()->formatId() == "img_png")
+			entries.push_back(entry);
+	if (entries.empty())
 		return false;
-	}
 
-	// Get selected entries
-	auto selection = entry_tree_->selectedEntries();
+	// Share entry data so it can be read from worker threads
+	struct Job
+	{
+		MemChunk data;
+		MemChunk optimized;
+		bool     ok = false;
+	};
+	vector<Job> jobs(entries.size());
+	for (unsigned a = 0; a < entries.size(); ++a)
+		jobs[a].data.share(entries[a]->data());
+
+	// Optimize on the task workers
+	const auto            n_jobs = static_cast<unsigned>(jobs.size());
+	std::atomic<unsigned> n_done{ 0 };
+
+	auto optimize_task = tasks::run(
+		[&](const tasks::Task& task)
+		{
+			tasks::parallelFor(
+				0,
+				n_jobs,
+				[&](unsigned index)
+				{
+					auto& job = jobs[index];
+					job.ok    = gfx::pngOptimize(job.data, job.optimized);
+					job.data.clear();
+					++n_done;
+				},
+				1,
+				&task);
+		});
 
-	ui::showSplash("Running external programs, please wait...", true);
+	// Show progress until finished or cancelled
+	{
+		wxProgressDialog progress(
+			"Optimize PNG",
+			"Optimizing PNG entries...",
+			n_jobs,
+			theMainWindow,
+			wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME | wxPD_REMAINING_TIME | wxPD_SMOOTH);
+		while (!optimize_task.isFinished())
+		{
+			const unsigned done = n_done;
+			if (!progress.Update(done, wxString::Format("Optimized %u of %u entries", done, n_jobs)))
+			{
+				optimize_task.cancel();
+				break;
+			}
+			wxMilliSleep(50);
+		}
+	}
+	optimize_task.wait();
+	const bool cancel = optimize_task.isCancelled();
 
 	// Begin recording undo level
 	undo_manager_->beginRecord("Optimize PNG");
 
-	// Go through selection
-	for (unsigned a = 0; a < selection.size(); a++)
+	// Apply optimized data where it's smaller
+	vector<ArchiveEntry*> external;
+	size_t                old_size    = 0;
+	size_t                new_size    = 0;
+	unsigned              n_optimized = 0;
+	for (unsigned a = 0; a < n_jobs; ++a)
+	{
+		auto& job = jobs[a];
+		if (!cancel && (!job.ok || png_opt_external))
+			external.push_back(entries[a]);
+
+		if (!job.ok || job.optimized.size() >= entries[a]->size())
+			continue;
+
+		old_size += entries[a]->size();
+		new_size += job.optimized.size();
+		++n_optimized;
+		undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(entries[a]));
+		entries[a]->importMemChunk(job.optimized);
+	}
+	log::info(
+		"Optimized {} of {} PNG entries, saving {}",
+		n_optimized,
+		n_jobs,
+		misc::sizeAsString(static_cast<uint32_t>(old_size - new_size)));
+
+	// Run external optimizers if needed
+	if (!external.empty() && entryoperations::pngToolsAvailable())
 	{
-		ui::setSplashProgressMessage(selection[a]->nameNoExt());
-		ui::setSplashProgress(static_cast<float>(a) / static_cast<float>(selection.size()));
-		if (selection[a]->type()->formatId() == "img_png")
+		ui::showSplash("Running external programs, please wait...", true);
+		for (unsigned a = 0; a < external.size(); ++a)
 		{
-			undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(selection[a]));
-			entryoperations::optimizePNG(selection[a]);
+			ui::setSplashProgressMessage(external[a]->nameNoExt());
+			ui::setSplashProgress(static_cast<float>(a) / static_cast<float>(external.size()));
+			undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(external[a]));
+			entryoperations::optimizePNGExternal(external[a]);
 		}
+		ui::hideSplash();
 	}
-	ui::hideSplash();
+	else if (!png_opt_external && !external.empty())
+		log::warning("{} PNG entries could not be optimized (unsupported or invalid)", external.size());
 
 	// Finish recording undo level
 	undo_manager_->endRecord(true);
@@ -2835,6 +3133,7 @@ bool ArchivePanel::openDir(const shared_ptr<ArchiveDir>& dir) const
 void ArchivePanel::closeCurrentEntry()
 {
 	// Close the current entry
+	pending_preview_entry_.reset();
 	showEntryPanel(nullptr, false);
 }
 
@@ -2888,7 +3187,9 @@ bool ArchivePanel::openEntry(ArchiveEntry* entry, bool force)
 		saveEntryChanges();
 
 		// Close the current entry
+		auto reload = cur_area_->entry() == entry;
 		cur_area_->closeEntry();
+		pending_preview_entry_.reset();
 
 		// Get the appropriate entry panel for the entry's type
 		auto new_area = default_area_;
@@ -2914,8 +3215,28 @@ bool ArchivePanel::openEntry(ArchiveEntry* entry, bool force)
 			log::warning(
 				wxString::Format("Entry editor %s does not exist, using default editor", entry->type()->editor()));
 
-		// Load the entry into the panel
-		if (!new_area->openEntry(entry))
+		// Load the entry into the panel. Gfx entries are decoded in the
+		// background (unless reloading in the gfx panel), the default panel is
+		// shown until the image is ready
+		bool loaded;
+		if (new_area == gfx_area_ && !(reload && cur_area_ == gfx_area_) && misc::canLoadImageFromData(*entry))
+		{
+			auto preview = preview_loader_->load(*entry);
+			if (!preview->done)
+			{
+				new_area               = default_area_;
+				pending_preview_entry_ = preview->entry;
+			}
+
+			if (preview->ok)
+				loaded = dynamic_cast<GfxEntryPanel*>(gfx_area_)->openDecodedEntry(entry, preview->image);
+			else
+				loaded = new_area->openEntry(entry);
+		}
+		else
+			loaded = new_area->openEntry(entry);
+
+		if (!loaded)
 			wxMessageBox(wxString::Format("Error loading entry:\n%s", global::error), "Error", wxOK | wxICON_ERROR);
 
 		// Show the new entry panel
@@ -3254,6 +3575,15 @@ bool ArchivePanel::handleAction(string_view id)
 		dlg.ShowModal();
 	}
 
+	// Archive->Maintenance->Compact Wad
+	else if (id == "arch_compact_wad")
+	{
+		if (archive->formatId() != "wad")
+			wxMessageBox("Only wad archives can be compacted", "Compact Wad", wxOK | wxICON_INFORMATION);
+		else if (!dynamic_cast<WadArchive*>(archive.get())->compact())
+			wxMessageBox(wxString::Format("Error: %s", global::error), "Error", wxOK | wxICON_ERROR);
+	}
+
 #ifndef NO_LUA
 	// Archive->Scripts->...
 	else if (id == "arch_script")
@@ -3498,6 +3828,7 @@ wxMenu* ArchivePanel::createMaintenanceMenu()
 	SAction::fromId("arch_check_zdoom_texture_duplicates")->addToMenu(menu_clean);
 	SAction::fromId("arch_check_zdoom_patch_duplicates")->addToMenu(menu_clean);
 	SAction::fromId("arch_replace_maps")->addToMenu(menu_clean);
+	SAction::fromId("arch_compact_wad")->addToMenu(menu_clean);
 	return menu_clean;
 }
 
@@ -3534,6 +3865,7 @@ void ArchivePanel::selectionChanged()
 	{
 		toolbar_elist_->group("_Entry")->setAllButtonsEnabled(false);
 		toolbar_elist_->enableGroup("_Moving", false);
+		pending_preview_entry_.reset();
 	}
 	else if (selection.size() == 1)
 	{
@@ -3543,6 +3875,7 @@ void ArchivePanel::selectionChanged()
 		toolbar_elist_->findActionButton("arch_entry_bookmark")->Enable(true);
 		toolbar_elist_->enableGroup("_Moving", canMoveEntries());
 		openEntry(selection[0]);
+		prefetchAdjacentEntries(selection[0]);
 	}
 	else
 	{
@@ -3551,6 +3884,7 @@ void ArchivePanel::selectionChanged()
 		toolbar_elist_->findActionButton("arch_entry_rename_each")->Enable(true);
 		toolbar_elist_->findActionButton("arch_entry_bookmark")->Enable(false);
 		toolbar_elist_->enableGroup("_Moving", canMoveEntries());
+		pending_preview_entry_.reset();
 		showEntryPanel(default_area_);
 		dynamic_cast<DefaultEntryPanel*>(default_area_)->loadEntries(selection);
 	}
@@ -3571,6 +3905,32 @@ void ArchivePanel::selectionChanged()
 	toolbar_elist_->Refresh();
 }
 
+// -----------------------------------------------------------------------------
+// Queues the gfx entries either side of [entry] in the entry list to be
+// decoded in the background, if [entry] is a gfx entry
+// -----------------------------------------------------------------------------
+void ArchivePanel::prefetchAdjacentEntries(ArchiveEntry* entry) const
+{
+	static constexpr int PREFETCH_RANGE = 2;
+
+	if (!misc::canLoadImageFromData(*entry))
+		return;
+
+	auto row = entry_tree_->GetRowByItem(wxDataViewItem{ entry });
+	if (row < 0)
+		return;
+
+	vector<ArchiveEntry*> adjacent;
+	for (int a = 1; a <= PREFETCH_RANGE; ++a)
+	{
+		adjacent.push_back(entry_tree_->entryForItem(entry_tree_->GetItemByRow(row + a)));
+		if (row - a >= 0)
+			adjacent.push_back(entry_tree_->entryForItem(entry_tree_->GetItemByRow(row - a)));
+	}
+
+	preview_loader_->prefetch(adjacent);
+}
+
 // -----------------------------------------------------------------------------
 // Updates the filtering on the entry tree
 // -----------------------------------------------------------------------------
@@ -4349,44 +4709,122 @@ void ArchivePanel::onBtnClearFilter(wxCommandEvent& e)
 // -----------------------------------------------------------------------------
 bool EntryDataUS::swapData()
 {
-	// log::info(1, "Entry data swap...");
+	// Get entry
+	auto entry = this->entry();
+	if (!entry)
+		return false;
+
+	// Get the data to restore
+	MemChunk restore;
+	if (!diff_)
+		restore.share(data_);
+	else if (!applyDiff(entry->data(), restore))
+		return false;
+
+	// Backup current data
+	MemChunk current;
+	current.share(entry->data());
+
+	// Restore entry data
+	if (restore.size() == 0)
+		entry->clearData();
+	else
+		entry->importMemChunk(restore);
+
+	// Store previous entry data, as a diff against the restored data if the
+	// restored data was stored that way
+	bool was_diff = diff_.has_value();
+	diff_.reset();
+	data_.share(current);
+	if (was_diff)
+		storeDiff(restore);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Called when recording of the undo level containing this step has ended.
+// If the entry data is large, only stores the part of it that was changed
+// (eg. a single edit to a large text entry)
+// -----------------------------------------------------------------------------
+void EntryDataUS::recordEnded()
+{
+	if (auto entry = this->entry())
+		storeDiff(entry->data());
+}
 
-	// Get parent dir
+// -----------------------------------------------------------------------------
+// Returns the entry the undo step is for, or null if it doesn't exist
+// -----------------------------------------------------------------------------
+ArchiveEntry* EntryDataUS::entry() const
+{
 	auto dir = archive_->dirAtPath(path_.ToStdString());
-	if (dir)
-	{
-		// Get entry
-		auto entry = dir->entryAt(index_);
-		if (!entry)
-			return false;
+	return dir ? dir->entryAt(index_) : nullptr;
+}
 
-		// Backup data
-		MemChunk temp_data;
-		temp_data.importMem(entry->rawData(), entry->size());
-		// log::info(1, "Backup current data, size %d", entry->getSize());
+// -----------------------------------------------------------------------------
+// Replaces the undo data with the part of it that differs from the entry's
+// [current] data, if the undo data is large and that part is small enough to
+// be worth it. The undo data can then only be restored while the entry still
+// has the [current] data (checked via a hash, see applyDiff), which is the
+// case as long as all changes to the entry are recorded as undo steps
+// -----------------------------------------------------------------------------
+void EntryDataUS::storeDiff(const MemChunk& current)
+{
+	static constexpr unsigned min_size = 64 * 1024;
 
-		// Restore entry data
-		if (data_.size() == 0)
-		{
-			entry->clearData();
-			// log::info(1, "Clear entry data");
-		}
-		else
-		{
-			entry->importMemChunk(data_);
-			// log::info(1, "Restored entry data, size %d", data.getSize());
-		}
+	if (diff_ || data_.size() < min_size || !current.hasData())
+		return;
 
-		// Store previous entry data
-		if (temp_data.size() > 0)
-			data_.importMem(temp_data.data(), temp_data.size());
-		else
-			data_.clear();
+	// Find the parts at the start and end that are the same
+	auto     old_data = data_.data();
+	auto     cur_data = current.data();
+	auto     max_same = std::min(data_.size(), current.size());
+	unsigned prefix   = 0;
+	while (prefix < max_same && old_data[prefix] == cur_data[prefix])
+		++prefix;
+	unsigned suffix = 0;
+	while (suffix < max_same - prefix
+		&& old_data[data_.size() - suffix - 1] == cur_data[current.size() - suffix - 1])
+		++suffix;
+
+	// Only worth it if it saves at least half
+	auto middle_size = data_.size() - prefix - suffix;
+	if (middle_size > data_.size() / 2)
+		return;
 
-		return true;
+	MemChunk middle;
+	if (middle_size > 0)
+		middle.importMem(old_data + prefix, middle_size);
+
+	diff_ = Diff{ prefix, suffix, current.size(), misc::hash64(cur_data, current.size()) };
+	data_.share(middle); // (Clears it if there is no middle part)
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the full undo data from the entry's [current] data and the stored
+// diff into [out]. Returns false if [current] isn't the data the diff was made
+// against
+// -----------------------------------------------------------------------------
+bool EntryDataUS::applyDiff(const MemChunk& current, MemChunk& out) const
+{
+	if (current.size() != diff_->size || misc::hash64(current.data(), current.size()) != diff_->hash)
+	{
+		log::error("Unable to undo entry data change: entry data has changed");
+		return false;
 	}
 
-	return false;
+	out.reSize(diff_->prefix + data_.size() + diff_->suffix, false);
+	out.write(0, current.data(), diff_->prefix, false);
+	if (data_.size() > 0)
+		out.write(diff_->prefix, data_.data(), data_.size(), false);
+	out.write(
+		diff_->prefix + data_.size(),
+		current.data() + current.size() - diff_->suffix,
+		diff_->suffix,
+		false);
+
+	return true;
 }
 
 
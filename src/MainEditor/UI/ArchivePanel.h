@@ -13,13 +13,14 @@ class wxBitmapButton;
 namespace slade
 {
 class EntryPanel;
+class EntryPreviewLoader;
 class SToolBar;
 
 class ArchivePanel : public wxPanel, SActionHandler
 {
 public:
 	ArchivePanel(wxWindow* parent, shared_ptr<Archive>& archive);
-	~ArchivePanel() override = default;
+	~ArchivePanel() override;
 
 	Archive*     archive() const { return archive_.lock().get(); }
 	UndoManager* undoManager() const { return undo_manager_.get(); }
@@ -37,6 +38,11 @@ public:
 	bool newEntry();
 	bool newDirectory();
 	bool importFiles();
+	bool importFiles(
+		const vector<string>&        paths,
+		ArchiveDir*                  dir,
+		int                          index,
+		const vector<ArchiveEntry*>& replace = {});
 	bool importDir();
 	bool convertArchiveTo() const;
 	bool cleanupArchive() const;
@@ -143,13 +149,19 @@ protected:
 	EntryPanel* audio_area_    = nullptr;
 	EntryPanel* data_area_     = nullptr;
 
+	// Background loading of gfx entries (see openEntry)
+	unique_ptr<EntryPreviewLoader> preview_loader_;
+	weak_ptr<ArchiveEntry>         pending_preview_entry_; // Shown in the default panel until decoded
+
 	// Signal connections
 	sigslot::scoped_connection sc_archive_saved_;
 	sigslot::scoped_connection sc_entry_removed_;
+	sigslot::scoped_connection sc_entries_changed_;
 	sigslot::scoped_connection sc_bookmarks_changed_;
 
 	bool canMoveEntries() const;
 	void selectionChanged();
+	void prefetchAdjacentEntries(ArchiveEntry* entry) const;
 	void updateFilter() const;
 
 	// Entry panel getters
@@ -186,17 +198,34 @@ class EntryDataUS : public UndoStep
 public:
 	EntryDataUS(ArchiveEntry* entry) : path_{ entry->path() }, index_{ entry->index() }, archive_{ entry->parent() }
 	{
-		data_.importMem(entry->rawData(), entry->size());
+		data_.share(entry->data());
 	}
 
-	bool swapData();
-	bool doUndo() override { return swapData(); }
-	bool doRedo() override { return swapData(); }
+	bool   swapData();
+	bool   doUndo() override { return swapData(); }
+	bool   doRedo() override { return swapData(); }
+	void   recordEnded() override;
+	size_t memUsage() const override { return data_.size(); }
 
 private:
-	MemChunk data_;
-	wxString path_;
-	int      index_   = -1;
-	Archive* archive_ = nullptr;
+	// The part of the entry's current data that differs from the undo data,
+	// when only that is stored (see storeDiff)
+	struct Diff
+	{
+		unsigned prefix = 0; // No. of bytes at the start that are the same
+		unsigned suffix = 0; // No. of bytes at the end that are the same
+		unsigned size   = 0; // Size of the current data
+		uint64_t hash   = 0; // Hash of the current data
+	};
+
+	MemChunk            data_; // Undo data, or only its middle part if diff_ is set
+	std::optional<Diff> diff_;
+	wxString            path_;
+	int                 index_   = -1;
+	Archive*            archive_ = nullptr;
+
+	ArchiveEntry* entry() const;
+	void          storeDiff(const MemChunk& current);
+	bool          applyDiff(const MemChunk& current, MemChunk& out) const;
 };
 } // namespace slade
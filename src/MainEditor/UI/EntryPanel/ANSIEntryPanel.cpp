@@ -72,8 +72,6 @@ bool ANSIEntryPanel::loadEntry(ArchiveEntry* entry)
 	{
 		ansi_chardata_.assign(entry->rawData(), entry->rawData() + DATASIZE);
 		ansi_canvas_->loadData(ansi_chardata_.data());
-		for (size_t i = 0; i < DATASIZE / 2; i++)
-			ansi_canvas_->drawCharacter(i);
 		Layout();
 		Refresh();
 		return true;
@@ -41,6 +41,7 @@
 #include "UI/Controls/SIconButton.h"
 #include "UI/WxUtils.h"
 #include "Utility/StringUtils.h"
+#include <deque>
 
 using namespace slade;
 
@@ -54,6 +55,68 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 CVAR(Int, snd_volume, 100, CVar::Flag::Save)
 CVAR(Bool, snd_autoplay, false, CVar::Flag::Save)
+namespace
+{
+// Recently converted MIDI data (most recent last), so music entries aren't
+// converted again each time they are selected
+struct ConvertedMidi
+{
+	uint64_t        key;
+	vector<uint8_t> data;
+	int             num_tracks;
+};
+std::deque<ConvertedMidi> converted_midi;
+constexpr unsigned        MAX_CONVERTED_MIDI = 16;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Converts music [entry] (MUS, XMI, etc.) to MIDI data in [out], or gets it
+// from the cache if it was recently converted. [num_tracks] is set to the
+// number of tracks in the converted music (if it has multiple)
+// -----------------------------------------------------------------------------
+bool convertToMidi(ArchiveEntry& entry, MemChunk& out, int& num_tracks)
+{
+	const auto& format = entry.type()->formatId();
+	auto        key    = (entry.contentHash() ^ std::hash<string>{}(format)) * 1099511628211ull;
+
+	// Check cache
+	for (auto i = converted_midi.begin(); i != converted_midi.end(); ++i)
+		if (i->key == key)
+		{
+			out.importMem(i->data.data(), i->data.size());
+			num_tracks = i->num_tracks;
+			std::rotate(i, i + 1, converted_midi.end());
+			return true;
+		}
+
+	// Convert
+	bool ok;
+	if (format == "midi_mus")
+		ok = conversion::musToMidi(entry.data(), out);
+	else if (format == "midi_gmid")
+		ok = conversion::gmidToMidi(entry.data(), out);
+	else
+		ok = conversion::zmusToMidi(entry.data(), out, 0, &num_tracks);
+
+	if (!ok)
+		return false;
+
+	// Add to cache
+	converted_midi.push_back({ key, { out.data(), out.data() + out.size() }, num_tracks });
+	if (converted_midi.size() > MAX_CONVERTED_MIDI)
+		converted_midi.pop_front();
+
+	return true;
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -292,21 +355,13 @@ bool AudioEntryPanel::open(ArchiveEntry* entry)
 		conversion::jagSndToWav(mcdata, data_);
 	else if (entry->type()->formatId() == "snd_bloodsfx") // Blood Sound -> WAV
 		conversion::bloodToWav(entry, data_);
-	else if (entry->type()->formatId() == "midi_mus") // MUS -> MIDI
-	{
-		conversion::musToMidi(mcdata, data_);
-		path.SetExt("mid");
-	}
 	else if (
+		entry->type()->formatId() == "midi_mus" || // MUS -> MIDI
 		entry->type()->formatId() == "midi_xmi" || // HMI/HMP/XMI -> MIDI
-		entry->type()->formatId() == "midi_hmi" || entry->type()->formatId() == "midi_hmp")
-	{
-		conversion::zmusToMidi(mcdata, data_, 0, &num_tracks_);
-		path.SetExt("mid");
-	}
-	else if (entry->type()->formatId() == "midi_gmid") // GMID -> MIDI
+		entry->type()->formatId() == "midi_hmi" || entry->type()->formatId() == "midi_hmp"
+		|| entry->type()->formatId() == "midi_gmid") // GMID -> MIDI
 	{
-		conversion::gmidToMidi(mcdata, data_);
+		convertToMidi(*entry, data_, num_tracks_);
 		path.SetExt("mid");
 	}
 	else
@@ -580,35 +635,14 @@ bool AudioEntryPanel::updateInfo(ArchiveEntry& entry) const
 			size_t samples = mc.readL16(0);
 			info += wxString::Format("%lu samples", (unsigned long)samples);
 		}
-		else if (entry.type() == EntryType::fromId("snd_sun"))
-			info += audio::getSunInfo(mc);
-		else if (entry.type() == EntryType::fromId("snd_voc"))
-			info += audio::getVocInfo(mc);
-		else if (entry.type() == EntryType::fromId("snd_wav"))
-			info += audio::getWavInfo(mc);
-		else if (entry.type() == EntryType::fromId("snd_mp3"))
-			info += audio::getID3Tag(mc);
-		else if (entry.type() == EntryType::fromId("snd_ogg"))
-			info += audio::getOggComments(mc);
-		else if (entry.type() == EntryType::fromId("snd_flac"))
-			info += audio::getFlacComments(mc);
-		else if (entry.type() == EntryType::fromId("snd_aiff"))
-			info += audio::getAiffInfo(mc);
-		break;
-	case Mod:
-		if (entry.type() == EntryType::fromId("mod_it"))
-			info += audio::getITComments(mc);
-		else if (entry.type() == EntryType::fromId("mod_mod"))
-			info += audio::getModComments(mc);
-		else if (entry.type() == EntryType::fromId("mod_s3m"))
-			info += audio::getS3MComments(mc);
-		else if (entry.type() == EntryType::fromId("mod_xm"))
-			info += audio::getXMComments(mc);
+		else
+			info += audio::getTagInfo(entry);
 		break;
+	case Mod: info += audio::getTagInfo(entry); break;
 	case MIDI:
 		info += audio::midiInfo(mc);
 		if (entry.type() == EntryType::fromId("midi_rmid"))
-			info += audio::getRmidInfo(mc);
+			info += audio::getTagInfo(entry);
 		break;
 	default: break;
 	}
@@ -718,11 +752,22 @@ void AudioEntryPanel::onTimer(wxTimerEvent& e)
 	default: break;
 	}
 
+	// Update duration if it changed (mod/mp3 durations are determined in the
+	// background after opening)
+	int duration = song_length_;
+	if (audio_type_ == Mod)
+		duration = mod_->duration().asMilliseconds();
+	else if (audio_type_ == Mp3)
+		duration = mp3_->duration().asMilliseconds();
+	if (duration != song_length_)
+		setAudioDuration(duration);
+
 	// Set slider
 	slider_seek_->SetValue(pos);
 
 	// Stop the timer if playback has reached the end
-	if (pos >= slider_seek_->GetMax() || (audio_type_ == Sound && sound_->getStatus() == sf::Sound::Stopped)
+	if ((song_length_ > 0 && pos >= slider_seek_->GetMax())
+		|| (audio_type_ == Sound && sound_->getStatus() == sf::Sound::Stopped)
 		|| (audio_type_ == Music && music_->getStatus() == sf::Sound::Stopped)
 		|| (audio_type_ == Mod && mod_->getStatus() == sf::Sound::Stopped)
 		|| (audio_type_ == Mp3 && mp3_->getStatus() == sf::Sound::Stopped)
@@ -165,7 +165,7 @@ wxString DataEntryTable::GetValue(int row, int col)
 	// String column
 	else if (columns_[col].type == ColType::String)
 	{
-		return wxString::FromAscii(data_.data() + data_.currentPos(), columns_[col].size);
+		return wxString::FromAscii(std::as_const(data_).data() + data_.currentPos(), columns_[col].size);
 	}
 
 	// Custom value column
@@ -322,7 +322,7 @@ bool DataEntryTable::DeleteRows(size_t pos, size_t num)
 {
 	// Copy existing data
 	MemChunk copy;
-	copy.write(data_.data(), data_.size());
+	copy.write(std::as_const(data_).data(), data_.size());
 
 	// Write new data (excluding deleted rows)
 	unsigned start = data_start_ + (row_stride_ * pos);
@@ -367,7 +367,7 @@ bool DataEntryTable::InsertRows(size_t pos, size_t num)
 {
 	// Copy existing data
 	MemChunk copy;
-	copy.write(data_.data(), data_.size());
+	copy.write(std::as_const(data_).data(), data_.size());
 
 	// Write leading rows
 	unsigned start = data_start_ + (row_stride_ * pos);
@@ -455,8 +455,9 @@ bool DataEntryTable::setupDataStructure(ArchiveEntry* entry)
 	if (!entry)
 		return true;
 
-	// Load entry data
-	data_.write(entry->rawData(), entry->size());
+	// Load entry data (shared until modified, since cell values are only read
+	// from the data as the rows are shown)
+	data_.share(entry->data());
 
 	// Setup columns
 	auto type = entry->type()->id();
@@ -855,7 +856,7 @@ void DataEntryTable::copyRows(int row, int num, bool add)
 	if (!add)
 		data_clipboard_.clear();
 
-	data_clipboard_.write(data_.data() + data_start_ + (row * row_stride_), num * row_stride_);
+	data_clipboard_.write(std::as_const(data_).data() + data_start_ + (row * row_stride_), num * row_stride_);
 }
 
 // -----------------------------------------------------------------------------
@@ -869,7 +870,7 @@ void DataEntryTable::pasteRows(int row)
 
 	// Copy existing data
 	MemChunk copy;
-	copy.write(data_.data(), data_.size());
+	copy.write(std::as_const(data_).data(), data_.size());
 
 	// Write leading rows
 	unsigned start = data_start_ + (row_stride_ * row);
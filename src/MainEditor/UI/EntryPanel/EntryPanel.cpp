@@ -172,9 +172,9 @@ bool EntryPanel::openEntry(shared_ptr<ArchiveEntry> entry)
 	// Set unmodified
 	setModified(false);
 
-	// Copy current entry content
-	entry_data_.clear();
-	entry_data_.importMem(entry->rawData(true), entry->size());
+	// Keep current entry content (shared with the entry until either is
+	// modified, see MemChunk::share)
+	entry_data_.share(entry->data(true));
 
 	// Load the entry
 	if (loadEntry(entry.get()))
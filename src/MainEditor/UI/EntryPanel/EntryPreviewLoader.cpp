@@ -0,0 +1,216 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    EntryPreviewLoader.cpp
+// Description: EntryPreviewLoader class. Decodes gfx entry images on the
+//              task workers for opening in the entry panels. Only the
+//              most recently requested entry (and any neighbouring entries
+//              prefetched after it) are decoded, older requests that haven't
+//              started yet are dropped.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "EntryPreviewLoader.h"
+#include "Archive/ArchiveEntry.h"
+#include "Archive/EntryType/EntryType.h"
+#include "General/Misc.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr unsigned MAX_PREVIEWS = 16; // Max finished previews to keep
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// EntryPreviewLoader Structs
+//
+// -----------------------------------------------------------------------------
+
+// An entry image to be decoded, with everything needed to decode it without
+// accessing the entry
+struct EntryPreviewLoader::Job
+{
+	shared_ptr<Preview> preview;
+	MemChunk            data; // Shared with the entry (see MemChunk::share)
+	string              format_id;
+	string              format_hint;
+	SIFormat*           image_format = nullptr; // Format the entry was last loaded with, if known
+	bool                ok           = false;
+};
+
+
+// -----------------------------------------------------------------------------
+//
+// EntryPreviewLoader Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// EntryPreviewLoader class constructor
+// -----------------------------------------------------------------------------
+EntryPreviewLoader::EntryPreviewLoader() :
+	jobs_{
+		[](Job& job)
+		{
+			// Decode into the preview image (it isn't accessed on the main
+			// thread until the preview is done)
+			job.ok = misc::loadImageFromData(
+				&job.preview->image, job.data, job.format_id, job.format_hint, 0, job.image_format);
+			job.data.clear();
+		},
+		[this](Job& job)
+		{
+			auto& preview = *job.preview;
+			preview.ok    = job.ok;
+			preview.done  = true;
+
+			// Remember the detected image format if the entry is unchanged
+			auto entry = preview.entry.lock();
+			if (job.ok && entry && entry->contentHash() == preview.content_hash)
+				entry->setImageFormat(preview.image.format());
+
+			if (ready_callback_)
+				ready_callback_(preview);
+		},
+		tasks::Priority::High
+	}
+{
+}
+
+// -----------------------------------------------------------------------------
+// EntryPreviewLoader class destructor
+// -----------------------------------------------------------------------------
+EntryPreviewLoader::~EntryPreviewLoader() = default;
+
+// -----------------------------------------------------------------------------
+// Returns the preview for [entry], queueing it to be decoded before anything
+// else if it isn't already. Any other queued previews that haven't started
+// decoding yet are dropped
+// -----------------------------------------------------------------------------
+shared_ptr<EntryPreviewLoader::Preview> EntryPreviewLoader::load(ArchiveEntry& entry)
+{
+	dropQueued();
+
+	if (auto preview = cachedPreview(entry))
+		return preview;
+
+	return queue(entry, true);
+}
+
+// -----------------------------------------------------------------------------
+// Queues any of [entries] that can be loaded and aren't already to be decoded
+// after any previews requested via load
+// -----------------------------------------------------------------------------
+void EntryPreviewLoader::prefetch(const vector<ArchiveEntry*>& entries)
+{
+	for (auto* entry : entries)
+		if (entry && misc::canLoadImageFromData(*entry) && !cachedPreview(*entry))
+			queue(*entry, false);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the queued or finished preview for [entry], or nullptr if there is
+// none for its current data
+// -----------------------------------------------------------------------------
+shared_ptr<EntryPreviewLoader::Preview> EntryPreviewLoader::cachedPreview(ArchiveEntry& entry)
+{
+	for (auto i = previews_.begin(); i != previews_.end(); ++i)
+	{
+		if ((*i)->entry.lock().get() != &entry)
+			continue;
+
+		auto preview = *i;
+		previews_.erase(i);
+
+		// Discard if the entry has been modified since
+		if (preview->content_hash != entry.contentHash())
+			return nullptr;
+
+		// Move to most recently used
+		previews_.push_back(preview);
+		return preview;
+	}
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Queues [entry] to be decoded on a task worker, before any other queued
+// entries if [priority] is true. Returns the queued preview
+// -----------------------------------------------------------------------------
+shared_ptr<EntryPreviewLoader::Preview> EntryPreviewLoader::queue(ArchiveEntry& entry, bool priority)
+{
+	auto preview          = std::make_shared<Preview>();
+	preview->entry        = entry.getShared();
+	preview->content_hash = entry.contentHash();
+
+	auto job          = std::make_shared<Job>();
+	job->preview      = preview;
+	job->format_id    = entry.type()->formatId();
+	job->format_hint  = entry.type()->extraProps().getOr<string>("image_format", {});
+	job->image_format = entry.imageFormat();
+	job->data.share(entry.data());
+
+	// Add to queue
+	jobs_.push(job, priority);
+
+	// Add to cache, removing the least recently used finished previews if
+	// there are too many
+	previews_.push_back(preview);
+	unsigned n_done = std::count_if(previews_.begin(), previews_.end(), [](const auto& p) { return p->done; });
+	for (auto i = previews_.begin(); n_done > MAX_PREVIEWS && i != previews_.end();)
+	{
+		if ((*i)->done)
+		{
+			i = previews_.erase(i);
+			--n_done;
+		}
+		else
+			++i;
+	}
+
+	return preview;
+}
+
+// -----------------------------------------------------------------------------
+// Drops all queued previews that haven't started decoding yet
+// -----------------------------------------------------------------------------
+void EntryPreviewLoader::dropQueued()
+{
+	for (const auto& job : jobs_.takeQueued())
+		previews_.erase(std::remove(previews_.begin(), previews_.end(), job->preview), previews_.end());
+}
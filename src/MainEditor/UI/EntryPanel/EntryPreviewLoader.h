@@ -0,0 +1,49 @@
+#pragma once
+
+#include "General/Tasks.h"
+#include "Graphics/SImage/SImage.h"
+#include <deque>
+
+namespace slade
+{
+class ArchiveEntry;
+
+// Decodes gfx entry images for the entry panels on the task workers, so
+// that selecting entries doesn't block the UI while they are decoded.
+// The entry being opened takes priority (any previously queued requests that
+// haven't started yet are dropped), and neighbouring entries can be prefetched
+// after it. Finished previews are kept in a small cache
+class EntryPreviewLoader
+{
+public:
+	// An entry image being decoded. [done], [ok] and [image] are only valid on
+	// the main thread once [done] is true
+	struct Preview
+	{
+		weak_ptr<ArchiveEntry> entry;
+		uint64_t               content_hash = 0;
+		SImage                 image;
+		bool                   done = false;
+		bool                   ok   = false;
+	};
+
+	EntryPreviewLoader();
+	~EntryPreviewLoader();
+
+	void setReadyCallback(std::function<void(const Preview&)> callback) { ready_callback_ = std::move(callback); }
+
+	shared_ptr<Preview> load(ArchiveEntry& entry);
+	void                prefetch(const vector<ArchiveEntry*>& entries);
+
+private:
+	struct Job;
+
+	tasks::JobQueue<Job>                jobs_;
+	std::deque<shared_ptr<Preview>>     previews_; // Queued and finished (most recently used last)
+	std::function<void(const Preview&)> ready_callback_;
+
+	shared_ptr<Preview> cachedPreview(ArchiveEntry& entry);
+	shared_ptr<Preview> queue(ArchiveEntry& entry, bool priority);
+	void                dropQueued();
+};
+} // namespace slade
@@ -211,8 +211,10 @@ bool GfxEntryPanel::loadEntry(ArchiveEntry* entry, int index)
 	// Update variables
 	setModified(false);
 
-	// Attempt to load the image
-	if (!misc::loadImageFromEntry(image(), entry, index))
+	// Attempt to load the image (or copy it if it was already decoded)
+	if (decoded_image_ && index == 0)
+		image()->copyImage(decoded_image_);
+	else if (!misc::loadImageFromEntry(image(), entry, index))
 		return false;
 
 	// Only show next/prev image buttons if the entry contains multiple images
@@ -239,6 +241,19 @@ bool GfxEntryPanel::loadEntry(ArchiveEntry* entry, int index)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Opens [entry], using [image] (already decoded from the entry's current data,
+// eg. by EntryPreviewLoader) rather than loading the image from the entry
+// -----------------------------------------------------------------------------
+bool GfxEntryPanel::openDecodedEntry(ArchiveEntry* entry, SImage& image)
+{
+	decoded_image_ = &image;
+	auto ok        = openEntry(entry);
+	decoded_image_ = nullptr;
+
+	return ok;
+}
+
 // -----------------------------------------------------------------------------
 // Saves any changes to the entry
 // -----------------------------------------------------------------------------
@@ -598,12 +613,13 @@ void GfxEntryPanel::refreshPanel()
 
 // -----------------------------------------------------------------------------
 // Sets the gfx canvas' palette to what is selected in the palette chooser, and
-// refreshes the gfx canvas
+// refreshes the gfx canvas. The image texture picks up the palette change when
+// drawn (see gl::TiledTexture::update), so it doesn't need to be regenerated
 // -----------------------------------------------------------------------------
 void GfxEntryPanel::updateImagePalette() const
 {
 	gfx_canvas_->setPalette(maineditor::currentPalette());
-	gfx_canvas_->updateImageTexture();
+	gfx_canvas_->Refresh();
 }
 
 // -----------------------------------------------------------------------------
@@ -29,6 +29,7 @@ public:
 	void            refreshPanel() override;
 	wxString        statusString() override;
 	bool            extractAll() const;
+	bool            openDecodedEntry(ArchiveEntry* entry, SImage& image);
 
 	// SAction handler
 	bool handleEntryPanelAction(string_view id) override;
@@ -53,6 +54,7 @@ private:
 	bool        image_data_modified_ = false;
 	int         cur_index_           = 0;
 	bool        editing_             = false;
+	SImage*     decoded_image_       = nullptr; // Already decoded image to load (see openDecodedEntry)
 	Translation prev_translation_;
 	Translation edit_translation_;
 
@@ -1036,91 +1036,15 @@ bool PaletteEntryPanel::gradient()
 // -----------------------------------------------------------------------------
 // Generates a COLORMAP lump from the current palette
 // -----------------------------------------------------------------------------
-#define DIMINISH(color, level) color = (uint8_t)((((float)(color)) * (32.0 - (level)) + 16.0) / 32.0)
 bool PaletteEntryPanel::generateColormaps() const
 {
-	constexpr int GREENMAP = 255;
-	constexpr int GRAYMAP  = 32;
-
 	auto entry = entry_.lock();
 	if (!entry || !entry->parent() || !palettes_[0])
 		return false;
 
 	MemChunk mc;
-	SImage   img;
-	MemChunk imc;
-	mc.reSize(34 * 256);
-	mc.seek(0, SEEK_SET);
-	imc.reSize(34 * 256 * 4);
-	imc.seek(0, SEEK_SET);
-	uint8_t rgba[4];
-	rgba[3] = 255;
-
-	ColRGBA rgb;
-	float   grey;
-	// Generate 34 maps: the first 32 for diminishing light levels,
-	// the 33th for the inverted grey map used by invulnerability.
-	// The 34th colormap remains empty and black.
-	for (size_t l = 0; l < 34; ++l)
-	{
-		for (size_t c = 0; c < 256; ++c)
-		{
-			rgb = palettes_[0]->colour(c);
-			if (l < 32)
-			{
-				// Generate light maps
-				DIMINISH(rgb.r, l);
-				DIMINISH(rgb.g, l);
-				DIMINISH(rgb.b, l);
-#if (0)
-			}
-			else if (l == GREENMAP)
-			{
-				// Point of mostly useless trivia: the green "light amp" colormap in the Press Release beta
-				// have colors that, on average, correspond to a bit less than (R*75/256, G*225/256, B*115/256)
-#endif
-			}
-			else if (l == GRAYMAP)
-			{
-				// Generate inverse map
-				grey = ((float)rgb.r / 256.0 * col_greyscale_r) + ((float)rgb.g / 256.0 * col_greyscale_g)
-					   + ((float)rgb.b / 256.0 * col_greyscale_b);
-				grey = 1.0 - grey;
-				// Clamp value: with Id Software's values, the sum is greater than 1.0 (0.299+0.587+0.144=1.030)
-				// This means the negation above can give a negative value (for example, with RGB values of 247 or
-				// more), which will not be converted correctly to unsigned 8-bit int in the ColRGBA struct.
-				if (grey < 0.0)
-					grey = 0;
-				rgb.r = rgb.g = rgb.b = grey * 255;
-			}
-			else
-			{
-				// Fill with 0
-				rgb = palettes_[0]->colour(0);
-			}
-			rgba[0] = rgb.r;
-			rgba[1] = rgb.g;
-			rgba[2] = rgb.b;
-			imc.write(&rgba, 4);
-			mc[(256 * l) + c] = palettes_[0]->nearestColour(rgb);
-		}
-	}
-#if 0
-	// Create truecolor image
-	uint8_t* imd = new uint8_t[256*34*4];
-	memcpy(imd, imc.getData(), 256*34*4);
-	img.setImageData(imd, 256, 34, RGBA);
-	// imd will be freed by img's destructor
-	ArchiveEntry* tcolormap;
-	string name = entry->getName(true) + "-tcm.png";
-	tcolormap = new ArchiveEntry(name);
-	if (tcolormap)
-	{
-		entry->getParent()->addEntry(tcolormap);
-		SIFormat::getFormat("png")->saveImage(img, tcolormap->getMCData());
-		EntryType::detectEntryType(tcolormap);
-	}
-#endif
+	palettes_[0]->generateColormap(mc);
+
 	// Now override or create new entry
 	auto colormap = entry->parent()->entry("COLORMAP", true);
 	if (!colormap)
@@ -1135,7 +1059,6 @@ bool PaletteEntryPanel::generateColormaps() const
 	colormap->importMemChunk(mc);
 	return true;
 }
-#undef DIMINISH
 
 // -----------------------------------------------------------------------------
 // Just a helper for generatePalettes to make the code less redundant
@@ -433,6 +433,10 @@ void MainWindow::setupLayout()
 				panel_undo_history_->setManager(nullptr);
 		});
 
+	// Periodically unload old entry data if over the memory budget
+	timer_memory_budget_.Bind(wxEVT_TIMER, [](wxTimerEvent&) { app::archiveManager().enforceMemoryBudget(); });
+	timer_memory_budget_.Start(5000);
+
 	// Initial focus to toolbar
 	toolbar_->SetFocus();
 }
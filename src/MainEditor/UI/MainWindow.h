@@ -50,6 +50,7 @@ private:
 	wxAuiManager*            aui_mgr_              = nullptr;
 	int                      lasttipindex_         = 0;
 	PaletteChooser*          palette_chooser_      = nullptr;
+	wxTimer                  timer_memory_budget_;
 
 	// Start page
 	SStartPage* start_page_ = nullptr;
@@ -37,11 +37,11 @@
 #include "PatchBrowser.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
-#include "General/Misc.h"
 #include "General/ResourceManager.h"
 #include "Graphics/CTexture/CTexture.h"
 #include "Graphics/CTexture/TextureXList.h"
 #include "Graphics/SImage/SImage.h"
+#include "Graphics/ThumbnailCache.h"
 #include "MainEditor/MainEditor.h"
 #include "MainEditor/UI/MainWindow.h"
 #include "OpenGL/GLTexture.h"
@@ -71,37 +71,77 @@ PatchBrowserItem::~PatchBrowserItem()
 // -----------------------------------------------------------------------------
 bool PatchBrowserItem::loadImage()
 {
-	SImage img;
-
-	// Load patch image
-	if (type_ == Type::Patch)
+	// Start loading the image in the background if needed
+	if (!pending_)
 	{
-		// Find patch entry
-		auto entry = app::resources().getPatchEntry(name_.ToStdString(), nspace_.ToStdString(), archive_);
+		// Load patch image
+		if (type_ == Type::Patch)
+		{
+			// Find patch entry
+			auto entry = app::resources().getPatchEntry(name_.ToStdString(), nspace_.ToStdString(), archive_);
+			if (!entry)
+				return false;
 
-		// Load entry to image, if it exists
-		if (entry)
-			misc::loadImageFromEntry(&img, entry);
-		else
-			return false;
+			// Decode entry to image
+			pending_ = parent_->imageQueue().queue(*entry, parent_->palette());
+		}
+
+		// Or, load texture image
+		if (type_ == Type::CTexture)
+		{
+			// Find texture
+			auto tex = app::resources().getTexture(name_.ToStdString(), "", archive_);
+			if (!tex)
+				return false;
+
+			// Check the thumbnail cache first
+			auto pal       = parent_->palette();
+			auto thumb_key = thumbnailcache::textureKey(*tex, archive_, pal);
+			pending_       = std::make_shared<BrowserImageQueue::Request>();
+			if (thumbnailcache::load(thumb_key, pending_->image, pending_->full_size))
+			{
+				pending_->done = true;
+				pending_->ok   = true;
+			}
+			else
+			{
+				// Compose texture (PatchBrowserItems are only ever added to a PatchBrowser)
+				static_cast<PatchBrowser*>(parent_)->composer().queue(
+					*tex,
+					archive_,
+					pal,
+					false,
+					[request = weak_ptr<BrowserImageQueue::Request>(pending_), thumb_key, pal](
+						bool ok, const SImage& image, const CTexture&)
+					{
+						if (ok)
+							thumbnailcache::save(thumb_key, image, pal);
+
+						if (auto composed = request.lock())
+						{
+							composed->done      = true;
+							composed->ok        = ok && composed->image.copyImage(&image);
+							composed->full_size = { image.width(), image.height() };
+						}
+					});
+			}
+		}
 	}
 
-	// Or, load texture image
-	if (type_ == Type::CTexture)
-	{
-		// Find texture
-		auto tex = app::resources().getTexture(name_.ToStdString(), "", archive_);
+	// Still loading
+	loading_ = pending_ && !pending_->done;
+	if (!pending_ || loading_)
+		return false;
 
-		// Load texture to image, if it exists
-		if (tex)
-			tex->toImage(img, archive_, parent_->palette());
-		else
-			return false;
-	}
+	// Failed (keep the request so it isn't retried until the image is cleared)
+	if (!pending_->ok)
+		return false;
 
 	// Create gl texture from image
 	gl::Texture::clear(image_tex_);
-	image_tex_ = gl::Texture::createFromImage(img, parent_->palette());
+	image_tex_ = gl::Texture::createFromImage(pending_->image, parent_->palette());
+	full_size_ = pending_->full_size;
+	pending_.reset();
 	return image_tex_ > 0;
 }
 
@@ -112,12 +152,9 @@ wxString PatchBrowserItem::itemInfo()
 {
 	wxString info;
 
-	// Add dimensions if known
+	// Add dimensions if known (the image may be a scaled-down thumbnail)
 	if (image_tex_)
-	{
-		auto& tex_info = gl::Texture::info(image_tex_);
-		info += wxString::Format("%dx%d", tex_info.size.x, tex_info.size.y);
-	}
+		info += wxString::Format("%dx%d", full_size_.x, full_size_.y);
 	else
 		info += "Unknown size";
 
@@ -145,6 +182,18 @@ void PatchBrowserItem::clearImage()
 {
 	gl::Texture::clear(image_tex_);
 	image_tex_ = 0;
+	pending_.reset();
+	loading_ = false;
+}
+
+// -----------------------------------------------------------------------------
+// Cancels loading the item image in the background. Patches that haven't
+// started decoding yet are skipped, composed textures are discarded
+// -----------------------------------------------------------------------------
+void PatchBrowserItem::cancelLoad()
+{
+	pending_.reset();
+	loading_ = false;
 }
 
 
@@ -171,6 +220,7 @@ PatchBrowser::PatchBrowser(wxWindow* parent) : BrowserWindow(parent)
 		palette_.copyPalette(theMainWindow->paletteChooser()->selectedPalette());
 
 		// Reload all items
+		composer_.cancel();
 		reloadItems();
 		Refresh();
 	});
@@ -189,6 +239,7 @@ bool PatchBrowser::openPatchTable(PatchTable* table)
 		return false;
 
 	// Clear any existing browser items
+	composer_.cancel();
 	clearItems();
 
 	// Setup palette chooser
@@ -245,6 +296,7 @@ bool PatchBrowser::openArchive(Archive* archive)
 		return false;
 
 	// Clear any existing browser items
+	composer_.cancel();
 	clearItems();
 
 	// Init browser tree
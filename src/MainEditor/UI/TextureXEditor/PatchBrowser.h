@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Graphics/CTexture/TextureComposer.h"
+#include "Graphics/SImage/SImage.h"
 #include "UI/Browser/BrowserWindow.h"
 
 namespace slade
@@ -35,11 +37,14 @@ public:
 	bool     loadImage() override;
 	wxString itemInfo() override;
 	void     clearImage() override;
+	void     cancelLoad() override;
 
 private:
-	Archive* archive_ = nullptr;
-	Type     type_    = Type::Patch;
-	wxString nspace_;
+	Archive*                               archive_ = nullptr;
+	Type                                   type_    = Type::Patch;
+	wxString                               nspace_;
+	shared_ptr<BrowserImageQueue::Request> pending_;   // Image being decoded or composed in the background
+	Vec2i                                  full_size_; // Size of the (unscaled) image
 };
 
 class PatchBrowser : public BrowserWindow
@@ -56,9 +61,12 @@ public:
 	void selectPatch(const wxString& name);
 	void setFullPath(bool enabled) { full_path_ = enabled; }
 
+	TextureComposer& composer() { return composer_; }
+
 private:
-	PatchTable* patch_table_ = nullptr;
-	bool        full_path_   = false; // Texture definition format supports full path texture and/or patch names
+	PatchTable*     patch_table_ = nullptr;
+	bool            full_path_   = false; // Texture definition format supports full path texture and/or patch names
+	TextureComposer composer_;
 
 	// Signal connections
 	sigslot::scoped_connection sc_palette_changed_;
@@ -183,7 +183,7 @@ void PatchTableListView::sortItems()
 	if (sort_column_ == 2)
 		std::sort(items_.begin(), items_.end(), &PatchTableListView::usageSort);
 	else
-		std::sort(items_.begin(), items_.end(), &VirtualListView::defaultSort);
+		sortItemsByText();
 }
 
 
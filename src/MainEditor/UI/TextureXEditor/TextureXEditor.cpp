@@ -207,15 +207,23 @@ TextureXEditor::TextureXEditor(wxWindow* parent) : wxPanel(parent, -1)
 	// Bind events
 	Bind(wxEVT_SHOW, &TextureXEditor::onShow, this);
 
-	// Update patch browser & palette when resources are updated or the patch table is modified
-	sc_resources_updated_ = app::resources().signals().resources_updated.connect([this]() {
-		pb_update_ = true;
-		updateTexturePalette();
-	});
-	sc_ptable_modified_   = patch_table_.signals().modified.connect([this]() {
-        pb_update_ = true;
-        updateTexturePalette();
-    });
+	// Update patch browser, palette and texture errors when resources are updated or the patch table is modified
+	sc_resources_updated_ = app::resources().signals().resources_updated.connect(
+		[this]()
+		{
+			pb_update_ = true;
+			updateTexturePalette();
+			for (auto& texture_editor : texture_editors_)
+				texture_editor->refreshTextureErrors();
+		});
+	sc_ptable_modified_ = patch_table_.signals().modified.connect(
+		[this]()
+		{
+			pb_update_ = true;
+			updateTexturePalette();
+			for (auto& texture_editor : texture_editors_)
+				texture_editor->refreshTextureErrors();
+		});
 
 	// Update the editor palette if the main palette is changed
 	sc_palette_changed_ = theMainWindow->paletteChooser()->signals().palette_changed.connect(
@@ -553,28 +561,11 @@ bool TextureXEditor::checkTextures()
 			auto tex = texture_editor->txList().texture(t);
 
 			// Check its patches are all valid
-			if (tex->isExtended())
-			{
-				// Extended texture, check if each patch exists in any open archive (or as a composite texture)
-				for (unsigned p = 0; p < tex->nPatches(); p++)
-				{
-					auto pentry = app::resources().getPatchEntry(tex->patch(p)->name());
-					auto fentry = app::resources().getFlatEntry(tex->patch(p)->name());
-					auto ptex   = app::resources().getTexture(tex->patch(p)->name());
-					if (!pentry && !fentry && !ptex)
-						problems += wxString::Format(
-							"Texture %s contains invalid/unknown patch %s\n", tex->name(), tex->patch(p)->name());
-				}
-			}
-			else
+			for (unsigned p = 0; p < tex->nPatches(); p++)
 			{
-				// Regular texture, check the patch table
-				for (unsigned p = 0; p < tex->nPatches(); p++)
-				{
-					if (patch_table_.patchIndex(tex->patch(p)->name()) == -1)
-						problems += wxString::Format(
-							"Texture %s contains invalid/unknown patch %s\n", tex->name(), tex->patch(p)->name());
-				}
+				if (!patchIsValid(*tex, p))
+					problems += wxString::Format(
+						"Texture %s contains invalid/unknown patch %s\n", tex->name(), tex->patch(p)->name());
 			}
 		}
 	}
@@ -620,6 +611,22 @@ bool TextureXEditor::checkTextures()
 		return false;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the patch at [index] in [texture] exists.
+// For extended textures it must exist in any open archive (or as a composite
+// texture), otherwise it must be in the patch table
+// -----------------------------------------------------------------------------
+bool TextureXEditor::patchIsValid(const CTexture& texture, unsigned index) const
+{
+	const auto& name = texture.patch(index)->name();
+
+	if (texture.isExtended())
+		return app::resources().getPatchEntry(name) || app::resources().getFlatEntry(name)
+			   || app::resources().getTexture(name);
+
+	return patch_table_.patchIndex(name) >= 0;
+}
+
 // -----------------------------------------------------------------------------
 // Sets the active tab to be the one corresponding to the given entry index or
 // entry.
@@ -41,6 +41,7 @@ public:
 
 	// Checks
 	bool checkTextures();
+	bool patchIsValid(const CTexture& texture, unsigned index) const;
 
 	// Static
 	static bool setupTextureEntries(Archive* archive);
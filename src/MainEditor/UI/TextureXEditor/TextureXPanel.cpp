@@ -306,8 +306,8 @@ private:
 // -----------------------------------------------------------------------------
 // TextureXListView class constructor
 // -----------------------------------------------------------------------------
-TextureXListView::TextureXListView(wxWindow* parent, TextureXList* texturex) :
-	VirtualListView{ parent }, texturex_{ texturex }
+TextureXListView::TextureXListView(wxWindow* parent, TextureXList* texturex, const TextureXEditor* tx_editor) :
+	VirtualListView{ parent }, texturex_{ texturex }, tx_editor_{ tx_editor }
 {
 	// Add columns
 	InsertColumn(0, "Name");
@@ -367,6 +367,10 @@ void TextureXListView::updateItemAttr(long item, long column, long index) const
 	if (!tex)
 		return;
 
+	// Error colour if the texture has invalid patches
+	if (hasErrors(index))
+		return;
+
 	// Set colour depending on entry state
 	switch (tex->state())
 	{
@@ -376,6 +380,35 @@ void TextureXListView::updateItemAttr(long item, long column, long index) const
 	};
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the texture at [index] has any invalid patches.
+// This is only checked when needed (ie. when the texture's row is shown) and
+// the result is kept until the list is updated or cleared (see clearErrors)
+// -----------------------------------------------------------------------------
+bool TextureXListView::hasErrors(long index) const
+{
+	if (!tx_editor_)
+		return false;
+
+	if (errors_.size() != texturex_->size())
+		errors_.assign(texturex_->size(), ErrorState::Unchecked);
+
+	auto& state = errors_[index];
+	if (state == ErrorState::Unchecked)
+	{
+		auto tex = texturex_->texture(index);
+		state    = ErrorState::Ok;
+		for (unsigned p = 0; p < tex->nPatches(); ++p)
+			if (!tx_editor_->patchIsValid(*tex, p))
+			{
+				state = ErrorState::Error;
+				break;
+			}
+	}
+
+	return state == ErrorState::Error;
+}
+
 // -----------------------------------------------------------------------------
 // Clears the list if [clear] is true, and refreshes it
 // -----------------------------------------------------------------------------
@@ -386,6 +419,7 @@ void TextureXListView::updateList(bool clear)
 
 	// Set list size
 	items_.clear();
+	errors_.clear();
 	if (texturex_)
 	{
 		unsigned count = texturex_->size();
@@ -427,7 +461,7 @@ void TextureXListView::sortItems()
 	if (sort_column_ == 1)
 		std::sort(items_.begin(), items_.end(), &TextureXListView::sizeSort);
 	else
-		std::sort(items_.begin(), items_.end(), &VirtualListView::defaultSort);
+		sortItemsByText();
 }
 
 // -----------------------------------------------------------------------------
@@ -483,6 +517,21 @@ void TextureXListView::applyFilter()
 // Undo Steps
 //
 // -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the (approximate) amount of memory used by a copy of [texture], for
+// undo step memory usage. Textures only hold their definition (not any image
+// data), so this is small
+// -----------------------------------------------------------------------------
+size_t textureMemUsage(const CTexture* texture)
+{
+	if (!texture)
+		return 0;
+
+	return sizeof(CTexture) + texture->patches().size() * sizeof(CTPatchEx);
+}
+} // namespace
 
 class TextureSwapUS : public UndoStep
 {
@@ -555,6 +604,8 @@ public:
 			return createTexture();
 	}
 
+	size_t memUsage() const override { return textureMemUsage(tex_removed_.get()); }
+
 private:
 	TextureXPanel*       tx_panel_ = nullptr;
 	unique_ptr<CTexture> tex_removed_;
@@ -591,8 +642,9 @@ public:
 		return true;
 	}
 
-	bool doUndo() override { return swapData(); }
-	bool doRedo() override { return swapData(); }
+	bool   doUndo() override { return swapData(); }
+	bool   doRedo() override { return swapData(); }
+	size_t memUsage() const override { return textureMemUsage(tex_copy_.get()); }
 
 private:
 	TextureXPanel*       tx_panel_ = nullptr;
@@ -635,7 +687,7 @@ TextureXPanel::TextureXPanel(wxWindow* parent, TextureXEditor& tx_editor) :
 	framesizer->Add(toolbar_, 0, wxEXPAND | wxTOP | wxBOTTOM, ui::px(ui::Size::PadMinimum));
 
 	// Textures list + filter
-	list_textures_    = new TextureXListView(this, &texturex_);
+	list_textures_    = new TextureXListView(this, &texturex_, tx_editor_);
 	text_filter_      = new wxTextCtrl(this, -1);
 	btn_clear_filter_ = new SIconButton(this, "close", "Clear Filter");
 	auto* vbox        = new wxBoxSizer(wxVERTICAL);
@@ -759,6 +811,16 @@ void TextureXPanel::setPalette(Palette* pal) const
 	texture_editor_->setPalette(pal);
 }
 
+// -----------------------------------------------------------------------------
+// Rechecks textures for invalid patches (eg. after the patch table or
+// resources have changed)
+// -----------------------------------------------------------------------------
+void TextureXPanel::refreshTextureErrors() const
+{
+	list_textures_->clearErrors();
+	list_textures_->Refresh();
+}
+
 // -----------------------------------------------------------------------------
 // Applies changes to the current texture, if any
 // -----------------------------------------------------------------------------
@@ -1477,13 +1539,9 @@ void TextureXPanel::exportTexture()
 		if (!gcd.itemModified(a))
 			continue;
 
-		// Get image and conversion info
-		auto image  = gcd.itemImage(a);
-		auto format = gcd.itemFormat(a);
-
 		// Write converted image back to entry
 		MemChunk mc;
-		format->saveImage(*image, mc, force_rgba ? nullptr : gcd.itemPalette(a));
+		gcd.itemData(a, mc);
 		auto lump = std::make_shared<ArchiveEntry>();
 		lump->importMemChunk(mc);
 		lump->rename(selection[a]->name());
@@ -14,10 +14,11 @@ class SToolBar;
 class TextureXListView : public VirtualListView
 {
 public:
-	TextureXListView(wxWindow* parent, TextureXList* texturex);
+	TextureXListView(wxWindow* parent, TextureXList* texturex, const TextureXEditor* tx_editor = nullptr);
 	~TextureXListView() = default;
 
 	TextureXList* txList() const { return texturex_; }
+	void          clearErrors() { errors_.clear(); }
 
 	void        updateList(bool clear = false) override;
 	static bool sizeSort(long left, long right);
@@ -34,7 +35,20 @@ protected:
 	void     updateItemAttr(long item, long column, long index) const override;
 
 private:
-	TextureXList* texturex_;
+	TextureXList*         texturex_;
+	const TextureXEditor* tx_editor_ = nullptr;
+
+	// Whether each texture has invalid patches, checked when its row is
+	// first shown (see hasErrors)
+	enum class ErrorState : uint8_t
+	{
+		Unchecked,
+		Ok,
+		Error
+	};
+	mutable vector<ErrorState> errors_;
+
+	bool hasErrors(long index) const;
 };
 
 class TextureXPanel : public wxPanel, SActionHandler
@@ -54,6 +68,7 @@ public:
 	void setPalette(Palette* pal) const;
 	void applyChanges();
 	void updateTextureList() const { list_textures_->updateList(); }
+	void refreshTextureErrors() const;
 
 	// Texture operations
 	unique_ptr<CTexture> newTextureFromPatch(const wxString& name, const wxString& patch);
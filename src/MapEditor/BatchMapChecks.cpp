@@ -0,0 +1,249 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    BatchMapChecks.cpp
+// Description: Runs map checks on every map in a list of archives without
+//              opening the map editor (for the -checkmaps command line option),
+//              writing the results to stdout
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "BatchMapChecks.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "Game/Configuration.h"
+#include "General/Tasks.h"
+#include "General/Trace.h"
+#include "MapChecks.h"
+#include "SLADEMap/SLADEMap.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// A map to be checked, along with the results of the checks
+struct BatchMap
+{
+	string               archive;
+	Archive::MapDesc     desc;
+	unique_ptr<SLADEMap> map;
+	vector<string>       results;
+};
+
+// -----------------------------------------------------------------------------
+// Returns the standard checks matching [check_ids], or all checks that can be
+// run without the map editor if [check_ids] is empty
+// -----------------------------------------------------------------------------
+vector<MapCheck::StandardCheck> batchChecks(const vector<string>& check_ids)
+{
+	vector<MapCheck::StandardCheck> checks;
+	for (int a = 0; a < MapCheck::NumStandardChecks; ++a)
+	{
+		auto type = static_cast<MapCheck::StandardCheck>(a);
+
+		// Texture checks need the map editor texture manager
+		if (type == MapCheck::UnknownTexture || type == MapCheck::UnknownFlat)
+			continue;
+
+		if (check_ids.empty() || VECTOR_EXISTS(check_ids, MapCheck::standardCheckId(type)))
+			checks.push_back(type);
+	}
+
+	return checks;
+}
+
+// -----------------------------------------------------------------------------
+// Escapes tab and newline characters in [text] so it can be written as a
+// single tab-separated field
+// -----------------------------------------------------------------------------
+string escapeField(string_view text)
+{
+	string escaped;
+	for (auto c : text)
+	{
+		if (c == '\t')
+			escaped += "\\t";
+		else if (c == '\n')
+			escaped += "\\n";
+		else if (c == '\\')
+			escaped += "\\\\";
+		else
+			escaped += c;
+	}
+
+	return escaped;
+}
+
+// -----------------------------------------------------------------------------
+// Runs [checks] on [map], adding a result line for each problem found
+// -----------------------------------------------------------------------------
+void checkMap(BatchMap& map, const vector<MapCheck::StandardCheck>& checks)
+{
+	for (auto type : checks)
+	{
+		auto check = MapCheck::standardCheck(type, map.map.get());
+		TRACE_ZONE("MapCheck", check->progressText());
+		check->doCheck();
+
+		for (unsigned a = 0; a < check->nProblems(); ++a)
+		{
+			auto object = check->getObject(a);
+			map.results.push_back(fmt::format(
+				"problem\t{}\t{}\t{}\t{}\t{}\t{}",
+				escapeField(map.archive),
+				escapeField(map.desc.name),
+				MapCheck::standardCheckId(type),
+				object ? object->typeName() : "",
+				object ? fmt::format("{}", object->index()) : "",
+				escapeField(check->problemDesc(a))));
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Writes an error result line for [archive] (and [map], if given)
+// -----------------------------------------------------------------------------
+void printError(string_view archive, string_view map, string_view message)
+{
+	fmt::print("error\t{}\t{}\t\t\t\t{}\n", escapeField(archive), escapeField(map), escapeField(message));
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MapEditor Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Runs the map checks in [check_ids] (or all applicable checks if empty) on
+// all maps in [archives], using the game configuration [game] and [port] (or
+// the current configuration if empty).
+//
+// Each problem found is written to stdout as a tab-separated line:
+// problem <archive> <map> <check id> <object type> <object index> <description>
+// Errors opening archives or maps are written in the same format, beginning
+// with 'error' instead.
+//
+// Maps are read one at a time, and the checks are run on batches of up to one
+// map per task worker (plus this thread) at once. Returns the process exit code: 0 if no problems
+// were found, 1 if any problems were found or 2 if there were any errors
+// -----------------------------------------------------------------------------
+int mapeditor::runBatchMapChecks(
+	const vector<string>& archives,
+	const vector<string>& check_ids,
+	const string&         game,
+	const string&         port)
+{
+	auto checks = batchChecks(check_ids);
+	if (checks.empty())
+	{
+		printError("", "", "No valid map checks given");
+		return 2;
+	}
+
+	auto config_game = game.empty() ? game::configuration().currentGame() : game;
+	auto config_port = port.empty() ? game::configuration().currentPort() : port;
+	auto batch_size  = tasks::numWorkers() + 1;
+	bool errors      = false;
+	bool problems    = false;
+
+	for (auto& path : archives)
+	{
+		auto archive = app::archiveManager().openArchive(path, true, true);
+		if (!archive)
+		{
+			printError(path, "", global::error);
+			errors = true;
+			continue;
+		}
+
+		// Sort maps by format, so the game configuration only needs to be
+		// reopened when the format changes
+		auto maps = archive->detectMaps();
+		std::stable_sort(
+			maps.begin(),
+			maps.end(),
+			[](const Archive::MapDesc& left, const Archive::MapDesc& right) { return left.format < right.format; });
+
+		for (unsigned start = 0; start < maps.size();)
+		{
+			// Open the game configuration for the map format
+			auto format = maps[start].format;
+			if (!game::configuration().openConfig(config_game, config_port, format))
+			{
+				printError(path, maps[start].name, "Unable to open game configuration");
+				app::archiveManager().closeArchive(archive.get());
+				return 2;
+			}
+
+			// Read the next batch of maps (of the same format)
+			vector<BatchMap> batch;
+			for (; start < maps.size() && batch.size() < batch_size && maps[start].format == format; ++start)
+			{
+				BatchMap bmap{ path, maps[start], std::make_unique<SLADEMap>(), {} };
+				if (!bmap.map->readMap(bmap.desc))
+				{
+					printError(path, bmap.desc.name, global::error);
+					errors = true;
+					continue;
+				}
+
+				batch.push_back(std::move(bmap));
+			}
+
+			// Run the checks on each map in parallel
+			tasks::parallelFor(0, batch.size(), [&](unsigned index) { checkMap(batch[index], checks); });
+
+			// Write results
+			for (auto& bmap : batch)
+			{
+				for (auto& result : bmap.results)
+					fmt::print("{}\n", result);
+
+				if (!bmap.results.empty())
+					problems = true;
+			}
+		}
+
+		app::archiveManager().closeArchive(archive.get());
+	}
+
+	std::fflush(stdout);
+
+	if (errors)
+		return 2;
+
+	return problems ? 1 : 0;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+namespace slade::mapeditor
+{
+int runBatchMapChecks(
+	const vector<string>& archives,
+	const vector<string>& check_ids,
+	const string&         game,
+	const string&         port);
+} // namespace slade::mapeditor
@@ -42,6 +42,30 @@ using namespace slade;
 using mapeditor::ItemType;
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the index of wall [part] (0-2) within a side, for indexing walls by
+// side index * 3 + part. Returns -1 if [part] isn't a wall
+// -----------------------------------------------------------------------------
+int wallPartIndex(ItemType part)
+{
+	switch (part)
+	{
+	case ItemType::WallTop: return 0;
+	case ItemType::WallMiddle: return 1;
+	case ItemType::WallBottom: return 2;
+	default: return -1;
+	}
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // Edit3D Class Functions
@@ -442,14 +466,14 @@ void Edit3D::autoAlignX(mapeditor::Item start) const
 	if (gl_tex)
 		tex_width = gl::Texture::info(gl_tex).size.x;
 
-	// Init aligned wall list
-	vector<mapeditor::Item> walls_done;
+	// Init aligned sides list
+	vector<bool> sides_done(context_.map().nSides(), false);
 
 	// Begin undo level
 	context_.beginUndoRecord("Auto Align X", true, false, false);
 
 	// Do alignment
-	doAlignX(side, side->texOffsetX(), tex, walls_done, tex_width);
+	doAlignX(side, side->texOffsetX(), tex, sides_done, tex_width);
 
 	// End undo level
 	context_.endUndoRecord();
@@ -887,23 +911,8 @@ void Edit3D::floodFill(CopyType type) const
 	// Restrict floodfill to selection, if any
 	if (!selection.empty())
 	{
-		for (unsigned i = 0; i < items.size(); ++i)
-		{
-			bool found = false;
-			for (auto& sel_item : selection)
-			{
-				if (sel_item.type == items[i].type && sel_item.index == items[i].index)
-				{
-					found = true;
-					break;
-				}
-			}
-			if (!found)
-			{
-				items.erase(items.begin() + i);
-				--i;
-			}
-		}
+		auto not_selected = [&selection](const mapeditor::Item& i) { return !selection.isSelected(i); };
+		items.erase(std::remove_if(items.begin(), items.end(), not_selected), items.end());
 	}
 
 	// Begin undo step
@@ -1372,118 +1381,68 @@ bool Edit3D::wallMatches(MapSide* side, ItemType part, string_view tex)
 // -----------------------------------------------------------------------------
 void Edit3D::getAdjacentWalls(mapeditor::Item item, vector<mapeditor::Item>& list) const
 {
-	// Add item to list if needed
-	for (auto& list_item : list)
-	{
-		if (list_item.type == item.type && list_item.index == item.index)
-			return;
-	}
-	list.push_back(item);
-
-	// Get initial side
-	auto side = item.asSide(context_.map());
-	if (!side)
-		return;
+	auto& map = context_.map();
 
-	// Get initial line
-	auto line = side->parentLine();
-	if (!line)
+	// Add item to list
+	auto start = list.size();
+	list.push_back(item);
+	auto part = wallPartIndex(item.type);
+	if (part < 0 || item.index < 0 || static_cast<unsigned>(item.index) >= map.nSides())
 		return;
 
-	// Get texture to match
-	string tex;
-	if (item.type == ItemType::WallBottom)
-		tex = side->texLower();
-	else if (item.type == ItemType::WallMiddle)
-		tex = side->texMiddle();
-	else
-		tex = side->texUpper();
+	// Walls already listed, by side index * 3 + part
+	vector<bool> listed(map.nSides() * 3, false);
+	listed[item.index * 3 + part] = true;
 
-	// Go through attached lines (vertex 1)
-	for (unsigned a = 0; a < line->v1()->nConnectedLines(); a++)
+	// Go through listed walls, adding any matching walls connected to them
+	// (the list is used as the worklist, so this doesn't recurse)
+	for (auto i = start; i < list.size(); ++i)
 	{
-		auto oline = line->v1()->connectedLine(a);
-		if (!oline || oline == line)
-			continue;
-
-		// Get line sides
-		auto side1 = oline->s1();
-		auto side2 = oline->s2();
-
-		// Front side
-		if (side1)
-		{
-			// Upper texture
-			if (wallMatches(side1, ItemType::WallTop, tex))
-				getAdjacentWalls({ (int)side1->index(), ItemType::WallTop }, list);
-
-			// Middle texture
-			if (wallMatches(side1, ItemType::WallMiddle, tex))
-				getAdjacentWalls({ (int)side1->index(), ItemType::WallMiddle }, list);
-
-			// Lower texture
-			if (wallMatches(side1, ItemType::WallBottom, tex))
-				getAdjacentWalls({ (int)side1->index(), ItemType::WallBottom }, list);
-		}
+		auto wall = list[i];
 
-		// Back side
-		if (side2)
-		{
-			// Upper texture
-			if (wallMatches(side2, ItemType::WallTop, tex))
-				getAdjacentWalls({ (int)side2->index(), ItemType::WallTop }, list);
-
-			// Middle texture
-			if (wallMatches(side2, ItemType::WallMiddle, tex))
-				getAdjacentWalls({ (int)side2->index(), ItemType::WallMiddle }, list);
-
-			// Lower texture
-			if (wallMatches(side2, ItemType::WallBottom, tex))
-				getAdjacentWalls({ (int)side2->index(), ItemType::WallBottom }, list);
-		}
-	}
-
-	// Go through attached lines (vertex 2)
-	for (unsigned a = 0; a < line->v2()->nConnectedLines(); a++)
-	{
-		auto oline = line->v2()->connectedLine(a);
-		if (!oline || oline == line)
+		// Get side and line
+		auto side = wall.asSide(map);
+		if (!side)
+			continue;
+		auto line = side->parentLine();
+		if (!line)
 			continue;
 
-		// Get line sides
-		auto side1 = oline->s1();
-		auto side2 = oline->s2();
+		// Get texture to match
+		string tex;
+		if (wall.type == ItemType::WallBottom)
+			tex = side->texLower();
+		else if (wall.type == ItemType::WallMiddle)
+			tex = side->texMiddle();
+		else
+			tex = side->texUpper();
 
-		// Front side
-		if (side1)
+		// Go through lines attached to either vertex
+		for (auto vertex : { line->v1(), line->v2() })
 		{
-			// Upper texture
-			if (wallMatches(side1, ItemType::WallTop, tex))
-				getAdjacentWalls({ (int)side1->index(), ItemType::WallTop }, list);
-
-			// Middle texture
-			if (wallMatches(side1, ItemType::WallMiddle, tex))
-				getAdjacentWalls({ (int)side1->index(), ItemType::WallMiddle }, list);
-
-			// Lower texture
-			if (wallMatches(side1, ItemType::WallBottom, tex))
-				getAdjacentWalls({ (int)side1->index(), ItemType::WallBottom }, list);
-		}
+			for (unsigned a = 0; a < vertex->nConnectedLines(); a++)
+			{
+				auto oline = vertex->connectedLine(a);
+				if (!oline || oline == line)
+					continue;
 
-		// Back side
-		if (side2)
-		{
-			// Upper texture
-			if (wallMatches(side2, ItemType::WallTop, tex))
-				getAdjacentWalls({ (int)side2->index(), ItemType::WallTop }, list);
+				// Check upper, middle and lower textures of both sides
+				for (auto oside : { oline->s1(), oline->s2() })
+				{
+					if (!oside)
+						continue;
 
-			// Middle texture
-			if (wallMatches(side2, ItemType::WallMiddle, tex))
-				getAdjacentWalls({ (int)side2->index(), ItemType::WallMiddle }, list);
+					for (auto opart : { ItemType::WallTop, ItemType::WallMiddle, ItemType::WallBottom })
+					{
+						auto index = oside->index() * 3 + wallPartIndex(opart);
+						if (listed[index] || !wallMatches(oside, opart, tex))
+							continue;
 
-			// Lower texture
-			if (wallMatches(side2, ItemType::WallBottom, tex))
-				getAdjacentWalls({ (int)side2->index(), ItemType::WallBottom }, list);
+						listed[index] = true;
+						list.emplace_back((int)oside->index(), opart);
+					}
+				}
+			}
 		}
 	}
 }
@@ -1498,136 +1457,141 @@ void Edit3D::getAdjacentFlats(mapeditor::Item item, vector<mapeditor::Item>& lis
 	if (item.index < 0 || (item.type != ItemType::Floor && item.type != ItemType::Ceiling))
 		return;
 
+	auto& map = context_.map();
+
 	// Add item
+	auto start = list.size();
 	list.push_back(item);
-
-	// Get initial sector
-	auto sector = item.asSector(context_.map());
-	if (!sector)
+	if (static_cast<unsigned>(item.index) >= map.nSectors())
 		return;
 
-	// Go through sector lines
+	// Flats already listed, by sector index
+	vector<bool> listed(map.nSectors(), false);
+	listed[item.index] = true;
+
+	// Go through listed flats, adding any matching flats adjacent to them
+	// (the list is used as the worklist, so this doesn't recurse)
 	vector<MapLine*> lines;
-	sector->putLines(lines);
-	for (auto& line : lines)
+	for (auto i = start; i < list.size(); ++i)
 	{
-		// Get sector on opposite side
-		auto osector = (line->frontSector() == sector) ? line->backSector() : line->frontSector();
-
-		// Skip if no sector
-		if (!osector || osector == sector)
+		auto sector = list[i].asSector(map);
+		if (!sector)
 			continue;
 
-		// Check for match
-		Plane this_plane, other_plane;
-		if (item.type == ItemType::Floor)
+		// Go through sector lines
+		lines.clear();
+		sector->putLines(lines);
+		for (auto& line : lines)
 		{
-			// Check sector floor texture
-			if (osector->floor().texture != sector->floor().texture)
-				continue;
+			// Get sector on opposite side
+			auto osector = (line->frontSector() == sector) ? line->backSector() : line->frontSector();
 
-			this_plane  = sector->floor().plane;
-			other_plane = osector->floor().plane;
-		}
-		else
-		{
-			// Check sector ceiling texture
-			if (osector->ceiling().texture != sector->ceiling().texture)
+			// Skip if no sector or already listed
+			if (!osector || osector == sector || listed[osector->index()])
 				continue;
 
-			this_plane  = sector->ceiling().plane;
-			other_plane = osector->ceiling().plane;
-		}
+			// Check for match
+			Plane this_plane, other_plane;
+			if (item.type == ItemType::Floor)
+			{
+				// Check sector floor texture
+				if (osector->floor().texture != sector->floor().texture)
+					continue;
+
+				this_plane  = sector->floor().plane;
+				other_plane = osector->floor().plane;
+			}
+			else
+			{
+				// Check sector ceiling texture
+				if (osector->ceiling().texture != sector->ceiling().texture)
+					continue;
 
-		// Check that planes meet
-		auto left  = line->v1()->position();
-		auto right = line->v2()->position();
+				this_plane  = sector->ceiling().plane;
+				other_plane = osector->ceiling().plane;
+			}
 
-		double this_left_z  = this_plane.heightAt(left);
-		double other_left_z = other_plane.heightAt(left);
-		if (fabs(this_left_z - other_left_z) > 1)
-			continue;
+			// Check that planes meet
+			auto left  = line->v1()->position();
+			auto right = line->v2()->position();
 
-		double this_right_z  = this_plane.heightAt(right);
-		double other_right_z = other_plane.heightAt(right);
-		if (fabs(this_right_z - other_right_z) > 1)
-			continue;
+			double this_left_z  = this_plane.heightAt(left);
+			double other_left_z = other_plane.heightAt(left);
+			if (fabs(this_left_z - other_left_z) > 1)
+				continue;
 
-		// Check flat isn't already listed
-		bool listed = false;
-		for (auto& i : list)
-		{
-			if (i.type == item.type && i.index == (int)osector->index())
-			{
-				listed = true;
-				break;
-			}
-		}
+			double this_right_z  = this_plane.heightAt(right);
+			double other_right_z = other_plane.heightAt(right);
+			if (fabs(this_right_z - other_right_z) > 1)
+				continue;
 
-		// Recursively list adjacent flats
-		if (!listed)
-		{
-			list.push_back(item);
-			getAdjacentFlats({ (int)osector->index(), item.type }, list);
+			// Add to list
+			listed[osector->index()] = true;
+			list.emplace_back((int)osector->index(), item.type);
 		}
 	}
 }
 
 // -----------------------------------------------------------------------------
-// Recursive function to align textures on the x axis
+// Aligns textures on the x axis, beginning from [start] at [offset] and
+// continuing along connected sides with [tex]. The sides are walked depth-first
+// (as a recursive walk would), using an explicit stack so long runs of walls
+// can't overflow the call stack
 // -----------------------------------------------------------------------------
-void Edit3D::doAlignX(MapSide* side, int offset, string_view tex, vector<mapeditor::Item>& walls_done, int tex_width)
+void Edit3D::doAlignX(MapSide* start, int offset, string_view tex, vector<bool>& sides_done, int tex_width)
 {
-	// Check if this wall has already been processed
-	for (auto& item : walls_done)
+	// A side being walked from - the offset for sides connected at its 'next'
+	// vertex, and the next connected side to check there
+	struct Step
 	{
-		if (item.index == (int)side->index())
-			return;
-	}
-
-	// Add to 'done' list
-	walls_done.emplace_back((int)side->index(), ItemType::WallMiddle);
-
-	// Wrap offset
-	if (tex_width > 0)
+		MapVertex* vertex;
+		int        offset;
+		unsigned   next;
+	};
+	vector<Step> stack;
+
+	// Aligns [side] to [side_offset] and adds it to the stack
+	auto align = [&](MapSide* side, int side_offset)
 	{
-		while (offset >= tex_width)
-			offset -= tex_width;
-	}
+		sides_done[side->index()] = true;
 
-	// Set offset
-	side->setIntProperty("offsetx", offset);
-
-	// Get 'next' vertex
-	auto line   = side->parentLine();
-	auto vertex = line->v2();
-	if (side == line->s2())
-		vertex = line->v1();
+		// Wrap offset
+		if (tex_width > 0)
+		{
+			while (side_offset >= tex_width)
+				side_offset -= tex_width;
+		}
 
-	// Get integral length of line
-	int intlen = math::round(line->length());
+		// Set offset
+		side->setIntProperty("offsetx", side_offset);
 
-	// Go through connected lines
-	for (unsigned a = 0; a < vertex->nConnectedLines(); a++)
-	{
-		auto l = vertex->connectedLine(a);
+		// Get 'next' vertex
+		auto line   = side->parentLine();
+		auto vertex = line->v2();
+		if (side == line->s2())
+			vertex = line->v1();
 
-		// First side
-		auto s = l->s1();
-		if (s)
-		{
-			// Check for matching texture
-			if (s->texUpper() == tex || s->texMiddle() == tex || s->texLower() == tex)
-				doAlignX(s, offset + intlen, tex, walls_done, tex_width);
-		}
+		// Sides connected there continue from the end of this one
+		stack.push_back({ vertex, side_offset + math::round(line->length()), 0 });
+	};
 
-		// Second side
-		s = l->s2();
-		if (s)
+	align(start, offset);
+	while (!stack.empty())
+	{
+		// Get the next connected side (first and second side of each line)
+		auto& step = stack.back();
+		if (step.next >= step.vertex->nConnectedLines() * 2)
 		{
-			// Check for matching texture
-			if (s->texUpper() == tex || s->texMiddle() == tex || s->texLower() == tex)
-				doAlignX(s, offset + intlen, tex, walls_done, tex_width);
+			stack.pop_back();
+			continue;
 		}
+		auto line = step.vertex->connectedLine(step.next / 2);
+		auto side = step.next % 2 == 0 ? line->s1() : line->s2();
+		step.next++;
+
+		// Align if not already done and it has a matching texture
+		if (side && !sides_done[side->index()]
+			&& (side->texUpper() == tex || side->texMiddle() == tex || side->texLower() == tex))
+			align(side, step.offset);
 	}
 }
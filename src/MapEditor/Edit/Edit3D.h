@@ -74,11 +74,6 @@ private:
 	void        getAdjacentFlats(mapeditor::Item item, vector<mapeditor::Item>& list) const;
 
 	// Helper for autoAlignX3d
-	static void doAlignX(
-		MapSide*                 side,
-		int                      offset,
-		string_view              tex,
-		vector<mapeditor::Item>& walls_done,
-		int                      tex_width);
+	static void doAlignX(MapSide* start, int offset, string_view tex, vector<bool>& sides_done, int tex_width);
 };
 } // namespace slade
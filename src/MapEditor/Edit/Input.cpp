@@ -80,16 +80,40 @@ EXTERN_CVAR(Bool, info_overlay_3d)
 // -----------------------------------------------------------------------------
 Input::Input(MapEditContext& context) : context_{ context } {}
 
+// -----------------------------------------------------------------------------
+// Records mouse movement to [new_x],[new_y] on the map editor view.
+// Movement is coalesced so that only the latest position is handled, once per
+// frame (see MapEditContext::update) or before any other input that depends on
+// the mouse position
+// -----------------------------------------------------------------------------
+void Input::mouseMove(int new_x, int new_y)
+{
+	mouse_pos_pending_  = { new_x, new_y };
+	mouse_move_pending_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Handles the latest mouse movement recorded by mouseMove, if any
+// -----------------------------------------------------------------------------
+void Input::applyMouseMove()
+{
+	if (!mouse_move_pending_)
+		return;
+
+	mouse_move_pending_ = false;
+	handleMouseMove(mouse_pos_pending_.x, mouse_pos_pending_.y);
+}
+
 // -----------------------------------------------------------------------------
 // Handles mouse movement to [new_x],[new_y] on the map editor view
 // -----------------------------------------------------------------------------
-bool Input::mouseMove(int new_x, int new_y)
+void Input::handleMouseMove(int new_x, int new_y)
 {
 	// Check if a full screen overlay is active
 	if (context_.overlayActive())
 	{
 		context_.currentOverlay()->mouseMotion(new_x, new_y);
-		return false;
+		return;
 	}
 
 	// Panning
@@ -161,7 +185,7 @@ bool Input::mouseMove(int new_x, int new_y)
 		else
 			context_.objectEdit().determineState();
 
-		return false;
+		return;
 	}
 
 	// Check if we want to start a selection box
@@ -179,7 +203,6 @@ bool Input::mouseMove(int new_x, int new_y)
 		mouse_state_ = MouseState::Move;
 		mouse_drag_  = DragType::None;
 		context_.moveObjects().begin(mouse_down_pos_map_);
-		context_.renderer().renderer2D().forceUpdate();
 	}
 
 	// Check if we are in thing quick angle state
@@ -189,8 +212,6 @@ bool Input::mouseMove(int new_x, int new_y)
 	// Update shape drawing if needed
 	if (mouse_state_ == MouseState::LineDraw && context_.lineDraw().state() == LineDraw::State::ShapeEdge)
 		context_.lineDraw().updateShape(mouse_pos_map_);
-
-	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -199,6 +220,8 @@ bool Input::mouseMove(int new_x, int new_y)
 // -----------------------------------------------------------------------------
 bool Input::mouseDown(MouseButton button, bool double_click)
 {
+	applyMouseMove();
+
 	// Update hilight
 	if (mouse_state_ == MouseState::Normal)
 		context_.selection().updateHilight(mouse_pos_map_, context_.renderer().view().scale());
@@ -371,6 +394,8 @@ bool Input::mouseDown(MouseButton button, bool double_click)
 // -----------------------------------------------------------------------------
 bool Input::mouseUp(MouseButton button)
 {
+	applyMouseMove();
+
 	// Update mouse variables
 	mouse_button_down_[button] = false;
 
@@ -416,7 +441,6 @@ bool Input::mouseUp(MouseButton button)
 		{
 			context_.moveObjects().end();
 			mouse_state_ = MouseState::Normal;
-			context_.renderer().renderer2D().forceUpdate();
 		}
 
 		// Paste state, cancel paste
@@ -468,6 +492,8 @@ void Input::mouseWheel(bool up, double amount)
 // -----------------------------------------------------------------------------
 void Input::mouseLeave()
 {
+	applyMouseMove();
+
 	// Stop panning
 	if (panning_)
 	{
@@ -511,6 +537,8 @@ bool Input::keyUp(string_view key) const
 // -----------------------------------------------------------------------------
 void Input::onKeyBindPress(string_view name)
 {
+	applyMouseMove();
+
 	// Check if an overlay is active
 	if (context_.overlayActive())
 	{
@@ -565,6 +593,8 @@ void Input::onKeyBindPress(string_view name)
 // -----------------------------------------------------------------------------
 void Input::onKeyBindRelease(string_view name)
 {
+	applyMouseMove();
+
 	if (name == "me2d_pan_view" && panning_)
 	{
 		panning_ = false;
@@ -728,7 +758,6 @@ void Input::handleKeyBind2d(string_view name)
 		{
 			context_.moveObjects().end();
 			mouse_state_ = MouseState::Normal;
-			context_.renderer().renderer2D().forceUpdate();
 		}
 
 		// Accept move
@@ -736,7 +765,6 @@ void Input::handleKeyBind2d(string_view name)
 		{
 			context_.moveObjects().end();
 			mouse_state_ = MouseState::Normal;
-			context_.renderer().renderer2D().forceUpdate();
 		}
 
 		// Cancel move
@@ -744,7 +772,6 @@ void Input::handleKeyBind2d(string_view name)
 		{
 			context_.moveObjects().end(false);
 			mouse_state_ = MouseState::Normal;
-			context_.renderer().renderer2D().forceUpdate();
 		}
 	}
 
@@ -1191,7 +1218,12 @@ bool Input::updateCamera3d(double mult) const
 
 	// Apply gravity to camera if needed
 	if (camera_3d_gravity)
+	{
+		auto z = r3d.camPosition().z;
 		r3d.cameraApplyGravity(mult);
+		if (r3d.camPosition().z != z)
+			moving = true;
+	}
 
 	return moving;
 }
@@ -57,7 +57,8 @@ namespace mapeditor
 
 		// Mouse handling
 		void setMouseState(MouseState state) { mouse_state_ = state; }
-		bool mouseMove(int new_x, int new_y);
+		void mouseMove(int new_x, int new_y);
+		void applyMouseMove();
 		bool mouseDown(MouseButton button, bool double_click = false);
 		bool mouseUp(MouseButton button);
 		void mouseWheel(bool up, double amount);
@@ -87,6 +88,8 @@ namespace mapeditor
 	private:
 		MapEditContext& context_;
 
+		void handleMouseMove(int new_x, int new_y);
+
 		// Mouse
 		MouseState mouse_state_          = MouseState::Normal;
 		bool       mouse_button_down_[5] = { false, false, false, false, false };
@@ -97,6 +100,8 @@ namespace mapeditor
 		DragType   mouse_drag_           = DragType::None;
 		double     mouse_wheel_speed_    = 0;
 		bool       panning_              = false;
+		Vec2i      mouse_pos_pending_    = { 0, 0 }; // Latest mouse position not yet handled (see mouseMove)
+		bool       mouse_move_pending_   = false;
 
 		// Keyboard
 		bool shift_down_ = false;
@@ -33,6 +33,8 @@
 #include "Main.h"
 #include "MoveObjects.h"
 #include "MapEditor/MapEditContext.h"
+#include "MapEditor/Renderer/MapRenderer2D.h"
+#include "MapEditor/Renderer/Renderer.h"
 #include "MapEditor/UndoSteps.h"
 
 using namespace slade;
@@ -108,12 +110,18 @@ bool MoveObjects::begin(Vec2d mouse_pos)
 	}
 	else
 	{
-		// Filter moving lines
+		// Get lines connected to moving vertices
+		moving_lines_.clear();
 		for (auto vertex : move_verts)
-		{
-			for (unsigned l = 0; l < vertex->nConnectedLines(); l++)
-				vertex->connectedLine(l)->filter(true);
-		}
+			moving_lines_.insert(
+				moving_lines_.end(), vertex->connectedLines().begin(), vertex->connectedLines().end());
+		std::sort(moving_lines_.begin(), moving_lines_.end());
+		moving_lines_.erase(std::unique(moving_lines_.begin(), moving_lines_.end()), moving_lines_.end());
+
+		// Filter moving lines (only these need updating in the renderer)
+		for (auto line : moving_lines_)
+			line->filter(true);
+		context_.renderer().renderer2D().updateLinesVBO(moving_lines_);
 	}
 
 	return true;
@@ -154,10 +162,12 @@ void MoveObjects::end(bool accept)
 	using mapeditor::Mode;
 
 	// Un-filter objects
-	for (const auto& line : context_.map().lines())
+	for (auto line : moving_lines_)
 		line->filter(false);
-	for (const auto& thing : context_.map().things())
-		thing->filter(false);
+	for (auto& item : items_)
+		if (auto thing = item.asThing(context_.map()))
+			thing->filter(false);
+	context_.renderer().renderer2D().updateLinesVBO(moving_lines_);
 
 	// Clear selection
 	if (accept && selection_clear_move)
@@ -220,8 +230,20 @@ void MoveObjects::end(bool accept)
 				move_verts[vertex->index()] = 1;
 		}
 
-		// Find moved sectors to move things
-		for (auto& sector : context_.map().sectors())
+		// Find moved sectors to move things (only sectors of lines connected to
+		// moved vertices can have been moved entirely)
+		vector<MapSector*> moved_sectors;
+		for (auto line : moving_lines_)
+		{
+			if (line->frontSector())
+				moved_sectors.push_back(line->frontSector());
+			if (line->backSector())
+				moved_sectors.push_back(line->backSector());
+		}
+		std::sort(moved_sectors.begin(), moved_sectors.end());
+		moved_sectors.erase(std::unique(moved_sectors.begin(), moved_sectors.end()), moved_sectors.end());
+		vector<MapThing*> sector_things;
+		for (auto sector : moved_sectors)
 		{
 			bool allMoved = true;
 			for (auto& side : sector->connectedSides())
@@ -241,7 +263,10 @@ void MoveObjects::end(bool accept)
 			if (!allMoved)
 				continue;
 			// All the vertices are moved, so move its things
-			for (auto& thing : context_.map().things())
+			auto bbox = sector->boundingBox();
+			sector_things.clear();
+			context_.map().things().putAllInArea(bbox.min.x, bbox.min.y, bbox.max.x, bbox.max.y, sector_things);
+			for (auto thing : sector_things)
 			{
 				if (sector->containsPoint(thing->position()))
 					move_things[thing->index()] = 1;
@@ -287,6 +312,7 @@ void MoveObjects::end(bool accept)
 
 	// Clear moving items
 	items_.clear();
+	moving_lines_.clear();
 
 	// Update map item indices
 	// context_.map().refreshIndices();
@@ -24,5 +24,6 @@ private:
 	Vec2d                   offset_;
 	vector<mapeditor::Item> items_;
 	mapeditor::Item         item_closest_ = 0;
+	vector<MapLine*>        moving_lines_; // Lines connected to any moving vertices
 };
 } // namespace slade
@@ -152,7 +152,7 @@ bool ItemSelection::updateHilight(Vec2d mouse_pos, double dist_scale)
 		auto nearest = map.things().multiNearest(mouse_pos);
 		if (nearest.size() == 1)
 		{
-			auto& type = game::configuration().thingType(nearest[0]->type());
+			auto& type = nearest[0]->typeDef();
 			if (math::distance(mouse_pos, nearest[0]->position()) <= type.radius() + (32 / dist_scale))
 				hilight_.index = nearest[0]->index();
 		}
@@ -160,16 +160,16 @@ bool ItemSelection::updateHilight(Vec2d mouse_pos, double dist_scale)
 		{
 			for (auto& t : nearest)
 			{
-				auto& type = game::configuration().thingType(t->type());
+				auto& type = t->typeDef();
 				if (math::distance(mouse_pos, t->position()) <= type.radius() + (32 / dist_scale))
 					hilight_.index = t->index();
 			}
 		}
 	}
 
-	// Update tagged lists if the hilight changed
+	// Update tagged lists if the hilight changed (once it stops changing)
 	if (current != hilight_.index)
-		context_->updateTagged();
+		context_->queueTaggedUpdate();
 
 	// Update map object properties panel if the hilight changed
 	if (current != hilight_.index && selection_.empty())
@@ -189,11 +189,25 @@ bool ItemSelection::updateHilight(Vec2d mouse_pos, double dist_scale)
 	return current != hilight_.index;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if [item] is currently selected
+// -----------------------------------------------------------------------------
+bool ItemSelection::isSelected(const mapeditor::Item& item) const
+{
+	if (!isIndexed(item))
+		return VECTOR_EXISTS(selection_, item);
+
+	auto& selected = selected_[static_cast<unsigned>(item.type)];
+	return static_cast<unsigned>(item.index) < selected.size() && selected[item.index];
+}
+
 // -----------------------------------------------------------------------------
 // Clears the current selection
 // -----------------------------------------------------------------------------
 void ItemSelection::clear()
 {
+	compact();
+
 	// Update change set
 	last_change_.clear();
 	for (auto& item : selection_)
@@ -201,6 +215,8 @@ void ItemSelection::clear()
 
 	// Clear selection
 	selection_.clear();
+	for (auto& selected : selected_)
+		selected.clear();
 
 	if (context_)
 		context_->selectionUpdated();
@@ -217,6 +233,7 @@ void ItemSelection::select(const mapeditor::Item& item, bool select, bool new_ch
 		last_change_.clear();
 
 	selectItem(item, select);
+	compact();
 }
 
 // -----------------------------------------------------------------------------
@@ -231,6 +248,7 @@ void ItemSelection::select(const vector<mapeditor::Item>& items, bool select, bo
 
 	for (auto& item : items)
 		selectItem(item, select);
+	compact();
 }
 
 // -----------------------------------------------------------------------------
@@ -268,6 +286,8 @@ void ItemSelection::selectAll()
 			selectItem({ (int)a, ItemType::Thing });
 	}
 
+	compact();
+
 	context_->addEditorMessage(fmt::format("Selected all {} {}", selection_.size(), context_->modeString()));
 	context_->selectionUpdated();
 }
@@ -315,6 +335,8 @@ void ItemSelection::selectVerticesWithin(const SLADEMap& map, const Rectd& rect)
 	for (unsigned a = 0; a < map.nVertices(); a++)
 		if (rect.contains(map.vertex(a)->position()))
 			selectItem({ (int)a, ItemType::Vertex });
+
+	compact();
 }
 
 // -----------------------------------------------------------------------------
@@ -329,6 +351,8 @@ void ItemSelection::selectLinesWithin(const SLADEMap& map, const Rectd& rect)
 	for (unsigned a = 0; a < map.nLines(); a++)
 		if (rect.contains(map.line(a)->v1()->position()) && rect.contains(map.line(a)->v2()->position()))
 			selectItem({ (int)a, ItemType::Line });
+
+	compact();
 }
 
 // -----------------------------------------------------------------------------
@@ -343,6 +367,8 @@ void ItemSelection::selectSectorsWithin(const SLADEMap& map, const Rectd& rect)
 	for (unsigned a = 0; a < map.nSectors(); a++)
 		if (map.sector(a)->boundingBox().isWithin(rect.tl, rect.br))
 			selectItem({ (int)a, ItemType::Sector });
+
+	compact();
 }
 
 // -----------------------------------------------------------------------------
@@ -357,6 +383,8 @@ void ItemSelection::selectThingsWithin(const SLADEMap& map, const Rectd& rect)
 	for (unsigned a = 0; a < map.nThings(); a++)
 		if (rect.contains(map.thing(a)->position()))
 			selectItem({ (int)a, ItemType::Thing });
+
+	compact();
 }
 
 // -----------------------------------------------------------------------------
@@ -734,6 +762,7 @@ void ItemSelection::migrate(Mode from_edit_mode, Mode to_edit_mode)
 
 	// Apply new selection
 	selection_.assign(new_selection.begin(), new_selection.end());
+	rebuildIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -743,17 +772,83 @@ void ItemSelection::migrate(Mode from_edit_mode, Mode to_edit_mode)
 void ItemSelection::selectItem(const mapeditor::Item& item, bool select)
 {
 	// Check if already selected
-	bool selected = VECTOR_EXISTS(selection_, item);
+	bool selected = isSelected(item);
 
 	// (De)Select and update change set
 	if (select && !selected)
 	{
+		// The item may still be in selection_ if it was deselected earlier in
+		// this operation, so remove any deselected items first
+		if (n_deselected_ > 0)
+			compact();
+
 		selection_.push_back(item);
+		setIndexed(item, true);
 		last_change_[item] = true;
 	}
 	if (!select && selected)
 	{
-		VECTOR_REMOVE(selection_, item);
+		if (isIndexed(item))
+		{
+			setIndexed(item, false);
+			++n_deselected_;
+		}
+		else
+			VECTOR_REMOVE(selection_, item);
+
 		last_change_[item] = false;
 	}
 }
+
+// -----------------------------------------------------------------------------
+// Returns true if the selection state of [item] is kept in the selected_
+// index. This is the case for all items but 3d floor parts (which also need
+// the real index to identify them) and 'any type' items
+// -----------------------------------------------------------------------------
+bool ItemSelection::isIndexed(const mapeditor::Item& item)
+{
+	return item.index >= 0 && item.real_index < 0 && item.type != ItemType::Any;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the selection state of [item] in the selected_ index to [selected]
+// -----------------------------------------------------------------------------
+void ItemSelection::setIndexed(const mapeditor::Item& item, bool selected)
+{
+	if (!isIndexed(item))
+		return;
+
+	auto& list = selected_[static_cast<unsigned>(item.type)];
+	if (static_cast<unsigned>(item.index) >= list.size())
+		list.resize(item.index + 1, false);
+	list[item.index] = selected;
+}
+
+// -----------------------------------------------------------------------------
+// Removes any items that were deselected from the selection list
+// -----------------------------------------------------------------------------
+void ItemSelection::compact()
+{
+	if (n_deselected_ == 0)
+		return;
+
+	selection_.erase(
+		std::remove_if(
+			selection_.begin(), selection_.end(), [this](const mapeditor::Item& item) { return !isSelected(item); }),
+		selection_.end());
+
+	n_deselected_ = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the selected_ index from the selection list
+// -----------------------------------------------------------------------------
+void ItemSelection::rebuildIndex()
+{
+	for (auto& selected : selected_)
+		selected.clear();
+	for (auto& item : selection_)
+		setIndexed(item, true);
+
+	n_deselected_ = 0;
+}
@@ -54,7 +54,7 @@ public:
 
 	bool hasHilight() const { return hilight_.index >= 0; }
 	bool hasHilightOrSelection() const { return !selection_.empty() || hilight_.index >= 0; }
-	bool isSelected(const mapeditor::Item& item) const { return VECTOR_EXISTS(selection_, item); }
+	bool isSelected(const mapeditor::Item& item) const;
 	bool isHilighted(const mapeditor::Item& item) const { return item == hilight_; }
 
 	bool updateHilight(Vec2d mouse_pos, double dist_scale);
@@ -89,12 +89,26 @@ public:
 	// void	selectItem3d(MapEditor::Item item, int sel);
 
 private:
+	static constexpr unsigned N_ITEM_TYPES = static_cast<unsigned>(mapeditor::ItemType::Any);
+
 	mapeditor::Item         hilight_ = { -1, mapeditor::ItemType::Any };
 	vector<mapeditor::Item> selection_;
 	bool                    hilight_lock_ = false;
 	ChangeSet               last_change_;
 	MapEditContext*         context_ = nullptr;
 
+	// Selection state of (plain) items by type and index, so checking if an
+	// item is selected doesn't need to search through selection_.
+	// Deselected items are only flagged here at first, and are removed from
+	// selection_ in one go by compact() at the end of the operation
+	std::array<vector<bool>, N_ITEM_TYPES> selected_;
+	unsigned                               n_deselected_ = 0;
+
+	static bool isIndexed(const mapeditor::Item& item);
+
 	void selectItem(const mapeditor::Item& item, bool select = true);
+	void setIndexed(const mapeditor::Item& item, bool selected);
+	void compact();
+	void rebuildIndex();
 };
 } // namespace slade
@@ -59,79 +59,69 @@ string mb_ignore_entries[] = { "NODES",    "SSECTORS", "ZNODES",  "SEGS",     "R
 
 // -----------------------------------------------------------------------------
 //
-// MapBackupManager Class Functions
+// Local Functions
 //
 // -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [entry] shouldn't be included in map backups
+// -----------------------------------------------------------------------------
+bool isIgnoredEntry(const ArchiveEntry& entry)
+{
+	for (auto& ignore_entry : mb_ignore_entries)
+		if (strutil::equalCI(ignore_entry, entry.name()))
+			return true;
 
+	return false;
+}
 
 // -----------------------------------------------------------------------------
-// Writes a backup for [map_name] in [archive_name], with the map data entries
-// in [map_data]
+// Adds [entries] as a new backup of [map_name] in directory [timestamp] of the
+// backup zip [backup_file]. If [check_same] is true, nothing is written if the
+// last backup in the zip has the same data.
+// This is run on a background thread, the entries are copies that aren't used
+// anywhere else
 // -----------------------------------------------------------------------------
-bool MapBackupManager::writeBackup(
-	vector<unique_ptr<ArchiveEntry>>& map_data,
-	std::string_view                  archive_name,
-	std::string_view                  map_name) const
+bool saveBackup(
+	const string&                     backup_file,
+	const string&                     map_name,
+	const string&                     timestamp,
+	vector<shared_ptr<ArchiveEntry>>& entries,
+	bool                              check_same)
 {
-	// Create backup directory if needed
-	auto backup_dir = app::path("backups", app::Dir::User);
-	if (!wxDirExists(backup_dir))
-		wxMkdir(backup_dir);
-
 	// Open or create backup zip
-	shared_ptr<Archive> backup = std::make_shared<ZipArchive>();
-	string              fname{ archive_name };
-	std::replace(fname.begin(), fname.end(), '.', '_');
-	auto backup_file = fmt::format("{}/{}_backup.zip", backup_dir, fname);
+	auto backup = std::make_shared<ZipArchive>();
 	if (!backup->open(backup_file))
 		backup->setFilename(backup_file);
 
-	// Filter ignored entries
-	vector<ArchiveEntry*> backup_entries;
-	for (auto& entry : map_data)
+	// Compare with last backup (if any)
+	auto        map_dir     = backup->dirAtPath(map_name);
+	ArchiveDir* last_backup = nullptr;
+	if (map_dir && map_dir->numSubdirs() > 0)
+		last_backup = map_dir->subdirAt(map_dir->numSubdirs() - 1).get();
+	if (last_backup && check_same && last_backup->numEntries() == entries.size())
 	{
-		// Check for ignored entry
-		bool ignored = false;
-		for (auto& ignore_entry : mb_ignore_entries)
+		bool same = true;
+		for (unsigned a = 0; a < last_backup->numEntries(); a++)
 		{
-			if (strutil::equalCI(ignore_entry, entry->name()))
+			auto e1 = entries[a].get();
+			auto e2 = last_backup->entryAt(a);
+			if (e1->size() != e2->size())
 			{
-				ignored = true;
+				same = false;
 				break;
 			}
-		}
-
-		if (!ignored)
-			backup_entries.push_back(entry.get());
-	}
 
-	// Compare with last backup (if any)
-	auto map_dir = backup->dirAtPath(map_name);
-	if (map_dir && map_dir->numSubdirs() > 0)
-	{
-		auto last_backup = map_dir->subdirAt(map_dir->numSubdirs() - 1);
-		bool same        = true;
-		if (last_backup->numEntries() != backup_entries.size())
-			same = false;
-		else
-		{
-			for (unsigned a = 0; a < last_backup->numEntries(); a++)
+			// Use the CRC from the zip directory if possible, to avoid
+			// decompressing the last backup
+			auto crc = backup->storedCRC(e2);
+			if (crc == 0 && e2->size() > 0)
+				crc = misc::crc(e2->rawData(), e2->size());
+			if (e1->data().crc() != crc)
 			{
-				auto e1 = backup_entries[a];
-				auto e2 = last_backup->entryAt(a);
-				if (e1->size() != e2->size())
-				{
-					same = false;
-					break;
-				}
-
-				uint32_t crc1 = misc::crc(e1->rawData(), e1->size());
-				uint32_t crc2 = misc::crc(e2->rawData(), e2->size());
-				if (crc1 != crc2)
-				{
-					same = false;
-					break;
-				}
+				same = false;
+				break;
 			}
 		}
 
@@ -142,32 +132,126 @@ bool MapBackupManager::writeBackup(
 		}
 	}
 
-	// Add map data to backup
-	auto timestamp = wxDateTime::Now().FormatISOCombined('_').ToStdString();
-	strutil::replaceIP(timestamp, ":", "");
+	// Add map data to backup.
+	// Entries with the same name as in the last backup are given that entry's
+	// zip index, so if the data is unchanged the (already compressed) data is
+	// copied over from the existing zip rather than compressed again
 	auto dir = fmt::format("{}/{}", map_name, timestamp);
-	for (auto& entry : backup_entries)
-		backup->addEntry(std::make_shared<ArchiveEntry>(*entry), dir);
+	for (unsigned a = 0; a < entries.size(); a++)
+	{
+		auto prev = last_backup && a < last_backup->numEntries() ? last_backup->entryAt(a) : nullptr;
+		if (prev && prev->name() == entries[a]->name() && prev->hasZipIndex())
+			entries[a]->setZipIndex(prev->zipIndex());
+
+		backup->addEntry(entries[a], dir);
+	}
 
 	// Check for max backups & remove old ones if over
 	map_dir = backup->dirAtPath(map_name);
 	while ((int)map_dir->numSubdirs() > max_map_backups)
 		backup->removeDir(map_dir->subdirAt(0)->name(), map_dir);
 
-	// Save backup file
-	Archive::save_backup = false;
-	bool ok              = backup->save();
-	Archive::save_backup = true;
+	// Save backup file (with the filename given so no .bak file is made)
+	return backup->save(backup_file);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MapBackupManager Class Functions
+//
+// -----------------------------------------------------------------------------
+
 
-	return ok;
+// -----------------------------------------------------------------------------
+// Writes a backup for [map_name] in [archive_name], with the map data entries
+// in [map_data].
+// The backup is written on a background thread from a copy of the map data,
+// returns false if it couldn't be started
+// -----------------------------------------------------------------------------
+bool MapBackupManager::writeBackup(
+	vector<unique_ptr<ArchiveEntry>>& map_data,
+	std::string_view                  archive_name,
+	std::string_view                  map_name)
+{
+	// Create backup directory if needed
+	auto backup_dir = app::path("backups", app::Dir::User);
+	if (!wxDirExists(backup_dir))
+		wxMkdir(backup_dir);
+
+	string fname{ archive_name };
+	std::replace(fname.begin(), fname.end(), '.', '_');
+	auto backup_file = fmt::format("{}/{}_backup.zip", backup_dir, fname);
+
+	// Copy (non-ignored) map data to back up
+	vector<shared_ptr<ArchiveEntry>> backup_entries;
+	vector<EntryInfo>                info;
+	for (auto& entry : map_data)
+	{
+		if (isIgnoredEntry(*entry))
+			continue;
+
+		backup_entries.push_back(std::make_shared<ArchiveEntry>(*entry));
+		info.push_back({ entry->name(), entry->size(), entry->data().crc() });
+	}
+
+	// Wait for any backup in progress (they need to be written in order)
+	waitForBackup();
+
+	// Nothing to do if the data is the same as the last backup written for
+	// this map
+	auto key  = fmt::format("{}|{}", backup_file, map_name);
+	auto last = last_backups_.find(key);
+	if (last != last_backups_.end() && sameEntries(info, last->second))
+	{
+		log::info(2, "Same data as previous backup - ignoring");
+		return true;
+	}
+
+	// If we haven't written a backup for this map yet the zip needs to be
+	// checked for an identical last backup instead
+	bool check_same = last == last_backups_.end();
+	last_backups_[key] = std::move(info);
+
+	// Write the backup in the background
+	auto timestamp = wxDateTime::Now().FormatISOCombined('_').ToStdString();
+	strutil::replaceIP(timestamp, ":", "");
+	pending_key_ = key;
+	pending_     = std::async(
+		std::launch::async,
+		[backup_file, map_name = string{ map_name }, timestamp, entries = std::move(backup_entries), check_same]() mutable
+		{ return saveBackup(backup_file, map_name, timestamp, entries, check_same); });
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Waits for the backup currently being written (if any) to finish
+// -----------------------------------------------------------------------------
+void MapBackupManager::waitForBackup()
+{
+	if (!pending_.valid())
+		return;
+
+	if (!pending_.get())
+	{
+		log::warning("Failed to backup map data to \"{}\"", pending_key_.substr(0, pending_key_.find('|')));
+
+		// Make sure the next backup of this map isn't skipped
+		last_backups_.erase(pending_key_);
+	}
 }
 
 // -----------------------------------------------------------------------------
 // Shows the map backups for [map_name] in [archive_name], returns the selected
 // map backup data in a WadArchive
 // -----------------------------------------------------------------------------
-Archive* MapBackupManager::openBackup(string_view archive_name, string_view map_name) const
+Archive* MapBackupManager::openBackup(string_view archive_name, string_view map_name)
 {
+	// Make sure any backup being written is finished first
+	waitForBackup();
+
 	SDialog dlg(mapeditor::windowWx(), fmt::format("Restore {} backup", map_name), "map_backup", 500, 400);
 	auto    sizer = new wxBoxSizer(wxVERTICAL);
 	dlg.SetSizer(sizer);
@@ -191,3 +275,51 @@ Archive* MapBackupManager::openBackup(string_view archive_name, string_view map_
 
 	return nullptr;
 }
+
+
+// -----------------------------------------------------------------------------
+//
+// MapBackupManager Class Static Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns true if the entries in [left] and [right] are the same (same names,
+// sizes and data CRCs, in the same order)
+// -----------------------------------------------------------------------------
+bool MapBackupManager::sameEntries(const vector<EntryInfo>& left, const vector<EntryInfo>& right)
+{
+	return left.size() == right.size()
+		   && std::equal(
+			   left.begin(),
+			   left.end(),
+			   right.begin(),
+			   [](const EntryInfo& e1, const EntryInfo& e2)
+			   { return e1.size == e2.size && e1.crc == e2.crc && e1.name == e2.name; });
+}
+
+// -----------------------------------------------------------------------------
+// Returns the names of entries that were added or changed in [to] or removed
+// since [from], in the order they appear in [to] (removed entries last)
+// -----------------------------------------------------------------------------
+vector<string> MapBackupManager::changedEntries(const vector<EntryInfo>& from, const vector<EntryInfo>& to)
+{
+	auto find = [](const vector<EntryInfo>& entries, const string& name)
+	{
+		return std::find_if(entries.begin(), entries.end(), [&](const EntryInfo& e) { return e.name == name; });
+	};
+
+	vector<string> changed;
+	for (const auto& entry : to)
+	{
+		auto old = find(from, entry.name);
+		if (old == from.end() || old->size != entry.size || old->crc != entry.crc)
+			changed.push_back(entry.name);
+	}
+	for (const auto& entry : from)
+		if (find(to, entry.name) == to.end())
+			changed.push_back(entry.name);
+
+	return changed;
+}
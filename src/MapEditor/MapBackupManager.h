@@ -1,5 +1,7 @@
 #pragma once
 
+#include <future>
+
 namespace slade
 {
 class ArchiveEntry;
@@ -7,10 +9,32 @@ class Archive;
 class MapBackupManager
 {
 public:
+	// Info about an entry in a map backup, used to check if backups differ
+	// without comparing (or loading) their data
+	struct EntryInfo
+	{
+		string   name;
+		uint32_t size;
+		uint32_t crc;
+	};
+
 	MapBackupManager()  = default;
 	~MapBackupManager() = default;
 
-	bool writeBackup(vector<unique_ptr<ArchiveEntry>>& map_data, string_view archive_name, string_view map_name) const;
-	Archive* openBackup(string_view archive_name, string_view map_name) const;
+	bool     writeBackup(vector<unique_ptr<ArchiveEntry>>& map_data, string_view archive_name, string_view map_name);
+	Archive* openBackup(string_view archive_name, string_view map_name);
+	void     waitForBackup();
+
+	static bool           sameEntries(const vector<EntryInfo>& left, const vector<EntryInfo>& right);
+	static vector<string> changedEntries(const vector<EntryInfo>& from, const vector<EntryInfo>& to);
+
+private:
+	// Last backup written for each map (by backup file + map name), used to
+	// check if a new backup is needed without reading the backup file
+	std::map<string, vector<EntryInfo>> last_backups_;
+
+	// Backup currently being written in the background (if any)
+	std::future<bool> pending_;
+	string            pending_key_;
 };
 } // namespace slade
@@ -37,6 +37,7 @@
 #include "MapEditor/MapEditContext.h"
 #include "MapEditor/MapEditor.h"
 #include "MapTextureManager.h"
+#include "SLADEMap/MapObjectList/MapObjectGrid.h"
 #include "SLADEMap/SLADEMap.h"
 #include "UI/Dialogs/MapTextureBrowser.h"
 #include "UI/Dialogs/ThingTypeBrowser.h"
@@ -88,77 +89,92 @@ class MissingTextureCheck : public MapCheck
 public:
 	MissingTextureCheck(SLADEMap* map) : MapCheck(map) {}
 
-	void doCheck() override
+	void checkLine(MapLine* line, NameKey sky_flat)
 	{
-		string sky_flat = game::configuration().skyFlat();
-		for (unsigned a = 0; a < map_->nLines(); a++)
+		// Check what textures the line needs
+		auto side1 = line->s1();
+		auto side2 = line->s2();
+		int  needs = line->needsTexture();
+
+		// Detect if sky hack might apply
+		bool sky_hack = false;
+		if (side1 && side1->sector()->ceiling().texture_key == sky_flat && side2
+			&& side2->sector()->ceiling().texture_key == sky_flat)
+			sky_hack = true;
+
+		// Check for missing textures (front side)
+		if (side1)
 		{
-			// Check what textures the line needs
-			auto line  = map_->line(a);
-			auto side1 = line->s1();
-			auto side2 = line->s2();
-			int  needs = line->needsTexture();
-
-			// Detect if sky hack might apply
-			bool sky_hack = false;
-			if (side1 && strutil::equalCI(sky_flat, side1->sector()->ceiling().texture) && side2
-				&& strutil::equalCI(sky_flat, side2->sector()->ceiling().texture))
-				sky_hack = true;
-
-			// Check for missing textures (front side)
-			if (side1)
+			// Upper
+			if ((needs & MapLine::Part::FrontUpper) > 0 && side1->texUpper() == MapSide::TEX_NONE && !sky_hack)
 			{
-				// Upper
-				if ((needs & MapLine::Part::FrontUpper) > 0 && side1->texUpper() == MapSide::TEX_NONE && !sky_hack)
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::FrontUpper);
-				}
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::FrontUpper);
+			}
 
-				// Middle
-				if ((needs & MapLine::Part::FrontMiddle) > 0 && side1->texMiddle() == MapSide::TEX_NONE)
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::FrontMiddle);
-				}
+			// Middle
+			if ((needs & MapLine::Part::FrontMiddle) > 0 && side1->texMiddle() == MapSide::TEX_NONE)
+			{
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::FrontMiddle);
+			}
 
-				// Lower
-				if ((needs & MapLine::Part::FrontLower) > 0 && side1->texLower() == MapSide::TEX_NONE)
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::FrontLower);
-				}
+			// Lower
+			if ((needs & MapLine::Part::FrontLower) > 0 && side1->texLower() == MapSide::TEX_NONE)
+			{
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::FrontLower);
 			}
+		}
 
-			// Check for missing textures (back side)
-			if (side2)
+		// Check for missing textures (back side)
+		if (side2)
+		{
+			// Upper
+			if ((needs & MapLine::Part::BackUpper) > 0 && side2->texUpper() == MapSide::TEX_NONE && !sky_hack)
 			{
-				// Upper
-				if ((needs & MapLine::Part::BackUpper) > 0 && side2->texUpper() == MapSide::TEX_NONE && !sky_hack)
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::BackUpper);
-				}
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::BackUpper);
+			}
 
-				// Middle
-				if ((needs & MapLine::Part::BackMiddle) > 0 && side2->texMiddle() == MapSide::TEX_NONE)
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::BackMiddle);
-				}
+			// Middle
+			if ((needs & MapLine::Part::BackMiddle) > 0 && side2->texMiddle() == MapSide::TEX_NONE)
+			{
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::BackMiddle);
+			}
 
-				// Lower
-				if ((needs & MapLine::Part::BackLower) > 0 && side2->texLower() == MapSide::TEX_NONE)
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::BackLower);
-				}
+			// Lower
+			if ((needs & MapLine::Part::BackLower) > 0 && side2->texLower() == MapSide::TEX_NONE)
+			{
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::BackLower);
 			}
 		}
+	}
+
+	void doCheck() override
+	{
+		NameKey sky_flat{ game::configuration().skyFlat() };
+		for (unsigned a = 0; a < map_->nLines(); a++)
+			checkLine(map_->line(a), sky_flat);
 
 		log::info(3, "Missing Texture Check: {} missing textures", parts_.size());
 	}
 
+	bool checkObjects(const vector<MapObject*>& objects) override
+	{
+		lines_.clear();
+		parts_.clear();
+
+		NameKey sky_flat{ game::configuration().skyFlat() };
+		for (auto object : objects)
+			if (object->objType() == MapObject::Type::Line)
+				checkLine(dynamic_cast<MapLine*>(object), sky_flat);
+
+		return true;
+	}
+
 	unsigned nProblems() override { return lines_.size(); }
 
 	string texName(int part) const
@@ -495,28 +511,57 @@ public:
 
 	void checkIntersections(vector<MapLine*> lines)
 	{
-		Vec2d    pos;
-		MapLine* line1;
-		MapLine* line2;
+		Vec2d pos;
 
 		// Clear existing intersections
 		intersections_.clear();
 
+		// Add lines to a spatial grid so each line is only compared with lines
+		// near it, and record the position of each line in the list (by index)
+		MapObjectGrid<MapLine> grid;
+		vector<int>            positions;
+		for (unsigned a = 0; a < lines.size(); a++)
+		{
+			auto line = lines[a];
+			grid.insert(line, line->x1(), line->y1(), line->x2(), line->y2());
+
+			if (line->index() >= positions.size())
+				positions.resize(line->index() + 1, -1);
+			positions[line->index()] = a;
+		}
+
 		// Go through lines
+		vector<MapLine*> nearby;
 		for (unsigned a = 0; a < lines.size(); a++)
 		{
-			line1 = lines[a];
+			auto line1 = lines[a];
+
+			// Get lines near line1 (or all lines if it covers a large area)
+			auto& check = grid.query(line1->x1(), line1->y1(), line1->x2(), line1->y2(), nearby) ? nearby : lines;
 
 			// Go through uncompared lines
-			for (unsigned b = a + 1; b < lines.size(); b++)
+			for (auto line2 : check)
 			{
-				line2 = lines[b];
+				if (positions[line2->index()] <= static_cast<int>(a))
+					continue;
 
 				// Check intersection
 				if (line1->intersects(line2, pos))
 					intersections_.emplace_back(line1, line2, pos.x, pos.y);
 			}
 		}
+
+		// Sort intersections in list order (as if every pair of lines was
+		// compared in turn)
+		std::sort(
+			intersections_.begin(),
+			intersections_.end(),
+			[&positions](const Intersection& left, const Intersection& right)
+			{
+				if (left.line1 != right.line1)
+					return positions[left.line1->index()] < positions[right.line1->index()];
+				return positions[left.line2->index()] < positions[right.line2->index()];
+			});
 	}
 
 	void doCheck() override
@@ -603,6 +648,7 @@ public:
 	}
 
 	string progressText() override { return "Checking for intersecting lines..."; }
+	bool   threadSafe() const override { return true; }
 
 	string fixText(unsigned fix_type, unsigned index) override
 	{
@@ -642,22 +688,41 @@ public:
 
 	void doCheck() override
 	{
-		// Go through lines
+		// Sort lines by their vertices (regardless of direction), so lines
+		// sharing both vertices end up next to each other
+		auto vertices = [](const MapLine* line)
+		{
+			auto v1 = line->v1()->index();
+			auto v2 = line->v2()->index();
+			return v1 < v2 ? std::make_pair(v1, v2) : std::make_pair(v2, v1);
+		};
+		vector<MapLine*> lines;
 		for (unsigned a = 0; a < map_->nLines(); a++)
+			lines.push_back(map_->line(a));
+		std::stable_sort(
+			lines.begin(),
+			lines.end(),
+			[&vertices](const MapLine* left, const MapLine* right) { return vertices(left) < vertices(right); });
+
+		// Go through groups of lines sharing both vertices
+		for (unsigned a = 0; a < lines.size(); a++)
 		{
-			auto line1 = map_->line(a);
+			auto line_vertices = vertices(lines[a]);
+			for (unsigned b = a + 1; b < lines.size() && vertices(lines[b]) == line_vertices; b++)
+				overlaps_.emplace_back(lines[a], lines[b]);
+		}
 
-			// Go through uncompared lines
-			for (unsigned b = a + 1; b < map_->nLines(); b++)
+		// Sort overlaps by line index (as if every pair of lines was compared
+		// in turn)
+		std::sort(
+			overlaps_.begin(),
+			overlaps_.end(),
+			[](const Overlap& left, const Overlap& right)
 			{
-				auto line2 = map_->line(b);
-
-				// Check for overlap (both vertices shared)
-				if ((line1->v1() == line2->v1() && line1->v2() == line2->v2())
-					|| (line1->v2() == line2->v1() && line1->v1() == line2->v2()))
-					overlaps_.emplace_back(line1, line2);
-			}
-		}
+				if (left.line1 != right.line1)
+					return left.line1->index() < right.line1->index();
+				return left.line2->index() < right.line2->index();
+			});
 	}
 
 	unsigned nProblems() override { return overlaps_.size(); }
@@ -714,6 +779,7 @@ public:
 	}
 
 	string progressText() override { return "Checking for overlapping lines..."; }
+	bool   threadSafe() const override { return true; }
 
 	string fixText(unsigned fix_type, unsigned index) override
 	{
@@ -749,37 +815,57 @@ public:
 	{
 		double r1, r2;
 
-		// Go through things
+		auto map_format = map_->currentFormat();
+		bool udmf_zdoom =
+			(map_format == MapFormat::UDMF && strutil::equalCI(game::configuration().udmfNamespace(), "zdoom"));
+		bool udmf_eternity =
+			(map_format == MapFormat::UDMF && strutil::equalCI(game::configuration().udmfNamespace(), "eternity"));
+		int min_skill = udmf_zdoom || udmf_eternity ? 1 : 2;
+		int max_skill = udmf_zdoom ? 17 : 5;
+		int max_class = udmf_zdoom ? 17 : 4;
+
+		// Add solid things with a radius to a spatial grid, so each thing is
+		// only compared with things near it
+		MapObjectGrid<MapThing> grid;
+		vector<MapThing*>       check_things;
+		vector<double>          radii(map_->nThings(), -1);
 		for (unsigned a = 0; a < map_->nThings(); a++)
 		{
-			auto  thing1 = map_->thing(a);
-			auto& tt1    = game::configuration().thingType(thing1->type());
-			r1           = tt1.radius() - 1;
+			auto  thing = map_->thing(a);
+			auto& tt    = game::configuration().thingType(thing->type());
+			if (!tt.solid())
+				continue;
 
-			// Ignore if no radius
-			if (r1 < 0 || !tt1.solid())
+			radii[a] = tt.radius() - 1;
+			if (radii[a] < 0)
 				continue;
 
+			grid.insert(
+				thing, thing->xPos() - radii[a], thing->yPos() - radii[a], thing->xPos() + radii[a], thing->yPos() + radii[a]);
+			check_things.push_back(thing);
+		}
+
+		// Go through things
+		vector<MapThing*> nearby;
+		for (auto thing1 : check_things)
+		{
+			auto& tt1 = game::configuration().thingType(thing1->type());
+			r1        = radii[thing1->index()];
+
+			// Get things near thing1 (or all things if it has a huge radius)
+			bool in_grid = grid.query(
+				thing1->xPos() - r1, thing1->yPos() - r1, thing1->xPos() + r1, thing1->yPos() + r1, nearby);
+			auto& check = in_grid ? nearby : check_things;
+
 			// Go through uncompared things
-			auto map_format = map_->currentFormat();
-			bool udmf_zdoom =
-				(map_format == MapFormat::UDMF && strutil::equalCI(game::configuration().udmfNamespace(), "zdoom"));
-			bool udmf_eternity =
-				(map_format == MapFormat::UDMF && strutil::equalCI(game::configuration().udmfNamespace(), "eternity"));
-			int min_skill = udmf_zdoom || udmf_eternity ? 1 : 2;
-			int max_skill = udmf_zdoom ? 17 : 5;
-			int max_class = udmf_zdoom ? 17 : 4;
-
-			for (unsigned b = a + 1; b < map_->nThings(); b++)
+			for (auto thing2 : check)
 			{
-				auto  thing2 = map_->thing(b);
-				auto& tt2    = game::configuration().thingType(thing2->type());
-				r2           = tt2.radius() - 1;
-
-				// Ignore if no radius
-				if (r2 < 0 || !tt2.solid())
+				if (thing2->index() <= thing1->index())
 					continue;
 
+				auto& tt2 = game::configuration().thingType(thing2->type());
+				r2        = radii[thing2->index()];
+
 				// Check flags
 				// Case #1: different skill levels
 				bool shareflag = false;
@@ -950,6 +1036,7 @@ public:
 	}
 
 	string progressText() override { return "Checking for overlapping things..."; }
+	bool   threadSafe() const override { return true; }
 
 	string fixText(unsigned fix_type, unsigned index) override
 	{
@@ -1323,6 +1410,7 @@ public:
 	}
 
 	string progressText() override { return "Checking for unknown thing types..."; }
+	bool   threadSafe() const override { return true; }
 
 	string fixText(unsigned fix_type, unsigned index) override
 	{
@@ -1365,7 +1453,14 @@ public:
 			check_lines.push_back(line);
 		}
 
+		// Add lines to a spatial grid, so each thing is only checked against
+		// lines near it
+		MapObjectGrid<MapLine> grid;
+		for (auto check_line : check_lines)
+			grid.insert(check_line, check_line->x1(), check_line->y1(), check_line->x2(), check_line->y2());
+
 		// Go through things
+		vector<MapLine*> nearby;
 		for (unsigned a = 0; a < map_->nThings(); a++)
 		{
 			auto  thing = map_->thing(a);
@@ -1378,8 +1473,13 @@ public:
 			radius = tt.radius() - 1;
 			Rectf bbox(thing->xPos(), thing->yPos(), radius * 2, radius * 2, 1);
 
+			// Get lines near the thing (or all lines if it has a huge radius)
+			bool in_grid = grid.query(
+				thing->xPos() - radius, thing->yPos() - radius, thing->xPos() + radius, thing->yPos() + radius, nearby);
+			auto& lines = in_grid ? nearby : check_lines;
+
 			// Go through lines
-			for (auto& check_line : check_lines)
+			for (auto& check_line : lines)
 			{
 				line = check_line;
 
@@ -1443,6 +1543,7 @@ public:
 	}
 
 	string progressText() override { return "Checking for things stuck in lines..."; }
+	bool   threadSafe() const override { return true; }
 
 	string fixText(unsigned fix_type, unsigned index) override
 	{
@@ -1490,6 +1591,16 @@ public:
 			checkLine(map_->line(a));
 	}
 
+	bool checkObjects(const vector<MapObject*>& objects) override
+	{
+		invalid_refs_.clear();
+		for (auto object : objects)
+			if (object->objType() == MapObject::Type::Line)
+				checkLine(dynamic_cast<MapLine*>(object));
+
+		return true;
+	}
+
 	unsigned nProblems() override { return invalid_refs_.size(); }
 
 	string problemDesc(unsigned index) override
@@ -1624,6 +1735,18 @@ public:
 		}
 	}
 
+	bool checkObjects(const vector<MapObject*>& objects) override
+	{
+		lines_.clear();
+		for (auto object : objects)
+		{
+			if (object->objType() == MapObject::Type::Line && !dynamic_cast<MapLine*>(object)->s1())
+				lines_.push_back(object->index());
+		}
+
+		return true;
+	}
+
 	unsigned nProblems() override { return lines_.size(); }
 
 	string problemDesc(unsigned index) override
@@ -1693,6 +1816,7 @@ public:
 	}
 
 	string progressText() override { return "Checking for invalid lines..."; }
+	bool   threadSafe() const override { return true; }
 
 	string fixText(unsigned fix_type, unsigned index) override
 	{
@@ -1802,31 +1926,56 @@ class UnknownSpecialCheck : public MapCheck
 public:
 	UnknownSpecialCheck(SLADEMap* map) : MapCheck(map) {}
 
+	void checkLine(MapLine* line)
+	{
+		if (game::configuration().actionSpecialName(line->special()) == "Unknown")
+			objects_.push_back(line);
+	}
+
+	void checkThing(MapThing* thing)
+	{
+		// Ignore the Heresiarch which does not have a real special
+		auto& tt = game::configuration().thingType(thing->type());
+		if (tt.flags() & game::ThingType::Flags::Script)
+			return;
+
+		// Otherwise, check special
+		if (game::configuration().actionSpecialName(thing->special()) == "Unknown")
+			objects_.push_back(thing);
+	}
+
+	bool thingSpecials() const
+	{
+		return map_->currentFormat() == MapFormat::Hexen || map_->currentFormat() == MapFormat::UDMF;
+	}
+
 	void doCheck() override
 	{
 		// Go through map lines
 		objects_.clear();
 		for (unsigned a = 0; a < map_->nLines(); ++a)
-		{
-			int special = map_->line(a)->special();
-			if (game::configuration().actionSpecialName(special) == "Unknown")
-				objects_.push_back(map_->line(a));
-		}
+			checkLine(map_->line(a));
+
 		// In Hexen or UDMF, go through map things too since they too can have specials
-		if (map_->currentFormat() == MapFormat::Hexen || map_->currentFormat() == MapFormat::UDMF)
+		if (thingSpecials())
 		{
 			for (unsigned a = 0; a < map_->nThings(); ++a)
-			{
-				// Ignore the Heresiarch which does not have a real special
-				auto& tt = game::configuration().thingType(map_->thing(a)->type());
-				if (tt.flags() & game::ThingType::Flags::Script)
-					continue;
+				checkThing(map_->thing(a));
+		}
+	}
 
-				// Otherwise, check special
-				if (game::configuration().actionSpecialName(map_->thing(a)->special()) == "Unknown")
-					objects_.push_back(map_->thing(a));
-			}
+	bool checkObjects(const vector<MapObject*>& objects) override
+	{
+		objects_.clear();
+		for (auto object : objects)
+		{
+			if (object->objType() == MapObject::Type::Line)
+				checkLine(dynamic_cast<MapLine*>(object));
+			else if (object->objType() == MapObject::Type::Thing && thingSpecials())
+				checkThing(dynamic_cast<MapThing*>(object));
 		}
+
+		return true;
 	}
 
 	unsigned nProblems() override { return objects_.size(); }
@@ -42,6 +42,14 @@ public:
 	virtual string     progressText() { return "Checking..."; }
 	virtual string     fixText(unsigned fix_type, unsigned index) { return ""; }
 
+	// Returns true if the check only reads map data (and nothing with lazily
+	// updated state), so it can safely be run alongside other checks
+	virtual bool threadSafe() const { return false; }
+
+	// Checks only [objects] rather than the whole map, replacing any previous
+	// results. Returns false if the check doesn't support this
+	virtual bool checkObjects(const vector<MapObject*>& objects) { return false; }
+
 	static unique_ptr<MapCheck> standardCheck(StandardCheck type, SLADEMap* map, MapTextureManager* texman = nullptr);
 	static unique_ptr<MapCheck> standardCheck(string_view type_id, SLADEMap* map, MapTextureManager* texman = nullptr);
 	static string               standardCheckDesc(StandardCheck type);
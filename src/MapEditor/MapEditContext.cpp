@@ -35,8 +35,12 @@
 #include "MapEditContext.h"
 #include "App.h"
 #include "Game/Configuration.h"
+#include "Game/Game.h"
 #include "General/Clipboard.h"
 #include "General/Console.h"
+#include "General/Tasks.h"
+#include "General/Trace.h"
+#include "General/UI.h"
 #include "General/UndoRedo.h"
 #include "MapChecks.h"
 #include "MapEditor/Renderer/Overlays/InfoOverlay3d.h"
@@ -51,6 +55,7 @@
 #include "UI/MapEditorWindow.h"
 #include "UndoSteps.h"
 #include "Utility/StringUtils.h"
+#include <unordered_set>
 
 using namespace slade;
 
@@ -80,6 +85,8 @@ CVAR(Bool, hilight_smooth, true, CVar::Flag::Save)
 // -----------------------------------------------------------------------------
 EXTERN_CVAR(Int, flat_drawtype)
 EXTERN_CVAR(Bool, thing_preview_lights)
+EXTERN_CVAR(Bool, map_animate_hilight)
+EXTERN_CVAR(Bool, map_showfps)
 
 
 // -----------------------------------------------------------------------------
@@ -89,6 +96,40 @@ EXTERN_CVAR(Bool, thing_preview_lights)
 // -----------------------------------------------------------------------------
 
 
+namespace
+{
+// -----------------------------------------------------------------------------
+// Logs the time taken by map open stage [name], started at [start]
+// -----------------------------------------------------------------------------
+void logOpenStage(string_view name, long start)
+{
+	log::info("Map open stage: {} took {}ms", name, app::runTimer() - start);
+}
+
+// -----------------------------------------------------------------------------
+// Returns a list of all (unique) wall texture names used by sides in [map]
+// -----------------------------------------------------------------------------
+vector<string> mapTextureNames(const SLADEMap& map)
+{
+	vector<string>             names;
+	std::unordered_set<string> seen;
+	auto                       add = [&](const string& name)
+	{
+		if (!name.empty() && name != MapSide::TEX_NONE && seen.insert(name).second)
+			names.push_back(name);
+	};
+
+	for (auto* side : map.sides())
+	{
+		add(side->texUpper());
+		add(side->texMiddle());
+		add(side->texLower());
+	}
+
+	return names;
+}
+} // namespace
+
 // -----------------------------------------------------------------------------
 // Template function to find something in an associative map.
 // M::mapped_type should be default constructible, or just provide
@@ -298,16 +339,40 @@ bool MapEditContext::update(long frametime)
 	if (frametime < next_frame_length_)
 		return false;
 
+	// Handle the latest mouse movement since the last update
+	input_.applyMouseMove();
+
+	// Don't count any time spent idle as frame time (otherwise camera movement
+	// and animations would jump ahead)
+	if (idle_)
+		frametime = std::min<long>(frametime, 10);
+
 	// Get frame time multiplier
 	double mult = (double)frametime / 10.0f;
 
-	// 3d mode
+	// Update 3d camera
+	bool camera_moved = false;
 	if (edit_mode_ == Mode::Visual && !overlayActive())
 	{
-		// Update camera
-		if (input_.updateCamera3d(mult))
+		camera_moved = input_.updateCamera3d(mult);
+		if (camera_moved)
 			next_frame_length_ = 2;
+	}
 
+	// Nothing to update or redraw if nothing has changed since the last update
+	if (!camera_moved && !redrawNeeded())
+	{
+		idle_ = true;
+		return false;
+	}
+	idle_              = false;
+	redraw_            = false;
+	last_update_state_ = currentUpdateState();
+	last_update_time_  = app::runTimer();
+
+	// 3d mode
+	if (edit_mode_ == Mode::Visual && !overlayActive())
+	{
 		// Update status bar
 		auto pos = renderer_.renderer3D().camPosition();
 		mapeditor::setStatusText(fmt::format("Position: ({}, {}, {})", (int)pos.x, (int)pos.y, (int)pos.z), 3);
@@ -351,6 +416,10 @@ bool MapEditContext::update(long frametime)
 		if (input_.mouseState() == mapeditor::Input::MouseState::Move)
 			move_objects_.update(input_.mousePosMap());
 
+		// Re-check anything modified for live map checks
+		if (input_.mouseState() == mapeditor::Input::MouseState::Normal)
+			validator_.update();
+
 		// Check if we have to update the info overlay
 		if (selection_.hilight() != prev_hl)
 		{
@@ -358,6 +427,10 @@ bool MapEditContext::update(long frametime)
 			updateInfoOverlay();
 			info_showing_ = selection_.hasHilight();
 		}
+
+		// Update tagged lists once the hilight has been the same for a frame
+		else if (tagged_update_pending_)
+			updateTagged();
 	}
 
 	// Update overlay animation (if active)
@@ -370,14 +443,118 @@ bool MapEditContext::update(long frametime)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if this update state is the same as [other]
+// -----------------------------------------------------------------------------
+bool MapEditContext::UpdateState::operator==(const UpdateState& other) const
+{
+	return edit_mode == other.edit_mode && sector_mode == other.sector_mode && grid_size == other.grid_size
+		   && n_selected == other.n_selected && n_messages == other.n_messages && hilight == other.hilight
+		   && mouse_locked == other.mouse_locked;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the current editor state (that affects what is drawn)
+// -----------------------------------------------------------------------------
+MapEditContext::UpdateState MapEditContext::currentUpdateState() const
+{
+	return { edit_mode_,
+			 sector_mode_,
+			 grid_size_,
+			 selection_.size(),
+			 static_cast<unsigned>(editor_messages_.size()),
+			 selection_.hilight(),
+			 mouse_locked_ };
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if anything has changed since the last update that requires
+// the canvas to be updated and redrawn: input, map modifications, animations
+// or other changes to the editor state
+// -----------------------------------------------------------------------------
+bool MapEditContext::redrawNeeded() const
+{
+	// Redraw requested (eg. by input) or always redrawing
+	if (redraw_ || map_showfps)
+		return true;
+
+	// 3d geometry still being built
+	if (edit_mode_ == Mode::Visual && renderer_.renderer3D().updatesPending())
+		return true;
+
+	// Animations or overlays active
+	if (renderer_.animationsActive() || overlayActive() || (selection_.hasHilight() && map_animate_hilight))
+		return true;
+
+	// Map modified
+	if (map_.mapData().lastModifiedTime() > last_update_time_ || map_.geometryUpdated() > last_update_time_
+		|| map_.thingsUpdated() > last_update_time_)
+		return true;
+
+	// Tagged lists waiting for the 2d hilight to settle
+	if (tagged_update_pending_ && edit_mode_ != Mode::Visual)
+		return true;
+
+	// Editor messages fading out
+	for (const auto& msg : editor_messages_)
+		if (app::runTimer() - msg.act_time <= 2000)
+			return true;
+
+	// Editor state changed
+	return !(currentUpdateState() == last_update_state_);
+}
+
 // -----------------------------------------------------------------------------
 // Opens [map]
 // -----------------------------------------------------------------------------
 bool MapEditContext::openMap(Archive::MapDesc map)
 {
 	log::info("Opening map {}", map.name);
+	auto open_start  = app::runTimer();
+	auto stage_start = open_start;
+
+	// Read core map geometry, everything else depends on it
 	if (!map_.readMap(map))
 		return false;
+	logOpenStage("Read map", stage_start);
+
+	// Build sector polygons in the background while the stages below run on
+	// this thread. They only read the map geometry, which doesn't change until
+	// the map is opened
+	long poly_time = 0;
+	auto polygons  = tasks::run(
+		[this, &poly_time](const tasks::Task& task)
+		{
+			auto start = app::runTimer();
+			tasks::parallelFor(
+				0, map_.nSectors(), [this](unsigned index) { map_.sector(index)->polygon(); }, 16, &task);
+			poly_time = app::runTimer() - start;
+		},
+		tasks::Priority::High);
+
+	// Queue background composition of textures used by the map, so they are
+	// (mostly) ready by the time they are first rendered
+	ui::setSplashProgressMessage("Loading textures");
+	stage_start = app::runTimer();
+	auto n_tex  = mapeditor::textureManager().prefetchTextures(mapTextureNames(map_));
+	logOpenStage(fmt::format("Queued {} textures", n_tex), stage_start);
+
+	// Update DECORATE, ZScript and *MAPINFO definitions
+	ui::setSplashProgressMessage("Loading definitions");
+	stage_start = app::runTimer();
+	game::updateCustomDefinitions();
+	logOpenStage("Custom definitions", stage_start);
+
+	// Process specials
+	ui::setSplashProgressMessage("Processing specials");
+	stage_start = app::runTimer();
+	map_.mapSpecials()->processMapSpecials(&(map_));
+	logOpenStage("Map specials", stage_start);
+
+	// Polygons must be done before anything can render
+	ui::setSplashProgressMessage("Building sectors");
+	polygons.wait();
+	log::info("Map open stage: Sector polygons took {}ms (in background)", poly_time);
 
 	// Find camera thing
 	if (canvas_)
@@ -411,8 +588,10 @@ bool MapEditContext::openMap(Archive::MapDesc map)
 	updateStatusText();
 	updateThingLists();
 
-	// Process specials
-	map_.mapSpecials()->processMapSpecials(&(map_));
+	// Check everything again for live map checks
+	validator_.reset();
+
+	log::info("Opened map {} in {}ms", map.name, app::runTimer() - open_start);
 
 	return true;
 }
@@ -437,10 +616,33 @@ void MapEditContext::clearMap()
 
 	// Clear other data
 	updateTagged();
+	info_vertex_.reset();
+	info_line_.reset();
+	info_sector_.reset();
+	info_thing_.reset();
 	info_3d_.reset();
 
 	// Clear map
 	map_.clearMap();
+	validator_.reset();
+}
+
+// -----------------------------------------------------------------------------
+// Reorders the map's vertices, lines and sides spatially (see
+// MapObjectCollection::optimiseOrder), as an undoable operation
+// -----------------------------------------------------------------------------
+void MapEditContext::optimiseMapOrder()
+{
+	// Object indices are about to change
+	selection_.clear();
+	selection_.clearHilight();
+
+	beginUndoRecord("Optimise Map Order", false, true, true);
+	map_.optimiseOrder();
+	map_.setGeometryUpdated();
+	endUndoRecord(true);
+
+	addEditorMessage("Optimised map object order");
 }
 
 // -----------------------------------------------------------------------------
@@ -539,6 +741,7 @@ void MapEditContext::forceRefreshRenderer()
 		return;
 
 	renderer_.forceUpdate();
+	redraw_ = true;
 }
 
 // -----------------------------------------------------------------------------
@@ -548,6 +751,8 @@ void MapEditContext::updateTagged()
 {
 	using game::TagType;
 
+	tagged_update_pending_ = false;
+
 	// Clear tagged lists
 	tagged_sectors_.clear();
 	tagged_lines_.clear();
@@ -756,8 +961,7 @@ void MapEditContext::updateTagged()
 void MapEditContext::selectionUpdated()
 {
 	// Open selected objects in properties panel
-	auto selected = selection_.selectedObjects();
-	mapeditor::openMultiObjectProperties(selected);
+	queuePropsPanelUpdate();
 
 	last_undo_level_ = "";
 
@@ -1262,6 +1466,30 @@ bool MapEditContext::handleKeyBind(string_view key, Vec2d position)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Queues an update of the map object properties panel from the current
+// selection. The update happens once the current event has been handled, so
+// many selection changes in a row (eg. box selecting or undo) only reopen the
+// selected objects in the panel once
+// -----------------------------------------------------------------------------
+void MapEditContext::queuePropsPanelUpdate()
+{
+	if (props_update_queued_)
+		return;
+
+	props_update_queued_ = true;
+	wxTheApp->CallAfter(
+		[]()
+		{
+			// Get the selection at the time of the update, since objects may
+			// have been deleted since it was queued
+			auto& context                = mapeditor::editContext();
+			context.props_update_queued_ = false;
+			auto selected                = context.selection_.selectedObjects();
+			mapeditor::openMultiObjectProperties(selected);
+		});
+}
+
 // -----------------------------------------------------------------------------
 // Updates the map object properties panel and current info overlay from the
 // current hilight/selection
@@ -1269,8 +1497,7 @@ bool MapEditContext::handleKeyBind(string_view key, Vec2d position)
 void MapEditContext::updateDisplay()
 {
 	// Update map object properties panel
-	auto selection = selection_.selectedObjects();
-	mapeditor::openMultiObjectProperties(selection);
+	queuePropsPanelUpdate();
 
 	// Update canvas info overlay
 	if (canvas_)
@@ -1441,6 +1668,7 @@ void MapEditContext::doUndo()
 		map_.rebuildConnectedSides();
 		map_.setGeometryUpdated();
 		map_.updateGeometryInfo(time);
+		validator_.reset(); // Restored objects aren't necessarily modified
 		last_undo_level_ = "";
 	}
 	updateThingLists();
@@ -1475,6 +1703,7 @@ void MapEditContext::doRedo()
 		map_.rebuildConnectedSides();
 		map_.setGeometryUpdated();
 		map_.updateGeometryInfo(time);
+		validator_.reset(); // Restored objects aren't necessarily modified
 		last_undo_level_ = "";
 	}
 	updateThingLists();
@@ -1654,6 +1883,9 @@ bool MapEditContext::handleAction(string_view id)
 	if (!canvas_->IsShown())
 		return false;
 
+	// Any action may change what is displayed
+	redraw_ = true;
+
 	// Skip if overlay is active
 	if (overlayActive())
 		return false;
@@ -1753,6 +1985,13 @@ bool MapEditContext::handleAction(string_view id)
 		addEditorMessage("Selection cleared");
 	}
 
+	// Optimise map object order
+	else if (id == "mapw_optimise_order" && mouse_state == Input::MouseState::Normal)
+	{
+		optimiseMapOrder();
+		return true;
+	}
+
 	// Begin line drawing
 	else if (id == "mapw_draw_lines" && mouse_state == Input::MouseState::Normal)
 	{
@@ -2051,35 +2290,59 @@ bool MapEditContext::handleAction(string_view id)
 
 
 // -----------------------------------------------------------------------------
-// Copies [lines] and all related map structures
+// Copies [lines] and all related map structures. Lines listed more than once
+// are only copied once
 // -----------------------------------------------------------------------------
 void MapArchClipboardItem::addLines(const vector<MapLine*>& lines)
 {
-	// Get sectors and sides to copy
-	vector<MapSector*> copy_sectors;
-	vector<MapSide*>   copy_sides;
+	// Get lines, sides, sectors and vertices to copy, indexing each
+	vector<MapLine*>                    copy_lines;
+	vector<MapSide*>                    copy_sides;
+	vector<MapSector*>                  copy_sectors;
+	vector<MapVertex*>                  copy_verts;
+	std::unordered_map<MapLine*, int>   line_index;
+	std::unordered_map<MapSide*, int>   side_index;
+	std::unordered_map<MapSector*, int> sector_index;
+	std::unordered_map<MapVertex*, int> vertex_index;
+	double                              min_x = 9999999;
+	double                              max_x = -9999999;
+	double                              min_y = 9999999;
+	double                              max_y = -9999999;
 	for (auto line : lines)
 	{
-		auto s1 = line->s1();
-		auto s2 = line->s2();
+		if (!line_index.emplace(line, copy_lines.size()).second)
+			continue;
+		copy_lines.push_back(line);
 
-		// Front side
-		if (s1)
+		// Sides (and their sectors)
+		for (auto side : { line->s1(), line->s2() })
 		{
-			copy_sides.push_back(s1);
-			if (std::find(copy_sectors.begin(), copy_sectors.end(), s1->sector()) == copy_sectors.end())
-				copy_sectors.push_back(s1->sector());
+			if (!side || !side_index.emplace(side, copy_sides.size()).second)
+				continue;
+			copy_sides.push_back(side);
+
+			if (sector_index.emplace(side->sector(), copy_sectors.size()).second)
+				copy_sectors.push_back(side->sector());
 		}
 
-		// Back side
-		if (s2)
+		// Vertices (and min/max)
+		for (auto vertex : { line->v1(), line->v2() })
 		{
-			copy_sides.push_back(s2);
-			if (std::find(copy_sectors.begin(), copy_sectors.end(), s2->sector()) == copy_sectors.end())
-				copy_sectors.push_back(s2->sector());
+			if (vertex_index.emplace(vertex, copy_verts.size()).second)
+				copy_verts.push_back(vertex);
+
+			min_x = std::min(min_x, vertex->xPos());
+			max_x = std::max(max_x, vertex->xPos());
+			min_y = std::min(min_y, vertex->yPos());
+			max_y = std::max(max_y, vertex->yPos());
 		}
 	}
 
+	// Determine midpoint
+	double mid_x = min_x + ((max_x - min_x) * 0.5);
+	double mid_y = min_y + ((max_y - min_y) * 0.5);
+	midpoint_.set(mid_x, mid_y);
+
 	// Copy sectors
 	for (auto& sector : copy_sectors)
 	{
@@ -2091,63 +2354,14 @@ void MapArchClipboardItem::addLines(const vector<MapLine*>& lines)
 	// Copy sides
 	for (auto& side : copy_sides)
 	{
-		auto copy = std::make_unique<MapSide>();
+		auto sector = sector_index[side->sector()];
+		auto copy   = std::make_unique<MapSide>();
 		copy->copy(side);
-
-		// Set relative sector
-		for (unsigned b = 0; b < copy_sectors.size(); b++)
-		{
-			if (side->sector() == copy_sectors[b])
-			{
-				copy->setSector(sectors_[b].get());
-				break;
-			}
-		}
-
+		copy->setSector(sectors_[sector].get());
 		sides_.push_back(std::move(copy));
+		side_sectors_.push_back(sector);
 	}
 
-	// Get vertices to copy (and determine midpoint)
-	double             min_x = 9999999;
-	double             max_x = -9999999;
-	double             min_y = 9999999;
-	double             max_y = -9999999;
-	vector<MapVertex*> copy_verts;
-	for (auto line : lines)
-	{
-		auto v1 = line->v1();
-		auto v2 = line->v2();
-
-		// Add vertices to copy list
-		if (std::find(copy_verts.begin(), copy_verts.end(), v1) == copy_verts.end())
-			copy_verts.push_back(v1);
-		if (std::find(copy_verts.begin(), copy_verts.end(), v2) == copy_verts.end())
-			copy_verts.push_back(v2);
-
-		// Update min/max
-		if (v1->xPos() < min_x)
-			min_x = v1->xPos();
-		if (v1->xPos() > max_x)
-			max_x = v1->xPos();
-		if (v1->yPos() < min_y)
-			min_y = v1->yPos();
-		if (v1->yPos() > max_y)
-			max_y = v1->yPos();
-		if (v2->xPos() < min_x)
-			min_x = v2->xPos();
-		if (v2->xPos() > max_x)
-			max_x = v2->xPos();
-		if (v2->yPos() < min_y)
-			min_y = v2->yPos();
-		if (v2->yPos() > max_y)
-			max_y = v2->yPos();
-	}
-
-	// Determine midpoint
-	double mid_x = min_x + ((max_x - min_x) * 0.5);
-	double mid_y = min_y + ((max_y - min_y) * 0.5);
-	midpoint_.set(mid_x, mid_y);
-
 	// Copy vertices
 	for (auto& vertex : copy_verts)
 	{
@@ -2157,48 +2371,21 @@ void MapArchClipboardItem::addLines(const vector<MapLine*>& lines)
 	}
 
 	// Copy lines
-	for (auto line : lines)
-	{
-		// Get relative sides
-		MapSide* s1       = nullptr;
-		MapSide* s2       = nullptr;
-		bool     s1_found = false;
-		bool     s2_found = !(line->s2());
-		for (unsigned i = 0; i < copy_sides.size(); i++)
-		{
-			if (line->s1() == copy_sides[i])
-			{
-				s1       = sides_[i].get();
-				s1_found = true;
-			}
-			if (line->s2() == copy_sides[i])
-			{
-				s2       = sides_[i].get();
-				s2_found = true;
-			}
-
-			if (s1_found && s2_found)
-				break;
-		}
-
-		// Get relative vertices
-		MapVertex* v1 = nullptr;
-		MapVertex* v2 = nullptr;
-		for (unsigned i = 0; i < copy_verts.size(); i++)
-		{
-			if (line->v1() == copy_verts[i])
-				v1 = vertices_[i].get();
-			if (line->v2() == copy_verts[i])
-				v2 = vertices_[i].get();
-
-			if (v1 && v2)
-				break;
-		}
-
-		// Copy line
-		auto copy = std::make_unique<MapLine>(v1, v2, s1, s2);
+	for (auto line : copy_lines)
+	{
+		LineRefs refs{ static_cast<unsigned>(vertex_index[line->v1()]),
+					   static_cast<unsigned>(vertex_index[line->v2()]),
+					   findInMap(side_index, line->s1(), -1),
+					   findInMap(side_index, line->s2(), -1) };
+
+		auto copy = std::make_unique<MapLine>(
+			vertices_[refs.v1].get(),
+			vertices_[refs.v2].get(),
+			refs.s1 >= 0 ? sides_[refs.s1].get() : nullptr,
+			refs.s2 >= 0 ? sides_[refs.s2].get() : nullptr);
 		copy->copy(line);
 		lines_.push_back(std::move(copy));
+		line_refs_.push_back(refs);
 	}
 }
 
@@ -2220,65 +2407,50 @@ string MapArchClipboardItem::info() const
 // -----------------------------------------------------------------------------
 vector<MapVertex*> MapArchClipboardItem::pasteToMap(SLADEMap* map, Vec2d position)
 {
-	std::map<MapVertex*, MapVertex*> vertMap;
-	std::map<MapSector*, MapSector*> sectMap;
-	std::map<MapSide*, MapSide*>     sideMap;
-	// Not used yet...
-	// std::map<MapLine*, MapLine*> lineMap;
+	// Reserve space for everything up front
+	map->reserve(MapObject::Type::Vertex, vertices_.size());
+	map->reserve(MapObject::Type::Sector, sectors_.size());
+	map->reserve(MapObject::Type::Side, sides_.size());
+	map->reserve(MapObject::Type::Line, lines_.size());
 
 	// Add vertices
 	vector<MapVertex*> new_verts;
+	new_verts.reserve(vertices_.size());
 	for (auto& vertex : vertices_)
 	{
 		new_verts.push_back(map->createVertex(position + vertex->position()));
 		new_verts.back()->copy(vertex.get());
-		vertMap[vertex.get()] = new_verts.back();
 	}
 
 	// Add sectors
+	vector<MapSector*> new_sectors;
+	new_sectors.reserve(sectors_.size());
 	for (auto& sector : sectors_)
 	{
-		auto new_sector = map->createSector();
-		new_sector->copy(sector.get());
-		sectMap[sector.get()] = new_sector;
+		new_sectors.push_back(map->createSector());
+		new_sectors.back()->copy(sector.get());
 	}
 
 	// Add sides
-	// int first_new_side = map->nSides();
-	for (auto& side : sides_)
+	vector<MapSide*> new_sides;
+	new_sides.reserve(sides_.size());
+	for (unsigned a = 0; a < sides_.size(); a++)
 	{
-		// Get relative sector
-		auto sector = findInMap(sectMap, side->sector());
-
-		auto new_side = map->createSide(sector);
-		new_side->copy(side.get());
-		sideMap[side.get()] = new_side;
+		auto new_side = map->createSide(new_sectors[side_sectors_[a]]);
+		new_side->copy(sides_[a].get());
+		new_sides.push_back(new_side);
 	}
 
 	// Add lines
-	// int first_new_line = map->nLines();
-	for (auto& line : lines_)
+	for (unsigned a = 0; a < lines_.size(); a++)
 	{
-		// Get relative vertices
-		auto v1 = findInMap(vertMap, line->v1());
-		auto v2 = findInMap(vertMap, line->v2());
-
-		if (!v1)
-		{
-			log::info(1, "no v1");
-			continue;
-		}
-		if (!v2)
-		{
-			log::info(1, "no v2");
-		}
-
-		auto newline = map->createLine(v1, v2, true);
-		newline->copy(line.get());
+		auto& refs    = line_refs_[a];
+		auto  newline = map->createLine(new_verts[refs.v1], new_verts[refs.v2], true);
+		newline->copy(lines_[a].get());
 
 		// Set relative sides
-		auto newS1 = findInMap(sideMap, line->s1());
-		auto newS2 = findInMap(sideMap, line->s2());
+		auto newS1 = refs.s1 >= 0 ? new_sides[refs.s1] : nullptr;
+		auto newS2 = refs.s2 >= 0 ? new_sides[refs.s2] : nullptr;
 		if (newS1)
 			newline->setS1(newS1);
 		if (newS2)
@@ -2463,6 +2635,7 @@ CONSOLE_COMMAND(m_check, 0, true)
 	{
 		// Run
 		log::console(check->progressText());
+		TRACE_ZONE("MapCheck", check->progressText());
 		check->doCheck();
 
 		// Check if no problems found
@@ -13,6 +13,7 @@
 #include "General/UndoRedo.h"
 #include "ItemSelection.h"
 #include "MapEditor.h"
+#include "MapValidator.h"
 #include "Renderer/Overlays/InfoOverlay3d.h"
 #include "Renderer/Overlays/LineInfoOverlay.h"
 #include "Renderer/Overlays/MCOverlay.h"
@@ -63,6 +64,7 @@ public:
 	MapCanvas*            canvas() const { return canvas_; }
 	mapeditor::Renderer&  renderer() { return renderer_; }
 	mapeditor::Input&     input() { return input_; }
+	MapValidator&         validator() { return validator_; }
 	bool                  mouseLocked() const { return mouse_locked_; }
 
 	void setEditMode(mapeditor::Mode mode);
@@ -74,14 +76,17 @@ public:
 
 	// General
 	bool update(long frametime);
+	void requestRedraw() { redraw_ = true; }
 
 	// Map loading
 	bool openMap(Archive::MapDesc map);
 	void clearMap();
+	void optimiseMapOrder();
 
 	// Selection/hilight
 	void showItem(int index);
 	void updateTagged();
+	void queueTaggedUpdate() { tagged_update_pending_ = true; }
 	void selectionUpdated();
 
 	// Grid
@@ -156,6 +161,29 @@ private:
 	Archive::MapDesc map_desc_;
 	long             next_frame_length_ = 0;
 
+	// Redrawing - the canvas is only updated/redrawn if something changed
+	// since the last update
+	struct UpdateState
+	{
+		mapeditor::Mode       edit_mode;
+		mapeditor::SectorMode sector_mode;
+		int                   grid_size;
+		unsigned              n_selected;
+		unsigned              n_messages;
+		mapeditor::Item       hilight;
+		bool                  mouse_locked;
+
+		bool operator==(const UpdateState& other) const;
+	};
+	UpdateState last_update_state_{};
+	long        last_update_time_ = 0;
+	bool        redraw_           = true;
+	bool        idle_             = false;
+
+	UpdateState currentUpdateState() const;
+	bool        redrawNeeded() const;
+	void        queuePropsPanelUpdate();
+
 	// Undo/Redo stuff
 	unique_ptr<UndoManager> undo_manager_     = nullptr;
 	unique_ptr<UndoStep>    us_create_delete_ = nullptr;
@@ -176,6 +204,9 @@ private:
 	bool   undo_deleted_  = false;
 	string last_undo_level_;
 
+	// Properties panel
+	bool props_update_queued_ = false;
+
 	// Tagged items
 	vector<MapSector*> tagged_sectors_;
 	vector<MapLine*>   tagged_lines_;
@@ -184,6 +215,7 @@ private:
 	// Tagging items
 	vector<MapLine*>  tagging_lines_;
 	vector<MapThing*> tagging_things_;
+	bool              tagged_update_pending_ = false; // Tagged/tagging lists need updating once the hilight settles
 
 	// Pathed things
 	vector<MapThing*> pathed_things_;
@@ -195,6 +227,9 @@ private:
 	Edit3D      edit_3d_{ *this };
 	ObjectEdit  object_edit_{ *this };
 
+	// Live map checks
+	MapValidator validator_{ map_ };
+
 	// Object properties and copy/paste
 	unique_ptr<MapThing>  copy_thing_      = nullptr;
 	unique_ptr<MapSector> copy_sector_     = nullptr;
@@ -243,10 +278,22 @@ public:
 	Vec2d              midpoint() const { return midpoint_; }
 
 private:
+	// Copied objects referenced by a copied line (indices into vertices_ and
+	// sides_, -1 for no side)
+	struct LineRefs
+	{
+		unsigned v1;
+		unsigned v2;
+		int      s1;
+		int      s2;
+	};
+
 	vector<unique_ptr<MapVertex>> vertices_;
 	vector<unique_ptr<MapSide>>   sides_;
 	vector<unique_ptr<MapLine>>   lines_;
 	vector<unique_ptr<MapSector>> sectors_;
+	vector<unsigned>              side_sectors_; // Index into sectors_ for each side
+	vector<LineRefs>              line_refs_;
 	Vec2d                         midpoint_;
 };
 
@@ -38,6 +38,7 @@
 #include "Game/Configuration.h"
 #include "General/Misc.h"
 #include "General/ResourceManager.h"
+#include "General/Trace.h"
 #include "Graphics/CTexture/CTexture.h"
 #include "Graphics/SImage/SImage.h"
 #include "MainEditor/MainEditor.h"
@@ -61,6 +62,246 @@ namespace
 MapTextureManager::Texture tex_invalid;
 }
 CVAR(Int, map_tex_filter, 0, CVar::Flag::Save)
+CVAR(Int, map_tex_memory_budget_mb, 512, CVar::Flag::Save)
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the desired filter type for map textures and flats
+// -----------------------------------------------------------------------------
+gl::TexFilter textureFilter()
+{
+	if (map_tex_filter == 0)
+		return gl::TexFilter::NearestLinearMin;
+	else if (map_tex_filter == 2)
+		return gl::TexFilter::LinearMipmap;
+	else if (map_tex_filter == 3)
+		return gl::TexFilter::NearestMipmap;
+
+	return gl::TexFilter::Linear;
+}
+
+// -----------------------------------------------------------------------------
+// Finds the composite texture matching [name] for a map texture, looking in
+// [archive] first
+// -----------------------------------------------------------------------------
+CTexture* compositeTexture(string_view name, Archive* archive)
+{
+	if (auto* ctex = app::resources().getTexture(name, "WallTexture", archive))
+		return ctex;
+
+	return app::resources().getTexture(name, "", archive);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the scale and world panning of [mtex] from composite texture [ctex]
+// -----------------------------------------------------------------------------
+void setCompositeScale(MapTextureManager::Texture& mtex, const CTexture& ctex)
+{
+	double sx = ctex.scaleX();
+	if (sx == 0.0)
+		sx = 1.0;
+	double sy = ctex.scaleY();
+	if (sy == 0.0)
+		sy = 1.0;
+
+	mtex.world_panning = ctex.worldPanning();
+	mtex.scale         = { 1.0 / sx, 1.0 / sy };
+}
+
+// -----------------------------------------------------------------------------
+// Returns the names of resources in [names] that still exist (added/changed)
+// -----------------------------------------------------------------------------
+std::set<string> currentNames(const ResourceChanges::Names& names)
+{
+	auto current = names.added;
+	current.insert(names.changed.begin(), names.changed.end());
+	return current;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a view of [str] interned in [strings], so that identical strings in
+// the texture info lists are only stored once
+// -----------------------------------------------------------------------------
+string_view intern(std::unordered_set<string>& strings, string_view str)
+{
+	if (str.empty())
+		return {};
+
+	return *strings.emplace(str).first;
+}
+
+// -----------------------------------------------------------------------------
+// Adds info for composite [texture] to [tex_info] or [flat_info] depending on
+// its type (either list can be null to skip textures of that kind), with
+// strings interned in [strings]
+// -----------------------------------------------------------------------------
+void addCompositeInfo(
+	const TextureResource::Texture&     texture,
+	vector<MapTextureManager::TexInfo>* tex_info,
+	vector<MapTextureManager::TexInfo>* flat_info,
+	std::unordered_set<string>&         strings)
+{
+	using Category = MapTextureManager::Category;
+
+	auto* tex    = &texture.tex;
+	auto  parent = texture.parent.lock().get();
+	if (!parent)
+		return;
+
+	auto long_name = intern(strings, tex->name());
+	auto path      = strutil::contains(long_name, '/') ? intern(strings, strutil::beforeLastV(long_name, '/')) :
+														 string_view{};
+
+	if (tex->isExtended())
+	{
+		if (strutil::equalCI(tex->type(), "texture") || strutil::equalCI(tex->type(), "walltexture"))
+		{
+			if (tex_info)
+				tex_info->emplace_back(long_name, Category::ZDTextures, parent, path, tex->index(), long_name);
+		}
+		else if (strutil::equalCI(tex->type(), "define"))
+		{
+			if (tex_info)
+				tex_info->emplace_back(long_name, Category::HiRes, parent, path, tex->index(), long_name);
+		}
+		else if (strutil::equalCI(tex->type(), "flat"))
+		{
+			if (flat_info)
+				flat_info->emplace_back(long_name, Category::ZDTextures, parent, path, tex->index(), long_name);
+		}
+		// Ignore graphics, patches and sprites
+	}
+	else if (tex_info)
+		tex_info->emplace_back(long_name, Category::TextureX, parent, path, tex->index() + 1, long_name);
+}
+
+// -----------------------------------------------------------------------------
+// Adds info for stand-alone texture or flat [entry] to [list], in [category],
+// with strings interned in [strings]
+// -----------------------------------------------------------------------------
+void addEntryInfo(
+	ArchiveEntry&                       entry,
+	MapTextureManager::Category         category,
+	vector<MapTextureManager::TexInfo>& list,
+	std::unordered_set<string>&         strings)
+{
+	// Determine texture path if it's in a pk3
+	auto long_name  = entry.path(true).erase(0, 1);
+	auto short_name = strutil::truncate(entry.upperNameNoExt(), 8);
+	auto path       = entry.path(false).erase(0, 1);
+
+	list.emplace_back(
+		intern(strings, short_name),
+		category,
+		entry.parent(),
+		intern(strings, path),
+		0,
+		intern(strings, long_name));
+}
+
+// -----------------------------------------------------------------------------
+// Removes all info in [list] of [category] that is for a resource in [names].
+// If [check_short] is true, the short name is checked as well as the long name
+// -----------------------------------------------------------------------------
+void removeInfo(
+	vector<MapTextureManager::TexInfo>& list,
+	MapTextureManager::Category         category,
+	const ResourceChanges::Names&       names,
+	bool                                check_short)
+{
+	list.erase(
+		std::remove_if(
+			list.begin(),
+			list.end(),
+			[&](const MapTextureManager::TexInfo& info)
+			{
+				if (info.category != category)
+					return false;
+
+				return names.contains(info.long_name) || names.contains(strutil::upper(info.long_name))
+					   || (check_short && names.contains(info.short_name));
+			}),
+		list.end());
+}
+
+// -----------------------------------------------------------------------------
+// Returns the average colour of rows [y1] to [y2] of [rgba] image data, which
+// is [width] pixels wide
+// -----------------------------------------------------------------------------
+ColRGBA averageColour(const uint8_t* rgba, unsigned width, unsigned y1, unsigned y2)
+{
+	if (y2 <= y1 || width == 0)
+		return ColRGBA::BLACK;
+
+	uint64_t red   = 0;
+	uint64_t green = 0;
+	uint64_t blue  = 0;
+	auto     end   = rgba + y2 * width * 4;
+	for (auto pixel = rgba + y1 * width * 4; pixel < end; pixel += 4)
+	{
+		red += pixel[0];
+		green += pixel[1];
+		blue += pixel[2];
+	}
+
+	auto npix = static_cast<uint64_t>(y2 - y1) * width;
+	return { static_cast<uint8_t>(red / npix), static_cast<uint8_t>(green / npix), static_cast<uint8_t>(blue / npix) };
+}
+
+// -----------------------------------------------------------------------------
+// Creates the OpenGL texture for [mtex] from [image] (using [pal]) with
+// [filter]. If possible, a copy is also added to a texture array layer so that
+// walls using different textures of the same size can be rendered without
+// rebinding
+// -----------------------------------------------------------------------------
+void createMapTexture(MapTextureManager::Texture& mtex, const SImage& image, Palette* pal, gl::TexFilter filter)
+{
+	MemChunk rgba;
+	image.putRGBAData(rgba, pal);
+	mtex.gl_id = gl::Texture::createFromData(rgba.data(), image.width(), image.height(), filter);
+	if (!mtex.gl_id)
+		return;
+
+	// Calculate average colours while the image data is at hand, rather than
+	// reading the texture back from the GPU later
+	unsigned width      = image.width();
+	unsigned height     = image.height();
+	unsigned band       = height * 0.4;
+	mtex.average_colour = averageColour(rgba.data(), width, 0, height);
+	mtex.average_top    = averageColour(rgba.data(), width, 0, band);
+	mtex.average_bottom = averageColour(rgba.data(), width, height - band, height);
+
+	mtex.layer = gl::TextureArray::add(rgba.data(), image.width(), image.height(), filter);
+
+	// Estimate GPU memory used (a full mip chain adds a third)
+	mtex.memory = image.width() * image.height() * 4;
+	if (filter == gl::TexFilter::Mipmap || filter == gl::TexFilter::LinearMipmap
+		|| filter == gl::TexFilter::NearestMipmap)
+		mtex.memory += mtex.memory / 3;
+	if (mtex.layer.isValid())
+		mtex.memory *= 2;
+}
+
+// -----------------------------------------------------------------------------
+// Deletes the OpenGL texture(s) for [mtex], so that it is reloaded next time
+// it is requested
+// -----------------------------------------------------------------------------
+void unloadMapTexture(MapTextureManager::Texture& mtex)
+{
+	gl::Texture::clear(mtex.gl_id);
+	gl::TextureArray::remove(mtex.layer);
+	mtex.gl_id  = 0;
+	mtex.layer  = {};
+	mtex.memory = 0;
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -80,8 +321,9 @@ MapTextureManager::MapTextureManager(shared_ptr<Archive> archive) : archive_{ ar
 // -----------------------------------------------------------------------------
 void MapTextureManager::init()
 {
-	// Refresh when resources are updated or the main palette is changed
-	sc_resources_updated_ = app::resources().signals().resources_updated.connect([this]() { refreshResources(); });
+	// Refresh when resources are changed or the main palette is changed
+	sc_resources_changed_ = app::resources().signals().resources_changed.connect(
+		[this](const ResourceChanges& changes) { updateResources(changes); });
 	sc_palette_changed_   = theMainWindow->paletteChooser()->signals().palette_changed.connect([this]()
                                                                                              { refreshResources(); });
 
@@ -112,23 +354,19 @@ Palette* MapTextureManager::resourcePalette() const
 
 // -----------------------------------------------------------------------------
 // Returns the texture matching [name], loading it from resources if necessary.
-// If [mixed] is true, flats are also searched if no matching texture is found
+// If [mixed] is true, flats are also searched if no matching texture is found.
+// If [async] is true, composite textures are composed in the background and
+// the placeholder texture is returned until they are ready (see
+// uploadComposed), rather than composing them immediately
 // -----------------------------------------------------------------------------
-const MapTextureManager::Texture& MapTextureManager::texture(string_view name, bool mixed)
+const MapTextureManager::Texture& MapTextureManager::texture(string_view name, bool mixed, bool async)
 {
 	// Get texture matching name
-	auto& mtex = textures_[strutil::upper(name)];
+	auto& mtex     = textures_[NameKey{ name }];
+	mtex.last_used = app::runTimer();
 
 	// Get desired filter type
-	auto filter = gl::TexFilter::Linear;
-	if (map_tex_filter == 0)
-		filter = gl::TexFilter::NearestLinearMin;
-	else if (map_tex_filter == 1)
-		filter = gl::TexFilter::Linear;
-	else if (map_tex_filter == 2)
-		filter = gl::TexFilter::LinearMipmap;
-	else if (map_tex_filter == 3)
-		filter = gl::TexFilter::NearestMipmap;
+	auto filter = textureFilter();
 
 	// If the texture is loaded
 	if (mtex.gl_id)
@@ -138,33 +376,50 @@ const MapTextureManager::Texture& MapTextureManager::texture(string_view name, b
 			return mtex;
 
 		// Otherwise, reload the texture
-		gl::Texture::clear(mtex.gl_id);
-		mtex.gl_id = 0;
+		unloadMapTexture(mtex);
 	}
 
 	// Texture not found or unloaded, look for it
+	TRACE_ZONE("MapTextureManager::texture", name);
+	auto archive = archive_.lock().get();
+
+	// Check for (or start) background composition if requested
+	if (async)
+	{
+		auto name_upper = strutil::upper(name);
+		auto i          = composing_.find(name_upper);
+		if (i == composing_.end())
+		{
+			if (auto* ctex = compositeTexture(name, archive))
+			{
+				queueComposite(name_upper, *ctex, archive);
+				i = composing_.find(name_upper);
+			}
+		}
+
+		if (i != composing_.end())
+		{
+			// Still being composed
+			if (!i->second)
+				return placeholder();
+
+			// Finished (may have been composed immediately if cached)
+			auto composed = std::move(i->second);
+			composing_.erase(i);
+			createComposed(name_upper, *composed);
+			if (mtex.gl_id)
+				return mtex;
+		}
+	}
 
 	// Look for composite textures first
-	auto  archive = archive_.lock().get();
-	auto* ctex    = app::resources().getTexture(name, "WallTexture", archive);
-	if (!ctex)
-		ctex = app::resources().getTexture(name, "", archive);
-	if (ctex)
+	if (auto* ctex = compositeTexture(name, archive))
 	{
 		SImage image;
 		if (ctex->toImage(image, archive, palette_.get(), true))
 		{
-			mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
-
-			double sx = ctex->scaleX();
-			if (sx == 0.0)
-				sx = 1.0;
-			double sy = ctex->scaleY();
-			if (sy == 0.0)
-				sy = 1.0;
-
-			mtex.world_panning = ctex->worldPanning();
-			mtex.scale         = { 1.0 / sx, 1.0 / sy };
+			createMapTexture(mtex, image, palette_.get(), filter);
+			setCompositeScale(mtex, *ctex);
 		}
 	}
 
@@ -177,7 +432,7 @@ const MapTextureManager::Texture& MapTextureManager::texture(string_view name, b
 			SImage image;
 			if (misc::loadImageFromEntry(&image, etex))
 			{
-				mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
+				createMapTexture(mtex, image, palette_.get(), filter);
 
 				if (auto* ref = app::resources().getTextureEntry(name, "textures", archive))
 				{
@@ -202,7 +457,7 @@ const MapTextureManager::Texture& MapTextureManager::texture(string_view name, b
 			SImage image;
 			etex = app::resources().getTextureEntry(name, "textures", archive);
 			if (misc::loadImageFromEntry(&image, etex))
-				mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
+				createMapTexture(mtex, image, palette_.get(), filter);
 		}
 	}
 
@@ -220,6 +475,127 @@ const MapTextureManager::Texture& MapTextureManager::texture(string_view name, b
 	return mtex;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the texture matching [name] if it can be loaded now, or null if it
+// is a composite texture that is still being composed in the background (see
+// TextureComposer), in which case it should be requested again later.
+// Used by the texture browser so that it can show textures as they become
+// available rather than blocking until all are composed
+// -----------------------------------------------------------------------------
+const MapTextureManager::Texture* MapTextureManager::requestTexture(string_view name)
+{
+	auto name_upper = strutil::upper(name);
+
+	// Check if the texture is being composed
+	if (auto i = composing_.find(name_upper); i != composing_.end())
+	{
+		if (!i->second)
+			return nullptr;
+
+		// Finished, create the gl texture
+		auto composed = std::move(i->second);
+		composing_.erase(i);
+		createComposed(name_upper, *composed);
+
+		return &texture(name, false);
+	}
+
+	// Already loaded
+	if (auto i = textures_.find(NameKey{ name }); i != textures_.end() && i->second.gl_id)
+		return &texture(name, false);
+
+	// Anything other than composite textures is loaded immediately
+	auto  archive = archive_.lock().get();
+	auto* ctex    = compositeTexture(name, archive);
+	if (!ctex)
+		return &texture(name, false);
+
+	// Compose in the background
+	queueComposite(name_upper, *ctex, archive);
+
+	// May have been composed immediately (if cached)
+	if (composing_[name_upper])
+		return requestTexture(name);
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Queues background composition of any composite textures in [names] that
+// aren't already loaded or being composed, so that they are ready (or closer
+// to it) when first requested asynchronously. Returns the number of textures
+// queued
+// -----------------------------------------------------------------------------
+unsigned MapTextureManager::prefetchTextures(const vector<string>& names)
+{
+	auto     archive = archive_.lock().get();
+	unsigned queued  = 0;
+	for (const auto& name : names)
+	{
+		// Already loaded
+		if (auto i = textures_.find(NameKey{ name }); i != textures_.end() && i->second.gl_id)
+			continue;
+
+		// Already being composed
+		auto name_upper = strutil::upper(name);
+		if (composing_.find(name_upper) != composing_.end())
+			continue;
+
+		if (auto* ctex = compositeTexture(name, archive))
+		{
+			queueComposite(name_upper, *ctex, archive);
+			queued++;
+		}
+	}
+
+	return queued;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the texture used in place of textures that are still being composed
+// in the background
+// -----------------------------------------------------------------------------
+const MapTextureManager::Texture& MapTextureManager::placeholder()
+{
+	if (!placeholder_.gl_id)
+	{
+		placeholder_.gl_id = gl::Texture::create();
+		gl::Texture::genChequeredTexture(placeholder_.gl_id, 8, ColRGBA(96, 96, 96), ColRGBA(112, 112, 112));
+	}
+
+	return placeholder_;
+}
+
+// -----------------------------------------------------------------------------
+// Creates gl textures for up to [max] composite textures that have finished
+// being composed in the background, and signals textures_loaded if any were.
+// Returns the number of textures still being composed or waiting to be created
+// -----------------------------------------------------------------------------
+unsigned MapTextureManager::uploadComposed(unsigned max)
+{
+	unsigned created = 0;
+	auto     i       = composing_.begin();
+	while (i != composing_.end() && created < max)
+	{
+		if (!i->second)
+		{
+			++i;
+			continue;
+		}
+
+		auto name     = i->first;
+		auto composed = std::move(i->second);
+		i             = composing_.erase(i);
+		createComposed(name, *composed);
+		created++;
+	}
+
+	if (created > 0)
+		signals_.textures_loaded();
+
+	return composing_.size();
+}
+
 // -----------------------------------------------------------------------------
 // Returns the flat matching [name], loading it from resources if necessary.
 // If [mixed] is true, textures are also searched if no matching flat is found
@@ -227,18 +603,11 @@ const MapTextureManager::Texture& MapTextureManager::texture(string_view name, b
 const MapTextureManager::Texture& MapTextureManager::flat(string_view name, bool mixed)
 {
 	// Get flat matching name
-	auto& mtex = flats_[strutil::upper(name)];
+	auto& mtex     = flats_[NameKey{ name }];
+	mtex.last_used = app::runTimer();
 
 	// Get desired filter type
-	auto filter = gl::TexFilter::Linear;
-	if (map_tex_filter == 0)
-		filter = gl::TexFilter::NearestLinearMin;
-	else if (map_tex_filter == 1)
-		filter = gl::TexFilter::Linear;
-	else if (map_tex_filter == 2)
-		filter = gl::TexFilter::LinearMipmap;
-	else if (map_tex_filter == 3)
-		filter = gl::TexFilter::NearestMipmap;
+	auto filter = textureFilter();
 
 	// If the texture is loaded
 	if (mtex.gl_id)
@@ -248,11 +617,11 @@ const MapTextureManager::Texture& MapTextureManager::flat(string_view name, bool
 			return mtex;
 
 		// Otherwise, reload the texture
-		gl::Texture::clear(mtex.gl_id);
-		mtex.gl_id = 0;
+		unloadMapTexture(mtex);
 	}
 
 	// Prioritize standalone textures
+	TRACE_ZONE("MapTextureManager::flat", name);
 	auto archive = archive_.lock().get();
 	if (mixed && app::resources().getTextureEntry(name, "textures", archive))
 	{
@@ -267,7 +636,7 @@ const MapTextureManager::Texture& MapTextureManager::flat(string_view name, bool
 			SImage image;
 			if (ctex->toImage(image, archive, palette_.get(), true))
 			{
-				mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
+				createMapTexture(mtex, image, palette_.get(), filter);
 
 				double sx = ctex->scaleX();
 				if (sx == 0.0)
@@ -302,7 +671,7 @@ const MapTextureManager::Texture& MapTextureManager::flat(string_view name, bool
 		// Load the image
 		SImage image;
 		if (misc::loadImageFromEntry(&image, image_entry))
-			mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
+			createMapTexture(mtex, image, palette_.get(), filter);
 
 		// Get high-res texture scale
 		if (scale_entry)
@@ -377,6 +746,7 @@ const MapTextureManager::Texture& MapTextureManager::sprite(
 	}
 
 	// Sprite not found, look for it
+	TRACE_ZONE("MapTextureManager::sprite", name);
 	bool   found  = false;
 	bool   mirror = false;
 	SImage image;
@@ -414,7 +784,12 @@ const MapTextureManager::Texture& MapTextureManager::sprite(
 
 		// Apply translation
 		if (!translation.empty())
-			image.applyTranslation(translation, pal, true);
+		{
+			auto [i, added] = translations_.try_emplace(string{ translation });
+			if (added)
+				i->second.parse(translation);
+			image.applyTranslation(&i->second, pal, true);
+		}
 
 		// Apply palette override
 		if (!palette.empty())
@@ -491,6 +866,69 @@ int MapTextureManager::verticalOffset(string_view name) const
 	return 0;
 }
 
+// -----------------------------------------------------------------------------
+// Totals the GPU memory used by loaded textures and flats, and unloads the
+// least recently used ones until the total is within the memory budget
+// (map_tex_memory_budget_mb). Textures used within the last few seconds are
+// never unloaded, and unloaded textures are reloaded next time they are
+// requested. Checks at most once per second, so can be called every frame
+// -----------------------------------------------------------------------------
+void MapTextureManager::enforceMemoryBudget()
+{
+	auto now = app::runTimer();
+	if (now - last_budget_check_ < 1000)
+		return;
+	last_budget_check_ = now;
+
+	// Total memory used, and update usage times of textures rendered since the
+	// last check (renderers keep gl ids rather than requesting textures again)
+	vector<Texture*> loaded;
+	memory_used_ = 0;
+	for (auto* cache : { &textures_, &flats_ })
+		for (auto& i : *cache)
+		{
+			auto& mtex = i.second;
+			if (!mtex.gl_id || mtex.memory == 0)
+				continue;
+
+			if (used_ids_.count(mtex.gl_id))
+				mtex.last_used = now;
+			memory_used_ += mtex.memory;
+			loaded.push_back(&mtex);
+		}
+	used_ids_.clear();
+
+	// Check budget
+	if (map_tex_memory_budget_mb <= 0)
+		return;
+	const auto budget = static_cast<size_t>(map_tex_memory_budget_mb) * 1024 * 1024;
+	if (memory_used_ <= budget)
+		return;
+
+	// Unload least recently used first
+	std::sort(
+		loaded.begin(),
+		loaded.end(),
+		[](const Texture* left, const Texture* right) { return left->last_used < right->last_used; });
+	vector<unsigned> unloaded;
+	for (auto* mtex : loaded)
+	{
+		if (memory_used_ <= budget || now - mtex->last_used < 5000)
+			break;
+
+		memory_used_ -= mtex->memory;
+		unloaded.push_back(mtex->gl_id);
+		unloadMapTexture(*mtex);
+	}
+
+	if (!unloaded.empty())
+	{
+		log::info(2, "Unloaded {} map textures to stay within the memory budget", unloaded.size());
+		unload_count_++;
+		signals_.textures_unloaded(unloaded);
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Loads all editor images (thing icons, etc) from the program resource archive
 // -----------------------------------------------------------------------------
@@ -504,7 +942,7 @@ void MapTextureManager::importEditorImages(MapTexHashMap& map, const ArchiveDir*
 		auto entry = dir->entryAt(a);
 
 		// Load entry to image
-		if (image.open(entry->data()))
+		if (image.open(entry->constData()))
 		{
 			// Create texture in hashmap
 			auto name = fmt::format("{}{}", path, entry->nameNoExt());
@@ -550,58 +988,205 @@ const MapTextureManager::Texture& MapTextureManager::editorImage(string_view nam
 void MapTextureManager::refreshResources()
 {
 	// Clear all cached textures
+	composer_.cancel();
+	composing_.clear();
 	textures_.clear();
 	flats_.clear();
 	sprites_.clear();
+	translations_.clear();
+	unload_count_++;
 
 	// Update palette
 	theMainWindow->paletteChooser()->setGlobalFromArchive(archive_.lock().get());
 	mapeditor::forceRefresh(true);
 	palette_->copyPalette(resourcePalette());
+}
+
+// -----------------------------------------------------------------------------
+// Unloads cached textures, flats and sprites affected by resource [changes],
+// and updates texture info lists (if built) to match
+// -----------------------------------------------------------------------------
+void MapTextureManager::updateResources(const ResourceChanges& changes)
+{
+	updateTexInfo(changes);
+
+	// Everything depends on the palette
+	if (!changes.palettes.empty())
+	{
+		refreshResources();
+		return;
+	}
+
+	// Textures being composed may be out of date
+	composer_.cancel();
+	composing_.clear();
+
+	// Unload cached textures and flats with changed names
+	auto unload = [this](const ResourceChanges::Names& names)
+	{
+		for (const auto* set : { &names.added, &names.removed, &names.changed })
+			for (const auto& name : *set)
+			{
+				NameKey key{ name };
+				textures_.erase(key);
+				flats_.erase(key);
+			}
+	};
+	unload(changes.textures);
+	unload(changes.satextures);
+	unload(changes.flats);
+	unload_count_++;
+
+	// Composite textures (and sprites) can be made up of any patches, so unload
+	// all of them if patches changed
+	if (!changes.patches.empty())
+	{
+		for (auto* cache : { &textures_, &flats_ })
+		{
+			auto i = cache->begin();
+			while (i != cache->end())
+			{
+				if (app::resources().getTexture(i->first.name()))
+					i = cache->erase(i);
+				else
+					++i;
+			}
+		}
+
+		sprites_.clear();
+	}
+
+	mapeditor::forceRefresh(true);
+}
+
+// -----------------------------------------------------------------------------
+// Updates the texture and flat info lists (whichever have been built) with
+// resource [changes]
+// -----------------------------------------------------------------------------
+void MapTextureManager::updateTexInfo(const ResourceChanges& changes)
+{
+	auto tex_info  = tex_info_built_ ? &tex_info_ : nullptr;
+	auto flat_info = flat_info_built_ ? &flat_info_ : nullptr;
+	if (!tex_info && !flat_info)
+		return;
+
+	// Composite textures
+	if (!changes.textures.empty())
+	{
+		if (tex_info)
+		{
+			removeInfo(tex_info_, Category::TextureX, changes.textures, false);
+			removeInfo(tex_info_, Category::ZDTextures, changes.textures, false);
+			removeInfo(tex_info_, Category::HiRes, changes.textures, false);
+		}
+		if (flat_info)
+			removeInfo(flat_info_, Category::ZDTextures, changes.textures, false);
+
+		vector<TextureResource::Texture*> textures;
+		app::resources().putTextures(
+			textures, currentNames(changes.textures), app::archiveManager().baseResourceArchive());
+		for (auto* texture : textures)
+			addCompositeInfo(*texture, tex_info, flat_info, info_strings_);
+	}
+
+	auto long_names = game::configuration().featureSupported(game::Feature::LongNames);
+
+	// Texture namespace patches (TX_)
+	if (tex_info && !changes.patches.empty() && game::configuration().featureSupported(game::Feature::TxTextures))
+	{
+		removeInfo(tex_info_, Category::Tx, changes.patches, true);
+
+		vector<ArchiveEntry*> patches;
+		app::resources().putPatchEntries(patches, currentNames(changes.patches), nullptr, long_names);
+		for (auto* patch : patches)
+			if (patch->isInNamespace("textures") || patch->isInNamespace("hires"))
+				addEntryInfo(*patch, Category::Tx, tex_info_, info_strings_);
+	}
+
+	// Flats
+	if (flat_info && !changes.flats.empty())
+	{
+		removeInfo(flat_info_, Category::None, changes.flats, true);
 
-	// Clear texture info
+		vector<ArchiveEntry*> flats;
+		app::resources().putFlatEntries(flats, currentNames(changes.flats), nullptr, long_names);
+		for (auto* flat : flats)
+			addEntryInfo(*flat, Category::None, flat_info_, info_strings_);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Clears the texture and flat info lists, they will be rebuilt when next
+// needed
+// -----------------------------------------------------------------------------
+void MapTextureManager::clearTexInfo()
+{
 	tex_info_.clear();
 	flat_info_.clear();
+	info_strings_.clear();
+	tex_info_built_  = false;
+	flat_info_built_ = false;
+}
+
+// -----------------------------------------------------------------------------
+// Queues composite texture [ctex] to be composed in the background, as texture
+// [name_upper]. The result is kept in composing_ until its gl texture is
+// created (see createComposed)
+// -----------------------------------------------------------------------------
+void MapTextureManager::queueComposite(const string& name_upper, CTexture& ctex, Archive* archive)
+{
+	composing_[name_upper] = nullptr;
+	composer_.queue(
+		ctex,
+		archive,
+		palette_.get(),
+		true,
+		[this, name_upper](bool ok, const SImage& image, const CTexture& tex)
+		{
+			auto composed = std::make_unique<ComposedTexture>();
+			composed->ok  = ok && composed->image.copyImage(&image);
+			setCompositeScale(composed->texture, tex);
+			composing_[name_upper] = std::move(composed);
+		});
+}
+
+// -----------------------------------------------------------------------------
+// Creates the gl texture for [composed] texture [name_upper], if it hasn't
+// already been loaded some other way. This is kept separate from the composer
+// callback since there may not be a current gl context there
+// -----------------------------------------------------------------------------
+void MapTextureManager::createComposed(const string& name_upper, const ComposedTexture& composed)
+{
+	auto& mtex = textures_[NameKey{ name_upper }];
+	if (mtex.gl_id)
+		return;
+
+	// Use the missing texture if it couldn't be composed (so it isn't queued
+	// again)
+	if (!composed.ok)
+	{
+		mtex.gl_id = gl::Texture::missingTexture();
+		return;
+	}
+
+	createMapTexture(mtex, composed.image, palette_.get(), textureFilter());
+	mtex.world_panning = composed.texture.world_panning;
+	mtex.scale         = composed.texture.scale;
 }
 
 // -----------------------------------------------------------------------------
-// (Re)builds lists with information about all currently available resource
-// textures and flats
+// Builds the list of information about all currently available resource
+// textures
 // -----------------------------------------------------------------------------
 void MapTextureManager::buildTexInfoList()
 {
-	// Clear
 	tex_info_.clear();
-	flat_info_.clear();
-
-	// --- Textures ---
 
 	// Composite textures
 	vector<TextureResource::Texture*> textures;
 	app::resources().putAllTextures(textures, app::archiveManager().baseResourceArchive());
 	for (auto& texture : textures)
-	{
-		auto tex    = &texture->tex;
-		auto parent = texture->parent.lock().get();
-		if (!parent)
-			continue;
-
-		auto long_name = tex->name();
-		auto path      = strutil::contains(long_name, '/') ? strutil::beforeLast(long_name, '/') : strutil::EMPTY;
-
-		if (tex->isExtended())
-		{
-			if (strutil::equalCI(tex->type(), "texture") || strutil::equalCI(tex->type(), "walltexture"))
-				tex_info_.emplace_back(long_name, Category::ZDTextures, parent, path, tex->index(), long_name);
-			else if (strutil::equalCI(tex->type(), "define"))
-				tex_info_.emplace_back(long_name, Category::HiRes, parent, path, tex->index(), long_name);
-			else if (strutil::equalCI(tex->type(), "flat"))
-				flat_info_.emplace_back(long_name, Category::ZDTextures, parent, path, tex->index(), long_name);
-			// Ignore graphics, patches and sprites
-		}
-		else
-			tex_info_.emplace_back(long_name, Category::TextureX, parent, path, tex->index() + 1, long_name);
-	}
+		addCompositeInfo(*texture, &tex_info_, nullptr, info_strings_);
 
 	// Texture namespace patches (TX_)
 	if (game::configuration().featureSupported(game::Feature::TxTextures))
@@ -610,32 +1195,35 @@ void MapTextureManager::buildTexInfoList()
 		app::resources().putAllPatchEntries(
 			patches, nullptr, game::configuration().featureSupported(game::Feature::LongNames));
 		for (auto& patch : patches)
-		{
 			if (patch->isInNamespace("textures") || patch->isInNamespace("hires"))
-			{
-				// Determine texture path if it's in a pk3
-				auto long_name  = patch->path(true).erase(0, 1);
-				auto short_name = strutil::truncate(patch->upperNameNoExt(), 8);
-				auto path       = patch->path(false).erase(0, 1);
-
-				tex_info_.emplace_back(short_name, Category::Tx, patch->parent(), path, 0, long_name);
-			}
-		}
+				addEntryInfo(*patch, Category::Tx, tex_info_, info_strings_);
 	}
 
+	tex_info_built_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Builds the list of information about all currently available resource
+// flats
+// -----------------------------------------------------------------------------
+void MapTextureManager::buildFlatInfoList()
+{
+	flat_info_.clear();
+
+	// Composite (ZDoom TEXTURES) flats
+	vector<TextureResource::Texture*> textures;
+	app::resources().putAllTextures(textures, app::archiveManager().baseResourceArchive());
+	for (auto& texture : textures)
+		addCompositeInfo(*texture, nullptr, &flat_info_, info_strings_);
+
 	// Flats
 	vector<ArchiveEntry*> flats;
 	app::resources().putAllFlatEntries(
 		flats, nullptr, game::configuration().featureSupported(game::Feature::LongNames));
 	for (auto& flat : flats)
-	{
-		// Determine flat path if it's in a pk3
-		auto long_name  = flat->path(true).erase(0, 1);
-		auto short_name = strutil::truncate(flat->upperNameNoExt(), 8);
-		auto path       = flat->path(false).erase(0, 1);
+		addEntryInfo(*flat, Category::None, flat_info_, info_strings_);
 
-		flat_info_.emplace_back(short_name, Category::None, flat->parent(), path, 0, long_name);
-	}
+	flat_info_built_ = true;
 }
 
 // -----------------------------------------------------------------------------
@@ -645,4 +1233,8 @@ void MapTextureManager::setArchive(shared_ptr<Archive> archive)
 {
 	archive_ = archive;
 	refreshResources();
+
+	// The game configuration (and so which textures are available) may have
+	// changed too
+	clearTexInfo();
 }
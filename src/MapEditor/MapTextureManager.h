@@ -1,12 +1,19 @@
 #pragma once
 
+#include "Graphics/CTexture/TextureComposer.h"
+#include "Graphics/SImage/SImage.h"
+#include "Graphics/Translation.h"
 #include "OpenGL/GLTexture.h"
+#include "OpenGL/TextureArray.h"
+#include "Utility/NameKey.h"
+#include <unordered_set>
 
 namespace slade
 {
 class ArchiveDir;
 class Archive;
 class Palette;
+struct ResourceChanges;
 
 class MapTextureManager
 {
@@ -23,21 +30,38 @@ public:
 
 	struct Texture
 	{
-		unsigned gl_id         = 0;
-		bool     world_panning = false;
-		Vec2d    scale         = { 1., 1. };
-		~Texture() { gl::Texture::clear(gl_id); }
+		unsigned                gl_id         = 0;
+		gl::TextureArray::Layer layer;
+		bool                    world_panning = false;
+		Vec2d                   scale         = { 1., 1. };
+		unsigned                memory        = 0; // GPU memory used in bytes (0 if it can't be unloaded)
+		long                    last_used     = 0; // Time last requested or rendered (see markUsed)
+
+		// Average colours, calculated when the image is loaded
+		ColRGBA average_colour; // Whole image
+		ColRGBA average_top;    // Top 40% (eg. for sky caps)
+		ColRGBA average_bottom; // Bottom 40%
+
+		~Texture()
+		{
+			gl::Texture::clear(gl_id);
+			gl::TextureArray::remove(layer);
+		}
 	};
 	typedef std::map<string, Texture> MapTexHashMap;
+	typedef std::unordered_map<NameKey, Texture> MapTexKeyMap;
 
+	// Info about an available texture or flat. The name and path strings are
+	// interned in the texture manager, and are valid until the info lists are
+	// cleared (see setArchive)
 	struct TexInfo
 	{
-		string   short_name;
-		Category category;
-		Archive* archive;
-		string   path;
-		unsigned index;
-		string   long_name;
+		string_view short_name;
+		Category    category;
+		Archive*    archive;
+		string_view path;
+		unsigned    index;
+		string_view long_name;
 
 		TexInfo(
 			string_view short_name,
@@ -51,23 +75,43 @@ public:
 		}
 	};
 
+	// Signals
+	struct Signals
+	{
+		sigslot::signal<> textures_loaded; // Background composed textures were created (see uploadComposed)
+		sigslot::signal<const vector<unsigned>&> textures_unloaded; // GL textures unloaded to stay within budget
+	};
+
 	MapTextureManager(shared_ptr<Archive> archive = nullptr);
 	~MapTextureManager() = default;
 
+	Signals& signals() { return signals_; }
+
 	void init();
 	void setArchive(shared_ptr<Archive> archive);
 	void refreshResources();
+	void updateResources(const ResourceChanges& changes);
 
 	Palette*       resourcePalette() const;
-	const Texture& texture(string_view name, bool mixed);
+	const Texture& texture(string_view name, bool mixed, bool async = false);
+	const Texture* requestTexture(string_view name);
+	const Texture& placeholder();
+	bool           texturesPending() const { return !composing_.empty(); }
+	unsigned       prefetchTextures(const vector<string>& names);
+	unsigned       uploadComposed(unsigned max);
 	const Texture& flat(string_view name, bool mixed);
 	const Texture& sprite(string_view name, string_view translation = "", string_view palette = "");
 	const Texture& editorImage(string_view name);
 	int            verticalOffset(string_view name) const;
 
+	void     markUsed(unsigned gl_id) { used_ids_.insert(gl_id); }
+	void     enforceMemoryBudget();
+	size_t   memoryUsed() const { return memory_used_; }
+	unsigned unloadCount() const { return unload_count_; }
+
 	vector<TexInfo>& allTexturesInfo()
 	{
-		if (tex_info_.empty() && flat_info_.empty())
+		if (!tex_info_built_)
 			buildTexInfoList();
 
 		return tex_info_;
@@ -75,28 +119,65 @@ public:
 
 	vector<TexInfo>& allFlatsInfo()
 	{
-		if (tex_info_.empty() && flat_info_.empty())
-			buildTexInfoList();
+		if (!flat_info_built_)
+			buildFlatInfoList();
 
 		return flat_info_;
 	}
 
 private:
+	// Composite texture composed in the background (see requestTexture)
+	struct ComposedTexture
+	{
+		SImage  image;
+		bool    ok = false;
+		Texture texture; // Scale and world panning (no gl texture)
+	};
+
 	weak_ptr<Archive>   archive_;
-	MapTexHashMap       textures_;
-	MapTexHashMap       flats_;
+	MapTexKeyMap        textures_;
+	MapTexKeyMap        flats_;
 	MapTexHashMap       sprites_;
 	MapTexHashMap       editor_images_;
+	Texture             placeholder_;
 	bool                editor_images_loaded_ = false;
 	unique_ptr<Palette> palette_;
-	vector<TexInfo>     tex_info_;
-	vector<TexInfo>     flat_info_;
 
-	// Signal connections
-	sigslot::scoped_connection sc_resources_updated_;
+	// Texture/flat info lists, each built when first needed and then kept up
+	// to date with resource changes (see updateTexInfo)
+	vector<TexInfo>            tex_info_;
+	vector<TexInfo>            flat_info_;
+	bool                       tex_info_built_  = false;
+	bool                       flat_info_built_ = false;
+	std::unordered_set<string> info_strings_; // Interned TexInfo strings
+
+	// Parsed sprite translations, kept so their compiled tables can be reused
+	std::map<string, Translation, std::less<>> translations_;
+
+	// GPU memory budget
+	std::unordered_set<unsigned> used_ids_; // GL textures rendered since the last budget check
+	size_t                       memory_used_       = 0;
+	long                         last_budget_check_ = 0;
+
+	// Background texture composition
+	TextureComposer                               composer_;
+	std::map<string, unique_ptr<ComposedTexture>> composing_; // Null if not finished yet
+
+	// Incremented whenever cached textures are unloaded, so anything holding on
+	// to their gl ids can tell when it needs to look them up again
+	unsigned unload_count_ = 0;
+
+	// Signals
+	Signals                    signals_;
+	sigslot::scoped_connection sc_resources_changed_;
 	sigslot::scoped_connection sc_palette_changed_;
 
 	void buildTexInfoList();
+	void buildFlatInfoList();
+	void updateTexInfo(const ResourceChanges& changes);
+	void clearTexInfo();
+	void queueComposite(const string& name_upper, CTexture& ctex, Archive* archive);
+	void createComposed(const string& name_upper, const ComposedTexture& composed);
 	void importEditorImages(MapTexHashMap& map, const ArchiveDir* dir, string_view path) const;
 };
 } // namespace slade
@@ -0,0 +1,214 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapValidator.cpp
+// Description: MapValidator class - runs the inexpensive map checks on objects
+//              as they are modified, to show problems while editing
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapValidator.h"
+#include "App.h"
+#include "MapChecks.h"
+#include "SLADEMap/SLADEMap.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, map_live_checks, true, CVar::Flag::Save)
+namespace
+{
+// Checks that are cheap enough to run on objects as they are modified
+MapCheck::StandardCheck live_checks[] = { MapCheck::MissingTexture,
+										  MapCheck::InvalidLine,
+										  MapCheck::SectorReference,
+										  MapCheck::UnknownSpecial };
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [object] is currently part of [map]
+// -----------------------------------------------------------------------------
+bool inMap(const SLADEMap& map, MapObject* object)
+{
+	auto index = object->index();
+	switch (object->objType())
+	{
+	case MapObject::Type::Line: return index < map.nLines() && map.line(index) == object;
+	case MapObject::Type::Thing: return index < map.nThings() && map.thing(index) == object;
+	default: return false;
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MapValidator Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// MapValidator class constructor
+// -----------------------------------------------------------------------------
+MapValidator::MapValidator(SLADEMap& map) : map_{ map }
+{
+	for (auto type : live_checks)
+		checks_.push_back(MapCheck::standardCheck(type, &map_));
+}
+
+// -----------------------------------------------------------------------------
+// MapValidator class destructor
+// -----------------------------------------------------------------------------
+MapValidator::~MapValidator() = default;
+
+// -----------------------------------------------------------------------------
+// Re-checks any objects modified since the last update
+// -----------------------------------------------------------------------------
+void MapValidator::update()
+{
+	if (!map_live_checks)
+	{
+		if (!problems_.empty())
+			reset();
+		return;
+	}
+
+	auto& data = map_.mapData();
+	auto  time = app::runTimer();
+
+	// Check everything on the first update
+	vector<MapObject*> objects;
+	if (last_update_ < 0)
+	{
+		for (unsigned a = 0; a < map_.nLines(); ++a)
+			objects.push_back(map_.line(a));
+		for (unsigned a = 0; a < map_.nThings(); ++a)
+			objects.push_back(map_.thing(a));
+	}
+	else
+	{
+		// Forget about objects that have been removed from the map
+		if (data.objectsUpdated() >= last_update_)
+			removeRemovedObjects();
+
+		// Get lines and things affected by anything modified since the last
+		// update (lines depend on their sides, vertices and sectors too)
+		for (auto* object : data.modifiedObjects(last_update_, MapObject::Type::Object))
+		{
+			switch (object->objType())
+			{
+			case MapObject::Type::Line:
+			case MapObject::Type::Thing: objects.push_back(object); break;
+			case MapObject::Type::Side:
+				if (auto* line = dynamic_cast<MapSide*>(object)->parentLine())
+					objects.push_back(line);
+				break;
+			case MapObject::Type::Vertex:
+				for (auto* line : dynamic_cast<MapVertex*>(object)->connectedLines())
+					objects.push_back(line);
+				break;
+			case MapObject::Type::Sector:
+				for (auto* side : dynamic_cast<MapSector*>(object)->connectedSides())
+					if (side->parentLine())
+						objects.push_back(side->parentLine());
+				break;
+			default: break;
+			}
+		}
+
+		std::sort(objects.begin(), objects.end());
+		objects.erase(std::unique(objects.begin(), objects.end()), objects.end());
+	}
+
+	last_update_ = time;
+
+	if (!objects.empty())
+		checkObjects(objects);
+}
+
+// -----------------------------------------------------------------------------
+// Clears all problems, everything will be re-checked next update
+// -----------------------------------------------------------------------------
+void MapValidator::reset()
+{
+	last_update_ = -1;
+	problem_set_.clear();
+	problems_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Runs all live checks on [objects] and updates the list of objects with
+// problems accordingly
+// -----------------------------------------------------------------------------
+void MapValidator::checkObjects(vector<MapObject*>& objects)
+{
+	// Clear any previous problems for the objects
+	for (auto* object : objects)
+		problem_set_.erase(object);
+
+	// Re-check them
+	for (auto& check : checks_)
+	{
+		if (!check->checkObjects(objects))
+			continue;
+
+		for (unsigned a = 0; a < check->nProblems(); ++a)
+			if (auto* object = check->getObject(a))
+				problem_set_.insert(object);
+	}
+
+	problems_.assign(problem_set_.begin(), problem_set_.end());
+}
+
+// -----------------------------------------------------------------------------
+// Removes any objects no longer in the map from the list of problems
+// -----------------------------------------------------------------------------
+void MapValidator::removeRemovedObjects()
+{
+	for (auto i = problem_set_.begin(); i != problem_set_.end();)
+	{
+		if (inMap(map_, *i))
+			++i;
+		else
+			i = problem_set_.erase(i);
+	}
+
+	problems_.assign(problem_set_.begin(), problem_set_.end());
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <unordered_set>
+
+namespace slade
+{
+class MapCheck;
+class MapObject;
+class SLADEMap;
+
+// Keeps track of problems found by the inexpensive map checks while editing.
+// Only objects modified since the last update (and objects depending on them,
+// eg. the lines of a modified sector) are re-checked each update, so it can
+// be run continuously even on very large maps
+class MapValidator
+{
+public:
+	MapValidator(SLADEMap& map);
+	~MapValidator();
+
+	const vector<MapObject*>& problems() const { return problems_; }
+
+	void update();
+	void reset();
+
+private:
+	SLADEMap&                      map_;
+	vector<unique_ptr<MapCheck>>   checks_;
+	long                           last_update_ = -1;
+	std::unordered_set<MapObject*> problem_set_;
+	vector<MapObject*>             problems_;
+
+	void checkObjects(vector<MapObject*>& objects);
+	void removeRemovedObjects();
+};
+} // namespace slade
@@ -34,6 +34,9 @@
 #include "NodeBuilders.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
+#include "General/Defs.h"
+#include "General/Misc.h"
+#include "SLADEMap/MapFormat/UDMFReader.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
 
@@ -52,8 +55,148 @@ Builder         invalid;
 Builder         none;
 string          custom;
 vector<string>  builder_paths;
+bool            initialised = false;
 } // namespace slade::nodebuilders
 
+namespace
+{
+// Nodebuilder output for a map's geometry. Lumps that the nodebuilder didn't
+// change aren't stored, they're taken from the map being built instead
+struct CachedNodes
+{
+	struct Lump
+	{
+		string          name;
+		bool            cached = false;
+		vector<uint8_t> data;
+	};
+
+	string       key;
+	vector<Lump> lumps; // All lumps in the nodebuilder output, in order
+};
+
+constexpr unsigned  MAX_CACHED_NODES = 8;
+vector<CachedNodes> cached_nodes; // Most recently used last
+
+// Map lumps that are entirely included in the nodes cache key
+const char* geometry_lumps[] = { "VERTEXES", "LINEDEFS", "SIDEDEFS", "SECTORS" };
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Adds [size] bytes of [data] to the 64-bit FNV-1a [hash]
+// -----------------------------------------------------------------------------
+void hashData(uint64_t& hash, const void* data, size_t size)
+{
+	auto bytes = static_cast<const uint8_t*>(data);
+	for (size_t a = 0; a < size; ++a)
+	{
+		hash ^= bytes[a];
+		hash *= 0x100000001b3ull;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds [value] to the 64-bit FNV-1a [hash]
+// -----------------------------------------------------------------------------
+void hashProperty(uint64_t& hash, const Property& value)
+{
+	auto type = static_cast<uint8_t>(value.index());
+	hashData(hash, &type, 1);
+	std::visit(
+		[&hash](auto&& val)
+		{
+			using T = std::decay_t<decltype(val)>;
+			if constexpr (std::is_same_v<T, string>)
+				hashData(hash, val.data(), val.size());
+			else
+				hashData(hash, &val, sizeof(T));
+		},
+		value);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [type] is a polyobject anchor or start spot thing type.
+// These are the only things that affect the nodes built for a map
+// -----------------------------------------------------------------------------
+bool isPolyobjectThing(int type)
+{
+	return (type >= 3000 && type <= 3002) || (type >= 9300 && type <= 9303);
+}
+
+// -----------------------------------------------------------------------------
+// Adds the polyobject things in the binary [things] lump data to [hash], where
+// each thing is [record_size] bytes with its type at [type_offset]
+// -----------------------------------------------------------------------------
+void hashPolyobjectThings(uint64_t& hash, const MemChunk& things, unsigned record_size, unsigned type_offset)
+{
+	for (unsigned pos = 0; pos + record_size <= things.size(); pos += record_size)
+	{
+		int type = things[pos + type_offset] | (things[pos + type_offset + 1] << 8);
+		if (isPolyobjectThing(type))
+			hashData(hash, things.data() + pos, record_size);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds everything but non-polyobject things in the UDMF [textmap] to [hash].
+// Returns false if the text couldn't be read
+// -----------------------------------------------------------------------------
+bool hashTextmapGeometry(uint64_t& hash, const MemChunk& textmap)
+{
+	UDMFReader  reader({ reinterpret_cast<const char*>(textmap.data()), textmap.size() });
+	string_view name;
+	UDMFFields  fields;
+	while (true)
+	{
+		auto result = reader.next(name, fields);
+		if (result == UDMFReader::Result::End)
+			return true;
+		if (result == UDMFReader::Result::Unsupported)
+			return false;
+
+		// Ignore non-polyobject things
+		if (result == UDMFReader::Result::Block && name == "thing")
+		{
+			int type = 0;
+			for (auto& field : fields)
+				if (field.name == "type")
+					type = property::asInt(field.value);
+
+			if (!isPolyobjectThing(type))
+				continue;
+		}
+
+		hashData(hash, name.data(), name.size());
+		for (auto& field : fields)
+		{
+			hashData(hash, field.name.data(), field.name.size());
+			hashProperty(hash, field.value);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [name] is one of the lumps entirely included in the nodes
+// cache key
+// -----------------------------------------------------------------------------
+bool isGeometryLump(string_view name)
+{
+	for (auto lump : geometry_lumps)
+		if (strutil::equalCI(name, lump))
+			return true;
+
+	return false;
+}
+} // namespace
+
 
 // -----------------------------------------------------------------------------
 //
@@ -63,10 +206,15 @@ vector<string>  builder_paths;
 
 
 // -----------------------------------------------------------------------------
-// Loads all node builder definitions from the program resource
+// Loads all node builder definitions from the program resource, if they haven't
+// been already. This is done on first use rather than at startup
 // -----------------------------------------------------------------------------
 void nodebuilders::init()
 {
+	if (initialised)
+		return;
+	initialised = true;
+
 	// Init default builders
 	invalid.id = "invalid";
 	none.id    = "none";
@@ -142,11 +290,20 @@ void nodebuilders::addBuilderPath(string_view builder, string_view path)
 void nodebuilders::saveBuilderPaths(wxFile& file)
 {
 	file.Write("nodebuilder_paths\n{\n");
-	for (auto& builder : builders)
+	if (initialised)
 	{
-		auto path = builder.path;
-		std::replace(path.begin(), path.end(), '\\', '/');
-		file.Write(wxString::Format("\t%s \"%s\"\n", builder.id, path), wxConvUTF8);
+		for (auto& builder : builders)
+		{
+			auto path = builder.path;
+			std::replace(path.begin(), path.end(), '\\', '/');
+			file.Write(wxString::Format("\t%s \"%s\"\n", builder.id, path), wxConvUTF8);
+		}
+	}
+	else
+	{
+		// Builders were never loaded, so just write back the paths as read
+		for (unsigned a = 0; a < builder_paths.size(); a += 2)
+			file.Write(wxString::Format("\t%s \"%s\"\n", builder_paths[a], builder_paths[a + 1]), wxConvUTF8);
 	}
 	file.Write("}\n");
 }
@@ -156,6 +313,8 @@ void nodebuilders::saveBuilderPaths(wxFile& file)
 // -----------------------------------------------------------------------------
 unsigned nodebuilders::nNodeBuilders()
 {
+	init();
+
 	return builders.size();
 }
 
@@ -164,6 +323,8 @@ unsigned nodebuilders::nNodeBuilders()
 // -----------------------------------------------------------------------------
 nodebuilders::Builder& nodebuilders::builder(string_view id)
 {
+	init();
+
 	for (unsigned a = 0; a < builders.size(); a++)
 	{
 		if (builders[a].id == id)
@@ -178,9 +339,259 @@ nodebuilders::Builder& nodebuilders::builder(string_view id)
 // -----------------------------------------------------------------------------
 nodebuilders::Builder& nodebuilders::builder(unsigned index)
 {
+	init();
+
 	// Check index
 	if (index >= builders.size())
 		return invalid;
 
 	return builders[index];
 }
+
+// -----------------------------------------------------------------------------
+// Returns a key identifying the map geometry in [wad] (of [format]) and the
+// nodebuilder [builder_command], for use with the nodes cache.
+// Only things that can affect the nodes built are included, so eg. changing
+// thing properties gives the same key. Returns an empty string if the map
+// can't be cached
+// -----------------------------------------------------------------------------
+string nodebuilders::nodesCacheKey(Archive& wad, MapFormat format, string_view builder_command)
+{
+	if (format != MapFormat::Doom && format != MapFormat::Hexen && format != MapFormat::UDMF)
+		return {};
+
+	uint64_t hash = 0xcbf29ce484222325ull;
+	string   key{ builder_command };
+	for (unsigned a = 0; a < wad.numEntries(); a++)
+	{
+		auto        entry = wad.entryAt(a);
+		const auto& data  = entry->data();
+		if (isGeometryLump(entry->name()))
+			hashData(hash, data.data(), data.size());
+		else if (format != MapFormat::UDMF && strutil::equalCI(entry->name(), "THINGS"))
+		{
+			if (format == MapFormat::Hexen)
+				hashPolyobjectThings(hash, data, 20, 10);
+			else
+				hashPolyobjectThings(hash, data, 10, 6);
+		}
+		else if (format == MapFormat::UDMF && strutil::equalCI(entry->name(), "TEXTMAP"))
+		{
+			if (!hashTextmapGeometry(hash, data))
+				hashData(hash, data.data(), data.size());
+		}
+		else
+			continue;
+
+		key += fmt::format("|{}:{}:{:08x}", entry->name(), data.size(), data.crc());
+	}
+
+	return key + fmt::format("|{:016x}", hash);
+}
+
+// -----------------------------------------------------------------------------
+// Replaces the map lumps in [wad] with previously built nodebuilder output for
+// the same [key] (see nodesCacheKey), if any.
+// Returns false if there was nothing cached for [key]
+// -----------------------------------------------------------------------------
+bool nodebuilders::loadCachedNodes(Archive& wad, const string& key)
+{
+	if (key.empty())
+		return false;
+
+	auto cached = std::find_if(
+		cached_nodes.begin(), cached_nodes.end(), [&key](const CachedNodes& nodes) { return nodes.key == key; });
+	if (cached == cached_nodes.end())
+		return false;
+
+	// Build the output lumps, cached or from the current map
+	vector<shared_ptr<ArchiveEntry>> entries;
+	for (auto& lump : cached->lumps)
+	{
+		if (lump.cached)
+		{
+			auto entry = std::make_shared<ArchiveEntry>(lump.name);
+			entry->importMem(lump.data.data(), lump.data.size());
+			entries.push_back(entry);
+		}
+		else if (auto entry = wad.entry(lump.name))
+			entries.push_back(std::make_shared<ArchiveEntry>(*entry));
+		else
+			return false;
+	}
+
+	// Replace the wad contents
+	while (wad.numEntries() > 0)
+		wad.removeEntry(wad.entryAt(0));
+	for (auto& entry : entries)
+		wad.addEntry(entry);
+
+	// Move to most recently used
+	std::rotate(cached, cached + 1, cached_nodes.end());
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the nodebuilder output [output_wad] for [input_wad] to the nodes cache
+// as [key] (see nodesCacheKey).
+// The output isn't cached if the nodebuilder changed any lumps that aren't
+// fully covered by the key, or didn't change anything
+// -----------------------------------------------------------------------------
+void nodebuilders::cacheNodes(const string& key, Archive& input_wad, Archive& output_wad)
+{
+	if (key.empty())
+		return;
+
+	CachedNodes nodes;
+	nodes.key    = key;
+	bool changed = false;
+	for (unsigned a = 0; a < output_wad.numEntries(); a++)
+	{
+		auto entry = output_wad.entryAt(a);
+		auto input = input_wad.entry(entry->name());
+		nodes.lumps.push_back({ entry->name() });
+
+		// Unchanged lump, taken from the map being built when reused
+		if (input && input->size() == entry->size()
+			&& (entry->size() == 0 || memcmp(input->rawData(), entry->rawData(), entry->size()) == 0))
+			continue;
+
+		// Modified existing lumps can only be cached if they were part of the key
+		if (input && !isGeometryLump(entry->name()))
+			return;
+
+		nodes.lumps.back().cached = true;
+		nodes.lumps.back().data.assign(entry->rawData(), entry->rawData() + entry->size());
+		changed = true;
+	}
+
+	if (!changed)
+		return;
+
+	cached_nodes.erase(
+		std::remove_if(
+			cached_nodes.begin(), cached_nodes.end(), [&key](const CachedNodes& cached) { return cached.key == key; }),
+		cached_nodes.end());
+	cached_nodes.push_back(std::move(nodes));
+	if (cached_nodes.size() > MAX_CACHED_NODES)
+		cached_nodes.erase(cached_nodes.begin());
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// BuildProcess Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// BuildProcess class constructor
+// -----------------------------------------------------------------------------
+nodebuilders::BuildProcess::BuildProcess(const std::function<void(int)>& finished) :
+	wxProcess{ wxPROCESS_REDIRECT }, finished_{ finished }
+{
+	// Poll the nodebuilder's output while it's running
+	timer_.SetOwner(this);
+	Bind(
+		wxEVT_TIMER,
+		[this](wxTimerEvent&)
+		{
+			readOutput(GetInputStream());
+			readOutput(GetErrorStream());
+			logOutput(false);
+		});
+}
+
+// -----------------------------------------------------------------------------
+// Runs the nodebuilder [command] in the background.
+// Returns false if it couldn't be started
+// -----------------------------------------------------------------------------
+bool nodebuilders::BuildProcess::start(const wxString& command)
+{
+	log::info(wxString::Format("execute %s", command));
+	log::info(1, "Nodebuilder output:");
+
+	pid_ = wxExecute(command, wxEXEC_ASYNC | wxEXEC_HIDE_CONSOLE, this);
+	if (pid_ == 0)
+	{
+		log::error(wxString::Format("Unable to run nodebuilder: %s", command));
+		return false;
+	}
+
+	timer_.Start(100);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Kills the nodebuilder process without calling the finished callback
+// -----------------------------------------------------------------------------
+void nodebuilders::BuildProcess::cancel()
+{
+	finished_ = nullptr;
+	if (pid_ != 0)
+		Kill(pid_, wxSIGKILL, wxKILL_CHILDREN);
+}
+
+// -----------------------------------------------------------------------------
+// Called when the nodebuilder process exits
+// -----------------------------------------------------------------------------
+void nodebuilders::BuildProcess::OnTerminate(int pid, int status)
+{
+	timer_.Stop();
+	pid_ = 0;
+
+	// Log any remaining output
+	readOutput(GetInputStream());
+	readOutput(GetErrorStream());
+	logOutput(true);
+
+	if (finished_)
+		finished_(status);
+
+	delete this;
+}
+
+// -----------------------------------------------------------------------------
+// Reads everything currently available from [stream] into the output buffer
+// -----------------------------------------------------------------------------
+void nodebuilders::BuildProcess::readOutput(wxInputStream* stream)
+{
+	if (!stream)
+		return;
+
+	// CanRead won't block, so read a character at a time while it's true
+	while (stream->CanRead())
+	{
+		auto c = stream->GetC();
+		if (stream->LastRead() == 0)
+			break;
+		output_ += static_cast<char>(c);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Logs all complete lines in the output buffer, or everything in it if
+// [flush] is true
+// -----------------------------------------------------------------------------
+void nodebuilders::BuildProcess::logOutput(bool flush)
+{
+	size_t start = 0;
+	for (auto end = output_.find('\n'); end != string::npos; end = output_.find('\n', start))
+	{
+		auto line = string_view{ output_ }.substr(start, end - start);
+		if (!line.empty() && line.back() == '\r')
+			line.remove_suffix(1);
+		log::info(wxString{ line.data(), line.size() });
+		start = end + 1;
+	}
+	output_.erase(0, start);
+
+	if (flush && !output_.empty())
+	{
+		log::info(wxString{ output_ });
+		output_.clear();
+	}
+}
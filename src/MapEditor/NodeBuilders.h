@@ -1,5 +1,11 @@
 #pragma once
 
+namespace slade
+{
+class Archive;
+enum class MapFormat;
+} // namespace slade
+
 namespace slade::nodebuilders
 {
 struct Builder
@@ -19,4 +25,36 @@ void     saveBuilderPaths(wxFile& file);
 unsigned nNodeBuilders();
 Builder& builder(string_view id);
 Builder& builder(unsigned index);
+
+// Nodebuilder output cache
+string nodesCacheKey(Archive& wad, MapFormat format, string_view builder_command);
+bool   loadCachedNodes(Archive& wad, const string& key);
+void   cacheNodes(const string& key, Archive& input_wad, Archive& output_wad);
+
+// Runs a nodebuilder command in the background, logging its output as it is
+// written. The [finished] callback is called (from the main thread) once the
+// nodebuilder exits, after which the BuildProcess deletes itself - so it must
+// not be deleted while running, use cancel() instead
+class BuildProcess : public wxProcess
+{
+public:
+	BuildProcess(const std::function<void(int)>& finished);
+	~BuildProcess() override = default;
+
+	bool isRunning() const { return pid_ != 0; }
+
+	bool start(const wxString& command);
+	void cancel();
+
+	void OnTerminate(int pid, int status) override;
+
+private:
+	long                     pid_ = 0;
+	wxTimer                  timer_;
+	string                   output_;
+	std::function<void(int)> finished_;
+
+	void readOutput(wxInputStream* stream);
+	void logOutput(bool flush);
+};
 } // namespace slade::nodebuilders
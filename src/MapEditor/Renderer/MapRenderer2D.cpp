@@ -42,7 +42,11 @@
 #include "OpenGL/Drawing.h"
 #include "OpenGL/GLTexture.h"
 #include "OpenGL/OpenGL.h"
+#include "OpenGL/Profiler.h"
+#include "OpenGL/Shader.h"
+#include "OpenGL/View.h"
 #include "SLADEMap/SLADEMap.h"
+#include "Utility/MathStuff.h"
 #include "Utility/Polygon2D.h"
 
 using namespace slade;
@@ -73,6 +77,7 @@ CVAR(Bool, map_animate_tagged, true, CVar::Flag::Save)
 CVAR(Float, arrow_alpha, 1.0f, CVar::Flag::Save)
 CVAR(Bool, arrow_colour, false, CVar::Flag::Save)
 CVAR(Bool, flats_use_vbo, true, CVar::Flag::Save)
+CVAR(Bool, map_cache_layer, true, CVar::Flag::Save)
 CVAR(Int, halo_width, 5, CVar::Flag::Save)
 CVAR(Float, arrowhead_angle, 0.7854f, CVar::Flag::Save)
 CVAR(Float, arrowhead_length, 25.f, CVar::Flag::Save)
@@ -84,6 +89,313 @@ namespace
 {
 // Texture coordinates for rendering square things (since we can't just rotate these)
 float sq_thing_tc[] = { 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f };
+
+// Texture coordinates for thing overlays (selection, hilight, etc.)
+float overlay_tc[] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f };
+
+// GLSL sources for the GL 3.3 rendering path.
+// Positions are in map coordinates, transformed by the current view (mvp)
+const char* shader_vert_coloured = R"(#version 330 core
+in vec2 in_position;
+in vec4 in_colour;
+uniform mat4 mvp;
+out vec4 colour;
+void main()
+{
+	colour      = in_colour;
+	gl_Position = mvp * vec4(in_position, 0.0, 1.0);
+}
+)";
+
+const char* shader_frag_lines = R"(#version 330 core
+in vec4 colour;
+out vec4 frag_colour;
+void main()
+{
+	frag_colour = colour;
+}
+)";
+
+const char* shader_frag_points = R"(#version 330 core
+in vec4 colour;
+uniform sampler2D tex;
+uniform int textured;
+uniform int round;
+out vec4 frag_colour;
+void main()
+{
+	if (textured != 0)
+		frag_colour = texture(tex, gl_PointCoord) * colour;
+	else
+	{
+		if (round != 0 && length(gl_PointCoord - vec2(0.5)) > 0.5)
+			discard;
+		frag_colour = colour;
+	}
+}
+)";
+
+const char* shader_vert_textured = R"(#version 330 core
+in vec2 in_position;
+in vec4 in_colour;
+in vec2 in_texcoord;
+uniform mat4 mvp;
+out vec4 colour;
+out vec2 texcoord;
+void main()
+{
+	colour      = in_colour;
+	texcoord    = in_texcoord;
+	gl_Position = mvp * vec4(in_position, 0.0, 1.0);
+}
+)";
+
+const char* shader_frag_textured = R"(#version 330 core
+in vec4 colour;
+in vec2 texcoord;
+uniform sampler2D tex;
+uniform int textured;
+out vec4 frag_colour;
+void main()
+{
+	if (textured != 0)
+		frag_colour = texture(tex, texcoord) * colour;
+	else
+		frag_colour = colour;
+}
+)";
+
+const char* shader_vert_flats = R"(#version 330 core
+in vec2 in_position;
+in vec2 in_texcoord;
+uniform mat4 mvp;
+out vec2 texcoord;
+void main()
+{
+	texcoord    = in_texcoord;
+	gl_Position = mvp * vec4(in_position, 0.0, 1.0);
+}
+)";
+
+const char* shader_frag_flats = R"(#version 330 core
+in vec2 texcoord;
+uniform sampler2D tex;
+uniform int textured;
+uniform vec4 colour;
+out vec4 frag_colour;
+void main()
+{
+	if (textured != 0)
+		frag_colour = texture(tex, texcoord) * colour;
+	else
+		frag_colour = colour;
+}
+)";
+
+// Point light previews: each instance is a quad (corners -1 to 1) scaled by
+// the light radius, faded out radially from the light's position
+const char* shader_vert_lights = R"(#version 330 core
+in vec2 in_position;
+in vec3 in_instance;
+in vec3 in_colour;
+uniform mat4 mvp;
+out vec3 colour;
+out vec2 offset;
+void main()
+{
+	colour      = in_colour;
+	offset      = in_position;
+	gl_Position = mvp * vec4(in_instance.xy + in_position * in_instance.z, 0.0, 1.0);
+}
+)";
+
+const char* shader_frag_lights = R"(#version 330 core
+in vec3 colour;
+in vec2 offset;
+uniform float alpha;
+out vec4 frag_colour;
+void main()
+{
+	float falloff = 1.0 - length(offset);
+	if (falloff <= 0.0)
+		discard;
+	frag_colour = vec4(colour, alpha * falloff * falloff);
+}
+)";
+
+// -----------------------------------------------------------------------------
+// Adds a textured quad [x1,y1]-[x2,y2] to [buffer] as 2 triangles, with
+// texture coordinates [tc] (for corners x1y1, x1y2, x2y2, x2y1)
+// -----------------------------------------------------------------------------
+void addThingQuad(
+	gl::VertexBuffer2D& buffer,
+	double              x1,
+	double              y1,
+	double              x2,
+	double              y2,
+	const float*        tc,
+	const ColRGBA&      colour)
+{
+	buffer.add(x1, y1, tc[0], tc[1], colour);
+	buffer.add(x1, y2, tc[2], tc[3], colour);
+	buffer.add(x2, y2, tc[4], tc[5], colour);
+	buffer.add(x1, y1, tc[0], tc[1], colour);
+	buffer.add(x2, y2, tc[4], tc[5], colour);
+	buffer.add(x2, y1, tc[6], tc[7], colour);
+}
+
+// -----------------------------------------------------------------------------
+// Adds a textured square of [radius] centered on [x,y] and rotated by [angle]
+// degrees to [buffer] as 2 triangles, with texture coordinates [tc]
+// -----------------------------------------------------------------------------
+void addRotatedThingQuad(
+	gl::VertexBuffer2D& buffer,
+	double              x,
+	double              y,
+	double              radius,
+	double              angle,
+	const float*        tc,
+	const ColRGBA&      colour)
+{
+	if (angle == 0.)
+	{
+		addThingQuad(buffer, x - radius, y - radius, x + radius, y + radius, tc, colour);
+		return;
+	}
+
+	double rad = math::degToRad(angle);
+	double c   = cos(rad) * radius;
+	double s   = sin(rad) * radius;
+
+	// Rotated corners (-r,-r), (-r,r), (r,r), (r,-r)
+	Vec2d p1{ x - c + s, y - s - c };
+	Vec2d p2{ x - c - s, y - s + c };
+	Vec2d p3{ x + c - s, y + s + c };
+	Vec2d p4{ x + c + s, y + s - c };
+
+	buffer.add(p1.x, p1.y, tc[0], tc[1], colour);
+	buffer.add(p2.x, p2.y, tc[2], tc[3], colour);
+	buffer.add(p3.x, p3.y, tc[4], tc[5], colour);
+	buffer.add(p1.x, p1.y, tc[0], tc[1], colour);
+	buffer.add(p3.x, p3.y, tc[4], tc[5], colour);
+	buffer.add(p4.x, p4.y, tc[6], tc[7], colour);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the icon colour for a thing of [type] with [args] (for point lights)
+// -----------------------------------------------------------------------------
+ColRGBA thingColour(const game::ThingType& type, const MapObject::ArgSet& args, float alpha)
+{
+	uint8_t a   = 255 * alpha;
+	auto    arg = [&args](int index) { return static_cast<uint8_t>(std::clamp(args[index], 0, 255)); };
+	if (type.pointLight().empty())
+		return { type.colour().r, type.colour().g, type.colour().b, a };
+	if (type.pointLight() == "zdoom")
+		return { arg(0), arg(1), arg(2), a };
+	if (type.pointLight() == "vavoom")
+		return { arg(1), arg(2), arg(3), a };
+
+	return { 255, 255, 255, a };
+}
+
+// -----------------------------------------------------------------------------
+// Gets the preview [colour] and [radius] of [thing] if it is a point light.
+// Returns false if it isn't
+// -----------------------------------------------------------------------------
+bool pointLightPreview(const MapThing& thing, ColRGBA& colour, double& radius)
+{
+	const auto& light = thing.typeDef().pointLight();
+	if (light.empty())
+		return false;
+
+	auto arg = [&thing](int index) { return static_cast<uint8_t>(std::clamp(thing.arg(index), 0, 255)); };
+
+	// ZDoom point light
+	if (light == "zdoom")
+	{
+		colour.set(arg(0), arg(1), arg(2));
+		radius = thing.arg(3);
+	}
+
+	// Vavoom point light
+	else if (light == "vavoom")
+	{
+		colour.set(arg(1), arg(2), arg(3));
+		radius = thing.arg(0);
+	}
+
+	// Vavoom white light
+	else if (light == "vavoom_white")
+	{
+		colour.set(255, 255, 255);
+		radius = thing.arg(0);
+	}
+
+	else
+		return false;
+
+	radius *= 2; // Doubling the radius value matches better with in-game results
+	return radius > 0;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the current GL colour and blend mode to colour [name] from the colour
+// configuration (with alpha multiplied by [alpha_mult]), and returns the colour
+// -----------------------------------------------------------------------------
+ColRGBA setOverlayColour(const string& name, float alpha_mult = 1.0f)
+{
+	auto& def = colourconfig::colDef(name);
+	auto  col = def.colour;
+	col.a *= alpha_mult;
+	gl::setColour(col, def.blendMode());
+	return col;
+}
+
+// -----------------------------------------------------------------------------
+// Merges the indices of [objects] (which must be in index order) into runs of
+// consecutive indices, written to [first] and [count]
+// -----------------------------------------------------------------------------
+template<class T> void buildIndexRuns(const vector<T*>& objects, vector<int>& first, vector<int>& count)
+{
+	first.clear();
+	count.clear();
+	for (auto object : objects)
+	{
+		int index = object->index();
+		if (!first.empty() && first.back() + count.back() == index)
+			++count.back();
+		else
+		{
+			first.push_back(index);
+			count.push_back(1);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Draws the runs of objects [first] and [count] from the currently bound VBO as
+// [primitive], where each object is [object_verts] vertices
+// -----------------------------------------------------------------------------
+void drawIndexRuns(unsigned primitive, const vector<int>& first, const vector<int>& count, int object_verts)
+{
+	if (first.empty())
+		return;
+
+	if (object_verts == 1)
+	{
+		glMultiDrawArrays(primitive, first.data(), count.data(), first.size());
+		return;
+	}
+
+	vector<GLint>   vert_first(first.size());
+	vector<GLsizei> vert_count(count.size());
+	for (unsigned a = 0; a < first.size(); a++)
+	{
+		vert_first[a] = first[a] * object_verts;
+		vert_count[a] = count[a] * object_verts;
+	}
+	glMultiDrawArrays(primitive, vert_first.data(), vert_count.data(), vert_first.size());
+}
 } // namespace
 
 
@@ -113,12 +425,119 @@ MapRenderer2D::~MapRenderer2D()
 		glDeleteBuffers(1, &vbo_lines_);
 	if (vbo_flats_ > 0)
 		glDeleteBuffers(1, &vbo_flats_);
+	if (vbo_light_quad_ > 0)
+		glDeleteBuffers(1, &vbo_light_quad_);
+	if (vbo_light_instances_ > 0)
+		glDeleteBuffers(1, &vbo_light_instances_);
 	if (list_vertices_ > 0)
 		glDeleteLists(list_vertices_, 1);
 	if (list_lines_ > 0)
 		glDeleteLists(list_lines_, 1);
 }
 
+// -----------------------------------------------------------------------------
+// Binds the shader program for [type], loading it first if needed, and sets
+// its view transformation from the current GL matrices.
+// Returns nullptr (and leaves fixed-function rendering active) if shaders are
+// unsupported/disabled or the program failed to load
+// -----------------------------------------------------------------------------
+const gl::Shader* MapRenderer2D::bindShader(ShaderType type) const
+{
+	if (!gl::shaderSupport())
+		return nullptr;
+
+	auto& shader = shaders_[static_cast<int>(type)];
+	if (!shader)
+	{
+		switch (type)
+		{
+		case ShaderType::Lines:
+			shader = std::make_unique<gl::Shader>("map2d_lines");
+			shader->load(shader_vert_coloured, shader_frag_lines);
+			break;
+		case ShaderType::Points:
+			shader = std::make_unique<gl::Shader>("map2d_points");
+			shader->load(shader_vert_coloured, shader_frag_points);
+			break;
+		case ShaderType::Flats:
+			shader = std::make_unique<gl::Shader>("map2d_flats");
+			shader->load(shader_vert_flats, shader_frag_flats);
+			break;
+		case ShaderType::Things:
+			shader = std::make_unique<gl::Shader>("map2d_things");
+			shader->load(shader_vert_textured, shader_frag_textured);
+			break;
+		case ShaderType::Lights:
+			shader = std::make_unique<gl::Shader>("map2d_lights");
+			shader->load(shader_vert_lights, shader_frag_lights);
+			break;
+		}
+	}
+
+	// Don't keep retrying a program that failed to compile
+	if (!shader->isValid())
+		return nullptr;
+
+	shader->bind();
+	shader->setFixedFunctionMVP();
+	return shader.get();
+}
+
+// -----------------------------------------------------------------------------
+// Binds the points shader program, for rendering vertices set up by
+// setupVertexRendering. [point] is true if a point sprite texture is bound
+// -----------------------------------------------------------------------------
+const gl::Shader* MapRenderer2D::bindPointShader(bool point) const
+{
+	auto shader = bindShader(ShaderType::Points);
+	if (shader)
+	{
+		// gl_PointCoord is needed for round untextured points too
+		glEnable(GL_POINT_SPRITE);
+		shader->setUniform("tex", 0);
+		shader->setUniform("textured", point ? 1 : 0);
+		shader->setUniform("round", vertex_round ? 1 : 0);
+	}
+
+	return shader;
+}
+
+// -----------------------------------------------------------------------------
+// Renders the contents of the overlay buffer as [primitive] in one draw call,
+// using the appropriate shader program if supported, and clears it after
+// -----------------------------------------------------------------------------
+void MapRenderer2D::drawOverlayBuffer(unsigned primitive) const
+{
+	if (overlay_buffer_.empty())
+		return;
+
+	auto shader = bindShader(ShaderType::Lines);
+	overlay_buffer_.draw(primitive, shader);
+	if (shader)
+		gl::Shader::unbind();
+
+	overlay_buffer_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Renders the contents of the overlay buffer as points set up by
+// setupVertexRendering ([point] is its return value), then clears it and
+// resets the point sprite state
+// -----------------------------------------------------------------------------
+void MapRenderer2D::renderOverlayPoints(bool point) const
+{
+	auto shader = bindPointShader(point);
+	overlay_buffer_.draw(GL_POINTS, shader);
+	if (shader)
+		gl::Shader::unbind();
+	overlay_buffer_.clear();
+
+	if (point || shader)
+		glDisable(GL_POINT_SPRITE);
+	if (point)
+		glDisable(GL_TEXTURE_2D);
+}
+
 // -----------------------------------------------------------------------------
 // Sets up the renderer for vertices (point sprites, etc.).
 // If [overlay] is true, use the point sprite for hilight/selection/etc
@@ -182,6 +601,8 @@ bool MapRenderer2D::setupVertexRendering(float size_scale, bool overlay) const
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderVertices(float alpha)
 {
+	gl::profiler::Scope profile{ "2d: Vertices" };
+
 	// Check there are any vertices to render
 	if (map_->nVertices() == 0)
 		return;
@@ -200,7 +621,17 @@ void MapRenderer2D::renderVertices(float alpha)
 
 	// Render the vertices depending on what features are supported
 	if (gl::vboSupport())
-		renderVerticesVBO();
+	{
+		auto shader = bindPointShader(point);
+		if (shader)
+			glVertexAttrib4f(gl::attrib::COLOUR, col.fr(), col.fg(), col.fb(), col.fa() * alpha);
+		renderVerticesVBO(shader);
+		if (shader)
+		{
+			gl::Shader::unbind();
+			glDisable(GL_POINT_SPRITE);
+		}
+	}
 	else
 		renderVerticesImmediate();
 
@@ -241,9 +672,10 @@ void MapRenderer2D::renderVerticesImmediate()
 }
 
 // -----------------------------------------------------------------------------
-// Renders vertices using an OpenGL Vertex Buffer Object
+// Renders vertices using an OpenGL Vertex Buffer Object.
+// If [shader] is given, it must be the bound points shader program
 // -----------------------------------------------------------------------------
-void MapRenderer2D::renderVerticesVBO()
+void MapRenderer2D::renderVerticesVBO(const gl::Shader* shader)
 {
 	// Do nothing if there are no vertices in the map
 	if (map_->nVertices() == 0)
@@ -251,7 +683,25 @@ void MapRenderer2D::renderVerticesVBO()
 
 	// Update vertices VBO if required
 	if (vbo_vertices_ == 0 || map_->nVertices() != n_vertices_ || map_->geometryUpdated() > vertices_updated_)
-		updateVerticesVBO();
+	{
+		if (!updateModifiedVerticesVBO())
+			updateVerticesVBO();
+	}
+
+	// Get vertices in view
+	updateVisibleObjects();
+
+	// Shader program bound, use generic vertex attributes (colour is constant,
+	// set by the caller)
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_vertices_);
+	if (shader)
+	{
+		gl::VertexBuffer2D::setupAttribPointers(8, 0);
+		drawIndexRuns(GL_POINTS, visible_.vertex_first, visible_.vertex_count, 1);
+		gl::VertexBuffer2D::clearAttribPointers();
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		return;
+	}
 
 	// Set VBO arrays to use
 	glEnableClientState(GL_VERTEX_ARRAY);
@@ -259,11 +709,10 @@ void MapRenderer2D::renderVerticesVBO()
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 
 	// Setup VBO pointers
-	glBindBuffer(GL_ARRAY_BUFFER, vbo_vertices_);
 	glVertexPointer(2, GL_FLOAT, 0, nullptr);
 
 	// Render the VBO
-	glDrawArrays(GL_POINTS, 0, map_->nVertices());
+	drawIndexRuns(GL_POINTS, visible_.vertex_first, visible_.vertex_count, 1);
 
 	// Cleanup state
 	glDisableClientState(GL_VERTEX_ARRAY);
@@ -275,6 +724,8 @@ void MapRenderer2D::renderVerticesVBO()
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderVertexHilight(int index, float fade) const
 {
+	gl::profiler::Scope profile{ "2d: Hilight" };
+
 	// Check hilight
 	if (!map_->vertex(index))
 		return;
@@ -284,21 +735,14 @@ void MapRenderer2D::renderVertexHilight(int index, float fade) const
 		fade = 1.0f;
 
 	// Set hilight colour
-	colourconfig::setGLColour("map_hilight", fade);
+	overlay_buffer_.setColour(setOverlayColour("map_hilight", fade));
 
 	// Setup rendering properties
 	bool point = setupVertexRendering(1.8f + (0.6f * fade), true);
 
 	// Draw vertex
-	glBegin(GL_POINTS);
-	glVertex2d(map_->vertex(index)->xPos(), map_->vertex(index)->yPos());
-	glEnd();
-
-	if (point)
-	{
-		glDisable(GL_POINT_SPRITE);
-		glDisable(GL_TEXTURE_2D);
-	}
+	overlay_buffer_.add(map_->vertex(index)->xPos(), map_->vertex(index)->yPos());
+	renderOverlayPoints(point);
 }
 
 // -----------------------------------------------------------------------------
@@ -315,26 +759,23 @@ void MapRenderer2D::renderVertexSelection(const ItemSelection& selection, float
 		fade = 1.0f;
 
 	// Set selection colour
-	auto& col = colourconfig::colDef("map_selection");
-	gl::setColour(col.colour.r, col.colour.g, col.colour.b, 255, col.blendMode());
+	auto& def = colourconfig::colDef("map_selection");
+	auto  col = def.colour;
+	col.a     = 255;
+	gl::setColour(col, def.blendMode());
+	overlay_buffer_.setColour(col);
 
 	// Setup rendering properties
 	bool point = setupVertexRendering(1.8f, true);
 
 	// Draw selected vertices
-	glBegin(GL_POINTS);
+	overlay_buffer_.reserve(selection.size());
 	for (const auto& item : selection)
 	{
 		if (auto v = item.asVertex(*map_))
-			glVertex2d(v->xPos(), v->yPos());
-	}
-	glEnd();
-
-	if (point)
-	{
-		glDisable(GL_POINT_SPRITE);
-		glDisable(GL_TEXTURE_2D);
+			overlay_buffer_.add(v->xPos(), v->yPos());
 	}
+	renderOverlayPoints(point);
 }
 
 // -----------------------------------------------------------------------------
@@ -371,6 +812,8 @@ ColRGBA MapRenderer2D::lineColour(const MapLine* line, bool ignore_filter) const
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderLines(bool show_direction, float alpha)
 {
+	gl::profiler::Scope profile{ "2d: Lines" };
+
 	// Check there are any lines to render
 	if (map_->nLines() == 0)
 		return;
@@ -469,31 +912,43 @@ void MapRenderer2D::renderLinesVBO(bool show_direction, float alpha)
 	if (vbo_lines_ == 0 || show_direction != lines_dirs_ || map_->nLines() != n_lines_
 		|| map_->geometryUpdated() > lines_updated_
 		|| map_->mapData().modifiedSince(lines_updated_, MapObject::Type::Line))
-		updateLinesVBO(show_direction, alpha);
+	{
+		if (!updateModifiedLinesVBO(show_direction, alpha))
+			updateLinesVBO(show_direction, alpha);
+	}
 
 	// Disable any blending
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	// Set VBO arrays to use
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-
-	// Setup VBO pointers
+	// Setup VBO pointers (generic attributes if using the lines shader)
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_lines_);
-	glVertexPointer(2, GL_FLOAT, 24, nullptr);
-
-	glColorPointer(4, GL_FLOAT, 24, ((char*)nullptr + 8));
-
-	// Render the VBO
-	if (show_direction)
-		glDrawArrays(GL_LINES, 0, map_->nLines() * 4);
+	auto shader = bindShader(ShaderType::Lines);
+	if (shader)
+		gl::VertexBuffer2D::setupAttribPointers(sizeof(GLVert), offsetof(GLVert, r));
 	else
-		glDrawArrays(GL_LINES, 0, map_->nLines() * 2);
+	{
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glVertexPointer(2, GL_FLOAT, 24, nullptr);
+		glColorPointer(4, GL_FLOAT, 24, ((char*)nullptr + 8));
+	}
+
+	// Render the VBO (lines in view only)
+	updateVisibleObjects();
+	drawIndexRuns(GL_LINES, visible_.line_first, visible_.line_count, show_direction ? 4 : 2);
 
 	// Clean state
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
+	if (shader)
+	{
+		gl::VertexBuffer2D::clearAttribPointers();
+		gl::Shader::unbind();
+	}
+	else
+	{
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glDisableClientState(GL_COLOR_ARRAY);
+	}
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
 	lines_dirs_ = show_direction;
@@ -504,6 +959,8 @@ void MapRenderer2D::renderLinesVBO(bool show_direction, float alpha)
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderLineHilight(int index, float fade) const
 {
+	gl::profiler::Scope profile{ "2d: Hilight" };
+
 	// Check hilight
 	if (!map_->line(index))
 		return;
@@ -513,29 +970,16 @@ void MapRenderer2D::renderLineHilight(int index, float fade) const
 		fade = 1.0f;
 
 	// Set hilight colour
-	colourconfig::setGLColour("map_hilight", fade);
+	overlay_buffer_.setColour(setOverlayColour("map_hilight", fade));
 
 	// Setup rendering properties
 	glLineWidth(line_width * colourconfig::lineHilightWidth());
 
-	// Render line
-	auto   line = map_->line(index);
-	double x1   = line->v1()->xPos();
-	double y1   = line->v1()->yPos();
-	double x2   = line->v2()->xPos();
-	double y2   = line->v2()->yPos();
-	glBegin(GL_LINES);
-	glVertex2d(x1, y1);
-	glVertex2d(x2, y2);
-	glEnd();
-
-	// Direction tab
-	auto mid = line->getPoint(MapObject::Point::Mid);
-	auto tab = line->dirTabPoint();
-	glBegin(GL_LINES);
-	glVertex2d(mid.x, mid.y);
-	glVertex2d(tab.x, tab.y);
-	glEnd();
+	// Render line + direction tab
+	auto line = map_->line(index);
+	overlay_buffer_.addLine(line->x1(), line->y1(), line->x2(), line->y2());
+	overlay_buffer_.addLine(line->getPoint(MapObject::Point::Mid), line->dirTabPoint());
+	drawOverlayBuffer(GL_LINES);
 }
 
 // -----------------------------------------------------------------------------
@@ -552,30 +996,25 @@ void MapRenderer2D::renderLineSelection(const ItemSelection& selection, float fa
 		fade = 1.0f;
 
 	// Set selection colour
-	colourconfig::setGLColour("map_selection", fade);
+	overlay_buffer_.setColour(setOverlayColour("map_selection", fade));
 
 	// Setup rendering properties
 	glLineWidth(line_width * colourconfig::lineSelectionWidth());
 
 	// Render selected lines
-	MapLine* line;
-	glBegin(GL_LINES);
+	overlay_buffer_.reserve(selection.size() * 4);
 	for (const auto& item : selection)
 	{
-		if ((line = item.asLine(*map_)))
+		if (auto line = item.asLine(*map_))
 		{
 			// Draw line
-			glVertex2d(line->x1(), line->y1());
-			glVertex2d(line->x2(), line->y2());
+			overlay_buffer_.addLine(line->x1(), line->y1(), line->x2(), line->y2());
 
 			// Direction tab
-			auto mid = line->getPoint(MapObject::Point::Mid);
-			auto tab = line->dirTabPoint();
-			glVertex2d(mid.x, mid.y);
-			glVertex2d(tab.x, tab.y);
+			overlay_buffer_.addLine(line->getPoint(MapObject::Point::Mid), line->dirTabPoint());
 		}
 	}
-	glEnd();
+	drawOverlayBuffer(GL_LINES);
 }
 
 // -----------------------------------------------------------------------------
@@ -596,33 +1035,22 @@ void MapRenderer2D::renderTaggedLines(const vector<MapLine*>& lines, float fade)
 	// Setup rendering properties
 	glLineWidth(line_width * colourconfig::lineHilightWidth());
 
-	// Go through tagged lines
-	double x1, y1, x2, y2;
-	auto   object = mapeditor::editContext().selection().hilightedObject();
+	// Render tagged lines (+ direction tabs) in one batch
+	overlay_buffer_.setColour(col);
+	overlay_buffer_.reserve(lines.size() * 4);
 	for (auto line : lines)
 	{
-		// Render line
-		x1 = line->v1()->xPos();
-		y1 = line->v1()->yPos();
-		x2 = line->v2()->xPos();
-		y2 = line->v2()->yPos();
-		glBegin(GL_LINES);
-		glVertex2d(x1, y1);
-		glVertex2d(x2, y2);
-		glEnd();
-
-		// Direction tab
-		auto mid = line->getPoint(MapObject::Point::Mid);
-		auto tab = line->dirTabPoint();
-		glBegin(GL_LINES);
-		glVertex2d(mid.x, mid.y);
-		glVertex2d(tab.x, tab.y);
-		glEnd();
+		overlay_buffer_.addLine(line->x1(), line->y1(), line->x2(), line->y2());
+		overlay_buffer_.addLine(line->getPoint(MapObject::Point::Mid), line->dirTabPoint());
+	}
+	drawOverlayBuffer(GL_LINES);
 
-		// Action lines
-		if (object && action_lines)
-		{
-			glLineWidth(line_width * 1.5f);
+	// Action lines
+	auto object = mapeditor::editContext().selection().hilightedObject();
+	if (object && action_lines)
+	{
+		glLineWidth(line_width * 1.5f);
+		for (auto line : lines)
 			drawing::drawArrow(
 				line->getPoint(MapObject::Point::Within),
 				object->getPoint(MapObject::Point::Within),
@@ -630,8 +1058,6 @@ void MapRenderer2D::renderTaggedLines(const vector<MapLine*>& lines, float fade)
 				false,
 				arrowhead_angle,
 				arrowhead_length);
-			glLineWidth(line_width * 3);
-		}
 	}
 }
 
@@ -653,33 +1079,22 @@ void MapRenderer2D::renderTaggingLines(const vector<MapLine*>& lines, float fade
 	// Setup rendering properties
 	glLineWidth(line_width * colourconfig::lineHilightWidth());
 
-	// Go through tagging lines
-	double x1, y1, x2, y2;
-	auto   object = mapeditor::editContext().selection().hilightedObject();
+	// Render tagging lines (+ direction tabs) in one batch
+	overlay_buffer_.setColour(col);
+	overlay_buffer_.reserve(lines.size() * 4);
 	for (auto line : lines)
 	{
-		// Render line
-		x1 = line->v1()->xPos();
-		y1 = line->v1()->yPos();
-		x2 = line->v2()->xPos();
-		y2 = line->v2()->yPos();
-		glBegin(GL_LINES);
-		glVertex2d(x1, y1);
-		glVertex2d(x2, y2);
-		glEnd();
-
-		// Direction tab
-		auto mid = line->getPoint(MapObject::Point::Mid);
-		auto tab = line->dirTabPoint();
-		glBegin(GL_LINES);
-		glVertex2d(mid.x, mid.y);
-		glVertex2d(tab.x, tab.y);
-		glEnd();
+		overlay_buffer_.addLine(line->x1(), line->y1(), line->x2(), line->y2());
+		overlay_buffer_.addLine(line->getPoint(MapObject::Point::Mid), line->dirTabPoint());
+	}
+	drawOverlayBuffer(GL_LINES);
 
-		// Action lines
-		if (object && action_lines)
-		{
-			glLineWidth(line_width * 1.5f);
+	// Action lines
+	auto object = mapeditor::editContext().selection().hilightedObject();
+	if (object && action_lines)
+	{
+		glLineWidth(line_width * 1.5f);
+		for (auto line : lines)
 			drawing::drawArrow(
 				object->getPoint(MapObject::Point::Within),
 				line->getPoint(MapObject::Point::Within),
@@ -687,101 +1102,73 @@ void MapRenderer2D::renderTaggingLines(const vector<MapLine*>& lines, float fade
 				false,
 				arrowhead_angle,
 				arrowhead_length);
-			glLineWidth(line_width * 5);
-		}
 	}
 }
 
 // -----------------------------------------------------------------------------
-// Sets up the renderer for thing overlays (point sprites, etc.)
+// Renders markers for lines and things in [objects] that have problems found
+// by the live map checks
 // -----------------------------------------------------------------------------
-bool MapRenderer2D::setupThingOverlay() const
+void MapRenderer2D::renderProblemMarkers(const vector<MapObject*>& objects) const
 {
-	// Get hilight texture
-	auto tex = mapeditor::textureManager().editorImage("thing/hilight").gl_id;
-	if (thing_drawtype == ThingDrawType::Square || thing_drawtype == ThingDrawType::SquareSprite
-		|| thing_drawtype == ThingDrawType::FramedSprite)
-		tex = mapeditor::textureManager().editorImage("thing/square/hilight").gl_id;
+	// Set colour
+	overlay_buffer_.setColour(setOverlayColour("map_line_invalid"));
 
-	// Nothing to do if thing_overlay_square is true and thing_drawtype is 1 or 2 (circles or sprites)
-	// or if the hilight circle texture isn't found for some reason
-	if (!tex
-		|| (thing_overlay_square
-			&& (thing_drawtype == ThingDrawType::Round || thing_drawtype == ThingDrawType::Sprite)))
+	// Setup rendering properties
+	glLineWidth(line_width * colourconfig::lineHilightWidth());
+
+	for (auto object : objects)
 	{
-		glDisable(GL_TEXTURE_2D);
-		return false;
+		if (object->objType() == MapObject::Type::Line)
+		{
+			// Line
+			auto line = dynamic_cast<MapLine*>(object);
+			overlay_buffer_.addLine(line->x1(), line->y1(), line->x2(), line->y2());
+		}
+		else if (object->objType() == MapObject::Type::Thing)
+		{
+			// Thing (box around its radius)
+			auto   thing  = dynamic_cast<MapThing*>(object);
+			double radius = thing->typeDef().radius() + 4;
+			double x1     = thing->xPos() - radius;
+			double y1     = thing->yPos() - radius;
+			double x2     = thing->xPos() + radius;
+			double y2     = thing->yPos() + radius;
+			overlay_buffer_.addRectOutline(x1, y1, x2, y2);
+		}
 	}
+	drawOverlayBuffer(GL_LINES);
+}
 
-	// Otherwise, we want the textured selection overlay
-	glEnable(GL_TEXTURE_2D);
-	gl::Texture::bind(tex);
+// -----------------------------------------------------------------------------
+// Returns the texture to use for thing overlays (selection, etc.), or 0 if
+// they should be drawn as plain squares
+// -----------------------------------------------------------------------------
+unsigned MapRenderer2D::thingOverlayTexture() const
+{
+	// Plain squares if thing_overlay_square is true and thing_drawtype is 1 or 2 (circles or sprites)
+	if (thing_overlay_square && (thing_drawtype == ThingDrawType::Round || thing_drawtype == ThingDrawType::Sprite))
+		return 0;
 
-	// Setup point sprites if supported
-	bool point = false;
-	if (gl::pointSpriteSupport())
-	{
-		glEnable(GL_POINT_SPRITE);
-		glTexEnvi(GL_POINT_SPRITE, GL_COORD_REPLACE, GL_TRUE);
-		point = true;
-	}
+	// Get hilight texture (if it isn't found for some reason, also use plain squares)
+	if (thing_drawtype == ThingDrawType::Square || thing_drawtype == ThingDrawType::SquareSprite
+		|| thing_drawtype == ThingDrawType::FramedSprite)
+		return mapeditor::textureManager().editorImage("thing/square/hilight").gl_id;
 
-	return point;
+	return mapeditor::textureManager().editorImage("thing/hilight").gl_id;
 }
 
 // -----------------------------------------------------------------------------
-// Renders a thing overlay at [x,y] of size [radius]
+// Adds a thing overlay at [x,y] of size [radius] and [colour] to the thing
+// batches. [tex] is the overlay texture (from thingOverlayTexture)
 // -----------------------------------------------------------------------------
-void MapRenderer2D::renderThingOverlay(double x, double y, double radius, bool point) const
+void MapRenderer2D::renderThingOverlay(unsigned tex, double x, double y, double radius, const ColRGBA& colour) const
 {
-	// Simplest case, thing_overlay_square is true and thing_drawtype is 1 or 2 (circles or sprites)
-	if (thing_overlay_square && (thing_drawtype == ThingDrawType::Round || thing_drawtype == ThingDrawType::Sprite))
-	{
-		// Draw square
-		glBegin(GL_QUADS);
-		glVertex2d(x - radius, y - radius);
-		glVertex2d(x - radius, y + radius);
-		glVertex2d(x + radius, y + radius);
-		glVertex2d(x + radius, y - radius);
-		glEnd();
-
-		return;
-	}
-
-	// Otherwise, we want the circle selection overlay
-	double ps = radius * 2 * view_scale_;
-
-	// Draw it
-	if (point && ps <= gl::maxPointSize())
-	{
-		// Point sprite
-		glPointSize(ps);
-		glBegin(GL_POINTS);
-		glVertex2d(x, y);
-		glEnd();
-	}
-	else
-	{
-		// Textured quad
-		if (point)
-			glDisable(GL_POINT_SPRITE);
-		glBegin(GL_QUADS);
-		glTexCoord2f(0.0f, 0.0f);
-		glVertex2d(x - radius, y - radius);
-		glTexCoord2f(0.0f, 1.0f);
-		glVertex2d(x - radius, y + radius);
-		glTexCoord2f(1.0f, 1.0f);
-		glVertex2d(x + radius, y + radius);
-		glTexCoord2f(1.0f, 0.0f);
-		glVertex2d(x + radius, y - radius);
-		glEnd();
-		if (point)
-			glEnable(GL_POINT_SPRITE);
-	}
+	addThingQuad(thingBatch(tex), x - radius, y - radius, x + radius, y + radius, overlay_tc, colour);
 }
 
 // -----------------------------------------------------------------------------
-// Renders a round thing icon at [x,y]
+// Adds a round thing icon at [x,y] to the thing batches
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderRoundThing(
 	double                   x,
@@ -796,24 +1183,6 @@ void MapRenderer2D::renderRoundThing(
 	unsigned tex    = 0;
 	bool     rotate = false;
 
-	// Set colour
-	if (type.pointLight().empty())
-		glColor4f(type.colour().fr(), type.colour().fg(), type.colour().fb(), alpha);
-	else if (type.pointLight() == "zdoom")
-		glColor4f(
-			static_cast<float>(args[0]) / 255.f,
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			alpha);
-	else if (type.pointLight() == "vavoom")
-		glColor4f(
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			static_cast<float>(args[3]) / 255.f,
-			alpha);
-	else
-		glColor4f(1.f, 1.f, 1.f, alpha);
-
 	// Check for custom thing icon
 	if (!type.icon().empty() && !thing_force_dir && !things_angles_)
 	{
@@ -845,40 +1214,16 @@ void MapRenderer2D::renderRoundThing(
 		return;
 	}
 
-	// Bind texture
-	gl::Texture::bind(tex, false);
-
-	// Rotate if needed
-	if (rotate)
-	{
-		glPushMatrix();
-		glTranslated(x, y, 0);
-		glRotated(angle, 0, 0, 1);
-		x = y = 0;
-	}
-
-	// Draw thing
+	// Add thing
 	double radius = type.radius() * radius_mult;
 	if (type.shrinkOnZoom())
 		radius = scaledRadius(radius);
-	glBegin(GL_QUADS);
-	glTexCoord2f(0.0f, 1.0f);
-	glVertex2d(x - radius, y - radius);
-	glTexCoord2f(0.0f, 0.0f);
-	glVertex2d(x - radius, y + radius);
-	glTexCoord2f(1.0f, 0.0f);
-	glVertex2d(x + radius, y + radius);
-	glTexCoord2f(1.0f, 1.0f);
-	glVertex2d(x + radius, y - radius);
-	glEnd();
-
-	// Restore previous matrix if rotated
-	if (rotate)
-		glPopMatrix();
+	addRotatedThingQuad(
+		thingBatch(tex), x, y, radius, rotate ? angle : 0., sq_thing_tc, thingColour(type, args, alpha));
 }
 
 // -----------------------------------------------------------------------------
-// Renders a sprite thing icon at [x,y].
+// Adds a sprite thing icon at [x,y] to the thing batches.
 // If [fitradius] is true, the sprite is drawn to fit within the thing's radius
 // -----------------------------------------------------------------------------
 bool MapRenderer2D::renderSpriteThing(
@@ -929,10 +1274,7 @@ bool MapRenderer2D::renderSpriteThing(
 	if (type.angled() || thing_force_dir || things_angles_)
 		show_angle = true;
 
-	// Bind texture
-	gl::Texture::bind(tex, false);
-
-	// Draw thing
+	// Get sprite size
 	auto&  tex_info = gl::Texture::info(tex);
 	double hw       = tex_info.size.x * 0.5;
 	double hh       = tex_info.size.y * 0.5;
@@ -945,53 +1287,26 @@ bool MapRenderer2D::renderSpriteThing(
 		hh *= scale;
 	}
 
-	// Shadow if needed
+	// Shadow if needed (added to the same batch first so it's drawn underneath)
+	auto& batch = thingBatch(tex);
 	if (thing_shadow > 0.01f && alpha >= 0.9 && !fitradius)
 	{
 		double sz = (min(hw, hh)) * 0.1;
 		if (sz < 1)
 			sz = 1;
-		glColor4f(0.0f, 0.0f, 0.0f, alpha * (thing_shadow * 0.7));
-		glBegin(GL_QUADS);
-		glTexCoord2f(0.0f, 1.0f);
-		glVertex2d(x - hw - sz, y - hh - sz);
-		glTexCoord2f(0.0f, 0.0f);
-		glVertex2d(x - hw - sz, y + hh + sz);
-		glTexCoord2f(1.0f, 0.0f);
-		glVertex2d(x + hw + sz, y + hh + sz);
-		glTexCoord2f(1.0f, 1.0f);
-		glVertex2d(x + hw + sz, y - hh - sz);
-		glEnd();
-		glBegin(GL_QUADS);
-		glTexCoord2f(0.0f, 1.0f);
-		glVertex2d(x - hw - sz, y - hh - sz - sz);
-		glTexCoord2f(0.0f, 0.0f);
-		glVertex2d(x - hw - sz, y + hh + sz);
-		glTexCoord2f(1.0f, 0.0f);
-		glVertex2d(x + hw + sz + sz, y + hh + sz);
-		glTexCoord2f(1.0f, 1.0f);
-		glVertex2d(x + hw + sz + sz, y - hh - sz - sz);
-		glEnd();
+		ColRGBA shadow_col(0, 0, 0, 255 * alpha * (thing_shadow * 0.7));
+		addThingQuad(batch, x - hw - sz, y - hh - sz, x + hw + sz, y + hh + sz, sq_thing_tc, shadow_col);
+		addThingQuad(batch, x - hw - sz, y - hh - sz - sz, x + hw + sz + sz, y + hh + sz, sq_thing_tc, shadow_col);
 	}
-	// Draw thing
-	glColor4f(1.0f, 1.0f, 1.0f, alpha);
-	glBegin(GL_QUADS);
-	glTexCoord2f(0.0f, 1.0f);
-	glVertex2d(x - hw, y - hh);
-	glTexCoord2f(0.0f, 0.0f);
-	glVertex2d(x - hw, y + hh);
-	glTexCoord2f(1.0f, 0.0f);
-	glVertex2d(x + hw, y + hh);
-	glTexCoord2f(1.0f, 1.0f);
-	glVertex2d(x + hw, y - hh);
-	glEnd();
 
+	// Add thing
+	addThingQuad(batch, x - hw, y - hh, x + hw, y + hh, sq_thing_tc, ColRGBA(255, 255, 255, 255 * alpha));
 
 	return show_angle;
 }
 
 // -----------------------------------------------------------------------------
-// Renders a square thing icon at [x,y]
+// Adds a square thing icon at [x,y] to the thing batches
 // -----------------------------------------------------------------------------
 bool MapRenderer2D::renderSquareThing(
 	double                   x,
@@ -1006,24 +1321,6 @@ bool MapRenderer2D::renderSquareThing(
 	// --- Determine texture to use ---
 	unsigned tex = 0;
 
-	// Set colour
-	if (type.pointLight().empty())
-		glColor4f(type.colour().fr(), type.colour().fg(), type.colour().fb(), alpha);
-	else if (type.pointLight() == "zdoom")
-		glColor4f(
-			static_cast<float>(args[0]) / 255.f,
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			alpha);
-	else if (type.pointLight() == "vavoom")
-		glColor4f(
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			static_cast<float>(args[3]) / 255.f,
-			alpha);
-	else
-		glColor4f(1.f, 1.f, 1.f, alpha);
-
 	// Show icon anyway if no sprite set
 	if (type.sprite().empty())
 		showicon = true;
@@ -1092,39 +1389,22 @@ bool MapRenderer2D::renderSquareThing(
 		return false;
 	}
 
-	// Bind texture
-	gl::Texture::bind(tex, false);
+	// Get texture coordinates, rotated to the angle
+	float tc[8];
+	for (int a = 0; a < 8; ++a)
+		tc[a] = sq_thing_tc[(tc_start + a) % 8];
 
-	// Draw thing
+	// Add thing
 	double radius = type.radius();
 	if (type.shrinkOnZoom())
 		radius = scaledRadius(radius);
-	glBegin(GL_QUADS);
-	int tc = tc_start;
-	glTexCoord2f(sq_thing_tc[tc], sq_thing_tc[tc + 1]);
-	tc += 2;
-	if (tc == 8)
-		tc = 0;
-	glVertex2d(x - radius, y - radius);
-	glTexCoord2f(sq_thing_tc[tc], sq_thing_tc[tc + 1]);
-	tc += 2;
-	if (tc == 8)
-		tc = 0;
-	glVertex2d(x - radius, y + radius);
-	glTexCoord2f(sq_thing_tc[tc], sq_thing_tc[tc + 1]);
-	tc += 2;
-	if (tc == 8)
-		tc = 0;
-	glVertex2d(x + radius, y + radius);
-	glTexCoord2f(sq_thing_tc[tc], sq_thing_tc[tc + 1]);
-	glVertex2d(x + radius, y - radius);
-	glEnd();
+	addThingQuad(thingBatch(tex), x - radius, y - radius, x + radius, y + radius, tc, thingColour(type, args, alpha));
 
 	return ((type.angled() || thing_force_dir || things_angles_) && !showicon);
 }
 
 // -----------------------------------------------------------------------------
-// Renders a simple square thing icon at [x,y]
+// Adds a simple square thing icon at [x,y] to the thing batches
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderSimpleSquareThing(
 	double                   x,
@@ -1140,58 +1420,124 @@ void MapRenderer2D::renderSimpleSquareThing(
 		radius = scaledRadius(radius);
 	double radius2 = radius * 0.1;
 
-	// Move to thing position
-	glPushMatrix();
-	glTranslated(x, y, 0);
+	// Background
+	auto& batch = thingBatch(0);
+	addThingQuad(batch, x - radius, y - radius, x + radius, y + radius, sq_thing_tc, ColRGBA(0, 0, 0, 255 * alpha));
+
+	// Base
+	addThingQuad(
+		batch,
+		x - radius + radius2,
+		y - radius + radius2,
+		x + radius - radius2,
+		y + radius - radius2,
+		sq_thing_tc,
+		thingColour(type, args, alpha));
+
+	// Angle indicator (if needed), drawn over the thing batches
+	if (type.angled() || thing_force_dir)
+	{
+		double rad = math::degToRad(angle);
+		overlay_buffer_.add(x, y, ColRGBA::BLACK);
+		overlay_buffer_.add(x + radius * cos(rad), y + radius * sin(rad), ColRGBA::BLACK);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the batch for thing quads using texture [tex] (0 for untextured)
+// -----------------------------------------------------------------------------
+gl::VertexBuffer2D& MapRenderer2D::thingBatch(unsigned tex) const
+{
+	return thing_batches_[tex];
+}
 
-	// Draw background
-	glColor4f(0.0f, 0.0f, 0.0f, alpha);
-	glBegin(GL_QUADS);
-	glVertex2d(-radius, -radius);
-	glVertex2d(-radius, radius);
-	glVertex2d(radius, radius);
-	glVertex2d(radius, -radius);
-	glEnd();
+// -----------------------------------------------------------------------------
+// Renders everything added to the thing batches, with a single draw call per
+// texture used, then clears them
+// -----------------------------------------------------------------------------
+void MapRenderer2D::flushThingBatches() const
+{
+	auto shader = bindShader(ShaderType::Things);
+	if (shader)
+		shader->setUniform("tex", 0);
 
-	// Set colour
-	if (type.pointLight().empty())
-		glColor4f(type.colour().fr(), type.colour().fg(), type.colour().fb(), alpha);
-	else if (type.pointLight() == "zdoom")
-		glColor4f(
-			static_cast<float>(args[0]) / 255.f,
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			alpha);
-	else if (type.pointLight() == "vavoom")
-		glColor4f(
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			static_cast<float>(args[3]) / 255.f,
-			alpha);
-	else
-		glColor4f(1.f, 1.f, 1.f, alpha);
+	for (auto& [tex, batch] : thing_batches_)
+	{
+		if (batch.empty())
+			continue;
 
-	// Draw base
-	glBegin(GL_QUADS);
-	glVertex2d(-radius + radius2, -radius + radius2);
-	glVertex2d(-radius + radius2, radius - radius2);
-	glVertex2d(radius - radius2, radius - radius2);
-	glVertex2d(radius - radius2, -radius + radius2);
-	glEnd();
+		// Setup texture
+		if (tex)
+			gl::Texture::bind(tex, false);
+		if (shader)
+			shader->setUniform("textured", tex ? 1 : 0);
+		else if (tex)
+			glEnable(GL_TEXTURE_2D);
+		else
+			glDisable(GL_TEXTURE_2D);
 
-	// Draw angle indicator (if needed)
-	if (type.angled() || thing_force_dir)
+		batch.draw(GL_TRIANGLES, shader, tex > 0);
+		batch.clear();
+	}
+
+	if (shader)
+		gl::Shader::unbind();
+	glDisable(GL_TEXTURE_2D);
+
+	// Any simple square thing angle indicators
+	drawOverlayBuffer(GL_LINES);
+}
+
+// -----------------------------------------------------------------------------
+// Renders [things] depending on the thing_drawtype cvar, batched by texture.
+// Any things that need a direction arrow drawn afterwards are added to
+// [arrows], if given
+// -----------------------------------------------------------------------------
+void MapRenderer2D::renderThingInstances(const vector<ThingInstance>& things, vector<const ThingInstance*>* arrows)
+{
+	// Draw things
+	for (auto& inst : things)
 	{
-		glColor4f(0.0f, 0.0f, 0.0f, 1.0f);
-		glRotated(angle, 0, 0, 1);
-		glBegin(GL_LINES);
-		glVertex2d(0, 0);
-		glVertex2d(radius, 0);
-		glEnd();
+		auto  thing = inst.thing;
+		auto& tt    = thing->typeDef();
+
+		// Draw thing depending on 'things_drawtype' cvar
+		bool arrow = false;
+		if (thing_drawtype == ThingDrawType::Sprite) // Drawtype 2: Sprites
+			arrow = renderSpriteThing(inst.x, inst.y, thing->angle(), tt, thing->args(), inst.index, inst.alpha);
+		else if (thing_drawtype == ThingDrawType::Round) // Drawtype 1: Round
+			renderRoundThing(inst.x, inst.y, thing->angle(), tt, thing->args(), inst.alpha);
+		else // Drawtype 0 (or other): Square
+			arrow = renderSquareThing(
+				inst.x,
+				inst.y,
+				thing->angle(),
+				tt,
+				thing->args(),
+				inst.alpha,
+				thing_drawtype < ThingDrawType::SquareSprite,
+				thing_drawtype == ThingDrawType::FramedSprite);
+
+		if (arrow && arrows)
+			arrows->push_back(&inst);
 	}
+	flushThingBatches();
+
+	// Draw thing sprites within squares if that drawtype is set
+	if (thing_drawtype > ThingDrawType::Sprite)
+	{
+		for (auto& inst : things)
+		{
+			auto  thing = inst.thing;
+			auto& tt    = thing->typeDef();
 
-	// Restore previous matrix
-	glPopMatrix();
+			if (thing_drawtype == ThingDrawType::SquareSprite && tt.sprite().empty())
+				continue;
+
+			renderSpriteThing(inst.x, inst.y, thing->angle(), tt, thing->args(), inst.index, inst.alpha, true);
+		}
+		flushThingBatches();
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -1199,6 +1545,8 @@ void MapRenderer2D::renderSimpleSquareThing(
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderThings(float alpha, bool force_dir)
 {
+	gl::profiler::Scope profile{ "2d: Things" };
+
 	// Don't bother if (practically) invisible
 	if (alpha <= 0.01f)
 		return;
@@ -1208,229 +1556,93 @@ void MapRenderer2D::renderThings(float alpha, bool force_dir)
 }
 
 // -----------------------------------------------------------------------------
-// Renders map things in immediate mode
+// Renders map things. Things are gathered into batches by texture (per pass:
+// shadows, things, sprites and arrows) so each pass only needs a draw call
+// per texture, rather than one per thing
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderThingsImmediate(float alpha)
 {
-	// Display lists aren't really good for this, better to check for
-	// visibility and just render things in immediate mode
-
-	// Enable textures
-	glEnable(GL_TEXTURE_2D);
-	glColor4f(1.0f, 1.0f, 1.0f, alpha);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	// Go through things
-	MapThing*   thing;
-	double      x, y, angle;
-	vector<int> things_arrows;
-	long        last_update = thing_sprites_updated_;
+	// Get visible things
+	updateVisibleObjects();
+	long last_update = thing_sprites_updated_;
+	thing_instances_.clear();
+	for (auto thing : visible_.things)
+	{
+		// Ignore if outside of screen, or not worth drawing
+		double x      = thing->xPos();
+		double y      = thing->yPos();
+		double radius = thing->typeDef().radius() * 1.3;
+		if (x + radius < view_tl_.x || x - radius > view_br_.x || y + radius < view_tl_.y || y - radius > view_br_.y
+			|| radius * view_scale_ < 2)
+			continue;
+
+		unsigned a = thing->index();
+
+		// Reset thing sprite if modified
+		if (thing->modifiedTime() > last_update && thing_sprites_.size() > a)
+			thing_sprites_[a] = 0;
+
+		thing_instances_.push_back(
+			{ thing, thing->xPos(), thing->yPos(), a, thing->isFiltered() ? alpha * 0.25f : alpha });
+	}
 
 	// Draw thing shadows if needed
 	if (thing_shadow > 0.01f && thing_drawtype != ThingDrawType::Sprite)
 	{
-		glEnable(GL_TEXTURE_2D);
 		auto tex_shadow = mapeditor::textureManager().editorImage("thing/shadow").gl_id;
 		if (thing_drawtype == ThingDrawType::Square || thing_drawtype == ThingDrawType::SquareSprite
 			|| thing_drawtype == ThingDrawType::FramedSprite)
 			tex_shadow = mapeditor::textureManager().editorImage("thing/square/shadow").gl_id;
 		if (tex_shadow)
 		{
-			gl::Texture::bind(tex_shadow);
-			glColor4f(0.0f, 0.0f, 0.0f, alpha * thing_shadow);
-
-			// Setup point sprites if supported
-			bool point = false;
-			if (gl::pointSpriteSupport())
-			{
-				glEnable(GL_POINT_SPRITE);
-				glTexEnvi(GL_POINT_SPRITE, GL_COORD_REPLACE, GL_TRUE);
-				point = true;
-			}
-
-			for (unsigned a = 0; a < map_->nThings(); a++)
+			ColRGBA col(0, 0, 0, 255 * alpha * thing_shadow);
+			auto&   batch = thingBatch(tex_shadow);
+			for (auto& inst : thing_instances_)
 			{
-				if (vis_t_[a] > 0)
-					continue;
-
 				// No shadow if filtered
-				thing = map_->thing(a);
-				if (thing->isFiltered())
+				if (inst.thing->isFiltered())
 					continue;
 
 				// Get thing info
-				auto&  tt     = game::configuration().thingType(thing->type());
+				auto&  tt     = inst.thing->typeDef();
 				double radius = (tt.radius() + 1);
 				if (tt.shrinkOnZoom())
 					radius = scaledRadius(radius);
 				radius *= 1.3;
-				x = thing->xPos();
-				y = thing->yPos();
 
-				// Draw shadow
-				if (point && radius * 2 * view_scale_ <= gl::maxPointSize())
-				{
-					// Point sprite
-					glPointSize(radius * 2 * view_scale_);
-					glBegin(GL_POINTS);
-					glVertex2d(x, y);
-					glEnd();
-				}
-				else
-				{
-					// Textured quad
-					if (point)
-						glDisable(GL_POINT_SPRITE);
-					glBegin(GL_QUADS);
-					glTexCoord2f(0.0f, 1.0f);
-					glVertex2d(x - radius, y - radius);
-					glTexCoord2f(0.0f, 0.0f);
-					glVertex2d(x - radius, y + radius);
-					glTexCoord2f(1.0f, 0.0f);
-					glVertex2d(x + radius, y + radius);
-					glTexCoord2f(1.0f, 1.0f);
-					glVertex2d(x + radius, y - radius);
-					glEnd();
-					if (point)
-						glEnable(GL_POINT_SPRITE);
-				}
+				addThingQuad(
+					batch, inst.x - radius, inst.y - radius, inst.x + radius, inst.y + radius, sq_thing_tc, col);
 			}
-
-			if (point)
-				glDisable(GL_POINT_SPRITE);
+			flushThingBatches();
 		}
 	}
 
 	// Draw things
-	double talpha;
-	for (unsigned a = 0; a < map_->nThings(); a++)
-	{
-		if (vis_t_[a] > 0)
-			continue;
-
-		// Get thing info
-		thing = map_->thing(a);
-		x     = thing->xPos();
-		y     = thing->yPos();
-		angle = thing->angle();
-
-		// Set alpha
-		if (thing->isFiltered())
-			talpha = alpha * 0.25;
-		else
-			talpha = alpha;
-
-		// Get thing type properties from game configuration
-		auto& tt = game::configuration().thingType(thing->type());
-
-		// Reset thing sprite if modified
-		if (thing->modifiedTime() > last_update && thing_sprites_.size() > a)
-			thing_sprites_[a] = 0;
-
-		// Draw thing depending on 'things_drawtype' cvar
-		if (thing_drawtype == ThingDrawType::Sprite) // Drawtype 2: Sprites
-		{
-			// Check if we need to draw the direction arrow for this thing
-			if (renderSpriteThing(x, y, angle, tt, thing->args(), a, talpha))
-				things_arrows.push_back(a);
-		}
-		else if (thing_drawtype == ThingDrawType::Round) // Drawtype 1: Round
-			renderRoundThing(x, y, angle, tt, thing->args(), talpha);
-		else // Drawtype 0 (or other): Square
-		{
-			if (renderSquareThing(
-					x,
-					y,
-					angle,
-					tt,
-					thing->args(),
-					talpha,
-					(thing_drawtype < ThingDrawType::SquareSprite),
-					(thing_drawtype == ThingDrawType::FramedSprite)))
-				things_arrows.push_back(a);
-		}
-	}
-
-	// Draw thing sprites within squares if that drawtype is set
-	if (thing_drawtype > ThingDrawType::Sprite)
-	{
-		glEnable(GL_TEXTURE_2D);
-
-		for (unsigned a = 0; a < map_->nThings(); a++)
-		{
-			if (vis_t_[a] > 0)
-				continue;
-
-			// Get thing info
-			thing    = map_->thing(a);
-			auto& tt = game::configuration().thingType(thing->type());
-			x        = thing->xPos();
-			y        = thing->yPos();
-
-			if (thing_drawtype == ThingDrawType::SquareSprite && tt.sprite().empty())
-				continue;
-
-			// Set alpha
-			if (thing->isFiltered())
-				talpha = alpha * 0.25;
-			else
-				talpha = alpha;
-
-			renderSpriteThing(x, y, thing->angle(), tt, thing->args(), a, talpha, true);
-		}
-	}
+	vector<const ThingInstance*> things_arrows;
+	renderThingInstances(thing_instances_, &things_arrows);
 
 	// Draw any thing direction arrows needed
-	if (!things_arrows.empty())
-	{
-		auto acol = ColRGBA::WHITE;
-		acol.a    = 255 * alpha * arrow_alpha;
-		gl::setColour(acol);
-		// glColor4f(1.0f, 1.0f, 1.0f, alpha * arrow_alpha);
-		auto tex_arrow = mapeditor::textureManager().editorImage("arrow").gl_id;
-		if (tex_arrow)
+	auto tex_arrow = mapeditor::textureManager().editorImage("arrow").gl_id;
+	if (!things_arrows.empty() && tex_arrow)
+	{
+		auto& batch = thingBatch(tex_arrow);
+		for (auto inst : things_arrows)
 		{
-			glEnable(GL_TEXTURE_2D);
-			gl::Texture::bind(tex_arrow);
-
-			for (int things_arrow : things_arrows)
+			auto acol = ColRGBA::WHITE;
+			if (arrow_colour)
 			{
-				thing = map_->thing(things_arrow);
-				if (arrow_colour)
-				{
-					auto& tt = game::configuration().thingType(thing->type());
-					if (tt.defined())
-					{
-						acol.set(tt.colour());
-						acol.a = 255 * alpha * arrow_alpha;
-						gl::setColour(acol);
-					}
-				}
-				x = thing->xPos();
-				y = thing->yPos();
-
-				glPushMatrix();
-				glTranslated(x, y, 0);
-				glRotated(thing->angle(), 0, 0, 1);
-
-				glBegin(GL_QUADS);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex2d(-32, -32);
-				glTexCoord2f(0.0f, 0.0f);
-				glVertex2d(-32, 32);
-				glTexCoord2f(1.0f, 0.0f);
-				glVertex2d(32, 32);
-				glTexCoord2f(1.0f, 1.0f);
-				glVertex2d(32, -32);
-				glEnd();
-
-				glPopMatrix();
+				auto& tt = inst->thing->typeDef();
+				if (tt.defined())
+					acol.set(tt.colour());
 			}
+			acol.a = 255 * alpha * arrow_alpha;
+
+			addRotatedThingQuad(batch, inst->x, inst->y, 32, inst->thing->angle(), sq_thing_tc, acol);
 		}
+		flushThingBatches();
 	}
-
-	// Disable textures
-	glDisable(GL_TEXTURE_2D);
 }
 
 // -----------------------------------------------------------------------------
@@ -1438,6 +1650,8 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderThingHilight(int index, float fade) const
 {
+	gl::profiler::Scope profile{ "2d: Hilight" };
+
 	// Check hilight
 	if (!map_->thing(index))
 		return;
@@ -1454,7 +1668,7 @@ void MapRenderer2D::renderThingHilight(int index, float fade) const
 
 	// Get thing info
 	auto   thing = map_->thing(index);
-	auto&  tt    = game::configuration().thingType(thing->type());
+	auto&  tt    = thing->typeDef();
 	double x     = thing->xPos();
 	double y     = thing->yPos();
 
@@ -1464,22 +1678,12 @@ void MapRenderer2D::renderThingHilight(int index, float fade) const
 	// Check if we want square overlays
 	if (thing_overlay_square)
 	{
-		glDisable(GL_TEXTURE_2D);
 		glLineWidth(3.0f);
-		glBegin(GL_LINE_LOOP);
-		glVertex2d(x - radius, y - radius);
-		glVertex2d(x - radius, y + radius);
-		glVertex2d(x + radius, y + radius);
-		glVertex2d(x + radius, y - radius);
-		glEnd();
+		overlay_buffer_.setColour(col);
+		overlay_buffer_.addRectOutline(x - radius, y - radius, x + radius, y + radius);
 		col.a *= 0.5;
-		gl::setColour(col);
-		glBegin(GL_QUADS);
-		glVertex2d(x - radius, y - radius);
-		glVertex2d(x - radius, y + radius);
-		glVertex2d(x + radius, y + radius);
-		glVertex2d(x + radius, y - radius);
-		glEnd();
+		addThingQuad(thingBatch(0), x - radius, y - radius, x + radius, y + radius, overlay_tc, col);
+		flushThingBatches();
 
 		return;
 	}
@@ -1502,24 +1706,9 @@ void MapRenderer2D::renderThingHilight(int index, float fade) const
 		tex = mapeditor::textureManager().editorImage("thing/square/hilight").gl_id;
 	else
 		tex = mapeditor::textureManager().editorImage("thing/hilight").gl_id;
-	if (tex)
-	{
-		glEnable(GL_TEXTURE_2D);
-		gl::Texture::bind(tex);
-	}
-
-	glBegin(GL_QUADS);
-	glTexCoord2f(0.0f, 0.0f);
-	glVertex2d(x - radius, y - radius);
-	glTexCoord2f(0.0f, 1.0f);
-	glVertex2d(x - radius, y + radius);
-	glTexCoord2f(1.0f, 1.0f);
-	glVertex2d(x + radius, y + radius);
-	glTexCoord2f(1.0f, 0.0f);
-	glVertex2d(x + radius, y - radius);
-	glEnd();
 
-	glDisable(GL_TEXTURE_2D);
+	renderThingOverlay(tex, x, y, radius, col);
+	flushThingBatches();
 }
 
 // -----------------------------------------------------------------------------
@@ -1536,17 +1725,15 @@ void MapRenderer2D::renderThingSelection(const ItemSelection& selection, float f
 		fade = 1.0f;
 
 	// Set selection colour
-	colourconfig::setGLColour("map_selection", fade);
-
-	// Setup overlay rendering
-	bool point = setupThingOverlay();
+	auto col = setOverlayColour("map_selection", fade);
 
 	// Draw all selection overlays
+	auto tex = thingOverlayTexture();
 	for (const auto& item : selection)
 	{
 		if (auto thing = item.asThing(*map_))
 		{
-			auto&  tt     = game::configuration().thingType(thing->type());
+			auto&  tt     = thing->typeDef();
 			double radius = tt.radius();
 			if (tt.shrinkOnZoom())
 				radius = scaledRadius(radius);
@@ -1557,14 +1744,10 @@ void MapRenderer2D::renderThingSelection(const ItemSelection& selection, float f
 			radius += halo_width * view_scale_inv_;
 
 			// Draw it
-			renderThingOverlay(thing->xPos(), thing->yPos(), radius * (0.8 + (0.2 * fade)), point);
+			renderThingOverlay(tex, thing->xPos(), thing->yPos(), radius * (0.8 + (0.2 * fade)), col);
 		}
 	}
-
-	// Clean up gl state
-	if (point)
-		glDisable(GL_POINT_SPRITE);
-	glDisable(GL_TEXTURE_2D);
+	flushThingBatches();
 }
 
 // -----------------------------------------------------------------------------
@@ -1582,13 +1765,11 @@ void MapRenderer2D::renderTaggedThings(const vector<MapThing*>& things, float fa
 	col.a *= fade;
 	gl::setColour(col, def.blendMode());
 
-	// Setup overlay rendering
-	bool point = setupThingOverlay();
-
 	// Draw all tagged overlays
+	auto tex = thingOverlayTexture();
 	for (auto thing : things)
 	{
-		auto&  tt     = game::configuration().thingType(thing->type());
+		auto&  tt     = thing->typeDef();
 		double radius = tt.radius();
 		if (tt.shrinkOnZoom())
 			radius = scaledRadius(radius);
@@ -1599,16 +1780,11 @@ void MapRenderer2D::renderTaggedThings(const vector<MapThing*>& things, float fa
 		radius += halo_width * view_scale_inv_;
 
 		// Draw it
-		renderThingOverlay(thing->xPos(), thing->yPos(), radius, point);
+		renderThingOverlay(tex, thing->xPos(), thing->yPos(), radius, col);
 	}
-
-	// Clean up gl state
-	if (point)
-		glDisable(GL_POINT_SPRITE);
-	glDisable(GL_TEXTURE_2D);
+	flushThingBatches();
 
 	// Draw action lines
-	// Because gl state is in texture mode above, we cannot merge the loops
 	auto object = mapeditor::editContext().selection().hilightedObject();
 	if (object && action_lines)
 	{
@@ -1637,13 +1813,11 @@ void MapRenderer2D::renderTaggingThings(const vector<MapThing*>& things, float f
 	col.a *= fade;
 	gl::setColour(col, def.blendMode());
 
-	// Setup overlay rendering
-	bool point = setupThingOverlay();
-
 	// Draw all tagging overlays
+	auto tex = thingOverlayTexture();
 	for (auto thing : things)
 	{
-		auto&  tt     = game::configuration().thingType(thing->type());
+		auto&  tt     = thing->typeDef();
 		double radius = tt.radius();
 		if (tt.shrinkOnZoom())
 			radius = scaledRadius(radius);
@@ -1654,16 +1828,11 @@ void MapRenderer2D::renderTaggingThings(const vector<MapThing*>& things, float f
 		radius += halo_width * view_scale_inv_;
 
 		// Draw it
-		renderThingOverlay(thing->xPos(), thing->yPos(), radius, point);
+		renderThingOverlay(tex, thing->xPos(), thing->yPos(), radius, col);
 	}
-
-	// Clean up gl state
-	if (point)
-		glDisable(GL_POINT_SPRITE);
-	glDisable(GL_TEXTURE_2D);
+	flushThingBatches();
 
 	// Draw action lines
-	// Because gl state is in texture mode above, we cannot merge the loops
 	auto object = mapeditor::editContext().selection().hilightedObject();
 	if (object && action_lines)
 	{
@@ -1722,7 +1891,7 @@ void MapRenderer2D::renderPathedThings(const vector<MapThing*>& things)
 			path.from_index = 0;
 			path.to_index   = 0;
 
-			auto& tt = game::configuration().thingType(thing->type());
+			auto& tt = thing->typeDef();
 
 			// Dragon Path
 			if (tt.flags() & game::ThingType::Flags::Dragon)
@@ -1746,7 +1915,7 @@ void MapRenderer2D::renderPathedThings(const vector<MapThing*>& things)
 						int   a13 = dragon_things[d]->arg(2);
 						int   a14 = dragon_things[d]->arg(3);
 						int   a15 = dragon_things[d]->arg(4);
-						auto& tt1 = game::configuration().thingType(dragon_things[d]->type());
+						auto& tt1 = dragon_things[d]->typeDef();
 						for (unsigned e = d + 1; e < dragon_things.size(); ++e)
 						{
 							int   id2  = dragon_things[e]->id();
@@ -1755,7 +1924,7 @@ void MapRenderer2D::renderPathedThings(const vector<MapThing*>& things)
 							int   a23  = dragon_things[e]->arg(2);
 							int   a24  = dragon_things[e]->arg(3);
 							int   a25  = dragon_things[e]->arg(4);
-							auto& tt2  = game::configuration().thingType(dragon_things[e]->type());
+							auto& tt2  = dragon_things[e]->typeDef();
 							bool l1to2 = ((a11 == id2) || (a12 == id2) || (a13 == id2) || (a14 == id2) || (a15 == id2));
 							bool l2to1 = ((a21 == id1) || (a22 == id1) || (a23 == id1) || (a24 == id1) || (a25 == id1));
 							if (!((tt1.flags() | tt2.flags()) & game::ThingType::Flags::Dragon))
@@ -1800,7 +1969,7 @@ void MapRenderer2D::renderPathedThings(const vector<MapThing*>& things)
 				auto thing2 = things[b];
 				if (thing2->type() == nexttype)
 				{
-					auto& tt2 = game::configuration().thingType(thing2->type());
+					auto& tt2 = thing2->typeDef();
 					nextargs  = tt2.nextArgs();
 					if (nextargs)
 					{
@@ -1860,80 +2029,116 @@ void MapRenderer2D::renderPathedThings(const vector<MapThing*>& things)
 }
 
 // -----------------------------------------------------------------------------
-// Renders point light previews
+// Renders point light previews for all point light things that may be visible,
+// with [alpha] transparency. The radius of the light at [hilight_index] (if
+// any) is also drawn
 // -----------------------------------------------------------------------------
-void MapRenderer2D::renderPointLightPreviews(float alpha, int hilight_index) const
+void MapRenderer2D::renderPointLightPreviews(float alpha, int hilight_index)
 {
 	if (!thing_preview_lights)
 		return;
 
-	ColRGBA light_col{ 0, 0, 0, static_cast<uint8_t>(alpha * (thing_light_intensity * 255.f)) };
-	double  light_radius = 0.;
+	gl::profiler::Scope profile{ "2d: Light Previews" };
 
-	glEnable(GL_TEXTURE_2D);
-	const auto light_tex = mapeditor::textureManager().editorImage("thing/light_preview").gl_id;
-	gl::Texture::bind(light_tex);
+	updateVisibleLights();
+	auto& lights = visible_lights_;
+	if (lights.instances.empty())
+		return;
 
-	for (const auto& thing : map_->things())
-	{
-		const auto& ttype = game::configuration().thingType(thing->type());
+	float light_alpha = alpha * thing_light_intensity;
+	gl::setBlend(gl::Blend::Additive);
 
-		// Not a point light
-		if (ttype.pointLight().empty())
-			continue;
+	if (auto shader = bindShader(ShaderType::Lights))
+	{
+		using namespace gl::attrib;
 
-		// ZDoom point light
-		if (ttype.pointLight() == "zdoom")
+		// Quad shared by all instances
+		if (vbo_light_quad_ == 0)
 		{
-			light_col.r  = thing->arg(0);
-			light_col.g  = thing->arg(1);
-			light_col.b  = thing->arg(2);
-			light_radius = thing->arg(3);
+			const float quad[] = { -1.f, -1.f, 1.f, -1.f, 1.f, 1.f, -1.f, 1.f };
+			glGenBuffers(1, &vbo_light_quad_);
+			glBindBuffer(GL_ARRAY_BUFFER, vbo_light_quad_);
+			glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
 		}
 
-		// Vavoom point light
-		else if (ttype.pointLight() == "vavoom")
+		// Instance data (position + radius and colour per light), only
+		// uploaded when the visible lights have changed
+		if (vbo_light_instances_ == 0)
+			glGenBuffers(1, &vbo_light_instances_);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_light_instances_);
+		if (!lights.uploaded)
 		{
-			light_col.r  = thing->arg(1);
-			light_col.g  = thing->arg(2);
-			light_col.b  = thing->arg(3);
-			light_radius = thing->arg(0);
+			glBufferData(
+				GL_ARRAY_BUFFER,
+				lights.instances.size() * sizeof(LightInstance),
+				lights.instances.data(),
+				GL_DYNAMIC_DRAW);
+			lights.uploaded = true;
 		}
+		glEnableVertexAttribArray(INSTANCE);
+		glVertexAttribPointer(INSTANCE, 3, GL_FLOAT, GL_FALSE, sizeof(LightInstance), nullptr);
+		glVertexAttribDivisor(INSTANCE, 1);
+		glEnableVertexAttribArray(COLOUR);
+		glVertexAttribPointer(
+			COLOUR, 3, GL_FLOAT, GL_FALSE, sizeof(LightInstance), (char*)nullptr + offsetof(LightInstance, r));
+		glVertexAttribDivisor(COLOUR, 1);
+
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_light_quad_);
+		glEnableVertexAttribArray(POSITION);
+		glVertexAttribPointer(POSITION, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+		// Draw all lights in one call
+		shader->setUniform("alpha", light_alpha);
+		glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, lights.instances.size());
+
+		// Other programs use the colour attribute per vertex
+		glVertexAttribDivisor(INSTANCE, 0);
+		glVertexAttribDivisor(COLOUR, 0);
+		glDisableVertexAttribArray(INSTANCE);
+		gl::VertexBuffer2D::clearAttribPointers();
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		gl::Shader::unbind();
+	}
+	else
+	{
+		// No shaders, draw a textured quad per light
+		glEnable(GL_TEXTURE_2D);
+		gl::Texture::bind(mapeditor::textureManager().editorImage("thing/light_preview").gl_id);
 
-		// Vavoom white light
-		else if (ttype.pointLight() == "vavoom_white")
+		glBegin(GL_QUADS);
+		for (const auto& light : lights.instances)
 		{
-			light_col.r  = 255;
-			light_col.g  = 255;
-			light_col.b  = 255;
-			light_radius = thing->arg(0);
+			glColor4f(light.r, light.g, light.b, light_alpha);
+			glTexCoord2f(0.0f, 0.0f);
+			glVertex2f(light.x - light.radius, light.y - light.radius);
+			glTexCoord2f(1.0f, 0.0f);
+			glVertex2f(light.x + light.radius, light.y - light.radius);
+			glTexCoord2f(1.0f, 1.0f);
+			glVertex2f(light.x + light.radius, light.y + light.radius);
+			glTexCoord2f(0.0f, 1.0f);
+			glVertex2f(light.x - light.radius, light.y + light.radius);
 		}
-
-		light_radius *= 2; // Doubling the radius value matches better with in-game results
-		gl::setColour(light_col, gl::Blend::Additive);
-
-		glBegin(GL_QUADS);
-		glTexCoord2f(0.0f, 0.0f);
-		glVertex2d(thing->xPos() - light_radius, thing->yPos() - light_radius);
-		glTexCoord2f(1.0f, 0.0f);
-		glVertex2d(thing->xPos() + light_radius, thing->yPos() - light_radius);
-		glTexCoord2f(1.0f, 1.0f);
-		glVertex2d(thing->xPos() + light_radius, thing->yPos() + light_radius);
-		glTexCoord2f(0.0f, 1.0f);
-		glVertex2d(thing->xPos() - light_radius, thing->yPos() + light_radius);
 		glEnd();
 
-		// Draw radius circle if the thing is the current hilight
-		if (hilight_index >= 0 && thing->index() == hilight_index)
+		glDisable(GL_TEXTURE_2D);
+	}
+
+	// Draw radius circle if a light is the current hilight
+	if (hilight_index >= 0)
+		for (unsigned a = 0; a < lights.things.size(); a++)
 		{
-			auto col = light_col;
-			col.a    = 180;
-			glDisable(GL_TEXTURE_2D);
+			if (lights.things[a]->index() != hilight_index)
+				continue;
+
+			auto&   light = lights.instances[a];
+			ColRGBA col{ static_cast<uint8_t>(light.r * 255.f),
+						 static_cast<uint8_t>(light.g * 255.f),
+						 static_cast<uint8_t>(light.b * 255.f),
+						 180 };
 			glLineWidth(2.f);
-			drawing::drawEllipse(thing->position(), light_radius, light_radius, 64, col);
-			glEnable(GL_TEXTURE_2D);
+			drawing::drawEllipse(lights.things[a]->position(), light.radius, light.radius, 64, col);
+			break;
 		}
-	}
 }
 
 
@@ -1942,6 +2147,8 @@ void MapRenderer2D::renderPointLightPreviews(float alpha, int hilight_index) con
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderFlats(int type, bool texture, float alpha)
 {
+	gl::profiler::Scope profile{ "2d: Flats" };
+
 	// Don't bother if (practically) invisible
 	if (alpha <= 0.01f)
 		return;
@@ -2130,15 +2337,22 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 		last_flat_type_ = type;
 	}
 
-	// First, check if any polygon vertex data has changed (in this case we need to refresh the entire vbo)
-	for (unsigned a = 0; a < map_->nSectors(); a++)
+	// First, check if any polygon vertex data has changed. Polygons that still
+	// fit in their existing area of the vbo are updated in place below, but
+	// otherwise (or if sectors were added/removed) the entire vbo is refreshed
+	bool rebuild = sector_vbo_slots_.size() != map_->nSectors();
+	for (unsigned a = 0; a < map_->nSectors() && !rebuild; a++)
 	{
-		auto poly = map_->sector(a)->polygon();
-		if (poly && poly->vboUpdate() > 1)
-		{
-			updateFlatsVBO();
-			vbo_updated = true;
-		}
+		auto sector = map_->sector(a);
+		auto poly   = sector->polygon();
+		if (sector_vbo_slots_[a].sector != sector
+			|| poly && poly->vboUpdate() > 1 && poly->vboDataSize() > sector_vbo_slots_[a].size)
+			rebuild = true;
+	}
+	if (rebuild)
+	{
+		updateFlatsVBO();
+		vbo_updated = true;
 	}
 
 	// Create VBO if necessary
@@ -2149,12 +2363,33 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 	}
 
 	// Setup opengl state
-	if (texture)
+	auto shader = bindShader(ShaderType::Flats);
+	if (texture && !shader)
 		glEnable(GL_TEXTURE_2D);
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
 
-	// Setup VBO pointers
-	Polygon2D::setupVBOPointers();
+	// Setup VBO pointers (generic attributes if using the flats shader)
+	if (shader)
+	{
+		Polygon2D::setupVBOAttribPointers();
+		shader->setUniform("tex", 0);
+		shader->setUniform("textured", texture ? 1 : 0);
+		if (flat_ignore_light)
+			shader->setUniform("colour", flat_brightness, flat_brightness, flat_brightness, alpha);
+	}
+	else
+		Polygon2D::setupVBOPointers();
+
+	// Enables/disables texturing for the next polygon(s)
+	auto set_textured = [shader](bool textured)
+	{
+		if (shader)
+			shader->setUniform("textured", textured ? 1 : 0);
+		else if (textured)
+			glEnable(GL_TEXTURE_2D);
+		else
+			glDisable(GL_TEXTURE_2D);
+	};
 
 	// Go through sectors
 	unsigned tex_last = 0;
@@ -2248,22 +2483,25 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 		// Update polygon VBO data if needed
 		if (poly->vboUpdate() > 0)
 		{
-			poly->writeToVBO(sector_vbo_offsets_[a]);
+			poly->writeToVBO(sector_vbo_slots_[a].offset);
 			update++;
 			if (update > 200)
+			{
+				layer_incomplete_ = true;
 				break;
+			}
 		}
 
 		// Bind the texture if needed
 		if (tex)
 		{
 			if (!tex_last || first)
-				glEnable(GL_TEXTURE_2D);
+				set_textured(true);
 			if (tex != tex_last)
 				gl::Texture::bind(tex);
 		}
 		else if (!tex_last || first)
-			glDisable(GL_TEXTURE_2D);
+			set_textured(false);
 		tex_last = tex;
 
 		// Render the polygon
@@ -2271,16 +2509,27 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 		{
 			auto col = sector->colourAt(type);
 			col.ampf(flat_brightness, flat_brightness, flat_brightness, 1.0f);
-			glColor4f(col.fr(), col.fg(), col.fb(), alpha);
+			if (shader)
+				shader->setUniform("colour", col.fr(), col.fg(), col.fb(), alpha);
+			else
+				glColor4f(col.fr(), col.fg(), col.fb(), alpha);
 		}
-		poly->renderVBO(sector_vbo_offsets_[a]);
+		poly->renderVBO(sector_vbo_slots_[a].offset);
 	}
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 
 	// Clean up opengl state
-	if (texture)
-		glDisable(GL_TEXTURE_2D);
+	if (shader)
+	{
+		Polygon2D::clearVBOAttribPointers();
+		gl::Shader::unbind();
+	}
+	else
+	{
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		if (texture)
+			glDisable(GL_TEXTURE_2D);
+	}
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
@@ -2289,6 +2538,8 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderFlatHilight(int index, float fade) const
 {
+	gl::profiler::Scope profile{ "2d: Hilight" };
+
 	// Check hilight
 	if (!map_->sector(index))
 		return;
@@ -2318,17 +2569,11 @@ void MapRenderer2D::renderFlatHilight(int index, float fade) const
 	map_->sector(index)->putLines(lines);
 
 	// Draw hilight
+	overlay_buffer_.setColour(col);
 	for (auto line : lines)
-	{
-		if (!line)
-			continue;
-
-		// Draw line
-		glBegin(GL_LINES);
-		glVertex2d(line->v1()->xPos(), line->v1()->yPos());
-		glVertex2d(line->v2()->xPos(), line->v2()->yPos());
-		glEnd();
-	}
+		if (line)
+			overlay_buffer_.addLine(line->x1(), line->y1(), line->x2(), line->y2());
+	drawOverlayBuffer(GL_LINES);
 
 	// Draw sector split lines
 	if (test_ssplit)
@@ -2390,37 +2635,26 @@ void MapRenderer2D::renderFlatSelection(const ItemSelection& selection, float fa
 			else
 			{
 				// Something went wrong with the polygon, just draw sector outline instead
-				glColor4f(col.fr(), col.fg(), col.fb(), col.fa());
-				glBegin(GL_LINES);
 				for (auto& side : sides)
-				{
-					auto line = side->parentLine();
-					glVertex2d(line->v1()->xPos(), line->v1()->yPos());
-					glVertex2d(line->v2()->xPos(), line->v2()->yPos());
-				}
-				glEnd();
-
-				glColor4f(col.fr(), col.fg(), col.fb(), col.fa() * 0.6f);
+					sides_selected.push_back(side);
 			}
 		}
 	}
 
 	// Draw selection outline
-	glColor4f(col.fr(), col.fg(), col.fb(), col.fa());
 	glLineWidth(line_width * 2);
+	overlay_buffer_.setColour(col);
 	vector<uint8_t> lines_drawn(map_->nLines(), 0);
-	glBegin(GL_LINES);
 	for (auto& a : sides_selected)
 	{
 		auto line = a->parentLine();
 		if (lines_drawn[line->index()] > 0)
 			continue;
 
-		glVertex2d(line->v1()->xPos(), line->v1()->yPos());
-		glVertex2d(line->v2()->xPos(), line->v2()->yPos());
+		overlay_buffer_.addLine(line->x1(), line->y1(), line->x2(), line->y2());
 		lines_drawn[line->index()] = 1;
 	}
-	glEnd();
+	drawOverlayBuffer(GL_LINES);
 }
 
 // -----------------------------------------------------------------------------
@@ -2438,50 +2672,47 @@ void MapRenderer2D::renderTaggedFlats(const vector<MapSector*>& sectors, float f
 	col.a *= fade;
 	gl::setColour(col, def.blendMode());
 
-	// Render each sector polygon
+	// Render each sector polygon, batching up their outlines
 	glDisable(GL_TEXTURE_2D);
-	auto object = mapeditor::editContext().selection().hilightedObject();
+	overlay_buffer_.setColour(col);
+	vector<MapLine*> lines;
 	for (auto& sector : sectors)
 	{
 		sector->polygon()->render();
 
 		// Get all lines belonging to the tagged sector
-		vector<MapLine*> lines;
+		lines.clear();
 		sector->putLines(lines);
-
-		// Draw hilight
 		for (auto line : lines)
-		{
-			if (!line)
-				continue;
+			if (line)
+				overlay_buffer_.addLine(line->x1(), line->y1(), line->x2(), line->y2());
+	}
 
-			// Draw line
-			glBegin(GL_LINES);
-			glVertex2d(line->v1()->xPos(), line->v1()->yPos());
-			glVertex2d(line->v2()->xPos(), line->v2()->yPos());
-			glEnd();
-		}
+	// Draw outlines
+	drawOverlayBuffer(GL_LINES);
 
-		// Action lines
-		if (object && action_lines)
+	// Action lines
+	auto object = mapeditor::editContext().selection().hilightedObject();
+	if (!object || !action_lines)
+		return;
+	glLineWidth(line_width * 1.5f);
+	for (auto& sector : sectors)
+	{
+		// Skip if the tagged sector is adjacent
+		if (object->objType() == MapObject::Type::Line)
 		{
-			// Skip if the tagged sector is adjacent
-			if (object->objType() == MapObject::Type::Line)
-			{
-				auto line = dynamic_cast<MapLine*>(object);
-				if (line->frontSector() == sector || line->backSector() == sector)
-					continue;
-			}
-
-			glLineWidth(line_width * 1.5f);
-			drawing::drawArrow(
-				sector->getPoint(MapObject::Point::Within),
-				object->getPoint(MapObject::Point::Within),
-				col,
-				false,
-				arrowhead_angle,
-				arrowhead_length);
+			auto line = dynamic_cast<MapLine*>(object);
+			if (line->frontSector() == sector || line->backSector() == sector)
+				continue;
 		}
+
+		drawing::drawArrow(
+			sector->getPoint(MapObject::Point::Within),
+			object->getPoint(MapObject::Point::Within),
+			col,
+			false,
+			arrowhead_angle,
+			arrowhead_length);
 	}
 }
 
@@ -2491,72 +2722,22 @@ void MapRenderer2D::renderTaggedFlats(const vector<MapSector*>& sectors, float f
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderMovingVertices(const vector<mapeditor::Item>& vertices, Vec2d move_vec) const
 {
-	vector<uint8_t> lines_drawn(map_->nLines(), 0);
-
-	// Determine what lines need drawing (and which of their vertices are being moved)
+	// Draw any lines attached to the moving vertices
+	vector<MapVertex*> moving;
 	for (const auto& item : vertices)
-	{
 		if (auto v = item.asVertex(*map_))
-		{
-			for (const auto& line : v->connectedLines())
-			{
-				if (line->v1() == v)
-					lines_drawn[line->index()] |= 1;
-				if (line->v2() == v)
-					lines_drawn[line->index()] |= 2;
-			}
-		}
-	}
-
-	// Draw any lines attached to the moving vertices
-	glLineWidth(line_width);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glBegin(GL_LINES);
-	for (unsigned a = 0; a < map_->nLines(); a++)
-	{
-		auto line  = map_->line(a);
-		auto drawn = lines_drawn[line->index()];
-
-		// Skip if not attached to any moving vertices
-		if (drawn == 0)
-			continue;
-
-		// Set line colour
-		gl::setColour(lineColour(line, true));
-
-		// First vertex
-		if (drawn & 1)
-			glVertex2d(line->x1() + move_vec.x, line->y1() + move_vec.y);
-		else
-			glVertex2d(line->x1(), line->y1());
-
-		// Second vertex
-		if (drawn & 2)
-			glVertex2d(line->x2() + move_vec.x, line->y2() + move_vec.y);
-		else
-			glVertex2d(line->x2(), line->y2());
-	}
-	glEnd();
+			moving.push_back(v);
+	renderMovingVertexLines(moving, move_vec);
 
 	// Set 'moving' colour
-	colourconfig::setGLColour("map_moving");
+	overlay_buffer_.setColour(setOverlayColour("map_moving"));
 
 	// Draw moving vertex overlays
 	bool point = setupVertexRendering(1.5f);
-	glBegin(GL_POINTS);
-	for (const auto& item : vertices)
-	{
-		if (auto v = item.asVertex(*map_))
-			glVertex2d(v->xPos() + move_vec.x, v->yPos() + move_vec.y);
-	}
-	glEnd();
-
-	// Clean up
-	if (point)
-	{
-		glDisable(GL_POINT_SPRITE);
-		glDisable(GL_TEXTURE_2D);
-	}
+	overlay_buffer_.reserve(moving.size());
+	for (auto v : moving)
+		overlay_buffer_.add(v->xPos() + move_vec.x, v->yPos() + move_vec.y);
+	renderOverlayPoints(point);
 }
 
 // -----------------------------------------------------------------------------
@@ -2565,84 +2746,31 @@ void MapRenderer2D::renderMovingVertices(const vector<mapeditor::Item>& vertices
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderMovingLines(const vector<mapeditor::Item>& lines, Vec2d move_vec) const
 {
-	vector<uint8_t> lines_drawn(map_->nLines(), 0);
-
-	// Determine what lines need drawing (and which of their vertices are being moved)
+	// Draw any lines attached to the moving lines' vertices
+	vector<MapVertex*> moving;
 	for (const auto& item : lines)
 	{
 		if (auto line = item.asLine(*map_))
 		{
-			// Check first vertex
-			auto v = line->v1();
-			for (unsigned l = 0; l < v->nConnectedLines(); l++)
-			{
-				auto cline = v->connectedLine(l);
-
-				if (cline->v1() == v)
-					lines_drawn[cline->index()] |= 1;
-				if (cline->v2() == v)
-					lines_drawn[cline->index()] |= 2;
-			}
-
-			// Check second vertex
-			v = line->v2();
-			for (unsigned l = 0; l < v->nConnectedLines(); l++)
-			{
-				auto cline = v->connectedLine(l);
-
-				if (cline->v1() == v)
-					lines_drawn[cline->index()] |= 1;
-				if (cline->v2() == v)
-					lines_drawn[cline->index()] |= 2;
-			}
+			moving.push_back(line->v1());
+			moving.push_back(line->v2());
 		}
 	}
-
-	// Draw any lines attached to the moving vertices
-	glLineWidth(line_width);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glBegin(GL_LINES);
-	for (unsigned a = 0; a < map_->nLines(); a++)
-	{
-		auto line  = map_->line(a);
-		auto drawn = lines_drawn[line->index()];
-
-		// Skip if not attached to any moving vertices
-		if (drawn == 0)
-			continue;
-
-		// Set line colour
-		gl::setColour(lineColour(line, true));
-
-		// First vertex
-		if (drawn & 1)
-			glVertex2d(line->x1() + move_vec.x, line->y1() + move_vec.y);
-		else
-			glVertex2d(line->x1(), line->y1());
-
-		// Second vertex
-		if (drawn & 2)
-			glVertex2d(line->x2() + move_vec.x, line->y2() + move_vec.y);
-		else
-			glVertex2d(line->x2(), line->y2());
-	}
-	glEnd();
+	renderMovingVertexLines(moving, move_vec);
 
 	// Set 'moving' colour
-	colourconfig::setGLColour("map_moving");
+	overlay_buffer_.setColour(setOverlayColour("map_moving"));
 
 	// Draw moving line overlays
 	glLineWidth(line_width * 3);
-	glBegin(GL_LINES);
+	overlay_buffer_.reserve(lines.size() * 2);
 	for (const auto& item : lines)
 	{
 		if (auto line = item.asLine(*map_))
-		{
-			glVertex2d(line->x1() + move_vec.x, line->y1() + move_vec.y);
-			glVertex2d(line->x2() + move_vec.x, line->y2() + move_vec.y);
-		}
+			overlay_buffer_.addLine(
+				line->x1() + move_vec.x, line->y1() + move_vec.y, line->x2() + move_vec.x, line->y2() + move_vec.y);
 	}
-	glEnd();
+	drawOverlayBuffer(GL_LINES);
 }
 
 // -----------------------------------------------------------------------------
@@ -2652,7 +2780,7 @@ void MapRenderer2D::renderMovingLines(const vector<mapeditor::Item>& lines, Vec2
 void MapRenderer2D::renderMovingSectors(const vector<mapeditor::Item>& sectors, Vec2d move_vec) const
 {
 	// Determine what lines are being moved
-	vector<uint8_t> lines_moved(map_->nLines(), 0);
+	vector<int> lines_moved;
 	for (auto item : sectors)
 	{
 		if (auto sector = item.asSector(*map_))
@@ -2660,99 +2788,86 @@ void MapRenderer2D::renderMovingSectors(const vector<mapeditor::Item>& sectors,
 			// Go through connected sides
 			auto& sides = sector->connectedSides();
 			for (auto& side : sides)
-				lines_moved[side->parentLine()->index()] = 1; // Mark parent line as moved
+				lines_moved.push_back(side->parentLine()->index());
 		}
 	}
+	std::sort(lines_moved.begin(), lines_moved.end());
+	lines_moved.erase(std::unique(lines_moved.begin(), lines_moved.end()), lines_moved.end());
 
 	// Build list of moving lines
 	vector<mapeditor::Item> lines;
-	for (unsigned a = 0; a < map_->nLines(); a++)
-	{
-		if (lines_moved[a] > 0)
-			lines.emplace_back((int)a, mapeditor::ItemType::Line);
-	}
+	for (auto index : lines_moved)
+		lines.emplace_back(index, mapeditor::ItemType::Line);
 
 	// Draw moving lines
 	renderMovingLines(lines, move_vec);
 }
 
 // -----------------------------------------------------------------------------
-// Renders the moving overlay for thing indices in [things], to show movement by
-// [move_vec]
+// Renders all lines connected to any of the moving [vertices], with the moving
+// ends offset by [move_vec]
 // -----------------------------------------------------------------------------
-void MapRenderer2D::renderMovingThings(const vector<mapeditor::Item>& things, Vec2d move_vec)
+void MapRenderer2D::renderMovingVertexLines(vector<MapVertex*> vertices, Vec2d move_vec) const
 {
-	// Enable textures
-	glEnable(GL_TEXTURE_2D);
-	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	// Get lines connected to the moving vertices
+	std::sort(vertices.begin(), vertices.end());
+	vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+	vector<MapLine*> lines;
+	for (auto vertex : vertices)
+		lines.insert(lines.end(), vertex->connectedLines().begin(), vertex->connectedLines().end());
+	std::sort(lines.begin(), lines.end());
+	lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
 
-	// Draw things
-	MapThing* thing;
-	double    x, y, angle;
-	for (unsigned a = 0; a < things.size(); a++)
-	{
-		thing = things[a].asThing(*map_);
-		if (!thing)
-			continue;
+	auto moving = [&vertices](MapVertex* vertex)
+	{ return std::binary_search(vertices.begin(), vertices.end(), vertex); };
 
-		// Get thing info
-		x     = thing->xPos() + move_vec.x;
-		y     = thing->yPos() + move_vec.y;
-		angle = thing->angle();
+	glLineWidth(line_width);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	overlay_buffer_.reserve(lines.size() * 2);
+	for (auto line : lines)
+	{
+		// Line colour
+		auto col = lineColour(line, true);
 
-		// Get thing type properties from game configuration
-		auto& tt = game::configuration().thingType(thing->type());
+		// First vertex
+		if (moving(line->v1()))
+			overlay_buffer_.add(line->x1() + move_vec.x, line->y1() + move_vec.y, col);
+		else
+			overlay_buffer_.add(line->x1(), line->y1(), col);
 
-		// Draw thing depending on 'things_drawtype' cvar
-		if (thing_drawtype == ThingDrawType::Sprite) // Drawtype 2: Sprites
-			renderSpriteThing(x, y, angle, tt, thing->args(), a, 1.0f);
-		else if (thing_drawtype == ThingDrawType::Round) // Drawtype 1: Round
-			renderRoundThing(x, y, angle, tt, thing->args(), 1.0f);
-		else // Drawtype 0 (or other): Square
-			renderSquareThing(
-				x,
-				y,
-				angle,
-				tt,
-				thing->args(),
-				1.0f,
-				thing_drawtype < ThingDrawType::SquareSprite,
-				thing_drawtype == ThingDrawType::FramedSprite);
+		// Second vertex
+		if (moving(line->v2()))
+			overlay_buffer_.add(line->x2() + move_vec.x, line->y2() + move_vec.y, col);
+		else
+			overlay_buffer_.add(line->x2(), line->y2(), col);
 	}
+	drawOverlayBuffer(GL_LINES);
+}
 
-	// Draw thing sprites within squares if that drawtype is set
-	if (thing_drawtype > ThingDrawType::Sprite)
-	{
-		glEnable(GL_TEXTURE_2D);
-
-		for (const auto& item : things)
-		{
-			if ((thing = item.asThing(*map_)))
-			{
-				// Get thing info
-				auto& tt = game::configuration().thingType(thing->type());
-				x        = thing->xPos() + move_vec.x;
-				y        = thing->yPos() + move_vec.y;
-				angle    = thing->angle();
+// -----------------------------------------------------------------------------
+// Renders the moving overlay for thing indices in [things], to show movement by
+// [move_vec]
+// -----------------------------------------------------------------------------
+void MapRenderer2D::renderMovingThings(const vector<mapeditor::Item>& things, Vec2d move_vec)
+{
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-				renderSpriteThing(x, y, angle, tt, thing->args(), item.index, 1.0f, true);
-			}
-		}
-	}
+	// Draw things
+	vector<ThingInstance> instances;
+	for (const auto& item : things)
+		if (auto thing = item.asThing(*map_))
+			instances.push_back(
+				{ thing, thing->xPos() + move_vec.x, thing->yPos() + move_vec.y, thing->index(), 1.0f });
+	renderThingInstances(instances);
 
 	// Set 'moving' colour
-	colourconfig::setGLColour("map_moving");
+	auto col = setOverlayColour("map_moving");
 
 	// Draw moving thing overlays
-	bool point = setupThingOverlay();
-	for (auto item : things)
+	auto tex = thingOverlayTexture();
+	for (auto& inst : instances)
 	{
-		thing = item.asThing(*map_);
-		if (!thing)
-			continue;
-
-		auto&  tt     = game::configuration().thingType(thing->type());
+		auto&  tt     = inst.thing->typeDef();
 		double radius = tt.radius();
 		if (tt.shrinkOnZoom())
 			radius = scaledRadius(radius);
@@ -2761,15 +2876,9 @@ void MapRenderer2D::renderMovingThings(const vector<mapeditor::Item>& things, Ve
 		if (!thing_overlay_square)
 			radius += 8;
 
-		renderThingOverlay(thing->xPos() + move_vec.x, thing->yPos() + move_vec.y, radius, point);
-	}
-
-	// Clean up gl state
-	if (point)
-	{
-		glDisable(GL_POINT_SPRITE);
-		glDisable(GL_TEXTURE_2D);
+		renderThingOverlay(tex, inst.x, inst.y, radius, col);
 	}
+	flushThingBatches();
 }
 
 // -----------------------------------------------------------------------------
@@ -2777,65 +2886,23 @@ void MapRenderer2D::renderMovingThings(const vector<mapeditor::Item>& things, Ve
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderPasteThings(const vector<MapThing*>& things, Vec2d pos)
 {
-	// Enable textures
-	glEnable(GL_TEXTURE_2D);
-	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	// Draw things
-	double x, y, angle;
+	vector<ThingInstance> instances;
+	instances.reserve(things.size());
 	for (auto thing : things)
-	{
-		// Get thing info
-		x     = thing->xPos() + pos.x;
-		y     = thing->yPos() + pos.y;
-		angle = thing->angle();
-
-		// Get thing type properties from game configuration
-		auto& tt = game::configuration().thingType(thing->type());
-
-		// Draw thing depending on 'things_drawtype' cvar
-		if (thing_drawtype == ThingDrawType::Sprite) // Drawtype 2: Sprites
-			renderSpriteThing(x, y, angle, tt, thing->args(), wxUINT32_MAX, 1.0f);
-		else if (thing_drawtype == ThingDrawType::Round) // Drawtype 1: Round
-			renderRoundThing(x, y, angle, tt, thing->args(), 1.0f);
-		else // Drawtype 0 (or other): Square
-			renderSquareThing(
-				x,
-				y,
-				angle,
-				tt,
-				thing->args(),
-				1.0f,
-				thing_drawtype < ThingDrawType::SquareSprite,
-				thing_drawtype == ThingDrawType::FramedSprite);
-	}
-
-	// Draw thing sprites within squares if that drawtype is set
-	if (thing_drawtype > ThingDrawType::Sprite)
-	{
-		glEnable(GL_TEXTURE_2D);
-
-		for (auto thing : things)
-		{
-			// Get thing info
-			auto& tt = game::configuration().thingType(thing->type());
-			x        = thing->xPos() + pos.x;
-			y        = thing->yPos() + pos.y;
-			angle    = thing->angle();
-
-			renderSpriteThing(x, y, angle, tt, thing->args(), wxUINT32_MAX, 1.0f, true);
-		}
-	}
+		instances.push_back({ thing, thing->xPos() + pos.x, thing->yPos() + pos.y, wxUINT32_MAX, 1.0f });
+	renderThingInstances(instances);
 
 	// Set 'drawing' colour
-	colourconfig::setGLColour("map_linedraw");
+	auto col = setOverlayColour("map_linedraw");
 
 	// Draw moving thing overlays
-	bool point = setupThingOverlay();
-	for (auto thing : things)
+	auto tex = thingOverlayTexture();
+	for (auto& inst : instances)
 	{
-		auto&  tt     = game::configuration().thingType(thing->type());
+		auto&  tt     = inst.thing->typeDef();
 		double radius = tt.radius();
 		if (tt.shrinkOnZoom())
 			radius = scaledRadius(radius);
@@ -2844,15 +2911,9 @@ void MapRenderer2D::renderPasteThings(const vector<MapThing*>& things, Vec2d pos
 		if (!thing_overlay_square)
 			radius += 8;
 
-		renderThingOverlay(thing->xPos() + pos.x, thing->yPos() + pos.y, radius, point);
-	}
-
-	// Clean up gl state
-	if (point)
-	{
-		glDisable(GL_POINT_SPRITE);
-		glDisable(GL_TEXTURE_2D);
+		renderThingOverlay(tex, inst.x, inst.y, radius, col);
 	}
+	flushThingBatches();
 }
 
 // -----------------------------------------------------------------------------
@@ -2872,48 +2933,38 @@ void MapRenderer2D::renderObjectEditGroup(ObjectEditGroup* group)
 	// --- Lines ---
 
 	// Lines
-	glBegin(GL_LINES);
 	glLineWidth(line_width);
 	for (auto& line : lines)
 	{
-		gl::setColour(lineColour(line.map_line, true));
-		glVertex2d(line.v1->position.x, line.v1->position.y);
-		glVertex2d(line.v2->position.x, line.v2->position.y);
+		auto col = lineColour(line.map_line, true);
+		overlay_buffer_.add(line.v1->position.x, line.v1->position.y, col);
+		overlay_buffer_.add(line.v2->position.x, line.v2->position.y, col);
 	}
-	glEnd();
+	drawOverlayBuffer(GL_LINES);
 
 	// Edit overlay
-	colourconfig::setGLColour("map_object_edit");
+	overlay_buffer_.setColour(setOverlayColour("map_object_edit"));
 	glLineWidth(line_width * 3);
-	glBegin(GL_LINES);
 	for (auto& line : lines)
 	{
 		if (line.isExtra())
 			continue;
 
-		glVertex2d(line.v1->position.x, line.v1->position.y);
-		glVertex2d(line.v2->position.x, line.v2->position.y);
+		overlay_buffer_.addLine(line.v1->position, line.v2->position);
 	}
-	glEnd();
+	drawOverlayBuffer(GL_LINES);
 
 	// --- Vertices ---
 
 	// Setup rendering properties
 	bool point = setupVertexRendering(1.0f);
 	gl::setColour(colourconfig::colour("map_object_edit"));
+	overlay_buffer_.setColour(colourconfig::colour("map_object_edit"));
 
 	// Render vertices
-	glBegin(GL_POINTS);
 	for (auto& vertex_point : vertex_points)
-		glVertex2d(vertex_point.x, vertex_point.y);
-	glEnd();
-
-	// Clean up
-	if (point)
-	{
-		glDisable(GL_POINT_SPRITE);
-		glDisable(GL_TEXTURE_2D);
-	}
+		overlay_buffer_.add(vertex_point);
+	renderOverlayPoints(point);
 
 	// --- Things ---
 
@@ -2923,69 +2974,23 @@ void MapRenderer2D::renderObjectEditGroup(ObjectEditGroup* group)
 
 	if (!things.empty())
 	{
-		// Enable textures
-		glEnable(GL_TEXTURE_2D);
-		glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 		// Draw things
-		MapThing* thing;
-		double    x, y, angle;
+		vector<ThingInstance> instances;
+		instances.reserve(things.size());
 		for (auto& item : things)
-		{
-			// Get thing info
-			thing = item.map_thing;
-			x     = item.position.x;
-			y     = item.position.y;
-			angle = thing->angle();
-
-			// Get thing type properties from game configuration
-			auto& tt = game::configuration().thingType(thing->type());
-
-			// Draw thing depending on 'things_drawtype' cvar
-			if (thing_drawtype == ThingDrawType::Sprite) // Drawtype 2: Sprites
-				renderSpriteThing(x, y, angle, tt, thing->args(), thing->index(), 1.0f);
-			else if (thing_drawtype == ThingDrawType::Round) // Drawtype 1: Round
-				renderRoundThing(x, y, angle, tt, thing->args(), 1.0f);
-			else // Drawtype 0 (or other): Square
-				renderSquareThing(
-					x,
-					y,
-					angle,
-					tt,
-					thing->args(),
-					1.0f,
-					thing_drawtype < ThingDrawType::SquareSprite,
-					thing_drawtype == ThingDrawType::FramedSprite);
-		}
-
-		// Draw thing sprites within squares if that drawtype is set
-		if (thing_drawtype > ThingDrawType::Sprite)
-		{
-			glEnable(GL_TEXTURE_2D);
-
-			for (auto& item : things)
-			{
-				// Get thing info
-				thing    = item.map_thing;
-				auto& tt = game::configuration().thingType(thing->type());
-				x        = item.position.x;
-				y        = item.position.y;
-				angle    = thing->angle();
-
-				renderSpriteThing(x, y, angle, tt, thing->args(), thing->index(), 1.0f, true);
-			}
-		}
+			instances.push_back({ item.map_thing, item.position.x, item.position.y, item.map_thing->index(), 1.0f });
+		renderThingInstances(instances);
 
 		// Set 'object edit' colour
-		colourconfig::setGLColour("map_object_edit");
+		auto col = setOverlayColour("map_object_edit");
 
 		// Draw moving thing overlays
-		bool point_spr = setupThingOverlay();
-		for (auto& item : things)
+		auto tex = thingOverlayTexture();
+		for (auto& inst : instances)
 		{
-			thing         = item.map_thing;
-			auto&  tt     = game::configuration().thingType(thing->type());
+			auto&  tt     = inst.thing->typeDef();
 			double radius = tt.radius();
 			if (tt.shrinkOnZoom())
 				radius = scaledRadius(radius);
@@ -2994,15 +2999,9 @@ void MapRenderer2D::renderObjectEditGroup(ObjectEditGroup* group)
 			if (!thing_overlay_square)
 				radius += 8;
 
-			renderThingOverlay(item.position.x, item.position.y, radius, point_spr);
-		}
-
-		// Clean up gl state
-		if (point_spr)
-		{
-			glDisable(GL_POINT_SPRITE);
-			glDisable(GL_TEXTURE_2D);
+			renderThingOverlay(tex, inst.x, inst.y, radius, col);
 		}
+		flushThingBatches();
 	}
 }
 
@@ -3054,46 +3053,9 @@ void MapRenderer2D::updateLinesVBO(bool show_direction, float base_alpha)
 	int            nverts = map_->nLines() * vpl;
 	vector<GLVert> lines(nverts);
 	unsigned       v = 0;
-	ColRGBA        col;
-	float          alpha;
 	for (unsigned a = 0; a < map_->nLines(); a++)
 	{
-		auto line = map_->line(a);
-
-		// Get line colour
-		col   = lineColour(line);
-		alpha = base_alpha * col.fa();
-
-		// Set line vertices
-		lines[v].x     = line->v1()->xPos();
-		lines[v].y     = line->v1()->yPos();
-		lines[v + 1].x = line->v2()->xPos();
-		lines[v + 1].y = line->v2()->yPos();
-
-		// Set line colour(s)
-		lines[v].r = lines[v + 1].r = col.fr();
-		lines[v].g = lines[v + 1].g = col.fg();
-		lines[v].b = lines[v + 1].b = col.fb();
-		lines[v].a = lines[v + 1].a = alpha;
-
-		// Direction tab if needed
-		if (show_direction)
-		{
-			auto mid       = line->getPoint(MapObject::Point::Mid);
-			auto tab       = line->dirTabPoint();
-			lines[v + 2].x = mid.x;
-			lines[v + 2].y = mid.y;
-			lines[v + 3].x = tab.x;
-			lines[v + 3].y = tab.y;
-
-			// Colours
-			lines[v + 2].r = lines[v + 3].r = col.fr();
-			lines[v + 2].g = lines[v + 3].g = col.fg();
-			lines[v + 2].b = lines[v + 3].b = col.fb();
-			lines[v + 2].a = lines[v + 3].a = alpha * 0.6f;
-		}
-
-		// Next line
+		setLineVBOData(&lines[v], map_->line(a), show_direction, base_alpha);
 		v += vpl;
 	}
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_lines_);
@@ -3103,9 +3065,160 @@ void MapRenderer2D::updateLinesVBO(bool show_direction, float base_alpha)
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
 	n_lines_       = map_->nLines();
+	lines_alpha_   = base_alpha;
 	lines_updated_ = app::runTimer();
 }
 
+// -----------------------------------------------------------------------------
+// Updates the data for [lines] in the lines VBO (or display list), for changes
+// that aren't picked up automatically - eg. lines being filtered
+// -----------------------------------------------------------------------------
+void MapRenderer2D::updateLinesVBO(const vector<MapLine*>& lines)
+{
+	// Display list can only be rebuilt entirely
+	if (!gl::vboSupport())
+	{
+		if (list_lines_ > 0)
+		{
+			glDeleteLists(list_lines_, 1);
+			list_lines_ = 0;
+		}
+		return;
+	}
+
+	// Nothing to do if the VBO will be rebuilt anyway
+	if (vbo_lines_ == 0 || map_->nLines() != n_lines_)
+		return;
+
+	// Write each line's data
+	unsigned       vpl = lines_dirs_ ? 4 : 2;
+	vector<GLVert> verts(vpl);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_lines_);
+	for (const auto& line : lines)
+	{
+		if (line->index() >= n_lines_)
+			continue;
+
+		setLineVBOData(verts.data(), line, lines_dirs_, lines_alpha_);
+		glBufferSubData(
+			GL_ARRAY_BUFFER, sizeof(GLVert) * vpl * line->index(), sizeof(GLVert) * vpl, verts.data());
+	}
+
+	// Clean up
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// -----------------------------------------------------------------------------
+// Updates the lines VBO data in place for only the lines modified (or with
+// vertices moved) since it was last updated.
+// Returns false if the VBO needs to be rebuilt entirely instead (eg. if lines
+// were added or removed, or most of the lines were modified)
+// -----------------------------------------------------------------------------
+bool MapRenderer2D::updateModifiedLinesVBO(bool show_direction, float base_alpha)
+{
+	// Check the VBO layout is still the same
+	if (vbo_lines_ == 0 || show_direction != lines_dirs_ || base_alpha != lines_alpha_
+		|| map_->nLines() != n_lines_ || map_->mapData().objectsUpdated() >= lines_updated_)
+		return false;
+
+	// Get modified lines
+	vector<MapLine*> lines;
+	for (auto* object : map_->mapData().modifiedObjects(lines_updated_, MapObject::Type::Line))
+		lines.push_back(dynamic_cast<MapLine*>(object));
+	for (auto* object : map_->mapData().modifiedObjects(lines_updated_, MapObject::Type::Vertex))
+	{
+		auto& connected = dynamic_cast<MapVertex*>(object)->connectedLines();
+		lines.insert(lines.end(), connected.begin(), connected.end());
+	}
+	std::sort(lines.begin(), lines.end());
+	lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+
+	// Not worth it if most of the map was modified
+	if (lines.size() > n_lines_ / 4)
+		return false;
+
+	log::info(3, "Updating {} lines in lines VBO", lines.size());
+
+	updateLinesVBO(lines);
+	lines_updated_ = app::runTimer();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Updates the vertices VBO data in place for only the vertices modified since
+// it was last updated.
+// Returns false if the VBO needs to be rebuilt entirely instead
+// -----------------------------------------------------------------------------
+bool MapRenderer2D::updateModifiedVerticesVBO()
+{
+	// Check the VBO layout is still the same
+	if (vbo_vertices_ == 0 || map_->nVertices() != n_vertices_
+		|| map_->mapData().objectsUpdated() >= vertices_updated_)
+		return false;
+
+	// Not worth it if most of the map was modified
+	auto vertices = map_->mapData().modifiedObjects(vertices_updated_, MapObject::Type::Vertex);
+	if (vertices.size() > n_vertices_ / 4)
+		return false;
+
+	// Write each vertex position
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_vertices_);
+	for (auto* object : vertices)
+	{
+		auto*   vertex = dynamic_cast<MapVertex*>(object);
+		GLfloat pos[2] = { static_cast<GLfloat>(vertex->xPos()), static_cast<GLfloat>(vertex->yPos()) };
+		glBufferSubData(GL_ARRAY_BUFFER, sizeof(pos) * vertex->index(), sizeof(pos), pos);
+	}
+
+	// Clean up
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	vertices_updated_ = app::runTimer();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the VBO vertex data for [line] to [verts] (2 vertices, or 4 if
+// [show_direction] is true)
+// -----------------------------------------------------------------------------
+void MapRenderer2D::setLineVBOData(GLVert* verts, MapLine* line, bool show_direction, float base_alpha) const
+{
+	// Get line colour
+	auto  col   = lineColour(line);
+	float alpha = base_alpha * col.fa();
+
+	// Set line vertices
+	verts[0].x = line->v1()->xPos();
+	verts[0].y = line->v1()->yPos();
+	verts[1].x = line->v2()->xPos();
+	verts[1].y = line->v2()->yPos();
+
+	// Set line colour(s)
+	verts[0].r = verts[1].r = col.fr();
+	verts[0].g = verts[1].g = col.fg();
+	verts[0].b = verts[1].b = col.fb();
+	verts[0].a = verts[1].a = alpha;
+
+	// Direction tab if needed
+	if (show_direction)
+	{
+		auto mid   = line->getPoint(MapObject::Point::Mid);
+		auto tab   = line->dirTabPoint();
+		verts[2].x = mid.x;
+		verts[2].y = mid.y;
+		verts[3].x = tab.x;
+		verts[3].y = tab.y;
+
+		// Colours
+		verts[2].r = verts[3].r = col.fr();
+		verts[2].g = verts[3].g = col.fg();
+		verts[2].b = verts[3].b = col.fb();
+		verts[2].a = verts[3].a = alpha * 0.6f;
+	}
+}
+
 // -----------------------------------------------------------------------------
 // (Re)builds the map flats VBO
 // -----------------------------------------------------------------------------
@@ -3119,7 +3232,7 @@ void MapRenderer2D::updateFlatsVBO()
 		glGenBuffers(1, &vbo_flats_);
 
 	auto n_sectors = map_->nSectors();
-	sector_vbo_offsets_.resize(n_sectors);
+	sector_vbo_slots_.resize(n_sectors);
 
 	// Get total size needed
 	unsigned totalsize = 0;
@@ -3137,9 +3250,10 @@ void MapRenderer2D::updateFlatsVBO()
 	unsigned offset = 0;
 	for (unsigned a = 0; a < n_sectors; a++)
 	{
-		sector_vbo_offsets_[a] = offset;
-		auto* poly             = map_->sector(a)->polygon();
-		offset                 = poly->writeToVBO(offset);
+		auto* sector         = map_->sector(a);
+		auto* poly           = sector->polygon();
+		sector_vbo_slots_[a] = { sector, offset, poly->vboDataSize() };
+		offset               = poly->writeToVBO(offset);
 	}
 
 	// Clean up
@@ -3153,6 +3267,9 @@ void MapRenderer2D::updateFlatsVBO()
 // -----------------------------------------------------------------------------
 void MapRenderer2D::updateVisibility(Vec2d view_tl, Vec2d view_br)
 {
+	view_tl_ = view_tl;
+	view_br_ = view_br;
+
 	// Sector visibility
 	if (map_->nSectors() != vis_s_.size())
 	{
@@ -3180,34 +3297,296 @@ void MapRenderer2D::updateVisibility(Vec2d view_tl, Vec2d view_br)
 			vis_s_[a] = VIS_SMALL;
 	}
 
-	// Thing visibility
-	if (map_->nThings() != vis_t_.size())
+	// Vertices, lines and things
+	updateVisibleObjects();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the lists of vertices, lines and things possibly visible in the
+// current view, if the view has moved outside the area they were queried for
+// or the map has been modified since
+// -----------------------------------------------------------------------------
+void MapRenderer2D::updateVisibleObjects()
+{
+	// Check if the current lists are still valid
+	if (visible_.updated >= 0 && visible_.area.pointWithin(view_tl_.x, view_tl_.y)
+		&& visible_.area.pointWithin(view_br_.x, view_br_.y) && visible_.n_vertices == map_->nVertices()
+		&& visible_.n_lines == map_->nLines() && visible_.n_things == map_->nThings()
+		&& map_->geometryUpdated() <= visible_.updated && map_->thingsUpdated() <= visible_.updated
+		&& map_->mapData().lastModifiedTime() <= visible_.updated)
+		return;
+
+	// Pad the query area by half the view size on each side, so small pans
+	// don't require a new query
+	double pad_x = (view_br_.x - view_tl_.x) * 0.5;
+	double pad_y = (view_br_.y - view_tl_.y) * 0.5;
+	visible_.area.min.set(view_tl_.x - pad_x, view_tl_.y - pad_y);
+	visible_.area.max.set(view_br_.x + pad_x, view_br_.y + pad_y);
+	auto& area = visible_.area;
+
+	// Vertices & lines
+	visible_.vertices.clear();
+	visible_.lines.clear();
+	map_->vertices().putAllInArea(area.min.x, area.min.y, area.max.x, area.max.y, visible_.vertices);
+	map_->lines().putAllInArea(area.min.x, area.min.y, area.max.x, area.max.y, visible_.lines);
+	buildIndexRuns(visible_.vertices, visible_.vertex_first, visible_.vertex_count);
+	buildIndexRuns(visible_.lines, visible_.line_first, visible_.line_count);
+
+	// Things (the area is extended by the largest thing radius, since only
+	// their positions are indexed)
+	double max_radius = game::ThingType::unknown().radius();
+	for (auto& tt : game::configuration().allThingTypes())
+		max_radius = std::max<double>(max_radius, tt.second.radius());
+	max_radius *= 1.3;
+	visible_.things.clear();
+	map_->things().putAllInArea(
+		area.min.x - max_radius,
+		area.min.y - max_radius,
+		area.max.x + max_radius,
+		area.max.y + max_radius,
+		visible_.things);
+
+	visible_.n_vertices = map_->nVertices();
+	visible_.n_lines    = map_->nLines();
+	visible_.n_things   = map_->nThings();
+	visible_.updated    = app::runTimer();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the list of point lights that may be visible in the current view (if
+// needed). Like updateVisibleObjects, the lights are queried from the map's
+// spatial index for an area padded around the view, and the list is kept until
+// the view leaves that area or things are modified
+// -----------------------------------------------------------------------------
+void MapRenderer2D::updateVisibleLights()
+{
+	auto& lights      = visible_lights_;
+	auto  map_changed = lights.updated < 0 || lights.n_things != map_->nThings()
+					   || map_->thingsUpdated() > lights.updated
+					   || map_->mapData().lastModifiedTime() > lights.updated
+					   || lights.types_version != game::configuration().thingTypesVersion();
+
+	// Check if the current list is still valid
+	if (!map_changed && lights.area.pointWithin(view_tl_.x, view_tl_.y)
+		&& lights.area.pointWithin(view_br_.x, view_br_.y))
+		return;
+
+	ColRGBA colour;
+	double  radius;
+
+	// Get the largest light radius in the map (things are only indexed by
+	// position, so the query area must be extended by this)
+	if (map_changed)
 	{
-		// Number of things changed, reset array
-		vis_t_.clear();
-		for (unsigned a = 0; a < map_->nThings(); a++)
-			vis_t_.push_back(0);
+		lights.max_radius = 0.;
+		for (const auto& thing : map_->things())
+			if (pointLightPreview(*thing, colour, radius))
+				lights.max_radius = std::max(lights.max_radius, radius);
 	}
-	double x, y;
-	double radius;
-	for (unsigned a = 0; a < vis_t_.size(); a++)
+
+	// Pad the area by half the view size on each side, as for visible objects
+	double pad_x = (view_br_.x - view_tl_.x) * 0.5;
+	double pad_y = (view_br_.y - view_tl_.y) * 0.5;
+	lights.area.min.set(view_tl_.x - pad_x, view_tl_.y - pad_y);
+	lights.area.max.set(view_br_.x + pad_x, view_br_.y + pad_y);
+	auto& area = lights.area;
+
+	// Get lights that reach the area
+	lights.things.clear();
+	lights.instances.clear();
+	if (lights.max_radius > 0.)
 	{
-		vis_t_[a] = 0;
-		x         = map_->thing(a)->xPos();
-		y         = map_->thing(a)->yPos();
+		auto pad = lights.max_radius;
+		map_->things().putAllInArea(
+			area.min.x - pad, area.min.y - pad, area.max.x + pad, area.max.y + pad, lights.things);
 
-		// Get thing type properties from game configuration
-		auto& tt = game::configuration().thingType(map_->thing(a)->type());
-		radius   = tt.radius() * 1.3;
+		unsigned count = 0;
+		for (auto thing : lights.things)
+		{
+			if (!pointLightPreview(*thing, colour, radius))
+				continue;
+
+			auto x = thing->xPos();
+			auto y = thing->yPos();
+			if (x + radius < area.min.x || x - radius > area.max.x || y + radius < area.min.y
+				|| y - radius > area.max.y)
+				continue;
+
+			lights.things[count++] = thing;
+			lights.instances.push_back({ static_cast<float>(x),
+										 static_cast<float>(y),
+										 static_cast<float>(radius),
+										 colour.fr(),
+										 colour.fg(),
+										 colour.fb() });
+		}
+		lights.things.resize(count);
+	}
+
+	lights.n_things      = map_->nThings();
+	lights.types_version = game::configuration().thingTypesVersion();
+	lights.updated       = app::runTimer();
+	lights.uploaded      = false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if this layer state is the same as [other]
+// -----------------------------------------------------------------------------
+bool MapRenderer2D::LayerState::operator==(const LayerState& other) const
+{
+	return edit_mode == other.edit_mode && sector_mode == other.sector_mode && mouse_state == other.mouse_state
+		   && flat_type == other.flat_type && grid_size == other.grid_size && hilight == other.hilight
+		   && fade_flats == other.fade_flats && fade_lines == other.fade_lines && fade_vertices == other.fade_vertices
+		   && fade_things == other.fade_things;
+}
+
+// -----------------------------------------------------------------------------
+// Begins rendering the static map layer for [view] with [state].
+// Returns true if the layer needs to be drawn - either to the offscreen layer
+// buffer (which is bound and set up for drawing here), or directly if layer
+// caching is disabled or unsupported. Returns false if the cached layer is
+// still valid and can be reused. Either way, endStaticLayer must be called
+// afterwards
+// -----------------------------------------------------------------------------
+bool MapRenderer2D::beginStaticLayer(const gl::View& view, const LayerState& state)
+{
+	auto   size   = view.size();
+	auto   offset = view.offset(true);
+	double scale  = view.scale(true);
+
+	// Get area of the map visible in the view
+	BBox view_area;
+	view_area.min.set(offset.x - size.x * 0.5 / scale, offset.y - size.y * 0.5 / scale);
+	view_area.max.set(offset.x + size.x * 0.5 / scale, offset.y + size.y * 0.5 / scale);
+
+	layer_active_  = false;
+	layer_drawing_ = false;
+	if (!map_cache_layer || !gl::fboSupport() || scale <= 0.)
+	{
+		layer_buffer_.clear();
+		layer_area_ = view_area;
+		return true;
+	}
+
+	// The hilighted thing only affects the layer if point lights are shown
+	auto layer_state = state;
+	if (!thing_preview_lights)
+		layer_state.hilight = -1;
+
+	// Check if the cached layer can be reused
+	int      margin_x = size.x / 4;
+	int      margin_y = size.y / 4;
+	unsigned objects  = map_->nVertices() + map_->nLines() + map_->nSectors() + map_->nThings();
+	if (layer_updated_ >= 0 && layer_buffer_.width() == size.x + margin_x * 2
+		&& layer_buffer_.height() == size.y + margin_y * 2 && scale == layer_scale_ && layer_state == layer_state_
+		&& view_area.isWithin(layer_area_.min, layer_area_.max) && objects == layer_objects_
+		&& map_->geometryUpdated() <= layer_updated_ && map_->thingsUpdated() <= layer_updated_
+		&& map_->mapData().lastModifiedTime() <= layer_updated_)
+	{
+		layer_active_ = true;
+		return false;
+	}
+
+	// Setup the layer buffer, with a margin of a quarter of the view size on
+	// each side so the view can be panned a bit before it needs re-rendering
+	int width  = size.x + margin_x * 2;
+	int height = size.y + margin_y * 2;
+	if (!layer_buffer_.setup(width, height))
+	{
+		layer_area_ = view_area;
+		return true;
+	}
+	layer_area_.min.set(offset.x - width * 0.5 / scale, offset.y - height * 0.5 / scale);
+	layer_area_.max.set(offset.x + width * 0.5 / scale, offset.y + height * 0.5 / scale);
+	layer_state_      = layer_state;
+	layer_scale_      = scale;
+	layer_objects_    = objects;
+	layer_updated_    = app::runTimer();
+	layer_incomplete_ = false;
+	layer_active_     = true;
+	layer_drawing_    = true;
+
+	// Bind and clear the layer buffer
+	layer_buffer_.bind();
+	glViewport(0, 0, width, height);
+	auto col_bg = colourconfig::colour("map_background");
+	glClearColor(col_bg.fr(), col_bg.fg(), col_bg.fb(), 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	// Setup the view for the layer area (same as gl::View::apply)
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(0.0f, width, 0.0f, height, -1.0f, 1.0f);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+	if (gl::accuracyTweak())
+		glTranslatef(0.375f, 0.375f, 0);
+	glTranslated(width * 0.5, height * 0.5, 0);
+	glScaled(scale, scale, 1);
+	glTranslated(-offset.x, -offset.y, 0);
+
+	// Update visibility for the whole layer area
+	updateVisibility(layer_area_.min, layer_area_.max);
+
+	return true;
+}
 
-		// Ignore if outside of screen
-		if (x + radius < view_tl.x || x - radius > view_br.x || y + radius < view_tl.y || y - radius > view_br.y)
-			vis_t_[a] = 1;
+// -----------------------------------------------------------------------------
+// Finishes rendering the static map layer, and draws the cached layer (if it
+// is being used) to line up with [view]
+// -----------------------------------------------------------------------------
+void MapRenderer2D::endStaticLayer(const gl::View& view)
+{
+	if (layer_drawing_)
+	{
+		gl::FrameBuffer::unbind();
+		layer_drawing_ = false;
 
-		// Check if the thing is worth drawing
-		else if (radius * view_scale_ < 2)
-			vis_t_[a] = VIS_SMALL;
+		// Don't keep the layer if anything was only partially drawn
+		if (layer_incomplete_)
+			layer_updated_ = -1;
 	}
+
+	if (!layer_active_)
+		return;
+
+	// Draw the layer in screen coordinates, offset to the current view (snapped
+	// to whole pixels)
+	auto   size   = view.size();
+	auto   offset = view.offset(true);
+	double scale  = view.scale(true);
+	double x1     = std::round(size.x * 0.5 + (layer_area_.min.x - offset.x) * scale);
+	double y1     = std::round(size.y * 0.5 + (layer_area_.min.y - offset.y) * scale);
+	double x2     = x1 + layer_buffer_.width();
+	double y2     = y1 + layer_buffer_.height();
+
+	glViewport(0, 0, size.x, size.y);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(0.0f, size.x, 0.0f, size.y, -1.0f, 1.0f);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+
+	// The layer is opaque (includes the background), so just copy it
+	glBlendFunc(GL_ONE, GL_ZERO);
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+	glEnable(GL_TEXTURE_2D);
+	gl::Texture::bind(layer_buffer_.texture());
+	glBegin(GL_QUADS);
+	glTexCoord2f(0.0f, 0.0f);
+	glVertex2d(x1, y1);
+	glTexCoord2f(0.0f, 1.0f);
+	glVertex2d(x1, y2);
+	glTexCoord2f(1.0f, 1.0f);
+	glVertex2d(x2, y2);
+	glTexCoord2f(1.0f, 0.0f);
+	glVertex2d(x2, y1);
+	glEnd();
+	glDisable(GL_TEXTURE_2D);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// Restore the view
+	view.apply();
 }
 
 // -----------------------------------------------------------------------------
@@ -3220,6 +3599,8 @@ void MapRenderer2D::forceUpdate(float line_alpha)
 	tex_flats_.clear();
 	thing_sprites_.clear();
 	thing_paths_.clear();
+	visible_.updated = -1;
+	layer_updated_   = -1;
 
 	if (gl::vboSupport())
 	{
@@ -3263,5 +3644,5 @@ double MapRenderer2D::scaledRadius(int radius) const
 // -----------------------------------------------------------------------------
 bool MapRenderer2D::visOK() const
 {
-	return !(map_->nSectors() != vis_s_.size() || map_->nThings() != vis_t_.size());
+	return map_->nSectors() == vis_s_.size();
 }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "MapEditor/MapEditor.h"
+#include "OpenGL/FrameBuffer.h"
+#include "OpenGL/Shader.h"
+#include "OpenGL/VertexBuffer2D.h"
 #include "SLADEMap/MapObject/MapObject.h"
 #include "Utility/Colour.h"
 
@@ -11,12 +14,17 @@ class ItemSelection;
 class MapLine;
 class MapSector;
 class MapThing;
+class MapVertex;
 class ObjectEditGroup;
 class SLADEMap;
 namespace game
 {
 	class ThingType;
 }
+namespace gl
+{
+	class View;
+}
 
 class MapRenderer2D
 {
@@ -29,7 +37,7 @@ public:
 	// Vertices
 	bool setupVertexRendering(float size_scale, bool overlay = false) const;
 	void renderVertices(float alpha = 1.0f);
-	void renderVerticesVBO();
+	void renderVerticesVBO(const gl::Shader* shader = nullptr);
 	void renderVerticesImmediate();
 	void renderVertexHilight(int index, float fade) const;
 	void renderVertexSelection(const ItemSelection& selection, float fade = 1.0f) const;
@@ -43,6 +51,7 @@ public:
 	void    renderLineSelection(const ItemSelection& selection, float fade = 1.0f) const;
 	void    renderTaggedLines(const vector<MapLine*>& lines, float fade) const;
 	void    renderTaggingLines(const vector<MapLine*>& lines, float fade) const;
+	void    renderProblemMarkers(const vector<MapObject*>& objects) const;
 
 	// Things
 	enum ThingDrawType
@@ -53,8 +62,8 @@ public:
 		SquareSprite,
 		FramedSprite,
 	};
-	bool setupThingOverlay() const;
-	void renderThingOverlay(double x, double y, double radius, bool point) const;
+	unsigned thingOverlayTexture() const;
+	void     renderThingOverlay(unsigned tex, double x, double y, double radius, const ColRGBA& colour) const;
 	void renderRoundThing(
 		double                   x,
 		double                   y,
@@ -95,7 +104,7 @@ public:
 	void renderTaggedThings(const vector<MapThing*>& things, float fade) const;
 	void renderTaggingThings(const vector<MapThing*>& things, float fade) const;
 	void renderPathedThings(const vector<MapThing*>& things);
-	void renderPointLightPreviews(float alpha, int hilight_index) const;
+	void renderPointLightPreviews(float alpha, int hilight_index);
 
 	// Flats (sectors)
 	void renderFlats(int type = 0, bool texture = true, float alpha = 1.0f);
@@ -117,9 +126,30 @@ public:
 	// Object Edit
 	void renderObjectEditGroup(ObjectEditGroup* group);
 
+	// Static layer
+	struct LayerState
+	{
+		int    edit_mode     = -1;
+		int    sector_mode   = -1;
+		int    mouse_state   = -1;
+		int    flat_type     = 0;
+		double grid_size     = 0.;
+		int    hilight       = -1;
+		float  fade_flats    = 1.f;
+		float  fade_lines    = 1.f;
+		float  fade_vertices = 1.f;
+		float  fade_things   = 1.f;
+
+		bool operator==(const LayerState& other) const;
+	};
+	bool        beginStaticLayer(const gl::View& view, const LayerState& state);
+	void        endStaticLayer(const gl::View& view);
+	const BBox& staticLayerArea() const { return layer_area_; }
+
 	// VBOs
 	void updateVerticesVBO();
 	void updateLinesVBO(bool show_direction, float base_alpha);
+	void updateLinesVBO(const vector<MapLine*>& lines);
 	void updateFlatsVBO();
 
 	// Misc
@@ -132,7 +162,11 @@ public:
 	void   forceUpdate(float line_alpha = 1.0f);
 	double scaledRadius(int radius) const;
 	bool   visOK() const;
-	void   clearTextureCache() { tex_flats_.clear(); }
+	void   clearTextureCache()
+	{
+		tex_flats_.clear();
+		layer_updated_ = -1;
+	}
 
 private:
 	SLADEMap* map_              = nullptr;
@@ -141,15 +175,68 @@ private:
 	long      flats_updated_    = 0;
 
 	// VBOs etc
-	unsigned         vbo_vertices_ = 0;
-	unsigned         vbo_lines_    = 0;
-	unsigned         vbo_flats_    = 0;
-	vector<unsigned> sector_vbo_offsets_;
+	unsigned vbo_vertices_ = 0;
+	unsigned vbo_lines_    = 0;
+	unsigned vbo_flats_    = 0;
+
+	// The area of the flats VBO used by a sector's polygon
+	struct SectorVBOSlot
+	{
+		MapSector* sector;
+		unsigned   offset;
+		unsigned   size;
+	};
+	vector<SectorVBOSlot> sector_vbo_slots_;
+
+	// Static layer (flats, grid and map objects), cached in an offscreen buffer
+	// larger than the view so it can be reused while panning. It is only
+	// re-rendered when the map, view scale or layer state changes
+	gl::FrameBuffer layer_buffer_;
+	LayerState      layer_state_;
+	BBox            layer_area_;
+	double          layer_scale_      = 0.;
+	long            layer_updated_    = -1;
+	unsigned        layer_objects_    = 0;
+	bool            layer_active_     = false;
+	bool            layer_drawing_    = false;
+	bool            layer_incomplete_ = false;
 
 	// Display lists
 	unsigned list_vertices_ = 0;
 	unsigned list_lines_    = 0;
 
+	// Shader programs (GL 3.3 path) and the batch used for dynamic overlays
+	enum class ShaderType
+	{
+		Lines,
+		Points,
+		Flats,
+		Things,
+		Lights,
+	};
+	mutable std::unique_ptr<gl::Shader> shaders_[5];
+	mutable gl::VertexBuffer2D          overlay_buffer_;
+
+	const gl::Shader* bindShader(ShaderType type) const;
+	const gl::Shader* bindPointShader(bool point) const;
+	void              drawOverlayBuffer(unsigned primitive) const;
+	void              renderOverlayPoints(bool point) const;
+
+	// Things are added to per-texture batches and drawn with a call per texture
+	struct ThingInstance
+	{
+		MapThing* thing;
+		double    x, y;
+		unsigned  index;
+		float     alpha;
+	};
+	mutable std::map<unsigned, gl::VertexBuffer2D> thing_batches_;
+	vector<ThingInstance>                          thing_instances_;
+
+	gl::VertexBuffer2D& thingBatch(unsigned tex) const;
+	void                flushThingBatches() const;
+	void renderThingInstances(const vector<ThingInstance>& things, vector<const ThingInstance*>* arrows = nullptr);
+
 	// Visibility
 	enum
 	{
@@ -159,10 +246,58 @@ private:
 		VIS_BELOW = 8,
 		VIS_SMALL = 16,
 	};
-	vector<uint8_t> vis_v_;
-	vector<uint8_t> vis_l_;
-	vector<uint8_t> vis_t_;
 	vector<uint8_t> vis_s_;
+	Vec2d           view_tl_;
+	Vec2d           view_br_;
+
+	// Vertices, lines and things possibly visible in the current view, queried
+	// from the map's spatial index. The query covers an area padded around the
+	// view so the lists can be kept while panning within it, until the map is
+	// modified. Consecutive vertex/line indices are merged into runs
+	// ([first, count]) so only the visible parts of the VBOs are drawn
+	struct VisibleObjects
+	{
+		BBox               area;
+		long               updated    = -1;
+		unsigned           n_vertices = 0;
+		unsigned           n_lines    = 0;
+		unsigned           n_things   = 0;
+		vector<MapVertex*> vertices;
+		vector<MapLine*>   lines;
+		vector<MapThing*>  things;
+		vector<int>        vertex_first, vertex_count;
+		vector<int>        line_first, line_count;
+	};
+	VisibleObjects visible_;
+
+	void updateVisibleObjects();
+
+	// Point lights possibly visible in the current view (for light previews),
+	// queried from the map's spatial index the same way as VisibleObjects,
+	// but with the query extended by the largest light radius in the map.
+	// With shaders, each light is an instance of a single quad and the
+	// instance data is only uploaded when the list changes
+	struct LightInstance
+	{
+		float x, y, radius;
+		float r, g, b;
+	};
+	struct VisibleLights
+	{
+		BBox                  area;
+		long                  updated       = -1;
+		unsigned              n_things      = 0;
+		unsigned              types_version = 0;
+		double                max_radius    = 0.;
+		bool                  uploaded      = false; // Instance data is in vbo_light_instances_
+		vector<LightInstance> instances;
+		vector<MapThing*>     things; // The thing for each instance
+	};
+	VisibleLights visible_lights_;
+	unsigned      vbo_light_quad_      = 0;
+	unsigned      vbo_light_instances_ = 0;
+
+	void updateVisibleLights();
 
 	// Structs
 	struct GLVert
@@ -176,8 +311,14 @@ private:
 		GLVert dv1, dv2; // Direction tab
 	};
 
+	bool updateModifiedVerticesVBO();
+	bool updateModifiedLinesVBO(bool show_direction, float base_alpha);
+	void setLineVBOData(GLVert* verts, MapLine* line, bool show_direction, float base_alpha) const;
+	void renderMovingVertexLines(vector<MapVertex*> vertices, Vec2d move_vec) const;
+
 	// Other
 	bool     lines_dirs_     = false;
+	float    lines_alpha_    = 1.0f;
 	unsigned n_vertices_     = 0;
 	unsigned n_lines_        = 0;
 	unsigned n_things_       = 0;
@@ -41,6 +41,9 @@
 #include "MapEditor/MapEditContext.h"
 #include "MapEditor/MapTextureManager.h"
 #include "OpenGL/OpenGL.h"
+#include "OpenGL/Profiler.h"
+#include "OpenGL/Shader.h"
+#include "OpenGL/TextureArray.h"
 #include "SLADEMap/SLADEMap.h"
 #include "UI/Controls/PaletteChooser.h"
 #include "Utility/MathStuff.h"
@@ -73,6 +76,9 @@ CVAR(Bool, mlook_invert_y, false, CVar::Flag::Save)
 CVAR(Float, camera_3d_sensitivity_x, 1.0f, CVar::Flag::Save)
 CVAR(Float, camera_3d_sensitivity_y, 1.0f, CVar::Flag::Save)
 CVAR(Int, render_fov, 90, CVar::Flag::Save)
+CVAR(Bool, render_3d_portal_vis, true, CVar::Flag::Save)
+CVAR(Int, render_3d_update_ms, 15, CVar::Flag::Save)
+CVAR(Bool, render_3d_gpu_pick, true, CVar::Flag::Save)
 
 
 // -----------------------------------------------------------------------------
@@ -91,6 +97,86 @@ EXTERN_CVAR(Bool, use_zeth_icons)
 // -----------------------------------------------------------------------------
 namespace
 {
+// Near clipping plane distance of the 3d view
+constexpr float near_clip = 0.5f;
+
+// Minimum extra space (in bytes) to allocate at the end of the flats VBO, for
+// sectors whose polygon data grows (see updateSectorVBOs)
+constexpr unsigned flats_vbo_min_spare = 64 * 1024;
+
+// GLSL sources for the GL 3.3 rendering path.
+// Lighting is applied to the vertex colour beforehand, fog is calculated per
+// fragment from the fog colour (rgb) and depth (a) given per-vertex for walls,
+// or per-flat for flats. Walls with a texture array layer (texcoord z >= 0)
+// are sampled from tex_array instead of tex
+const char* shader_vert_walls = R"(#version 330 core
+in vec3 in_position;
+in vec4 in_colour;
+in vec3 in_texcoord;
+in vec4 in_fog;
+uniform mat4 mvp;
+out vec4 colour;
+out vec3 texcoord;
+out vec4 fog;
+out vec3 position;
+void main()
+{
+	colour      = in_colour;
+	texcoord    = in_texcoord;
+	fog         = in_fog;
+	position    = in_position;
+	gl_Position = mvp * vec4(in_position, 1.0);
+}
+)";
+
+const char* shader_vert_flats = R"(#version 330 core
+in vec3 in_position;
+in vec2 in_texcoord;
+uniform mat4 mvp;
+uniform vec4 flat_colour;
+uniform vec4 flat_fog;
+out vec4 colour;
+out vec3 texcoord;
+out vec4 fog;
+out vec3 position;
+void main()
+{
+	colour      = flat_colour;
+	texcoord    = vec3(in_texcoord, -1.0);
+	fog         = flat_fog;
+	position    = in_position;
+	gl_Position = mvp * vec4(in_position, 1.0);
+}
+)";
+
+const char* shader_frag_map3d = R"(#version 330 core
+in vec4 colour;
+in vec3 texcoord;
+in vec4 fog;
+in vec3 position;
+uniform sampler2D tex;
+uniform sampler2DArray tex_array;
+uniform vec3 camera;
+uniform int fog_enabled;
+uniform float alpha_ref;
+out vec4 frag_colour;
+void main()
+{
+	vec4 texel = texcoord.z >= 0.0 ? texture(tex_array, texcoord) : texture(tex, texcoord.xy);
+	vec4 col   = texel * colour;
+	if (col.a <= alpha_ref)
+		discard;
+
+	if (fog_enabled != 0)
+	{
+		float depth = max(fog.a, 0.001);
+		col.rgb     = mix(fog.rgb, col.rgb, clamp((depth - distance(position, camera)) / depth, 0.0, 1.0));
+	}
+
+	frag_colour = col;
+}
+)";
+
 // -----------------------------------------------------------------------------
 // (Helper for updateLine) Fetches the per-wall-section offset and scale and
 // adjusts the existing offsets to match.
@@ -116,6 +202,189 @@ void applyZDoomPerSectionOffsets(
 	*xoff *= *sx;
 	*yoff *= *sy;
 }
+
+// -----------------------------------------------------------------------------
+// (Helper for floodSectorVisibility) Returns true if there is any vertical
+// opening between the front and back sectors of two-sided [line]
+// -----------------------------------------------------------------------------
+bool lineOpen(const MapLine* line)
+{
+	auto front = line->frontSector();
+	auto back  = line->backSector();
+	for (const auto& point : { line->start(), line->end() })
+	{
+		auto top    = std::min(front->ceiling().plane.heightAt(point), back->ceiling().plane.heightAt(point));
+		auto bottom = std::max(front->floor().plane.heightAt(point), back->floor().plane.heightAt(point));
+		if (top > bottom)
+			return true;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// (Helper for floodSectorVisibility) Clips the view angle range [min]-[max] to
+// the range covered by a line with endpoints at view angles [a1] and [a2].
+// Returns false if the ranges don't overlap
+// -----------------------------------------------------------------------------
+bool clipViewRange(double& min, double& max, double a1, double a2)
+{
+	auto lo = std::min(a1, a2);
+	auto hi = std::max(a1, a2);
+	if (hi - lo <= math::PI)
+	{
+		if (std::max(min, lo) > std::min(max, hi))
+			return false;
+
+		min = std::max(min, lo);
+		max = std::min(max, hi);
+		return true;
+	}
+
+	// Line range wraps around behind the camera ([hi,PI] and [-PI,lo]),
+	// clip to whichever parts of it overlap
+	bool upper = hi <= max;
+	bool lower = lo >= min;
+	if (!upper && !lower)
+		return false;
+
+	auto new_min = lower ? min : std::max(min, hi);
+	auto new_max = upper ? max : std::min(max, lo);
+	min          = new_min;
+	max          = new_max;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// (Helper for updateLine) Returns true if any of [quads] are using the
+// placeholder texture for a texture that is still being loaded
+// -----------------------------------------------------------------------------
+bool anyTexturePending(const vector<MapRenderer3D::Quad>& quads)
+{
+	auto placeholder = mapeditor::textureManager().placeholder().gl_id;
+	for (const auto& quad : quads)
+		if (quad.texture == placeholder)
+			return true;
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// (Helper for updateLine) Sets [quad] to use map texture [tex]
+// -----------------------------------------------------------------------------
+void setQuadTexture(MapRenderer3D::Quad& quad, const MapTextureManager::Texture& tex)
+{
+	quad.texture   = tex.gl_id;
+	quad.tex_array = tex.layer.array;
+	quad.tex_layer = tex.layer.index;
+}
+
+// -----------------------------------------------------------------------------
+// (Helper for determineHilight) Returns the item for [quad] on [line]
+// -----------------------------------------------------------------------------
+mapeditor::Item quadItem(const MapLine* line, const MapRenderer3D::Quad& quad)
+{
+	using Q = MapRenderer3D;
+	mapeditor::Item item;
+
+	// Side index
+	if (quad.flags & Q::BACK)
+		item.index = line->s2Index();
+	else
+		item.index = line->s1Index();
+
+	// Side part
+	if (quad.control_side >= 0)
+	{
+		item.type         = mapeditor::ItemType::WallMiddle;
+		item.real_index   = item.index;
+		item.control_line = quad.control_line;
+		item.index        = quad.control_side;
+	}
+	else if (quad.flags & Q::UPPER)
+		item.type = mapeditor::ItemType::WallTop;
+	else if (quad.flags & Q::LOWER)
+		item.type = mapeditor::ItemType::WallBottom;
+	else
+		item.type = mapeditor::ItemType::WallMiddle;
+
+	return item;
+}
+
+// -----------------------------------------------------------------------------
+// (Helper for determineHilight) Returns the item for [flat] in sector [index]
+// -----------------------------------------------------------------------------
+mapeditor::Item flatItem(unsigned index, const MapRenderer3D::Flat& flat)
+{
+	mapeditor::Item item{ static_cast<int>(index),
+						  (flat.flags & MapRenderer3D::CEIL) ? mapeditor::ItemType::Ceiling :
+															   mapeditor::ItemType::Floor };
+	if (flat.extra_floor_index >= 0)
+	{
+		item.index      = flat.control_sector->index();
+		item.real_index = index;
+	}
+
+	return item;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the fog depth to use for an object with [fogcol] and [light] level
+// -----------------------------------------------------------------------------
+float fogDepth(const ColRGBA& fogcol, uint8_t light)
+{
+	// Check if fog colour is default
+	if (!render_fog_new_formula || (fogcol.r == 0 && fogcol.g == 0 && fogcol.b == 0))
+	{
+		float lm = light / 170.0f;
+		return lm * lm * 3000.0f;
+	}
+
+	return render_fog_distance;
+}
+
+// -----------------------------------------------------------------------------
+// (Helper for renderWalls) Returns all properties of [quad] that require GL
+// state changes to render, for sorting and batching quads. Fog is only
+// included if [fog] is true. If [arrays] is true, quads with a texture array
+// layer are keyed by their array texture, so quads with different textures
+// in the same array are batched together
+// -----------------------------------------------------------------------------
+auto quadRenderState(const MapRenderer3D::Quad* quad, bool fog, bool arrays)
+{
+	using Q       = MapRenderer3D;
+	uint8_t flags = quad->flags & (Q::SKY | Q::MIDTEX | Q::DRAWBOTH | Q::TRANSADD);
+	return std::make_tuple(
+		arrays && quad->tex_array ? quad->tex_array : quad->texture,
+		flags,
+		(flags & Q::MIDTEX) ? quad->alpha : 1.f,
+		fog ? quad->fogcolour.r : 0,
+		fog ? quad->fogcolour.g : 0,
+		fog ? quad->fogcolour.b : 0,
+		fog ? fogDepth(quad->fogcolour, quad->light) : 0.f);
+}
+
+// -----------------------------------------------------------------------------
+// (Helper for renderFlats) Returns all properties of [flat] that require GL
+// state changes to render, for sorting and batching flats. Fog is only
+// included if [fog] is true
+// -----------------------------------------------------------------------------
+auto flatRenderState(const MapRenderer3D::Flat* flat, bool fog)
+{
+	using Q = MapRenderer3D;
+	return std::make_tuple(
+		flat->texture,
+		static_cast<uint8_t>(flat->flags & (Q::SKY | Q::CEIL | Q::FLATFLIP | Q::DRAWBOTH | Q::TRANSADD)),
+		flat->light,
+		flat->colour.r,
+		flat->colour.g,
+		flat->colour.b,
+		flat->colour.a,
+		flat->alpha * flat->base_alpha,
+		fog ? flat->fogcolour.r : 0,
+		fog ? flat->fogcolour.g : 0,
+		fog ? flat->fogcolour.b : 0);
+}
 } // namespace
 
 
@@ -141,6 +410,22 @@ MapRenderer3D::MapRenderer3D(SLADEMap* map) : map_{ map }
 	sc_resources_updated_ = app::resources().signals().resources_updated.connect([this]() { refreshTextures(); });
 	sc_palette_changed_   = theMainWindow->paletteChooser()->signals().palette_changed.connect([this]()
                                                                                              { refreshTextures(); });
+
+	// Update any lines waiting on textures when they are loaded
+	sc_textures_loaded_ = mapeditor::textureManager().signals().textures_loaded.connect(
+		[this]()
+		{
+			for (auto& line : lines_)
+				if (line.texture_pending)
+				{
+					line.updated_time    = 0;
+					line.texture_pending = false;
+				}
+		});
+
+	// Update any lines and flats using textures unloaded to free memory
+	sc_textures_unloaded_ = mapeditor::textureManager().signals().textures_unloaded.connect(
+		[this](const vector<unsigned>& textures) { texturesUnloaded(textures); });
 }
 
 // -----------------------------------------------------------------------------
@@ -152,6 +437,15 @@ MapRenderer3D::~MapRenderer3D()
 		glDeleteBuffers(1, &vbo_flats_);
 	if (vbo_walls_ > 0)
 		glDeleteBuffers(1, &vbo_walls_);
+	if (vbo_sky_ > 0)
+		glDeleteBuffers(1, &vbo_sky_);
+	if (pick_fbo_ > 0)
+	{
+		glDeleteFramebuffers(1, &pick_fbo_);
+		glDeleteRenderbuffers(1, &pick_rb_colour_);
+		glDeleteRenderbuffers(1, &pick_rb_depth_);
+		glDeleteBuffers(1, &pick_pbo_);
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -187,6 +481,10 @@ void MapRenderer3D::refresh()
 		glDeleteBuffers(1, &vbo_flats_);
 		vbo_flats_ = 0;
 	}
+	vbo_flats_sectors_.clear();
+	vbo_flats_free_.clear();
+	vbo_flats_size_ = 0;
+	vbo_flats_end_  = 0;
 
 	sector_flats_.clear();
 
@@ -195,6 +493,7 @@ void MapRenderer3D::refresh()
 	skytex1_      = minf.sky1;
 	skytex2_      = minf.sky2;
 	skycol_top_.a = 0;
+	sky_texture_  = 0;
 }
 
 // -----------------------------------------------------------------------------
@@ -206,7 +505,10 @@ void MapRenderer3D::refreshTextures()
 	for (auto& line : lines_)
 	{
 		for (auto& quad : line.quads)
-			quad.texture = 0;
+		{
+			quad.texture   = 0;
+			quad.tex_array = 0;
+		}
 
 		line.updated_time = 0;
 	}
@@ -227,6 +529,31 @@ void MapRenderer3D::refreshTextures()
 		thing.sprite       = 0;
 		thing.updated_time = 0;
 	}
+	// Refresh sky
+	sky_texture_ = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Marks any lines and flats using any of the gl [textures] (which have been
+// unloaded) as needing an update, so the textures are reloaded when next
+// visible
+// -----------------------------------------------------------------------------
+void MapRenderer3D::texturesUnloaded(const vector<unsigned>& textures)
+{
+	std::unordered_set<unsigned> unloaded(textures.begin(), textures.end());
+
+	for (auto& line : lines_)
+		for (auto& quad : line.quads)
+			if (unloaded.count(quad.texture))
+			{
+				line.updated_time = 0;
+				break;
+			}
+
+	for (auto& sector : sector_flats_)
+		for (auto& flat : sector)
+			if (unloaded.count(flat.texture))
+				flat.updated_time = 0;
 }
 
 // -----------------------------------------------------------------------------
@@ -237,6 +564,7 @@ void MapRenderer3D::clearData()
 	// Clear map structures
 	lines_.clear();
 	things_.clear();
+	things_drawn_.clear();
 	sector_flats_.clear();
 
 	// Clear everything else
@@ -514,10 +842,11 @@ void MapRenderer3D::cameraLook(double xrel, double yrel)
 // -----------------------------------------------------------------------------
 // Sets up the OpenGL view/projection for rendering
 // -----------------------------------------------------------------------------
-void MapRenderer3D::setupView(int width, int height) const
+void MapRenderer3D::setupView(int width, int height)
 {
 	// Calculate aspect ratio
 	float aspect = (1.6f / 1.333333f) * ((float)width / (float)height);
+	view_aspect_ = aspect;
 	float fovy   = 2 * math::radToDeg(atan(tan(math::degToRad(render_fov) / 2) / aspect));
 
 	// Setup projection
@@ -527,7 +856,8 @@ void MapRenderer3D::setupView(int width, int height) const
 	float max = render_max_dist * 1.5f;
 	if (max < 100)
 		max = 20000;
-	gluPerspective(fovy, aspect, 0.5f, max);
+	gluPerspective(fovy, aspect, near_clip, max);
+	view_far_ = max;
 
 	glMatrixMode(GL_MODELVIEW);
 	glLoadIdentity();
@@ -553,6 +883,17 @@ void MapRenderer3D::setupView(int width, int height) const
 // level
 // -----------------------------------------------------------------------------
 void MapRenderer3D::setLight(const ColRGBA& colour, uint8_t light, float alpha) const
+{
+	float rgba[4];
+	lightColour(colour, light, alpha, rgba);
+	glColor4fv(rgba);
+}
+
+// -----------------------------------------------------------------------------
+// Calculates the colour to render an object with using [colour] and [light]
+// level, and writes it to [rgba]
+// -----------------------------------------------------------------------------
+void MapRenderer3D::lightColour(const ColRGBA& colour, uint8_t light, float alpha, float* rgba) const
 {
 	// Force 255 light in fullbright mode
 	if (fullbright_)
@@ -566,7 +907,10 @@ void MapRenderer3D::setLight(const ColRGBA& colour, uint8_t light, float alpha)
 	// closer resemble the software renderer light level
 	float mult = (float)light / 255.0f;
 	mult *= (mult * 1.3f);
-	glColor4f(colour.fr() * mult, colour.fg() * mult, colour.fb() * mult, colour.fa() * alpha);
+	rgba[0] = colour.fr() * mult;
+	rgba[1] = colour.fg() * mult;
+	rgba[2] = colour.fb() * mult;
+	rgba[3] = colour.fa() * alpha;
 }
 
 // -----------------------------------------------------------------------------
@@ -587,17 +931,7 @@ void MapRenderer3D::setFog(const ColRGBA& fogcol, uint8_t light)
 
 
 	// Setup fog depth
-	float depth;
-
-	// check if fog color is default
-	if (!render_fog_new_formula || (fogColor[0] == 0 && fogColor[1] == 0 && fogColor[2] == 0))
-	{
-		float lm = light / 170.0f;
-		depth    = (lm * lm * 3000.0f);
-	}
-	else
-		depth = render_fog_distance;
-
+	float depth = fogDepth(fogcol, light);
 	if (fog_depth_last_ != depth)
 	{
 		glFogf(GL_FOG_END, depth);
@@ -605,6 +939,46 @@ void MapRenderer3D::setFog(const ColRGBA& fogcol, uint8_t light)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Binds the shader program for [type], loading it first if needed, and sets
+// its view transformation from the current GL matrices.
+// Returns nullptr (and leaves fixed-function rendering active) if shaders are
+// unsupported/disabled or the program failed to load
+// -----------------------------------------------------------------------------
+const gl::Shader* MapRenderer3D::bindShader(ShaderType type)
+{
+	if (!gl::shaderSupport())
+		return nullptr;
+
+	auto& shader = shaders_[static_cast<int>(type)];
+	if (!shader)
+	{
+		switch (type)
+		{
+		case ShaderType::Walls:
+			shader = std::make_unique<gl::Shader>("map3d_walls");
+			shader->load(shader_vert_walls, shader_frag_map3d);
+			break;
+		case ShaderType::Flats:
+			shader = std::make_unique<gl::Shader>("map3d_flats");
+			shader->load(shader_vert_flats, shader_frag_map3d);
+			break;
+		}
+	}
+
+	// Don't keep retrying a program that failed to compile
+	if (!shader->isValid())
+		return nullptr;
+
+	shader->bind();
+	shader->setFixedFunctionMVP();
+	shader->setUniform("tex", 0);
+	shader->setUniform("tex_array", 1);
+	shader->setUniform("camera", cam_position_.x, cam_position_.y, cam_position_.z);
+	shader->setUniform("fog_enabled", fog_ ? 1 : 0);
+	return shader.get();
+}
+
 // -----------------------------------------------------------------------------
 // Renders the map in 3d
 // -----------------------------------------------------------------------------
@@ -620,7 +994,15 @@ void MapRenderer3D::renderMap()
 
 	// Create flats array if needed
 	if (sector_flats_.size() != map_->nSectors())
+	{
+		// Free the flats VBO ranges of any removed sectors
+		for (auto a = map_->nSectors(); a < vbo_flats_sectors_.size(); a++)
+			freeFlatsVBORange(vbo_flats_sectors_[a].offset, vbo_flats_sectors_[a].size);
+		if (vbo_flats_sectors_.size() > map_->nSectors())
+			vbo_flats_sectors_.resize(map_->nSectors());
+
 		sector_flats_.resize(map_->nSectors());
+	}
 
 	// Create lines array if empty
 	if (lines_.size() != map_->nLines())
@@ -633,17 +1015,20 @@ void MapRenderer3D::renderMap()
 	// Init VBO stuff
 	if (gl::vboSupport())
 	{
-		// Check if any polygon vertex data has changed (in this case we need to refresh the entire vbo)
+		// Check if any polygon vertex data has changed. Sectors whose flats
+		// still fit in their existing area of the vbo are updated in place,
+		// otherwise the entire vbo is refreshed
 		bool vbo_updated = false;
-		for (unsigned a = 0; a < map_->nSectors(); a++)
+		for (unsigned a = 0; a < map_->nSectors() && !vbo_flats_rebuild_; a++)
 		{
 			auto poly = map_->sector(a)->polygon();
 			if (poly && poly->vboUpdate() > 1)
-			{
-				updateFlatsVBO();
-				vbo_updated = true;
-				break;
-			}
+				updateSectorVBOs(a);
+		}
+		if (vbo_flats_rebuild_)
+		{
+			updateFlatsVBO();
+			vbo_updated = true;
 		}
 
 		// Create VBO if necessary
@@ -654,13 +1039,23 @@ void MapRenderer3D::renderMap()
 		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	}
 
+	// Create any textures that have finished loading in the background (only a
+	// few per frame, to avoid hitches), and keep updating while any are left
+	updates_pending_ = mapeditor::textureManager().uploadComposed(4) > 0;
+
+	// Allow some time for any geometry updates this frame
+	update_deadline_ = app::runTimer() + render_3d_update_ms;
+
 	// Quick distance vis check
 	sf::Clock clock;
-	quickVisDiscard();
+	{
+		gl::profiler::Scope profile{ "3d: Visibility" };
+		quickVisDiscard();
 
-	// Build lists of quads and flats to render
-	checkVisibleFlats();
-	checkVisibleQuads();
+		// Build lists of quads and flats to render
+		checkVisibleFlats();
+		checkVisibleQuads();
+	}
 
 	// Render sky
 	if (render_3d_sky)
@@ -712,6 +1107,10 @@ void MapRenderer3D::renderMap()
 		}
 	}
 
+	// Render object ids under the crosshair for hilighting
+	if (pickingEnabled())
+		renderPickBuffer();
+
 	// Cleanup gl state
 	glDisable(GL_ALPHA_TEST);
 	glDisable(GL_DEPTH_TEST);
@@ -720,78 +1119,75 @@ void MapRenderer3D::renderMap()
 }
 
 // -----------------------------------------------------------------------------
-// Renders a cylindrical 'slice' of the sky between [top] and [bottom] on the z
-// axis
+// Adds a cylindrical 'slice' of the sky between [top] and [bottom] on the z
+// axis to the sky geometry
 // -----------------------------------------------------------------------------
-void MapRenderer3D::renderSkySlice(float top, float bottom, float atop, float abottom, float size, float tx, float ty)
-	const
+void MapRenderer3D::addSkySlice(float top, float bottom, float atop, float abottom, float size, float tx, float ty)
 {
 	float tc_x  = 0.0f;
 	float tc_y1 = (-top + 1.0f) * (ty * 0.5f);
 	float tc_y2 = (-bottom + 1.0f) * (ty * 0.5f);
 
-	glBegin(GL_QUADS);
-
-	// Go through circular points
-	for (unsigned a = 0; a < 31; a++)
+	// Go through circular points (linking the last point to the first)
+	for (unsigned a = 0; a < 32; a++)
 	{
+		auto& p1 = sky_circle_[a];
+		auto& p2 = sky_circle_[(a + 1) % 32];
+
 		// Top
-		glColor4f(1.0f, 1.0f, 1.0f, atop);
-		glTexCoord2f(tc_x + tx, tc_y1);
-		glVertex3f(
-			cam_position_.x + (sky_circle_[a + 1].x * size),
-			cam_position_.y - (sky_circle_[a + 1].y * size),
-			cam_position_.z + (top * size));
-		glTexCoord2f(tc_x, tc_y1);
-		glVertex3f(
-			cam_position_.x + (sky_circle_[a].x * size),
-			cam_position_.y - (sky_circle_[a].y * size),
-			cam_position_.z + (top * size));
+		sky_vertices_.push_back(
+			{ (float)p2.x * size, (float)-p2.y * size, top * size, tc_x + tx, tc_y1, 1, 1, 1, atop });
+		sky_vertices_.push_back({ (float)p1.x * size, (float)-p1.y * size, top * size, tc_x, tc_y1, 1, 1, 1, atop });
 
 		// Bottom
-		glColor4f(1.0f, 1.0f, 1.0f, abottom);
-		glTexCoord2f(tc_x, tc_y2);
-		glVertex3f(
-			cam_position_.x + (sky_circle_[a].x * size),
-			cam_position_.y - (sky_circle_[a].y * size),
-			cam_position_.z + (bottom * size));
-		glTexCoord2f(tc_x + tx, tc_y2);
-		glVertex3f(
-			cam_position_.x + (sky_circle_[a + 1].x * size),
-			cam_position_.y - (sky_circle_[a + 1].y * size),
-			cam_position_.z + (bottom * size));
+		sky_vertices_.push_back(
+			{ (float)p1.x * size, (float)-p1.y * size, bottom * size, tc_x, tc_y2, 1, 1, 1, abottom });
+		sky_vertices_.push_back(
+			{ (float)p2.x * size, (float)-p2.y * size, bottom * size, tc_x + tx, tc_y2, 1, 1, 1, abottom });
 
 		tc_x += tx;
 	}
+}
+
+// -----------------------------------------------------------------------------
+// Builds the sky geometry (top/bottom caps and sides) for sky [texture], with
+// texture coordinate scale [tx],[ty], and uploads it to the sky VBO if VBOs
+// are supported. The geometry is relative to the camera, so it only needs to
+// be rebuilt when the sky texture changes
+// -----------------------------------------------------------------------------
+void MapRenderer3D::updateSkyVBO(unsigned texture, float tx, float ty)
+{
+	sky_vertices_.clear();
+
+	// Top/bottom caps
+	float size = 64.0f;
+	float cap  = size * 10;
+	for (auto [z, col] : { std::make_pair(size, skycol_top_), std::make_pair(-size, skycol_bottom_) })
+	{
+		float r = col.fr(), g = col.fg(), b = col.fb(), a = col.fa();
+		sky_vertices_.push_back({ -cap, -cap, z, 0, 0, r, g, b, a });
+		sky_vertices_.push_back({ -cap, cap, z, 0, 0, r, g, b, a });
+		sky_vertices_.push_back({ cap, cap, z, 0, 0, r, g, b, a });
+		sky_vertices_.push_back({ cap, -cap, z, 0, 0, r, g, b, a });
+	}
 
-	// Link last point -> first
-	// Top
-	glColor4f(1.0f, 1.0f, 1.0f, atop);
-	glTexCoord2f(tc_x + tx, tc_y1);
-	glVertex3f(
-		cam_position_.x + (sky_circle_[0].x * size),
-		cam_position_.y - (sky_circle_[0].y * size),
-		cam_position_.z + (top * size));
-	glTexCoord2f(tc_x, tc_y1);
-	glVertex3f(
-		cam_position_.x + (sky_circle_[31].x * size),
-		cam_position_.y - (sky_circle_[31].y * size),
-		cam_position_.z + (top * size));
-
-	// Bottom
-	glColor4f(1.0f, 1.0f, 1.0f, abottom);
-	glTexCoord2f(tc_x, tc_y2);
-	glVertex3f(
-		cam_position_.x + (sky_circle_[31].x * size),
-		cam_position_.y - (sky_circle_[31].y * size),
-		cam_position_.z + (bottom * size));
-	glTexCoord2f(tc_x + tx, tc_y2);
-	glVertex3f(
-		cam_position_.x + (sky_circle_[0].x * size),
-		cam_position_.y - (sky_circle_[0].y * size),
-		cam_position_.z + (bottom * size));
+	// Sides
+	addSkySlice(1.0f, 0.5f, 0.0f, 1.0f, size, tx, ty);   // Top
+	addSkySlice(0.5f, -0.5f, 1.0f, 1.0f, size, tx, ty);  // Middle
+	addSkySlice(-0.5f, -1.0f, 1.0f, 0.0f, size, tx, ty); // Bottom
 
-	glEnd();
+	// Upload to VBO
+	if (gl::vboSupport())
+	{
+		if (vbo_sky_ == 0)
+			glGenBuffers(1, &vbo_sky_);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_sky_);
+		glBufferData(
+			GL_ARRAY_BUFFER, sky_vertices_.size() * sizeof(SkyVertex), sky_vertices_.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	sky_texture_ = texture;
 }
 
 // -----------------------------------------------------------------------------
@@ -799,6 +1195,8 @@ void MapRenderer3D::renderSkySlice(float top, float bottom, float atop, float ab
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderSky()
 {
+	gl::profiler::Scope profile{ "3d: Sky" };
+
 	gl::setColour(ColRGBA::WHITE);
 	glDisable(GL_CULL_FACE);
 	glDisable(GL_FOG);
@@ -806,69 +1204,75 @@ void MapRenderer3D::renderSky()
 	glDepthMask(GL_FALSE);
 	glEnable(GL_TEXTURE_2D);
 
-	// Center skybox a bit below the camera view
-	glPushMatrix();
-	glTranslatef(0.0f, 0.0f, -10.0f);
-
 	// Get sky texture
-	unsigned sky;
-	if (!skytex2_.empty())
-		sky = mapeditor::textureManager().texture(skytex2_, false).gl_id;
-	else
-		sky = mapeditor::textureManager().texture(skytex1_, false).gl_id;
+	auto& sky_tex = mapeditor::textureManager().texture(skytex2_.empty() ? skytex1_ : skytex2_, false);
+	auto  sky     = sky_tex.gl_id;
 	if (sky)
 	{
-		// Bind texture
-		gl::Texture::bind(sky);
-
 		// Get average colour if needed
-		auto& tex_info = gl::Texture::info(sky);
 		if (skycol_top_.a == 0)
 		{
-			int theight    = tex_info.size.y * 0.4;
-			skycol_top_    = gl::Texture::averageColour(sky, { 0, 0, tex_info.size.x, theight });
-			skycol_bottom_ = gl::Texture::averageColour(
-				sky, { 0, tex_info.size.y - theight, tex_info.size.x, tex_info.size.y });
+			skycol_top_    = sky_tex.average_top;
+			skycol_bottom_ = sky_tex.average_bottom;
+			sky_texture_   = 0;
 		}
 
-		// Render top cap
-		float size = 64.0f;
-		glDisable(GL_TEXTURE_2D);
-		gl::setColour(skycol_top_);
-		glBegin(GL_QUADS);
-		glVertex3f(cam_position_.x - (size * 10), cam_position_.y - (size * 10), cam_position_.z + size);
-		glVertex3f(cam_position_.x - (size * 10), cam_position_.y + (size * 10), cam_position_.z + size);
-		glVertex3f(cam_position_.x + (size * 10), cam_position_.y + (size * 10), cam_position_.z + size);
-		glVertex3f(cam_position_.x + (size * 10), cam_position_.y - (size * 10), cam_position_.z + size);
-		glEnd();
+		// Rebuild sky geometry if the texture changed
+		if (sky != sky_texture_)
+		{
+			// Check for odd sky sizes
+			auto& tex_info = gl::Texture::info(sky);
+			float tx       = 0.125f;
+			float ty       = 2.0f;
+			if (tex_info.size.x > 256)
+				tx = 0.125f / ((float)tex_info.size.x / 256.0f);
+			if (tex_info.size.y > 128)
+				ty = 1.0f;
+
+			updateSkyVBO(sky, tx, ty);
+		}
 
-		// Render bottom cap
-		gl::setColour(skycol_bottom_);
-		glBegin(GL_QUADS);
-		glVertex3f(cam_position_.x - (size * 10), cam_position_.y - (size * 10), cam_position_.z - size);
-		glVertex3f(cam_position_.x - (size * 10), cam_position_.y + (size * 10), cam_position_.z - size);
-		glVertex3f(cam_position_.x + (size * 10), cam_position_.y + (size * 10), cam_position_.z - size);
-		glVertex3f(cam_position_.x + (size * 10), cam_position_.y - (size * 10), cam_position_.z - size);
-		glEnd();
+		// Setup vertex arrays
+		auto stride = sizeof(SkyVertex);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		if (vbo_sky_)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, vbo_sky_);
+			glVertexPointer(3, GL_FLOAT, stride, nullptr);
+			glTexCoordPointer(2, GL_FLOAT, stride, (char*)nullptr + offsetof(SkyVertex, tx));
+			glColorPointer(4, GL_FLOAT, stride, (char*)nullptr + offsetof(SkyVertex, r));
+		}
+		else
+		{
+			glVertexPointer(3, GL_FLOAT, stride, &sky_vertices_[0].x);
+			glTexCoordPointer(2, GL_FLOAT, stride, &sky_vertices_[0].tx);
+			glColorPointer(4, GL_FLOAT, stride, &sky_vertices_[0].r);
+		}
+
+		// Center skybox on the camera (a bit below the camera view)
+		glPushMatrix();
+		glTranslatef(cam_position_.x, cam_position_.y, cam_position_.z - 10.0f);
+
+		// Render top and bottom caps
+		glDisable(GL_TEXTURE_2D);
+		glDrawArrays(GL_QUADS, 0, 8);
 
 		// Render skybox sides
 		glDisable(GL_ALPHA_TEST);
 		glEnable(GL_TEXTURE_2D);
+		gl::Texture::bind(sky);
+		glDrawArrays(GL_QUADS, 8, sky_vertices_.size() - 8);
 
-		// Check for odd sky sizes
-		float tx = 0.125f;
-		float ty = 2.0f;
-		if (tex_info.size.x > 256)
-			tx = 0.125f / ((float)tex_info.size.x / 256.0f);
-		if (tex_info.size.y > 128)
-			ty = 1.0f;
-
-		renderSkySlice(1.0f, 0.5f, 0.0f, 1.0f, size, tx, ty);   // Top
-		renderSkySlice(0.5f, -0.5f, 1.0f, 1.0f, size, tx, ty);  // Middle
-		renderSkySlice(-0.5f, -1.0f, 1.0f, 0.0f, size, tx, ty); // Bottom
+		glPopMatrix();
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_COLOR_ARRAY);
+		if (vbo_sky_)
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
-	glPopMatrix();
 	glDepthMask(GL_TRUE);
 	glEnable(GL_CULL_FACE);
 	glEnable(GL_DEPTH_TEST);
@@ -1013,7 +1417,7 @@ void MapRenderer3D::updateSectorFlats(unsigned index)
 	floor_flat.flags             = 0;
 	floor_flat.plane             = sector->floor().plane;
 	floor_flat.base_alpha        = 1.0f;
-	if (strutil::equalCI(sector->floor().texture, game::configuration().skyFlat()))
+	if (sector->floor().texture_key == NameKey{ game::configuration().skyFlat() })
 		floor_flat.flags |= SKY;
 
 	// Update ceiling
@@ -1030,7 +1434,7 @@ void MapRenderer3D::updateSectorFlats(unsigned index)
 	ceiling_flat.flags             = CEIL;
 	ceiling_flat.plane             = sector->ceiling().plane;
 	ceiling_flat.base_alpha        = 1.0f;
-	if (strutil::equalCI(sector->ceiling().texture, game::configuration().skyFlat()))
+	if (sector->ceiling().texture_key == NameKey{ game::configuration().skyFlat() })
 		ceiling_flat.flags |= SKY;
 
 	// Deal with 3D floors
@@ -1110,28 +1514,59 @@ void MapRenderer3D::updateSectorFlats(unsigned index)
 }
 
 // -----------------------------------------------------------------------------
-// Updates VBOs for sector [index]
+// Updates VBOs for sector [index].
+// Only the sector's own area of the flats vbo is re-uploaded - if the sector's
+// polygon (or number of flats) has outgrown it, the entire vbo is flagged to be
+// rebuilt on the next render instead
 // -----------------------------------------------------------------------------
-void MapRenderer3D::updateSectorVBOs(unsigned index) const
+void MapRenderer3D::updateSectorVBOs(unsigned index)
 {
-	if (!gl::vboSupport())
+	if (!gl::vboSupport() || vbo_flats_ == 0 || vbo_flats_rebuild_)
 		return;
 
 	// Check index
-	if (index >= map_->nSectors())
+	if (index >= map_->nSectors() || index >= sector_flats_.size())
 		return;
 	MapSector* sector = map_->sector(index);
 	Polygon2D* poly   = sector->polygon();
 
-	// Update VBOs
+	// Nothing to write until the sector's flats are set up
+	auto& flats = sector_flats_[index];
+	if (flats.empty())
+		return;
+
+	// Move the sector's flats to another range of the VBO if they no longer
+	// fit in their current one
+	auto data_size = poly->vboDataSize();
+	auto size      = data_size * static_cast<unsigned>(flats.size());
+	if (vbo_flats_sectors_.size() < sector_flats_.size())
+		vbo_flats_sectors_.resize(sector_flats_.size());
+	auto& range = vbo_flats_sectors_[index];
+	if (size > range.size)
+	{
+		freeFlatsVBORange(range.offset, range.size);
+		range.size = 0;
+
+		// Rebuild the entire VBO if there's no space left
+		if (!allocFlatsVBORange(size, range.offset))
+		{
+			vbo_flats_rebuild_ = true;
+			return;
+		}
+		range.size = size;
+	}
+
+	// Update VBO
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
 	Polygon2D::setupVBOPointers();
 
-	for (unsigned a = 0; a < sector_flats_[index].size(); a++)
+	for (unsigned a = 0; a < flats.size(); a++)
 	{
+		flats[a].vbo_offset = range.offset + a * data_size;
+		flats[a].vbo_size   = data_size;
 		updateFlatTexCoords(index, a);
-		poly->setZ(sector_flats_[index][a].plane);
-		poly->writeToVBO(sector_flats_[index][a].vbo_offset);
+		poly->setZ(flats[a].plane);
+		poly->writeToVBO(flats[a].vbo_offset);
 	}
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -1152,14 +1587,12 @@ bool MapRenderer3D::isSectorStale(unsigned index) const
 }
 
 // -----------------------------------------------------------------------------
-// Renders [flat]
+// Sets up the GL state for rendering [flat]. If [shader] is given (it must
+// already be bound), the flat's colour and fog are passed to it instead of
+// being set up for fixed-function rendering
 // -----------------------------------------------------------------------------
-void MapRenderer3D::renderFlat(const Flat* flat)
+void MapRenderer3D::setupFlatRender(const Flat* flat, const gl::Shader* shader)
 {
-	// Skip if no sector (for whatever reason)
-	if (!flat->sector)
-		return;
-
 	// Setup special rendering options
 	float alpha = flat->alpha * flat->base_alpha;
 	if (flat->flags & SKY && render_3d_sky)
@@ -1172,70 +1605,86 @@ void MapRenderer3D::renderFlat(const Flat* flat)
 	else
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	// Setup colour/light
-	setLight(flat->colour, flat->light, alpha);
+	if (shader)
+	{
+		// Setup colour/light and fog
+		float rgba[4];
+		lightColour(flat->colour, flat->light, alpha, rgba);
+		shader->setUniform("flat_colour", rgba[0], rgba[1], rgba[2], rgba[3]);
+		shader->setUniform(
+			"flat_fog",
+			flat->fogcolour.fr(),
+			flat->fogcolour.fg(),
+			flat->fogcolour.fb(),
+			fogDepth(flat->fogcolour, flat->light));
+		shader->setUniform("alpha_ref", glIsEnabled(GL_ALPHA_TEST) ? 0.0f : -1.0f);
+	}
+	else
+	{
+		// Setup colour/light
+		setLight(flat->colour, flat->light, alpha);
 
-	// Setup fog colour
-	setFog(flat->fogcolour, flat->light);
+		// Setup fog colour
+		setFog(flat->fogcolour, flat->light);
+	}
+
+	// Setup for floor or ceiling
+	if (flat->flags & CEIL)
+	{
+		glCullFace((flat->flags & FLATFLIP) ? GL_FRONT : GL_BACK);
+		flat_last_ = 2;
+	}
+	else
+	{
+		glCullFace((flat->flags & FLATFLIP) ? GL_BACK : GL_FRONT);
+		flat_last_ = 1;
+	}
+
+	if (flat->flags & DRAWBOTH)
+		glDisable(GL_CULL_FACE);
+}
+
+// -----------------------------------------------------------------------------
+// Resets any GL state changed by setupFlatRender for [flat]
+// -----------------------------------------------------------------------------
+void MapRenderer3D::resetFlatRender(const Flat* flat)
+{
+	if (flat->flags & DRAWBOTH)
+		glEnable(GL_CULL_FACE);
+	if (flat->flags & SKY && render_3d_sky)
+		glEnable(GL_ALPHA_TEST);
+}
+
+// -----------------------------------------------------------------------------
+// Renders [flat]
+// -----------------------------------------------------------------------------
+void MapRenderer3D::renderFlat(const Flat* flat)
+{
+	// Skip if no sector (for whatever reason)
+	if (!flat->sector)
+		return;
+
+	setupFlatRender(flat);
 
 	// Render flat
 	if (gl::vboSupport() && flats_use_vbo)
 	{
-		// Setup for floor or ceiling
-		if (flat->flags & CEIL)
-		{
-			glCullFace((flat->flags & FLATFLIP) ? GL_FRONT : GL_BACK);
-			flat_last_ = 2;
-		}
-		else
-		{
-			glCullFace((flat->flags & FLATFLIP) ? GL_BACK : GL_FRONT);
-			flat_last_ = 1;
-		}
-
 		glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
 		Polygon2D::setupVBOPointers();
-
-		if (flat->flags & DRAWBOTH)
-			glDisable(GL_CULL_FACE);
-
-		// Render
 		flat->sector->polygon()->renderVBO(flat->vbo_offset);
-
-		if (flat->flags & DRAWBOTH)
-			glEnable(GL_CULL_FACE);
 	}
 	else
 	{
 		glPushMatrix();
-
-		// Setup for floor or ceiling
 		if (flat->flags & CEIL)
-		{
-			glCullFace((flat->flags & FLATFLIP) ? GL_FRONT : GL_BACK);
 			glTranslated(0, 0, flat->sector->ceiling().height);
-		}
 		else
-		{
-			glCullFace((flat->flags & FLATFLIP) ? GL_BACK : GL_FRONT);
 			glTranslated(0, 0, flat->sector->floor().height);
-		}
-
-		if (flat->flags & DRAWBOTH)
-			glDisable(GL_CULL_FACE);
-
-		// Render
 		flat->sector->polygon()->render();
-
-		if (flat->flags & DRAWBOTH)
-			glEnable(GL_CULL_FACE);
-
 		glPopMatrix();
 	}
 
-	// Reset settings
-	if (flat->flags & SKY && render_3d_sky)
-		glEnable(GL_ALPHA_TEST);
+	resetFlatRender(flat);
 }
 
 // -----------------------------------------------------------------------------
@@ -1243,65 +1692,111 @@ void MapRenderer3D::renderFlat(const Flat* flat)
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderFlats()
 {
+	gl::profiler::Scope profile{ "3d: Flats" };
+
 	// Check for map
 	if (!map_)
 		return;
 
 	// Init textures
 	glEnable(GL_TEXTURE_2D);
+	flat_last_ = 0;
 
-	// Render all visible opaque flats, ordered by texture
-	unsigned a        = 0;
-	unsigned tex_last = 0;
-	flat_last_        = 0;
-	while (n_flats_ > 0)
+	// Split off translucent flats to render last
+	vector<Flat*> flats_translucent;
+	unsigned      n_opaque = 0;
+	for (unsigned a = 0; a < n_flats_; a++)
 	{
-		a        = 0;
-		tex_last = 0;
-		while (a < n_flats_)
-		{
-			if (flats_[a])
-			{
-				// Skip different textures on this loop, and save all translucent
-				// flats for last
-				if ((tex_last && flats_[a]->texture != tex_last) || flats_[a]->base_alpha < 1.0f)
-				{
-					a++;
-					continue;
-				}
-
-				// Check texture
-				if (!tex_last)
-					tex_last = flats_[a]->texture;
-				if (tex_last)
-					gl::Texture::bind(flats_[a]->texture);
+		if (!flats_[a] || !flats_[a]->sector)
+			continue;
 
-				// Render flat
-				renderFlat(flats_[a]);
-			}
+		if (flats_[a]->base_alpha < 1.0f)
+			flats_translucent.push_back(flats_[a]);
+		else
+			flats_[n_opaque++] = flats_[a];
+	}
+	n_flats_ = 0;
 
-			flats_[a] = flats_[--n_flats_];
-		}
-		if (!tex_last)
-			break;
+	// Use shader program for lighting/fog if possible
+	bool use_vbo = gl::vboSupport() && flats_use_vbo;
+	auto shader  = use_vbo ? bindShader(ShaderType::Flats) : nullptr;
+
+	// Sort opaque flats by render state, so that all flats with the same
+	// texture, light, etc. can be rendered together
+	bool fog = fog_ && !shader;
+	std::sort(
+		flats_.begin(),
+		flats_.begin() + n_opaque,
+		[fog](const Flat* left, const Flat* right)
+		{ return flatRenderState(left, fog) < flatRenderState(right, fog); });
+
+	// Render opaque flats
+	if (use_vbo)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
+		if (shader)
+			Polygon2D::setupVBOAttribPointers();
+		else
+			Polygon2D::setupVBOPointers();
 	}
+	unsigned a = 0;
+	while (a < n_opaque)
+	{
+		// Get all following flats with the same render state
+		auto     state = flatRenderState(flats_[a], fog);
+		unsigned end   = a + 1;
+		while (end < n_opaque && flatRenderState(flats_[end], fog) == state)
+			end++;
+
+		gl::Texture::bind(flats_[a]->texture);
+		mapeditor::textureManager().markUsed(flats_[a]->texture);
+		if (use_vbo)
+		{
+			// Render all sub-polygons of all flats in a single call
+			batch_first_.clear();
+			batch_count_.clear();
+			for (unsigned b = a; b < end; b++)
+				flats_[b]->sector->polygon()->addVBORanges(flats_[b]->vbo_offset, batch_first_, batch_count_);
+
+			setupFlatRender(flats_[a], shader);
+			glMultiDrawArrays(GL_TRIANGLE_FAN, batch_first_.data(), batch_count_.data(), batch_first_.size());
+			resetFlatRender(flats_[a]);
+		}
+		else
+		{
+			for (unsigned b = a; b < end; b++)
+				renderFlat(flats_[b]);
+		}
 
-	// Render any remaining translucent flats, ordered by depth
-	// TODO order by depth?  how??  sector distance, then plane height?  (note
-	// that sloped and translucent is forbidden even in gzdoom)
-	for (unsigned b = 0; b < n_flats_; b++)
+		a = end;
+	}
+	if (shader)
 	{
-		if (!flats_[b])
-			continue;
+		Polygon2D::clearVBOAttribPointers();
+		gl::Shader::unbind();
+	}
 
-		if (tex_last != flats_[b]->texture)
+	// Render translucent flats, furthest from the camera first (by sector
+	// distance, then plane height)
+	auto cam = cam_position_;
+	std::sort(
+		flats_translucent.begin(),
+		flats_translucent.end(),
+		[this, &cam](const Flat* left, const Flat* right)
 		{
-			tex_last = flats_[b]->texture;
-			gl::Texture::bind(tex_last);
-		}
-		renderFlat(flats_[b]);
+			auto dist_left  = dist_sectors_[left->sector->index()];
+			auto dist_right = dist_sectors_[right->sector->index()];
+			if (dist_left != dist_right)
+				return dist_left > dist_right;
+
+			return fabs(cam.z - left->plane.heightAt(cam.get2d())) > fabs(cam.z - right->plane.heightAt(cam.get2d()));
+		});
+	for (auto flat : flats_translucent)
+	{
+		gl::Texture::bind(flat->texture, false);
+		mapeditor::textureManager().markUsed(flat->texture);
+		renderFlat(flat);
 	}
-	n_flats_ = 0;
 
 	// Reset gl stuff
 	glDisable(GL_TEXTURE_2D);
@@ -1568,8 +2063,8 @@ void MapRenderer3D::updateLine(unsigned index)
 		}
 
 		// Texture scale
-		auto& tex    = mapeditor::textureManager().texture(line->s1()->texMiddle(), mixed);
-		quad.texture = tex.gl_id;
+		auto& tex    = mapeditor::textureManager().texture(line->s1()->texMiddle(), mixed, true);
+		setQuadTexture(quad, tex);
 		sx           = tex.scale.x;
 		sy           = tex.scale.y;
 		if (game::configuration().featureSupported(UDMFFeature::TextureScaling))
@@ -1598,7 +2093,8 @@ void MapRenderer3D::updateLine(unsigned index)
 
 		// Add middle quad and finish
 		lines_[index].quads.push_back(quad);
-		lines_[index].updated_time = app::runTimer();
+		lines_[index].updated_time    = app::runTimer();
+		lines_[index].texture_pending = anyTexturePending(lines_[index].quads);
 		return;
 	}
 
@@ -1660,8 +2156,8 @@ void MapRenderer3D::updateLine(unsigned index)
 		}
 
 		// Texture scale
-		auto& tex    = mapeditor::textureManager().texture(line->s1()->texLower(), mixed);
-		quad.texture = tex.gl_id;
+		auto& tex    = mapeditor::textureManager().texture(line->s1()->texLower(), mixed, true);
+		setQuadTexture(quad, tex);
 		sx           = tex.scale.x;
 		sy           = tex.scale.y;
 		if (map_->currentFormat() == MapFormat::UDMF
@@ -1706,8 +2202,8 @@ void MapRenderer3D::updateLine(unsigned index)
 		Quad quad;
 
 		// Get texture
-		auto& tex    = mapeditor::textureManager().texture(line->s1()->texMiddle(), mixed);
-		quad.texture = tex.gl_id;
+		auto& tex    = mapeditor::textureManager().texture(line->s1()->texMiddle(), mixed, true);
+		setQuadTexture(quad, tex);
 
 		// Determine offsets
 		xoff        = xoff1;
@@ -1817,8 +2313,8 @@ void MapRenderer3D::updateLine(unsigned index)
 		}
 
 		// Texture scale
-		auto& tex    = mapeditor::textureManager().texture(line->s1()->texUpper(), mixed);
-		quad.texture = tex.gl_id;
+		auto& tex    = mapeditor::textureManager().texture(line->s1()->texUpper(), mixed, true);
+		setQuadTexture(quad, tex);
 		sx           = tex.scale.x;
 		sy           = tex.scale.y;
 		if (map_->currentFormat() == MapFormat::UDMF
@@ -1876,8 +2372,8 @@ void MapRenderer3D::updateLine(unsigned index)
 		}
 
 		// Texture scale
-		auto& tex    = mapeditor::textureManager().texture(line->s2()->texLower(), mixed);
-		quad.texture = tex.gl_id;
+		auto& tex    = mapeditor::textureManager().texture(line->s2()->texLower(), mixed, true);
+		setQuadTexture(quad, tex);
 		sx           = tex.scale.x;
 		sy           = tex.scale.y;
 		if (map_->currentFormat() == MapFormat::UDMF
@@ -1925,8 +2421,8 @@ void MapRenderer3D::updateLine(unsigned index)
 		Quad quad;
 
 		// Get texture
-		auto& tex    = mapeditor::textureManager().texture(midtex2, mixed);
-		quad.texture = tex.gl_id;
+		auto& tex    = mapeditor::textureManager().texture(midtex2, mixed, true);
+		setQuadTexture(quad, tex);
 
 		// Determine offsets
 		xoff        = xoff2;
@@ -2036,8 +2532,8 @@ void MapRenderer3D::updateLine(unsigned index)
 		}
 
 		// Texture scale
-		auto& tex    = mapeditor::textureManager().texture(line->s2()->texUpper(), mixed);
-		quad.texture = tex.gl_id;
+		auto& tex    = mapeditor::textureManager().texture(line->s2()->texUpper(), mixed, true);
+		setQuadTexture(quad, tex);
 		sx           = tex.scale.x;
 		sy           = tex.scale.y;
 		if (map_->currentFormat() == MapFormat::UDMF
@@ -2138,7 +2634,7 @@ void MapRenderer3D::updateLine(unsigned index)
 			quad.colour    = colour1.ampf(1.0f, 1.0f, 1.0f, extra.alpha);
 			quad.fogcolour = fogcolour1;
 			quad.light     = light1;
-			quad.texture   = mapeditor::textureManager().texture(texname, mixed).gl_id;
+			setQuadTexture(quad, mapeditor::textureManager().texture(texname, mixed, true));
 
 			setupQuadTexCoords(
 				&quad,
@@ -2172,22 +2668,22 @@ void MapRenderer3D::updateLine(unsigned index)
 	}
 
 	// Finished
-	lines_[index].updated_time = app::runTimer();
+	lines_[index].updated_time    = app::runTimer();
+	lines_[index].texture_pending = anyTexturePending(lines_[index].quads);
 }
 
 // -----------------------------------------------------------------------------
-// Renders [quad]
+// Sets up the GL state (other than texture and colour) for rendering [quad]
+// with [alpha]. If [shader] is given (it must already be bound), fog is left
+// to the shader and the alpha test is passed to it
 // -----------------------------------------------------------------------------
-void MapRenderer3D::renderQuad(const Quad* quad, float alpha)
+void MapRenderer3D::setupQuadRender(const Quad* quad, float alpha, const gl::Shader* shader)
 {
 	// Setup special rendering options
 	if (quad->colour.a == 255)
 	{
 		if (quad->flags & SKY && render_3d_sky)
-		{
-			alpha = 0;
 			glDisable(GL_ALPHA_TEST);
-		}
 		else if (quad->flags & MIDTEX)
 			glAlphaFunc(GL_GREATER, 0.9f * alpha);
 	}
@@ -2198,15 +2694,50 @@ void MapRenderer3D::renderQuad(const Quad* quad, float alpha)
 	else
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	// Setup colour/light
-	setLight(quad->colour, quad->light, alpha);
-
-	// Setup fog
-	setFog(quad->fogcolour, quad->light);
+	// Setup alpha test (shader) or fog (fixed-function)
+	if (shader)
+	{
+		float alpha_ref = -1.0f;
+		if (glIsEnabled(GL_ALPHA_TEST))
+			alpha_ref = (quad->colour.a == 255 && quad->flags & MIDTEX) ? 0.9f * alpha : 0.0f;
+		shader->setUniform("alpha_ref", alpha_ref);
+	}
+	else
+		setFog(quad->fogcolour, quad->light);
 
 	// Setup DRAWBOTH
 	if (quad->flags & DRAWBOTH)
 		glDisable(GL_CULL_FACE);
+}
+
+// -----------------------------------------------------------------------------
+// Resets any GL state changed by setupQuadRender for [quad]
+// -----------------------------------------------------------------------------
+void MapRenderer3D::resetQuadRender(const Quad* quad)
+{
+	if (quad->colour.a == 255)
+	{
+		if (quad->flags & SKY && render_3d_sky)
+			glEnable(GL_ALPHA_TEST);
+		else if (quad->flags & MIDTEX)
+			glAlphaFunc(GL_GREATER, 0.0f);
+	}
+	if (quad->flags & DRAWBOTH)
+		glEnable(GL_CULL_FACE);
+}
+
+// -----------------------------------------------------------------------------
+// Renders [quad]
+// -----------------------------------------------------------------------------
+void MapRenderer3D::renderQuad(const Quad* quad, float alpha)
+{
+	setupQuadRender(quad, alpha);
+
+	// Setup colour/light
+	if (quad->colour.a == 255 && quad->flags & SKY && render_3d_sky)
+		setLight(quad->colour, quad->light, 0.0f);
+	else
+		setLight(quad->colour, quad->light, alpha);
 
 	// Draw quad
 	glBegin(GL_QUADS);
@@ -2220,16 +2751,134 @@ void MapRenderer3D::renderQuad(const Quad* quad, float alpha)
 	glVertex3f(quad->points[3].x, quad->points[3].y, quad->points[3].z);
 	glEnd();
 
-	// Reset settings
-	if (quad->colour.a == 255)
+	resetQuadRender(quad);
+}
+
+// -----------------------------------------------------------------------------
+// Renders the first [count] quads in [quads] using a single vertex array.
+// Each run of consecutive quads with the same render state (texture, fog,
+// etc.) is drawn with a single call, so [quads] should be sorted to keep
+// quads with the same state together. If [shader] is given (it must already
+// be bound) the vertices are streamed to a VBO and fog is done per-vertex, so
+// it isn't part of the render state
+// -----------------------------------------------------------------------------
+void MapRenderer3D::renderQuadBatches(const vector<Quad*>& quads, unsigned count, const gl::Shader* shader)
+{
+	if (count == 0)
+		return;
+
+	// Build vertex array, with each quad's colour/light applied per-vertex
+	wall_vertices_.resize(count * 4);
+	for (unsigned a = 0; a < count; a++)
 	{
-		if (quad->flags & SKY && render_3d_sky)
-			glEnable(GL_ALPHA_TEST);
-		else if (quad->flags & MIDTEX)
-			glAlphaFunc(GL_GREATER, 0.0f);
+		auto quad  = quads[a];
+		auto alpha = quad->alpha;
+		if (quad->colour.a == 255 && quad->flags & SKY && render_3d_sky)
+			alpha = 0.0f;
+
+		float rgba[4];
+		lightColour(quad->colour, quad->light, alpha, rgba);
+		float fog_depth = fogDepth(quad->fogcolour, quad->light);
+		float layer     = shader && quad->tex_array ? quad->tex_layer : -1.0f;
+		for (unsigned p = 0; p < 4; p++)
+		{
+			auto& point  = quad->points[p];
+			auto& vertex = wall_vertices_[a * 4 + p];
+			vertex       = { point.x,
+							 point.y,
+							 point.z,
+							 point.tx,
+							 point.ty,
+							 layer,
+							 rgba[0],
+							 rgba[1],
+							 rgba[2],
+							 rgba[3],
+							 quad->fogcolour.fr(),
+							 quad->fogcolour.fg(),
+							 quad->fogcolour.fb(),
+							 fog_depth };
+		}
+	}
+
+	// Setup vertex array
+	if (shader)
+	{
+		// Stream vertices to the walls VBO
+		if (vbo_walls_ == 0)
+			glGenBuffers(1, &vbo_walls_);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_walls_);
+		glBufferData(
+			GL_ARRAY_BUFFER, wall_vertices_.size() * sizeof(WallVertex), wall_vertices_.data(), GL_STREAM_DRAW);
+
+		auto stride = sizeof(WallVertex);
+		glEnableVertexAttribArray(gl::attrib::POSITION);
+		glEnableVertexAttribArray(gl::attrib::TEXCOORD);
+		glEnableVertexAttribArray(gl::attrib::COLOUR);
+		glEnableVertexAttribArray(gl::attrib::FOG);
+		glVertexAttribPointer(gl::attrib::POSITION, 3, GL_FLOAT, GL_FALSE, stride, nullptr);
+		glVertexAttribPointer(
+			gl::attrib::TEXCOORD, 3, GL_FLOAT, GL_FALSE, stride, (char*)nullptr + offsetof(WallVertex, tx));
+		glVertexAttribPointer(
+			gl::attrib::COLOUR, 4, GL_FLOAT, GL_FALSE, stride, (char*)nullptr + offsetof(WallVertex, r));
+		glVertexAttribPointer(
+			gl::attrib::FOG, 4, GL_FLOAT, GL_FALSE, stride, (char*)nullptr + offsetof(WallVertex, fog_r));
+	}
+	else
+	{
+		if (gl::vboSupport())
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glVertexPointer(3, GL_FLOAT, sizeof(WallVertex), &wall_vertices_[0].x);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(WallVertex), &wall_vertices_[0].tx);
+		glColorPointer(4, GL_FLOAT, sizeof(WallVertex), &wall_vertices_[0].r);
+	}
+
+	// Render quads
+	bool     fog    = fog_ && !shader;
+	bool     arrays = shader != nullptr;
+	unsigned a      = 0;
+	while (a < count)
+	{
+		// Get all following quads with the same render state
+		auto     state = quadRenderState(quads[a], fog, arrays);
+		unsigned end   = a + 1;
+		while (end < count && quadRenderState(quads[end], fog, arrays) == state)
+			end++;
+
+		// Bind texture (array textures go to unit 1, see shader_frag_map3d)
+		if (arrays && quads[a]->tex_array)
+		{
+			glActiveTexture(GL_TEXTURE1);
+			gl::TextureArray::bind(quads[a]->tex_array);
+			glActiveTexture(GL_TEXTURE0);
+		}
+		else
+			gl::Texture::bind(quads[a]->texture);
+		mapeditor::textureManager().markUsed(quads[a]->texture);
+		setupQuadRender(quads[a], quads[a]->alpha, shader);
+		glDrawArrays(GL_QUADS, a * 4, (end - a) * 4);
+		resetQuadRender(quads[a]);
+
+		a = end;
+	}
+
+	if (shader)
+	{
+		glDisableVertexAttribArray(gl::attrib::POSITION);
+		glDisableVertexAttribArray(gl::attrib::TEXCOORD);
+		glDisableVertexAttribArray(gl::attrib::COLOUR);
+		glDisableVertexAttribArray(gl::attrib::FOG);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	else
+	{
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_COLOR_ARRAY);
 	}
-	if (quad->flags & DRAWBOTH)
-		glEnable(GL_CULL_FACE);
 }
 
 // -----------------------------------------------------------------------------
@@ -2237,45 +2886,36 @@ void MapRenderer3D::renderQuad(const Quad* quad, float alpha)
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderWalls()
 {
+	gl::profiler::Scope profile{ "3d: Walls" };
+
 	// Init
 	quads_transparent_.clear();
 	glEnable(GL_TEXTURE_2D);
 	glCullFace(GL_BACK);
 
-	// Render all visible quads, ordered by texture
-	unsigned a        = 0;
-	unsigned tex_last = 0;
-	while (n_quads_ > 0)
+	// Split off transparent quads to render last
+	unsigned n_opaque = 0;
+	for (unsigned a = 0; a < n_quads_; a++)
 	{
-		tex_last = 0;
-		a        = 0;
-		while (a < n_quads_)
-		{
-			// Check alpha
-			if (quads_[a]->colour.a < 255)
-			{
-				quads_transparent_.push_back(quads_[a]);
-				quads_[a] = quads_[--n_quads_];
-				continue;
-			}
-
-			// Check texture
-			if (!tex_last && quads_[a]->texture)
-			{
-				tex_last = quads_[a]->texture;
-				gl::Texture::bind(quads_[a]->texture);
-			}
-			if (quads_[a]->texture != tex_last)
-			{
-				a++;
-				continue;
-			}
-
-			// Render quad
-			renderQuad(quads_[a], quads_[a]->alpha);
-			quads_[a] = quads_[--n_quads_];
-		}
+		if (quads_[a]->colour.a < 255)
+			quads_transparent_.push_back(quads_[a]);
+		else
+			quads_[n_opaque++] = quads_[a];
 	}
+	n_quads_ = 0;
+
+	// Render all opaque quads, sorted by render state
+	auto shader = bindShader(ShaderType::Walls);
+	bool fog    = fog_ && !shader;
+	bool arrays = shader != nullptr;
+	std::sort(
+		quads_.begin(),
+		quads_.begin() + n_opaque,
+		[fog, arrays](const Quad* left, const Quad* right)
+		{ return quadRenderState(left, fog, arrays) < quadRenderState(right, fog, arrays); });
+	renderQuadBatches(quads_, n_opaque, shader);
+	if (shader)
+		gl::Shader::unbind();
 
 	glDisable(GL_TEXTURE_2D);
 }
@@ -2285,21 +2925,34 @@ void MapRenderer3D::renderWalls()
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderTransparentWalls()
 {
+	gl::profiler::Scope profile{ "3d: Transparent" };
+
 	// Init
 	glEnable(GL_TEXTURE_2D);
 	glDepthMask(GL_FALSE);
 	glDisable(GL_ALPHA_TEST);
 	glCullFace(GL_BACK);
 
-	// Render all transparent quads
-	for (auto& quad : quads_transparent_)
+	// Sort transparent quads furthest from the camera first (any consecutive
+	// quads with the same render state are still drawn together)
+	auto quad_dist = [this](const Quad* quad)
 	{
-		// Bind texture
-		gl::Texture::bind(quad->texture, false);
+		auto centre = Vec3d(
+			(quad->points[0].x + quad->points[2].x) * 0.5,
+			(quad->points[0].y + quad->points[2].y) * 0.5,
+			(quad->points[0].z + quad->points[2].z) * 0.5);
+		return (centre - cam_position_).magnitude();
+	};
+	std::sort(
+		quads_transparent_.begin(),
+		quads_transparent_.end(),
+		[&quad_dist](const Quad* left, const Quad* right) { return quad_dist(left) > quad_dist(right); });
 
-		// Render quad
-		renderQuad(quad, quad->alpha);
-	}
+	// Render all transparent quads
+	auto shader = bindShader(ShaderType::Walls);
+	renderQuadBatches(quads_transparent_, quads_transparent_.size(), shader);
+	if (shader)
+		gl::Shader::unbind();
 
 	glDisable(GL_TEXTURE_2D);
 	glDepthMask(GL_TRUE);
@@ -2427,7 +3080,7 @@ void MapRenderer3D::updateThing(unsigned index, const MapThing* thing)
 		return;
 
 	// Setup thing info
-	things_[index].type   = &(game::configuration().thingType(thing->type()));
+	things_[index].type   = &thing->typeDef();
 	things_[index].sector = map_->sectors().atPos(thing->position());
 
 	// Get sprite texture
@@ -2507,29 +3160,46 @@ void MapRenderer3D::updateThing(unsigned index, const MapThing* thing)
 }
 
 // -----------------------------------------------------------------------------
-// Renders all currently visible things
+// Renders all currently visible things.
+// Each thing's sprite is a camera-facing quad built here, and all sprites are
+// drawn together via renderQuadBatches (sorted by render state, so things with
+// the same sprite are drawn with a single call)
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderThings()
 {
+	gl::profiler::Scope profile{ "3d: Things" };
+
 	// Init
 	glEnable(GL_TEXTURE_2D);
 	glCullFace(GL_BACK);
-	unsigned tex = 0;
 
-	// Go through things
-	double dist, halfwidth, theight;
+	// Clear drawn flags from last frame
+	for (auto index : things_drawn_)
+		if (index < things_.size())
+			things_[index].flags &= ~DRAWN;
+	things_drawn_.clear();
+
+	// Get things within view distance (from the map's thing grid)
 	double mdist = render_max_thing_dist;
 	if (mdist <= 0 || mdist > render_max_dist)
 		mdist = render_max_dist;
-	ColRGBA  col;
-	uint8_t  light;
-	float    x1, y1, x2, y2;
-	unsigned update = 0;
-	Seg2d    strafe(cam_position_.get2d(), (cam_position_ + cam_strafe_).get2d());
-	for (unsigned a = 0; a < map_->nThings(); a++)
+	things_in_range_.clear();
+	map_->things().putAllInArea(
+		cam_position_.x - mdist,
+		cam_position_.y - mdist,
+		cam_position_.x + mdist,
+		cam_position_.y + mdist,
+		things_in_range_);
+
+	// Go through things
+	double  dist, halfwidth, theight;
+	uint8_t light;
+	float   x1, y1, x2, y2;
+	Seg2d   strafe(cam_position_.get2d(), (cam_position_ + cam_strafe_).get2d());
+	thing_quads_.clear();
+	for (auto thing : things_in_range_)
 	{
-		auto thing       = map_->thing(a);
-		things_[a].flags = things_[a].flags & ~DRAWN;
+		auto a = thing->index();
 
 		// Check side of camera
 		if (cam_pitch_ > -0.9 && cam_pitch_ < 0.9)
@@ -2538,35 +3208,34 @@ void MapRenderer3D::renderThings()
 				continue;
 		}
 
-		// Check thing distance if needed
+		// Check thing distance
 		dist = math::distance(cam_position_.get2d(), thing->position());
-		if (mdist > 0 && dist > mdist)
+		if (dist > mdist)
 			continue;
 
-		// Update thing if needed
-		if (things_[a].updated_time < thing->modifiedTime()
-			|| (things_[a].sector
-				&& (things_[a].updated_time < things_[a].sector->modifiedTime()
-					|| things_[a].updated_time < things_[a].sector->geometryUpdatedTime())))
-		{
+		// Update thing if needed (and there's time left this frame)
+		if ((things_[a].updated_time < thing->modifiedTime()
+			 || (things_[a].sector
+				 && (things_[a].updated_time < things_[a].sector->modifiedTime()
+					 || things_[a].updated_time < things_[a].sector->geometryUpdatedTime())))
+			&& !updateTimeUp())
 			updateThing(a, thing);
-			update++;
-			if (update > 500)
-				break;
-		}
+
+		// Skip if never updated
+		if (!things_[a].type)
+			continue;
 
 		// Skip if not shown
 		if (!things_[a].type->decoration() && render_3d_things == 2)
 			continue;
 
-		// Get thing sprite
-		tex = things_[a].sprite;
-
-		// Bind texture if needed
-		gl::Texture::bind(tex, false);
+		// Skip if in a hidden sector
+		if (things_[a].sector && things_[a].sector->index() < dist_sectors_.size()
+			&& dist_sectors_[things_[a].sector->index()] < 0)
+			continue;
 
 		// Determine coordinates
-		auto& tex_info = gl::Texture::info(tex);
+		auto& tex_info = gl::Texture::info(things_[a].sprite);
 		halfwidth      = things_[a].type->scaleX() * tex_info.size.x * 0.5;
 		theight        = things_[a].type->scaleY() * tex_info.size.y;
 		if (things_[a].flags & ICON)
@@ -2580,13 +3249,21 @@ void MapRenderer3D::renderThings()
 		y2                = thing->yPos() + cam_strafe_.y * halfwidth;
 		things_[a].height = theight;
 
+		// Setup sprite quad
+		auto  top      = static_cast<float>(things_[a].z + theight);
+		auto& quad     = thing_quads_.emplace_back();
+		quad.texture   = things_[a].sprite;
+		quad.alpha     = calcDistFade(dist, mdist);
+		quad.points[0] = { x1, y1, top, 0.0f, 0.0f };
+		quad.points[1] = { x1, y1, things_[a].z, 0.0f, 1.0f };
+		quad.points[2] = { x2, y2, things_[a].z, 1.0f, 1.0f };
+		quad.points[3] = { x2, y2, top, 1.0f, 0.0f };
+
 		// Set colour/brightness
 		light = 255;
 		// If a thing is defined as fullbright but the sprite is missing,
 		// we'll fallback on the icon, which needs to be colored as appropriate.
-		if (things_[a].type->fullbright() && !(things_[a].flags & ICON))
-			col.set(255, 255, 255, 255);
-		else
+		if (!things_[a].type->fullbright() || things_[a].flags & ICON)
 		{
 			// Get light level from sector
 			if (things_[a].sector)
@@ -2595,38 +3272,39 @@ void MapRenderer3D::renderThings()
 			// Icon, use thing icon colour (not for Zeth icons, though)
 			if (things_[a].flags & ICON)
 			{
-				if (things_[a].flags & ZETH)
-					col.set(255, 255, 255, 255);
-				else
-					col.set(things_[a].type->colour());
+				if (!(things_[a].flags & ZETH))
+					quad.colour.set(things_[a].type->colour());
 			}
 
 			// Otherwise use sector colour
 			else if (things_[a].sector)
-				col.set(things_[a].sector->colourAt(0, true));
+				quad.colour.set(things_[a].sector->colourAt(0, true));
 		}
-		setLight(col, light, calcDistFade(dist, mdist));
-		auto fogcol = ColRGBA(0, 0, 0, 0);
+		quad.light = light;
 		if (things_[a].sector)
-			fogcol = things_[a].sector->fogColour();
-
-		setFog(fogcol, light);
-
-		// Draw thing
-		glBegin(GL_QUADS);
-		glTexCoord2f(0.0f, 0.0f);
-		glVertex3f(x1, y1, things_[a].z + theight);
-		glTexCoord2f(0.0f, 1.0f);
-		glVertex3f(x1, y1, things_[a].z);
-		glTexCoord2f(1.0f, 1.0f);
-		glVertex3f(x2, y2, things_[a].z);
-		glTexCoord2f(1.0f, 0.0f);
-		glVertex3f(x2, y2, things_[a].z + theight);
-		glEnd();
+			quad.fogcolour = things_[a].sector->fogColour();
+		else
+			quad.fogcolour.set(0, 0, 0, 0);
 
 		things_[a].flags |= DRAWN;
+		things_drawn_.push_back(a);
 	}
 
+	// Draw sprites, grouped by render state (mostly sprite texture)
+	auto shader = bindShader(ShaderType::Walls);
+	bool fog    = fog_ && !shader;
+	thing_quad_list_.clear();
+	for (auto& quad : thing_quads_)
+		thing_quad_list_.push_back(&quad);
+	std::sort(
+		thing_quad_list_.begin(),
+		thing_quad_list_.end(),
+		[fog](const Quad* left, const Quad* right)
+		{ return quadRenderState(left, fog, false) < quadRenderState(right, fog, false); });
+	renderQuadBatches(thing_quad_list_, thing_quad_list_.size(), shader);
+	if (shader)
+		gl::Shader::unbind();
+
 	// Draw thing borders if needed
 	if (render_3d_things_style >= 1)
 	{
@@ -2636,12 +3314,9 @@ void MapRenderer3D::renderThings()
 		glDisable(GL_CULL_FACE);
 		glLineWidth(3.5f);
 
-		for (unsigned a = 0; a < map_->nThings(); a++)
+		ColRGBA col;
+		for (auto a : things_drawn_)
 		{
-			// Skip if hidden
-			if (!(things_[a].flags & DRAWN))
-				continue;
-
 			auto thing = map_->thing(a);
 			col.set(things_[a].type->colour());
 			float radius = things_[a].type->radius();
@@ -2854,10 +3529,14 @@ void MapRenderer3D::updateFlatsVBO()
 		totalsize += poly->vboDataSize() * sector_flats_[a].size();
 	}
 
-	// Allocate buffer data
+	// Allocate buffer data, with some spare space at the end for sectors that
+	// outgrow their range later
+	vbo_flats_size_ = totalsize + std::max(totalsize / 4, flats_vbo_min_spare);
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
 	Polygon2D::setupVBOPointers();
-	glBufferData(GL_ARRAY_BUFFER, totalsize, nullptr, GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, vbo_flats_size_, nullptr, GL_DYNAMIC_DRAW);
+	vbo_flats_free_.clear();
+	vbo_flats_sectors_.assign(sector_flats_.size(), {});
 
 	// Write polygon data to VBO
 	unsigned offset = 0;
@@ -2866,11 +3545,15 @@ void MapRenderer3D::updateFlatsVBO()
 		MapSector* sector = sector_flats_[a][0].sector;
 		Polygon2D* poly   = sector->polygon();
 
+		vbo_flats_sectors_[a].offset = offset;
+		vbo_flats_sectors_[a].size   = poly->vboDataSize() * static_cast<unsigned>(sector_flats_[a].size());
+
 		// TODO i realize we'll have to do this if any 3d floors are /added/, too
 		for (unsigned b = 0; b < sector_flats_[a].size(); b++)
 		{
 			// Write flat to VBO
 			sector_flats_[a][b].vbo_offset = offset;
+			sector_flats_[a][b].vbo_size   = poly->vboDataSize();
 			updateFlatTexCoords(a, b);
 			poly->setZ(sector_flats_[a][b].plane);
 			offset = poly->writeToVBO(offset);
@@ -2882,6 +3565,80 @@ void MapRenderer3D::updateFlatsVBO()
 
 	// Clean up
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	vbo_flats_end_     = offset;
+	vbo_flats_rebuild_ = false;
+}
+
+// -----------------------------------------------------------------------------
+// Finds an unused range of [size] bytes in the flats VBO, and writes its
+// offset to [offset]. Returns false if there isn't enough space left
+// -----------------------------------------------------------------------------
+bool MapRenderer3D::allocFlatsVBORange(unsigned size, unsigned& offset)
+{
+	// Use the first free range that's big enough
+	for (auto range = vbo_flats_free_.begin(); range != vbo_flats_free_.end(); ++range)
+	{
+		if (range->size < size)
+			continue;
+
+		offset = range->offset;
+		range->offset += size;
+		range->size -= size;
+		if (range->size == 0)
+			vbo_flats_free_.erase(range);
+
+		return true;
+	}
+
+	// Otherwise use the spare space at the end of the buffer
+	if (vbo_flats_size_ - vbo_flats_end_ < size)
+		return false;
+
+	offset = vbo_flats_end_;
+	vbo_flats_end_ += size;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Marks the range of [size] bytes at [offset] in the flats VBO as unused,
+// merging it with any adjacent unused ranges
+// -----------------------------------------------------------------------------
+void MapRenderer3D::freeFlatsVBORange(unsigned offset, unsigned size)
+{
+	if (size == 0)
+		return;
+
+	// Add to free ranges (in offset order), merging with the next range
+	auto range = std::lower_bound(
+		vbo_flats_free_.begin(),
+		vbo_flats_free_.end(),
+		offset,
+		[](const VBORange& free, unsigned value) { return free.offset < value; });
+	if (range != vbo_flats_free_.end() && offset + size == range->offset)
+	{
+		range->offset = offset;
+		range->size += size;
+	}
+	else
+		range = vbo_flats_free_.insert(range, { offset, size });
+
+	// Merge with the previous range
+	if (range != vbo_flats_free_.begin())
+	{
+		auto prev = std::prev(range);
+		if (prev->offset + prev->size == range->offset)
+		{
+			prev->size += range->size;
+			range = std::prev(vbo_flats_free_.erase(range));
+		}
+	}
+
+	// Return to the spare space if it's at the end of the used part
+	if (range->offset + range->size == vbo_flats_end_)
+	{
+		vbo_flats_end_ = range->offset;
+		vbo_flats_free_.erase(range);
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -2949,16 +3706,127 @@ void MapRenderer3D::quickVisDiscard()
 		}
 	}
 
-	// Set all lines that are part of invisible sectors to invisible
-	for (unsigned a = 0; a < map_->nSides(); a++)
+	// Hide any sectors that can't be seen through other sectors from the camera
+	if (render_3d_portal_vis)
+		floodSectorVisibility();
+
+	// Set all lines that aren't part of any visible sectors to invisible
+	for (unsigned a = 0; a < map_->nLines(); a++)
 	{
-		dist = dist_sectors_[map_->side(a)->sector()->index()];
+		auto line    = map_->line(a);
+		bool visible = false;
+		for (auto side : { line->s1(), line->s2() })
+		{
+			if (!side)
+				continue;
+
+			dist = dist_sectors_[side->sector()->index()];
+			if (dist >= 0 && !(render_max_dist > 0 && dist > render_max_dist))
+				visible = true;
+		}
 
-		lines_[map_->side(a)->parentLine()->index()].visible = !(
-			dist < 0 || (render_max_dist > 0 && dist > render_max_dist));
+		lines_[a].visible = visible;
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Determines which sectors are potentially visible from the camera by flooding
+// out from the sector containing the camera through any open two-sided lines
+// facing it. Each sector reached keeps the range of (horizontal) view angles
+// it can be seen through, which is narrowed by each line passed through on the
+// way to it. Any sectors not reached are hidden
+// -----------------------------------------------------------------------------
+void MapRenderer3D::floodSectorVisibility()
+{
+	// Can't determine anything if the camera isn't within a sector
+	auto cam        = cam_position_.get2d();
+	auto cam_sector = map_->sectors().atPos(cam);
+	if (!cam_sector || cam_position_.z < cam_sector->floor().plane.heightAt(cam)
+		|| cam_position_.z > cam_sector->ceiling().plane.heightAt(cam))
+		return;
+
+	// Determine the range of view angles (relative to the camera direction)
+	// covered by the view frustum on the xy plane
+	double max_angle = math::PI;
+	auto   tan_h     = tan(math::degToRad(render_fov) * 0.5);
+	auto   tan_v     = tan_h / view_aspect_;
+	auto   pitch     = fabs(cam_pitch_);
+	auto   cos_pitch = cos(pitch) - tan_v * sin(pitch);
+	if (cos_pitch > 0.01)
+		max_angle = std::min(math::PI, atan(tan_h / cos_pitch) + 0.05);
+
+	auto view_angle = [&](const Vec2d& point)
+	{
+		auto dir = point - cam;
+		return atan2(
+			cam_direction_.x * dir.y - cam_direction_.y * dir.x, cam_direction_.x * dir.x + cam_direction_.y * dir.y);
+	};
+
+	// Flood out from the camera sector
+	vis_ranges_.assign(map_->nSectors(), {});
+	vis_ranges_[cam_sector->index()] = { -max_angle, max_angle, true };
+	vector<unsigned> to_check{ cam_sector->index() };
+	while (!to_check.empty())
+	{
+		auto index = to_check.back();
+		auto range = vis_ranges_[index];
+		to_check.pop_back();
+
+		for (auto side : map_->sector(index)->connectedSides())
+		{
+			// Check for sector on the other side
+			auto line  = side->parentLine();
+			auto other = side == line->s1() ? line->s2() : line->s1();
+			if (!other || other->sector() == side->sector())
+				continue;
+
+			// Check distance
+			auto seg  = line->seg();
+			auto dist = math::distanceToLine(cam, seg);
+			if (render_max_dist > 0 && dist > render_max_dist)
+				continue;
+
+			// Can't see through closed lines
+			if (!lineOpen(line))
+				continue;
+
+			// Check the line faces the camera and clip the visible range to it
+			// (unless the camera is right at the line)
+			auto min = range.min;
+			auto max = range.max;
+			if (dist > 1.0)
+			{
+				auto cam_side = math::lineSide(cam, seg);
+				if (side == line->s1() ? cam_side < 0 : cam_side > 0)
+					continue;
+
+				if (!clipViewRange(min, max, view_angle(line->start()), view_angle(line->end())))
+					continue;
+			}
+
+			// Add the range to the sector on the other side, and check it (again)
+			// if it is visible through more than it was previously
+			auto& other_range = vis_ranges_[other->sector()->index()];
+			if (!other_range.reached)
+				other_range = { min, max, true };
+			else if (min < other_range.min || max > other_range.max)
+			{
+				other_range.min = std::min(min, other_range.min);
+				other_range.max = std::max(max, other_range.max);
+			}
+			else
+				continue;
+
+			to_check.push_back(other->sector()->index());
+		}
+	}
+
+	// Hide any sectors that weren't reached
+	for (unsigned a = 0; a < map_->nSectors(); a++)
+		if (!vis_ranges_[a].reached)
+			dist_sectors_[a] = -1.0f;
+}
+
 // -----------------------------------------------------------------------------
 // Calculates and returns the faded alpha value for [distance] from the camera
 // -----------------------------------------------------------------------------
@@ -2974,27 +3842,73 @@ float MapRenderer3D::calcDistFade(double distance, double max) const
 		return 1.0f;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the 3d geometry for line [index] needs to be (re)built
+// -----------------------------------------------------------------------------
+bool MapRenderer3D::isLineStale(unsigned index) const
+{
+	auto  line    = map_->line(index);
+	auto& line3d  = lines_[index];
+	auto  updated = line3d.updated_time;
+
+	// Check line modified (or waiting on textures that are now loaded)
+	if (line3d.line != line || updated == 0 || updated < line->modifiedTime())
+		return true;
+
+	// Check front/back side and sector (including 3d floor control sectors) modified
+	for (auto side : { line->s1(), line->s2() })
+	{
+		if (!side)
+			continue;
+
+		auto sector = side->sector();
+		if (updated < side->modifiedTime() || updated < sector->modifiedTime()
+			|| updated < sector->geometryUpdatedTime())
+			return true;
+
+		for (const auto& extra_floor : sector->extraFloors())
+		{
+			MapLine* control_line = map_->line(extra_floor.control_line_index);
+			if (updated < control_line->s1()->modifiedTime()
+				|| updated < control_line->frontSector()->modifiedTime()
+				|| updated < control_line->frontSector()->geometryUpdatedTime())
+				return true;
+		}
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the time allowed for updating 3d geometry this frame has
+// been used up. If so, the remaining updates are left for later frames
+// -----------------------------------------------------------------------------
+bool MapRenderer3D::updateTimeUp()
+{
+	if (app::runTimer() < update_deadline_)
+		return false;
+
+	updates_pending_ = true;
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Checks and hides any quads that are not currently in view
 // -----------------------------------------------------------------------------
 void MapRenderer3D::checkVisibleQuads()
 {
 	// Create quads array if empty
-	// if (!quads_)
-	//	quads_ = new Quad*[map_->nLines() * 4];
 	if (quads_.empty())
 		quads_.resize(map_->nLines() * 4);
 
 	// Go through lines
-	MapLine* line;
-	float    distfade;
-	n_quads_         = 0;
-	unsigned updates = 0;
-	bool     update  = false;
-	Seg2d    strafe(cam_position_.get2d(), (cam_position_ + cam_strafe_).get2d());
+	vector<unsigned>                    visible;
+	vector<std::pair<double, unsigned>> stale;
+	auto                                cam = cam_position_.get2d();
+	Seg2d                               strafe(cam, (cam_position_ + cam_strafe_).get2d());
 	for (unsigned a = 0; a < lines_.size(); a++)
 	{
-		line = map_->line(a);
+		auto line = map_->line(a);
 
 		// Skip if not visible
 		if (!lines_[a].visible)
@@ -3007,70 +3921,35 @@ void MapRenderer3D::checkVisibleQuads()
 				continue;
 		}
 
+		visible.push_back(a);
+		if (isLineStale(a))
+			stale.emplace_back(math::distanceToLine(cam, line->seg()), a);
+	}
+
+	// Update lines that need it, nearest to the camera first
+	std::sort(stale.begin(), stale.end());
+	for (const auto& line : stale)
+	{
+		if (updateTimeUp())
+			break;
+
+		updateLine(line.second);
+	}
+
+	// Determine quads to be drawn
+	n_quads_ = 0;
+	for (auto index : visible)
+	{
 		// Check for distance fade
+		float distfade = 1.0f;
 		if (render_max_dist > 0)
-			distfade = calcDistFade(math::distanceToLine(cam_position_.get2d(), line->seg()), render_max_dist);
-		else
-			distfade = 1.0f;
-
-		// Update line if needed
-		update = false;
-		if (lines_[a].updated_time < line->modifiedTime()) // Check line modified
-			update = true;
-		if (lines_[a].line != line)
-			update = true;
-		if (!update && line->s1())
-		{
-			// Check front side/sector modified
-			if (lines_[a].updated_time < line->s1()->modifiedTime()
-				|| lines_[a].updated_time < line->frontSector()->modifiedTime()
-				|| lines_[a].updated_time < line->frontSector()->geometryUpdatedTime())
-				update = true;
-
-			MapSector* sector = line->frontSector();
-			for (const auto& extra_floor : sector->extraFloors())
-			{
-				MapLine* control_line = map_->line(extra_floor.control_line_index);
-				if (lines_[a].updated_time < control_line->s1()->modifiedTime()
-					|| lines_[a].updated_time < control_line->frontSector()->modifiedTime()
-					|| lines_[a].updated_time < control_line->frontSector()->geometryUpdatedTime())
-					update = true;
-			}
-		}
-		if (!update && line->s2())
-		{
-			// Check back side/sector modified
-			if (lines_[a].updated_time < line->s2()->modifiedTime()
-				|| lines_[a].updated_time < line->backSector()->modifiedTime()
-				|| lines_[a].updated_time < line->backSector()->geometryUpdatedTime())
-				update = true;
+			distfade = calcDistFade(math::distanceToLine(cam, map_->line(index)->seg()), render_max_dist);
 
-			MapSector* sector = line->backSector();
-			for (const auto& extra_floor : sector->extraFloors())
-			{
-				MapLine* control_line = map_->line(extra_floor.control_line_index);
-				if (lines_[a].updated_time < control_line->s1()->modifiedTime()
-					|| lines_[a].updated_time < control_line->frontSector()->modifiedTime()
-					|| lines_[a].updated_time < control_line->frontSector()->geometryUpdatedTime())
-					update = true;
-			}
-		}
-		if (update)
-		{
-			updateLine(a);
-			// updates++;
-			// if (updates > 500)
-			//	break;
-		}
-
-		// Determine quads to be drawn
-		for (auto& quad : lines_[a].quads)
+		for (auto& quad : lines_[index].quads)
 		{
 			// Check we're on the right side of the quad
 			if (!(quad.flags & DRAWBOTH)
-				&& math::lineSide(
-					   cam_position_.get2d(),
-					   Seg2d(quad.points[0].x, quad.points[0].y, quad.points[2].x, quad.points[2].y))
+				&& math::lineSide(cam, Seg2d(quad.points[0].x, quad.points[0].y, quad.points[2].x, quad.points[2].y))
 					   < 0)
 				continue;
 
@@ -3086,6 +3965,20 @@ void MapRenderer3D::checkVisibleQuads()
 // -----------------------------------------------------------------------------
 void MapRenderer3D::checkVisibleFlats()
 {
+	// Update visible sectors that need it, nearest to the camera first
+	vector<std::pair<float, unsigned>> stale;
+	for (unsigned a = 0; a < sector_flats_.size(); a++)
+		if (dist_sectors_[a] >= 0 && isSectorStale(a))
+			stale.emplace_back(dist_sectors_[a], a);
+	std::sort(stale.begin(), stale.end());
+	for (const auto& sector : stale)
+	{
+		if (updateTimeUp())
+			break;
+
+		updateSector(sector.second);
+	}
+
 	// Update flats array
 	flats_.clear();
 	n_flats_ = 0;
@@ -3095,10 +3988,6 @@ void MapRenderer3D::checkVisibleFlats()
 		if (dist_sectors_[a] < 0)
 			continue;
 
-		// Update sector info if needed
-		if (isSectorStale(a))
-			updateSector(a);
-
 		n_flats_ += sector_flats_[a].size();
 	}
 	flats_.resize(n_flats_);
@@ -3159,22 +4048,14 @@ void MapRenderer3D::checkVisibleFlats()
 }
 
 // -----------------------------------------------------------------------------
-// Finds the closest wall/flat/thing to the camera along the view vector
+// Finds the closest wall or flat intersecting the camera view ray, by testing
+// all visible walls and flats. [current] and [min_dist] are set to the item
+// and its distance if one is found closer than [min_dist]
 // -----------------------------------------------------------------------------
-mapeditor::Item MapRenderer3D::determineHilight()
+void MapRenderer3D::rayTestWallsAndFlats(mapeditor::Item& current, double& min_dist) const
 {
-	// Init
-	double          min_dist = 9999999;
-	mapeditor::Item current;
-	Seg2d           strafe(cam_position_.get2d(), (cam_position_ + cam_strafe_).get2d());
-
-	// Check for required map structures
-	if (!map_ || lines_.size() != map_->nLines() || sector_flats_.size() != map_->nSectors()
-		|| things_.size() != map_->nThings())
-		return current;
-
 	// Check lines
-	double height, dist;
+	double dist;
 	for (unsigned a = 0; a < map_->nLines(); a++)
 	{
 		// Ignore if not visible
@@ -3214,29 +4095,7 @@ mapeditor::Item MapRenderer3D::determineHilight()
 			double bottom = quad.points[1].z + (quad.points[2].z - quad.points[1].z) * dist_along_segment;
 			if (bottom <= intersection.z && intersection.z <= top)
 			{
-				// Determine selected item from quad flags
-
-				// Side index
-				if (quad.flags & BACK)
-					current.index = line->s2Index();
-				else
-					current.index = line->s1Index();
-
-				// Side part
-				if (quad.control_side >= 0)
-				{
-					current.type         = mapeditor::ItemType::WallMiddle;
-					current.real_index   = current.index;
-					current.control_line = quad.control_line;
-					current.index        = quad.control_side;
-				}
-				else if (quad.flags & UPPER)
-					current.type = mapeditor::ItemType::WallTop;
-				else if (quad.flags & LOWER)
-					current.type = mapeditor::ItemType::WallBottom;
-				else
-					current.type = mapeditor::ItemType::WallMiddle;
-
+				current  = quadItem(line, quad);
 				min_dist = dist;
 			}
 		}
@@ -3282,21 +4141,45 @@ mapeditor::Item MapRenderer3D::determineHilight()
 			if (!map_->sector(a)->containsPoint((cam_position_ + cam_dir3d_ * dist).get2d()))
 				continue;
 
-			if (flat.extra_floor_index < 0)
-				current.index = a;
-			else
+			current  = flatItem(a, flat);
+			min_dist = dist;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Finds the closest wall/flat/thing to the camera along the view vector
+// -----------------------------------------------------------------------------
+mapeditor::Item MapRenderer3D::determineHilight()
+{
+	// Init
+	double          min_dist = 9999999;
+	mapeditor::Item current;
+	Seg2d           strafe(cam_position_.get2d(), (cam_position_ + cam_strafe_).get2d());
+
+	// Check for required map structures
+	if (!map_ || lines_.size() != map_->nLines() || sector_flats_.size() != map_->nSectors()
+		|| things_.size() != map_->nThings())
+		return current;
+
+	// Check walls and flats, using the result of the last GPU pick pass if
+	// possible (see renderPickBuffer)
+	if (pickingEnabled())
+	{
+		// (the map may have changed since the pick pass)
+		if (pick_item_.index >= 0 && pick_dist_ >= 0)
+		{
+			bool side    = mapeditor::baseItemType(pick_item_.type) == mapeditor::ItemType::Side;
+			auto n_items = side ? map_->nSides() : map_->nSectors();
+			if (pick_item_.index < static_cast<int>(n_items))
 			{
-				current.index      = flat.control_sector->index();
-				current.real_index = a;
+				current  = pick_item_;
+				min_dist = pick_dist_;
 			}
-
-			min_dist = dist;
-			if (flat.flags & CEIL)
-				current.type = mapeditor::ItemType::Ceiling;
-			else
-				current.type = mapeditor::ItemType::Floor;
 		}
 	}
+	else
+		rayTestWallsAndFlats(current, min_dist);
 
 	// Update item distance
 	if (min_dist >= 9999999 || min_dist < 0)
@@ -3307,7 +4190,7 @@ mapeditor::Item MapRenderer3D::determineHilight()
 	// Check things (if visible)
 	if (render_3d_things == 0)
 		return current;
-	double halfwidth, theight;
+	double halfwidth, theight, height, dist;
 	for (unsigned a = 0; a < map_->nThings(); a++)
 	{
 		// Ignore if no sprite
@@ -3360,11 +4243,241 @@ mapeditor::Item MapRenderer3D::determineHilight()
 	return current;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if hilighted walls and flats are determined by rendering them
+// to a pick buffer on the GPU (see renderPickBuffer)
+// -----------------------------------------------------------------------------
+bool MapRenderer3D::pickingEnabled() const
+{
+	return render_3d_gpu_pick && !pick_failed_ && gl::fboSupport() && gl::vboSupport() && flats_use_vbo;
+}
+
+// -----------------------------------------------------------------------------
+// Renders all visible walls and flats with their item ids as colours to a
+// 1x1 pixel offscreen buffer, restricted to the pixel under the crosshair.
+// The id and depth of the pixel are read back asynchronously to a PBO, and the
+// result is read by readPickBuffer the next time this is called (a frame
+// later), to be used by determineHilight without stalling for the GPU
+// -----------------------------------------------------------------------------
+void MapRenderer3D::renderPickBuffer()
+{
+	gl::profiler::Scope profile{ "3d: Pick" };
+
+	// Get result of the previous pick pass
+	readPickBuffer();
+
+	// Create pick buffer if needed
+	if (!pick_fbo_)
+	{
+		glGenRenderbuffers(1, &pick_rb_colour_);
+		glBindRenderbuffer(GL_RENDERBUFFER, pick_rb_colour_);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, 1, 1);
+		glGenRenderbuffers(1, &pick_rb_depth_);
+		glBindRenderbuffer(GL_RENDERBUFFER, pick_rb_depth_);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 1, 1);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+		glGenFramebuffers(1, &pick_fbo_);
+		glBindFramebuffer(GL_FRAMEBUFFER, pick_fbo_);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, pick_rb_colour_);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, pick_rb_depth_);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			// Fall back to CPU ray tests
+			log::warning("Unable to create 3d pick buffer, using CPU hilight detection");
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			pick_failed_ = true;
+			return;
+		}
+
+		// Colour (4 bytes) + depth (float)
+		glGenBuffers(1, &pick_pbo_);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pick_pbo_);
+		glBufferData(GL_PIXEL_PACK_BUFFER, 8, nullptr, GL_STREAM_READ);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+	else
+		glBindFramebuffer(GL_FRAMEBUFFER, pick_fbo_);
+
+	// Restrict the current projection to the crosshair pixel
+	GLint viewport[4];
+	float projection[16];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glGetFloatv(GL_PROJECTION_MATRIX, projection);
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	gluPickMatrix(viewport[0] + viewport[2] * 0.5, viewport[1] + viewport[3] * 0.5, 1, 1, viewport);
+	glMultMatrixf(projection);
+	glMatrixMode(GL_MODELVIEW);
+	glViewport(0, 0, 1, 1);
+
+	// Setup GL state (ids must be written exactly)
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glDisable(GL_TEXTURE_2D);
+	glDisable(GL_BLEND);
+	glDisable(GL_ALPHA_TEST);
+	glDisable(GL_FOG);
+	glDisable(GL_DITHER);
+	glEnable(GL_DEPTH_TEST);
+	glDepthMask(GL_TRUE);
+	glEnable(GL_CULL_FACE);
+	glCullFace(GL_BACK);
+
+	// Item ids are stored as 24-bit colours (0 is nothing)
+	pick_items_.clear();
+	auto next_id = [this](const mapeditor::Item& item)
+	{
+		pick_items_.push_back(item);
+		auto id = pick_items_.size();
+		return ColRGBA(id & 0xff, (id >> 8) & 0xff, (id >> 16) & 0xff);
+	};
+
+	// Build wall vertices, double-sided walls separately so they can be drawn
+	// without culling
+	pick_vertices_[0].clear();
+	pick_vertices_[1].clear();
+	for (unsigned a = 0; a < lines_.size(); a++)
+	{
+		if (!lines_[a].visible)
+			continue;
+
+		auto line = map_->line(a);
+		for (auto& quad : lines_[a].quads)
+		{
+			auto  id       = next_id(quadItem(line, quad));
+			auto& vertices = pick_vertices_[(quad.flags & DRAWBOTH) ? 1 : 0];
+			for (auto& point : quad.points)
+				vertices.push_back({ point.x, point.y, point.z, id.r, id.g, id.b, 255 });
+		}
+	}
+
+	// Render walls
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	for (int drawboth = 0; drawboth < 2; drawboth++)
+	{
+		auto& vertices = pick_vertices_[drawboth];
+		if (vertices.empty())
+			continue;
+
+		if (drawboth)
+			glDisable(GL_CULL_FACE);
+		glVertexPointer(3, GL_FLOAT, sizeof(PickVertex), &vertices[0].x);
+		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(PickVertex), &vertices[0].r);
+		glDrawArrays(GL_QUADS, 0, vertices.size());
+	}
+	glDisableClientState(GL_COLOR_ARRAY);
+	glEnable(GL_CULL_FACE);
+
+	// Render flats
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
+	Polygon2D::setupVBOPointers();
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	for (unsigned a = 0; a < sector_flats_.size(); a++)
+	{
+		if (dist_sectors_[a] < 0)
+			continue;
+
+		for (auto& flat : sector_flats_[a])
+		{
+			if (!flat.sector)
+				continue;
+
+			auto id = next_id(flatItem(a, flat));
+			glColor4ub(id.r, id.g, id.b, 255);
+
+			// Cull the same as when rendering normally (see setupFlatRender)
+			if (flat.flags & DRAWBOTH)
+				glDisable(GL_CULL_FACE);
+			else if (flat.flags & CEIL)
+				glCullFace((flat.flags & FLATFLIP) ? GL_FRONT : GL_BACK);
+			else
+				glCullFace((flat.flags & FLATFLIP) ? GL_BACK : GL_FRONT);
+
+			flat.sector->polygon()->renderVBO(flat.vbo_offset);
+
+			if (flat.flags & DRAWBOTH)
+				glEnable(GL_CULL_FACE);
+		}
+	}
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// Start reading back the id and depth (read next frame)
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pick_pbo_);
+	glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glReadPixels(0, 0, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, (char*)nullptr + 4);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	pick_pending_ = true;
+	pick_far_     = view_far_;
+
+	// The result is only available next frame, so make sure there is one if
+	// the view has changed
+	if ((pick_cam_position_ - cam_position_).magnitude() > 0. || (pick_cam_dir_ - cam_dir3d_).magnitude() > 0.)
+	{
+		pick_cam_position_ = cam_position_;
+		pick_cam_dir_      = cam_dir3d_;
+		updates_pending_   = true;
+	}
+
+	// Restore GL state
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glEnable(GL_BLEND);
+	glEnable(GL_DITHER);
+	glCullFace(GL_BACK);
+	gl::setColour(ColRGBA::WHITE);
+}
+
+// -----------------------------------------------------------------------------
+// Reads the result of the last pick pass (see renderPickBuffer), if any, and
+// updates the currently picked item and its distance from the camera
+// -----------------------------------------------------------------------------
+void MapRenderer3D::readPickBuffer()
+{
+	if (!pick_pending_)
+		return;
+
+	pick_pending_ = false;
+	pick_item_    = {};
+	pick_dist_    = -1.;
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pick_pbo_);
+	auto data = static_cast<const uint8_t*>(glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY));
+	if (data)
+	{
+		unsigned id = data[0] | (data[1] << 8) | (data[2] << 16);
+		float    depth;
+		memcpy(&depth, data + 4, sizeof(float));
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+		if (id > 0 && id <= pick_items_.size())
+		{
+			pick_item_ = pick_items_[id - 1];
+
+			// Convert window depth to distance from the camera (at the centre
+			// of the view this is the distance along the view direction)
+			double z   = depth * 2.0 - 1.0;
+			pick_dist_ = 2.0 * near_clip * pick_far_ / (pick_far_ + near_clip - z * (pick_far_ - near_clip));
+		}
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
 // -----------------------------------------------------------------------------
 // Renders the hilight overlay for the currently hilighted object
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderHilight(mapeditor::Item hilight, float alpha)
 {
+	gl::profiler::Scope profile{ "3d: Hilight" };
+
 	// Do nothing if no item hilighted
 	if (hilight.index < 0 || render_3d_hilight == 0 || !render_hilight_)
 		return;
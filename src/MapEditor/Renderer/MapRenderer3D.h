@@ -8,6 +8,11 @@ namespace slade
 class ItemSelection;
 class Polygon2D;
 
+namespace gl
+{
+	class Shader;
+}
+
 namespace game
 {
 	class ThingType;
@@ -53,6 +58,8 @@ public:
 		ColRGBA  fogcolour;
 		uint8_t  light        = 0;
 		unsigned texture      = 0;
+		unsigned tex_array    = 0;
+		int      tex_layer    = -1;
 		uint8_t  flags        = 0;
 		float    alpha        = 1.f;
 		int      control_line = -1;
@@ -63,9 +70,10 @@ public:
 	struct Line
 	{
 		vector<Quad> quads;
-		long         updated_time = 0;
-		bool         visible      = true;
-		MapLine*     line         = nullptr;
+		long         updated_time    = 0;
+		bool         visible         = true;
+		bool         texture_pending = false;
+		MapLine*     line            = nullptr;
 	};
 	struct Thing
 	{
@@ -93,6 +101,7 @@ public:
 		int        extra_floor_index = -1;
 		long       updated_time      = 0;
 		unsigned   vbo_offset        = 0;
+		unsigned   vbo_size          = 0;
 	};
 
 	MapRenderer3D(SLADEMap* map = nullptr);
@@ -103,12 +112,14 @@ public:
 	void enableFullbright(bool enable = true) { fullbright_ = enable; }
 	void enableFog(bool enable = true) { fog_ = enable; }
 	int  itemDistance() const { return item_dist_; }
+	bool updatesPending() const { return updates_pending_; }
 	void enableHilight(bool render) { render_hilight_ = render; }
 	void enableSelection(bool render) { render_selection_ = render; }
 
 	bool init();
 	void refresh();
 	void refreshTextures();
+	void texturesUnloaded(const vector<unsigned>& textures);
 	void clearData();
 	void buildSkyCircle();
 
@@ -133,26 +144,23 @@ public:
 	Vec2d  camDirection() const { return cam_direction_; }
 
 	// -- Rendering --
-	void setupView(int width, int height) const;
+	void setupView(int width, int height);
 	void setLight(const ColRGBA& colour, uint8_t light, float alpha = 1.0f) const;
+	void lightColour(const ColRGBA& colour, uint8_t light, float alpha, float* rgba) const;
 	void setFog(const ColRGBA& fogcol, uint8_t light);
 	void renderMap();
-	void renderSkySlice(
-		float top,
-		float bottom,
-		float atop,
-		float abottom,
-		float size,
-		float tx = 0.125f,
-		float ty = 2.0f) const;
+	void addSkySlice(float top, float bottom, float atop, float abottom, float size, float tx, float ty);
+	void updateSkyVBO(unsigned texture, float tx, float ty);
 	void renderSky();
 
 	// Flats
 	void updateFlatTexCoords(unsigned index, unsigned flat_index) const;
 	void updateSector(unsigned index);
 	void updateSectorFlats(unsigned index);
-	void updateSectorVBOs(unsigned index) const;
+	void updateSectorVBOs(unsigned index);
 	bool isSectorStale(unsigned index) const;
+	void setupFlatRender(const Flat* flat, const gl::Shader* shader = nullptr);
+	void resetFlatRender(const Flat* flat);
 	void renderFlat(const Flat* flat);
 	void renderFlats();
 	void renderFlatSelection(const ItemSelection& selection, float alpha = 1.0f) const;
@@ -171,7 +179,10 @@ public:
 		double sx        = 1,
 		double sy        = 1) const;
 	void updateLine(unsigned index);
+	void setupQuadRender(const Quad* quad, float alpha, const gl::Shader* shader = nullptr);
+	void resetQuadRender(const Quad* quad);
 	void renderQuad(const Quad* quad, float alpha = 1.0f);
+	void renderQuadBatches(const vector<Quad*>& quads, unsigned count, const gl::Shader* shader = nullptr);
 	void renderWalls();
 	void renderTransparentWalls();
 	void renderWallSelection(const ItemSelection& selection, float alpha = 1.0f);
@@ -184,15 +195,24 @@ public:
 	// VBO stuff
 	void updateFlatsVBO();
 	void updateWallsVBO() const;
+	bool allocFlatsVBORange(unsigned size, unsigned& offset);
+	void freeFlatsVBORange(unsigned offset, unsigned size);
 
 	// Visibility checking
+	bool  isLineStale(unsigned index) const;
+	bool  updateTimeUp();
 	void  quickVisDiscard();
+	void  floodSectorVisibility();
 	float calcDistFade(double distance, double max = -1) const;
 	void  checkVisibleQuads();
 	void  checkVisibleFlats();
 
 	// Hilight
 	mapeditor::Item determineHilight();
+	void            rayTestWallsAndFlats(mapeditor::Item& current, double& min_dist) const;
+	bool            pickingEnabled() const;
+	void            renderPickBuffer();
+	void            readPickBuffer();
 	void            renderHilight(mapeditor::Item hilight, float alpha = 1.0f);
 
 private:
@@ -208,7 +228,20 @@ private:
 	float     fog_depth_last_ = 0.f;
 
 	// Visibility
-	vector<float> dist_sectors_;
+	struct ViewRange
+	{
+		double min     = 0.;
+		double max     = 0.;
+		bool   reached = false;
+	};
+	vector<float>     dist_sectors_;
+	vector<ViewRange> vis_ranges_;
+	float             view_aspect_ = 1.f;
+	float             view_far_    = 20000.f;
+
+	// Geometry updates
+	long update_deadline_ = 0;
+	bool updates_pending_ = false;
 
 	// Camera
 	Vec3d  cam_position_;
@@ -228,25 +261,92 @@ private:
 	vector<vector<Flat>> sector_flats_;
 	vector<Flat*>        flats_;
 
+	// Things in range/drawn and their sprite quads (rebuilt each frame, see renderThings)
+	vector<MapThing*> things_in_range_;
+	vector<unsigned>  things_drawn_;
+	vector<Quad>      thing_quads_;
+	vector<Quad*>     thing_quad_list_;
+
+	// Batching
+	struct WallVertex
+	{
+		float x, y, z;
+		float tx, ty, layer;
+		float r, g, b, a;
+		float fog_r, fog_g, fog_b, fog_depth;
+	};
+	vector<WallVertex> wall_vertices_;
+	vector<int>        batch_first_;
+	vector<int>        batch_count_;
+
+	// Shader programs (GL 3.3 path)
+	enum class ShaderType
+	{
+		Walls,
+		Flats,
+	};
+	std::unique_ptr<gl::Shader> shaders_[2];
+
+	const gl::Shader* bindShader(ShaderType type);
+
 	// VBOs
-	unsigned vbo_flats_ = 0;
-	unsigned vbo_walls_ = 0;
+	unsigned     vbo_flats_         = 0;
+	unsigned     vbo_walls_         = 0;
+	mutable bool vbo_flats_rebuild_ = false;
+
+	// Flats VBO allocation. Each sector's flats are stored together in a
+	// range of the VBO, which is reused while the sector's polygon data still
+	// fits in it, or moved to a free range (or the unused end of the buffer)
+	struct VBORange
+	{
+		unsigned offset = 0;
+		unsigned size   = 0;
+	};
+	vector<VBORange> vbo_flats_sectors_;  // Range allocated to each sector
+	vector<VBORange> vbo_flats_free_;     // Unused ranges, sorted by offset
+	unsigned         vbo_flats_size_ = 0; // Allocated size of the buffer
+	unsigned         vbo_flats_end_  = 0; // End of the used part of the buffer
+
+	// GPU picking (see renderPickBuffer)
+	struct PickVertex
+	{
+		float   x, y, z;
+		uint8_t r, g, b, a;
+	};
+	unsigned                pick_fbo_        = 0;
+	unsigned                pick_rb_colour_  = 0;
+	unsigned                pick_rb_depth_   = 0;
+	unsigned                pick_pbo_        = 0;
+	bool                    pick_failed_     = false;
+	bool                    pick_pending_    = false; // Readback of the last pick pass not yet read
+	float                   pick_far_        = 0.f;   // Far clip distance of the last pick pass
+	vector<mapeditor::Item> pick_items_;              // Items in the last pick pass (by id - 1)
+	vector<PickVertex>      pick_vertices_[2];        // Culled/double-sided wall vertices
+	mapeditor::Item         pick_item_;
+	double                  pick_dist_ = -1.;
+	Vec3d                   pick_cam_position_;
+	Vec3d                   pick_cam_dir_;
 
 	// Sky
-	struct GLVertexEx
+	struct SkyVertex
 	{
-		float x = 0.f, y = 0.f, z = 0.f;
-		float tx = 0.f, ty = 0.f;
-		float alpha = 1.f;
+		float x, y, z;
+		float tx, ty;
+		float r, g, b, a;
 	};
-	string  skytex1_ = "SKY1";
-	string  skytex2_;
-	ColRGBA skycol_top_;
-	ColRGBA skycol_bottom_;
-	Vec2d   sky_circle_[32];
+	string            skytex1_ = "SKY1";
+	string            skytex2_;
+	ColRGBA           skycol_top_;
+	ColRGBA           skycol_bottom_;
+	Vec2d             sky_circle_[32];
+	vector<SkyVertex> sky_vertices_;    // Sky geometry, relative to the camera (see updateSkyVBO)
+	unsigned          sky_texture_ = 0; // Texture the sky geometry was built for
+	unsigned          vbo_sky_     = 0;
 
 	// Signal connections
 	sigslot::scoped_connection sc_resources_updated_;
 	sigslot::scoped_connection sc_palette_changed_;
+	sigslot::scoped_connection sc_textures_loaded_;
+	sigslot::scoped_connection sc_textures_unloaded_;
 };
 } // namespace slade
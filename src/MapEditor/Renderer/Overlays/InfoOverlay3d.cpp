@@ -54,6 +54,7 @@ using namespace slade;
 //
 // -----------------------------------------------------------------------------
 EXTERN_CVAR(Bool, use_zeth_icons)
+EXTERN_CVAR(Int, map_tex_memory_budget_mb)
 
 
 // -----------------------------------------------------------------------------
@@ -472,7 +473,7 @@ void InfoOverlay3D::update(mapeditor::Item item, SLADEMap* map)
 
 
 		// Type
-		auto& tt = game::configuration().thingType(thing->type());
+		auto& tt = thing->typeDef();
 		if (!tt.defined())
 			info2_.push_back(fmt::format("Type: {}", thing->type()));
 		else
@@ -518,7 +519,16 @@ void InfoOverlay3D::update(mapeditor::Item item, SLADEMap* map)
 		texname_ = "";
 	}
 
-	last_update_ = app::runTimer();
+	// Texture name (truncated)
+	texlabel_ = texname_;
+	if (texlabel_.size() > 8)
+	{
+		strutil::truncateIP(texlabel_, 8);
+		texlabel_.append("...");
+	}
+
+	unload_count_ = mapeditor::textureManager().unloadCount();
+	last_update_  = app::runTimer();
 }
 
 // -----------------------------------------------------------------------------
@@ -536,7 +546,8 @@ void InfoOverlay3D::draw(int bottom, int right, int middle, float alpha)
 
 	// Update if needed
 	if (object_
-		&& (object_->modifiedTime() > last_update_ || // object_ updated
+		&& (object_->modifiedTime() > last_update_ ||                       // object_ updated
+			unload_count_ != mapeditor::textureManager().unloadCount() || // texture unloaded
 			(object_->objType() == MapObject::Type::Side
 			 && (dynamic_cast<MapSide*>(object_)->parentLine()->modifiedTime() > last_update_ || // parent line updated
 				 dynamic_cast<MapSide*>(object_)->sector()->modifiedTime() > last_update_)))) // parent sector updated
@@ -594,6 +605,23 @@ void InfoOverlay3D::draw(int bottom, int right, int middle, float alpha)
 	// Draw texture if any
 	drawTexture(alpha, middle - (40 * scale), bottom);
 
+	// Draw map texture memory usage (bottom right)
+	auto memory_used = mapeditor::textureManager().memoryUsed();
+	if (memory_used != memory_text_used_ || map_tex_memory_budget_mb.value != memory_text_budget_)
+	{
+		memory_text_used_   = memory_used;
+		memory_text_budget_ = map_tex_memory_budget_mb.value;
+		memory_text_        = fmt::format(
+			"Texture memory: {:1.1f}mb/{}mb", memory_used / (1024.0 * 1024.0), memory_text_budget_);
+	}
+	drawing::drawText(
+		memory_text_,
+		right - 4,
+		bottom - line_height - 2,
+		col_fg,
+		drawing::Font::Condensed,
+		drawing::Align::Right);
+
 	// Done
 	glEnable(GL_LINE_SMOOTH);
 }
@@ -629,6 +657,7 @@ void InfoOverlay3D::drawTexture(float alpha, int x, int y) const
 			gl::setColour(255, 255, 255, 255 * alpha, gl::Blend::Normal);
 			drawing::drawTextureWithin(
 				texture_, x, y - tex_box_size - line_height, x + tex_box_size, y - line_height, 0);
+			mapeditor::textureManager().markUsed(texture_);
 		}
 		else if (texname_ == "-")
 		{
@@ -659,14 +688,8 @@ void InfoOverlay3D::drawTexture(float alpha, int x, int y) const
 	}
 
 	// Draw texture name (even if texture is blank)
-	auto tn_truncated = texname_;
-	if (tn_truncated.size() > 8)
-	{
-		strutil::truncateIP(tn_truncated, 8);
-		tn_truncated.append("...");
-	}
 	drawing::drawText(
-		tn_truncated,
+		texlabel_,
 		x + (tex_box_size * 0.5),
 		y - line_height,
 		col_fg,
@@ -32,5 +32,13 @@ private:
 	bool                thing_icon_  = false;
 	MapObject*          object_      = nullptr;
 	long                last_update_ = 0;
+
+	string   texlabel_;         // Texture name shown under the texture box
+	unsigned unload_count_ = 0; // Texture manager unload count at the last update
+
+	// Texture memory usage text, rebuilt when the usage or budget changes
+	string memory_text_;
+	size_t memory_text_used_   = -1;
+	int    memory_text_budget_ = 0;
 };
 } // namespace slade
@@ -33,6 +33,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "LineInfoOverlay.h"
+#include "App.h"
 #include "Game/Configuration.h"
 #include "General/ColourConfiguration.h"
 #include "MapEditor/MapEditContext.h"
@@ -43,6 +44,7 @@
 #include "OpenGL/OpenGL.h"
 #include "SLADEMap/MapObject/MapLine.h"
 #include "SLADEMap/MapObject/MapSide.h"
+#include "SLADEMap/SLADEMap.h"
 #include "Utility/MathStuff.h"
 #include "Utility/StringUtils.h"
 
@@ -73,7 +75,14 @@ void LineInfoOverlay::update(MapLine* line)
 	if (!line)
 		return;
 
-	// info.clear();
+	// Nothing to do if nothing in the map has changed since the last update
+	// for this line
+	if (line == line_ && line->parentMap()->lastChanged() < updated_)
+		return;
+
+	line_    = line;
+	updated_ = app::runTimer();
+
 	string info_text;
 	auto   map_format = mapeditor::editContext().mapDesc().format;
 
@@ -123,6 +132,21 @@ void LineInfoOverlay::update(MapLine* line)
 	// Check needed textures
 	int needed_tex = line->needsTexture();
 
+	// Sets up side texture [tex] for texture [name] at [pos]
+	auto set_texture = [](Texture& tex, const string& name, bool needed, string_view pos)
+	{
+		tex.name      = name;
+		tex.needed    = needed;
+		tex.looked_up = false;
+
+		if (needed && name == MapSide::TEX_NONE)
+			tex.label = fmt::format("{}:MISSING", pos);
+		else if (name.size() > 8)
+			tex.label = fmt::format("{}:{}...", pos, name.substr(0, 8));
+		else
+			tex.label = fmt::format("{}:{}", pos, name);
+	};
+
 	// Front side
 	auto s = line->s1();
 	if (s)
@@ -134,12 +158,9 @@ void LineInfoOverlay::update(MapLine* line)
 		else
 			side_front_.info = fmt::format("Front Side #{} (Sector {})", s->index(), s->sector()->index());
 		side_front_.offsets      = fmt::format("Offsets: ({}, {})", s->texOffsetX(), s->texOffsetY());
-		side_front_.tex_upper    = s->texUpper();
-		side_front_.tex_middle   = s->texMiddle();
-		side_front_.tex_lower    = s->texLower();
-		side_front_.needs_lower  = ((needed_tex & MapLine::Part::FrontLower) > 0);
-		side_front_.needs_middle = ((needed_tex & MapLine::Part::FrontMiddle) > 0);
-		side_front_.needs_upper  = ((needed_tex & MapLine::Part::FrontUpper) > 0);
+		set_texture(side_front_.tex_upper, s->texUpper(), needed_tex & MapLine::Part::FrontUpper, "U");
+		set_texture(side_front_.tex_middle, s->texMiddle(), needed_tex & MapLine::Part::FrontMiddle, "M");
+		set_texture(side_front_.tex_lower, s->texLower(), needed_tex & MapLine::Part::FrontLower, "L");
 	}
 	else
 		side_front_.exists = false;
@@ -155,12 +176,9 @@ void LineInfoOverlay::update(MapLine* line)
 		else
 			side_back_.info = fmt::format("Back Side #{} (Sector {})", s->index(), s->sector()->index());
 		side_back_.offsets      = fmt::format("Offsets: ({}, {})", s->texOffsetX(), s->texOffsetY());
-		side_back_.tex_upper    = s->texUpper();
-		side_back_.tex_middle   = s->texMiddle();
-		side_back_.tex_lower    = s->texLower();
-		side_back_.needs_lower  = ((needed_tex & MapLine::Part::BackLower) > 0);
-		side_back_.needs_middle = ((needed_tex & MapLine::Part::BackMiddle) > 0);
-		side_back_.needs_upper  = ((needed_tex & MapLine::Part::BackUpper) > 0);
+		set_texture(side_back_.tex_upper, s->texUpper(), needed_tex & MapLine::Part::BackUpper, "U");
+		set_texture(side_back_.tex_middle, s->texMiddle(), needed_tex & MapLine::Part::BackMiddle, "M");
+		set_texture(side_back_.tex_lower, s->texLower(), needed_tex & MapLine::Part::BackLower, "L");
 	}
 	else
 		side_back_.exists = false;
@@ -264,23 +282,17 @@ void LineInfoOverlay::drawSide(int bottom, int right, float alpha, Side& side, i
 
 	// Textures
 	int tex_box_size = 80 * scale_;
-	drawTexture(alpha, xstart + 4, bottom - (32 * scale_), side.tex_upper, side.needs_upper);
-	drawTexture(alpha, xstart + tex_box_size + 8, bottom - (32 * scale_), side.tex_middle, side.needs_middle, "M");
-	drawTexture(
-		alpha,
-		xstart + tex_box_size + 12 + tex_box_size,
-		bottom - (32 * scale_),
-		side.tex_lower,
-		side.needs_lower,
-		"L");
+	drawTexture(alpha, xstart + 4, bottom - (32 * scale_), side.tex_upper);
+	drawTexture(alpha, xstart + tex_box_size + 8, bottom - (32 * scale_), side.tex_middle);
+	drawTexture(alpha, xstart + tex_box_size + 12 + tex_box_size, bottom - (32 * scale_), side.tex_lower);
 }
 
 // -----------------------------------------------------------------------------
 // Draws a texture box with name underneath for [texture]
 // -----------------------------------------------------------------------------
-void LineInfoOverlay::drawTexture(float alpha, int x, int y, string_view texture, bool needed, string_view pos) const
+void LineInfoOverlay::drawTexture(float alpha, int x, int y, Texture& texture)
 {
-	bool required     = (needed && texture == MapSide::TEX_NONE);
+	bool required     = (texture.needed && texture.name == MapSide::TEX_NONE);
 	int  tex_box_size = 80 * scale_;
 	int  line_height  = 16 * scale_;
 
@@ -288,13 +300,19 @@ void LineInfoOverlay::drawTexture(float alpha, int x, int y, string_view texture
 	ColRGBA col_fg = colourconfig::colour("map_overlay_foreground");
 	col_fg.a       = col_fg.a * alpha;
 
-	// Get texture
-	auto tex = mapeditor::textureManager()
-				   .texture(texture, game::configuration().featureSupported(game::Feature::MixTexFlats))
-				   .gl_id;
+	// Get texture (if it isn't already)
+	auto& tex_manager = mapeditor::textureManager();
+	if (!texture.looked_up || texture.unload_count != tex_manager.unloadCount())
+	{
+		auto mixed           = game::configuration().featureSupported(game::Feature::MixTexFlats);
+		texture.gl_id        = tex_manager.texture(texture.name, mixed).gl_id;
+		texture.unload_count = tex_manager.unloadCount();
+		texture.looked_up    = true;
+	}
+	auto tex = texture.gl_id;
 
 	// Valid texture
-	if (texture != MapSide::TEX_NONE && tex != gl::Texture::missingTexture())
+	if (texture.name != MapSide::TEX_NONE && tex != gl::Texture::missingTexture())
 	{
 		// Draw background
 		glEnable(GL_TEXTURE_2D);
@@ -317,10 +335,10 @@ void LineInfoOverlay::drawTexture(float alpha, int x, int y, string_view texture
 	}
 
 	// Unknown texture
-	else if (tex == gl::Texture::missingTexture() && texture != MapSide::TEX_NONE)
+	else if (tex == gl::Texture::missingTexture() && texture.name != MapSide::TEX_NONE)
 	{
 		// Draw unknown icon
-		auto icon = mapeditor::textureManager().editorImage("thing/unknown").gl_id;
+		auto icon = tex_manager.editorImage("thing/unknown").gl_id;
 		glEnable(GL_TEXTURE_2D);
 		gl::setColour(180, 0, 0, 255 * alpha, gl::Blend::Normal);
 		drawing::drawTextureWithin(icon, x, y - tex_box_size - line_height, x + tex_box_size, y - line_height, 0, 0.15);
@@ -333,7 +351,7 @@ void LineInfoOverlay::drawTexture(float alpha, int x, int y, string_view texture
 	else if (required)
 	{
 		// Draw missing icon
-		auto icon = mapeditor::textureManager().editorImage("thing/minus").gl_id;
+		auto icon = tex_manager.editorImage("thing/minus").gl_id;
 		glEnable(GL_TEXTURE_2D);
 		gl::setColour(180, 0, 0, 255 * alpha, gl::Blend::Normal);
 		drawing::drawTextureWithin(icon, x, y - tex_box_size - line_height, x + tex_box_size, y - line_height, 0, 0.15);
@@ -343,14 +361,11 @@ void LineInfoOverlay::drawTexture(float alpha, int x, int y, string_view texture
 	}
 
 	// Draw texture name (even if texture is blank)
-	string tex_str;
-	if (required)
-		tex_str = fmt::format("{}:MISSING", pos);
-	else if (texture.size() > 8)
-		tex_str = fmt::format("{}:{}...", pos, texture.substr(0, 8));
-	else
-		tex_str = fmt::format("{}:{}", pos, texture);
-
 	drawing::drawText(
-		tex_str, x + (tex_box_size * 0.5), y - line_height, col_fg, drawing::Font::Condensed, drawing::Align::Center);
+		texture.label,
+		x + (tex_box_size * 0.5),
+		y - line_height,
+		col_fg,
+		drawing::Font::Condensed,
+		drawing::Align::Center);
 }
@@ -14,28 +14,41 @@ public:
 
 	void update(MapLine* line);
 	void draw(int bottom, int right, float alpha = 1.0f);
+	void reset() { line_ = nullptr; }
 
 private:
-	double  scale_ = 1.;
-	TextBox text_box_;
-	int     last_size_ = 100;
+	double         scale_ = 1.;
+	TextBox        text_box_;
+	int            last_size_ = 100;
+	const MapLine* line_      = nullptr; // Line the info is for
+	long           updated_   = 0;       // Time the info was last updated
+
+	// A side texture shown in the overlay. The gl texture is looked up when
+	// first drawn, and again only if the texture manager has unloaded any
+	// textures
+	struct Texture
+	{
+		string   name;
+		string   label; // Shown under the texture box
+		bool     needed       = false;
+		unsigned gl_id        = 0;
+		unsigned unload_count = 0; // Texture manager unload count at lookup
+		bool     looked_up    = false;
+	};
 
 	struct Side
 	{
-		bool   exists;
-		string info;
-		string offsets;
-		string tex_upper;
-		string tex_middle;
-		string tex_lower;
-		bool   needs_upper;
-		bool   needs_middle;
-		bool   needs_lower;
+		bool    exists;
+		string  info;
+		string  offsets;
+		Texture tex_upper;
+		Texture tex_middle;
+		Texture tex_lower;
 	};
 	Side side_front_{};
 	Side side_back_{};
 
 	void drawSide(int bottom, int right, float alpha, Side& side, int xstart = 0);
-	void drawTexture(float alpha, int x, int y, string_view texture, bool needed, string_view pos = "U") const;
+	void drawTexture(float alpha, int x, int y, Texture& texture);
 };
 } // namespace slade
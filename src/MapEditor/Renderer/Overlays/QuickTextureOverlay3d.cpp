@@ -120,13 +120,13 @@ QuickTextureOverlay3d::QuickTextureOverlay3d(MapEditContext* editor) : MCOverlay
 
 				if (map_format == MapFormat::UDMF && game::configuration().featureSupported(game::Feature::LongNames)
 					&& !strutil::equalCI(tex_info.short_name, tex_info.long_name))
-					tex_names.push_back(tex_info.long_name);
+					tex_names.emplace_back(tex_info.long_name);
 
 				if (skip)
 					continue;
 
 				if (map_format == MapFormat::UDMF || tex_info.short_name.size() <= 8)
-					tex_names.push_back(tex_info.short_name);
+					tex_names.emplace_back(tex_info.short_name);
 			}
 		}
 		if (sel_flats_)
@@ -145,13 +145,13 @@ QuickTextureOverlay3d::QuickTextureOverlay3d(MapEditContext* editor) : MCOverlay
 
 				if (map_format == MapFormat::UDMF && game::configuration().featureSupported(game::Feature::LongNames)
 					&& !strutil::equalCI(tex_info.short_name, tex_info.long_name))
-					tex_names.push_back(tex_info.long_name);
+					tex_names.emplace_back(tex_info.long_name);
 
 				if (skip)
 					continue;
 
 				if (map_format == MapFormat::UDMF || tex_info.short_name.size() <= 8)
-					tex_names.push_back(tex_info.short_name);
+					tex_names.emplace_back(tex_info.short_name);
 			}
 		}
 		std::sort(tex_names.begin(), tex_names.end());
@@ -33,6 +33,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "SectorInfoOverlay.h"
+#include "App.h"
 #include "Game/Configuration.h"
 #include "General/ColourConfiguration.h"
 #include "MapEditor/MapEditor.h"
@@ -40,6 +41,7 @@
 #include "OpenGL/Drawing.h"
 #include "OpenGL/OpenGL.h"
 #include "SLADEMap/MapObject/MapSector.h"
+#include "SLADEMap/SLADEMap.h"
 
 using namespace slade;
 
@@ -67,6 +69,14 @@ void SectorInfoOverlay::update(MapSector* sector)
 	if (!sector)
 		return;
 
+	// Nothing to do if nothing in the map has changed since the last update
+	// for this sector
+	if (sector == sector_ && sector->parentMap()->lastChanged() < updated_)
+		return;
+
+	sector_  = sector;
+	updated_ = app::runTimer();
+
 	string info_text;
 
 	// Info (index + type)
@@ -88,8 +98,14 @@ void SectorInfoOverlay::update(MapSector* sector)
 	info_text += fmt::format("Tag: {}", sector->tag());
 
 	// Textures
-	ftex_ = sector->floor().texture;
-	ctex_ = sector->ceiling().texture;
+	auto set_texture = [](Texture& tex, const string& name, string_view pos)
+	{
+		tex.name      = name;
+		tex.label     = fmt::format("{}:{}", pos, name.size() > 8 ? name.substr(0, 8) : name);
+		tex.looked_up = false;
+	};
+	set_texture(ftex_, sector->floor().texture, "F");
+	set_texture(ctex_, sector->ceiling().texture, "C");
 
 	// Setup text box
 	text_box_->setText(info_text);
@@ -140,10 +156,10 @@ void SectorInfoOverlay::draw(int bottom, int right, float alpha)
 	text_box_->draw(2, bottom - height, col_fg);
 
 	// Ceiling texture
-	drawTexture(alpha, right - tex_box_size - 8, bottom - 4, ctex_, "C");
+	drawTexture(alpha, right - tex_box_size - 8, bottom - 4, ctex_);
 
 	// Floor texture
-	drawTexture(alpha, right - (tex_box_size * 2) - 20, bottom - 4, ftex_, "F");
+	drawTexture(alpha, right - (tex_box_size * 2) - 20, bottom - 4, ftex_);
 
 	// Done
 	glEnable(GL_LINE_SMOOTH);
@@ -152,7 +168,7 @@ void SectorInfoOverlay::draw(int bottom, int right, float alpha)
 // -----------------------------------------------------------------------------
 // Draws a texture box with name underneath for [texture]
 // -----------------------------------------------------------------------------
-void SectorInfoOverlay::drawTexture(float alpha, int x, int y, string_view texture, string_view pos) const
+void SectorInfoOverlay::drawTexture(float alpha, int x, int y, Texture& texture)
 {
 	double scale        = (drawing::fontSize() / 12.0);
 	int    tex_box_size = 80 * scale;
@@ -163,13 +179,19 @@ void SectorInfoOverlay::drawTexture(float alpha, int x, int y, string_view textu
 	auto col_fg = colourconfig::colour("map_overlay_foreground");
 	col_fg.a    = col_fg.a * alpha;
 
-	// Get texture
-	auto tex = mapeditor::textureManager()
-				   .flat(texture, game::configuration().featureSupported(game::Feature::MixTexFlats))
-				   .gl_id;
+	// Get texture (if it isn't already)
+	auto& tex_manager = mapeditor::textureManager();
+	if (!texture.looked_up || texture.unload_count != tex_manager.unloadCount())
+	{
+		auto mixed           = game::configuration().featureSupported(game::Feature::MixTexFlats);
+		texture.gl_id        = tex_manager.flat(texture.name, mixed).gl_id;
+		texture.unload_count = tex_manager.unloadCount();
+		texture.looked_up    = true;
+	}
+	auto tex = texture.gl_id;
 
 	// Valid texture
-	if (texture != "-" && tex != gl::Texture::missingTexture())
+	if (texture.name != "-" && tex != gl::Texture::missingTexture())
 	{
 		// Draw background
 		glEnable(GL_TEXTURE_2D);
@@ -195,7 +217,7 @@ void SectorInfoOverlay::drawTexture(float alpha, int x, int y, string_view textu
 	else if (tex == gl::Texture::missingTexture())
 	{
 		// Draw unknown icon
-		auto icon = mapeditor::textureManager().editorImage("thing/unknown").gl_id;
+		auto icon = tex_manager.editorImage("thing/unknown").gl_id;
 		glEnable(GL_TEXTURE_2D);
 		gl::setColour(180, 0, 0, 255 * alpha, gl::Blend::Normal);
 		drawing::drawTextureWithin(icon, x, y - tex_box_size - line_height, x + tex_box_size, y - line_height, 0, 0.15);
@@ -205,7 +227,11 @@ void SectorInfoOverlay::drawTexture(float alpha, int x, int y, string_view textu
 	}
 
 	// Draw texture name
-	auto tex_name = fmt::format("{}:{}", pos, texture.size() > 8 ? texture.substr(0, 8) : texture);
 	drawing::drawText(
-		tex_name, x + (tex_box_size * 0.5), y - line_height, col_fg, drawing::Font::Condensed, drawing::Align::Center);
+		texture.label,
+		x + (tex_box_size * 0.5),
+		y - line_height,
+		col_fg,
+		drawing::Font::Condensed,
+		drawing::Align::Center);
 }
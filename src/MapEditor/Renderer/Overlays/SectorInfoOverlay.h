@@ -13,13 +13,27 @@ public:
 
 	void update(MapSector* sector);
 	void draw(int bottom, int right, float alpha = 1.0f);
+	void reset() { sector_ = nullptr; }
 
 private:
+	// A flat shown in the overlay. The gl texture is looked up when first
+	// drawn, and again only if the texture manager has unloaded any textures
+	struct Texture
+	{
+		string   name;
+		string   label; // Shown under the texture box
+		unsigned gl_id        = 0;
+		unsigned unload_count = 0; // Texture manager unload count at lookup
+		bool     looked_up    = false;
+	};
+
 	unique_ptr<TextBox> text_box_;
-	string              ftex_;
-	string              ctex_;
+	Texture             ftex_;
+	Texture             ctex_;
 	int                 last_size_ = 100;
+	const MapSector*    sector_    = nullptr; // Sector the info is for
+	long                updated_   = 0;       // Time the info was last updated
 
-	void drawTexture(float alpha, int x, int y, string_view texture, string_view pos = "Upper") const;
+	void drawTexture(float alpha, int x, int y, Texture& texture);
 };
 } // namespace slade
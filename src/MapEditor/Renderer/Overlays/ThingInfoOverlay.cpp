@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "ThingInfoOverlay.h"
+#include "App.h"
 #include "Game/Configuration.h"
 #include "General/ColourConfiguration.h"
 #include "MapEditor/MapEditContext.h"
@@ -40,6 +41,7 @@
 #include "OpenGL/Drawing.h"
 #include "OpenGL/OpenGL.h"
 #include "SLADEMap/MapObject/MapThing.h"
+#include "SLADEMap/SLADEMap.h"
 
 using namespace slade;
 
@@ -75,6 +77,14 @@ void ThingInfoOverlay::update(MapThing* thing)
 	if (!thing)
 		return;
 
+	// Nothing to do if nothing in the map has changed since the last update
+	// for this thing
+	if (thing == thing_ && thing->parentMap()->lastChanged() < updated_)
+		return;
+
+	thing_   = thing;
+	updated_ = app::runTimer();
+
 	string info_text;
 	sprite_         = "";
 	translation_    = "";
@@ -83,7 +93,7 @@ void ThingInfoOverlay::update(MapThing* thing)
 	auto map_format = mapeditor::editContext().mapDesc().format;
 
 	// Index + type
-	auto& tt   = game::configuration().thingType(thing->type());
+	auto& tt   = thing->typeDef();
 	auto  type = fmt::format("{} (Type {})", tt.name(), thing->type());
 	if (global::debug)
 		info_text += fmt::format("Thing #{} ({}): {}\n", thing->index(), thing->objId(), type);
@@ -151,11 +161,12 @@ void ThingInfoOverlay::update(MapThing* thing)
 		info_text.pop_back();
 
 	// Set sprite and translation
-	sprite_      = tt.sprite();
-	translation_ = tt.translation();
-	palette_     = tt.palette();
-	icon_        = tt.icon();
-	zeth_icon_   = tt.zethIcon();
+	sprite_           = tt.sprite();
+	translation_      = tt.translation();
+	palette_          = tt.palette();
+	icon_             = tt.icon();
+	zeth_icon_        = tt.zethIcon();
+	sprite_looked_up_ = false;
 
 	// Setup text box
 	text_box_.setText(info_text);
@@ -202,16 +213,10 @@ void ThingInfoOverlay::draw(int bottom, int right, float alpha)
 	text_box_.draw(2, bottom - height, col_fg);
 
 	// Draw sprite
-	bool isicon = false;
-	auto tex    = mapeditor::textureManager().sprite(sprite_, translation_, palette_).gl_id;
-	if (!tex)
-	{
-		if (use_zeth_icons && zeth_icon_ >= 0)
-			tex = mapeditor::textureManager().editorImage(fmt::format("zethicons/zeth{:02d}", zeth_icon_)).gl_id;
-		if (!tex)
-			tex = mapeditor::textureManager().editorImage(fmt::format("thing/{}", icon_)).gl_id;
-		isicon = true;
-	}
+	if (!sprite_looked_up_ || sprite_unload_count_ != mapeditor::textureManager().unloadCount())
+		lookupSprite();
+	auto tex    = sprite_tex_;
+	bool isicon = sprite_is_icon_;
 	glEnable(GL_TEXTURE_2D);
 	gl::setColour(255, 255, 255, 255 * alpha, gl::Blend::Normal);
 	if (tex)
@@ -247,3 +252,26 @@ void ThingInfoOverlay::draw(int bottom, int right, float alpha)
 	// Done
 	glEnable(GL_LINE_SMOOTH);
 }
+
+// -----------------------------------------------------------------------------
+// Looks up the sprite texture for the current thing, or its icon if it has no
+// sprite
+// -----------------------------------------------------------------------------
+void ThingInfoOverlay::lookupSprite()
+{
+	auto& tex_manager = mapeditor::textureManager();
+
+	sprite_tex_     = tex_manager.sprite(sprite_, translation_, palette_).gl_id;
+	sprite_is_icon_ = false;
+	if (!sprite_tex_)
+	{
+		if (use_zeth_icons && zeth_icon_ >= 0)
+			sprite_tex_ = tex_manager.editorImage(fmt::format("zethicons/zeth{:02d}", zeth_icon_)).gl_id;
+		if (!sprite_tex_)
+			sprite_tex_ = tex_manager.editorImage(fmt::format("thing/{}", icon_)).gl_id;
+		sprite_is_icon_ = true;
+	}
+
+	sprite_unload_count_ = tex_manager.unloadCount();
+	sprite_looked_up_    = true;
+}
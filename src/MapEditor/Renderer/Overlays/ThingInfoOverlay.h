@@ -15,14 +15,26 @@ public:
 
 	void update(MapThing* thing);
 	void draw(int bottom, int right, float alpha = 1.0f);
+	void reset() { thing_ = nullptr; }
 
 private:
-	string  sprite_;
-	string  translation_;
-	string  palette_;
-	string  icon_;
-	int     zeth_icon_ = -1;
-	TextBox text_box_;
-	int     last_size_ = 100;
+	string          sprite_;
+	string          translation_;
+	string          palette_;
+	string          icon_;
+	int             zeth_icon_ = -1;
+	TextBox         text_box_;
+	int             last_size_ = 100;
+	const MapThing* thing_     = nullptr; // Thing the info is for
+	long            updated_   = 0;       // Time the info was last updated
+
+	// Sprite (or icon) texture, looked up when first drawn and again only if
+	// the texture manager has unloaded any textures
+	unsigned sprite_tex_          = 0;
+	bool     sprite_is_icon_      = false;
+	bool     sprite_looked_up_    = false;
+	unsigned sprite_unload_count_ = 0;
+
+	void lookupSprite();
 };
 } // namespace slade
@@ -33,6 +33,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "VertexInfoOverlay.h"
+#include "App.h"
 #include "General/ColourConfiguration.h"
 #include "OpenGL/Drawing.h"
 #include "OpenGL/OpenGL.h"
@@ -58,8 +59,17 @@ void VertexInfoOverlay::update(MapVertex* vertex)
 	if (!vertex)
 		return;
 
+	// Nothing to do if nothing in the map has changed since the last update
+	// for this vertex
+	auto map = vertex->parentMap();
+	if (vertex == vertex_ && map->lastChanged() < updated_)
+		return;
+
+	vertex_  = vertex;
+	updated_ = app::runTimer();
+
 	info_.clear();
-	bool udmf = vertex->parentMap()->currentFormat() == MapFormat::UDMF;
+	bool udmf = map->currentFormat() == MapFormat::UDMF;
 
 	// Update info string
 	auto pos = vertex->position();
@@ -12,8 +12,11 @@ public:
 
 	void update(MapVertex* vertex);
 	void draw(int bottom, int right, float alpha = 1.0f) const;
+	void reset() { vertex_ = nullptr; }
 
 private:
-	vector<string> info_;
+	vector<string>   info_;
+	const MapVertex* vertex_  = nullptr; // Vertex the info is for
+	long             updated_ = 0;       // Time the info was last updated
 };
 } // namespace slade
@@ -38,8 +38,11 @@
 #include "General/ColourConfiguration.h"
 #include "MapEditor/Edit/LineDraw.h"
 #include "MapEditor/MapEditContext.h"
+#include "MapEditor/MapEditor.h"
+#include "MapEditor/MapTextureManager.h"
 #include "OpenGL/Drawing.h"
 #include "OpenGL/OpenGL.h"
+#include "OpenGL/Profiler.h"
 #include "Overlays/MCOverlay.h"
 #include "Utility/MathStuff.h"
 
@@ -329,9 +332,9 @@ Vec2d Renderer::cameraDir2D() const
 }
 
 // -----------------------------------------------------------------------------
-// Draws the grid
+// Draws the grid over [area] (in map coordinates)
 // -----------------------------------------------------------------------------
-void Renderer::drawGrid() const
+void Renderer::drawGrid(const BBox& area) const
 {
 	// Get grid size
 	int gridsize = context_.gridSize();
@@ -353,11 +356,11 @@ void Renderer::drawGrid() const
 	// Determine smallest grid size to bother drawing
 	int grid_hidelevel = 2.0 / view_.scale();
 
-	// Determine canvas edges in map coordinates
-	int start_x = view_.canvasX(0, true);
-	int end_x   = view_.canvasX(view_.size().x, true);
-	int start_y = view_.canvasY(view_.size().y, true);
-	int end_y   = view_.canvasY(0, true);
+	// Determine area edges
+	int start_x = area.min.x;
+	int end_x   = area.max.x;
+	int start_y = area.min.y;
+	int end_y   = area.max.y;
 
 	// Draw regular grid if it's not too small
 	if (gridsize > grid_hidelevel)
@@ -540,6 +543,7 @@ void Renderer::drawEditorMessages() const
 	auto col_bg = colourconfig::colour("map_editor_message_outline");
 	drawing::setTextState(true);
 	drawing::enableTextStateReset(false);
+	drawing::beginTextBatch();
 
 	// Go through editor messages
 	for (unsigned a = 0; a < context_.numEditorMessages(); a++)
@@ -573,6 +577,7 @@ void Renderer::drawEditorMessages() const
 
 		yoff += 16;
 	}
+	drawing::endTextBatch();
 	drawing::setTextOutline(0);
 	drawing::setTextState(false);
 	drawing::enableTextStateReset(true);
@@ -613,11 +618,13 @@ void Renderer::drawFeatureHelpText() const
 	int yoff = 22;
 	drawing::setTextState(true);
 	drawing::enableTextStateReset(false);
+	drawing::beginTextBatch();
 	for (unsigned a = 1; a < help_lines.size(); a++)
 	{
 		drawing::drawText(help_lines[a], view_.size().x - 2, yoff, col, drawing::Font::Bold, drawing::Align::Right);
 		yoff += 16;
 	}
+	drawing::endTextBatch();
 	drawing::setTextOutline(0);
 	drawing::setTextState(false);
 	drawing::enableTextStateReset(true);
@@ -641,10 +648,12 @@ void Renderer::drawSelectionNumbers() const
 	drawing::enableTextStateReset(false);
 	drawing::setTextState(true);
 	view_.setOverlayCoords(true);
+	drawing::beginTextBatch();
 #if USE_SFML_RENDERWINDOW && ((SFML_VERSION_MAJOR == 2 && SFML_VERSION_MINOR >= 4) || SFML_VERSION_MAJOR > 2)
 	drawing::setTextOutline(1.0f, ColRGBA::BLACK);
 #else
-	if (context_.selection().size() <= map_max_selection_numbers * 0.5)
+	// Outlines are only affordable for large selections when text is batched
+	if (context_.selection().size() <= map_max_selection_numbers * 0.5 || gl::shaderSupport())
 		drawing::setTextOutline(1.0f, ColRGBA::BLACK);
 #endif
 	for (unsigned a = 0; a < selection.size(); a++)
@@ -672,6 +681,7 @@ void Renderer::drawSelectionNumbers() const
 		// Draw text
 		drawing::drawText(fmt::format("{}", a + 1), tp.x, tp.y, col, drawing::Font::Bold);
 	}
+	drawing::endTextBatch();
 	drawing::setTextOutline(0);
 	drawing::enableTextStateReset();
 	drawing::setTextState(false);
@@ -972,16 +982,12 @@ void Renderer::drawAnimations() const
 }
 
 // -----------------------------------------------------------------------------
-// Draws the 2d map
+// Draws the parts of the 2d map that don't change from frame to frame unless
+// the map or view is changed - flats, grid and map objects (depending on mode)
 // -----------------------------------------------------------------------------
-void Renderer::drawMap2d()
+void Renderer::drawStaticMap2d()
 {
-	// Apply the current 2d view
-	view_.apply();
-
-	// Update visibility info if needed
-	if (!renderer_2d_.visOK())
-		renderer_2d_.updateVisibility(view_.visibleRegion().tl, view_.visibleRegion().br);
+	auto mouse_state = context_.input().mouseState();
 
 	// Draw flats if needed
 	gl::setColour(ColRGBA::WHITE, gl::Blend::Normal);
@@ -1005,10 +1011,9 @@ void Renderer::drawMap2d()
 	}
 
 	// Draw grid
-	drawGrid();
+	drawGrid(renderer_2d_.staticLayerArea());
 
 	// --- Draw map (depending on mode) ---
-	auto mouse_state = context_.input().mouseState();
 	gl::resetBlend();
 	if (context_.editMode() == Mode::Vertices)
 	{
@@ -1021,7 +1026,74 @@ void Renderer::drawMap2d()
 			renderer_2d_.renderVertices(0.25f);
 		else
 			renderer_2d_.renderVertices(fade_vertices_);
+	}
+	else if (context_.editMode() == Mode::Lines)
+	{
+		// Lines mode
+		renderer_2d_.renderThings(fade_things_);     // Things
+		renderer_2d_.renderVertices(fade_vertices_); // Vertices
+		renderer_2d_.renderLines(true);              // Lines
+	}
+	else if (context_.editMode() == Mode::Sectors)
+	{
+		// Sectors mode
+		renderer_2d_.renderThings(fade_things_);                 // Things
+		renderer_2d_.renderVertices(fade_vertices_);             // Vertices
+		renderer_2d_.renderLines(line_tabs_always, fade_lines_); // Lines
+	}
+	else if (context_.editMode() == Mode::Things)
+	{
+		// Check if we should force thing angles visible
+		bool force_dir = false;
+		if (mouse_state == Input::MouseState::ThingAngle)
+			force_dir = true;
+
+		// Things mode
+		auto hl_index = context_.hilightItem().index;
+		renderer_2d_.renderVertices(fade_vertices_);                   // Vertices
+		renderer_2d_.renderLines(line_tabs_always, fade_lines_);       // Lines
+		renderer_2d_.renderPointLightPreviews(fade_things_, hl_index); // Point light previews
+		renderer_2d_.renderThings(fade_things_, force_dir);            // Things
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Draws the 2d map
+// -----------------------------------------------------------------------------
+void Renderer::drawMap2d()
+{
+	// Apply the current 2d view
+	view_.apply();
+
+	// Update visibility info if needed
+	if (!renderer_2d_.visOK())
+		renderer_2d_.updateVisibility(view_.visibleRegion().tl, view_.visibleRegion().br);
 
+	// Get render state affecting the static map layer
+	auto                      mouse_state = context_.input().mouseState();
+	MapRenderer2D::LayerState layer_state;
+	layer_state.edit_mode     = static_cast<int>(context_.editMode());
+	layer_state.sector_mode   = static_cast<int>(context_.sectorEditMode());
+	layer_state.mouse_state   = static_cast<int>(mouse_state);
+	layer_state.flat_type     = flat_drawtype;
+	layer_state.grid_size     = context_.gridSize();
+	layer_state.fade_flats    = fade_flats_;
+	layer_state.fade_lines    = fade_lines_;
+	layer_state.fade_vertices = fade_vertices_;
+	layer_state.fade_things   = fade_things_;
+	if (context_.editMode() == Mode::Things)
+		layer_state.hilight = context_.hilightItem().index;
+
+	// Draw the static map layer (flats, grid and map objects), unless the
+	// cached one can be used
+	if (renderer_2d_.beginStaticLayer(view_, layer_state))
+		drawStaticMap2d();
+	renderer_2d_.endStaticLayer(view_);
+
+	// --- Draw selection/hilight (depending on mode) ---
+	gl::resetBlend();
+	if (context_.editMode() == Mode::Vertices)
+	{
 		// Selection if needed
 		if (mouse_state != Input::MouseState::Move && !context_.overlayActive()
 			&& mouse_state != Input::MouseState::ObjectEdit)
@@ -1033,11 +1105,6 @@ void Renderer::drawMap2d()
 	}
 	else if (context_.editMode() == Mode::Lines)
 	{
-		// Lines mode
-		renderer_2d_.renderThings(fade_things_);     // Things
-		renderer_2d_.renderVertices(fade_vertices_); // Vertices
-		renderer_2d_.renderLines(true);              // Lines
-
 		// Selection if needed
 		if (mouse_state != Input::MouseState::Move && !context_.overlayActive()
 			&& mouse_state != Input::MouseState::ObjectEdit)
@@ -1049,11 +1116,6 @@ void Renderer::drawMap2d()
 	}
 	else if (context_.editMode() == Mode::Sectors)
 	{
-		// Sectors mode
-		renderer_2d_.renderThings(fade_things_);                 // Things
-		renderer_2d_.renderVertices(fade_vertices_);             // Vertices
-		renderer_2d_.renderLines(line_tabs_always, fade_lines_); // Lines
-
 		// Selection if needed
 		if (mouse_state != Input::MouseState::Move && !context_.overlayActive()
 			&& mouse_state != Input::MouseState::ObjectEdit)
@@ -1067,18 +1129,6 @@ void Renderer::drawMap2d()
 	}
 	else if (context_.editMode() == Mode::Things)
 	{
-		// Check if we should force thing angles visible
-		bool force_dir = false;
-		if (mouse_state == Input::MouseState::ThingAngle)
-			force_dir = true;
-
-		// Things mode
-		auto hl_index = context_.hilightItem().index;
-		renderer_2d_.renderVertices(fade_vertices_);                   // Vertices
-		renderer_2d_.renderLines(line_tabs_always, fade_lines_);       // Lines
-		renderer_2d_.renderPointLightPreviews(fade_things_, hl_index); // Point light previews
-		renderer_2d_.renderThings(fade_things_, force_dir);            // Things
-
 		// Thing paths
 		renderer_2d_.renderPathedThings(context_.pathedThings());
 
@@ -1089,7 +1139,7 @@ void Renderer::drawMap2d()
 
 		// Hilight if needed
 		if (mouse_state == Input::MouseState::Normal && !context_.overlayActive())
-			renderer_2d_.renderThingHilight(hl_index, anim_flash_level_);
+			renderer_2d_.renderThingHilight(context_.hilightItem().index, anim_flash_level_);
 	}
 
 	// Draw tagged sectors/lines/things if needed
@@ -1109,6 +1159,11 @@ void Renderer::drawMap2d()
 			renderer_2d_.renderTaggingThings(context_.taggingThings(), anim_flash_level_);
 	}
 
+	// Draw live map check problems if needed
+	if (!context_.overlayActive() && mouse_state == Input::MouseState::Normal
+		&& !context_.validator().problems().empty())
+		renderer_2d_.renderProblemMarkers(context_.validator().problems());
+
 	// Draw selection numbers if needed
 	if (!context_.selection().empty() && mouse_state == Input::MouseState::Normal && map_show_selection_numbers)
 		drawSelectionNumbers();
@@ -1228,6 +1283,8 @@ void Renderer::drawMap3d()
 // -----------------------------------------------------------------------------
 void Renderer::draw()
 {
+	gl::profiler::beginFrame();
+
 	// Setup the viewport
 	glViewport(0, 0, view_.size().x, view_.size().y);
 
@@ -1260,13 +1317,19 @@ void Renderer::draw()
 	if (gl::accuracyTweak())
 		glTranslatef(0.375f, 0.375f, 0);
 
-	// Draw current info overlay
-	glDisable(GL_TEXTURE_2D);
-	context_.drawInfoOverlay(view_.size(), anim_info_fade_);
+	{
+		gl::profiler::Scope profile{ "Overlays" };
+
+		// Draw current info overlay (text is batched and drawn on top)
+		glDisable(GL_TEXTURE_2D);
+		drawing::beginTextBatch();
+		context_.drawInfoOverlay(view_.size(), anim_info_fade_);
+		drawing::endTextBatch();
 
-	// Draw current fullscreen overlay
-	if (context_.currentOverlay() && anim_overlay_fade_ > 0.01f)
-		context_.currentOverlay()->draw(view_.size().x, view_.size().y, anim_overlay_fade_);
+		// Draw current fullscreen overlay
+		if (context_.currentOverlay() && anim_overlay_fade_ > 0.01f)
+			context_.currentOverlay()->draw(view_.size().x, view_.size().y, anim_overlay_fade_);
+	}
 
 	// Draw crosshair if 3d mode
 	if (context_.editMode() == Mode::Visual)
@@ -1344,11 +1407,24 @@ void Renderer::draw()
 	// test
 	// Drawing::drawText(fmt::format("Render distance: {:1.2f}", (double)render_max_dist), 0, 100);
 
-	// Editor messages
-	drawEditorMessages();
+	{
+		gl::profiler::Scope profile{ "Text" };
+
+		// Editor messages
+		drawEditorMessages();
+
+		// Help text
+		drawFeatureHelpText();
+	}
+
+	// Render profiler graph
+	gl::profiler::drawOverlay(view_.size().x, view_.size().y);
+
+	// Unload old map textures if over the memory budget (textures rendered this
+	// frame have been marked as used)
+	mapeditor::textureManager().enforceMemoryBudget();
 
-	// Help text
-	drawFeatureHelpText();
+	gl::profiler::endFrame();
 }
 
 namespace
@@ -1655,7 +1731,7 @@ void Renderer::animateSelectionChange(const mapeditor::Item& item, bool selected
 			return;
 
 		// Get thing type
-		auto& tt = game::configuration().thingType(t->type());
+		auto& tt = t->typeDef();
 
 		// Start animation
 		double radius = tt.radius();
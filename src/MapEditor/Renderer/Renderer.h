@@ -17,9 +17,10 @@ namespace mapeditor
 	public:
 		Renderer(MapEditContext& context);
 
-		MapRenderer2D& renderer2D() { return renderer_2d_; }
-		MapRenderer3D& renderer3D() { return renderer_3d_; }
-		gl::View&      view() { return view_; }
+		MapRenderer2D&       renderer2D() { return renderer_2d_; }
+		MapRenderer3D&       renderer3D() { return renderer_3d_; }
+		const MapRenderer3D& renderer3D() const { return renderer_3d_; }
+		gl::View&            view() { return view_; }
 
 		void forceUpdate();
 
@@ -75,7 +76,7 @@ namespace mapeditor
 
 
 		// Drawing
-		void drawGrid() const;
+		void drawGrid(const BBox& area) const;
 		void drawEditorMessages() const;
 		void drawFeatureHelpText() const;
 		void drawSelectionNumbers() const;
@@ -85,6 +86,7 @@ namespace mapeditor
 		void drawPasteLines() const;
 		void drawObjectEdit();
 		void drawAnimations() const;
+		void drawStaticMap2d();
 		void drawMap2d();
 		void drawMap3d();
 
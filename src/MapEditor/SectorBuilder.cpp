@@ -48,71 +48,17 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 namespace
 {
-typedef std::map<MapLine*, int> MapLineSet;
-
 // -----------------------------------------------------------------------------
-// Finds the next adjacent edge to [edge], ie the adjacent edge that creates the
-// smallest angle
+// Returns [angle] wrapped to the range [0, 2pi)
 // -----------------------------------------------------------------------------
-SectorBuilder::Edge nextEdge(SectorBuilder::Edge edge, MapLineSet& visited_lines)
+double wrapAngle(double angle)
 {
-	// Get relevant vertices
-	auto vertex      = edge.line->v2(); // Vertex to be tested
-	auto vertex_prev = edge.line->v1(); // 'Previous' vertex
-	if (!edge.front)
-	{
-		vertex      = edge.line->v1();
-		vertex_prev = edge.line->v2();
-	}
-
-	// Find next connected line with the lowest angle
-	double              min_angle = 2 * math::PI;
-	SectorBuilder::Edge next;
-	for (unsigned a = 0; a < vertex->nConnectedLines(); a++)
-	{
-		auto line = vertex->connectedLine(a);
-
-		// Ignore original line
-		if (line == edge.line)
-			continue;
-
-		// Ignore if zero-length
-		if (line->v1() == line->v2())
-			continue;
-
-		// Get next vertex
-		MapVertex* vertex_next;
-		bool       front = true;
-		if (line->v1() == vertex)
-			vertex_next = line->v2();
-		else
-		{
-			vertex_next = line->v1();
-			front       = false;
-		}
-
-		// Ignore already-traversed lines
-		if (visited_lines[line] & (front ? 1 : 2))
-			continue;
-
-		// Determine angle between lines
-		double angle = math::angle2DRad(
-			{ vertex_prev->xPos(), vertex_prev->yPos() },
-			{ vertex->xPos(), vertex->yPos() },
-			{ vertex_next->xPos(), vertex_next->yPos() });
-
-		// Check if minimum angle
-		if (angle < min_angle)
-		{
-			min_angle  = angle;
-			next.line  = line;
-			next.front = front;
-		}
-	}
+	if (angle < 0)
+		angle += 2 * math::PI;
+	else if (angle >= 2 * math::PI)
+		angle -= 2 * math::PI;
 
-	// Return the next edge found
-	visited_lines[next.line] |= (next.front ? 1 : 2);
-	return next;
+	return angle;
 }
 } // namespace
 
@@ -160,6 +106,98 @@ bool SectorBuilder::edgeSideCreated(unsigned index)
 	return sector_edges_[index].side_created;
 }
 
+// -----------------------------------------------------------------------------
+// Builds the vertex->half-edge adjacency lists for the current map, with the
+// direction angle of each half-edge precomputed. Zero-length lines are left
+// out since they can never be part of an outline
+// -----------------------------------------------------------------------------
+void SectorBuilder::buildAdjacency()
+{
+	auto n_vertices = map_->nVertices();
+	auto n_lines    = map_->nLines();
+
+	// Line angles (v1 -> v2)
+	line_angles_.resize(n_lines);
+	for (unsigned a = 0; a < n_lines; a++)
+	{
+		auto line       = map_->line(a);
+		line_angles_[a] = wrapAngle(atan2(line->y2() - line->y1(), line->x2() - line->x1()));
+	}
+
+	// Outgoing half-edges for each vertex, in connected line order
+	adj_first_.resize(n_vertices + 1);
+	adj_edges_.clear();
+	adj_max_x_ = n_vertices > 0 ? map_->vertex(0)->xPos() : 0.;
+	for (unsigned a = 0; a < n_vertices; a++)
+	{
+		auto vertex   = map_->vertex(a);
+		adj_first_[a] = adj_edges_.size();
+		adj_max_x_    = std::max(adj_max_x_, vertex->xPos());
+
+		for (auto line : vertex->connectedLines())
+		{
+			if (line->v1() == line->v2())
+				continue;
+
+			bool front = line->v1() == vertex;
+			auto angle = line_angles_[line->index()];
+			adj_edges_.push_back({ line, front, front ? angle : wrapAngle(angle + math::PI) });
+		}
+	}
+	adj_first_[n_vertices] = adj_edges_.size();
+
+	visited_lines_.assign(n_lines, 0);
+	adj_map_ = map_;
+}
+
+// -----------------------------------------------------------------------------
+// Finds the next adjacent edge to [edge], ie the adjacent edge that creates the
+// smallest angle
+// -----------------------------------------------------------------------------
+SectorBuilder::Edge SectorBuilder::nextEdge(const Edge& edge)
+{
+	// There is no angle to a zero-length line
+	if (edge.line->v1() == edge.line->v2())
+		return {};
+
+	// Get vertex to be tested and the direction back to the 'previous' vertex
+	auto vertex     = edge.front ? edge.line->v2() : edge.line->v1();
+	auto angle_back = line_angles_[edge.line->index()];
+	if (edge.front)
+		angle_back = wrapAngle(angle_back + math::PI);
+
+	// Find next connected line with the lowest angle
+	double min_angle = 2 * math::PI;
+	Edge   next;
+	auto   v_index = vertex->index();
+	for (auto a = adj_first_[v_index]; a < adj_first_[v_index + 1]; a++)
+	{
+		auto& half_edge = adj_edges_[a];
+
+		// Ignore original line
+		if (half_edge.line == edge.line)
+			continue;
+
+		// Ignore already-traversed lines
+		if (visited_lines_[half_edge.line->index()] & (half_edge.front ? 1 : 2))
+			continue;
+
+		// Check if minimum angle (anticlockwise from the previous vertex)
+		double angle = wrapAngle(half_edge.angle - angle_back);
+		if (angle < min_angle)
+		{
+			min_angle  = angle;
+			next.line  = half_edge.line;
+			next.front = half_edge.front;
+		}
+	}
+
+	// Return the next edge found
+	if (next.line)
+		visited_lines_[next.line->index()] |= (next.front ? 1 : 2);
+	return next;
+}
+
 // -----------------------------------------------------------------------------
 // Traces the sector outline from lines beginning at [line], on either the front
 // or back side ([front])
@@ -175,8 +213,7 @@ bool SectorBuilder::traceOutline(MapLine* line, bool front)
 	o_bbox_.reset();
 	Edge edge(line, front);
 	o_edges_.push_back(edge);
-	double     edge_sum = 0;
-	MapLineSet visited_lines;
+	double edge_sum = 0;
 
 	// Begin tracing
 	vertex_right_ = edge.line->v1();
@@ -195,7 +232,7 @@ bool SectorBuilder::traceOutline(MapLine* line, bool front)
 			vertex_right_ = edge.line->v2();
 
 		// Get next edge
-		Edge edge_next = nextEdge(edge, visited_lines);
+		Edge edge_next = nextEdge(edge);
 		log::info(
 			4,
 			"Got next edge line {}, {}",
@@ -232,9 +269,13 @@ bool SectorBuilder::traceOutline(MapLine* line, bool front)
 	else
 		o_clockwise_ = false;
 
-	// Add outline edges to sector edge list
+	// Add outline edges to sector edge list, and clear the visited flags for
+	// the next outline (only outline lines can have been visited)
 	for (auto o_edge : o_edges_)
+	{
 		sector_edges_.push_back(o_edge);
+		visited_lines_[o_edge.line->index()] = 0;
+	}
 
 	// Trace complete
 	return true;
@@ -346,11 +387,10 @@ SectorBuilder::Edge SectorBuilder::findOuterEdge() const
 	// LOG_DEBUG("Finding outer edge from vertex", vertex_right, "at", vertex_right->point());
 
 	// Fire a ray east from the vertex and find the first line it crosses
-	MapLine* line = nullptr;
-	for (unsigned a = 0; a < map_->nLines(); a++)
+	vector<MapLine*> ray_lines;
+	map_->lines().putAllInArea(vr_x, vr_y, adj_max_x_, vr_y, ray_lines);
+	for (auto line : ray_lines)
 	{
-		line = map_->line(a);
-
 		// Ignore if the line is completely left of the vertex
 		if (line->x1() <= vr_x && line->x2() <= vr_x)
 			continue;
@@ -434,37 +474,17 @@ SectorBuilder::Edge SectorBuilder::findInnerEdge()
 	if (!vertex_right_)
 		return { nullptr };
 
-	// Go through vertex's connected lines, to find
-	// the line with the smallest angle parallel with
-	// the right side of the bbox
-	MapLine* eline     = nullptr;
-	double   min_angle = 999999;
-	for (unsigned a = 0; a < vertex_right_->nConnectedLines(); a++)
+	// Go through vertex's half-edges, to find the one with the smallest angle
+	// parallel with the right side of the bbox
+	const HalfEdge* eline     = nullptr;
+	double          min_angle = 999999;
+	auto            v_index   = vertex_right_->index();
+	for (auto a = adj_first_[v_index]; a < adj_first_[v_index + 1]; a++)
 	{
-		auto line = vertex_right_->connectedLine(a);
-
-		// Ignore if zero-length
-		if (line->v1() == line->v2())
-			continue;
-
-		// Get opposite vertex
-		MapVertex* opposite;
-		if (line->v1() == vertex_right_)
-			opposite = line->v2();
-		else
-			opposite = line->v1();
-
-		// Determine angle
-		double angle = math::angle2DRad(
-			Vec2d(vertex_right_->xPos() + 32, vertex_right_->yPos()),
-			Vec2d(vertex_right_->xPos(), vertex_right_->yPos()),
-			Vec2d(opposite->xPos(), opposite->yPos()));
-
-		// Check if minimum
-		if (angle < min_angle)
+		if (adj_edges_[a].angle < min_angle)
 		{
-			min_angle = angle;
-			eline     = line;
+			min_angle = adj_edges_[a].angle;
+			eline     = &adj_edges_[a];
 		}
 	}
 
@@ -477,11 +497,8 @@ SectorBuilder::Edge SectorBuilder::findInnerEdge()
 		return findInnerEdge();
 	}
 
-	// Determine appropriate side
-	if (vertex_right_ == eline->v1())
-		return { eline, true };
-	else
-		return { eline, false };
+	// Half-edge side is the appropriate side
+	return { eline->line, eline->front };
 }
 
 // -----------------------------------------------------------------------------
@@ -521,40 +538,30 @@ MapSector* SectorBuilder::findCopySector()
 }
 
 // -----------------------------------------------------------------------------
-// Finds any existing sector that is already part of the traced new sector
+// Finds any existing sector that is already part of the traced new sector.
+// Sectors on sides not in [sides_ignore] take priority, and of those the one on
+// the last edge traced is used
 // -----------------------------------------------------------------------------
-MapSector* SectorBuilder::findExistingSector(vector<MapSide*>& sides_ignore)
+MapSector* SectorBuilder::findExistingSector(const std::unordered_set<MapSide*>& sides_ignore)
 {
-	// Go through new sector edges
-	MapSector* sector          = nullptr;
-	MapSector* sector_priority = nullptr;
-	for (auto& edge : sector_edges_)
+	// Go through new sector edges, last first
+	MapSector* sector = nullptr;
+	for (auto edge = sector_edges_.rbegin(); edge != sector_edges_.rend(); ++edge)
 	{
-		// Check if the edge's corresponding MapSide has a front sector
-		if (edge.front && edge.line->frontSector())
-		{
-			// return sector_edges[a].line->frontSector();
-			if (VECTOR_EXISTS(sides_ignore, edge.line->s1()))
-				sector = edge.line->frontSector();
-			else
-				sector_priority = edge.line->frontSector();
-		}
+		// Check if the edge's corresponding MapSide has a sector
+		auto side = edge->front ? edge->line->s1() : edge->line->s2();
+		if (!side || !side->sector())
+			continue;
 
-		// Check if the edge's corresponding MapSide has a back sector
-		if (!edge.front && edge.line->backSector())
-		{
-			// return sector_edges[a].line->backSector();
-			if (VECTOR_EXISTS(sides_ignore, edge.line->s2()))
-				sector = edge.line->backSector();
-			else
-				sector_priority = edge.line->backSector();
-		}
+		// Return it straight away if it isn't ignored
+		if (sides_ignore.count(side) == 0)
+			return side->sector();
+
+		if (!sector)
+			sector = side->sector();
 	}
 
-	if (sector_priority)
-		return sector_priority;
-	else
-		return sector;
+	return sector;
 }
 
 // -----------------------------------------------------------------------------
@@ -607,10 +614,12 @@ bool SectorBuilder::traceSector(SLADEMap* map, MapLine* line, bool front)
 	sector_edges_.clear();
 	error_ = "Unknown error";
 
+	// Build adjacency if this is a different map or its geometry has changed
+	if (adj_map_ != map || adj_first_.size() != map->nVertices() + 1 || line_angles_.size() != map->nLines())
+		buildAdjacency();
+
 	// Create valid vertices list
-	vertex_valid_.clear();
-	for (unsigned a = 0; a < map->nVertices(); a++)
-		vertex_valid_.push_back(true);
+	vertex_valid_.assign(map->nVertices(), true);
 
 	// Find outmost outline
 	for (unsigned a = 0; a < 10000; a++)
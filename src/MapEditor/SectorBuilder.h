@@ -1,5 +1,7 @@
 #pragma once
 
+#include <unordered_set>
+
 namespace slade
 {
 // Forward declarations
@@ -37,7 +39,7 @@ public:
 	Edge       findOuterEdge() const;
 	Edge       findInnerEdge();
 	MapSector* findCopySector();
-	MapSector* findExistingSector(vector<MapSide*>& sides_ignore);
+	MapSector* findExistingSector(const std::unordered_set<MapSide*>& sides_ignore);
 	bool       isValidSector();
 
 	bool traceSector(SLADEMap* map, MapLine* line, bool front = true);
@@ -47,6 +49,14 @@ public:
 	void drawResult();
 
 private:
+	// Outgoing half-edge from a vertex
+	struct HalfEdge
+	{
+		MapLine* line  = nullptr;
+		bool     front = true; // True if the half-edge goes from the line's v1 to v2
+		double   angle = 0.;   // Direction in radians, anticlockwise from east [0, 2pi)
+	};
+
 	vector<bool> vertex_valid_;
 	SLADEMap*    map_ = nullptr;
 	vector<Edge> sector_edges_;
@@ -57,5 +67,17 @@ private:
 	bool         o_clockwise_ = false;
 	BBox         o_bbox_;
 	MapVertex*   vertex_right_ = nullptr;
+
+	// Half-edge adjacency, built once per map and reused for all traces until
+	// the map geometry changes (vertex index -> range of outgoing half-edges)
+	SLADEMap*        adj_map_ = nullptr;
+	vector<unsigned> adj_first_;
+	vector<HalfEdge> adj_edges_;
+	vector<double>   line_angles_;
+	double           adj_max_x_ = 0.;
+	vector<uint8_t>  visited_lines_;
+
+	void buildAdjacency();
+	Edge nextEdge(const Edge& edge);
 };
 } // namespace slade
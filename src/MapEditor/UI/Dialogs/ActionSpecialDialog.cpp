@@ -65,14 +65,22 @@ ActionSpecialTreeView::ActionSpecialTreeView(wxWindow* parent) : wxDataViewTreeC
 	dc.SetFont(GetFont());
 	wxSize textsize;
 
-	// Populate tree
-	for (auto& i : game::configuration().allActionSpecials())
+	// Populate tree from the configuration's (cached) special tree nodes
+	auto&                  nodes = game::configuration().actionSpecialTree();
+	vector<wxDataViewItem> items(nodes.size());
+	for (unsigned a = 0; a < nodes.size(); ++a)
 	{
-		if (!i.second.defined())
+		auto& node   = nodes[a];
+		auto  parent = node.parent < 0 ? root_ : items[node.parent];
+		if (node.special < 0)
+		{
+			items[a] = AppendContainer(parent, wxString::FromUTF8(node.label));
 			continue;
+		}
 
-		wxString label = wxString::Format("%d: %s", i.second.number(), i.second.name());
-		AppendItem(getGroup(i.second.group()), label);
+		wxString label = wxString::FromUTF8(node.label);
+		items[a]       = AppendItem(parent, label);
+		special_items_.emplace(node.special, items[a]);
 		textsize.IncTo(dc.GetTextExtent(label));
 	}
 	Expand(root_);
@@ -117,24 +125,13 @@ void ActionSpecialTreeView::showSpecial(int special, bool focus)
 		return;
 	}
 
-	// Go through item groups
-	for (auto& group : groups_)
+	// Select+show if there is an item for the special
+	if (auto i = special_items_.find(special); i != special_items_.end())
 	{
-		// Go through group items
-		for (int b = 0; b < GetChildCount(group.item); b++)
-		{
-			auto item = GetNthChild(group.item, b);
-
-			// Select+show if match
-			if (specialNumber(item) == special)
-			{
-				EnsureVisible(item);
-				Select(item);
-				if (focus)
-					SetFocus();
-				return;
-			}
-		}
+		EnsureVisible(i->second);
+		Select(i->second);
+		if (focus)
+			SetFocus();
 	}
 }
 
@@ -150,51 +147,6 @@ int ActionSpecialTreeView::selectedSpecial() const
 		return -1;
 }
 
-// -----------------------------------------------------------------------------
-// Returns the parent wxDataViewItem representing action special group [group]
-// -----------------------------------------------------------------------------
-wxDataViewItem ActionSpecialTreeView::getGroup(const wxString& group_name)
-{
-	// Check if group was already made
-	for (auto& group : groups_)
-	{
-		if (group_name == group.name)
-			return group.item;
-	}
-
-	// Split group into subgroups
-	auto path = wxSplit(group_name, '/');
-
-	// Create group needed
-	auto     current  = root_;
-	wxString fullpath = "";
-	for (unsigned p = 0; p < path.size(); p++)
-	{
-		if (p > 0)
-			fullpath += "/";
-		fullpath += path[p];
-
-		bool found = false;
-		for (auto& group : groups_)
-		{
-			if (group.name == fullpath)
-			{
-				current = group.item;
-				found   = true;
-				break;
-			}
-		}
-
-		if (!found)
-		{
-			current = AppendContainer(current, path[p]);
-			groups_.emplace_back(current, fullpath);
-		}
-	}
-
-	return current;
-}
-
 
 namespace slade
 {
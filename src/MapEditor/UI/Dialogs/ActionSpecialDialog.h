@@ -31,19 +31,10 @@ public:
 	int  selectedSpecial() const;
 
 private:
-	wxDataViewItem root_;
-	wxDataViewItem item_none_;
-	wxDialog*      parent_dialog_ = nullptr;
-
-	struct ASTVGroup
-	{
-		wxString       name;
-		wxDataViewItem item;
-		ASTVGroup(wxDataViewItem i, const wxString& name) : name{ name }, item{ i } {}
-	};
-	vector<ASTVGroup> groups_;
-
-	wxDataViewItem getGroup(const wxString& group_name);
+	wxDataViewItem                root_;
+	wxDataViewItem                item_none_;
+	wxDialog*                     parent_dialog_ = nullptr;
+	std::map<int, wxDataViewItem> special_items_; // Special number -> tree item
 };
 
 class ArgsPanel : public wxScrolled<wxPanel>
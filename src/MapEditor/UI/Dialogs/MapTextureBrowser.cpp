@@ -35,8 +35,11 @@
 #include "Game/Configuration.h"
 #include "General/ResourceManager.h"
 #include "MapEditor/MapEditor.h"
+#include "MapEditor/MapEditContext.h"
 #include "MapEditor/MapTextureManager.h"
+#include "SLADEMap/MapUsageIndex.h"
 #include "SLADEMap/SLADEMap.h"
+#include "UI/WxUtils.h"
 #include "Utility/StringUtils.h"
 
 using namespace slade;
@@ -80,8 +83,12 @@ bool MapTexBrowserItem::loadImage()
 	const MapTextureManager::Texture* tex = nullptr;
 
 	// Get texture or flat depending on type
+	// (composite textures are composed in the background, so may not be ready yet)
 	if (type_ == "texture")
-		tex = &mapeditor::textureManager().texture(name_.ToStdString(), false);
+	{
+		tex      = mapeditor::textureManager().requestTexture(name_.ToStdString());
+		loading_ = !tex;
+	}
 	else if (type_ == "flat")
 		tex = &mapeditor::textureManager().flat(name_.ToStdString(), false);
 
@@ -125,6 +132,8 @@ wxString MapTexBrowserItem::itemInfo()
 
 	// Add usage count
 	info += wxString::Format(", Used %d times", usage_count_);
+	if (global_usage_count_ >= 0)
+		info += wxString::Format(" (%d in all maps)", global_usage_count_);
 
 	return info;
 }
@@ -184,9 +193,11 @@ MapTextureBrowser::MapTextureBrowser(wxWindow* parent, TextureType type, const w
 				continue;
 
 			// Add browser item
+			auto name = wxutil::strFromView(textures[a].short_name);
+			auto path = wxutil::strFromView(textures[a].path);
 			addItem(
-				new MapTexBrowserItem(textures[a].short_name, MapTexBrowserItem::TEXTURE, textures[a].index),
-				determineTexturePath(textures[a].archive, textures[a].category, "Textures", textures[a].path));
+				new MapTexBrowserItem(name, MapTexBrowserItem::TEXTURE, textures[a].index),
+				determineTexturePath(textures[a].archive, textures[a].category, "Textures", path));
 		}
 	}
 
@@ -217,16 +228,17 @@ MapTextureBrowser::MapTextureBrowser(wxWindow* parent, TextureType type, const w
 				continue;
 
 			// Determine tree path
-			wxString flat_path = flats[a].path;
+			wxString flat_path = wxutil::strFromView(flats[a].path);
 			if (flat_path.Lower().StartsWith("flats/"))
 				flat_path = flat_path.substr(6);
 			wxString path = determineTexturePath(flats[a].archive, flats[a].category, "Flats", flat_path);
 
 			// Add browser item
+			auto name = wxutil::strFromView(flats[a].short_name);
 			if (flats[a].category == MapTextureManager::Category::ZDTextures)
-				addItem(new MapTexBrowserItem(flats[a].short_name, MapTexBrowserItem::TEXTURE, flats[a].index), path);
+				addItem(new MapTexBrowserItem(name, MapTexBrowserItem::TEXTURE, flats[a].index), path);
 			else
-				addItem(new MapTexBrowserItem(flats[a].short_name, MapTexBrowserItem::FLAT, flats[a].index), path);
+				addItem(new MapTexBrowserItem(name, MapTexBrowserItem::FLAT, flats[a].index), path);
 		}
 	}
 
@@ -241,9 +253,10 @@ MapTextureBrowser::MapTextureBrowser(wxWindow* parent, TextureType type, const w
 				&& tex.category != MapTextureManager::Category::HiRes && !tex.path.empty() && tex.path != "/")
 			{
 				// Add browser item
+				auto path = wxutil::strFromView(tex.path);
 				addItem(
-					new MapTexBrowserItem(tex.long_name, MapTexBrowserItem::TEXTURE, tex.index),
-					determineTexturePath(tex.archive, tex.category, "Textures (Full Path)", tex.path));
+					new MapTexBrowserItem(wxutil::strFromView(tex.long_name), MapTexBrowserItem::TEXTURE, tex.index),
+					determineTexturePath(tex.archive, tex.category, "Textures (Full Path)", path));
 			}
 		}
 
@@ -255,9 +268,10 @@ MapTextureBrowser::MapTextureBrowser(wxWindow* parent, TextureType type, const w
 			{
 				// Add browser item
 				// fpName.Remove(0, 1); // Remove leading slash
+				auto path = wxutil::strFromView(flat.path);
 				addItem(
-					new MapTexBrowserItem(flat.long_name, MapTexBrowserItem::FLAT, flat.index),
-					determineTexturePath(flat.archive, flat.category, "Textures (Full Path)", flat.path));
+					new MapTexBrowserItem(wxutil::strFromView(flat.long_name), MapTexBrowserItem::FLAT, flat.index),
+					determineTexturePath(flat.archive, flat.category, "Textures (Full Path)", path));
 			}
 		}
 	}
@@ -348,13 +362,38 @@ void MapTextureBrowser::updateUsage() const
 	if (!map_)
 		return;
 
+	// Get the usage index of the archive the map is in, for the usage in all
+	// other maps (the index has the saved version of the current map, so its
+	// usage comes from the map being edited instead)
+	auto&          map_desc    = mapeditor::editContext().mapDesc();
+	auto           head        = map_desc.head.lock();
+	MapUsageIndex* usage_index = nullptr;
+	if (head && head->parent())
+		usage_index = MapUsageIndex::forArchive(*head->parent());
+
+	// Usage in other maps is unknown until the index is up to date
+	if (usage_index)
+	{
+		usage_index->update();
+		if (!usage_index->isReady())
+			usage_index = nullptr;
+	}
+
 	auto& items = canvas_->itemList();
 	for (auto& i : items)
 	{
 		auto item = dynamic_cast<MapTexBrowserItem*>(i);
+		auto name = item->name().ToStdString();
 		if (type_ == TextureType::Texture)
-			item->setUsage(map_->sides().texUsageCount(item->name().ToStdString()));
+			item->setUsage(map_->sides().texUsageCount(name));
 		else
-			item->setUsage(map_->sectors().texUsageCount(item->name().ToStdString()));
+			item->setUsage(map_->sectors().texUsageCount(name));
+
+		if (usage_index)
+		{
+			auto others = type_ == TextureType::Texture ? usage_index->textureUsage(name, map_desc.name) :
+														  usage_index->flatUsage(name, map_desc.name);
+			item->setGlobalUsage(item->usageCount() + static_cast<int>(others));
+		}
 	}
 }
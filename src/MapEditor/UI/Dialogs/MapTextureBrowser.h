@@ -22,10 +22,12 @@ public:
 	wxString itemInfo() override;
 	int      usageCount() const { return usage_count_; }
 	void     setUsage(int count) { usage_count_ = count; }
+	void     setGlobalUsage(int count) { global_usage_count_ = count; }
 
 private:
-	int   usage_count_ = 0;
-	Vec2d scale_       = { 1., 1. };
+	int   usage_count_        = 0;
+	int   global_usage_count_ = -1; // Usage in all maps in the archive, -1 if unknown
+	Vec2d scale_              = { 1., 1. };
 };
 
 class MapTextureBrowser : public BrowserWindow
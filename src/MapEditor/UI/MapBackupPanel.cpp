@@ -34,6 +34,8 @@
 #include "App.h"
 #include "Archive/Formats/WadArchive.h"
 #include "Archive/Formats/ZipArchive.h"
+#include "General/Misc.h"
+#include "SLADEMap/MapPreviewData.h"
 #include "UI/Canvas/MapPreviewCanvas.h"
 #include "UI/Lists/ListView.h"
 #include "UI/WxUtils.h"
@@ -69,6 +71,15 @@ MapBackupPanel::MapBackupPanel(wxWindow* parent) : wxPanel{ parent, -1 }, archiv
 	wxWindowBase::Layout();
 }
 
+// -----------------------------------------------------------------------------
+// MapBackupPanel class destructor
+// -----------------------------------------------------------------------------
+MapBackupPanel::~MapBackupPanel()
+{
+	// Don't show the preview being read (if any) once it's done
+	preview_task_.cancel();
+}
+
 // -----------------------------------------------------------------------------
 // Opens the map backup file for [map_name] in [archive_name] and populates the
 // list
@@ -86,15 +97,37 @@ bool MapBackupPanel::loadBackups(wxString archive_name, const wxString& map_name
 	if (dir_current_ == archive_backups_->rootDir().get() || !dir_current_)
 		return false;
 
+	// Index backups (newest first) from the zip directory info, without
+	// loading any entry data
+	backups_.clear();
+	for (int a = dir_current_->numSubdirs() - 1; a >= 0; a--)
+	{
+		Backup backup;
+		backup.dir = dir_current_->subdirAt(a).get();
+		for (unsigned e = 0; e < backup.dir->numEntries(); e++)
+		{
+			auto entry = backup.dir->entryAt(e);
+			auto crc   = archive_backups_->storedCRC(entry);
+			if (crc == 0 && entry->size() > 0)
+				crc = entry->data().crc();
+
+			backup.size += entry->size();
+			backup.entries.push_back({ entry->name(), entry->size(), crc });
+		}
+		backups_.push_back(std::move(backup));
+	}
+
 	// Populate backups list
 	list_backups_->ClearAll();
 	list_backups_->AppendColumn("Backup Date");
 	list_backups_->AppendColumn("Time");
+	list_backups_->AppendColumn("Size");
+	list_backups_->AppendColumn("Changed");
 
-	int index = 0;
-	for (int a = dir_current_->numSubdirs() - 1; a >= 0; a--)
+	for (unsigned index = 0; index < backups_.size(); ++index)
 	{
-		wxString      timestamp = dir_current_->subdirAt(a)->name();
+		auto&         backup    = backups_[index];
+		wxString      timestamp = backup.dir->name();
 		wxArrayString cols;
 
 		// Date
@@ -104,8 +137,22 @@ bool MapBackupPanel::loadBackups(wxString archive_name, const wxString& map_name
 		wxString time = timestamp.After('_');
 		cols.Add(time.Left(2) + ":" + time.Mid(2, 2) + ":" + time.Right(2));
 
+		// Size
+		cols.Add(misc::sizeAsString(backup.size));
+
+		// Entries changed since the previous backup
+		if (index + 1 < backups_.size())
+		{
+			wxString changed;
+			for (const auto& name : MapBackupManager::changedEntries(backups_[index + 1].entries, backup.entries))
+				changed += (changed.empty() ? "" : ", ") + wxString::FromUTF8(name);
+			cols.Add(changed.empty() ? "None" : changed);
+		}
+		else
+			cols.Add("");
+
 		// Add to list
-		list_backups_->addItem(index++, cols);
+		list_backups_->addItem(index, cols);
 	}
 
 	if (list_backups_->GetItemCount() > 0)
@@ -119,22 +166,50 @@ bool MapBackupPanel::loadBackups(wxString archive_name, const wxString& map_name
 // -----------------------------------------------------------------------------
 void MapBackupPanel::updateMapPreview()
 {
-	// Clear current preview
+	// Clear current preview (and stop reading the previous one)
+	preview_task_.cancel();
 	canvas_map_->clearMap();
+	canvas_map_->Refresh();
 
 	// Check for selection
 	if (list_backups_->selectedItems().IsEmpty())
 		return;
-	int selection = (list_backups_->GetItemCount() - 1) - list_backups_->selectedItems()[0];
+	auto selection = static_cast<unsigned>(list_backups_->selectedItems()[0]);
+	if (selection >= backups_.size())
+		return;
 
 	// Load map data to temporary wad
 	archive_mapdata_ = std::make_unique<WadArchive>();
-	auto dir         = dir_current_->subdirAt(selection);
+	auto dir         = backups_[selection].dir;
 	for (unsigned a = 0; a < dir->numEntries(); a++)
 		archive_mapdata_->addEntry(std::make_shared<ArchiveEntry>(*dir->entryAt(a)), "");
 
-	// Open map preview
-	auto maps = archive_mapdata_->detectMaps();
-	if (!maps.empty())
-		canvas_map_->openMap(maps[0]);
+	auto maps   = archive_mapdata_->detectMaps();
+	auto source = std::make_shared<MapPreviewData::Source>();
+	if (maps.empty() || !MapPreviewData::getSource(maps[0], *source))
+		return;
+
+	// Show the preview straight away if it was read before
+	if (auto data = MapPreviewData::cached(source->key))
+	{
+		canvas_map_->setMap(data);
+		return;
+	}
+
+	// Otherwise read it in the background
+	auto data     = std::make_shared<MapPreviewData>();
+	preview_task_ = tasks::run(
+		[source, data](const tasks::Task&)
+		{
+			if (data->read(*source))
+				MapPreviewData::addToCache(source->key, data);
+			else
+				log::error(data->error());
+		},
+		tasks::Priority::Normal,
+		[this, data](const tasks::Task& task)
+		{
+			if (!task.isCancelled() && data->error().empty())
+				canvas_map_->setMap(data);
+		});
 }
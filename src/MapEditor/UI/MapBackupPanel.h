@@ -1,5 +1,8 @@
 #pragma once
 
+#include "General/Tasks.h"
+#include "MapEditor/MapBackupManager.h"
+
 namespace slade
 {
 class MapPreviewCanvas;
@@ -8,11 +11,17 @@ class ZipArchive;
 class ArchiveDir;
 class ListView;
 
+// Lists the backups of a map and previews the selected one.
+//
+// The list is built from the backup zip's directory alone (entry sizes and
+// CRCs), so no backup data is loaded until a backup is selected. The preview
+// geometry is then read on a background task and kept in the map preview
+// cache, so going back to a backup that was already viewed is instant
 class MapBackupPanel : public wxPanel
 {
 public:
 	MapBackupPanel(wxWindow* parent);
-	~MapBackupPanel() = default;
+	~MapBackupPanel();
 
 	Archive* selectedMapData() const { return archive_mapdata_.get(); }
 
@@ -25,5 +34,17 @@ private:
 	unique_ptr<ZipArchive> archive_backups_;
 	unique_ptr<Archive>    archive_mapdata_;
 	ArchiveDir*            dir_current_ = nullptr;
+
+	// Backups of the current map, newest first (as listed)
+	struct Backup
+	{
+		ArchiveDir*                         dir  = nullptr;
+		unsigned                            size = 0;
+		vector<MapBackupManager::EntryInfo> entries;
+	};
+	vector<Backup> backups_;
+
+	// Background preview read for the selected backup (if any)
+	tasks::Task preview_task_;
 };
 } // namespace slade
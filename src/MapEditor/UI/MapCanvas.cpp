@@ -190,6 +190,7 @@ void MapCanvas::mouseLook3d()
 			if (fabs(xrel) > threshold || fabs(yrel) > threshold)
 			{
 				context_->renderer().renderer3D().cameraLook(xrel, yrel);
+				context_->requestRedraw();
 				mouseToCenter();
 			}
 		}
@@ -259,6 +260,7 @@ void MapCanvas::onSize(wxSizeEvent& e)
 	// Update screen limits
 	const wxSize size = GetSize() * GetContentScaleFactor();
 	context_->renderer().setViewSize(size.x, size.y);
+	context_->requestRedraw();
 
 	e.Skip();
 }
@@ -271,6 +273,7 @@ void MapCanvas::onKeyDown(wxKeyEvent& e)
 	// Send to editor
 	context_->input().updateKeyModifiersWx(e.GetModifiers());
 	context_->input().keyDown(KeyBind::keyName(e.GetKeyCode()));
+	context_->requestRedraw();
 
 	// Testing
 	if (global::debug)
@@ -355,6 +358,7 @@ void MapCanvas::onKeyUp(wxKeyEvent& e)
 	// Send to editor
 	context_->input().updateKeyModifiersWx(e.GetModifiers());
 	context_->input().keyUp(KeyBind::keyName(e.GetKeyCode()));
+	context_->requestRedraw();
 
 	e.Skip();
 }
@@ -369,6 +373,7 @@ void MapCanvas::onMouseDown(wxMouseEvent& e)
 	// Send to editor context
 	bool skip = true;
 	context_->input().updateKeyModifiersWx(e.GetModifiers());
+	context_->requestRedraw();
 	if (e.LeftDown())
 		skip = context_->input().mouseDown(Input::MouseButton::Left);
 	else if (e.LeftDClick())
@@ -409,6 +414,7 @@ void MapCanvas::onMouseUp(wxMouseEvent& e)
 	// Send to editor context
 	bool skip = true;
 	context_->input().updateKeyModifiersWx(e.GetModifiers());
+	context_->requestRedraw();
 	if (e.LeftUp())
 		skip = context_->input().mouseUp(Input::MouseButton::Left);
 	else if (e.RightUp())
@@ -425,7 +431,9 @@ void MapCanvas::onMouseUp(wxMouseEvent& e)
 }
 
 // -----------------------------------------------------------------------------
-// Called when the mouse cursor is moved within the canvas
+// Called when the mouse cursor is moved within the canvas.
+// The new position is handled on the next frame update, so that high polling
+// rate mice don't trigger (eg.) hilight updates for every motion event
 // -----------------------------------------------------------------------------
 void MapCanvas::onMouseMotion(wxMouseEvent& e)
 {
@@ -438,8 +446,8 @@ void MapCanvas::onMouseMotion(wxMouseEvent& e)
 	}
 
 	// Update mouse variables
-	if (!context_->input().mouseMove(e.GetX() * GetContentScaleFactor(), e.GetY() * GetContentScaleFactor()))
-		return;
+	context_->requestRedraw();
+	context_->input().mouseMove(e.GetX() * GetContentScaleFactor(), e.GetY() * GetContentScaleFactor());
 
 	e.Skip();
 }
@@ -461,6 +469,7 @@ void MapCanvas::onMouseWheel(wxMouseEvent& e)
 		return;
 
 	context_->input().mouseWheel(e.GetWheelRotation() > 0, mwheel_rotation);
+	context_->requestRedraw();
 }
 
 // -----------------------------------------------------------------------------
@@ -469,6 +478,7 @@ void MapCanvas::onMouseWheel(wxMouseEvent& e)
 void MapCanvas::onMouseLeave(wxMouseEvent& e)
 {
 	context_->input().mouseLeave();
+	context_->requestRedraw();
 
 	e.Skip();
 }
@@ -532,4 +542,6 @@ void MapCanvas::onFocus(wxFocusEvent& e)
 	}
 	else if (e.GetEventType() == wxEVT_KILL_FOCUS)
 		context_->lockMouse(false);
+
+	context_->requestRedraw();
 }
@@ -33,12 +33,14 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapChecksPanel.h"
+#include "General/Trace.h"
 #include "MapEditor/MapChecks.h"
 #include "MapEditor/MapEditContext.h"
 #include "MapEditor/MapEditor.h"
 #include "SLADEMap/SLADEMap.h"
 #include "UI/WxUtils.h"
 #include "Utility/SFileDialog.h"
+#include <future>
 
 using namespace slade;
 
@@ -332,12 +334,35 @@ void MapChecksPanel::onBtnCheck(wxCommandEvent& e)
 		}
 	}
 
+	// Start any checks that can run in the background, so they run alongside
+	// the checks that need to run on this thread
+	vector<std::future<void>> background_checks(active_checks_.size());
+	for (unsigned a = 0; a < active_checks_.size(); ++a)
+	{
+		if (active_checks_[a]->threadSafe())
+			background_checks[a] = std::async(
+				std::launch::async,
+				[check = active_checks_[a].get()]
+				{
+					TRACE_ZONE("MapCheck", check->progressText());
+					check->doCheck();
+				});
+	}
+
 	// Run checks
-	for (auto& check : active_checks_)
+	for (unsigned a = 0; a < active_checks_.size(); ++a)
 	{
-		// Check
-		updateStatusText(check->progressText());
-		check->doCheck();
+		auto& check = active_checks_[a];
+
+		// Check (or wait for the background check to finish)
+		updateStatusText(fmt::format("{} ({}/{})", check->progressText(), a + 1, active_checks_.size()));
+		if (background_checks[a].valid())
+			background_checks[a].get();
+		else
+		{
+			TRACE_ZONE("MapCheck", check->progressText());
+			check->doCheck();
+		}
 
 		// Add results to list
 		for (unsigned b = 0; b < check->nProblems(); b++)
@@ -49,6 +49,7 @@
 #include "MapEditor/UI/PropsPanel/MapObjectPropsPanel.h"
 #include "MapEditor/UI/ScriptEditorPanel.h"
 #include "MapEditor/UI/ShapeDrawPanel.h"
+#include "SLADEMap/MapUsageIndex.h"
 #include "SLADEWxApp.h"
 #include "Scripting/ScriptManager.h"
 #include "UI/Controls/ConsolePanel.h"
@@ -60,6 +61,7 @@
 #include "UI/SAuiTabArt.h"
 #include "UI/SToolBar/SToolBar.h"
 #include "UI/WxUtils.h"
+#include "Utility/FileUtils.h"
 #include "Utility/SFileDialog.h"
 #include "Utility/Tokenizer.h"
 
@@ -79,6 +81,7 @@ CVAR(Bool, mew_maximized, true, CVar::Flag::Save);
 CVAR(String, nodebuilder_id, "zdbsp", CVar::Flag::Save);
 CVAR(String, nodebuilder_options, "", CVar::Flag::Save);
 CVAR(Bool, save_archive_with_map, true, CVar::Flag::Save);
+CVAR(Bool, map_optimise_order_on_save, false, CVar::Flag::Save);
 
 
 // -----------------------------------------------------------------------------
@@ -89,6 +92,29 @@ CVAR(Bool, save_archive_with_map, true, CVar::Flag::Save);
 EXTERN_CVAR(Int, flat_drawtype);
 
 
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Re-loads [wad] from [filename] after the nodebuilder has been run on it,
+// adding the nodes built to the nodes cache as [cache_key]
+// -----------------------------------------------------------------------------
+void loadBuiltNodes(Archive& wad, const string& filename, const string& cache_key)
+{
+	WadArchive output;
+	if (output.open(filename))
+		nodebuilders::cacheNodes(cache_key, wad, output);
+
+	wad.close();
+	wad.open(filename);
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MapEditorWindow Class Functions
@@ -123,6 +149,9 @@ MapEditorWindow::MapEditorWindow() : STopWindow{ "SLADE", "map" }
 // -----------------------------------------------------------------------------
 MapEditorWindow::~MapEditorWindow()
 {
+	if (node_build_)
+		node_build_->cancel();
+
 	wxAuiManager::GetManager(this)->UnInit();
 }
 
@@ -220,6 +249,7 @@ void MapEditorWindow::setupMenu()
 	SAction::fromId("mapw_saveas")->addToMenu(menu_map);
 	// SAction::fromId("mapw_rename")->addToMenu(menu_map);
 	SAction::fromId("mapw_backup")->addToMenu(menu_map);
+	SAction::fromId("mapw_optimise_order")->addToMenu(menu_map);
 	menu_map->AppendSeparator();
 	SAction::fromId("mapw_run_map")->addToMenu(menu_map);
 	SAction::fromId("mapw_quick_run_map")->addToMenu(menu_map);
@@ -613,6 +643,10 @@ bool MapEditorWindow::openMap(const Archive::MapDesc& map)
 			return true;
 	}
 
+	// Finish saving the current map first, so the nodebuild for it can't
+	// finish after the new map's data has been loaded
+	waitForNodeBuild();
+
 	// Show blank map
 	Show(true);
 	map_canvas_->Refresh();
@@ -648,6 +682,11 @@ bool MapEditorWindow::openMap(const Archive::MapDesc& map)
 	// Set texture manager archive
 	mapeditor::textureManager().setArchive(app::archiveManager().shareArchive(archive));
 
+	// Begin indexing the textures etc. used by the archive's maps in the
+	// background (for usage counts in the texture browser)
+	if (archive)
+		MapUsageIndex::forArchive(*archive);
+
 	// Clear current map
 	closeMap();
 
@@ -661,9 +700,6 @@ bool MapEditorWindow::openMap(const Archive::MapDesc& map)
 	{
 		mapeditor::editContext().mapDesc() = map;
 
-		// Update DECORATE and *MAPINFO definitions
-		game::updateCustomDefinitions();
-
 		// Load scripts if any
 		loadMapScripts(map);
 
@@ -755,14 +791,11 @@ void MapEditorWindow::loadMapScripts(const Archive::MapDesc& map)
 }
 
 // -----------------------------------------------------------------------------
-// Builds nodes for the maps in [wad]
+// Returns the command line to run the current nodebuilder on [filename] with,
+// or an empty string if nodes shouldn't be built
 // -----------------------------------------------------------------------------
-void MapEditorWindow::buildNodes(Archive* wad)
+wxString MapEditorWindow::nodeBuilderCommand(const wxString& filename)
 {
-	// Save wad to disk
-	auto filename = app::path("sladetemp.wad", app::Dir::Temp);
-	wad->save(filename);
-
 	// Get current nodebuilder
 	auto     builder = nodebuilders::builder(nodebuilder_id);
 	wxString command = builder.command;
@@ -770,7 +803,7 @@ void MapEditorWindow::buildNodes(Archive* wad)
 
 	// Don't build if none selected
 	if (builder.id == "none")
-		return;
+		return {};
 
 	// Switch to ZDBSP if UDMF
 	if (mapeditor::editContext().mapDesc().format == MapFormat::UDMF && nodebuilder_id != "zdbsp")
@@ -799,31 +832,134 @@ void MapEditorWindow::buildNodes(Archive* wad)
 		}
 	}
 
+	if (!wxFileExists(builder.path))
+	{
+		if (nb_warned)
+			log::info(1, "Nodebuilder path not set up, no nodes were built");
+		return {};
+	}
+
 	// Build command line
 	command.Replace("$f", wxString::Format("\"%s\"", filename));
 	command.Replace("$o", wxString(options));
 
+	return wxString::Format("\"%s\" %s", builder.path, command);
+}
+
+// -----------------------------------------------------------------------------
+// Builds nodes for the maps in [wad]
+// -----------------------------------------------------------------------------
+void MapEditorWindow::buildNodes(Archive* wad)
+{
+	auto filename = app::path("sladetemp.wad", app::Dir::Temp);
+	auto command  = nodeBuilderCommand(filename);
+	if (command.empty())
+		return;
+
+	// Reuse the nodes from last time if the map geometry hasn't changed
+	auto cache_key = nodebuilders::nodesCacheKey(
+		*wad, mapeditor::editContext().mapDesc().format, command.ToStdString());
+	if (nodebuilders::loadCachedNodes(*wad, cache_key))
+	{
+		log::info("Map geometry unchanged, reusing previously built nodes");
+		return;
+	}
+
+	// Save wad to disk
+	wad->save(filename);
+
 	// Run nodebuilder
-	if (wxFileExists(builder.path))
+	wxArrayString out;
+	log::info(wxString::Format("execute %s", command));
+	wxGetApp().SetTopWindow(this);
+	auto focus = wxWindow::FindFocus();
+	wxExecute(command, out, wxEXEC_HIDE_CONSOLE);
+	wxGetApp().SetTopWindow(maineditor::windowWx());
+	if (focus)
+		focus->SetFocusFromKbd();
+	log::info(1, "Nodebuilder output:");
+	for (const auto& line : out)
+		log::info(line);
+
+	loadBuiltNodes(*wad, filename, cache_key);
+}
+
+// -----------------------------------------------------------------------------
+// Starts building nodes for the map in [wad] in the background, and saves it
+// to its archive once the nodebuilder has finished (see saveMapEntries). If
+// [save_archive] is true the archive is then saved too.
+// Returns false if no nodebuilder was run, in which case [wad] is untouched
+// (or has had previously built nodes added from the cache)
+// -----------------------------------------------------------------------------
+bool MapEditorWindow::buildNodesInBackground(const shared_ptr<WadArchive>& wad, long save_time, bool save_archive)
+{
+	// Use a different temp file to buildNodes so the two can't clash
+	auto filename = app::path("sladesave.wad", app::Dir::Temp);
+	auto command  = nodeBuilderCommand(filename);
+	if (command.empty())
+		return false;
+
+	// Reuse the nodes from last time if the map geometry hasn't changed
+	auto cache_key = nodebuilders::nodesCacheKey(
+		*wad, mapeditor::editContext().mapDesc().format, command.ToStdString());
+	if (nodebuilders::loadCachedNodes(*wad, cache_key))
+	{
+		log::info("Map geometry unchanged, reusing previously built nodes");
+		return false;
+	}
+
+	// Save wad to disk
+	wad->save(filename);
+
+	// Run nodebuilder, the map is saved when it finishes
+	node_build_ = new nodebuilders::BuildProcess(
+		[this, wad, filename, cache_key, save_time, save_archive](int status)
+		{
+			node_build_ = nullptr;
+			if (status != 0)
+				log::warning(wxString::Format("Nodebuilder exited with code %d", status));
+
+			loadBuiltNodes(*wad, filename, cache_key);
+
+			// Get map data (with nodes) to back up
+			vector<unique_ptr<ArchiveEntry>> map_data;
+			for (unsigned a = 0; a < wad->numEntries(); a++)
+				map_data.emplace_back(new ArchiveEntry(*(wad->entryAt(a))));
+
+			if (saveMapEntries(*wad, map_data))
+			{
+				mapeditor::editContext().map().setOpenedTime(save_time);
+				log::info("Map saved");
+
+				if (save_archive)
+					saveMapArchive();
+			}
+		});
+	if (!node_build_->start(command))
 	{
-		wxArrayString out;
-		log::info(wxString::Format("execute \"%s %s\"", builder.path, command));
-		wxGetApp().SetTopWindow(this);
-		auto focus = wxWindow::FindFocus();
-		wxExecute(wxString::Format("\"%s\" %s", builder.path, command), out, wxEXEC_HIDE_CONSOLE);
-		wxGetApp().SetTopWindow(maineditor::windowWx());
-		if (focus)
-			focus->SetFocusFromKbd();
-		log::info(1, "Nodebuilder output:");
-		for (const auto& line : out)
-			log::info(line);
-
-		// Re-load wad
-		wad->close();
-		wad->open(filename);
+		delete node_build_;
+		node_build_ = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Waits for any nodes currently being built in the background to finish (and
+// the map to be saved)
+// -----------------------------------------------------------------------------
+void MapEditorWindow::waitForNodeBuild() const
+{
+	if (!node_build_)
+		return;
+
+	log::info("Waiting for the nodebuilder to finish...");
+	while (node_build_)
+	{
+		wxSafeYield(nullptr, true);
+		wxMilliSleep(10);
 	}
-	else if (nb_warned)
-		log::info(1, "Nodebuilder path not set up, no nodes were built");
 }
 
 // -----------------------------------------------------------------------------
@@ -889,9 +1025,14 @@ bool MapEditorWindow::writeMap(WadArchive& wad, const wxString& name, bool nodes
 
 // -----------------------------------------------------------------------------
 // Saves the current map to its archive, or opens the 'save as' dialog if it
-// doesn't currently belong to one
-// -----------------------------------------------------------------------------
-bool MapEditorWindow::saveMap()
+// doesn't currently belong to one. If [save_archive] is true, the archive is
+// saved as well once the map entries in it have been replaced.
+// If [background_nodes] is true, nodes are built in the background and the map
+// entries in the archive are only replaced (and the archive saved) once the
+// nodebuilder has finished, in which case the save is still pending when this
+// returns true
+// -----------------------------------------------------------------------------
+bool MapEditorWindow::saveMap(bool background_nodes, bool save_archive)
 {
 	auto& mdesc_current = mapeditor::editContext().mapDesc();
 
@@ -900,11 +1041,81 @@ bool MapEditorWindow::saveMap()
 	if (!current_head)
 		return saveMapAs();
 
+	// Any nodes still being built are for an older version of the map
+	if (node_build_)
+	{
+		log::info("Cancelling previous nodebuild");
+		node_build_->cancel();
+		node_build_ = nullptr;
+	}
+
+	// Reorder map objects spatially if enabled
+	if (map_optimise_order_on_save)
+		mapeditor::editContext().optimiseMapOrder();
+
 	// Write map to temp wad
-	WadArchive wad;
-	if (!writeMap(wad))
+	auto save_time = app::runTimer();
+	auto wad       = std::make_shared<WadArchive>();
+	if (!writeMap(*wad, "MAP01", !background_nodes))
+		return false;
+
+	// Build nodes in the background, the map is saved once they're done
+	if (background_nodes && buildNodesInBackground(wad, save_time, save_archive))
+		return true;
+
+	if (!saveMapEntries(*wad, map_data_))
 		return false;
 
+	mapeditor::editContext().map().setOpenedTime(save_time);
+
+	if (save_archive)
+		saveMapArchive();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Saves the archive the current map is in, or opens the 'save as' dialog for
+// it if it can't be saved directly
+// -----------------------------------------------------------------------------
+void MapEditorWindow::saveMapArchive()
+{
+	auto& mdesc_current = mapeditor::editContext().mapDesc();
+
+	auto head = mdesc_current.head.lock();
+	if (!head)
+		return;
+
+	auto a = head->parent();
+	if (!a)
+		return;
+
+	if (a->canSave())
+		a->save();
+	else
+	{
+		// Can't save archive, do Save As instead
+		if (maineditor::saveArchiveAs(a))
+			SetTitle(wxString::Format("SLADE - %s of %s", mdesc_current.name, a->filename(false)));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Replaces the current map's entries in its archive with the map in [wad].
+// [map_data] is a copy of the map entries in [wad], for the backup
+// -----------------------------------------------------------------------------
+bool MapEditorWindow::saveMapEntries(WadArchive& wad, vector<unique_ptr<ArchiveEntry>>& map_data)
+{
+	auto& mdesc_current = mapeditor::editContext().mapDesc();
+
+	// Check the map is still in an archive (it may have been closed)
+	auto current_head = mdesc_current.head.lock();
+	if (!current_head)
+	{
+		log::error("Unable to save map: the archive it belongs to is no longer open");
+		return false;
+	}
+
 	// Check for map archive
 	unique_ptr<Archive> tempwad;
 	auto                map = mdesc_current;
@@ -930,7 +1141,7 @@ bool MapEditorWindow::saveMap()
 		archive->removeEntry(entry);
 
 	// Create backup
-	if (!mapeditor::backupManager().writeBackup(map_data_, m_head->topParent()->filename(false), m_head->nameNoExt()))
+	if (!mapeditor::backupManager().writeBackup(map_data, m_head->topParent()->filename(false), m_head->nameNoExt()))
 		log::warning(1, "Warning: Failed to backup map data");
 
 	// Add new map entries
@@ -951,11 +1162,72 @@ bool MapEditorWindow::saveMap()
 	// Finish
 	mdesc_current.updateMapFormatHints();
 	lockMapEntries();
-	mapeditor::editContext().map().setOpenedTime();
 
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Writes [wad] (the map written for running) to [filename]. If the file is
+// still the one written on the last run and the lumps are the same sizes, only
+// the lumps that have changed since are rewritten in place (nothing is written
+// if the map hasn't changed at all), otherwise the whole wad is saved
+// -----------------------------------------------------------------------------
+bool MapEditorWindow::writeRunWad(WadArchive& wad, const string& filename)
+{
+	vector<RunWadLump> lumps;
+	for (unsigned a = 0; a < wad.numEntries(); a++)
+	{
+		auto entry = wad.entryAt(a);
+		lumps.push_back({ entry->name(), entry->size(), entry->contentHash() });
+	}
+
+	// Check the previous run wad can be updated in place
+	bool in_place = run_wad_modified_ > 0 && lumps.size() == run_wad_lumps_.size()
+					&& fileutil::fileModifiedTime(filename) == run_wad_modified_;
+	for (unsigned a = 0; in_place && a < lumps.size(); a++)
+		in_place = lumps[a].name == run_wad_lumps_[a].name && lumps[a].size == run_wad_lumps_[a].size;
+
+	if (in_place)
+	{
+		wxFile file(filename, wxFile::read_write);
+		unsigned offset  = 12;
+		unsigned n_write = 0;
+		for (unsigned a = 0; in_place && a < lumps.size(); a++)
+		{
+			if (lumps[a].hash != run_wad_lumps_[a].hash)
+			{
+				auto entry = wad.entryAt(a);
+				in_place   = file.IsOpened() && file.Seek(offset, wxFromStart) != wxInvalidOffset
+						   && file.Write(entry->rawData(), entry->size()) == entry->size();
+				++n_write;
+			}
+			offset += lumps[a].size;
+		}
+
+		if (in_place)
+		{
+			log::info(2, "Run map: {} of {} lumps rewritten", n_write, lumps.size());
+			if (n_write > 0)
+			{
+				file.Close();
+				run_wad_modified_ = fileutil::fileModifiedTime(filename);
+			}
+			run_wad_lumps_ = std::move(lumps);
+			return true;
+		}
+	}
+
+	// Write the whole wad
+	run_wad_modified_ = 0;
+	run_wad_lumps_.clear();
+	if (!wad.save(filename))
+		return false;
+
+	run_wad_modified_ = fileutil::fileModifiedTime(filename);
+	run_wad_lumps_    = std::move(lumps);
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Saves the current map to a new archive
 // -----------------------------------------------------------------------------
@@ -990,7 +1262,7 @@ bool MapEditorWindow::saveMapAs()
 	mdesc_current.head    = head;
 	mdesc_current.archive = false;
 	mdesc_current.end     = end;
-	saveMap();
+	saveMap(false);
 
 	// Write wad to file
 	wad.save(info.filenames[0]);
@@ -1017,6 +1289,9 @@ bool MapEditorWindow::saveMapAs()
 // -----------------------------------------------------------------------------
 void MapEditorWindow::closeMap() const
 {
+	// Finish saving the map first if needed
+	waitForNodeBuild();
+
 	// Close map in editor
 	mapeditor::editContext().clearMap();
 
@@ -1171,25 +1446,8 @@ bool MapEditorWindow::handleAction(string_view id)
 	// Map->Save
 	if (id == "mapw_save")
 	{
-		// Save map
-		if (saveMap())
-		{
-			// Save archive
-			if (auto head = mdesc_current.head.lock())
-			{
-				if (auto a = head->parent(); a && save_archive_with_map)
-				{
-					if (a->canSave())
-						a->save();
-					else
-					{
-						// Can't save archive, do Save As instead
-						if (maineditor::saveArchiveAs(a))
-							SetTitle(wxString::Format("SLADE - %s of %s", mdesc_current.name, a->filename(false)));
-					}
-				}
-			}
-		}
+		// Save map (and archive, once the map entries have been replaced)
+		saveMap(true, save_archive_with_map);
 		mapeditor::editContext().renderer().forceUpdate();
 		return true;
 	}
@@ -1376,16 +1634,17 @@ bool MapEditorWindow::handleAction(string_view id)
 			else if (dlg.start3dModeChecked())
 				edit_context.swapPlayerStart3d();
 
-			// Write temp wad
+			// Write temp wad (only the lumps changed since the last run)
 			WadArchive wad;
+			auto       filename = app::path("sladetemp_run.wad", app::Dir::Temp);
 			if (writeMap(wad, mdesc_current.name))
-				wad.save(app::path("sladetemp_run.wad", app::Dir::Temp));
+				writeRunWad(wad, filename);
 
 			// Reset player 1 start if moved
 			if (dlg.start3dModeChecked() || id == "mapw_run_map_here")
 				mapeditor::editContext().resetPlayerStart();
 
-			wxString command = dlg.selectedCommandLine(archive, mdesc_current.name, wad.filename());
+			wxString command = dlg.selectedCommandLine(archive, mdesc_current.name, filename);
 			if (!command.IsEmpty())
 			{
 				// Set working directory
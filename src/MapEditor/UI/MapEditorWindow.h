@@ -17,6 +17,10 @@ class MapChecksPanel;
 class UndoManagerHistoryPanel;
 class UndoManager;
 class ArchiveEntry;
+namespace nodebuilders
+{
+	class BuildProcess;
+}
 
 class MapEditorWindow : public STopWindow, public SActionHandler
 {
@@ -34,7 +38,7 @@ public:
 	bool openMap(const Archive::MapDesc& map);
 	void loadMapScripts(const Archive::MapDesc& map);
 	bool writeMap(WadArchive& wad, const wxString& name = "MAP01", bool nodes = true);
-	bool saveMap();
+	bool saveMap(bool background_nodes = true, bool save_archive = false);
 	bool saveMapAs();
 	void closeMap() const;
 	void forceRefresh(bool renderer = false) const;
@@ -54,6 +58,14 @@ public:
 	bool handleAction(string_view id) override;
 
 private:
+	// A lump in the temp wad last written to run the map (see writeRunWad)
+	struct RunWadLump
+	{
+		string   name;
+		unsigned size = 0;
+		uint64_t hash = 0;
+	};
+
 	MapCanvas*                       map_canvas_          = nullptr;
 	MapObjectPropsPanel*             panel_obj_props_     = nullptr;
 	ScriptEditorPanel*               panel_script_editor_ = nullptr;
@@ -62,9 +74,18 @@ private:
 	MapChecksPanel*                  panel_checks_       = nullptr;
 	UndoManagerHistoryPanel*         panel_undo_history_ = nullptr;
 	wxMenu*                          menu_scripts_       = nullptr;
+	nodebuilders::BuildProcess*      node_build_         = nullptr;
+	vector<RunWadLump>               run_wad_lumps_;
+	time_t                           run_wad_modified_ = 0;
 
-	void buildNodes(Archive* wad);
-	void lockMapEntries(bool lock = true) const;
+	wxString nodeBuilderCommand(const wxString& filename);
+	void     buildNodes(Archive* wad);
+	bool     buildNodesInBackground(const shared_ptr<WadArchive>& wad, long save_time, bool save_archive);
+	void     waitForNodeBuild() const;
+	bool     saveMapEntries(WadArchive& wad, vector<unique_ptr<ArchiveEntry>>& map_data);
+	void     saveMapArchive();
+	void     lockMapEntries(bool lock = true) const;
+	bool     writeRunWad(WadArchive& wad, const string& filename);
 
 	// Events
 	void onClose(wxCloseEvent& e);
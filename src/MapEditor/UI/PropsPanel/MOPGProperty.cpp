@@ -70,6 +70,33 @@ void MOPGProperty::resetValue()
 	openObjects(parent_->objects());
 }
 
+// -----------------------------------------------------------------------------
+// Reads the value of this property from [objects] and opens it (if the value
+// differs between objects, it is set to unspecified)
+// -----------------------------------------------------------------------------
+void MOPGProperty::openObjects(const vector<MapObject*>& objects)
+{
+	// Set unspecified if no objects given
+	if (objects.empty())
+	{
+		openValue(nullptr);
+		return;
+	}
+
+	// Check whether all objects share the same value as the first
+	auto first = readValue(*objects[0]);
+	for (unsigned a = 1; a < objects.size(); a++)
+	{
+		if (readValue(*objects[a]) != first)
+		{
+			openValue(nullptr);
+			return;
+		}
+	}
+
+	openValue(&first);
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -87,35 +114,28 @@ MOPGBoolProperty::MOPGBoolProperty(const wxString& label, const wxString& name)
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this boolean property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Returns the value of this boolean property for [object]
 // -----------------------------------------------------------------------------
-void MOPGBoolProperty::openObjects(vector<MapObject*>& objects)
+Property MOPGBoolProperty::readValue(MapObject& object) const
 {
-	// Set unspecified if no objects given
-	if (objects.empty())
+	return object.boolProperty(key_);
+}
+
+// -----------------------------------------------------------------------------
+// Opens the common [value] of this boolean property, or sets it to unspecified
+// if there is none (ie. it differs between the objects being edited)
+// -----------------------------------------------------------------------------
+void MOPGBoolProperty::openValue(const Property* value)
+{
+	if (!value)
 	{
 		SetValueToUnspecified();
 		return;
 	}
 
-	// Get property of first object
-	bool first = objects[0]->boolProperty(GetName().ToStdString());
-
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (objects[a]->boolProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
-
 	// Set to common value
 	noupdate_ = true;
-	SetValue(first);
+	SetValue(std::get<bool>(*value));
 	updateVisibility();
 	noupdate_ = false;
 }
@@ -169,35 +189,28 @@ MOPGIntProperty::MOPGIntProperty(const wxString& label, const wxString& name) :
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this integer property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Returns the value of this integer property for [object]
 // -----------------------------------------------------------------------------
-void MOPGIntProperty::openObjects(vector<MapObject*>& objects)
+Property MOPGIntProperty::readValue(MapObject& object) const
 {
-	// Assume unspecified until we see otherwise
-	SetValueToUnspecified();
-
-	// Set unspecified if no objects given
-	if (objects.empty())
-		return;
-
-	// Get property of first object
-	int first = objects[0]->intProperty(GetName().ToStdString());
+	return object.intProperty(key_);
+}
 
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
+// -----------------------------------------------------------------------------
+// Opens the common [value] of this integer property, or sets it to unspecified
+// if there is none (ie. it differs between the objects being edited)
+// -----------------------------------------------------------------------------
+void MOPGIntProperty::openValue(const Property* value)
+{
+	if (!value)
 	{
-		if (objects[a]->intProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
+		SetValueToUnspecified();
+		return;
 	}
 
 	// Set to common value
 	noupdate_ = true;
-	SetValue(first);
+	SetValue(std::get<int>(*value));
 	updateVisibility();
 	noupdate_ = false;
 }
@@ -251,35 +264,28 @@ MOPGFloatProperty::MOPGFloatProperty(const wxString& label, const wxString& name
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this float property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Returns the value of this float property for [object]
 // -----------------------------------------------------------------------------
-void MOPGFloatProperty::openObjects(vector<MapObject*>& objects)
+Property MOPGFloatProperty::readValue(MapObject& object) const
 {
-	// Set unspecified if no objects given
-	if (objects.empty())
+	return object.floatProperty(key_);
+}
+
+// -----------------------------------------------------------------------------
+// Opens the common [value] of this float property, or sets it to unspecified
+// if there is none (ie. it differs between the objects being edited)
+// -----------------------------------------------------------------------------
+void MOPGFloatProperty::openValue(const Property* value)
+{
+	if (!value)
 	{
 		SetValueToUnspecified();
 		return;
 	}
 
-	// Get property of first object
-	double first = objects[0]->floatProperty(GetName().ToStdString());
-
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (objects[a]->floatProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
-
 	// Set to common value
 	noupdate_ = true;
-	SetValue(first);
+	SetValue(std::get<double>(*value));
 	updateVisibility();
 	noupdate_ = false;
 }
@@ -355,35 +361,28 @@ void MOPGStringProperty::setUDMFProp(game::UDMFProperty* prop)
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this string property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Returns the value of this string property for [object]
 // -----------------------------------------------------------------------------
-void MOPGStringProperty::openObjects(vector<MapObject*>& objects)
+Property MOPGStringProperty::readValue(MapObject& object) const
 {
-	// Set unspecified if no objects given
-	if (objects.empty())
+	return object.stringProperty(key_);
+}
+
+// -----------------------------------------------------------------------------
+// Opens the common [value] of this string property, or sets it to unspecified
+// if there is none (ie. it differs between the objects being edited)
+// -----------------------------------------------------------------------------
+void MOPGStringProperty::openValue(const Property* value)
+{
+	if (!value)
 	{
 		SetValueToUnspecified();
 		return;
 	}
 
-	// Get property of first object
-	wxString first = objects[0]->stringProperty(GetName().ToStdString());
-
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (objects[a]->stringProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
-
 	// Set to common value
 	noupdate_ = true;
-	SetValue(first);
+	SetValue(wxString(std::get<string>(*value)));
 	updateVisibility();
 	noupdate_ = false;
 }
@@ -655,37 +654,11 @@ MOPGLineFlagProperty::MOPGLineFlagProperty(const wxString& label, const wxString
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this line flag property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Returns the value of this line flag property for [object]
 // -----------------------------------------------------------------------------
-void MOPGLineFlagProperty::openObjects(vector<MapObject*>& objects)
+Property MOPGLineFlagProperty::readValue(MapObject& object) const
 {
-	// Set unspecified if no objects given
-	if (objects.empty())
-	{
-		SetValueToUnspecified();
-		return;
-	}
-
-	// Check flag against first object
-	bool first = game::configuration().lineFlagSet(index_, (MapLine*)objects[0]);
-
-	// Check whether all objects share the same flag setting
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (game::configuration().lineFlagSet(index_, (MapLine*)objects[a]) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
-
-	// Set to common value
-	noupdate_ = true;
-	SetValue(first);
-	updateVisibility();
-	noupdate_ = false;
+	return game::configuration().lineFlagSet(index_, (MapLine*)&object);
 }
 
 // -----------------------------------------------------------------------------
@@ -725,37 +698,11 @@ MOPGThingFlagProperty::MOPGThingFlagProperty(const wxString& label, const wxStri
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this thing flag property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Returns the value of this thing flag property for [object]
 // -----------------------------------------------------------------------------
-void MOPGThingFlagProperty::openObjects(vector<MapObject*>& objects)
+Property MOPGThingFlagProperty::readValue(MapObject& object) const
 {
-	// Set unspecified if no objects given
-	if (objects.empty())
-	{
-		SetValueToUnspecified();
-		return;
-	}
-
-	// Check flag against first object
-	bool first = game::configuration().thingFlagSet(index_, (MapThing*)objects[0]);
-
-	// Check whether all objects share the same flag setting
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (game::configuration().thingFlagSet(index_, (MapThing*)objects[a]) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
-
-	// Set to common value
-	noupdate_ = true;
-	SetValue(first);
-	updateVisibility();
-	noupdate_ = false;
+	return game::configuration().thingFlagSet(index_, (MapThing*)&object);
 }
 
 // -----------------------------------------------------------------------------
@@ -816,35 +763,28 @@ MOPGAngleProperty::MOPGAngleProperty(const wxString& label, const wxString& name
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this angle property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Returns the value of this angle property for [object]
 // -----------------------------------------------------------------------------
-void MOPGAngleProperty::openObjects(vector<MapObject*>& objects)
+Property MOPGAngleProperty::readValue(MapObject& object) const
 {
-	// Set unspecified if no objects given
-	if (objects.empty())
+	return object.intProperty(key_);
+}
+
+// -----------------------------------------------------------------------------
+// Opens the common [value] of this angle property, or sets it to unspecified
+// if there is none (ie. it differs between the objects being edited)
+// -----------------------------------------------------------------------------
+void MOPGAngleProperty::openValue(const Property* value)
+{
+	if (!value)
 	{
 		SetValueToUnspecified();
 		return;
 	}
 
-	// Get property of first object
-	int first = objects[0]->intProperty(GetName().ToStdString());
-
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (objects[a]->intProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
-
 	// Set to common value
 	noupdate_ = true;
-	SetValue(first);
+	SetValue(std::get<int>(*value));
 	updateVisibility();
 	noupdate_ = false;
 }
@@ -919,35 +859,28 @@ MOPGColourProperty::MOPGColourProperty(const wxString& label, const wxString& na
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this colour property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Returns the value of this colour property for [object]
 // -----------------------------------------------------------------------------
-void MOPGColourProperty::openObjects(vector<MapObject*>& objects)
+Property MOPGColourProperty::readValue(MapObject& object) const
 {
-	// Set unspecified if no objects given
-	if (objects.empty())
+	return object.intProperty(key_);
+}
+
+// -----------------------------------------------------------------------------
+// Opens the common [value] of this colour property, or sets it to unspecified
+// if there is none (ie. it differs between the objects being edited)
+// -----------------------------------------------------------------------------
+void MOPGColourProperty::openValue(const Property* value)
+{
+	if (!value)
 	{
 		SetValueToUnspecified();
 		return;
 	}
 
-	// Get property of first object
-	int first = objects[0]->intProperty(GetName().ToStdString());
-
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (objects[a]->intProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
-
 	// Set to common value
 	noupdate_ = true;
-	wxColour col(first);
+	wxColour col(std::get<int>(*value));
 	col.Set(col.Blue(), col.Green(), col.Red());
 	wxVariant var_value;
 	var_value << col;
@@ -1005,40 +938,6 @@ MOPGTextureProperty::MOPGTextureProperty(TextureType textype, const wxString& la
 	SetEditor(wxPGEditor_TextCtrlAndButton);
 }
 
-// -----------------------------------------------------------------------------
-// Reads the value of this texture property from [objects]
-// (if the value differs between objects, it is set to unspecified)
-// -----------------------------------------------------------------------------
-void MOPGTextureProperty::openObjects(vector<MapObject*>& objects)
-{
-	// Set unspecified if no objects given
-	if (objects.empty())
-	{
-		SetValueToUnspecified();
-		return;
-	}
-
-	// Get property of first object
-	wxString first = objects[0]->stringProperty(GetName().ToStdString());
-
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (objects[a]->stringProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
-
-	// Set to common value
-	noupdate_ = true;
-	SetValue(first);
-	updateVisibility();
-	noupdate_ = false;
-}
-
 // -----------------------------------------------------------------------------
 // Called when an event is raised for the control
 // -----------------------------------------------------------------------------
@@ -1087,36 +986,29 @@ MOPGSPACTriggerProperty::MOPGSPACTriggerProperty(const wxString& label, const wx
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this SPAC trigger property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Returns the value of this SPAC trigger property for [object]
 // -----------------------------------------------------------------------------
-void MOPGSPACTriggerProperty::openObjects(vector<MapObject*>& objects)
+Property MOPGSPACTriggerProperty::readValue(MapObject& object) const
 {
-	// Set unspecified if no objects given
-	if (objects.empty())
+	auto map_format = mapeditor::editContext().mapDesc().format;
+	return game::configuration().spacTriggerString(dynamic_cast<MapLine*>(&object), map_format);
+}
+
+// -----------------------------------------------------------------------------
+// Opens the common [value] of this SPAC trigger property, or sets it to unspecified
+// if there is none (ie. it differs between the objects being edited)
+// -----------------------------------------------------------------------------
+void MOPGSPACTriggerProperty::openValue(const Property* value)
+{
+	if (!value)
 	{
 		SetValueToUnspecified();
 		return;
 	}
 
-	// Get property of first object
-	auto     map_format = mapeditor::editContext().mapDesc().format;
-	wxString first      = game::configuration().spacTriggerString(dynamic_cast<MapLine*>(objects[0]), map_format);
-
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (game::configuration().spacTriggerString(dynamic_cast<MapLine*>(objects[a]), map_format) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
-
 	// Set to common value
 	noupdate_ = true;
-	SetValue(first);
+	SetValue(wxString(std::get<string>(*value)));
 	updateVisibility();
 	noupdate_ = false;
 }
@@ -1172,40 +1064,6 @@ MOPGTagProperty::MOPGTagProperty(IdType id_type, const wxString& label, const wx
 	SetEditor(wxPGEditor_TextCtrlAndButton);
 }
 
-// -----------------------------------------------------------------------------
-// Reads the value of this tag/id property from [objects]
-// (if the value differs between objects, it is set to unspecified)
-// -----------------------------------------------------------------------------
-void MOPGTagProperty::openObjects(vector<MapObject*>& objects)
-{
-	// Set unspecified if no objects given
-	if (objects.empty())
-	{
-		SetValueToUnspecified();
-		return;
-	}
-
-	// Get property of first object
-	int first = objects[0]->intProperty(GetName().ToStdString());
-
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (objects[a]->intProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
-
-	// Set to common value
-	noupdate_ = true;
-	SetValue(first);
-	updateVisibility();
-	noupdate_ = false;
-}
-
 // -----------------------------------------------------------------------------
 // Called when an event is raised for the control
 // -----------------------------------------------------------------------------
@@ -1253,40 +1111,6 @@ MOPGSectorSpecialProperty::MOPGSectorSpecialProperty(const wxString& label, cons
 	SetEditor(wxPGEditor_TextCtrlAndButton);
 }
 
-// -----------------------------------------------------------------------------
-// Reads the value of this sector special property from [objects]
-// (if the value differs between objects, it is set to unspecified)
-// -----------------------------------------------------------------------------
-void MOPGSectorSpecialProperty::openObjects(vector<MapObject*>& objects)
-{
-	// Set unspecified if no objects given
-	if (objects.empty())
-	{
-		SetValueToUnspecified();
-		return;
-	}
-
-	// Get property of first object
-	int first = objects[0]->intProperty(GetName().ToStdString());
-
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (objects[a]->intProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
-
-	// Set to common value
-	noupdate_ = true;
-	SetValue(first);
-	updateVisibility();
-	noupdate_ = false;
-}
-
 // -----------------------------------------------------------------------------
 // Returns the sector special value as a string
 // -----------------------------------------------------------------------------
@@ -2,6 +2,7 @@
 
 #include "Game/Args.h"
 #include "MapEditor/MapEditor.h"
+#include "Utility/Property.h"
 
 namespace slade
 {
@@ -15,7 +16,7 @@ class MapObjectPropsPanel;
 class MOPGProperty
 {
 public:
-	MOPGProperty(const wxString& prop_name) : propname_{ prop_name } {}
+	MOPGProperty(const wxString& prop_name) : propname_{ prop_name }, key_{ prop_name.ToStdString() } {}
 	virtual ~MOPGProperty() = default;
 
 	enum class Type
@@ -40,17 +41,23 @@ public:
 	void         setParent(MapObjectPropsPanel* parent) { parent_ = parent; }
 	virtual void setUDMFProp(game::UDMFProperty* prop) { udmf_prop_ = prop; }
 
-	virtual Type type()                                   = 0;
-	virtual void openObjects(vector<MapObject*>& objects) = 0;
-	virtual void updateVisibility()                       = 0;
-	virtual void applyValue() {}
-	virtual void resetValue();
+	const string& key() const { return key_; }
+
+	virtual Type     type()                              = 0;
+	virtual Property readValue(MapObject& object) const = 0;
+	virtual void     openValue(const Property* value)    = 0;
+	virtual void     updateVisibility()                  = 0;
+	virtual void     applyValue() {}
+	virtual void     resetValue();
+
+	void openObjects(const vector<MapObject*>& objects);
 
 protected:
 	MapObjectPropsPanel* parent_    = nullptr;
 	bool                 noupdate_  = false;
 	game::UDMFProperty*  udmf_prop_ = nullptr;
 	wxString             propname_;
+	string               key_; // propname_ as used for MapObject property lookups
 };
 
 class MOPGBoolProperty : public MOPGProperty, public wxBoolProperty
@@ -58,10 +65,11 @@ class MOPGBoolProperty : public MOPGProperty, public wxBoolProperty
 public:
 	MOPGBoolProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
-	Type type() override { return Type::Boolean; }
-	void openObjects(vector<MapObject*>& objects) override;
-	void updateVisibility() override;
-	void applyValue() override;
+	Type     type() override { return Type::Boolean; }
+	Property readValue(MapObject& object) const override;
+	void     openValue(const Property* value) override;
+	void     updateVisibility() override;
+	void     applyValue() override;
 };
 
 class MOPGIntProperty : public MOPGProperty, public wxIntProperty
@@ -69,10 +77,11 @@ class MOPGIntProperty : public MOPGProperty, public wxIntProperty
 public:
 	MOPGIntProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
-	Type type() override { return Type::Integer; }
-	void openObjects(vector<MapObject*>& objects) override;
-	void updateVisibility() override;
-	void applyValue() override;
+	Type     type() override { return Type::Integer; }
+	Property readValue(MapObject& object) const override;
+	void     openValue(const Property* value) override;
+	void     updateVisibility() override;
+	void     applyValue() override;
 };
 
 class MOPGFloatProperty : public MOPGProperty, public wxFloatProperty
@@ -80,10 +89,11 @@ class MOPGFloatProperty : public MOPGProperty, public wxFloatProperty
 public:
 	MOPGFloatProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
-	Type type() override { return Type::Float; }
-	void openObjects(vector<MapObject*>& objects) override;
-	void updateVisibility() override;
-	void applyValue() override;
+	Type     type() override { return Type::Float; }
+	Property readValue(MapObject& object) const override;
+	void     openValue(const Property* value) override;
+	void     updateVisibility() override;
+	void     applyValue() override;
 };
 
 class MOPGStringProperty : public MOPGProperty, public wxStringProperty
@@ -93,10 +103,11 @@ public:
 
 	void setUDMFProp(game::UDMFProperty* prop) override;
 
-	Type type() override { return Type::String; }
-	void openObjects(vector<MapObject*>& objects) override;
-	void updateVisibility() override;
-	void applyValue() override;
+	Type     type() override { return Type::String; }
+	Property readValue(MapObject& object) const override;
+	void     openValue(const Property* value) override;
+	void     updateVisibility() override;
+	void     applyValue() override;
 };
 
 class MOPGIntWithArgsProperty : public MOPGIntProperty
@@ -156,9 +167,9 @@ class MOPGLineFlagProperty : public MOPGBoolProperty
 public:
 	MOPGLineFlagProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL, int index = -1);
 
-	Type type() override { return Type::LineFlag; }
-	void openObjects(vector<MapObject*>& objects) override;
-	void applyValue() override;
+	Type     type() override { return Type::LineFlag; }
+	Property readValue(MapObject& object) const override;
+	void     applyValue() override;
 
 private:
 	int index_;
@@ -169,9 +180,9 @@ class MOPGThingFlagProperty : public MOPGBoolProperty
 public:
 	MOPGThingFlagProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL, int index = -1);
 
-	Type type() override { return Type::ThingFlag; }
-	void openObjects(vector<MapObject*>& objects) override;
-	void applyValue() override;
+	Type     type() override { return Type::ThingFlag; }
+	Property readValue(MapObject& object) const override;
+	void     applyValue() override;
 
 private:
 	int index_;
@@ -182,10 +193,11 @@ class MOPGAngleProperty : public MOPGProperty, public wxEditEnumProperty
 public:
 	MOPGAngleProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
-	Type type() override { return Type::Angle; }
-	void openObjects(vector<MapObject*>& objects) override;
-	void updateVisibility() override;
-	void applyValue() override;
+	Type     type() override { return Type::Angle; }
+	Property readValue(MapObject& object) const override;
+	void     openValue(const Property* value) override;
+	void     updateVisibility() override;
+	void     applyValue() override;
 
 	// wxPGProperty overrides
 	wxString ValueToString(wxVariant& value, int arg_flags = 0) const override;
@@ -196,10 +208,11 @@ class MOPGColourProperty : public MOPGProperty, public wxColourProperty
 public:
 	MOPGColourProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
-	Type type() override { return Type::Colour; }
-	void openObjects(vector<MapObject*>& objects) override;
-	void updateVisibility() override;
-	void applyValue() override;
+	Type     type() override { return Type::Colour; }
+	Property readValue(MapObject& object) const override;
+	void     openValue(const Property* value) override;
+	void     updateVisibility() override;
+	void     applyValue() override;
 };
 
 class MOPGTextureProperty : public MOPGStringProperty
@@ -211,7 +224,6 @@ public:
 		const wxString&        name    = wxPG_LABEL);
 
 	Type type() override { return Type::Texture; }
-	void openObjects(vector<MapObject*>& objects) override;
 
 	// wxPGProperty overrides
 	bool OnEvent(wxPropertyGrid* propgrid, wxWindow* window, wxEvent& e) override;
@@ -225,10 +237,11 @@ class MOPGSPACTriggerProperty : public MOPGProperty, public wxEnumProperty
 public:
 	MOPGSPACTriggerProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
-	Type type() override { return Type::SPACTrigger; }
-	void openObjects(vector<MapObject*>& objects) override;
-	void updateVisibility() override;
-	void applyValue() override;
+	Type     type() override { return Type::SPACTrigger; }
+	Property readValue(MapObject& object) const override;
+	void     openValue(const Property* value) override;
+	void     updateVisibility() override;
+	void     applyValue() override;
 };
 
 class MOPGTagProperty : public MOPGIntProperty
@@ -244,7 +257,6 @@ public:
 	MOPGTagProperty(IdType id_type, const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::Id; }
-	void openObjects(vector<MapObject*>& objects) override;
 
 	// wxPGProperty overrides
 	bool OnEvent(wxPropertyGrid* propgrid, wxWindow* window, wxEvent& e) override;
@@ -259,7 +271,6 @@ public:
 	MOPGSectorSpecialProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::SectorSpecial; }
-	void openObjects(vector<MapObject*>& objects) override;
 
 	// wxPGProperty overrides
 	wxString ValueToString(wxVariant& value, int argFlags = 0) const override;
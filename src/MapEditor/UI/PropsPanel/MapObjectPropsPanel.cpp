@@ -962,53 +962,65 @@ void MapObjectPropsPanel::openObjects(vector<MapObject*>& objects)
 	// Find any custom properties (UDMF only)
 	if (mapeditor::editContext().mapDesc().format == MapFormat::UDMF)
 	{
+		// Each (interned) property id only needs checking once, so start with
+		// the properties already on the list and any hidden ones
+		std::set<MobjPropertyList::Id> checked_ids;
+		for (auto& property : properties_)
+			checked_ids.insert(MobjPropertyList::id(property->key()));
+		for (auto& name : hide_props_)
+			checked_ids.insert(MobjPropertyList::id(name.ToStdString()));
+
 		for (auto& object : objects)
 		{
 			// Go through object properties
-			auto objprops = object->props().properties();
-			for (auto& prop : objprops)
+			for (auto& prop : object->props().properties())
 			{
-				// Ignore side property
-				if (strutil::startsWith(prop.name, "side1.") || strutil::startsWith(prop.name, "side2."))
+				// Ignore if already checked
+				if (!checked_ids.insert(prop.id).second)
 					continue;
 
-				// Check if hidden
-				if (VECTOR_EXISTS(hide_props_, prop.name))
+				// Ignore side property
+				if (strutil::startsWith(prop.name(), "side1.") || strutil::startsWith(prop.name(), "side2."))
 					continue;
 
-				// Check if property is already on the list
-				bool exists = false;
-				for (auto& property : properties_)
-				{
-					if (property->propName() == prop.name)
-					{
-						exists = true;
-						break;
-					}
-				}
+				// Create custom group if needed
+				if (!group_custom_)
+					group_custom_ = pg_properties_->Append(new wxPropertyCategory("Custom"));
 
-				if (!exists)
+				// Add property
+				switch (property::valueType(prop.value))
 				{
-					// Create custom group if needed
-					if (!group_custom_)
-						group_custom_ = pg_properties_->Append(new wxPropertyCategory("Custom"));
-
-					// Add property
-					switch (property::valueType(prop.value))
-					{
-					case property::ValueType::Bool: addBoolProperty(group_custom_, prop.name, prop.name); break;
-					case property::ValueType::Int: addIntProperty(group_custom_, prop.name, prop.name); break;
-					case property::ValueType::Float: addFloatProperty(group_custom_, prop.name, prop.name); break;
-					default: addStringProperty(group_custom_, prop.name, prop.name); break;
-					}
+				case property::ValueType::Bool: addBoolProperty(group_custom_, prop.name(), prop.name()); break;
+				case property::ValueType::Int: addIntProperty(group_custom_, prop.name(), prop.name()); break;
+				case property::ValueType::Float: addFloatProperty(group_custom_, prop.name(), prop.name()); break;
+				default: addStringProperty(group_custom_, prop.name(), prop.name()); break;
 				}
 			}
 		}
 	}
 
-	// Generic properties
+	// Generic properties - read all values in a single pass over the objects,
+	// no longer checking a property once it differs between objects
+	auto             n_props = properties_.size();
+	vector<Property> values;
+	vector<bool>     mixed(n_props, false);
+	unsigned         n_mixed = 0;
+	values.reserve(n_props);
 	for (auto& property : properties_)
-		property->openObjects(objects);
+		values.push_back(property->readValue(*objects[0]));
+	for (unsigned a = 1; a < objects.size() && n_mixed < n_props; a++)
+	{
+		for (unsigned p = 0; p < n_props; p++)
+		{
+			if (!mixed[p] && properties_[p]->readValue(*objects[a]) != values[p])
+			{
+				mixed[p] = true;
+				n_mixed++;
+			}
+		}
+	}
+	for (unsigned p = 0; p < n_props; p++)
+		properties_[p]->openValue(mixed[p] ? nullptr : &values[p]);
 
 	// Handle line sides
 	if (objects[0]->objType() == MapObject::Type::Line)
@@ -115,6 +115,7 @@ void FlatTexCanvas::draw()
 	{
 		glEnable(GL_TEXTURE_2D);
 		drawing::drawTextureWithin(texture_, 0, 0, size.x, size.y, 0, 100.0);
+		mapeditor::textureManager().markUsed(texture_);
 	}
 	else if (texture_ == gl::Texture::missingTexture())
 	{
@@ -179,13 +180,13 @@ void FlatComboBox::onDropDown(wxCommandEvent& e)
 	{
 		if (strutil::startsWith(texture.short_name, text.ToStdString()))
 		{
-			list.Add(texture.short_name);
+			list.Add(wxutil::strFromView(texture.short_name));
 		}
 		if (game::configuration().featureSupported(game::Feature::LongNames))
 		{
 			if (strutil::startsWith(texture.long_name, text.ToStdString()))
 			{
-				list.Add(texture.long_name);
+				list.Add(wxutil::strFromView(texture.long_name));
 			}
 		}
 	}
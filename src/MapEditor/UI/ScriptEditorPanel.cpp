@@ -156,8 +156,8 @@ bool ScriptEditorPanel::openScripts(ArchiveEntry* script, ArchiveEntry* compiled
 	if (entry_script_->size() > 0 && (lang == "acs_hexen" || lang == "acs_zdoom"))
 	{
 		auto& map = mapeditor::editContext().map();
-		map.mapSpecials()->processACSScripts(entry_script_.get());
-		map.mapSpecials()->updateTaggedSectors(&map);
+		if (map.mapSpecials()->processACSScripts(entry_script_.get()))
+			map.mapSpecials()->updateTaggedSectors(&map);
 	}
 
 	// Load script text
@@ -216,8 +216,8 @@ void ScriptEditorPanel::saveScripts() const
 	if (entry_script_->size() > 0 && (lang == "acs_hexen" || lang == "acs_zdoom"))
 	{
 		auto map = &(mapeditor::editContext().map());
-		map->mapSpecials()->processACSScripts(entry_script_.get());
-		map->mapSpecials()->updateTaggedSectors(map);
+		if (map->mapSpecials()->processACSScripts(entry_script_.get()))
+			map->mapSpecials()->updateTaggedSectors(map);
 	}
 }
 
@@ -6,22 +6,350 @@
 using namespace slade;
 using namespace mapeditor;
 
-PropertyChangeUS::PropertyChangeUS(MapObject* object) : backup_{ new MapObject::Backup() }
+namespace
 {
-	object->backupTo(backup_.get());
+// Removes all properties from [list] that have the same value in [other], and
+// adds the ids of any properties in [other] that aren't in [list] to [absent]
+void stripUnchanged(MobjPropertyList& list, const MobjPropertyList& other, vector<MobjPropertyList::Id>& absent)
+{
+	MobjPropertyList changed;
+	auto&            props       = list.properties();
+	auto&            other_props = other.properties();
+
+	// Both lists are sorted by id
+	unsigned a = 0, b = 0;
+	while (a < props.size() || b < other_props.size())
+	{
+		if (b == other_props.size() || (a < props.size() && props[a].id < other_props[b].id))
+		{
+			changed[props[a].id] = props[a].value;
+			++a;
+		}
+		else if (a == props.size() || other_props[b].id < props[a].id)
+		{
+			absent.push_back(other_props[b].id);
+			++b;
+		}
+		else
+		{
+			if (props[a].value != other_props[b].value)
+				changed[props[a].id] = props[a].value;
+			++a;
+			++b;
+		}
+	}
+
+	list = std::move(changed);
+}
+
+// Sets all properties in [changed] and removes all properties in [absent] from
+// [list]
+void applyChanges(MobjPropertyList& list, const MobjPropertyList& changed, const vector<MobjPropertyList::Id>& absent)
+{
+	for (auto& prop : changed.properties())
+		list[prop.id] = prop.value;
+	for (auto id : absent)
+		list.remove(id);
+}
+
+// Approximate memory used by [list]
+size_t propListMemUsage(const MobjPropertyList& list)
+{
+	size_t size = list.properties().capacity() * sizeof(MobjPropertyList::Entry);
+	for (auto& prop : list.properties())
+		if (auto str = std::get_if<string>(&prop.value))
+			size += str->capacity();
+
+	return size;
+}
+
+// Writes [ids] to [runs] as runs of consecutive ids (first id, count). Object
+// ids are allocated sequentially so the id lists of big maps compress well
+void compressIds(const vector<unsigned>& ids, vector<unsigned>& runs)
+{
+	runs.clear();
+	for (auto id : ids)
+	{
+		if (!runs.empty() && runs[runs.size() - 2] + runs.back() == id)
+			++runs.back();
+		else
+		{
+			runs.push_back(id);
+			runs.push_back(1);
+		}
+	}
+	runs.shrink_to_fit();
+}
+
+// Writes the ids in [runs] (see compressIds) to [ids]
+void expandIds(const vector<unsigned>& runs, vector<unsigned>& ids)
+{
+	ids.clear();
+	for (unsigned a = 0; a + 1 < runs.size(); a += 2)
+		for (unsigned b = 0; b < runs[a + 1]; ++b)
+			ids.push_back(runs[a] + b);
+}
+
+// Returns true if the ids of [objects] are the same as the ids in [runs]
+template<typename T> bool sameIds(const T& objects, const vector<unsigned>& runs)
+{
+	vector<unsigned> ids;
+	expandIds(runs, ids);
+	if (objects.size() != ids.size())
+		return false;
+
+	for (unsigned a = 0; a < ids.size(); a++)
+		if (objects[a]->objId() != ids[a])
+			return false;
+
+	return true;
+}
+
+// Writes [value] to [mc]
+template<typename T> void writeValue(MemChunk& mc, const T& value)
+{
+	mc.write(&value, sizeof(T));
+}
+
+// Reads [value] from [mc], returns false if there wasn't enough data
+template<typename T> bool readValue(MemChunk& mc, T& value)
+{
+	return mc.read(&value, sizeof(T));
 }
 
+// Writes [list] to [mc]
+void writeIds(MemChunk& mc, const vector<unsigned>& list)
+{
+	writeValue(mc, static_cast<uint32_t>(list.size()));
+	if (!list.empty())
+		mc.write(list.data(), list.size() * sizeof(unsigned));
+}
+
+// Reads a list written by writeIds from [mc] to [list]
+bool readIds(MemChunk& mc, vector<unsigned>& list)
+{
+	uint32_t count = 0;
+	if (!readValue(mc, count) || mc.currentPos() + count * sizeof(unsigned) > mc.size())
+		return false;
+
+	list.resize(count);
+	return count == 0 || mc.read(list.data(), count * sizeof(unsigned));
+}
+
+// Writes all properties in [list] to [mc]. Property ids are written as-is since
+// they're only read back in the same session
+void writePropList(MemChunk& mc, const MobjPropertyList& list)
+{
+	writeValue(mc, static_cast<uint32_t>(list.properties().size()));
+	for (auto& prop : list.properties())
+	{
+		writeValue(mc, prop.id);
+		writeValue(mc, static_cast<uint8_t>(prop.value.index()));
+		switch (property::valueType(prop.value))
+		{
+		case property::ValueType::Bool: writeValue(mc, static_cast<uint8_t>(std::get<bool>(prop.value))); break;
+		case property::ValueType::Int: writeValue(mc, std::get<int>(prop.value)); break;
+		case property::ValueType::UInt: writeValue(mc, std::get<unsigned>(prop.value)); break;
+		case property::ValueType::Float: writeValue(mc, std::get<double>(prop.value)); break;
+		case property::ValueType::String:
+		{
+			auto& str = std::get<string>(prop.value);
+			writeValue(mc, static_cast<uint32_t>(str.size()));
+			mc.write(str.data(), str.size());
+			break;
+		}
+		}
+	}
+}
+
+// Reads a property list written by writePropList from [mc] to [list]
+bool readPropList(MemChunk& mc, MobjPropertyList& list)
+{
+	list = {};
+
+	uint32_t count = 0;
+	if (!readValue(mc, count))
+		return false;
+
+	for (unsigned a = 0; a < count; ++a)
+	{
+		MobjPropertyList::Id id;
+		uint8_t              type;
+		if (!readValue(mc, id) || !readValue(mc, type))
+			return false;
+
+		auto& value = list[id];
+		switch (static_cast<property::ValueType>(type))
+		{
+		case property::ValueType::Bool:
+		{
+			uint8_t val = 0;
+			if (!readValue(mc, val))
+				return false;
+			value = val != 0;
+			break;
+		}
+		case property::ValueType::Int:
+		{
+			int val = 0;
+			if (!readValue(mc, val))
+				return false;
+			value = val;
+			break;
+		}
+		case property::ValueType::UInt:
+		{
+			unsigned val = 0;
+			if (!readValue(mc, val))
+				return false;
+			value = val;
+			break;
+		}
+		case property::ValueType::Float:
+		{
+			double val = 0.;
+			if (!readValue(mc, val))
+				return false;
+			value = val;
+			break;
+		}
+		case property::ValueType::String:
+		{
+			uint32_t length = 0;
+			if (!readValue(mc, length) || mc.currentPos() + length > mc.size())
+				return false;
+			string val(length, '\0');
+			if (length > 0 && !mc.read(val.data(), length))
+				return false;
+			value = std::move(val);
+			break;
+		}
+		default: return false;
+		}
+	}
+
+	return true;
+}
+
+// Returns a full backup of [object]
+unique_ptr<MapObject::Backup> backupObject(MapObject* object)
+{
+	auto backup = std::make_unique<MapObject::Backup>();
+	object->backupTo(backup.get());
+	return backup;
+}
+
+// Gets the id list of all objects of [type] in [map] as runs (see compressIds)
+void putIdRuns(SLADEMap* map, MapObject::Type type, vector<unsigned>& runs)
+{
+	vector<unsigned> ids;
+	map->mapData().putObjectIdList(type, ids);
+	compressIds(ids, runs);
+}
+} // namespace
+
+
+bool MapObjectDelta::empty() const
+{
+	return stripped_ && backup_->properties.empty() && backup_->props_internal.empty() && absent_.empty()
+		   && absent_internal_.empty();
+}
+
+size_t MapObjectDelta::memUsage() const
+{
+	return sizeof(MapObject::Backup) + propListMemUsage(backup_->properties)
+		   + propListMemUsage(backup_->props_internal)
+		   + (absent_.capacity() + absent_internal_.capacity()) * sizeof(MobjPropertyList::Id);
+}
+
+// Removes everything from the backup that is the same in [obj]'s current state
+void MapObjectDelta::strip(MapObject* obj)
+{
+	MapObject::Backup current;
+	obj->backupTo(&current);
+
+	absent_.clear();
+	absent_internal_.clear();
+	stripUnchanged(backup_->properties, current.properties, absent_);
+	stripUnchanged(backup_->props_internal, current.props_internal, absent_internal_);
+	absent_.shrink_to_fit();
+	absent_internal_.shrink_to_fit();
+	stripped_ = true;
+}
+
+// Writes the delta to [mc]
+void MapObjectDelta::write(MemChunk& mc) const
+{
+	writeValue(mc, backup_->id);
+	writeValue(mc, static_cast<uint8_t>(backup_->type));
+	writeValue(mc, static_cast<uint8_t>(stripped_));
+	writePropList(mc, backup_->properties);
+	writePropList(mc, backup_->props_internal);
+	writeIds(mc, absent_);
+	writeIds(mc, absent_internal_);
+}
+
+// Reads the delta from [mc] (written with write())
+bool MapObjectDelta::read(MemChunk& mc)
+{
+	uint8_t type     = 0;
+	uint8_t stripped = 0;
+	if (!readValue(mc, backup_->id) || !readValue(mc, type) || !readValue(mc, stripped))
+		return false;
+
+	backup_->type = static_cast<MapObject::Type>(type);
+	stripped_     = stripped != 0;
+
+	return readPropList(mc, backup_->properties) && readPropList(mc, backup_->props_internal)
+		   && readIds(mc, absent_) && readIds(mc, absent_internal_);
+}
+
+// Frees the delta's properties (the object id is kept)
+void MapObjectDelta::unload()
+{
+	backup_->properties     = {};
+	backup_->props_internal = {};
+	absent_                 = {};
+	absent_internal_        = {};
+}
+
+// Restores [obj] to the state in the delta, and stores [obj]'s previous state
+// (of the changed properties) in the delta
+void MapObjectDelta::swap(MapObject* obj)
+{
+	auto current = std::make_unique<MapObject::Backup>();
+	obj->backupTo(current.get());
+
+	// Full backup, just swap
+	if (!stripped_)
+	{
+		obj->loadFromBackup(backup_.get());
+		backup_ = std::move(current);
+		return;
+	}
+
+	// Apply the changes to the current state and restore from that
+	MapObject::Backup restored = *current;
+	applyChanges(restored.properties, backup_->properties, absent_);
+	applyChanges(restored.props_internal, backup_->props_internal, absent_internal_);
+	obj->loadFromBackup(&restored);
+
+	// Keep what changed from the previous state
+	backup_ = std::move(current);
+	strip(obj);
+}
+
+
+PropertyChangeUS::PropertyChangeUS(MapObject* object) : delta_{ backupObject(object) } {}
+
 void PropertyChangeUS::doSwap(MapObject* obj)
 {
-	auto temp = std::make_unique<MapObject::Backup>();
-	obj->backupTo(temp.get());
-	obj->loadFromBackup(backup_.get());
-	backup_.swap(temp);
+	delta_.swap(obj);
 }
 
 bool PropertyChangeUS::doUndo()
 {
-	auto obj = undoredo::currentMap()->mapData().getObjectById(backup_->id);
+	auto obj = undoredo::currentMap()->mapData().getObjectById(delta_.objId());
 	if (obj)
 		doSwap(obj);
 
@@ -30,22 +358,42 @@ bool PropertyChangeUS::doUndo()
 
 bool PropertyChangeUS::doRedo()
 {
-	auto obj = undoredo::currentMap()->mapData().getObjectById(backup_->id);
+	auto obj = undoredo::currentMap()->mapData().getObjectById(delta_.objId());
 	if (obj)
 		doSwap(obj);
 
 	return true;
 }
 
+bool PropertyChangeUS::writeFile(MemChunk& mc)
+{
+	delta_.write(mc);
+	return true;
+}
+
+bool PropertyChangeUS::readFile(MemChunk& mc)
+{
+	return delta_.read(mc);
+}
+
+void PropertyChangeUS::recordEnded()
+{
+	// The object has been modified now, only keep what changed
+	auto map = undoredo::currentMap();
+	auto obj = map ? map->mapData().getObjectById(delta_.objId()) : nullptr;
+	if (obj)
+		delta_.strip(obj);
+}
+
 
 MapObjectCreateDeleteUS::MapObjectCreateDeleteUS()
 {
 	auto map = undoredo::currentMap();
-	map->mapData().putObjectIdList(MapObject::Type::Vertex, vertices_);
-	map->mapData().putObjectIdList(MapObject::Type::Line, lines_);
-	map->mapData().putObjectIdList(MapObject::Type::Side, sides_);
-	map->mapData().putObjectIdList(MapObject::Type::Sector, sectors_);
-	map->mapData().putObjectIdList(MapObject::Type::Thing, things_);
+	putIdRuns(map, MapObject::Type::Vertex, vertices_);
+	putIdRuns(map, MapObject::Type::Line, lines_);
+	putIdRuns(map, MapObject::Type::Side, sides_);
+	putIdRuns(map, MapObject::Type::Sector, sectors_);
+	putIdRuns(map, MapObject::Type::Thing, things_);
 }
 
 void MapObjectCreateDeleteUS::swapLists()
@@ -58,42 +406,48 @@ void MapObjectCreateDeleteUS::swapLists()
 	vector<unsigned> things;
 	auto             map = undoredo::currentMap();
 	if (isValid(vertices_))
-		map->mapData().putObjectIdList(MapObject::Type::Vertex, vertices);
+		putIdRuns(map, MapObject::Type::Vertex, vertices);
 	if (isValid(lines_))
-		map->mapData().putObjectIdList(MapObject::Type::Line, lines);
+		putIdRuns(map, MapObject::Type::Line, lines);
 	if (isValid(sides_))
-		map->mapData().putObjectIdList(MapObject::Type::Side, sides);
+		putIdRuns(map, MapObject::Type::Side, sides);
 	if (isValid(sectors_))
-		map->mapData().putObjectIdList(MapObject::Type::Sector, sectors);
+		putIdRuns(map, MapObject::Type::Sector, sectors);
 	if (isValid(things_))
-		map->mapData().putObjectIdList(MapObject::Type::Thing, things);
+		putIdRuns(map, MapObject::Type::Thing, things);
 
 	// Restore
+	vector<unsigned> ids;
 	if (isValid(vertices_))
 	{
-		map->restoreObjectIdList(MapObject::Type::Vertex, vertices_);
+		expandIds(vertices_, ids);
+		map->restoreObjectIdList(MapObject::Type::Vertex, ids);
 		vertices_ = vertices;
 		map->updateGeometryInfo(0);
 	}
 	if (isValid(lines_))
 	{
-		map->restoreObjectIdList(MapObject::Type::Line, lines_);
+		expandIds(lines_, ids);
+		map->restoreObjectIdList(MapObject::Type::Line, ids);
 		lines_ = lines;
 		map->updateGeometryInfo(0);
 	}
 	if (isValid(sides_))
 	{
-		map->restoreObjectIdList(MapObject::Type::Side, sides_);
+		expandIds(sides_, ids);
+		map->restoreObjectIdList(MapObject::Type::Side, ids);
 		sides_ = sides;
 	}
 	if (isValid(sectors_))
 	{
-		map->restoreObjectIdList(MapObject::Type::Sector, sectors_);
+		expandIds(sectors_, ids);
+		map->restoreObjectIdList(MapObject::Type::Sector, ids);
 		sectors_ = sectors;
 	}
 	if (isValid(things_))
 	{
-		map->restoreObjectIdList(MapObject::Type::Thing, things_);
+		expandIds(things_, ids);
+		map->restoreObjectIdList(MapObject::Type::Thing, ids);
 		things_ = things;
 	}
 }
@@ -115,97 +469,42 @@ void MapObjectCreateDeleteUS::checkChanges()
 	auto map = undoredo::currentMap();
 
 	// Check vertices changed
-	bool vertices_changed = false;
-	if (map->nVertices() != vertices_.size())
-		vertices_changed = true;
-	else
-		for (unsigned a = 0; a < map->nVertices(); a++)
-			if (map->vertex(a)->objId() != vertices_[a])
-			{
-				vertices_changed = true;
-				break;
-			}
-	if (!vertices_changed)
+	if (sameIds(map->vertices(), vertices_))
 	{
 		// No change, clear
-		vertices_.clear();
-		vertices_.push_back(0);
+		vertices_.assign(1, 0);
 		log::info(3, "MapObjectCreateDeleteUS: No vertices added/deleted");
 	}
 
 	// Check lines changed
-	bool lines_changed = false;
-	if (map->nLines() != lines_.size())
-		lines_changed = true;
-	else
-		for (unsigned a = 0; a < map->nLines(); a++)
-			if (map->line(a)->objId() != lines_[a])
-			{
-				lines_changed = true;
-				break;
-			}
-	if (!lines_changed)
+	if (sameIds(map->lines(), lines_))
 	{
 		// No change, clear
-		lines_.clear();
-		lines_.push_back(0);
+		lines_.assign(1, 0);
 		log::info(3, "MapObjectCreateDeleteUS: No lines added/deleted");
 	}
 
 	// Check sides changed
-	bool sides_changed = false;
-	if (map->nSides() != sides_.size())
-		sides_changed = true;
-	else
-		for (unsigned a = 0; a < map->nSides(); a++)
-			if (map->side(a)->objId() != sides_[a])
-			{
-				sides_changed = true;
-				break;
-			}
-	if (!sides_changed)
+	if (sameIds(map->sides(), sides_))
 	{
 		// No change, clear
-		sides_.clear();
-		sides_.push_back(0);
+		sides_.assign(1, 0);
 		log::info(3, "MapObjectCreateDeleteUS: No sides added/deleted");
 	}
 
 	// Check sectors changed
-	bool sectors_changed = false;
-	if (map->nSectors() != sectors_.size())
-		sectors_changed = true;
-	else
-		for (unsigned a = 0; a < map->nSectors(); a++)
-			if (map->sector(a)->objId() != sectors_[a])
-			{
-				sectors_changed = true;
-				break;
-			}
-	if (!sectors_changed)
+	if (sameIds(map->sectors(), sectors_))
 	{
 		// No change, clear
-		sectors_.clear();
-		sectors_.push_back(0);
+		sectors_.assign(1, 0);
 		log::info(3, "MapObjectCreateDeleteUS: No sectors added/deleted");
 	}
 
 	// Check things changed
-	bool things_changed = false;
-	if (map->nThings() != things_.size())
-		things_changed = true;
-	else
-		for (unsigned a = 0; a < map->nThings(); a++)
-			if (map->thing(a)->objId() != things_[a])
-			{
-				things_changed = true;
-				break;
-			}
-	if (!things_changed)
+	if (sameIds(map->things(), things_))
 	{
 		// No change, clear
-		things_.clear();
-		things_.push_back(0);
+		things_.assign(1, 0);
 		log::info(3, "MapObjectCreateDeleteUS: No things added/deleted");
 	}
 }
@@ -218,44 +517,74 @@ bool MapObjectCreateDeleteUS::isOk()
 		&& sides_[0] == 0 && sectors_.size() == 1 && sectors_[0] == 0 && things_.size() == 1 && things_[0] == 0);
 }
 
+bool MapObjectCreateDeleteUS::writeFile(MemChunk& mc)
+{
+	writeIds(mc, vertices_);
+	writeIds(mc, lines_);
+	writeIds(mc, sides_);
+	writeIds(mc, sectors_);
+	writeIds(mc, things_);
+	return true;
+}
+
+bool MapObjectCreateDeleteUS::readFile(MemChunk& mc)
+{
+	return readIds(mc, vertices_) && readIds(mc, lines_) && readIds(mc, sides_) && readIds(mc, sectors_)
+		   && readIds(mc, things_);
+}
+
+void MapObjectCreateDeleteUS::unload()
+{
+	vertices_ = {};
+	lines_    = {};
+	sides_    = {};
+	sectors_  = {};
+	things_   = {};
+}
+
+size_t MapObjectCreateDeleteUS::memUsage() const
+{
+	return (vertices_.capacity() + lines_.capacity() + sides_.capacity() + sectors_.capacity() + things_.capacity())
+		   * sizeof(unsigned);
+}
+
 
 
 MultiMapObjectPropertyChangeUS::MultiMapObjectPropertyChangeUS()
 {
-	// Get backups of recently modified map objects
+	// Get backups of recently modified map objects, keeping only what changed
 	auto objects = undoredo::currentMap()->mapData().allModifiedObjects(MapObject::propBackupTime());
 	for (auto& object : objects)
 	{
 		auto bak = object->backup(true);
 		if (bak)
 		{
-			backups_.emplace_back(bak);
-			// log::info(1, "%s #%d modified", objects[a]->getTypeName(), objects[a]->getIndex());
+			MapObjectDelta delta{ unique_ptr<MapObject::Backup>(bak) };
+			delta.strip(object);
+			if (!delta.empty())
+				deltas_.push_back(std::move(delta));
 		}
 	}
 
 	if (log::verbosity() >= 2)
 	{
 		string msg = "Modified ids: ";
-		for (auto& backup : backups_)
-			msg += fmt::format("{}, ", backup->id);
+		for (auto& delta : deltas_)
+			msg += fmt::format("{}, ", delta.objId());
 		log::info(msg);
 	}
 }
 
 void MultiMapObjectPropertyChangeUS::doSwap(MapObject* obj, unsigned index)
 {
-	auto temp = std::make_unique<MapObject::Backup>();
-	obj->backupTo(temp.get());
-	obj->loadFromBackup(backups_[index].get());
-	backups_[index].swap(temp);
+	deltas_[index].swap(obj);
 }
 
 bool MultiMapObjectPropertyChangeUS::doUndo()
 {
-	for (unsigned a = 0; a < backups_.size(); a++)
+	for (unsigned a = 0; a < deltas_.size(); a++)
 	{
-		auto obj = undoredo::currentMap()->mapData().getObjectById(backups_[a]->id);
+		auto obj = undoredo::currentMap()->mapData().getObjectById(deltas_[a].objId());
 		if (obj)
 			doSwap(obj, a);
 	}
@@ -265,13 +594,49 @@ bool MultiMapObjectPropertyChangeUS::doUndo()
 
 bool MultiMapObjectPropertyChangeUS::doRedo()
 {
-	// log::info(2, "Restore %lu objects", backups.size());
-	for (unsigned a = 0; a < backups_.size(); a++)
+	for (unsigned a = 0; a < deltas_.size(); a++)
 	{
-		auto obj = undoredo::currentMap()->mapData().getObjectById(backups_[a]->id);
+		auto obj = undoredo::currentMap()->mapData().getObjectById(deltas_[a].objId());
 		if (obj)
 			doSwap(obj, a);
 	}
 
 	return true;
 }
+
+size_t MultiMapObjectPropertyChangeUS::memUsage() const
+{
+	size_t size = deltas_.capacity() * sizeof(MapObjectDelta);
+	for (auto& delta : deltas_)
+		size += delta.memUsage();
+
+	return size;
+}
+
+bool MultiMapObjectPropertyChangeUS::writeFile(MemChunk& mc)
+{
+	writeValue(mc, static_cast<uint32_t>(deltas_.size()));
+	for (auto& delta : deltas_)
+		delta.write(mc);
+
+	return true;
+}
+
+bool MultiMapObjectPropertyChangeUS::readFile(MemChunk& mc)
+{
+	uint32_t count = 0;
+	if (!readValue(mc, count) || count != deltas_.size())
+		return false;
+
+	for (auto& delta : deltas_)
+		if (!delta.read(mc))
+			return false;
+
+	return true;
+}
+
+void MultiMapObjectPropertyChangeUS::unload()
+{
+	for (auto& delta : deltas_)
+		delta.unload();
+}
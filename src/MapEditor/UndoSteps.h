@@ -5,6 +5,33 @@
 
 namespace slade::mapeditor
 {
+// The state of a MapObject's properties, stored as only the properties that
+// differ from the object's current state once strip() has been called (rather
+// than a full backup of the object)
+class MapObjectDelta
+{
+public:
+	MapObjectDelta(unique_ptr<MapObject::Backup> backup) : backup_{ std::move(backup) } {}
+	~MapObjectDelta() = default;
+
+	unsigned objId() const { return backup_->id; }
+	bool     empty() const;
+	size_t   memUsage() const;
+
+	void strip(MapObject* obj);
+	void swap(MapObject* obj);
+
+	void write(MemChunk& mc) const;
+	bool read(MemChunk& mc);
+	void unload();
+
+private:
+	unique_ptr<MapObject::Backup> backup_;
+	vector<MobjPropertyList::Id>  absent_;          // Properties the object has that the backup doesn't
+	vector<MobjPropertyList::Id>  absent_internal_; // As above, for internal properties
+	bool                          stripped_ = false;
+};
+
 // UndoStep for when a MapObject has properties changed
 class PropertyChangeUS : public UndoStep
 {
@@ -12,12 +39,17 @@ public:
 	PropertyChangeUS(MapObject* object);
 	~PropertyChangeUS() = default;
 
-	void doSwap(MapObject* obj);
-	bool doUndo() override;
-	bool doRedo() override;
+	void   doSwap(MapObject* obj);
+	bool   doUndo() override;
+	bool   doRedo() override;
+	void   recordEnded() override;
+	size_t memUsage() const override { return delta_.memUsage(); }
+	bool   writeFile(MemChunk& mc) override;
+	bool   readFile(MemChunk& mc) override;
+	void   unload() override { delta_.unload(); }
 
 private:
-	unique_ptr<MapObject::Backup> backup_;
+	MapObjectDelta delta_;
 };
 
 // UndoStep for when a MapObject is either created or deleted
@@ -31,10 +63,16 @@ public:
 	void swapLists();
 	bool doUndo() override;
 	bool doRedo() override;
-	void checkChanges();
-	bool isOk() override;
+	void   checkChanges();
+	bool   isOk() override;
+	size_t memUsage() const override;
+	bool   writeFile(MemChunk& mc) override;
+	bool   readFile(MemChunk& mc) override;
+	void   unload() override;
 
 private:
+	// Object id lists are stored as runs of consecutive ids (first id, count),
+	// or a single 0 if there was no change
 	vector<unsigned> vertices_;
 	vector<unsigned> lines_;
 	vector<unsigned> sides_;
@@ -49,12 +87,16 @@ public:
 	MultiMapObjectPropertyChangeUS();
 	~MultiMapObjectPropertyChangeUS() = default;
 
-	void doSwap(MapObject* obj, unsigned index);
-	bool doUndo() override;
-	bool doRedo() override;
-	bool isOk() override { return !backups_.empty(); }
+	void   doSwap(MapObject* obj, unsigned index);
+	bool   doUndo() override;
+	bool   doRedo() override;
+	bool   isOk() override { return !deltas_.empty(); }
+	size_t memUsage() const override;
+	bool   writeFile(MemChunk& mc) override;
+	bool   readFile(MemChunk& mc) override;
+	void   unload() override;
 
 private:
-	vector<unique_ptr<MapObject::Backup>> backups_;
+	vector<MapObjectDelta> deltas_;
 };
 } // namespace slade::mapeditor
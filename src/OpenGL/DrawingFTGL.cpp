@@ -35,8 +35,13 @@
 #include "Archive/ArchiveEntry.h"
 #include "Archive/ArchiveManager.h"
 #include "Drawing.h"
+#include "FrameBuffer.h"
+#include "GLTexture.h"
 #include "MapEditor/UI/MapCanvas.h"
+#include "OpenGL.h"
+#include "Shader.h"
 #include "Utility/MathStuff.h"
+#include "VertexBuffer2D.h"
 #include <FTGL/ftgl.h>
 
 using namespace slade;
@@ -57,6 +62,70 @@ unique_ptr<FTFont> font_mono;
 unique_ptr<FTFont> font_small;
 } // namespace slade::drawing
 
+namespace
+{
+// A glyph rendered into the text atlas. The quad is relative to the pen
+// position on the baseline (in screen space, so y is down)
+struct Glyph
+{
+	bool  empty = true;
+	float x1, y1, x2, y2;
+	float u1, v1, u2, v2;
+};
+
+// The cached layout of a string: glyph quads relative to the top-left of the
+// text and its FTGL bounding box (for alignment and bounds)
+struct TextLayout
+{
+	vector<Glyph> quads;
+	float         bbox_x1 = 0.f;
+	float         bbox_y1 = 0.f;
+	float         bbox_x2 = 0.f;
+};
+
+constexpr int      ATLAS_SIZE  = 1024;
+constexpr unsigned MAX_LAYOUTS = 2048;
+
+unique_ptr<gl::FrameBuffer>            atlas;
+unique_ptr<gl::VertexBuffer2D>         text_buffer;
+unique_ptr<gl::Shader>                 text_shader;
+std::unordered_map<string, Glyph>      glyphs;
+std::unordered_map<string, TextLayout> layouts;
+int                                    atlas_x      = 0;
+int                                    atlas_y      = 0;
+int                                    atlas_row_h  = 0;
+bool                                   atlas_dirty  = true;
+bool                                   atlas_failed = false;
+int                                    batch_depth  = 0;
+
+const char* shader_vert_text = R"(#version 330 core
+in vec2 in_position;
+in vec4 in_colour;
+in vec2 in_texcoord;
+uniform mat4 mvp;
+out vec4 colour;
+out vec2 texcoord;
+void main()
+{
+	colour      = in_colour;
+	texcoord    = in_texcoord;
+	gl_Position = mvp * vec4(in_position, 0.0, 1.0);
+}
+)";
+
+// Glyph coverage is stored in the red channel of the atlas
+const char* shader_frag_text = R"(#version 330 core
+in vec4 colour;
+in vec2 texcoord;
+uniform sampler2D tex;
+out vec4 frag_colour;
+void main()
+{
+	frag_colour = vec4(colour.rgb, colour.a * texture(tex, texcoord).r);
+}
+)";
+} // namespace
+
 
 // -----------------------------------------------------------------------------
 //
@@ -86,6 +155,9 @@ int initFonts()
 	// --- Load general fonts ---
 	int ret = 0;
 
+	// Glyphs need to be re-rendered for the new fonts
+	atlas_dirty = true;
+
 	font_normal.reset();
 	font_condensed.reset();
 	font_bold.reset();
@@ -185,6 +257,11 @@ int initFonts()
 // -----------------------------------------------------------------------------
 void cleanupFonts()
 {
+	atlas.reset();
+	text_buffer.reset();
+	text_shader.reset();
+	atlas_dirty = true;
+
 	font_normal.reset();
 	font_condensed.reset();
 	font_bold.reset();
@@ -211,6 +288,310 @@ FTFont* getFont(Font font)
 }
 } // namespace slade::drawing
 
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the number of bytes in the UTF-8 sequence starting with [lead]
+// -----------------------------------------------------------------------------
+unsigned utf8Length(uint8_t lead)
+{
+	if ((lead & 0xE0) == 0xC0)
+		return 2;
+	if ((lead & 0xF0) == 0xE0)
+		return 3;
+	if ((lead & 0xF8) == 0xF0)
+		return 4;
+	return 1;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the text shader program, loading it first if needed.
+// Returns nullptr if it failed to load
+// -----------------------------------------------------------------------------
+const gl::Shader* textShader()
+{
+	if (!text_shader)
+	{
+		text_shader = std::make_unique<gl::Shader>("text");
+		text_shader->load(shader_vert_text, shader_frag_text);
+	}
+
+	return text_shader->isValid() ? text_shader.get() : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if text can be drawn via the glyph atlas, setting up (or
+// clearing) the atlas first if needed
+// -----------------------------------------------------------------------------
+bool setupAtlas()
+{
+	if (atlas_failed)
+		return false;
+
+	if (!gl::shaderSupport() || !gl::fboSupport())
+	{
+		atlas_failed = true;
+		return false;
+	}
+
+	if (!atlas)
+	{
+		atlas = std::make_unique<gl::FrameBuffer>();
+		if (!atlas->setup(ATLAS_SIZE, ATLAS_SIZE) || !textShader())
+		{
+			log::warning("Unable to set up the text glyph atlas, falling back to direct text rendering");
+			atlas_failed = true;
+			atlas.reset();
+			return false;
+		}
+		text_buffer = std::make_unique<gl::VertexBuffer2D>();
+	}
+
+	if (atlas_dirty)
+	{
+		GLint fbo = 0;
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING, &fbo);
+		glPushAttrib(GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT);
+		glDisable(GL_SCISSOR_TEST);
+		atlas->bind();
+		glClearColor(0.f, 0.f, 0.f, 0.f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glPopAttrib();
+
+		glyphs.clear();
+		layouts.clear();
+		atlas_x     = 0;
+		atlas_y     = 0;
+		atlas_row_h = 0;
+		atlas_dirty = false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Draws all text in the current batch in a single draw call, and clears it
+// -----------------------------------------------------------------------------
+void flushTextBatch()
+{
+	if (!text_buffer || text_buffer->empty())
+		return;
+
+	auto shader = textShader();
+	if (!shader)
+	{
+		text_buffer->clear();
+		return;
+	}
+
+	// Batched vertices are already transformed by the modelview matrix at the
+	// time each string was added
+	glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	shader->bind();
+	shader->setFixedFunctionMVP();
+	shader->setUniform("tex", 0);
+	gl::Texture::bind(atlas->texture());
+	text_buffer->draw(GL_TRIANGLES, shader, true);
+	gl::Shader::unbind();
+
+	glPopMatrix();
+	glPopAttrib();
+
+	text_buffer->clear();
+}
+
+// -----------------------------------------------------------------------------
+// Renders character [ch] (UTF-8) of [font] into the atlas, and returns its
+// glyph info. Returns nullptr if the atlas is full
+// -----------------------------------------------------------------------------
+const Glyph* addGlyph(FTFont* font, const string& key, const string& ch)
+{
+	Glyph glyph;
+
+	// Get glyph size (including 1 pixel of padding around it)
+	auto bbox = font->BBox(ch.c_str(), -1);
+	auto lx   = std::floor(bbox.Lower().Xf()) - 1;
+	auto ly   = std::floor(bbox.Lower().Yf()) - 1;
+	auto w    = static_cast<int>(std::ceil(bbox.Upper().Xf()) + 1 - lx);
+	auto h    = static_cast<int>(std::ceil(bbox.Upper().Yf()) + 1 - ly);
+	if (bbox.Upper().Xf() <= bbox.Lower().Xf() || bbox.Upper().Yf() <= bbox.Lower().Yf())
+		return &(glyphs[key] = glyph);
+
+	// Find space in the atlas (rows of glyphs, left to right)
+	if (atlas_x + w > ATLAS_SIZE)
+	{
+		atlas_x = 0;
+		atlas_y += atlas_row_h + 1;
+		atlas_row_h = 0;
+	}
+	if (atlas_y + h > ATLAS_SIZE || w > ATLAS_SIZE)
+		return nullptr;
+
+	// Render the glyph (white, so the resulting colour is its coverage) with
+	// FTGL into its space in the atlas
+	GLint fbo = 0;
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &fbo);
+	glPushAttrib(GL_VIEWPORT_BIT | GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT);
+	glDisable(GL_SCISSOR_TEST);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_ALPHA_TEST);
+	atlas->bind();
+	glViewport(0, 0, ATLAS_SIZE, ATLAS_SIZE);
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho(0, ATLAS_SIZE, 0, ATLAS_SIZE, -1, 1);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+	glTranslatef(atlas_x - lx, atlas_y - ly, 0.f);
+	glColor4f(1.f, 1.f, 1.f, 1.f);
+	font->Render(ch.c_str(), -1);
+	glPopMatrix();
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glPopAttrib();
+
+	glyph.empty = false;
+	glyph.x1    = lx;
+	glyph.x2    = lx + w;
+	glyph.y1    = -(ly + h);
+	glyph.y2    = -ly;
+	glyph.u1    = static_cast<float>(atlas_x) / ATLAS_SIZE;
+	glyph.u2    = static_cast<float>(atlas_x + w) / ATLAS_SIZE;
+	glyph.v1    = static_cast<float>(atlas_y + h) / ATLAS_SIZE;
+	glyph.v2    = static_cast<float>(atlas_y) / ATLAS_SIZE;
+
+	atlas_x += w + 1;
+	atlas_row_h = std::max(atlas_row_h, h);
+
+	return &(glyphs[key] = glyph);
+}
+
+// -----------------------------------------------------------------------------
+// Builds the layout of [text] drawn with [font] (id [font_id]), adding any
+// glyphs not yet in the atlas.
+// Returns nullptr if the atlas is full
+// -----------------------------------------------------------------------------
+unique_ptr<TextLayout> buildLayout(FTFont* font, char font_id, const string& text)
+{
+	auto layout = std::make_unique<TextLayout>();
+	auto bbox   = font->BBox(text.c_str(), -1);
+	auto face   = static_cast<float>(font->FaceSize());
+
+	layout->bbox_x1 = bbox.Lower().Xf();
+	layout->bbox_y1 = bbox.Lower().Yf();
+	layout->bbox_x2 = bbox.Upper().Xf();
+
+	int index = 0;
+	for (size_t pos = 0; pos < text.size(); ++index)
+	{
+		auto len = std::min<size_t>(utf8Length(text[pos]), text.size() - pos);
+		auto ch  = text.substr(pos, len);
+		pos += len;
+
+		// Get glyph, adding it to the atlas if needed
+		auto key   = font_id + ch;
+		auto i     = glyphs.find(key);
+		auto glyph = i != glyphs.end() ? &i->second : addGlyph(font, key, ch);
+		if (!glyph)
+			return nullptr;
+		if (glyph->empty)
+			continue;
+
+		// Pen position from the advance of all previous characters (so
+		// kerning is included)
+		auto pen  = index > 0 ? std::round(font->Advance(text.c_str(), index)) : 0.f;
+		auto quad = *glyph;
+		quad.x1 += pen - 0.375f;
+		quad.x2 += pen - 0.375f;
+		quad.y1 += face - 0.375f;
+		quad.y2 += face - 0.375f;
+		layout->quads.push_back(quad);
+	}
+
+	return layout;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the (cached) layout of [text] drawn with [font], or nullptr if the
+// glyph atlas can't be used
+// -----------------------------------------------------------------------------
+const TextLayout* textLayout(FTFont* ftgl_font, drawing::Font font, const string& text)
+{
+	if (!setupAtlas())
+		return nullptr;
+
+	auto font_id = static_cast<char>('0' + static_cast<int>(font));
+	auto key     = font_id + text;
+	auto i       = layouts.find(key);
+	if (i != layouts.end())
+		return &i->second;
+
+	auto layout = buildLayout(ftgl_font, font_id, text);
+	if (!layout)
+	{
+		// Atlas is full, draw what's batched so far and start again with an
+		// empty atlas
+		flushTextBatch();
+		atlas_dirty = true;
+		if (!setupAtlas())
+			return nullptr;
+		layout = buildLayout(ftgl_font, font_id, text);
+		if (!layout)
+			return nullptr;
+	}
+
+	// Keep the layout cache from growing indefinitely (eg. from constantly
+	// changing strings)
+	if (layouts.size() >= MAX_LAYOUTS)
+		layouts.clear();
+
+	return &(layouts[key] = std::move(*layout));
+}
+
+// -----------------------------------------------------------------------------
+// Adds the glyph quads in [layout] at [x,y] with [colour] to the text batch
+// -----------------------------------------------------------------------------
+void addLayout(const TextLayout& layout, float x, float y, const ColRGBA& colour)
+{
+	float mv[16];
+	glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+	auto add = [&](float vx, float vy, float u, float v)
+	{
+		vx += x;
+		vy += y;
+		text_buffer->add(mv[0] * vx + mv[4] * vy + mv[12], mv[1] * vx + mv[5] * vy + mv[13], u, v, colour);
+	};
+
+	for (auto& quad : layout.quads)
+	{
+		add(quad.x1, quad.y1, quad.u1, quad.v1);
+		add(quad.x2, quad.y1, quad.u2, quad.v1);
+		add(quad.x2, quad.y2, quad.u2, quad.v2);
+		add(quad.x1, quad.y1, quad.u1, quad.v1);
+		add(quad.x2, quad.y2, quad.u2, quad.v2);
+		add(quad.x1, quad.y2, quad.u1, quad.v2);
+	}
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 // Draws [text] at [x,y]. If [bounds] is not null, the bounding coordinates of
 // the rendered text string are written to it.
@@ -224,6 +605,39 @@ void drawing::drawText(const string& text, int x, int y, ColRGBA colour, Font fo
 	if (!ftgl_font)
 		return;
 
+	// Add to the text batch via the glyph atlas if possible
+	if (auto layout = textLayout(ftgl_font, font, text))
+	{
+		int   xpos  = x;
+		float width = layout->bbox_x2 - layout->bbox_x1;
+		if (alignment == Align::Center)
+			xpos -= math::round(width * 0.5);
+		else if (alignment == Align::Right)
+			xpos -= width;
+
+		if (bounds)
+			bounds->set(
+				xpos + layout->bbox_x1,
+				y + layout->bbox_y1,
+				xpos + layout->bbox_x2,
+				y + layout->bbox_y1 + ftgl_font->LineHeight());
+
+		// Outline (same offsets as direct rendering below)
+		if (text_outline_width > 0)
+		{
+			addLayout(*layout, xpos - 2, y + 1, outline_colour);
+			addLayout(*layout, xpos - 2, y - 1, outline_colour);
+			addLayout(*layout, xpos + 2, y - 1, outline_colour);
+			addLayout(*layout, xpos + 2, y + 1, outline_colour);
+		}
+		addLayout(*layout, xpos, y, colour);
+
+		if (batch_depth == 0)
+			flushTextBatch();
+
+		return;
+	}
+
 	// Setup alignment
 	auto  bbox   = ftgl_font->BBox(text.c_str(), -1);
 	int   xpos   = x;
@@ -281,6 +695,10 @@ Vec2d drawing::textExtents(const string& text, Font font)
 	if (!ftgl_font)
 		return { 0, 0 };
 
+	// Use the cached layout if possible
+	if (auto layout = textLayout(ftgl_font, font, text))
+		return { layout->bbox_x2 - layout->bbox_x1, ftgl_font->LineHeight() };
+
 	// Return width and height of text
 	auto bbox = ftgl_font->BBox(text.c_str(), -1);
 	return Vec2d(bbox.Upper().X() - bbox.Lower().X(), ftgl_font->LineHeight());
@@ -298,4 +716,25 @@ void drawing::setTextState(bool set) {}
 // -----------------------------------------------------------------------------
 void drawing::enableTextStateReset(bool enable) {}
 
+// -----------------------------------------------------------------------------
+// Begins a text batch: text drawn until the matching endTextBatch call is
+// collected and drawn in a single draw call (on top of anything else drawn in
+// the meantime). Batches can be nested, the text is drawn when the outermost
+// batch ends. The projection must not change within a batch
+// -----------------------------------------------------------------------------
+void drawing::beginTextBatch()
+{
+	++batch_depth;
+}
+
+// -----------------------------------------------------------------------------
+// Ends the current text batch, drawing all batched text if it was the
+// outermost
+// -----------------------------------------------------------------------------
+void drawing::endTextBatch()
+{
+	if (batch_depth > 0 && --batch_depth == 0)
+		flushTextBatch();
+}
+
 #endif
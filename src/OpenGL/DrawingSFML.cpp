@@ -264,6 +264,16 @@ void drawing::enableTextStateReset(bool enable)
 	text_state_reset = enable;
 }
 
+// -----------------------------------------------------------------------------
+// Begins a text batch (does nothing for SFML, text is drawn immediately)
+// -----------------------------------------------------------------------------
+void drawing::beginTextBatch() {}
+
+// -----------------------------------------------------------------------------
+// Ends the current text batch (does nothing for SFML)
+// -----------------------------------------------------------------------------
+void drawing::endTextBatch() {}
+
 // -----------------------------------------------------------------------------
 // Sets the SFML render target to [target]
 // -----------------------------------------------------------------------------
@@ -0,0 +1,133 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    FrameBuffer.cpp
+// Description: FrameBuffer class - an offscreen render target (framebuffer
+//              object with a colour texture attached)
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "FrameBuffer.h"
+#include "GLTexture.h"
+#include "OpenGL.h"
+
+using namespace slade;
+using namespace gl;
+
+
+// -----------------------------------------------------------------------------
+//
+// FrameBuffer Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// FrameBuffer class destructor
+// -----------------------------------------------------------------------------
+FrameBuffer::~FrameBuffer()
+{
+	clear();
+}
+
+// -----------------------------------------------------------------------------
+// (Re)creates the framebuffer with a colour texture of [width]x[height], if it
+// doesn't already exist at that size.
+// Returns false if framebuffers aren't supported or it couldn't be created
+// -----------------------------------------------------------------------------
+bool FrameBuffer::setup(int width, int height)
+{
+	if (fbo_ > 0 && width == width_ && height == height_)
+		return true;
+
+	clear();
+
+	if (!fboSupport() || width <= 0 || height <= 0 || !validTexDimension(width) || !validTexDimension(height))
+		return false;
+
+	// Create colour texture (not registered with gl::Texture, so it isn't
+	// deleted along with all other textures when resources are reloaded)
+	glGenTextures(1, &texture_);
+	Texture::bind(texture_);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	Texture::bind(0);
+
+	// Create framebuffer
+	glGenFramebuffers(1, &fbo_);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture_, 0);
+	auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		log::warning("Unable to create {}x{} framebuffer (status {:#x})", width, height, status);
+		clear();
+		return false;
+	}
+
+	width_  = width;
+	height_ = height;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Makes this the current render target
+// -----------------------------------------------------------------------------
+void FrameBuffer::bind() const
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+}
+
+// -----------------------------------------------------------------------------
+// Deletes the framebuffer and its texture
+// -----------------------------------------------------------------------------
+void FrameBuffer::clear()
+{
+	if (fbo_ > 0 && glDeleteFramebuffers)
+		glDeleteFramebuffers(1, &fbo_);
+	if (texture_ > 0 && glDeleteTextures)
+		glDeleteTextures(1, &texture_);
+
+	fbo_     = 0;
+	texture_ = 0;
+	width_   = 0;
+	height_  = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the render target back to the default (window) framebuffer
+// -----------------------------------------------------------------------------
+void FrameBuffer::unbind()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+namespace slade
+{
+namespace gl
+{
+	// An offscreen render target: a framebuffer object with an RGBA colour
+	// texture attached, which can be drawn to and then rendered as a texture
+	class FrameBuffer
+	{
+	public:
+		FrameBuffer() = default;
+		~FrameBuffer();
+
+		// Non-copyable (owns GL framebuffer and texture objects)
+		FrameBuffer(const FrameBuffer&) = delete;
+		FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+		unsigned texture() const { return texture_; }
+		int      width() const { return width_; }
+		int      height() const { return height_; }
+		bool     isValid() const { return fbo_ > 0; }
+
+		bool setup(int width, int height);
+		void bind() const;
+		void clear();
+
+		static void unbind();
+
+	private:
+		unsigned fbo_     = 0;
+		unsigned texture_ = 0;
+		int      width_   = 0;
+		int      height_  = 0;
+	};
+} // namespace gl
+} // namespace slade
@@ -31,8 +31,10 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "GLTexture.h"
+#include "General/MemoryStats.h"
 #include "Graphics/SImage/SImage.h"
 #include "OpenGL.h"
+#include "Shader.h"
 
 using namespace slade;
 
@@ -44,12 +46,91 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 CVAR(String, bgtx_colour1, "#404050", CVar::Flag::Save)
 CVAR(String, bgtx_colour2, "#505060", CVar::Flag::Save)
+CVAR(Bool, gl_indexed_textures, true, CVar::Flag::Save)
 namespace
 {
 std::map<unsigned, gl::Texture> textures;
 gl::Texture                     tex_missing;
 gl::Texture                     tex_background;
 unsigned                        last_bound_tex = 0;
+unique_ptr<gl::Shader>          indexed_shader;
+
+// Resolves an indexed texture's palette index (red) against row [palette_row]
+// of the [palette] texture, with alpha from green (always 1 if unmasked)
+const char* shader_vert_indexed = R"(#version 330 core
+in vec2 in_position;
+in vec4 in_colour;
+in vec2 in_texcoord;
+uniform mat4 mvp;
+out vec4 colour;
+out vec2 texcoord;
+void main()
+{
+	colour      = in_colour;
+	texcoord    = in_texcoord;
+	gl_Position = mvp * vec4(in_position, 0.0, 1.0);
+}
+)";
+
+const char* shader_frag_indexed = R"(#version 330 core
+in vec4 colour;
+in vec2 texcoord;
+uniform sampler2D tex;
+uniform sampler2D palette;
+uniform int palette_row;
+out vec4 frag_colour;
+void main()
+{
+	vec2 texel  = texture(tex, texcoord).rg;
+	vec3 rgb    = texelFetch(palette, ivec2(int(texel.r * 255.0 + 0.5), palette_row), 0).rgb;
+	frag_colour = vec4(rgb, texel.g) * colour;
+}
+)";
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the (estimated) amount of video memory used by [tex], in bytes
+// -----------------------------------------------------------------------------
+size_t texMemUsage(const gl::Texture& tex)
+{
+	size_t bpp = 4;
+	if (tex.format == gl::TexFormat::Indexed)
+		bpp = 1;
+	else if (tex.format == gl::TexFormat::IndexedMasked)
+		bpp = 2;
+
+	size_t usage = static_cast<size_t>(tex.size.x) * tex.size.y * bpp;
+
+	// Mipmaps add roughly another third
+	if (tex.filter == gl::TexFilter::Mipmap || tex.filter == gl::TexFilter::LinearMipmap
+		|| tex.filter == gl::TexFilter::NearestMipmap)
+		usage += usage / 3;
+
+	return usage;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the shader program for drawing indexed textures, compiling it first
+// if needed. Returns null if it couldn't be compiled
+// -----------------------------------------------------------------------------
+const gl::Shader* indexedShader()
+{
+	if (!indexed_shader)
+	{
+		indexed_shader = std::make_unique<gl::Shader>("indexed_texture");
+		indexed_shader->load(shader_vert_indexed, shader_frag_indexed);
+	}
+
+	return indexed_shader->isValid() ? indexed_shader.get() : nullptr;
+}
 } // namespace
 
 
@@ -139,6 +220,7 @@ void gl::Texture::resetBackgroundTexture()
 		return;
 
 	glDeleteTextures(1, &tex_background.id);
+	memstats::freed(memstats::Category::GLTexture, texMemUsage(tex_background));
 
 	textures[tex_background.id] = {};
 	tex_background              = {};
@@ -271,7 +353,14 @@ bool gl::Texture::loadData(unsigned id, const uint8_t* data, unsigned width, uns
 		glTexImage2D(GL_TEXTURE_2D, 0, 4, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
 	}
 
-	tex_info.size = { (int)width, (int)height };
+	// Reset the channel swizzle if this was previously an indexed texture
+	if (tex_info.format != TexFormat::RGBA)
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_GREEN);
+
+	memstats::freed(memstats::Category::GLTexture, texMemUsage(tex_info));
+	tex_info.size   = { (int)width, (int)height };
+	tex_info.format = TexFormat::RGBA;
+	memstats::allocated(memstats::Category::GLTexture, texMemUsage(tex_info));
 
 	return true;
 }
@@ -355,6 +444,134 @@ bool gl::Texture::genChequeredTexture(unsigned id, uint8_t block_size, ColRGBA c
 	return loadData(id, data.data(), block_size * 2, block_size * 2);
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if indexed textures are supported (and enabled)
+// -----------------------------------------------------------------------------
+bool gl::Texture::indexedSupport()
+{
+	return gl_indexed_textures && gl::shaderSupport() && indexedShader();
+}
+
+// -----------------------------------------------------------------------------
+// Loads indexed [data] of [width]x[height] to the OpenGL texture [id]. If
+// [masked] is true, [data] is palette index and alpha pairs, otherwise it is
+// just palette indices. [data] can be null to allocate the texture only.
+// Palette indices can't be interpolated, so indexed textures are always
+// sampled as 'nearest' regardless of the texture's filter
+// -----------------------------------------------------------------------------
+bool gl::Texture::loadIndexedData(unsigned id, const uint8_t* data, unsigned width, unsigned height, bool masked)
+{
+	if (!indexedSupport())
+		return false;
+
+	// Check given id
+	if (id == 0 || id == tex_missing.id || id == tex_background.id)
+	{
+		log::warning("Unable to load OpenGL texture with id {} - invalid or built-in texture", id);
+		return false;
+	}
+
+	// Check image dimensions
+	if (!validTexDimension(width) || !validTexDimension(height))
+	{
+		log::warning("Attempt to create OpenGL texture of invalid size {}x{}", width, height);
+		return false;
+	}
+
+	bind(id);
+
+	// Set texture params
+	auto& tex_info = textures[id];
+	auto  wrap     = tex_info.tiling ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+	// Unmasked textures have no alpha channel, so read it as 1
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, masked ? GL_GREEN : GL_ONE);
+
+	// Generate the texture
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if (masked)
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8, width, height, 0, GL_RG, GL_UNSIGNED_BYTE, data);
+	else
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, data);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	memstats::freed(memstats::Category::GLTexture, texMemUsage(tex_info));
+	tex_info.size   = { (int)width, (int)height };
+	tex_info.format = masked ? TexFormat::IndexedMasked : TexFormat::Indexed;
+	memstats::allocated(memstats::Category::GLTexture, texMemUsage(tex_info));
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Loads paletted [image] to the OpenGL texture [id] as an indexed texture.
+// The alpha channel is only included if the image has any transparency.
+// Returns false if the image isn't paletted or indexed textures aren't
+// supported, in which case loadImage should be used instead
+// -----------------------------------------------------------------------------
+bool gl::Texture::loadIndexed(unsigned id, const SImage& image)
+{
+	if (image.type() != SImage::Type::PalMask || !indexedSupport())
+		return false;
+
+	MemChunk data;
+	auto     masked = !image.isOpaque();
+	if (masked ? !image.putIndexedMaskData(data) : !image.putIndexedData(data))
+		return false;
+
+	return loadIndexedData(id, data.data(), image.width(), image.height(), masked);
+}
+
+// -----------------------------------------------------------------------------
+// Loads [colours] to the OpenGL texture [id] as a palette texture for indexed
+// textures, 256 colours per row (the last row is padded with black if needed)
+// -----------------------------------------------------------------------------
+bool gl::Texture::loadPalettes(unsigned id, const vector<ColRGBA>& colours)
+{
+	unsigned rows = (colours.size() + 255) / 256;
+	if (rows == 0)
+		return false;
+
+	vector<uint8_t> data(rows * 256 * 4);
+	for (unsigned a = 0; a < colours.size(); ++a)
+	{
+		colours[a].write(data.data() + a * 4);
+		data[a * 4 + 3] = 255;
+	}
+
+	return loadData(id, data.data(), 256, rows);
+}
+
+// -----------------------------------------------------------------------------
+// Binds the shader program for drawing indexed textures (via VertexBuffer2D),
+// using row [palette_row] of palette texture [palette_id]. The indexed texture
+// to draw should be bound as usual (to texture unit 0).
+// Returns null if indexed textures aren't supported
+// -----------------------------------------------------------------------------
+const gl::Shader* gl::Texture::bindIndexedShader(unsigned palette_id, int palette_row)
+{
+	if (!indexedSupport())
+		return nullptr;
+
+	// Palette goes on texture unit 1
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, palette_id);
+	glActiveTexture(GL_TEXTURE0);
+
+	auto shader = indexedShader();
+	shader->bind();
+	shader->setFixedFunctionMVP();
+	shader->setUniform("tex", 0);
+	shader->setUniform("palette", 1);
+	shader->setUniform("palette_row", palette_row);
+
+	return shader;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the average colour of the OpenGL texture [id] within [area]
 // -----------------------------------------------------------------------------
@@ -441,6 +658,7 @@ void gl::Texture::clear(unsigned id)
 	if (!gl::isInitialised() || id == 0 || id == tex_missing.id || id == tex_background.id || textures.empty())
 		return;
 
+	memstats::freed(memstats::Category::GLTexture, texMemUsage(textures[id]));
 	textures[id] = {};
 	glDeleteTextures(1, &id);
 }
@@ -454,7 +672,10 @@ void gl::Texture::clearAll()
 		return;
 
 	for (auto& tex : textures)
+	{
 		glDeleteTextures(1, &tex.second.id);
+		memstats::freed(memstats::Category::GLTexture, texMemUsage(tex.second));
+	}
 
 	textures.clear();
 	tex_missing    = {};
@@ -9,6 +9,8 @@ class Palette;
 
 namespace gl
 {
+	class Shader;
+
 	enum class TexFilter
 	{
 		// Filter types
@@ -20,11 +22,19 @@ namespace gl
 		NearestMipmap,
 	};
 
+	enum class TexFormat
+	{
+		RGBA,          // 4 bytes per pixel
+		Indexed,       // 1 byte per pixel: palette index (see loadIndexed)
+		IndexedMasked, // 2 bytes per pixel: palette index and alpha (see loadIndexed)
+	};
+
 	struct Texture
 	{
 		unsigned  id     = 0;
 		Vec2i     size   = { 0, 0 };
 		TexFilter filter = TexFilter::Nearest;
+		TexFormat format = TexFormat::RGBA;
 		bool      tiling = true;
 
 		static bool isCreated(unsigned id); // const { return id > 0; }
@@ -53,6 +63,17 @@ namespace gl
 		static bool loadData(unsigned id, const uint8_t* data, unsigned width, unsigned height);
 		static bool loadImage(unsigned id, const SImage& image, Palette* pal = nullptr);
 		static bool genChequeredTexture(unsigned id, uint8_t block_size, ColRGBA col1, ColRGBA col2);
+
+		// Indexed textures, which store palette indices rather than colours and
+		// are resolved by a shader against a separate palette texture, so they
+		// use less memory and changing the palette doesn't need a re-upload
+		static bool indexedSupport();
+		static bool loadIndexedData(unsigned id, const uint8_t* data, unsigned width, unsigned height, bool masked);
+		static bool loadIndexed(unsigned id, const SImage& image);
+		static bool loadPalettes(unsigned id, const vector<ColRGBA>& colours);
+
+		static const Shader* bindIndexedShader(unsigned palette_id, int palette_row = 0);
+
 		static void clear(unsigned id);
 		static void clearAll();
 	};
@@ -45,6 +45,7 @@ using namespace slade;
 CVAR(Bool, gl_point_sprite, true, CVar::Flag::Save)
 CVAR(Bool, gl_tweak_accuracy, true, CVar::Flag::Save)
 CVAR(Bool, gl_vbo, true, CVar::Flag::Save)
+CVAR(Bool, gl_shaders, true, CVar::Flag::Save)
 CVAR(Int, gl_depth_buffer_size, 24, CVar::Flag::Save)
 
 namespace slade::gl
@@ -150,6 +151,10 @@ bool gl::init()
 		log::info("Framebuffer Objects supported");
 	else
 		log::info("Framebuffer Objects not supported");
+	if (version >= 3.3)
+		log::info("GLSL 3.30 shaders supported");
+	else
+		log::info("GLSL 3.30 shaders not supported");
 
 	initialised = true;
 	return true;
@@ -182,6 +187,15 @@ bool gl::vboSupport()
 	return GLAD_GL_ARB_vertex_buffer_object && gl_vbo;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the installed OpenGL version supports GLSL 3.30 shader
+// programs (and they are enabled), false otherwise
+// -----------------------------------------------------------------------------
+bool gl::shaderSupport()
+{
+	return version >= 3.3 && GLAD_GL_VERSION_3_3 && vboSupport() && gl_shaders;
+}
+
 // -----------------------------------------------------------------------------
 // Returns true if the installed OpenGL version supports framebuffer objects,
 // false otherwise
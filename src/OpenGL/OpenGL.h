@@ -48,6 +48,7 @@ namespace gl
 	bool     np2TexSupport();
 	bool     pointSpriteSupport();
 	bool     vboSupport();
+	bool     shaderSupport();
 	bool     fboSupport();
 	bool     validTexDimension(unsigned dim);
 	float    maxPointSize();
@@ -0,0 +1,420 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Profiler.cpp
+// Description: Render profiler - CPU and GPU timing of render passes, with a
+//              rolling histogram overlay and console dump
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Profiler.h"
+#include "Drawing.h"
+#include "General/Console.h"
+#include "OpenGL.h"
+#include <chrono>
+
+using namespace slade;
+using namespace gl;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, render_profile, false, 0)
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// Number of frames GPU query results are given to become available
+constexpr unsigned QUERY_FRAMES = 3;
+
+struct Pass
+{
+	string                               name;
+	double                               cpu_frame = 0.;
+	std::array<float, profiler::HISTORY> cpu_ms{};
+	std::array<float, profiler::HISTORY> gpu_ms{};
+};
+
+struct PassState
+{
+	unsigned          pass;
+	Clock::time_point start;
+	bool              gpu;
+};
+
+struct QueryFrame
+{
+	long             frame = -1;
+	vector<unsigned> queries;
+	vector<unsigned> passes;
+	unsigned         count = 0;
+};
+
+vector<Pass>                         passes;
+vector<PassState>                    pass_stack;
+std::array<QueryFrame, QUERY_FRAMES> query_frames;
+std::array<bool, profiler::HISTORY>  gpu_valid{};
+long                                 frame        = 0;
+bool                                 frame_active = false;
+bool                                 gpu_query    = false;
+
+const ColRGBA pass_colours[] = { { 230, 80, 80 },  { 80, 200, 80 },  { 80, 140, 240 }, { 240, 200, 60 },
+								 { 200, 90, 220 }, { 70, 210, 210 }, { 240, 140, 50 }, { 160, 160, 160 } };
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if GPU timer queries are supported
+// -----------------------------------------------------------------------------
+bool timerQuerySupport()
+{
+	return gl::isInitialised() && (GLAD_GL_VERSION_3_3 || GLAD_GL_ARB_timer_query);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the pass named [name], adding it if it doesn't exist
+// -----------------------------------------------------------------------------
+unsigned passIndex(string_view name)
+{
+	for (unsigned a = 0; a < passes.size(); ++a)
+		if (passes[a].name == name)
+			return a;
+
+	passes.push_back({ string{ name } });
+	return static_cast<unsigned>(passes.size() - 1);
+}
+
+// -----------------------------------------------------------------------------
+// Reads the results of the queries in [qf] into the GPU history, if they are
+// available (if not, that frame's GPU times are dropped rather than waiting)
+// -----------------------------------------------------------------------------
+void readQueries(QueryFrame& qf)
+{
+	if (qf.frame < 0 || qf.count == 0)
+		return;
+
+	GLint available = 0;
+	glGetQueryObjectiv(qf.queries[qf.count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return;
+
+	auto slot = qf.frame % profiler::HISTORY;
+	for (unsigned a = 0; a < qf.count; ++a)
+	{
+		GLuint64 ns = 0;
+		glGetQueryObjectui64v(qf.queries[a], GL_QUERY_RESULT, &ns);
+		if (qf.passes[a] < passes.size())
+			passes[qf.passes[a]].gpu_ms[slot] += static_cast<float>(ns / 1000000.);
+	}
+	gpu_valid[slot] = true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the average and maximum of [values] over the last recorded frames,
+// only including frames where [valid] is true (if given)
+// -----------------------------------------------------------------------------
+std::pair<float, float> stats(
+	const std::array<float, profiler::HISTORY>& values,
+	const std::array<bool, profiler::HISTORY>*  valid = nullptr)
+{
+	float    total = 0.f;
+	float    max   = 0.f;
+	unsigned count = 0;
+	for (long f = std::max(0l, frame - static_cast<long>(profiler::HISTORY)); f < frame; ++f)
+	{
+		auto slot = f % profiler::HISTORY;
+		if (valid && !(*valid)[slot])
+			continue;
+
+		total += values[slot];
+		max = std::max(max, values[slot]);
+		++count;
+	}
+
+	return { count > 0 ? total / count : 0.f, max };
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Profiler Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns true if passes are currently being profiled
+// -----------------------------------------------------------------------------
+bool profiler::enabled()
+{
+	return frame_active;
+}
+
+// -----------------------------------------------------------------------------
+// Begins profiling a frame (if the render_profile cvar is enabled), collecting
+// the GPU results from the frame that last used this frame's query set
+// -----------------------------------------------------------------------------
+void profiler::beginFrame()
+{
+	frame_active = render_profile;
+	if (!frame_active)
+		return;
+
+	// Clear history for this frame
+	auto slot = frame % HISTORY;
+	for (auto& pass : passes)
+	{
+		pass.cpu_frame    = 0.;
+		pass.cpu_ms[slot] = 0.f;
+		pass.gpu_ms[slot] = 0.f;
+	}
+	gpu_valid[slot] = false;
+
+	if (timerQuerySupport())
+	{
+		auto& qf = query_frames[frame % QUERY_FRAMES];
+		readQueries(qf);
+		qf.frame = frame;
+		qf.count = 0;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Ends the current profiled frame
+// -----------------------------------------------------------------------------
+void profiler::endFrame()
+{
+	if (!frame_active)
+		return;
+
+	// Close any passes left open
+	while (!pass_stack.empty())
+		endPass();
+
+	auto slot = frame % HISTORY;
+	for (auto& pass : passes)
+		pass.cpu_ms[slot] = static_cast<float>(pass.cpu_frame);
+
+	++frame;
+	frame_active = false;
+}
+
+// -----------------------------------------------------------------------------
+// Begins timing pass [name]
+// -----------------------------------------------------------------------------
+void profiler::beginPass(string_view name)
+{
+	if (!frame_active)
+		return;
+
+	PassState state{ passIndex(name), Clock::now(), false };
+
+	// Start a GPU query if none is already running
+	if (!gpu_query && timerQuerySupport())
+	{
+		auto& qf = query_frames[frame % QUERY_FRAMES];
+		if (qf.count == qf.queries.size())
+		{
+			unsigned id;
+			glGenQueries(1, &id);
+			qf.queries.push_back(id);
+			qf.passes.push_back(0);
+		}
+		qf.passes[qf.count] = state.pass;
+		glBeginQuery(GL_TIME_ELAPSED, qf.queries[qf.count++]);
+		gpu_query = state.gpu = true;
+	}
+
+	pass_stack.push_back(state);
+}
+
+// -----------------------------------------------------------------------------
+// Ends timing the current (innermost) pass
+// -----------------------------------------------------------------------------
+void profiler::endPass()
+{
+	if (pass_stack.empty())
+		return;
+
+	auto state = pass_stack.back();
+	pass_stack.pop_back();
+
+	if (state.gpu)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		gpu_query = false;
+	}
+
+	passes[state.pass].cpu_frame += std::chrono::duration<double, std::milli>(Clock::now() - state.start).count();
+}
+
+// -----------------------------------------------------------------------------
+// Draws the profiler overlay in the top-right of a [width]x[height] view: a
+// rolling histogram of per-pass times (stacked, GPU times if available,
+// otherwise CPU) and a list of per-pass average times.
+// Expects an orthographic pixel projection to be set up
+// -----------------------------------------------------------------------------
+void profiler::drawOverlay(int width, int height)
+{
+	if (!render_profile || passes.empty())
+		return;
+
+	bool       gpu      = timerQuerySupport();
+	const auto bar_w    = 2;
+	const auto graph_w  = static_cast<int>(HISTORY) * bar_w;
+	const auto graph_h  = 100;
+	const auto px_ms    = graph_h / 33.3f; // Graph height is ~2 frames at 60fps
+	const auto x        = width - graph_w - 8;
+	const auto y        = 8;
+	const auto n_colour = sizeof(pass_colours) / sizeof(ColRGBA);
+
+	glDisable(GL_TEXTURE_2D);
+
+	// Background
+	gl::setColour(0, 0, 0, 160, gl::Blend::Normal);
+	glBegin(GL_QUADS);
+	glVertex2i(x, y);
+	glVertex2i(x + graph_w, y);
+	glVertex2i(x + graph_w, y + graph_h);
+	glVertex2i(x, y + graph_h);
+
+	// Bars (oldest frame on the left)
+	for (int a = 0; a < static_cast<int>(HISTORY); ++a)
+	{
+		auto f = frame - static_cast<long>(HISTORY) + a;
+		if (f < 0)
+			continue;
+
+		auto  slot = f % HISTORY;
+		float base = 0.f;
+		if (gpu && !gpu_valid[slot])
+			continue;
+
+		for (unsigned p = 0; p < passes.size(); ++p)
+		{
+			auto ms = gpu ? passes[p].gpu_ms[slot] : passes[p].cpu_ms[slot];
+			if (ms <= 0.f)
+				continue;
+
+			auto top = std::min(base + ms * px_ms, static_cast<float>(graph_h));
+			gl::setColour(pass_colours[p % n_colour]);
+			glVertex2f(x + a * bar_w, y + graph_h - base);
+			glVertex2f(x + (a + 1) * bar_w, y + graph_h - base);
+			glVertex2f(x + (a + 1) * bar_w, y + graph_h - top);
+			glVertex2f(x + a * bar_w, y + graph_h - top);
+			base = top;
+		}
+	}
+	glEnd();
+
+	// 60fps line
+	gl::setColour(255, 255, 255, 128);
+	glBegin(GL_LINES);
+	glVertex2f(x, y + graph_h - 16.7f * px_ms);
+	glVertex2f(x + graph_w, y + graph_h - 16.7f * px_ms);
+	glEnd();
+
+	// Per-pass averages
+	glEnable(GL_TEXTURE_2D);
+	auto ty = y + graph_h + 4;
+	drawing::drawText(
+		gpu ? "Pass (avg ms): CPU / GPU" : "Pass (avg ms): CPU",
+		width - 8,
+		ty,
+		ColRGBA::WHITE,
+		drawing::Font::Small,
+		drawing::Align::Right);
+	for (unsigned p = 0; p < passes.size() && ty < height - 16; ++p)
+	{
+		ty += 12;
+		auto text = fmt::format("{}: {:.2f}", passes[p].name, stats(passes[p].cpu_ms).first);
+		if (gpu)
+			text += fmt::format(" / {:.2f}", stats(passes[p].gpu_ms, &gpu_valid).first);
+		drawing::drawText(text, width - 8, ty, pass_colours[p % n_colour], drawing::Font::Small, drawing::Align::Right);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Writes the average and maximum CPU (and GPU) times of each pass over the
+// recorded history to the log
+// -----------------------------------------------------------------------------
+void profiler::dump()
+{
+	if (passes.empty() || frame == 0)
+	{
+		log::info("No render profiling data recorded (set render_profile to 1 to enable)");
+		return;
+	}
+
+	log::info("Render passes over the last {} frames:", std::min(frame, static_cast<long>(HISTORY)));
+	bool gpu = timerQuerySupport();
+	for (auto& pass : passes)
+	{
+		auto [cpu_avg, cpu_max] = stats(pass.cpu_ms);
+		if (gpu)
+		{
+			auto [gpu_avg, gpu_max] = stats(pass.gpu_ms, &gpu_valid);
+			log::info(
+				"{}: CPU {:.3f}ms avg, {:.3f}ms max - GPU {:.3f}ms avg, {:.3f}ms max",
+				pass.name,
+				cpu_avg,
+				cpu_max,
+				gpu_avg,
+				gpu_max);
+		}
+		else
+			log::info("{}: CPU {:.3f}ms avg, {:.3f}ms max", pass.name, cpu_avg, cpu_max);
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Lists the average and maximum time of each profiled render pass
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(render_profile_dump, 0, true)
+{
+	profiler::dump();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "General/Trace.h"
+
+namespace slade
+{
+namespace gl
+{
+	// Per-pass render profiler. Each pass is timed on the CPU and, where timer
+	// queries are supported, on the GPU with GL_TIME_ELAPSED queries (read back
+	// a few frames later to avoid stalling). A rolling history of the last
+	// profiler::HISTORY frames is kept for the overlay and the
+	// render_profile_dump console command.
+	// Nothing is recorded (and no GL calls are made) unless the render_profile
+	// cvar is enabled
+	namespace profiler
+	{
+		static constexpr unsigned HISTORY = 120;
+
+		bool enabled();
+		void beginFrame();
+		void endFrame();
+		void beginPass(string_view name);
+		void endPass();
+		void drawOverlay(int width, int height);
+		void dump();
+
+		// Times everything from construction to destruction as pass [name].
+		// Only the outermost pass in a nested set of passes gets a GPU timer
+		// query (GL_TIME_ELAPSED queries can't be nested), inner passes are
+		// CPU-timed only. Passes are also recorded as zones in trace captures
+		class Scope
+		{
+		public:
+			Scope(const char* name) : active_{ enabled() }, zone_{ name }
+			{
+				if (active_)
+					beginPass(name);
+			}
+			~Scope()
+			{
+				if (active_)
+					endPass();
+			}
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			bool        active_;
+			trace::Zone zone_;
+		};
+	} // namespace profiler
+} // namespace gl
+} // namespace slade
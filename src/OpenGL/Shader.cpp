@@ -0,0 +1,251 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Shader.cpp
+// Description: Shader class - a simple wrapper around a linked GLSL vertex +
+//              fragment shader program
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Shader.h"
+#include "OpenGL.h"
+#include "Utility/Colour.h"
+
+using namespace slade;
+using namespace gl;
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Compiles a shader of [type] from [source].
+// Returns the shader object id, or 0 if compilation failed
+// -----------------------------------------------------------------------------
+unsigned compileShader(GLenum type, string_view source, string_view program_name)
+{
+	auto        shader = glCreateShader(type);
+	const char* src    = source.data();
+	auto        len    = static_cast<GLint>(source.size());
+	glShaderSource(shader, 1, &src, &len);
+	glCompileShader(shader);
+
+	GLint status = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		GLint log_length = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length);
+		string info(std::max(log_length, 1), '\0');
+		glGetShaderInfoLog(shader, log_length, nullptr, info.data());
+		log::error(
+			"Unable to compile {} shader for program \"{}\": {}",
+			type == GL_VERTEX_SHADER ? "vertex" : "fragment",
+			program_name,
+			info);
+
+		glDeleteShader(shader);
+		return 0;
+	}
+
+	return shader;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Shader Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Shader class destructor
+// -----------------------------------------------------------------------------
+Shader::~Shader()
+{
+	if (id_ > 0 && glDeleteProgram)
+		glDeleteProgram(id_);
+}
+
+// -----------------------------------------------------------------------------
+// Compiles and links the shader program from [vertex_src] and [fragment_src].
+// Generic vertex attributes are bound to the locations in gl::attrib.
+// Returns false if compiling or linking failed
+// -----------------------------------------------------------------------------
+bool Shader::load(string_view vertex_src, string_view fragment_src)
+{
+	// Clear any existing program
+	if (id_ > 0)
+	{
+		glDeleteProgram(id_);
+		id_ = 0;
+		uniform_locations_.clear();
+	}
+
+	// Compile shaders
+	auto vert = compileShader(GL_VERTEX_SHADER, vertex_src, name_);
+	auto frag = compileShader(GL_FRAGMENT_SHADER, fragment_src, name_);
+	if (!vert || !frag)
+	{
+		if (vert)
+			glDeleteShader(vert);
+		if (frag)
+			glDeleteShader(frag);
+		return false;
+	}
+
+	// Link program
+	auto program = glCreateProgram();
+	glAttachShader(program, vert);
+	glAttachShader(program, frag);
+	glBindAttribLocation(program, attrib::POSITION, "in_position");
+	glBindAttribLocation(program, attrib::COLOUR, "in_colour");
+	glBindAttribLocation(program, attrib::TEXCOORD, "in_texcoord");
+	glBindAttribLocation(program, attrib::FOG, "in_fog");
+	glBindAttribLocation(program, attrib::INSTANCE, "in_instance");
+	glLinkProgram(program);
+
+	// Shaders are no longer needed once linked (or failed to)
+	glDetachShader(program, vert);
+	glDetachShader(program, frag);
+	glDeleteShader(vert);
+	glDeleteShader(frag);
+
+	GLint status = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		GLint log_length = 0;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &log_length);
+		string info(std::max(log_length, 1), '\0');
+		glGetProgramInfoLog(program, log_length, nullptr, info.data());
+		log::error("Unable to link shader program \"{}\": {}", name_, info);
+
+		glDeleteProgram(program);
+		return false;
+	}
+
+	id_ = program;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Makes this the current shader program
+// -----------------------------------------------------------------------------
+void Shader::bind() const
+{
+	glUseProgram(id_);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the location of uniform [name] in the program (or -1 if it doesn't
+// exist). Locations are cached after the first lookup
+// -----------------------------------------------------------------------------
+int Shader::uniformLocation(const char* name) const
+{
+	auto i = uniform_locations_.find(string_view{ name });
+	if (i != uniform_locations_.end())
+		return i->second;
+
+	auto location            = glGetUniformLocation(id_, name);
+	uniform_locations_[name] = location;
+	return location;
+}
+
+// -----------------------------------------------------------------------------
+// Sets uniform [name] to [value].
+// The shader program must be bound for the setUniform* functions
+// -----------------------------------------------------------------------------
+void Shader::setUniform(const char* name, int value) const
+{
+	glUniform1i(uniformLocation(name), value);
+}
+void Shader::setUniform(const char* name, float value) const
+{
+	glUniform1f(uniformLocation(name), value);
+}
+void Shader::setUniform(const char* name, float x, float y) const
+{
+	glUniform2f(uniformLocation(name), x, y);
+}
+void Shader::setUniform(const char* name, float x, float y, float z) const
+{
+	glUniform3f(uniformLocation(name), x, y, z);
+}
+void Shader::setUniform(const char* name, float r, float g, float b, float a) const
+{
+	glUniform4f(uniformLocation(name), r, g, b, a);
+}
+void Shader::setUniform(const char* name, const ColRGBA& colour) const
+{
+	glUniform4f(uniformLocation(name), colour.fr(), colour.fg(), colour.fb(), colour.fa());
+}
+
+// -----------------------------------------------------------------------------
+// Sets 4x4 matrix uniform [name] to [matrix] (16 floats, column-major)
+// -----------------------------------------------------------------------------
+void Shader::setUniformMatrix(const char* name, const float* matrix) const
+{
+	glUniformMatrix4fv(uniformLocation(name), 1, GL_FALSE, matrix);
+}
+
+// -----------------------------------------------------------------------------
+// Sets 4x4 matrix uniform [name] to the current fixed-function
+// projection * modelview matrix, so shader-rendered geometry lines up with
+// anything else drawn using the current view transformation
+// -----------------------------------------------------------------------------
+void Shader::setFixedFunctionMVP(const char* name) const
+{
+	float projection[16], modelview[16], mvp[16];
+	glGetFloatv(GL_PROJECTION_MATRIX, projection);
+	glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+
+	for (int col = 0; col < 4; ++col)
+		for (int row = 0; row < 4; ++row)
+		{
+			float sum = 0.f;
+			for (int k = 0; k < 4; ++k)
+				sum += projection[k * 4 + row] * modelview[col * 4 + k];
+			mvp[col * 4 + row] = sum;
+		}
+
+	setUniformMatrix(name, mvp);
+}
+
+// -----------------------------------------------------------------------------
+// Clears the current shader program (back to fixed-function rendering)
+// -----------------------------------------------------------------------------
+void Shader::unbind()
+{
+	glUseProgram(0);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+namespace slade
+{
+struct ColRGBA;
+
+namespace gl
+{
+	// Generic vertex attribute locations used by all shader programs
+	namespace attrib
+	{
+		static constexpr unsigned POSITION = 0;
+		static constexpr unsigned COLOUR   = 1;
+		static constexpr unsigned TEXCOORD = 2;
+		static constexpr unsigned FOG      = 3;
+		static constexpr unsigned INSTANCE = 4; // Per-instance data for instanced rendering
+	} // namespace attrib
+
+	class Shader
+	{
+	public:
+		Shader(string_view name) : name_{ name } {}
+		~Shader();
+
+		// Non-copyable (owns a GL program object)
+		Shader(const Shader&) = delete;
+		Shader& operator=(const Shader&) = delete;
+
+		const string& name() const { return name_; }
+		unsigned      id() const { return id_; }
+		bool          isValid() const { return id_ > 0; }
+
+		bool load(string_view vertex_src, string_view fragment_src);
+		void bind() const;
+
+		int  uniformLocation(const char* name) const;
+		void setUniform(const char* name, int value) const;
+		void setUniform(const char* name, float value) const;
+		void setUniform(const char* name, float x, float y) const;
+		void setUniform(const char* name, float x, float y, float z) const;
+		void setUniform(const char* name, float r, float g, float b, float a) const;
+		void setUniform(const char* name, const ColRGBA& colour) const;
+		void setUniformMatrix(const char* name, const float* matrix) const;
+		void setFixedFunctionMVP(const char* name = "mvp") const;
+
+		static void unbind();
+
+	private:
+		string   name_;
+		unsigned id_ = 0;
+
+		mutable std::map<string, int, std::less<>> uniform_locations_;
+	};
+} // namespace gl
+} // namespace slade
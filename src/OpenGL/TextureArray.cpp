@@ -0,0 +1,250 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TextureArray.cpp
+// Description: TextureArray struct - pools same-size textures into layers of
+//              OpenGL 2d array textures
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "TextureArray.h"
+#include "GLTexture.h"
+#include "OpenGL.h"
+
+using namespace slade;
+using namespace gl;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+struct ArrayInfo
+{
+	unsigned    width  = 0;
+	unsigned    height = 0;
+	TexFilter   filter = TexFilter::Nearest;
+	vector<int> free_layers;
+	bool        mipmaps_dirty = false;
+};
+
+std::map<unsigned, ArrayInfo> arrays;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [filter] uses mipmaps
+// -----------------------------------------------------------------------------
+bool hasMipmaps(TexFilter filter)
+{
+	return filter == TexFilter::Mipmap || filter == TexFilter::LinearMipmap || filter == TexFilter::NearestMipmap;
+}
+
+// -----------------------------------------------------------------------------
+// Creates a new (empty) array texture for [width]x[height] textures using
+// [filter], with TextureArray::CAPACITY layers.
+// Returns the id of the created array texture
+// -----------------------------------------------------------------------------
+unsigned createArray(unsigned width, unsigned height, TexFilter filter)
+{
+	unsigned id;
+	glGenTextures(1, &id);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	// Filtering (same as the equivalent gl::Texture filter)
+	auto mag = (filter == TexFilter::Linear || filter == TexFilter::Mipmap || filter == TexFilter::LinearMipmap) ?
+				   GL_LINEAR :
+				   GL_NEAREST;
+	auto min = GL_NEAREST;
+	if (hasMipmaps(filter))
+		min = GL_LINEAR_MIPMAP_LINEAR;
+	else if (filter == TexFilter::Linear || filter == TexFilter::NearestLinearMin)
+		min = GL_LINEAR;
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, mag);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, min);
+
+	// Allocate storage for all layers (and mip levels if needed)
+	auto level = 0;
+	auto w     = width;
+	auto h     = height;
+	while (true)
+	{
+		glTexImage3D(
+			GL_TEXTURE_2D_ARRAY,
+			level,
+			GL_RGBA8,
+			w,
+			h,
+			TextureArray::CAPACITY,
+			0,
+			GL_RGBA,
+			GL_UNSIGNED_BYTE,
+			nullptr);
+
+		if (!hasMipmaps(filter) || (w == 1 && h == 1))
+			break;
+
+		w = std::max(w / 2, 1u);
+		h = std::max(h / 2, 1u);
+		++level;
+	}
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, level);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	auto& info  = arrays[id];
+	info.width  = width;
+	info.height = height;
+	info.filter = filter;
+	for (int a = TextureArray::CAPACITY - 1; a >= 0; --a)
+		info.free_layers.push_back(a);
+
+	return id;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// TextureArray Struct Static Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns true if array textures can be used (they are only sampled from
+// shaders, so shader support is required)
+// -----------------------------------------------------------------------------
+bool TextureArray::supported()
+{
+	return gl::isInitialised() && gl::shaderSupport();
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if a [width]x[height] texture can be pooled in an array
+// -----------------------------------------------------------------------------
+bool TextureArray::canPool(unsigned width, unsigned height)
+{
+	auto pow2 = [](unsigned v) { return v > 0 && (v & (v - 1)) == 0; };
+	return pow2(width) && pow2(height) && width <= MAX_SIZE && height <= MAX_SIZE;
+}
+
+// -----------------------------------------------------------------------------
+// Adds RGBA [data] of [width]x[height] as a layer in an array texture for
+// textures of that size and [filter], creating a new array if all existing
+// ones are full.
+// Returns the layer added, or an invalid layer if the texture can't be pooled
+// -----------------------------------------------------------------------------
+TextureArray::Layer TextureArray::add(const uint8_t* data, unsigned width, unsigned height, TexFilter filter)
+{
+	if (!data || !supported() || !canPool(width, height))
+		return {};
+
+	// Find an array with a free layer
+	unsigned array = 0;
+	for (auto& [id, info] : arrays)
+		if (info.width == width && info.height == height && info.filter == filter && !info.free_layers.empty())
+		{
+			array = id;
+			break;
+		}
+	if (array == 0)
+		array = createArray(width, height, filter);
+
+	// Upload to the layer
+	auto& info  = arrays[array];
+	auto  layer = info.free_layers.back();
+	info.free_layers.pop_back();
+	glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	if (hasMipmaps(filter))
+		info.mipmaps_dirty = true;
+
+	return { array, layer };
+}
+
+// -----------------------------------------------------------------------------
+// Frees [layer] for reuse, deleting its array texture if no layers are in use
+// -----------------------------------------------------------------------------
+void TextureArray::remove(const Layer& layer)
+{
+	if (!layer.isValid() || !gl::isInitialised())
+		return;
+
+	auto i = arrays.find(layer.array);
+	if (i == arrays.end())
+		return;
+
+	i->second.free_layers.push_back(layer.index);
+	if (i->second.free_layers.size() == static_cast<unsigned>(CAPACITY))
+	{
+		glDeleteTextures(1, &layer.array);
+		arrays.erase(i);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Binds [array] to the current texture unit, first regenerating its mipmaps if
+// any layers were added since it was last bound
+// -----------------------------------------------------------------------------
+void TextureArray::bind(unsigned array)
+{
+	glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+
+	auto i = arrays.find(array);
+	if (i != arrays.end() && i->second.mipmaps_dirty)
+	{
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+		i->second.mipmaps_dirty = false;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Deletes all array textures
+// -----------------------------------------------------------------------------
+void TextureArray::clearAll()
+{
+	if (!gl::isInitialised())
+		return;
+
+	for (auto& array : arrays)
+		glDeleteTextures(1, &array.first);
+
+	arrays.clear();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+namespace slade
+{
+namespace gl
+{
+	enum class TexFilter;
+
+	// Pools same-size textures as layers of GL_TEXTURE_2D_ARRAY textures, so
+	// geometry using different textures can be rendered without rebinding.
+	// Arrays are bucketed by size and filter, and only small power-of-two
+	// sizes are pooled (anything else should be rendered from its own texture)
+	struct TextureArray
+	{
+		struct Layer
+		{
+			unsigned array = 0;
+			int      index = -1;
+
+			bool isValid() const { return array > 0 && index >= 0; }
+		};
+
+		static constexpr unsigned MAX_SIZE = 256;
+		static constexpr int      CAPACITY = 32;
+
+		static bool supported();
+		static bool canPool(unsigned width, unsigned height);
+
+		static Layer add(const uint8_t* data, unsigned width, unsigned height, TexFilter filter);
+		static void  remove(const Layer& layer);
+		static void  bind(unsigned array);
+		static void  clearAll();
+	};
+} // namespace gl
+} // namespace slade
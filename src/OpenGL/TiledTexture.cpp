@@ -0,0 +1,426 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TiledTexture.cpp
+// Description: TiledTexture class - displays an image as a grid of OpenGL
+//              textures, re-uploading only the areas that have changed
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "TiledTexture.h"
+#include "GLTexture.h"
+#include "Graphics/Palette/Palette.h"
+#include "Graphics/SImage/SImage.h"
+#include "OpenGL.h"
+#include "Shader.h"
+
+using namespace slade;
+using namespace gl;
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the texture size needed for a tile of [size] pixels (the next power
+// of two if non-power-of-two textures aren't supported)
+// -----------------------------------------------------------------------------
+int texSize(int size)
+{
+	if (gl::np2TexSupport())
+		return size;
+
+	int pow2 = 1;
+	while (pow2 < size)
+		pow2 *= 2;
+	return pow2;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if palettes [a] and [b] have the same colours
+// -----------------------------------------------------------------------------
+bool samePalette(const vector<ColRGBA>& a, const vector<ColRGBA>& b)
+{
+	if (a.size() != b.size())
+		return false;
+
+	for (unsigned i = 0; i < a.size(); ++i)
+		if (!a[i].equals(b[i]))
+			return false;
+
+	return true;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// TiledTexture Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// TiledTexture class destructor
+// -----------------------------------------------------------------------------
+TiledTexture::~TiledTexture()
+{
+	clear();
+}
+
+// -----------------------------------------------------------------------------
+// Uploads all of [image] (using [pal] if needed), reusing the existing tile
+// textures if the image size and format haven't changed.
+// Returns false if the image is invalid or the tiles couldn't be created
+// -----------------------------------------------------------------------------
+bool TiledTexture::load(const SImage& image, Palette* pal)
+{
+	if (!gl::isInitialised() || !image.isValid())
+	{
+		clear();
+		return false;
+	}
+
+	// Get image data, as palette index + alpha pairs if it can be indexed
+	auto     indexed = image.type() == SImage::Type::PalMask && Texture::indexedSupport();
+	MemChunk data;
+	if (indexed ? !image.putIndexedMaskData(data) : !image.putRGBAData(data, pal))
+	{
+		clear();
+		return false;
+	}
+
+	// (Re)create tiles if the size or format changed
+	if (image.width() != width_ || image.height() != height_ || indexed != indexed_ || tiles_.empty())
+	{
+		clear();
+
+		width_     = image.width();
+		height_    = image.height();
+		indexed_   = indexed;
+		tile_size_ = std::min<int>(TILE_SIZE, gl::maxTextureSize());
+		for (int y = 0; y < height_; y += tile_size_)
+			for (int x = 0; x < width_; x += tile_size_)
+			{
+				Tile tile;
+				tile.x          = x;
+				tile.y          = y;
+				tile.width      = std::min(tile_size_, width_ - x);
+				tile.height     = std::min(tile_size_, height_ - y);
+				tile.tex_width  = texSize(tile.width);
+				tile.tex_height = texSize(tile.height);
+
+				// Create the tile texture (uploaded below)
+				if (indexed)
+				{
+					tile.texture = Texture::create(TexFilter::Nearest, false);
+					if (!Texture::loadIndexedData(tile.texture, nullptr, tile.tex_width, tile.tex_height, true))
+					{
+						Texture::clear(tile.texture);
+						tile.texture = 0;
+					}
+				}
+				else
+					tile.texture = Texture::createFromData(
+						nullptr, tile.tex_width, tile.tex_height, TexFilter::Nearest, false);
+				if (!tile.texture)
+				{
+					clear();
+					return false;
+				}
+
+				tiles_.push_back(tile);
+			}
+	}
+
+	// Upload each tile's area directly from the full image data
+	auto format = indexed_ ? GL_RG : GL_RGBA;
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, width_);
+	for (auto& tile : tiles_)
+	{
+		Texture::bind(tile.texture);
+		glPixelStorei(GL_UNPACK_SKIP_PIXELS, tile.x);
+		glPixelStorei(GL_UNPACK_SKIP_ROWS, tile.y);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tile.width, tile.height, format, GL_UNSIGNED_BYTE, data.data());
+		tile.dirty_x1 = tile.dirty_x2 = 0;
+	}
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	updatePalette(image, pal);
+	dirty_ = false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Marks the [width]x[height] area at [x],[y] in the image as changed, to be
+// re-uploaded on the next update
+// -----------------------------------------------------------------------------
+void TiledTexture::markDirty(int x, int y, int width, int height)
+{
+	// Clip to image
+	auto x2 = std::min(x + width, width_);
+	auto y2 = std::min(y + height, height_);
+	x       = std::max(x, 0);
+	y       = std::max(y, 0);
+	if (x2 <= x || y2 <= y)
+		return;
+
+	// Expand the dirty area of each tile it touches
+	int cols = (width_ + tile_size_ - 1) / tile_size_;
+	for (int row = y / tile_size_; row <= (y2 - 1) / tile_size_; ++row)
+		for (int col = x / tile_size_; col <= (x2 - 1) / tile_size_; ++col)
+		{
+			auto& tile = tiles_[row * cols + col];
+			auto  tx1  = std::max(x - tile.x, 0);
+			auto  ty1  = std::max(y - tile.y, 0);
+			auto  tx2  = std::min(x2 - tile.x, tile.width);
+			auto  ty2  = std::min(y2 - tile.y, tile.height);
+
+			if (tile.dirty_x2 <= tile.dirty_x1)
+			{
+				tile.dirty_x1 = tx1;
+				tile.dirty_y1 = ty1;
+				tile.dirty_x2 = tx2;
+				tile.dirty_y2 = ty2;
+			}
+			else
+			{
+				tile.dirty_x1 = std::min(tile.dirty_x1, tx1);
+				tile.dirty_y1 = std::min(tile.dirty_y1, ty1);
+				tile.dirty_x2 = std::max(tile.dirty_x2, tx2);
+				tile.dirty_y2 = std::max(tile.dirty_y2, ty2);
+			}
+		}
+
+	dirty_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Re-uploads the areas of [image] marked as changed since it was last loaded
+// or updated (or all of it if its size or format has changed), using [pal] if
+// needed. If the palette has changed, indexed tiles only need the palette
+// re-uploaded, otherwise all of the image is
+// -----------------------------------------------------------------------------
+void TiledTexture::update(const SImage& image, Palette* pal)
+{
+	auto indexed = image.type() == SImage::Type::PalMask && Texture::indexedSupport();
+	if (image.width() != width_ || image.height() != height_ || indexed != indexed_ || tiles_.empty())
+	{
+		load(image, pal);
+		return;
+	}
+
+	if (updatePalette(image, pal) && !indexed_)
+	{
+		load(image, pal);
+		return;
+	}
+
+	if (!dirty_)
+		return;
+
+	auto            bpp    = indexed_ ? 2 : 4;
+	auto            format = indexed_ ? GL_RG : GL_RGBA;
+	vector<uint8_t> data;
+	for (auto& tile : tiles_)
+	{
+		if (tile.dirty_x2 <= tile.dirty_x1)
+			continue;
+
+		// Get RGBA (or index + alpha) data for the dirty area
+		auto w = tile.dirty_x2 - tile.dirty_x1;
+		auto h = tile.dirty_y2 - tile.dirty_y1;
+		data.resize(static_cast<size_t>(w) * h * bpp);
+		auto pixel = data.data();
+		for (int y = 0; y < h; ++y)
+			for (int x = 0; x < w; ++x)
+			{
+				// (pixelAt isn't const, but doesn't modify the image)
+				auto px  = tile.x + tile.dirty_x1 + x;
+				auto py  = tile.y + tile.dirty_y1 + y;
+				auto col = const_cast<SImage&>(image).pixelAt(px, py, pal);
+				if (indexed_)
+					*pixel++ = image.pixelIndexAt(px, py);
+				else
+				{
+					*pixel++ = col.r;
+					*pixel++ = col.g;
+					*pixel++ = col.b;
+				}
+				*pixel++ = col.a;
+			}
+
+		// Upload it
+		Texture::bind(tile.texture);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, tile.dirty_x1, tile.dirty_y1, w, h, format, GL_UNSIGNED_BYTE, data.data());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		tile.dirty_x1 = tile.dirty_x2 = 0;
+	}
+
+	dirty_ = false;
+}
+
+// -----------------------------------------------------------------------------
+// Draws the image at 0,0 (at its actual size in the current GL transform), so
+// zooming and panning don't require any re-uploading
+// -----------------------------------------------------------------------------
+void TiledTexture::draw() const
+{
+	auto shader = indexed_ ? Texture::bindIndexedShader(palette_) : nullptr;
+
+	for (const auto& tile : tiles_)
+		drawTile(tile, tile.x, tile.y, tile.x + tile.width, tile.y + tile.height, shader);
+
+	if (shader)
+		Shader::unbind();
+}
+
+// -----------------------------------------------------------------------------
+// Draws the image repeatedly to fill [width]x[height] from 0,0
+// -----------------------------------------------------------------------------
+void TiledTexture::drawTiled(double width, double height) const
+{
+	if (tiles_.empty())
+		return;
+
+	auto shader = indexed_ ? Texture::bindIndexedShader(palette_) : nullptr;
+
+	for (double y = 0; y < height; y += height_)
+		for (double x = 0; x < width; x += width_)
+			for (const auto& tile : tiles_)
+				if (x + tile.x < width && y + tile.y < height)
+					drawTile(tile, x + tile.x, y + tile.y, width, height, shader);
+
+	if (shader)
+		Shader::unbind();
+}
+
+// -----------------------------------------------------------------------------
+// Deletes all tile textures
+// -----------------------------------------------------------------------------
+void TiledTexture::clear()
+{
+	for (auto& tile : tiles_)
+		Texture::clear(tile.texture);
+	Texture::clear(palette_);
+
+	tiles_.clear();
+	palette_colours_.clear();
+	width_   = 0;
+	height_  = 0;
+	palette_ = 0;
+	indexed_ = false;
+	dirty_   = false;
+}
+
+// -----------------------------------------------------------------------------
+// Records the palette [image] is drawn with (its own, or [pal]), uploading it
+// to the palette texture if the tiles are indexed.
+// Returns true if the palette has changed since it was last recorded
+// -----------------------------------------------------------------------------
+bool TiledTexture::updatePalette(const SImage& image, Palette* pal)
+{
+	if (image.type() != SImage::Type::PalMask)
+	{
+		palette_colours_.clear();
+		return false;
+	}
+
+	// (palette isn't const, but isn't modified here)
+	auto& palette = (image.hasPalette() || !pal) ? *const_cast<SImage&>(image).palette() : *pal;
+	if (samePalette(palette.colours(), palette_colours_))
+		return false;
+
+	palette_colours_ = palette.colours();
+	if (indexed_)
+	{
+		if (!palette_)
+			palette_ = Texture::create(TexFilter::Nearest, false);
+		Texture::loadPalettes(palette_, palette_colours_);
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Draws [tile] at [x],[y], clipped to [max_x],[max_y]. If [shader] is given
+// (indexed tiles), the tile is drawn with it in the current GL colour
+// -----------------------------------------------------------------------------
+void TiledTexture::drawTile(
+	const Tile&   tile,
+	double        x,
+	double        y,
+	double        max_x,
+	double        max_y,
+	const Shader* shader) const
+{
+	auto w  = std::min<double>(tile.width, max_x - x);
+	auto h  = std::min<double>(tile.height, max_y - y);
+	auto tw = w / tile.tex_width;
+	auto th = h / tile.tex_height;
+
+	Texture::bind(tile.texture);
+
+	if (shader)
+	{
+		float col[4];
+		glGetFloatv(GL_CURRENT_COLOR, col);
+		ColRGBA colour(col[0] * 255, col[1] * 255, col[2] * 255, col[3] * 255);
+
+		quad_.clear();
+		quad_.add(x, y, 0, 0, colour);
+		quad_.add(x, y + h, 0, th, colour);
+		quad_.add(x + w, y + h, tw, th, colour);
+		quad_.add(x, y, 0, 0, colour);
+		quad_.add(x + w, y + h, tw, th, colour);
+		quad_.add(x + w, y, tw, 0, colour);
+		quad_.draw(GL_TRIANGLES, shader, true);
+		return;
+	}
+
+	glBegin(GL_QUADS);
+	glTexCoord2d(0, 0);
+	glVertex2d(x, y);
+	glTexCoord2d(0, th);
+	glVertex2d(x, y + h);
+	glTexCoord2d(tw, th);
+	glVertex2d(x + w, y + h);
+	glTexCoord2d(tw, 0);
+	glVertex2d(x + w, y);
+	glEnd();
+}
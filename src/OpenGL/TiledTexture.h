@@ -0,0 +1,73 @@
+#pragma once
+
+#include "VertexBuffer2D.h"
+
+namespace slade
+{
+class SImage;
+class Palette;
+
+namespace gl
+{
+	// An image uploaded as a grid of textures (tiles), so images larger than
+	// the max. texture size can be displayed, and edits only need to
+	// re-upload the changed areas of the tiles they touch (see markDirty).
+	// Paletted images are uploaded as indexed textures where supported, so
+	// changing the palette only needs the palette itself re-uploaded
+	class TiledTexture
+	{
+	public:
+		static constexpr int TILE_SIZE = 1024;
+
+		TiledTexture() = default;
+		~TiledTexture();
+
+		// Non-copyable (owns GL textures)
+		TiledTexture(const TiledTexture&) = delete;
+		TiledTexture& operator=(const TiledTexture&) = delete;
+
+		int  width() const { return width_; }
+		int  height() const { return height_; }
+		bool isLoaded() const { return !tiles_.empty(); }
+		bool isIndexed() const { return indexed_; }
+
+		bool load(const SImage& image, Palette* pal = nullptr);
+		void markDirty(int x, int y, int width = 1, int height = 1);
+		void update(const SImage& image, Palette* pal = nullptr);
+		void draw() const;
+		void drawTiled(double width, double height) const;
+		void clear();
+
+	private:
+		struct Tile
+		{
+			unsigned texture    = 0;
+			int      x          = 0; // Position and size of the tile in the image
+			int      y          = 0;
+			int      width      = 0;
+			int      height     = 0;
+			int      tex_width  = 0; // Size of the tile texture (may be padded to a power of two)
+			int      tex_height = 0;
+
+			// Dirty area (relative to the tile), empty if dirty_x2 <= dirty_x1
+			int dirty_x1 = 0;
+			int dirty_y1 = 0;
+			int dirty_x2 = 0;
+			int dirty_y2 = 0;
+		};
+
+		vector<Tile>           tiles_;
+		int                    width_     = 0;
+		int                    height_    = 0;
+		int                    tile_size_ = TILE_SIZE;
+		bool                   dirty_     = false;
+		bool                   indexed_   = false; // Tiles are indexed textures (see Texture::loadIndexed)
+		unsigned               palette_   = 0;     // Palette texture for indexed tiles
+		vector<ColRGBA>        palette_colours_;   // Palette the image was last uploaded with (if paletted)
+		mutable VertexBuffer2D quad_;              // For drawing indexed tiles
+
+		bool updatePalette(const SImage& image, Palette* pal);
+		void drawTile(const Tile& tile, double x, double y, double max_x, double max_y, const Shader* shader) const;
+	};
+} // namespace gl
+} // namespace slade
@@ -0,0 +1,182 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    VertexBuffer2D.cpp
+// Description: VertexBuffer2D class - batches dynamic coloured 2d geometry
+//              (overlays, selections, etc.) into a single draw call
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "VertexBuffer2D.h"
+#include "OpenGL.h"
+#include "Shader.h"
+
+using namespace slade;
+using namespace gl;
+
+
+// -----------------------------------------------------------------------------
+//
+// VertexBuffer2D Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// VertexBuffer2D class destructor
+// -----------------------------------------------------------------------------
+VertexBuffer2D::~VertexBuffer2D()
+{
+	if (vbo_ > 0 && glDeleteBuffers)
+		glDeleteBuffers(1, &vbo_);
+}
+
+// -----------------------------------------------------------------------------
+// Adds the outline of the rectangle [x1,y1]-[x2,y2] as 4 lines (GL_LINES)
+// -----------------------------------------------------------------------------
+void VertexBuffer2D::addRectOutline(float x1, float y1, float x2, float y2)
+{
+	addLine(x1, y1, x2, y1);
+	addLine(x2, y1, x2, y2);
+	addLine(x2, y2, x1, y2);
+	addLine(x1, y2, x1, y1);
+}
+
+// -----------------------------------------------------------------------------
+// Adds the rectangle [x1,y1]-[x2,y2] as 2 triangles (GL_TRIANGLES)
+// -----------------------------------------------------------------------------
+void VertexBuffer2D::addQuad(float x1, float y1, float x2, float y2)
+{
+	add(x1, y1);
+	add(x2, y1);
+	add(x2, y2);
+	add(x1, y1);
+	add(x2, y2);
+	add(x1, y2);
+}
+
+// -----------------------------------------------------------------------------
+// Renders all vertices in the buffer as [primitive] in a single draw call.
+// If [shader] is given (it must already be bound), the vertices are streamed
+// into the buffer's VBO and fed to the generic vertex attributes, otherwise
+// fixed-function client-side vertex arrays are used. Texture coordinates are
+// only passed on if [textured] is true
+// -----------------------------------------------------------------------------
+void VertexBuffer2D::draw(unsigned primitive, const Shader* shader, bool textured)
+{
+	if (vertices_.empty())
+		return;
+
+	unsigned data_size = vertices_.size() * sizeof(Vertex);
+
+	if (shader && shader->isValid())
+	{
+		if (vbo_ == 0)
+			glGenBuffers(1, &vbo_);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+
+		// Grow the buffer if needed, otherwise orphan the existing storage so
+		// the upload doesn't have to wait on the previous frame's draw
+		if (data_size > vbo_size_)
+			vbo_size_ = std::max(data_size, vbo_size_ * 2);
+		glBufferData(GL_ARRAY_BUFFER, vbo_size_, nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, data_size, vertices_.data());
+
+		setupAttribPointers(sizeof(Vertex), offsetof(Vertex, r), textured ? offsetof(Vertex, u) : 0);
+		glDrawArrays(primitive, 0, vertices_.size());
+		clearAttribPointers();
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	else
+	{
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &vertices_[0].x);
+		glColorPointer(4, GL_FLOAT, sizeof(Vertex), &vertices_[0].r);
+		if (textured)
+		{
+			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+			glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &vertices_[0].u);
+		}
+		else
+			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+		glDrawArrays(primitive, 0, vertices_.size());
+
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// VertexBuffer2D Class Static Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Sets up the generic position (and colour/texcoord, if [colour_offset] or
+// [texcoord_offset] are not 0) vertex attributes for the currently bound VBO,
+// with vertices [stride] bytes apart. Positions are expected to be 2 floats at
+// the start of each vertex, colours 4 floats at [colour_offset] and texture
+// coordinates 2 floats at [texcoord_offset]
+// -----------------------------------------------------------------------------
+void VertexBuffer2D::setupAttribPointers(unsigned stride, unsigned colour_offset, unsigned texcoord_offset)
+{
+	glEnableVertexAttribArray(attrib::POSITION);
+	glVertexAttribPointer(attrib::POSITION, 2, GL_FLOAT, GL_FALSE, stride, nullptr);
+
+	if (colour_offset > 0)
+	{
+		glEnableVertexAttribArray(attrib::COLOUR);
+		glVertexAttribPointer(attrib::COLOUR, 4, GL_FLOAT, GL_FALSE, stride, (char*)nullptr + colour_offset);
+	}
+	else
+		glDisableVertexAttribArray(attrib::COLOUR);
+
+	if (texcoord_offset > 0)
+	{
+		glEnableVertexAttribArray(attrib::TEXCOORD);
+		glVertexAttribPointer(attrib::TEXCOORD, 2, GL_FLOAT, GL_FALSE, stride, (char*)nullptr + texcoord_offset);
+	}
+	else
+		glDisableVertexAttribArray(attrib::TEXCOORD);
+}
+
+// -----------------------------------------------------------------------------
+// Disables the generic vertex attribute arrays enabled by setupAttribPointers
+// -----------------------------------------------------------------------------
+void VertexBuffer2D::clearAttribPointers()
+{
+	glDisableVertexAttribArray(attrib::POSITION);
+	glDisableVertexAttribArray(attrib::COLOUR);
+	glDisableVertexAttribArray(attrib::TEXCOORD);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Utility/Colour.h"
+
+namespace slade
+{
+namespace gl
+{
+	class Shader;
+
+	// A batch of coloured (and optionally textured) 2d vertices that is filled on
+	// the CPU each frame and rendered with a single draw call. Uploads go to a
+	// persistent streaming VBO when drawn with a shader, or straight from client
+	// memory otherwise
+	class VertexBuffer2D
+	{
+	public:
+		struct Vertex
+		{
+			float x, y;
+			float r, g, b, a;
+			float u, v;
+		};
+
+		VertexBuffer2D() = default;
+		~VertexBuffer2D();
+
+		// Non-copyable (owns a GL buffer object)
+		VertexBuffer2D(const VertexBuffer2D&) = delete;
+		VertexBuffer2D& operator=(const VertexBuffer2D&) = delete;
+
+		const vector<Vertex>& vertices() const { return vertices_; }
+		bool                  empty() const { return vertices_.empty(); }
+		unsigned              size() const { return vertices_.size(); }
+
+		void setColour(const ColRGBA& colour) { colour_ = colour; }
+
+		void reserve(unsigned count) { vertices_.reserve(count); }
+		void clear() { vertices_.clear(); }
+
+		void add(float x, float y) { add(x, y, colour_); }
+		void add(float x, float y, const ColRGBA& colour)
+		{
+			vertices_.push_back({ x, y, colour.fr(), colour.fg(), colour.fb(), colour.fa(), 0.f, 0.f });
+		}
+		void add(float x, float y, float u, float v, const ColRGBA& colour)
+		{
+			vertices_.push_back({ x, y, colour.fr(), colour.fg(), colour.fb(), colour.fa(), u, v });
+		}
+		void add(const Vec2d& pos) { add(pos.x, pos.y, colour_); }
+		void addLine(float x1, float y1, float x2, float y2)
+		{
+			add(x1, y1);
+			add(x2, y2);
+		}
+		void addLine(const Vec2d& p1, const Vec2d& p2) { addLine(p1.x, p1.y, p2.x, p2.y); }
+		void addRectOutline(float x1, float y1, float x2, float y2);
+		void addQuad(float x1, float y1, float x2, float y2);
+
+		void draw(unsigned primitive, const Shader* shader = nullptr, bool textured = false);
+
+		static void setupAttribPointers(unsigned stride, unsigned colour_offset, unsigned texcoord_offset = 0);
+		static void clearAttribPointers();
+
+	private:
+		vector<Vertex> vertices_;
+		ColRGBA        colour_   = ColRGBA::WHITE;
+		unsigned       vbo_      = 0;
+		unsigned       vbo_size_ = 0;
+	};
+} // namespace gl
+} // namespace slade
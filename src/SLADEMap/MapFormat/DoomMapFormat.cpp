@@ -156,9 +156,11 @@ bool DoomMapFormat::readVERTEXES(ArchiveEntry* entry, MapObjectCollection& map_d
 	auto     vert_data = reinterpret_cast<const Vertex*>(entry->rawData(true));
 	unsigned nv        = entry->size() / sizeof(Vertex);
 	float    p         = ui::getSplashProgress();
+	map_data.reserve(MapObject::Type::Vertex, nv);
 	for (size_t a = 0; a < nv; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nv) * 0.2f);
+		if (a % PROGRESS_INTERVAL == 0)
+			ui::setSplashProgress(p + ((float)a / nv) * 0.2f);
 		map_data.addVertex(std::make_unique<MapVertex>(Vec2d{ (double)vert_data[a].x, (double)vert_data[a].y }));
 	}
 
@@ -189,9 +191,11 @@ bool DoomMapFormat::readSIDEDEFS(ArchiveEntry* entry, MapObjectCollection& map_d
 	auto     side_data = reinterpret_cast<const SideDef*>(entry->rawData(true));
 	unsigned ns        = entry->size() / sizeof(SideDef);
 	float    p         = ui::getSplashProgress();
+	map_data.reserve(MapObject::Type::Side, ns);
 	for (size_t a = 0; a < ns; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / ns) * 0.2f);
+		if (a % PROGRESS_INTERVAL == 0)
+			ui::setSplashProgress(p + ((float)a / ns) * 0.2f);
 
 		// Add side
 		map_data.addSide(std::make_unique<MapSide>(
@@ -229,9 +233,12 @@ bool DoomMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_d
 	auto     line_data = reinterpret_cast<const LineDef*>(entry->rawData(true));
 	unsigned nl        = entry->size() / sizeof(LineDef);
 	float    p         = ui::getSplashProgress();
+	bool     big_sides = map_data.sides().size() > 32767;
+	map_data.reserve(MapObject::Type::Line, nl);
 	for (size_t a = 0; a < nl; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nl) * 0.2f);
+		if (a % PROGRESS_INTERVAL == 0)
+			ui::setSplashProgress(p + ((float)a / nl) * 0.2f);
 		const auto& data = line_data[a];
 
 		// Check vertices exist
@@ -247,7 +254,7 @@ bool DoomMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_d
 		int  s1_index = data.side1;
 		int  s2_index = data.side2;
 		bool no_s2    = false;
-		if (map_data.sides().size() > 32767)
+		if (big_sides)
 		{
 			// Support for > 32768 sides
 			if (data.side1 != 65535)
@@ -266,12 +273,12 @@ bool DoomMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_d
 		if (s2 && s2->parentLine())
 			s2 = map_data.addSide(std::make_unique<MapSide>(s2->sector(), s2));
 
-		// Create line
-		auto line = map_data.addLine(std::make_unique<MapLine>(v1, v2, s1, s2, data.type, data.flags));
-
-		// Set properties
-		line->setArg(0, data.sector_tag);
+		// Create line (with properties set before adding it to the map, so its
+		// id is indexed once)
+		auto line = std::make_unique<MapLine>(
+			v1, v2, s1, s2, data.type, data.flags, MapObject::ArgSet{ data.sector_tag, 0, 0, 0, 0 });
 		line->setId(data.sector_tag);
+		map_data.addLine(std::move(line));
 	}
 
 	log::info(3, "Read {} lines", map_data.lines().size());
@@ -301,9 +308,11 @@ bool DoomMapFormat::readSECTORS(ArchiveEntry* entry, MapObjectCollection& map_da
 	auto     sect_data = reinterpret_cast<const Sector*>(entry->rawData(true));
 	unsigned ns        = entry->size() / sizeof(Sector);
 	float    p         = ui::getSplashProgress();
+	map_data.reserve(MapObject::Type::Sector, ns);
 	for (size_t a = 0; a < ns; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / ns) * 0.2f);
+		if (a % PROGRESS_INTERVAL == 0)
+			ui::setSplashProgress(p + ((float)a / ns) * 0.2f);
 		const auto& data = sect_data[a];
 
 		// Add sector
@@ -344,20 +353,25 @@ bool DoomMapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_dat
 	auto     thng_data = reinterpret_cast<const Thing*>(entry->rawData(true));
 	unsigned nt        = entry->size() / sizeof(Thing);
 	float    p         = ui::getSplashProgress();
+	bool     srb2      = game::configuration().currentGame() == "srb2"; // Sonic robo blast 2
+	map_data.reserve(MapObject::Type::Thing, nt);
 	for (size_t a = 0; a < nt; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nt) * 0.2f);
-		MapThing* thing = map_data.addThing(std::make_unique<MapThing>(
+		if (a % PROGRESS_INTERVAL == 0)
+			ui::setSplashProgress(p + ((float)a / nt) * 0.2f);
+		auto thing = std::make_unique<MapThing>(
 			Vec3d{ (double)thng_data[a].x, (double)thng_data[a].y, 0. },
 			thng_data[a].type,
 			thng_data[a].angle,
-			thng_data[a].flags));
+			thng_data[a].flags);
 
-		if (game::configuration().currentGame() == "srb2") // Sonic robo blast 2
+		if (srb2)
 		{
 			// Srb2 stores thing's z position at the upper 12-bit from the thing's flags
 			thing->setZ((unsigned)(thng_data[a].flags >> 4));
 		}
+
+		map_data.addThing(std::move(thing));
 	}
 
 	log::info(3, "Read {} things", map_data.things().size());
@@ -70,9 +70,17 @@ bool HexenMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_
 	auto     line_data = (LineDef*)entry->rawData(true);
 	unsigned nl        = entry->size() / sizeof(LineDef);
 	float    p         = ui::getSplashProgress();
+	bool     big_sides = map_data.sides().size() > 32767;
+	map_data.reserve(MapObject::Type::Line, nl);
+
+	// Cache the tag type of each special as it's found, rather than looking it
+	// up in the game configuration for every line
+	std::array<std::optional<game::TagType>, 256> tag_types;
+
 	for (size_t a = 0; a < nl; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nl) * 0.2f);
+		if (a % PROGRESS_INTERVAL == 0)
+			ui::setSplashProgress(p + ((float)a / nl) * 0.2f);
 		const auto& data = line_data[a];
 
 		// Check vertices exist
@@ -87,7 +95,7 @@ bool HexenMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_
 		// Get side indices
 		int s1_index = data.side1;
 		int s2_index = data.side2;
-		if (map_data.sides().size() > 32767)
+		if (big_sides)
 		{
 			// Support for > 32768 sides
 			if (data.side1 != 65535)
@@ -104,24 +112,24 @@ bool HexenMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_
 		if (s2 && s2->parentLine())
 			s2 = map_data.duplicateSide(s2);
 
-		// Create line
-		auto line = map_data.addLine(std::make_unique<MapLine>(v1, v2, s1, s2, data.type, data.flags));
-
-		// Set properties
-		for (unsigned i = 0; i < 5; ++i)
-			line->setArg(i, data.args[i]);
+		// Create line (with properties set before adding it to the map, so its
+		// id and args are indexed once)
+		MapObject::ArgSet args{ data.args[0], data.args[1], data.args[2], data.args[3], data.args[4] };
+		auto              line = std::make_unique<MapLine>(v1, v2, s1, s2, data.type, data.flags, args);
 
 		// Handle some special cases
-		if (data.type)
+		auto& tag_type = tag_types[data.type];
+		if (!tag_type)
+			tag_type = data.type ? game::configuration().actionSpecial(data.type).needsTag() : game::TagType::None;
+		switch (*tag_type)
 		{
-			switch (game::configuration().actionSpecial(data.type).needsTag())
-			{
-			case game::TagType::LineId:
-			case game::TagType::LineId1Line2: line->setId(data.args[0]); break;
-			case game::TagType::LineIdHi5: line->setId((data.args[0] + (data.args[4] << 8))); break;
-			default: break;
-			}
+		case game::TagType::LineId:
+		case game::TagType::LineId1Line2: line->setId(data.args[0]); break;
+		case game::TagType::LineIdHi5: line->setId((data.args[0] + (data.args[4] << 8))); break;
+		default: break;
 		}
+
+		map_data.addLine(std::move(line));
 	}
 
 	log::info(3, "Read {} lines", map_data.lines().size());
@@ -152,9 +160,11 @@ bool HexenMapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_da
 	unsigned          nt        = entry->size() / sizeof(Thing);
 	float             p         = ui::getSplashProgress();
 	MapObject::ArgSet args;
+	map_data.reserve(MapObject::Type::Thing, nt);
 	for (size_t a = 0; a < nt; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nt) * 0.2f);
+		if (a % PROGRESS_INTERVAL == 0)
+			ui::setSplashProgress(p + ((float)a / nt) * 0.2f);
 		const auto& data = thng_data[a];
 
 		// Set args
@@ -20,5 +20,10 @@ public:
 	virtual void   setUDMFNamespace(string_view ns) {}
 
 	static unique_ptr<MapFormatHandler> get(MapFormat format);
+
+protected:
+	// Binary map lump readers only update the splash progress every this many
+	// records, rather than for every single one
+	static constexpr unsigned PROGRESS_INTERVAL = 256;
 };
 } // namespace slade
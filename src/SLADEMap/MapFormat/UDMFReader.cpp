@@ -0,0 +1,490 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    UDMFReader.cpp
+// Description: UDMFReader class - a fast, single-pass reader for UDMF TEXTMAP
+//              text. Tokenizes the text in place and returns each top-level
+//              definition as a compact list of fields with interned names,
+//              rather than building a full ParseTreeNode tree
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "UDMFReader.h"
+#include "App.h"
+#include "Archive/ArchiveEntry.h"
+#include "General/Console.h"
+#include "MainEditor/MainEditor.h"
+#include "Utility/Parser.h"
+#include "Utility/StringUtils.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [c] is whitespace (same as Tokenizer)
+// -----------------------------------------------------------------------------
+bool isWhitespace(char c)
+{
+	return c == '\n' || c == 13 || c == ' ' || c == '\t';
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [c] is one of Tokenizer's default special characters
+// -----------------------------------------------------------------------------
+bool isSpecialCharacter(char c)
+{
+	return c == ';' || c == ',' || c == ':' || c == '|' || c == '=' || c == '{' || c == '}' || c == '/';
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [str] is not empty and made up of only decimal digits
+// -----------------------------------------------------------------------------
+bool isDigits(string_view str)
+{
+	if (str.empty())
+		return false;
+
+	for (auto c : str)
+		if (c < '0' || c > '9')
+			return false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [str] is an integer, as per strutil::isInteger
+// -----------------------------------------------------------------------------
+bool isInteger(string_view str)
+{
+	if (!str.empty() && (str[0] == '+' || str[0] == '-'))
+		str.remove_prefix(1);
+
+	return isDigits(str);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [str] is a (lowercase) hex number, as per strutil::isHex
+// -----------------------------------------------------------------------------
+bool isHex(string_view str)
+{
+	if (str.size() < 3 || str[0] != '0' || str[1] != 'x')
+		return false;
+
+	for (auto c : str.substr(2))
+		if (!isxdigit(static_cast<unsigned char>(c)))
+			return false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [str] begins with one or more digits, followed by either
+// nothing or an exponent
+// -----------------------------------------------------------------------------
+bool isFloatTail(string_view str)
+{
+	size_t digits = 0;
+	while (digits < str.size() && str[digits] >= '0' && str[digits] <= '9')
+		++digits;
+	if (digits == 0)
+		return false;
+
+	str.remove_prefix(digits);
+	if (str.empty())
+		return true;
+
+	if (str[0] != 'e' && str[0] != 'E')
+		return false;
+	str.remove_prefix(1);
+	if (!str.empty() && (str[0] == '+' || str[0] == '-'))
+		str.remove_prefix(1);
+
+	return isDigits(str);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [str] is a floating point number, as per strutil::isFloat.
+// This matches the same (loose) regex - ^[-+]?[0-9]*.?[0-9]+([eE][-+]?[0-9]+)?$
+// - where the separator can be any character
+// -----------------------------------------------------------------------------
+bool isFloat(string_view str)
+{
+	if (str.empty() || str[0] == '$')
+		return false;
+
+	if (str[0] == '+' || str[0] == '-')
+		str.remove_prefix(1);
+
+	// No separator
+	if (isFloatTail(str))
+		return true;
+
+	// Separator after 0 or more leading digits
+	for (size_t a = 0; a < str.size(); ++a)
+	{
+		if (isFloatTail(str.substr(a + 1)))
+			return true;
+
+		if (str[a] < '0' || str[a] > '9')
+			break;
+	}
+
+	return false;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// UDMFReader Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Reads the next top-level definition. For a block, [name] is set to the block
+// type and [fields] to its properties, in the order they were defined. For an
+// assignment, [fields] will contain the single value assigned to [name]
+// -----------------------------------------------------------------------------
+UDMFReader::Result UDMFReader::next(string_view& name, UDMFFields& fields)
+{
+	fields.clear();
+
+	// Name
+	Token token;
+	if (!readToken(token))
+		return Result::End;
+	if (token.quoted || token.special || token.text[0] == '#')
+		return Result::Unsupported;
+	name = intern(token.text);
+
+	// Assignment
+	if (!readToken(token) || !token.special)
+		return Result::Unsupported;
+	if (token.text == "=")
+	{
+		fields.push_back({ name, {} });
+		return readValue(fields.back().value) ? Result::Assignment : Result::Unsupported;
+	}
+
+	// Block
+	if (token.text != "{")
+		return Result::Unsupported;
+	while (true)
+	{
+		if (!readToken(token))
+			return Result::Unsupported;
+
+		// End of block
+		if (token.special && token.text == "}")
+			return Result::Block;
+
+		// Field name
+		if (token.quoted || token.special || token.text[0] == '#')
+			return Result::Unsupported;
+		auto field_name = intern(token.text);
+
+		// Field value
+		if (!readToken(token) || !token.special || token.text != "=")
+			return Result::Unsupported;
+		fields.push_back({ field_name, {} });
+		if (!readValue(fields.back().value))
+			return Result::Unsupported;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads the next token to [token], skipping any whitespace and comments.
+// Returns false if the end of the text was reached
+// -----------------------------------------------------------------------------
+bool UDMFReader::readToken(Token& token)
+{
+	const auto size = text_.size();
+
+	// Skip whitespace and comments
+	while (pos_ < size)
+	{
+		auto c    = text_[pos_];
+		auto next = pos_ + 1 < size ? text_[pos_ + 1] : 0;
+
+		if (isWhitespace(c))
+			++pos_;
+		else if ((c == '/' && next == '/') || (c == '#' && next == '#'))
+		{
+			auto eol = text_.find('\n', pos_);
+			pos_     = eol == string_view::npos ? size : eol + 1;
+		}
+		else if (c == '/' && next == '*')
+		{
+			auto end = text_.find("*/", pos_ + 2);
+			pos_     = end == string_view::npos ? size : end + 2;
+		}
+		else
+			break;
+	}
+
+	if (pos_ >= size)
+		return false;
+
+	// Special character
+	if (isSpecialCharacter(text_[pos_]))
+	{
+		token.text    = text_.substr(pos_++, 1);
+		token.quoted  = false;
+		token.special = true;
+		return true;
+	}
+
+	// Quoted string (escaped quotes are kept as-is here, see tokenValue)
+	if (text_[pos_] == '\"')
+	{
+		auto start = ++pos_;
+		while (pos_ < size && text_[pos_] != '\"')
+			pos_ += text_[pos_] == '\\' && pos_ + 1 < size && text_[pos_ + 1] == '\"' ? 2 : 1;
+
+		token.text    = text_.substr(start, pos_ - start);
+		token.quoted  = true;
+		token.special = false;
+
+		// Skip closing "
+		if (pos_ < size)
+			++pos_;
+
+		return true;
+	}
+
+	// Regular token
+	auto start = pos_;
+	while (pos_ < size)
+	{
+		auto c = text_[pos_];
+		if (isWhitespace(c) || isSpecialCharacter(c) || (c == '#' && pos_ + 1 < size && text_[pos_ + 1] == '#'))
+			break;
+		++pos_;
+	}
+
+	token.text    = text_.substr(start, pos_ - start);
+	token.quoted  = false;
+	token.special = false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads the value(s) of an assignment up to the closing ';', setting [value]
+// to the first one (or false if there were none, same as ParseTreeNode::value).
+// Returns false if the assignment isn't in a form the reader supports
+// -----------------------------------------------------------------------------
+bool UDMFReader::readValue(Property& value)
+{
+	Token token;
+	if (!readToken(token))
+		return false;
+
+	if (token.special)
+	{
+		value = false;
+		return token.text == ";";
+	}
+
+	value = tokenValue(token);
+
+	// Skip any further values in the list
+	while (true)
+	{
+		if (!readToken(token) || !token.special)
+			return false;
+		if (token.text == ";")
+			return true;
+		if (token.text != ",")
+			return false;
+
+		if (!readToken(token))
+			return false;
+		if (token.special)
+			return token.text == ";";
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the lowercase, interned version of [name]
+// -----------------------------------------------------------------------------
+string_view UDMFReader::intern(string_view name)
+{
+	buffer_.assign(name);
+	strutil::lowerIP(buffer_);
+
+	auto i = names_.find(buffer_);
+	if (i == names_.end())
+		i = names_.insert(buffer_).first;
+
+	return *i;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the value of [token], with the type detected the same way as
+// ParseTreeNode::parseAssignment
+// -----------------------------------------------------------------------------
+Property UDMFReader::tokenValue(const Token& token)
+{
+	// Quoted string
+	if (token.quoted)
+	{
+		if (token.text.find("\\\"") == string_view::npos)
+			return string{ token.text };
+
+		// Unescape \"
+		string str;
+		str.reserve(token.text.size());
+		for (size_t a = 0; a < token.text.size(); ++a)
+		{
+			if (token.text[a] == '\\' && a + 1 < token.text.size() && token.text[a + 1] == '\"')
+				++a;
+			str += token.text[a];
+		}
+		return str;
+	}
+
+	// Unquoted tokens are read as lowercase (Parser is case-insensitive)
+	buffer_.assign(token.text);
+	strutil::lowerIP(buffer_);
+
+	if (buffer_ == "true")
+		return true;
+	if (buffer_ == "false")
+		return false;
+	if (isInteger(buffer_))
+		return strutil::asInt(buffer_);
+	if (isHex(buffer_))
+		return strutil::asInt(string_view{ buffer_ }.substr(2), 16);
+	if (isFloat(buffer_))
+		return strutil::asDouble(buffer_);
+
+	return buffer_;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// Compares the speed of UDMFReader and Parser reading the currently selected
+// (TEXTMAP) entry, and checks that both give the same definitions.
+// The number of runs can be given as an argument (default 10)
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(benchmark_udmf_read, 0, false)
+{
+	auto entry = maineditor::currentEntry();
+	if (!entry)
+		return;
+
+	int runs = 10;
+	if (!args.empty())
+		runs = std::max(strutil::asInt(args[0]), 1);
+
+	string_view text{ reinterpret_cast<const char*>(entry->rawData()), entry->size() };
+
+	// UDMFReader
+	vector<std::pair<string_view, UDMFFields>> blocks;
+	auto                                       start = app::runTimer();
+	for (int a = 0; a < runs; ++a)
+	{
+		blocks.clear();
+		UDMFReader         reader(text);
+		string_view        name;
+		UDMFFields         fields;
+		UDMFReader::Result result;
+		while ((result = reader.next(name, fields)) == UDMFReader::Result::Block
+			   || result == UDMFReader::Result::Assignment)
+			blocks.emplace_back(name, fields);
+
+		if (result == UDMFReader::Result::Unsupported)
+		{
+			log::console("Entry has syntax not supported by UDMFReader");
+			return;
+		}
+	}
+	auto reader_time = app::runTimer() - start;
+
+	// Parser (building the same field lists from the parse tree)
+	unique_ptr<Parser> parser;
+	start = app::runTimer();
+	for (int a = 0; a < runs; ++a)
+	{
+		parser = std::make_unique<Parser>();
+		if (!parser->parseText(entry->data()))
+		{
+			log::console("Parser failed to parse the entry");
+			return;
+		}
+
+		auto root = parser->parseTreeRoot();
+		for (unsigned b = 0; b < root->nChildren(); ++b)
+		{
+			auto       node = root->childPTN(b);
+			UDMFFields fields;
+			for (unsigned c = 0; c < node->nChildren(); ++c)
+				fields.push_back({ node->childPTN(c)->name(), node->childPTN(c)->value() });
+		}
+	}
+	auto parser_time = app::runTimer() - start;
+
+	log::console(fmt::format(
+		"Read {} definitions x{}: UDMFReader {}ms, Parser {}ms", blocks.size(), runs, reader_time, parser_time));
+
+	// Check results match
+	auto root  = parser->parseTreeRoot();
+	auto match = root->nChildren() == blocks.size();
+	for (unsigned a = 0; match && a < blocks.size(); ++a)
+	{
+		auto node = root->childPTN(a);
+		if (blocks[a].first != node->name())
+			match = false;
+		else if (node->nValues() > 0)
+			match = blocks[a].second.size() == 1 && blocks[a].second[0].value == node->value();
+		else if (blocks[a].second.size() != node->nChildren())
+			match = false;
+		else
+		{
+			for (unsigned c = 0; match && c < node->nChildren(); ++c)
+			{
+				auto child = node->childPTN(c);
+				match      = blocks[a].second[c].name == child->name() && blocks[a].second[c].value == child->value();
+			}
+		}
+	}
+	log::console(match ? "Results match" : "Results DON'T match!");
+}
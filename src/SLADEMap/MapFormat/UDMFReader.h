@@ -0,0 +1,52 @@
+#pragma once
+
+#include "SLADEMap/MapObject/MapObject.h"
+#include <unordered_set>
+
+namespace slade
+{
+// Reads UDMF (TEXTMAP) text one top-level definition at a time, directly from
+// the text in memory without building a parse tree. Property names are
+// lowercased and interned, so the UDMFFields returned only reference names
+// owned by the reader (it must outlive anything constructed from them).
+//
+// Values are typed the same way Parser does it, but only plain UDMF syntax is
+// handled - anything else (preprocessor directives, nested blocks, value lists
+// in braces etc.) gives Result::Unsupported, and the caller is expected to fall
+// back to Parser for the whole text
+class UDMFReader
+{
+public:
+	enum class Result
+	{
+		Block,      // A block definition, eg. 'vertex { x = 0; y = 0; }'
+		Assignment, // A map-scope assignment, eg. 'namespace = "zdoom";'
+		End,        // Nothing more to read
+		Unsupported // Syntax that isn't handled by the reader
+	};
+
+	UDMFReader(string_view text) : text_{ text } {}
+	~UDMFReader() = default;
+
+	Result next(string_view& name, UDMFFields& fields);
+	float  progress() const { return text_.empty() ? 1.0f : static_cast<float>(pos_) / text_.size(); }
+
+private:
+	struct Token
+	{
+		string_view text;
+		bool        quoted  = false;
+		bool        special = false;
+	};
+
+	string_view                text_;
+	size_t                     pos_ = 0;
+	std::unordered_set<string> names_;
+	string                     buffer_;
+
+	bool        readToken(Token& token);
+	bool        readValue(Property& value);
+	string_view intern(string_view name);
+	Property    tokenValue(const Token& token);
+};
+} // namespace slade
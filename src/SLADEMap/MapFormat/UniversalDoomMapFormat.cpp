@@ -31,20 +31,206 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "UniversalDoomMapFormat.h"
-#include "App.h"
 #include "Game/Configuration.h"
+#include "General/Tasks.h"
 #include "General/UI.h"
 #include "SLADEMap/MapObject/MapLine.h"
 #include "SLADEMap/MapObject/MapSector.h"
 #include "SLADEMap/MapObject/MapVertex.h"
 #include "SLADEMap/MapObjectCollection.h"
 #include "SLADEMap/SLADEMap.h"
+#include "UDMFReader.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// UDMF definitions sorted by type, along with any map-scope values
+struct UDMFDefinitions
+{
+	vector<UDMFFields> vertices;
+	vector<UDMFFields> lines;
+	vector<UDMFFields> sides;
+	vector<UDMFFields> sectors;
+	vector<UDMFFields> things;
+	string             udmf_namespace;
+	PropertyList       map_props;
+};
+
+// -----------------------------------------------------------------------------
+// Reads all definitions from [reader] into [defs]. Returns false if the reader
+// came across anything it doesn't support
+// -----------------------------------------------------------------------------
+bool readDefinitions(UDMFReader& reader, UDMFDefinitions& defs)
+{
+	string_view name;
+	UDMFFields  fields;
+	unsigned    count = 0;
+	while (true)
+	{
+		auto result = reader.next(name, fields);
+		if (result == UDMFReader::Result::End)
+			return true;
+		if (result == UDMFReader::Result::Unsupported)
+			return false;
+
+		if (++count % 1000 == 0)
+			ui::setSplashProgress(reader.progress());
+
+		// Map-scope value
+		if (result == UDMFReader::Result::Assignment)
+		{
+			if (name == "namespace")
+				defs.udmf_namespace = property::asString(fields[0].value);
+			else
+				defs.map_props[name] = fields[0].value;
+			continue;
+		}
+
+		// Definition block, moved to an exactly-sized list so [fields] can be reused
+		vector<UDMFFields>* list;
+		if (name == "vertex")
+			list = &defs.vertices;
+		else if (name == "linedef")
+			list = &defs.lines;
+		else if (name == "sidedef")
+			list = &defs.sides;
+		else if (name == "sector")
+			list = &defs.sectors;
+		else if (name == "thing")
+			list = &defs.things;
+		else
+			continue; // TODO: Unknown blocks
+
+		list->emplace_back(std::make_move_iterator(fields.begin()), std::make_move_iterator(fields.end()));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Gets all definitions from the parse tree in [parser] into [defs]. This is
+// only used for TEXTMAPs that UDMFReader can't handle, and the field names
+// reference the parse tree so [parser] must be kept until they're used
+// -----------------------------------------------------------------------------
+void parseDefinitions(Parser& parser, UDMFDefinitions& defs)
+{
+	auto root = parser.parseTreeRoot();
+	for (unsigned a = 0; a < root->nChildren(); a++)
+	{
+		auto node = root->childPTN(a);
+
+		// Namespace
+		if (strutil::equalCI(node->name(), "namespace"))
+		{
+			defs.udmf_namespace = node->stringValue();
+			continue;
+		}
+
+		// Definition block
+		vector<UDMFFields>* list = nullptr;
+		if (strutil::equalCI(node->name(), "vertex"))
+			list = &defs.vertices;
+		else if (strutil::equalCI(node->name(), "linedef"))
+			list = &defs.lines;
+		else if (strutil::equalCI(node->name(), "sidedef"))
+			list = &defs.sides;
+		else if (strutil::equalCI(node->name(), "sector"))
+			list = &defs.sectors;
+		else if (strutil::equalCI(node->name(), "thing"))
+			list = &defs.things;
+
+		if (list)
+		{
+			auto& fields = list->emplace_back();
+			fields.reserve(node->nChildren());
+			for (unsigned c = 0; c < node->nChildren(); c++)
+			{
+				auto child = node->childPTN(c);
+				fields.push_back({ child->name(), child->value() });
+			}
+		}
+
+		// Map-scope value
+		else if (node->nValues() > 0)
+			defs.map_props[node->name()] = node->value();
+
+		// TODO: Unknown blocks
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the value of the first field in [def] matching [name], or nullptr if
+// there is none
+// -----------------------------------------------------------------------------
+const Property* findField(const UDMFFields& def, string_view name)
+{
+	for (const auto& field : def)
+		if (field.name == name)
+			return &field.value;
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Cleans up and writes all objects in [map_data] as UDMF text to [chunks], in
+// the order they go in the TEXTMAP (things, lines, sides, vertices, sectors).
+// Each chunk is a range of objects written on one of the task workers, so
+// appending them in order gives exactly the same text as writing serially
+// -----------------------------------------------------------------------------
+void writeObjects(const MapObjectCollection& map_data, vector<string>& chunks)
+{
+	constexpr size_t chunk_size = 1024;
+
+	vector<MapObject*> objects;
+	objects.reserve(
+		map_data.things().size() + map_data.lines().size() + map_data.sides().size() + map_data.vertices().size()
+		+ map_data.sectors().size());
+	objects.insert(objects.end(), map_data.things().begin(), map_data.things().end());
+	objects.insert(objects.end(), map_data.lines().begin(), map_data.lines().end());
+	objects.insert(objects.end(), map_data.sides().begin(), map_data.sides().end());
+	objects.insert(objects.end(), map_data.vertices().begin(), map_data.vertices().end());
+	objects.insert(objects.end(), map_data.sectors().begin(), map_data.sectors().end());
+
+	chunks.clear();
+	chunks.resize((objects.size() + chunk_size - 1) / chunk_size);
+
+	// Each object only modifies its own properties here and the game
+	// configuration is only read from, so chunks can be written concurrently
+	tasks::parallelFor(
+		0,
+		chunks.size(),
+		[&](unsigned c)
+		{
+			string object_def;
+			auto&  chunk = chunks[c];
+			auto   end   = std::min(objects.size(), (c + 1) * chunk_size);
+			for (auto a = c * chunk_size; a < end; ++a)
+			{
+				auto object = objects[a];
+
+				// Cleanup properties
+				if (!object->props().empty())
+				{
+					if (object->objType() == MapObject::Type::Thing || object->objType() == MapObject::Type::Line)
+						object->props().remove("flags");
+					game::configuration().cleanObjectUDMFProps(object);
+				}
+
+				object->writeUDMF(object_def);
+				chunk += object_def;
+			}
+		});
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // UniversalDoomMapFormat Class Functions
@@ -66,71 +252,39 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	if (!textmap)
 		return false;
 
-	// --- Parse UDMF text ---
-	ui::setSplashProgressMessage("Parsing TEXTMAP");
-	ui::setSplashProgress(-100.0f);
-	Parser parser;
-	if (!parser.parseText(textmap->data()))
-		return false;
-
-	// --- Process parsed data ---
-
-	// First we have to sort the definition blocks by type so they can
-	// be created in the correct order (verts->sides->lines->sectors->things),
-	// even if they aren't defined in that order.
-	// Unknown definitions are also kept, just in case
-	ui::setSplashProgressMessage("Sorting definitions");
-	auto                   root = parser.parseTreeRoot();
-	vector<ParseTreeNode*> defs_vertices;
-	vector<ParseTreeNode*> defs_lines;
-	vector<ParseTreeNode*> defs_sides;
-	vector<ParseTreeNode*> defs_sectors;
-	vector<ParseTreeNode*> defs_things;
-	vector<ParseTreeNode*> defs_other;
-	for (unsigned a = 0; a < root->nChildren(); a++)
+	// --- Read UDMF text ---
+	// The definition blocks are sorted by type as they are read so they can be
+	// created in the correct order (verts->sectors->sides->lines->things), even
+	// if they aren't defined in that order
+	ui::setSplashProgressMessage("Reading TEXTMAP");
+	ui::setSplashProgress(0.0f);
+	UDMFDefinitions defs;
+	UDMFReader      reader({ reinterpret_cast<const char*>(textmap->rawData()), textmap->size() });
+	Parser          parser; // Only used if the reader can't handle the TEXTMAP
+	if (!readDefinitions(reader, defs))
 	{
-		ui::setSplashProgress((float)a / root->nChildren());
+		log::info("TEXTMAP has syntax not supported by UDMFReader, parsing with Parser instead");
 
-		auto node = root->childPTN(a);
+		defs = {};
+		ui::setSplashProgressMessage("Parsing TEXTMAP");
+		ui::setSplashProgress(-100.0f);
+		if (!parser.parseText(textmap->data()))
+			return false;
 
-		// Vertex definition
-		if (strutil::equalCI(node->name(), "vertex"))
-			defs_vertices.push_back(node);
-
-		// Line definition
-		else if (strutil::equalCI(node->name(), "linedef"))
-			defs_lines.push_back(node);
-
-		// Side definition
-		else if (strutil::equalCI(node->name(), "sidedef"))
-			defs_sides.push_back(node);
-
-		// Sector definition
-		else if (strutil::equalCI(node->name(), "sector"))
-			defs_sectors.push_back(node);
-
-		// Thing definition
-		else if (strutil::equalCI(node->name(), "thing"))
-			defs_things.push_back(node);
-
-		// Namespace
-		else if (strutil::equalCI(node->name(), "namespace"))
-			udmf_namespace_ = node->stringValue();
-
-		// Unknown
-		else
-			defs_other.push_back(node);
+		parseDefinitions(parser, defs);
 	}
+	if (!defs.udmf_namespace.empty())
+		udmf_namespace_ = defs.udmf_namespace;
 
-	// Now create map structures from parsed data, in the right order
+	// --- Create map structures from the definitions, in the right order ---
 
 	// Create vertices from parsed data
 	ui::setSplashProgressMessage("Reading Vertices");
-	for (unsigned a = 0; a < defs_vertices.size(); a++)
+	for (unsigned a = 0; a < defs.vertices.size(); a++)
 	{
-		ui::setSplashProgress(((float)a / defs_vertices.size()) * 0.2f);
+		ui::setSplashProgress(((float)a / defs.vertices.size()) * 0.2f);
 
-		auto vertex = createVertex(defs_vertices[a]);
+		auto vertex = createVertex(defs.vertices[a]);
 		if (!vertex)
 		{
 			log::warning("Invalid UDMF vertex definition {}, not added", a);
@@ -139,14 +293,16 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 
 		map_data.addVertex(std::move(vertex));
 	}
+	defs.vertices.clear(); // Free each type's definitions once they're created
+	defs.vertices.shrink_to_fit();
 
 	// Create sectors from parsed data
 	ui::setSplashProgressMessage("Reading Sectors");
-	for (unsigned a = 0; a < defs_sectors.size(); a++)
+	for (unsigned a = 0; a < defs.sectors.size(); a++)
 	{
-		ui::setSplashProgress(0.2f + ((float)a / defs_sectors.size()) * 0.2f);
+		ui::setSplashProgress(0.2f + ((float)a / defs.sectors.size()) * 0.2f);
 
-		auto sector = createSector(defs_sectors[a]);
+		auto sector = createSector(defs.sectors[a]);
 		if (!sector)
 		{
 			log::warning("Invalid UDMF sector definition {}, not added", a);
@@ -155,14 +311,16 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 
 		map_data.addSector(std::move(sector));
 	}
+	defs.sectors.clear();
+	defs.sectors.shrink_to_fit();
 
 	// Create sides from parsed data
 	ui::setSplashProgressMessage("Reading Sides");
-	for (unsigned a = 0; a < defs_sides.size(); a++)
+	for (unsigned a = 0; a < defs.sides.size(); a++)
 	{
-		ui::setSplashProgress(0.4f + ((float)a / defs_sides.size()) * 0.2f);
+		ui::setSplashProgress(0.4f + ((float)a / defs.sides.size()) * 0.2f);
 
-		auto side = createSide(defs_sides[a], map_data);
+		auto side = createSide(defs.sides[a], map_data);
 		if (!side)
 		{
 			log::warning("Invalid UDMF side definition {}, not added", a);
@@ -171,14 +329,16 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 
 		map_data.addSide(std::move(side));
 	}
+	defs.sides.clear();
+	defs.sides.shrink_to_fit();
 
 	// Create lines from parsed data
 	ui::setSplashProgressMessage("Reading Lines");
-	for (unsigned a = 0; a < defs_lines.size(); a++)
+	for (unsigned a = 0; a < defs.lines.size(); a++)
 	{
-		ui::setSplashProgress(0.6f + ((float)a / defs_lines.size()) * 0.2f);
+		ui::setSplashProgress(0.6f + ((float)a / defs.lines.size()) * 0.2f);
 
-		auto line = createLine(defs_lines[a], map_data);
+		auto line = createLine(defs.lines[a], map_data);
 		if (!line)
 		{
 			log::warning("Invalid UDMF line definition {}, not added", a);
@@ -187,14 +347,16 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 
 		map_data.addLine(std::move(line));
 	}
+	defs.lines.clear();
+	defs.lines.shrink_to_fit();
 
 	// Create things from parsed data
 	ui::setSplashProgressMessage("Reading Things");
-	for (unsigned a = 0; a < defs_things.size(); a++)
+	for (unsigned a = 0; a < defs.things.size(); a++)
 	{
-		ui::setSplashProgress(0.8f + ((float)a / defs_things.size()) * 0.2f);
+		ui::setSplashProgress(0.8f + ((float)a / defs.things.size()) * 0.2f);
 
-		auto thing = createThing(defs_things[a]);
+		auto thing = createThing(defs.things[a]);
 		if (!thing)
 		{
 			log::warning("Invalid UDMF thing definition {}, not added", a);
@@ -203,15 +365,12 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 
 		map_data.addThing(std::move(thing));
 	}
+	defs.things.clear();
+	defs.things.shrink_to_fit();
 
 	// Keep map-scope values
-	for (auto node : defs_other)
-	{
-		if (node->nValues() > 0)
-			map_extra_props[node->name()] = node->value();
-
-		// TODO: Unknown blocks
-	}
+	for (const auto& prop : defs.map_props.properties())
+		map_extra_props[prop.name] = prop.value;
 
 	ui::setSplashProgressMessage("Init map data");
 
@@ -229,144 +388,78 @@ vector<unique_ptr<ArchiveEntry>> UniversalDoomMapFormat::writeMap(
 	vector<unique_ptr<ArchiveEntry>> entries;
 	entries.push_back(std::make_unique<ArchiveEntry>("TEXTMAP"));
 
-	// Open temp text file
-	wxFile tempfile(app::path("sladetemp.txt", app::Dir::Temp), wxFile::write);
+	MemChunk textmap;
+	auto write = [&textmap](string_view str) { textmap.write(str.data(), str.size()); };
 
 	// Write map namespace
-	tempfile.Write("// Written by SLADE3\n");
-	tempfile.Write(fmt::format("namespace=\"{}\";\n", udmf_namespace_));
+	write("// Written by SLADE3\n");
+	write(fmt::format("namespace=\"{}\";\n", udmf_namespace_));
 
 	// Write map-scope props
-	tempfile.Write(map_extra_props.toString(true));
-	tempfile.Write("\n");
-
-	// sf::Clock clock;
+	write(map_extra_props.toString(true));
+	write("\n");
 
 	// Locale for float number format
 	setlocale(LC_NUMERIC, "C");
 
-	// Write things
-	string object_def;
-	for (const auto& thing : map_data.things())
-	{
-		// Cleanup properties
-		if (!thing->props().empty())
-		{
-			thing->props().remove("flags");
-			game::configuration().cleanObjectUDMFProps(thing);
-		}
-
-		thing->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing things took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Write lines
-	// clock.restart();
-	for (const auto& line : map_data.lines())
-	{
-		// Cleanup properties
-		if (!line->props().empty())
-		{
-			line->props().remove("flags");
-			game::configuration().cleanObjectUDMFProps(line);
-		}
-
-		line->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing lines took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Write sides
-	// clock.restart();
-	for (const auto& side : map_data.sides())
-	{
-		// Cleanup properties
-		if (!side->props().empty())
-			game::configuration().cleanObjectUDMFProps(side);
-
-		side->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing sides took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Write vertices
-	// clock.restart();
-	for (const auto& vertex : map_data.vertices())
-	{
-		// Cleanup properties
-		if (!vertex->props().empty())
-			game::configuration().cleanObjectUDMFProps(vertex);
-
-		vertex->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing vertices took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Write sectors
-	// clock.restart();
-	for (const auto& sector : map_data.sectors())
-	{
-		// Cleanup properties
-		if (!sector->props().empty())
-			game::configuration().cleanObjectUDMFProps(sector);
-
-		sector->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing sectors took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Close file
-	tempfile.Close();
+	// Write objects, in chunks that are formatted in parallel
+	vector<string> chunks;
+	writeObjects(map_data, chunks);
+	size_t size = textmap.size();
+	for (const auto& chunk : chunks)
+		size += chunk.size();
+	textmap.reserve(size);
+	for (const auto& chunk : chunks)
+		write(chunk);
 
-	// Load file to entry
-	entries[0]->importFile(app::path("sladetemp.txt", app::Dir::Temp));
+	// Load data to entry
+	entries[0]->importMemChunk(textmap);
 
 	return entries;
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a vertex from parsed UDMF definition [def]
+// Creates and returns a vertex from UDMF definition [def]
 // -----------------------------------------------------------------------------
-unique_ptr<MapVertex> UniversalDoomMapFormat::createVertex(ParseTreeNode* def) const
+unique_ptr<MapVertex> UniversalDoomMapFormat::createVertex(const UDMFFields& def) const
 {
 	// Check for required properties
-	auto prop_x = def->childPTN("x");
-	auto prop_y = def->childPTN("y");
+	auto prop_x = findField(def, MapVertex::PROP_X);
+	auto prop_y = findField(def, MapVertex::PROP_Y);
 	if (!prop_x || !prop_y)
 		return nullptr;
 
 	// Create vertex
-	return std::make_unique<MapVertex>(Vec2d{ prop_x->floatValue(), prop_y->floatValue() }, def);
+	return std::make_unique<MapVertex>(Vec2d{ property::asFloat(*prop_x), property::asFloat(*prop_y) }, def);
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a sector from parsed UDMF definition [def]
+// Creates and returns a sector from UDMF definition [def]
 // -----------------------------------------------------------------------------
-unique_ptr<MapSector> UniversalDoomMapFormat::createSector(ParseTreeNode* def) const
+unique_ptr<MapSector> UniversalDoomMapFormat::createSector(const UDMFFields& def) const
 {
 	// Check for required properties
-	auto prop_ftex = def->childPTN("texturefloor");
-	auto prop_ctex = def->childPTN("textureceiling");
+	auto prop_ftex = findField(def, MapSector::PROP_TEXFLOOR);
+	auto prop_ctex = findField(def, MapSector::PROP_TEXCEILING);
 	if (!prop_ftex || !prop_ctex)
 		return nullptr;
 
 	// Create sector
-	return std::make_unique<MapSector>(prop_ftex->stringValue(), prop_ctex->stringValue(), def);
+	return std::make_unique<MapSector>(property::asString(*prop_ftex), property::asString(*prop_ctex), def);
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a side from parsed UDMF definition [def]
+// Creates and returns a side from UDMF definition [def]
 // -----------------------------------------------------------------------------
-unique_ptr<MapSide> UniversalDoomMapFormat::createSide(ParseTreeNode* def, const MapObjectCollection& map_data) const
+unique_ptr<MapSide> UniversalDoomMapFormat::createSide(const UDMFFields& def, const MapObjectCollection& map_data) const
 {
 	// Check for required properties
-	auto prop_sector = def->childPTN("sector");
+	auto prop_sector = findField(def, MapSide::PROP_SECTOR);
 	if (!prop_sector)
 		return nullptr;
 
 	// Check sector exists
-	auto sector = map_data.sectors().at(prop_sector->intValue());
+	auto sector = map_data.sectors().at(property::asInt(*prop_sector));
 	if (!sector)
 		return nullptr;
 
@@ -375,27 +468,27 @@ unique_ptr<MapSide> UniversalDoomMapFormat::createSide(ParseTreeNode* def, const
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a line from parsed UDMF definition [def]
+// Creates and returns a line from UDMF definition [def]
 // -----------------------------------------------------------------------------
-unique_ptr<MapLine> UniversalDoomMapFormat::createLine(ParseTreeNode* def, MapObjectCollection& map_data) const
+unique_ptr<MapLine> UniversalDoomMapFormat::createLine(const UDMFFields& def, MapObjectCollection& map_data) const
 {
 	// Check for required properties
-	auto prop_v1 = def->childPTN(MapLine::PROP_V1);
-	auto prop_v2 = def->childPTN(MapLine::PROP_V2);
-	auto prop_s1 = def->childPTN(MapLine::PROP_S1);
-	auto prop_s2 = def->childPTN(MapLine::PROP_S2);
+	auto prop_v1 = findField(def, MapLine::PROP_V1);
+	auto prop_v2 = findField(def, MapLine::PROP_V2);
+	auto prop_s1 = findField(def, MapLine::PROP_S1);
+	auto prop_s2 = findField(def, MapLine::PROP_S2);
 	if (!prop_v1 || !prop_v2 || !prop_s1)
 		return nullptr;
 
 	// Check vertices
-	auto v1 = map_data.vertices().at(prop_v1->intValue());
-	auto v2 = map_data.vertices().at(prop_v2->intValue());
+	auto v1 = map_data.vertices().at(property::asInt(*prop_v1));
+	auto v2 = map_data.vertices().at(property::asInt(*prop_v2));
 	if (!v1 || !v2)
 		return nullptr;
 
 	// Get sides
-	auto s1 = map_data.sides().at(prop_s1->intValue());
-	auto s2 = prop_s2 ? map_data.sides().at(prop_s2->intValue()) : nullptr;
+	auto s1 = map_data.sides().at(property::asInt(*prop_s1));
+	auto s2 = prop_s2 ? map_data.sides().at(property::asInt(*prop_s2)) : nullptr;
 
 	// Copy side(s) if they already have parent lines (compressed sidedefs)
 	if (s1 && s1->parentLine())
@@ -408,18 +501,18 @@ unique_ptr<MapLine> UniversalDoomMapFormat::createLine(ParseTreeNode* def, MapOb
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a thing from parsed UDMF definition [def]
+// Creates and returns a thing from UDMF definition [def]
 // -----------------------------------------------------------------------------
-unique_ptr<MapThing> UniversalDoomMapFormat::createThing(ParseTreeNode* def) const
+unique_ptr<MapThing> UniversalDoomMapFormat::createThing(const UDMFFields& def) const
 {
 	// Check for required properties
-	auto prop_x    = def->childPTN(MapThing::PROP_X);
-	auto prop_y    = def->childPTN(MapThing::PROP_Y);
-	auto prop_type = def->childPTN(MapThing::PROP_TYPE);
+	auto prop_x    = findField(def, MapThing::PROP_X);
+	auto prop_y    = findField(def, MapThing::PROP_Y);
+	auto prop_type = findField(def, MapThing::PROP_TYPE);
 	if (!prop_x || !prop_y || !prop_type)
 		return nullptr;
 
 	// Create thing
 	return std::make_unique<MapThing>(
-		Vec3d{ prop_x->floatValue(), prop_y->floatValue(), 0. }, prop_type->intValue(), def);
+		Vec3d{ property::asFloat(*prop_x), property::asFloat(*prop_y), 0. }, property::asInt(*prop_type), def);
 }
@@ -9,7 +9,7 @@ class MapSector;
 class MapSide;
 class MapLine;
 class MapThing;
-class ParseTreeNode;
+struct UDMFField;
 
 class UniversalDoomMapFormat : public MapFormatHandler
 {
@@ -25,10 +25,10 @@ public:
 private:
 	string udmf_namespace_;
 
-	unique_ptr<MapVertex> createVertex(ParseTreeNode* def) const;
-	unique_ptr<MapSector> createSector(ParseTreeNode* def) const;
-	unique_ptr<MapSide>   createSide(ParseTreeNode* def, const MapObjectCollection& map_data) const;
-	unique_ptr<MapLine>   createLine(ParseTreeNode* def, MapObjectCollection& map_data) const;
-	unique_ptr<MapThing>  createThing(ParseTreeNode* def) const;
+	unique_ptr<MapVertex> createVertex(const vector<UDMFField>& def) const;
+	unique_ptr<MapSector> createSector(const vector<UDMFField>& def) const;
+	unique_ptr<MapSide>   createSide(const vector<UDMFField>& def, const MapObjectCollection& map_data) const;
+	unique_ptr<MapLine>   createLine(const vector<UDMFField>& def, MapObjectCollection& map_data) const;
+	unique_ptr<MapThing>  createThing(const vector<UDMFField>& def) const;
 };
 } // namespace slade
@@ -48,6 +48,22 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Allocates memory for a MapLine from its pool (see MapObjectPool)
+// -----------------------------------------------------------------------------
+void* MapLine::operator new(size_t size)
+{
+	return MapObjectPool<MapLine>::allocate(size);
+}
+
+// -----------------------------------------------------------------------------
+// Frees memory for a MapLine back to its pool
+// -----------------------------------------------------------------------------
+void MapLine::operator delete(void* ptr, size_t size)
+{
+	MapObjectPool<MapLine>::release(ptr, size);
+}
+
 // -----------------------------------------------------------------------------
 // MapLine class constructor
 // -----------------------------------------------------------------------------
@@ -77,7 +93,7 @@ MapLine::MapLine(MapVertex* v1, MapVertex* v2, MapSide* s1, MapSide* s2, int spe
 // -----------------------------------------------------------------------------
 // MapLine class constructor from UDMF definition
 // -----------------------------------------------------------------------------
-MapLine::MapLine(MapVertex* v1, MapVertex* v2, MapSide* s1, MapSide* s2, ParseTreeNode* udmf_def) :
+MapLine::MapLine(MapVertex* v1, MapVertex* v2, MapSide* s1, MapSide* s2, const UDMFFields& udmf_fields) :
 	MapObject(Type::Line),
 	vertex1_{ v1 },
 	vertex2_{ v2 },
@@ -97,33 +113,30 @@ MapLine::MapLine(MapVertex* v1, MapVertex* v2, MapSide* s1, MapSide* s2, ParseTr
 		s2->parent_ = this;
 
 	// Set properties from UDMF definition
-	ParseTreeNode* prop;
-	for (unsigned a = 0; a < udmf_def->nChildren(); a++)
+	for (const auto& field : udmf_fields)
 	{
-		prop = udmf_def->childPTN(a);
-
 		// Skip required properties
-		if (prop->nameIsCI(PROP_V1) || prop->nameIsCI(PROP_V2) || prop->nameIsCI(PROP_S1) || prop->nameIsCI(PROP_S2))
+		if (field.name == PROP_V1 || field.name == PROP_V2 || field.name == PROP_S1 || field.name == PROP_S2)
 			continue;
 
-		if (prop->nameIsCI(PROP_SPECIAL))
-			special_ = prop->intValue();
-		else if (prop->nameIsCI(PROP_ID))
-			id_ = prop->intValue();
-		else if (prop->nameIsCI(PROP_FLAGS))
-			flags_ = prop->intValue();
-		else if (prop->nameIsCI(PROP_ARG0))
-			args_[0] = prop->intValue();
-		else if (prop->nameIsCI(PROP_ARG1))
-			args_[1] = prop->intValue();
-		else if (prop->nameIsCI(PROP_ARG2))
-			args_[2] = prop->intValue();
-		else if (prop->nameIsCI(PROP_ARG3))
-			args_[3] = prop->intValue();
-		else if (prop->nameIsCI(PROP_ARG4))
-			args_[4] = prop->intValue();
+		if (field.name == PROP_SPECIAL)
+			special_ = property::asInt(field.value);
+		else if (field.name == PROP_ID)
+			id_ = property::asInt(field.value);
+		else if (field.name == PROP_FLAGS)
+			flags_ = property::asInt(field.value);
+		else if (field.name == PROP_ARG0)
+			args_[0] = property::asInt(field.value);
+		else if (field.name == PROP_ARG1)
+			args_[1] = property::asInt(field.value);
+		else if (field.name == PROP_ARG2)
+			args_[2] = property::asInt(field.value);
+		else if (field.name == PROP_ARG3)
+			args_[3] = property::asInt(field.value);
+		else if (field.name == PROP_ARG4)
+			args_[4] = property::asInt(field.value);
 		else
-			properties_[prop->name()] = prop->value();
+			properties_[field.name] = field.value;
 	}
 }
 
@@ -409,6 +422,8 @@ void MapLine::setIntProperty(string_view key, int value)
 	// Line property
 	else
 		MapObject::setIntProperty(key, value);
+
+	updateIdIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -541,6 +556,7 @@ void MapLine::setId(int id)
 {
 	setModified();
 	id_ = id;
+	updateIdIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -579,6 +595,7 @@ void MapLine::setArg(unsigned index, int value)
 	{
 		setModified();
 		args_[index] = value;
+		updateIdIndex();
 	}
 }
 
@@ -837,6 +854,7 @@ void MapLine::resetInternals()
 	// Reset line internals
 	length_ = -1;
 	front_vec_.set(0, 0);
+	updateSpatialIndex();
 
 	// Reset front sector internals
 	auto s1 = frontSector();
@@ -956,6 +974,7 @@ void MapLine::readBackup(Backup* backup)
 	args_[2] = backup->props_internal.get<int>(PROP_ARG2);
 	args_[3] = backup->props_internal.get<int>(PROP_ARG3);
 	args_[4] = backup->props_internal.get<int>(PROP_ARG4);
+	updateIdIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -987,6 +1006,7 @@ void MapLine::copy(MapObject* c)
 	args_[2] = l->args_[2];
 	args_[3] = l->args_[3];
 	args_[4] = l->args_[4];
+	updateIdIndex();
 }
 
 // -----------------------------------------------------------------------------
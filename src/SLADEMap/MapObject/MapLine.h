@@ -41,9 +41,13 @@ public:
 		int        special = 0,
 		int        flags   = 0,
 		ArgSet     args    = {});
-	MapLine(MapVertex* v1, MapVertex* v2, MapSide* s1, MapSide* s2, ParseTreeNode* udmf_def);
+	MapLine(MapVertex* v1, MapVertex* v2, MapSide* s1, MapSide* s2, const UDMFFields& udmf_fields);
 	~MapLine() = default;
 
+	// Allocated from a pool (see MapObjectPool)
+	static void* operator new(size_t size);
+	static void  operator delete(void* ptr, size_t size);
+
 	bool isOk() const { return vertex1_ && vertex2_; }
 
 	MapVertex*    v1() const { return vertex1_; }
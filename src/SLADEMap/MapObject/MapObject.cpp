@@ -73,6 +73,26 @@ unsigned MapObject::index() const
 	return index_;
 }
 
+// -----------------------------------------------------------------------------
+// Updates the object in the parent map's spatial index (see MapObjectGrid), to
+// be called whenever its position changes
+// -----------------------------------------------------------------------------
+void MapObject::updateSpatialIndex()
+{
+	if (parent_map_)
+		parent_map_->updateSpatialIndex(this);
+}
+
+// -----------------------------------------------------------------------------
+// Updates the object in the parent map's id indices (see MapObjectIdIndex), to
+// be called whenever its id/tag or args change
+// -----------------------------------------------------------------------------
+void MapObject::updateIdIndex()
+{
+	if (parent_map_)
+		parent_map_->updateIdIndex(this);
+}
+
 // -----------------------------------------------------------------------------
 // Returns a string representation of the object type
 // -----------------------------------------------------------------------------
@@ -104,6 +124,9 @@ void MapObject::setModified()
 	}
 
 	modified_time_ = app::runTimer();
+
+	if (parent_map_)
+		parent_map_->recordModified(this);
 }
 
 // -----------------------------------------------------------------------------
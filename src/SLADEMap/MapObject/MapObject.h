@@ -4,7 +4,8 @@
 #pragma clang diagnostic ignored "-Wundefined-bool-conversion"
 #endif
 
-#include "Utility/Property.h"
+#include "MapObjectPool.h"
+#include "MobjPropertyList.h"
 #include <array>
 
 namespace slade
@@ -19,6 +20,16 @@ class MapLine;
 class MapSector;
 class MapThing;
 
+// A single property assignment from a UDMF object definition. The name is
+// always lowercase and is owned by whatever read the definition (UDMFReader or
+// a parse tree), so it must outlive the object constructed from it
+struct UDMFField
+{
+	string_view name;
+	Property    value;
+};
+typedef vector<UDMFField> UDMFFields;
+
 class MapObject
 {
 	friend class SLADEMap;
@@ -44,10 +55,10 @@ public:
 
 	struct Backup
 	{
-		PropertyList properties;
-		PropertyList props_internal;
-		unsigned     id   = 0;
-		Type         type = Type::Object;
+		MobjPropertyList properties;
+		MobjPropertyList props_internal;
+		unsigned         id   = 0;
+		Type             type = Type::Object;
 	};
 
 	typedef std::array<int, 5> ArgSet;
@@ -70,8 +81,9 @@ public:
 	void      setModified();
 	void      setIndex(unsigned index) { index_ = index; }
 
-	PropertyList& props() { return properties_; }
-	bool          hasProp(string_view key) const { return properties_.contains(key); }
+	MobjPropertyList&       props() { return properties_; }
+	const MobjPropertyList& props() const { return properties_; }
+	bool                    hasProp(string_view key) const { return properties_.contains(key); }
 
 	// Generic property modification
 	virtual bool   boolProperty(string_view key);
@@ -109,9 +121,12 @@ public:
 	static bool multiStringProperty(vector<MapObject*>& objects, string_view prop, string& value);
 
 protected:
+	void updateSpatialIndex();
+	void updateIdIndex();
+
 	unsigned           index_      = 0;
 	SLADEMap*          parent_map_ = nullptr;
-	PropertyList       properties_;
+	MobjPropertyList   properties_;
 	bool               filtered_      = false;
 	long               modified_time_ = 0;
 	unsigned           obj_id_        = 0;
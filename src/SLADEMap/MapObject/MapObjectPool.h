@@ -0,0 +1,107 @@
+#pragma once
+
+#include "General/MemoryStats.h"
+#include <mutex>
+
+namespace slade
+{
+// A simple slab allocator for map objects of type [T], used via class-specific
+// operator new/delete on the map object types. Objects are allocated
+// sequentially from slabs of SLAB_SIZE objects (so objects created together,
+// eg. when loading a map, end up together in memory), and freed objects are
+// reused before the current slab is extended. Addresses are stable, since
+// objects are never moved.
+//
+// Map objects generally live until their MapObjectCollection is cleared (they
+// are kept around for undo/redo after being removed from the map), so once the
+// last object of a type is freed all its slabs are released in one go rather
+// than being kept around
+template<class T> class MapObjectPool
+{
+public:
+	static constexpr unsigned SLAB_SIZE = 1024;
+
+	static void* allocate(size_t size)
+	{
+		// Let anything bigger (a derived type) go through the global allocator
+		if (size != sizeof(T))
+		{
+			memstats::allocated(memstats::Category::MapObjects, size);
+			return ::operator new(size);
+		}
+
+		auto&           pool = instance();
+		std::lock_guard lock(pool.mutex_);
+		++pool.live_;
+
+		// Reuse a freed slot if possible
+		if (auto slot = pool.free_)
+		{
+			pool.free_ = slot->next;
+			return slot;
+		}
+
+		// Otherwise take the next slot in the current slab, adding a new one if
+		// needed
+		if (pool.slabs_.empty() || pool.used_ == SLAB_SIZE)
+		{
+			pool.slabs_.emplace_back(new Slot[SLAB_SIZE]);
+			pool.used_ = 0;
+			memstats::allocated(memstats::Category::MapObjects, sizeof(Slot) * SLAB_SIZE);
+		}
+
+		return &pool.slabs_.back()[pool.used_++];
+	}
+
+	static void release(void* ptr, size_t size)
+	{
+		if (!ptr)
+			return;
+
+		if (size != sizeof(T))
+		{
+			memstats::freed(memstats::Category::MapObjects, size);
+			::operator delete(ptr);
+			return;
+		}
+
+		auto&           pool = instance();
+		std::lock_guard lock(pool.mutex_);
+
+		// Release everything once there are no objects left
+		if (--pool.live_ == 0)
+		{
+			memstats::freed(memstats::Category::MapObjects, sizeof(Slot) * SLAB_SIZE * pool.slabs_.size());
+			pool.slabs_.clear();
+			pool.free_ = nullptr;
+			pool.used_ = 0;
+			return;
+		}
+
+		auto slot  = static_cast<Slot*>(ptr);
+		slot->next = pool.free_;
+		pool.free_ = slot;
+	}
+
+private:
+	union Slot
+	{
+		Slot* next;
+		alignas(T) unsigned char data[sizeof(T)];
+	};
+
+	vector<unique_ptr<Slot[]>> slabs_;
+	Slot*                      free_ = nullptr;
+	unsigned                   used_ = 0;
+	size_t                     live_ = 0;
+	std::mutex                 mutex_;
+
+	// The pool is intentionally never destroyed, so objects can safely be freed
+	// during static destruction
+	static MapObjectPool& instance()
+	{
+		static auto pool = new MapObjectPool;
+		return *pool;
+	}
+};
+} // namespace slade
@@ -47,6 +47,22 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Allocates memory for a MapSector from its pool (see MapObjectPool)
+// -----------------------------------------------------------------------------
+void* MapSector::operator new(size_t size)
+{
+	return MapObjectPool<MapSector>::allocate(size);
+}
+
+// -----------------------------------------------------------------------------
+// Frees memory for a MapSector back to its pool
+// -----------------------------------------------------------------------------
+void MapSector::operator delete(void* ptr, size_t size)
+{
+	MapObjectPool<MapSector>::release(ptr, size);
+}
+
 // -----------------------------------------------------------------------------
 // MapSector class constructor
 // -----------------------------------------------------------------------------
@@ -71,34 +87,31 @@ MapSector::MapSector(
 // -----------------------------------------------------------------------------
 // MapSector class constructor from UDMF definition
 // -----------------------------------------------------------------------------
-MapSector::MapSector(string_view f_tex, string_view c_tex, const ParseTreeNode* udmf_def) :
+MapSector::MapSector(string_view f_tex, string_view c_tex, const UDMFFields& udmf_fields) :
 	MapObject(Type::Sector), floor_{ f_tex }, ceiling_{ c_tex }
 {
 	// Set UDMF defaults
 	light_ = 160;
 
 	// Set properties from UDMF definition
-	ParseTreeNode* prop;
-	for (unsigned a = 0; a < udmf_def->nChildren(); a++)
+	for (const auto& field : udmf_fields)
 	{
-		prop = udmf_def->childPTN(a);
-
 		// Skip required properties
-		if (prop->nameIsCI(PROP_TEXFLOOR) || prop->nameIsCI(PROP_TEXCEILING))
+		if (field.name == PROP_TEXFLOOR || field.name == PROP_TEXCEILING)
 			continue;
 
-		if (prop->nameIsCI(PROP_HEIGHTFLOOR))
-			setFloorHeight(prop->intValue());
-		else if (prop->nameIsCI(PROP_HEIGHTCEILING))
-			setCeilingHeight(prop->intValue());
-		else if (prop->nameIsCI(PROP_LIGHTLEVEL))
-			light_ = prop->intValue();
-		else if (prop->nameIsCI(PROP_SPECIAL))
-			special_ = prop->intValue();
-		else if (prop->nameIsCI(PROP_ID))
-			id_ = prop->intValue();
+		if (field.name == PROP_HEIGHTFLOOR)
+			setFloorHeight(property::asInt(field.value));
+		else if (field.name == PROP_HEIGHTCEILING)
+			setCeilingHeight(property::asInt(field.value));
+		else if (field.name == PROP_LIGHTLEVEL)
+			light_ = property::asInt(field.value);
+		else if (field.name == PROP_SPECIAL)
+			special_ = property::asInt(field.value);
+		else if (field.name == PROP_ID)
+			id_ = property::asInt(field.value);
 		else
-			properties_[prop->name()] = prop->value();
+			properties_[field.name] = field.value;
 	}
 }
 
@@ -117,27 +130,28 @@ void MapSector::copy(MapObject* obj)
 	// Update texture counts (decrement previous)
 	if (parent_map_)
 	{
-		parent_map_->sectors().updateTexUsage(floor_.texture, -1);
-		parent_map_->sectors().updateTexUsage(ceiling_.texture, -1);
+		parent_map_->sectors().updateTexUsage(floor_.texture_key, -1);
+		parent_map_->sectors().updateTexUsage(ceiling_.texture_key, -1);
 	}
 
 	// Basic variables
-	auto sector      = dynamic_cast<MapSector*>(obj);
-	floor_.texture   = sector->floor_.texture;
-	ceiling_.texture = sector->ceiling_.texture;
-	floor_.height    = sector->floor_.height;
-	ceiling_.height  = sector->ceiling_.height;
-	light_           = sector->light_;
-	special_         = sector->special_;
-	id_              = sector->id_;
+	auto sector = dynamic_cast<MapSector*>(obj);
+	floor_.setTexture(sector->floor_.texture);
+	ceiling_.setTexture(sector->ceiling_.texture);
+	floor_.height   = sector->floor_.height;
+	ceiling_.height = sector->ceiling_.height;
+	light_          = sector->light_;
+	special_        = sector->special_;
+	id_             = sector->id_;
+	updateIdIndex();
 	floor_.plane.set(0, 0, 1, sector->floor_.height);
 	ceiling_.plane.set(0, 0, 1, sector->ceiling_.height);
 
 	// Update texture counts (increment new)
 	if (parent_map_)
 	{
-		parent_map_->sectors().updateTexUsage(floor_.texture, 1);
-		parent_map_->sectors().updateTexUsage(ceiling_.texture, 1);
+		parent_map_->sectors().updateTexUsage(floor_.texture_key, 1);
+		parent_map_->sectors().updateTexUsage(ceiling_.texture_key, 1);
 	}
 
 	// Other properties
@@ -236,7 +250,10 @@ void MapSector::setIntProperty(string_view key, int value)
 	else if (key == PROP_SPECIAL)
 		special_ = value;
 	else if (key == PROP_ID)
+	{
 		id_ = value;
+		updateIdIndex();
+	}
 	else
 		MapObject::setIntProperty(key, value);
 }
@@ -248,10 +265,10 @@ void MapSector::setFloorTexture(string_view tex)
 {
 	setModified();
 	if (parent_map_)
-		parent_map_->sectors().updateTexUsage(floor_.texture, -1);
-	floor_.texture = tex;
+		parent_map_->sectors().updateTexUsage(floor_.texture_key, -1);
+	floor_.setTexture(tex);
 	if (parent_map_)
-		parent_map_->sectors().updateTexUsage(floor_.texture, 1);
+		parent_map_->sectors().updateTexUsage(floor_.texture_key, 1);
 }
 
 // -----------------------------------------------------------------------------
@@ -261,10 +278,10 @@ void MapSector::setCeilingTexture(string_view tex)
 {
 	setModified();
 	if (parent_map_)
-		parent_map_->sectors().updateTexUsage(ceiling_.texture, -1);
-	ceiling_.texture = tex;
+		parent_map_->sectors().updateTexUsage(ceiling_.texture_key, -1);
+	ceiling_.setTexture(tex);
 	if (parent_map_)
-		parent_map_->sectors().updateTexUsage(ceiling_.texture, 1);
+		parent_map_->sectors().updateTexUsage(ceiling_.texture_key, 1);
 }
 
 // -----------------------------------------------------------------------------
@@ -332,6 +349,7 @@ void MapSector::setTag(int tag)
 {
 	setModified();
 	id_ = tag;
+	updateIdIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -373,6 +391,20 @@ void MapSector::updateBBox()
 
 	text_point_.set(0, 0);
 	setGeometryUpdated();
+
+	if (parent_map_)
+		parent_map_->sectors().bboxUpdated(this);
+}
+
+// -----------------------------------------------------------------------------
+// Resets the sector bounding box, it will be recalculated next time it's needed
+// -----------------------------------------------------------------------------
+void MapSector::resetBBox()
+{
+	bbox_.reset();
+
+	if (parent_map_)
+		parent_map_->sectors().bboxUpdated(this);
 }
 
 // -----------------------------------------------------------------------------
@@ -852,7 +884,7 @@ void MapSector::connectSide(MapSide* side)
 	setModified();
 	connected_sides_.push_back(side);
 	poly_needsupdate_ = true;
-	bbox_.reset();
+	resetBBox();
 	setGeometryUpdated();
 }
 
@@ -872,7 +904,7 @@ void MapSector::disconnectSide(const MapSide* side)
 	}
 
 	poly_needsupdate_ = true;
-	bbox_.reset();
+	resetBBox();
 	setGeometryUpdated();
 }
 
@@ -913,26 +945,27 @@ void MapSector::writeBackup(Backup* backup)
 void MapSector::readBackup(Backup* backup)
 {
 	// Update texture counts (decrement previous)
-	parent_map_->sectors().updateTexUsage(floor_.texture, -1);
-	parent_map_->sectors().updateTexUsage(ceiling_.texture, -1);
+	parent_map_->sectors().updateTexUsage(floor_.texture_key, -1);
+	parent_map_->sectors().updateTexUsage(ceiling_.texture_key, -1);
 
-	floor_.texture   = backup->props_internal.get<string>(PROP_TEXFLOOR);
-	ceiling_.texture = backup->props_internal.get<string>(PROP_TEXCEILING);
-	floor_.height    = backup->props_internal.get<int>(PROP_HEIGHTFLOOR);
-	ceiling_.height  = backup->props_internal.get<int>(PROP_HEIGHTCEILING);
+	floor_.setTexture(backup->props_internal.get<string>(PROP_TEXFLOOR));
+	ceiling_.setTexture(backup->props_internal.get<string>(PROP_TEXCEILING));
+	floor_.height   = backup->props_internal.get<int>(PROP_HEIGHTFLOOR);
+	ceiling_.height = backup->props_internal.get<int>(PROP_HEIGHTCEILING);
 	floor_.plane.set(0, 0, 1, floor_.height);
 	ceiling_.plane.set(0, 0, 1, ceiling_.height);
 	light_   = backup->props_internal.get<int>(PROP_LIGHTLEVEL);
 	special_ = backup->props_internal.get<int>(PROP_SPECIAL);
 	id_      = backup->props_internal.get<int>(PROP_ID);
+	updateIdIndex();
 
 	// Update texture counts (increment new)
-	parent_map_->sectors().updateTexUsage(floor_.texture, 1);
-	parent_map_->sectors().updateTexUsage(ceiling_.texture, 1);
+	parent_map_->sectors().updateTexUsage(floor_.texture_key, 1);
+	parent_map_->sectors().updateTexUsage(ceiling_.texture_key, 1);
 
 	// Update geometry info
 	poly_needsupdate_ = true;
-	bbox_.reset();
+	resetBBox();
 	setGeometryUpdated();
 }
 
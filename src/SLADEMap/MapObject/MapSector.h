@@ -2,6 +2,7 @@
 
 #include "MapObject.h"
 #include "Utility/Colour.h"
+#include "Utility/NameKey.h"
 #include "Utility/Polygon2D.h"
 
 namespace slade
@@ -20,14 +21,21 @@ public:
 
 	struct Surface
 	{
-		string texture;
-		int    height = 0;
-		Plane  plane  = { 0., 0., 1., 0. };
+		string  texture;
+		NameKey texture_key; // Key of [texture], for fast comparisons and usage counts
+		int     height = 0;
+		Plane   plane  = { 0., 0., 1., 0. };
 
 		Surface(string_view texture = "", int height = 0, const Plane& plane = { 0., 0., 1., 0. }) :
-			texture{ texture }, height{ height }, plane{ plane }
+			texture{ texture }, texture_key{ texture }, height{ height }, plane{ plane }
 		{
 		}
+
+		void setTexture(string_view tex)
+		{
+			texture     = tex;
+			texture_key = NameKey{ tex };
+		}
 	};
 
 	struct ExtraFloor
@@ -87,9 +95,13 @@ public:
 		short       light    = 0,
 		short       special  = 0,
 		short       id       = 0);
-	MapSector(string_view f_tex, string_view c_tex, const ParseTreeNode* udmf_def);
+	MapSector(string_view f_tex, string_view c_tex, const UDMFFields& udmf_fields);
 	~MapSector() override = default;
 
+	// Allocated from a pool (see MapObjectPool)
+	static void* operator new(size_t size);
+	static void  operator delete(void* ptr, size_t size);
+
 	void copy(MapObject* obj) override;
 
 	const Surface& floor() const { return floor_; }
@@ -121,7 +133,7 @@ public:
 	template<SurfaceType p> void  setPlane(const Plane& plane);
 
 	Vec2d             getPoint(Point point) override;
-	void              resetBBox() { bbox_.reset(); }
+	void              resetBBox();
 	BBox              boundingBox();
 	vector<MapSide*>& connectedSides() { return connected_sides_; }
 	void              resetPolygon() { poly_needsupdate_ = true; }
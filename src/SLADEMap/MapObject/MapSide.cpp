@@ -46,6 +46,22 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Allocates memory for a MapSide from its pool (see MapObjectPool)
+// -----------------------------------------------------------------------------
+void* MapSide::operator new(size_t size)
+{
+	return MapObjectPool<MapSide>::allocate(size);
+}
+
+// -----------------------------------------------------------------------------
+// Frees memory for a MapSide back to its pool
+// -----------------------------------------------------------------------------
+void MapSide::operator delete(void* ptr, size_t size)
+{
+	MapObjectPool<MapSide>::release(ptr, size);
+}
+
 // -----------------------------------------------------------------------------
 // MapSide class constructor
 // -----------------------------------------------------------------------------
@@ -60,7 +76,10 @@ MapSide::MapSide(
 	tex_upper_{ tex_upper },
 	tex_middle_{ tex_middle },
 	tex_lower_{ tex_lower },
-	tex_offset_{ tex_offset }
+	tex_offset_{ tex_offset },
+	tex_upper_key_{ tex_upper },
+	tex_middle_key_{ tex_middle },
+	tex_lower_key_{ tex_lower }
 {
 	if (sector)
 		sector->connectSide(this);
@@ -69,35 +88,39 @@ MapSide::MapSide(
 // -----------------------------------------------------------------------------
 // MapSide class constructor from UDMF definition
 // -----------------------------------------------------------------------------
-MapSide::MapSide(MapSector* sector, ParseTreeNode* udmf_def) : MapObject{ Type::Side }, sector_{ sector }
+MapSide::MapSide(MapSector* sector, const UDMFFields& udmf_fields) : MapObject{ Type::Side }, sector_{ sector }
 {
 	if (sector)
 		sector->connectSide(this);
 
 	// Set properties from UDMF definition
-	ParseTreeNode* prop;
-	for (unsigned a = 0; a < udmf_def->nChildren(); a++)
+	for (const auto& field : udmf_fields)
 	{
-		prop = udmf_def->childPTN(a);
-
 		// Skip required properties
-		if (prop->nameIsCI(PROP_SECTOR))
+		if (field.name == PROP_SECTOR)
 			continue;
 
-		if (prop->nameIsCI(PROP_TEXUPPER))
-			tex_upper_ = prop->stringValue();
-		else if (prop->nameIsCI(PROP_TEXMIDDLE))
-			tex_middle_ = prop->stringValue();
-		else if (prop->nameIsCI(PROP_TEXLOWER))
-			tex_lower_ = prop->stringValue();
-		else if (prop->nameIsCI(PROP_OFFSETX))
-			tex_offset_.x = prop->intValue();
-		else if (prop->nameIsCI(PROP_OFFSETY))
-			tex_offset_.y = prop->intValue();
+		if (field.name == PROP_TEXUPPER)
+		{
+			tex_upper_     = property::asString(field.value);
+			tex_upper_key_ = NameKey{ tex_upper_ };
+		}
+		else if (field.name == PROP_TEXMIDDLE)
+		{
+			tex_middle_     = property::asString(field.value);
+			tex_middle_key_ = NameKey{ tex_middle_ };
+		}
+		else if (field.name == PROP_TEXLOWER)
+		{
+			tex_lower_     = property::asString(field.value);
+			tex_lower_key_ = NameKey{ tex_lower_ };
+		}
+		else if (field.name == PROP_OFFSETX)
+			tex_offset_.x = property::asInt(field.value);
+		else if (field.name == PROP_OFFSETY)
+			tex_offset_.y = property::asInt(field.value);
 		else
-			properties_[prop->name()] = prop->value();
-		// log::info(1, "Property %s type %s (%s)", prop->getName(), prop->getValue().typeString(),
-		// prop->getValue().getStringValue());
+			properties_[field.name] = field.value;
 	}
 }
 
@@ -178,13 +201,15 @@ void MapSide::setTexUpper(string_view tex, bool modify)
 	if (modify)
 		setModified();
 
+	NameKey key{ tex };
 	if (parent_map_)
 	{
-		parent_map_->sides().updateTexUsage(tex_upper_, -1);
-		parent_map_->sides().updateTexUsage(tex, 1);
+		parent_map_->sides().updateTexUsage(tex_upper_key_, -1);
+		parent_map_->sides().updateTexUsage(key, 1);
 	}
 
-	tex_upper_ = tex;
+	tex_upper_     = tex;
+	tex_upper_key_ = key;
 }
 
 // -----------------------------------------------------------------------------
@@ -195,13 +220,15 @@ void MapSide::setTexMiddle(string_view tex, bool modify)
 	if (modify)
 		setModified();
 
+	NameKey key{ tex };
 	if (parent_map_)
 	{
-		parent_map_->sides().updateTexUsage(tex_middle_, -1);
-		parent_map_->sides().updateTexUsage(tex, 1);
+		parent_map_->sides().updateTexUsage(tex_middle_key_, -1);
+		parent_map_->sides().updateTexUsage(key, 1);
 	}
 
-	tex_middle_ = tex;
+	tex_middle_     = tex;
+	tex_middle_key_ = key;
 }
 
 // -----------------------------------------------------------------------------
@@ -212,13 +239,15 @@ void MapSide::setTexLower(string_view tex, bool modify)
 	if (modify)
 		setModified();
 
+	NameKey key{ tex };
 	if (parent_map_)
 	{
-		parent_map_->sides().updateTexUsage(tex_lower_, -1);
-		parent_map_->sides().updateTexUsage(tex, 1);
+		parent_map_->sides().updateTexUsage(tex_lower_key_, -1);
+		parent_map_->sides().updateTexUsage(key, 1);
 	}
 
-	tex_lower_ = tex;
+	tex_lower_     = tex;
+	tex_lower_key_ = key;
 }
 
 // -----------------------------------------------------------------------------
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MapObject.h"
+#include "Utility/NameKey.h"
 
 namespace slade
 {
@@ -27,10 +28,14 @@ public:
 		string_view tex_middle = TEX_NONE,
 		string_view tex_lower  = TEX_NONE,
 		Vec2i       tex_offset = { 0, 0 });
-	MapSide(MapSector* sector, ParseTreeNode* udmf_def);
+	MapSide(MapSector* sector, const UDMFFields& udmf_fields);
 	MapSide(MapSector* sector, MapSide* copy_side);
 	~MapSide() = default;
 
+	// Allocated from a pool (see MapObjectPool)
+	static void* operator new(size_t size);
+	static void  operator delete(void* ptr, size_t size);
+
 	void copy(MapObject* c) override;
 
 	bool isOk() const { return !!sector_; }
@@ -40,6 +45,9 @@ public:
 	const string& texUpper() const { return tex_upper_; }
 	const string& texMiddle() const { return tex_middle_; }
 	const string& texLower() const { return tex_lower_; }
+	NameKey       texUpperKey() const { return tex_upper_key_; }
+	NameKey       texMiddleKey() const { return tex_middle_key_; }
+	NameKey       texLowerKey() const { return tex_lower_key_; }
 	short         texOffsetX() const { return tex_offset_.x; }
 	short         texOffsetY() const { return tex_offset_.y; }
 	Vec2i         texOffset() const { return tex_offset_; }
@@ -72,5 +80,10 @@ private:
 	string     tex_middle_ = "-";
 	string     tex_lower_  = "-";
 	Vec2i      tex_offset_ = { 0, 0 };
+
+	// Texture name keys (for fast comparisons and usage counts)
+	NameKey tex_upper_key_{ TEX_NONE };
+	NameKey tex_middle_key_{ TEX_NONE };
+	NameKey tex_lower_key_{ TEX_NONE };
 };
 } // namespace slade
@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapThing.h"
+#include "Game/Configuration.h"
 #include "Utility/Parser.h"
 
 using namespace slade;
@@ -43,6 +44,22 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Allocates memory for a MapThing from its pool (see MapObjectPool)
+// -----------------------------------------------------------------------------
+void* MapThing::operator new(size_t size)
+{
+	return MapObjectPool<MapThing>::allocate(size);
+}
+
+// -----------------------------------------------------------------------------
+// Frees memory for a MapThing back to its pool
+// -----------------------------------------------------------------------------
+void MapThing::operator delete(void* ptr, size_t size)
+{
+	MapObjectPool<MapThing>::release(ptr, size);
+}
+
 // -----------------------------------------------------------------------------
 // MapThing class constructor
 // -----------------------------------------------------------------------------
@@ -62,45 +79,42 @@ MapThing::MapThing(const Vec3d& pos, short type, short angle, short flags, const
 // -----------------------------------------------------------------------------
 // MapThing class constructor from UDMF definition
 // -----------------------------------------------------------------------------
-MapThing::MapThing(const Vec3d& pos, short type, ParseTreeNode* def) :
+MapThing::MapThing(const Vec3d& pos, short type, const UDMFFields& udmf_fields) :
 	MapObject(Type::Thing),
 	type_{ type },
 	position_{ pos.x, pos.y },
 	z_{ pos.z }
 {
 	// Set properties from UDMF definition
-	ParseTreeNode* prop;
-	for (unsigned a = 0; a < def->nChildren(); a++)
+	for (const auto& field : udmf_fields)
 	{
-		prop = def->childPTN(a);
-
 		// Skip required properties
-		if (prop->name() == PROP_X || prop->name() == PROP_Y || prop->name() == PROP_TYPE)
+		if (field.name == PROP_X || field.name == PROP_Y || field.name == PROP_TYPE)
 			continue;
 
 		// Builtin properties
-		if (prop->name() == PROP_Z)
-			z_ = prop->floatValue();
-		else if (prop->name() == PROP_ANGLE)
-			angle_ = prop->intValue();
-		else if (prop->name() == PROP_FLAGS)
-			flags_ = prop->intValue();
-		else if (prop->name() == PROP_ARG0)
-			args_[0] = prop->intValue();
-		else if (prop->name() == PROP_ARG1)
-			args_[1] = prop->intValue();
-		else if (prop->name() == PROP_ARG2)
-			args_[2] = prop->intValue();
-		else if (prop->name() == PROP_ARG3)
-			args_[3] = prop->intValue();
-		else if (prop->name() == PROP_ARG4)
-			args_[4] = prop->intValue();
-		else if (prop->name() == PROP_ID)
-			id_ = prop->intValue();
-		else if (prop->name() == PROP_SPECIAL)
-			special_ = prop->intValue();
+		if (field.name == PROP_Z)
+			z_ = property::asFloat(field.value);
+		else if (field.name == PROP_ANGLE)
+			angle_ = property::asInt(field.value);
+		else if (field.name == PROP_FLAGS)
+			flags_ = property::asInt(field.value);
+		else if (field.name == PROP_ARG0)
+			args_[0] = property::asInt(field.value);
+		else if (field.name == PROP_ARG1)
+			args_[1] = property::asInt(field.value);
+		else if (field.name == PROP_ARG2)
+			args_[2] = property::asInt(field.value);
+		else if (field.name == PROP_ARG3)
+			args_[3] = property::asInt(field.value);
+		else if (field.name == PROP_ARG4)
+			args_[4] = property::asInt(field.value);
+		else if (field.name == PROP_ID)
+			id_ = property::asInt(field.value);
+		else if (field.name == PROP_SPECIAL)
+			special_ = property::asInt(field.value);
 		else
-			properties_[prop->name()] = prop->value();
+			properties_[field.name] = field.value;
 	}
 }
 
@@ -163,6 +177,24 @@ double MapThing::floatProperty(string_view key)
 	return MapObject::floatProperty(key);
 }
 
+// -----------------------------------------------------------------------------
+// Returns the game configuration's definition of the thing's type. This is
+// cached until the type or the configuration's thing types change, so it
+// should only be used on the main thread (use game::configuration().thingType
+// elsewhere)
+// -----------------------------------------------------------------------------
+const game::ThingType& MapThing::typeDef() const
+{
+	auto& config = game::configuration();
+	if (!type_def_ || type_def_version_ != config.thingTypesVersion())
+	{
+		type_def_         = &config.thingType(type_);
+		type_def_version_ = config.thingTypesVersion();
+	}
+
+	return *type_def_;
+}
+
 // -----------------------------------------------------------------------------
 // Sets the integer value of the property [key] to [value]
 // -----------------------------------------------------------------------------
@@ -172,11 +204,20 @@ void MapThing::setIntProperty(string_view key, int value)
 	setModified();
 
 	if (key == PROP_TYPE)
-		type_ = value;
+	{
+		type_     = value;
+		type_def_ = nullptr;
+	}
 	else if (key == PROP_X)
+	{
 		position_.x = value;
+		updateSpatialIndex();
+	}
 	else if (key == PROP_Y)
+	{
 		position_.y = value;
+		updateSpatialIndex();
+	}
 	else if (key == PROP_Z)
 		z_ = value;
 	else if (key == PROP_ANGLE)
@@ -199,6 +240,8 @@ void MapThing::setIntProperty(string_view key, int value)
 		special_ = value;
 	else
 		return MapObject::setIntProperty(key, value);
+
+	updateIdIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -210,9 +253,15 @@ void MapThing::setFloatProperty(string_view key, double value)
 	setModified();
 
 	if (key == PROP_X)
+	{
 		position_.x = value;
+		updateSpatialIndex();
+	}
 	else if (key == PROP_Y)
+	{
 		position_.y = value;
+		updateSpatialIndex();
+	}
 	else if (key == PROP_Z)
 		z_ = value;
 	else
@@ -235,13 +284,16 @@ void MapThing::copy(MapObject* c)
 	auto thing  = dynamic_cast<MapThing*>(c);
 	position_.x = thing->position_.x;
 	position_.y = thing->position_.y;
+	updateSpatialIndex();
 	type_       = thing->type_;
+	type_def_   = nullptr;
 	angle_      = thing->angle_;
 	flags_      = thing->flags_;
 	id_         = thing->id_;
 	special_    = thing->special_;
 	for (unsigned i = 0; i < 5; ++i)
 		args_[i] = thing->args_[i];
+	updateIdIndex();
 
 	// Other properties
 	MapObject::copy(c);
@@ -256,6 +308,7 @@ void MapThing::move(Vec2d pos, bool modify)
 	if (modify)
 		setModified();
 	position_ = pos;
+	updateSpatialIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -273,7 +326,8 @@ void MapThing::setZ(double z)
 void MapThing::setType(int type)
 {
 	setModified();
-	type_ = type;
+	type_     = type;
+	type_def_ = nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -331,6 +385,7 @@ void MapThing::setId(int id)
 {
 	setModified();
 	id_ = id;
+	updateIdIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -369,6 +424,7 @@ void MapThing::setArg(unsigned index, int value)
 	{
 		setModified();
 		args_[index] = value;
+		updateIdIndex();
 	}
 }
 
@@ -407,8 +463,10 @@ void MapThing::writeBackup(Backup* backup)
 void MapThing::readBackup(Backup* backup)
 {
 	type_       = backup->props_internal.get<int>(PROP_TYPE);
+	type_def_   = nullptr;
 	position_.x = backup->props_internal.get<double>(PROP_X);
 	position_.y = backup->props_internal.get<double>(PROP_Y);
+	updateSpatialIndex();
 	z_          = backup->props_internal.get<double>(PROP_Z);
 	angle_      = backup->props_internal.get<int>(PROP_ANGLE);
 	flags_      = backup->props_internal.get<int>(PROP_FLAGS);
@@ -419,6 +477,7 @@ void MapThing::readBackup(Backup* backup)
 	args_[4]    = backup->props_internal.get<int>(PROP_ARG4);
 	id_         = backup->props_internal.get<int>(PROP_ID);
 	special_    = backup->props_internal.get<int>(PROP_SPECIAL);
+	updateIdIndex();
 }
 
 // -----------------------------------------------------------------------------
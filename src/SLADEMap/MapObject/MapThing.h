@@ -4,6 +4,11 @@
 
 namespace slade
 {
+namespace game
+{
+	class ThingType;
+}
+
 class MapThing : public MapObject
 {
 	friend class SLADEMap;
@@ -32,9 +37,13 @@ public:
 		const ArgSet& args    = {},
 		int           id      = 0,
 		int           special = 0);
-	MapThing(const Vec3d& pos, short type, ParseTreeNode* def);
+	MapThing(const Vec3d& pos, short type, const UDMFFields& udmf_fields);
 	~MapThing() = default;
 
+	// Allocated from a pool (see MapObjectPool)
+	static void* operator new(size_t size);
+	static void  operator delete(void* ptr, size_t size);
+
 	double        xPos() const { return position_.x; }
 	double        yPos() const { return position_.y; }
 	double        zPos() const { return z_; }
@@ -49,6 +58,8 @@ public:
 	int           id() const { return id_; }
 	int           special() const { return special_; }
 
+	const game::ThingType& typeDef() const;
+
 	Vec2d getPoint(Point point) override;
 
 	int    intProperty(string_view key) override;
@@ -93,5 +104,9 @@ private:
 	ArgSet args_    = {};
 	int    id_      = 0;
 	int    special_ = 0;
+
+	// Cached type definition (see typeDef)
+	mutable const game::ThingType* type_def_         = nullptr;
+	mutable unsigned               type_def_version_ = 0;
 };
 } // namespace slade
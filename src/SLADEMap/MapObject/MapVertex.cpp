@@ -44,6 +44,22 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Allocates memory for a MapVertex from its pool (see MapObjectPool)
+// -----------------------------------------------------------------------------
+void* MapVertex::operator new(size_t size)
+{
+	return MapObjectPool<MapVertex>::allocate(size);
+}
+
+// -----------------------------------------------------------------------------
+// Frees memory for a MapVertex back to its pool
+// -----------------------------------------------------------------------------
+void MapVertex::operator delete(void* ptr, size_t size)
+{
+	MapObjectPool<MapVertex>::release(ptr, size);
+}
+
 // -----------------------------------------------------------------------------
 // MapVertex class constructor
 // -----------------------------------------------------------------------------
@@ -52,19 +68,16 @@ MapVertex::MapVertex(const Vec2d& pos) : MapObject(Type::Vertex), position_{ pos
 // -----------------------------------------------------------------------------
 // MapVertex class constructor from UDMF definition
 // -----------------------------------------------------------------------------
-MapVertex::MapVertex(const Vec2d& pos, ParseTreeNode* udmf_def) : MapObject(Type::Vertex), position_{ pos }
+MapVertex::MapVertex(const Vec2d& pos, const UDMFFields& udmf_fields) : MapObject(Type::Vertex), position_{ pos }
 {
 	// Set properties from UDMF definition
-	ParseTreeNode* prop;
-	for (unsigned a = 0; a < udmf_def->nChildren(); a++)
+	for (const auto& field : udmf_fields)
 	{
-		prop = udmf_def->childPTN(a);
-
 		// Skip required properties
-		if (prop->name() == PROP_X || prop->name() == PROP_Y)
+		if (field.name == PROP_X || field.name == PROP_Y)
 			continue;
 
-		properties_[prop->name()] = prop->value();
+		properties_[field.name] = field.value;
 	}
 }
 
@@ -86,6 +99,7 @@ void MapVertex::move(double nx, double ny)
 	setModified();
 	position_.x = nx;
 	position_.y = ny;
+	updateSpatialIndex();
 
 	// Reset all attached lines' geometry info
 	for (auto& connected_line : connected_lines_)
@@ -131,12 +145,14 @@ void MapVertex::setIntProperty(string_view key, int value)
 	if (key == PROP_X)
 	{
 		position_.x = value;
+		updateSpatialIndex();
 		for (auto& connected_line : connected_lines_)
 			connected_line->resetInternals();
 	}
 	else if (key == PROP_Y)
 	{
 		position_.y = value;
+		updateSpatialIndex();
 		for (auto& connected_line : connected_lines_)
 			connected_line->resetInternals();
 	}
@@ -158,6 +174,8 @@ void MapVertex::setFloatProperty(string_view key, double value)
 		position_.y = value;
 	else
 		return MapObject::setFloatProperty(key, value);
+
+	updateSpatialIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -223,6 +241,7 @@ void MapVertex::readBackup(Backup* backup)
 	// Position
 	position_.x = backup->props_internal.get<double>(PROP_X);
 	position_.y = backup->props_internal.get<double>(PROP_Y);
+	updateSpatialIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -0,0 +1,309 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MobjPropertyList.cpp
+// Description: MobjPropertyList class - a compact list of properties for map
+//              objects, with globally interned property names
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MobjPropertyList.h"
+#include <atomic>
+#include <mutex>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Interned names are stored in fixed-size chunks so they never move once added,
+// and can be read without locking
+constexpr unsigned NAME_CHUNK_SIZE = 1024;
+constexpr unsigned MAX_NAME_CHUNKS = 1024;
+constexpr unsigned MIN_TABLE_SLOTS = 1024;
+std::atomic<string*> name_chunks[MAX_NAME_CHUNKS];
+unsigned             name_count = 0;
+
+// Open-addressing hash table of name -> id (slot value is id + 1, 0 if empty).
+// When it gets too full a bigger table is built and published, and the old one
+// is kept around (never freed) since other threads may still be reading it
+struct NameTable
+{
+	unsigned                                 size;
+	std::unique_ptr<std::atomic<uint32_t>[]> slots;
+
+	NameTable(unsigned size) : size{ size }, slots{ new std::atomic<uint32_t>[size]() } {}
+};
+vector<std::unique_ptr<NameTable>> name_tables;
+std::atomic<NameTable*>            name_table{ nullptr };
+std::mutex                         intern_mutex;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns a case-insensitive hash of [name]
+// -----------------------------------------------------------------------------
+uint32_t nameHash(string_view name)
+{
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+	for (auto c : name)
+	{
+		hash ^= static_cast<uint8_t>(tolower(static_cast<uint8_t>(c)));
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the interned name for [id]
+// -----------------------------------------------------------------------------
+const string& internedName(MobjPropertyList::Id id)
+{
+	return name_chunks[id / NAME_CHUNK_SIZE].load(std::memory_order_acquire)[id % NAME_CHUNK_SIZE];
+}
+
+// -----------------------------------------------------------------------------
+// Adds [id] to the hash [table]
+// -----------------------------------------------------------------------------
+void insertId(NameTable& table, MobjPropertyList::Id id)
+{
+	auto mask = table.size - 1;
+	auto slot = nameHash(internedName(id)) & mask;
+	while (table.slots[slot].load(std::memory_order_relaxed) != 0)
+		slot = (slot + 1) & mask;
+
+	table.slots[slot].store(id + 1, std::memory_order_release);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MobjPropertyList Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the property with [prop_id], adding it (with no value) if it doesn't
+// exist
+// -----------------------------------------------------------------------------
+Property& MobjPropertyList::operator[](Id prop_id)
+{
+	auto i = std::lower_bound(
+		properties_.begin(), properties_.end(), prop_id, [](const Entry& e, Id id) { return e.id < id; });
+
+	if (i == properties_.end() || i->id != prop_id)
+		i = properties_.insert(i, { prop_id, Property{} });
+
+	return i->value;
+}
+
+// -----------------------------------------------------------------------------
+// Adds all property values to [list]
+// -----------------------------------------------------------------------------
+void MobjPropertyList::allProperties(vector<Property>& list) const
+{
+	for (const auto& prop : properties_)
+		list.push_back(prop.value);
+}
+
+// -----------------------------------------------------------------------------
+// Adds all property names to [list]
+// -----------------------------------------------------------------------------
+void MobjPropertyList::allPropertyNames(vector<string>& list) const
+{
+	for (const auto& prop : properties_)
+		list.push_back(prop.name());
+}
+
+// -----------------------------------------------------------------------------
+// Removes the property [key] from the list.
+// Returns false if the property didn't exist
+// -----------------------------------------------------------------------------
+bool MobjPropertyList::remove(string_view key)
+{
+	auto prop_id = findId(key);
+	if (!prop_id)
+		return false;
+
+	return remove(*prop_id);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the property with id [prop_id] from the list.
+// Returns false if the property didn't exist
+// -----------------------------------------------------------------------------
+bool MobjPropertyList::remove(Id prop_id)
+{
+	auto i = std::lower_bound(
+		properties_.begin(), properties_.end(), prop_id, [](const Entry& e, Id id) { return e.id < id; });
+
+	if (i == properties_.end() || i->id != prop_id)
+		return false;
+
+	properties_.erase(i);
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a string representation of the property list
+// -----------------------------------------------------------------------------
+string MobjPropertyList::toString(bool condensed, int float_precision) const
+{
+	// Init return string
+	string ret;
+
+	// Go through all properties
+	for (const auto& prop : properties_)
+	{
+		// Add "key = value;\n" to the return string
+		auto val = property::asString(prop.value, float_precision);
+
+		if (property::valueType(prop.value) == property::ValueType::String)
+		{
+			val = strutil::escapedString(val, false, true);
+			val.insert(val.begin(), '\"');
+			val.push_back('\"');
+		}
+
+		if (condensed)
+			ret += fmt::format("{}={};\n", prop.name(), val);
+		else
+			ret += fmt::format("{} = {};\n", prop.name(), val);
+	}
+
+	return ret;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the interned id for property [name], adding it if it doesn't exist
+// -----------------------------------------------------------------------------
+MobjPropertyList::Id MobjPropertyList::id(string_view name)
+{
+	if (auto existing = findId(name))
+		return *existing;
+
+	std::lock_guard lock(intern_mutex);
+
+	// Check again in case another thread added it first
+	if (auto existing = findId(name))
+		return *existing;
+
+	// Add name
+	auto new_id = name_count;
+	auto chunk  = new_id / NAME_CHUNK_SIZE;
+	if (chunk >= MAX_NAME_CHUNKS)
+	{
+		// Out of space (would need over a million different property names),
+		// just give the last one
+		log::error("Too many map object property names, can't add \"{}\"", name);
+		return new_id - 1;
+	}
+	if (!name_chunks[chunk].load(std::memory_order_relaxed))
+		name_chunks[chunk].store(new string[NAME_CHUNK_SIZE], std::memory_order_release);
+	name_chunks[chunk].load(std::memory_order_relaxed)[new_id % NAME_CHUNK_SIZE] = name;
+	++name_count;
+
+	// Grow the hash table if it would be more than half full
+	auto table = name_table.load(std::memory_order_relaxed);
+	if (!table || name_count * 2 > table->size)
+	{
+		auto new_table = std::make_unique<NameTable>(table ? table->size * 2 : MIN_TABLE_SLOTS);
+		for (Id a = 0; a < new_id; ++a)
+			insertId(*new_table, a);
+
+		table = new_table.get();
+		name_tables.push_back(std::move(new_table));
+		name_table.store(table, std::memory_order_release);
+	}
+
+	insertId(*table, new_id);
+
+	return new_id;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the interned id for property [name], or nothing if no property has
+// been added with that name
+// -----------------------------------------------------------------------------
+std::optional<MobjPropertyList::Id> MobjPropertyList::findId(string_view name)
+{
+	auto table = name_table.load(std::memory_order_acquire);
+	if (!table)
+		return {};
+
+	auto mask = table->size - 1;
+	for (auto slot = nameHash(name) & mask;; slot = (slot + 1) & mask)
+	{
+		auto value = table->slots[slot].load(std::memory_order_acquire);
+		if (value == 0)
+			return {};
+
+		if (strutil::equalCI(internedName(value - 1), name))
+			return value - 1;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the name of the property with [id]
+// -----------------------------------------------------------------------------
+const string& MobjPropertyList::name(Id id)
+{
+	return internedName(id);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the property [key], or null if it doesn't exist
+// -----------------------------------------------------------------------------
+const Property* MobjPropertyList::find(string_view key) const
+{
+	if (properties_.empty())
+		return nullptr;
+
+	auto prop_id = findId(key);
+	if (!prop_id)
+		return nullptr;
+
+	auto i = std::lower_bound(
+		properties_.begin(), properties_.end(), *prop_id, [](const Entry& e, Id id) { return e.id < id; });
+
+	return i != properties_.end() && i->id == *prop_id ? &i->value : nullptr;
+}
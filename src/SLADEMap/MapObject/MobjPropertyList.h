@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Utility/Property.h"
+
+namespace slade
+{
+// A compact property list for map objects.
+//
+// Property names are interned globally (case-insensitively, keeping the first
+// spelling seen) as a MobjPropertyList::Id, and each list is just a vector of
+// id/value pairs sorted by id. Looking up a property is then a hash lookup of
+// the name followed by a binary search, rather than a case-insensitive string
+// comparison against every property in the list, and each property only costs
+// an id + value per object. Name lookups don't lock, so lists can be read from
+// multiple threads (eg. when writing UDMF) while names are being interned
+class MobjPropertyList
+{
+public:
+	typedef uint32_t Id;
+
+	struct Entry
+	{
+		Id       id;
+		Property value;
+
+		const string& name() const { return MobjPropertyList::name(id); }
+	};
+
+	const vector<Entry>& properties() const { return properties_; }
+
+	Property& operator[](string_view key) { return (*this)[id(key)]; }
+	Property& operator[](Id id);
+
+	bool empty() const { return properties_.empty(); }
+	bool contains(string_view key) const { return find(key) != nullptr; }
+
+	template<typename T> T get(string_view key) const
+	{
+		if (auto prop = find(key))
+			return std::get<T>(*prop);
+
+		return T{};
+	}
+
+	std::optional<Property> getIf(string_view key) const
+	{
+		if (auto prop = find(key))
+			return *prop;
+
+		return {};
+	}
+
+	template<typename T> std::optional<T> getIf(string_view key) const
+	{
+		if (auto prop = find(key))
+			return property::value<T>(*prop);
+
+		return {};
+	}
+
+	template<typename T> T getOr(string_view key, T default_val) const
+	{
+		if (auto prop = find(key))
+			return property::value<T>(*prop, default_val);
+
+		return default_val;
+	}
+
+	void allProperties(vector<Property>& list) const;
+	void allPropertyNames(vector<string>& list) const;
+
+	void clear() { properties_.clear(); }
+	bool remove(string_view key);
+	bool remove(Id prop_id);
+
+	string toString(bool condensed = false, int float_precision = 0) const;
+
+	// Interned property names
+	static Id                id(string_view name);
+	static std::optional<Id> findId(string_view name);
+	static const string&     name(Id id);
+
+private:
+	vector<Entry> properties_;
+
+	const Property* find(string_view key) const;
+};
+} // namespace slade
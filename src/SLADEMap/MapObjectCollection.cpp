@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapObjectCollection.h"
+#include "App.h"
 #include "Game/Configuration.h"
 #include "MapObject/MapLine.h"
 #include "MapObject/MapSector.h"
@@ -40,6 +41,110 @@
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// The modification journal is compacted once it has this many more records
+// than twice the number of objects
+constexpr size_t JOURNAL_COMPACT_MIN = 4096;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the order objects of [type] are listed in modified object lists
+// (vertices, sides, lines, sectors then things)
+// -----------------------------------------------------------------------------
+int typeOrder(MapObject::Type type)
+{
+	switch (type)
+	{
+	case MapObject::Type::Vertex: return 0;
+	case MapObject::Type::Side: return 1;
+	case MapObject::Type::Line: return 2;
+	case MapObject::Type::Sector: return 3;
+	case MapObject::Type::Thing: return 4;
+	default: return 5;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the distance along a Hilbert curve filling a 65536x65536 grid of the
+// point [x,y] (each in the range 0-65535)
+// -----------------------------------------------------------------------------
+uint64_t hilbertIndex(uint32_t x, uint32_t y)
+{
+	constexpr uint32_t n = 65536;
+
+	uint64_t d = 0;
+	for (uint32_t s = n / 2; s > 0; s /= 2)
+	{
+		uint32_t rx = (x & s) > 0 ? 1 : 0;
+		uint32_t ry = (y & s) > 0 ? 1 : 0;
+		d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+
+		// Rotate quadrant
+		if (ry == 0)
+		{
+			if (rx == 1)
+			{
+				x = n - 1 - x;
+				y = n - 1 - y;
+			}
+			std::swap(x, y);
+		}
+	}
+
+	return d;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the ids of [objects] to [list], sorted by Hilbert curve distance of
+// their position (from [get_pos]) within [bbox]. Objects at the same distance
+// keep their current order
+// -----------------------------------------------------------------------------
+template<class T, typename F>
+void putHilbertOrderIds(const MapObjectList<T>& objects, const BBox& bbox, F get_pos, vector<unsigned>& list)
+{
+	auto scale_x = bbox.width() > 0 ? 65535. / bbox.width() : 0.;
+	auto scale_y = bbox.height() > 0 ? 65535. / bbox.height() : 0.;
+
+	vector<std::pair<uint64_t, unsigned>> keys;
+	keys.reserve(objects.size());
+	for (const auto& object : objects)
+	{
+		Vec2d pos = get_pos(object);
+		auto  x   = static_cast<uint32_t>(std::clamp((pos.x - bbox.min.x) * scale_x, 0., 65535.));
+		auto  y   = static_cast<uint32_t>(std::clamp((pos.y - bbox.min.y) * scale_y, 0., 65535.));
+		keys.emplace_back(hilbertIndex(x, y), object->objId());
+	}
+
+	std::stable_sort(
+		keys.begin(), keys.end(), [](const auto& left, const auto& right) { return left.first < right.first; });
+
+	for (const auto& key : keys)
+		list.push_back(key.second);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MapObjectCollection Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
 // -----------------------------------------------------------------------------
 // MapObjectCollection class constructor
 // -----------------------------------------------------------------------------
@@ -57,6 +162,8 @@ void MapObjectCollection::addMapObject(unique_ptr<MapObject> object)
 	object->obj_id_     = objects_.size();
 	object->parent_map_ = parent_map_;
 	objects_.emplace_back(std::move(object), true);
+	objects_updated_ = app::runTimer();
+	recordModified(objects_.back().object.get());
 }
 
 // -----------------------------------------------------------------------------
@@ -66,6 +173,19 @@ void MapObjectCollection::addMapObject(unique_ptr<MapObject> object)
 void MapObjectCollection::removeMapObject(MapObject* object)
 {
 	objects_[object->obj_id_].in_map = false;
+	objects_updated_                 = app::runTimer();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the object with [id] if it is currently in the map, or nullptr if
+// it has been removed or [id] is invalid
+// -----------------------------------------------------------------------------
+MapObject* MapObjectCollection::mapObjectById(unsigned id) const
+{
+	if (id >= objects_.size() || !objects_[id].in_map)
+		return nullptr;
+
+	return objects_[id].object.get();
 }
 
 // -----------------------------------------------------------------------------
@@ -106,6 +226,8 @@ void MapObjectCollection::putObjectIdList(MapObject::Type type, vector<unsigned>
 // -----------------------------------------------------------------------------
 void MapObjectCollection::restoreObjectIdList(MapObject::Type type, vector<unsigned>& list)
 {
+	objects_updated_ = app::runTimer();
+
 	if (type == MapObject::Type::Vertex)
 	{
 		// Clear
@@ -209,6 +331,49 @@ void MapObjectCollection::refreshIndices()
 		things_[a]->index_ = a;
 }
 
+// -----------------------------------------------------------------------------
+// Reorders vertices and lines along a Hilbert curve through the map, so that
+// objects near each other in the map are also near each other in their lists.
+// Sides are reordered to follow their lines.
+// Sectors and things are left as they are, since their order determines the
+// order their specials and actors are spawned in-game
+// -----------------------------------------------------------------------------
+void MapObjectCollection::optimiseOrder()
+{
+	if (vertices_.empty())
+		return;
+
+	// Get vertex bounds
+	BBox bbox;
+	for (const auto& vertex : vertices_)
+		bbox.extend(vertex->xPos(), vertex->yPos());
+
+	// Vertices
+	vector<unsigned> ids;
+	putHilbertOrderIds(vertices_, bbox, [](MapVertex* vertex) { return vertex->position(); }, ids);
+	restoreObjectIdList(MapObject::Type::Vertex, ids);
+
+	// Lines (by midpoint)
+	ids.clear();
+	putHilbertOrderIds(lines_, bbox, [](MapLine* line) { return line->getPoint(MapObject::Point::Mid); }, ids);
+	restoreObjectIdList(MapObject::Type::Line, ids);
+
+	// Sides, in the order of their parent lines, then any sides without one
+	vector<bool> side_added(sides_.size(), false);
+	ids.clear();
+	for (const auto& line : lines_)
+		for (auto side : { line->s1(), line->s2() })
+			if (side && !side_added[side->index_])
+			{
+				side_added[side->index_] = true;
+				ids.push_back(side->obj_id_);
+			}
+	for (const auto& side : sides_)
+		if (!side_added[side->index_])
+			ids.push_back(side->obj_id_);
+	restoreObjectIdList(MapObject::Type::Side, ids);
+}
+
 // -----------------------------------------------------------------------------
 // Clears all objects
 // -----------------------------------------------------------------------------
@@ -223,9 +388,30 @@ void MapObjectCollection::clear()
 
 	// Clear map objects
 	objects_.clear();
+	modified_journal_.clear();
 
 	// Object id 0 is always null
 	objects_.emplace_back(nullptr, false);
+	objects_updated_ = app::runTimer();
+}
+
+// -----------------------------------------------------------------------------
+// Reserves space for [count] more objects of [type], to avoid reallocating the
+// object lists repeatedly when adding a lot of objects at once (eg. on load)
+// -----------------------------------------------------------------------------
+void MapObjectCollection::reserve(MapObject::Type type, unsigned count)
+{
+	objects_.reserve(objects_.size() + count);
+
+	switch (type)
+	{
+	case MapObject::Type::Vertex: vertices_.reserve(vertices_.size() + count); break;
+	case MapObject::Type::Line: lines_.reserve(lines_.size() + count); break;
+	case MapObject::Type::Side: sides_.reserve(sides_.size() + count); break;
+	case MapObject::Type::Sector: sectors_.reserve(sectors_.size() + count); break;
+	case MapObject::Type::Thing: things_.reserve(things_.size() + count); break;
+	default: break;
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -554,17 +740,24 @@ MapSide* MapObjectCollection::duplicateSide(MapSide* side)
 vector<MapObject*> MapObjectCollection::modifiedObjects(long since, MapObject::Type type) const
 {
 	vector<MapObject*> modified_objects;
-
-	if (type == MapObject::Type::Object || type == MapObject::Type::Vertex)
-		vertices_.putModifiedObjects(since, modified_objects);
-	if (type == MapObject::Type::Object || type == MapObject::Type::Side)
-		sides_.putModifiedObjects(since, modified_objects);
-	if (type == MapObject::Type::Object || type == MapObject::Type::Line)
-		lines_.putModifiedObjects(since, modified_objects);
-	if (type == MapObject::Type::Object || type == MapObject::Type::Sector)
-		sectors_.putModifiedObjects(since, modified_objects);
-	if (type == MapObject::Type::Object || type == MapObject::Type::Thing)
-		things_.putModifiedObjects(since, modified_objects);
+	putJournalObjects(since, modified_objects);
+
+	// Only include objects of [type] currently in the map
+	auto not_included = [this, type](const MapObject* object)
+	{ return !objects_[object->obj_id_].in_map || (type != MapObject::Type::Object && object->type_ != type); };
+	modified_objects.erase(
+		std::remove_if(modified_objects.begin(), modified_objects.end(), not_included), modified_objects.end());
+
+	// Sort in list order
+	std::sort(
+		modified_objects.begin(),
+		modified_objects.end(),
+		[](const MapObject* left, const MapObject* right)
+		{
+			if (left->type_ != right->type_)
+				return typeOrder(left->type_) < typeOrder(right->type_);
+			return left->index_ < right->index_;
+		});
 
 	return modified_objects;
 }
@@ -575,13 +768,7 @@ vector<MapObject*> MapObjectCollection::modifiedObjects(long since, MapObject::T
 vector<MapObject*> MapObjectCollection::allModifiedObjects(long since) const
 {
 	vector<MapObject*> modified_objects;
-
-	for (auto& holder : objects_)
-	{
-		if (holder.object && holder.object->modified_time_ >= since)
-			modified_objects.push_back(holder.object.get());
-	}
-
+	putJournalObjects(since, modified_objects);
 	return modified_objects;
 }
 
@@ -590,15 +777,8 @@ vector<MapObject*> MapObjectCollection::allModifiedObjects(long since) const
 // -----------------------------------------------------------------------------
 long MapObjectCollection::lastModifiedTime() const
 {
-	long mod_time = 0;
-
-	for (auto& holder : objects_)
-	{
-		if (holder.object && holder.object->modified_time_ > mod_time)
-			mod_time = holder.object->modified_time_;
-	}
-
-	return mod_time;
+	// Journal times only ever increase, so the last record is always the newest
+	return modified_journal_.empty() ? 0 : modified_journal_.back().time;
 }
 
 // -----------------------------------------------------------------------------
@@ -606,16 +786,17 @@ long MapObjectCollection::lastModifiedTime() const
 // -----------------------------------------------------------------------------
 bool MapObjectCollection::modifiedSince(long since, MapObject::Type type) const
 {
-	switch (type)
+	if (type == MapObject::Type::Object)
+		return lastModifiedTime() > since;
+
+	for (auto a = journalStart(since + 1); a < modified_journal_.size(); ++a)
 	{
-	case MapObject::Type::Object: return lastModifiedTime() > since;
-	case MapObject::Type::Vertex: return vertices_.modifiedSince(since);
-	case MapObject::Type::Line: return lines_.modifiedSince(since);
-	case MapObject::Type::Side: return sides_.modifiedSince(since);
-	case MapObject::Type::Sector: return sectors_.modifiedSince(since);
-	case MapObject::Type::Thing: return things_.modifiedSince(since);
-	default: return false;
+		auto& holder = objects_[modified_journal_[a].obj_id];
+		if (holder.in_map && holder.object->type_ == type && holder.object->modified_time_ > since)
+			return true;
 	}
+
+	return false;
 }
 
 // -----------------------------------------------------------------------------
@@ -753,3 +934,130 @@ void MapObjectCollection::rebuildConnectedSides()
 			side->sector()->connectSide(side);
 	}
 }
+
+// -----------------------------------------------------------------------------
+// Updates the position of [object] in the relevant list's spatial index, after
+// its position (or for lines, vertices) has changed. For vertices, all lines
+// connected to the vertex are updated too
+// -----------------------------------------------------------------------------
+void MapObjectCollection::updateSpatialIndex(MapObject* object)
+{
+	switch (object->objType())
+	{
+	case MapObject::Type::Vertex:
+	{
+		auto vertex = dynamic_cast<MapVertex*>(object);
+		vertices_.updateGrid(vertex);
+		for (auto line : vertex->connectedLines())
+			lines_.updateGrid(line);
+		break;
+	}
+	case MapObject::Type::Line: lines_.updateGrid(dynamic_cast<MapLine*>(object)); break;
+	case MapObject::Type::Thing: things_.updateGrid(dynamic_cast<MapThing*>(object)); break;
+	default: break;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Updates [object] in the relevant list's id indices, after its id/tag or args
+// have changed
+// -----------------------------------------------------------------------------
+void MapObjectCollection::updateIdIndex(MapObject* object)
+{
+	switch (object->objType())
+	{
+	case MapObject::Type::Line: lines_.updateIdIndex(dynamic_cast<MapLine*>(object)); break;
+	case MapObject::Type::Sector: sectors_.updateIdIndex(dynamic_cast<MapSector*>(object)); break;
+	case MapObject::Type::Thing: things_.updateIdIndex(dynamic_cast<MapThing*>(object)); break;
+	default: break;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Records that [object] has been modified in the modification journal, which
+// is used to find modified objects without having to check every object.
+// Called whenever an object in the map has its modified time updated
+// -----------------------------------------------------------------------------
+void MapObjectCollection::recordModified(const MapObject* object)
+{
+	if (object->obj_id_ == 0 || object->obj_id_ >= objects_.size())
+		return;
+
+	// Keep the journal in time order - an object added to the map can have an
+	// older modified time than the last record
+	auto time = object->modified_time_;
+	if (!modified_journal_.empty())
+	{
+		auto& last = modified_journal_.back();
+		if (last.obj_id == object->obj_id_ && last.time >= time)
+			return;
+
+		time = std::max(time, last.time);
+	}
+
+	modified_journal_.push_back({ time, object->obj_id_ });
+
+	if (modified_journal_.size() > JOURNAL_COMPACT_MIN + objects_.size() * 2)
+		compactJournal();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the first record in the modification journal with a
+// time of [since] or later
+// -----------------------------------------------------------------------------
+size_t MapObjectCollection::journalStart(long since) const
+{
+	auto first = std::lower_bound(
+		modified_journal_.begin(),
+		modified_journal_.end(),
+		since,
+		[](const ModifiedRecord& record, long time) { return record.time < time; });
+
+	return first - modified_journal_.begin();
+}
+
+// -----------------------------------------------------------------------------
+// Adds all objects (including those removed from the map) with a modified time
+// of [since] or later to [list], in order of object id
+// -----------------------------------------------------------------------------
+void MapObjectCollection::putJournalObjects(long since, vector<MapObject*>& list) const
+{
+	for (auto a = journalStart(since); a < modified_journal_.size(); ++a)
+	{
+		auto object = objects_[modified_journal_[a].obj_id].object.get();
+
+		// Records can have a later time than the object itself (see
+		// recordModified), so check the actual modified time too
+		if (object->modified_time_ >= since)
+			list.push_back(object);
+	}
+
+	// Objects modified more than once will have multiple records
+	std::sort(
+		list.begin(),
+		list.end(),
+		[](const MapObject* left, const MapObject* right) { return left->obj_id_ < right->obj_id_; });
+	list.erase(std::unique(list.begin(), list.end()), list.end());
+}
+
+// -----------------------------------------------------------------------------
+// Removes all but the latest record for each object from the modification
+// journal
+// -----------------------------------------------------------------------------
+void MapObjectCollection::compactJournal()
+{
+	vector<bool> recorded(objects_.size(), false);
+	auto         keep = modified_journal_.size();
+
+	for (auto a = modified_journal_.size(); a-- > 0;)
+	{
+		auto& record = modified_journal_[a];
+		if (recorded[record.obj_id])
+			continue;
+
+		recorded[record.obj_id]   = true;
+		modified_journal_[--keep] = record;
+	}
+
+	modified_journal_.erase(modified_journal_.begin(), modified_journal_.begin() + static_cast<long>(keep));
+}
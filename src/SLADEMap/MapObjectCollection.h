@@ -32,11 +32,15 @@ public:
 	void       addMapObject(unique_ptr<MapObject> object);
 	void       removeMapObject(MapObject* object);
 	MapObject* getObjectById(unsigned id) const { return objects_[id].object.get(); }
+	MapObject* mapObjectById(unsigned id) const;
 	void       putObjectIdList(MapObject::Type type, vector<unsigned>& list) const;
 	void       restoreObjectIdList(MapObject::Type type, vector<unsigned>& list);
+	long       objectsUpdated() const { return objects_updated_; }
 
 	void refreshIndices();
+	void optimiseOrder();
 	void clear();
+	void reserve(MapObject::Type type, unsigned count);
 
 	// Object add
 	MapVertex* addVertex(unique_ptr<MapVertex> vertex);
@@ -76,6 +80,9 @@ public:
 	// Cleanup/Extra
 	void rebuildConnectedLines();
 	void rebuildConnectedSides();
+	void updateSpatialIndex(MapObject* object);
+	void updateIdIndex(MapObject* object);
+	void recordModified(const MapObject* object);
 
 private:
 	struct MapObjectHolder
@@ -86,12 +93,26 @@ private:
 		MapObjectHolder(unique_ptr<MapObject> object, bool in_map) : object{ std::move(object) }, in_map{ in_map } {}
 	};
 
+	// A record in the modification journal. Records are appended in order of
+	// [time], so queries only need to look at the records since a given time
+	struct ModifiedRecord
+	{
+		long     time;
+		unsigned obj_id;
+	};
+
 	SLADEMap*               parent_map_ = nullptr;
 	vector<MapObjectHolder> objects_;
+	long                    objects_updated_ = 0; // The last time an object was added to or removed from the map
+	vector<ModifiedRecord>  modified_journal_;
 	VertexList              vertices_;
 	SideList                sides_;
 	LineList                lines_;
 	SectorList              sectors_;
 	ThingList               things_;
+
+	size_t journalStart(long since) const;
+	void   putJournalObjects(long since, vector<MapObject*>& list) const;
+	void   compactJournal();
 };
 } // namespace slade
@@ -40,6 +40,28 @@
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the keys to index [line]'s args by. Negative args are indexed by
+// their absolute value, since some specials take a negative line id
+// -----------------------------------------------------------------------------
+std::array<int, 5> argKeys(const MapLine* line)
+{
+	std::array<int, 5> keys{};
+	for (unsigned a = 0; a < 5; ++a)
+		keys[a] = std::abs(line->arg(a));
+
+	return keys;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // LineList Class Functions
@@ -47,17 +69,89 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Clears the list (and spatial/id indices)
+// -----------------------------------------------------------------------------
+void LineList::clear()
+{
+	grid_.clear();
+	id_index_.clear();
+	arg_index_.clear();
+	MapObjectList::clear();
+}
+
+// -----------------------------------------------------------------------------
+// Adds [line] to the list and spatial/id indices
+// -----------------------------------------------------------------------------
+void LineList::add(MapLine* line)
+{
+	if (line->v1() && line->v2())
+		grid_.insert(line, line->x1(), line->y1(), line->x2(), line->y2());
+	id_index_.insert(line, { line->id() });
+	arg_index_.insert(line, argKeys(line));
+
+	MapObjectList::add(line);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the line at [index] from the list and spatial/id indices
+// -----------------------------------------------------------------------------
+void LineList::remove(unsigned index)
+{
+	if (index >= count_)
+		return;
+
+	grid_.remove(objects_[index]);
+	id_index_.remove(objects_[index]);
+	arg_index_.remove(objects_[index]);
+	MapObjectList::remove(index);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the last line from the list and spatial/id indices
+// -----------------------------------------------------------------------------
+void LineList::removeLast()
+{
+	grid_.remove(objects_.back());
+	id_index_.remove(objects_.back());
+	arg_index_.remove(objects_.back());
+	MapObjectList::removeLast();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the spatial index for [line] after its vertices have changed or moved
+// -----------------------------------------------------------------------------
+void LineList::updateGrid(MapLine* line)
+{
+	if (line->v1() && line->v2())
+		grid_.update(line, line->x1(), line->y1(), line->x2(), line->y2());
+}
+
+// -----------------------------------------------------------------------------
+// Updates the id indices for [line] after its id or args have changed
+// -----------------------------------------------------------------------------
+void LineList::updateIdIndex(MapLine* line)
+{
+	id_index_.update(line, { line->id() });
+	arg_index_.update(line, argKeys(line));
+}
+
 // -----------------------------------------------------------------------------
 // Returns the line closest to the point, or null if none is found.
 // Ignores lines further away than [mindist]
 // -----------------------------------------------------------------------------
 MapLine* LineList::nearest(Vec2d point, double min) const
 {
+	// Only lines with a bounding box within [min] of the point can be near
+	// enough, so just check those if possible
+	vector<MapLine*> candidates;
+	auto             in_range = grid_.query(point.x - min, point.y - min, point.x + min, point.y + min, candidates);
+
 	// Go through lines
 	double   dist;
 	double   min_dist = min;
 	MapLine* nearest  = nullptr;
-	for (const auto& line : objects_)
+	for (const auto& line : in_range ? candidates : objects_)
 	{
 		// Check with line bounding box first (since we have a minimum distance)
 		auto bbox = line->seg();
@@ -79,6 +173,23 @@ MapLine* LineList::nearest(Vec2d point, double min) const
 	return nearest;
 }
 
+// -----------------------------------------------------------------------------
+// Adds all lines with a bounding box overlapping the area [x1,y1]-[x2,y2] to
+// [list], in index order
+// -----------------------------------------------------------------------------
+void LineList::putAllInArea(double x1, double y1, double x2, double y2, vector<MapLine*>& list) const
+{
+	vector<MapLine*> candidates;
+	auto             in_range = grid_.query(x1, y1, x2, y2, candidates);
+
+	for (const auto& line : in_range ? candidates : objects_)
+	{
+		auto bbox = line->seg();
+		if (bbox.left() <= x2 && bbox.right() >= x1 && bbox.top() <= y2 && bbox.bottom() >= y1)
+			list.push_back(line);
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Returns the first line in the list with vertices [v1] and [v2].
 // If [reverse] is false, only looks for lines with first vertex [v1] and second
@@ -104,8 +215,12 @@ vector<Vec2d> LineList::cutPoints(const Seg2d& cutter) const
 	vector<Vec2d> intersect_points;
 	Vec2d         intersection;
 
+	// Only lines overlapping the cutter's bounding box can cross it
+	vector<MapLine*> candidates;
+	auto             in_range = grid_.query(cutter.left(), cutter.top(), cutter.right(), cutter.bottom(), candidates);
+
 	// Go through map lines
-	for (const auto& line : objects_)
+	for (const auto& line : in_range ? candidates : objects_)
 	{
 		// Check for intersection
 		intersection = cutter.start();
@@ -161,11 +276,19 @@ vector<Vec2d> LineList::cutPoints(const Seg2d& cutter) const
 // -----------------------------------------------------------------------------
 MapLine* LineList::firstWithId(int id) const
 {
-	for (auto& line : objects_)
-		if (line->id() == id)
-			return line;
+	// Id 0 isn't indexed
+	if (id == 0)
+	{
+		for (auto& line : objects_)
+			if (line->id() == id)
+				return line;
 
-	return nullptr;
+		return nullptr;
+	}
+
+	vector<MapLine*> list;
+	id_index_.put(id, list);
+	return list.empty() ? nullptr : list[0];
 }
 
 // -----------------------------------------------------------------------------
@@ -173,9 +296,17 @@ MapLine* LineList::firstWithId(int id) const
 // -----------------------------------------------------------------------------
 void LineList::putAllWithId(int id, vector<MapLine*>& list) const
 {
-	for (auto& line : objects_)
-		if (line->id() == id)
-			list.push_back(line);
+	// Id 0 isn't indexed
+	if (id == 0)
+	{
+		for (auto& line : objects_)
+			if (line->id() == id)
+				list.push_back(line);
+
+		return;
+	}
+
+	id_index_.put(id, list);
 }
 
 // -----------------------------------------------------------------------------
@@ -188,6 +319,16 @@ vector<MapLine*> LineList::allWithId(int id) const
 	return list;
 }
 
+// -----------------------------------------------------------------------------
+// Adds all lines with any arg matching [value] (or its negative) to [list].
+// Nothing is added for a [value] of 0
+// -----------------------------------------------------------------------------
+void LineList::putAllWithArg(int value, vector<MapLine*>& list) const
+{
+	if (value != 0)
+		arg_index_.put(std::abs(value), list);
+}
+
 // -----------------------------------------------------------------------------
 // Adds all lines with special affecting matching [id] to [list]
 // -----------------------------------------------------------------------------
@@ -196,9 +337,17 @@ void LineList::putAllTaggingWithId(int id, int type, vector<MapLine*>& list) con
 {
 	using game::TagType;
 
+	// Nothing can match id 0
+	if (id == 0)
+		return;
+
+	// Only lines with an arg matching the id can possibly fit
+	vector<MapLine*> candidates;
+	arg_index_.put(std::abs(id), candidates);
+
 	// Find lines with special affecting matching id
 	int tag, arg2, arg3, arg4, arg5;
-	for (auto& line : objects_)
+	for (auto& line : candidates)
 	{
 		int special = line->special();
 		if (special)
@@ -298,40 +447,44 @@ int LineList::firstFreeId(MapFormat format) const
 	// UDMF (id property)
 	if (format == MapFormat::UDMF)
 	{
-		for (unsigned a = 0; a < count_; a++)
-		{
-			if (objects_[a]->id() == id)
-			{
-				id++;
-				a = 0;
-			}
-		}
+		while (id_index_.contains(id))
+			id++;
 	}
 
 	// Hexen (special 121 arg0)
 	else if (format == MapFormat::Hexen)
 	{
-		for (unsigned a = 0; a < count_; a++)
+		vector<MapLine*> lines;
+		auto             used = [&](int check_id)
 		{
-			if (objects_[a]->special() == 121 && objects_[a]->arg(0) == id)
-			{
-				id++;
-				a = 0;
-			}
-		}
+			lines.clear();
+			arg_index_.put(check_id, lines);
+			for (const auto& line : lines)
+				if (line->special() == 121 && line->arg(0) == check_id)
+					return true;
+			return false;
+		};
+
+		while (used(id))
+			id++;
 	}
 
 	// Boom (sector tag (arg0))
 	else if (format == MapFormat::Doom && game::configuration().featureSupported(game::Feature::Boom))
 	{
-		for (unsigned a = 0; a < count_; a++)
+		vector<MapLine*> lines;
+		auto             used = [&](int check_id)
 		{
-			if (objects_[a]->arg(0) == id)
-			{
-				id++;
-				a = 0;
-			}
-		}
+			lines.clear();
+			arg_index_.put(check_id, lines);
+			for (const auto& line : lines)
+				if (line->arg(0) == check_id)
+					return true;
+			return false;
+		};
+
+		while (used(id))
+			id++;
 	}
 
 	return id;
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "General/Defs.h"
+#include "MapObjectGrid.h"
+#include "MapObjectIdIndex.h"
 #include "MapObjectList.h"
 #include "SLADEMap/MapObject/MapLine.h"
 
@@ -9,13 +11,29 @@ namespace slade
 class LineList : public MapObjectList<MapLine>
 {
 public:
+	// MapObjectList overrides
+	void clear() override;
+	void add(MapLine* line) override;
+	void remove(unsigned index) override;
+	void removeLast() override;
+
+	void updateGrid(MapLine* line);
+	void updateIdIndex(MapLine* line);
+
 	MapLine*         nearest(Vec2d point, double min = 64) const;
 	MapLine*         withVertices(MapVertex* v1, MapVertex* v2, bool reverse = true) const;
+	void             putAllInArea(double x1, double y1, double x2, double y2, vector<MapLine*>& list) const;
 	vector<Vec2d>    cutPoints(const Seg2d& cutter) const;
 	MapLine*         firstWithId(int id) const;
 	void             putAllWithId(int id, vector<MapLine*>& list) const;
 	vector<MapLine*> allWithId(int id) const;
+	void             putAllWithArg(int value, vector<MapLine*>& list) const;
 	void             putAllTaggingWithId(int id, int type, vector<MapLine*>& list) const;
 	int              firstFreeId(MapFormat format) const;
+
+private:
+	MapObjectGrid<MapLine>       grid_;
+	MapObjectIdIndex<MapLine, 1> id_index_;
+	MapObjectIdIndex<MapLine, 5> arg_index_;
 };
 } // namespace slade
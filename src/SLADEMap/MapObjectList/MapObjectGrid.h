@@ -0,0 +1,169 @@
+#pragma once
+
+#include <unordered_map>
+
+namespace slade
+{
+// A uniform grid spatial index for map objects of type [T], used to speed up
+// position-based queries (nearest object, objects in an area etc.) on the
+// object lists. Each object is filed in every cell its bounds overlap - objects
+// covering a lot of cells (very long lines) are kept in a separate list that
+// is always included in query results instead.
+//
+// The grid doesn't know anything about the objects' positions itself, so the
+// owning list must call update() whenever an object's bounds change (see
+// MapObjectCollection::updateSpatialIndex)
+template<class T> class MapObjectGrid
+{
+public:
+	static constexpr double   CELL_SIZE        = 256.;
+	static constexpr int      MAX_OBJECT_CELLS = 64;
+	static constexpr unsigned MAX_QUERY_CELLS  = 4096;
+
+	void clear()
+	{
+		cells_.clear();
+		ranges_.clear();
+		large_.clear();
+	}
+
+	// Adds [object] with bounds [x1,y1]-[x2,y2] to the grid
+	void insert(T* object, double x1, double y1, double x2, double y2)
+	{
+		auto range = cellRange(x1, y1, x2, y2);
+		if (static_cast<double>(range.x2 - range.x1 + 1) * (range.y2 - range.y1 + 1) > MAX_OBJECT_CELLS)
+		{
+			range.x2 = range.x1 - 1; // Mark as large
+			large_.push_back(object);
+		}
+		else
+		{
+			for (int x = range.x1; x <= range.x2; ++x)
+				for (int y = range.y1; y <= range.y2; ++y)
+					cells_[cellKey(x, y)].push_back(object);
+		}
+
+		ranges_[object] = range;
+	}
+
+	// Removes [object] from the grid (if it's in it)
+	void remove(T* object)
+	{
+		auto i = ranges_.find(object);
+		if (i == ranges_.end())
+			return;
+
+		removeFromCells(object, i->second);
+		ranges_.erase(i);
+	}
+
+	// Updates the bounds of [object] to [x1,y1]-[x2,y2]. Does nothing if the
+	// object isn't in the grid
+	void update(T* object, double x1, double y1, double x2, double y2)
+	{
+		auto i = ranges_.find(object);
+		if (i == ranges_.end())
+			return;
+
+		// Nothing to do if it's still within the same cells
+		const auto range = cellRange(x1, y1, x2, y2);
+		if (i->second.x2 >= i->second.x1 && range == i->second)
+			return;
+
+		removeFromCells(object, i->second);
+		ranges_.erase(i);
+		insert(object, x1, y1, x2, y2);
+	}
+
+	// Adds all objects possibly overlapping the area [x1,y1]-[x2,y2] to
+	// [objects], in order of their index (and without duplicates).
+	// Returns false if the area covers too many cells to be worth it, in which
+	// case the caller should just check all objects instead
+	bool query(double x1, double y1, double x2, double y2, vector<T*>& objects) const
+	{
+		objects.clear();
+
+		const auto range = cellRange(x1, y1, x2, y2);
+		if (static_cast<double>(range.x2 - range.x1 + 1) * (range.y2 - range.y1 + 1) > MAX_QUERY_CELLS)
+			return false;
+
+		for (int x = range.x1; x <= range.x2; ++x)
+			for (int y = range.y1; y <= range.y2; ++y)
+			{
+				auto cell = cells_.find(cellKey(x, y));
+				if (cell != cells_.end())
+					objects.insert(objects.end(), cell->second.begin(), cell->second.end());
+			}
+		objects.insert(objects.end(), large_.begin(), large_.end());
+
+		std::sort(objects.begin(), objects.end(), [](T* left, T* right) { return left->index() < right->index(); });
+		objects.erase(std::unique(objects.begin(), objects.end()), objects.end());
+
+		return true;
+	}
+
+private:
+	struct CellRange
+	{
+		int x1, y1, x2, y2;
+
+		bool operator==(const CellRange& other) const
+		{
+			return x1 == other.x1 && y1 == other.y1 && x2 == other.x2 && y2 == other.y2;
+		}
+	};
+
+	std::unordered_map<uint64_t, vector<T*>> cells_;
+	std::unordered_map<T*, CellRange>        ranges_;
+	vector<T*>                               large_;
+
+	static int cell(double pos)
+	{
+		// Clamp to a sane range so huge coordinates can't overflow
+		return static_cast<int>(std::floor(std::clamp(pos / CELL_SIZE, -1048576., 1048576.)));
+	}
+
+	static CellRange cellRange(double x1, double y1, double x2, double y2)
+	{
+		return { cell(std::min(x1, x2)), cell(std::min(y1, y2)), cell(std::max(x1, x2)), cell(std::max(y1, y2)) };
+	}
+
+	static uint64_t cellKey(int x, int y)
+	{
+		return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+	}
+
+	void removeFromCells(T* object, const CellRange& range)
+	{
+		auto erase = [object](vector<T*>& list)
+		{
+			for (auto& obj : list)
+				if (obj == object)
+				{
+					obj = list.back();
+					list.pop_back();
+					return;
+				}
+		};
+
+		// Large object
+		if (range.x2 < range.x1)
+		{
+			erase(large_);
+			return;
+		}
+
+		for (int x = range.x1; x <= range.x2; ++x)
+			for (int y = range.y1; y <= range.y2; ++y)
+			{
+				auto cell = cells_.find(cellKey(x, y));
+				if (cell == cells_.end())
+					continue;
+
+				erase(cell->second);
+				if (cell->second.empty())
+					cells_.erase(cell);
+			}
+	}
+};
+} // namespace slade
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <unordered_map>
+
+namespace slade
+{
+// An index of map objects of type [T] by up to [N] integer keys per object (eg.
+// tag/id, or special args), used to speed up id-based lookups on the object
+// lists. A key of 0 is never indexed, since it generally means 'no id' and
+// would otherwise end up containing most of the objects in the map.
+//
+// Like MapObjectGrid, the owning list must call update() whenever an object's
+// keys change (see MapObjectCollection::updateIdIndex)
+template<class T, unsigned N> class MapObjectIdIndex
+{
+public:
+	typedef std::array<int, N> Keys;
+
+	void clear()
+	{
+		objects_.clear();
+		keys_.clear();
+	}
+
+	// Adds [object] to the index with [keys]
+	void insert(T* object, const Keys& keys)
+	{
+		for (unsigned a = 0; a < N; ++a)
+			if (isNewKey(keys, a))
+				objects_[keys[a]].push_back(object);
+
+		keys_[object] = keys;
+	}
+
+	// Removes [object] from the index (if it's in it)
+	void remove(T* object)
+	{
+		auto i = keys_.find(object);
+		if (i == keys_.end())
+			return;
+
+		removeKeys(object, i->second);
+		keys_.erase(i);
+	}
+
+	// Updates the keys of [object] to [keys]. Does nothing if the object isn't
+	// in the index
+	void update(T* object, const Keys& keys)
+	{
+		auto i = keys_.find(object);
+		if (i == keys_.end() || i->second == keys)
+			return;
+
+		removeKeys(object, i->second);
+		keys_.erase(i);
+		insert(object, keys);
+	}
+
+	// Adds all objects with [key] to [objects], in order of their index
+	void put(int key, vector<T*>& objects) const
+	{
+		auto i = objects_.find(key);
+		if (i == objects_.end())
+			return;
+
+		auto start = objects.size();
+		objects.insert(objects.end(), i->second.begin(), i->second.end());
+		std::sort(
+			objects.begin() + start,
+			objects.end(),
+			[](T* left, T* right) { return left->index() < right->index(); });
+	}
+
+	// Returns true if any object has [key]
+	bool contains(int key) const { return objects_.find(key) != objects_.end(); }
+
+private:
+	std::unordered_map<int, vector<T*>> objects_;
+	std::unordered_map<T*, Keys>        keys_;
+
+	// Returns true if key [index] in [keys] should be indexed (not 0 and not a
+	// duplicate of an earlier key)
+	static bool isNewKey(const Keys& keys, unsigned index)
+	{
+		if (keys[index] == 0)
+			return false;
+
+		for (unsigned a = 0; a < index; ++a)
+			if (keys[a] == keys[index])
+				return false;
+
+		return true;
+	}
+
+	void removeKeys(T* object, const Keys& keys)
+	{
+		for (unsigned a = 0; a < N; ++a)
+		{
+			if (!isNewKey(keys, a))
+				continue;
+
+			auto i = objects_.find(keys[a]);
+			if (i == objects_.end())
+				continue;
+
+			auto& list = i->second;
+			for (auto& obj : list)
+				if (obj == object)
+				{
+					obj = list.back();
+					list.pop_back();
+					break;
+				}
+
+			if (list.empty())
+				objects_.erase(i);
+		}
+	}
+};
+} // namespace slade
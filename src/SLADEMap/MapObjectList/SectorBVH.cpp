@@ -0,0 +1,296 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    SectorBVH.cpp
+// Description: A bounding volume hierarchy over sector bounding boxes, for
+//              quickly finding the sector(s) at a point
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "SectorBVH.h"
+#include "SLADEMap/MapObject/MapSector.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns a bbox containing both [a] and [b]. BBox::extend isn't used here
+// since it treats an all-zero bbox as 'empty', whereas a sector bbox of zero
+// size still contains that point as far as MapSector::containsPoint goes
+// -----------------------------------------------------------------------------
+BBox combined(const BBox& a, const BBox& b)
+{
+	BBox bbox;
+	bbox.min.set(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y));
+	bbox.max.set(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y));
+	return bbox;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [a] and [b] are exactly the same
+// -----------------------------------------------------------------------------
+bool sameBBox(const BBox& a, const BBox& b)
+{
+	return a.min.x == b.min.x && a.min.y == b.min.y && a.max.x == b.max.x && a.max.y == b.max.y;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// SectorBVH Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Clears the hierarchy. It will need to be built again before it is used
+// -----------------------------------------------------------------------------
+void SectorBVH::clear()
+{
+	nodes_.clear();
+	leaves_.clear();
+	dirty_.clear();
+	unindexed_.clear();
+	removed_ = 0;
+	refits_  = 0;
+	built_   = false;
+}
+
+// -----------------------------------------------------------------------------
+// (Re)builds the hierarchy from [sectors]
+// -----------------------------------------------------------------------------
+void SectorBVH::build(const vector<MapSector*>& sectors)
+{
+	clear();
+
+	if (!sectors.empty())
+	{
+		vector<Item> items;
+		items.reserve(sectors.size());
+		for (auto sector : sectors)
+			items.push_back({ sector, sector->boundingBox() });
+
+		nodes_.reserve(sectors.size() * 2);
+		leaves_.reserve(sectors.size());
+		buildNode(items, 0, items.size(), -1);
+	}
+
+	built_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the hierarchy should be rebuilt before querying it, given the
+// current number of sectors ([sector_count]). This is the case if it hasn't
+// been built yet, or if enough sectors have been added, removed or refitted
+// since it was built that it's likely to be worse than just rebuilding it
+// -----------------------------------------------------------------------------
+bool SectorBVH::needsRebuild(unsigned sector_count) const
+{
+	return !built_ || unindexed_.size() > 16 + sector_count / 32 || removed_ > sector_count / 4
+		   || refits_ > sector_count;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [sector] to the hierarchy (it's kept in the unindexed list until the
+// next rebuild)
+// -----------------------------------------------------------------------------
+void SectorBVH::add(MapSector* sector)
+{
+	if (built_)
+		unindexed_.push_back(sector);
+}
+
+// -----------------------------------------------------------------------------
+// Removes [sector] from the hierarchy
+// -----------------------------------------------------------------------------
+void SectorBVH::remove(MapSector* sector)
+{
+	auto leaf = leaves_.find(sector);
+	if (leaf != leaves_.end())
+	{
+		// Just clear the leaf, the node is removed on the next rebuild
+		nodes_[leaf->second].sector = nullptr;
+		leaves_.erase(leaf);
+		++removed_;
+		return;
+	}
+
+	for (unsigned a = 0; a < unindexed_.size(); ++a)
+		if (unindexed_[a] == sector)
+		{
+			unindexed_.erase(unindexed_.begin() + a);
+			return;
+		}
+}
+
+// -----------------------------------------------------------------------------
+// Marks [sector]'s bbox as changed, so it is refitted on the next query
+// -----------------------------------------------------------------------------
+void SectorBVH::invalidate(MapSector* sector)
+{
+	auto leaf = leaves_.find(sector);
+	if (leaf == leaves_.end() || nodes_[leaf->second].dirty)
+		return;
+
+	nodes_[leaf->second].dirty = true;
+	dirty_.push_back(leaf->second);
+}
+
+// -----------------------------------------------------------------------------
+// Adds all sectors with a bbox containing [point] to [sectors], in order of
+// their index
+// -----------------------------------------------------------------------------
+void SectorBVH::query(Vec2d point, vector<MapSector*>& sectors)
+{
+	sectors.clear();
+
+	if (!dirty_.empty())
+		refit();
+
+	if (!nodes_.empty())
+	{
+		stack_.clear();
+		stack_.push_back(0);
+		while (!stack_.empty())
+		{
+			const auto& node = nodes_[stack_.back()];
+			stack_.pop_back();
+
+			if (!node.bbox.contains(point))
+				continue;
+
+			if (node.left < 0)
+			{
+				if (node.sector)
+					sectors.push_back(node.sector);
+			}
+			else
+			{
+				stack_.push_back(node.right);
+				stack_.push_back(node.left);
+			}
+		}
+	}
+
+	// Sectors not in the tree yet are always included, MapSector::containsPoint
+	// checks the bbox first anyway
+	sectors.insert(sectors.end(), unindexed_.begin(), unindexed_.end());
+
+	std::sort(
+		sectors.begin(),
+		sectors.end(),
+		[](const MapSector* left, const MapSector* right) { return left->index() < right->index(); });
+}
+
+// -----------------------------------------------------------------------------
+// Builds a node (and its children) for [items] from [start] to [end], splitting
+// them at the median of the longest axis. Returns the index of the new node
+// -----------------------------------------------------------------------------
+int SectorBVH::buildNode(vector<Item>& items, unsigned start, unsigned end, int parent)
+{
+	auto index = static_cast<int>(nodes_.size());
+	nodes_.emplace_back();
+	nodes_[index].parent = parent;
+
+	// Leaf node
+	if (end - start == 1)
+	{
+		nodes_[index].bbox   = items[start].bbox;
+		nodes_[index].sector = items[start].sector;
+
+		leaves_[items[start].sector] = index;
+		return index;
+	}
+
+	// Determine the longest axis of the item bbox centres
+	auto cmin = items[start].bbox.mid();
+	auto cmax = cmin;
+	for (unsigned a = start + 1; a < end; ++a)
+	{
+		auto mid = items[a].bbox.mid();
+		cmin.set(std::min(cmin.x, mid.x), std::min(cmin.y, mid.y));
+		cmax.set(std::max(cmax.x, mid.x), std::max(cmax.y, mid.y));
+	}
+	bool split_x = cmax.x - cmin.x >= cmax.y - cmin.y;
+
+	// Split at the median
+	auto median = start + (end - start) / 2;
+	std::nth_element(
+		items.begin() + start,
+		items.begin() + median,
+		items.begin() + end,
+		[split_x](const Item& a, const Item& b)
+		{ return split_x ? a.bbox.midX() < b.bbox.midX() : a.bbox.midY() < b.bbox.midY(); });
+
+	auto left  = buildNode(items, start, median, index);
+	auto right = buildNode(items, median, end, index);
+
+	nodes_[index].left  = left;
+	nodes_[index].right = right;
+	nodes_[index].bbox  = combined(nodes_[left].bbox, nodes_[right].bbox);
+
+	return index;
+}
+
+// -----------------------------------------------------------------------------
+// Updates the bboxes of all dirty leaf nodes and their parents
+// -----------------------------------------------------------------------------
+void SectorBVH::refit()
+{
+	// Get all the new sector bboxes first - this can invalidate the sectors
+	// again (when a bbox is recalculated), which is ignored since they are
+	// still marked dirty
+	for (auto leaf : dirty_)
+		if (nodes_[leaf].sector)
+			nodes_[leaf].bbox = nodes_[leaf].sector->boundingBox();
+
+	for (auto leaf : dirty_)
+	{
+		nodes_[leaf].dirty = false;
+
+		// Refit parent nodes, stopping once one doesn't change
+		for (auto node = nodes_[leaf].parent; node >= 0; node = nodes_[node].parent)
+		{
+			auto bbox = combined(nodes_[nodes_[node].left].bbox, nodes_[nodes_[node].right].bbox);
+			if (sameBBox(bbox, nodes_[node].bbox))
+				break;
+
+			nodes_[node].bbox = bbox;
+		}
+	}
+
+	refits_ += dirty_.size();
+	dirty_.clear();
+}
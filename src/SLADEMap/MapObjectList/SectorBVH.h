@@ -0,0 +1,63 @@
+#pragma once
+
+#include <unordered_map>
+
+namespace slade
+{
+class MapSector;
+
+// A bounding volume hierarchy over sector bounding boxes, used by SectorList to
+// quickly find the sectors that may contain a point.
+//
+// Sector bboxes are calculated lazily and reset from a lot of places, so the
+// hierarchy doesn't try to keep up with them itself - invalidate() must be
+// called whenever a sector's bbox changes (see MapSector::resetBBox), and the
+// affected nodes are refitted on the next query. Sectors added since the last
+// build are kept in a separate list until there are enough of them to be worth
+// rebuilding (see needsRebuild)
+class SectorBVH
+{
+public:
+	SectorBVH()  = default;
+	~SectorBVH() = default;
+
+	void clear();
+	void build(const vector<MapSector*>& sectors);
+	bool needsRebuild(unsigned sector_count) const;
+
+	void add(MapSector* sector);
+	void remove(MapSector* sector);
+	void invalidate(MapSector* sector);
+
+	void query(Vec2d point, vector<MapSector*>& sectors);
+
+private:
+	struct Node
+	{
+		BBox       bbox;
+		int        parent = -1;
+		int        left   = -1; // -1 if leaf
+		int        right  = -1;
+		MapSector* sector = nullptr; // Leaf sector, null if removed
+		bool       dirty  = false;
+	};
+
+	struct Item
+	{
+		MapSector* sector;
+		BBox       bbox;
+	};
+
+	vector<Node>                        nodes_;
+	std::unordered_map<MapSector*, int> leaves_;
+	vector<int>                         dirty_;
+	vector<MapSector*>                  unindexed_;
+	vector<int>                         stack_;
+	unsigned                            removed_ = 0;
+	unsigned                            refits_  = 0;
+	bool                                built_   = false;
+
+	int  buildNode(vector<Item>& items, unsigned start, unsigned end, int parent);
+	void refit();
+};
+} // namespace slade
@@ -33,12 +33,25 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "SectorList.h"
+#include "General/Tasks.h"
 #include "General/UI.h"
-#include "Utility/StringUtils.h"
+#include <thread>
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Minimum number of sectors before polygons are built on the task workers
+constexpr unsigned PARALLEL_POLYGONS_MIN = 256;
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // SectorList Class Functions
@@ -47,11 +60,13 @@ using namespace slade;
 
 
 // -----------------------------------------------------------------------------
-// Clears the list (and texture usage)
+// Clears the list (and texture usage, bvh, id index)
 // -----------------------------------------------------------------------------
 void SectorList::clear()
 {
 	usage_tex_.clear();
+	bvh_.clear();
+	id_index_.clear();
 	MapObjectList::clear();
 }
 
@@ -61,9 +76,11 @@ void SectorList::clear()
 void SectorList::add(MapSector* sector)
 {
 	// Update texture counts
-	usage_tex_[strutil::upper(sector->floor().texture)] += 1;
-	usage_tex_[strutil::upper(sector->ceiling().texture)] += 1;
+	usage_tex_[sector->floor().texture_key] += 1;
+	usage_tex_[sector->ceiling().texture_key] += 1;
 
+	bvh_.add(sector);
+	id_index_.insert(sector, { sector->tag() });
 	MapObjectList::add(sector);
 }
 
@@ -76,19 +93,36 @@ void SectorList::remove(unsigned index)
 		return;
 
 	// Update texture counts
-	usage_tex_[strutil::upper(objects_[index]->floor().texture)] -= 1;
-	usage_tex_[strutil::upper(objects_[index]->ceiling().texture)] -= 1;
+	usage_tex_[objects_[index]->floor().texture_key] -= 1;
+	usage_tex_[objects_[index]->ceiling().texture_key] -= 1;
 
+	bvh_.remove(objects_[index]);
+	id_index_.remove(objects_[index]);
 	MapObjectList::remove(index);
 }
 
+// -----------------------------------------------------------------------------
+// Removes the last sector from the list and bvh
+// -----------------------------------------------------------------------------
+void SectorList::removeLast()
+{
+	bvh_.remove(objects_.back());
+	id_index_.remove(objects_.back());
+	MapObjectList::removeLast();
+}
+
 // -----------------------------------------------------------------------------
 // Returns the sector at the given [point], or null if not within a sector
 // -----------------------------------------------------------------------------
 MapSector* SectorList::atPos(Vec2d point) const
 {
-	// Go through sectors
-	for (const auto& sector : objects_)
+	if (bvh_.needsRebuild(count_))
+		bvh_.build(objects_);
+
+	// Go through sectors with a bbox containing the point (in index order)
+	vector<MapSector*> candidates;
+	bvh_.query(point, candidates);
+	for (const auto& sector : candidates)
 	{
 		// Check if point is within sector
 		if (sector->containsPoint(point))
@@ -136,21 +170,37 @@ void SectorList::initPolygons()
 {
 	ui::setSplashProgressMessage("Building sector polygons");
 	ui::setSplashProgress(0.0f);
-	for (unsigned i = 0; i < count_; ++i)
-	{
-		ui::setSplashProgress((float)i / (float)count_);
-		objects_[i]->polygon();
-	}
+
+	// Each sector's polygon only depends on the (unchanging) map geometry, so
+	// they can be built on the task workers. Sectors are handed out one at a
+	// time since polygon complexity varies a lot between sectors
+	const auto caller = std::this_thread::get_id();
+	tasks::parallelFor(
+		0,
+		count_,
+		[this, caller](unsigned index)
+		{
+			// Update progress from sectors built on this thread
+			if (std::this_thread::get_id() == caller)
+				ui::setSplashProgress(static_cast<float>(index) / static_cast<float>(count_));
+
+			objects_[index]->polygon();
+		},
+		count_ >= PARALLEL_POLYGONS_MIN ? 1 : std::max(count_, 1u));
+
 	ui::setSplashProgress(1.0f);
 }
 
 // -----------------------------------------------------------------------------
-// Forces update of bounding boxes for all sectors in the list
+// Forces update of bounding boxes for all sectors in the list, and builds the
+// bvh from them
 // -----------------------------------------------------------------------------
 void SectorList::initBBoxes()
 {
 	for (auto& sector : objects_)
 		sector->updateBBox();
+
+	bvh_.build(objects_);
 }
 
 // -----------------------------------------------------------------------------
@@ -158,9 +208,17 @@ void SectorList::initBBoxes()
 // -----------------------------------------------------------------------------
 void SectorList::putAllWithId(int id, vector<MapSector*>& list) const
 {
-	for (auto& sector : objects_)
-		if (sector->tag() == id)
-			list.push_back(sector);
+	// Tag 0 isn't indexed
+	if (id == 0)
+	{
+		for (auto& sector : objects_)
+			if (sector->tag() == id)
+				list.push_back(sector);
+
+		return;
+	}
+
+	id_index_.put(id, list);
 }
 
 // -----------------------------------------------------------------------------
@@ -178,11 +236,19 @@ vector<MapSector*> SectorList::allWithId(int id) const
 // -----------------------------------------------------------------------------
 MapSector* SectorList::firstWithId(int id) const
 {
-	for (auto& sector : objects_)
-		if (sector->tag() == id)
-			return sector;
+	// Tag 0 isn't indexed
+	if (id == 0)
+	{
+		for (auto& sector : objects_)
+			if (sector->tag() == id)
+				return sector;
 
-	return nullptr;
+		return nullptr;
+	}
+
+	vector<MapSector*> list;
+	id_index_.put(id, list);
+	return list.empty() ? nullptr : list[0];
 }
 
 // -----------------------------------------------------------------------------
@@ -191,14 +257,8 @@ MapSector* SectorList::firstWithId(int id) const
 int SectorList::firstFreeId() const
 {
 	int id = 1;
-	for (unsigned i = 0; i < count_; ++i)
-	{
-		if (objects_[i]->tag() == id)
-		{
-			id++;
-			i = 0;
-		}
-	}
+	while (id_index_.contains(id))
+		id++;
 
 	return id;
 }
@@ -206,15 +266,16 @@ int SectorList::firstFreeId() const
 // -----------------------------------------------------------------------------
 // Adjusts the usage count of [tex] by [adjust]
 // -----------------------------------------------------------------------------
-void SectorList::updateTexUsage(string_view tex, int adjust) const
+void SectorList::updateTexUsage(NameKey tex, int adjust) const
 {
-	usage_tex_[strutil::upper(tex)] += adjust;
+	usage_tex_[tex] += adjust;
 }
 
 // -----------------------------------------------------------------------------
 // Returns the usage count of [tex]
 // -----------------------------------------------------------------------------
-int SectorList::texUsageCount(string_view tex) const
+int SectorList::texUsageCount(NameKey tex) const
 {
-	return usage_tex_[strutil::upper(tex)];
+	auto i = usage_tex_.find(tex);
+	return i != usage_tex_.end() ? i->second : 0;
 }
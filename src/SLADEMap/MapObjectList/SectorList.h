@@ -1,6 +1,8 @@
 #pragma once
 
+#include "MapObjectIdIndex.h"
 #include "MapObjectList.h"
+#include "SectorBVH.h"
 #include "SLADEMap/MapObject/MapSector.h"
 
 namespace slade
@@ -12,6 +14,9 @@ public:
 	void clear() override;
 	void add(MapSector* sector) override;
 	void remove(unsigned index) override;
+	void removeLast() override;
+
+	void updateIdIndex(MapSector* sector) { id_index_.update(sector, { sector->tag() }); }
 
 	MapSector*         atPos(Vec2d point) const;
 	BBox               allSectorBounds() const;
@@ -22,11 +27,16 @@ public:
 	MapSector*         firstWithId(int id) const;
 	int                firstFreeId() const;
 
+	void bboxUpdated(MapSector* sector) const { bvh_.invalidate(sector); }
+
 	void clearTexUsage() const { usage_tex_.clear(); }
-	void updateTexUsage(string_view tex, int adjust) const;
-	int  texUsageCount(string_view tex) const;
+	void updateTexUsage(NameKey tex, int adjust) const;
+	int  texUsageCount(NameKey tex) const;
+	int  texUsageCount(string_view tex) const { return texUsageCount(NameKey{ tex }); }
 
 private:
-	mutable std::map<string, int> usage_tex_;
+	mutable std::unordered_map<NameKey, int> usage_tex_;
+	mutable SectorBVH                        bvh_;
+	MapObjectIdIndex<MapSector, 1>           id_index_;
 };
 } // namespace slade
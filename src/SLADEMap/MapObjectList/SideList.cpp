@@ -33,7 +33,6 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "SideList.h"
-#include "Utility/StringUtils.h"
 
 using namespace slade;
 
@@ -60,9 +59,9 @@ void SideList::clear()
 void SideList::add(MapSide* side)
 {
 	// Update texture counts
-	usage_tex_[strutil::upper(side->tex_upper_)] += 1;
-	usage_tex_[strutil::upper(side->tex_middle_)] += 1;
-	usage_tex_[strutil::upper(side->tex_lower_)] += 1;
+	usage_tex_[side->tex_upper_key_] += 1;
+	usage_tex_[side->tex_middle_key_] += 1;
+	usage_tex_[side->tex_lower_key_] += 1;
 
 	MapObjectList::add(side);
 }
@@ -76,9 +75,9 @@ void SideList::remove(unsigned index)
 		return;
 
 	// Update texture counts
-	usage_tex_[strutil::upper(objects_[index]->tex_upper_)] -= 1;
-	usage_tex_[strutil::upper(objects_[index]->tex_middle_)] -= 1;
-	usage_tex_[strutil::upper(objects_[index]->tex_lower_)] -= 1;
+	usage_tex_[objects_[index]->tex_upper_key_] -= 1;
+	usage_tex_[objects_[index]->tex_middle_key_] -= 1;
+	usage_tex_[objects_[index]->tex_lower_key_] -= 1;
 
 	MapObjectList::remove(index);
 }
@@ -86,15 +85,16 @@ void SideList::remove(unsigned index)
 // -----------------------------------------------------------------------------
 // Adjusts the usage count of [tex] by [adjust]
 // -----------------------------------------------------------------------------
-void SideList::updateTexUsage(string_view tex, int adjust) const
+void SideList::updateTexUsage(NameKey tex, int adjust) const
 {
-	usage_tex_[strutil::upper(tex)] += adjust;
+	usage_tex_[tex] += adjust;
 }
 
 // -----------------------------------------------------------------------------
 // Returns the usage count of [tex]
 // -----------------------------------------------------------------------------
-int SideList::texUsageCount(string_view tex) const
+int SideList::texUsageCount(NameKey tex) const
 {
-	return usage_tex_[strutil::upper(tex)];
+	auto i = usage_tex_.find(tex);
+	return i != usage_tex_.end() ? i->second : 0;
 }
@@ -14,10 +14,11 @@ public:
 	void remove(unsigned index) override;
 
 	void clearTexUsage() const { usage_tex_.clear(); }
-	void updateTexUsage(string_view tex, int adjust) const;
-	int  texUsageCount(string_view tex) const;
+	void updateTexUsage(NameKey tex, int adjust) const;
+	int  texUsageCount(NameKey tex) const;
+	int  texUsageCount(string_view tex) const { return texUsageCount(NameKey{ tex }); }
 
 private:
-	mutable std::map<string, int> usage_tex_;
+	mutable std::unordered_map<NameKey, int> usage_tex_;
 };
 } // namespace slade
@@ -40,6 +40,28 @@
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the keys to index [thing]'s args by. Negative args are indexed by
+// their absolute value, since some specials take a negative line id
+// -----------------------------------------------------------------------------
+std::array<int, 5> argKeys(const MapThing* thing)
+{
+	std::array<int, 5> keys{};
+	for (unsigned a = 0; a < 5; ++a)
+		keys[a] = std::abs(thing->arg(a));
+
+	return keys;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // ThingList Class Functions
@@ -47,17 +69,88 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Clears the list (and spatial/id indices)
+// -----------------------------------------------------------------------------
+void ThingList::clear()
+{
+	grid_.clear();
+	id_index_.clear();
+	arg_index_.clear();
+	MapObjectList::clear();
+}
+
+// -----------------------------------------------------------------------------
+// Adds [thing] to the list and spatial/id indices
+// -----------------------------------------------------------------------------
+void ThingList::add(MapThing* thing)
+{
+	grid_.insert(thing, thing->xPos(), thing->yPos(), thing->xPos(), thing->yPos());
+	id_index_.insert(thing, { thing->id() });
+	arg_index_.insert(thing, argKeys(thing));
+	MapObjectList::add(thing);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the thing at [index] from the list and spatial/id indices
+// -----------------------------------------------------------------------------
+void ThingList::remove(unsigned index)
+{
+	if (index >= count_)
+		return;
+
+	grid_.remove(objects_[index]);
+	id_index_.remove(objects_[index]);
+	arg_index_.remove(objects_[index]);
+	MapObjectList::remove(index);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the last thing from the list and spatial/id indices
+// -----------------------------------------------------------------------------
+void ThingList::removeLast()
+{
+	grid_.remove(objects_.back());
+	id_index_.remove(objects_.back());
+	arg_index_.remove(objects_.back());
+	MapObjectList::removeLast();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the spatial index for [thing] after it has moved
+// -----------------------------------------------------------------------------
+void ThingList::updateGrid(MapThing* thing)
+{
+	grid_.update(thing, thing->xPos(), thing->yPos(), thing->xPos(), thing->yPos());
+}
+
+// -----------------------------------------------------------------------------
+// Updates the id indices for [thing] after its TID or args have changed
+// -----------------------------------------------------------------------------
+void ThingList::updateIdIndex(MapThing* thing)
+{
+	id_index_.update(thing, { thing->id() });
+	arg_index_.update(thing, argKeys(thing));
+}
+
 // -----------------------------------------------------------------------------
 // Returns the thing closest to the point, or null if none found.
 // Igonres any thing further away than [min]
 // -----------------------------------------------------------------------------
 MapThing* ThingList::nearest(Vec2d point, double min) const
 {
+	// Only things within a 'quick' distance of [min] * sqrt(2) can be within
+	// the real distance [min], so just check those if possible
+	vector<MapThing*> candidates;
+	auto              qmin     = min * 1.415;
+	auto              in_range = grid_.query(
+		point.x - qmin, point.y - qmin, point.x + qmin, point.y + qmin, candidates);
+
 	// Go through things
 	double    dist;
 	double    min_dist = 999999999;
 	MapThing* nearest  = nullptr;
-	for (const auto& thing : objects_)
+	for (const auto& thing : in_range ? candidates : objects_)
 	{
 		// Get 'quick' distance (no need to get real distance)
 		dist = point.taxicabDistanceTo(thing->position());
@@ -90,10 +183,32 @@ vector<MapThing*> ThingList::multiNearest(Vec2d point) const
 {
 	vector<MapThing*> ret;
 
+	// Search an increasingly large area around the point until it contains at
+	// least one thing, and all things within the 'quick' distance of the
+	// nearest one (falls back to checking all things if the area gets too big)
+	vector<MapThing*> candidates;
+	bool              in_range = false;
+	for (double size = MapObjectGrid<MapThing>::CELL_SIZE; !objects_.empty(); size *= 4)
+	{
+		in_range = grid_.query(point.x - size, point.y - size, point.x + size, point.y + size, candidates);
+		if (!in_range || candidates.size() == objects_.size())
+			break;
+
+		auto found = false;
+		for (const auto& thing : candidates)
+			if (point.taxicabDistanceTo(thing->position()) <= size)
+			{
+				found = true;
+				break;
+			}
+		if (found)
+			break;
+	}
+
 	// Go through things
 	double min_dist = 999999999;
 	double dist     = 0;
-	for (const auto& thing : objects_)
+	for (const auto& thing : in_range ? candidates : objects_)
 	{
 		// Get 'quick' distance (no need to get real distance)
 		dist = point.taxicabDistanceTo(thing->position());
@@ -127,15 +242,42 @@ BBox ThingList::allThingBounds() const
 	return bbox;
 }
 
+// -----------------------------------------------------------------------------
+// Adds all things within the area [x1,y1]-[x2,y2] to [list], in index order
+// -----------------------------------------------------------------------------
+void ThingList::putAllInArea(double x1, double y1, double x2, double y2, vector<MapThing*>& list) const
+{
+	vector<MapThing*> candidates;
+	auto              in_range = grid_.query(x1, y1, x2, y2, candidates);
+
+	for (const auto& thing : in_range ? candidates : objects_)
+	{
+		if (thing->xPos() >= x1 && thing->xPos() <= x2 && thing->yPos() >= y1 && thing->yPos() <= y2)
+			list.push_back(thing);
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Adds all things with TID [id] to [list].
 // If [type] is not 0, only checks things of that type
 // -----------------------------------------------------------------------------
 void ThingList::putAllWithId(int id, vector<MapThing*>& list, unsigned start, int type) const
 {
-	for (unsigned i = start; i < count_; ++i)
-		if (objects_[i]->id() == id && (type == 0 || objects_[i]->type() == type))
-			list.push_back(objects_[i]);
+	// TID 0 isn't indexed
+	if (id == 0)
+	{
+		for (unsigned i = start; i < count_; ++i)
+			if (objects_[i]->id() == id && (type == 0 || objects_[i]->type() == type))
+				list.push_back(objects_[i]);
+
+		return;
+	}
+
+	vector<MapThing*> things;
+	id_index_.put(id, things);
+	for (const auto& thing : things)
+		if (thing->index() >= start && (type == 0 || thing->type() == type))
+			list.push_back(thing);
 }
 
 // -----------------------------------------------------------------------------
@@ -149,25 +291,36 @@ vector<MapThing*> ThingList::allWithId(int id, unsigned start, int type) const
 	return list;
 }
 
+// -----------------------------------------------------------------------------
+// Adds all things with any arg matching [value] (or its negative) to [list].
+// Nothing is added for a [value] of 0
+// -----------------------------------------------------------------------------
+void ThingList::putAllWithArg(int value, vector<MapThing*>& list) const
+{
+	if (value != 0)
+		arg_index_.put(std::abs(value), list);
+}
+
 // -----------------------------------------------------------------------------
 // Returns the first thing found with TID [id], or null if none were found.
 // If [type] is not 0, only checks things of that type
 // -----------------------------------------------------------------------------
 MapThing* ThingList::firstWithId(int id, unsigned start, int type, bool ignore_dragon) const
 {
-	for (unsigned i = start; i < count_; ++i)
-		if (objects_[i]->id() == id && (type == 0 || objects_[i]->type() == type))
+	vector<MapThing*> things;
+	putAllWithId(id, things, start, type);
+	for (const auto& thing : things)
+	{
+		if (ignore_dragon)
 		{
-			if (ignore_dragon)
-			{
-				auto& tt = game::configuration().thingType(objects_[i]->type());
-				if (tt.flags() & game::ThingType::Flags::Dragon)
-					continue;
-			}
-
-			return objects_[i];
+			auto& tt = game::configuration().thingType(thing->type());
+			if (tt.flags() & game::ThingType::Flags::Dragon)
+				continue;
 		}
 
+		return thing;
+	}
+
 	return nullptr;
 }
 
@@ -193,9 +346,23 @@ void ThingList::putAllTaggingWithId(int id, int type, vector<MapThing*>& list, i
 {
 	using game::TagType;
 
+	// Nothing can match id 0
+	if (id == 0)
+		return;
+
+	// Only things with an arg or TID matching the id can possibly fit
+	vector<MapThing*> candidates;
+	arg_index_.put(std::abs(id), candidates);
+	id_index_.put(id, candidates);
+	std::sort(
+		candidates.begin(),
+		candidates.end(),
+		[](const MapThing* left, const MapThing* right) { return left->index() < right->index(); });
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
 	// Find things with special affecting matching id
 	int tag, arg2, arg3, arg4, arg5, tid;
-	for (auto& thing : objects_)
+	for (auto& thing : candidates)
 	{
 		auto& tt        = game::configuration().thingType(thing->type());
 		auto  needs_tag = tt.needsTag();
@@ -302,14 +469,8 @@ void ThingList::putAllTaggingWithId(int id, int type, vector<MapThing*>& list, i
 int ThingList::firstFreeId() const
 {
 	int id = 1;
-	for (unsigned i = 0; i < count_; ++i)
-	{
-		if (objects_[i]->id() == id)
-		{
-			id++;
-			i = 0;
-		}
-	}
+	while (id_index_.contains(id))
+		id++;
 
 	return id;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "MapObjectGrid.h"
+#include "MapObjectIdIndex.h"
 #include "MapObjectList.h"
 #include "SLADEMap/MapObject/MapThing.h"
 
@@ -8,14 +10,30 @@ namespace slade
 class ThingList : public MapObjectList<MapThing>
 {
 public:
+	// MapObjectList overrides
+	void clear() override;
+	void add(MapThing* thing) override;
+	void remove(unsigned index) override;
+	void removeLast() override;
+
+	void updateGrid(MapThing* thing);
+	void updateIdIndex(MapThing* thing);
+
 	MapThing*         nearest(Vec2d point, double min = 64) const;
 	vector<MapThing*> multiNearest(Vec2d point) const;
 	BBox              allThingBounds() const;
+	void              putAllInArea(double x1, double y1, double x2, double y2, vector<MapThing*>& list) const;
 	void              putAllWithId(int id, vector<MapThing*>& list, unsigned start = 0, int type = 0) const;
 	vector<MapThing*> allWithId(int id, unsigned start = 0, int type = 0) const;
 	MapThing*         firstWithId(int id, unsigned start = 0, int type = 0, bool ignore_dragon = false) const;
+	void              putAllWithArg(int value, vector<MapThing*>& list) const;
 	void              putAllPathed(vector<MapThing*>& list) const;
 	void              putAllTaggingWithId(int id, int type, vector<MapThing*>& list, int ttype) const;
 	int               firstFreeId() const;
+
+private:
+	MapObjectGrid<MapThing>       grid_;
+	MapObjectIdIndex<MapThing, 1> id_index_;
+	MapObjectIdIndex<MapThing, 5> arg_index_;
 };
 } // namespace slade
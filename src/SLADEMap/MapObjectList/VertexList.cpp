@@ -45,17 +45,71 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Clears the list (and spatial index)
+// -----------------------------------------------------------------------------
+void VertexList::clear()
+{
+	grid_.clear();
+	MapObjectList::clear();
+}
+
+// -----------------------------------------------------------------------------
+// Adds [vertex] to the list and spatial index
+// -----------------------------------------------------------------------------
+void VertexList::add(MapVertex* vertex)
+{
+	grid_.insert(vertex, vertex->xPos(), vertex->yPos(), vertex->xPos(), vertex->yPos());
+	MapObjectList::add(vertex);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the vertex at [index] from the list and spatial index
+// -----------------------------------------------------------------------------
+void VertexList::remove(unsigned index)
+{
+	if (index >= count_)
+		return;
+
+	grid_.remove(objects_[index]);
+	MapObjectList::remove(index);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the last vertex from the list and spatial index
+// -----------------------------------------------------------------------------
+void VertexList::removeLast()
+{
+	grid_.remove(objects_.back());
+	MapObjectList::removeLast();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the spatial index for [vertex] after it has moved
+// -----------------------------------------------------------------------------
+void VertexList::updateGrid(MapVertex* vertex)
+{
+	grid_.update(vertex, vertex->xPos(), vertex->yPos(), vertex->xPos(), vertex->yPos());
+}
+
 // -----------------------------------------------------------------------------
 // Returns the vertex closest to the point, or null if none found.
 // Igonres any vertices further away than [min]
 // -----------------------------------------------------------------------------
 MapVertex* VertexList::nearest(Vec2d point, double min) const
 {
+	// Only vertices within a 'quick' distance of [min] * sqrt(2) can be within
+	// the real distance [min], so just check those if possible
+	vector<MapVertex*> candidates;
+	auto               qmin     = min * 1.415;
+	auto               in_range = grid_.query(
+		point.x - qmin, point.y - qmin, point.x + qmin, point.y + qmin, candidates);
+
 	// Go through vertices
 	double     dist;
 	double     min_dist = 999999999;
 	MapVertex* nearest  = nullptr;
-	for (const auto& vertex : objects_)
+	for (const auto& vertex : in_range ? candidates : objects_)
 	{
 		// Get 'quick' distance (no need to get real distance)
 		dist = point.taxicabDistanceTo(vertex->position());
@@ -85,8 +139,11 @@ MapVertex* VertexList::nearest(Vec2d point, double min) const
 // -----------------------------------------------------------------------------
 MapVertex* VertexList::vertexAt(double x, double y) const
 {
+	vector<MapVertex*> candidates;
+	auto               in_range = grid_.query(x, y, x, y, candidates);
+
 	// Go through all vertices
-	for (auto& vertex : objects_)
+	for (auto& vertex : in_range ? candidates : objects_)
 	{
 		if (vertex->position_.x == x && vertex->position_.y == y)
 			return vertex;
@@ -101,10 +158,13 @@ MapVertex* VertexList::vertexAt(double x, double y) const
 // -----------------------------------------------------------------------------
 MapVertex* VertexList::firstCrossed(const Seg2d& line) const
 {
+	vector<MapVertex*> candidates;
+	auto               in_range = grid_.query(line.left(), line.top(), line.right(), line.bottom(), candidates);
+
 	// Go through vertices
 	MapVertex* cv       = nullptr;
 	double     min_dist = 999999;
-	for (const auto& vertex : objects_)
+	for (const auto& vertex : in_range ? candidates : objects_)
 	{
 		auto point = vertex->position();
 
@@ -132,3 +192,19 @@ MapVertex* VertexList::firstCrossed(const Seg2d& line) const
 	// Return closest overlapping vertex to line start
 	return cv;
 }
+
+// -----------------------------------------------------------------------------
+// Adds all vertices within the area [x1,y1]-[x2,y2] to [list], in index order
+// -----------------------------------------------------------------------------
+void VertexList::putAllInArea(double x1, double y1, double x2, double y2, vector<MapVertex*>& list) const
+{
+	vector<MapVertex*> candidates;
+	auto               in_range = grid_.query(x1, y1, x2, y2, candidates);
+
+	for (const auto& vertex : in_range ? candidates : objects_)
+	{
+		if (vertex->position_.x >= x1 && vertex->position_.x <= x2 && vertex->position_.y >= y1
+			&& vertex->position_.y <= y2)
+			list.push_back(vertex);
+	}
+}
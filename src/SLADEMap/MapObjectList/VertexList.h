@@ -1,5 +1,6 @@
 #pragma once
 
+#include "MapObjectGrid.h"
 #include "MapObjectList.h"
 #include "SLADEMap/MapObject/MapVertex.h"
 
@@ -8,8 +9,20 @@ namespace slade
 class VertexList : public MapObjectList<MapVertex>
 {
 public:
+	// MapObjectList overrides
+	void clear() override;
+	void add(MapVertex* vertex) override;
+	void remove(unsigned index) override;
+	void removeLast() override;
+
+	void updateGrid(MapVertex* vertex);
+
 	MapVertex* nearest(Vec2d point, double min = 64) const;
 	MapVertex* vertexAt(double x, double y) const;
 	MapVertex* firstCrossed(const Seg2d& line) const;
+	void       putAllInArea(double x1, double y1, double x2, double y2, vector<MapVertex*>& list) const;
+
+private:
+	MapObjectGrid<MapVertex> grid_;
 };
 } // namespace slade
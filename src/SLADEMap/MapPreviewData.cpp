@@ -0,0 +1,716 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapPreviewData.cpp
+// Description: MapPreviewData class - basic map geometry read directly from
+//              map entries for previews and thumbnails, with a cache of
+//              recently read maps (keyed by content) and a simple CPU
+//              rasteriser to render it to an image without OpenGL
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapPreviewData.h"
+#include "Archive/ArchiveEntry.h"
+#include "Archive/EntryType/EntryType.h"
+#include "Archive/Formats/WadArchive.h"
+#include "General/ColourConfiguration.h"
+#include "General/Misc.h"
+#include "Graphics/SImage/SImage.h"
+#include "SLADEMap/MapFormat/Doom32XMapFormat.h"
+#include "SLADEMap/MapFormat/Doom64MapFormat.h"
+#include "SLADEMap/MapFormat/DoomMapFormat.h"
+#include "SLADEMap/MapFormat/HexenMapFormat.h"
+#include "Utility/Tokenizer.h"
+#include <list>
+#include <mutex>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, map_preview_cache_size, 64, CVar::Flag::Save)
+EXTERN_CVAR(Float, map_image_thickness)
+
+namespace
+{
+std::mutex                                                       cache_mutex;
+std::list<std::pair<uint64_t, shared_ptr<const MapPreviewData>>> cache; // Most recently used first
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Reads a struct of type T at [index] from [data] into [out].
+// Returns false if [data] isn't big enough
+// -----------------------------------------------------------------------------
+template<typename T> bool readStruct(const MemChunk& data, unsigned index, T& out)
+{
+	if ((index + 1) * sizeof(T) > data.size())
+		return false;
+
+	memcpy(&out, data.data() + index * sizeof(T), sizeof(T));
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Blends [colour] into the RGBA pixel at [pixel] with [coverage] (0-1)
+// -----------------------------------------------------------------------------
+void blendPixel(uint8_t* pixel, const ColRGBA& colour, float coverage)
+{
+	auto a   = colour.fa() * coverage;
+	auto inv = 1.0f - a;
+	pixel[0] = static_cast<uint8_t>(colour.r * a + pixel[0] * inv);
+	pixel[1] = static_cast<uint8_t>(colour.g * a + pixel[1] * inv);
+	pixel[2] = static_cast<uint8_t>(colour.b * a + pixel[2] * inv);
+	pixel[3] = static_cast<uint8_t>(255 * a + pixel[3] * inv);
+}
+
+// -----------------------------------------------------------------------------
+// Draws an antialiased line from [x1,y1] to [x2,y2] (in pixels) of [thickness]
+// in [colour] to the [width]x[height] RGBA [pixels].
+// Only pixels near the line are visited (stepping along its major axis), so
+// long lines across large images are still cheap
+// -----------------------------------------------------------------------------
+void rasteriseLine(
+	vector<uint8_t>& pixels,
+	int              width,
+	int              height,
+	double           x1,
+	double           y1,
+	double           x2,
+	double           y2,
+	double           thickness,
+	const ColRGBA&   colour)
+{
+	auto dx     = x2 - x1;
+	auto dy     = y2 - y1;
+	auto len_sq = dx * dx + dy * dy;
+	auto radius = thickness * 0.5;
+	auto steep  = std::abs(dy) > std::abs(dx);
+
+	// Range to visit along the major axis, and around the line on the minor
+	auto major_min = static_cast<int>(std::floor((steep ? std::min(y1, y2) : std::min(x1, x2)) - radius));
+	auto major_max = static_cast<int>(std::ceil((steep ? std::max(y1, y2) : std::max(x1, x2)) + radius));
+	auto spread    = static_cast<int>(std::ceil(radius * std::sqrt(2.0))) + 1;
+	major_min      = std::max(major_min, 0);
+	major_max      = std::min(major_max, (steep ? height : width) - 1);
+
+	for (int major = major_min; major <= major_max; ++major)
+	{
+		// Minor axis position of the line at this major position (clamped to
+		// the line ends)
+		double minor_pos;
+		if (steep)
+			minor_pos = dy == 0 ? x1 : x1 + dx * std::clamp((major + 0.5 - y1) / dy, 0.0, 1.0);
+		else
+			minor_pos = dx == 0 ? y1 : y1 + dy * std::clamp((major + 0.5 - x1) / dx, 0.0, 1.0);
+
+		auto minor_min = std::max(static_cast<int>(minor_pos) - spread, 0);
+		auto minor_max = std::min(static_cast<int>(minor_pos) + spread, (steep ? width : height) - 1);
+		for (int minor = minor_min; minor <= minor_max; ++minor)
+		{
+			// Get distance from pixel centre to the line segment
+			auto px = (steep ? minor : major) + 0.5;
+			auto py = (steep ? major : minor) + 0.5;
+			auto t  = len_sq > 0 ? std::clamp(((px - x1) * dx + (py - y1) * dy) / len_sq, 0.0, 1.0) : 0.0;
+			auto ex = px - (x1 + dx * t);
+			auto ey = py - (y1 + dy * t);
+
+			// Coverage falls off over the last pixel of the line's radius
+			auto coverage = std::clamp(radius + 0.5 - std::sqrt(ex * ex + ey * ey), 0.0, 1.0);
+			if (coverage > 0)
+			{
+				auto x = steep ? minor : major;
+				auto y = steep ? major : minor;
+				blendPixel(pixels.data() + (y * width + x) * 4, colour, static_cast<float>(coverage));
+			}
+		}
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MapPreviewData Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Reads map geometry from [source].
+// Doesn't access any entries or global state, so can be used on any thread.
+// Returns false (with an error message set, see error()) if the map couldn't
+// be read
+// -----------------------------------------------------------------------------
+bool MapPreviewData::read(const Source& source)
+{
+	vertices_.clear();
+	lines_.clear();
+	things_.clear();
+	n_sides_   = 0;
+	n_sectors_ = 0;
+	error_.clear();
+
+	// UDMF map
+	if (source.format == MapFormat::UDMF)
+	{
+		if (!source.textmap.hasData())
+		{
+			error_ = "No TEXTMAP entry in UDMF map";
+			return false;
+		}
+
+		return readUDMF(source.textmap, source.name);
+	}
+
+	// Read vertices and linedefs (required)
+	if (!readVertices(source.vertexes, source.format))
+	{
+		error_ = "No VERTEXES entry in map";
+		return false;
+	}
+	if (!readLines(source.linedefs, source.format))
+	{
+		error_ = "No LINEDEFS entry in map";
+		return false;
+	}
+
+	// Read things
+	readThings(source.things, source.format);
+
+	// Count sides & sectors
+	if (source.format != MapFormat::Doom64)
+	{
+		n_sides_   = source.sidedefs_size / 30;
+		n_sectors_ = source.sectors_size / 26;
+	}
+	else
+	{
+		n_sides_   = source.sidedefs_size / 12;
+		n_sectors_ = source.sectors_size / 16;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of (attached) vertices in the map
+// -----------------------------------------------------------------------------
+unsigned MapPreviewData::nVertices() const
+{
+	// Get list of used vertices
+	vector<bool> v_used(vertices_.size(), false);
+	for (auto& line : lines_)
+	{
+		if (line.v1 < v_used.size())
+			v_used[line.v1] = true;
+		if (line.v2 < v_used.size())
+			v_used[line.v2] = true;
+	}
+
+	// Get count of used vertices
+	return static_cast<unsigned>(std::count(v_used.begin(), v_used.end(), true));
+}
+
+// -----------------------------------------------------------------------------
+// Returns the bounding box of all vertices in the map
+// -----------------------------------------------------------------------------
+BBox MapPreviewData::bounds() const
+{
+	BBox bbox;
+	for (auto& vertex : vertices_)
+		bbox.extend(vertex);
+
+	return bbox;
+}
+
+// -----------------------------------------------------------------------------
+// Renders the map lines to [image] (as [width]x[height] RGBA) in [style],
+// zoomed to fit (the same as the map preview canvas).
+// Doesn't require OpenGL, and can be used on any thread
+// -----------------------------------------------------------------------------
+void MapPreviewData::render(SImage& image, int width, int height, const RenderStyle& style) const
+{
+	if (width <= 0 || height <= 0)
+		return;
+
+	// Fill background
+	vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+	for (size_t a = 0; a < pixels.size(); a += 4)
+		style.background.write(pixels.data() + a);
+
+	// Zoom/offset to fit whole map
+	auto bbox = bounds();
+	auto zoom = 0.;
+	if (bbox.width() > 0 && bbox.height() > 0)
+		zoom = std::min<double>(width / bbox.width(), height / bbox.height()) * 0.95;
+	auto mid     = bbox.mid();
+	auto to_x    = [&](double x) { return width * 0.5 + (x - mid.x) * zoom; };
+	auto to_y    = [&](double y) { return height * 0.5 - (y - mid.y) * zoom; }; // Map y is up
+	auto n_verts = vertices_.size();
+
+	// Draw 2s lines, then 1s lines over them
+	for (auto pass : { true, false })
+		for (auto& line : lines_)
+		{
+			if (line.twosided != pass || line.v1 >= n_verts || line.v2 >= n_verts)
+				continue;
+
+			// Get colour
+			auto colour = style.line_1s;
+			if (line.special)
+				colour = style.line_special;
+			else if (line.macro)
+				colour = style.line_macro;
+			else if (line.twosided)
+				colour = style.line_2s;
+
+			auto& v1 = vertices_[line.v1];
+			auto& v2 = vertices_[line.v2];
+			rasteriseLine(
+				pixels, width, height, to_x(v1.x), to_y(v1.y), to_x(v2.x), to_y(v2.y), style.thickness, colour);
+		}
+
+	image.setImageData(pixels, width, height, SImage::Type::RGBA);
+}
+
+// -----------------------------------------------------------------------------
+// Reads UDMF map geometry from [textmap] ([name] is used for error messages)
+// -----------------------------------------------------------------------------
+bool MapPreviewData::readUDMF(const MemChunk& textmap, string_view name)
+{
+	Tokenizer tz;
+	tz.enableZeroCopy(true);
+	tz.openMem(textmap, name);
+	size_t vertcounter = 0, linecounter = 0, thingcounter = 0;
+	while (!tz.atEnd())
+	{
+		// Namespace
+		if (tz.checkNC("namespace"))
+			tz.advUntil(";");
+
+		// Sidedef
+		else if (tz.checkNC("sidedef"))
+		{
+			// Just increase count
+			n_sides_++;
+			tz.advUntil("}");
+		}
+
+		// Sector
+		else if (tz.checkNC("sector"))
+		{
+			// Just increase count
+			n_sectors_++;
+			tz.advUntil("}");
+		}
+
+		// Vertex or thing
+		else if (tz.checkNC("vertex") || tz.checkNC("thing"))
+		{
+			bool   vertex = tz.checkNC("vertex");
+			auto&  count  = vertex ? vertcounter : thingcounter;
+			bool   gotx   = false;
+			bool   goty   = false;
+			double x      = 0.;
+			double y      = 0.;
+
+			tz.adv(2); // skip {
+
+			// Get X and Y properties
+			while (!tz.check("}") && !tz.atEnd())
+			{
+				if (tz.checkNC("x") || tz.checkNC("y"))
+				{
+					if (!tz.checkNext("="))
+					{
+						error_ = fmt::format(
+							"Bad syntax for {} {} in UDMF map data", vertex ? "vertex" : "thing", count);
+						return false;
+					}
+
+					if (tz.checkNC("x"))
+					{
+						tz.adv(2);
+						x    = tz.current().asFloat();
+						gotx = true;
+					}
+					else
+					{
+						tz.adv(2);
+						y    = tz.current().asFloat();
+						goty = true;
+					}
+				}
+
+				tz.advUntil(";");
+				tz.adv();
+			}
+
+			if (!gotx || !goty)
+			{
+				error_ = fmt::format("Wrong {} {} in UDMF map data", vertex ? "vertex" : "thing", count);
+				return false;
+			}
+
+			if (vertex)
+				vertices_.emplace_back(x, y);
+			else
+				things_.emplace_back(x, y);
+
+			count++;
+		}
+
+		// Linedef
+		else if (tz.checkNC("linedef"))
+		{
+			bool     special  = false;
+			bool     twosided = false;
+			bool     gotv1 = false, gotv2 = false;
+			unsigned v1 = 0, v2 = 0;
+
+			tz.adv(2); // skip {
+
+			while (!tz.check("}") && !tz.atEnd())
+			{
+				if (tz.checkNC("v1") || tz.checkNC("v2"))
+				{
+					if (!tz.checkNext("="))
+					{
+						error_ = fmt::format("Bad syntax for linedef {} in UDMF map data", linecounter);
+						return false;
+					}
+
+					if (tz.checkNC("v1"))
+					{
+						tz.adv(2);
+						v1    = tz.current().asInt();
+						gotv1 = true;
+					}
+					else
+					{
+						tz.adv(2);
+						v2    = tz.current().asInt();
+						gotv2 = true;
+					}
+				}
+				else if (tz.checkNC("special"))
+					special = true;
+				else if (tz.checkNC("sideback"))
+					twosided = true;
+
+				tz.advUntil(";");
+				tz.adv();
+			}
+
+			if (!gotv1 || !gotv2)
+			{
+				error_ = fmt::format("Wrong line {} in UDMF map data", linecounter);
+				return false;
+			}
+
+			lines_.push_back({ v1, v2, twosided, special, false });
+			linecounter++;
+		}
+
+		tz.adv();
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads non-UDMF vertex data from [data] in [format]
+// -----------------------------------------------------------------------------
+bool MapPreviewData::readVertices(const MemChunk& data, MapFormat format)
+{
+	// Can't open a map without vertices
+	if (!data.hasData())
+		return false;
+
+	if (format == MapFormat::Doom64)
+	{
+		Doom64MapFormat::Vertex v;
+		for (unsigned a = 0; readStruct(data, a, v); ++a)
+			vertices_.emplace_back(static_cast<double>(v.x) / 65536, static_cast<double>(v.y) / 65536);
+	}
+	else if (format == MapFormat::Doom32X)
+	{
+		Doom32XMapFormat::Vertex32BE v;
+		for (unsigned a = 0; readStruct(data, a, v); ++a)
+			vertices_.emplace_back(
+				static_cast<double>(wxINT32_SWAP_ON_LE(v.x)) / 65536,
+				static_cast<double>(wxINT32_SWAP_ON_LE(v.y)) / 65536);
+	}
+	else
+	{
+		DoomMapFormat::Vertex v;
+		for (unsigned a = 0; readStruct(data, a, v); ++a)
+			vertices_.emplace_back(v.x, v.y);
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads non-UDMF line data from [data] in [format]
+// -----------------------------------------------------------------------------
+bool MapPreviewData::readLines(const MemChunk& data, MapFormat format)
+{
+	// Can't open a map without linedefs
+	if (!data.hasData())
+		return false;
+
+	if (format == MapFormat::Doom || format == MapFormat::Doom32X)
+	{
+		DoomMapFormat::LineDef l;
+		for (unsigned a = 0; readStruct(data, a, l); ++a)
+			lines_.push_back({ l.vertex1, l.vertex2, l.side2 != 0xFFFF, l.type > 0, false });
+	}
+	else if (format == MapFormat::Doom64)
+	{
+		Doom64MapFormat::LineDef l;
+		for (unsigned a = 0; readStruct(data, a, l); ++a)
+		{
+			// Doom64 macros are flagged in the line type
+			bool macro   = l.type > 0 && (l.type & 0x100);
+			bool special = l.type > 0 && !macro;
+			lines_.push_back({ l.vertex1, l.vertex2, l.side2 != 0xFFFF, special, macro });
+		}
+	}
+	else if (format == MapFormat::Hexen)
+	{
+		HexenMapFormat::LineDef l;
+		for (unsigned a = 0; readStruct(data, a, l); ++a)
+			lines_.push_back({ l.vertex1, l.vertex2, l.side2 != 0xFFFF, l.type > 0, false });
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads non-UDMF thing data from [data] in [format]
+// -----------------------------------------------------------------------------
+void MapPreviewData::readThings(const MemChunk& data, MapFormat format)
+{
+	if (format == MapFormat::Doom || format == MapFormat::Doom32X)
+	{
+		DoomMapFormat::Thing t;
+		for (unsigned a = 0; readStruct(data, a, t); ++a)
+			things_.emplace_back(t.x, t.y);
+	}
+	else if (format == MapFormat::Doom64)
+	{
+		Doom64MapFormat::Thing t;
+		for (unsigned a = 0; readStruct(data, a, t); ++a)
+			things_.emplace_back(t.x, t.y);
+	}
+	else if (format == MapFormat::Hexen)
+	{
+		HexenMapFormat::Thing t;
+		for (unsigned a = 0; readStruct(data, a, t); ++a)
+			things_.emplace_back(t.x, t.y);
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// MapPreviewData Class Static Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Gets the entry data needed to read a preview of [map] into [source], along
+// with a key identifying its content (for the cache).
+// Must be called on the main thread, returns false if the map is invalid
+// -----------------------------------------------------------------------------
+bool MapPreviewData::getSource(const Archive::MapDesc& map, Source& source)
+{
+	auto head = map.head.lock();
+	auto end  = map.end.lock();
+	if (!head)
+		return false;
+
+	// If this is a map in a zip, open it as a wad archive and use the
+	// (first) map within
+	unique_ptr<WadArchive> temp_archive;
+	auto                   format = map.format;
+	if (map.archive)
+	{
+		temp_archive = std::make_unique<WadArchive>();
+		if (!temp_archive->open(head->data()))
+			return false;
+
+		auto maps = temp_archive->detectMaps();
+		if (maps.empty())
+			return false;
+
+		head   = maps[0].head.lock();
+		end    = maps[0].end.lock();
+		format = maps[0].format;
+	}
+
+	source.name   = head->name();
+	source.format = format;
+
+	// Share the data of the map entries needed, and build the content key from
+	// their hashes
+	auto key = fmt::format("{}", static_cast<int>(format));
+	for (auto entry = head.get(); entry; entry = entry->nextEntry())
+	{
+		MemChunk* data = nullptr;
+		if (format == MapFormat::UDMF && entry->type() == EntryType::fromId("udmf_textmap"))
+			data = &source.textmap;
+		else if (entry->type() == EntryType::fromId("map_vertexes"))
+			data = &source.vertexes;
+		else if (entry->type() == EntryType::fromId("map_linedefs"))
+			data = &source.linedefs;
+		else if (entry->type() == EntryType::fromId("map_things"))
+			data = &source.things;
+		else if (entry->type() == EntryType::fromId("map_sidedefs"))
+			source.sidedefs_size = entry->size();
+		else if (entry->type() == EntryType::fromId("map_sectors"))
+			source.sectors_size = entry->size();
+
+		if (data && !data->hasData())
+		{
+			data->share(entry->data());
+			key += fmt::format(" {}", entry->contentHash());
+		}
+
+		// Exit loop if we've reached the end of the map entries
+		if (entry == end.get())
+			break;
+	}
+	key += fmt::format(" {} {}", source.sidedefs_size, source.sectors_size);
+
+	source.key = misc::hash64(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns preview data for [map], from the cache if it is unchanged since it
+// was last read, or null if it couldn't be read
+// -----------------------------------------------------------------------------
+shared_ptr<const MapPreviewData> MapPreviewData::load(const Archive::MapDesc& map)
+{
+	Source source;
+	if (!getSource(map, source))
+		return nullptr;
+
+	if (auto data = cached(source.key))
+		return data;
+
+	auto data = std::make_shared<MapPreviewData>();
+	if (!data->read(source))
+	{
+		log::error(data->error());
+		return nullptr;
+	}
+
+	addToCache(source.key, data);
+
+	return data;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the cached preview data for [key], or null if it isn't cached.
+// Can be used on any thread
+// -----------------------------------------------------------------------------
+shared_ptr<const MapPreviewData> MapPreviewData::cached(uint64_t key)
+{
+	std::lock_guard lock(cache_mutex);
+
+	for (auto i = cache.begin(); i != cache.end(); ++i)
+		if (i->first == key)
+		{
+			// Move to front (most recently used)
+			cache.splice(cache.begin(), cache, i);
+			return cache.front().second;
+		}
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [data] to the cache for [key], removing the least recently used
+// previews if the cache is full.
+// Can be used on any thread
+// -----------------------------------------------------------------------------
+void MapPreviewData::addToCache(uint64_t key, const shared_ptr<const MapPreviewData>& data)
+{
+	std::lock_guard lock(cache_mutex);
+
+	cache.remove_if([key](const auto& item) { return item.first == key; });
+	cache.emplace_front(key, data);
+	while (cache.size() > static_cast<size_t>(std::max<int>(map_preview_cache_size, 1)))
+		cache.pop_back();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the render style for map previews, from the colour configuration
+// -----------------------------------------------------------------------------
+MapPreviewData::RenderStyle MapPreviewData::viewStyle()
+{
+	RenderStyle style;
+	style.background   = colourconfig::colour("map_view_background");
+	style.line_1s      = colourconfig::colour("map_view_line_1s");
+	style.line_2s      = colourconfig::colour("map_view_line_2s");
+	style.line_special = colourconfig::colour("map_view_line_special");
+	style.line_macro   = colourconfig::colour("map_view_line_macro");
+	style.thickness    = 1.5f;
+	return style;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the render style for saved map images, from the colour configuration
+// -----------------------------------------------------------------------------
+MapPreviewData::RenderStyle MapPreviewData::imageStyle()
+{
+	RenderStyle style;
+	style.background   = colourconfig::colour("map_image_background");
+	style.line_1s      = colourconfig::colour("map_image_line_1s");
+	style.line_2s      = colourconfig::colour("map_image_line_2s");
+	style.line_special = colourconfig::colour("map_image_line_special");
+	style.line_macro   = colourconfig::colour("map_image_line_macro");
+	style.thickness    = map_image_thickness;
+	return style;
+}
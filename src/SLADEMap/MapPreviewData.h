@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Archive/Archive.h"
+#include "Utility/Colour.h"
+
+namespace slade
+{
+class SImage;
+
+// Basic map geometry (vertices, lines and things) read directly from map
+// entries, for previews and thumbnails without loading the full map
+class MapPreviewData
+{
+public:
+	struct Line
+	{
+		unsigned v1       = 0;
+		unsigned v2       = 0;
+		bool     twosided = false;
+		bool     special  = false;
+		bool     macro    = false;
+	};
+
+	// The map entry data needed to read a preview. The data is shared with the
+	// entries (see MemChunk::share), so it can be read on any thread
+	struct Source
+	{
+		uint64_t  key           = 0; // Identifies the map content (see getSource)
+		string    name;
+		MapFormat format        = MapFormat::Unknown;
+		MemChunk  vertexes;
+		MemChunk  linedefs;
+		MemChunk  things;
+		MemChunk  textmap;
+		unsigned  sidedefs_size = 0;
+		unsigned  sectors_size  = 0;
+	};
+
+	// Colours and line thickness to render with
+	struct RenderStyle
+	{
+		ColRGBA background;
+		ColRGBA line_1s;
+		ColRGBA line_2s;
+		ColRGBA line_special;
+		ColRGBA line_macro;
+		float   thickness = 1.5f;
+	};
+
+	const vector<Vec2d>& vertices() const { return vertices_; }
+	const vector<Line>&  lines() const { return lines_; }
+	const vector<Vec2d>& things() const { return things_; }
+	unsigned             nSides() const { return n_sides_; }
+	unsigned             nSectors() const { return n_sectors_; }
+	const string&        error() const { return error_; }
+
+	bool     read(const Source& source);
+	unsigned nVertices() const;
+	BBox     bounds() const;
+	void     render(SImage& image, int width, int height, const RenderStyle& style) const;
+
+	static bool                             getSource(const Archive::MapDesc& map, Source& source);
+	static shared_ptr<const MapPreviewData> load(const Archive::MapDesc& map);
+	static shared_ptr<const MapPreviewData> cached(uint64_t key);
+	static void                             addToCache(uint64_t key, const shared_ptr<const MapPreviewData>& data);
+	static RenderStyle                      viewStyle();
+	static RenderStyle                      imageStyle();
+
+private:
+	vector<Vec2d> vertices_;
+	vector<Line>  lines_;
+	vector<Vec2d> things_;
+	unsigned      n_sides_   = 0;
+	unsigned      n_sectors_ = 0;
+	string        error_;
+
+	bool readUDMF(const MemChunk& textmap, string_view name);
+	bool readVertices(const MemChunk& data, MapFormat format);
+	bool readLines(const MemChunk& data, MapFormat format);
+	void readThings(const MemChunk& data, MapFormat format);
+};
+} // namespace slade
@@ -0,0 +1,195 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapSnapshot.cpp
+// Description: MapSnapshot class - an immutable copy of a map's objects that
+//              background threads can read while the map is being edited
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapSnapshot.h"
+#include "App.h"
+#include "MapObject/MapLine.h"
+#include "MapObject/MapSide.h"
+#include "MapObject/MapThing.h"
+#include "MapObject/MapVertex.h"
+#include "SLADEMap.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Copies the common MapObject info from [object] to snapshot object [copy]
+// -----------------------------------------------------------------------------
+void copyObject(const MapObject& object, MapSnapshot::Object& copy)
+{
+	copy.obj_id        = object.objId();
+	copy.modified_time = object.modifiedTime();
+	copy.properties    = object.props();
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MapSnapshot Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the snapshot object of [type] at [index], or null if [index] is out
+// of range
+// -----------------------------------------------------------------------------
+const MapSnapshot::Object* MapSnapshot::object(MapObject::Type type, unsigned index) const
+{
+	switch (type)
+	{
+	case MapObject::Type::Vertex: return index < vertices_.size() ? &vertices_[index] : nullptr;
+	case MapObject::Type::Line: return index < lines_.size() ? &lines_[index] : nullptr;
+	case MapObject::Type::Side: return index < sides_.size() ? &sides_[index] : nullptr;
+	case MapObject::Type::Sector: return index < sectors_.size() ? &sectors_[index] : nullptr;
+	case MapObject::Type::Thing: return index < things_.size() ? &things_[index] : nullptr;
+	default: return nullptr;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the live object in [map] that the snapshot object of [type] at
+// [index] was copied from, if it is unchanged since the snapshot was created
+// (still in the map and not modified since). Returns null otherwise.
+// Note that this is conservative - an object modified in the same timer tick
+// the snapshot was created in is considered changed.
+// Must only be called from the UI thread
+// -----------------------------------------------------------------------------
+MapObject* MapSnapshot::liveObject(const SLADEMap& map, MapObject::Type type, unsigned index) const
+{
+	auto copy = object(type, index);
+	if (!copy)
+		return nullptr;
+
+	auto live = map.mapData().mapObjectById(copy->obj_id);
+	if (!live || live->objType() != type || live->modifiedTime() >= time_)
+		return nullptr;
+
+	return live;
+}
+
+// -----------------------------------------------------------------------------
+// Creates a snapshot of all objects in [map].
+// Must only be called from the UI thread
+// -----------------------------------------------------------------------------
+shared_ptr<const MapSnapshot> MapSnapshot::create(const SLADEMap& map)
+{
+	auto snapshot             = std::make_shared<MapSnapshot>();
+	snapshot->name_           = map.mapName();
+	snapshot->udmf_namespace_ = map.udmfNamespace();
+	snapshot->format_         = map.currentFormat();
+	snapshot->time_           = app::runTimer();
+
+	// Vertices
+	snapshot->vertices_.resize(map.nVertices());
+	for (unsigned a = 0; a < map.nVertices(); ++a)
+	{
+		auto  vertex = map.vertex(a);
+		auto& copy   = snapshot->vertices_[a];
+		copyObject(*vertex, copy);
+		copy.position = vertex->position();
+	}
+
+	// Lines
+	snapshot->lines_.resize(map.nLines());
+	for (unsigned a = 0; a < map.nLines(); ++a)
+	{
+		auto  line = map.line(a);
+		auto& copy = snapshot->lines_[a];
+		copyObject(*line, copy);
+		copy.v1      = line->v1Index();
+		copy.v2      = line->v2Index();
+		copy.s1      = line->s1Index();
+		copy.s2      = line->s2Index();
+		copy.special = line->special();
+		copy.id      = line->id();
+		copy.flags   = line->flags();
+		copy.args    = line->args();
+	}
+
+	// Sides
+	snapshot->sides_.resize(map.nSides());
+	for (unsigned a = 0; a < map.nSides(); ++a)
+	{
+		auto  side = map.side(a);
+		auto& copy = snapshot->sides_[a];
+		copyObject(*side, copy);
+		copy.sector     = side->sector() ? static_cast<int>(side->sector()->index()) : -1;
+		copy.line       = side->parentLine() ? static_cast<int>(side->parentLine()->index()) : -1;
+		copy.tex_upper  = side->texUpper();
+		copy.tex_middle = side->texMiddle();
+		copy.tex_lower  = side->texLower();
+		copy.tex_offset = side->texOffset();
+	}
+
+	// Sectors
+	snapshot->sectors_.resize(map.nSectors());
+	for (unsigned a = 0; a < map.nSectors(); ++a)
+	{
+		auto  sector = map.sector(a);
+		auto& copy   = snapshot->sectors_[a];
+		copyObject(*sector, copy);
+		copy.floor   = sector->floor();
+		copy.ceiling = sector->ceiling();
+		copy.light   = sector->lightLevel();
+		copy.special = sector->special();
+		copy.id      = sector->id();
+	}
+
+	// Things
+	snapshot->things_.resize(map.nThings());
+	for (unsigned a = 0; a < map.nThings(); ++a)
+	{
+		auto  thing = map.thing(a);
+		auto& copy  = snapshot->things_[a];
+		copyObject(*thing, copy);
+		copy.position = thing->position();
+		copy.z        = thing->zPos();
+		copy.type     = thing->type();
+		copy.angle    = thing->angle();
+		copy.flags    = thing->flags();
+		copy.id       = thing->id();
+		copy.special  = thing->special();
+		copy.args     = thing->args();
+	}
+
+	return snapshot;
+}
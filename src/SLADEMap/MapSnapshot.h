@@ -0,0 +1,105 @@
+#pragma once
+
+#include "MapObject/MapObject.h"
+#include "MapObject/MapSector.h"
+
+namespace slade
+{
+// An immutable copy of a map's objects at the time it was created, which can
+// be read from any thread while the map itself continues to be edited on the
+// UI thread. Objects are stored as plain values and refer to each other by
+// index (-1 for none). Results of work done on a snapshot can be reconciled
+// with the live map afterwards via liveObject (on the UI thread only)
+class MapSnapshot
+{
+public:
+	struct Object
+	{
+		unsigned         obj_id        = 0;
+		long             modified_time = 0;
+		MobjPropertyList properties;
+	};
+
+	struct Vertex : Object
+	{
+		Vec2d position;
+	};
+
+	struct Line : Object
+	{
+		int               v1      = -1;
+		int               v2      = -1;
+		int               s1      = -1;
+		int               s2      = -1;
+		int               special = 0;
+		int               id      = 0;
+		int               flags   = 0;
+		MapObject::ArgSet args    = {};
+	};
+
+	struct Side : Object
+	{
+		int    sector = -1;
+		int    line   = -1;
+		string tex_upper;
+		string tex_middle;
+		string tex_lower;
+		Vec2i  tex_offset;
+	};
+
+	struct Sector : Object
+	{
+		MapSector::Surface floor;
+		MapSector::Surface ceiling;
+		short              light   = 0;
+		short              special = 0;
+		short              id      = 0;
+	};
+
+	struct Thing : Object
+	{
+		Vec2d             position;
+		double            z       = 0.;
+		short             type    = 0;
+		short             angle   = 0;
+		int               flags   = 0;
+		int               id      = 0;
+		int               special = 0;
+		MapObject::ArgSet args    = {};
+	};
+
+	MapSnapshot()  = default;
+	~MapSnapshot() = default;
+
+	// Non-copyable
+	MapSnapshot(const MapSnapshot&)            = delete;
+	MapSnapshot& operator=(const MapSnapshot&) = delete;
+
+	const string&         mapName() const { return name_; }
+	const string&         udmfNamespace() const { return udmf_namespace_; }
+	MapFormat             format() const { return format_; }
+	long                  time() const { return time_; }
+	const vector<Vertex>& vertices() const { return vertices_; }
+	const vector<Line>&   lines() const { return lines_; }
+	const vector<Side>&   sides() const { return sides_; }
+	const vector<Sector>& sectors() const { return sectors_; }
+	const vector<Thing>&  things() const { return things_; }
+	const Object*         object(MapObject::Type type, unsigned index) const;
+
+	// Reconciliation (UI thread only)
+	MapObject* liveObject(const SLADEMap& map, MapObject::Type type, unsigned index) const;
+
+	static shared_ptr<const MapSnapshot> create(const SLADEMap& map);
+
+private:
+	string         name_;
+	string         udmf_namespace_;
+	MapFormat      format_ = MapFormat::Unknown;
+	long           time_   = 0; // The app::runTimer time the snapshot was created at
+	vector<Vertex> vertices_;
+	vector<Line>   lines_;
+	vector<Side>   sides_;
+	vector<Sector> sectors_;
+	vector<Thing>  things_;
+};
+} // namespace slade
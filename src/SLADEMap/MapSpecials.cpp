@@ -32,7 +32,10 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapSpecials.h"
+#include "App.h"
 #include "Game/Configuration.h"
+#include "General/Tasks.h"
+#include "General/Trace.h"
 #include "SLADEMap.h"
 #include "Utility/MathStuff.h"
 #include "Utility/Tokenizer.h"
@@ -50,11 +53,37 @@ using ExtraFloor  = MapSector::ExtraFloor;
 namespace
 {
 constexpr double TAU = math::PI * 2; // Number of radians in the unit circle
+
+// Number of slopes to calculate per task worker chunk (any fewer are just
+// calculated on the calling thread)
+constexpr unsigned PARALLEL_SLOPES_GRAIN = 64;
 } // namespace
 
 CVAR(Bool, map_process_3d_floors, false, CVar::Save)
 
 
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns a string identifying the current game/port and options that affect
+// how map specials are processed
+// -----------------------------------------------------------------------------
+string specialsMode()
+{
+	return fmt::format(
+		"{}/{}/{}",
+		game::configuration().currentGame(),
+		game::configuration().currentPort(),
+		map_process_3d_floors ? 1 : 0);
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MapSpecials Class Functions
@@ -69,7 +98,11 @@ void MapSpecials::reset()
 {
 	sector_colours_.clear();
 	sector_fadecolours_.clear();
+	acs_scripts_hash_.reset();
 	translucent_lines_.clear();
+	links_.clear();
+	affected_.clear();
+	processed_time_ = -1;
 }
 
 // -----------------------------------------------------------------------------
@@ -77,11 +110,57 @@ void MapSpecials::reset()
 // -----------------------------------------------------------------------------
 void MapSpecials::processMapSpecials(SLADEMap* map)
 {
+	links_.clear();
+	affected_.clear();
+	process_all_ = true;
+
+	processSpecials(map);
+}
+
+// -----------------------------------------------------------------------------
+// Updates map specials for any changes made to [map] since they were last
+// processed. Only the sectors that could be affected by the modified objects
+// (along with any sectors linked to them via specials) are reprocessed.
+// If objects have been added to or removed from the map since, or the
+// game/port has changed, everything is processed again
+// -----------------------------------------------------------------------------
+void MapSpecials::updateMapSpecials(SLADEMap* map)
+{
+	if (processed_time_ < 0 || map->mapData().objectsUpdated() >= processed_time_ || processed_mode_ != specialsMode())
+	{
+		processMapSpecials(map);
+		return;
+	}
+
+	// Nothing to do if nothing has changed
+	auto modified = map->mapData().modifiedObjects(processed_time_, MapObject::Type::Object);
+	if (modified.empty())
+		return;
+
+	if (!findAffectedSectors(map, modified))
+	{
+		processMapSpecials(map);
+		return;
+	}
+
+	process_all_ = false;
+	processSpecials(map);
+	process_all_ = true;
+	affected_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Process map specials for all affected sectors, depending on the current
+// game/port
+// -----------------------------------------------------------------------------
+void MapSpecials::processSpecials(SLADEMap* map)
+{
+	TRACE_ZONE("MapSpecials::processSpecials");
 
 	// Clear out all 3D floors, or every call to this function will create duplicates!
-	// TODO this isn't a very good solution, but we don't have incremental updates yet
 	for (unsigned a = 0; a < map->nSectors(); a++)
-		map->sector(a)->clearExtraFloors();
+		if (isAffected(map->sector(a)))
+			map->sector(a)->clearExtraFloors();
 
 	// ZDoom
 	if (game::configuration().currentPort() == "zdoom")
@@ -99,6 +178,9 @@ void MapSpecials::processMapSpecials(SLADEMap* map)
 	// EDGE-Classic
 	else if (game::configuration().currentPort() == "edge_classic")
 		processEDGEClassicSlopes(map);
+
+	processed_time_ = app::runTimer();
+	processed_mode_ = specialsMode();
 }
 
 // -----------------------------------------------------------------------------
@@ -217,6 +299,186 @@ bool MapSpecials::translucentLineAdditive(const MapLine* line) const
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Records that [sector] is affected by (or depends on) [object] when processing
+// specials, so it is reprocessed if [object] is modified
+// -----------------------------------------------------------------------------
+void MapSpecials::link(const MapObject* object, MapSector* sector) const
+{
+	if (!object || !sector || object == sector)
+		return;
+
+	auto& linked = links_[object];
+	if (std::find(linked.begin(), linked.end(), sector) == linked.end())
+		linked.push_back(sector);
+}
+
+// -----------------------------------------------------------------------------
+// Records that [sector1] and [sector2] depend on each other when processing
+// specials, so both are always reprocessed together
+// -----------------------------------------------------------------------------
+void MapSpecials::linkSectors(MapSector* sector1, MapSector* sector2) const
+{
+	link(sector1, sector2);
+	link(sector2, sector1);
+}
+
+// -----------------------------------------------------------------------------
+// Finds all sectors that need to be reprocessed due to changes to [modified]
+// objects, along with all sectors linked to them, and adds them to the
+// affected sectors list.
+// Returns false if everything needs to be reprocessed
+// -----------------------------------------------------------------------------
+bool MapSpecials::findAffectedSectors(const SLADEMap* map, const vector<MapObject*>& modified)
+{
+	vector<MapSector*> sectors;
+	vector<MapLine*>   lines;
+	vector<MapThing*>  things;
+
+	auto add_linked = [&](const MapObject* object)
+	{
+		auto i = links_.find(object);
+		if (i != links_.end())
+			sectors.insert(sectors.end(), i->second.begin(), i->second.end());
+	};
+	auto add_line = [&](const MapLine* line)
+	{
+		sectors.push_back(line->frontSector());
+		sectors.push_back(line->backSector());
+		add_linked(line);
+	};
+	auto add_thing = [&](const MapThing* thing)
+	{
+		sectors.push_back(map->sectors().atPos(thing->position()));
+		add_linked(thing);
+	};
+
+	// SRB2 vertex slope things are found by angle or side offsets rather than
+	// by id, so there's no easy way to tell which lines they could affect
+	bool srb2 = game::configuration().currentGame() == "srb2";
+
+	for (auto object : modified)
+	{
+		add_linked(object);
+
+		// Vertex: sectors of all lines attached to it
+		if (object->objType() == MapObject::Type::Vertex)
+		{
+			for (auto line : dynamic_cast<MapVertex*>(object)->connectedLines())
+				add_line(line);
+		}
+
+		// Line/Side: sectors on both sides of the line, and anything the line
+		// or things referencing its id could affect
+		else if (object->objType() == MapObject::Type::Line || object->objType() == MapObject::Type::Side)
+		{
+			MapLine* line;
+			if (object->objType() == MapObject::Type::Side)
+			{
+				auto side = dynamic_cast<MapSide*>(object);
+				sectors.push_back(side->sector());
+				line = side->parentLine();
+				if (!line)
+					continue;
+			}
+			else
+				line = dynamic_cast<MapLine*>(object);
+
+			if (srb2 && line->special() >= 700 && line->special() < 800)
+				return false;
+
+			add_line(line);
+
+			if (line->special() != 0)
+			{
+				if (line->id() != 0)
+					map->sectors().putAllWithId(line->id(), sectors);
+				for (unsigned arg = 0; arg < 5; arg++)
+					if (line->arg(arg) != 0)
+						map->sectors().putAllWithId(line->arg(arg), sectors);
+			}
+
+			things.clear();
+			map->things().putAllWithArg(line->id(), things);
+			for (auto thing : things)
+				add_thing(thing);
+		}
+
+		// Sector: the sector itself, and anything referencing its tag
+		else if (object->objType() == MapObject::Type::Sector)
+		{
+			auto sector = dynamic_cast<MapSector*>(object);
+			sectors.push_back(sector);
+
+			if (sector->id() == 0)
+				continue;
+
+			lines.clear();
+			map->lines().putAllWithId(sector->id(), lines);
+			map->lines().putAllWithArg(sector->id(), lines);
+			for (auto line : lines)
+				if (line->special() != 0)
+					add_line(line);
+
+			things.clear();
+			map->things().putAllWithArg(sector->id(), things);
+			for (auto thing : things)
+				if (thing->type() == 9510 || thing->type() == 9511)
+					add_thing(thing);
+		}
+
+		// Thing: the sector it's in, and anything it references
+		else if (object->objType() == MapObject::Type::Thing)
+		{
+			auto thing = dynamic_cast<MapThing*>(object);
+			if (srb2 && thing->type() == 750)
+				return false;
+
+			add_thing(thing);
+
+			if (thing->arg(0) != 0)
+			{
+				lines.clear();
+				map->lines().putAllWithId(thing->arg(0), lines);
+				for (auto line : lines)
+					add_line(line);
+
+				map->sectors().putAllWithId(thing->arg(0), sectors);
+			}
+
+			if (thing->type() == 1504 || thing->type() == 1505)
+			{
+				if (auto vertex = map->vertices().vertexAt(thing->xPos(), thing->yPos()))
+					for (auto line : vertex->connectedLines())
+						add_line(line);
+			}
+		}
+	}
+
+	// Add all sectors linked to the affected sectors
+	affected_.clear();
+	vector<MapSector*> to_check;
+	for (auto sector : sectors)
+		if (sector && affected_.insert(sector).second)
+			to_check.push_back(sector);
+
+	while (!to_check.empty())
+	{
+		auto sector = to_check.back();
+		to_check.pop_back();
+
+		auto i = links_.find(sector);
+		if (i == links_.end())
+			continue;
+
+		for (auto linked : i->second)
+			if (affected_.insert(linked).second)
+				to_check.push_back(linked);
+	}
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Updates any sectors with tags that are affected by any processed
 // specials/scripts
@@ -308,7 +570,12 @@ void MapSpecials::processZDoomLineSpecial(MapLine* line)
 		auto count = 0;
 		for (auto& sector : map->sectors())
 		{
-			if (sector->id() == sector_tag)
+			if (sector->id() != sector_tag)
+				continue;
+
+			link(line, sector);
+			linkSectors(sector, control_sector);
+			if (isAffected(sector))
 			{
 				sector->addExtraFloor(extra_floor, *control_sector);
 				count++;
@@ -343,15 +610,22 @@ void MapSpecials::processZDoomLineSpecial(MapLine* line)
 }
 
 // -----------------------------------------------------------------------------
-// Process 'OPEN' ACS scripts for various specials - sector colours, slopes, etc
+// Process 'OPEN' ACS scripts for various specials - sector colours, slopes, etc.
+// The scripts are only processed again if their content has changed since the
+// last call. Returns true if they were processed
 // -----------------------------------------------------------------------------
-void MapSpecials::processACSScripts(ArchiveEntry* entry)
+bool MapSpecials::processACSScripts(ArchiveEntry* entry)
 {
+	auto hash = entry && entry->size() > 0 ? entry->contentHash() : 0;
+	if (acs_scripts_hash_ == hash)
+		return false;
+	acs_scripts_hash_ = hash;
+
 	sector_colours_.clear();
 	sector_fadecolours_.clear();
 
 	if (!entry || entry->size() == 0)
-		return;
+		return true;
 
 	Tokenizer tz;
 	tz.setSpecialCharacters(";,:|={}/()");
@@ -469,6 +743,8 @@ void MapSpecials::processACSScripts(ArchiveEntry* entry)
 
 		tz.adv();
 	}
+
+	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -476,6 +752,7 @@ void MapSpecials::processACSScripts(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 void MapSpecials::processSRB2Slopes(const SLADEMap* map) const
 {
+	vector<PlaneSlope> slopes;
 	for (unsigned a = 0; a < map->nLines(); a++)
 	{
 		auto line = map->line(a);
@@ -490,40 +767,40 @@ void MapSpecials::processSRB2Slopes(const SLADEMap* map) const
 			//
 
 		case 700: // Front sector floor
-			applyPlaneAlign<SurfaceType::Floor>(line, front, back);
+			queuePlaneAlign(slopes, SurfaceType::Floor, line, front, back);
 			break;
 
 		case 701: // Front sector ceiling
-			applyPlaneAlign<SurfaceType::Ceiling>(line, front, back);
+			queuePlaneAlign(slopes, SurfaceType::Ceiling, line, front, back);
 			break;
 
 		case 702: // Front sector floor and ceiling
-			applyPlaneAlign<SurfaceType::Floor>(line, front, back);
-			applyPlaneAlign<SurfaceType::Ceiling>(line, front, back);
+			queuePlaneAlign(slopes, SurfaceType::Floor, line, front, back);
+			queuePlaneAlign(slopes, SurfaceType::Ceiling, line, front, back);
 			break;
 
 		case 703: // Front sector floor and back sector ceiling
-			applyPlaneAlign<SurfaceType::Floor>(line, front, back);
-			applyPlaneAlign<SurfaceType::Ceiling>(line, back, front);
+			queuePlaneAlign(slopes, SurfaceType::Floor, line, front, back);
+			queuePlaneAlign(slopes, SurfaceType::Ceiling, line, back, front);
 			break;
 
 
 		case 710: // Back sector floor
-			applyPlaneAlign<SurfaceType::Floor>(line, back, front);
+			queuePlaneAlign(slopes, SurfaceType::Floor, line, back, front);
 			break;
 
 		case 711: // Back sector ceiling
-			applyPlaneAlign<SurfaceType::Ceiling>(line, back, front);
+			queuePlaneAlign(slopes, SurfaceType::Ceiling, line, back, front);
 			break;
 
 		case 712: // Back sector floor and ceiling
-			applyPlaneAlign<SurfaceType::Floor>(line, back, front);
-			applyPlaneAlign<SurfaceType::Ceiling>(line, back, front);
+			queuePlaneAlign(slopes, SurfaceType::Floor, line, back, front);
+			queuePlaneAlign(slopes, SurfaceType::Ceiling, line, back, front);
 			break;
 
 		case 713: // Back sector floor and front sector ceiling
-			applyPlaneAlign<SurfaceType::Floor>(line, back, front);
-			applyPlaneAlign<SurfaceType::Ceiling>(line, front, back);
+			queuePlaneAlign(slopes, SurfaceType::Floor, line, back, front);
+			queuePlaneAlign(slopes, SurfaceType::Ceiling, line, front, back);
 			break;
 
 
@@ -549,6 +826,10 @@ void MapSpecials::processSRB2Slopes(const SLADEMap* map) const
 				break;
 			}
 
+			link(line, target);
+			if (!isAffected(target))
+				break;
+
 			auto sidedef = line->s1()->sector() == target ? line->s1() : line->s2();
 
 			Vec3d    vertices[3];
@@ -563,6 +844,7 @@ void MapSpecials::processSRB2Slopes(const SLADEMap* map) const
 						 || thing->angle() == sidedef->texOffsetY()))
 					|| thing->angle() == line->id())
 				{
+					link(thing, target);
 					vertices[count++] = Vec3d(thing->xPos(), thing->yPos(), thing->zPos());
 					if (count >= 3)
 						break;
@@ -578,14 +860,14 @@ void MapSpecials::processSRB2Slopes(const SLADEMap* map) const
 				break;
 			}
 
-			if (line->special() == 704 || line->special() == 714)
-				target->setPlane<SurfaceType::Floor>(math::planeFromTriangle(vertices[0], vertices[1], vertices[2]));
-			else
-				target->setPlane<SurfaceType::Ceiling>(math::planeFromTriangle(vertices[0], vertices[1], vertices[2]));
+			auto surface = line->special() == 704 || line->special() == 714 ? SurfaceType::Floor : SurfaceType::Ceiling;
+			slopes.push_back(
+				{ line, target, nullptr, surface, math::planeFromTriangle(vertices[0], vertices[1], vertices[2]) });
 		}
 		break;
 		}
 	}
+	applyPlaneSlopes(slopes);
 
 	// Copied slopes linedefs need to be processed right after the other slope linedefs to assure ordering
 	for (unsigned a = 0; a < map->nLines(); a++)
@@ -623,6 +905,11 @@ void MapSpecials::processSRB2Slopes(const SLADEMap* map) const
 				break;
 			}
 
+			link(line, front);
+			linkSectors(front, tagged);
+			if (!isAffected(front))
+				break;
+
 			if (line->special() == 720 || line->special() == 722)
 				front->setFloorPlane(tagged->floor().plane);
 
@@ -799,7 +1086,12 @@ void MapSpecials::processSRB2FOFs(const SLADEMap* map) const
 
 		for (auto& sector : map->sectors())
 		{
-			if (sector->id() == line->id())
+			if (sector->id() != line->id())
+				continue;
+
+			link(line, sector);
+			linkSectors(sector, control_sector);
+			if (isAffected(sector))
 				sector->addExtraFloor(extra_floor, *control_sector);
 		}
 	}
@@ -814,6 +1106,9 @@ void MapSpecials::processEDGEClassicSlopes(SLADEMap* map) const
 	for (unsigned a = 0; a < map->nSectors(); a++)
 	{
 		auto target = map->sector(a);
+		if (!isAffected(target))
+			continue;
+
 		target->setPlane<SurfaceType::Floor>(Plane::flat(target->planeHeight<SurfaceType::Floor>()));
 		target->setPlane<SurfaceType::Ceiling>(Plane::flat(target->planeHeight<SurfaceType::Ceiling>()));
 	}
@@ -823,25 +1118,7 @@ void MapSpecials::processEDGEClassicSlopes(SLADEMap* map) const
 	// Vertex heights -- only applies for sectors with exactly three vertices,
 	// or sectors with exactly four vertices that also fulfill other criteria.
 	// Heights are set by UDMF properties.
-	vector<MapVertex*> vertices;
-	for (unsigned a = 0; a < map->nSectors(); a++)
-	{
-		auto target = map->sector(a);
-		vertices.clear();
-		target->putVertices(vertices);
-		if (vertices.size() == 4)
-		{
-			applyRectangularVertexHeightSlope<SurfaceType::Floor>(target, vertices, vertex_floor_heights);
-			applyRectangularVertexHeightSlope<SurfaceType::Ceiling>(target, vertices, vertex_ceiling_heights);
-		}
-		else if (vertices.size() == 3)
-		{
-			applyVertexHeightSlope<SurfaceType::Floor>(target, vertices, vertex_floor_heights);
-			applyVertexHeightSlope<SurfaceType::Ceiling>(target, vertices, vertex_ceiling_heights);
-		}
-		else
-			continue;
-	}
+	applyVertexHeightSlopes(map, vertex_floor_heights, vertex_ceiling_heights, true);
 }
 
 // -----------------------------------------------------------------------------
@@ -863,6 +1140,9 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 	for (unsigned a = 0; a < map->nSectors(); a++)
 	{
 		auto target = map->sector(a);
+		if (!isAffected(target))
+			continue;
+
 		target->setPlane<SurfaceType::Floor>(Plane::flat(target->planeHeight<SurfaceType::Floor>()));
 		target->setPlane<SurfaceType::Ceiling>(Plane::flat(target->planeHeight<SurfaceType::Ceiling>()));
 	}
@@ -870,7 +1150,10 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 	// Floor/ceiling plane properties
 	for (unsigned a = 0; a < map->nSectors(); a++)
 	{
-		auto target        = map->sector(a);
+		auto target = map->sector(a);
+		if (!isAffected(target))
+			continue;
+
 		auto floorplane    = Plane::flat(target->floor().height);
 		bool hasFloorplane = false;
 		// Check for floor plane.
@@ -933,6 +1216,7 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 	}
 
 	// Plane_Align (line special 181)
+	vector<PlaneSlope> slopes;
 	for (unsigned a = 0; a < map->nLines(); a++)
 	{
 		auto line = map->line(a);
@@ -954,16 +1238,17 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 
 		int floor_arg = line->arg(0);
 		if (floor_arg == 1)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector1, sector2);
+			queuePlaneAlign(slopes, SurfaceType::Floor, line, sector1, sector2);
 		else if (floor_arg == 2)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector2, sector1);
+			queuePlaneAlign(slopes, SurfaceType::Floor, line, sector2, sector1);
 
 		int ceiling_arg = line->arg(1);
 		if (ceiling_arg == 1)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector1, sector2);
+			queuePlaneAlign(slopes, SurfaceType::Ceiling, line, sector1, sector2);
 		else if (ceiling_arg == 2)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector2, sector1);
+			queuePlaneAlign(slopes, SurfaceType::Ceiling, line, sector2, sector1);
 	}
+	applyPlaneSlopes(slopes);
 
 	// Line slope things (9500/9501), sector tilt things (9502/9503), and
 	// vavoom things (1500/1501), all in the same pass
@@ -999,6 +1284,10 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 			if (!target)
 				continue;
 
+			link(thing, target);
+			if (!isAffected(target))
+				continue;
+
 			// First argument is the tag of a sector whose slope should be copied
 			int tag = thing->arg(0);
 			if (!tag)
@@ -1015,6 +1304,7 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 				continue;
 			}
 
+			linkSectors(target, tagged_sector);
 			if (thing->type() == 9510)
 				target->setFloorPlane(tagged_sector->floor().plane);
 			else
@@ -1037,6 +1327,12 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 			auto vertex = map->vertices().vertexAt(thing->xPos(), thing->yPos());
 			if (vertex)
 			{
+				for (auto line : vertex->connectedLines())
+				{
+					link(thing, line->frontSector());
+					link(thing, line->backSector());
+				}
+
 				if (thing->type() == 1504)
 					vertex_floor_heights[vertex] = thing->zPos();
 				else if (thing->type() == 1505)
@@ -1048,18 +1344,7 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 	// Vertex heights -- only applies for sectors with exactly three vertices.
 	// Heights may be set by UDMF properties, or by a vertex height thing
 	// placed exactly on the vertex (which takes priority over the prop).
-	vector<MapVertex*> vertices;
-	for (unsigned a = 0; a < map->nSectors(); a++)
-	{
-		auto target = map->sector(a);
-		vertices.clear();
-		target->putVertices(vertices);
-		if (vertices.size() != 3)
-			continue;
-
-		applyVertexHeightSlope<SurfaceType::Floor>(target, vertices, vertex_floor_heights);
-		applyVertexHeightSlope<SurfaceType::Ceiling>(target, vertices, vertex_ceiling_heights);
-	}
+	applyVertexHeightSlopes(map, vertex_floor_heights, vertex_ceiling_heights, false);
 
 	// Plane_Copy
 	for (unsigned a = 0; a < map->nLines(); a++)
@@ -1068,46 +1353,7 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 		if (line->special() != 118)
 			continue;
 
-		int  tag;
-		auto front = line->frontSector();
-		auto back  = line->backSector();
-		if ((tag = line->arg(0)) && front)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setFloorPlane(sector->floor().plane);
-		}
-		if ((tag = line->arg(1)) && front)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setCeilingPlane(sector->ceiling().plane);
-		}
-		if ((tag = line->arg(2)) && back)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				back->setFloorPlane(sector->floor().plane);
-		}
-		if ((tag = line->arg(3)) && back)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				back->setCeilingPlane(sector->ceiling().plane);
-		}
-
-		// The fifth "share" argument copies from one side of the line to the
-		// other
-		if (front && back)
-		{
-			int share = line->arg(4);
-
-			if ((share & 3) == 1)
-				back->setFloorPlane(front->floor().plane);
-			else if ((share & 3) == 2)
-				front->setFloorPlane(back->floor().plane);
-
-			if ((share & 12) == 4)
-				back->setCeilingPlane(front->ceiling().plane);
-			else if ((share & 12) == 8)
-				front->setCeilingPlane(back->ceiling().plane);
-		}
+		applyPlaneCopy(map, line);
 	}
 }
 
@@ -1126,11 +1372,15 @@ void MapSpecials::processEternitySlopes(const SLADEMap* map) const
 	for (unsigned a = 0; a < map->nSectors(); a++)
 	{
 		auto target = map->sector(a);
+		if (!isAffected(target))
+			continue;
+
 		target->setPlane<SurfaceType::Floor>(Plane::flat(target->planeHeight<SurfaceType::Floor>()));
 		target->setPlane<SurfaceType::Ceiling>(Plane::flat(target->planeHeight<SurfaceType::Ceiling>()));
 	}
 
 	// Plane_Align (line special 181)
+	vector<PlaneSlope> slopes;
 	for (unsigned a = 0; a < map->nLines(); a++)
 	{
 		auto line = map->line(a);
@@ -1152,16 +1402,17 @@ void MapSpecials::processEternitySlopes(const SLADEMap* map) const
 
 		int floor_arg = line->arg(0);
 		if (floor_arg == 1)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector1, sector2);
+			queuePlaneAlign(slopes, SurfaceType::Floor, line, sector1, sector2);
 		else if (floor_arg == 2)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector2, sector1);
+			queuePlaneAlign(slopes, SurfaceType::Floor, line, sector2, sector1);
 
 		int ceiling_arg = line->arg(1);
 		if (ceiling_arg == 1)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector1, sector2);
+			queuePlaneAlign(slopes, SurfaceType::Ceiling, line, sector1, sector2);
 		else if (ceiling_arg == 2)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector2, sector1);
+			queuePlaneAlign(slopes, SurfaceType::Ceiling, line, sector2, sector1);
 	}
+	applyPlaneSlopes(slopes);
 
 	// Plane_Copy
 	vector<MapSector*> sectors;
@@ -1171,53 +1422,132 @@ void MapSpecials::processEternitySlopes(const SLADEMap* map) const
 		if (line->special() != 118)
 			continue;
 
-		int  tag;
-		auto front = line->frontSector();
-		auto back  = line->backSector();
-		if ((tag = line->arg(0)) && front)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setFloorPlane(sector->floor().plane);
-		}
-		if ((tag = line->arg(1)) && front)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setCeilingPlane(sector->ceiling().plane);
-		}
-		if ((tag = line->arg(2)) && back)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				back->setFloorPlane(sector->floor().plane);
-		}
-		if ((tag = line->arg(3)) && back)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				back->setCeilingPlane(sector->ceiling().plane);
-		}
+		applyPlaneCopy(map, line);
+	}
+}
 
-		// The fifth "share" argument copies from one side of the line to the
-		// other
-		if (front && back)
-		{
-			int share = line->arg(4);
+// -----------------------------------------------------------------------------
+// Applies a Plane_Copy special on [line] in [map]
+// -----------------------------------------------------------------------------
+void MapSpecials::applyPlaneCopy(const SLADEMap* map, MapLine* line) const
+{
+	auto front = line->frontSector();
+	auto back  = line->backSector();
+	link(line, front);
+	link(line, back);
 
-			if ((share & 3) == 1)
-				back->setFloorPlane(front->floor().plane);
-			else if ((share & 3) == 2)
-				front->setFloorPlane(back->floor().plane);
+	// Copies the [surface] plane of the sector tagged [tag] to [target]
+	auto copy_tagged = [this, map](SurfaceType surface, int tag, MapSector* target)
+	{
+		if (!tag || !target)
+			return;
 
-			if ((share & 12) == 4)
-				back->setCeilingPlane(front->ceiling().plane);
-			else if ((share & 12) == 8)
-				front->setCeilingPlane(back->ceiling().plane);
-		}
+		auto sector = map->sectors().firstWithId(tag);
+		if (!sector)
+			return;
+
+		linkSectors(target, sector);
+		if (!isAffected(target))
+			return;
+
+		if (surface == SurfaceType::Floor)
+			target->setFloorPlane(sector->floor().plane);
+		else
+			target->setCeilingPlane(sector->ceiling().plane);
+	};
+
+	copy_tagged(SurfaceType::Floor, line->arg(0), front);
+	copy_tagged(SurfaceType::Ceiling, line->arg(1), front);
+	copy_tagged(SurfaceType::Floor, line->arg(2), back);
+	copy_tagged(SurfaceType::Ceiling, line->arg(3), back);
+
+	// The fifth "share" argument copies from one side of the line to the
+	// other
+	if (front && back)
+	{
+		linkSectors(front, back);
+		if (!isAffected(front))
+			return;
+
+		int share = line->arg(4);
+
+		if ((share & 3) == 1)
+			back->setFloorPlane(front->floor().plane);
+		else if ((share & 3) == 2)
+			front->setFloorPlane(back->floor().plane);
+
+		if ((share & 12) == 4)
+			back->setCeilingPlane(front->ceiling().plane);
+		else if ((share & 12) == 8)
+			front->setCeilingPlane(back->ceiling().plane);
 	}
 }
 
 // -----------------------------------------------------------------------------
-// Applies a Plane_Align special on [line], to [target] from [model]
+// Applies vertex height slopes to all (affected) triangular sectors in [map],
+// and also rectangular sectors if [rectangular] is true.
+// Each sector's slopes are independent of any others, so they are calculated
+// in parallel and then applied in sector order
 // -----------------------------------------------------------------------------
-template<SurfaceType T> void MapSpecials::applyPlaneAlign(MapLine* line, MapSector* target, MapSector* model) const
+void MapSpecials::applyVertexHeightSlopes(
+	const SLADEMap*        map,
+	const VertexHeightMap& floor_heights,
+	const VertexHeightMap& ceiling_heights,
+	bool                   rectangular) const
+{
+	struct SectorSlopes
+	{
+		MapSector*           sector;
+		std::optional<Plane> floor;
+		std::optional<Plane> ceiling;
+	};
+
+	vector<SectorSlopes> slopes;
+	for (unsigned a = 0; a < map->nSectors(); a++)
+		if (isAffected(map->sector(a)))
+			slopes.push_back({ map->sector(a), {}, {} });
+
+	tasks::parallelFor(
+		0,
+		slopes.size(),
+		[&](unsigned index)
+		{
+			auto&              slope = slopes[index];
+			vector<MapVertex*> vertices;
+			slope.sector->putVertices(vertices);
+			if (vertices.size() == 3)
+			{
+				slope.floor   = vertexHeightSlope<SurfaceType::Floor>(slope.sector, vertices, floor_heights);
+				slope.ceiling = vertexHeightSlope<SurfaceType::Ceiling>(slope.sector, vertices, ceiling_heights);
+			}
+			else if (rectangular && vertices.size() == 4)
+			{
+				slope.floor = rectangularVertexHeightSlope<SurfaceType::Floor>(slope.sector, vertices, floor_heights);
+				slope.ceiling = rectangularVertexHeightSlope<SurfaceType::Ceiling>(
+					slope.sector, vertices, ceiling_heights);
+			}
+		},
+		PARALLEL_SLOPES_GRAIN);
+
+	for (auto& slope : slopes)
+	{
+		if (slope.floor)
+			slope.sector->setFloorPlane(*slope.floor);
+		if (slope.ceiling)
+			slope.sector->setCeilingPlane(*slope.ceiling);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds a Plane_Align special on [line] for the [surface] of [target] from
+// [model] to [slopes], to be calculated and applied by applyPlaneSlopes
+// -----------------------------------------------------------------------------
+void MapSpecials::queuePlaneAlign(
+	vector<PlaneSlope>& slopes,
+	SurfaceType         surface,
+	MapLine*            line,
+	MapSector*          target,
+	MapSector*          model) const
 {
 	if (!model || !target) // Do nothing, ignore
 	{
@@ -1225,6 +1555,61 @@ template<SurfaceType T> void MapSpecials::applyPlaneAlign(MapLine* line, MapSect
 		return;
 	}
 
+	link(line, target);
+	linkSectors(target, model);
+	if (isAffected(target))
+		slopes.push_back({ line, target, model, surface, {} });
+}
+
+// -----------------------------------------------------------------------------
+// Calculates all Plane_Align [slopes] that need it (in parallel, since they
+// only depend on sector heights and geometry), then applies all [slopes] in
+// order so the last one for each sector surface wins
+// -----------------------------------------------------------------------------
+void MapSpecials::applyPlaneSlopes(vector<PlaneSlope>& slopes) const
+{
+	tasks::parallelFor(
+		0,
+		slopes.size(),
+		[&slopes, this](unsigned index)
+		{
+			auto& slope = slopes[index];
+			if (!slope.model)
+				return;
+
+			if (slope.surface == SurfaceType::Floor)
+				slope.plane = planeAlignSlope<SurfaceType::Floor>(slope.line, slope.target, slope.model);
+			else
+				slope.plane = planeAlignSlope<SurfaceType::Ceiling>(slope.line, slope.target, slope.model);
+		},
+		PARALLEL_SLOPES_GRAIN);
+
+	for (auto& slope : slopes)
+	{
+		if (!slope.plane)
+		{
+			log::warning(
+				"Ignoring Plane_Align on line {}; sector {} has no appropriate reference vertex",
+				slope.line->index(),
+				slope.target->index());
+			continue;
+		}
+
+		if (slope.surface == SurfaceType::Floor)
+			slope.target->setFloorPlane(*slope.plane);
+		else
+			slope.target->setCeilingPlane(*slope.plane);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the plane for a Plane_Align special on [line], to [target] from
+// [model], or nothing if [target] has no vertex to use as a reference.
+// This doesn't modify anything, so is safe to call from multiple threads
+// -----------------------------------------------------------------------------
+template<SurfaceType T>
+std::optional<Plane> MapSpecials::planeAlignSlope(MapLine* line, MapSector* target, MapSector* model) const
+{
 	vector<MapVertex*> vertices;
 	target->putVertices(vertices);
 
@@ -1270,13 +1655,7 @@ template<SurfaceType T> void MapSpecials::applyPlaneAlign(MapLine* line, MapSect
 	}
 
 	if (!furthest_vertex || furthest_dist < 0.01)
-	{
-		log::warning(
-			"Ignoring Plane_Align on line {}; sector {} has no appropriate reference vertex",
-			line->index(),
-			target->index());
-		return;
-	}
+		return {};
 
 	// Calculate slope plane from our three points: this line's endpoints
 	// (at the model sector's height) and the found vertex (at this sector's height).
@@ -1287,7 +1666,7 @@ template<SurfaceType T> void MapSpecials::applyPlaneAlign(MapLine* line, MapSect
 	Vec3d p2(v2_pos, modelz);
 	Vec3d p3(furthest_vertex->position(), targetz);
 
-	target->setPlane<T>(math::planeFromTriangle(p1, p2, p3));
+	return math::planeFromTriangle(p1, p2, p3);
 }
 
 // -----------------------------------------------------------------------------
@@ -1319,6 +1698,11 @@ template<SurfaceType T> void MapSpecials::applyLineSlopeThing(SLADEMap* map, Map
 		if (!target)
 			continue;
 
+		link(thing, target);
+		link(line, target);
+		if (!isAffected(target))
+			continue;
+
 		// Need to know the containing sector's height to find the thing's true height
 		if (!containing_sector)
 		{
@@ -1327,6 +1711,7 @@ template<SurfaceType T> void MapSpecials::applyLineSlopeThing(SLADEMap* map, Map
 				return;
 			thingz = containing_sector->plane<T>().heightAt(thing->position()) + thing->zPos();
 		}
+		linkSectors(target, containing_sector);
 
 		// Three points: endpoints of the line, and the thing itself
 		auto  target_plane = target->plane<T>();
@@ -1348,6 +1733,10 @@ template<SurfaceType T> void MapSpecials::applySectorTiltThing(SLADEMap* map, Ma
 	if (!target)
 		return;
 
+	link(thing, target);
+	if (!isAffected(target))
+		return;
+
 	// First argument is the tilt angle, but starting with 0 as straight down;
 	// subtracting 90 fixes that.
 	int raw_angle = thing->arg(0);
@@ -1391,6 +1780,10 @@ template<SurfaceType T> void MapSpecials::applyVavoomSlopeThing(SLADEMap* map, M
 	if (!target)
 		return;
 
+	link(thing, target);
+	if (!isAffected(target))
+		return;
+
 	int              tid = thing->id();
 	vector<MapLine*> lines;
 	target->putLines(lines);
@@ -1438,12 +1831,14 @@ template<SurfaceType T> double MapSpecials::vertexHeight(MapVertex* vertex, MapS
 }
 
 // -----------------------------------------------------------------------------
-// Applies a slope to sector [target] based on the heights of its vertices
-// (triangular sectors only)
+// Returns the slope for sector [target] based on the heights of its vertices
+// (triangular sectors only), or nothing if no vertices have a height set
 // -----------------------------------------------------------------------------
 template<SurfaceType T>
-void MapSpecials::applyVertexHeightSlope(MapSector* target, vector<MapVertex*>& vertices, VertexHeightMap& heights)
-	const
+std::optional<Plane> MapSpecials::vertexHeightSlope(
+	MapSector*                target,
+	const vector<MapVertex*>& vertices,
+	const VertexHeightMap&    heights) const
 {
 	string prop         = (T == SurfaceType::Floor ? "zfloor" : "zceiling");
 	auto   v1_hasheight = heights.count(vertices[0]) || vertices[0]->hasProp(prop);
@@ -1452,25 +1847,28 @@ void MapSpecials::applyVertexHeightSlope(MapSector* target, vector<MapVertex*>&
 
 	// Ignore if no vertices have a height set
 	if (!v1_hasheight && !v2_hasheight && !v3_hasheight)
-		return;
+		return {};
 
-	double z1 = heights.count(vertices[0]) ? heights[vertices[0]] : vertexHeight<T>(vertices[0], target);
-	double z2 = heights.count(vertices[1]) ? heights[vertices[1]] : vertexHeight<T>(vertices[1], target);
-	double z3 = heights.count(vertices[2]) ? heights[vertices[2]] : vertexHeight<T>(vertices[2], target);
+	double z1 = heights.count(vertices[0]) ? heights.at(vertices[0]) : vertexHeight<T>(vertices[0], target);
+	double z2 = heights.count(vertices[1]) ? heights.at(vertices[1]) : vertexHeight<T>(vertices[1], target);
+	double z3 = heights.count(vertices[2]) ? heights.at(vertices[2]) : vertexHeight<T>(vertices[2], target);
 
 	Vec3d p1(vertices[0]->xPos(), vertices[0]->yPos(), z1);
 	Vec3d p2(vertices[1]->xPos(), vertices[1]->yPos(), z2);
 	Vec3d p3(vertices[2]->xPos(), vertices[2]->yPos(), z3);
-	target->setPlane<T>(math::planeFromTriangle(p1, p2, p3));
+	return math::planeFromTriangle(p1, p2, p3);
 }
 
 // -----------------------------------------------------------------------------
-// Applies a slope to sector [target] based on the heights of its vertices
-// (EDGE-Classic rectangular sectors only; performs additional validation)
+// Returns the slope for sector [target] based on the heights of its vertices
+// (EDGE-Classic rectangular sectors only; performs additional validation), or
+// nothing if it doesn't qualify
 // -----------------------------------------------------------------------------
 template<SurfaceType T>
-void MapSpecials::applyRectangularVertexHeightSlope(MapSector* target, vector<MapVertex*>& vertices, VertexHeightMap& heights)
-	const
+std::optional<Plane> MapSpecials::rectangularVertexHeightSlope(
+	MapSector*                target,
+	const vector<MapVertex*>& vertices,
+	const VertexHeightMap&    heights) const
 {
 	std::vector<int> height_verts;
 	string prop         = (T == SurfaceType::Floor ? "zfloor" : "zceiling");
@@ -1503,7 +1901,7 @@ void MapSpecials::applyRectangularVertexHeightSlope(MapSector* target, vector<Ma
 		if (same_line)
 		{
 			// The zfloor/zceiling values must be equal
-			if (fabs(heights.count(v1) ? heights[v1] : vertexHeight<T>(v1, target) - heights.count(v2) ? heights[v2] : vertexHeight<T>(v2, target)) < 0.001f)
+			if (fabs(heights.count(v1) ? heights.at(v1) : vertexHeight<T>(v1, target) - heights.count(v2) ? heights.at(v2) : vertexHeight<T>(v2, target)) < 0.001f)
 			{
 				// Psuedo-Plane_Align routine
 				double     furthest_dist   = 0.0;
@@ -1522,19 +1920,21 @@ void MapSpecials::applyRectangularVertexHeightSlope(MapSector* target, vector<Ma
 				}
 
 				if (!furthest_vertex || furthest_dist < 0.01)
-					return;
+					return {};
 
 				// Calculate slope plane from our three points: this line's endpoints
 				// (at the model sector's height) and the found vertex (at this sector's height).
-				double modelz  = heights.count(v1) ? heights[v1] : vertexHeight<T>(v1, target);
+				double modelz  = heights.count(v1) ? heights.at(v1) : vertexHeight<T>(v1, target);
 				double targetz = target->planeHeight<T>();
 
 				Vec3d p1(v1->position(), modelz);
 				Vec3d p2(v2->position(), modelz);
 				Vec3d p3(furthest_vertex->position(), targetz);
 
-				target->setPlane<T>(math::planeFromTriangle(p1, p2, p3));
+				return math::planeFromTriangle(p1, p2, p3);
 			}
 		}
 	}
+
+	return {};
 }
\ No newline at end of file
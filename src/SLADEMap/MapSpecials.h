@@ -1,9 +1,11 @@
 #pragma once
 
 #include "SLADEMap/MapObject/MapSector.h"
+#include <unordered_set>
 
 namespace slade
 {
+class MapObject;
 class MapVertex;
 class MapThing;
 class MapLine;
@@ -16,6 +18,7 @@ public:
 	void reset();
 
 	void processMapSpecials(SLADEMap* map);
+	void updateMapSpecials(SLADEMap* map);
 	void processLineSpecial(MapLine* line);
 
 	bool tagColour(int tag, ColRGBA* colour) const;
@@ -27,7 +30,7 @@ public:
 	// ZDoom
 	void   processZDoomMapSpecials(SLADEMap* map);
 	void   processZDoomLineSpecial(MapLine* line);
-	void   processACSScripts(ArchiveEntry* entry);
+	bool   processACSScripts(ArchiveEntry* entry);
 	void   setModified(const SLADEMap* map, int tag) const;
 	bool   lineIsTranslucent(const MapLine* line) const;
 	double translucentLineAlpha(const MapLine* line) const;
@@ -47,13 +50,39 @@ private:
 		bool     additive;
 	};
 
-	typedef std::map<MapVertex*, double> VertexHeightMap;
+	// A slope to apply to the [surface] of [target] from a line special. If
+	// [model] is set, it's a Plane_Align that still needs [plane] calculated
+	struct PlaneSlope
+	{
+		MapLine*               line;
+		MapSector*             target;
+		MapSector*             model;
+		MapSector::SurfaceType surface;
+		std::optional<Plane>   plane;
+	};
+
+	typedef std::map<MapVertex*, double>                             VertexHeightMap;
+	typedef std::unordered_map<const MapObject*, vector<MapSector*>> LinkMap;
 
-	vector<SectorColour> sector_colours_;
-	vector<SectorColour> sector_fadecolours_;
+	vector<SectorColour>    sector_colours_;
+	vector<SectorColour>    sector_fadecolours_;
+	std::optional<uint64_t> acs_scripts_hash_; // Content hash of the scripts the colours were read from
 
 	vector<TranslucentLine> translucent_lines_;
 
+	// Incremental updates
+	mutable LinkMap                links_; // Sectors each processed object/sector affects or depends on
+	std::unordered_set<MapSector*> affected_;
+	bool                           process_all_    = true;
+	long                           processed_time_ = -1;
+	string                         processed_mode_;
+
+	void processSpecials(SLADEMap* map);
+	bool isAffected(MapSector* sector) const { return process_all_ || affected_.count(sector) > 0; }
+	void link(const MapObject* object, MapSector* sector) const;
+	void linkSectors(MapSector* sector1, MapSector* sector2) const;
+	bool findAffectedSectors(const SLADEMap* map, const vector<MapObject*>& modified);
+
 	void processZDoomSlopes(SLADEMap* map) const;
 	void processEternitySlopes(const SLADEMap* map) const;
 
@@ -61,15 +90,35 @@ private:
 	void processSRB2FOFs(const SLADEMap* map) const;
 	void processEDGEClassicSlopes(SLADEMap* map) const;
 
+	void applyPlaneCopy(const SLADEMap* map, MapLine* line) const;
+	void applyVertexHeightSlopes(
+		const SLADEMap*        map,
+		const VertexHeightMap& floor_heights,
+		const VertexHeightMap& ceiling_heights,
+		bool                   rectangular) const;
+	void queuePlaneAlign(
+		vector<PlaneSlope>&    slopes,
+		MapSector::SurfaceType surface,
+		MapLine*               line,
+		MapSector*             target,
+		MapSector*             model) const;
+	void applyPlaneSlopes(vector<PlaneSlope>& slopes) const;
+
 	template<MapSector::SurfaceType>
-	void applyPlaneAlign(MapLine* line, MapSector* target, MapSector* model_sector) const;
+	std::optional<Plane> planeAlignSlope(MapLine* line, MapSector* target, MapSector* model_sector) const;
 	template<MapSector::SurfaceType> void   applyLineSlopeThing(SLADEMap* map, MapThing* thing) const;
 	template<MapSector::SurfaceType> void   applySectorTiltThing(SLADEMap* map, MapThing* thing) const;
 	template<MapSector::SurfaceType> void   applyVavoomSlopeThing(SLADEMap* map, MapThing* thing) const;
 	template<MapSector::SurfaceType> double vertexHeight(MapVertex* vertex, MapSector* sector) const;
 	template<MapSector::SurfaceType>
-	void applyVertexHeightSlope(MapSector* target, vector<MapVertex*>& vertices, VertexHeightMap& heights) const;
+	std::optional<Plane> vertexHeightSlope(
+		MapSector*                target,
+		const vector<MapVertex*>& vertices,
+		const VertexHeightMap&    heights) const;
 	template<MapSector::SurfaceType>
-	void applyRectangularVertexHeightSlope(MapSector* target, vector<MapVertex*>& vertices, VertexHeightMap& heights) const;
+	std::optional<Plane> rectangularVertexHeightSlope(
+		MapSector*                target,
+		const vector<MapVertex*>& vertices,
+		const VertexHeightMap&    heights) const;
 };
 } // namespace slade
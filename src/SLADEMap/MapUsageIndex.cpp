@@ -0,0 +1,761 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapUsageIndex.cpp
+// Description: MapUsageIndex class - an index of the textures, flats and thing
+//              types used by each map in an archive, read directly from the
+//              map lumps
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapUsageIndex.h"
+#include "App.h"
+#include "Archive/ArchiveEntry.h"
+#include "Archive/ArchiveManager.h"
+#include "Archive/EntryType/EntryType.h"
+#include "Archive/Formats/WadArchive.h"
+#include "General/Console.h"
+#include "General/Misc.h"
+#include "MainEditor/MainEditor.h"
+#include "SLADEMap/MapFormat/Doom64MapFormat.h"
+#include "SLADEMap/MapFormat/DoomMapFormat.h"
+#include "SLADEMap/MapFormat/HexenMapFormat.h"
+#include "Utility/StringUtils.h"
+#include "Utility/Tokenizer.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+std::map<Archive*, unique_ptr<MapUsageIndex>> archive_indexes;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+using NameCounts = std::unordered_map<NameKey, unsigned>;
+
+// The map lump data needed to index a map. The data is shared with the entries
+// (see MemChunk::share), so it can be read on any thread
+struct MapSource
+{
+	MapFormat format = MapFormat::Unknown;
+	MemChunk  sidedefs;
+	MemChunk  sectors;
+	MemChunk  things;
+	MemChunk  textmap;
+};
+
+// -----------------------------------------------------------------------------
+// Returns the data in [source] that map entry [entry] should be read into, or
+// null if it isn't a lump that is indexed
+// -----------------------------------------------------------------------------
+MemChunk* sourceData(MapSource& source, ArchiveEntry* entry)
+{
+	if (entry->type() == EntryType::fromId("map_sidedefs"))
+		return &source.sidedefs;
+	if (entry->type() == EntryType::fromId("map_sectors"))
+		return &source.sectors;
+	if (entry->type() == EntryType::fromId("map_things"))
+		return &source.things;
+	if (entry->type() == EntryType::fromId("udmf_textmap"))
+		return &source.textmap;
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a key identifying the content of the indexed lumps in [source], so
+// unchanged maps don't need to be scanned again. Can be used on any thread
+// -----------------------------------------------------------------------------
+uint64_t sourceKey(const MapSource& source)
+{
+	auto key = fmt::format("{}", static_cast<int>(source.format));
+	for (auto data : { &source.sidedefs, &source.sectors, &source.things, &source.textmap })
+		key += fmt::format(" {}", misc::hash64(data->data(), data->size()));
+
+	return misc::hash64(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+}
+
+// -----------------------------------------------------------------------------
+// Returns a key identifying the content of the wad containing [map] (a map in
+// a zip), so unchanged wads don't need to be opened again.
+// Must be called from the UI thread
+// -----------------------------------------------------------------------------
+uint64_t wadMapKey(const Archive::MapDesc& map)
+{
+	auto head = map.head.lock();
+	if (!head)
+		return 0;
+
+	auto key = fmt::format("{} wad {}", static_cast<int>(map.format), head->contentHash());
+	return misc::hash64(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+}
+
+// -----------------------------------------------------------------------------
+// Gets the data of the indexed lumps in [map] into [source], loading it if
+// needed. If the map is in a zip, the (first) map in its wad is used.
+// Must be called from the UI thread
+// -----------------------------------------------------------------------------
+bool loadSource(const Archive::MapDesc& map, MapSource& source)
+{
+	auto head = map.head.lock();
+	auto end  = map.end.lock();
+	if (!head)
+		return false;
+
+	unique_ptr<WadArchive> temp_archive;
+	source.format = map.format;
+	if (map.archive)
+	{
+		temp_archive = std::make_unique<WadArchive>();
+		if (!temp_archive->open(head->data()))
+			return false;
+
+		auto maps = temp_archive->detectMaps();
+		if (maps.empty())
+			return false;
+
+		head          = maps[0].head.lock();
+		end           = maps[0].end.lock();
+		source.format = maps[0].format;
+	}
+
+	for (auto entry = head.get(); entry; entry = entry->nextEntry())
+	{
+		auto data = sourceData(source, entry);
+		if (data && !data->hasData())
+			data->share(entry->data());
+
+		// Exit loop if we've reached the end of the map entries
+		if (entry == end.get())
+			break;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Adds 1 to the count of [name] in [counts], unless it is empty
+// -----------------------------------------------------------------------------
+void countName(NameCounts& counts, string_view name)
+{
+	NameKey key{ name };
+	if (!key.empty())
+		++counts[key];
+}
+
+// -----------------------------------------------------------------------------
+// Counts the texture names used by the sides in SIDEDEFS lump [data]
+// -----------------------------------------------------------------------------
+void countSideTextures(const MemChunk& data, NameCounts& counts)
+{
+	DoomMapFormat::SideDef sdef;
+	const auto             n_sides = data.size() / sizeof(DoomMapFormat::SideDef);
+	for (unsigned s = 0; s < n_sides; s++)
+	{
+		memcpy(&sdef, data.data() + s * sizeof(DoomMapFormat::SideDef), sizeof(DoomMapFormat::SideDef));
+		countName(counts, strutil::viewFromChars(sdef.tex_lower, 8));
+		countName(counts, strutil::viewFromChars(sdef.tex_middle, 8));
+		countName(counts, strutil::viewFromChars(sdef.tex_upper, 8));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Counts the flat names used by the sectors in SECTORS lump [data]
+// -----------------------------------------------------------------------------
+void countSectorFlats(const MemChunk& data, NameCounts& counts)
+{
+	DoomMapFormat::Sector sec;
+	const auto            n_sectors = data.size() / sizeof(DoomMapFormat::Sector);
+	for (unsigned s = 0; s < n_sectors; s++)
+	{
+		memcpy(&sec, data.data() + s * sizeof(DoomMapFormat::Sector), sizeof(DoomMapFormat::Sector));
+		countName(counts, strutil::viewFromChars(sec.f_tex, 8));
+		countName(counts, strutil::viewFromChars(sec.c_tex, 8));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Counts the types of the things (of struct type T) in THINGS lump [data]
+// -----------------------------------------------------------------------------
+template<typename T> void countThingTypes(const MemChunk& data, std::unordered_map<int, unsigned>& counts)
+{
+	T          thing;
+	const auto n_things = data.size() / sizeof(T);
+	for (unsigned t = 0; t < n_things; t++)
+	{
+		memcpy(&thing, data.data() + t * sizeof(T), sizeof(T));
+		++counts[wxINT16_SWAP_ON_BE(thing.type)];
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Counts the texture names used by sidedefs, the flat names used by sectors
+// and the types of things in UDMF TEXTMAP [data], adding them to [usage]
+// -----------------------------------------------------------------------------
+void countUDMFUsage(const MemChunk& data, MapUsageIndex::MapUsage& usage)
+{
+	Tokenizer tz;
+	tz.setSpecialCharacters("{};=");
+	tz.openMem(data, "UDMF TEXTMAP");
+
+	// Go through text tokens
+	auto token = tz.getToken();
+	while (!token.empty())
+	{
+		// Check for sidedef/sector/thing definition
+		const bool side   = token == "sidedef";
+		const bool sector = token == "sector";
+		const bool thing  = token == "thing";
+		if (side || sector || thing)
+		{
+			tz.getToken(); // Skip {
+
+			token = tz.getToken();
+			while (!token.empty() && token != "}")
+			{
+				// Check for texture/type property
+				if (side && (token == "texturetop" || token == "texturemiddle" || token == "texturebottom"))
+				{
+					tz.getToken(); // Skip =
+					countName(usage.textures, tz.getToken());
+				}
+				else if (sector && (token == "texturefloor" || token == "textureceiling"))
+				{
+					tz.getToken(); // Skip =
+					countName(usage.flats, tz.getToken());
+				}
+				else if (thing && token == "type")
+				{
+					tz.getToken(); // Skip =
+					++usage.things[strutil::asInt(tz.getToken())];
+				}
+
+				token = tz.getToken();
+			}
+		}
+
+		// Next token
+		token = tz.getToken();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Counts the textures, flats and thing types used in the map lumps in
+// [source], adding them to [usage]. Can be used on any thread
+// -----------------------------------------------------------------------------
+void scanMap(const MapSource& source, MapUsageIndex::MapUsage& usage)
+{
+	switch (source.format)
+	{
+	case MapFormat::Doom:
+	case MapFormat::Doom32X:
+		countSideTextures(source.sidedefs, usage.textures);
+		countSectorFlats(source.sectors, usage.flats);
+		countThingTypes<DoomMapFormat::Thing>(source.things, usage.things);
+		break;
+	case MapFormat::Hexen:
+		countSideTextures(source.sidedefs, usage.textures);
+		countSectorFlats(source.sectors, usage.flats);
+		countThingTypes<HexenMapFormat::Thing>(source.things, usage.things);
+		break;
+	case MapFormat::Doom64: countThingTypes<Doom64MapFormat::Thing>(source.things, usage.things); break;
+	case MapFormat::UDMF:   countUDMFUsage(source.textmap, usage); break;
+	default:                break;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the total of the counts for [key] in [maps] (using the [counts]
+// member of each), skipping any map named [exclude_map]
+// -----------------------------------------------------------------------------
+template<typename K>
+unsigned totalUsage(
+	const vector<MapUsageIndex::MapUsage>&                          maps,
+	std::unordered_map<K, unsigned> MapUsageIndex::MapUsage::*counts,
+	const K&                                                        key,
+	string_view                                                     exclude_map)
+{
+	unsigned total = 0;
+	for (const auto& map : maps)
+	{
+		if (!exclude_map.empty() && strutil::equalCI(map.name, exclude_map))
+			continue;
+
+		auto i = (map.*counts).find(key);
+		if (i != (map.*counts).end())
+			total += i->second;
+	}
+
+	return total;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the names of the [maps] using [key] (in the [counts] member of each)
+// -----------------------------------------------------------------------------
+template<typename K>
+vector<string> mapsUsing(
+	const vector<MapUsageIndex::MapUsage>&                          maps,
+	std::unordered_map<K, unsigned> MapUsageIndex::MapUsage::*counts,
+	const K&                                                        key)
+{
+	vector<string> names;
+	for (const auto& map : maps)
+		if ((map.*counts).count(key) > 0)
+			names.push_back(map.name);
+
+	return names;
+}
+
+// -----------------------------------------------------------------------------
+// Returns all names used in any of [maps] (in the [counts] member of each)
+// -----------------------------------------------------------------------------
+std::unordered_set<NameKey> usedNames(
+	const vector<MapUsageIndex::MapUsage>& maps,
+	NameCounts MapUsageIndex::MapUsage::*counts)
+{
+	std::unordered_set<NameKey> names;
+	for (const auto& map : maps)
+		for (const auto& count : map.*counts)
+			names.insert(count.first);
+
+	return names;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MapUsageIndex::Scan Struct
+//
+// -----------------------------------------------------------------------------
+
+
+// The maps detected for an update of a MapUsageIndex, and the lumps to scan for
+// any that are new or may have changed. Shared with the scan task
+struct MapUsageIndex::Scan
+{
+	vector<MapUsage>                       maps;    // Usage info for each map (in archive order)
+	vector<MapSource>                      sources; // Lumps of each map to scan (if any)
+	vector<unsigned>                       to_scan; // Indices of the maps to scan
+	std::unordered_map<uint64_t, MapUsage> old;     // Usage info from the last update, by key
+
+	void scanIndex(unsigned index);
+	void scanAll(const tasks::Task* task);
+};
+
+// -----------------------------------------------------------------------------
+// Scans the lumps of map [index], unless they are the same as a map in the
+// last update (maps in zips are checked in prepareScan instead).
+// Can be used on any thread
+// -----------------------------------------------------------------------------
+void MapUsageIndex::Scan::scanIndex(unsigned index)
+{
+	auto& usage  = maps[index];
+	auto& source = sources[index];
+
+	if (usage.key == 0)
+	{
+		usage.key = sourceKey(source);
+		if (auto i = std::as_const(old).find(usage.key); i != old.end())
+		{
+			auto name  = std::move(usage.name);
+			auto head  = usage.head;
+			usage      = i->second;
+			usage.name = std::move(name);
+			usage.head = head;
+			source     = {};
+			return;
+		}
+	}
+
+	scanMap(source, usage);
+	source = {};
+}
+
+// -----------------------------------------------------------------------------
+// Scans all maps to be scanned, in parallel on the task workers. Stops early
+// if [task] is given and gets cancelled
+// -----------------------------------------------------------------------------
+void MapUsageIndex::Scan::scanAll(const tasks::Task* task)
+{
+	tasks::parallelFor(0, to_scan.size(), [this](unsigned i) { scanIndex(to_scan[i]); }, 1, task);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// MapUsageIndex Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// MapUsageIndex class constructor. The index is empty until it is first
+// updated (see update/updateNow)
+// -----------------------------------------------------------------------------
+MapUsageIndex::MapUsageIndex(Archive& archive) : archive_{ &archive }
+{
+	// Track entry changes
+	auto& signals = archive.signals();
+	signal_connections_ += signals.entry_added.connect([this](Archive&, ArchiveEntry&) { changed_ = true; });
+	signal_connections_ += signals.entry_state_changed.connect([this](Archive&, ArchiveEntry&) { changed_ = true; });
+	signal_connections_ += signals.entry_removed.connect(
+		[this](Archive&, ArchiveDir&, ArchiveEntry&) { changed_ = true; });
+	signal_connections_ += signals.entries_changed.connect(
+		[this](Archive&, const Archive::EntryChanges&) { changed_ = true; });
+}
+
+// -----------------------------------------------------------------------------
+// MapUsageIndex class destructor
+// -----------------------------------------------------------------------------
+MapUsageIndex::~MapUsageIndex()
+{
+	// The scan task only refers to its own scan state, but its continuation
+	// mustn't update this index once it's gone
+	cancelScan();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the usage info of all maps in the archive
+// -----------------------------------------------------------------------------
+const vector<MapUsageIndex::MapUsage>& MapUsageIndex::maps()
+{
+	update();
+	return maps_;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the usage info of the map with header entry [head] (or the wad entry
+// for maps in zips), or null if it isn't a map in the archive
+// -----------------------------------------------------------------------------
+const MapUsageIndex::MapUsage* MapUsageIndex::mapUsage(const ArchiveEntry* head)
+{
+	update();
+	for (const auto& map : maps_)
+		if (map.head.lock().get() == head)
+			return &map;
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of times texture [name] is used on sides in all maps,
+// excluding any map named [exclude_map]
+// -----------------------------------------------------------------------------
+unsigned MapUsageIndex::textureUsage(string_view name, string_view exclude_map)
+{
+	update();
+	return totalUsage(maps_, &MapUsage::textures, NameKey{ name }, exclude_map);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of times flat [name] is used on sectors in all maps,
+// excluding any map named [exclude_map]
+// -----------------------------------------------------------------------------
+unsigned MapUsageIndex::flatUsage(string_view name, string_view exclude_map)
+{
+	update();
+	return totalUsage(maps_, &MapUsage::flats, NameKey{ name }, exclude_map);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of things of [type] in all maps, excluding any map named
+// [exclude_map]
+// -----------------------------------------------------------------------------
+unsigned MapUsageIndex::thingUsage(int type, string_view exclude_map)
+{
+	update();
+	return totalUsage(maps_, &MapUsage::things, type, exclude_map);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the names of all maps using texture [name] on any side
+// -----------------------------------------------------------------------------
+vector<string> MapUsageIndex::mapsUsingTexture(string_view name)
+{
+	update();
+	return mapsUsing(maps_, &MapUsage::textures, NameKey{ name });
+}
+
+// -----------------------------------------------------------------------------
+// Returns the names of all maps using flat [name] on any sector
+// -----------------------------------------------------------------------------
+vector<string> MapUsageIndex::mapsUsingFlat(string_view name)
+{
+	update();
+	return mapsUsing(maps_, &MapUsage::flats, NameKey{ name });
+}
+
+// -----------------------------------------------------------------------------
+// Returns the names of all maps containing things of [type]
+// -----------------------------------------------------------------------------
+vector<string> MapUsageIndex::mapsUsingThing(int type)
+{
+	update();
+	return mapsUsing(maps_, &MapUsage::things, type);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the names of all textures used on sides in any map
+// -----------------------------------------------------------------------------
+std::unordered_set<NameKey> MapUsageIndex::usedTextures()
+{
+	update();
+	return usedNames(maps_, &MapUsage::textures);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the names of all flats used on sectors in any map
+// -----------------------------------------------------------------------------
+std::unordered_set<NameKey> MapUsageIndex::usedFlats()
+{
+	update();
+	return usedNames(maps_, &MapUsage::flats);
+}
+
+// -----------------------------------------------------------------------------
+// Starts updating the index in the background if anything in the archive has
+// changed since it was last updated (and it isn't already being updated).
+// Must be called from the UI thread
+// -----------------------------------------------------------------------------
+void MapUsageIndex::update()
+{
+	if (!changed_ || scanning_)
+		return;
+	changed_ = false;
+
+	auto scan  = prepareScan();
+	scanning_  = true;
+	scan_task_ = tasks::run(
+		[scan](const tasks::Task& task) { scan->scanAll(&task); },
+		tasks::Priority::Low,
+		[this, scan](const tasks::Task& task)
+		{
+			// Cancelled tasks were superseded (see cancelScan)
+			if (task.isCancelled())
+				return;
+
+			maps_.swap(scan->maps);
+			scanning_ = false;
+
+			// Update again if anything changed while scanning
+			update();
+		});
+}
+
+// -----------------------------------------------------------------------------
+// Detects the maps in the archive and gets the lumps to scan for any that are
+// new or have changed since the last update. Usage info for unchanged maps in
+// zips is copied here, for other maps it's done by the scan (see scanIndex)
+// since their lumps need hashing to check.
+// Must be called from the UI thread
+// -----------------------------------------------------------------------------
+shared_ptr<MapUsageIndex::Scan> MapUsageIndex::prepareScan() const
+{
+	auto scan = std::make_shared<Scan>();
+	for (const auto& usage : maps_)
+		scan->old.emplace(usage.key, usage);
+
+	for (const auto& map : archive_->detectMaps())
+	{
+		auto& usage  = scan->maps.emplace_back();
+		auto& source = scan->sources.emplace_back();
+		usage.name   = map.name;
+		usage.head   = map.head;
+
+		if (map.archive)
+		{
+			usage.key = wadMapKey(map);
+			if (auto old = scan->old.find(usage.key); old != scan->old.end())
+			{
+				usage      = old->second;
+				usage.name = map.name;
+				usage.head = map.head;
+				continue;
+			}
+		}
+
+		if (!loadSource(map, source))
+			continue;
+
+		usage.format = source.format;
+		scan->to_scan.push_back(scan->maps.size() - 1);
+	}
+
+	return scan;
+}
+
+// -----------------------------------------------------------------------------
+// Cancels the background update (if any), it will need to be done again
+// -----------------------------------------------------------------------------
+void MapUsageIndex::cancelScan()
+{
+	if (!scanning_)
+		return;
+
+	scan_task_.cancel();
+	scanning_ = false;
+	changed_  = true;
+}
+
+// -----------------------------------------------------------------------------
+//
+// MapUsageIndex Static Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the map usage index for [archive], creating it (and beginning to
+// build it in the background) if needed. Returns null if [archive] isn't open
+// in the archive manager, since indexes are only removed when their archive is
+// closed (a temporary index can be created directly instead)
+// -----------------------------------------------------------------------------
+MapUsageIndex* MapUsageIndex::forArchive(Archive& archive)
+{
+	if (app::archiveManager().archiveIndex(&archive) < 0)
+		return nullptr;
+
+	auto& index = archive_indexes[&archive];
+	if (!index)
+	{
+		index = std::make_unique<MapUsageIndex>(archive);
+
+		// Remove the index when the archive is closed
+		index->signal_connections_ += archive.signals().closed.connect(
+			[](Archive& closed) { archive_indexes.erase(&closed); });
+
+		// Begin building it once whatever is creating it is done (the index
+		// may have been removed again by then)
+		tasks::callOnUIThread(
+			[archive = &archive]
+			{
+				if (auto i = archive_indexes.find(archive); i != archive_indexes.end() && i->second)
+					i->second->update();
+			});
+	}
+
+	return index.get();
+}
+
+// -----------------------------------------------------------------------------
+// Brings all [indexes] up to date now. The changed maps of all indexes are
+// scanned together, in parallel on the task workers and this thread.
+// Any background updates in progress are cancelled and done here instead.
+// Must be called from the UI thread
+// -----------------------------------------------------------------------------
+void MapUsageIndex::updateNow(const vector<MapUsageIndex*>& indexes)
+{
+	vector<std::pair<MapUsageIndex*, shared_ptr<Scan>>> scans;
+	vector<std::pair<Scan*, unsigned>>                  jobs;
+	for (auto index : indexes)
+	{
+		index->cancelScan();
+		if (!index->changed_)
+			continue;
+		index->changed_ = false;
+
+		auto scan = index->prepareScan();
+		for (auto map_index : scan->to_scan)
+			jobs.emplace_back(scan.get(), map_index);
+		scans.emplace_back(index, scan);
+	}
+
+	tasks::parallelFor(0, jobs.size(), [&jobs](unsigned job) { jobs[job].first->scanIndex(jobs[job].second); });
+
+	for (auto& [index, scan] : scans)
+		index->maps_.swap(scan->maps);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Lists the maps in the current archive that use the given texture/flat name,
+// or thing type (with -thing)
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(mapusage, 1, true)
+{
+	auto archive = maineditor::currentArchive();
+	auto index   = archive ? MapUsageIndex::forArchive(*archive) : nullptr;
+	if (!index)
+	{
+		log::console("No archive open");
+		return;
+	}
+	index->updateNow();
+
+	// Thing type
+	if (args[0] == "-thing")
+	{
+		int type = args.size() > 1 ? strutil::asInt(args[1]) : 0;
+		for (const auto& map : index->maps())
+			if (auto i = map.things.find(type); i != map.things.end())
+				log::console(fmt::format("{}: {} thing(s)", map.name, i->second));
+
+		log::console(fmt::format("Type {} used by {} thing(s) in total", type, index->thingUsage(type)));
+		return;
+	}
+
+	// Texture/flat name
+	NameKey key{ args[0] };
+	for (const auto& map : index->maps())
+	{
+		auto tex  = map.textures.find(key);
+		auto flat = map.flats.find(key);
+		if (tex != map.textures.end() || flat != map.flats.end())
+			log::console(fmt::format(
+				"{}: {} side texture(s), {} sector texture(s)",
+				map.name,
+				tex != map.textures.end() ? tex->second : 0,
+				flat != map.flats.end() ? flat->second : 0));
+	}
+
+	log::console(fmt::format(
+		"{} used {} time(s) as a texture and {} time(s) as a flat in total",
+		args[0],
+		index->textureUsage(args[0]),
+		index->flatUsage(args[0])));
+}
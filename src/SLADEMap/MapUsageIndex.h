@@ -0,0 +1,88 @@
+#pragma once
+
+#include "General/Defs.h"
+#include "General/Sigslot.h"
+#include "General/Tasks.h"
+#include "Utility/NameKey.h"
+#include <unordered_set>
+
+namespace slade
+{
+class Archive;
+class ArchiveEntry;
+
+// An index of the textures, flats and thing types used by each map in an
+// archive, for answering questions like 'which maps use texture X' without
+// loading any maps. The names/types are read straight from the map lumps
+// (SIDEDEFS, SECTORS, THINGS and TEXTMAP), including maps in wads within zip
+// archives.
+//
+// The map lumps are scanned in parallel on the task workers (see tasks::run).
+// Entry data can only be loaded on the UI thread, so that part is done when an
+// update starts, and only for maps whose lumps have changed. Queries start an
+// update in the background if any entries in the archive have changed, and
+// return the previous results until it is done (isReady() is false until
+// then). Use updateNow() first where the results must be up to date.
+// Doom64 format maps only have their things indexed, since their sides and
+// sectors reference textures by hash rather than by name
+class MapUsageIndex
+{
+public:
+	struct MapUsage
+	{
+		string                                name;
+		weak_ptr<ArchiveEntry>                head;
+		uint64_t                              key    = 0; // Identifies the map lump content
+		MapFormat                             format = MapFormat::Unknown;
+		std::unordered_map<NameKey, unsigned> textures;
+		std::unordered_map<NameKey, unsigned> flats;
+		std::unordered_map<int, unsigned>     things;
+	};
+
+	explicit MapUsageIndex(Archive& archive);
+	~MapUsageIndex();
+
+	// Non-copyable (the scan task refers to it)
+	MapUsageIndex(const MapUsageIndex&)            = delete;
+	MapUsageIndex& operator=(const MapUsageIndex&) = delete;
+
+	bool isReady() const { return !scanning_ && !changed_; }
+
+	void update();
+	void updateNow() { updateNow({ this }); }
+
+	const vector<MapUsage>& maps();
+	const MapUsage*         mapUsage(const ArchiveEntry* head);
+
+	unsigned       textureUsage(string_view name, string_view exclude_map = {});
+	unsigned       flatUsage(string_view name, string_view exclude_map = {});
+	unsigned       thingUsage(int type, string_view exclude_map = {});
+	vector<string> mapsUsingTexture(string_view name);
+	vector<string> mapsUsingFlat(string_view name);
+	vector<string> mapsUsingThing(int type);
+
+	std::unordered_set<NameKey> usedTextures();
+	std::unordered_set<NameKey> usedFlats();
+
+	static MapUsageIndex* forArchive(Archive& archive);
+	static void           updateNow(const vector<MapUsageIndex*>& indexes);
+
+private:
+	struct Scan;
+
+	Archive*         archive_;
+	vector<MapUsage> maps_;
+
+	// Background update
+	tasks::Task scan_task_;
+	bool        scanning_ = false;
+
+	// Set when any entry in the archive changes (and initially), the maps are
+	// updated on the next query
+	bool                 changed_ = true;
+	ScopedConnectionList signal_connections_;
+
+	shared_ptr<Scan> prepareScan() const;
+	void             cancelScan();
+};
+} // namespace slade
@@ -34,8 +34,10 @@
 #include "App.h"
 #include "Archive/Formats/WadArchive.h"
 #include "Game/Configuration.h"
+#include "General/Trace.h"
 #include "MapEditor/SectorBuilder.h"
 #include "MapFormat/MapFormatHandler.h"
+#include "MapSnapshot.h"
 #include "Utility/MathStuff.h"
 
 using namespace slade;
@@ -49,6 +51,25 @@ using namespace slade;
 CVAR(Bool, map_split_auto_offset, true, CVar::Flag::Save)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Adds [object] to [list] if it isn't already in [added] (which should contain
+// everything in [list])
+// -----------------------------------------------------------------------------
+template<class T> void addUnique(vector<T*>& list, std::unordered_set<T*>& added, T* object)
+{
+	if (added.insert(object).second)
+		list.push_back(object);
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // SLADEMap Class Functions
@@ -105,11 +126,22 @@ void SLADEMap::setThingsUpdated()
 	things_updated_ = app::runTimer();
 }
 
+// -----------------------------------------------------------------------------
+// Returns the most recent time anything in the map was modified, added or
+// removed
+// -----------------------------------------------------------------------------
+long SLADEMap::lastChanged() const
+{
+	return std::max({ data_.lastModifiedTime(), geometry_updated_, things_updated_ });
+}
+
 // -----------------------------------------------------------------------------
 // Reads map data using info in [map]
 // -----------------------------------------------------------------------------
 bool SLADEMap::readMap(const Archive::MapDesc& map)
 {
+	TRACE_ZONE("SLADEMap::readMap", map.name);
+
 	auto omap = map;
 
 	// Check for map archive
@@ -184,52 +216,204 @@ void SLADEMap::clearMap()
 	udmf_extra_entries_.clear();
 }
 
+// -----------------------------------------------------------------------------
+// Returns an immutable snapshot of all objects in the map, which can be read
+// from other threads (see MapSnapshot::create)
+// -----------------------------------------------------------------------------
+shared_ptr<const MapSnapshot> SLADEMap::snapshot() const
+{
+	return MapSnapshot::create(*this);
+}
+
 // -----------------------------------------------------------------------------
 // Returns a bounding box for the entire map.
 // If [include_things] is true, the bounding box will include things, otherwise
-// it will be for sectors (vertices) only
+// it will be for sectors (vertices) only.
+// The bounds are cached, and kept up to date from the modification journal
+// (see updateBounds)
 // -----------------------------------------------------------------------------
 BBox SLADEMap::bounds(bool include_things)
 {
-	auto bbox = data_.sectors().allSectorBounds();
+	updateBounds();
+
+	auto bbox = sector_bounds_.bbox;
 
-	if (include_things)
-		bbox.extend(data_.things().allThingBounds());
+	if (include_things && thing_bounds_.count > 0)
+		bbox.extend(thing_bounds_.bbox);
 
 	return bbox;
 }
 
 // -----------------------------------------------------------------------------
-// Updates geometry info (polygons/bbox/etc) for anything modified since
-// [modified_time]
+// Updates the cached map bounds for any objects modified since they were last
+// updated. Modified objects are added to the bounds, and the bounds are only
+// recalculated from scratch if an object at one of their edges was modified
+// (since it may have moved inward), objects were added or removed, or lines
+// or sides were modified (which can change which vertices are in sectors)
 // -----------------------------------------------------------------------------
-void SLADEMap::updateGeometryInfo(long modified_time)
+void SLADEMap::updateBounds()
 {
-	for (auto& vertex : data_.vertices())
+	const auto modified_time   = data_.lastModifiedTime();
+	const auto objects_updated = data_.objectsUpdated();
+	if (modified_time == bounds_time_ && objects_updated == bounds_objects_updated_)
+		return;
+
+	// Check modified objects (if no objects were added or removed)
+	if (objects_updated != bounds_objects_updated_)
+	{
+		sector_bounds_.valid = false;
+		thing_bounds_.valid  = false;
+	}
+	else
 	{
-		if (vertex->modifiedTime() > modified_time)
+		for (auto* object : data_.allModifiedObjects(bounds_time_))
 		{
-			for (auto* line : vertex->connected_lines_)
+			switch (object->objType())
 			{
-				// Update line geometry
-				line->resetInternals();
-
-				// Update front sector
-				if (line->frontSector())
+			case MapObject::Type::Vertex:
+				if (sector_bounds_.isEdge(object->objId()))
+					sector_bounds_.valid = false;
+				else if (sector_bounds_.valid)
 				{
-					line->frontSector()->resetPolygon();
-					line->frontSector()->updateBBox();
+					auto vertex = dynamic_cast<MapVertex*>(object);
+					for (auto* line : vertex->connectedLines())
+					{
+						if (line->frontSector() || line->backSector())
+						{
+							sector_bounds_.extend(vertex->position(), vertex->objId());
+							break;
+						}
+					}
 				}
+				break;
+			case MapObject::Type::Line:
+			case MapObject::Type::Side: sector_bounds_.valid = false; break;
+			case MapObject::Type::Thing:
+				if (thing_bounds_.isEdge(object->objId()))
+					thing_bounds_.valid = false;
+				else if (thing_bounds_.valid)
+					thing_bounds_.extend(dynamic_cast<MapThing*>(object)->position(), object->objId());
+				break;
+			default: break;
+			}
+		}
+	}
 
-				// Update back sector
-				if (line->backSector())
+	// Recalculate sector bounds from all vertices in sectors if needed
+	if (!sector_bounds_.valid)
+	{
+		sector_bounds_ = {};
+		for (const auto& vertex : data_.vertices())
+		{
+			for (auto* line : vertex->connectedLines())
+			{
+				if (line->frontSector() || line->backSector())
 				{
-					line->backSector()->resetPolygon();
-					line->backSector()->updateBBox();
+					sector_bounds_.extend(vertex->position(), vertex->objId());
+					break;
 				}
 			}
 		}
+		sector_bounds_.valid = true;
+	}
+
+	// Recalculate thing bounds if needed
+	if (!thing_bounds_.valid)
+	{
+		thing_bounds_ = {};
+		for (const auto& thing : data_.things())
+			thing_bounds_.extend(thing->position(), thing->objId());
+		thing_bounds_.valid = true;
+	}
+
+	bounds_time_            = modified_time;
+	bounds_objects_updated_ = objects_updated;
+}
+
+// -----------------------------------------------------------------------------
+// Extends the cached bounds to include [pos] (the position of object
+// [obj_id]), updating the edge object ids if needed
+// -----------------------------------------------------------------------------
+void SLADEMap::BoundsCache::extend(const Vec2d& pos, unsigned obj_id)
+{
+	if (count++ == 0)
+	{
+		bbox.min = pos;
+		bbox.max = pos;
+		std::fill(std::begin(edges), std::end(edges), obj_id);
+		return;
+	}
+
+	if (pos.x < bbox.min.x)
+	{
+		bbox.min.x = pos.x;
+		edges[0]   = obj_id;
+	}
+	if (pos.y < bbox.min.y)
+	{
+		bbox.min.y = pos.y;
+		edges[1]   = obj_id;
+	}
+	if (pos.x > bbox.max.x)
+	{
+		bbox.max.x = pos.x;
+		edges[2]   = obj_id;
+	}
+	if (pos.y > bbox.max.y)
+	{
+		bbox.max.y = pos.y;
+		edges[3]   = obj_id;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if object [obj_id] is at any edge of the cached bounds
+// -----------------------------------------------------------------------------
+bool SLADEMap::BoundsCache::isEdge(unsigned obj_id) const
+{
+	return count > 0 && std::find(std::begin(edges), std::end(edges), obj_id) != std::end(edges);
+}
+
+// -----------------------------------------------------------------------------
+// Updates geometry info (polygons/bbox/etc) for anything modified since
+// [modified_time].
+// Each line and sector affected is only updated once, no matter how many of
+// its vertices were modified. Sector polygons are only flagged for update
+// here, they are rebuilt the next time they are needed
+// -----------------------------------------------------------------------------
+void SLADEMap::updateGeometryInfo(long modified_time)
+{
+	auto vertices = data_.modifiedObjects(modified_time + 1, MapObject::Type::Vertex);
+	if (vertices.empty())
+		return;
+
+	// Get lines connected to modified vertices
+	vector<MapLine*> lines;
+	for (auto* object : vertices)
+	{
+		auto* vertex = dynamic_cast<MapVertex*>(object);
+		lines.insert(lines.end(), vertex->connected_lines_.begin(), vertex->connected_lines_.end());
 	}
+	std::sort(lines.begin(), lines.end());
+	lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+
+	// Update line geometry (this also flags sector polygons for update)
+	vector<MapSector*> sectors;
+	for (auto* line : lines)
+	{
+		line->resetInternals();
+
+		if (auto* sector = line->frontSector())
+			sectors.push_back(sector);
+		if (auto* sector = line->backSector())
+			sectors.push_back(sector);
+	}
+	std::sort(sectors.begin(), sectors.end());
+	sectors.erase(std::unique(sectors.begin(), sectors.end()), sectors.end());
+
+	// Update sector bounding boxes
+	for (auto* sector : sectors)
+		sector->updateBBox();
 }
 
 // -----------------------------------------------------------------------------
@@ -491,11 +675,12 @@ void SLADEMap::setOpenedTime()
 // Re-applies all the currently calculated special map properties (currently
 // this just means ZDoom slopes).
 // Since this needs to be done anytime the map changes, it's called whenever a
-// map is read, an undo record ends, or an undo/redo is performed.
+// map is read, an undo record ends, or an undo/redo is performed. Only sectors
+// affected by objects modified since the last time are reprocessed.
 // -----------------------------------------------------------------------------
 void SLADEMap::recomputeSpecials()
 {
-	map_specials_.processMapSpecials(this);
+	map_specials_.updateMapSpecials(this);
 }
 
 // -----------------------------------------------------------------------------
@@ -503,6 +688,8 @@ void SLADEMap::recomputeSpecials()
 // -----------------------------------------------------------------------------
 bool SLADEMap::writeMap(vector<ArchiveEntry*>& map_entries) const
 {
+	TRACE_ZONE("SLADEMap::writeMap");
+
 	// Get format handler
 	auto handler = MapFormatHandler::get(current_format_);
 	handler->setUDMFNamespace(udmf_namespace_);
@@ -546,7 +733,8 @@ MapVertex* SLADEMap::createVertex(Vec2d pos, double split_dist)
 	// Check if this vertex splits any lines (if needed)
 	if (split_dist >= 0)
 	{
-		auto lines = data_.lines();
+		vector<MapLine*> lines;
+		data_.lines().putAllInArea(pos.x - split_dist, pos.y - split_dist, pos.x + split_dist, pos.y + split_dist, lines);
 		for (auto* line : lines)
 		{
 			// Skip line if it shares the vertex
@@ -681,6 +869,7 @@ void SLADEMap::mergeVertices(unsigned vertex1, unsigned vertex2)
 			line->vertex1_ = v1;
 			line->length_  = -1;
 			v1->connectLine(line);
+			line->updateSpatialIndex();
 		}
 
 		// Change second vertex if needed
@@ -690,6 +879,7 @@ void SLADEMap::mergeVertices(unsigned vertex1, unsigned vertex2)
 			line->vertex2_ = v1;
 			line->length_  = -1;
 			v1->connectLine(line);
+			line->updateSpatialIndex();
 		}
 
 		if (line->vertex1_ == v1 && line->vertex2_ == v1)
@@ -716,30 +906,21 @@ void SLADEMap::mergeVertices(unsigned vertex1, unsigned vertex2)
 // -----------------------------------------------------------------------------
 MapVertex* SLADEMap::mergeVerticesPoint(const Vec2d& pos)
 {
-	// Go through all vertices
-	int merge = -1;
-	for (unsigned a = 0; a < vertices().size(); a++)
-	{
-		// Skip if vertex isn't on the point
-		if (vertex(a)->position_.x != pos.x || vertex(a)->position_.y != pos.y)
-			continue;
-
-		// Set as the merge target vertex if we don't have one already
-		if (merge < 0)
-		{
-			merge = a;
-			continue;
-		}
+	// Get all vertices on the point
+	vector<MapVertex*> at_pos;
+	vertices().putAllInArea(pos.x, pos.y, pos.x, pos.y, at_pos);
+	if (at_pos.empty())
+		return nullptr;
 
-		// Otherwise, merge this vertex with the merge target
-		mergeVertices(merge, a);
-		a--;
-	}
+	// Merge them all into the first one
+	auto* merge = at_pos[0];
+	for (unsigned a = 1; a < at_pos.size(); a++)
+		mergeVertices(merge->index_, at_pos[a]->index_);
 
 	geometry_updated_ = app::runTimer();
 
 	// Return the final merged vertex
-	return vertex(merge);
+	return merge;
 }
 
 // -----------------------------------------------------------------------------
@@ -757,6 +938,7 @@ MapLine* SLADEMap::splitLine(MapLine* line, MapVertex* vertex)
 	line->vertex2_ = vertex;
 	vertex->connectLine(line);
 	line->length_ = -1;
+	line->updateSpatialIndex();
 
 	// Create and add new sides
 	MapSide* s1 = nullptr;
@@ -805,11 +987,11 @@ MapLine* SLADEMap::splitLine(MapLine* line, MapVertex* vertex)
 void SLADEMap::splitLinesAt(MapVertex* vertex, double split_dist)
 {
 	// Check if this vertex splits any lines (if needed)
-	const auto nlines = data_.lines().size();
-	for (unsigned i = 0; i < nlines; ++i)
+	vector<MapLine*> lines;
+	auto             pos = vertex->position_;
+	data_.lines().putAllInArea(pos.x - split_dist, pos.y - split_dist, pos.x + split_dist, pos.y + split_dist, lines);
+	for (auto* line : lines)
 	{
-		auto* line = this->line(i);
-
 		// Skip line if it shares the vertex
 		if (line->v1() == vertex || line->v2() == vertex)
 			continue;
@@ -822,7 +1004,7 @@ void SLADEMap::splitLinesAt(MapVertex* vertex, double split_dist)
 				vertex->index_,
 				vertex->position_.x,
 				vertex->position_.y,
-				i);
+				line->index_);
 			splitLine(line, vertex);
 		}
 	}
@@ -1000,16 +1182,19 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 	auto*          last_line   = lines().last();
 
 	// Merge vertices
-	vector<MapVertex*> merged_vertices;
+	vector<MapVertex*>            merged_vertices;
+	std::unordered_set<MapVertex*> merged_set;
+	merged_vertices.reserve(vertices.size());
 	for (const auto* vertex : vertices)
 		if (auto* v = mergeVerticesPoint(vertex->position_))
-			VECTOR_ADD_UNIQUE(merged_vertices, v);
+			addUnique(merged_vertices, merged_set, v);
 
 	// Get all connected lines
-	vector<MapLine*> connected_lines;
+	vector<MapLine*>            connected_lines;
+	std::unordered_set<MapLine*> connected_set;
 	for (const auto* vertex : merged_vertices)
 		for (auto* connected_line : vertex->connected_lines_)
-			VECTOR_ADD_UNIQUE(connected_lines, connected_line);
+			addUnique(connected_lines, connected_set, connected_line);
 
 	// Split lines (by vertices)
 	constexpr double split_dist = 0.1;
@@ -1018,13 +1203,19 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 		splitLinesAt(merged, split_dist);
 
 	// Split lines that moved onto existing vertices
+	vector<MapVertex*> near_vertices;
 	for (unsigned a = 0; a < connected_lines.size(); a++)
 	{
-		const unsigned nvertices = nVertices();
-		for (unsigned b = 0; b < nvertices; b++)
+		auto bbox = connected_lines[a]->seg();
+		near_vertices.clear();
+		this->vertices().putAllInArea(
+			bbox.left() - split_dist,
+			bbox.top() - split_dist,
+			bbox.right() + split_dist,
+			bbox.bottom() + split_dist,
+			near_vertices);
+		for (auto* vertex : near_vertices)
 		{
-			auto* vertex = this->vertex(b);
-
 			// Skip line if it shares the vertex
 			if (connected_lines[a]->v1() == vertex || connected_lines[a]->v2() == vertex)
 				continue;
@@ -1032,23 +1223,23 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 			if (connected_lines[a]->distanceTo(vertex->position()) < split_dist)
 			{
 				connected_lines.push_back(splitLine(connected_lines[a], vertex));
-				VECTOR_ADD_UNIQUE(merged_vertices, vertex);
+				addUnique(merged_vertices, merged_set, vertex);
 			}
 		}
 	}
 
 	// Split lines (by lines)
-	Seg2d seg1;
+	Seg2d            seg1;
+	vector<MapLine*> near_lines;
 	for (unsigned a = 0; a < connected_lines.size(); a++)
 	{
 		auto* line1 = connected_lines[a];
 		seg1        = line1->seg();
 
-		const unsigned count = nLines();
-		for (unsigned b = 0; b < count; b++)
+		near_lines.clear();
+		lines().putAllInArea(seg1.left(), seg1.top(), seg1.right(), seg1.bottom(), near_lines);
+		for (auto* line2 : near_lines)
 		{
-			auto* line2 = line(b);
-
 			// Can't intersect if they share a vertex
 			if (line1->vertex1_ == line2->vertex1_ || line1->vertex1_ == line2->vertex2_
 				|| line2->vertex1_ == line1->vertex2_ || line2->vertex2_ == line1->vertex2_)
@@ -1060,7 +1251,7 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 			{
 				// Create split vertex
 				auto* nv = createVertex(intersection);
-				merged_vertices.push_back(nv);
+				addUnique(merged_vertices, merged_set, nv);
 
 				// Split lines
 				splitLine(line1, nv);
@@ -1078,38 +1269,56 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 
 	// Refresh connected lines
 	connected_lines.clear();
+	connected_set.clear();
 	for (const auto* vertex : merged_vertices)
 		for (auto* connected_line : vertex->connected_lines_)
-			VECTOR_ADD_UNIQUE(connected_lines, connected_line);
+			addUnique(connected_lines, connected_set, connected_line);
 
-	// Find overlapping lines
-	vector<MapLine*> remove_lines;
+	// Find overlapping lines. Overlapping lines share both vertices, so only
+	// lines connected to line1's first vertex need checking (in connected
+	// lines order, same as a full pairwise check)
+	std::unordered_map<MapLine*, unsigned> connected_order;
+	for (unsigned a = 0; a < connected_lines.size(); a++)
+		connected_order[connected_lines[a]] = a;
+	vector<MapLine*>             remove_lines;
+	std::unordered_set<MapLine*> remove_set;
+	vector<MapLine*>             overlapping;
 	for (unsigned a = 0; a < connected_lines.size(); a++)
 	{
 		auto* line1 = connected_lines[a];
 
 		// Skip if removing already
-		if (VECTOR_EXISTS(remove_lines, line1))
+		if (remove_set.count(line1) > 0)
 			continue;
 
-		for (unsigned l = a + 1; l < connected_lines.size(); l++)
+		overlapping.clear();
+		for (auto* line2 : line1->vertex1_->connected_lines_)
 		{
-			auto* line2 = connected_lines[l];
+			if (line1->vertex1_ == line2->vertex1_ && line1->vertex2_ == line2->vertex2_
+				|| line1->vertex1_ == line2->vertex2_ && line1->vertex2_ == line2->vertex1_)
+			{
+				auto order = connected_order.find(line2);
+				if (order != connected_order.end() && order->second > a)
+					overlapping.push_back(line2);
+			}
+		}
+		std::sort(
+			overlapping.begin(),
+			overlapping.end(),
+			[&connected_order](MapLine* l1, MapLine* l2) { return connected_order[l1] < connected_order[l2]; });
 
+		for (auto* line2 : overlapping)
+		{
 			// Skip if removing already
-			if (VECTOR_EXISTS(remove_lines, line2))
+			if (remove_set.count(line2) > 0)
 				continue;
 
-			if (line1->vertex1_ == line2->vertex1_ && line1->vertex2_ == line2->vertex2_
-				|| line1->vertex1_ == line2->vertex2_ && line1->vertex2_ == line2->vertex1_)
-			{
-				auto* remove_line = mergeOverlappingLines(line1, line2);
-				VECTOR_ADD_UNIQUE(remove_lines, remove_line);
+			auto* remove_line = mergeOverlappingLines(line1, line2);
+			addUnique(remove_lines, remove_set, remove_line);
 
-				// Don't check against any more lines if we just decided to remove this one
-				if (remove_line == line1)
-					break;
-			}
+			// Don't check against any more lines if we just decided to remove this one
+			if (remove_line == line1)
+				break;
 		}
 	}
 
@@ -1121,7 +1330,7 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 	}
 	for (unsigned a = 0; a < connected_lines.size(); a++)
 	{
-		if (VECTOR_EXISTS(remove_lines, connected_lines[a]))
+		if (remove_set.count(connected_lines[a]) > 0)
 		{
 			connected_lines[a] = connected_lines.back();
 			connected_lines.pop_back();
@@ -1229,16 +1438,27 @@ void SLADEMap::correctSectors(vector<MapLine*> lines, bool existing_only)
 		}
 	}
 
-	vector<MapSide*> sides_correct;
+	std::unordered_set<MapSide*> sides_correct;
 	for (auto& edge : edges)
 	{
 		if (edge.front && edge.line->side1_)
-			sides_correct.push_back(edge.line->side1_);
+			sides_correct.insert(edge.line->side1_);
 		else if (!edge.front && edge.line->side2_)
-			sides_correct.push_back(edge.line->side2_);
+			sides_correct.insert(edge.line->side2_);
+	}
+
+	// Index the first front/back edge for each line, to look up traced edges
+	std::unordered_map<MapLine*, std::pair<int, int>> line_edges;
+	for (unsigned a = 0; a < edges.size(); a++)
+	{
+		auto  inserted = line_edges.emplace(edges[a].line, std::make_pair(-1, -1)).first;
+		auto& index    = edges[a].front ? inserted->second.first : inserted->second.second;
+		if (index < 0)
+			index = a;
 	}
 
-	// Build sectors
+	// Build sectors (the builder's line adjacency is reused for every trace,
+	// since only sides change from here on)
 	SectorBuilder      builder;
 	int                runs      = 0;
 	unsigned           ns_start  = nSectors();
@@ -1268,18 +1488,13 @@ void SLADEMap::correctSectors(vector<MapLine*> lines, bool existing_only)
 			auto* line     = builder.edgeLine(b);
 			bool  is_front = builder.edgeIsFront(b);
 
-			bool line_is_ours = false;
-			for (unsigned e = 0; e < edges.size(); e++)
+			auto line_edge    = line_edges.find(line);
+			bool line_is_ours = line_edge != line_edges.end();
+			if (line_is_ours)
 			{
-				if (edges[e].line == line)
-				{
-					line_is_ours = true;
-					if (edges[e].front == is_front)
-					{
-						edges_in_sector.push_back(e);
-						break;
-					}
-				}
+				auto e = is_front ? line_edge->second.first : line_edge->second.second;
+				if (e >= 0)
+					edges_in_sector.push_back(e);
 			}
 
 			if (line_is_ours)
@@ -1456,7 +1671,13 @@ bool SLADEMap::convertToHexen() const
 }
 
 // -----------------------------------------------------------------------------
-// Converts the map to UDMF format (not implemented)
+// Converts the map to UDMF format from Doom or Hexen format.
+// Binary line and thing flags (and Hexen line activation types) are mapped
+// onto UDMF fields in bulk, using the tables of field ids for each flag built
+// by the game configuration, rather than looking up each flag by name.
+// Only the (read-only) game configuration and this map's objects are used, so
+// separate maps can be converted in parallel, without the UI.
+// Line specials are not translated
 // -----------------------------------------------------------------------------
 bool SLADEMap::convertToUDMF()
 {
@@ -1464,7 +1685,12 @@ bool SLADEMap::convertToUDMF()
 	if (current_format_ == MapFormat::UDMF)
 		return true;
 
-	if (current_format_ == MapFormat::Hexen)
+	// Only Doom and Hexen format flags can be converted
+	bool hexen = current_format_ == MapFormat::Hexen;
+	if (!hexen && current_format_ != MapFormat::Doom && current_format_ != MapFormat::Doom32X)
+		return false;
+
+	if (hexen)
 	{
 		// Handle special cases for conversion from Hexen format
 		for (const auto& line : lines())
@@ -1561,8 +1787,41 @@ bool SLADEMap::convertToUDMF()
 				line->setBoolProperty("checkswitchrange", true);
 		}
 	}
-	else
-		return false;
+
+	// Lines
+	const auto& config = game::configuration();
+	for (auto* line : lines())
+	{
+		// Clear the binary flags first (so the line is backed up unmodified)
+		int flags = line->flags();
+		line->setFlags(0);
+
+		auto& props = line->props();
+		for (const auto& field : config.udmfLineFlagFields())
+			if (field.value(flags))
+				props[field.id] = true;
+
+		// Hexen activation type (only meaningful if the line has a special)
+		if (hexen && line->special() != 0)
+			for (auto id : config.udmfSpacTriggerFields((flags & 0x1c00) >> 10))
+				props[id] = true;
+
+		// Doom format lines have their tag copied to arg0, UDMF only uses the id
+		if (!hexen && line->arg(0) != 0)
+			line->setArg(0, 0);
+	}
+
+	// Things
+	for (auto* thing : things())
+	{
+		int flags = thing->flags();
+		thing->setFlags(0);
+
+		auto& props = thing->props();
+		for (const auto& field : config.udmfThingFlagFields())
+			if (field.value(flags))
+				props[field.id] = true;
+	}
 
 	// Set format
 	current_format_ = MapFormat::UDMF;
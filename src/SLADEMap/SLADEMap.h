@@ -6,6 +6,7 @@
 
 namespace slade
 {
+class MapSnapshot;
 class ParseTreeNode;
 namespace Game
 {
@@ -34,10 +35,14 @@ public:
 	MapFormat                  currentFormat() const { return current_format_; }
 	long                       geometryUpdated() const { return geometry_updated_; }
 	long                       thingsUpdated() const { return things_updated_; }
+	long                       lastChanged() const;
 	const MapObjectCollection& mapData() const { return data_; }
 
 	void setGeometryUpdated();
 	void setThingsUpdated();
+	void updateSpatialIndex(MapObject* object) { data_.updateSpatialIndex(object); }
+	void updateIdIndex(MapObject* object) { data_.updateIdIndex(object); }
+	void recordModified(const MapObject* object) { data_.recordModified(object); }
 
 	// MapObject access
 	MapVertex*        vertex(unsigned index) const { return data_.vertices().at(index); }
@@ -75,6 +80,7 @@ public:
 	MapThing*  createThing(Vec2d pos, int type = 1);
 	MapSector* createSector();
 	MapSide*   createSide(MapSector* sector);
+	void       reserve(MapObject::Type type, unsigned count) { data_.reserve(type, count); }
 
 	// Removal
 	bool removeVertex(MapVertex* vertex, bool merge_lines = false) { return data_.removeVertex(vertex, merge_lines); }
@@ -94,6 +100,9 @@ public:
 	void     updateGeometryInfo(long modified_time);
 	MapLine* lineVectorIntersect(MapLine* line, bool front, double& hit_x, double& hit_y) const;
 
+	// Snapshots (for reading on background threads, see MapSnapshot)
+	shared_ptr<const MapSnapshot> snapshot() const;
+
 	// Tags/Ids
 	void putThingsWithIdInSectorTag(int id, int tag, vector<MapThing*>& list);
 	void putDragonTargets(MapThing* first, vector<MapThing*>& list);
@@ -103,6 +112,7 @@ public:
 	MapSector* lineSideSector(MapLine* line, bool front = true);
 	bool       isModified() const;
 	void       setOpenedTime();
+	void       setOpenedTime(long time) { opened_time_ = time; }
 
 	// Editing
 	void       mergeVertices(unsigned vertex1, unsigned vertex2);
@@ -126,6 +136,7 @@ public:
 	void rebuildConnectedLines() { data_.rebuildConnectedLines(); }
 	void rebuildConnectedSides() { data_.rebuildConnectedSides(); }
 	void restoreObjectIdList(MapObject::Type type, vector<unsigned>& list) { data_.restoreObjectIdList(type, list); }
+	void optimiseOrder() { data_.optimiseOrder(); }
 
 	// Convert
 	bool convertToHexen() const;
@@ -137,6 +148,19 @@ public:
 	int  thingTypeUsageCount(int type);
 
 private:
+	// Cached bounds of a set of map object positions, with the ids of the
+	// objects at each edge so it is known when they need recalculating
+	struct BoundsCache
+	{
+		BBox     bbox;
+		unsigned edges[4] = { 0, 0, 0, 0 }; // Object ids at min x, min y, max x, max y
+		unsigned count    = 0;              // Number of positions added to the bounds
+		bool     valid    = false;
+
+		void extend(const Vec2d& pos, unsigned obj_id);
+		bool isEdge(unsigned obj_id) const;
+	};
+
 	MapObjectCollection data_;
 	string              udmf_namespace_;
 	PropertyList        udmf_props_;
@@ -150,6 +174,14 @@ private:
 	long geometry_updated_ = 0; // The last time the map geometry was updated
 	long things_updated_   = 0; // The last time the thing list was modified
 
+	// Map bounds (see bounds)
+	BoundsCache sector_bounds_;               // Vertices of lines with a sector on either side
+	BoundsCache thing_bounds_;                // Thing positions
+	long        bounds_time_            = -1; // Modification journal time the bounds are up to date with
+	long        bounds_objects_updated_ = -1; // Objects added/removed time the bounds are up to date with
+
+	void updateBounds();
+
 	// Usage counts
 	std::map<int, int> usage_thing_type_;
 };
@@ -141,6 +141,63 @@ vector<shared_ptr<ArchiveEntry>> archiveFindAll(Archive& self, Archive::SearchOp
 	return found_shared;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a list of the entries in [entries], which can be a table of entries
+// or an array returned from another function (eg. Archive.entries or
+// Archive.FindAll)
+// -----------------------------------------------------------------------------
+vector<ArchiveEntry*> archiveEntryList(const sol::object& entries)
+{
+	vector<ArchiveEntry*> list;
+
+	if (entries.get_type() == sol::type::table)
+	{
+		auto table = entries.as<sol::table>();
+		list.reserve(table.size());
+		for (const auto& item : table)
+			if (item.second.is<ArchiveEntry*>())
+				list.push_back(item.second.as<ArchiveEntry*>());
+	}
+	else if (entries.is<vector<shared_ptr<ArchiveEntry>>>())
+	{
+		for (const auto& entry : entries.as<vector<shared_ptr<ArchiveEntry>>&>())
+			list.push_back(entry.get());
+	}
+	else if (entries.is<vector<ArchiveEntry*>>())
+		list = entries.as<vector<ArchiveEntry*>&>();
+
+	return list;
+}
+
+// -----------------------------------------------------------------------------
+// Removes all [entries] from archive [self] as a single batch of changes.
+// Returns the number of entries removed
+// -----------------------------------------------------------------------------
+unsigned archiveRemoveEntries(Archive& self, const sol::object& entries)
+{
+	ArchiveBatch batch(self);
+
+	unsigned n_removed = 0;
+	for (auto* entry : archiveEntryList(entries))
+		if (entry && self.removeEntry(entry))
+			++n_removed;
+
+	return n_removed;
+}
+
+// -----------------------------------------------------------------------------
+// Commits any archive batches left open by a script
+// -----------------------------------------------------------------------------
+void commitArchiveBatches()
+{
+	for (int a = 0; a < app::archiveManager().numArchives(); ++a)
+	{
+		auto archive = app::archiveManager().getArchive(a);
+		while (archive && archive->inBatch())
+			archive->commitBatch();
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Registers the ArchiveFormat type with lua
 // -----------------------------------------------------------------------------
@@ -210,6 +267,12 @@ void registerArchive(sol::state& lua)
 	lua_archive["FindLast"]  = &archiveFindLast;
 	lua_archive["FindAll"]   = &archiveFindAll;
 
+	// Batched changes
+	// -------------------------------------------------------------------------
+	lua_archive["BeginBatch"]    = &Archive::beginBatch;
+	lua_archive["CommitBatch"]   = &Archive::commitBatch;
+	lua_archive["RemoveEntries"] = &archiveRemoveEntries;
+
 	// Register all subclasses
 	// (perhaps it'd be a good idea to make Archive not abstract and handle
 	//  the format-specific stuff somewhere else, rather than in subclasses)
@@ -302,7 +365,8 @@ void registerArchiveEntry(sol::state& lua)
 	lua_entry["size"]  = sol::property(&ArchiveEntry::size);
 	lua_entry["index"] = sol::property(&ArchiveEntry::index);
 	lua_entry["crc32"] = sol::property([](ArchiveEntry& self) { return misc::crc(self.rawData(), self.size()); });
-	lua_entry["data"]  = sol::property([](ArchiveEntry& self) { return &self.data(); });
+	lua_entry["contentHash"] = sol::property(&ArchiveEntry::contentHash);
+	lua_entry["data"]        = sol::property([](ArchiveEntry& self) { return &self.data(); });
 	lua_entry["parentArchive"] = sol::property(&entryParent);
 	lua_entry["parentDir"]     = sol::property(&entryDir);
 
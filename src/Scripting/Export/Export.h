@@ -17,4 +17,8 @@ void registerArchiveTypes(sol::state& lua);
 void registerMapEditorTypes(sol::state& lua);
 void registerGameTypes(sol::state& lua);
 void registerGraphicsTypes(sol::state& lua);
+
+// Batched changes (committed after a script has run)
+void commitMapTransaction();
+void commitArchiveBatches();
 } // namespace slade::lua
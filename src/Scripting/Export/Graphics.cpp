@@ -290,6 +290,17 @@ bool paletteLoadDataFormatted(Palette& self, string_view data, Palette::Format f
 	return self.loadMem(mc, format);
 }
 
+// -----------------------------------------------------------------------------
+// Returns a Doom COLORMAP generated from palette [self] as a binary string,
+// using colour matching method [match]
+// -----------------------------------------------------------------------------
+string paletteGenerateColormap(Palette& self, Palette::ColourMatch match)
+{
+	MemChunk mc;
+	self.generateColormap(mc, match);
+	return { reinterpret_cast<const char*>(mc.data()), mc.size() };
+}
+
 // -----------------------------------------------------------------------------
 // Registers the Palette type with lua
 // -----------------------------------------------------------------------------
@@ -333,6 +344,9 @@ void registerPaletteType(sol::state& lua)
 	lua_palette["FindColour"]    = &Palette::findColour;
 	lua_palette["NearestColour"] = sol::overload(
 		&Palette::nearestColour, [](Palette& self, const ColRGBA& col) { return self.nearestColour(col); });
+	lua_palette["GenerateColormap"] = sol::overload(
+		&paletteGenerateColormap,
+		[](Palette& self) { return paletteGenerateColormap(self, Palette::ColourMatch::Default); });
 	lua_palette["CountUniqueColours"] = &Palette::countColours;
 	lua_palette["ApplyTranslation"]   = &Palette::applyTranslation;
 	lua_palette["Colourise"]          = &Palette::colourise;
@@ -40,6 +40,17 @@
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace slade::lua
+{
+MapEditContext* transaction_context = nullptr; // Map editor with a script transaction in progress
+} // namespace slade::lua
+
+
 // -----------------------------------------------------------------------------
 //
 // Lua Namespace Functions
@@ -95,6 +106,99 @@ void objectSetStringProperty(MapObject& self, string_view key, string_view value
 		log::warning("{} string property \"{}\" can not be modified via script", self.typeName(), key);
 }
 
+// -----------------------------------------------------------------------------
+// Returns a list of the MapObjects in [objects], which can be a table of any
+// MapObject types or an array returned from another function (eg.
+// Map.linedefs or MapEditor.SelectedThings)
+// -----------------------------------------------------------------------------
+vector<MapObject*> mapObjectList(const sol::object& objects)
+{
+	vector<MapObject*> list;
+
+	if (objects.get_type() == sol::type::table)
+	{
+		auto table = objects.as<sol::table>();
+		list.reserve(table.size());
+		for (const auto& item : table)
+			if (item.second.is<MapObject*>())
+				list.push_back(item.second.as<MapObject*>());
+	}
+	else if (objects.is<vector<MapVertex*>>())
+		list.assign(objects.as<vector<MapVertex*>&>().begin(), objects.as<vector<MapVertex*>&>().end());
+	else if (objects.is<vector<MapLine*>>())
+		list.assign(objects.as<vector<MapLine*>&>().begin(), objects.as<vector<MapLine*>&>().end());
+	else if (objects.is<vector<MapSide*>>())
+		list.assign(objects.as<vector<MapSide*>&>().begin(), objects.as<vector<MapSide*>&>().end());
+	else if (objects.is<vector<MapSector*>>())
+		list.assign(objects.as<vector<MapSector*>&>().begin(), objects.as<vector<MapSector*>&>().end());
+	else if (objects.is<vector<MapThing*>>())
+		list.assign(objects.as<vector<MapThing*>&>().begin(), objects.as<vector<MapThing*>&>().end());
+
+	return list;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a table of the values of property [key] on all [objects] (see
+// mapObjectList), read with [get]
+// -----------------------------------------------------------------------------
+template<typename T>
+sol::table objectsProperty(const sol::object& objects, string_view key, T (MapObject::*get)(string_view))
+{
+	auto list   = mapObjectList(objects);
+	auto values = lua::state().create_table(list.size(), 0);
+	for (unsigned a = 0; a < list.size(); ++a)
+		values[a + 1] = (list[a]->*get)(key);
+
+	return values;
+}
+
+// -----------------------------------------------------------------------------
+// Sets property [key] to [value] on all [objects] (see mapObjectList) with
+// [set]. Objects that don't allow [key] to be modified by scripts are skipped,
+// with a single warning logged for all of them
+// -----------------------------------------------------------------------------
+template<typename T, typename V>
+void objectsSetProperty(const sol::object& objects, string_view key, V value, void (MapObject::*set)(string_view, T))
+{
+	unsigned n_skipped = 0;
+	for (auto* object : mapObjectList(objects))
+	{
+		if (object->scriptCanModifyProp(key))
+			(object->*set)(key, value);
+		else
+			++n_skipped;
+	}
+
+	if (n_skipped > 0)
+		log::warning("Property \"{}\" can not be modified via script on {} object(s)", key, n_skipped);
+}
+
+// -----------------------------------------------------------------------------
+// Returns all things in [map] of [type]
+// -----------------------------------------------------------------------------
+vector<MapThing*> mapThingsOfType(SLADEMap& map, int type)
+{
+	vector<MapThing*> list;
+	for (auto* thing : map.things())
+		if (thing->type() == type)
+			list.push_back(thing);
+
+	return list;
+}
+
+// -----------------------------------------------------------------------------
+// Returns all lines in [map] with action [special]
+// -----------------------------------------------------------------------------
+vector<MapLine*> mapLinesWithSpecial(SLADEMap& map, int special)
+{
+	vector<MapLine*> list;
+	for (auto* line : map.lines())
+		if (line->special() == special)
+			list.push_back(line);
+
+	return list;
+}
+
 // -----------------------------------------------------------------------------
 // Registers the Map type with lua
 // -----------------------------------------------------------------------------
@@ -112,6 +216,33 @@ void registerSLADEMap(sol::state& lua)
 	lua_map["sidedefs"]      = sol::property([](SLADEMap& self) { return self.sides().all(); });
 	lua_map["sectors"]       = sol::property([](SLADEMap& self) { return self.sectors().all(); });
 	lua_map["things"]        = sol::property([](SLADEMap& self) { return self.things().all(); });
+
+	// Functions
+	// -------------------------------------------------------------------------
+	lua_map["LinesWithId"]      = [](SLADEMap& self, int id) { return self.lines().allWithId(id); };
+	lua_map["LinesWithSpecial"] = &mapLinesWithSpecial;
+	lua_map["SectorsWithTag"]   = [](SLADEMap& self, int tag) { return self.sectors().allWithId(tag); };
+	lua_map["ThingsWithId"]     = [](SLADEMap& self, int id) { return self.things().allWithId(id); };
+	lua_map["ThingsOfType"]     = &mapThingsOfType;
+
+	// Bulk property access
+	// -------------------------------------------------------------------------
+	lua_map["BoolProperties"] = [](SLADEMap&, const sol::object& objects, string_view key)
+	{ return objectsProperty(objects, key, &MapObject::boolProperty); };
+	lua_map["IntProperties"] = [](SLADEMap&, const sol::object& objects, string_view key)
+	{ return objectsProperty(objects, key, &MapObject::intProperty); };
+	lua_map["FloatProperties"] = [](SLADEMap&, const sol::object& objects, string_view key)
+	{ return objectsProperty(objects, key, &MapObject::floatProperty); };
+	lua_map["StringProperties"] = [](SLADEMap&, const sol::object& objects, string_view key)
+	{ return objectsProperty(objects, key, &MapObject::stringProperty); };
+	lua_map["SetBoolProperties"] = [](SLADEMap&, const sol::object& objects, string_view key, bool value)
+	{ objectsSetProperty(objects, key, value, &MapObject::setBoolProperty); };
+	lua_map["SetIntProperties"] = [](SLADEMap&, const sol::object& objects, string_view key, int value)
+	{ objectsSetProperty(objects, key, value, &MapObject::setIntProperty); };
+	lua_map["SetFloatProperties"] = [](SLADEMap&, const sol::object& objects, string_view key, double value)
+	{ objectsSetProperty(objects, key, value, &MapObject::setFloatProperty); };
+	lua_map["SetStringProperties"] = [](SLADEMap&, const sol::object& objects, string_view key, string_view value)
+	{ objectsSetProperty(objects, key, value, &MapObject::setStringProperty); };
 }
 
 // -----------------------------------------------------------------------------
@@ -136,6 +267,38 @@ void setEditMode(
 		self.setSectorEditMode(sector_mode);
 }
 
+// -----------------------------------------------------------------------------
+// Begins a transaction [name] in the map editor [self]. All changes made to
+// the map until the transaction is committed are recorded as a single undo
+// level, and the map editor display is only refreshed when it is committed
+// -----------------------------------------------------------------------------
+void beginMapTransaction(MapEditContext& self, string_view name)
+{
+	if (transaction_context)
+	{
+		log::warning("Can't begin map editor transaction \"{}\", one is already in progress", name);
+		return;
+	}
+
+	self.beginUndoRecord(name);
+	transaction_context = &self;
+}
+
+// -----------------------------------------------------------------------------
+// Commits the map editor transaction in progress (if any), recording its undo
+// level and refreshing the map editor display
+// -----------------------------------------------------------------------------
+void commitMapTransaction()
+{
+	if (!transaction_context)
+		return;
+
+	transaction_context->endUndoRecord(true);
+	transaction_context->forceRefreshRenderer();
+	transaction_context->updateDisplay();
+	transaction_context = nullptr;
+}
+
 // -----------------------------------------------------------------------------
 // Registers the MapEditor type with lua
 // -----------------------------------------------------------------------------
@@ -179,7 +342,9 @@ void registerMapEditor(sol::state& lua)
 	lua_mapeditor["ClearSelection"] = [](MapEditContext& self) { self.selection().clear(); };
 	lua_mapeditor["Select"]         = sol::overload(
         &selectMapObject, [](MapEditContext& self, MapObject* object) { selectMapObject(self, object, true); });
-	lua_mapeditor["SetEditMode"] = sol::overload(
+	lua_mapeditor["BeginTransaction"]  = &beginMapTransaction;
+	lua_mapeditor["CommitTransaction"] = [](MapEditContext&) { commitMapTransaction(); };
+	lua_mapeditor["SetEditMode"]       = sol::overload(
 		[](MapEditContext& self, mapeditor::Mode mode) { setEditMode(self, mode); },
 		[](MapEditContext& self, mapeditor::Mode mode, mapeditor::SectorMode sector_mode) {
 			setEditMode(self, mode, sector_mode);
@@ -2,6 +2,7 @@
 #include "Main.h"
 #include "Export.h"
 #include "Scripting/Lua.h"
+#include "Scripting/ScriptMonitor.h"
 #include "UI/Dialogs/ExtMessageDialog.h"
 #include "UI/Dialogs/Preferences/ACSPrefsPanel.h"
 #include "Utility/SFileDialog.h"
@@ -163,7 +164,12 @@ void registerUINamespace(sol::state& lua)
 	ui["SplashProgress"]           = &ui::getSplashProgress;
 	ui["SetSplashMessage"]         = &ui::setSplashMessage;
 	ui["SetSplashProgressMessage"] = &ui::setSplashProgressMessage;
-	ui["SetSplashProgress"]        = &ui::setSplashProgress;
+	ui["SetSplashProgress"]        = [](float progress)
+	{
+		// Suspend the script so the progress is shown
+		ui::setSplashProgress(progress);
+		ScriptMonitor::requestSuspend();
+	};
 
 	// Constants
 	// -------------------------------------------------------------------------
@@ -34,7 +34,9 @@
 #include "Export/Export.h"
 #include "General/Console.h"
 #include "General/Misc.h"
+#include "General/Trace.h"
 #include "SLADEMap/SLADEMap.h"
+#include "ScriptMonitor.h"
 #include "UI/Dialogs/ExtMessageDialog.h"
 #include "UI/WxUtils.h"
 #include "Utility/StringUtils.h"
@@ -86,9 +88,9 @@ void logError(const Error& error)
 }
 
 // -----------------------------------------------------------------------------
-// Processes error information from [result]
+// Processes error information from [result] (a sol load or function result)
 // -----------------------------------------------------------------------------
-void processError(const sol::protected_function_result& result)
+template<typename R> void processError(const R& result)
 {
 	// Error Type
 	script_error.type = sol::to_string(result.status());
@@ -124,15 +126,62 @@ sol::protected_function_result handleError(lua_State* L, sol::protected_function
 	return pfr;
 }
 
+// -----------------------------------------------------------------------------
+// Commits any batched archive changes or map editor transaction left in
+// progress by a script
+// -----------------------------------------------------------------------------
+void commitScriptChanges()
+{
+	commitArchiveBatches();
+	commitMapTransaction();
+}
+
+// -----------------------------------------------------------------------------
+// Runs [func] with [args] in a new coroutine, so that it can be suspended by
+// [monitor] to update the UI. The coroutine is resumed until it finishes or
+// the user cancels it.
+// Returns false if an error occurred or the script was cancelled
+// -----------------------------------------------------------------------------
+template<typename... Args> bool runCoroutine(ScriptMonitor& monitor, const sol::function& func, Args&&... args)
+{
+	auto           thread = sol::thread::create(lua.lua_state());
+	sol::coroutine coroutine(thread.state(), func);
+	monitor.attach(thread.state());
+
+	auto result = coroutine(std::forward<Args>(args)...);
+	while (result.status() == sol::call_status::yielded)
+	{
+		if (!monitor.update())
+		{
+			script_error = { "Cancelled", "Script cancelled by user", -1 };
+			logError(script_error);
+			return false;
+		}
+
+		result = coroutine();
+	}
+
+	if (!result.valid())
+	{
+		processError(result);
+		logError(script_error);
+		return false;
+	}
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Template function for Lua::run*Script functions.
-// Loads [script] and runs the 'Execute' function in the script, passing
-// [param] to the function
+// Loads [script] ([name] is used for the profiler/watchdog) and runs the
+// 'Execute' function in the script, passing [param] to the function
 // -----------------------------------------------------------------------------
-template<class T> bool runEditorScript(const string& script, T param)
+template<class T> bool runEditorScript(const string& script, string_view name, T param)
 {
+	TRACE_ZONE("lua::runEditorScript", name);
 	resetError();
 	script_start_time = wxDateTime::Now().GetTicks();
+	ScriptMonitor monitor(lua.lua_state(), name);
 
 	// Load script
 	sol::environment sandbox(lua, sol::create, lua.globals());
@@ -145,17 +194,11 @@ template<class T> bool runEditorScript(const string& script, T param)
 	}
 
 	// Run script execute function
-	sol::protected_function        func(sandbox["Execute"]);
-	sol::protected_function_result exec_result = func(param);
-	if (!exec_result.valid())
-	{
-		sol::error error = exec_result;
-		processError(exec_result);
-		logError(script_error);
-		return false;
-	}
+	sol::function func = sandbox["Execute"];
+	auto          ok   = runCoroutine(monitor, func, param);
+	commitScriptChanges();
 
-	return true;
+	return ok;
 }
 
 } // namespace slade::lua
@@ -244,21 +287,29 @@ void lua::showErrorDialog(wxWindow* parent, string_view title, string_view messa
 // -----------------------------------------------------------------------------
 bool lua::run(const string& program)
 {
+	TRACE_ZONE("lua::run");
 	resetError();
 	script_start_time = wxDateTime::Now().GetTicks();
 
-	sol::environment sandbox(lua, sol::create, lua.globals());
-	auto             result = lua.script(program, sandbox, handleError);
-	lua.collect_garbage();
-
-	if (!result.valid())
+	// Load script
+	auto loaded = lua.load(program);
+	if (!loaded.valid())
 	{
-		processError(result);
+		processError(loaded);
 		logError(script_error);
 		return false;
 	}
 
-	return true;
+	// Run it in a sandbox environment
+	ScriptMonitor    monitor(lua.lua_state(), "script");
+	sol::environment sandbox(lua, sol::create, lua.globals());
+	sol::function    chunk = loaded;
+	sandbox.set_on(chunk);
+	auto ok = runCoroutine(monitor, chunk);
+	commitScriptChanges();
+	lua.collect_garbage();
+
+	return ok;
 }
 
 // -----------------------------------------------------------------------------
@@ -266,21 +317,29 @@ bool lua::run(const string& program)
 // -----------------------------------------------------------------------------
 bool lua::runFile(const string& filename)
 {
+	TRACE_ZONE("lua::runFile", filename);
 	resetError();
 	script_start_time = wxDateTime::Now().GetTicks();
 
-	sol::environment sandbox(lua, sol::create, lua.globals());
-	auto             result = lua.script_file(filename, sandbox, handleError);
-	lua.collect_garbage();
-
-	if (!result.valid())
+	// Load script
+	auto loaded = lua.load_file(filename);
+	if (!loaded.valid())
 	{
-		processError(result);
+		processError(loaded);
 		logError(script_error);
 		return false;
 	}
 
-	return true;
+	// Run it in a sandbox environment
+	ScriptMonitor    monitor(lua.lua_state(), filename);
+	sol::environment sandbox(lua, sol::create, lua.globals());
+	sol::function    chunk = loaded;
+	sandbox.set_on(chunk);
+	auto ok = runCoroutine(monitor, chunk);
+	commitScriptChanges();
+	lua.collect_garbage();
+
+	return ok;
 }
 
 // -----------------------------------------------------------------------------
@@ -289,7 +348,7 @@ bool lua::runFile(const string& filename)
 // -----------------------------------------------------------------------------
 bool lua::runArchiveScript(const string& script, Archive* archive)
 {
-	return runEditorScript<Archive*>(script, archive);
+	return runEditorScript<Archive*>(script, "archive script", archive);
 }
 
 // -----------------------------------------------------------------------------
@@ -298,7 +357,7 @@ bool lua::runArchiveScript(const string& script, Archive* archive)
 // -----------------------------------------------------------------------------
 bool lua::runEntryScript(const string& script, vector<ArchiveEntry*>& entries)
 {
-	return runEditorScript<vector<ArchiveEntry*>&>(script, entries);
+	return runEditorScript<vector<ArchiveEntry*>&>(script, "entry script", entries);
 }
 
 // -----------------------------------------------------------------------------
@@ -307,7 +366,7 @@ bool lua::runEntryScript(const string& script, vector<ArchiveEntry*>& entries)
 // -----------------------------------------------------------------------------
 bool lua::runMapScript(const string& script, SLADEMap* map)
 {
-	return runEditorScript<SLADEMap*>(script, map);
+	return runEditorScript<SLADEMap*>(script, "map script", map);
 }
 
 // -----------------------------------------------------------------------------
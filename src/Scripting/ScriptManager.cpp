@@ -59,6 +59,7 @@ ScriptList scripts_decorate;
 ScriptList scripts_zscript;
 
 std::map<ScriptType, string> script_templates;
+bool                         initialised = false;
 } // namespace slade::scriptmanager
 
 
@@ -237,10 +238,15 @@ Script* getEditorScript(string_view name, ScriptType type, bool user_only = true
 } // namespace slade::scriptmanager
 
 // -----------------------------------------------------------------------------
-// Initialises the script manager
+// Initialises the script manager, if it hasn't been already. This is done on
+// first use (eg. when a scripts menu is populated) rather than at startup
 // -----------------------------------------------------------------------------
 void scriptmanager::init()
 {
+	if (initialised)
+		return;
+	initialised = true;
+
 	// Create user scripts directory if it doesn't exist
 	auto user_scripts_dir = app::path("scripts", app::Dir::User);
 	if (!fileutil::dirExists(user_scripts_dir))
@@ -265,6 +271,8 @@ void scriptmanager::init()
 // -----------------------------------------------------------------------------
 void scriptmanager::open()
 {
+	init();
+
 	if (!window)
 		window = new ScriptManagerWindow();
 
@@ -276,6 +284,11 @@ void scriptmanager::open()
 // -----------------------------------------------------------------------------
 void scriptmanager::saveUserScripts()
 {
+	// Nothing to save (and the user script dirs shouldn't be cleared) if the
+	// scripts were never loaded
+	if (!initialised)
+		return;
+
 	exportUserScripts("scripts/custom", scripts_editor[ScriptType::Custom]);
 	exportUserScripts("scripts/archive", scripts_editor[ScriptType::Archive]);
 	exportUserScripts("scripts/entry", scripts_editor[ScriptType::Entry]);
@@ -326,6 +339,8 @@ bool scriptmanager::deleteScript(Script* script)
 // -----------------------------------------------------------------------------
 scriptmanager::Script* scriptmanager::createEditorScript(string_view name, ScriptType type)
 {
+	init();
+
 	// Check name
 	auto script = getEditorScript(name, type);
 	if (!script)
@@ -345,6 +360,8 @@ scriptmanager::Script* scriptmanager::createEditorScript(string_view name, Scrip
 // -----------------------------------------------------------------------------
 vector<unique_ptr<scriptmanager::Script>>& scriptmanager::editorScripts(ScriptType type)
 {
+	init();
+
 	return scripts_editor[type];
 }
 
@@ -353,6 +370,8 @@ vector<unique_ptr<scriptmanager::Script>>& scriptmanager::editorScripts(ScriptTy
 // -----------------------------------------------------------------------------
 void scriptmanager::populateEditorScriptMenu(wxMenu* menu, ScriptType type, string_view action_id)
 {
+	init();
+
 	int index = 0;
 	for (auto& script : scripts_editor[type])
 		menu->Append(SAction::fromId(action_id)->wxId() + index++, script->name);
@@ -0,0 +1,377 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ScriptMonitor.cpp
+// Description: ScriptMonitor class - profiles running lua scripts and allows
+//              long-running scripts to be interrupted, via lua debug hooks
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ScriptMonitor.h"
+#include "General/Console.h"
+#include "Lua.h"
+#include "thirdparty/sol/sol.hpp"
+#include <wx/progdlg.h>
+
+using namespace slade;
+using namespace lua;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, lua_profile, false, 0)
+CVAR(Int, script_watchdog_time, 5, CVar::Flag::Save)
+
+namespace
+{
+// Number of lua instructions between watchdog/suspend checks
+constexpr int CHECK_INSTRUCTIONS = 1000;
+
+// Time a suspendable script runs for before being suspended to update the UI
+constexpr auto SUSPEND_INTERVAL = std::chrono::milliseconds(100);
+
+// Maximum number of functions listed in a profile
+constexpr unsigned PROFILE_FUNCTIONS = 30;
+
+struct Profile
+{
+	string                               script;
+	double                               total_ms = 0.;
+	vector<ScriptMonitor::FunctionStats> functions;
+};
+
+ScriptMonitor* current_monitor   = nullptr;
+bool           suspend_requested = false;
+Profile        last_profile;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Writes [profile] to the log as messages of [type], listing the functions
+// with the most self time first
+// -----------------------------------------------------------------------------
+void logProfile(Profile& profile, log::MessageType type)
+{
+	std::sort(
+		profile.functions.begin(),
+		profile.functions.end(),
+		[](const auto& left, const auto& right) { return left.self_ms > right.self_ms; });
+
+	log::message(type, fmt::format("Profile of {} ({:.2f}ms):", profile.script, profile.total_ms));
+	log::message(type, fmt::format("{:>10} {:>10} {:>8}  Function", "Self ms", "Total ms", "Calls"));
+	for (unsigned a = 0; a < profile.functions.size() && a < PROFILE_FUNCTIONS; ++a)
+	{
+		const auto& func = profile.functions[a];
+		log::message(
+			type,
+			fmt::format(
+				"{:>10.2f} {:>10.2f} {:>8}  {} ({})", func.self_ms, func.total_ms, func.calls, func.name, func.source));
+	}
+	if (profile.functions.size() > PROFILE_FUNCTIONS)
+		log::message(type, fmt::format("({} more functions not shown)", profile.functions.size() - PROFILE_FUNCTIONS));
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ScriptMonitor Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// ScriptMonitor class constructor. Starts monitoring lua [state] (running
+// [script_name]), unless another script is already being monitored
+// -----------------------------------------------------------------------------
+ScriptMonitor::ScriptMonitor(lua_State* state, string_view script_name) :
+	state_{ state },
+	script_name_{ script_name },
+	profile_{ lua_profile },
+	start_time_{ Clock::now() },
+	last_suspend_{ start_time_ }
+{
+	if (current_monitor)
+		return;
+
+	current_monitor   = this;
+	suspend_requested = false;
+	attach(state_);
+}
+
+// -----------------------------------------------------------------------------
+// ScriptMonitor class destructor. Stops monitoring and logs the profile
+// results (if profiling)
+// -----------------------------------------------------------------------------
+ScriptMonitor::~ScriptMonitor()
+{
+	if (current_monitor != this)
+		return;
+
+	lua_sethook(state_, nullptr, 0, 0);
+	current_monitor   = nullptr;
+	suspend_requested = false;
+	watchdog_dialog_.reset();
+
+	if (!profile_)
+		return;
+
+	// End any calls still in progress (eg. if the script was interrupted)
+	auto end_time = Clock::now();
+	while (!call_stack_.empty())
+		leaveFunction(end_time);
+
+	last_profile.script    = script_name_;
+	last_profile.total_ms  = std::chrono::duration<double, std::milli>(end_time - start_time_).count();
+	last_profile.functions = std::move(functions_);
+	logProfile(last_profile, log::MessageType::Script);
+}
+
+// -----------------------------------------------------------------------------
+// Installs the monitor's hooks on lua [coroutine] (or the main state)
+// -----------------------------------------------------------------------------
+void ScriptMonitor::attach(lua_State* coroutine) const
+{
+	if (current_monitor != this)
+		return;
+
+	auto mask = LUA_MASKCOUNT;
+	if (profile_)
+		mask |= LUA_MASKCALL | LUA_MASKRET;
+	lua_sethook(coroutine, &ScriptMonitor::hook, mask, CHECK_INSTRUCTIONS);
+}
+
+// -----------------------------------------------------------------------------
+// Updates the UI while the script is suspended: shows or updates the watchdog
+// dialog, and processes pending events so the UI stays responsive (user input
+// is blocked while the script is running).
+// Returns false if the user cancelled the script
+// -----------------------------------------------------------------------------
+bool ScriptMonitor::update()
+{
+	auto pause_start = Clock::now();
+
+	auto cancelled = checkWatchdog();
+	if (!watchdog_dialog_)
+		wxSafeYield(nullptr, true);
+
+	// Don't count the time spent here towards the functions being profiled
+	last_suspend_ = Clock::now();
+	for (auto& call : call_stack_)
+		call.start += last_suspend_ - pause_start;
+
+	return !cancelled;
+}
+
+// -----------------------------------------------------------------------------
+// Requests that the running script is suspended to update the UI as soon as
+// possible (eg. after the script updated its progress)
+// -----------------------------------------------------------------------------
+void ScriptMonitor::requestSuspend()
+{
+	suspend_requested = true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the results of the last script profile to the console
+// -----------------------------------------------------------------------------
+void ScriptMonitor::dumpLastProfile()
+{
+	if (last_profile.script.empty())
+		log::console("No script has been profiled, enable the lua_profile cvar and run a script first");
+	else
+		logProfile(last_profile, log::MessageType::Console);
+}
+
+// -----------------------------------------------------------------------------
+// Records a call to the function described by [ar] in lua [state]
+// -----------------------------------------------------------------------------
+void ScriptMonitor::enterFunction(lua_State* state, lua_Debug* ar)
+{
+	lua_getinfo(state, "nSf", ar);
+	auto function = lua_topointer(state, -1);
+	lua_pop(state, 1);
+
+	// Add function stats if this is the first call to it
+	auto [i, added] = function_index_.emplace(function, functions_.size());
+	if (added)
+	{
+		auto& stats = functions_.emplace_back();
+		if (ar->name)
+			stats.name = ar->name;
+		else
+			stats.name = strcmp(ar->what, "main") == 0 ? "(main chunk)" : "(anonymous)";
+
+		if (strcmp(ar->what, "C") == 0)
+			stats.source = "[C]";
+		else
+			stats.source = fmt::format("{}:{}", ar->short_src, ar->linedefined);
+	}
+
+	auto& stats = functions_[i->second];
+	++stats.calls;
+	++stats.active;
+	call_stack_.push_back({ i->second, Clock::now() });
+}
+
+// -----------------------------------------------------------------------------
+// Records the return (at [time]) from the function call at the top of the
+// call stack
+// -----------------------------------------------------------------------------
+void ScriptMonitor::leaveFunction(Clock::time_point time)
+{
+	if (call_stack_.empty())
+		return;
+
+	auto call = call_stack_.back();
+	call_stack_.pop_back();
+
+	auto  elapsed = std::chrono::duration<double, std::milli>(time - call.start).count();
+	auto& stats   = functions_[call.function];
+	stats.self_ms += elapsed - call.child_ms;
+
+	// Only add the outermost call of a recursive function to its total time
+	if (--stats.active == 0)
+		stats.total_ms += elapsed;
+
+	if (!call_stack_.empty())
+		call_stack_.back().child_ms += elapsed;
+}
+
+// -----------------------------------------------------------------------------
+// Shows (and periodically updates) the watchdog progress dialog once the
+// script has been running for script_watchdog_time seconds.
+// Returns true if the user cancelled the dialog (ie. the script should be
+// interrupted)
+// -----------------------------------------------------------------------------
+bool ScriptMonitor::checkWatchdog()
+{
+	if (script_watchdog_time <= 0)
+		return false;
+
+	auto now = Clock::now();
+	if (!watchdog_dialog_)
+	{
+		if (now - start_time_ < std::chrono::seconds(script_watchdog_time))
+			return false;
+
+		watchdog_dialog_ = std::make_unique<wxProgressDialog>(
+			"Running Script",
+			wxString::Format("Running %s...", script_name_),
+			100,
+			lua::currentWindow(),
+			wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME);
+	}
+	else if (now - last_pulse_ < std::chrono::milliseconds(100))
+		return false;
+
+	last_pulse_ = now;
+	return !watchdog_dialog_->Pulse();
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the script running in lua [state] can and should be
+// suspended to update the UI
+// -----------------------------------------------------------------------------
+bool ScriptMonitor::shouldSuspend(lua_State* state)
+{
+#if LUA_VERSION_NUM >= 503
+	// Can only suspend coroutines, without any C functions in between
+	if (state == state_ || !lua_isyieldable(state))
+		return false;
+
+	if (suspend_requested || Clock::now() - last_suspend_ >= SUSPEND_INTERVAL)
+	{
+		suspend_requested = false;
+		return true;
+	}
+#endif
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Lua debug hook for the current monitor
+// -----------------------------------------------------------------------------
+void ScriptMonitor::hook(lua_State* state, lua_Debug* ar)
+{
+	if (!current_monitor)
+		return;
+
+	bool interrupt = false;
+	bool suspend   = false;
+	switch (ar->event)
+	{
+	case LUA_HOOKCALL: current_monitor->enterFunction(state, ar); break;
+#ifdef LUA_HOOKTAILCALL
+	case LUA_HOOKTAILCALL:
+		// A tail call replaces the current function (which won't get a return event)
+		current_monitor->leaveFunction(Clock::now());
+		current_monitor->enterFunction(state, ar);
+		break;
+#endif
+	case LUA_HOOKRET: current_monitor->leaveFunction(Clock::now()); break;
+	case LUA_HOOKCOUNT:
+		suspend   = current_monitor->shouldSuspend(state);
+		interrupt = !suspend && current_monitor->checkWatchdog();
+		break;
+	default: break;
+	}
+
+	// Raise the error/yield here, since neither luaL_error nor lua_yield
+	// return normally
+	if (interrupt)
+		luaL_error(state, "Script interrupted by user");
+	else if (suspend)
+		lua_yield(state, 0);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Writes the results of the last script profile to the console
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(lua_profile_dump, 0, true)
+{
+	ScriptMonitor::dumpLastProfile();
+}
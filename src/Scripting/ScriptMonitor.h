@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+
+struct lua_State;
+struct lua_Debug;
+class wxProgressDialog;
+
+namespace slade::lua
+{
+// Monitors a running lua script via lua debug hooks, for the lifetime of the
+// monitor.
+//
+// If the lua_profile cvar is enabled, calls are hooked to time each function
+// the script calls, both lua functions and exported C++ functions. The
+// results are written to the script log when the monitor is destroyed (and
+// can be shown again with the lua_profile_dump console command).
+//
+// Scripts run in a coroutine (see attach) are suspended periodically via an
+// instruction count hook, and on script progress updates, so the UI can be
+// updated before resuming them (see update).
+//
+// Once a script has run for script_watchdog_time seconds, a progress dialog
+// is shown that allows the script to be cancelled. Scripts that can't be
+// suspended update the dialog directly from the hook, and are interrupted via
+// a lua error if it is cancelled
+class ScriptMonitor
+{
+public:
+	struct FunctionStats
+	{
+		string   name;
+		string   source;        // Script and line the function is defined at, or [C] for C/C++ functions
+		unsigned calls    = 0;
+		double   total_ms = 0.; // Time spent in the function, including any functions it called
+		double   self_ms  = 0.; // Time spent in the function itself
+		unsigned active   = 0;  // Number of calls currently in progress (for recursion)
+	};
+
+	ScriptMonitor(lua_State* state, string_view script_name);
+	~ScriptMonitor();
+
+	// Non-copyable (the hook refers to the current monitor)
+	ScriptMonitor(const ScriptMonitor&)            = delete;
+	ScriptMonitor& operator=(const ScriptMonitor&) = delete;
+
+	void attach(lua_State* coroutine) const;
+	bool update();
+
+	static void requestSuspend();
+	static void dumpLastProfile();
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Call
+	{
+		unsigned          function;
+		Clock::time_point start;
+		double            child_ms = 0.;
+	};
+
+	lua_State*                      state_;
+	string                          script_name_;
+	bool                            profile_;
+	Clock::time_point               start_time_;
+	vector<FunctionStats>           functions_;
+	std::map<const void*, unsigned> function_index_; // Index in functions_ for each lua function
+	vector<Call>                    call_stack_;
+	unique_ptr<wxProgressDialog>    watchdog_dialog_;
+	Clock::time_point               last_pulse_;
+	Clock::time_point               last_suspend_;
+
+	void enterFunction(lua_State* state, lua_Debug* ar);
+	void leaveFunction(Clock::time_point time);
+	bool checkWatchdog();
+	bool shouldSuspend(lua_State* state);
+
+	static void hook(lua_State* state, lua_Debug* ar);
+};
+} // namespace slade::lua
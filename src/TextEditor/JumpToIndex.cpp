@@ -0,0 +1,309 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    JumpToIndex.cpp
+// Description: JumpToIndex class - keeps an index of the 'Jump To' points in
+//              a text editor, updated incrementally as the text is modified
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "JumpToIndex.h"
+#include "TextLanguage.h"
+#include "UI/TextEditorCtrl.h"
+#include "Utility/StringUtils.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Blanks out any block comments in [text], starting within a block comment
+// if [in_comment] is true. [in_comment] is set to true if [text] ends within a
+// block comment.
+// Line comments are left for the tokenizer to skip
+// -----------------------------------------------------------------------------
+void blankBlockComments(string& text, bool& in_comment)
+{
+	for (size_t a = 0; a < text.size(); ++a)
+	{
+		if (in_comment)
+		{
+			// End of block comment
+			if (text[a] == '*' && a + 1 < text.size() && text[a + 1] == '/')
+			{
+				text[a]     = ' ';
+				text[a + 1] = ' ';
+				in_comment  = false;
+				++a;
+			}
+			else
+				text[a] = ' ';
+
+			continue;
+		}
+
+		// Skip quoted strings
+		if (text[a] == '"')
+		{
+			for (++a; a < text.size() && text[a] != '"'; ++a)
+				if (text[a] == '\\')
+					++a;
+
+			continue;
+		}
+
+		if (text[a] == '/' && a + 1 < text.size())
+		{
+			// Line comment, nothing more to check
+			if (text[a + 1] == '/')
+				return;
+
+			// Start of block comment
+			if (text[a + 1] == '*')
+			{
+				text[a]     = ' ';
+				text[a + 1] = ' ';
+				in_comment  = true;
+				++a;
+			}
+		}
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// JumpToIndex Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// JumpToIndex class constructor
+// -----------------------------------------------------------------------------
+JumpToIndex::JumpToIndex()
+{
+	tz_.setSpecialCharacters(";,:|={}/()");
+}
+
+// -----------------------------------------------------------------------------
+// Sets the jump blocks (and ignored words) to look for from [language], and
+// clears the index
+// -----------------------------------------------------------------------------
+void JumpToIndex::setLanguage(const TextLanguage* language)
+{
+	blocks_.clear();
+	ignore_.clear();
+	clear();
+
+	if (!language)
+		return;
+
+	// Jump blocks are in the form 'keyword[:skip]'
+	for (const auto& block : language->jumpBlocks())
+	{
+		auto& jb   = blocks_.emplace_back();
+		auto  sp   = strutil::split(block, ':');
+		jb.keyword = sp[0];
+		if (sp.size() > 1)
+			strutil::toInt(sp.back(), jb.skip);
+	}
+
+	ignore_ = language->jumpBlocksIgnored();
+}
+
+// -----------------------------------------------------------------------------
+// Clears the index (all lines will be rescanned on the next update)
+// -----------------------------------------------------------------------------
+void JumpToIndex::clear()
+{
+	lines_.clear();
+	jump_points_.clear();
+	points_changed_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Updates the index after text was modified on [line], adding [lines_added]
+// lines (removing if negative)
+// -----------------------------------------------------------------------------
+void JumpToIndex::textModified(int line, int lines_added)
+{
+	if (line >= static_cast<int>(lines_.size()))
+		return;
+
+	lines_[line].scanned = false;
+	if (lines_added > 0)
+		lines_.insert(lines_.begin() + line + 1, lines_added, LineInfo{});
+	else if (lines_added < 0)
+		lines_.erase(
+			lines_.begin() + std::min<int>(line + 1, lines_.size()),
+			lines_.begin() + std::min<int>(line + 1 - lines_added, lines_.size()));
+
+	// Following jump points have moved
+	if (lines_added != 0)
+		points_changed_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Rescans any lines in [editor] that have changed since the last update.
+// Returns true if the jump points changed
+// -----------------------------------------------------------------------------
+bool JumpToIndex::update(TextEditorCtrl* editor)
+{
+	auto n_lines = editor->GetLineCount();
+	if (blocks_.empty())
+	{
+		auto changed = !jump_points_.empty();
+		clear();
+		points_changed_ = false;
+		return changed;
+	}
+
+	// Rescan lines that were modified, or that start in a different state
+	// than when they were last scanned
+	lines_.resize(n_lines);
+	ScanState state;
+	bool      changed = points_changed_;
+	for (int l = 0; l < n_lines; ++l)
+	{
+		auto& info = lines_[l];
+		if (!info.scanned || info.start != state)
+		{
+			auto names  = std::move(info.names);
+			auto buffer = editor->GetLineRaw(l);
+			info.start  = state;
+			scanLine({ buffer.data(), buffer.length() }, info);
+			if (info.names != names)
+				changed = true;
+		}
+
+		state = info.end;
+	}
+
+	points_changed_ = false;
+	if (!changed)
+		return false;
+
+	// Rebuild jump points list (sorted by line)
+	jump_points_.clear();
+	for (int l = 0; l < n_lines; ++l)
+		for (const auto& name : lines_[l].names)
+			jump_points_.push_back({ l, name });
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Scans [text] (a single line) for jump points, starting from [info]'s start
+// state
+// -----------------------------------------------------------------------------
+void JumpToIndex::scanLine(string_view text, LineInfo& info)
+{
+	auto state = info.start;
+	info.names.clear();
+
+	// Remove block comments
+	string line{ text };
+	blankBlockComments(line, state.in_comment);
+
+	// Process tokens
+	tz_.openString(line);
+	for (auto* token = &tz_.current(); token->valid; token = &tz_.next())
+		processToken(token->view(), state, info.names);
+
+	info.end     = state;
+	info.scanned = true;
+}
+
+// -----------------------------------------------------------------------------
+// Processes [token], updating [state] and adding any found jump point names to
+// [names]
+// -----------------------------------------------------------------------------
+void JumpToIndex::processToken(string_view token, ScanState& state, vector<string>& names) const
+{
+	// Waiting for a jump block name
+	if (state.block >= 0)
+	{
+		// Skip tokens before the name
+		if (state.skip > 0)
+		{
+			--state.skip;
+			return;
+		}
+
+		// Check ignored words (the next token is the name instead)
+		while (state.ignore < ignore_.size())
+			if (strutil::equalCI(token, ignore_[state.ignore++]))
+				return;
+
+		auto& block = blocks_[state.block];
+		state.block = -1;
+
+		// Numbered block, add block name
+		if (strutil::isInteger(string{ token }, false))
+			names.push_back(fmt::format("{} {}", block.keyword, token));
+
+		// Unnamed block, use block name
+		else if (token == "{" || token == ";")
+			names.push_back(block.keyword);
+
+		else
+			names.emplace_back(token);
+
+		return;
+	}
+
+	// Skip blocks
+	if (state.in_block)
+	{
+		if (token == "}")
+			state.in_block = false;
+		return;
+	}
+	if (token == "{")
+	{
+		state.in_block = true;
+		return;
+	}
+
+	// Check for jump block keyword
+	for (unsigned a = 0; a < blocks_.size(); ++a)
+		if (strutil::equalCI(token, blocks_[a].keyword))
+		{
+			state.block  = a;
+			state.skip   = blocks_[a].skip;
+			state.ignore = 0;
+			return;
+		}
+}
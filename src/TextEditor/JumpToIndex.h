@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Utility/Tokenizer.h"
+
+namespace slade
+{
+class TextEditorCtrl;
+class TextLanguage;
+
+// An index of the 'Jump To' points (named blocks, eg. scripts or classes) in
+// a text editor, kept up to date incrementally. Only modified lines are
+// rescanned, along with any following lines until the scan state at the start
+// of a line matches what it was when it was last scanned
+class JumpToIndex
+{
+public:
+	struct JumpPoint
+	{
+		int    line;
+		string name;
+	};
+
+	JumpToIndex();
+
+	const vector<JumpPoint>& jumpPoints() const { return jump_points_; }
+
+	void setLanguage(const TextLanguage* language);
+	void clear();
+	void textModified(int line, int lines_added);
+	bool update(TextEditorCtrl* editor);
+
+private:
+	struct JumpBlock
+	{
+		string keyword;
+		int    skip = 0; // Number of tokens to skip before the block name
+	};
+
+	// Scanner state between tokens (and lines)
+	struct ScanState
+	{
+		bool     in_comment = false; // Within a block comment
+		bool     in_block   = false; // Within a { } block
+		int      block      = -1;    // Jump block keyword found, waiting for its name
+		int      skip       = 0;     // Tokens left to skip before the block name
+		unsigned ignore     = 0;     // Next ignored word to check the block name against
+
+		bool operator==(const ScanState& other) const
+		{
+			return in_comment == other.in_comment && in_block == other.in_block && block == other.block
+				   && skip == other.skip && ignore == other.ignore;
+		}
+		bool operator!=(const ScanState& other) const { return !(*this == other); }
+	};
+
+	struct LineInfo
+	{
+		ScanState      start;
+		ScanState      end;
+		vector<string> names;
+		bool           scanned = false;
+	};
+
+	vector<JumpBlock> blocks_;
+	vector<string>    ignore_;
+	vector<LineInfo>  lines_;
+	vector<JumpPoint> jump_points_;
+	bool              points_changed_ = true;
+	Tokenizer         tz_;
+
+	void scanLine(string_view text, LineInfo& info);
+	void processToken(string_view token, ScanState& state, vector<string>& names) const;
+};
+} // namespace slade
@@ -145,24 +145,22 @@ void Lexer::doStyling(TextEditorCtrl* editor, int start, int end)
 		}
 	}
 
-	// Set current & next line's info
-	lines_[line].fold_increment = state.fold_increment;
-	lines_[line].has_word       = state.has_word;
+	// Set current line's info
+	auto& info          = lineInfo(line);
+	info.fold_increment = state.fold_increment;
+	info.has_word       = state.has_word;
+	info.styled         = true;
 }
 
 // ----------------------------------------------------------------------------
-// Updates and styles comments in [editor], for characters from [start] to
-// [end].
+// Updates comment blocks in [editor], for characters from [start] to [end].
+// Returns the position up to which comment blocks may have changed, which can
+// be past [end] (eg. if a block comment was opened or closed)
 // ----------------------------------------------------------------------------
-void Lexer::updateComments(TextEditorCtrl* editor, int start, int end)
+int Lexer::updateComments(TextEditorCtrl* editor, int start, int end)
 {
 	if (!language_)
-		return;
-
-	// Block comment handling
-	auto& block_begin = language_->commentBeginL();
-	auto& block_end   = language_->commentEndL();
-	int   token_index;
+		return end;
 
 	// Extend start/end if either is within a comment
 	auto cb = isWithinComment(start);
@@ -172,19 +170,44 @@ void Lexer::updateComments(TextEditorCtrl* editor, int start, int end)
 	if (cb >= 0)
 		end = comment_blocks_[cb].end_pos;
 
-	// Remove any existing comment blocks within start->end
-	for (int i = comment_blocks_.size() - 1; i >= 0; --i)
+	// Scan text
+	vector<CommentBlock> blocks;
+	auto                 pos = scanComments(editor, start, end, blocks);
+
+	// Get the range of existing comment blocks that start within the scanned text
+	auto start_before = [](const CommentBlock& block, int position) { return block.start_pos < position; };
+	auto first        = std::lower_bound(comment_blocks_.begin(), comment_blocks_.end(), start, start_before);
+	auto last         = std::lower_bound(first, comment_blocks_.end(), pos, start_before);
+
+	// If the scan ended within an existing block, the rest of it needs scanning
+	// too since it may not be a comment any more
+	while (last != first && (last - 1)->end_pos > pos)
 	{
-		if (comment_blocks_[i].start_pos >= start && comment_blocks_[i].end_pos <= end)
-			comment_blocks_.erase(comment_blocks_.begin() + i);
+		pos  = scanComments(editor, pos, (last - 1)->end_pos, blocks);
+		last = std::lower_bound(last, comment_blocks_.end(), pos, start_before);
 	}
 
-	// Do not look for comments if no language is loaded
-	if (!language_)
-		return;
+	// Replace them with the new blocks (keeping comment_blocks_ sorted)
+	auto index = first - comment_blocks_.begin();
+	comment_blocks_.erase(first, last);
+	comment_blocks_.insert(comment_blocks_.begin() + index, blocks.begin(), blocks.end());
+
+	return std::max(pos, end);
+}
+
+// ----------------------------------------------------------------------------
+// Scans the text in [editor] from [pos] to [end] for comments, adding them to
+// [blocks]. A block comment beginning before [end] is scanned to its end token
+// (or the end of the text).
+// Returns the position the scan ended at
+// ----------------------------------------------------------------------------
+int Lexer::scanComments(TextEditorCtrl* editor, int pos, int end, vector<CommentBlock>& blocks) const
+{
+	auto& block_begin = language_->commentBeginL();
+	auto& block_end   = language_->commentEndL();
+	auto  text_end    = editor->GetTextLength();
+	int   token_index;
 
-	// Scan text
-	auto pos = start;
 	while (pos < end)
 	{
 		// Skip quoted strings
@@ -202,7 +225,7 @@ void Lexer::updateComments(TextEditorCtrl* editor, int start, int end)
 		if (checkToken(editor, pos, language_->lineCommentL()))
 		{
 			const auto l_end = editor->GetLineEndPosition(editor->LineFromPosition(pos)) + 1;
-			comment_blocks_.push_back({ pos, l_end });
+			blocks.push_back({ pos, l_end });
 			pos = l_end;
 			continue;
 		}
@@ -213,7 +236,7 @@ void Lexer::updateComments(TextEditorCtrl* editor, int start, int end)
 			auto& end_token = block_end[token_index];
 			auto  cb_start  = pos;
 			pos += block_begin[token_index].size();
-			while (pos < end)
+			while (pos < text_end)
 			{
 				if (checkToken(editor, pos, end_token))
 				{
@@ -223,12 +246,61 @@ void Lexer::updateComments(TextEditorCtrl* editor, int start, int end)
 				++pos;
 			}
 
-			comment_blocks_.push_back({ cb_start, pos });
+			blocks.push_back({ cb_start, pos });
 			continue;
 		}
 
 		++pos;
 	}
+
+	return pos;
+}
+
+// -----------------------------------------------------------------------------
+// Updates comment blocks and line info after text was modified in the editor.
+// [length] characters were inserted at [position] (removed if negative), on
+// [line], adding [lines_added] lines (removing if negative)
+// -----------------------------------------------------------------------------
+void Lexer::textModified(int position, int length, int line, int lines_added)
+{
+	// Move comment blocks after the modified text, removing any that were
+	// deleted entirely
+	for (auto& block : comment_blocks_)
+	{
+		if (block.start_pos > position)
+			block.start_pos = std::max(block.start_pos + length, position);
+		if (block.end_pos > position)
+			block.end_pos = std::max(block.end_pos + length, position);
+	}
+	comment_blocks_.erase(
+		std::remove_if(
+			comment_blocks_.begin(),
+			comment_blocks_.end(),
+			[](const CommentBlock& block) { return block.end_pos <= block.start_pos; }),
+		comment_blocks_.end());
+
+	// Move line info after the modified line, the modified line and any added
+	// lines need restyling
+	if (line >= static_cast<int>(lines_.size()))
+		return;
+	lines_[line].styled = false;
+	if (lines_added > 0)
+		lines_.insert(lines_.begin() + line + 1, lines_added, LineInfo{});
+	else if (lines_added < 0)
+		lines_.erase(
+			lines_.begin() + std::min<int>(line + 1, lines_.size()),
+			lines_.begin() + std::min<int>(line + 1 - lines_added, lines_.size()));
+}
+
+// -----------------------------------------------------------------------------
+// Returns the first line from [line] onwards that needs (re)styling
+// -----------------------------------------------------------------------------
+int Lexer::firstUnstyledLine(int line) const
+{
+	while (line < static_cast<int>(lines_.size()) && lines_[line].styled)
+		++line;
+
+	return line;
 }
 
 // -----------------------------------------------------------------------------
@@ -671,33 +743,74 @@ bool Lexer::checkToken(TextEditorCtrl* editor, int pos, const vector<string>& to
 // Checks if [pos] is within a block comment, and returns the index for
 // comment_blocks_ if it is (-1 otherwise)
 // ----------------------------------------------------------------------------
-int Lexer::isWithinComment(int pos)
+int Lexer::isWithinComment(int pos) const
 {
-	for (unsigned i = 0; i < comment_blocks_.size(); ++i)
-		if (pos >= comment_blocks_[i].start_pos && pos < comment_blocks_[i].end_pos)
-			return i;
+	// Find the last block starting at or before [pos]
+	auto block = std::upper_bound(
+		comment_blocks_.begin(),
+		comment_blocks_.end(),
+		pos,
+		[](int position, const CommentBlock& cb) { return position < cb.start_pos; });
+
+	if (block != comment_blocks_.begin() && pos < (block - 1)->end_pos)
+		return block - comment_blocks_.begin() - 1;
 
 	return -1;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the info for [line], adding it if needed
+// -----------------------------------------------------------------------------
+Lexer::LineInfo& Lexer::lineInfo(int line)
+{
+	if (line >= static_cast<int>(lines_.size()))
+		lines_.resize(line + 1);
+
+	return lines_[line];
+}
+
 // ---------------------------------------------------------------------------
-// Updates code folding levels in [editor], starting from line [line_start]
+// Updates code folding levels in [editor] for lines [line_start] to
+// [line_end], continuing until the fold levels match the previous update
 // -----------------------------------------------------------------------------
-void Lexer::updateFolding(TextEditorCtrl* editor, int line_start)
+void Lexer::updateFolding(TextEditorCtrl* editor, int line_start, int line_end)
 {
-	int fold_level = editor->GetFoldLevel(line_start) & wxSTC_FOLDLEVELNUMBERMASK;
+	// Get fold level at the start of the first line
+	int fold_level = wxSTC_FOLDLEVELBASE;
+	if (line_start > 0)
+	{
+		auto& prev = lineInfo(line_start - 1);
+		if (prev.fold_level >= 0)
+			fold_level = std::max(prev.fold_level + prev.fold_increment, wxSTC_FOLDLEVELBASE);
+		else
+			fold_level = editor->GetFoldLevel(line_start) & wxSTC_FOLDLEVELNUMBERMASK;
+	}
 
 	for (int l = line_start; l < editor->GetLineCount(); l++)
 	{
+		auto& info = lineInfo(l);
+
 		// Determine next line's fold level
-		int next_level = fold_level + lines_[l].fold_increment;
+		int next_level = fold_level + info.fold_increment;
 		if (next_level < wxSTC_FOLDLEVELBASE)
 			next_level = wxSTC_FOLDLEVELBASE;
 
+		// Past the updated lines, stop at a line that hasn't been styled yet
+		// (it is folded when it is styled), or once the fold level coming into
+		// a line is the same as last time (so the following levels are too)
+		if (l > line_end && (!info.styled || info.fold_level == fold_level))
+		{
+			// The line may still move its fold header up to the previous line
+			if (info.styled && next_level > fold_level && !info.has_word)
+				editor->SetFoldLevel(l - 1, fold_level | wxSTC_FOLDLEVELHEADERFLAG);
+			break;
+		}
+		info.fold_level = fold_level;
+
 		// Check if we are going up a fold level
 		if (next_level > fold_level)
 		{
-			if (!lines_[l].has_word)
+			if (!info.has_word)
 			{
 				// Line doesn't have any words (eg. only has an opening brace),
 				// move the fold header up a line
@@ -33,7 +33,9 @@ public:
 	virtual void loadLanguage(TextLanguage* language);
 
 	virtual void doStyling(TextEditorCtrl* editor, int start, int end);
-	void         updateComments(TextEditorCtrl* editor, int start, int end);
+	int          updateComments(TextEditorCtrl* editor, int start, int end);
+	void         textModified(int position, int length, int line, int lines_added);
+	int          firstUnstyledLine(int line) const;
 
 	virtual void addWord(string_view word, int style);
 	virtual void clearWords() { word_list_.clear(); }
@@ -42,7 +44,7 @@ public:
 	void setWordChars(string_view chars);
 	void setOperatorChars(string_view chars);
 
-	void updateFolding(TextEditorCtrl* editor, int line_start);
+	void updateFolding(TextEditorCtrl* editor, int line_start, int line_end);
 	void foldComments(bool fold) { fold_comments_ = fold; }
 	void foldPreprocessor(bool fold) { fold_preprocessor_ = fold; }
 
@@ -79,13 +81,17 @@ protected:
 	};
 	std::map<string, WLIndex> word_list_;
 
+	// Per-line info, kept as a checkpoint of the lexer state from when the
+	// line was last styled, so an edit only needs to restyle and refold lines
+	// until the state matches again
 	struct LineInfo
 	{
-		int  fold_increment;
-		bool has_word;
-		LineInfo() : fold_increment{ 0 }, has_word{ false } {}
+		int  fold_increment = 0;
+		bool has_word       = false;
+		bool styled         = false; // False if the line needs (re)styling
+		int  fold_level     = -1;    // Fold level at the start of the line when last folded
 	};
-	std::map<int, LineInfo> lines_;
+	vector<LineInfo> lines_;
 
 	struct CommentBlock
 	{
@@ -115,7 +121,9 @@ protected:
 	virtual void styleWord(LexerState& state, string_view word);
 	bool         checkToken(TextEditorCtrl* editor, int pos, string_view token) const;
 	bool checkToken(TextEditorCtrl* editor, int pos, const vector<string>& tokens, int* found_idx = nullptr) const;
-	int  isWithinComment(int pos);
+	int       isWithinComment(int pos) const;
+	int       scanComments(TextEditorCtrl* editor, int pos, int end, vector<CommentBlock>& blocks) const;
+	LineInfo& lineInfo(int line);
 };
 
 class ZScriptLexer : public Lexer
@@ -50,6 +50,7 @@ using namespace slade;
 //
 // -----------------------------------------------------------------------------
 vector<TextLanguage*> text_languages;
+bool                  text_languages_loaded = false; // Builtin definitions are loaded on first use
 
 
 // -----------------------------------------------------------------------------
@@ -275,7 +276,9 @@ void TextLanguage::copyTo(TextLanguage* copy) const
 		copy->word_lists_[a] = word_lists_[a];
 
 	// Copy functions
-	copy->functions_ = functions_;
+	copy->functions_            = functions_;
+	copy->function_index_dirty_ = true;
+	copy->autocomp_trie_dirty_  = true;
 
 	// Copy preprocessor/word block begin/end
 	copy->pp_block_begin_   = pp_block_begin_;
@@ -292,7 +295,10 @@ void TextLanguage::addWord(WordType type, string_view keyword, bool custom)
 	// Add only if it doesn't already exist
 	auto& list = custom ? word_lists_custom_[type].list : word_lists_[type].list;
 	if (std::find(list.begin(), list.end(), keyword) == list.end())
+	{
 		list.emplace_back(keyword);
+		autocomp_trie_dirty_ = true;
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -322,10 +328,7 @@ void TextLanguage::addFunction(
 
 	// If it doesn't, create it
 	if (!func)
-	{
-		functions_.emplace_back(func_name);
-		func = &functions_.back();
-	}
+		func = &newFunction(func_name);
 	// Clear the function if we're replacing it
 	else if (replace)
 	{
@@ -362,10 +365,7 @@ void TextLanguage::loadZScript(const zscript::Definitions& defs, bool custom)
 
 			// If it doesn't, create it
 			if (!func)
-			{
-				functions_.emplace_back(f.name());
-				func = &functions_.back();
-			}
+				func = &newFunction(f.name());
 
 			// Add the context
 			if (!func->hasContext(f.baseClass()))
@@ -417,41 +417,37 @@ string TextLanguage::functionsList() const
 }
 
 // -----------------------------------------------------------------------------
-// Returns a string containing all words and functions that can be used
-// directly in scintilla for an autocompletion list
+// Returns a string containing all words and functions beginning with [start]
+// that can be used directly in scintilla for an autocompletion list.
+// If [extra] is given, any matching words in it are also included (with
+// their own trie word type as the scintilla image id, or none if 0)
 // -----------------------------------------------------------------------------
-string TextLanguage::autocompletionList(string_view start, bool include_custom)
+string TextLanguage::autocompletionList(string_view start, bool include_custom, const PrefixTrie* extra)
 {
-	// Firstly, add all functions and word lists to a vector
-	vector<string> list;
+	updateAutocompletionTrie();
 
-	// Add word lists
-	for (unsigned type = 0; type < 4; type++)
+	// Get matching words, sorted in the (case-insensitive) order scintilla expects
+	vector<const PrefixTrie::Word*> matches;
+	autocomp_trie_.findPrefix(start, matches, include_custom);
+	if (extra)
 	{
-		for (auto& word : word_lists_[type].list)
-			if (strutil::startsWithCI(word, start))
-				list.push_back(fmt::format("{}?{}", word, type + 1));
-
-		if (!include_custom)
-			continue;
-
-		for (auto& word : word_lists_custom_[type].list)
-			if (strutil::startsWithCI(word, start))
-				list.push_back(fmt::format("{}?{}", word, type + 1));
+		extra->findPrefix(start, matches);
+		std::stable_sort(
+			matches.begin(),
+			matches.end(),
+			[](const PrefixTrie::Word* left, const PrefixTrie::Word* right)
+			{ return PrefixTrie::lessFolded(left->word, right->word); });
 	}
 
-	// Add functions
-	for (auto& func : functions_)
-		if (strutil::startsWithCI(func.name(), start))
-			list.push_back(fmt::format("{}{}", func.name(), "?5"));
-
-	// Sort the list
-	std::sort(list.begin(), list.end());
-
 	// Now build a string of the list items separated by spaces
 	string ret;
-	for (const auto& a : list)
-		ret.append(a).append(" ");
+	for (const auto* match : matches)
+	{
+		ret.append(match->word);
+		if (match->type > 0)
+			ret.append("?").append(std::to_string(match->type));
+		ret.append(" ");
+	}
 
 	return ret;
 }
@@ -522,22 +518,10 @@ bool TextLanguage::isFunction(string_view word) const
 // -----------------------------------------------------------------------------
 TLFunction* TextLanguage::function(string_view name)
 {
-	// Find function matching [name]
-	if (case_sensitive_)
-	{
-		for (auto& func : functions_)
-			if (func.name() == name)
-				return &func;
-	}
-	else
-	{
-		for (auto& func : functions_)
-			if (strutil::equalCI(func.name(), name))
-				return &func;
-	}
+	updateFunctionIndex();
 
-	// Not found
-	return nullptr;
+	auto i = function_index_.find(functionKey(name));
+	return i != function_index_.end() ? &functions_[i->second] : nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -556,6 +540,76 @@ void TextLanguage::clearCustomDefs()
 
 	for (auto& a : word_lists_custom_)
 		a.list.clear();
+
+	function_index_dirty_ = true;
+	autocomp_trie_dirty_  = true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the key for function [name] in the function index
+// (lower case if the language isn't case sensitive)
+// -----------------------------------------------------------------------------
+string TextLanguage::functionKey(string_view name) const
+{
+	return case_sensitive_ ? string{ name } : strutil::lower(name);
+}
+
+// -----------------------------------------------------------------------------
+// Adds a new (empty) function [name] to the language and returns it.
+// Does not check if the function already exists
+// -----------------------------------------------------------------------------
+TLFunction& TextLanguage::newFunction(string_view name)
+{
+	auto& func = functions_.emplace_back(name);
+
+	if (!function_index_dirty_)
+		function_index_.emplace(functionKey(name), static_cast<unsigned>(functions_.size() - 1));
+	autocomp_trie_dirty_ = true;
+
+	return func;
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the function name index if the functions have changed since it was
+// last built
+// -----------------------------------------------------------------------------
+void TextLanguage::updateFunctionIndex()
+{
+	if (!function_index_dirty_)
+		return;
+
+	// If multiple functions have the same key the first one is used, as the
+	// previous linear search did
+	function_index_.clear();
+	function_index_.reserve(functions_.size());
+	for (unsigned a = 0; a < functions_.size(); ++a)
+		function_index_.emplace(functionKey(functions_[a].name()), a);
+
+	function_index_dirty_ = false;
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the autocompletion trie if the words or functions have changed since
+// it was last built. Words are given their type + 1 as the trie word type
+// (the scintilla autocompletion image id), and functions 5
+// -----------------------------------------------------------------------------
+void TextLanguage::updateAutocompletionTrie()
+{
+	if (!autocomp_trie_dirty_)
+		return;
+
+	autocomp_trie_.clear();
+	for (unsigned type = 0; type < 4; type++)
+	{
+		for (auto& word : word_lists_[type].list)
+			autocomp_trie_.insert(word, type + 1);
+		for (auto& word : word_lists_custom_[type].list)
+			autocomp_trie_.insert(word, type + 1, true);
+	}
+	for (auto& func : functions_)
+		autocomp_trie_.insert(func.name(), 5);
+
+	autocomp_trie_dirty_ = false;
 }
 
 
@@ -884,10 +938,16 @@ bool TextLanguage::readLanguageDefinition(MemChunk& mc, string_view source)
 }
 
 // -----------------------------------------------------------------------------
-// Loads all text language definitions from slade.pk3
+// Loads all text language definitions from slade.pk3, if they haven't been
+// already. This is done on first use of any of the language lookup functions
+// below rather than at startup
 // -----------------------------------------------------------------------------
 bool TextLanguage::loadLanguages()
 {
+	if (text_languages_loaded)
+		return true;
+	text_languages_loaded = true;
+
 	// Get slade resource archive
 	auto* res_archive = app::archiveManager().programResourceArchive();
 
@@ -927,6 +987,8 @@ bool TextLanguage::loadLanguages()
 // -----------------------------------------------------------------------------
 TextLanguage* TextLanguage::fromId(string_view id)
 {
+	loadLanguages();
+
 	// Find text language matching [id]
 	for (auto& text_language : text_languages)
 	{
@@ -944,6 +1006,8 @@ TextLanguage* TextLanguage::fromId(string_view id)
 // -----------------------------------------------------------------------------
 TextLanguage* TextLanguage::fromIndex(unsigned index)
 {
+	loadLanguages();
+
 	// Check index
 	if (index >= text_languages.size())
 		return nullptr;
@@ -956,6 +1020,8 @@ TextLanguage* TextLanguage::fromIndex(unsigned index)
 // -----------------------------------------------------------------------------
 TextLanguage* TextLanguage::fromName(string_view name)
 {
+	loadLanguages();
+
 	// Find text language matching [name]
 	for (auto& text_language : text_languages)
 	{
@@ -972,6 +1038,8 @@ TextLanguage* TextLanguage::fromName(string_view name)
 // -----------------------------------------------------------------------------
 vector<string> TextLanguage::languageNames()
 {
+	loadLanguages();
+
 	vector<string> ret;
 
 	for (auto& text_language : text_languages)
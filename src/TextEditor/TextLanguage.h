@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Utility/PrefixTrie.h"
+
 namespace slade
 {
 namespace zscript
@@ -137,7 +139,11 @@ public:
 	void setCommentEndList(vector<string> token) { comment_end_l_ = std::move(token); }
 	void setPreprocessor(string_view token) { preprocessor_ = token; }
 	void setDocComment(string_view token) { doc_comment_ = token; }
-	void setCaseSensitive(bool cs) { case_sensitive_ = cs; }
+	void setCaseSensitive(bool cs)
+	{
+		case_sensitive_       = cs;
+		function_index_dirty_ = true;
+	}
 	void addWord(WordType type, string_view word, bool custom = false);
 	void addFunction(
 		string_view name,
@@ -150,7 +156,7 @@ public:
 
 	string wordList(WordType type, bool include_custom = true) const;
 	string functionsList() const;
-	string autocompletionList(string_view start = "", bool include_custom = true);
+	string autocompletionList(string_view start = "", bool include_custom = true, const PrefixTrie* extra = nullptr);
 
 	vector<string> wordListSorted(WordType type, bool include_custom = true) const;
 	vector<string> functionsSorted() const;
@@ -163,8 +169,17 @@ public:
 
 	TLFunction* function(string_view name);
 
-	void clearWordList(WordType type) { word_lists_[type].list.clear(); }
-	void clearFunctions() { functions_.clear(); }
+	void clearWordList(WordType type)
+	{
+		word_lists_[type].list.clear();
+		autocomp_trie_dirty_ = true;
+	}
+	void clearFunctions()
+	{
+		functions_.clear();
+		function_index_dirty_ = true;
+		autocomp_trie_dirty_  = true;
+	}
 	void clearCustomDefs();
 
 	// Static functions
@@ -210,6 +225,12 @@ private:
 	vector<TLFunction> functions_;
 	string             f_lookup_url_;
 
+	// Lookup structures, rebuilt on demand when the words/functions change
+	std::unordered_map<string, unsigned> function_index_; // functions_ index by name (lower case if case-insensitive)
+	bool                                 function_index_dirty_ = true;
+	PrefixTrie                           autocomp_trie_;
+	bool                                 autocomp_trie_dirty_ = true;
+
 	// Zscript function properties which cannot be parsed from (g)zdoom.pk3
 	struct ZFuncExProp
 	{
@@ -217,5 +238,10 @@ private:
 		string deprecated_f;
 	};
 	std::map<string, ZFuncExProp> zfuncs_ex_props_;
+
+	string      functionKey(string_view name) const;
+	TLFunction& newFunction(string_view name);
+	void        updateFunctionIndex();
+	void        updateAutocompletionTrie();
 };
 } // namespace slade
@@ -796,7 +796,7 @@ bool StyleSet::loadResourceStyles()
 		{
 			auto newset       = std::make_unique<StyleSet>();
 			newset->built_in_ = true;
-			if (newset->parseSet(dynamic_cast<ParseTreeNode*>(node)))
+			if (newset->parseSet(Parser::node(node)))
 				style_sets.push_back(std::move(newset));
 		}
 	}
@@ -825,7 +825,7 @@ bool StyleSet::loadResourceStyles()
 		{
 			auto newset       = std::make_unique<StyleSet>();
 			newset->built_in_ = true;
-			if (newset->parseSet(dynamic_cast<ParseTreeNode*>(node)))
+			if (newset->parseSet(Parser::node(node)))
 				style_sets.push_back(std::move(newset));
 		}
 	}
@@ -859,7 +859,7 @@ bool StyleSet::loadCustomStyles()
 		for (auto& node : nodes)
 		{
 			auto newset = std::make_unique<StyleSet>();
-			if (newset->parseSet(dynamic_cast<ParseTreeNode*>(node)))
+			if (newset->parseSet(Parser::node(node)))
 				style_sets.push_back(std::move(newset));
 		}
 	}
@@ -81,7 +81,6 @@ CVAR(Bool, txed_fr_matchcase, false, CVar::Save)
 CVAR(Bool, txed_fr_matchword, false, CVar::Save)
 CVAR(Bool, txed_fr_matchword_start, false, CVar::Save)
 
-wxDEFINE_EVENT(wxEVT_COMMAND_JTCALCULATOR_COMPLETED, wxThreadEvent);
 wxDEFINE_EVENT(wxEVT_TEXT_CHANGED, wxCommandEvent);
 
 
@@ -109,83 +108,6 @@ int searchFlags()
 }
 } // namespace
 
-// -----------------------------------------------------------------------------
-//
-// JumpToCalculator Class Functions
-//
-// -----------------------------------------------------------------------------
-
-
-// -----------------------------------------------------------------------------
-// JumpToCalculator thread entry function
-// -----------------------------------------------------------------------------
-wxThread::ExitCode JumpToCalculator::Entry()
-{
-	wxString jump_points;
-
-	Tokenizer tz;
-	tz.setSpecialCharacters(";,:|={}/()");
-	tz.openString(text_);
-
-	wxString token = tz.getToken();
-	while (!tz.atEnd())
-	{
-		if (token == "{")
-		{
-			// Skip block
-			while (!tz.atEnd() && token != "}")
-				token = tz.getToken();
-		}
-
-		for (auto block : block_names_)
-		{
-			// Get jump block keyword
-			long skip = 0;
-			if (strutil::contains(block, ':'))
-			{
-				auto sp = wxSplit(block, ':');
-				sp.back().ToLong(&skip);
-				block = sp[0];
-			}
-
-			if (S_CMPNOCASE(token, block))
-			{
-				wxString name = tz.getToken();
-				for (int s = 0; s < skip; s++)
-					name = tz.getToken();
-
-				for (const auto& i : ignore_)
-					if (S_CMPNOCASE(name, i))
-						name = tz.getToken();
-
-				// Numbered block, add block name
-				if (name.IsNumber())
-					name = wxString::Format("%s %s", block, name);
-				// Unnamed block, use block name
-				if (name == "{" || name == ";")
-					name = block;
-
-				// Add jump point
-				jump_points += wxString::Format("%d,%s,", tz.lineNo() - 1, name);
-			}
-		}
-
-		token = tz.getToken();
-	}
-
-	// Remove ending comma
-	if (!jump_points.empty())
-		jump_points.RemoveLast(1);
-
-	// Send event
-	auto event = new wxThreadEvent(wxEVT_COMMAND_JTCALCULATOR_COMPLETED);
-	event->SetString(jump_points);
-	wxQueueEvent(handler_, event);
-
-	return nullptr;
-}
-
-
 // -----------------------------------------------------------------------------
 //
 // TextEditorCtrl Class Functions
@@ -250,10 +172,11 @@ TextEditorCtrl::TextEditorCtrl(wxWindow* parent, int id) :
 	Bind(wxEVT_KILL_FOCUS, &TextEditorCtrl::onFocusLoss, this);
 	Bind(wxEVT_ACTIVATE, &TextEditorCtrl::onActivate, this);
 	Bind(wxEVT_STC_MARGINCLICK, &TextEditorCtrl::onMarginClick, this);
-	Bind(wxEVT_COMMAND_JTCALCULATOR_COMPLETED, &TextEditorCtrl::onJumpToCalculateComplete, this);
 	Bind(wxEVT_STC_CHANGE, &TextEditorCtrl::onModified, this);
 	Bind(wxEVT_TIMER, &TextEditorCtrl::onUpdateTimer, this);
 	Bind(wxEVT_STC_STYLENEEDED, &TextEditorCtrl::onStyleNeeded, this);
+	Bind(wxEVT_STC_MODIFIED, &TextEditorCtrl::onTextModified, this);
+	Bind(wxEVT_IDLE, &TextEditorCtrl::onIdle, this);
 }
 
 // -----------------------------------------------------------------------------
@@ -416,8 +339,8 @@ bool TextEditorCtrl::setLanguage(TextLanguage* lang)
 		// Load to lexer
 		lexer_->loadLanguage(lang);
 
-		// Load autocompletion list
-		autocomp_list_ = lang->autocompletionList();
+		// Autocompletion list is built when needed
+		autocomp_list_.Clear();
 	}
 
 	// Set folding options
@@ -431,6 +354,7 @@ bool TextEditorCtrl::setLanguage(TextLanguage* lang)
 	Colourise(0, GetTextLength());
 
 	// Update Jump To list
+	jump_to_index_.setLanguage(lang);
 	updateJumpToList();
 
 	return true;
@@ -1064,24 +988,32 @@ void TextEditorCtrl::setJumpToControl(wxChoice* jump_to)
 }
 
 // -----------------------------------------------------------------------------
-// Begin updating the 'Jump To' list
+// Updates the 'Jump To' list and document symbols for autocompletion (only
+// rescanning lines that changed since the last update)
 // -----------------------------------------------------------------------------
 void TextEditorCtrl::updateJumpToList()
 {
+	if (!jump_to_index_.update(this))
+		return;
+
+	doc_symbols_.clear();
+	for (const auto& point : jump_to_index_.jumpPoints())
+		doc_symbols_.insert(point.name);
+
 	if (!choice_jump_to_)
 		return;
 
-	if (!language_ || jump_to_calculator_ || GetText().length() == 0)
+	choice_jump_to_->Clear();
+	jump_to_lines_.clear();
+
+	wxArrayString items;
+	for (const auto& point : jump_to_index_.jumpPoints())
 	{
-		choice_jump_to_->Clear();
-		return;
+		items.push_back(wxString::FromUTF8(point.name));
+		jump_to_lines_.push_back(point.line);
 	}
 
-	// Begin jump to calculation thread
-	choice_jump_to_->Enable(false);
-	jump_to_calculator_ = new JumpToCalculator(
-		this, wxutil::strToView(GetText()), language_->jumpBlocks(), language_->jumpBlocksIgnored());
-	jump_to_calculator_->Run();
+	choice_jump_to_->Append(items);
 }
 
 // -----------------------------------------------------------------------------
@@ -1291,6 +1223,54 @@ void TextEditorCtrl::cycleComments() const
 	language_->setPreferedComments(next_style);
 }
 
+// -----------------------------------------------------------------------------
+// Styles lines [line_start] to [line_end], and any following lines affected by
+// changes to comment blocks. Lines after those that are still styled from
+// before are skipped, since the lexer state has converged again
+// -----------------------------------------------------------------------------
+void TextEditorCtrl::styleLines(int line_start, int line_end)
+{
+	auto n_lines = GetLineCount();
+	line_end     = std::min(line_end, n_lines - 1);
+
+	// Update comment block info
+	auto comments_end = lexer_->updateComments(
+		this, line_start == 0 ? 0 : GetLineEndPosition(line_start - 1), GetLineEndPosition(line_end));
+	line_end = std::max(line_end, LineFromPosition(comments_end));
+
+	// Lex lines
+	for (int l = line_start; l <= line_end; l++)
+	{
+		int end   = GetLineEndPosition(l) - 1;
+		int start = end - GetLineLength(l) + 1;
+
+		if (start > end)
+			end = start;
+
+		lexer_->doStyling(this, start, end);
+	}
+
+	if (txed_fold_enable)
+	{
+		auto modified = last_modified_;
+		lexer_->updateFolding(this, line_start, line_end);
+		last_modified_ = modified;
+	}
+
+	// Skip following lines that don't need restyling
+	auto next = lexer_->firstUnstyledLine(line_end + 1);
+	if (next > line_end + 1)
+	{
+		auto pos = next < n_lines ? PositionFromLine(next) : GetTextLength();
+#if wxMAJOR_VERSION < 3 || (wxMAJOR_VERSION == 3 && wxMINOR_VERSION < 1) \
+	|| (wxMAJOR_VERSION == 3 && wxMINOR_VERSION == 1 && wxRELEASE_NUMBER == 0)
+		StartStyling(pos, 31);
+#else
+		StartStyling(pos);
+#endif
+	}
+}
+
 // -----------------------------------------------------------------------------
 //
 // TextEditorCtrl Class Events
@@ -1326,7 +1306,10 @@ void TextEditorCtrl::onKeyDown(wxKeyEvent& e)
 				// Get word before cursor
 				auto word = GetTextRange(WordStartPosition(GetCurrentPos(), true), GetCurrentPos()).ToStdString();
 
-				autocomp_list_ = language_->autocompletionList(word);
+				// Include named blocks in the document (eg. scripts or classes)
+				updateJumpToList();
+
+				autocomp_list_ = language_->autocompletionList(word, true, &doc_symbols_);
 				AutoCompShow(static_cast<int>(word.size()), autocomp_list_);
 			}
 
@@ -1591,13 +1574,6 @@ void TextEditorCtrl::onCharAdded(wxStyledTextEvent& e)
 		// Comma, possibly update calltip
 		if (e.GetKey() == ',' && txed_calltips_parenthesis)
 			updateCalltip();
-
-		// Block comment ended
-		for (auto& end_token : language_->commentEndL())
-		{
-			if (GetTextRange(GetCurrentPos() - end_token.size(), GetCurrentPos()) == end_token)
-				block_comment_closed_ = true;
-		}
 	}
 
 	// Continue
@@ -1803,43 +1779,6 @@ void TextEditorCtrl::onMarginClick(wxStyledTextEvent& e)
 	}
 }
 
-// -----------------------------------------------------------------------------
-// Called when the 'Jump To' calculation thread completes
-// -----------------------------------------------------------------------------
-void TextEditorCtrl::onJumpToCalculateComplete(wxThreadEvent& e)
-{
-	if (!choice_jump_to_)
-	{
-		jump_to_calculator_ = nullptr;
-		return;
-	}
-
-	choice_jump_to_->Clear();
-	jump_to_lines_.clear();
-
-	auto split = wxSplit(e.GetString(), ',');
-
-	wxArrayString items;
-	for (unsigned a = 0; a < split.size(); a += 2)
-	{
-		if (a == split.size() - 1)
-			break;
-
-		long line;
-		if (!split[a].ToLong(&line))
-			line = 0;
-		wxString name = split[a + 1];
-
-		items.push_back(name);
-		jump_to_lines_.push_back(line);
-	}
-
-	choice_jump_to_->Append(items);
-	choice_jump_to_->Enable(true);
-
-	jump_to_calculator_ = nullptr;
-}
-
 // -----------------------------------------------------------------------------
 // Called when the 'Jump To' dropdown is changed
 // -----------------------------------------------------------------------------
@@ -1894,40 +1833,42 @@ void TextEditorCtrl::onUpdateTimer(wxTimerEvent& e)
 // -----------------------------------------------------------------------------
 void TextEditorCtrl::onStyleNeeded(wxStyledTextEvent& e)
 {
-	// Get range of lines to be updated
-	int line_start = LineFromPosition(GetEndStyled());
-	int line_end   = LineFromPosition(e.GetPosition());
+	styleLines(LineFromPosition(GetEndStyled()), LineFromPosition(e.GetPosition()));
+}
 
-	// If a block comment was just closed, we need to style to the end of the text
-	if (block_comment_closed_)
-	{
-		lexer_->resetLineInfo();
-		line_end              = GetNumberOfLines();
-		block_comment_closed_ = false;
-	}
+// -----------------------------------------------------------------------------
+// Called when the text is modified (lower level than onModified, with info
+// about what changed)
+// -----------------------------------------------------------------------------
+void TextEditorCtrl::onTextModified(wxStyledTextEvent& e)
+{
+	auto type = e.GetModificationType();
+	auto line = LineFromPosition(e.GetPosition());
+	if (type & wxSTC_MOD_INSERTTEXT)
+		lexer_->textModified(e.GetPosition(), e.GetLength(), line, e.GetLinesAdded());
+	else if (type & wxSTC_MOD_DELETETEXT)
+		lexer_->textModified(e.GetPosition(), -e.GetLength(), line, e.GetLinesAdded());
+	if (type & (wxSTC_MOD_INSERTTEXT | wxSTC_MOD_DELETETEXT))
+		jump_to_index_.textModified(line, e.GetLinesAdded());
 
-	// Update comment block info
-	lexer_->updateComments(
-		this, line_start == 0 ? 0 : GetLineEndPosition(line_start - 1), GetLineEndPosition(line_end));
+	e.Skip();
+}
 
-	// Lex until done (end of lines, end of file or end of block comment)
-	int l = line_start;
-	while (l <= GetNumberOfLines() && (l <= line_end))
+// -----------------------------------------------------------------------------
+// Called when the application is idle
+// -----------------------------------------------------------------------------
+void TextEditorCtrl::onIdle(wxIdleEvent& e)
+{
+	// Style any remaining text in the background (a chunk at a time), after
+	// Scintilla has requested styling for the visible lines
+	auto styled_end = GetEndStyled();
+	if (styled_end < GetTextLength())
 	{
-		int end   = GetLineEndPosition(l) - 1;
-		int start = end - GetLineLength(l) + 1;
-
-		if (start > end)
-			end = start;
-
-		lexer_->doStyling(this, start, end);
-		l++;
+		auto line = LineFromPosition(styled_end);
+		styleLines(line, line + IDLE_STYLE_LINES - 1);
+		if (GetEndStyled() > styled_end)
+			e.RequestMore();
 	}
 
-	if (txed_fold_enable)
-	{
-		auto modified = last_modified_;
-		lexer_->updateFolding(this, line_start);
-		last_modified_ = modified;
-	}
+	e.Skip();
 }
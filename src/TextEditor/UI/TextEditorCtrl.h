@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Archive/ArchiveEntry.h"
+#include "TextEditor/JumpToIndex.h"
 #include "TextEditor/Lexer.h"
 #include "TextEditor/TextLanguage.h"
 #include "TextEditor/TextStyle.h"
@@ -11,7 +12,6 @@ class wxCheckBox;
 class wxTextCtrl;
 class wxChoice;
 
-wxDECLARE_EVENT(wxEVT_COMMAND_JTCALCULATOR_COMPLETED, wxThreadEvent);
 wxDECLARE_EVENT(wxEVT_TEXT_CHANGED, wxCommandEvent);
 
 namespace slade
@@ -19,27 +19,6 @@ namespace slade
 class FindReplacePanel;
 class SCallTip;
 
-class JumpToCalculator : public wxThread
-{
-public:
-	JumpToCalculator(wxEvtHandler* handler, string_view text, vector<string> block_names, vector<string> ignore) :
-		handler_(handler),
-		text_(text),
-		block_names_(std::move(block_names)),
-		ignore_(std::move(ignore))
-	{
-	}
-	virtual ~JumpToCalculator() = default;
-
-	ExitCode Entry() override;
-
-private:
-	wxEvtHandler*  handler_;
-	string         text_;
-	vector<string> block_names_;
-	vector<string> ignore_;
-};
-
 class TextEditorCtrl : public wxStyledTextCtrl
 {
 public:
@@ -96,11 +75,12 @@ public:
 	void cycleComments() const;
 
 private:
-	TextLanguage*     language_           = nullptr;
-	FindReplacePanel* panel_fr_           = nullptr;
-	SCallTip*         call_tip_           = nullptr;
-	wxChoice*         choice_jump_to_     = nullptr;
-	JumpToCalculator* jump_to_calculator_ = nullptr;
+	TextLanguage*     language_       = nullptr;
+	FindReplacePanel* panel_fr_       = nullptr;
+	SCallTip*         call_tip_       = nullptr;
+	wxChoice*         choice_jump_to_ = nullptr;
+	JumpToIndex       jump_to_index_;
+	PrefixTrie        doc_symbols_; // Named blocks in the document, for autocompletion
 	unique_ptr<Lexer> lexer_;
 	wxString          prev_word_match_;
 	wxString          autocomp_list_;
@@ -108,10 +88,9 @@ private:
 	long              last_modified_ = 0;
 
 	// State tracking for updates
-	int  prev_cursor_pos_      = -1;
-	int  prev_text_length_     = -1;
-	int  prev_brace_match_     = -1;
-	bool block_comment_closed_ = false;
+	int prev_cursor_pos_  = -1;
+	int prev_text_length_ = -1;
+	int prev_brace_match_ = -1;
 
 	// Timed update stuff
 	wxTimer timer_update_;
@@ -129,6 +108,11 @@ private:
 	const wxString default_begin_comment_ = "/*";
 	const wxString default_end_comment_   = "*/";
 
+	// Number of lines styled at a time in the background
+	static constexpr int IDLE_STYLE_LINES = 2000;
+
+	void styleLines(int line_start, int line_end);
+
 	// Events
 	void onKeyDown(wxKeyEvent& e);
 	void onKeyUp(wxKeyEvent& e);
@@ -141,10 +125,11 @@ private:
 	void onFocusLoss(wxFocusEvent& e);
 	void onActivate(wxActivateEvent& e);
 	void onMarginClick(wxStyledTextEvent& e);
-	void onJumpToCalculateComplete(wxThreadEvent& e);
 	void onJumpToChoiceSelected(wxCommandEvent& e);
 	void onModified(wxStyledTextEvent& e);
 	void onUpdateTimer(wxTimerEvent& e);
 	void onStyleNeeded(wxStyledTextEvent& e);
+	void onTextModified(wxStyledTextEvent& e);
+	void onIdle(wxIdleEvent& e);
 };
 } // namespace slade
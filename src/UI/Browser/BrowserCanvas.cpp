@@ -70,6 +70,7 @@ BrowserCanvas::BrowserCanvas(wxWindow* parent) :
 	Bind(wxEVT_MOUSEWHEEL, &BrowserCanvas::onMouseEvent, this);
 	Bind(wxEVT_LEFT_DOWN, &BrowserCanvas::onMouseEvent, this);
 	Bind(wxEVT_KEY_DOWN, &BrowserCanvas::onKeyDown, this);
+	timer_loading_.Bind(wxEVT_TIMER, [this](wxTimerEvent&) { Refresh(); });
 }
 
 // -----------------------------------------------------------------------------
@@ -109,6 +110,7 @@ void BrowserCanvas::addItem(BrowserItem* item)
 void BrowserCanvas::clearItems()
 {
 	items_.clear();
+	loading_items_.clear();
 }
 
 // -----------------------------------------------------------------------------
@@ -205,97 +207,112 @@ void BrowserCanvas::draw()
 	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 	glLineWidth(2.0f);
 
+	// Determine visible rows (only items in these are drawn)
+	int  row_height = fullItemSizeY();
+	int  n_items    = static_cast<int>(items_filter_.size());
+	int  first_row  = std::max(0, yoff_ / row_height);
+	int  last_row   = (yoff_ + size.y) / row_height;
+	int  col_width  = num_cols_ > 0 ? size.x / num_cols_ : 0;
+	bool loading    = false;
+	top_index_      = -1;
+
 	// Draw items
-	int x         = item_border_;
-	int y         = item_border_;
-	int col_width = size.x / num_cols_;
-	int col       = 0;
-	top_index_    = -1;
-	for (unsigned a = 0; a < items_filter_.size(); a++)
+	for (int row = first_row; num_cols_ > 0 && row <= last_row; ++row)
 	{
-		// If we're not yet into the viewable area, skip
-		if (y < yoff_ - fullItemSizeY())
+		for (int col = 0; col < num_cols_; ++col)
 		{
-			col++;
-			if (col >= num_cols_)
+			int a = row * num_cols_ + col;
+			if (a >= n_items)
+				break;
+
+			int y = item_border_ + row * row_height;
+
+			// If we're drawing the first item, save it
+			if (top_index_ < 0)
 			{
-				col = 0;
-				y += fullItemSizeY();
+				top_index_ = a;
+				top_y_     = y - yoff_;
+			}
+
+			// Determine current x position
+			int xgap = (col_width - fullItemSizeX()) * 0.5;
+			int x    = item_border_ + xgap + (col * col_width);
 
-				// Canvas is filled, stop drawing
-				if (y > yoff_ + size.y)
-					break;
+			// Draw selection box if selected
+			if (item_selected_ == items_[items_filter_[a]])
+			{
+				// Setup
+				glDisable(GL_TEXTURE_2D);
+				glColor4f(0.3f, 0.5f, 1.0f, 0.3f);
+				glPushMatrix();
+				glTranslated(x, y - yoff_, 0);
+				glTranslated(-item_border_, -item_border_, 0);
+
+				// Selection background
+				glBegin(GL_QUADS);
+				glVertex2i(2, 2);
+				glVertex2i(2, fullItemSizeY() - 3);
+				glVertex2i(fullItemSizeX() - 3, fullItemSizeY() - 3);
+				glVertex2i(fullItemSizeX() - 3, 2);
+				glEnd();
+
+				// Selection border
+				glColor4f(0.6f, 0.8f, 1.0f, 1.0f);
+				glBegin(GL_LINE_LOOP);
+				glVertex2i(2, 2);
+				glVertex2i(2, fullItemSizeY() - 3);
+				glVertex2i(fullItemSizeX() - 3, fullItemSizeY() - 3);
+				glVertex2i(fullItemSizeX() - 3, 2);
+				glEnd();
+
+				// Finish
+				glPopMatrix();
+				glEnable(GL_TEXTURE_2D);
+				glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 			}
-			continue;
-		}
 
-		// If we're drawing the first non-hidden item, save it
-		if (top_index_ < 0)
-		{
-			top_index_ = a;
-			top_y_     = y - yoff_;
+			// Draw item
+			if (item_size_ <= 0)
+				items_[items_filter_[a]]->draw(
+					browser_item_size, x, y - yoff_, font_, show_names_, item_type_, col_text, text_shadow);
+			else
+				items_[items_filter_[a]]->draw(
+					item_size_, x, y - yoff_, font_, show_names_, item_type_, col_text, text_shadow);
+			loading |= items_[items_filter_[a]]->loading();
 		}
+	}
 
-		// Determine current x position
-		int xgap = (col_width - fullItemSizeX()) * 0.5;
-		x        = item_border_ + xgap + (col * col_width);
+	// Start loading images for items within a page of the visible rows, and
+	// cancel any still loading from further away (eg. after scrolling quickly)
+	if (num_cols_ > 0)
+	{
+		int page      = last_row - first_row + 1;
+		int near_from = std::max(0, first_row - page) * num_cols_;
+		int near_to   = std::min(n_items, (last_row + page + 1) * num_cols_);
 
-		// Draw selection box if selected
-		if (item_selected_ == items_[items_filter_[a]])
+		vector<BrowserItem*> near_loading;
+		for (int a = near_from; a < near_to; ++a)
 		{
-			// Setup
-			glDisable(GL_TEXTURE_2D);
-			glColor4f(0.3f, 0.5f, 1.0f, 0.3f);
-			glPushMatrix();
-			glTranslated(x, y - yoff_, 0);
-			glTranslated(-item_border_, -item_border_, 0);
-
-			// Selection background
-			glBegin(GL_QUADS);
-			glVertex2i(2, 2);
-			glVertex2i(2, fullItemSizeY() - 3);
-			glVertex2i(fullItemSizeX() - 3, fullItemSizeY() - 3);
-			glVertex2i(fullItemSizeX() - 3, 2);
-			glEnd();
-
-			// Selection border
-			glColor4f(0.6f, 0.8f, 1.0f, 1.0f);
-			glBegin(GL_LINE_LOOP);
-			glVertex2i(2, 2);
-			glVertex2i(2, fullItemSizeY() - 3);
-			glVertex2i(fullItemSizeX() - 3, fullItemSizeY() - 3);
-			glVertex2i(fullItemSizeX() - 3, 2);
-			glEnd();
-
-			// Finish
-			glPopMatrix();
-			glEnable(GL_TEXTURE_2D);
-			glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+			auto item = items_[items_filter_[a]];
+			item->requestImage();
+			if (item->loading())
+				near_loading.push_back(item);
 		}
 
-		// Draw item
-		if (item_size_ <= 0)
-			items_[items_filter_[a]]->draw(
-				browser_item_size, x, y - yoff_, font_, show_names_, item_type_, col_text, text_shadow);
-		else
-			items_[items_filter_[a]]->draw(
-				item_size_, x, y - yoff_, font_, show_names_, item_type_, col_text, text_shadow);
+		for (auto item : loading_items_)
+			if (item->loading() && std::find(near_loading.begin(), near_loading.end(), item) == near_loading.end())
+				item->cancelLoad();
 
-		// Move over for next item
-		col++;
-		if (col >= num_cols_)
-		{
-			col = 0;
-			y += fullItemSizeY();
-
-			// Canvas is filled, stop drawing
-			if (y > yoff_ + size.y)
-				break;
-		}
+		loading_items_ = near_loading;
+		loading |= !loading_items_.empty();
 	}
 
 	// Swap Buffers
 	SwapBuffers();
+
+	// Keep redrawing until any items being loaded in the background are done
+	if (loading && !timer_loading_.IsRunning())
+		timer_loading_.StartOnce(50);
 }
 
 // -----------------------------------------------------------------------------
@@ -80,6 +80,10 @@ private:
 	int           top_y_       = 0;
 	ItemView      item_type_   = ItemView::Normal;
 	int           num_cols_    = -1;
+
+	// Redraws while any visible items are loading in the background
+	wxTimer              timer_loading_;
+	vector<BrowserItem*> loading_items_; // Items near the viewport that were loading when last drawn
 };
 } // namespace slade
 
@@ -0,0 +1,168 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    BrowserImageQueue.cpp
+// Description: BrowserImageQueue class. Decodes browser item images from
+//              entry data (or loads them from the thumbnail cache) on the
+//              task workers. The most recently queued images are decoded first
+//              (they are most likely to be in view), and requests that are
+//              dropped before they are started (eg. for items scrolled out of
+//              view) are skipped.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "BrowserImageQueue.h"
+#include "Archive/ArchiveEntry.h"
+#include "Archive/EntryType/EntryType.h"
+#include "General/Misc.h"
+#include "Graphics/Palette/Palette.h"
+#include "Graphics/ThumbnailCache.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// BrowserImageQueue Structs
+//
+// -----------------------------------------------------------------------------
+
+// An entry image to be decoded, with everything needed to decode it without
+// accessing the entry
+struct BrowserImageQueue::Job
+{
+	weak_ptr<Request>      request;
+	MemChunk               data; // Shared with the entry (see MemChunk::share)
+	string                 format_id;
+	string                 format_hint;
+	SIFormat*              image_format = nullptr; // Format the entry was last loaded with, if known
+	weak_ptr<ArchiveEntry> entry;
+	uint64_t               content_hash = 0;
+	uint64_t               thumb_key    = 0;
+	unique_ptr<Palette>    palette; // For converting to RGBA thumbnails
+	bool                   decoded      = false;
+	bool                   ok           = false;
+};
+
+
+// -----------------------------------------------------------------------------
+//
+// BrowserImageQueue Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// BrowserImageQueue class constructor
+// -----------------------------------------------------------------------------
+BrowserImageQueue::BrowserImageQueue() :
+	jobs_{
+		[](Job& job)
+		{
+			// Skip if the request was dropped
+			auto request = job.request.lock();
+			if (!request)
+				return;
+
+			// Load into the request image (it isn't accessed on the main thread
+			// until the request is done), from the thumbnail cache if possible
+			if (thumbnailcache::load(job.thumb_key, request->image, request->full_size))
+				job.ok = true;
+			else
+			{
+				job.decoded = true;
+				job.ok      = misc::loadImageFromData(
+					&request->image, job.data, job.format_id, job.format_hint, 0, job.image_format);
+				request->full_size = { request->image.width(), request->image.height() };
+				if (job.ok)
+					thumbnailcache::save(job.thumb_key, request->image, job.palette.get());
+			}
+			job.data.clear();
+		},
+		[](Job& job)
+		{
+			auto request = job.request.lock();
+			if (!request)
+				return;
+
+			request->ok   = job.ok;
+			request->done = true;
+
+			// Remember the detected image format if the entry is unchanged
+			auto entry = job.entry.lock();
+			if (job.decoded && job.ok && entry && entry->contentHash() == job.content_hash)
+				entry->setImageFormat(request->image.format());
+		}
+	}
+{
+}
+
+// -----------------------------------------------------------------------------
+// BrowserImageQueue class destructor
+// -----------------------------------------------------------------------------
+BrowserImageQueue::~BrowserImageQueue() = default;
+
+// -----------------------------------------------------------------------------
+// Queues the image in [entry] to be decoded on a worker thread, and returns
+// the request to poll for the result. The decoded image is added to the
+// thumbnail cache (using palette [pal]), and will be loaded from there next
+// time if it is unchanged.
+// If the image can't be decoded from the entry data alone it is loaded
+// immediately, and the returned request is already done
+// -----------------------------------------------------------------------------
+shared_ptr<BrowserImageQueue::Request> BrowserImageQueue::queue(ArchiveEntry& entry, Palette* pal)
+{
+	auto request = std::make_shared<Request>();
+
+	if (!misc::canLoadImageFromData(entry))
+	{
+		request->ok        = misc::loadImageFromEntry(&request->image, &entry);
+		request->full_size = { request->image.width(), request->image.height() };
+		request->done      = true;
+		return request;
+	}
+
+	auto job          = std::make_shared<Job>();
+	job->request      = request;
+	job->entry        = entry.getShared();
+	job->content_hash = entry.contentHash();
+	job->format_id    = entry.type()->formatId();
+	job->format_hint  = entry.type()->extraProps().getOr<string>("image_format", {});
+	job->image_format = entry.imageFormat();
+	job->thumb_key    = thumbnailcache::entryKey(entry, pal);
+	job->data.share(entry.data());
+	if (pal)
+	{
+		job->palette = std::make_unique<Palette>();
+		job->palette->copyPalette(pal);
+	}
+
+	// Add to the front of the queue (newest first)
+	jobs_.push(job, true);
+
+	return request;
+}
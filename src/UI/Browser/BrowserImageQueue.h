@@ -0,0 +1,37 @@
+#pragma once
+
+#include "General/Tasks.h"
+#include "Graphics/SImage/SImage.h"
+
+namespace slade
+{
+class ArchiveEntry;
+
+class BrowserImageQueue
+{
+public:
+	// An image being loaded in the background. [done], [ok], [image] and
+	// [full_size] are only valid on the main thread once [done] is true.
+	// [image] may be a scaled-down thumbnail from the thumbnail cache, with
+	// the size of the original image in [full_size].
+	// Dropping the last reference to a request cancels it if it hasn't
+	// started decoding yet
+	struct Request
+	{
+		SImage image;
+		Vec2i  full_size;
+		bool   done = false;
+		bool   ok   = false;
+	};
+
+	BrowserImageQueue();
+	~BrowserImageQueue();
+
+	shared_ptr<Request> queue(ArchiveEntry& entry, Palette* pal);
+
+private:
+	struct Job;
+
+	tasks::JobQueue<Job> jobs_;
+};
+} // namespace slade
@@ -71,6 +71,15 @@ bool BrowserItem::loadImage()
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Starts loading the item image if it isn't already loaded (or loading)
+// -----------------------------------------------------------------------------
+void BrowserItem::requestImage()
+{
+	if (!blank_ && (!image_tex_ || !gl::Texture::isLoaded(image_tex_)))
+		loadImage();
+}
+
 // -----------------------------------------------------------------------------
 // Draws the item in a [size]x[size] box, keeping the correct aspect ratio of
 // it's image
@@ -141,8 +150,11 @@ void BrowserItem::draw(
 		return;
 
 	// Try to load image if it isn't already
-	if (!image_tex_ || (image_tex_ && !gl::Texture::isLoaded(image_tex_)))
-		loadImage();
+	requestImage();
+
+	// Nothing to draw yet if it's still loading
+	if (loading_)
+		return;
 
 	// If it still isn't just draw a red box with an X
 	if (!image_tex_ || (image_tex_ && !gl::Texture::isLoaded(image_tex_)))
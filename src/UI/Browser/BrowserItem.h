@@ -17,8 +17,10 @@ public:
 
 	wxString name() const { return name_; }
 	unsigned index() const { return index_; }
+	bool     loading() const { return loading_; }
 
 	virtual bool loadImage();
+	void         requestImage();
 	void         draw(
 				int                     size,
 				int                     x,
@@ -29,6 +31,7 @@ public:
 				const ColRGBA&          colour      = ColRGBA::WHITE,
 				bool                    text_shadow = true);
 	virtual void     clearImage() {}
+	virtual void     cancelLoad() {}
 	virtual wxString itemInfo() { return ""; }
 
 protected:
@@ -38,6 +41,7 @@ protected:
 	unsigned            image_tex_ = 0;
 	BrowserWindow*      parent_    = nullptr;
 	bool                blank_     = false;
+	bool                loading_   = false; // Image is being loaded in the background
 	unique_ptr<TextBox> text_box_;
 };
 } // namespace slade
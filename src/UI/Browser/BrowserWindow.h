@@ -1,6 +1,7 @@
 #pragma once
 
 #include "BrowserCanvas.h"
+#include "BrowserImageQueue.h"
 #include "BrowserItem.h"
 #include "Graphics/Palette/Palette.h"
 #include "Utility/Tree.h"
@@ -49,8 +50,9 @@ public:
 
 	bool truncateNames() const { return truncate_names_; }
 
-	Palette* palette() { return &palette_; }
-	void     setPalette(Palette* pal) { palette_.copyPalette(pal); }
+	Palette*           palette() { return &palette_; }
+	void               setPalette(Palette* pal) { palette_.copyPalette(pal); }
+	BrowserImageQueue& imageQueue() { return image_queue_; }
 
 	bool         addItem(BrowserItem* item, const wxString& where = "");
 	void         addGlobalItem(BrowserItem* item);
@@ -80,6 +82,7 @@ protected:
 	BrowserCanvas*       canvas_ = nullptr;
 	vector<BrowserItem*> items_global_;
 	bool                 truncate_names_ = false;
+	BrowserImageQueue    image_queue_;
 
 private:
 	wxTreeListCtrl* tree_items_  = nullptr;
@@ -36,6 +36,7 @@
 #include "Archive/ArchiveManager.h"
 #include "MainEditor/UI/TextureXEditor/TextureXEditor.h"
 #include "OpenGL/GLTexture.h"
+#include "OpenGL/Shader.h"
 #include "Utility/CodePages.h"
 
 using namespace slade;
@@ -48,8 +49,49 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 namespace
 {
-const int NUMROWS = 25;
-const int NUMCOLS = 80;
+const int NUMROWS        = 25;
+const int NUMCOLS        = 80;
+const int BLINK_INTERVAL = 500; // ms
+
+// GLSL sources for glyph atlas rendering. Each cell is an instance of a quad
+// (corners 0 to 1), with its character and attribute bytes as instance data.
+// The glyph atlas is a 16x16 grid of all 256 characters
+const char* shader_vert_cells = R"(#version 330 core
+in vec2 in_position;
+in uvec2 in_instance;
+uniform mat4 mvp;
+uniform vec2 cell_size;
+uniform int columns;
+uniform int blink_on;
+uniform vec3 colours[16];
+out vec2 texcoord;
+flat out vec3 fg;
+flat out vec3 bg;
+void main()
+{
+	uint chr  = in_instance.x;
+	uint attr = in_instance.y;
+	vec2 cell = vec2(gl_InstanceID % columns, gl_InstanceID / columns);
+
+	texcoord = (vec2(chr % 16u, chr / 16u) + in_position) / 16.0;
+	bg       = colours[(attr >> 4) & 7u];
+	fg       = ((attr & 128u) != 0u && blink_on == 0) ? bg : colours[attr & 15u];
+
+	gl_Position = mvp * vec4((cell + in_position) * cell_size, 0.0, 1.0);
+}
+)";
+
+const char* shader_frag_cells = R"(#version 330 core
+in vec2 texcoord;
+flat in vec3 fg;
+flat in vec3 bg;
+uniform sampler2D font;
+out vec4 frag_colour;
+void main()
+{
+	frag_colour = vec4(mix(bg, fg, texture(font, texcoord).a), 1.0);
+}
+)";
 } // namespace
 
 
@@ -63,8 +105,11 @@ const int NUMCOLS = 80;
 // -----------------------------------------------------------------------------
 // ANSICanvas class constructor
 // -----------------------------------------------------------------------------
-ANSICanvas::ANSICanvas(wxWindow* parent, int id) : OGLCanvas(parent, id)
+ANSICanvas::ANSICanvas(wxWindow* parent, int id) :
+	OGLCanvas(parent, id), blink_timer_{ this, NewControlId() }
 {
+	Bind(wxEVT_TIMER, &ANSICanvas::onBlinkTimer, this, blink_timer_.GetId());
+
 	// Get the all-important font data
 	auto res_archive = app::archiveManager().programResourceArchive();
 	if (!res_archive)
@@ -80,7 +125,7 @@ ANSICanvas::ANSICanvas(wxWindow* parent, int id) : OGLCanvas(parent, id)
 	char_height_ = ansi_font->size() / 256;
 	width_       = NUMCOLS * char_width_;
 	height_      = NUMROWS * char_height_;
-	picdata_     = new uint8_t[width_ * height_];
+	picdata_     = new uint8_t[width_ * height_]();
 }
 
 // -----------------------------------------------------------------------------
@@ -88,7 +133,13 @@ ANSICanvas::ANSICanvas(wxWindow* parent, int id) : OGLCanvas(parent, id)
 // -----------------------------------------------------------------------------
 ANSICanvas::~ANSICanvas()
 {
+	blink_timer_.Stop();
 	gl::Texture::clear(tex_image_);
+	gl::Texture::clear(tex_font_);
+	if (vbo_quad_ > 0)
+		glDeleteBuffers(1, &vbo_quad_);
+	if (vbo_cells_ > 0)
+		glDeleteBuffers(1, &vbo_cells_);
 	delete[] picdata_;
 	// fontdata belongs to the ansi_font ArchiveEntry
 	// ansidata belongs to the parent ANSIPanel
@@ -110,6 +161,28 @@ void ANSICanvas::writeRGBAData(uint8_t* dest) const
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Sets the ANSI screen [data] (character/attribute pairs) to display. Blinking
+// is started if any characters blink
+// -----------------------------------------------------------------------------
+void ANSICanvas::loadData(uint8_t* data)
+{
+	ansidata_    = data;
+	cells_dirty_ = true;
+	image_dirty_ = true;
+
+	bool blink = false;
+	if (data)
+		for (size_t i = 0; i < NUMROWS * NUMCOLS && !blink; ++i)
+			blink = (data[(i << 1) + 1] & 128) != 0;
+
+	blink_on_ = true;
+	if (!blink)
+		blink_timer_.Stop();
+	else if (!blink_timer_.IsRunning())
+		blink_timer_.Start(BLINK_INTERVAL);
+}
+
 // -----------------------------------------------------------------------------
 // Draws the image
 // -----------------------------------------------------------------------------
@@ -146,8 +219,9 @@ void ANSICanvas::draw()
 }
 
 // -----------------------------------------------------------------------------
-// Draws the image
-// (reloads the image as a texture each time, will change this later...)
+// Draws the image, from the glyph atlas if supported. Otherwise the characters
+// are rasterised and uploaded as a texture when the data (or blink state) has
+// changed
 // -----------------------------------------------------------------------------
 void ANSICanvas::drawImage()
 {
@@ -158,28 +232,39 @@ void ANSICanvas::drawImage()
 	// Save current matrix
 	glPushMatrix();
 
-	// Enable textures
-	glEnable(GL_TEXTURE_2D);
-
-	// Load texture data
-	if (!tex_image_)
+	if (!drawCells())
 	{
-		vector<uint8_t> rgba_data(width_ * height_ * 4);
-		writeRGBAData(rgba_data.data());
-		tex_image_ = gl::Texture::createFromData(rgba_data.data(), width_, height_);
+		// Enable textures
+		glEnable(GL_TEXTURE_2D);
+
+		// Rasterise and load texture data
+		if (!tex_image_ || image_dirty_)
+		{
+			if (ansidata_)
+				for (size_t i = 0; i < NUMROWS * NUMCOLS; ++i)
+					drawCharacter(i);
+
+			vector<uint8_t> rgba_data(width_ * height_ * 4);
+			writeRGBAData(rgba_data.data());
+			if (!tex_image_)
+				tex_image_ = gl::Texture::createFromData(rgba_data.data(), width_, height_);
+			else
+				gl::Texture::loadData(tex_image_, rgba_data.data(), width_, height_);
+			image_dirty_ = false;
+		}
+
+		// Draw the image
+		gl::setColour(ColRGBA::WHITE, gl::Blend::Normal);
+		drawing::drawTexture(tex_image_);
+
+		// Disable textures
+		glDisable(GL_TEXTURE_2D);
 	}
 
 	// Determine (texture)coordinates
 	double x = (double)width_;
 	double y = (double)height_;
 
-	// Draw the image
-	gl::setColour(ColRGBA::WHITE, gl::Blend::Normal);
-	drawing::drawTexture(tex_image_);
-
-	// Disable textures
-	glDisable(GL_TEXTURE_2D);
-
 	// Draw outline
 	gl::setColour(0, 0, 0, 64);
 	glBegin(GL_LINE_LOOP);
@@ -194,7 +279,106 @@ void ANSICanvas::drawImage()
 }
 
 // -----------------------------------------------------------------------------
-// Draws a single character. This is called from the parent ANSIPanel
+// Draws all character cells as instances of a single quad, using the glyph
+// atlas and a shader (both created on first use). The ANSI data is only
+// uploaded again when it has changed.
+// Returns false if shaders are unsupported or the shader failed to load
+// -----------------------------------------------------------------------------
+bool ANSICanvas::drawCells()
+{
+	using namespace gl::attrib;
+
+	if (!gl::shaderSupport() || !fontdata_)
+		return false;
+
+	// Load shader
+	if (!shader_)
+	{
+		shader_ = std::make_unique<gl::Shader>("ansi_cells");
+		if (shader_->load(shader_vert_cells, shader_frag_cells))
+		{
+			shader_->bind();
+			shader_->setUniform("font", 0);
+			shader_->setUniform("columns", NUMCOLS);
+			for (int i = 0; i < 16; ++i)
+			{
+				auto col  = codepages::ansiColor(i);
+				auto name = fmt::format("colours[{}]", i);
+				shader_->setUniform(name.c_str(), col.fr(), col.fg(), col.fb());
+			}
+			gl::Shader::unbind();
+		}
+	}
+	if (!shader_->isValid())
+		return false;
+
+	if (!ansidata_)
+		return true;
+
+	// Create glyph atlas
+	if (!tex_font_)
+	{
+		unsigned        atlas_width  = 16 * char_width_;
+		unsigned        atlas_height = 16 * char_height_;
+		vector<uint8_t> atlas(atlas_width * atlas_height * 4, 0);
+		for (unsigned chara = 0; chara < 256; ++chara)
+		{
+			const uint8_t* fnt  = fontdata_ + (char_height_ * chara);
+			auto           left = (chara % 16) * char_width_;
+			auto           top  = (chara / 16) * char_height_;
+			for (int y = 0; y < char_height_; ++y)
+				for (int x = 0; x < char_width_; ++x)
+					if (fnt[y] & (1 << (char_width_ - 1 - x)))
+						memset(&atlas[((top + y) * atlas_width + left + x) * 4], 0xFF, 4);
+		}
+		tex_font_ = gl::Texture::createFromData(atlas.data(), atlas_width, atlas_height, gl::TexFilter::Nearest, false);
+	}
+
+	// Cell quad
+	if (vbo_quad_ == 0)
+	{
+		const float quad[] = { 0.f, 0.f, 1.f, 0.f, 1.f, 1.f, 0.f, 1.f };
+		glGenBuffers(1, &vbo_quad_);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_quad_);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+	}
+
+	// Cell data (the ANSI data as-is)
+	if (vbo_cells_ == 0)
+		glGenBuffers(1, &vbo_cells_);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_cells_);
+	if (cells_dirty_)
+	{
+		glBufferData(GL_ARRAY_BUFFER, NUMROWS * NUMCOLS * 2, ansidata_, GL_DYNAMIC_DRAW);
+		cells_dirty_ = false;
+	}
+	glEnableVertexAttribArray(INSTANCE);
+	glVertexAttribIPointer(INSTANCE, 2, GL_UNSIGNED_BYTE, 2, nullptr);
+	glVertexAttribDivisor(INSTANCE, 1);
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_quad_);
+	glEnableVertexAttribArray(POSITION);
+	glVertexAttribPointer(POSITION, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+	// Draw all cells
+	gl::Texture::bind(tex_font_);
+	shader_->bind();
+	shader_->setFixedFunctionMVP();
+	shader_->setUniform("cell_size", static_cast<float>(char_width_), static_cast<float>(char_height_));
+	shader_->setUniform("blink_on", blink_on_ ? 1 : 0);
+	glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, NUMROWS * NUMCOLS);
+
+	glVertexAttribDivisor(INSTANCE, 0);
+	glDisableVertexAttribArray(INSTANCE);
+	glDisableVertexAttribArray(POSITION);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	gl::Shader::unbind();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Draws a single character (to the image used when shaders are unsupported)
 // -----------------------------------------------------------------------------
 void ANSICanvas::drawCharacter(size_t index) const
 {
@@ -208,8 +392,30 @@ void ANSICanvas::drawCharacter(size_t index) const
 				   + ((index % NUMCOLS) * char_width_);      // Position on canvas to draw
 	const uint8_t* fnt = fontdata_ + (char_height_ * chara); // Position of character in font image
 
+	// Blinking characters are hidden in the 'off' phase
+	uint8_t bg = (color & 112) >> 4;
+	uint8_t fg = (color & 128) && !blink_on_ ? bg : (color & 15);
+
 	// Draw character (including background)
 	for (int y = 0; y < char_height_; ++y)
 		for (int x = 0; x < char_width_; ++x)
-			pic[x + (y * width_)] = (fnt[y] & (1 << (char_width_ - 1 - x))) ? (color & 15) : ((color & 112) >> 4);
+			pic[x + (y * width_)] = (fnt[y] & (1 << (char_width_ - 1 - x))) ? fg : bg;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// ANSICanvas Class Events
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Called when the blink timer fires, toggles blinking characters
+// -----------------------------------------------------------------------------
+void ANSICanvas::onBlinkTimer(wxTimerEvent& e)
+{
+	blink_on_    = !blink_on_;
+	image_dirty_ = true; // (only matters without shaders)
+	Refresh();
 }
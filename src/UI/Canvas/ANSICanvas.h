@@ -4,6 +4,17 @@
 
 namespace slade
 {
+namespace gl
+{
+	class Shader;
+}
+
+// Displays an ANSI screen (80x25 character/attribute pairs) using a VGA font.
+//
+// With GL 3.3 shaders, the font is uploaded once as a glyph atlas and the
+// ANSI data itself is used as per-cell instance data, so loading a screen is
+// a 4000 byte upload and blinking needs no re-rasterisation. Otherwise each
+// character is rasterised into an image on the CPU and uploaded as a texture
 class ANSICanvas : public OGLCanvas
 {
 public:
@@ -13,7 +24,7 @@ public:
 	void draw() override;
 	void drawImage();
 	void writeRGBAData(uint8_t* dest) const;
-	void loadData(uint8_t* data) { ansidata_ = data; }
+	void loadData(uint8_t* data);
 	void drawCharacter(size_t index) const;
 
 private:
@@ -25,5 +36,20 @@ private:
 	unsigned       tex_image_   = 0;
 	int            char_width_  = 8;
 	int            char_height_ = 8;
+	bool           image_dirty_ = true; // Image needs rasterising and uploading again
+
+	// Glyph atlas rendering
+	std::unique_ptr<gl::Shader> shader_;
+	unsigned                    tex_font_    = 0;
+	unsigned                    vbo_quad_    = 0;
+	unsigned                    vbo_cells_   = 0;
+	bool                        cells_dirty_ = true; // ANSI data needs uploading again
+
+	// Blinking (characters with attribute bit 7 set)
+	wxTimer blink_timer_;
+	bool    blink_on_ = true;
+
+	bool drawCells();
+	void onBlinkTimer(wxTimerEvent& e);
 };
 } // namespace slade
@@ -36,6 +36,8 @@
 #include "Graphics/SImage/SImage.h"
 #include "OpenGL/Drawing.h"
 #include "OpenGL/GLTexture.h"
+#include "OpenGL/OpenGL.h"
+#include "OpenGL/Shader.h"
 #include "UI/Controls/ZoomControl.h"
 
 using namespace slade;
@@ -49,6 +51,51 @@ using namespace slade;
 wxDEFINE_EVENT(EVT_DRAG_END, wxCommandEvent);
 CVAR(Bool, tx_arc, false, CVar::Flag::Save)
 EXTERN_CVAR(Bool, gfx_show_border)
+EXTERN_CVAR(Float, col_greyscale_r)
+EXTERN_CVAR(Float, col_greyscale_g)
+EXTERN_CVAR(Float, col_greyscale_b)
+
+namespace
+{
+const char* shader_vert_composite = R"(#version 330 core
+in vec2 in_position;
+in vec2 in_texcoord;
+uniform mat4 mvp;
+out vec2 texcoord;
+void main()
+{
+	texcoord    = in_texcoord;
+	gl_Position = mvp * vec4(in_position, 0.0, 1.0);
+}
+)";
+
+// Applies a patch's colour blend and alpha as in CTexture::composeImage
+// (blend_type: 0 = none, 1 = colourise, 2 = tint with amount in colour.a)
+const char* shader_frag_composite = R"(#version 330 core
+in vec2 texcoord;
+uniform sampler2D tex;
+uniform float alpha;
+uniform int src_alpha;
+uniform int blend_type;
+uniform vec4 colour;
+uniform vec3 greyscale;
+out vec4 frag_colour;
+void main()
+{
+	vec4 texel = texture(tex, texcoord);
+	if (texel.a <= 0.0)
+		discard;
+
+	vec3 rgb = texel.rgb;
+	if (blend_type == 1)
+		rgb = colour.rgb * min(dot(rgb, greyscale), 1.0);
+	else if (blend_type == 2)
+		rgb = mix(rgb, colour.rgb, colour.a);
+
+	frag_colour = vec4(rgb, src_alpha != 0 ? texel.a * alpha : alpha);
+}
+)";
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -70,6 +117,11 @@ CTextureCanvas::CTextureCanvas(wxWindow* parent, int id) : OGLCanvas(parent, id)
 	Bind(wxEVT_MOUSEWHEEL, &CTextureCanvas::onMouseEvent, this);
 }
 
+// -----------------------------------------------------------------------------
+// CTextureCanvas class destructor
+// -----------------------------------------------------------------------------
+CTextureCanvas::~CTextureCanvas() = default;
+
 // -----------------------------------------------------------------------------
 // Selects the patch at [index]
 // -----------------------------------------------------------------------------
@@ -142,6 +194,8 @@ void CTextureCanvas::clearTexture()
 void CTextureCanvas::clearPatchTextures()
 {
 	patch_textures_.clear();
+	patch_texture_keys_.clear();
+	patch_image_offsets_.clear();
 
 	// Refresh canvas
 	Refresh();
@@ -325,39 +379,44 @@ void CTextureCanvas::drawTexture()
 	// Reset colouring
 	gl::setColour(ColRGBA::WHITE, gl::Blend::Normal);
 
-	// If we're currently dragging, draw a 'basic' preview of the texture using opengl
-	if (dragging_)
-	{
-		glEnable(GL_SCISSOR_TEST);
-		glScissor(
-			left,
-			top,
-			static_cast<GLint>(texture_->width() * scale_ * (1.0 / tscalex)),
-			static_cast<GLint>(texture_->height() * yscale * (1.0 / tscaley)));
-		for (uint32_t a = 0; a < texture_->nPatches(); a++)
-			drawPatch(a);
-		glDisable(GL_SCISSOR_TEST);
-	}
-
-	// Otherwise, draw the fully generated texture
-	else
+	// Draw the texture composited from its patches on the GPU if possible (cheap
+	// enough to redo every frame, so it's always up-to-date, even while dragging)
+	if (!drawComposite())
 	{
-		// Generate if needed
-		if (!tex_preview_)
+		// If we're currently dragging, draw a 'basic' preview of the texture using opengl
+		if (dragging_)
 		{
-			// Determine image type
-			auto type = SImage::Type::PalMask;
-			if (blend_rgba_)
-				type = SImage::Type::RGBA;
-
-			// CTexture -> temp Image -> GLTexture
-			SImage temp(type);
-			texture_->toImage(temp, parent_, &palette_, blend_rgba_);
-			tex_preview_ = gl::Texture::createFromImage(temp, &palette_);
+			glEnable(GL_SCISSOR_TEST);
+			glScissor(
+				left,
+				top,
+				static_cast<GLint>(texture_->width() * scale_ * (1.0 / tscalex)),
+				static_cast<GLint>(texture_->height() * yscale * (1.0 / tscaley)));
+			for (uint32_t a = 0; a < texture_->nPatches(); a++)
+				drawPatch(a);
+			glDisable(GL_SCISSOR_TEST);
 		}
 
-		// Draw it
-		drawing::drawTexture(tex_preview_);
+		// Otherwise, draw the fully generated texture
+		else
+		{
+			// Generate if needed
+			if (!tex_preview_)
+			{
+				// Determine image type
+				auto type = SImage::Type::PalMask;
+				if (blend_rgba_)
+					type = SImage::Type::RGBA;
+
+				// CTexture -> temp Image -> GLTexture
+				SImage temp(type);
+				texture_->toImage(temp, parent_, &palette_, blend_rgba_);
+				tex_preview_ = gl::Texture::createFromImage(temp, &palette_);
+			}
+
+			// Draw it
+			drawing::drawTexture(tex_preview_);
+		}
 	}
 
 	// Disable textures
@@ -454,18 +513,8 @@ void CTextureCanvas::drawPatch(int num, bool outside)
 	if (!patch)
 		return;
 
-	// Load the patch as an opengl texture if it isn't already
-	if (!gl::Texture::isLoaded(patch_textures_[num]))
-	{
-		SImage temp(SImage::Type::PalMask);
-		if (texture_->loadPatchImage(num, temp, parent_, &palette_, blend_rgba_))
-		{
-			// Load the image as a texture
-			patch_textures_[num] = gl::Texture::createFromImage(temp, &palette_);
-		}
-		else
-			patch_textures_[num] = gl::Texture::missingTexture();
-	}
+	// Load the patch as an opengl texture if needed
+	loadPatchTexture(num);
 
 	// Translate to position
 	glPushMatrix();
@@ -521,6 +570,276 @@ void CTextureCanvas::drawPatch(int num, bool outside)
 	glPopMatrix();
 }
 
+// -----------------------------------------------------------------------------
+// Composites the texture from its patch textures into an offscreen framebuffer
+// on the GPU, with each patch's offsets, flip/rotation, style and colour blend
+// applied as in CTexture::composeImage, and draws the result.
+// Returns false if this isn't possible (no shader/framebuffer support, or the
+// result wouldn't match CTexture::toImage), in which case nothing is drawn
+// -----------------------------------------------------------------------------
+bool CTextureCanvas::drawComposite()
+{
+	if (!canComposite() || !composite_.setup(texture_->width(), texture_->height()))
+		return false;
+
+	// Load shader if needed
+	if (!composite_shader_)
+	{
+		composite_shader_ = std::make_unique<gl::Shader>("texture_composite");
+		composite_shader_->load(shader_vert_composite, shader_frag_composite);
+	}
+	if (!composite_shader_->isValid())
+		return false;
+
+	// Load any patch textures that need (re)loading
+	for (unsigned a = 0; a < texture_->nPatches(); a++)
+		loadPatchTexture(a);
+
+	// Render to the composite framebuffer 1:1, with the top of the texture at
+	// the start of the framebuffer texture
+	GLint fbo = 0;
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &fbo);
+	glPushAttrib(GL_VIEWPORT_BIT | GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT);
+	composite_.bind();
+	glViewport(0, 0, composite_.width(), composite_.height());
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho(0, composite_.width(), 0, composite_.height(), -1, 1);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+	glDisable(GL_SCISSOR_TEST);
+	glEnable(GL_BLEND);
+	glClearColor(0.f, 0.f, 0.f, 0.f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	// Draw patches
+	composite_shader_->bind();
+	composite_shader_->setUniform("tex", 0);
+	composite_shader_->setUniform("greyscale", col_greyscale_r, col_greyscale_g, col_greyscale_b);
+	for (unsigned a = 0; a < texture_->nPatches(); a++)
+		compositePatch(a, *composite_shader_);
+	gl::Shader::unbind();
+
+	// Restore previous render target and state
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix();
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glPopAttrib();
+
+	// Draw the composited texture
+	gl::Texture::bind(composite_.texture());
+	glBegin(GL_QUADS);
+	glTexCoord2d(0, 0);
+	glVertex2d(0, 0);
+	glTexCoord2d(0, 1);
+	glVertex2d(0, composite_.height());
+	glTexCoord2d(1, 1);
+	glVertex2d(composite_.width(), composite_.height());
+	glTexCoord2d(1, 0);
+	glVertex2d(composite_.width(), 0);
+	glEnd();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Loads the patch at index [num] as an opengl texture if it isn't already, or
+// if its translation has changed since it was loaded.
+// Translations are applied here rather than when compositing since they remap
+// palette indices, so changing one only reloads that patch
+// -----------------------------------------------------------------------------
+void CTextureCanvas::loadPatchTexture(unsigned num)
+{
+	if (patch_texture_keys_.size() < patch_textures_.size())
+	{
+		patch_texture_keys_.resize(patch_textures_.size());
+		patch_image_offsets_.resize(patch_textures_.size());
+	}
+
+	// Get patch translation (if any)
+	const auto patch  = texture_->patch(num);
+	const auto epatch = texture_->isExtended() ? dynamic_cast<CTPatchEx*>(patch) : nullptr;
+	const auto translation =
+		epatch && epatch->blendType() == CTPatchEx::BlendType::Translation ? &epatch->translation() : nullptr;
+
+	// Check if already loaded
+	auto key = fmt::format("{} {} {}", patch->name(), blend_rgba_, translation ? translation->asText() : "");
+	if (gl::Texture::isLoaded(patch_textures_[num]) && patch_texture_keys_[num] == key)
+		return;
+
+	gl::Texture::clear(patch_textures_[num]);
+	patch_texture_keys_[num] = key;
+
+	SImage temp(SImage::Type::PalMask);
+	if (texture_->loadPatchImage(num, temp, parent_, &palette_, blend_rgba_))
+	{
+		if (translation)
+			temp.applyTranslation(translation, &palette_, blend_rgba_);
+
+		// Load the image as a texture
+		patch_textures_[num]      = gl::Texture::createFromImage(temp, &palette_);
+		patch_image_offsets_[num] = temp.offset();
+	}
+	else
+	{
+		patch_textures_[num]      = gl::Texture::missingTexture();
+		patch_image_offsets_[num] = { 0, 0 };
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the texture can be composited on the GPU (see drawComposite)
+// -----------------------------------------------------------------------------
+bool CTextureCanvas::canComposite() const
+{
+	if (!gl::shaderSupport() || !gl::fboSupport() || texture_->isDefined())
+		return false;
+
+	if (blend_rgba_ || !texture_->isExtended())
+		return true;
+
+	// When not blending in RGBA, each blended patch pixel is matched to the
+	// nearest palette colour, so only patches that are copied as-is will match
+	for (unsigned a = 0; a < texture_->nPatches(); a++)
+	{
+		const auto patch = dynamic_cast<CTPatchEx*>(texture_->patch(a));
+		if (patch->style() != "Copy" || patch->blendType() == CTPatchEx::BlendType::Blend
+			|| patch->blendType() == CTPatchEx::BlendType::Tint)
+			return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Draws the patch at index [num] to the composite framebuffer using [shader],
+// with its blend style applied via the GL blend equation (see
+// SImage::drawPixel for the equivalent CPU blending)
+// -----------------------------------------------------------------------------
+void CTextureCanvas::compositePatch(unsigned num, const gl::Shader& shader)
+{
+	if (!gl::Texture::isLoaded(patch_textures_[num]))
+		return;
+
+	const auto  patch    = texture_->patch(num);
+	const auto& tex_info = gl::Texture::info(patch_textures_[num]);
+
+	// Setup extended features
+	int     x          = patch->xOffset();
+	int     y          = patch->yOffset();
+	bool    flipx      = false;
+	bool    flipy      = false;
+	int     rotation   = 0;
+	float   alpha      = 1.0f;
+	bool    src_alpha  = false;
+	int     blend_type = 0;
+	ColRGBA colour     = ColRGBA::WHITE;
+	GLenum  equation   = GL_FUNC_ADD;
+	GLenum  src_factor = GL_SRC_ALPHA;
+	GLenum  dst_factor = GL_ONE_MINUS_SRC_ALPHA;
+	if (texture_->isExtended())
+	{
+		// Get extended patch
+		const auto epatch = dynamic_cast<CTPatchEx*>(patch);
+
+		// Offsets, flips and rotation
+		if (epatch->useOffsets())
+		{
+			x -= patch_image_offsets_[num].x;
+			y -= patch_image_offsets_[num].y;
+		}
+		flipx    = epatch->flipX();
+		flipy    = epatch->flipY();
+		rotation = epatch->rotation();
+
+		// Style
+		const auto style = epatch->style();
+		if (style == "CopyAlpha" || style == "Overlay")
+			src_alpha = true;
+		else if (style == "Translucent" || style == "CopyNewAlpha")
+			alpha = epatch->alpha();
+		else if (style == "Add")
+		{
+			dst_factor = GL_ONE;
+			alpha      = epatch->alpha();
+		}
+		else if (style == "Subtract")
+		{
+			equation   = GL_FUNC_REVERSE_SUBTRACT;
+			dst_factor = GL_ONE;
+			alpha      = epatch->alpha();
+		}
+		else if (style == "ReverseSubtract")
+		{
+			equation   = GL_FUNC_SUBTRACT;
+			dst_factor = GL_ONE;
+			alpha      = epatch->alpha();
+		}
+		else if (style == "Modulate")
+		{
+			src_factor = GL_DST_COLOR;
+			dst_factor = GL_ZERO;
+			alpha      = epatch->alpha();
+		}
+
+		// Colour blend
+		colour = epatch->colour();
+		if (epatch->blendType() == CTPatchEx::BlendType::Blend)
+			blend_type = 1;
+		else if (epatch->blendType() == CTPatchEx::BlendType::Tint)
+			blend_type = 2;
+	}
+
+	// Translate to position, and rotate if needed
+	glPushMatrix();
+	glTranslated(x, y, 0);
+	if (rotation == 90)
+	{
+		glTranslated(tex_info.size.y, 0, 0);
+		glRotated(90, 0, 0, 1);
+	}
+	else if (rotation == 180)
+	{
+		glTranslated(tex_info.size.x, tex_info.size.y, 0);
+		glRotated(180, 0, 0, 1);
+	}
+	else if (rotation == -90)
+	{
+		glTranslated(0, tex_info.size.x, 0);
+		glRotated(-90, 0, 0, 1);
+	}
+
+	// Setup shader and blending (alpha always accumulates)
+	shader.setFixedFunctionMVP();
+	shader.setUniform("alpha", alpha);
+	shader.setUniform("src_alpha", src_alpha ? 1 : 0);
+	shader.setUniform("blend_type", blend_type);
+	shader.setUniform("colour", colour);
+	glBlendEquationSeparate(equation, GL_FUNC_ADD);
+	glBlendFuncSeparate(src_factor, dst_factor, GL_ONE, GL_ONE);
+
+	// Draw the patch
+	const float u1 = flipx ? 1.f : 0.f;
+	const float v1 = flipy ? 1.f : 0.f;
+	const float w  = tex_info.size.x;
+	const float h  = tex_info.size.y;
+	composite_quad_.clear();
+	composite_quad_.add(0, 0, u1, v1, ColRGBA::WHITE);
+	composite_quad_.add(w, 0, 1 - u1, v1, ColRGBA::WHITE);
+	composite_quad_.add(w, h, 1 - u1, 1 - v1, ColRGBA::WHITE);
+	composite_quad_.add(0, 0, u1, v1, ColRGBA::WHITE);
+	composite_quad_.add(w, h, 1 - u1, 1 - v1, ColRGBA::WHITE);
+	composite_quad_.add(0, h, u1, 1 - v1, ColRGBA::WHITE);
+	gl::Texture::bind(patch_textures_[num]);
+	composite_quad_.draw(GL_TRIANGLES, &shader, true);
+
+	glPopMatrix();
+}
+
 // -----------------------------------------------------------------------------
 // Draws a black border around the texture
 // -----------------------------------------------------------------------------
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "OGLCanvas.h"
+#include "OpenGL/FrameBuffer.h"
+#include "OpenGL/VertexBuffer2D.h"
 
 wxDECLARE_EVENT(EVT_DRAG_END, wxCommandEvent);
 
@@ -8,6 +10,10 @@ namespace slade
 {
 class CTexture;
 class Archive;
+namespace gl
+{
+	class Shader;
+}
 namespace ui
 {
 	class ZoomControl;
@@ -24,7 +30,7 @@ public:
 	};
 
 	CTextureCanvas(wxWindow* parent, int id);
-	~CTextureCanvas() = default;
+	~CTextureCanvas() override;
 
 	CTexture* texture() const { return texture_; }
 	View      viewType() const { return view_type_; }
@@ -52,6 +58,7 @@ public:
 	void draw() override;
 	void drawTexture();
 	void drawPatch(int num, bool outside = false);
+	bool drawComposite();
 	void drawTextureBorder() const;
 	void drawOffsetLines() const;
 	void resetOffsets() { offset_.x = offset_.y = 0; }
@@ -69,6 +76,8 @@ private:
 	CTexture*        texture_ = nullptr;
 	Archive*         parent_  = nullptr;
 	vector<unsigned> patch_textures_;
+	vector<string>   patch_texture_keys_; // What each patch texture was loaded from (see loadPatchTexture)
+	vector<Vec2i>    patch_image_offsets_;
 	unsigned         tex_preview_ = 0;
 	vector<bool>     selected_patches_;
 	int              hilight_patch_ = -1;
@@ -83,9 +92,18 @@ private:
 	View             view_type_           = View::Normal;
 	ui::ZoomControl* linked_zoom_control_ = nullptr;
 
+	// GPU compositing (see drawComposite)
+	gl::FrameBuffer        composite_;
+	gl::VertexBuffer2D     composite_quad_;
+	unique_ptr<gl::Shader> composite_shader_;
+
 	// Signal connections
 	sigslot::scoped_connection sc_patches_modified_;
 
+	void loadPatchTexture(unsigned num);
+	bool canComposite() const;
+	void compositePatch(unsigned num, const gl::Shader& shader);
+
 	// Events
 	void onMouseEvent(wxMouseEvent& e);
 };
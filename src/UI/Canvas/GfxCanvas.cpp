@@ -174,7 +174,7 @@ void GfxCanvas::drawOffsetLines() const
 
 // -----------------------------------------------------------------------------
 // Draws the image
-// (reloads the image as a texture each time, will change this later...)
+// (uploaded as tiles, only re-uploading areas changed by painting)
 // -----------------------------------------------------------------------------
 void GfxCanvas::drawImage()
 {
@@ -214,11 +214,12 @@ void GfxCanvas::drawImage()
 			memset(drawing_mask_, false, image_.width() * image_.height());
 		}
 
-		gl::Texture::clear(tex_image_);
-		tex_image_ = gl::Texture::createFromImage(image_, &palette_);
+		tex_image_.load(image_, &palette_);
 
 		update_texture_ = false;
 	}
+	else
+		tex_image_.update(image_, &palette_);
 
 	// Determine (texture)coordinates
 	const double x = image_.width();
@@ -230,19 +231,19 @@ void GfxCanvas::drawImage()
 		// Draw tiled image
 		gl::setColour(255, 255, 255, 255, gl::Blend::Normal);
 		const wxSize size = GetSize() * GetContentScaleFactor();
-		drawing::drawTextureTiled(tex_image_, math::scaleInverse(size.x, scale_), math::scaleInverse(size.y, scale_));
+		tex_image_.drawTiled(math::scaleInverse(size.x, scale_), math::scaleInverse(size.y, scale_));
 	}
 	else if (drag_origin_.x < 0) // If not dragging
 	{
 		// Draw the image
 		gl::setColour(255, 255, 255, 255, gl::Blend::Normal);
-		drawing::drawTexture(tex_image_);
+		tex_image_.draw();
 
 		// Draw hilight otherwise
 		if (image_hilight_ && gfx_hilight_mouseover && editing_mode_ == EditMode::None)
 		{
 			gl::setColour(255, 255, 255, 80, gl::Blend::Additive);
-			drawing::drawTexture(tex_image_);
+			tex_image_.draw();
 
 			// Reset colour
 			gl::setColour(255, 255, 255, 255, gl::Blend::Normal);
@@ -252,14 +253,14 @@ void GfxCanvas::drawImage()
 	{
 		// Draw the original
 		gl::setColour(ColRGBA(0, 0, 0, 180), gl::Blend::Normal);
-		drawing::drawTexture(tex_image_);
+		tex_image_.draw();
 
 		// Draw the dragged image
 		const auto off_x = static_cast<int>((drag_pos_.x - drag_origin_.x) / scale_);
 		const auto off_y = static_cast<int>((drag_pos_.y - drag_origin_.y) / scale_);
 		glTranslated(off_x, off_y, 0);
 		gl::setColour(255, 255, 255, 255, gl::Blend::Normal);
-		drawing::drawTexture(tex_image_);
+		tex_image_.draw();
 	}
 	// Draw brush shadow when in editing mode
 	if (editing_mode_ != EditMode::None && cursor_pos_ != Vec2i{ -1, -1 })
@@ -293,7 +294,10 @@ void GfxCanvas::drawImage()
 // -----------------------------------------------------------------------------
 void GfxCanvas::updateImageTexture()
 {
-	update_texture_ = true;
+	// Painted pixels are marked dirty in paintPixel instead
+	if (!pixel_edit_)
+		update_texture_ = true;
+
 	Refresh();
 }
 
@@ -441,6 +445,7 @@ void GfxCanvas::paintPixel(int x, int y)
 		return;
 
 	bool painted = false;
+	pixel_edit_  = true;
 	if (editing_mode_ == EditMode::Erase) // eraser
 		painted = image_.setPixel(x, y, 255, 0);
 	else if (editing_mode_ == EditMode::Translate) // translator
@@ -457,11 +462,14 @@ void GfxCanvas::paintPixel(int x, int y)
 	}
 	else
 		painted = image_.setPixel(x, y, paint_colour_);
+	pixel_edit_ = false;
 
 	// Mark the modification, if any, and announce the modification
 	drawing_mask_[pos] = painted;
 	if (painted)
 	{
+		tex_image_.markDirty(x, y);
+
 		// Generate event
 		wxNotifyEvent e(wxEVT_GFXCANVAS_PIXELS_CHANGED, GetId());
 		e.SetEventObject(this);
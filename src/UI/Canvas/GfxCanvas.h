@@ -3,6 +3,7 @@
 #include "Graphics/SImage/SImage.h"
 #include "OGLCanvas.h"
 #include "OpenGL/GLTexture.h"
+#include "OpenGL/TiledTexture.h"
 
 namespace slade
 {
@@ -76,8 +77,9 @@ private:
 	View             view_type_ = View::Default;
 	double           scale_     = 1.;
 	Vec2d            offset_; // panning offsets (not image offsets)
-	unsigned         tex_image_      = 0;
+	gl::TiledTexture tex_image_;
 	bool             update_texture_ = false;
+	bool             pixel_edit_     = false; // true while painting a pixel (only its tile area is re-uploaded)
 	bool             image_hilight_  = false;
 	bool             allow_drag_     = false;
 	bool             allow_scroll_   = false;
@@ -34,17 +34,12 @@
 #include "MapPreviewCanvas.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
-#include "Archive/Formats/WadArchive.h"
 #include "General/ColourConfiguration.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "Graphics/SImage/SImage.h"
 #include "OpenGL/GLTexture.h"
-#include "SLADEMap/MapFormat/Doom64MapFormat.h"
-#include "SLADEMap/MapFormat/DoomMapFormat.h"
-#include "SLADEMap/MapFormat/HexenMapFormat.h"
-#include "SLADEMap/MapFormat/Doom32XMapFormat.h"
-#include "SLADEMap/MapObject/MapThing.h"
-#include "Utility/Tokenizer.h"
+#include "OpenGL/VertexBuffer2D.h"
+#include "SLADEMap/MapPreviewData.h"
 
 using namespace slade;
 
@@ -66,333 +61,29 @@ CVAR(Bool, map_view_things, true, CVar::Flag::Save)
 
 
 // -----------------------------------------------------------------------------
-// Adds a vertex to the map data
+// MapPreviewCanvas class destructor
 // -----------------------------------------------------------------------------
-void MapPreviewCanvas::addVertex(double x, double y)
+MapPreviewCanvas::~MapPreviewCanvas()
 {
-	verts_.emplace_back(x, y);
+	if (vbo_ > 0 && glDeleteBuffers)
+		glDeleteBuffers(1, &vbo_);
 }
 
 // -----------------------------------------------------------------------------
-// Adds a line to the map data
+// Opens [map] for previewing.
+// The map geometry is cached (see MapPreviewData::load), so opening a map
+// again is fast if it hasn't changed
 // -----------------------------------------------------------------------------
-void MapPreviewCanvas::addLine(unsigned v1, unsigned v2, bool twosided, bool special, bool macro)
+bool MapPreviewCanvas::openMap(const Archive::MapDesc& map)
 {
-	lines_.emplace_back(v1, v2, twosided, special, macro);
-}
-
-// -----------------------------------------------------------------------------
-// Adds a thing to the map data
-// -----------------------------------------------------------------------------
-void MapPreviewCanvas::addThing(double x, double y)
-{
-	things_.emplace_back(x, y);
-}
-
-// -----------------------------------------------------------------------------
-// Opens a map from a mapdesc_t
-// -----------------------------------------------------------------------------
-bool MapPreviewCanvas::openMap(Archive::MapDesc map)
-{
-	auto m_head = map.head.lock();
-	if (!m_head)
-		return false;
-
 	// All errors = invalid map
 	global::error = "Invalid map";
 
-	// Init
-	std::unique_ptr<Archive> temp_archive;
-
-	// Check if this map is a pk3 map
-	bool map_archive = false;
-	if (map.archive)
-	{
-		map_archive = true;
-
-		// Attempt to open entry as wad archive
-		temp_archive_ = std::make_unique<WadArchive>();
-		if (!temp_archive_->open(m_head->data()))
-		{
-			temp_archive_.reset();
-			return false;
-		}
-
-		// Detect maps
-		auto maps = temp_archive_->detectMaps();
-
-		// Set map if there are any in the archive
-		if (!maps.empty())
-			map = maps[0];
-		else
-			return false;
-
-		m_head = maps[0].head.lock();
-	}
-
-	// Parse UDMF map
-	if (map.format == MapFormat::UDMF)
-	{
-		ArchiveEntry* udmfdata  = nullptr;
-		auto          archive   = m_head->parent();
-		auto          index     = archive->entryIndex(m_head.get());
-		auto          end_index = archive->entryIndex(map.end.lock().get());
-		while (index <= end_index)
-		{
-			// Check entry type
-			auto entry = archive->entryAt(index);
-			if (entry->type() == EntryType::fromId("udmf_textmap"))
-			{
-				udmfdata = entry;
-				break;
-			}
-			++index;
-		}
-		if (udmfdata == nullptr)
-			return false;
-
-		// Start parsing
-		Tokenizer tz;
-		tz.openMem(udmfdata->data(), m_head->name());
-		size_t vertcounter = 0, linecounter = 0, thingcounter = 0;
-		while (!tz.atEnd())
-		{
-			// Namespace
-			if (tz.checkNC("namespace"))
-				tz.advUntil(";");
-
-			// Sidedef
-			else if (tz.checkNC("sidedef"))
-			{
-				// Just increase count
-				n_sides_++;
-				tz.advUntil("}");
-			}
-
-			// Sector
-			else if (tz.checkNC("sector"))
-			{
-				// Just increase count
-				n_sectors_++;
-				tz.advUntil("}");
-			}
-
-			// Vertex
-			else if (tz.checkNC("vertex"))
-			{
-				// Get X and Y properties
-				bool   gotx = false;
-				bool   goty = false;
-				double x    = 0.;
-				double y    = 0.;
-
-				tz.adv(2); // skip {
-
-				while (!tz.check("}"))
-				{
-					if (tz.checkNC("x") || tz.checkNC("y"))
-					{
-						if (!tz.checkNext("="))
-						{
-							log::error(wxString::Format("Bad syntax for vertex %i in UDMF map data", vertcounter));
-							return false;
-						}
-
-						if (tz.checkNC("x"))
-						{
-							tz.adv(2);
-							x    = tz.current().asFloat();
-							gotx = true;
-						}
-						else
-						{
-							tz.adv(2);
-							y    = tz.current().asFloat();
-							goty = true;
-						}
-					}
-
-					tz.advUntil(";");
-					tz.adv();
-				}
-
-				if (gotx && goty)
-					addVertex(x, y);
-				else
-				{
-					log::error(wxString::Format("Wrong vertex %i in UDMF map data", vertcounter));
-					return false;
-				}
-
-				vertcounter++;
-			}
-
-			// Thing
-			else if (tz.checkNC("thing"))
-			{
-				// Get X and Y properties
-				bool   gotx = false;
-				bool   goty = false;
-				double x    = 0.;
-				double y    = 0.;
-
-				tz.adv(2); // skip {
-
-				while (!tz.check("}"))
-				{
-					if (tz.checkNC("x") || tz.checkNC("y"))
-					{
-						if (!tz.checkNext("="))
-						{
-							log::error(wxString::Format("Bad syntax for thing %i in UDMF map data", thingcounter));
-							return false;
-						}
-
-						if (tz.checkNC("x"))
-						{
-							tz.adv(2);
-							x    = tz.current().asFloat();
-							gotx = true;
-						}
-						else
-						{
-							tz.adv(2);
-							y    = tz.current().asFloat();
-							goty = true;
-						}
-					}
-
-					tz.advUntil(";");
-					tz.adv();
-				}
-
-				if (gotx && goty)
-					addThing(x, y);
-				else
-				{
-					log::error(wxString::Format("Wrong thing %i in UDMF map data", thingcounter));
-					return false;
-				}
-
-				thingcounter++;
-			}
-
-			// Linedef
-			else if (tz.checkNC("linedef"))
-			{
-				bool     special  = false;
-				bool     twosided = false;
-				bool     gotv1 = false, gotv2 = false;
-				unsigned v1 = 0, v2 = 0;
-
-				tz.adv(2); // skip {
-
-				while (!tz.check("}"))
-				{
-					if (tz.checkNC("v1") || tz.checkNC("v2"))
-					{
-						if (!tz.checkNext("="))
-						{
-							log::error(wxString::Format("Bad syntax for linedef %i in UDMF map data", linecounter));
-							return false;
-						}
-
-						if (tz.checkNC("v1"))
-						{
-							tz.adv(2);
-							v1    = tz.current().asInt();
-							gotv1 = true;
-						}
-						else
-						{
-							tz.adv(2);
-							v2    = tz.current().asInt();
-							gotv2 = true;
-						}
-					}
-					else if (tz.checkNC("special"))
-						special = true;
-					else if (tz.checkNC("sideback"))
-						twosided = true;
-
-					tz.advUntil(";");
-					tz.adv();
-				}
-
-				if (gotv1 && gotv2)
-					addLine(v1, v2, twosided, special);
-				else
-				{
-					log::error(wxString::Format("Wrong line %i in UDMF map data", linecounter));
-					return false;
-				}
-
-				linecounter++;
-			}
-
-			tz.adv();
-		}
-	}
-
-	// Non-UDMF map
-	if (map.format != MapFormat::UDMF)
-	{
-		auto m_head = map.head.lock().get();
-		auto m_end  = map.end.lock().get();
-
-		// Read vertices (required)
-		if (!readVertices(m_head, m_end, map.format))
-			return false;
-
-		// Read linedefs (required)
-		if (!readLines(m_head, m_end, map.format))
-			return false;
-
-		// Read things
-		if (map.format != MapFormat::UDMF)
-			readThings(m_head, m_end, map.format);
-
-		// Read sides & sectors (count only)
-		ArchiveEntry* sidedefs = nullptr;
-		ArchiveEntry* sectors  = nullptr;
-		while (m_head)
-		{
-			// Check entry type
-			if (m_head->type() == EntryType::fromId("map_sidedefs"))
-				sidedefs = m_head;
-			if (m_head->type() == EntryType::fromId("map_sectors"))
-				sectors = m_head;
-
-			// Exit loop if we've reached the end of the map entries
-			if (m_head == m_end)
-				break;
-			else
-				m_head = m_head->nextEntry();
-		}
-		if (sidedefs && sectors)
-		{
-			// Doom64 map
-			if (map.format != MapFormat::Doom64)
-			{
-				n_sides_   = sidedefs->size() / 30;
-				n_sectors_ = sectors->size() / 26;
-			}
-
-			// Doom/Hexen map
-			else
-			{
-				n_sides_   = sidedefs->size() / 12;
-				n_sectors_ = sectors->size() / 16;
-			}
-		}
-	}
+	auto data = MapPreviewData::load(map);
+	if (!data)
+		return false;
 
-	// Clean up
-	if (map_archive)
-	{
-		temp_archive_->close();
-		temp_archive_ = nullptr;
-	}
+	map_ = data;
 
 	// Refresh map
 	Refresh();
@@ -401,233 +92,12 @@ bool MapPreviewCanvas::openMap(Archive::MapDesc map)
 }
 
 // -----------------------------------------------------------------------------
-// Reads non-UDMF vertex data
-// -----------------------------------------------------------------------------
-bool MapPreviewCanvas::readVertices(ArchiveEntry* map_head, ArchiveEntry* map_end, MapFormat map_format)
-{
-	// Find VERTEXES entry
-	ArchiveEntry* vertexes = nullptr;
-	while (map_head)
-	{
-		// Check entry type
-		if (map_head->type() == EntryType::fromId("map_vertexes"))
-		{
-			vertexes = map_head;
-			break;
-		}
-
-		// Exit loop if we've reached the end of the map entries
-		if (map_head == map_end)
-			break;
-		else
-			map_head = map_head->nextEntry();
-	}
-
-	// Can't open a map without vertices
-	if (!vertexes)
-		return false;
-
-	// Read vertex data
-	auto& mc = vertexes->data();
-	mc.seek(0, SEEK_SET);
-
-	if (map_format == MapFormat::Doom64)
-	{
-		Doom64MapFormat::Vertex v;
-		while (true)
-		{
-			// Read vertex
-			if (!mc.read(&v, 8))
-				break;
-
-			// Add vertex
-			addVertex((double)v.x / 65536, (double)v.y / 65536);
-		}
-	}
-	else if (map_format == MapFormat::Doom32X)
-	{
-		Doom32XMapFormat::Vertex32BE v;
-		while (true)
-		{
-			// Read vertex
-			if (!mc.read(&v, 8))
-				break;
-
-			// Add vertex
-			addVertex((double)wxINT32_SWAP_ON_LE(v.x) / 65536, (double)wxINT32_SWAP_ON_LE(v.y) / 65536);
-		}
-	}
-	else
-	{
-		DoomMapFormat::Vertex v;
-		while (true)
-		{
-			// Read vertex
-			if (!mc.read(&v, 4))
-				break;
-
-			// Add vertex
-			addVertex((double)v.x, (double)v.y);
-		}
-	}
-
-	return true;
-}
-
-// -----------------------------------------------------------------------------
-// Reads non-UDMF line data
+// Shows [map] (already read, eg. on a background thread) in the preview
 // -----------------------------------------------------------------------------
-bool MapPreviewCanvas::readLines(ArchiveEntry* map_head, ArchiveEntry* map_end, MapFormat map_format)
+void MapPreviewCanvas::setMap(const shared_ptr<const MapPreviewData>& map)
 {
-	// Find LINEDEFS entry
-	ArchiveEntry* linedefs = nullptr;
-	while (map_head)
-	{
-		// Check entry type
-		if (map_head->type() == EntryType::fromId("map_linedefs"))
-		{
-			linedefs = map_head;
-			break;
-		}
-
-		// Exit loop if we've reached the end of the map entries
-		if (map_head == map_end)
-			break;
-		else
-			map_head = map_head->nextEntry();
-	}
-
-	// Can't open a map without linedefs
-	if (!linedefs)
-		return false;
-
-	// Read line data
-	auto& mc = linedefs->data();
-	mc.seek(0, SEEK_SET);
-	if (map_format == MapFormat::Doom || map_format == MapFormat::Doom32X)
-	{
-		while (true)
-		{
-			// Read line
-			DoomMapFormat::LineDef l;
-			if (!mc.read(&l, sizeof(DoomMapFormat::LineDef)))
-				break;
-
-			// Check properties
-			bool special  = false;
-			bool twosided = false;
-			if (l.side2 != 0xFFFF)
-				twosided = true;
-			if (l.type > 0)
-				special = true;
-
-			// Add line
-			addLine(l.vertex1, l.vertex2, twosided, special);
-		}
-	}
-	else if (map_format == MapFormat::Doom64)
-	{
-		while (true)
-		{
-			// Read line
-			Doom64MapFormat::LineDef l;
-			if (!mc.read(&l, sizeof(Doom64MapFormat::LineDef)))
-				break;
-
-			// Check properties
-			bool macro    = false;
-			bool special  = false;
-			bool twosided = false;
-			if (l.side2 != 0xFFFF)
-				twosided = true;
-			if (l.type > 0)
-			{
-				if (l.type & 0x100)
-					macro = true;
-				else
-					special = true;
-			}
-
-			// Add line
-			addLine(l.vertex1, l.vertex2, twosided, special, macro);
-		}
-	}
-	else if (map_format == MapFormat::Hexen)
-	{
-		while (true)
-		{
-			// Read line
-			HexenMapFormat::LineDef l;
-			if (!mc.read(&l, sizeof(HexenMapFormat::LineDef)))
-				break;
-
-			// Check properties
-			bool special  = false;
-			bool twosided = false;
-			if (l.side2 != 0xFFFF)
-				twosided = true;
-			if (l.type > 0)
-				special = true;
-
-			// Add line
-			addLine(l.vertex1, l.vertex2, twosided, special);
-		}
-	}
-
-	return true;
-}
-
-// -----------------------------------------------------------------------------
-// Reads non-UDMF thing data
-// -----------------------------------------------------------------------------
-bool MapPreviewCanvas::readThings(ArchiveEntry* map_head, ArchiveEntry* map_end, MapFormat map_format)
-{
-	// Find THINGS entry
-	ArchiveEntry* things = nullptr;
-	while (map_head)
-	{
-		// Check entry type
-		if (map_head->type() == EntryType::fromId("map_things"))
-		{
-			things = map_head;
-			break;
-		}
-
-		// Exit loop if we've reached the end of the map entries
-		if (map_head == map_end)
-			break;
-		else
-			map_head = map_head->nextEntry();
-	}
-
-	// No things
-	if (!things)
-		return false;
-
-	// Read things data
-	if (map_format == MapFormat::Doom || map_format == MapFormat::Doom32X)
-	{
-		auto     thng_data = (DoomMapFormat::Thing*)things->rawData(true);
-		unsigned nt        = things->size() / sizeof(DoomMapFormat::Thing);
-		for (size_t a = 0; a < nt; a++)
-			addThing(thng_data[a].x, thng_data[a].y);
-	}
-	else if (map_format == MapFormat::Doom64)
-	{
-		auto     thng_data = (Doom64MapFormat::Thing*)things->rawData(true);
-		unsigned nt        = things->size() / sizeof(Doom64MapFormat::Thing);
-		for (size_t a = 0; a < nt; a++)
-			addThing(thng_data[a].x, thng_data[a].y);
-	}
-	else if (map_format == MapFormat::Hexen)
-	{
-		auto     thng_data = (HexenMapFormat::Thing*)things->rawData(true);
-		unsigned nt        = things->size() / sizeof(HexenMapFormat::Thing);
-		for (size_t a = 0; a < nt; a++)
-			addThing(thng_data[a].x, thng_data[a].y);
-	}
-
-	return true;
+	map_ = map;
+	Refresh();
 }
 
 // -----------------------------------------------------------------------------
@@ -635,11 +105,7 @@ bool MapPreviewCanvas::readThings(ArchiveEntry* map_head, ArchiveEntry* map_end,
 // -----------------------------------------------------------------------------
 void MapPreviewCanvas::clearMap()
 {
-	verts_.clear();
-	lines_.clear();
-	things_.clear();
-	n_sides_   = 0;
-	n_sectors_ = 0;
+	map_.reset();
 }
 
 // -----------------------------------------------------------------------------
@@ -647,30 +113,17 @@ void MapPreviewCanvas::clearMap()
 // -----------------------------------------------------------------------------
 void MapPreviewCanvas::showMap()
 {
-	// Find extents of map
-	Vertex m_min(999999.0, 999999.0);
-	Vertex m_max(-999999.0, -999999.0);
-	for (auto& vert : verts_)
-	{
-		if (vert.x < m_min.x)
-			m_min.x = vert.x;
-		if (vert.x > m_max.x)
-			m_max.x = vert.x;
-		if (vert.y < m_min.y)
-			m_min.y = vert.y;
-		if (vert.y > m_max.y)
-			m_max.y = vert.y;
-	}
+	if (!map_)
+		return;
 
 	// Offset to center of map
-	double width  = m_max.x - m_min.x;
-	double height = m_max.y - m_min.y;
-	offset_       = { m_min.x + (width * 0.5), m_min.y + (height * 0.5) };
+	auto bbox = map_->bounds();
+	offset_   = bbox.mid();
 
 	// Zoom to fit whole map
 	const wxSize ClientSize = GetClientSize() * GetContentScaleFactor();
-	double       x_scale    = ((double)ClientSize.x) / width;
-	double       y_scale    = ((double)ClientSize.y) / height;
+	double       x_scale    = ((double)ClientSize.x) / bbox.width();
+	double       y_scale    = ((double)ClientSize.y) / bbox.height();
 	zoom_                   = std::min<double>(x_scale, y_scale);
 	zoom_ *= 0.95;
 }
@@ -681,12 +134,7 @@ void MapPreviewCanvas::showMap()
 void MapPreviewCanvas::draw()
 {
 	// Setup colours
-	auto col_view_background   = colourconfig::colour("map_view_background");
-	auto col_view_line_1s      = colourconfig::colour("map_view_line_1s");
-	auto col_view_line_2s      = colourconfig::colour("map_view_line_2s");
-	auto col_view_line_special = colourconfig::colour("map_view_line_special");
-	auto col_view_line_macro   = colourconfig::colour("map_view_line_macro");
-	auto col_view_thing        = colourconfig::colour("map_view_thing");
+	auto col_view_background = colourconfig::colour("map_view_background");
 
 	// Setup the viewport
 	const wxSize size = GetSize() * GetContentScaleFactor();
@@ -708,6 +156,12 @@ void MapPreviewCanvas::draw()
 		((double)col_view_background.a) / 255.f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+	if (!map_)
+	{
+		SwapBuffers();
+		return;
+	}
+
 	// Translate to inside of pixel (otherwise inaccuracies can occur on certain gl implementations)
 	if (gl::accuracyTweak())
 		glTranslatef(0.375f, 0.375f, 0);
@@ -724,40 +178,6 @@ void MapPreviewCanvas::draw()
 	// Translate to offset
 	glTranslated(-offset_.x, -offset_.y, 0);
 
-	// Setup drawing
-	glDisable(GL_TEXTURE_2D);
-	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-	glLineWidth(1.5f);
-	glEnable(GL_LINE_SMOOTH);
-
-	// Draw lines
-	for (auto& line : lines_)
-	{
-		// Check ends
-		if (line.v1 >= verts_.size() || line.v2 >= verts_.size())
-			continue;
-
-		// Get vertices
-		auto v1 = verts_[line.v1];
-		auto v2 = verts_[line.v2];
-
-		// Set colour
-		if (line.special)
-			gl::setColour(col_view_line_special);
-		else if (line.macro)
-			gl::setColour(col_view_line_macro);
-		else if (line.twosided)
-			gl::setColour(col_view_line_2s);
-		else
-			gl::setColour(col_view_line_1s);
-
-		// Draw line
-		glBegin(GL_LINES);
-		glVertex2d(v1.x, v1.y);
-		glVertex2d(v2.x, v2.y);
-		glEnd();
-	}
-
 	// Load thing texture if needed
 	if (!tex_loaded_)
 	{
@@ -775,43 +195,45 @@ void MapPreviewCanvas::draw()
 		tex_loaded_ = true;
 	}
 
+	// Update geometry VBO if needed
+	updateVBO();
+
+	// Setup drawing
+	glDisable(GL_TEXTURE_2D);
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+	glLineWidth(1.5f);
+	glEnable(GL_LINE_SMOOTH);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(gl::VertexBuffer2D::Vertex), nullptr);
+	glColorPointer(
+		4, GL_FLOAT, sizeof(gl::VertexBuffer2D::Vertex), (void*)offsetof(gl::VertexBuffer2D::Vertex, r));
+
+	// Draw lines
+	glDrawArrays(GL_LINES, 0, vbo_n_lines_ * 2);
+
 	// Draw things
 	if (map_view_things)
 	{
-		gl::setColour(col_view_thing);
 		if (tex_thing_)
 		{
-			double radius = 20;
 			glEnable(GL_TEXTURE_2D);
 			gl::Texture::bind(tex_thing_);
-			for (auto& thing : things_)
-			{
-				glPushMatrix();
-				glTranslated(thing.x, thing.y, 0);
-				glBegin(GL_QUADS);
-				glTexCoord2f(0.0f, 0.0f);
-				glVertex2d(-radius, -radius);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex2d(-radius, radius);
-				glTexCoord2f(1.0f, 1.0f);
-				glVertex2d(radius, radius);
-				glTexCoord2f(1.0f, 0.0f);
-				glVertex2d(radius, -radius);
-				glEnd();
-				glPopMatrix();
-			}
-		}
-		else
-		{
-			glEnable(GL_POINT_SMOOTH);
-			glPointSize(8.0f);
-			glBegin(GL_POINTS);
-			for (auto& thing : things_)
-				glVertex2d(thing.x, thing.y);
-			glEnd();
+			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+			glTexCoordPointer(
+				2, GL_FLOAT, sizeof(gl::VertexBuffer2D::Vertex), (void*)offsetof(gl::VertexBuffer2D::Vertex, u));
 		}
+
+		glDrawArrays(GL_QUADS, vbo_n_lines_ * 2, vbo_n_things_ * 4);
+
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisable(GL_TEXTURE_2D);
 	}
 
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glLineWidth(1.0f);
 	glDisable(GL_LINE_SMOOTH);
 
@@ -819,186 +241,108 @@ void MapPreviewCanvas::draw()
 	SwapBuffers();
 }
 
-
 // -----------------------------------------------------------------------------
-// Draws the map in an image
-// TODO: Factorize code with normal draw() and showMap() functions.
-// TODO: Find a way to generate an arbitrary-sized image through tiled rendering
+// Uploads the current map's lines and things to the geometry VBO, if the map
+// or the preview colours have changed since it was last updated
 // -----------------------------------------------------------------------------
-void MapPreviewCanvas::createImage(ArchiveEntry& ae, int width, int height)
+void MapPreviewCanvas::updateVBO()
 {
-	// Find extents of map
-	Vertex m_min(999999.0, 999999.0);
-	Vertex m_max(-999999.0, -999999.0);
-	for (auto& vert : verts_)
-	{
-		if (vert.x < m_min.x)
-			m_min.x = vert.x;
-		if (vert.x > m_max.x)
-			m_max.x = vert.x;
-		if (vert.y < m_min.y)
-			m_min.y = vert.y;
-		if (vert.y > m_max.y)
-			m_max.y = vert.y;
-	}
-	double mapwidth  = m_max.x - m_min.x;
-	double mapheight = m_max.y - m_min.y;
-
-	if (width == 0)
-		width = -5;
-	if (height == 0)
-		height = -5;
-	if (width < 0)
-		width = mapwidth / abs(width);
-	if (height < 0)
-		height = mapheight / abs(height);
-
-	// Setup colours
-	auto col_save_background   = colourconfig::colour("map_image_background");
-	auto col_save_line_1s      = colourconfig::colour("map_image_line_1s");
-	auto col_save_line_2s      = colourconfig::colour("map_image_line_2s");
-	auto col_save_line_special = colourconfig::colour("map_image_line_special");
-	auto col_save_line_macro   = colourconfig::colour("map_image_line_macro");
-
-	// Setup OpenGL rigmarole
-	GLuint tex_id, fbo_id;
-	if (gl::fboSupport())
-	{
-		glGenTextures(1, &tex_id);
-		gl::Texture::bind(tex_id);
-		// We don't use mipmaps, but OpenGL will refuse to attach
-		// the texture to the framebuffer if they are not present
-		glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-		gl::Texture::bind(0);
-		glGenFramebuffersEXT(1, &fbo_id);
-		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo_id);
-		glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, tex_id, 0);
-		GLenum status = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT);
-	}
-
-	glViewport(0, 0, width, height);
-
-	// Setup the screen projection
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	glOrtho(0, width, 0, height, -1, 1);
-
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-
-	// Clear
-	glClearColor(
-		((double)col_save_background.r) / 255.f,
-		((double)col_save_background.g) / 255.f,
-		((double)col_save_background.b) / 255.f,
-		((double)col_save_background.a) / 255.f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-	// Translate to inside of pixel (otherwise inaccuracies can occur on certain gl implementations)
-	if (gl::accuracyTweak())
-		glTranslatef(0.375f, 0.375f, 0);
-
-	// Zoom/offset to show full map
-	// Offset to center of map
-	offset_ = { m_min.x + (mapwidth * 0.5), m_min.y + (mapheight * 0.5) };
-
-	// Zoom to fit whole map
-	double x_scale = ((double)width) / mapwidth;
-	double y_scale = ((double)height) / mapheight;
-	zoom_          = std::min<double>(x_scale, y_scale);
-	zoom_ *= 0.95;
-
-	// Translate to middle of canvas
-	glTranslated(width >> 1, height >> 1, 0);
-
-	// Zoom
-	glScaled(zoom_, zoom_, 1);
-
-	// Translate to offset
-	glTranslated(-offset_.x, -offset_.y, 0);
-
-	// Setup drawing
-	glDisable(GL_TEXTURE_2D);
-	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-	glLineWidth(map_image_thickness);
-	glEnable(GL_LINE_SMOOTH);
-
-	// Draw 2s lines
-	for (auto& line : lines_)
+	auto            style   = MapPreviewData::viewStyle();
+	vector<ColRGBA> colours = {
+		style.line_1s, style.line_2s, style.line_special, style.line_macro, colourconfig::colour("map_view_thing")
+	};
+
+	// Check if an update is needed
+	auto same_colour = [](const ColRGBA& c1, const ColRGBA& c2) { return c1.equals(c2, true); };
+	if (vbo_ > 0 && vbo_map_ == map_
+		&& std::equal(colours.begin(), colours.end(), vbo_colours_.begin(), vbo_colours_.end(), same_colour))
+		return;
+
+	vector<gl::VertexBuffer2D::Vertex> vertices;
+	auto&                              verts = map_->vertices();
+	vertices.reserve(map_->lines().size() * 2 + map_->things().size() * 4);
+
+	// Lines
+	vbo_n_lines_ = 0;
+	for (auto& line : map_->lines())
 	{
-		if (!line.twosided)
-			continue;
-
 		// Check ends
-		if (line.v1 >= verts_.size() || line.v2 >= verts_.size())
+		if (line.v1 >= verts.size() || line.v2 >= verts.size())
 			continue;
 
-		// Get vertices
-		auto v1 = verts_[line.v1];
-		auto v2 = verts_[line.v2];
-
-		// Set colour
+		// Get colour
+		auto col = style.line_1s;
 		if (line.special)
-			gl::setColour(col_save_line_special);
+			col = style.line_special;
 		else if (line.macro)
-			gl::setColour(col_save_line_macro);
+			col = style.line_macro;
 		else if (line.twosided)
-			gl::setColour(col_save_line_2s);
-		else
-			gl::setColour(col_save_line_1s);
+			col = style.line_2s;
 
-		// Draw line
-		glBegin(GL_LINES);
-		glVertex2d(v1.x, v1.y);
-		glVertex2d(v2.x, v2.y);
-		glEnd();
+		auto& v1 = verts[line.v1];
+		auto& v2 = verts[line.v2];
+		vertices.push_back({ (float)v1.x, (float)v1.y, col.fr(), col.fg(), col.fb(), col.fa(), 0.f, 0.f });
+		vertices.push_back({ (float)v2.x, (float)v2.y, col.fr(), col.fg(), col.fb(), col.fa(), 0.f, 0.f });
+		++vbo_n_lines_;
 	}
 
-	// Draw 1s lines
-	for (auto& line : lines_)
+	// Things (textured quads)
+	const float radius = 20.f;
+	auto&       col    = colours.back();
+	for (auto& thing : map_->things())
 	{
-		if (line.twosided)
-			continue;
-
-		// Check ends
-		if (line.v1 >= verts_.size() || line.v2 >= verts_.size())
-			continue;
-
-		// Get vertices
-		auto v1 = verts_[line.v1];
-		auto v2 = verts_[line.v2];
-
-		// Set colour
-		if (line.special)
-			gl::setColour(col_save_line_special);
-		else if (line.macro)
-			gl::setColour(col_save_line_macro);
-		else
-			gl::setColour(col_save_line_1s);
-
-		// Draw line
-		glBegin(GL_LINES);
-		glVertex2d(v1.x, v1.y);
-		glVertex2d(v2.x, v2.y);
-		glEnd();
+		auto x = (float)thing.x;
+		auto y = (float)thing.y;
+		vertices.push_back({ x - radius, y - radius, col.fr(), col.fg(), col.fb(), col.fa(), 0.f, 0.f });
+		vertices.push_back({ x - radius, y + radius, col.fr(), col.fg(), col.fb(), col.fa(), 0.f, 1.f });
+		vertices.push_back({ x + radius, y + radius, col.fr(), col.fg(), col.fb(), col.fa(), 1.f, 1.f });
+		vertices.push_back({ x + radius, y - radius, col.fr(), col.fg(), col.fb(), col.fa(), 1.f, 0.f });
 	}
+	vbo_n_things_ = map_->things().size();
+
+	// Upload
+	if (vbo_ == 0)
+		glGenBuffers(1, &vbo_);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+	glBufferData(
+		GL_ARRAY_BUFFER,
+		vertices.size() * sizeof(gl::VertexBuffer2D::Vertex),
+		vertices.empty() ? nullptr : vertices.data(),
+		GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	vbo_map_     = map_;
+	vbo_colours_ = colours;
+}
 
-	glLineWidth(1.0f);
-	glDisable(GL_LINE_SMOOTH);
+// -----------------------------------------------------------------------------
+// Draws the map to a [width]x[height] PNG image in [ae]. If [width] or
+// [height] are negative, they are the number of map units per pixel (0 is the
+// same as -5).
+// The image is rendered on the CPU (see MapPreviewData::render), so it can be
+// any size and doesn't require an OpenGL framebuffer
+// -----------------------------------------------------------------------------
+void MapPreviewCanvas::createImage(ArchiveEntry& ae, int width, int height) const
+{
+	if (!map_)
+		return;
 
-	vector<uint8_t> buffer(width * height * 4);
-	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, buffer.data());
+	// Determine image size
+	auto bbox = map_->bounds();
+	if (width == 0)
+		width = -5;
+	if (height == 0)
+		height = -5;
+	if (width < 0)
+		width = bbox.width() / abs(width);
+	if (height < 0)
+		height = bbox.height() / abs(height);
 
-	if (gl::fboSupport())
-	{
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-		glDeleteTextures(1, &tex_id);
-		glDeleteFramebuffersEXT(1, &fbo_id);
-	}
+	// Render map
 	SImage img;
-	img.setImageData(buffer, width, height, SImage::Type::RGBA);
-	img.mirror(true);
+	map_->render(img, width, height, MapPreviewData::imageStyle());
+
+	// Save as png
 	MemChunk mc;
 	SIFormat::getFormat("png")->saveImage(img, mc);
 	ae.importMemChunk(mc);
@@ -1007,63 +351,55 @@ void MapPreviewCanvas::createImage(ArchiveEntry& ae, int width, int height)
 // -----------------------------------------------------------------------------
 // Returns the number of (attached) vertices in the map
 // -----------------------------------------------------------------------------
-unsigned MapPreviewCanvas::nVertices()
+unsigned MapPreviewCanvas::nVertices() const
 {
-	// Get list of used vertices
-	vector<bool> v_used;
-	for (unsigned a = 0; a < verts_.size(); a++)
-		v_used.push_back(false);
-	for (auto& line : lines_)
-	{
-		v_used[line.v1] = true;
-		v_used[line.v2] = true;
-	}
+	return map_ ? map_->nVertices() : 0;
+}
 
-	// Get count of used vertices
-	unsigned count = 0;
-	for (auto&& a : v_used)
-	{
-		if (a)
-			count++;
-	}
+// -----------------------------------------------------------------------------
+// Returns the number of sides in the map
+// -----------------------------------------------------------------------------
+unsigned MapPreviewCanvas::nSides() const
+{
+	return map_ ? map_->nSides() : 0;
+}
 
-	return count;
+// -----------------------------------------------------------------------------
+// Returns the number of lines in the map
+// -----------------------------------------------------------------------------
+unsigned MapPreviewCanvas::nLines() const
+{
+	return map_ ? map_->lines().size() : 0;
 }
 
 // -----------------------------------------------------------------------------
-// Returns the width (in map units) of the map
+// Returns the number of sectors in the map
 // -----------------------------------------------------------------------------
-unsigned MapPreviewCanvas::width()
+unsigned MapPreviewCanvas::nSectors() const
 {
-	int min_x = wxINT32_MAX;
-	int max_x = wxINT32_MIN;
+	return map_ ? map_->nSectors() : 0;
+}
 
-	for (auto& vertex : verts_)
-	{
-		if (vertex.x < min_x)
-			min_x = vertex.x;
-		if (vertex.x > max_x)
-			max_x = vertex.x;
-	}
+// -----------------------------------------------------------------------------
+// Returns the number of things in the map
+// -----------------------------------------------------------------------------
+unsigned MapPreviewCanvas::nThings() const
+{
+	return map_ ? map_->things().size() : 0;
+}
 
-	return max_x - min_x;
+// -----------------------------------------------------------------------------
+// Returns the width (in map units) of the map
+// -----------------------------------------------------------------------------
+unsigned MapPreviewCanvas::width() const
+{
+	return map_ ? static_cast<unsigned>(map_->bounds().width()) : 0;
 }
 
 // -----------------------------------------------------------------------------
 // Returns the height (in map units) of the map
 // -----------------------------------------------------------------------------
-unsigned MapPreviewCanvas::height()
+unsigned MapPreviewCanvas::height() const
 {
-	int min_y = wxINT32_MAX;
-	int max_y = wxINT32_MIN;
-
-	for (auto& vertex : verts_)
-	{
-		if (vertex.y < min_y)
-			min_y = vertex.y;
-		if (vertex.y > max_y)
-			max_y = vertex.y;
-	}
-
-	return max_y - min_y;
+	return map_ ? static_cast<unsigned>(map_->bounds().height()) : 0;
 }
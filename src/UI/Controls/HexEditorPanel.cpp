@@ -79,7 +79,7 @@ wxString HexTable::GetValue(int row, int col)
 		return "";
 	else
 	{
-		uint8_t val = data_[row * hex_grid_width + col];
+		uint8_t val = uByteValue(row * hex_grid_width + col);
 
 		// Hex
 		if (view_type_ == 0)
@@ -107,11 +107,14 @@ void HexTable::SetValue(int row, int col, const wxString& value)
 }
 
 // -----------------------------------------------------------------------------
-// Loads in data from [mc]. Returns true on success, false otherwise
+// Loads in data from [mc]. Returns true on success, false otherwise.
+// The data is shared rather than copied, and since the grid only requests the
+// cells currently shown, only the rows being viewed are ever read (so large
+// memory-mapped data is only paged in as it is scrolled through)
 // -----------------------------------------------------------------------------
 bool HexTable::loadData(MemChunk& mc)
 {
-	data_.importMem(mc.data(), mc.size());
+	data_.share(mc);
 	return true;
 }
 
@@ -137,7 +140,7 @@ uint8_t HexTable::uByteValue(uint32_t offset) const
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as an unsigned short
 // -----------------------------------------------------------------------------
-uint16_t HexTable::uShortValue(uint32_t offset)
+uint16_t HexTable::uShortValue(uint32_t offset) const
 {
 	uint16_t val = 0;
 	if (offset < data_.size() - 1)
@@ -148,7 +151,7 @@ uint16_t HexTable::uShortValue(uint32_t offset)
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as an unsigned 32-bit integer
 // -----------------------------------------------------------------------------
-uint32_t HexTable::uInt32Value(uint32_t offset)
+uint32_t HexTable::uInt32Value(uint32_t offset) const
 {
 	uint32_t val = 0;
 	if (offset < data_.size() - 3)
@@ -159,7 +162,7 @@ uint32_t HexTable::uInt32Value(uint32_t offset)
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as an unsigned 64-bit integer
 // -----------------------------------------------------------------------------
-uint64_t HexTable::uInt64Value(uint32_t offset)
+uint64_t HexTable::uInt64Value(uint32_t offset) const
 {
 	uint64_t val = 0;
 	if (offset < data_.size() - 7)
@@ -170,7 +173,7 @@ uint64_t HexTable::uInt64Value(uint32_t offset)
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as a signed byte
 // -----------------------------------------------------------------------------
-int8_t HexTable::byteValue(uint32_t offset)
+int8_t HexTable::byteValue(uint32_t offset) const
 {
 	int8_t val = 0;
 	if (offset < data_.size())
@@ -181,7 +184,7 @@ int8_t HexTable::byteValue(uint32_t offset)
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as a signed short
 // -----------------------------------------------------------------------------
-int16_t HexTable::shortValue(uint32_t offset)
+int16_t HexTable::shortValue(uint32_t offset) const
 {
 	int16_t val = 0;
 	if (offset < data_.size() - 1)
@@ -192,7 +195,7 @@ int16_t HexTable::shortValue(uint32_t offset)
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as a signed 32-bit integer
 // -----------------------------------------------------------------------------
-int32_t HexTable::int32Value(uint32_t offset)
+int32_t HexTable::int32Value(uint32_t offset) const
 {
 	int32_t val = 0;
 	if (offset < data_.size() - 3)
@@ -203,7 +206,7 @@ int32_t HexTable::int32Value(uint32_t offset)
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as a signed 64-bit integer
 // -----------------------------------------------------------------------------
-int64_t HexTable::int64Value(uint32_t offset)
+int64_t HexTable::int64Value(uint32_t offset) const
 {
 	int64_t val = 0;
 	if (offset < data_.size() - 7)
@@ -214,7 +217,7 @@ int64_t HexTable::int64Value(uint32_t offset)
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as a float
 // -----------------------------------------------------------------------------
-float HexTable::floatValue(uint32_t offset)
+float HexTable::floatValue(uint32_t offset) const
 {
 	float val = 0;
 	if (offset < data_.size() - 3)
@@ -225,7 +228,7 @@ float HexTable::floatValue(uint32_t offset)
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as a double
 // -----------------------------------------------------------------------------
-double HexTable::doubleValue(uint32_t offset)
+double HexTable::doubleValue(uint32_t offset) const
 {
 	double val = 0;
 	if (offset < data_.size() - 7)
@@ -8,7 +8,7 @@ public:
 	HexTable()  = default;
 	~HexTable() = default;
 
-	MemChunk& getData() { return data_; }
+	const MemChunk& getData() const { return data_; }
 
 	// Overrides
 	int      GetNumberRows() override;
@@ -22,18 +22,18 @@ public:
 
 	// Get values
 	uint8_t  uByteValue(uint32_t offset) const;
-	uint16_t uShortValue(uint32_t offset);
-	uint32_t uInt32Value(uint32_t offset);
-	uint64_t uInt64Value(uint32_t offset);
-	int8_t   byteValue(uint32_t offset);
-	int16_t  shortValue(uint32_t offset);
-	int32_t  int32Value(uint32_t offset);
-	int64_t  int64Value(uint32_t offset);
-	float    floatValue(uint32_t offset);
-	double   doubleValue(uint32_t offset);
+	uint16_t uShortValue(uint32_t offset) const;
+	uint32_t uInt32Value(uint32_t offset) const;
+	uint64_t uInt64Value(uint32_t offset) const;
+	int8_t   byteValue(uint32_t offset) const;
+	int16_t  shortValue(uint32_t offset) const;
+	int32_t  int32Value(uint32_t offset) const;
+	int64_t  int64Value(uint32_t offset) const;
+	float    floatValue(uint32_t offset) const;
+	double   doubleValue(uint32_t offset) const;
 
 private:
-	MemChunk data_;
+	MemChunk data_; // Shared with the loaded data (see MemChunk::share), only ever read
 	int      view_type_ = 0;
 };
 
@@ -32,8 +32,11 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "GfxConvDialog.h"
+#include "Archive/ArchiveEntry.h"
 #include "Archive/ArchiveManager.h"
+#include "Archive/EntryType/EntryType.h"
 #include "General/Misc.h"
+#include "General/Tasks.h"
 #include "General/UI.h"
 #include "Graphics/CTexture/CTexture.h"
 #include "Graphics/Icons.h"
@@ -44,6 +47,8 @@
 #include "UI/Controls/PaletteChooser.h"
 #include "UI/Dialogs/Preferences/PreferencesDialog.h"
 #include "UI/WxUtils.h"
+#include "Utility/StringUtils.h"
+#include <atomic>
 
 using namespace slade;
 
@@ -58,6 +63,49 @@ wxString GfxConvDialog::target_palette_name_  = "";
 CVAR(Bool, gfx_extraconv, false, CVar::Flag::Save)
 
 
+// -----------------------------------------------------------------------------
+//
+// GfxConvDialog Structs
+//
+// -----------------------------------------------------------------------------
+
+// A batch conversion of the remaining items (see GfxConvDialog::startBatch).
+// Each item is decoded, converted and written on the task workers, using only
+// what's in here so the dialog stays responsive meanwhile
+struct GfxConvDialog::Batch
+{
+	struct Item
+	{
+		unsigned index = 0; // Index in items_
+
+		// Entry data to decode (if the image wasn't loaded already)
+		bool      decode = false;
+		MemChunk  data; // Shared with the entry (see MemChunk::share)
+		string    format_id;
+		string    format_hint;
+		SIFormat* image_format = nullptr;
+
+		// Conversion palettes (index in palettes)
+		unsigned pal_current = 0;
+		unsigned pal_target  = 0;
+
+		// Result
+		bool loaded   = false;
+		bool writable = false;
+		bool ok       = false;
+	};
+
+	SIFormat*                   format = nullptr;
+	SIFormat::ConvertOptions    options;
+	vector<unique_ptr<Palette>> palettes;         // Copied for each item since palettes aren't thread-safe
+	vector<Palette*>            chooser_palettes; // As returned by the palette choosers (for ConvItem::palette)
+	vector<unique_ptr<Item>>    items;
+
+	tasks::Task           task;
+	std::atomic<unsigned> n_done{ 0 };
+};
+
+
 // -----------------------------------------------------------------------------
 //
 // GfxConvDialog Class Functions
@@ -82,18 +130,48 @@ GfxConvDialog::GfxConvDialog(wxWindow* parent) : SDialog(parent, "Graphic Format
 // -----------------------------------------------------------------------------
 GfxConvDialog::~GfxConvDialog()
 {
+	if (batch_)
+	{
+		batch_->task.cancel();
+		batch_->task.wait();
+	}
+
 	current_palette_name_ = pal_chooser_current_->GetStringSelection();
 	target_palette_name_  = pal_chooser_target_->GetStringSelection();
 }
 
 // -----------------------------------------------------------------------------
-// Opens the next item to be converted.
+// Loads the image for [item] from its entry or texture.
+// Returns false if it isn't a valid image
+// -----------------------------------------------------------------------------
+bool GfxConvDialog::loadItem(ConvItem& item) const
+{
+	// If loading images from entries
+	if (item.entry != nullptr)
+		return misc::loadImageFromEntry(&item.image, item.entry);
+
+	// If loading images from textures
+	if (item.texture != nullptr)
+	{
+		if (item.force_rgba)
+			item.image.convertRGBA(item.palette);
+		return item.texture->toImage(item.image, item.archive, item.palette, item.force_rgba);
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Opens the next item to be converted (skipping any already converted by a
+// batch conversion).
 // Returns true if the selected format was valid for the next image
 // -----------------------------------------------------------------------------
 bool GfxConvDialog::nextItem()
 {
 	// Go to next image
 	current_item_++;
+	while (current_item_ < items_.size() && items_[current_item_].modified)
+		current_item_++;
 	if (current_item_ >= items_.size())
 	{
 		Close(true);
@@ -101,29 +179,8 @@ bool GfxConvDialog::nextItem()
 	}
 
 	// Load image if needed
-	if (!items_[current_item_].image.isValid())
-	{
-		// If loading images from entries
-		if (items_[current_item_].entry != nullptr)
-		{
-			if (!misc::loadImageFromEntry(&(items_[current_item_].image), items_[current_item_].entry))
-				return nextItem(); // Skip if not a valid image entry
-		}
-		// If loading images from textures
-		else if (items_[current_item_].texture != nullptr)
-		{
-			if (items_[current_item_].force_rgba)
-				items_[current_item_].image.convertRGBA(items_[current_item_].palette);
-			if (!items_[current_item_].texture->toImage(
-					items_[current_item_].image,
-					items_[current_item_].archive,
-					items_[current_item_].palette,
-					items_[current_item_].force_rgba))
-				return nextItem(); // Skip if not a valid image entry
-		}
-		else
-			return nextItem(); // Skip if not a valid image entry
-	}
+	if (!items_[current_item_].image.isValid() && !loadItem(items_[current_item_]))
+		return nextItem(); // Skip if not a valid image entry
 
 	// Update valid formats
 	combo_target_format_->Clear();
@@ -242,6 +299,193 @@ void GfxConvDialog::updateButtons() const
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Starts converting all items after the current one to the current format in
+// the background, using all available cores. Any items that can't be written
+// in the current format are left to go through afterwards (see finishBatch)
+// -----------------------------------------------------------------------------
+void GfxConvDialog::startBatch()
+{
+	batch_         = std::make_unique<Batch>();
+	batch_->format = current_format_.format;
+	convertOptions(batch_->options);
+
+	// Returns the index in the batch palettes of the palette selected in
+	// [chooser] for [entry], adding it if needed. Archive palettes are only
+	// looked up once per archive (and palette hack)
+	using PaletteKey = std::pair<Archive*, int>;
+	std::map<PaletteKey, unsigned> pal_indices_current;
+	std::map<PaletteKey, unsigned> pal_indices_target;
+	auto palette_index = [this](PaletteChooser* chooser, ArchiveEntry* entry, std::map<PaletteKey, unsigned>& indices)
+	{
+		PaletteKey key{ nullptr, misc::palhack::NONE };
+		if (chooser->globalSelected() && entry)
+			key = { entry->parent(), misc::detectPaletteHack(entry) };
+
+		if (auto i = indices.find(key); i != indices.end())
+			return i->second;
+
+		auto* pal = chooser->selectedPalette(entry);
+		batch_->chooser_palettes.push_back(pal);
+		batch_->palettes.push_back(std::make_unique<Palette>(*pal));
+		return indices[key] = static_cast<unsigned>(batch_->palettes.size() - 1);
+	};
+
+	// Setup batch items. Anything needing archive or resource access is done
+	// here, on the main thread
+	for (auto index = current_item_ + 1; index < items_.size(); ++index)
+	{
+		auto& conv_item = items_[index];
+		auto  item      = std::make_unique<Batch::Item>();
+		item->index     = static_cast<unsigned>(index);
+
+		// Decode entry images on the worker threads where possible
+		if (!conv_item.image.isValid() && conv_item.entry)
+		{
+			auto& entry = *conv_item.entry;
+			if (entry.type() == EntryType::unknownType())
+				EntryType::detectEntryType(entry);
+			if (!entry.type()->extraProps().contains("image"))
+				continue; // Skip if not a valid image entry
+
+			// Jaguar formats need other entries to load
+			if (!strutil::startsWith(entry.type()->formatId(), "img_jaguar"))
+			{
+				item->decode       = true;
+				item->format_id    = entry.type()->formatId();
+				item->format_hint  = entry.type()->extraProps().getOr<string>("image_format", {});
+				item->image_format = entry.imageFormat();
+				item->data.share(entry.data());
+			}
+		}
+		if (!item->decode && !conv_item.image.isValid() && !loadItem(conv_item))
+			continue; // Skip if not a valid image entry
+
+		item->pal_current = palette_index(pal_chooser_current_, conv_item.entry, pal_indices_current);
+		item->pal_target  = palette_index(pal_chooser_target_, conv_item.entry, pal_indices_target);
+		batch_->items.push_back(std::move(item));
+	}
+
+	// Convert items on the task workers
+	auto* batch        = batch_.get();
+	auto  convert_item = [this, batch](unsigned index)
+	{
+		auto& item      = *batch->items[index];
+		auto& conv_item = items_[item.index];
+
+		// Copy palettes since they aren't thread-safe
+		Palette pal_current(*batch->palettes[item.pal_current]);
+		Palette pal_target(*batch->palettes[item.pal_target]);
+
+		// Decode
+		SImage  decoded;
+		SImage* image = &conv_item.image;
+		if (item.decode)
+		{
+			item.loaded = misc::loadImageFromData(
+				&decoded, item.data, item.format_id, item.format_hint, 0, item.image_format);
+			item.data.clear();
+			image = &decoded;
+		}
+		else
+			item.loaded = true;
+
+		// Convert and write
+		if (item.loaded && batch->format->canWrite(*image) != SIFormat::Writable::No)
+		{
+			auto opt        = batch->options;
+			opt.pal_current = &pal_current;
+			opt.pal_target  = &pal_target;
+			batch->format->convertWritable(*image, opt);
+
+			item.writable  = true;
+			conv_item.data = std::make_unique<MemChunk>();
+			item.ok        = batch->format->saveImage(
+				*image, *conv_item.data, conv_item.force_rgba ? nullptr : opt.pal_target);
+		}
+
+		++batch->n_done;
+	};
+	const auto n_items = static_cast<unsigned>(batch->items.size());
+	batch->task = tasks::run(
+		[convert_item, n_items](const tasks::Task& task) { tasks::parallelFor(0, n_items, convert_item, 1, &task); });
+
+	// Keep the dialog responsive (showing progress) until finished
+	enableControls(false);
+	label_current_format_->SetLabel(wxString::Format("Converting 0 of %u...", n_items));
+	timer_batch_.Start(50);
+}
+
+// -----------------------------------------------------------------------------
+// Waits for the batch conversion to finish and applies its results. If [next]
+// is true, the first item that couldn't be written in the current format is
+// opened (or the dialog closed if there are none)
+// -----------------------------------------------------------------------------
+void GfxConvDialog::finishBatch(bool next)
+{
+	if (!batch_)
+		return;
+
+	timer_batch_.Stop();
+	batch_->task.wait();
+
+	// Apply results
+	auto next_index = items_.size();
+	for (auto& item : batch_->items)
+	{
+		auto& conv_item = items_[item->index];
+		if (item->ok)
+		{
+			conv_item.modified   = true;
+			conv_item.new_format = batch_->format;
+			conv_item.palette    = batch_->chooser_palettes[item->pal_target];
+		}
+		else
+		{
+			conv_item.data.reset();
+			if (item->loaded && !item->writable)
+				next_index = std::min<size_t>(next_index, item->index);
+		}
+	}
+
+	batch_.reset();
+	enableControls(true);
+
+	if (next)
+	{
+		current_item_ = next_index - 1;
+		nextItem();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Enables/disables all conversion option controls and buttons (except
+// 'Skip All', which cancels a batch conversion while they are disabled)
+// -----------------------------------------------------------------------------
+void GfxConvDialog::enableControls(bool enable) const
+{
+	combo_target_format_->Enable(enable);
+	pal_chooser_current_->Enable(enable);
+	pal_chooser_target_->Enable(enable);
+	btn_colorimetry_settings_->Enable(enable);
+	cb_enable_transparency_->Enable(enable);
+	colbox_transparent_->Enable(enable);
+	btn_convert_->Enable(enable);
+	btn_convert_all_->Enable(enable);
+	btn_skip_->Enable(enable);
+	btn_skip_all_->SetLabelText(enable ? "Skip All" : "Cancel");
+
+	if (enable)
+		updateControls();
+	else
+	{
+		rb_transparency_colour_->Enable(false);
+		rb_transparency_existing_->Enable(false);
+		rb_transparency_brightness_->Enable(false);
+		slider_alpha_threshold_->Enable(false);
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Sets up the dialog UI layout
 // -----------------------------------------------------------------------------
@@ -382,6 +626,8 @@ void GfxConvDialog::setupLayout()
 	Bind(wxEVT_COLOURBOX_CHANGED, &GfxConvDialog::onTransColourChanged, this, colbox_transparent_->GetId());
 	gfx_current_->Bind(wxEVT_LEFT_DOWN, &GfxConvDialog::onPreviewCurrentMouseDown, this);
 	btn_colorimetry_settings_->Bind(wxEVT_BUTTON, &GfxConvDialog::onBtnColorimetrySettings, this);
+	timer_batch_.Bind(wxEVT_TIMER, &GfxConvDialog::onBatchTimer, this);
+	Bind(wxEVT_CLOSE_WINDOW, &GfxConvDialog::onClose, this);
 
 
 	// Autosize to fit contents (and set this as the minimum size)
@@ -593,6 +839,24 @@ Palette* GfxConvDialog::itemPalette(int index) const
 	return items_[index].palette;
 }
 
+// -----------------------------------------------------------------------------
+// Writes the converted image for the item at [index] to [out], using the data
+// already written by a batch conversion if possible.
+// Returns false if the item wasn't converted or couldn't be written
+// -----------------------------------------------------------------------------
+bool GfxConvDialog::itemData(int index, MemChunk& out)
+{
+	// Check index
+	if (index < 0 || index >= (int)items_.size() || !items_[index].modified)
+		return false;
+
+	auto& item = items_[index];
+	if (item.data)
+		return out.importMem(*item.data);
+
+	return item.new_format->saveImage(item.image, out, item.force_rgba ? nullptr : item.palette);
+}
+
 // -----------------------------------------------------------------------------
 // Applies the conversion to the current image
 // -----------------------------------------------------------------------------
@@ -645,19 +909,9 @@ void GfxConvDialog::onBtnConvert(wxCommandEvent& e)
 // -----------------------------------------------------------------------------
 void GfxConvDialog::onBtnConvertAll(wxCommandEvent& e)
 {
-	// Show splash window
-	ui::showSplash("Converting Gfx...", true);
-
-	// Convert all images
-	for (size_t a = current_item_; a < items_.size(); a++)
-	{
-		applyConversion();
-		if (!nextItem())
-			break;
-	}
-
-	// Hide splash window
-	ui::hideSplash();
+	// Convert the current image as previewed, then the rest in the background
+	applyConversion();
+	startBatch();
 }
 
 // -----------------------------------------------------------------------------
@@ -673,6 +927,13 @@ void GfxConvDialog::onBtnSkip(wxCommandEvent& e)
 // -----------------------------------------------------------------------------
 void GfxConvDialog::onBtnSkipAll(wxCommandEvent& e)
 {
+	// Cancel any batch conversion (keeping anything already converted)
+	if (batch_)
+	{
+		batch_->task.cancel();
+		finishBatch(false);
+	}
+
 	Close(true);
 }
 
@@ -745,6 +1006,10 @@ void GfxConvDialog::onTransColourChanged(wxEvent& e)
 // -----------------------------------------------------------------------------
 void GfxConvDialog::onPreviewCurrentMouseDown(wxMouseEvent& e)
 {
+	// Ignore while converting in the background
+	if (batch_)
+		return;
+
 	// Get image coordinates of the point clicked
 	auto imgcoord = gfx_current_->imageCoords(e.GetX() * GetContentScaleFactor(), e.GetY() * GetContentScaleFactor());
 	if (imgcoord.x < 0)
@@ -766,3 +1031,34 @@ void GfxConvDialog::onBtnColorimetrySettings(wxCommandEvent& e)
 	PreferencesDialog::openPreferences(this, "Colorimetry");
 	updatePreviewGfx();
 }
+
+// -----------------------------------------------------------------------------
+// Called periodically while a batch conversion is running
+// -----------------------------------------------------------------------------
+void GfxConvDialog::onBatchTimer(wxTimerEvent& e)
+{
+	if (!batch_)
+		return;
+
+	const unsigned done  = batch_->n_done;
+	const auto     total = static_cast<unsigned>(batch_->items.size());
+	if (batch_->task.isFinished())
+		finishBatch(true);
+	else
+		label_current_format_->SetLabel(wxString::Format("Converting %u of %u...", done, total));
+}
+
+// -----------------------------------------------------------------------------
+// Called when the dialog is closed
+// -----------------------------------------------------------------------------
+void GfxConvDialog::onClose(wxCloseEvent& e)
+{
+	// Make sure any batch conversion is finished first
+	if (batch_)
+	{
+		batch_->task.cancel();
+		finishBatch(false);
+	}
+
+	e.Skip();
+}
@@ -57,6 +57,7 @@ public:
 	SImage*   itemImage(int index);
 	SIFormat* itemFormat(int index) const;
 	Palette*  itemPalette(int index) const;
+	bool      itemData(int index, MemChunk& out);
 
 	void applyConversion();
 
@@ -82,6 +83,7 @@ private:
 		Palette*      palette    = nullptr;
 		Archive*      archive    = nullptr;
 		bool          force_rgba = false;
+		unique_ptr<MemChunk> data; // Converted image data, if already written by a batch conversion
 
 		ConvItem(ArchiveEntry* entry = nullptr) : entry{ entry } {}
 
@@ -119,8 +121,17 @@ private:
 	Palette target_pal_;
 	ColRGBA colour_trans_;
 
+	// Batch conversion (see startBatch)
+	struct Batch;
+	unique_ptr<Batch> batch_;
+	wxTimer           timer_batch_;
+
+	bool loadItem(ConvItem& item) const;
 	bool nextItem();
 	void updateButtons() const;
+	void startBatch();
+	void finishBatch(bool next);
+	void enableControls(bool enable) const;
 
 	// Static
 	static wxString current_palette_name_;
@@ -141,5 +152,7 @@ private:
 	void onTransColourChanged(wxEvent& e);
 	void onPreviewCurrentMouseDown(wxMouseEvent& e);
 	void onBtnColorimetrySettings(wxCommandEvent& e);
+	void onBatchTimer(wxTimerEvent& e);
+	void onClose(wxCloseEvent& e);
 };
 } // namespace slade
@@ -36,6 +36,7 @@
 #include "Archive/ArchiveManager.h"
 #include "Archive/Formats/WadArchive.h"
 #include "Game/Configuration.h"
+#include "General/ColourConfiguration.h"
 #include "Graphics/Icons.h"
 #include "UI/Canvas/MapPreviewCanvas.h"
 #include "UI/Controls/BaseResourceChooser.h"
@@ -51,6 +52,8 @@ using namespace slade;
 // Variables
 //
 // -----------------------------------------------------------------------------
+CVAR(Bool, map_list_thumbnails, true, CVar::Flag::Save)
+
 namespace
 {
 struct MapFormatDef
@@ -67,6 +70,58 @@ MapFormatDef map_formats[] = { { MapFormat::Doom, "Doom", "D" },
 } // namespace
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the size of map list thumbnails
+// -----------------------------------------------------------------------------
+int thumbnailSize()
+{
+	return ui::scalePx(64);
+}
+
+// -----------------------------------------------------------------------------
+// Creates a map list thumbnail bitmap from [image] (or blank if null), with a
+// tick or cross icon in the corner depending on whether the map format is
+// [supported] by the current game configuration
+// -----------------------------------------------------------------------------
+wxBitmap thumbnailBitmap(SImage* image, bool supported)
+{
+	auto size = thumbnailSize();
+	auto bg   = colourconfig::colour("map_view_background");
+
+	// Map thumbnail
+	wxImage thumb(size, size);
+	for (int y = 0; y < size; ++y)
+		for (int x = 0; x < size; ++x)
+		{
+			auto col = image && x < image->width() && y < image->height() ? image->pixelAt(x, y) : bg;
+			thumb.SetRGB(x, y, col.r, col.g, col.b);
+		}
+
+	// Format supported icon
+	wxBitmap bitmap(thumb);
+	{
+		wxMemoryDC dc(bitmap);
+		auto       icon_size = ui::scalePx(16);
+#if wxCHECK_VERSION(3, 1, 6)
+		auto icon = icons::getIcon(icons::General, supported ? "tick" : "close").GetBitmap({ icon_size, icon_size });
+#else
+		auto icon = icons::getIcon(icons::General, supported ? "tick" : "close", icon_size);
+#endif
+		dc.DrawBitmap(icon, size - icon_size, size - icon_size, true);
+	}
+
+	return bitmap;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 // NewMapDialog Class
 //
@@ -235,8 +290,17 @@ MapEditorConfigDialog::MapEditorConfigDialog(wxWindow* parent, Archive* archive,
 		sizer->Add(framesizer, 1, wxEXPAND | wxBOTTOM, ui::pad());
 
 		// Map list
-		list_maps_ = new ListView(this, -1, wxLC_SINGLE_SEL | wxLC_LIST);
-		list_maps_->SetImageList(img_list_, wxIMAGE_LIST_SMALL);
+		if (map_list_thumbnails)
+		{
+			img_list_thumbs_ = new wxImageList(thumbnailSize(), thumbnailSize(), false, 0);
+			list_maps_       = new ListView(this, -1, wxLC_SINGLE_SEL | wxLC_ICON);
+			list_maps_->SetImageList(img_list_thumbs_, wxIMAGE_LIST_NORMAL);
+		}
+		else
+		{
+			list_maps_ = new ListView(this, -1, wxLC_SINGLE_SEL | wxLC_LIST);
+			list_maps_->SetImageList(img_list_, wxIMAGE_LIST_SMALL);
+		}
 		framesizer->Add(list_maps_, 1, wxEXPAND | wxALL, ui::pad());
 
 		// New map button
@@ -314,7 +378,9 @@ MapEditorConfigDialog::MapEditorConfigDialog(wxWindow* parent, Archive* archive,
 // -----------------------------------------------------------------------------
 MapEditorConfigDialog::~MapEditorConfigDialog()
 {
+	thumbnail_requests_.clear();
 	delete img_list_;
+	delete img_list_thumbs_;
 }
 
 // -----------------------------------------------------------------------------
@@ -388,6 +454,9 @@ void MapEditorConfigDialog::populateMapList()
 	// Clear list
 	list_maps_->ClearAll();
 	maps_.clear();
+	thumbnail_requests_.clear();
+	if (img_list_thumbs_)
+		img_list_thumbs_->RemoveAll();
 
 	// Check if an archive is open
 	if (!archive_)
@@ -416,10 +485,30 @@ void MapEditorConfigDialog::populateMapList()
 		wxListItem li;
 		li.SetId(index);
 		li.SetText(wxString::Format("(%s) %s", fmt, map.name));
-		if (game::mapFormatSupported(map.format, game, port))
-			li.SetImage(0);
+		bool supported = game::mapFormatSupported(map.format, game, port);
+		if (img_list_thumbs_)
+		{
+			// Add a blank thumbnail, to be replaced when the map thumbnail is
+			// rendered in the background (this also caches the map geometry,
+			// so selecting it to preview is quick)
+			li.SetImage(img_list_thumbs_->Add(thumbnailBitmap(nullptr, supported)));
+			auto style      = MapPreviewData::viewStyle();
+			style.thickness = 1.0f;
+			thumbnail_requests_.push_back(thumbnail_queue_.queue(
+				map,
+				thumbnailSize(),
+				style,
+				[this, index, supported](MapThumbnailQueue::Request& request)
+				{
+					if (!request.ok)
+						return;
+
+					img_list_thumbs_->Replace(index, thumbnailBitmap(&request.image, supported));
+					list_maps_->RefreshItem(index);
+				}));
+		}
 		else
-			li.SetImage(1);
+			li.SetImage(supported ? 0 : 1);
 
 		// Add to list
 		list_maps_->InsertItem(li);
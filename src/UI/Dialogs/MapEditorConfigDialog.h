@@ -2,6 +2,7 @@
 
 #include "Archive/Archive.h"
 #include "UI/Lists/ListView.h"
+#include "UI/Lists/MapThumbnailQueue.h"
 #include "UI/SDialog.h"
 
 class wxImageList;
@@ -35,6 +36,7 @@ private:
 	wxButton*               btn_new_map_          = nullptr;
 	MapPreviewCanvas*       canvas_preview_       = nullptr;
 	wxImageList*            img_list_             = nullptr;
+	wxImageList*            img_list_thumbs_      = nullptr;
 	wxButton*               btn_ok_               = nullptr;
 	wxButton*               btn_cancel_           = nullptr;
 	wxString                game_current_;
@@ -46,6 +48,10 @@ private:
 	vector<wxString>         games_list_;
 	vector<wxString>         ports_list_;
 
+	// Map list thumbnails
+	MapThumbnailQueue                              thumbnail_queue_;
+	vector<shared_ptr<MapThumbnailQueue::Request>> thumbnail_requests_;
+
 	// Events
 	void onChoiceGameConfigChanged(wxCommandEvent& e);
 	void onChoicePortConfigChanged(wxCommandEvent& e);
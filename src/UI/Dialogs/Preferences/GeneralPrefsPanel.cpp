@@ -49,6 +49,7 @@ EXTERN_CVAR(Bool, update_check_beta)
 EXTERN_CVAR(Bool, confirm_exit)
 EXTERN_CVAR(Bool, backup_archives)
 EXTERN_CVAR(Bool, archive_dir_ignore_hidden)
+EXTERN_CVAR(Bool, wad_save_incremental)
 
 
 // -----------------------------------------------------------------------------
@@ -70,6 +71,7 @@ GeneralPrefsPanel::GeneralPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent)
 		cb_wads_root_                 = new wxCheckBox(this, -1, "Auto open nested wad archives"),
 		cb_backup_archives_           = new wxCheckBox(this, -1, "Back up archives"),
 		cb_archive_dir_ignore_hidden_ = new wxCheckBox(this, -1, "Ignore hidden files in directories"),
+		cb_wad_save_incremental_      = new wxCheckBox(this, -1, "Only write changed lumps when saving wads"),
 		new wxStaticLine(this, -1, wxDefaultPosition, wxDefaultSize, wxLI_HORIZONTAL),
 #ifdef __WXMSW__
 		cb_update_check_      = new wxCheckBox(this, -1, "Check for updates on startup"),
@@ -83,6 +85,10 @@ GeneralPrefsPanel::GeneralPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent)
 
 	cb_archive_dir_ignore_hidden_->SetToolTip(
 		"When opening a directory, ignore any files or subdirectories beginning with a '.'");
+
+	cb_wad_save_incremental_->SetToolTip(
+		"When saving a wad file, append new and modified lumps to the end of the file instead of rewriting all "
+		"of it. Use Maintenance->Compact Wad to reclaim the unused space this leaves in the file");
 }
 
 // -----------------------------------------------------------------------------
@@ -100,6 +106,7 @@ void GeneralPrefsPanel::init()
 	cb_confirm_exit_->SetValue(confirm_exit);
 	cb_backup_archives_->SetValue(backup_archives);
 	cb_archive_dir_ignore_hidden_->SetValue(archive_dir_ignore_hidden);
+	cb_wad_save_incremental_->SetValue(wad_save_incremental);
 }
 
 // -----------------------------------------------------------------------------
@@ -117,4 +124,5 @@ void GeneralPrefsPanel::applyPreferences()
 	confirm_exit              = cb_confirm_exit_->GetValue();
 	backup_archives           = cb_backup_archives_->GetValue();
 	archive_dir_ignore_hidden = cb_archive_dir_ignore_hidden_->GetValue();
+	wad_save_incremental      = cb_wad_save_incremental_->GetValue();
 }
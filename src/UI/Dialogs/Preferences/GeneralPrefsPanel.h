@@ -22,5 +22,6 @@ private:
 	wxCheckBox* cb_confirm_exit_              = nullptr;
 	wxCheckBox* cb_backup_archives_           = nullptr;
 	wxCheckBox* cb_archive_dir_ignore_hidden_ = nullptr;
+	wxCheckBox* cb_wad_save_incremental_      = nullptr;
 };
 } // namespace slade
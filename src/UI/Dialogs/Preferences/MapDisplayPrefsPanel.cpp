@@ -61,6 +61,7 @@ EXTERN_CVAR(Bool, line_tabs_always)
 EXTERN_CVAR(Bool, map_animate_hilight)
 EXTERN_CVAR(Bool, map_animate_selection)
 EXTERN_CVAR(Bool, map_animate_tagged)
+EXTERN_CVAR(Bool, map_live_checks)
 EXTERN_CVAR(Bool, line_fade)
 EXTERN_CVAR(Bool, flat_fade)
 EXTERN_CVAR(Int, map_crosshair)
@@ -168,6 +169,13 @@ void MapDisplayPrefsPanel::setupGeneralTab()
 		"Show lines from an object with an action special to the tagged object(s) when highlighted");
 	gb_sizer->Add(cb_action_lines_, { row++, 0 }, { 1, 2 }, wxEXPAND);
 
+	// Show live map check problems
+	cb_live_checks_ = new wxCheckBox(panel, -1, "Show Map Problems While Editing");
+	cb_live_checks_->SetToolTip(
+		"Continuously check modified lines and things for basic problems (missing textures, invalid lines, wrong "
+		"sector references and unknown specials) and mark any found");
+	gb_sizer->Add(cb_live_checks_, { row++, 0 }, { 1, 2 }, wxEXPAND);
+
 	// Show help text
 	cb_show_help_ = new wxCheckBox(panel, -1, "Show Help Text");
 	gb_sizer->Add(cb_show_help_, { row++, 0 }, { 1, 2 }, wxEXPAND);
@@ -354,6 +362,7 @@ void MapDisplayPrefsPanel::init()
 	slider_flat_brightness_->SetValue(flat_brightness * 10);
 	choice_crosshair_->Select(map_crosshair);
 	cb_action_lines_->SetValue(action_lines);
+	cb_live_checks_->SetValue(map_live_checks);
 	cb_show_help_->SetValue(map_show_help);
 	choice_tex_filter_->Select(map_tex_filter);
 	cb_use_zeth_icons_->SetValue(use_zeth_icons);
@@ -393,6 +402,7 @@ void MapDisplayPrefsPanel::applyPreferences()
 	flat_fade             = cb_flat_fade_->GetValue();
 	map_crosshair         = choice_crosshair_->GetSelection();
 	action_lines          = cb_action_lines_->GetValue();
+	map_live_checks       = cb_live_checks_->GetValue();
 	map_show_help         = cb_show_help_->GetValue();
 	map_tex_filter        = choice_tex_filter_->GetSelection();
 	use_zeth_icons        = cb_use_zeth_icons_->GetValue();
@@ -34,6 +34,7 @@ private:
 	wxCheckBox* cb_animate_tagged_    = nullptr;
 	wxChoice*   choice_crosshair_     = nullptr;
 	wxCheckBox* cb_action_lines_      = nullptr;
+	wxCheckBox* cb_live_checks_       = nullptr;
 	wxCheckBox* cb_show_help_         = nullptr;
 	wxChoice*   choice_tex_filter_    = nullptr;
 
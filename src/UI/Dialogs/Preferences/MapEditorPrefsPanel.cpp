@@ -52,6 +52,7 @@ EXTERN_CVAR(Bool, map_remove_invalid_lines)
 EXTERN_CVAR(Int, max_map_backups)
 EXTERN_CVAR(Bool, map_merge_lines_on_delete_vertex)
 EXTERN_CVAR(Bool, map_split_auto_offset)
+EXTERN_CVAR(Bool, map_optimise_order_on_save)
 
 
 // -----------------------------------------------------------------------------
@@ -82,6 +83,7 @@ MapEditorPrefsPanel::MapEditorPrefsPanel(wxWindow* parent) : PrefsPanelBase(pare
 			cb_remove_invalid_lines_ = new wxCheckBox(this, -1, "Remove any resulting invalid lines on sector delete"),
 			cb_merge_lines_vertex_delete_ = new wxCheckBox(this, -1, "Merge connected lines when deleting a vertex"),
 			cb_split_auto_offset_         = new wxCheckBox(this, -1, "Automatic x-offset on line split"),
+			cb_optimise_order_on_save_ = new wxCheckBox(this, -1, "Optimise map object order when saving"),
 			wxutil::createLabelHBox(this, "Max backups to keep:", text_max_backups_ = new NumberTextCtrl(this)) },
 		wxSizerFlags(0).Expand());
 
@@ -102,6 +104,7 @@ void MapEditorPrefsPanel::init()
 	cb_remove_invalid_lines_->SetValue(map_remove_invalid_lines);
 	cb_merge_lines_vertex_delete_->SetValue(map_merge_lines_on_delete_vertex);
 	cb_split_auto_offset_->SetValue(map_split_auto_offset);
+	cb_optimise_order_on_save_->SetValue(map_optimise_order_on_save);
 	text_max_backups_->setNumber(max_map_backups);
 }
 
@@ -119,5 +122,6 @@ void MapEditorPrefsPanel::applyPreferences()
 	map_remove_invalid_lines         = cb_remove_invalid_lines_->GetValue();
 	map_merge_lines_on_delete_vertex = cb_merge_lines_vertex_delete_->GetValue();
 	map_split_auto_offset            = cb_split_auto_offset_->GetValue();
+	map_optimise_order_on_save       = cb_optimise_order_on_save_->GetValue();
 	max_map_backups                  = text_max_backups_->number();
 }
@@ -25,6 +25,7 @@ private:
 	wxCheckBox*     cb_remove_invalid_lines_      = nullptr;
 	wxCheckBox*     cb_merge_lines_vertex_delete_ = nullptr;
 	wxCheckBox*     cb_split_auto_offset_         = nullptr;
+	wxCheckBox*     cb_optimise_order_on_save_    = nullptr;
 	NumberTextCtrl* text_max_backups_             = nullptr;
 };
 } // namespace slade
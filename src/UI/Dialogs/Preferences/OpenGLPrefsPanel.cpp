@@ -45,6 +45,7 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 EXTERN_CVAR(Bool, gl_point_sprite)
 EXTERN_CVAR(Bool, gl_vbo)
+EXTERN_CVAR(Bool, gl_shaders)
 EXTERN_CVAR(Int, gl_font_size)
 
 
@@ -68,11 +69,14 @@ OpenGLPrefsPanel::OpenGLPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent), l
 		sizer,
 		vector<wxObject*>{ cb_gl_point_sprite_ = new wxCheckBox(this, -1, "Enable point sprites if supported"),
 						   cb_gl_use_vbo_      = new wxCheckBox(this, -1, "Use Vertex Buffer Objects if supported"),
+						   cb_gl_use_shaders_  = new wxCheckBox(this, -1, "Use OpenGL 3.3 shaders if supported"),
 						   wxutil::createLabelHBox(this, "Font Size:", ntc_font_size_ = new NumberTextCtrl(this)) },
 		wxSizerFlags(0).Expand());
 
 	cb_gl_point_sprite_->SetToolTip(
 		"Only disable this if you are experiencing graphical glitches like things disappearing");
+	cb_gl_use_shaders_->SetToolTip(
+		"Renders the 2d map view with GLSL shader programs and batched geometry (requires Vertex Buffer Objects)");
 	ntc_font_size_->SetToolTip("The size of the font to use in OpenGL, eg. for info overlays in the map editor");
 }
 
@@ -83,6 +87,7 @@ void OpenGLPrefsPanel::init()
 {
 	cb_gl_point_sprite_->SetValue(gl_point_sprite);
 	cb_gl_use_vbo_->SetValue(gl_vbo);
+	cb_gl_use_shaders_->SetValue(gl_shaders);
 	ntc_font_size_->setNumber(gl_font_size);
 }
 
@@ -93,6 +98,7 @@ void OpenGLPrefsPanel::applyPreferences()
 {
 	gl_point_sprite = cb_gl_point_sprite_->GetValue();
 	gl_vbo          = cb_gl_use_vbo_->GetValue();
+	gl_shaders      = cb_gl_use_shaders_->GetValue();
 	gl_font_size    = ntc_font_size_->number();
 
 	if (gl_font_size != last_font_size_)
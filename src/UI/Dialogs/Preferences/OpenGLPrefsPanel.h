@@ -18,6 +18,7 @@ public:
 private:
 	wxCheckBox*     cb_gl_point_sprite_ = nullptr;
 	wxCheckBox*     cb_gl_use_vbo_      = nullptr;
+	wxCheckBox*     cb_gl_use_shaders_  = nullptr;
 	NumberTextCtrl* ntc_font_size_      = nullptr;
 	int             last_font_size_     = 0;
 };
@@ -45,6 +45,7 @@ using namespace slade;
 EXTERN_CVAR(String, path_pngout)
 EXTERN_CVAR(String, path_pngcrush)
 EXTERN_CVAR(String, path_deflopt)
+EXTERN_CVAR(Bool, png_opt_external)
 CVAR(String, dir_last_pngtool, "", CVar::Flag::Save)
 
 
@@ -95,7 +96,9 @@ PNGPrefsPanel::PNGPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent)
 								   true,
 								   "Browse for DeflOpt Executable",
 								   filedialog::executableExtensionString(),
-								   filedialog::executableFileName("deflopt"))) },
+								   filedialog::executableFileName("deflopt"))),
+						   cb_external_ = new wxCheckBox(
+							   this, -1, "Always run these after the built-in optimizer (much slower)") },
 		wxSizerFlags(0).Expand());
 }
 
@@ -107,6 +110,7 @@ void PNGPrefsPanel::init()
 	flp_pngout_->setLocation(path_pngout);
 	flp_pngcrush_->setLocation(path_pngcrush);
 	flp_deflopt_->setLocation(path_deflopt);
+	cb_external_->SetValue(png_opt_external);
 }
 
 // -----------------------------------------------------------------------------
@@ -114,7 +118,8 @@ void PNGPrefsPanel::init()
 // -----------------------------------------------------------------------------
 void PNGPrefsPanel::applyPreferences()
 {
-	path_pngout   = wxutil::strToView(flp_pngout_->location());
-	path_pngcrush = wxutil::strToView(flp_pngcrush_->location());
-	path_deflopt  = wxutil::strToView(flp_deflopt_->location());
+	path_pngout      = wxutil::strToView(flp_pngout_->location());
+	path_pngcrush    = wxutil::strToView(flp_pngcrush_->location());
+	path_deflopt     = wxutil::strToView(flp_deflopt_->location());
+	png_opt_external = cb_external_->GetValue();
 }
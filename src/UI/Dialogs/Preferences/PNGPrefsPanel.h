@@ -21,5 +21,6 @@ private:
 	FileLocationPanel* flp_pngout_   = nullptr;
 	FileLocationPanel* flp_pngcrush_ = nullptr;
 	FileLocationPanel* flp_deflopt_  = nullptr;
+	wxCheckBox*        cb_external_  = nullptr;
 };
 } // namespace slade
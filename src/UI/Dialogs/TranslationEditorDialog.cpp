@@ -36,6 +36,7 @@
 #include "Archive/ArchiveManager.h"
 #include "General/UI.h"
 #include "Graphics/SImage/SImage.h"
+#include "OpenGL/GLTexture.h"
 #include "UI/Canvas/GfxCanvas.h"
 #include "UI/Canvas/PaletteCanvas.h"
 #include "UI/Controls/SIconButton.h"
@@ -795,12 +796,7 @@ void TranslationEditorDialog::updatePreviews()
 	pal_canvas_preview_->Refresh();
 
 	// Update image preview
-	gfx_preview_->image().copyImage(&image_preview_);
-	gfx_preview_->image().applyTranslation(&translation_, &palette_, cb_truecolor_->GetValue());
-
-	// Update UI
-	gfx_preview_->updateImageTexture();
-	gfx_preview_->Refresh();
+	updateImagePreview();
 
 	// Update text string
 	if (cb_paletteonly_->GetValue())
@@ -825,6 +821,52 @@ void TranslationEditorDialog::updatePreviews()
 		text_string_->SetValue(translation_.asText());
 }
 
+// -----------------------------------------------------------------------------
+// Updates the image preview with the current translation.
+// Paletted images are left untranslated and drawn with the translation
+// compiled to a 256 colour lookup table as the canvas palette, so only the
+// palette texture needs re-uploading when the translation changes. Otherwise
+// the translation is applied to a copy of the image
+// -----------------------------------------------------------------------------
+void TranslationEditorDialog::updateImagePreview()
+{
+	auto& image = gfx_preview_->image();
+
+	if (image_preview_.type() == SImage::Type::PalMask && gl::Texture::indexedSupport())
+	{
+		// Restore the untranslated image if needed
+		if (!preview_untranslated_)
+		{
+			image.copyImage(&image_preview_);
+			preview_untranslated_ = true;
+		}
+
+		// Build lookup palette (truecolor uses the translated colours directly,
+		// otherwise each index maps to the colour of its translated index)
+		const auto& table     = translation_.compile(&palette_);
+		auto        truecolor = cb_truecolor_->GetValue();
+		Palette     lookup;
+		for (int i = 0; i < 256; ++i)
+			lookup.setColour(i, truecolor ? table.colour[i] : palette_.colour(table.index[i]));
+
+		// The image's own palette is used over the canvas palette if it has one
+		if (image.hasPalette())
+			image.palette()->copyPalette(&lookup);
+		gfx_preview_->setPalette(&lookup);
+		gfx_preview_->Refresh();
+		return;
+	}
+
+	// Apply the translation to a copy of the image
+	image.copyImage(&image_preview_);
+	image.applyTranslation(&translation_, &palette_, cb_truecolor_->GetValue());
+	preview_untranslated_ = false;
+
+	// Update UI
+	gfx_preview_->updateImageTexture();
+	gfx_preview_->Refresh();
+}
+
 // -----------------------------------------------------------------------------
 // Returns whether the truecolor checkbox is checked
 // -----------------------------------------------------------------------------
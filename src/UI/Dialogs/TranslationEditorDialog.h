@@ -61,6 +61,7 @@ private:
 	Palette     palette_;
 	Translation translation_;
 	SImage      image_preview_;
+	bool        preview_untranslated_ = true; // Preview canvas image is an untranslated copy of image_preview_
 
 	PaletteCanvas* pal_canvas_original_ = nullptr;
 	wxListBox*     list_translations_   = nullptr;
@@ -104,6 +105,8 @@ private:
 	wxCheckBox* cb_paletteonly_ = nullptr;
 
 
+	void updateImagePreview();
+
 	// Events
 	void onSize(wxSizeEvent& e);
 	void onTranslationListItemSelected(wxCommandEvent& e);
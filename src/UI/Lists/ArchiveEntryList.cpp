@@ -258,12 +258,45 @@ void ArchiveEntryList::setArchive(const shared_ptr<Archive>& archive)
 {
 	// Set archive (allow null)
 	archive_ = archive;
+	signal_connections_.connections.clear();
+	filter_applied_dir_ = nullptr;
 
 	// Init new archive if given
 	if (archive)
 	{
-		// Update list when archive is modified
-		sc_archive_modified_ = archive->signals().modified.connect([this](Archive&, bool) { updateEntries(); });
+		// Update list items when entries/dirs in the archive change
+		auto& signals = archive->signals();
+		signal_connections_ += signals.entry_added.connect(
+			[this](Archive&, ArchiveEntry& entry) { entryAdded(entry); });
+		signal_connections_ += signals.entry_state_changed.connect(
+			[this](Archive&, ArchiveEntry& entry) { entryChanged(entry); });
+		signal_connections_ += signals.entry_removed.connect(
+			[this](Archive&, ArchiveDir& dir, ArchiveEntry&) { dirChanged(dir); });
+		signal_connections_ += signals.entry_renamed.connect(
+			[this](Archive&, ArchiveEntry& entry, string_view)
+			{
+				if (entry.parentDir())
+					dirChanged(*entry.parentDir());
+			});
+		signal_connections_ += signals.entries_swapped.connect(
+			[this](Archive&, ArchiveDir& dir, unsigned, unsigned) { dirChanged(dir); });
+		signal_connections_ += signals.dir_added.connect(
+			[this](Archive&, ArchiveDir& dir)
+			{
+				if (auto parent = dir.parent())
+					dirChanged(*parent);
+			});
+		signal_connections_ += signals.dir_removed.connect(
+			[this](Archive&, ArchiveDir& parent, ArchiveDir&) { dirChanged(parent); });
+		signal_connections_ += signals.entries_changed.connect(
+			[this](Archive&, const Archive::EntryChanges& changes)
+			{
+				if (!changes.added.empty() || !changes.removed.empty())
+					updateEntries();
+				else
+					for (const auto& entry : changes.state_changed)
+						entryChanged(*entry);
+			});
 
 		// Open root directory
 		current_dir_ = archive->rootDir();
@@ -400,7 +433,10 @@ void ArchiveEntryList::filterList(const wxString& filter, const wxString& catego
 }
 
 // -----------------------------------------------------------------------------
-// Applies the current filter(s) to the list
+// Applies the current filter(s) to the list.
+// If the name filter was only narrowed since it was last applied (and the
+// current directory hasn't changed), only the items currently in the list need
+// checking, and they don't need resorting
 // -----------------------------------------------------------------------------
 void ArchiveEntryList::applyFilter()
 {
@@ -408,46 +444,13 @@ void ArchiveEntryList::applyFilter()
 	if (!dir)
 		return;
 
-	// Clear current filter list
-	items_.clear();
-
-	// Check if any filters were given
-	if (filter_text_.IsEmpty() && filter_category_.IsEmpty())
-	{
-		// No filter, just refresh the list
-		unsigned count = dir->numEntries() + dir->numSubdirs();
-		for (unsigned a = 0; a < count; a++)
-			items_.push_back(a);
-		updateList();
-
-		return;
-	}
-
-	// Filter by category
-	unsigned index = 0;
-	auto     entry = entryAt(index, false);
-	while (entry)
-	{
-		if (filter_category_.IsEmpty() || entry->type() == EntryType::folderType())
-			items_.push_back(index); // If no category specified, just add all entries to the filter
-		else
-		{
-			// Check for category match
-			if (strutil::equalCI(entry->type()->category(), filter_category_.ToStdString()))
-				items_.push_back(index);
-		}
-
-		entry = entryAt(++index, false);
-	}
-
-	// Now filter by name if needed
+	// Process name filter terms (split by ,)
+	auto prev_terms = std::move(filter_terms_);
+	filter_terms_.clear();
 	if (!filter_text_.IsEmpty())
 	{
-		// Split filter by ,
-		auto terms = strutil::split(filter_text_.ToStdString(), ',');
-
-		// Process filter strings
-		for (auto& term : terms)
+		filter_terms_ = strutil::split(filter_text_.ToStdString(), ',');
+		for (auto& term : filter_terms_)
 		{
 			// Remove spaces
 			strutil::replaceIP(term, " ", "");
@@ -459,35 +462,48 @@ void ArchiveEntryList::applyFilter()
 				term += "*";
 			}
 		}
+	}
 
-		// Go through filtered list
-		for (unsigned a = 0; a < items_.size(); a++)
+	// Check if the filter was narrowed, ie. each term only matches names
+	// that the previous term in its place matches
+	auto category = filter_category_.ToStdString();
+	bool narrowed = dir.get() == filter_applied_dir_ && category == filter_applied_category_;
+	if (narrowed && !prev_terms.empty())
+	{
+		narrowed = filter_terms_.size() == prev_terms.size();
+		for (unsigned a = 0; narrowed && a < filter_terms_.size(); a++)
 		{
-			entry = entryAt(items_[a], false);
+			const auto& prev = prev_terms[a];
+			if (prev.empty() || prev.back() != '*')
+				narrowed = filter_terms_[a] == prev;
+			else
+				narrowed = strutil::startsWith(filter_terms_[a], string_view{ prev }.substr(0, prev.size() - 1));
+		}
+	}
 
-			// Don't filter folders if !elist_filter_dirs
-			if (!elist_filter_dirs && entry->type() == EntryType::folderType())
-				continue;
+	filter_applied_dir_      = dir.get();
+	filter_applied_category_ = category;
 
-			// Check for name match with filter
-			bool match = false;
-			for (const auto& term : terms)
-			{
-				if (entry == entry_dir_back_.get() || strutil::matches(entry->upperName(), term))
-				{
-					match = true;
-					continue;
-				}
-			}
-			if (match)
-				continue;
+	// Narrowed, remove any current items that no longer match
+	if (narrowed)
+	{
+		items_.erase(
+			std::remove_if(
+				items_.begin(), items_.end(), [this](long item) { return !matchesFilter(*entryAt(item, false)); }),
+			items_.end());
 
-			// No match, remove from filtered list
-			items_.erase(items_.begin() + a);
-			a--;
-		}
+		SetItemCount(items_.size());
+		Refresh();
+		return;
 	}
 
+	// Otherwise rebuild the list from all items in the dir
+	items_.clear();
+	unsigned count = dir->numEntries() + dir->numSubdirs() + (show_dir_back_ && dir->parent() ? 1 : 0);
+	for (unsigned a = 0; a < count; a++)
+		if (matchesFilter(*entryAt(a, false)))
+			items_.push_back(a);
+
 	// Update the list
 	updateList();
 }
@@ -517,8 +533,13 @@ bool ArchiveEntryList::setDir(const shared_ptr<ArchiveDir>& dir)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Rebuilds the list items from the current directory (if auto updating is
+// enabled)
+// -----------------------------------------------------------------------------
 void ArchiveEntryList::updateEntries()
 {
+	filter_applied_dir_ = nullptr;
 	if (entries_update_)
 		applyFilter();
 }
@@ -554,35 +575,163 @@ int ArchiveEntryList::entrySize(long index) const
 void ArchiveEntryList::sortItems()
 {
 	lv_current_ = this;
+
+	// Get sort keys for all items first, rather than for every comparison
+	vector<SortKey> keys;
+	keys.reserve(items_.size());
+	for (auto item : items_)
+		keys.push_back(sortKey(item));
+
 	std::sort(
-		items_.begin(),
-		items_.end(),
-		[&](long left, long right)
+		keys.begin(),
+		keys.end(),
+		[this](const SortKey& left, const SortKey& right) { return sortsBefore(left, right); });
+
+	for (unsigned a = 0; a < keys.size(); a++)
+		items_[a] = keys[a].item;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [entry] matches the current filter(s)
+// -----------------------------------------------------------------------------
+bool ArchiveEntryList::matchesFilter(const ArchiveEntry& entry) const
+{
+	// Always show the 'up folder' entry
+	if (&entry == entry_dir_back_.get())
+		return true;
+
+	// Check for category match (folders have no category)
+	bool folder = entry.type() == EntryType::folderType();
+	if (!folder && !filter_applied_category_.empty()
+		&& !strutil::equalCI(entry.type()->category(), filter_applied_category_))
+		return false;
+
+	// Don't filter folders by name if !elist_filter_dirs
+	if (filter_terms_.empty() || (folder && !elist_filter_dirs))
+		return true;
+
+	// Check for name match with filter
+	for (const auto& term : filter_terms_)
+		if (strutil::matches(entry.upperName(), term))
+			return true;
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the sort key for [item] (unfiltered index), depending on the current
+// sorting column
+// -----------------------------------------------------------------------------
+ArchiveEntryList::SortKey ArchiveEntryList::sortKey(long item) const
+{
+	SortKey key;
+	auto*   entry = entryAt(item, false);
+	key.item      = item;
+	key.folder    = entry->type() == EntryType::folderType();
+
+	auto column = sortColumn();
+	if (column < 0 || column == col_index_)
+		key.number = item;
+	else if (column == col_name_)
+		key.text = entry->upperName();
+	else if (column == col_size_)
+		key.number = entrySize(item);
+	else
+		key.text = itemText(item, column, item).Lower().ToStdString();
+
+	return key;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the item with sort key [left] should be before the item
+// with sort key [right] in the list
+// -----------------------------------------------------------------------------
+bool ArchiveEntryList::sortsBefore(const SortKey& left, const SortKey& right) const
+{
+	// Sort folder->entry first
+	if (left.folder != right.folder)
+		return left.folder;
+
+	// Compare by text (name/other column) or number (size/index)
+	int  result;
+	auto column = sortColumn();
+	if (column >= 0 && column != col_index_ && column != col_size_)
+		result = left.text.compare(right.text);
+	else
+		result = left.number < right.number ? -1 : (left.number > right.number ? 1 : 0);
+
+	// Equal, keep in index order
+	if (result == 0)
+		return left.item < right.item;
+
+	return sort_descend_ ? result > 0 : result < 0;
+}
+
+// -----------------------------------------------------------------------------
+// Called when [entry] is added to the archive. If it was added to the current
+// directory, the following list items are shifted down and the new item is
+// inserted at its sorted position (if it matches the filter)
+// -----------------------------------------------------------------------------
+void ArchiveEntryList::entryAdded(ArchiveEntry& entry)
+{
+	auto dir = current_dir_.lock();
+	if (!dir || entry.parentDir() != dir.get())
+		return;
+
+	if (!entries_update_ || filter_applied_dir_ != dir.get())
+	{
+		updateEntries();
+		return;
+	}
+
+	// Shift following items
+	long index = entriesBegin() + entry.index();
+	for (auto& item : items_)
+		if (item >= index)
+			++item;
+
+	// Insert new item
+	if (matchesFilter(entry))
+	{
+		auto key = sortKey(index);
+		auto pos = std::upper_bound(
+			items_.begin(),
+			items_.end(),
+			key,
+			[this](const SortKey& key, long item) { return sortsBefore(key, sortKey(item)); });
+		items_.insert(pos, index);
+	}
+
+	SetItemCount(items_.size());
+	Refresh();
+}
+
+// -----------------------------------------------------------------------------
+// Called when [entry]'s state changes, refreshes its list item only
+// -----------------------------------------------------------------------------
+void ArchiveEntryList::entryChanged(ArchiveEntry& entry)
+{
+	auto dir = current_dir_.lock();
+	if (!dir || entry.parentDir() != dir.get())
+		return;
+
+	long index = entriesBegin() + entry.index();
+	for (unsigned a = 0; a < items_.size(); a++)
+		if (items_[a] == index)
 		{
-			auto le = entryAt(left, false);
-			auto re = entryAt(right, false);
-
-			// Sort folder->entry first
-			if (le->type() == EntryType::folderType() && re->type() != EntryType::folderType())
-				return true;
-			if (re->type() == EntryType::folderType() && le->type() != EntryType::folderType())
-				return false;
-
-			// Name sort
-			if (col_name_ >= 0 && col_name_ == sortColumn())
-				return sort_descend_ ? le->upperName() > re->upperName() : le->upperName() < re->upperName();
-
-			// Size sort
-			if (col_size_ >= 0 && col_size_ == sortColumn())
-				return sort_descend_ ? entrySize(left) > entrySize(right) : entrySize(left) < entrySize(right);
-
-			// Index sort
-			if (col_index_ >= 0 && col_index_ == sortColumn())
-				return sort_descend_ ? left > right : left < right;
-
-			// Other (default) sort
-			return VirtualListView::defaultSort(left, right);
-		});
+			RefreshItem(a);
+			return;
+		}
+}
+
+// -----------------------------------------------------------------------------
+// Called when entries or subdirs in [dir] were removed, renamed or reordered,
+// rebuilds the list if [dir] is the current directory
+// -----------------------------------------------------------------------------
+void ArchiveEntryList::dirChanged(const ArchiveDir& dir)
+{
+	if (current_dir_.lock().get() == &dir)
+		updateEntries();
 }
 
 // -----------------------------------------------------------------------------
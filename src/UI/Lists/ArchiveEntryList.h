@@ -2,6 +2,7 @@
 
 #include "Archive/Archive.h"
 #include "General/SAction.h"
+#include "General/Sigslot.h"
 #include "VirtualListView.h"
 
 wxDECLARE_EVENT(EVT_AEL_DIR_CHANGED, wxCommandEvent);
@@ -65,8 +66,20 @@ protected:
 	void     updateItemAttr(long item, long column, long index) const override;
 
 private:
+	// Precomputed sort key for a list item (see sortKey)
+	struct SortKey
+	{
+		long   item   = 0;
+		bool   folder = false;
+		long   number = 0; // Size or list index, depending on the sort column
+		string text;       // Name or column text, depending on the sort column
+	};
+
 	weak_ptr<Archive>        archive_;
 	wxString                 filter_category_;
+	vector<string>           filter_terms_; // Processed name filter terms
+	string                   filter_applied_category_;
+	ArchiveDir*              filter_applied_dir_ = nullptr; // Dir the current (filtered) items are from
 	weak_ptr<ArchiveDir>     current_dir_;
 	unique_ptr<ArchiveEntry> entry_dir_back_;
 	bool                     show_dir_back_  = false;
@@ -78,8 +91,14 @@ private:
 	bool                     entries_update_ = true;
 
 	// Signal connections
-	sigslot::scoped_connection sc_archive_modified_;
-
-	int entrySize(long index) const;
+	ScopedConnectionList signal_connections_;
+
+	int     entrySize(long index) const;
+	bool    matchesFilter(const ArchiveEntry& entry) const;
+	SortKey sortKey(long item) const;
+	bool    sortsBefore(const SortKey& left, const SortKey& right) const;
+	void    entryAdded(ArchiveEntry& entry);
+	void    entryChanged(ArchiveEntry& entry);
+	void    dirChanged(const ArchiveDir& dir);
 };
 } // namespace slade
@@ -167,13 +167,15 @@ void ArchivePathPanel::setCurrentPath(const ArchiveDir* dir) const
 // -----------------------------------------------------------------------------
 void ArchiveViewModel::openArchive(shared_ptr<Archive> archive, UndoManager* undo_manager, bool force_list)
 {
-	archive_      = archive;
-	root_dir_     = archive->rootDir();
-	undo_manager_ = undo_manager;
-	view_type_    = archive->formatDesc().supports_dirs && !force_list ? ViewType::Tree : ViewType::List;
+	archive_           = archive;
+	root_dir_          = archive->rootDir();
+	undo_manager_      = undo_manager;
+	view_type_         = archive->formatDesc().supports_dirs && !force_list ? ViewType::Tree : ViewType::List;
+	sort_default_name_ = archive->formatId() == "folder";
+	rows_.clear();
 
-	// Refresh (will load all items)
-	Cleared();
+	// Refresh (will load root items)
+	resetItems();
 
 
 	// --- Connect to Archive/ArchiveManager signals ---
@@ -182,72 +184,93 @@ void ArchiveViewModel::openArchive(shared_ptr<Archive> archive, UndoManager* und
 	connections_ += archive->signals().entry_added.connect(
 		[this](Archive& archive, ArchiveEntry& entry)
 		{
-			if (entryIsInList(entry))
-			{
-				if (view_type_ == ViewType::Tree)
-					ItemAdded(createItemForDirectory(*entry.parentDir()), wxDataViewItem(&entry));
-				else
-					ItemAdded({}, wxDataViewItem(&entry));
-			}
+			if (auto* dir = entry.parentDir())
+				addItems(*dir, { &entry });
 		});
 
 	// Entry removed
 	connections_ += archive->signals().entry_removed.connect(
-		[this](Archive& archive, ArchiveDir& dir, ArchiveEntry& entry)
-		{
-			if (view_type_ == ViewType::Tree)
-				ItemDeleted(createItemForDirectory(dir), wxDataViewItem(&entry));
-			else if (root_dir_.lock().get() == &dir)
-				ItemDeleted({}, wxDataViewItem(&entry));
-		});
+		[this](Archive& archive, ArchiveDir& dir, ArchiveEntry& entry) { removeItems(dir, { &entry }); });
 
 	// Entry modified
 	connections_ += archive->signals().entry_state_changed.connect(
 		[this](Archive& archive, ArchiveEntry& entry)
 		{
-			if (entryIsInList(entry))
+			if (isShown(entry))
 				ItemChanged(wxDataViewItem(&entry));
 		});
 
+	// Batch of entry changes
+	connections_ += archive->signals().entries_changed.connect(
+		[this](Archive& archive, const Archive::EntryChanges& changes)
+		{
+			// Group added/removed entries by parent dir, so each group can be
+			// added/removed from the model at once
+			vector<std::pair<ArchiveDir*, vector<ArchiveEntry*>>> groups;
+			std::map<ArchiveDir*, size_t>                         group_index;
+			auto add_to_group = [&](ArchiveDir* dir, ArchiveEntry* entry)
+			{
+				auto [it, added] = group_index.try_emplace(dir, groups.size());
+				if (added)
+					groups.emplace_back(dir, vector<ArchiveEntry*>{});
+				groups[it->second].second.push_back(entry);
+			};
+
+			// Removed
+			for (const auto& removed : changes.removed)
+				if (removed.dir)
+					add_to_group(removed.dir.get(), removed.entry.get());
+			for (const auto& [dir, entries] : groups)
+				removeItems(*dir, entries);
+
+			// Added
+			groups.clear();
+			group_index.clear();
+			for (const auto& entry : changes.added)
+				if (entry->parentDir())
+					add_to_group(entry->parentDir(), entry.get());
+			for (const auto& [dir, entries] : groups)
+				addItems(*dir, entries);
+
+			// Modified
+			wxDataViewItemArray changed;
+			for (const auto& entry : changes.state_changed)
+				if (isShown(*entry))
+					changed.push_back(wxDataViewItem{ entry.get() });
+			if (!changed.empty())
+				ItemsChanged(changed);
+		});
+
 	// Dir added
 	connections_ += archive->signals().dir_added.connect(
 		[this](Archive& archive, ArchiveDir& dir)
 		{
-			if (dirIsInList(dir))
-			{
-				if (view_type_ == ViewType::Tree)
-					ItemAdded(createItemForDirectory(*dir.parent()), wxDataViewItem(dir.dirEntry()));
-				else
-					ItemAdded({}, wxDataViewItem(dir.dirEntry()));
-			}
+			if (auto parent = dir.parent())
+				addItems(*parent, { dir.dirEntry() });
 		});
 
 	// Dir removed
 	connections_ += archive->signals().dir_removed.connect(
 		[this](Archive& archive, ArchiveDir& parent, ArchiveDir& dir)
 		{
-			if (view_type_ == ViewType::Tree)
-				ItemDeleted(createItemForDirectory(parent), wxDataViewItem(dir.dirEntry()));
-			else if (root_dir_.lock().get() == &parent)
-				ItemDeleted({}, wxDataViewItem(dir.dirEntry()));
+			removeItems(parent, { dir.dirEntry() });
+			fetched_dirs_.erase(&dir);
 		});
 
 	// Entries reordered within dir
 	connections_ += archive->signals().entries_swapped.connect(
 		[this](Archive& archive, ArchiveDir& dir, unsigned index1, unsigned index2)
 		{
-			if (view_type_ == ViewType::List && root_dir_.lock().get() != &dir)
-				return;
-
-			ItemChanged(wxDataViewItem(dir.entryAt(index1)));
-			ItemChanged(wxDataViewItem(dir.entryAt(index2)));
+			for (auto* entry : { dir.entryAt(index1), dir.entryAt(index2) })
+				if (entry && isShown(*entry))
+					ItemChanged(wxDataViewItem(entry));
 		});
 
 	// Bookmark added
 	connections_ += app::archiveManager().signals().bookmark_added.connect(
 		[this](ArchiveEntry* entry)
 		{
-			if (entryIsInList(*entry))
+			if (isShown(*entry))
 				ItemChanged(wxDataViewItem(entry));
 		});
 
@@ -257,9 +280,10 @@ void ArchiveViewModel::openArchive(shared_ptr<Archive> archive, UndoManager* und
 		{
 			wxDataViewItemArray items;
 			for (auto* entry : removed)
-				if (entry && entryIsInList(*entry))
+				if (entry && isShown(*entry))
 					items.push_back(wxDataViewItem{ entry });
-			ItemsChanged(items);
+			if (!items.empty())
+				ItemsChanged(items);
 		});
 }
 
@@ -269,13 +293,14 @@ void ArchiveViewModel::openArchive(shared_ptr<Archive> archive, UndoManager* und
 void ArchiveViewModel::setFilter(string_view name, string_view category)
 {
 	// Check any change is required
-	if (name.empty() && filter_name_.empty() && filter_category_ == category)
+	if (name.empty() && filter_name_.empty() && filter_prefix_.empty() && filter_category_ == category)
 		return;
 
 	filter_category_ = category;
 
 	// Process filter string
 	filter_name_.clear();
+	filter_prefix_.clear();
 	if (!name.empty())
 	{
 		auto filter_parts = strutil::splitV(name, ',');
@@ -285,14 +310,56 @@ void ArchiveViewModel::setFilter(string_view name, string_view category)
 			if (filter_part.empty())
 				continue;
 
+			// Terms without wildcards only need a (much cheaper) prefix check
 			strutil::upperIP(filter_part);
-			filter_part += '*';
-			filter_name_.push_back(filter_part);
+			if (filter_part.find_first_of("*?") == string::npos)
+				filter_prefix_.push_back(filter_part);
+			else
+				filter_name_.push_back(filter_part + '*');
 		}
 	}
 
-	// Fully refresh the list
-	Cleared();
+	// Find which items in fetched directories need to be added or removed
+	vector<std::tuple<ArchiveDir*, vector<ArchiveEntry*>, vector<ArchiveEntry*>>> changes;
+	size_t                                                                        n_changes = 0;
+	for (auto i = fetched_dirs_.begin(); i != fetched_dirs_.end();)
+	{
+		auto dir = i->second.lock();
+		if (!dir || dir.get() != i->first)
+		{
+			i = fetched_dirs_.erase(i);
+			continue;
+		}
+
+		wxDataViewItemArray    items;
+		vector<ArchiveEntry*> removed, added;
+		getDirChildItems(items, *dir, false);
+		for (const auto& item : items)
+		{
+			auto* entry = static_cast<ArchiveEntry*>(item.GetID());
+			auto  show  = itemMatchesFilter(*entry);
+			if (show != isShown(*entry))
+				(show ? added : removed).push_back(entry);
+		}
+
+		n_changes += removed.size() + added.size();
+		if (!removed.empty() || !added.empty())
+			changes.emplace_back(dir.get(), std::move(removed), std::move(added));
+		++i;
+	}
+
+	// Fully refresh the list if most of it is changing anyway
+	if (n_changes > shown_items_.size() / 2)
+	{
+		resetItems();
+		return;
+	}
+
+	for (const auto& [dir, removed, added] : changes)
+	{
+		removeItems(*dir, removed);
+		addItems(*dir, added);
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -310,7 +377,7 @@ void ArchiveViewModel::setRootDir(shared_ptr<ArchiveDir> dir)
 
 	// Change root dir and refresh
 	root_dir_ = dir;
-	Cleared();
+	resetItems();
 
 	if (path_panel_)
 		path_panel_->setCurrentPath(dir.get());
@@ -369,30 +436,12 @@ void ArchiveViewModel::GetValue(wxVariant& variant, const wxDataViewItem& item,
 	// Name column
 	if (col == 0)
 	{
-		// Find icon in cache
-		if (icon_cache.find(entry->type()->icon()) == icon_cache.end())
-		{
-			// Not found, add to cache
-			const auto pad = Point2i{ 1, elist_icon_padding };
-
-#if wxCHECK_VERSION(3, 1, 6)
-			const auto bundle = icons::getIcon(icons::Type::Entry, entry->type()->icon(), elist_icon_size, pad);
-			icon_cache[entry->type()->icon()] = bundle;
-#else
-			const auto size = scalePx(elist_icon_size);
-			const auto bmp  = icons::getIcon(icons::Type::Entry, entry->type()->icon(), size, pad);
-
-			wxIcon icon;
-			icon.CopyFromBitmap(bmp);
-			icon_cache[entry->type()->icon()] = icon;
-#endif
-		}
-
-		wxString name = entry->name();
+		auto value = rowInfo(*entry).icon;
 		if (modified_indicator_ && entry->state() != ArchiveEntry::State::Unmodified)
-			variant << wxDataViewIconText(entry->name() + " *", icon_cache[entry->type()->icon()]);
+			value.SetText(entry->name() + " *");
 		else
-			variant << wxDataViewIconText(entry->name(), icon_cache[entry->type()->icon()]);
+			value.SetText(entry->name());
+		variant << value;
 	}
 
 	// Size column
@@ -402,7 +451,7 @@ void ArchiveViewModel::GetValue(wxVariant& variant, const wxDataViewItem& item,
 		{
 			if (view_type_ == ViewType::List)
 			{
-				if (auto dir = ArchiveDir::findDirByDirEntry(root_dir_.lock(), *entry))
+				if (auto* dir = dirForDirItem(item))
 					variant = fmt::format("{}", dir->numEntries(true));
 				else
 					variant = "";
@@ -411,12 +460,12 @@ void ArchiveViewModel::GetValue(wxVariant& variant, const wxDataViewItem& item,
 				variant = "";
 		}
 		else
-			variant = entry->sizeString();
+			variant = rowInfo(*entry).size_string;
 	}
 
 	// Type column
 	else if (col == 2)
-		variant = entry->type() == EntryType::folderType() ? "Folder" : entry->typeString();
+		variant = rowInfo(*entry).type_string;
 
 	// Index column
 	else if (col == 3)
@@ -542,9 +591,8 @@ bool ArchiveViewModel::SetValue(const wxVariant& variant, const wxDataViewItem&
 				undo_manager_->beginRecord("Rename Directory");
 
 			// Rename the entry
-			const auto dir = ArchiveDir::findDirByDirEntry(archive->rootDir(), *entry);
-			if (dir)
-				ok = archive->renameDir(dir.get(), wxutil::strToView(new_name));
+			if (auto* dir = dirForDirItem(item))
+				ok = archive->renameDir(dir, wxutil::strToView(new_name));
 			else
 				ok = false;
 		}
@@ -609,11 +657,10 @@ bool ArchiveViewModel::IsContainer(const wxDataViewItem& item) const
 
 #ifdef __WXMSW__
 		// Empty folder
-		else if (auto* archive = archive_.lock().get())
+		else if (auto* dir = dirForDirItem(item))
 		{
-			if (auto* dir = archive->dirAtPath(entry->path(true)))
-				if (dir->entries().empty() && dir->subdirs().empty())
-					return false;
+			if (dir->entries().empty() && dir->subdirs().empty())
+				return false;
 		}
 #endif
 	}
@@ -632,24 +679,30 @@ unsigned int ArchiveViewModel::GetChildren(const wxDataViewItem& item, wxDataVie
 		return 0;
 
 	// Check if the item is a directory
-	ArchiveDir* dir;
+	shared_ptr<ArchiveDir> dir;
 	if (auto* entry = static_cast<ArchiveEntry*>(item.GetID()))
 	{
 		if (entry->type() == EntryType::folderType())
-			dir = archive->dirAtPath(entry->path(true));
+			dir = ArchiveDir::getShared(dirForDirItem(item));
 		else
 			return 0; // Non-directory entry, no children
 	}
 	else
-		dir = root_dir_.lock().get(); // 'Invalid' item is the current root dir
+		dir = root_dir_.lock(); // 'Invalid' item is the current root dir
 
 	if (!dir)
 		return 0;
 
 	// Get items for directory subdirs + entries
+	auto first = children.size();
 	getDirChildItems(children, *dir);
 
-	return static_cast<unsigned int>(children.size());
+	// Keep track of the items given to the control
+	fetched_dirs_[dir.get()] = dir;
+	for (auto i = first; i < children.size(); ++i)
+		shown_items_[static_cast<ArchiveEntry*>(children[i].GetID())] = dir.get();
+
+	return static_cast<unsigned int>(children.size() - first);
 }
 
 // -----------------------------------------------------------------------------
@@ -727,7 +780,7 @@ int ArchiveViewModel::Compare(
 		else
 		{
 			// Directory archives default to alphabetical order
-			if (const auto archive = archive_.lock(); archive->formatId() == "folder")
+			if (sort_default_name_)
 				cmpval = e1->upperName().compare(e2->upperName());
 
 			// Everything else defaults to index order
@@ -761,8 +814,12 @@ wxDataViewItem ArchiveViewModel::createItemForDirectory(const ArchiveDir& dir) c
 bool ArchiveViewModel::matchesFilter(const ArchiveEntry& entry) const
 {
 	// Check for name match if needed
-	if (!filter_name_.empty())
+	if (!filter_name_.empty() || !filter_prefix_.empty())
 	{
+		for (const auto& f : filter_prefix_)
+			if (strutil::startsWith(entry.upperName(), f))
+				return true;
+
 		for (const auto& f : filter_name_)
 			if (strutil::matches(entry.upperName(), f))
 				return true;
@@ -778,6 +835,18 @@ bool ArchiveViewModel::matchesFilter(const ArchiveEntry& entry) const
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the item for [entry] (or directory entry) should be shown
+// with the current filter
+// -----------------------------------------------------------------------------
+bool ArchiveViewModel::itemMatchesFilter(const ArchiveEntry& entry) const
+{
+	if (entry.type() == EntryType::folderType() && !elist_filter_dirs)
+		return true;
+
+	return matchesFilter(entry);
+}
+
 // -----------------------------------------------------------------------------
 // Populates [items] with all child entries/subrirs of [dir].
 // If [filtered] is true, only adds children matching the current filter
@@ -787,7 +856,7 @@ void ArchiveViewModel::getDirChildItems(wxDataViewItemArray& items, const Archiv
 	if (filtered)
 	{
 		for (const auto& subdir : dir.subdirs())
-			if (!elist_filter_dirs || matchesFilter(*subdir->dirEntry()))
+			if (itemMatchesFilter(*subdir->dirEntry()))
 				items.push_back(wxDataViewItem{ subdir->dirEntry() });
 		for (const auto& entry : dir.entries())
 			if (matchesFilter(*entry))
@@ -803,36 +872,114 @@ void ArchiveViewModel::getDirChildItems(wxDataViewItemArray& items, const Archiv
 }
 
 // -----------------------------------------------------------------------------
-// Returns true if [entry] is contained within the current list (ignores filter)
+// Returns true if the control has requested the child items of [dir] (and the
+// dir is still valid)
 // -----------------------------------------------------------------------------
-bool ArchiveViewModel::entryIsInList(const ArchiveEntry& entry) const
+bool ArchiveViewModel::isFetched(const ArchiveDir& dir) const
 {
-	if (auto archive = archive_.lock())
+	auto i = fetched_dirs_.find(&dir);
+	if (i == fetched_dirs_.end())
+		return false;
+
+	// Remove if the dir it was for no longer exists
+	if (i->second.lock().get() != &dir)
 	{
-		// Check entry is in archive
-		if (entry.parent() != archive.get())
-			return false;
+		fetched_dirs_.erase(i);
+		return false;
+	}
 
-		// For list view, check if entry is in current dir
-		if (view_type_ == ViewType::List && entry.parentDir() != root_dir_.lock().get())
-			return false;
+	return true;
+}
 
-		return true;
+// -----------------------------------------------------------------------------
+// Notifies the control of [entries] added to [dir], if the control has fetched
+// the dir's children and they match the current filter
+// -----------------------------------------------------------------------------
+void ArchiveViewModel::addItems(const ArchiveDir& dir, const vector<ArchiveEntry*>& entries)
+{
+	if (!isFetched(dir))
+		return;
+
+	wxDataViewItemArray items;
+	for (auto* entry : entries)
+		if (itemMatchesFilter(*entry) && shown_items_.try_emplace(entry, &dir).second)
+			items.push_back(wxDataViewItem{ entry });
+
+	if (!items.empty())
+		ItemsAdded(createItemForDirectory(dir), items);
+}
+
+// -----------------------------------------------------------------------------
+// Notifies the control of [entries] removed from [dir], if they were shown
+// -----------------------------------------------------------------------------
+void ArchiveViewModel::removeItems(const ArchiveDir& dir, const vector<ArchiveEntry*>& entries)
+{
+	wxDataViewItemArray items;
+	for (auto* entry : entries)
+	{
+		rows_.erase(entry);
+		if (shown_items_.erase(entry) > 0)
+			items.push_back(wxDataViewItem{ entry });
 	}
 
-	return false;
+	if (!items.empty())
+		ItemsDeleted(createItemForDirectory(dir), items);
+}
+
+// -----------------------------------------------------------------------------
+// Fully refreshes the control's items
+// -----------------------------------------------------------------------------
+void ArchiveViewModel::resetItems()
+{
+	fetched_dirs_.clear();
+	shown_items_.clear();
+	Cleared();
 }
 
 // -----------------------------------------------------------------------------
-// Returns true if [dir] is contained within the current list (ignores filter)
+// Returns the (cached) display info for [entry]'s row
 // -----------------------------------------------------------------------------
-bool ArchiveViewModel::dirIsInList(const ArchiveDir& dir) const
+const ArchiveViewModel::RowInfo& ArchiveViewModel::rowInfo(const ArchiveEntry& entry) const
 {
-	switch (view_type_)
+	auto& row = rows_[&entry];
+	if (row.type && row.type == entry.type() && row.size == entry.size())
+		return row;
+
+	row.type = entry.type();
+	row.size = entry.size();
+	if (row.type == EntryType::folderType())
+	{
+		row.size_string = "";
+		row.type_string = "Folder";
+	}
+	else
 	{
-	case ViewType::List: return dir.parent() == root_dir_.lock();
-	default: return true;
+		row.size_string = entry.sizeString();
+		row.type_string = entry.typeString();
 	}
+
+	// Find icon in cache
+	const auto& icon_name = row.type->icon();
+	auto icon      = icon_cache.find(icon_name);
+	if (icon == icon_cache.end())
+	{
+		// Not found, add to cache
+		const auto pad = Point2i{ 1, elist_icon_padding };
+
+#if wxCHECK_VERSION(3, 1, 6)
+		icon = icon_cache.emplace(icon_name, icons::getIcon(icons::Type::Entry, icon_name, elist_icon_size, pad)).first;
+#else
+		const auto size = scalePx(elist_icon_size);
+		const auto bmp  = icons::getIcon(icons::Type::Entry, icon_name, size, pad);
+
+		wxIcon wx_icon;
+		wx_icon.CopyFromBitmap(bmp);
+		icon = icon_cache.emplace(icon_name, wx_icon).first;
+#endif
+	}
+	row.icon = wxDataViewIconText("", icon->second);
+
+	return row;
 }
 
 // -----------------------------------------------------------------------------
@@ -841,13 +988,22 @@ bool ArchiveViewModel::dirIsInList(const ArchiveDir& dir) const
 // -----------------------------------------------------------------------------
 ArchiveDir* ArchiveViewModel::dirForDirItem(const wxDataViewItem& item) const
 {
-	if (auto archive = archive_.lock())
+	auto archive = archive_.lock();
+	auto entry   = static_cast<ArchiveEntry*>(item.GetID());
+	if (!archive || !entry || entry->type() != EntryType::folderType())
+		return nullptr;
+
+	// Directory entries are in their parent dir, so only its subdirs need checking
+	if (auto* pdir = entry->parentDir())
 	{
-		auto* entry = static_cast<ArchiveEntry*>(item.GetID());
-		return ArchiveDir::findDirByDirEntry(archive_.lock()->rootDir(), *entry).get();
+		for (const auto& subdir : pdir->subdirs())
+			if (subdir->dirEntry() == entry)
+				return subdir.get();
+
+		return nullptr;
 	}
 
-	return nullptr;
+	return archive->rootDir()->dirEntry() == entry ? archive->rootDir().get() : nullptr;
 }
 
 
@@ -1188,12 +1344,9 @@ vector<ArchiveDir*> ArchiveEntryTree::selectedDirectories() const
 	GetSelections(selection);
 
 	// Add dirs from selected items
-	const auto dir_root = archive->rootDir();
 	for (const auto& item : selection)
-		if (auto* entry = static_cast<ArchiveEntry*>(item.GetID()))
-			if (entry->type() == EntryType::folderType())
-				if (auto dir = ArchiveDir::findDirByDirEntry(dir_root, *entry))
-					dirs.push_back(dir.get());
+		if (auto* dir = model_->dirForDirItem(item))
+			dirs.push_back(dir);
 
 	return dirs;
 }
@@ -1215,12 +1368,9 @@ ArchiveDir* ArchiveEntryTree::firstSelectedDirectory() const
 	GetSelections(selection);
 
 	// Find first directory in selected items
-	const auto dir_root = archive->rootDir();
 	for (const auto& item : selection)
-		if (auto* entry = static_cast<ArchiveEntry*>(item.GetID()))
-			if (entry->type() == EntryType::folderType())
-				if (const auto dir = ArchiveDir::findDirByDirEntry(dir_root, *entry))
-					return dir.get();
+		if (auto* dir = model_->dirForDirItem(item))
+			return dir;
 
 	return nullptr;
 }
@@ -1241,13 +1391,10 @@ ArchiveDir* ArchiveEntryTree::lastSelectedDirectory() const
 	wxDataViewItemArray selection;
 	GetSelections(selection);
 
-	// Find first directory in selected items
-	const auto dir_root = archive->rootDir();
+	// Find last directory in selected items
 	for (int i = static_cast<int>(selection.size()) - 1; i >= 0; --i)
-		if (auto* entry = static_cast<ArchiveEntry*>(selection[i].GetID()))
-			if (entry->type() == EntryType::folderType())
-				if (const auto dir = ArchiveDir::findDirByDirEntry(dir_root, *entry))
-					return dir.get();
+		if (auto* dir = model_->dirForDirItem(selection[i]))
+			return dir;
 
 	return nullptr;
 }
@@ -8,6 +8,7 @@ namespace slade
 class Archive;
 class ArchiveEntry;
 class ArchiveDir;
+class EntryType;
 class UndoManager;
 class SToolBarButton;
 
@@ -56,17 +57,37 @@ namespace ui
 		wxDataViewItem createItemForDirectory(const ArchiveDir& dir) const;
 
 	private:
+		// Cached display info for an entry row (regenerated if the entry's
+		// type or size changes)
+		struct RowInfo
+		{
+			EntryType*         type = nullptr;
+			uint32_t           size = 0;
+			wxString           size_string;
+			wxString           type_string;
+			wxDataViewIconText icon; // Icon only, the name is set when getting the value
+		};
+
 		weak_ptr<Archive>    archive_;
 		weak_ptr<ArchiveDir> root_dir_;
 		ScopedConnectionList connections_;
-		vector<string>       filter_name_;
+		vector<string>       filter_name_;   // Wildcard name filters
+		vector<string>       filter_prefix_; // Plain name prefix filters (no wildcards)
 		string               filter_category_;
 		UndoManager*         undo_manager_       = nullptr;
 		bool                 sort_enabled_       = true;
+		bool                 sort_default_name_  = false; // Default (index) sort is by name (eg. directory archives)
 		bool                 modified_indicator_ = true;
 		ViewType             view_type_          = ViewType::Tree;
 		ArchivePathPanel*    path_panel_         = nullptr;
 
+		// Directories the control has requested the children of, and the items
+		// given for them. Changes in other directories need no notifications,
+		// the control will get their current children when they are expanded
+		mutable std::unordered_map<const ArchiveDir*, weak_ptr<ArchiveDir>> fetched_dirs_;
+		mutable std::unordered_map<const ArchiveEntry*, const ArchiveDir*>  shown_items_;
+		mutable std::unordered_map<const ArchiveEntry*, RowInfo>            rows_;
+
 		// wxDataViewModel
 		unsigned int   GetColumnCount() const override { return 4; }
 		wxString       GetColumnType(unsigned int col) const override;
@@ -81,10 +102,15 @@ namespace ui
 		int Compare(const wxDataViewItem& item1, const wxDataViewItem& item2, unsigned int column, bool ascending)
 			const override;
 
-		bool matchesFilter(const ArchiveEntry& entry) const;
-		void getDirChildItems(wxDataViewItemArray& items, const ArchiveDir& dir, bool filter = true) const;
-		bool entryIsInList(const ArchiveEntry& entry) const;
-		bool dirIsInList(const ArchiveDir& dir) const;
+		bool           matchesFilter(const ArchiveEntry& entry) const;
+		bool           itemMatchesFilter(const ArchiveEntry& entry) const;
+		void           getDirChildItems(wxDataViewItemArray& items, const ArchiveDir& dir, bool filter = true) const;
+		bool           isFetched(const ArchiveDir& dir) const;
+		bool           isShown(const ArchiveEntry& entry) const { return shown_items_.count(&entry) > 0; }
+		void           addItems(const ArchiveDir& dir, const vector<ArchiveEntry*>& entries);
+		void           removeItems(const ArchiveDir& dir, const vector<ArchiveEntry*>& entries);
+		void           resetItems();
+		const RowInfo& rowInfo(const ArchiveEntry& entry) const;
 	};
 
 	class ArchiveEntryTree : public wxDataViewCtrl
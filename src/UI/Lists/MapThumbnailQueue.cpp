@@ -0,0 +1,150 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapThumbnailQueue.cpp
+// Description: MapThumbnailQueue class. Reads map geometry and renders map
+//              thumbnails on worker threads (without OpenGL, see
+//              MapPreviewData::render). Geometry read for a thumbnail is added
+//              to the map preview cache, so the map then opens instantly in a
+//              MapPreviewCanvas.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapThumbnailQueue.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// MapThumbnailQueue Structs
+//
+// -----------------------------------------------------------------------------
+
+// A map thumbnail to be rendered, with everything needed to render it without
+// accessing the map entries
+struct MapThumbnailQueue::Job
+{
+	weak_ptr<Request>                request;
+	MapPreviewData::Source           source;
+	shared_ptr<const MapPreviewData> data; // Already cached geometry, if any
+	MapPreviewData::RenderStyle      style;
+	int                              size = 0;
+	bool                             ok   = false;
+};
+
+
+// -----------------------------------------------------------------------------
+//
+// MapThumbnailQueue Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// MapThumbnailQueue class constructor
+// -----------------------------------------------------------------------------
+MapThumbnailQueue::MapThumbnailQueue() :
+	jobs_{
+		[](Job& job)
+		{
+			// Skip if the request was dropped
+			auto request = job.request.lock();
+			if (!request)
+				return;
+
+			// Read map geometry if it wasn't cached, and add it to the cache
+			if (!job.data)
+			{
+				auto data = std::make_shared<MapPreviewData>();
+				if (data->read(job.source))
+				{
+					MapPreviewData::addToCache(job.source.key, data);
+					job.data = data;
+				}
+			}
+
+			// Render the thumbnail into the request image (it isn't accessed on
+			// the main thread until the request is done)
+			if (job.data)
+			{
+				job.data->render(request->image, job.size, job.size, job.style);
+				job.ok = true;
+			}
+			job.data.reset();
+		},
+		[](Job& job)
+		{
+			auto request = job.request.lock();
+			if (!request)
+				return;
+
+			request->ok   = job.ok;
+			request->done = true;
+			if (request->on_done)
+				request->on_done(*request);
+		}
+	}
+{
+}
+
+// -----------------------------------------------------------------------------
+// MapThumbnailQueue class destructor
+// -----------------------------------------------------------------------------
+MapThumbnailQueue::~MapThumbnailQueue() = default;
+
+// -----------------------------------------------------------------------------
+// Queues a [size]x[size] thumbnail of [map] in [style] to be rendered on a
+// task worker, and returns the request for the result. [on_done] is called
+// on the main thread when it is finished.
+// If the map is invalid the returned request is already done (and not ok)
+// -----------------------------------------------------------------------------
+shared_ptr<MapThumbnailQueue::Request> MapThumbnailQueue::queue(
+	const Archive::MapDesc&            map,
+	int                                size,
+	const MapPreviewData::RenderStyle& style,
+	std::function<void(Request&)>      on_done)
+{
+	auto request     = std::make_shared<Request>();
+	request->on_done = std::move(on_done);
+
+	auto job = std::make_shared<Job>();
+	if (!MapPreviewData::getSource(map, job->source))
+	{
+		request->done = true;
+		return request;
+	}
+	job->request = request;
+	job->data    = MapPreviewData::cached(job->source.key);
+	job->style   = style;
+	job->size    = size;
+
+	// Add to queue (in order, so thumbnails appear from the top of the list)
+	jobs_.push(job);
+
+	return request;
+}
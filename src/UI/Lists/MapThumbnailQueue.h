@@ -0,0 +1,39 @@
+#pragma once
+
+#include "General/Tasks.h"
+#include "Graphics/SImage/SImage.h"
+#include "SLADEMap/MapPreviewData.h"
+
+namespace slade
+{
+class MapThumbnailQueue
+{
+public:
+	// A map thumbnail being rendered in the background. [done], [ok] and
+	// [image] are only valid on the main thread once [done] is true, at which
+	// point [on_done] is called (if set).
+	// Dropping the last reference to a request cancels it if it hasn't
+	// started rendering yet
+	struct Request
+	{
+		SImage                        image;
+		bool                          done = false;
+		bool                          ok   = false;
+		std::function<void(Request&)> on_done;
+	};
+
+	MapThumbnailQueue();
+	~MapThumbnailQueue();
+
+	shared_ptr<Request> queue(
+		const Archive::MapDesc&            map,
+		int                                size,
+		const MapPreviewData::RenderStyle& style,
+		std::function<void(Request&)>      on_done = {});
+
+private:
+	struct Job;
+
+	tasks::JobQueue<Job> jobs_;
+};
+} // namespace slade
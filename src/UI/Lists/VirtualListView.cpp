@@ -338,7 +338,45 @@ void VirtualListView::updateList(bool clear)
 void VirtualListView::sortItems()
 {
 	lv_current_ = this;
-	std::sort(items_.begin(), items_.end(), &VirtualListView::defaultSort);
+	sortItemsByText();
+}
+
+// -----------------------------------------------------------------------------
+// Sorts the list items the same as defaultSort, but only gets the (lowercase)
+// sort column text of each item once rather than for every comparison
+// -----------------------------------------------------------------------------
+void VirtualListView::sortItemsByText()
+{
+	// No sort column, just sort by index
+	if (sort_column_ < 0)
+	{
+		std::sort(
+			items_.begin(),
+			items_.end(),
+			[this](long left, long right) { return sort_descend_ ? right < left : left < right; });
+		return;
+	}
+
+	// Get sort column text for all items
+	vector<std::pair<wxString, long>> keys(items_.size());
+	for (unsigned a = 0; a < items_.size(); a++)
+		keys[a] = { itemText(items_[a], sort_column_, items_[a]).Lower(), items_[a] };
+
+	// Sort by column text > index
+	std::sort(
+		keys.begin(),
+		keys.end(),
+		[this](const std::pair<wxString, long>& left, const std::pair<wxString, long>& right)
+		{
+			int result = left.first.compare(right.first);
+			if (result == 0)
+				return left.second < right.second;
+			else
+				return sort_descend_ ? result > 0 : result < 0;
+		});
+
+	for (unsigned a = 0; a < keys.size(); a++)
+		items_[a] = keys[a].second;
 }
 
 // -----------------------------------------------------------------------------
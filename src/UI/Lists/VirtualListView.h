@@ -66,6 +66,8 @@ protected:
 
 	static VirtualListView* lv_current_;
 
+	void sortItemsByText();
+
 	virtual wxString itemText(long item, long column, long index) const { return "UNDEFINED"; }
 	virtual int      itemIcon(long item, long column, long index) const { return -1; }
 	virtual void     updateItemAttr(long item, long column, long index) const {}
@@ -33,10 +33,93 @@
 #include "Main.h"
 #include "Compression.h"
 #include "thirdparty/zreaders/files.h"
+#ifdef USE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr unsigned STREAM_CHUNK = 65536; // Buffer size for streaming (de)compression
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Inflates the content of [in] directly into [out], which is resized to the
+// expected inflated [size] beforehand. This avoids the intermediate buffers
+// and reallocations of streaming, and uses libdeflate instead of zlib if
+// available.
+// Returns false if the data didn't inflate successfully to at most [size]
+// bytes (in which case streaming should be used instead)
+// -----------------------------------------------------------------------------
+bool inflateToSize(const MemChunk& in, MemChunk& out, int windowbits, size_t size)
+{
+	if (!in.hasData() || size == 0 || !out.reSize(size, false))
+		return false;
+
+	size_t inflated_size;
+
+#ifdef USE_LIBDEFLATE
+	// Decompressors can't be shared between threads, so use one per thread
+	thread_local std::unique_ptr<libdeflate_decompressor, decltype(&libdeflate_free_decompressor)> decompressor{
+		libdeflate_alloc_decompressor(), &libdeflate_free_decompressor
+	};
+	if (!decompressor)
+		return false;
+
+	libdeflate_result result;
+	if (windowbits < 0)
+		result = libdeflate_deflate_decompress(
+			decompressor.get(), in.data(), in.size(), out.data(), size, &inflated_size);
+	else if (windowbits > MAX_WBITS)
+		result = libdeflate_gzip_decompress(decompressor.get(), in.data(), in.size(), out.data(), size, &inflated_size);
+	else
+		result = libdeflate_zlib_decompress(decompressor.get(), in.data(), in.size(), out.data(), size, &inflated_size);
+
+	if (result != LIBDEFLATE_SUCCESS)
+		return false;
+#else
+	z_stream strm{};
+	if ((windowbits == 0 ? inflateInit(&strm) : inflateInit2(&strm, windowbits)) != Z_OK)
+		return false;
+
+	strm.next_in   = const_cast<Bytef*>(in.data());
+	strm.avail_in  = in.size();
+	strm.next_out  = out.data();
+	strm.avail_out = size;
+	const auto ret = inflate(&strm, Z_FINISH);
+	inflated_size  = strm.total_out;
+	inflateEnd(&strm);
+
+	if (ret != Z_STREAM_END)
+		return false;
+#endif
+
+	// Inflated to less than expected
+	if (inflated_size == 0)
+		out.clear();
+	else if (inflated_size < size)
+		out.reSize(inflated_size);
+
+	return true;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // Compression Namespace Functions
@@ -52,17 +135,14 @@ bool compression::genericInflate(MemChunk& in, MemChunk& out, int windowbits, co
 {
 	in.seek(0, SEEK_SET);
 	out.clear();
-	MemoryReader source(in);
-	FileReaderZ  stream(source, windowbits);
-	uint8_t      buffer[CHUNK];
-	size_t       gotten;
-	do
+
+	if (!inflateStream(in, [&out](const uint8_t* data, size_t size) { return out.write(data, size); }, windowbits))
 	{
-		gotten = stream.Read(buffer, CHUNK);
-		if (gotten > 0)
-			out.write(buffer, gotten);
-	} while (gotten == CHUNK && stream.Status == Z_OK);
-	return (stream.Status == Z_OK || stream.Status == Z_STREAM_END);
+		log::error("{}: Error inflating stream", function);
+		return false;
+	}
+
+	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -139,7 +219,8 @@ bool compression::genericDeflate(MemChunk& in, MemChunk& out, int level, int win
 // -----------------------------------------------------------------------------
 bool compression::zipInflate(MemChunk& in, MemChunk& out, size_t maxsize)
 {
-	bool ret = compression::genericInflate(in, out, -MAX_WBITS, "ZipInflate");
+	bool ret = inflateToSize(in, out, -MAX_WBITS, maxsize)
+			   || compression::genericInflate(in, out, -MAX_WBITS, "ZipInflate");
 
 	if (maxsize && out.size() != maxsize)
 		log::warning("Zip stream inflated to {}, expected {}", out.size(), maxsize);
@@ -164,7 +245,18 @@ bool compression::zipDeflate(MemChunk& in, MemChunk& out, int level)
 // -----------------------------------------------------------------------------
 bool compression::gzipInflate(MemChunk& in, MemChunk& out, size_t maxsize)
 {
-	bool ret = compression::genericInflate(in, out, 16 + MAX_WBITS, "GZipInflate");
+	// If no size was given, use the size recorded at the end of the stream
+	// (ignored if it's larger than is possible for deflated data)
+	auto expected_size = maxsize;
+	if (expected_size == 0 && in.size() >= 18)
+	{
+		expected_size = in.readL32(in.size() - 4);
+		if (expected_size > static_cast<size_t>(in.size()) * 1032)
+			expected_size = 0;
+	}
+
+	bool ret = inflateToSize(in, out, 16 + MAX_WBITS, expected_size)
+			   || compression::genericInflate(in, out, 16 + MAX_WBITS, "GZipInflate");
 
 	if (maxsize && out.size() != maxsize)
 		log::warning("Zip stream inflated to {}, expected {}", out.size(), maxsize);
@@ -190,7 +282,7 @@ bool compression::gzipDeflate(MemChunk& in, MemChunk& out, int level)
 // -----------------------------------------------------------------------------
 bool compression::zlibInflate(MemChunk& in, MemChunk& out, size_t maxsize)
 {
-	bool ret = compression::genericInflate(in, out, 0, "ZlibInflate");
+	bool ret = inflateToSize(in, out, 0, maxsize) || compression::genericInflate(in, out, 0, "ZlibInflate");
 
 	if (maxsize && out.size() != maxsize)
 		log::warning("Zlib stream inflated to {}, expected {}", out.size(), maxsize);
@@ -206,6 +298,69 @@ bool compression::zlibDeflate(MemChunk& in, MemChunk& out, int level)
 	return compression::genericDeflate(in, out, level, 0, "ZlibDeflate");
 }
 
+// -----------------------------------------------------------------------------
+// Deflates the content of [in] as a zlib stream to [out] as small as possible,
+// using libdeflate's highest level if available, otherwise the smaller of
+// zlib's level 9 with the default and filtered strategies. Much slower than
+// zlibDeflate, for when output size matters most (eg. PNG optimization).
+// Can be called from any thread
+// -----------------------------------------------------------------------------
+bool compression::zlibDeflateBest(const MemChunk& in, MemChunk& out)
+{
+	if (!in.hasData())
+		return false;
+
+#ifdef USE_LIBDEFLATE
+	// Compressors can't be shared between threads, so use one per thread
+	thread_local std::unique_ptr<libdeflate_compressor, decltype(&libdeflate_free_compressor)> compressor{
+		libdeflate_alloc_compressor(12), &libdeflate_free_compressor
+	};
+	if (!compressor)
+		return false;
+
+	if (!out.reSize(libdeflate_zlib_compress_bound(compressor.get(), in.size()), false))
+		return false;
+
+	const auto size = libdeflate_zlib_compress(compressor.get(), in.data(), in.size(), out.data(), out.size());
+	if (size == 0)
+		return false;
+
+	return out.reSize(size);
+#else
+	auto deflate_strategy = [&in](int strategy, MemChunk& result)
+	{
+		z_stream strm{};
+		if (deflateInit2(&strm, 9, Z_DEFLATED, MAX_WBITS, 9, strategy) != Z_OK)
+			return false;
+
+		if (!result.reSize(deflateBound(&strm, in.size()), false))
+		{
+			deflateEnd(&strm);
+			return false;
+		}
+
+		strm.next_in   = const_cast<Bytef*>(in.data());
+		strm.avail_in  = in.size();
+		strm.next_out  = result.data();
+		strm.avail_out = result.size();
+		const auto ret  = deflate(&strm, Z_FINISH);
+		const auto size = strm.total_out;
+		deflateEnd(&strm);
+
+		return ret == Z_STREAM_END && result.reSize(size);
+	};
+
+	if (!deflate_strategy(Z_DEFAULT_STRATEGY, out))
+		return false;
+
+	MemChunk filtered;
+	if (deflate_strategy(Z_FILTERED, filtered) && filtered.size() < out.size())
+		out.importMem(filtered.data(), filtered.size());
+
+	return true;
+#endif
+}
+
 // -----------------------------------------------------------------------------
 // Decompress the content of [in] as a bzip2 stream to [out]
 // -----------------------------------------------------------------------------
@@ -213,22 +368,16 @@ bool compression::bzip2Decompress(MemChunk& in, MemChunk& out, size_t maxsize)
 {
 	in.seek(0, SEEK_SET);
 	out.clear();
+	if (maxsize)
+		out.reserve(maxsize);
 
-	MemoryReader  source(in);
-	FileReaderBZ2 stream(source);
-	uint8_t       buffer[4096];
-	size_t        gotten;
-	do
-	{
-		gotten = stream.Read(buffer, 4096);
-		if (gotten > 0)
-			out.write(buffer, gotten);
-	} while (gotten == 4096 && stream.Status == BZ_OK);
+	const bool ok = bzip2DecompressStream(
+		in, [&out](const uint8_t* data, size_t size) { return out.write(data, size); });
 
 	if (maxsize && out.size() != maxsize)
 		log::warning("bzip2 stream inflated to {}, expected {}", out.size(), maxsize);
 
-	return (stream.Status == BZ_OK || stream.Status == BZ_STREAM_END);
+	return ok;
 }
 
 // -----------------------------------------------------------------------------
@@ -268,15 +417,211 @@ bool compression::lzmaDecompress(MemChunk& in, MemChunk& out, size_t size)
 	in.seek(0, SEEK_SET);
 	out.clear();
 
+	if (size == 0)
+		return true;
+
+	// Decompress directly into [out]
 	MemoryReader   source(in);
 	FileReaderLZMA stream(source, size, true);
-	uint8_t*       cache = new uint8_t[size];
-	if (stream.Read(cache, size))
-	{
-		out.write(cache, size);
-		delete[] cache;
+	if (out.reSize(size, false) && stream.Read(out.data(), size))
 		return true;
-	}
-	delete[] cache;
+
+	out.clear();
 	return false;
 }
+
+// -----------------------------------------------------------------------------
+// Inflates the content of [in] (from its current position) with the given zlib
+// [windowbits] (0 for a zlib stream), passing the inflated data to [out] as it
+// is produced. Only small fixed-size buffers are used, so neither the input or
+// output need to be held in memory all at once.
+// Returns false if an error occurred or [out] stopped inflating, true otherwise
+// (including if the input ended before the end of the stream)
+// -----------------------------------------------------------------------------
+bool compression::inflateStream(SeekableData& in, const StreamOutput& out, int windowbits)
+{
+	z_stream strm{};
+	auto     ret = windowbits == 0 ? inflateInit(&strm) : inflateInit2(&strm, windowbits);
+	if (ret != Z_OK)
+	{
+		log::error("inflateStream init error {}", ret);
+		return false;
+	}
+
+	vector<uint8_t> buf_in(STREAM_CHUNK);
+	vector<uint8_t> buf_out(STREAM_CHUNK);
+	bool            ok = true;
+	while (ok && ret != Z_STREAM_END)
+	{
+		// Read next chunk of input
+		const auto have = std::min(STREAM_CHUNK, in.size() - in.currentPos());
+		if (have == 0 || !in.read(buf_in.data(), have))
+			break;
+		strm.next_in  = buf_in.data();
+		strm.avail_in = have;
+
+		// Inflate until all input is used (or the stream ends)
+		do
+		{
+			strm.next_out  = buf_out.data();
+			strm.avail_out = STREAM_CHUNK;
+			ret            = inflate(&strm, Z_NO_FLUSH);
+			if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+			{
+				log::error("inflateStream error {}: {}", ret, strm.msg ? strm.msg : "");
+				ok = false;
+				break;
+			}
+
+			const auto produced = STREAM_CHUNK - strm.avail_out;
+			if (produced > 0 && !out(buf_out.data(), produced))
+			{
+				ok = false;
+				break;
+			}
+		} while (strm.avail_out == 0 && ret != Z_STREAM_END);
+	}
+
+	inflateEnd(&strm);
+	return ok;
+}
+
+// -----------------------------------------------------------------------------
+// Decompresses the content of [in] (from its current position) as a bzip2
+// stream, passing the decompressed data to [out] as it is produced. Like
+// inflateStream, only small fixed-size buffers are used.
+// Returns false if an error occurred or [out] stopped decompressing, true
+// otherwise (including if the input ended before the end of the stream)
+// -----------------------------------------------------------------------------
+bool compression::bzip2DecompressStream(SeekableData& in, const StreamOutput& out)
+{
+	bz_stream strm{};
+	auto      ret = BZ2_bzDecompressInit(&strm, 0, 0);
+	if (ret != BZ_OK)
+	{
+		log::error("bzip2DecompressStream init error {}", ret);
+		return false;
+	}
+
+	vector<char> buf_in(STREAM_CHUNK);
+	vector<char> buf_out(STREAM_CHUNK);
+	bool         ok = true;
+	while (ok && ret != BZ_STREAM_END)
+	{
+		// Read next chunk of input
+		const auto have = std::min(STREAM_CHUNK, in.size() - in.currentPos());
+		if (have == 0 || !in.read(buf_in.data(), have))
+			break;
+		strm.next_in  = buf_in.data();
+		strm.avail_in = have;
+
+		// Decompress until all input is used (or the stream ends)
+		do
+		{
+			strm.next_out  = buf_out.data();
+			strm.avail_out = STREAM_CHUNK;
+			ret            = BZ2_bzDecompress(&strm);
+			if (ret != BZ_OK && ret != BZ_STREAM_END)
+			{
+				log::error("bzip2DecompressStream error {}", ret);
+				ok = false;
+				break;
+			}
+
+			const auto produced = STREAM_CHUNK - strm.avail_out;
+			if (produced > 0 && !out(reinterpret_cast<const uint8_t*>(buf_out.data()), produced))
+			{
+				ok = false;
+				break;
+			}
+		} while ((strm.avail_in > 0 || strm.avail_out == 0) && ret != BZ_STREAM_END);
+	}
+
+	BZ2_bzDecompressEnd(&strm);
+	return ok;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the name of the library used for inflating data of a known size
+// (eg. zip entries)
+// -----------------------------------------------------------------------------
+string_view compression::inflateBackendName()
+{
+#ifdef USE_LIBDEFLATE
+	return "libdeflate";
+#else
+	return "zlib";
+#endif
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+#include "Archive/Archive.h"
+#include "General/Console.h"
+#include "MainEditor/MainEditor.h"
+#include <chrono>
+
+// -----------------------------------------------------------------------------
+// Compares the speed of streaming and sized (direct) inflating of the entries
+// in the current archive. Entry data is deflated first, then inflated [count]
+// times (default 10) with each method
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(test_inflate_speed, 0, false)
+{
+	auto archive = maineditor::currentArchive();
+	if (!archive)
+		return;
+
+	int count = 10;
+	if (!args.empty())
+		count = std::max(strutil::asInt(args[0]), 1);
+
+	// Deflate all entry data
+	vector<unique_ptr<MemChunk>> deflated;
+	vector<size_t>               sizes;
+	size_t                       total_size = 0;
+	archive->rootDir()->visitEntries(
+		[&](ArchiveEntry& entry)
+		{
+			auto mc = std::make_unique<MemChunk>();
+			if (entry.size() == 0 || !compression::zipDeflate(entry.data(), *mc))
+				return;
+
+			deflated.push_back(std::move(mc));
+			sizes.push_back(entry.size());
+			total_size += entry.size();
+		});
+
+	log::console(fmt::format(
+		"Inflating {} entries ({:.1f}MB) x{}, using {} for sized inflate",
+		sizes.size(),
+		total_size / 1048576.0,
+		count,
+		compression::inflateBackendName()));
+
+	auto time_inflate = [&](string_view method, bool sized)
+	{
+		MemChunk   out;
+		const auto start = std::chrono::steady_clock::now();
+		for (int a = 0; a < count; a++)
+			for (unsigned i = 0; i < deflated.size(); i++)
+			{
+				if (sized)
+					compression::zipInflate(*deflated[i], out, sizes[i]);
+				else
+					compression::genericInflate(*deflated[i], out, -MAX_WBITS, "test_inflate_speed");
+			}
+		const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		log::console(
+			fmt::format("{}: {:.1f}ms ({:.1f}MB/s)", method, ms, total_size * count / 1048576.0 / (ms / 1000.0)));
+	};
+
+	time_inflate("Streaming", false);
+	time_inflate("Sized", true);
+}
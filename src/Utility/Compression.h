@@ -2,6 +2,10 @@
 
 namespace slade::compression
 {
+// Receives decompressed data as it is produced by a streaming decompressor.
+// Return false to stop decompressing
+using StreamOutput = std::function<bool(const uint8_t* data, size_t size)>;
+
 bool genericInflate(MemChunk& in, MemChunk& out, int windowbits, const char* function);
 bool genericDeflate(MemChunk& in, MemChunk& out, int level, int windowbits, const char* function);
 bool gzipInflate(MemChunk& in, MemChunk& out, size_t maxsize = 0);
@@ -10,9 +14,16 @@ bool zipInflate(MemChunk& in, MemChunk& out, size_t maxsize = 0);
 bool zipDeflate(MemChunk& in, MemChunk& out, int level = -1);
 bool zlibInflate(MemChunk& in, MemChunk& out, size_t maxsize = 0);
 bool zlibDeflate(MemChunk& in, MemChunk& out, int level = -1);
+bool zlibDeflateBest(const MemChunk& in, MemChunk& out);
 bool zipExplode(MemChunk& in, MemChunk& out, size_t size, int flags);
 bool zipUnshrink(MemChunk& in, MemChunk& out, size_t maxsize);
 bool bzip2Decompress(MemChunk& in, MemChunk& out, size_t maxsize = 0);
 bool bzip2Compress(MemChunk& in, MemChunk& out);
 bool lzmaDecompress(MemChunk& in, MemChunk& out, size_t size);
+
+// Streaming decompression (bounded buffers, [in] is read from its current position)
+bool inflateStream(SeekableData& in, const StreamOutput& out, int windowbits);
+bool bzip2DecompressStream(SeekableData& in, const StreamOutput& out);
+
+string_view inflateBackendName();
 } // namespace slade::compression
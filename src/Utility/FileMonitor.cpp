@@ -7,8 +7,9 @@
 // Web:         http://slade.mancubus.net
 // Filename:    FileMonitor.cpp
 // Description: FileMonitor class, keeps track of a file and checks it for any
-//              modifications every second, also tracks an external process, and
-//              deletes itself when this process is terminated.
+//              modifications (when notified of changes by the file system, or
+//              every second if that isn't possible), also tracks an external
+//              process, and deletes itself when this process is terminated.
 //
 // This program is free software; you can redistribute it and/or modify it
 // under the terms of the GNU General Public License as published by the Free
@@ -38,10 +39,120 @@
 #include "FileUtils.h"
 #include "StringUtils.h"
 #include <filesystem>
+#include <wx/fswatcher.h>
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr int CHANGE_DELAY = 200; // Time (ms) to wait for further changes before checking a changed file
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// FileMonitorWatcher Class
+//
+// A single file system watcher shared by all FileMonitors, watching the
+// directories of all monitored files and passing change notifications on to
+// the monitors of the changed files
+// -----------------------------------------------------------------------------
+namespace
+{
+class FileMonitorWatcher : public wxEvtHandler
+{
+public:
+	// Starts watching for changes to the file of [monitor]. Returns false if
+	// it can't be watched
+	bool add(FileMonitor* monitor)
+	{
+		// The watcher needs a running event loop
+		if (!wxEventLoopBase::GetActive())
+			return false;
+
+		if (!watcher_)
+		{
+			watcher_ = std::make_unique<wxFileSystemWatcher>();
+			watcher_->SetOwner(this);
+			Bind(wxEVT_FSWATCHER, &FileMonitorWatcher::onFileChanged, this);
+		}
+
+		// Watch the file's directory rather than the file itself, since many
+		// programs save by replacing the file
+		wxFileName fn(monitor->filename());
+		fn.Normalize(wxPATH_NORM_ABSOLUTE | wxPATH_NORM_DOTS);
+		auto dir = fn.GetPath();
+		if (dir_refs_[dir] == 0
+			&& !watcher_->Add(wxFileName::DirName(dir), wxFSW_EVENT_CREATE | wxFSW_EVENT_MODIFY | wxFSW_EVENT_RENAME))
+		{
+			dir_refs_.erase(dir);
+			return false;
+		}
+
+		dir_refs_[dir]++;
+		monitors_[monitor] = fn.GetFullPath();
+		return true;
+	}
+
+	// Stops watching for changes to the file of [monitor]
+	void remove(FileMonitor* monitor)
+	{
+		auto i = monitors_.find(monitor);
+		if (i == monitors_.end())
+			return;
+
+		// Stop watching the directory if nothing else is monitored there
+		auto dir = wxFileName(i->second).GetPath();
+		if (--dir_refs_[dir] == 0)
+		{
+			dir_refs_.erase(dir);
+			watcher_->Remove(wxFileName::DirName(dir));
+		}
+
+		monitors_.erase(i);
+	}
+
+	static FileMonitorWatcher& instance()
+	{
+		// Never deleted, since the watcher can't be destroyed after wx has
+		// been shut down
+		static auto* watcher = new FileMonitorWatcher();
+		return *watcher;
+	}
+
+private:
+	unique_ptr<wxFileSystemWatcher>  watcher_;
+	std::map<wxString, unsigned>     dir_refs_; // Number of monitored files in each watched directory
+	std::map<FileMonitor*, wxString> monitors_; // Full path of each monitor's file
+
+	void onFileChanged(wxFileSystemWatcherEvent& e)
+	{
+		// Check everything if the watcher itself had problems (eg. overflowed)
+		if (e.GetChangeType() == wxFSW_EVENT_ERROR || e.GetChangeType() == wxFSW_EVENT_WARNING)
+		{
+			for (const auto& monitor : monitors_)
+				monitor.first->fileChanged();
+			return;
+		}
+
+		// Renames pass on the new path too (eg. a temp file renamed over the
+		// monitored file)
+		auto path     = e.GetPath().GetFullPath();
+		auto new_path = e.GetChangeType() == wxFSW_EVENT_RENAME ? e.GetNewPath().GetFullPath() : wxString{};
+		for (const auto& monitor : monitors_)
+			if (monitor.second == path || monitor.second == new_path)
+				monitor.first->fileChanged();
+	}
+};
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // FileMonitor Class Fucntions
@@ -57,24 +168,70 @@ FileMonitor::FileMonitor(string_view filename, bool start) : filename_{ filename
 	// Create process
 	process_ = std::make_unique<wxProcess>(this);
 
-	// Start timer (updates every 1 sec)
+	// Start monitoring
 	if (start)
-	{
-		file_modified_ = fileutil::fileModifiedTime(filename);
-		wxTimer::Start(1000);
-	}
+		startMonitoring();
 
 	// Bind events
 	Bind(wxEVT_END_PROCESS, &FileMonitor::onEndProcess, this);
 }
 
+// -----------------------------------------------------------------------------
+// FileMonitor class destructor
+// -----------------------------------------------------------------------------
+FileMonitor::~FileMonitor()
+{
+	if (watched_)
+		FileMonitorWatcher::instance().remove(this);
+}
+
+// -----------------------------------------------------------------------------
+// Starts monitoring the file for changes, via the file system watcher if
+// possible, otherwise by checking it every second
+// -----------------------------------------------------------------------------
+void FileMonitor::startMonitoring()
+{
+	file_modified_ = fileutil::fileModifiedTime(filename_);
+
+	if (!watched_)
+		watched_ = FileMonitorWatcher::instance().add(this);
+
+	if (!watched_)
+		wxTimer::Start(1000);
+}
+
+// -----------------------------------------------------------------------------
+// Called by the file system watcher when the file has changed. The file is
+// checked once it hasn't changed for a short time, so that a file being
+// written in several steps is only reloaded once
+// -----------------------------------------------------------------------------
+void FileMonitor::fileChanged()
+{
+	changed_ = true;
+	wxTimer::StartOnce(CHANGE_DELAY);
+}
+
 // -----------------------------------------------------------------------------
 // Override of wxTimer::Notify, called each time the timer updates
 // -----------------------------------------------------------------------------
 void FileMonitor::Notify()
 {
-	// Check if the file has been modified since last update
 	auto modified = fileutil::fileModifiedTime(filename_);
+
+	// Watched file, the watcher has already determined that it changed (the
+	// modification time may not have, if it changed within the same second)
+	if (watched_)
+	{
+		if (!changed_ || !fileutil::fileExists(filename_))
+			return;
+
+		changed_       = false;
+		file_modified_ = modified;
+		fileModified();
+		return;
+	}
+
+	// Check if the file has been modified since last update
 	if (modified > file_modified_)
 	{
 		// Modified, update modification time and run any custom code
@@ -4,11 +4,15 @@ namespace slade
 {
 class Archive;
 
+// Keeps track of a file, calling fileModified when it is changed, and an
+// external process (deleting itself when the process is terminated).
+// Changes are picked up from file system change notifications where possible,
+// falling back to checking the file every second otherwise
 class FileMonitor : public wxTimer
 {
 public:
 	FileMonitor(string_view filename, bool start = true);
-	virtual ~FileMonitor() = default;
+	virtual ~FileMonitor();
 
 	wxProcess*    process() const { return process_.get(); }
 	const string& filename() const { return filename_; }
@@ -16,15 +20,19 @@ public:
 	virtual void fileModified() {}
 	virtual void processTerminated() {}
 
+	void startMonitoring();
+	void fileChanged();
 	void Notify() override;
 	void onEndProcess(wxProcessEvent& e);
 
 protected:
 	string filename_;
-	time_t file_modified_;
+	time_t file_modified_ = 0;
 
 private:
 	unique_ptr<wxProcess> process_;
+	bool                  watched_ = false; // Notified of changes by the file system watcher
+	bool                  changed_ = false; // Changed since last checked (when watched)
 };
 
 class DB2MapFileMonitor : public FileMonitor
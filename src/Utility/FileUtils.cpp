@@ -37,11 +37,39 @@
 #include "StringUtils.h"
 #include <filesystem>
 #include <fstream>
+#ifdef _WIN32
+#include <wx/msw/wrapwin.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 using namespace slade;
 namespace fs = std::filesystem;
 
 
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Seeks [handle] to [offset] from [origin], supporting offsets beyond 4GB
+// -----------------------------------------------------------------------------
+int seekFile(FILE* handle, int64_t offset, int origin)
+{
+#ifdef _WIN32
+	return _fseeki64(handle, offset, origin);
+#else
+	return fseeko(handle, static_cast<off_t>(offset), origin);
+#endif
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // FileUtil Namespace Functions
@@ -304,7 +332,12 @@ bool SFile::open(const string& path, Mode mode)
 	}
 
 	if (handle_)
-		stat(path.c_str(), &stat_);
+	{
+		std::error_code error;
+		size_ = fs::file_size(path, error);
+		if (error)
+			size_ = 0;
+	}
 
 	return handle_ != nullptr;
 }
@@ -324,25 +357,25 @@ void SFile::close()
 // -----------------------------------------------------------------------------
 // Seeks ahead by [offset] bytes from the current position
 // -----------------------------------------------------------------------------
-bool SFile::seek(unsigned offset)
+bool SFile::seek(uint64_t offset)
 {
-	return handle_ ? fseek(handle_, offset, SEEK_CUR) == 0 : false;
+	return handle_ ? seekFile(handle_, static_cast<int64_t>(offset), SEEK_CUR) == 0 : false;
 }
 
 // -----------------------------------------------------------------------------
 // Seeks to [offset] bytes from the beginning of the file
 // -----------------------------------------------------------------------------
-bool SFile::seekFromStart(unsigned offset)
+bool SFile::seekFromStart(uint64_t offset)
 {
-	return handle_ ? fseek(handle_, offset, SEEK_SET) == 0 : false;
+	return handle_ ? seekFile(handle_, static_cast<int64_t>(offset), SEEK_SET) == 0 : false;
 }
 
 // -----------------------------------------------------------------------------
 // Seeks to [offset] bytes back from the end of the file
 // -----------------------------------------------------------------------------
-bool SFile::seekFromEnd(unsigned offset)
+bool SFile::seekFromEnd(uint64_t offset)
 {
-	return handle_ ? fseek(handle_, offset, SEEK_END) == 0 : false;
+	return handle_ ? seekFile(handle_, -static_cast<int64_t>(offset), SEEK_END) == 0 : false;
 }
 
 // -----------------------------------------------------------------------------
@@ -403,3 +436,107 @@ bool SFile::writeStr(string_view str) const
 
 	return false;
 }
+
+
+
+// -----------------------------------------------------------------------------
+//
+// MappedFile Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Maps the file at [path] into memory.
+// Returns false if the file couldn't be opened or mapped (or is empty)
+// -----------------------------------------------------------------------------
+bool MappedFile::open(string_view path)
+{
+	// Needs to be closed first if already open
+	if (data_)
+		return false;
+
+#ifdef _WIN32
+	auto file = CreateFileW(
+		fs::path{ path }.wstring().c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0 || file_size.QuadPart > 0xFFFFFFFF)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	auto map = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if (!map)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	auto view = MapViewOfFile(map, FILE_MAP_COPY, 0, 0, 0);
+	if (!view)
+	{
+		CloseHandle(map);
+		CloseHandle(file);
+		return false;
+	}
+
+	file_handle_ = file;
+	map_handle_  = map;
+	data_        = static_cast<uint8_t*>(view);
+	size_        = static_cast<unsigned>(file_size.QuadPart);
+#else
+	auto fd = ::open(string{ path }.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0 || file_stat.st_size > 0xFFFFFFFF)
+	{
+		::close(fd);
+		return false;
+	}
+
+	// Map privately so that any writes to the data are copy-on-write
+	auto view = mmap(nullptr, file_stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	::close(fd); // The mapping stays valid after the file descriptor is closed
+	if (view == MAP_FAILED)
+		return false;
+
+	data_ = static_cast<uint8_t*>(view);
+	size_ = static_cast<unsigned>(file_stat.st_size);
+#endif
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Unmaps the file
+// -----------------------------------------------------------------------------
+void MappedFile::close()
+{
+	if (!data_)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(data_);
+	CloseHandle(map_handle_);
+	CloseHandle(file_handle_);
+	map_handle_  = nullptr;
+	file_handle_ = nullptr;
+#else
+	munmap(data_, size_);
+#endif
+
+	data_ = nullptr;
+	size_ = 0;
+}
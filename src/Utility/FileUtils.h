@@ -36,15 +36,15 @@ public:
 
 	bool     isOpen() const { return handle_ != nullptr; }
 	unsigned currentPos() const override;
-	unsigned length() const { return handle_ ? stat_.st_size : 0; }
-	unsigned size() const override { return handle_ ? stat_.st_size : 0; }
+	uint64_t length() const { return handle_ ? size_ : 0; }
+	unsigned size() const override { return handle_ ? static_cast<unsigned>(size_) : 0; }
 
 	bool open(const string& path, Mode mode = Mode::ReadOnly);
 	void close();
 
-	bool seek(unsigned offset) override;
-	bool seekFromStart(unsigned offset) override;
-	bool seekFromEnd(unsigned offset) override;
+	bool seek(uint64_t offset) override;
+	bool seekFromStart(uint64_t offset) override;
+	bool seekFromEnd(uint64_t offset) override;
 
 	bool read(void* buffer, unsigned count) override;
 	bool read(MemChunk& mc, unsigned count);
@@ -54,7 +54,36 @@ public:
 	bool writeStr(string_view str) const;
 
 private:
-	FILE*       handle_ = nullptr;
-	struct stat stat_;
+	FILE*    handle_ = nullptr;
+	uint64_t size_   = 0; // Size of the file when opened (see length)
+};
+
+// Read-only (copy-on-write) memory mapping of a file.
+// Pages are only read from disk when accessed, and any writes to the mapped
+// data are private to the process (the file itself is never modified)
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(string_view path) { open(path); }
+	~MappedFile() { close(); }
+
+	MappedFile(const MappedFile&)            = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool     isOpen() const { return data_ != nullptr; }
+	uint8_t* data() const { return data_; }
+	unsigned size() const { return size_; }
+
+	bool open(string_view path);
+	void close();
+
+private:
+	uint8_t* data_ = nullptr;
+	unsigned size_ = 0;
+#ifdef _WIN32
+	void* file_handle_ = nullptr;
+	void* map_handle_  = nullptr;
+#endif
 };
 } // namespace slade
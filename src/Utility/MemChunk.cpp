@@ -72,7 +72,7 @@ MemChunk::MemChunk(const uint8_t* data, uint32_t size) : size_{ size }
 MemChunk::~MemChunk()
 {
 	// Free memory
-	delete[] data_;
+	freeData();
 }
 
 // -----------------------------------------------------------------------------
@@ -89,20 +89,22 @@ bool MemChunk::hasData() const
 // -----------------------------------------------------------------------------
 bool MemChunk::clear()
 {
-	if (hasData())
-	{
-		delete[] data_;
-		data_    = nullptr;
-		size_    = 0;
-		cur_ptr_ = 0;
-		return true;
-	}
+	const bool had_data = hasData();
+
+	if (data_)
+		freeData();
 
-	return false;
+	data_     = nullptr;
+	size_     = 0;
+	capacity_ = 0;
+	cur_ptr_  = 0;
+
+	return had_data;
 }
 
 // -----------------------------------------------------------------------------
 // Resizes the memory chunk, preserving existing data if specified.
+// Memory is only reallocated if [new_size] is larger than the current capacity.
 // Returns false if new size is invalid, true otherwise
 // -----------------------------------------------------------------------------
 bool MemChunk::reSize(uint32_t new_size, bool preserve_data)
@@ -114,35 +116,119 @@ bool MemChunk::reSize(uint32_t new_size, bool preserve_data)
 		return false;
 	}
 
-	// Attempt to allocate memory for new size
-	auto ndata = allocData(new_size, false);
+	if (!preserve_data)
+	{
+		// Existing data isn't needed, reallocate only if there isn't enough room
+		if (new_size > capacity_)
+		{
+			clear();
+			if (!allocData(new_size))
+				return false;
+		}
+		cur_ptr_ = 0;
+	}
+	else if (!reserve(new_size))
+		return false;
+
+	// Update variables
+	size_ = new_size;
+
+	// Check position
+	if (cur_ptr_ > size_)
+		cur_ptr_ = size_;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Ensures at least [capacity] bytes are allocated for the chunk, so that it can
+// be written to up to that size without reallocating. Existing data and the
+// current size are preserved.
+// Returns false if allocation failed, true otherwise
+// -----------------------------------------------------------------------------
+bool MemChunk::reserve(uint32_t capacity)
+{
+	// Check if there is already enough room
+	if (capacity <= capacity_)
+		return true;
+
+	// Allocate new memory and copy existing data to it
+	auto ndata = allocData(capacity, false);
 	if (!ndata)
 		return false;
+	if (data_ && size_ > 0)
+		memcpy(ndata, data_, size_);
+	if (data_)
+		freeData();
 
-	// Preserve existing data if specified
-	if (!preserve_data)
+	data_     = ndata;
+	capacity_ = capacity;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the category the chunk's allocated data is counted under to [category],
+// moving any data it currently owns to it
+// -----------------------------------------------------------------------------
+void MemChunk::setMemCategory(memstats::Category category)
+{
+	if (data_ && !mapping_ && !shared_)
 	{
-		clear();
-		data_ = ndata;
+		memstats::freed(mem_category_, capacity_);
+		memstats::allocated(category, capacity_);
 	}
-	else if (data_ != nullptr)
+
+	mem_category_ = category;
+}
+
+// -----------------------------------------------------------------------------
+// Shares the data in [other] with this MemChunk rather than copying it. The
+// data is only actually copied when either MemChunk is modified (copy on write).
+// If [size] is given, only [size] bytes from [offset] in [other] are shared.
+// Returns false if [other] has no data or the range is invalid, true otherwise
+// -----------------------------------------------------------------------------
+bool MemChunk::share(const MemChunk& other, uint32_t offset, uint32_t size)
+{
+	if (&other == this)
+		return offset == 0 && (size == 0 || size == size_);
+
+	// Clear current data if it exists
+	clear();
+
+	if (!other.hasData())
+		return false;
+
+	// Check range
+	if (size == 0)
+		size = other.size_ - std::min(offset, other.size_);
+	if (size == 0 || static_cast<uint64_t>(offset) + size > other.size_)
 	{
-		memcpy(ndata, data_, size_ * sizeof(uint8_t));
-		delete[] data_;
-		data_ = ndata;
+		log::error("MemChunk::share: Invalid range {}-{} (data size {})", offset, offset + size, other.size_);
+		return false;
 	}
+
+	if (other.mapping_)
+		mapping_ = other.mapping_;
 	else
 	{
-		memset(ndata, 0, size_ * sizeof(uint8_t));
-		data_ = ndata;
+		// Other chunk owns its data, so it needs to be moved into a shared
+		// pointer so it can be kept for as long as either chunk uses it
+		if (!other.shared_)
+			other.shared_.reset(
+				other.data_,
+				[bytes = other.capacity_, category = other.mem_category_](const uint8_t* data)
+				{
+					memstats::freed(category, bytes);
+					delete[] data;
+				});
+		shared_ = other.shared_;
 	}
 
-	// Update variables
-	size_ = new_size;
-
-	// Check position
-	if (cur_ptr_ > size_)
-		cur_ptr_ = size_;
+	data_     = other.data_ + offset;
+	size_     = size;
+	capacity_ = size_;
+	cur_ptr_  = 0;
 
 	return true;
 }
@@ -201,6 +287,31 @@ bool MemChunk::importFile(string_view filename, uint32_t offset, uint32_t len)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Maps the file at [filename] into memory rather than reading it all in.
+// File data is only read from disk as it is accessed, and is copied on write
+// (any changes to the data will not affect the file).
+// Falls back to importFile if the file couldn't be mapped.
+// Returns false if the file couldn't be opened, true otherwise
+// -----------------------------------------------------------------------------
+bool MemChunk::mapFile(string_view filename)
+{
+	// Clear current data if it exists
+	clear();
+
+	auto mapping = std::make_shared<MappedFile>(filename);
+	if (!mapping->isOpen())
+		return importFile(filename);
+
+	mapping_  = mapping;
+	data_     = mapping_->data();
+	size_     = mapping_->size();
+	capacity_ = size_;
+	cur_ptr_  = 0;
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Loads a file (or part of it) from a currently open file stream into memory.
 // Returns false if file couldn't be opened, true otherwise
@@ -371,13 +482,13 @@ bool MemChunk::write(unsigned offset, const void* data, unsigned size, bool expa
 	// (or return false if expanding is disallowed)
 	if (offset + size > size_)
 	{
-		if (expand)
-			reSize(offset + size, true);
-		else
+		if (!expand || !grow(offset + size))
 			return false;
 	}
 
 	// Write the data
+	if (!unshare())
+		return false;
 	memcpy(data_ + offset, data, size);
 
 	// Success
@@ -417,10 +528,12 @@ bool MemChunk::write(const void* buffer, uint32_t count)
 
 	// If we're trying to write past the end of the memory chunk,
 	// resize it so we can write at this point
-	if (cur_ptr_ + count > size_)
-		reSize(cur_ptr_ + count, true);
+	if (cur_ptr_ + count > size_ && !grow(cur_ptr_ + count))
+		return false;
 
 	// Write the data and move to the byte after what was written
+	if (!unshare())
+		return false;
 	memcpy(data_ + cur_ptr_, buffer, count);
 	cur_ptr_ += count;
 
@@ -529,13 +642,15 @@ bool MemChunk::readMC(MemChunk& mc, uint32_t size)
 // Overwrites all data bytes with [val] (basically is memset).
 // Returns false if no data exists, true otherwise
 // -----------------------------------------------------------------------------
-bool MemChunk::fillData(uint8_t val) const
+bool MemChunk::fillData(uint8_t val)
 {
 	// Check data exists
 	if (!hasData())
 		return false;
 
 	// Fill data with value
+	if (!unshare())
+		return false;
 	memset(data_, val, size_);
 
 	// Success
@@ -586,15 +701,82 @@ uint8_t* MemChunk::allocData(uint32_t size, bool set_data)
 
 		if (set_data)
 		{
-			cur_ptr_ = 0;
-			size_    = 0;
+			cur_ptr_  = 0;
+			size_     = 0;
+			capacity_ = 0;
 		}
 
 		return nullptr;
 	}
 
+	memstats::allocated(mem_category_, size);
+
 	if (set_data)
-		data_ = ndata;
+	{
+		data_     = ndata;
+		capacity_ = size;
+	}
 
 	return ndata;
 }
+
+// -----------------------------------------------------------------------------
+// Frees the current data (or releases the file mapping/shared data if it is
+// mapped or shared). Does not reset the data pointer or size
+// -----------------------------------------------------------------------------
+void MemChunk::freeData()
+{
+	if (mapping_)
+		mapping_.reset();
+	else if (shared_)
+		shared_.reset();
+	else if (data_)
+	{
+		memstats::freed(mem_category_, capacity_);
+		delete[] data_;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Expands the chunk to [new_size], preserving existing data. If more memory is
+// needed, the capacity is grown geometrically so that many small writes past
+// the end don't each cause a reallocation.
+// Returns false if allocation failed, true otherwise
+// -----------------------------------------------------------------------------
+bool MemChunk::grow(uint32_t new_size)
+{
+	if (new_size > capacity_)
+	{
+		// Grow by 1.5x (at least 64 bytes), limited to the maximum size
+		static constexpr uint64_t max_capacity = 0xFFFFFFFF;
+		const uint64_t            grow_size    = std::max<uint64_t>(capacity_ + capacity_ / 2, 64);
+		const auto                capacity     = std::min(std::max<uint64_t>(grow_size, new_size), max_capacity);
+		if (!reserve(static_cast<uint32_t>(capacity)))
+			return false;
+	}
+
+	size_ = new_size;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Copies the current data to newly allocated memory owned only by this chunk,
+// so that it can be modified without affecting any other chunks it is shared
+// with (see share).
+// Returns false if allocation failed, true otherwise
+// -----------------------------------------------------------------------------
+bool MemChunk::copySharedData()
+{
+	auto ndata = allocData(std::max<uint32_t>(size_, 1), false);
+	if (!ndata)
+		return false;
+	if (size_ > 0)
+		memcpy(ndata, data_, size_);
+	freeData();
+
+	data_     = ndata;
+	capacity_ = std::max<uint32_t>(size_, 1);
+
+	return true;
+}
@@ -1,10 +1,12 @@
 #pragma once
 
+#include "General/MemoryStats.h"
 #include "SeekableData.h"
 
 namespace slade
 {
 class SFile;
+class MappedFile;
 
 class MemChunk : public SeekableData
 {
@@ -12,34 +14,51 @@ public:
 	MemChunk() = default;
 	MemChunk(uint32_t size);
 	MemChunk(const uint8_t* data, uint32_t size);
+	explicit MemChunk(memstats::Category category) : mem_category_{ category } {}
 	~MemChunk() override;
 
-	uint8_t& operator[](int a) const { return data_[a]; }
+	const uint8_t& operator[](int a) const { return data_[a]; }
+	uint8_t&       operator[](int a)
+	{
+		unshare();
+		return data_[a];
+	}
 
 	// Accessors
 	const uint8_t* data() const { return data_; }
-	uint8_t*       data() { return data_; }
+	uint8_t*       data()
+	{
+		unshare();
+		return data_;
+	}
 
 	// SeekableData
 	unsigned size() const override { return size_; }
 	unsigned currentPos() const override { return cur_ptr_; }
-	bool     seek(unsigned offset) override { return seek(offset, SEEK_CUR); }
-	bool     seekFromStart(unsigned offset) override { return seek(offset, SEEK_SET); }
-	bool     seekFromEnd(unsigned offset) override { return seek(offset, SEEK_END); }
+	bool     seek(uint64_t offset) override { return seek(clampOffset(offset), SEEK_CUR); }
+	bool     seekFromStart(uint64_t offset) override { return seek(clampOffset(offset), SEEK_SET); }
+	bool     seekFromEnd(uint64_t offset) override { return seek(clampOffset(offset), SEEK_END); }
 	bool     read(void* buffer, unsigned count) override;
 	bool     write(const void* buffer, unsigned count) override;
 
 	bool hasData() const;
+	bool isMapped() const { return mapping_ != nullptr; }
+	bool isShared() const { return shared_.use_count() > 1 || mapping_.use_count() > 1; }
 
-	bool clear();
-	bool reSize(uint32_t new_size, bool preserve_data = true);
+	bool     clear();
+	bool     reSize(uint32_t new_size, bool preserve_data = true);
+	bool     reserve(uint32_t capacity);
+	uint32_t capacity() const { return capacity_; }
+	void     setMemCategory(memstats::Category category);
 
 	// Data import
 	bool importFile(string_view filename, uint32_t offset = 0, uint32_t len = 0);
+	bool mapFile(string_view filename);
 	bool importFileStreamWx(wxFile& file, uint32_t len = 0);
 	bool importFileStream(SFile& file, unsigned len = 0);
 	bool importMem(const uint8_t* start, uint32_t len);
 	bool importMem(const MemChunk& other) { return importMem(other.data_, other.size_); }
+	bool share(const MemChunk& other, uint32_t offset = 0, uint32_t size = 0);
 
 	// Data export
 	bool exportFile(string_view filename, uint32_t start = 0, uint32_t size = 0) const;
@@ -58,7 +77,7 @@ public:
 	bool readMC(MemChunk& mc, uint32_t size);
 
 	// Misc
-	bool     fillData(uint8_t val) const;
+	bool     fillData(uint8_t val);
 	uint32_t crc() const;
 	string   asString(uint32_t offset = 0, uint32_t length = 0) const;
 
@@ -77,10 +96,30 @@ public:
 	}
 
 protected:
-	uint8_t* data_    = nullptr;
-	uint32_t cur_ptr_ = 0;
-	uint32_t size_    = 0;
+	uint8_t* data_     = nullptr;
+	uint32_t cur_ptr_  = 0;
+	uint32_t size_     = 0;
+	uint32_t capacity_ = 0; // Allocated size of data_, can be larger than size_
+
+	// The category allocated data is counted under (see MemoryStats.h)
+	memstats::Category mem_category_ = memstats::Category::Data;
+
+	// If set, data_ points to the mapped file data rather than allocated memory
+	shared_ptr<MappedFile> mapping_;
+
+	// If set, data_ is owned by this and may be shared with other MemChunks
+	// (see share), in which case it is copied before being modified.
+	// Mutable since sharing moves a chunk's data into shared ownership without
+	// changing the data itself
+	mutable shared_ptr<uint8_t> shared_;
 
 	uint8_t* allocData(uint32_t size, bool set_data = true);
+	void     freeData();
+	bool     grow(uint32_t new_size);
+	bool     unshare() { return !isShared() || copySharedData(); }
+	bool     copySharedData();
+
+	// Offsets past the end of the chunk are clamped when seeking anyway
+	uint32_t clampOffset(uint64_t offset) const { return static_cast<uint32_t>(std::min<uint64_t>(offset, size_)); }
 };
 } // namespace slade
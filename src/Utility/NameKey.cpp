@@ -0,0 +1,109 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    NameKey.cpp
+// Description: NameKey class - a case-insensitive integer handle for a
+//              texture/flat/lump name
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "NameKey.h"
+#include "StringUtils.h"
+#include <mutex>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Interned (long or non-ASCII) names, in upper case. Names can be interned
+// from background threads (eg. when parsing maps) so access is locked
+std::mutex                           intern_mutex;
+std::unordered_map<string, uint64_t> intern_ids;
+vector<string>                       intern_names;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// NameKey Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// NameKey class constructor.
+// Any zero padding at the end of [name] is ignored, as with lump names in wad
+// directories
+// -----------------------------------------------------------------------------
+NameKey::NameKey(string_view name)
+{
+	while (!name.empty() && name.back() == 0)
+		name.remove_suffix(1);
+	if (name.empty())
+		return;
+
+	// Pack short ASCII names
+	if (name.size() <= 8 && std::none_of(name.begin(), name.end(), [](char c) { return c & 0x80; }))
+	{
+		value_ = strutil::lumpNameKey(name);
+		return;
+	}
+
+	// Intern anything else
+	auto name_upper = strutil::upper(name);
+
+	std::lock_guard lock(intern_mutex);
+	auto [i, inserted] = intern_ids.try_emplace(name_upper, INTERNED | intern_names.size());
+	if (inserted)
+		intern_names.push_back(std::move(name_upper));
+	value_ = i->second;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the (upper case) name the key was created from
+// -----------------------------------------------------------------------------
+string NameKey::name() const
+{
+	if (empty())
+		return {};
+
+	if (isInterned())
+	{
+		std::lock_guard lock(intern_mutex);
+		return intern_names[value_ & ~INTERNED];
+	}
+
+	char packed[8];
+	memcpy(packed, &value_, 8);
+	return string{ strutil::viewFromChars(packed, 8) };
+}
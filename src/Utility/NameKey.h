@@ -0,0 +1,40 @@
+#pragma once
+
+namespace slade
+{
+// NameKey: A case-insensitive handle for a texture/flat/lump name, so that
+// names can be compared, sorted and hashed as integers.
+// Names of up to 8 ASCII characters (ie. almost all doom format names) are
+// packed (upper case) into the 64-bit value itself, anything else is interned
+// in a global table and identified by its index in the table
+class NameKey
+{
+public:
+	NameKey() = default;
+	explicit NameKey(string_view name);
+
+	uint64_t value() const { return value_; }
+	bool     empty() const { return value_ == 0; }
+	bool     isInterned() const { return (value_ & INTERNED) != 0; }
+	string   name() const;
+
+	bool operator==(const NameKey& other) const { return value_ == other.value_; }
+	bool operator!=(const NameKey& other) const { return value_ != other.value_; }
+	bool operator<(const NameKey& other) const { return value_ < other.value_; }
+
+private:
+	// Set for interned names (packed ASCII names never have the high bit set
+	// in any byte)
+	static constexpr uint64_t INTERNED = 0x8000000000000000ull;
+
+	uint64_t value_ = 0;
+};
+} // namespace slade
+
+namespace std
+{
+template<> struct hash<slade::NameKey>
+{
+	size_t operator()(const slade::NameKey& key) const noexcept { return hash<uint64_t>{}(key.value()); }
+};
+} // namespace std
@@ -40,6 +40,53 @@
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr uint32_t BINARY_MAGIC   = 0x4e425450; // "PTBN"
+constexpr uint16_t BINARY_VERSION = 1;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Writes [str] to [mc] as a 32bit length followed by its characters
+// -----------------------------------------------------------------------------
+void writeString(MemChunk& mc, string_view str)
+{
+	auto length = static_cast<uint32_t>(str.size());
+	mc.write(&length, 4);
+	if (length > 0)
+		mc.write(str.data(), length);
+}
+
+// -----------------------------------------------------------------------------
+// Reads a string written by writeString from [mc] into [str].
+// Returns false if there isn't enough data
+// -----------------------------------------------------------------------------
+bool readString(MemChunk& mc, string& str)
+{
+	uint32_t length;
+	if (!mc.read(&length, 4) || length > mc.size() - mc.currentPos())
+		return false;
+
+	str.assign(reinterpret_cast<const char*>(mc.data() + mc.currentPos()), length);
+	mc.seek(length);
+	return true;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // ParseTreeNode Class Functions
@@ -56,6 +103,16 @@ ParseTreeNode::ParseTreeNode(ParseTreeNode* parent, Parser* parser, ArchiveDir*
 	allowDup(true);
 }
 
+// -----------------------------------------------------------------------------
+// ParseTreeNode class destructor
+// -----------------------------------------------------------------------------
+ParseTreeNode::~ParseTreeNode()
+{
+	// Children in an arena are deleted along with the arena
+	if (arena_)
+		children_.clear();
+}
+
 // -----------------------------------------------------------------------------
 // Returns true if the node's name matches [name] (case-insensitive)
 // -----------------------------------------------------------------------------
@@ -153,11 +210,22 @@ double ParseTreeNode::floatValue(unsigned index) const
 // -----------------------------------------------------------------------------
 ParseTreeNode* ParseTreeNode::addChildPTN(string_view name, string_view type)
 {
-	auto* node  = dynamic_cast<ParseTreeNode*>(addChild(name));
+	auto* node  = static_cast<ParseTreeNode*>(addChild(name));
 	node->type_ = type;
 	return node;
 }
 
+// -----------------------------------------------------------------------------
+// Creates a child ParseTreeNode of [name], in the same arena as this node if
+// it is in one
+// -----------------------------------------------------------------------------
+STreeNode* ParseTreeNode::createChild(string_view name)
+{
+	auto* child = arena_ ? arena_->create(parser_) : new ParseTreeNode(nullptr, parser_);
+	child->setName(name);
+	return child;
+}
+
 // -----------------------------------------------------------------------------
 // Writes an error log message [error], showing the source and current line
 // from tokenizer [tz]
@@ -176,7 +244,7 @@ bool ParseTreeNode::parsePreprocessor(Tokenizer& tz)
 
 	// #define
 	if (tz.current() == "#define")
-		parser_->define(tz.next().text);
+		parser_->define(tz.next().view());
 
 	// #if(n)def
 	else if (tz.current() == "#ifdef" || tz.current() == "#ifndef")
@@ -185,7 +253,7 @@ bool ParseTreeNode::parsePreprocessor(Tokenizer& tz)
 		bool test = true;
 		if (tz.current() == "#ifndef")
 			test = false;
-		auto define = tz.next().text;
+		auto define = tz.next().view();
 		if (parser_->defined(define) == test)
 			return true;
 
@@ -214,7 +282,7 @@ bool ParseTreeNode::parsePreprocessor(Tokenizer& tz)
 		if (archive_dir_)
 		{
 			// Get entry to include
-			auto  inc_path  = tz.next().text;
+			auto  inc_path  = string{ tz.next().view() };
 			auto* archive   = archive_dir_->archive();
 			auto* inc_entry = archive->entryAtPath(archive_dir_->path() + inc_path);
 			log::info("Looking for #include entry '{}' / '{}'", archive_dir_->path(), inc_path);
@@ -231,6 +299,7 @@ bool ParseTreeNode::parsePreprocessor(Tokenizer& tz)
 
 				// Parse text in the entry
 				Tokenizer inc_tz;
+				inc_tz.enableZeroCopy(tz.zeroCopy());
 				inc_tz.openMem(inc_entry->data(), inc_entry->name());
 				bool ok = parse(inc_tz);
 
@@ -254,7 +323,7 @@ bool ParseTreeNode::parsePreprocessor(Tokenizer& tz)
 
 	// Unrecognised
 	else
-		logError(tz, fmt::format("Unrecognised preprocessor directive \"{}\"", tz.current().text));
+		logError(tz, fmt::format("Unrecognised preprocessor directive \"{}\"", tz.current().view()));
 
 	return true;
 }
@@ -286,7 +355,7 @@ bool ParseTreeNode::parseAssignment(Tokenizer& tz, ParseTreeNode* child) const
 
 		// Detect value type
 		if (token.quoted_string) // Quoted string
-			value = token.text;
+			value = string{ token.view() };
 		else if (token == "true") // Boolean (true)
 			value = true;
 		else if (token == "false") // Boolean (false)
@@ -294,11 +363,11 @@ bool ParseTreeNode::parseAssignment(Tokenizer& tz, ParseTreeNode* child) const
 		else if (token.isInteger()) // Integer
 			value = token.asInt();
 		else if (token.isHex()) // Hex (0xXXXXXX)
-			value = strutil::asInt({ token.text.data() + 2, token.text.size() - 2 }, 16);
+			value = strutil::asInt(token.view().substr(2), 16);
 		else if (token.isFloat()) // Floating point
 			value = token.asFloat();
 		else // Unknown, just treat as string
-			value = token.text;
+			value = string{ token.view() };
 
 		// Add value
 		child->values_.push_back(value);
@@ -308,7 +377,7 @@ bool ParseTreeNode::parseAssignment(Tokenizer& tz, ParseTreeNode* child) const
 			tz.adv(); // Skip it
 		else if (tz.peek() != list_end)
 		{
-			logError(tz, fmt::format(R"(Expected "," or "{}", got "{}")", list_end, tz.peek().text));
+			logError(tz, fmt::format(R"(Expected "," or "{}", got "{}")", list_end, tz.peek().view()));
 			return false;
 		}
 
@@ -346,14 +415,14 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 		}
 
 		// If it's a special character (ie not a valid name), parsing fails
-		if (tz.isSpecialCharacter(tz.current().text[0]))
+		if (tz.isSpecialCharacter(tz.current()[0]))
 		{
-			logError(tz, fmt::format("Unexpected special character '{}'", tz.current().text));
+			logError(tz, fmt::format("Unexpected special character '{}'", tz.current().view()));
 			return false;
 		}
 
 		// So we have either a node or property name
-		name = tz.current().text;
+		name = tz.current().view();
 		type.clear();
 		if (name.empty())
 		{
@@ -365,7 +434,7 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 		if (tz.peek() != '=' && tz.peek() != '{' && tz.peek() != ';' && tz.peek() != ':')
 		{
 			type = name;
-			name = tz.next().text;
+			name = tz.next().view();
 
 			if (name.empty())
 			{
@@ -407,7 +476,7 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 			{
 				// Add child node
 				auto* child     = addChildPTN(name, type);
-				child->inherit_ = tz.current().text;
+				child->inherit_ = tz.current().view();
 
 				// Skip {
 				tz.adv(2);
@@ -420,7 +489,7 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 			{
 				// Add child node
 				auto* child     = addChildPTN(name, type);
-				child->inherit_ = tz.current().text;
+				child->inherit_ = tz.current().view();
 
 				// Skip ;
 				tz.adv(2);
@@ -429,7 +498,7 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 			}
 			else
 			{
-				logError(tz, fmt::format(R"(Expecting "{{" or ";", got "{}")", tz.next().text));
+				logError(tz, fmt::format(R"(Expecting "{{" or ";", got "{}")", tz.next().view()));
 				return false;
 			}
 		}
@@ -437,7 +506,7 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 		// Unexpected token
 		else
 		{
-			logError(tz, fmt::format("Unexpected token \"{}\"", tz.next().text));
+			logError(tz, fmt::format("Unexpected token \"{}\"", tz.next().view()));
 			return false;
 		}
 
@@ -525,13 +594,191 @@ void ParseTreeNode::write(string& out, int indent) const
 		out += "\n" + tabs + "{\n";
 
 		for (auto* node : children_)
-			dynamic_cast<ParseTreeNode*>(node)->write(out, indent + 1);
+			static_cast<ParseTreeNode*>(node)->write(out, indent + 1);
 
 		// Closing brace
 		out += tabs + "}\n";
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Writes this node and its children to [mc] in a compact binary form, which
+// can be read back with readBinary much faster than parsing the text
+// -----------------------------------------------------------------------------
+void ParseTreeNode::writeBinary(MemChunk& mc) const
+{
+	using Type = property::ValueType;
+
+	writeString(mc, name_);
+	writeString(mc, type_);
+	writeString(mc, inherit_);
+
+	// Values
+	auto count = static_cast<uint32_t>(values_.size());
+	mc.write(&count, 4);
+	for (const auto& value : values_)
+	{
+		auto type = static_cast<uint8_t>(value.index());
+		mc.write(&type, 1);
+		switch (property::valueType(value))
+		{
+		case Type::Bool:
+		{
+			uint8_t b = std::get<bool>(value) ? 1 : 0;
+			mc.write(&b, 1);
+			break;
+		}
+		case Type::Int:
+		{
+			auto i = static_cast<int32_t>(std::get<int>(value));
+			mc.write(&i, 4);
+			break;
+		}
+		case Type::UInt:
+		{
+			auto u = static_cast<uint32_t>(std::get<unsigned>(value));
+			mc.write(&u, 4);
+			break;
+		}
+		case Type::Float: mc.write(&std::get<double>(value), 8); break;
+		case Type::String: writeString(mc, std::get<string>(value)); break;
+		}
+	}
+
+	// Children
+	count = static_cast<uint32_t>(children_.size());
+	mc.write(&count, 4);
+	for (auto* child : children_)
+		static_cast<ParseTreeNode*>(child)->writeBinary(mc);
+}
+
+// -----------------------------------------------------------------------------
+// Reads this node and its children from [mc], as written by writeBinary.
+// Returns false if the data is invalid (the node may be partially read)
+// -----------------------------------------------------------------------------
+bool ParseTreeNode::readBinary(MemChunk& mc)
+{
+	using Type = property::ValueType;
+
+	if (!readString(mc, name_) || !readString(mc, type_) || !readString(mc, inherit_))
+		return false;
+
+	// Values (each is at least 2 bytes, so a count larger than the remaining
+	// data must be invalid)
+	uint32_t count;
+	if (!mc.read(&count, 4) || count > mc.size() - mc.currentPos())
+		return false;
+	values_.clear();
+	values_.reserve(count);
+	for (unsigned a = 0; a < count; ++a)
+	{
+		uint8_t type;
+		if (!mc.read(&type, 1))
+			return false;
+
+		switch (static_cast<Type>(type))
+		{
+		case Type::Bool:
+		{
+			uint8_t b;
+			if (!mc.read(&b, 1))
+				return false;
+			values_.emplace_back(b != 0);
+			break;
+		}
+		case Type::Int:
+		{
+			int32_t i;
+			if (!mc.read(&i, 4))
+				return false;
+			values_.emplace_back(static_cast<int>(i));
+			break;
+		}
+		case Type::UInt:
+		{
+			uint32_t u;
+			if (!mc.read(&u, 4))
+				return false;
+			values_.emplace_back(static_cast<unsigned>(u));
+			break;
+		}
+		case Type::Float:
+		{
+			double d;
+			if (!mc.read(&d, 8))
+				return false;
+			values_.emplace_back(d);
+			break;
+		}
+		case Type::String:
+		{
+			string str;
+			if (!readString(mc, str))
+				return false;
+			values_.emplace_back(std::move(str));
+			break;
+		}
+		default: return false;
+		}
+	}
+
+	// Children (added directly, since names aren't paths here)
+	if (!mc.read(&count, 4) || count > mc.size() - mc.currentPos())
+		return false;
+	children_.reserve(children_.size() + count);
+	for (unsigned a = 0; a < count; ++a)
+	{
+		auto* child = static_cast<ParseTreeNode*>(createChild({}));
+		addChild(child);
+		if (!child->readBinary(mc))
+			return false;
+	}
+
+	return true;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// ParseTreeArena Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Creates a new (parentless) ParseTreeNode in the arena. The node and any
+// children created for it are deleted when the arena is cleared
+// -----------------------------------------------------------------------------
+ParseTreeNode* ParseTreeArena::create(Parser* parser, ArchiveDir* archive_dir, string_view type)
+{
+	// Add a new block if needed (not value-initialised, nodes are constructed
+	// in place as needed)
+	if (blocks_.empty() || blocks_.back()->count == BLOCK_NODES)
+		blocks_.emplace_back(new Block);
+
+	auto& block = *blocks_.back();
+	auto* node  = new (block.data + sizeof(ParseTreeNode) * block.count)
+		ParseTreeNode(nullptr, parser, archive_dir, type);
+	node->arena_ = this;
+	++block.count;
+
+	return node;
+}
+
+// -----------------------------------------------------------------------------
+// Deletes all nodes in the arena
+// -----------------------------------------------------------------------------
+void ParseTreeArena::clear()
+{
+	// Nodes in an arena don't delete their children, so they can be destroyed
+	// in any order
+	for (auto& block : blocks_)
+		for (unsigned a = 0; a < block->count; ++a)
+			block->node(a)->~ParseTreeNode();
+
+	blocks_.clear();
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -543,10 +790,10 @@ void ParseTreeNode::write(string& out, int indent) const
 // -----------------------------------------------------------------------------
 // Parser class constructor
 // -----------------------------------------------------------------------------
-Parser::Parser(ArchiveDir* dir_root) : archive_dir_root_{ dir_root }
+Parser::Parser(ArchiveDir* dir_root) : arena_{ new ParseTreeArena }, archive_dir_root_{ dir_root }
 {
 	// Create parse tree root node
-	pt_root_ = std::make_unique<ParseTreeNode>(nullptr, this, archive_dir_root_);
+	pt_root_ = arena_->create(this, archive_dir_root_);
 }
 
 // -----------------------------------------------------------------------------
@@ -589,6 +836,7 @@ bool Parser::parseText(MemChunk& mc, string_view source) const
 
 	// Open the given text data
 	tz.setReadLowerCase(!case_sensitive_);
+	tz.enableZeroCopy(true);
 	if (!tz.openMem(mc, source))
 	{
 		log::error("Unable to open text data for parsing");
@@ -604,6 +852,7 @@ bool Parser::parseText(string_view text, string_view source) const
 
 	// Open the given text data
 	tz.setReadLowerCase(!case_sensitive_);
+	tz.enableZeroCopy(true);
 	if (!tz.openString(text, 0, 0, source))
 	{
 		log::error("Unable to open text data for parsing");
@@ -633,3 +882,45 @@ bool Parser::defined(string_view def) const
 
 	return false;
 }
+
+// -----------------------------------------------------------------------------
+// Deletes the parse tree (all nodes at once) and starts a new empty one
+// -----------------------------------------------------------------------------
+void Parser::clear()
+{
+	arena_->clear();
+	pt_root_ = arena_->create(this, archive_dir_root_);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the parse tree to [mc] in a compact binary form (see
+// ParseTreeNode::writeBinary)
+// -----------------------------------------------------------------------------
+void Parser::writeBinary(MemChunk& mc) const
+{
+	mc.write(&BINARY_MAGIC, 4);
+	mc.write(&BINARY_VERSION, 2);
+	pt_root_->writeBinary(mc);
+}
+
+// -----------------------------------------------------------------------------
+// Replaces the parse tree with one read from [mc], as written by writeBinary.
+// Returns false (with an empty tree) if the data is invalid or from a
+// different version
+// -----------------------------------------------------------------------------
+bool Parser::readBinary(MemChunk& mc)
+{
+	clear();
+
+	uint32_t magic   = 0;
+	uint16_t version = 0;
+	mc.seekFromStart(0);
+	if (!mc.read(&magic, 4) || !mc.read(&version, 2) || magic != BINARY_MAGIC || version != BINARY_VERSION
+		|| !pt_root_->readBinary(mc))
+	{
+		clear();
+		return false;
+	}
+
+	return true;
+}
@@ -7,6 +7,7 @@ namespace slade
 {
 class ArchiveDir;
 class Parser;
+class ParseTreeArena;
 class Tokenizer;
 
 class ParseTreeNode : public STreeNode
@@ -17,7 +18,7 @@ public:
 		Parser*        parser      = nullptr,
 		ArchiveDir*    archive_dir = nullptr,
 		string_view    type        = "");
-	~ParseTreeNode() override = default;
+	~ParseTreeNode() override;
 
 	const string& name() const override { return name_; }
 	void          setName(string_view name) override { name_ = name; }
@@ -39,9 +40,10 @@ public:
 	bool           boolValue(unsigned index = 0) const;
 	double         floatValue(unsigned index = 0) const;
 
-	// To avoid need for casts everywhere
-	ParseTreeNode* childPTN(string_view name) const { return dynamic_cast<ParseTreeNode*>(child(name)); }
-	ParseTreeNode* childPTN(unsigned index) const { return dynamic_cast<ParseTreeNode*>(child(index)); }
+	// To avoid need for casts everywhere (all children of a ParseTreeNode are ParseTreeNodes)
+	ParseTreeNode* parentPTN() const { return static_cast<ParseTreeNode*>(parent_); }
+	ParseTreeNode* childPTN(string_view name) const { return static_cast<ParseTreeNode*>(child(name)); }
+	ParseTreeNode* childPTN(unsigned index) const { return static_cast<ParseTreeNode*>(child(index)); }
 
 	ParseTreeNode* addChildPTN(string_view name, string_view type = "");
 	void           addStringValue(string_view value) { values_.emplace_back(string{ value }); }
@@ -51,15 +53,11 @@ public:
 
 	bool parse(Tokenizer& tz);
 	void write(string& out, int indent = 0) const;
+	void writeBinary(MemChunk& mc) const;
+	bool readBinary(MemChunk& mc);
 
 protected:
-	STreeNode* createChild(string_view name) override
-	{
-		auto ret = new ParseTreeNode();
-		ret->setName(name);
-		ret->parser_ = parser_;
-		return ret;
-	}
+	STreeNode* createChild(string_view name) override;
 
 private:
 	string           name_;
@@ -68,19 +66,54 @@ private:
 	vector<Property> values_;
 	Parser*          parser_      = nullptr;
 	ArchiveDir*      archive_dir_ = nullptr;
+	ParseTreeArena*  arena_       = nullptr; // If set, this node and its children are owned by the arena
+
+	friend class ParseTreeArena;
 
 	void logError(const Tokenizer& tz, string_view error) const;
 	bool parsePreprocessor(Tokenizer& tz);
 	bool parseAssignment(Tokenizer& tz, ParseTreeNode* child) const;
 };
 
+// Allocates ParseTreeNodes in large blocks, so a parse tree can be built
+// without a heap allocation per node and released all at once
+class ParseTreeArena
+{
+public:
+	ParseTreeArena() = default;
+	~ParseTreeArena() { clear(); }
+
+	// Non-copyable (owns the nodes)
+	ParseTreeArena(const ParseTreeArena&) = delete;
+	ParseTreeArena& operator=(const ParseTreeArena&) = delete;
+
+	ParseTreeNode* create(Parser* parser = nullptr, ArchiveDir* archive_dir = nullptr, string_view type = "");
+	void           clear();
+
+private:
+	static constexpr unsigned BLOCK_NODES = 256;
+
+	struct Block
+	{
+		alignas(ParseTreeNode) std::byte data[sizeof(ParseTreeNode) * BLOCK_NODES];
+		unsigned count = 0;
+
+		ParseTreeNode* node(unsigned index)
+		{
+			return std::launder(reinterpret_cast<ParseTreeNode*>(data + sizeof(ParseTreeNode) * index));
+		}
+	};
+
+	vector<unique_ptr<Block>> blocks_;
+};
+
 class Parser
 {
 public:
 	Parser(ArchiveDir* dir_root = nullptr);
 	~Parser() = default;
 
-	ParseTreeNode* parseTreeRoot() const { return pt_root_.get(); }
+	ParseTreeNode* parseTreeRoot() const { return pt_root_; }
 
 	void setCaseSensitive(bool cs) { case_sensitive_ = cs; }
 
@@ -88,14 +121,18 @@ public:
 	bool parseText(string_view text, string_view source = "string") const;
 	void define(string_view def);
 	bool defined(string_view def) const;
+	void clear();
+	void writeBinary(MemChunk& mc) const;
+	bool readBinary(MemChunk& mc);
 
 	// To simplify casts from STreeNode to ParseTreeNode
-	static ParseTreeNode* node(STreeNode* node) { return dynamic_cast<ParseTreeNode*>(node); }
+	static ParseTreeNode* node(STreeNode* node) { return static_cast<ParseTreeNode*>(node); }
 
 private:
-	unique_ptr<ParseTreeNode> pt_root_;
-	vector<string>            defines_;
-	ArchiveDir*               archive_dir_root_ = nullptr;
-	bool                      case_sensitive_   = false;
+	unique_ptr<ParseTreeArena> arena_;
+	ParseTreeNode*             pt_root_ = nullptr;
+	vector<string>             defines_;
+	ArchiveDir*                archive_dir_root_ = nullptr;
+	bool                       case_sensitive_   = false;
 };
 } // namespace slade
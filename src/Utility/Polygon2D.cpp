@@ -36,6 +36,7 @@
 #include "MathStuff.h"
 #include "OpenGL/GLTexture.h"
 #include "OpenGL/OpenGL.h"
+#include "OpenGL/Shader.h"
 #include "SLADEMap/SLADEMap.h"
 
 using namespace slade;
@@ -278,6 +279,22 @@ void Polygon2D::renderVBO(unsigned offset) const
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Adds the first vertex index and vertex count of each sub-polygon (as written
+// to a VBO at [offset]) to [first] and [count], so that many polygons can be
+// rendered with a single glMultiDrawArrays(GL_TRIANGLE_FAN, ...) call
+// -----------------------------------------------------------------------------
+void Polygon2D::addVBORanges(unsigned offset, vector<int>& first, vector<int>& count) const
+{
+	unsigned index = offset / VERTEX_SIZE;
+	for (auto& subpoly : subpolys_)
+	{
+		first.push_back(index);
+		count.push_back(subpoly.vertices.size());
+		index += subpoly.vertices.size();
+	}
+}
+
 void Polygon2D::renderWireframeVBO(bool colour) const {}
 
 void Polygon2D::setupVBOPointers()
@@ -289,6 +306,27 @@ void Polygon2D::setupVBOPointers()
 	glDisableClientState(GL_COLOR_ARRAY);
 }
 
+// -----------------------------------------------------------------------------
+// Sets up generic vertex attribute pointers (position + texcoord) for
+// rendering polygon VBO data with a shader program
+// -----------------------------------------------------------------------------
+void Polygon2D::setupVBOAttribPointers()
+{
+	glEnableVertexAttribArray(gl::attrib::POSITION);
+	glEnableVertexAttribArray(gl::attrib::TEXCOORD);
+	glVertexAttribPointer(gl::attrib::POSITION, 3, GL_FLOAT, GL_FALSE, VERTEX_SIZE, nullptr);
+	glVertexAttribPointer(gl::attrib::TEXCOORD, 2, GL_FLOAT, GL_FALSE, VERTEX_SIZE, ((char*)nullptr + 12));
+}
+
+// -----------------------------------------------------------------------------
+// Disables the generic vertex attributes enabled by setupVBOAttribPointers
+// -----------------------------------------------------------------------------
+void Polygon2D::clearVBOAttribPointers()
+{
+	glDisableVertexAttribArray(gl::attrib::POSITION);
+	glDisableVertexAttribArray(gl::attrib::TEXCOORD);
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -300,6 +338,7 @@ void Polygon2D::setupVBOPointers()
 void PolygonSplitter::clear()
 {
 	vertices_.clear();
+	vertex_index_.clear();
 	edges_.clear();
 	polygon_outlines_.clear();
 }
@@ -307,15 +346,14 @@ void PolygonSplitter::clear()
 int PolygonSplitter::addVertex(double x, double y)
 {
 	// Check vertex doesn't exist
-	for (unsigned a = 0; a < vertices_.size(); a++)
-	{
-		if (vertices_[a].x == x && vertices_[a].y == y)
-			return a;
-	}
+	auto existing = vertex_index_.find({ x, y });
+	if (existing != vertex_index_.end())
+		return existing->second;
 
 	// Add vertex
 	vertices_.emplace_back(x, y);
 	vertices_.back().distance = 999999;
+	vertex_index_[{ x, y }] = vertices_.size() - 1;
 	return vertices_.size() - 1;
 }
 
@@ -331,11 +369,11 @@ int PolygonSplitter::addEdge(double x1, double y1, double x2, double y2)
 
 int PolygonSplitter::addEdge(int v1, int v2)
 {
-	// Check for duplicate edge
-	for (unsigned a = 0; a < edges_.size(); a++)
+	// Check for duplicate edge (only need to check edges already leaving v1)
+	for (auto e : vertices_[v1].edges_out)
 	{
-		if (edges_[a].v1 == v1 && edges_[a].v2 == v2)
-			return a;
+		if (edges_[e].v2 == v2)
+			return e;
 	}
 
 	// Create edge
@@ -583,11 +621,13 @@ bool PolygonSplitter::tracePolyOutline(int edge_start)
 	poly.convex     = true;
 	double edge_sum = 0;
 
-	int edge = edge_start;
-	int v1, v2, next;
-	// while (true) {
+	// A valid outline can't have more edges than there are in total, so stop
+	// there (rather than looping for ages on a degenerate sector)
+	int      edge  = edge_start;
+	unsigned limit = edges_.size() + 1;
+	int      v1, v2, next;
 	unsigned a = 0;
-	for (a = 0; a < 100000; a++)
+	for (a = 0; a < limit; a++)
 	{
 		v1   = edges_[edge].v1;
 		v2   = edges_[edge].v2;
@@ -627,7 +667,7 @@ bool PolygonSplitter::tracePolyOutline(int edge_start)
 		edge = next;
 	}
 
-	if (a >= 99999)
+	if (a >= limit)
 	{
 		if (verbose_)
 			log::info("Possible infinite loop in tracePolyOutline");
@@ -662,14 +702,12 @@ bool PolygonSplitter::tracePolyOutline(int edge_start)
 
 bool PolygonSplitter::testTracePolyOutline(int edge_start)
 {
-	int      edge = edge_start;
-	int      v1, v2, next;
+	int      edge  = edge_start;
+	unsigned limit = edges_.size() + 1;
+	int      next;
 	unsigned a = 0;
-	for (a = 0; a < 100000; a++)
+	for (a = 0; a < limit; a++)
 	{
-		v1 = edges_[edge].v1;
-		v2 = edges_[edge].v2;
-
 		// Find the next convex edge with the lowest angle
 		next = findNextEdge(edge, false, true);
 
@@ -685,7 +723,7 @@ bool PolygonSplitter::testTracePolyOutline(int edge_start)
 		edge = next;
 	}
 
-	if (a >= 99999)
+	if (a >= limit)
 	{
 		if (verbose_)
 			log::info("Possible infinite loop in tracePolyOutline");
@@ -737,23 +775,7 @@ bool PolygonSplitter::splitFromEdge(int splitter_edge)
 
 	// See if we can split to here without crossing anything
 	// (this will be the case most of the time)
-	bool  intersect = false;
-	Vec2d pointi;
-	for (auto& edge : edges_)
-	{
-		// Ignore edge if adjacent to the vertices we are looking at
-		if (edge.v1 == closest || edge.v2 == closest || edge.v1 == v2 || edge.v2 == v2 || !edge.ok)
-			continue;
-
-		// Intersection test
-		if (math::linesIntersect(
-				Seg2d(vertices_[v2], vertices_[closest]), Seg2d(vertices_[edge.v1], vertices_[edge.v2]), pointi))
-		{
-			intersect = true;
-			break;
-		}
-	}
-	if (!intersect)
+	if (!splitCrossesEdge(v2, closest))
 	{
 		// No edge intersections, create split
 		int e1            = addEdge(v2, closest);
@@ -779,26 +801,13 @@ bool PolygonSplitter::splitFromEdge(int splitter_edge)
 	std::sort(sorted_verts.begin(), sorted_verts.end());
 	for (auto& sorted_vertex : sorted_verts)
 	{
-		int   index = sorted_vertex.index;
-		auto& vert  = vertices_[index];
+		// Already checked the closest vertex above
+		int index = sorted_vertex.index;
+		if (index == closest)
+			continue;
 
 		// Check if a split from the edge to this vertex would cross any other edges
-		intersect = false;
-		for (auto& edge : edges_)
-		{
-			// Ignore edge if adjacent to the vertices we are looking at
-			if (edge.v1 == index || edge.v2 == index || edge.v1 == v2 || edge.v2 == v2 || !edge.ok)
-				continue;
-
-			// Intersection test
-			if (math::linesIntersect(Seg2d(vertices_[v2], vert), Seg2d(vertices_[edge.v1], vertices_[edge.v2]), pointi))
-			{
-				intersect = true;
-				break;
-			}
-		}
-
-		if (!intersect)
+		if (!splitCrossesEdge(v2, index))
 		{
 			// No edge intersections, create split
 			int e1            = addEdge(v2, index);
@@ -814,6 +823,39 @@ bool PolygonSplitter::splitFromEdge(int splitter_edge)
 	return false;
 }
 
+bool PolygonSplitter::splitCrossesEdge(int v1, int v2) const
+{
+	auto& p1 = vertices_[v1];
+	auto& p2 = vertices_[v2];
+	Seg2d split(p1, p2);
+
+	// Bounding box of the split, to quickly skip edges that can't cross it
+	double min_x = std::min(p1.x, p2.x);
+	double max_x = std::max(p1.x, p2.x);
+	double min_y = std::min(p1.y, p2.y);
+	double max_y = std::max(p1.y, p2.y);
+
+	Vec2d pointi;
+	for (auto& edge : edges_)
+	{
+		// Ignore edge if adjacent to the vertices we are looking at
+		if (edge.v1 == v2 || edge.v2 == v2 || edge.v1 == v1 || edge.v2 == v1 || !edge.ok)
+			continue;
+
+		auto& e1 = vertices_[edge.v1];
+		auto& e2 = vertices_[edge.v2];
+		if (std::max(e1.x, e2.x) < min_x || std::min(e1.x, e2.x) > max_x || std::max(e1.y, e2.y) < min_y
+			|| std::min(e1.y, e2.y) > max_y)
+			continue;
+
+		// Intersection test
+		if (math::linesIntersect(split, Seg2d(e1, e2), pointi))
+			return true;
+	}
+
+	return false;
+}
+
 bool PolygonSplitter::buildSubPoly(int edge_start, Polygon2D::SubPoly* poly)
 {
 	// Check polygon was given
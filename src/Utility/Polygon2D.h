@@ -56,9 +56,12 @@ public:
 	void render() const;
 	void renderWireframe() const;
 	void renderVBO(unsigned offset) const;
+	void addVBORanges(unsigned offset, vector<int>& first, vector<int>& count) const;
 	void renderWireframeVBO(bool colour = true) const;
 
 	static void setupVBOPointers();
+	static void setupVBOAttribPointers();
+	static void clearVBOAttribPointers();
 
 private:
 	// Polygon data
@@ -95,6 +98,7 @@ public:
 	bool testTracePolyOutline(int edge_start);
 
 	bool splitFromEdge(int splitter_edge);
+	bool splitCrossesEdge(int v1, int v2) const;
 	bool buildSubPoly(int edge_start, Polygon2D::SubPoly* poly);
 	bool doSplitting(Polygon2D* poly);
 
@@ -132,12 +136,13 @@ private:
 	};
 
 	// Splitter data
-	vector<Vertex>  vertices_;
-	vector<Edge>    edges_;
-	vector<int>     concave_edges_;
-	vector<Outline> polygon_outlines_;
-	int             split_edges_start_ = 0;
-	bool            verbose_           = false;
-	double          last_angle_        = 0.;
+	vector<Vertex>                           vertices_;
+	std::map<std::pair<double, double>, int> vertex_index_;
+	vector<Edge>                             edges_;
+	vector<int>                              concave_edges_;
+	vector<Outline>                          polygon_outlines_;
+	int                                      split_edges_start_ = 0;
+	bool                                     verbose_           = false;
+	double                                   last_angle_        = 0.;
 };
 } // namespace slade
@@ -0,0 +1,173 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    PrefixTrie.cpp
+// Description: PrefixTrie class - a case-insensitive prefix tree of words for
+//              fast prefix lookups (eg. autocompletion)
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "PrefixTrie.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns [c] folded to upper case (ASCII only)
+// -----------------------------------------------------------------------------
+char fold(char c)
+{
+	return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 32) : c;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the character of trie node child [kid] is before [c]
+// -----------------------------------------------------------------------------
+bool childBefore(const std::pair<char, unsigned>& kid, char c)
+{
+	return kid.first < c;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// PrefixTrie Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Removes all words from the trie
+// -----------------------------------------------------------------------------
+void PrefixTrie::clear()
+{
+	nodes_.assign(1, Node{});
+	size_ = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [word] to the trie with [type] and [custom] flag, if it isn't already
+// in the trie with the same type and flag
+// -----------------------------------------------------------------------------
+void PrefixTrie::insert(string_view word, uint8_t type, bool custom)
+{
+	if (word.empty())
+		return;
+
+	// Find or create the node for each (folded) character
+	unsigned node = 0;
+	for (auto c : word)
+	{
+		c          = fold(c);
+		auto& kids = nodes_[node].children;
+		auto  i    = std::lower_bound(kids.begin(), kids.end(), c, childBefore);
+
+		if (i != kids.end() && i->first == c)
+			node = i->second;
+		else
+		{
+			auto index = static_cast<unsigned>(nodes_.size());
+			kids.insert(i, { c, index });
+			nodes_.emplace_back(); // (invalidates kids)
+			node = index;
+		}
+	}
+
+	// Add word to the end node
+	auto& words = nodes_[node].words;
+	for (const auto& existing : words)
+		if (existing.word == word && existing.type == type && existing.custom == custom)
+			return;
+
+	words.push_back({ string{ word }, type, custom });
+	++size_;
+}
+
+// -----------------------------------------------------------------------------
+// Adds all words beginning with [prefix] (ignoring case) to [matches], in
+// case-folded order. Words added as custom are skipped unless
+// [include_custom] is true
+// -----------------------------------------------------------------------------
+void PrefixTrie::findPrefix(string_view prefix, vector<const Word*>& matches, bool include_custom) const
+{
+	unsigned node = 0;
+	for (auto c : prefix)
+	{
+		node = child(node, fold(c));
+		if (node == 0)
+			return;
+	}
+
+	collect(node, matches, include_custom);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [left] comes before [right] in case-folded order (the order
+// findPrefix returns words in)
+// -----------------------------------------------------------------------------
+bool PrefixTrie::lessFolded(string_view left, string_view right)
+{
+	return std::lexicographical_compare(
+		left.begin(),
+		left.end(),
+		right.begin(),
+		right.end(),
+		[](char a, char b) { return fold(a) < fold(b); });
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of [node]'s child for (folded) character [c], or 0 if it
+// has none (the root node is never a child)
+// -----------------------------------------------------------------------------
+unsigned PrefixTrie::child(unsigned node, char c) const
+{
+	const auto& kids = nodes_[node].children;
+	auto        i    = std::lower_bound(kids.begin(), kids.end(), c, childBefore);
+
+	return (i != kids.end() && i->first == c) ? i->second : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Adds all words at [node] and below to [matches]
+// -----------------------------------------------------------------------------
+void PrefixTrie::collect(unsigned node, vector<const Word*>& matches, bool include_custom) const
+{
+	for (const auto& word : nodes_[node].words)
+		if (include_custom || !word.custom)
+			matches.push_back(&word);
+
+	for (const auto& kid : nodes_[node].children)
+		collect(kid.second, matches, include_custom);
+}
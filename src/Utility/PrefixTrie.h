@@ -0,0 +1,44 @@
+#pragma once
+
+namespace slade
+{
+// PrefixTrie: A case-insensitive prefix tree of words, for quickly finding all
+// words beginning with a given prefix (eg. for autocompletion).
+// Words are folded to upper case, which is also how scintilla compares
+// autocompletion list items when ignoring case, so results come out in the
+// order scintilla expects
+class PrefixTrie
+{
+public:
+	struct Word
+	{
+		string  word;
+		uint8_t type   = 0; // Defined by the user of the trie (eg. autocompletion icon)
+		bool    custom = false;
+	};
+
+	PrefixTrie() = default;
+
+	bool     empty() const { return size_ == 0; }
+	unsigned size() const { return size_; }
+
+	void clear();
+	void insert(string_view word, uint8_t type = 0, bool custom = false);
+	void findPrefix(string_view prefix, vector<const Word*>& matches, bool include_custom = true) const;
+
+	static bool lessFolded(string_view left, string_view right);
+
+private:
+	struct Node
+	{
+		vector<std::pair<char, unsigned>> children; // Child node indices, sorted by character
+		vector<Word>                      words;    // Words ending at this node
+	};
+
+	vector<Node> nodes_ = { Node{} };
+	unsigned     size_  = 0;
+
+	unsigned child(unsigned node, char c) const;
+	void     collect(unsigned node, vector<const Word*>& matches, bool include_custom) const;
+};
+} // namespace slade
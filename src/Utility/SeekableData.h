@@ -10,9 +10,10 @@ public:
 	virtual unsigned currentPos() const = 0;
 	virtual unsigned size() const       = 0;
 
-	virtual bool seek(unsigned offset)          = 0;
-	virtual bool seekFromStart(unsigned offset) = 0;
-	virtual bool seekFromEnd(unsigned offset)   = 0;
+	// Offsets are 64-bit so that files larger than 4GB can be seeked through
+	virtual bool seek(uint64_t offset)          = 0;
+	virtual bool seekFromStart(uint64_t offset) = 0;
+	virtual bool seekFromEnd(uint64_t offset)   = 0;
 
 	virtual bool read(void* buffer, unsigned count)        = 0;
 	virtual bool write(const void* buffer, unsigned count) = 0;
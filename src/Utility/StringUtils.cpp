@@ -33,11 +33,18 @@
 #include "StringUtils.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
+#include "General/Console.h"
 #include "Tokenizer.h"
 #include "UI/WxUtils.h"
 #include <charconv>
+#include <cstring>
 #include <regex>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STRUTIL_SSE2
+#include <emmintrin.h>
+#endif
+
 using namespace slade;
 
 
@@ -63,6 +70,154 @@ std::regex re_float{ "^[+-]?[0-9]+[.][0-9]*([eE][+-]?[0-9]+)?$" };
 } // namespace slade::strutil
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Case conversions and comparisons below are ASCII-only - other characters
+// (including UTF8 bytes) are left unchanged, the same as tolower/toupper in
+// the "C" locale but without the per-character call overhead
+constexpr uint64_t BYTES_ONE  = 0x0101010101010101ull;
+constexpr uint64_t BYTES_HIGH = 0x8080808080808080ull;
+
+// -----------------------------------------------------------------------------
+// Returns the ASCII lower case version of [c]
+// -----------------------------------------------------------------------------
+inline char asciiLower(char c)
+{
+	return static_cast<char>(c | (static_cast<unsigned char>(c - 'A') < 26) << 5);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the ASCII upper case version of [c]
+// -----------------------------------------------------------------------------
+inline char asciiUpper(char c)
+{
+	return static_cast<char>(c ^ (static_cast<unsigned char>(c - 'a') < 26) << 5);
+}
+
+// -----------------------------------------------------------------------------
+// Returns 8 bytes read from [data] as a 64-bit word
+// -----------------------------------------------------------------------------
+inline uint64_t loadWord(const char* data)
+{
+	uint64_t word;
+	memcpy(&word, data, 8);
+	return word;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a mask with the case bit (0x20) set for each byte in [word] that is
+// an ASCII character between [first] and [last] (inclusive).
+// Each byte is checked at once by adding offsets to the low 7 bits so that the
+// high bit of each byte indicates the result (the sums can't carry into the
+// next byte)
+// -----------------------------------------------------------------------------
+inline uint64_t caseBits(uint64_t word, uint8_t first, uint8_t last)
+{
+	const auto low7       = word & ~BYTES_HIGH;
+	const auto from_first = low7 + BYTES_ONE * (0x80 - first);
+	const auto after_last = low7 + BYTES_ONE * (0x7f - last);
+	return ((from_first ^ after_last) & ~word & BYTES_HIGH) >> 2;
+}
+
+inline uint64_t lowerWord(uint64_t word)
+{
+	return word | caseBits(word, 'A', 'Z');
+}
+
+inline uint64_t upperWord(uint64_t word)
+{
+	return word ^ caseBits(word, 'a', 'z');
+}
+
+#ifdef STRUTIL_SSE2
+// -----------------------------------------------------------------------------
+// SSE2 version of caseBits above, for 16 bytes.
+// Non-ASCII bytes are negative as signed bytes so are never in range
+// -----------------------------------------------------------------------------
+inline __m128i caseBits(__m128i bytes, char first, char last)
+{
+	const auto in_range = _mm_and_si128(
+		_mm_cmpgt_epi8(bytes, _mm_set1_epi8(static_cast<char>(first - 1))),
+		_mm_cmplt_epi8(bytes, _mm_set1_epi8(static_cast<char>(last + 1))));
+	return _mm_and_si128(in_range, _mm_set1_epi8(0x20));
+}
+
+inline __m128i lowerBytes(__m128i bytes)
+{
+	return _mm_or_si128(bytes, caseBits(bytes, 'A', 'Z'));
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// Returns true if the first [size] characters of [left] and [right] are equal,
+// ignoring (ASCII) case.
+// Compares 16 bytes at a time with SSE2 (if available), then 8 bytes at a
+// time as 64-bit words
+// -----------------------------------------------------------------------------
+bool equalCIAscii(const char* left, const char* right, size_t size)
+{
+	size_t pos = 0;
+
+#ifdef STRUTIL_SSE2
+	for (; pos + 16 <= size; pos += 16)
+	{
+		const auto l = lowerBytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(left + pos)));
+		const auto r = lowerBytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(right + pos)));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(l, r)) != 0xFFFF)
+			return false;
+	}
+#endif
+
+	for (; pos + 8 <= size; pos += 8)
+		if (lowerWord(loadWord(left + pos)) != lowerWord(loadWord(right + pos)))
+			return false;
+
+	for (; pos < size; ++pos)
+		if (asciiLower(left[pos]) != asciiLower(right[pos]))
+			return false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Converts the [size] characters at [data] to (ASCII) upper case if [upper] is
+// true, otherwise lower case
+// -----------------------------------------------------------------------------
+template<bool upper> void convertCaseAscii(char* data, size_t size)
+{
+	size_t pos = 0;
+
+#ifdef STRUTIL_SSE2
+	for (; pos + 16 <= size; pos += 16)
+	{
+		auto* ptr   = reinterpret_cast<__m128i*>(data + pos);
+		auto  bytes = _mm_loadu_si128(ptr);
+		if constexpr (upper)
+			bytes = _mm_xor_si128(bytes, caseBits(bytes, 'a', 'z'));
+		else
+			bytes = _mm_or_si128(bytes, caseBits(bytes, 'A', 'Z'));
+		_mm_storeu_si128(ptr, bytes);
+	}
+#endif
+
+	for (; pos + 8 <= size; pos += 8)
+	{
+		auto word = loadWord(data + pos);
+		word      = upper ? upperWord(word) : lowerWord(word);
+		memcpy(data + pos, &word, 8);
+	}
+
+	for (; pos < size; ++pos)
+		data[pos] = upper ? asciiUpper(data[pos]) : asciiLower(data[pos]);
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // strutil Namespace Functions
@@ -99,17 +254,37 @@ bool strutil::isFloat(const string& str)
 	return std::regex_search(str, re_float);
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if [left] and [right] are equal, ignoring (ASCII) case
+// -----------------------------------------------------------------------------
 bool strutil::equalCI(string_view left, string_view right)
 {
-	const auto sz = left.size();
-	if (right.size() != sz)
-		return false;
+	return left.size() == right.size() && equalCIAscii(left.data(), right.data(), left.size());
+}
 
-	for (auto a = 0u; a < sz; ++a)
-		if (tolower(left[a]) != tolower(right[a]))
-			return false;
+// -----------------------------------------------------------------------------
+// Returns [name] as a 64-bit key for fast lump name comparisons - the first 8
+// characters of [name] in (ASCII) upper case, padded with zeros
+// -----------------------------------------------------------------------------
+uint64_t strutil::lumpNameKey(string_view name)
+{
+	char padded[8]{};
+	memcpy(padded, name.data(), std::min<size_t>(name.size(), 8));
+	return upperWord(loadWord(padded));
+}
 
-	return true;
+// -----------------------------------------------------------------------------
+// Returns true if lump names [left] and [right] are equal, ignoring (ASCII)
+// case. Names up to 8 characters long are compared as single 64-bit integers
+// -----------------------------------------------------------------------------
+bool strutil::equalLumpNameCI(string_view left, string_view right)
+{
+	if (left.size() != right.size())
+		return false;
+	if (left.size() > 8)
+		return equalCIAscii(left.data(), right.data(), left.size());
+
+	return lumpNameKey(left) == lumpNameKey(right);
 }
 
 // This one is a bit tricky - the string_view == string_view one above should be sufficient
@@ -144,20 +319,12 @@ bool strutil::startsWith(string_view str, char check)
 
 bool strutil::startsWithCI(string_view str, string_view check)
 {
-	const auto c_size = check.size();
-	if (c_size > str.size())
-		return false;
-
-	for (unsigned c = 0; c < c_size; ++c)
-		if (tolower(str[c]) != tolower(check[c]))
-			return false;
-
-	return true;
+	return check.size() <= str.size() && equalCIAscii(str.data(), check.data(), check.size());
 }
 
 bool strutil::startsWithCI(string_view str, char check)
 {
-	return !str.empty() && tolower(str[0]) == tolower(check);
+	return !str.empty() && asciiLower(str[0]) == asciiLower(check);
 }
 
 bool strutil::endsWith(string_view str, string_view check)
@@ -172,21 +339,13 @@ bool strutil::endsWith(string_view str, char check)
 
 bool strutil::endsWithCI(string_view str, string_view check)
 {
-	const auto c_size = check.size();
-	if (c_size > str.size())
-		return false;
-
-	const auto s_size = str.size();
-	for (unsigned c = 0; c < c_size; ++c)
-		if (tolower(str[s_size - c_size + c]) != tolower(check[c]))
-			return false;
-
-	return true;
+	return check.size() <= str.size()
+		   && equalCIAscii(str.data() + str.size() - check.size(), check.data(), check.size());
 }
 
-bool endsWithCI(string_view str, char check)
+bool strutil::endsWithCI(string_view str, char check)
 {
-	return !str.empty() && tolower(str.back()) == tolower(check);
+	return !str.empty() && asciiLower(str.back()) == asciiLower(check);
 }
 
 bool strutil::contains(string_view str, char check)
@@ -196,9 +355,9 @@ bool strutil::contains(string_view str, char check)
 
 bool strutil::containsCI(string_view str, char check)
 {
-	const auto lc = tolower(check);
+	const auto lc = asciiLower(check);
 	for (auto c : str)
-		if (tolower(c) == lc)
+		if (asciiLower(c) == lc)
 			return true;
 
 	return false;
@@ -213,9 +372,16 @@ bool strutil::containsCI(string_view str, string_view check)
 {
 	if (str.size() < check.size())
 		return false;
+	if (check.empty())
+		return true;
+
+	const auto first = asciiLower(check[0]);
+	const auto last  = str.size() - check.size();
+	for (size_t pos = 0; pos <= last; ++pos)
+		if (asciiLower(str[pos]) == first && equalCIAscii(str.data() + pos, check.data(), check.size()))
+			return true;
 
-	// TODO: Could be improved to avoid copying strings - it's currently unused so not a priority
-	return lower(str).find(lower(check)) != string::npos;
+	return false;
 }
 
 bool strutil::matches(string_view str, string_view match)
@@ -314,7 +480,7 @@ bool strutil::matchesCI(string_view str, string_view match)
 			if (t_pos == str.size())
 				return false; // Not found, no match
 
-			if (match[m_start + i] == '?' || tolower(str[t_pos]) == tolower(match[m_start + i]))
+			if (match[m_start + i] == '?' || asciiLower(str[t_pos]) == asciiLower(match[m_start + i]))
 				++i;
 			else if (wildcard)
 				i = 0;
@@ -380,27 +546,27 @@ string strutil::replaceFirst(string_view str, string_view from, string_view to)
 
 string& strutil::lowerIP(string& str)
 {
-	transform(str.begin(), str.end(), str.begin(), ::tolower);
+	convertCaseAscii<false>(str.data(), str.size());
 	return str;
 }
 
 string& strutil::upperIP(string& str)
 {
-	transform(str.begin(), str.end(), str.begin(), ::toupper);
+	convertCaseAscii<true>(str.data(), str.size());
 	return str;
 }
 
 string strutil::lower(string_view str)
 {
 	auto s = string{ str };
-	transform(s.begin(), s.end(), s.begin(), ::tolower);
+	convertCaseAscii<false>(s.data(), s.size());
 	return s;
 }
 
 string strutil::upper(string_view str)
 {
 	auto s = string{ str };
-	transform(s.begin(), s.end(), s.begin(), ::toupper);
+	convertCaseAscii<true>(s.data(), s.size());
 	return s;
 }
 
@@ -450,8 +616,8 @@ string& strutil::capitalizeIP(string& str)
 	if (str.empty())
 		return str;
 
-	transform(str.begin(), str.end(), str.begin(), tolower);
-	str[0] = static_cast<char>(toupper(str[0]));
+	convertCaseAscii<false>(str.data(), str.size());
+	str[0] = asciiUpper(str[0]);
 
 	return str;
 }
@@ -462,8 +628,8 @@ string strutil::capitalize(string_view str)
 		return {};
 
 	auto s = string{ str };
-	transform(s.begin(), s.end(), s.begin(), tolower);
-	s[0] = static_cast<char>(toupper(s[0]));
+	convertCaseAscii<false>(s.data(), s.size());
+	s[0] = asciiUpper(s[0]);
 	return s;
 }
 
@@ -892,7 +1058,7 @@ bool strutil::Path::filePathsMatch(string_view left, string_view right)
 				continue;
 
 			// Case-insensitive
-			if (tolower(left[a]) != tolower(right[a]))
+			if (asciiLower(left[a]) != asciiLower(right[a]))
 				return false;
 		}
 	}
@@ -1695,3 +1861,140 @@ double wxStringUtils::toDouble(const wxString& str)
 	log::error(wxString::Format("Can't convert \"%s\" to a double", str));
 	return 0.;
 }
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Benchmarks the case-insensitive string functions against simple per-character
+// tolower/toupper versions, and checks that their results match
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(benchmark_strutil, 0, false)
+{
+	constexpr unsigned count = 4096;
+	constexpr int      runs  = 200;
+
+	// Generate test strings - lump names (up to 8 characters) and longer paths,
+	// with each string paired with a random-case copy (sometimes altered)
+	uint32_t seed   = 12345;
+	auto     random = [&seed](unsigned max)
+	{
+		seed = seed * 1664525 + 1013904223;
+		return (seed >> 8) % max;
+	};
+	auto randomPair = [&](unsigned max_length)
+	{
+		const string chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-[]/.";
+		string       str, other;
+		auto         length = 1 + random(max_length);
+		for (unsigned a = 0; a < length; ++a)
+		{
+			str += chars[random(chars.size())];
+			other += random(2) ? static_cast<char>(tolower(str.back())) : str.back();
+		}
+		if (random(4) == 0)
+			other[random(length)] = '!';
+		return std::make_pair(str, other);
+	};
+	vector<std::pair<string, string>> names, paths;
+	for (unsigned a = 0; a < count; ++a)
+	{
+		names.push_back(randomPair(8));
+		paths.push_back(randomPair(64));
+	}
+
+	// Simple versions to compare against
+	auto simpleEqualCI = [](string_view left, string_view right)
+	{
+		if (left.size() != right.size())
+			return false;
+		for (unsigned a = 0; a < left.size(); ++a)
+			if (tolower(left[a]) != tolower(right[a]))
+				return false;
+		return true;
+	};
+	auto simpleStartsWithCI = [&](string_view str, string_view check)
+	{ return check.size() <= str.size() && simpleEqualCI(str.substr(0, check.size()), check); };
+	auto simpleLower = [](string_view str)
+	{
+		auto s = string{ str };
+		transform(s.begin(), s.end(), s.begin(), ::tolower);
+		return s;
+	};
+	auto simpleUpper = [](string_view str)
+	{
+		auto s = string{ str };
+		transform(s.begin(), s.end(), s.begin(), ::toupper);
+		return s;
+	};
+
+	log::console(fmt::format("String functions, {} strings, {} runs:", count, runs));
+
+	using BenchFunc = std::function<size_t()>;
+	size_t result   = 0; // Accumulated so the compiler can't skip anything
+	auto   run      = [&](string_view name, const BenchFunc& fast_func, const BenchFunc& simple_func)
+	{
+		auto start = app::runTimer();
+		for (int a = 0; a < runs; ++a)
+			result += fast_func();
+		auto fast_time = app::runTimer() - start;
+
+		start = app::runTimer();
+		for (int a = 0; a < runs; ++a)
+			result += simple_func();
+		auto simple_time = app::runTimer() - start;
+
+		log::console(fmt::format("{}: {}ms (simple {}ms)", name, fast_time, simple_time));
+	};
+	auto countMatches = [](const vector<std::pair<string, string>>& pairs, auto&& func)
+	{
+		size_t n = 0;
+		for (const auto& pair : pairs)
+			n += func(pair.first, pair.second) ? 1 : 0;
+		return n;
+	};
+
+	run(
+		"equalCI (names)",
+		[&]() { return countMatches(names, strutil::equalCI); },
+		[&]() { return countMatches(names, simpleEqualCI); });
+	run(
+		"equalLumpNameCI (names)",
+		[&]() { return countMatches(names, strutil::equalLumpNameCI); },
+		[&]() { return countMatches(names, simpleEqualCI); });
+	run(
+		"equalCI (paths)",
+		[&]() { return countMatches(paths, strutil::equalCI); },
+		[&]() { return countMatches(paths, simpleEqualCI); });
+	run(
+		"startsWithCI (paths)",
+		[&]() { return countMatches(paths, [](string_view l, string_view r) { return strutil::startsWithCI(l, r); }); },
+		[&]() { return countMatches(paths, simpleStartsWithCI); });
+	run(
+		"lower (paths)",
+		[&]() { return countMatches(paths, [](string_view l, string_view) { return !strutil::lower(l).empty(); }); },
+		[&]() { return countMatches(paths, [&](string_view l, string_view) { return !simpleLower(l).empty(); }); });
+	run(
+		"upper (paths)",
+		[&]() { return countMatches(paths, [](string_view l, string_view) { return !strutil::upper(l).empty(); }); },
+		[&]() { return countMatches(paths, [&](string_view l, string_view) { return !simpleUpper(l).empty(); }); });
+
+	// Check results match
+	auto match = true;
+	for (const auto* pairs : { &names, &paths })
+		for (const auto& [left, right] : *pairs)
+		{
+			const auto equal = simpleEqualCI(left, right);
+			match &= strutil::equalCI(left, right) == equal;
+			match &= strutil::equalLumpNameCI(left, right) == equal;
+			match &= strutil::lower(right) == simpleLower(right);
+			match &= strutil::upper(right) == simpleUpper(right);
+		}
+	log::console(match ? "Results match" : "Results DON'T match!");
+	log::console(fmt::format("Checksum: {}", result));
+}
@@ -54,6 +54,10 @@ namespace strutil
 	bool matches(string_view str, string_view match);
 	bool matchesCI(string_view str, string_view match);
 
+	// Lump names (fast comparisons of names up to 8 characters)
+	uint64_t lumpNameKey(string_view name);
+	bool     equalLumpNameCI(string_view left, string_view right);
+
 	// String transformations
 	// IP = In-Place
 	string  escapedString(string_view str, bool swap_backslash = false, bool escape_backslash = true);
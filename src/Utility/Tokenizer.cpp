@@ -45,24 +45,6 @@ const string     Tokenizer::DEFAULT_SPECIAL_CHARACTERS = ";,:|={}/";
 Tokenizer::Token Tokenizer::invalid_token_{ "", 0, false, 0, 0, 0, false };
 
 
-// -----------------------------------------------------------------------------
-//
-// Local Functions
-//
-// -----------------------------------------------------------------------------
-namespace
-{
-// -----------------------------------------------------------------------------
-// Returns true if [p] is a whitespace character
-// -----------------------------------------------------------------------------
-bool isWhitespace(char p)
-{
-	// Whitespace is either a newline, tab character or space
-	return p == '\n' || p == 13 || p == ' ' || p == '\t';
-}
-} // namespace
-
-
 // -----------------------------------------------------------------------------
 //
 // Tokenizer::Token Struct Functions
@@ -76,7 +58,7 @@ bool isWhitespace(char p)
 // -----------------------------------------------------------------------------
 bool Tokenizer::Token::isInteger(bool allow_hex) const
 {
-	return strutil::isInteger(text, allow_hex);
+	return strutil::isInteger(string{ view() }, allow_hex);
 }
 
 // -----------------------------------------------------------------------------
@@ -84,7 +66,7 @@ bool Tokenizer::Token::isInteger(bool allow_hex) const
 // -----------------------------------------------------------------------------
 bool Tokenizer::Token::isHex() const
 {
-	return strutil::isHex(text);
+	return strutil::isHex(string{ view() });
 }
 
 // -----------------------------------------------------------------------------
@@ -92,7 +74,7 @@ bool Tokenizer::Token::isHex() const
 // -----------------------------------------------------------------------------
 bool Tokenizer::Token::isFloat() const
 {
-	return strutil::isFloat(text);
+	return strutil::isFloat(string{ view() });
 }
 
 // ----------------------------------------------------------------------------
@@ -100,7 +82,7 @@ bool Tokenizer::Token::isFloat() const
 // ----------------------------------------------------------------------------
 int Tokenizer::Token::asInt() const
 {
-	return strutil::asInt(text);
+	return strutil::asInt(view());
 }
 
 // -----------------------------------------------------------------------------
@@ -109,8 +91,9 @@ int Tokenizer::Token::asInt() const
 // -----------------------------------------------------------------------------
 bool Tokenizer::Token::asBool() const
 {
+	auto str = view();
 	return !(
-		text.empty() || strutil::equalCI(text, "false") || strutil::equalCI(text, "no") || strutil::equalCI(text, "0"));
+		str.empty() || strutil::equalCI(str, "false") || strutil::equalCI(str, "no") || strutil::equalCI(str, "0"));
 }
 
 // ----------------------------------------------------------------------------
@@ -118,7 +101,7 @@ bool Tokenizer::Token::asBool() const
 // ----------------------------------------------------------------------------
 double Tokenizer::Token::asFloat() const
 {
-	return strutil::asDouble(text);
+	return strutil::asDouble(view());
 }
 
 // ----------------------------------------------------------------------------
@@ -126,7 +109,7 @@ double Tokenizer::Token::asFloat() const
 // ----------------------------------------------------------------------------
 void Tokenizer::Token::toInt(int& val) const
 {
-	val = strutil::asInt(text);
+	val = strutil::asInt(view());
 }
 
 // -----------------------------------------------------------------------------
@@ -135,8 +118,8 @@ void Tokenizer::Token::toInt(int& val) const
 // -----------------------------------------------------------------------------
 void Tokenizer::Token::toBool(bool& val) const
 {
-	val = !(
-		text.empty() || strutil::equalCI(text, "false") || strutil::equalCI(text, "no") || strutil::equalCI(text, "0"));
+	auto str = view();
+	val = !(str.empty() || strutil::equalCI(str, "false") || strutil::equalCI(str, "no") || strutil::equalCI(str, "0"));
 }
 
 // ----------------------------------------------------------------------------
@@ -144,7 +127,7 @@ void Tokenizer::Token::toBool(bool& val) const
 // ----------------------------------------------------------------------------
 void Tokenizer::Token::toFloat(double& val) const
 {
-	val = strutil::asDouble(text);
+	val = strutil::asDouble(view());
 }
 
 // ----------------------------------------------------------------------------
@@ -152,7 +135,7 @@ void Tokenizer::Token::toFloat(double& val) const
 // ----------------------------------------------------------------------------
 void Tokenizer::Token::toFloat(float& val) const
 {
-	val = strutil::asFloat(text);
+	val = strutil::asFloat(view());
 }
 
 
@@ -168,8 +151,27 @@ void Tokenizer::Token::toFloat(float& val) const
 // -----------------------------------------------------------------------------
 Tokenizer::Tokenizer(int comments, const string& special_characters) :
 	comment_types_{ comments },
-	special_characters_{ special_characters.begin(), special_characters.end() }
+	special_characters_{ special_characters }
+{
+	updateCharClasses();
+}
+
+// -----------------------------------------------------------------------------
+// Sets the types of comments to skip to [types] (see CommentTypes)
+// -----------------------------------------------------------------------------
+void Tokenizer::setCommentTypes(int types)
+{
+	comment_types_ = types;
+	updateCharClasses();
+}
+
+// -----------------------------------------------------------------------------
+// Sets the characters that are always read as separate tokens to [characters]
+// -----------------------------------------------------------------------------
+void Tokenizer::setSpecialCharacters(string_view characters)
 {
+	special_characters_ = characters;
+	updateCharClasses();
 }
 
 // -----------------------------------------------------------------------------
@@ -250,7 +252,7 @@ bool Tokenizer::advIf(char check, size_t inc)
 // -----------------------------------------------------------------------------
 bool Tokenizer::advIfNC(const char* check, size_t inc)
 {
-	if (strutil::equalCI(token_current_.text, check))
+	if (strutil::equalCI(token_current_.view(), check))
 	{
 		adv(inc);
 		return true;
@@ -260,7 +262,7 @@ bool Tokenizer::advIfNC(const char* check, size_t inc)
 }
 bool Tokenizer::advIfNC(const string& check, size_t inc)
 {
-	if (strutil::equalCI(token_current_.text, check))
+	if (strutil::equalCI(token_current_.view(), check))
 	{
 		adv(inc);
 		return true;
@@ -320,7 +322,7 @@ bool Tokenizer::advIfNextNC(const char* check, size_t inc)
 	if (!token_next_.valid)
 		return false;
 
-	if (strutil::equalCI(token_next_.text, check))
+	if (strutil::equalCI(token_next_.view(), check))
 	{
 		adv(inc);
 		return true;
@@ -400,7 +402,7 @@ void slade::Tokenizer::advUntilNC(const char* end)
 	{
 		adv();
 
-		if (strutil::equalCI(token_current_.text, end))
+		if (strutil::equalCI(token_current_.view(), end))
 			break;
 	}
 }
@@ -458,7 +460,7 @@ vector<Tokenizer::Token> Tokenizer::getTokensUntilNC(const char* end)
 
 		adv();
 
-		if (strutil::equalCI(token_current_.text, end))
+		if (strutil::equalCI(token_current_.view(), end))
 			break;
 	}
 
@@ -542,7 +544,7 @@ bool Tokenizer::checkOrEnd(char check) const
 
 bool Tokenizer::checkNC(const char* check) const
 {
-	return strutil::equalCI(token_current_.text, check);
+	return strutil::equalCI(token_current_.view(), check);
 }
 
 bool Tokenizer::checkOrEndNC(const char* check) const
@@ -551,7 +553,7 @@ bool Tokenizer::checkOrEndNC(const char* check) const
 	if (!token_next_.valid)
 		return true;
 
-	return strutil::equalCI(token_current_.text, check);
+	return strutil::equalCI(token_current_.view(), check);
 }
 
 // -----------------------------------------------------------------------------
@@ -584,7 +586,7 @@ bool Tokenizer::checkNextNC(const char* check) const
 	if (!token_next_.valid)
 		return false;
 
-	return strutil::equalCI(token_next_.text, check);
+	return strutil::equalCI(token_next_.view(), check);
 }
 
 // -----------------------------------------------------------------------------
@@ -682,12 +684,39 @@ void Tokenizer::reset()
 	readNext(&token_next_);
 }
 
+// -----------------------------------------------------------------------------
+// Rebuilds the character class table from the current special characters and
+// comment types, so each character only needs a single lookup to classify
+// -----------------------------------------------------------------------------
+void Tokenizer::updateCharClasses()
+{
+	std::fill(std::begin(char_class_), std::end(char_class_), 0);
+
+	// Whitespace is either a newline, tab character or space
+	for (auto c : { '\n', '\r', ' ', '\t' })
+		char_class_[static_cast<uint8_t>(c)] |= CharWhitespace;
+
+	for (auto c : special_characters_)
+		char_class_[static_cast<uint8_t>(c)] |= CharSpecial;
+
+	if (comment_types_ & (CStyle | CPPStyle))
+		char_class_[static_cast<uint8_t>('/')] |= CharCommentBegin;
+	if (comment_types_ & (Hash | DoubleHash))
+		char_class_[static_cast<uint8_t>('#')] |= CharCommentBegin;
+	if (comment_types_ & Shell)
+		char_class_[static_cast<uint8_t>(';')] |= CharCommentBegin;
+}
+
 // -----------------------------------------------------------------------------
 // Checks if a comment begins at the current position and returns the comment
 // type if one does (0 otherwise)
 // -----------------------------------------------------------------------------
 unsigned Tokenizer::checkCommentBegin()
 {
+	// Quick check for any comment type
+	if (!(char_class_[static_cast<uint8_t>(data_[state_.position])] & CharCommentBegin))
+		return 0;
+
 	// C-Style comment (/*)
 	if (comment_types_ & CStyle && state_.position + 1 < state_.size && data_[state_.position] == '/'
 		&& data_[state_.position + 1] == '*')
@@ -794,7 +823,10 @@ void Tokenizer::tokenizeToken()
 
 		// Escape backslash+double-quote
 		if (state_.position < state_.size && data_[state_.position] == '\\' && data_[state_.position + 1] == '\"')
+		{
+			state_.escaped = true;
 			++state_.position;
+		}
 
 		// Continue token
 		++state_.position;
@@ -884,7 +916,8 @@ bool Tokenizer::readNext(Token* target)
 	}
 
 	// Process until the end of a token or the end of the data
-	state_.done = false;
+	state_.done    = false;
+	state_.escaped = false;
 	while (state_.position < state_.size && !state_.done)
 	{
 		// Check for newline
@@ -904,13 +937,31 @@ bool Tokenizer::readNext(Token* target)
 	// Write to target token (if specified)
 	if (target)
 	{
-		target->text.clear();
-		for (unsigned a = state_.current_token.pos_start; a < state_.position; ++a)
+		auto start  = state_.current_token.pos_start;
+		auto length = state_.position > start ? state_.position - start : 0;
+		auto lower  = read_lowercase_ && !state_.current_token.quoted_string;
+		if (zero_copy_ && !state_.escaped && !lower)
 		{
-			if (state_.current_token.quoted_string && a < data_.size() - 1 && data_[a] == '\\' && data_[a + 1] == '\"')
-				++a;
-
-			target->text += data_[a];
+			// No processing needed, point to the text in the data
+			target->text.clear();
+			target->source_text = { data_.data() + start, length };
+		}
+		else if (state_.escaped)
+		{
+			target->source_text = {};
+			target->text.clear();
+			for (unsigned a = start; a < state_.position; ++a)
+			{
+				if (a < data_.size() - 1 && data_[a] == '\\' && data_[a + 1] == '\"')
+					++a;
+
+				target->text += data_[a];
+			}
+		}
+		else
+		{
+			target->source_text = {};
+			target->text.assign(data_.data() + start, length);
 		}
 
 		target->line_no       = state_.current_token.line_no;
@@ -921,7 +972,7 @@ bool Tokenizer::readNext(Token* target)
 		target->valid         = true;
 
 		// Convert to lowercase if configured to and it isn't a quoted string
-		if (read_lowercase_ && !target->quoted_string)
+		if (lower)
 			strutil::lowerIP(target->text);
 	}
 
@@ -930,7 +981,7 @@ bool Tokenizer::readNext(Token* target)
 		++state_.position;
 
 	if (debug_)
-		log::debug("{}: \"{}\"", token_current_.line_no, token_current_.text);
+		log::debug("{}: \"{}\"", token_current_.line_no, token_current_.view());
 
 	return true;
 }
@@ -974,8 +1025,9 @@ CONSOLE_COMMAND(test_tokenizer, 0, false)
 	if (!args.empty())
 		num = strutil::asInt(args[0]);
 
-	bool lower = (VECTOR_EXISTS(args, "lower"));
-	bool dump  = (VECTOR_EXISTS(args, "dump"));
+	bool lower     = (VECTOR_EXISTS(args, "lower"));
+	bool dump      = (VECTOR_EXISTS(args, "dump"));
+	bool zero_copy = (VECTOR_EXISTS(args, "zerocopy"));
 
 	struct TestToken
 	{
@@ -988,6 +1040,7 @@ CONSOLE_COMMAND(test_tokenizer, 0, false)
 	Tokenizer         tz;
 	vector<TestToken> t_new;
 	tz.setReadLowerCase(lower);
+	tz.enableZeroCopy(zero_copy);
 	long time = app::runTimer();
 	tz.openMem(entry->data(), entry->name());
 	for (long a = 0; a < num; a++)
@@ -995,7 +1048,7 @@ CONSOLE_COMMAND(test_tokenizer, 0, false)
 		while (!tz.atEnd())
 		{
 			if (a == 0)
-				t_new.push_back({ tz.current().text, tz.current().quoted_string, tz.current().line_no });
+				t_new.push_back({ string{ tz.current().view() }, tz.current().quoted_string, tz.current().line_no });
 
 			tz.next();
 		}
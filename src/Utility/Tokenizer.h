@@ -18,24 +18,29 @@ public:
 
 	struct Token
 	{
-		string   text;
-		unsigned line_no;
-		bool     quoted_string;
-		unsigned pos_start;
-		unsigned pos_end;
-		unsigned length;
-		bool     valid;
-
-		explicit operator string() const { return text; }
-		explicit operator const string() const { return text; }
+		string      text; // Not set for tokens read in zero-copy mode (use view())
+		unsigned    line_no;
+		bool        quoted_string;
+		unsigned    pos_start;
+		unsigned    pos_end;
+		unsigned    length;
+		bool        valid;
+		string_view source_text = {}; // Zero-copy token text, within the tokenizer's data
+
+		// Returns the token text, whether or not it was read in zero-copy mode.
+		// Zero-copy token text is only valid until the tokenizer is re-opened
+		string_view view() const { return source_text.data() ? source_text : string_view{ text }; }
+
+		explicit operator string() const { return string{ view() }; }
+		explicit operator const string() const { return string{ view() }; }
 		explicit operator const char*() const { return text.c_str(); }
-		bool     operator==(const string& cmp) const { return text == cmp; }
-		bool     operator==(const char* cmp) const { return text == cmp; }
-		bool     operator==(char cmp) const { return length == 1 && text[0] == cmp; }
-		bool     operator!=(const string& cmp) const { return text != cmp; }
-		bool     operator!=(const char* cmp) const { return text != cmp; }
-		bool     operator!=(char cmp) const { return length != 1 || text[0] != cmp; }
-		char     operator[](unsigned index) const { return text[index]; }
+		bool     operator==(const string& cmp) const { return view() == cmp; }
+		bool     operator==(const char* cmp) const { return view() == cmp; }
+		bool     operator==(char cmp) const { return view().size() == 1 && view()[0] == cmp; }
+		bool     operator!=(const string& cmp) const { return view() != cmp; }
+		bool     operator!=(const char* cmp) const { return view() != cmp; }
+		bool     operator!=(char cmp) const { return view().size() != 1 || view()[0] != cmp; }
+		char     operator[](unsigned index) const { return index < view().size() ? view()[index] : 0; }
 
 		bool isInteger(bool allow_hex = false) const;
 		bool isHex() const;
@@ -67,7 +72,8 @@ public:
 		unsigned current_line = 1;
 		unsigned comment_type = 0;
 		Token    current_token;
-		bool     done = false;
+		bool     escaped = false; // Current (quoted) token contains escaped characters
+		bool     done    = false;
 	};
 
 	// Constructors
@@ -77,19 +83,18 @@ public:
 	const string& source() const { return source_; }
 	bool          decorate() const { return decorate_; }
 	bool          readLowerCase() const { return read_lowercase_; }
+	bool          zeroCopy() const { return zero_copy_; }
 	const Token&  current() const { return token_current_; }
 	const Token&  peek() const;
 
 	// Modifiers
-	void setCommentTypes(int types) { comment_types_ = types; }
-	void setSpecialCharacters(string_view characters)
-	{
-		special_characters_.assign(characters.data(), characters.data() + characters.size());
-	}
+	void setCommentTypes(int types);
+	void setSpecialCharacters(string_view characters);
 	void setSource(const wxString& source) { source_ = source; }
 	void setReadLowerCase(bool lower) { read_lowercase_ = lower; }
 	void enableDecorate(bool enable) { decorate_ = enable; }
 	void enableDebug(bool enable) { debug_ = enable; }
+	void enableZeroCopy(bool enable) { zero_copy_ = enable; }
 
 	// Token Iterating
 	const Token&  next();
@@ -139,7 +144,7 @@ public:
 	bool openMem(const MemChunk& mc, string_view source);
 
 	// General
-	bool isSpecialCharacter(char p) const { return VECTOR_EXISTS(special_characters_, p); }
+	bool isSpecialCharacter(char p) const { return char_class_[static_cast<uint8_t>(p)] & CharSpecial; }
 	bool atEnd() const { return !token_next_.valid; }
 	void reset();
 
@@ -148,7 +153,7 @@ public:
 	{
 		if (atEnd())
 			return "";
-		string t = token_current_.text;
+		string t{ token_current_.view() };
 		adv();
 		return t;
 	}
@@ -157,14 +162,14 @@ public:
 		if (atEnd())
 			*str = "";
 		else
-			*str = token_current_.text;
+			*str = token_current_.view();
 		adv();
 	}
 	string peekToken() const
 	{
 		if (atEnd())
 			return "";
-		return token_current_.text;
+		return string{ token_current_.view() };
 	}
 	int getInteger()
 	{
@@ -210,18 +215,30 @@ private:
 	TokenizeState state_         = {};
 
 	// Configuration
-	int          comment_types_;          // Types of comments to skip
-	vector<char> special_characters_;     // These will always be read as separate tokens
-	string       source_;                 // What file/entry/chunk is being tokenized
-	bool         decorate_       = false; // Special handling for //$ comments
-	bool         read_lowercase_ = false; // If true, tokens will all be read in lowercase
-										  // (except for quoted strings, obviously)
-	bool debug_ = false;                  // Log each token read
+	int     comment_types_;           // Types of comments to skip
+	string  special_characters_;      // These will always be read as separate tokens
+	string  source_;                  // What file/entry/chunk is being tokenized
+	bool    decorate_       = false;  // Special handling for //$ comments
+	bool    read_lowercase_ = false;  // If true, tokens will all be read in lowercase
+	                                  // (except for quoted strings, obviously)
+	bool    debug_           = false; // Log each token read
+	bool    zero_copy_       = false; // Tokens point into the data where possible (see Token::view)
+	uint8_t char_class_[256] = {};    // CharClass flags for each character
+
+	// Character classes
+	enum CharClass : uint8_t
+	{
+		CharWhitespace   = 1,
+		CharSpecial      = 2,
+		CharCommentBegin = 4, // First character of any enabled comment type
+	};
 
 	// Static
 	static Token invalid_token_;
 
 	// Tokenizing
+	bool     isWhitespace(char p) const { return char_class_[static_cast<uint8_t>(p)] & CharWhitespace; }
+	void     updateCharClasses();
 	unsigned checkCommentBegin();
 	void     tokenizeUnknown();
 	void     tokenizeToken();